@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <future>
+
 #include "fmt/format.h"
 #include "pybind11/iostream.h"
 #include "pybind11/numpy.h"
@@ -206,6 +209,32 @@ void BindLink(py::module& m) {
         });
 }
 
+constexpr size_t kPickleChunkSize = 64 * 1024 * 1024;
+
+py::tuple SerializeToChunks(const spu::Value& value, size_t max_chunk_size) {
+  auto [meta, chunks] = value.toProto(max_chunk_size);
+
+  py::list serialized;
+  for (auto& chunk : chunks) {
+    serialized.append(py::bytes(chunk.SerializeAsString()));
+    // release the chunk once serialized.
+    ValueChunkProto().Swap(&chunk);
+  }
+  return py::make_tuple(py::bytes(meta.SerializeAsString()), serialized);
+}
+
+spu::Value ParseFromChunks(const py::bytes& meta_pb,
+                           const std::vector<py::bytes>& chunks_pb) {
+  ValueMetaProto meta;
+  YACL_ENFORCE(meta.ParseFromString(meta_pb));
+
+  std::vector<ValueChunkProto> chunks(chunks_pb.size());
+  for (size_t idx = 0; idx < chunks.size(); ++idx) {
+    YACL_ENFORCE(chunks[idx].ParseFromString(chunks_pb[idx]));
+  }
+  return spu::Value::fromProto(meta, chunks);
+}
+
 // Wrap Runtime, it's workaround for protobuf pybind11/protoc conflict.
 class RuntimeWrapper {
   std::unique_ptr<spu::HalContext> hctx_;
@@ -213,6 +242,17 @@ class RuntimeWrapper {
   // the golbals, could be used to cross session stuffs.
   spu::device::SymbolTable env_;
 
+  // executables loaded to run without parsing again.
+  spu::device::ExecutableCache exec_cache_;
+
+  static bool SameIoNames(const spu::ExecutableProto& lhs,
+                          const spu::ExecutableProto& rhs) {
+    return std::equal(lhs.input_names().begin(), lhs.input_names().end(),
+                      rhs.input_names().begin(), rhs.input_names().end()) &&
+           std::equal(lhs.output_names().begin(), lhs.output_names().end(),
+                      rhs.output_names().begin(), rhs.output_names().end());
+  }
+
  public:
   explicit RuntimeWrapper(std::shared_ptr<yacl::link::Context> lctx,
                           const std::string& config_pb) {
@@ -227,9 +267,35 @@ class RuntimeWrapper {
     YACL_ENFORCE(exec.ParseFromString(exec_pb));
 
     spu::device::pphlo::PPHloExecutor executor;
+    // run the loaded one of the same code and io names without parsing.
+    auto parsed = exec_cache_.find(exec.code());
+    if (parsed != nullptr && SameIoNames(parsed->executable(), exec)) {
+      spu::device::execute(&executor, hctx_.get(), *parsed, &env_);
+      return;
+    }
     spu::device::execute(&executor, hctx_.get(), exec, &env_);
   }
 
+  // Parse the executable once and keep it, return the key to run it by.
+  std::string LoadExecutable(const py::bytes& exec_pb) {
+    spu::ExecutableProto exec;
+    YACL_ENFORCE(exec.ParseFromString(exec_pb));
+
+    return exec_cache_.load(exec);
+  }
+
+  void RunLoaded(const std::string& key) {
+    auto parsed = exec_cache_.get(key);
+    YACL_ENFORCE(parsed != nullptr, "executable {} is not loaded", key);
+
+    spu::device::pphlo::PPHloExecutor executor;
+    spu::device::execute(&executor, hctx_.get(), *parsed, &env_);
+  }
+
+  bool UnloadExecutable(const std::string& key) {
+    return exec_cache_.unload(key);
+  }
+
   void SetVar(const std::string& name, const py::bytes& value) {
     ValueProto proto;
     YACL_ENFORCE(proto.ParseFromString(value));
@@ -241,6 +307,16 @@ class RuntimeWrapper {
     return env_.getVar(name).toProto().SerializeAsString();
   }
 
+  // Set and get vars as Share objects, which hold the buffers of the values
+  // without any copy or serialization.
+  void SetShare(const std::string& name, const spu::Value& value) {
+    env_.setVar(name, value);
+  }
+
+  spu::Value GetShare(const std::string& name) const {
+    return env_.getVar(name);
+  }
+
   void DelVar(const std::string& name) { env_.delVar(name); }
 
   void Clear() { env_.clear(); }
@@ -307,6 +383,38 @@ constexpr void SizeCheck() {
                 "SPU assumes size of ulonglong == 8");
 }
 
+// A view of the buffer of `arr`, valid as long as `arr` is alive.
+spu::PtBufferView PyArrayToView(const py::array& arr) {
+  const py::buffer_info& binfo = arr.request();
+  const PtType pt_type = PyFormatToPtType(binfo.format);
+
+  return spu::PtBufferView(
+      binfo.ptr, pt_type,
+      std::vector<int64_t>(binfo.shape.begin(), binfo.shape.end()),
+      ByteToElementStrides(binfo.strides.begin(), binfo.strides.end(),
+                           binfo.itemsize));
+}
+
+// The returned array owns the decoded buffer, which is not copied again.
+py::array NdArrayToPyArray(NdArrayRef ndarr) {
+  YACL_ENFORCE(ndarr.eltype().isa<PtTy>(), "expect decode to pt_type, got {}",
+               ndarr.eltype());
+
+  const auto pt_type = ndarr.eltype().as<PtTy>()->pt_type();
+  std::vector<size_t> shape = {ndarr.shape().begin(), ndarr.shape().end()};
+  std::vector<int64_t> strides(ndarr.strides().size());
+  for (size_t idx = 0; idx < strides.size(); ++idx) {
+    strides[idx] = ndarr.strides()[idx] * ndarr.elsize();
+  }
+
+  // the capsule keeps the buffer alive as long as the array.
+  auto* holder = new NdArrayRef(std::move(ndarr));
+  py::capsule base(holder,
+                   [](void* p) { delete static_cast<NdArrayRef*>(p); });
+  return py::array(py::dtype(PtTypeToPyFormat(pt_type)), shape, strides,
+                   holder->data(), base);
+}
+
 class IoWrapper {
   std::unique_ptr<spu::device::IoClient> ptr_;
 
@@ -320,21 +428,7 @@ class IoWrapper {
 
   std::vector<py::bytes> MakeShares(const py::array& arr, int visibility,
                                     int owner_rank = -1) {
-    // When working with Python, do a static size check, this has no runtime
-    // cost
-    SizeCheck();
-
-    const py::buffer_info& binfo = arr.request();
-    const PtType pt_type = PyFormatToPtType(binfo.format);
-
-    spu::PtBufferView view(
-        binfo.ptr, pt_type,
-        std::vector<int64_t>(binfo.shape.begin(), binfo.shape.end()),
-        ByteToElementStrides(binfo.strides.begin(), binfo.strides.end(),
-                             binfo.itemsize));
-
-    auto shares =
-        ptr_->makeShares(view, spu::Visibility(visibility), owner_rank);
+    auto shares = MakeRawShares(arr, visibility, owner_rank);
     std::vector<py::bytes> serialized(shares.size());
     for (size_t idx = 0; idx < shares.size(); ++idx) {
       std::string s;
@@ -345,6 +439,20 @@ class IoWrapper {
     return serialized;
   }
 
+  // Shares read straight from the buffer of `arr`, the GIL is released while
+  // sharing, and the buffer is held by `arr` meanwhile.
+  std::vector<spu::Value> MakeRawShares(const py::array& arr, int visibility,
+                                        int owner_rank = -1) {
+    // When working with Python, do a static size check, this has no runtime
+    // cost
+    SizeCheck();
+
+    const auto view = PyArrayToView(arr);
+
+    py::gil_scoped_release release;
+    return ptr_->makeShares(view, spu::Visibility(visibility), owner_rank);
+  }
+
   py::array reconstruct(const std::vector<std::string>& vals) {
     std::vector<spu::Value> shares;
     YACL_ENFORCE(vals.size() > 0);
@@ -354,8 +462,15 @@ class IoWrapper {
       shares.push_back(spu::Value::fromProto(vp));
     }
 
+    return ReconstructRaw(shares);
+  }
+
+  // The returned array owns the decoded buffer, which is not copied again.
+  py::array ReconstructRaw(const std::vector<spu::Value>& shares) {
+    YACL_ENFORCE(shares.size() > 0);
+
     // sanity
-    for (size_t idx = 1; idx < vals.size(); ++idx) {
+    for (size_t idx = 1; idx < shares.size(); ++idx) {
       const auto& cur = shares[idx];
       const auto& prev = shares[idx - 1];
       YACL_ENFORCE(cur.storage_type() == prev.storage_type(),
@@ -365,16 +480,122 @@ class IoWrapper {
                    cur.dtype(), prev.dtype());
     }
 
-    auto ndarr = ptr_->combineShares(shares);
-    YACL_ENFORCE(ndarr.eltype().isa<PtTy>(), "expect decode to pt_type, got {}",
-                 ndarr.eltype());
-
-    const auto pt_type = ndarr.eltype().as<PtTy>()->pt_type();
-    std::vector<size_t> shape = {ndarr.shape().begin(), ndarr.shape().end()};
-    return py::array(py::dtype(PtTypeToPyFormat(pt_type)), shape, ndarr.data());
+    NdArrayRef ndarr;
+    {
+      py::gil_scoped_release release;
+      ndarr = ptr_->combineShares(shares);
+    }
+    return NdArrayToPyArray(std::move(ndarr));
   }
 };
 
+// Run all the parties of `exec` on native threads over in-memory links, the
+// inputs are shared from the numpy buffers and the outputs are decoded into
+// numpy buffers, nothing is serialized. The GIL is only held to convert the
+// arrays.
+std::vector<py::array> Simulate(size_t world_size, const std::string& config_pb,
+                                const py::bytes& exec_pb,
+                                const std::vector<py::array>& inputs,
+                                const std::vector<int>& input_visibilities) {
+  SizeCheck();
+
+  spu::RuntimeConfig config;
+  YACL_ENFORCE(config.ParseFromString(config_pb));
+  spu::ExecutableProto exec;
+  YACL_ENFORCE(exec.ParseFromString(exec_pb));
+  YACL_ENFORCE(static_cast<int>(inputs.size()) == exec.input_names_size(),
+               "got {} inputs, expect {}", inputs.size(),
+               exec.input_names_size());
+  YACL_ENFORCE(input_visibilities.empty() ||
+                   input_visibilities.size() == inputs.size(),
+               "got {} visibilities of {} inputs", input_visibilities.size(),
+               inputs.size());
+
+  // the views are valid as long as `inputs`, which outlives this call.
+  std::vector<spu::PtBufferView> views;
+  views.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    views.push_back(PyArrayToView(input));
+  }
+
+  std::vector<NdArrayRef> outputs;
+  {
+    py::gil_scoped_release release;
+
+    spu::device::IoClient io(world_size, config);
+    // shares of every party, by input.
+    std::vector<std::vector<spu::Value>> params;
+    params.reserve(views.size());
+    for (size_t idx = 0; idx < views.size(); ++idx) {
+      const auto vis = input_visibilities.empty()
+                           ? spu::VIS_SECRET
+                           : spu::Visibility(input_visibilities[idx]);
+      params.push_back(io.makeShares(views[idx], vis));
+    }
+
+    // a fresh link id of every simulation, so concurrent ones never meet.
+    static std::atomic<uint64_t> sim_count{0};
+    yacl::link::ContextDesc desc;
+    desc.id = fmt::format("sim_{}", sim_count++);
+    for (size_t rank = 0; rank < world_size; ++rank) {
+      desc.parties.push_back({fmt::format("id_{}", rank),
+                              fmt::format("thread_{}", rank)});
+    }
+
+    auto party = [&](size_t rank) {
+      auto lctx = yacl::link::FactoryMem().CreateContext(desc, rank);
+      lctx->ConnectToMesh();
+
+      spu::RuntimeConfig rank_config = config;
+      if (rank != 0) {
+        // profiles and traces of the first party only.
+        rank_config.set_enable_action_trace(false);
+        rank_config.set_enable_hal_profile(false);
+        rank_config.set_enable_pphlo_profile(false);
+      }
+      spu::HalContext hctx(rank_config, lctx);
+
+      spu::device::SymbolTable env;
+      for (int idx = 0; idx < exec.input_names_size(); ++idx) {
+        env.setVar(exec.input_names(idx), params[idx][rank]);
+      }
+
+      spu::device::pphlo::PPHloExecutor executor;
+      spu::device::execute(&executor, &hctx, exec, &env);
+
+      std::vector<spu::Value> rets;
+      for (const auto& name : exec.output_names()) {
+        rets.push_back(env.getVar(name));
+      }
+      return rets;
+    };
+
+    std::vector<std::future<std::vector<spu::Value>>> futures;
+    for (size_t rank = 0; rank < world_size; ++rank) {
+      futures.push_back(std::async(std::launch::async, party, rank));
+    }
+    std::vector<std::vector<spu::Value>> parties;
+    for (auto& future : futures) {
+      parties.push_back(future.get());
+    }
+
+    for (int idx = 0; idx < exec.output_names_size(); ++idx) {
+      std::vector<spu::Value> shares;
+      for (const auto& rets : parties) {
+        shares.push_back(rets[idx]);
+      }
+      outputs.push_back(io.combineShares(shares));
+    }
+  }
+
+  std::vector<py::array> ret;
+  ret.reserve(outputs.size());
+  for (auto& output : outputs) {
+    ret.push_back(NdArrayToPyArray(std::move(output)));
+  }
+  return ret;
+}
+
 void BindLibs(py::module& m) {
   m.doc() = R"pbdoc(
               SPU Mixed Library
@@ -424,30 +645,78 @@ PYBIND11_MODULE(_lib, m) {
     }
   });
 
+  // bind spu value, to pass shares between io and runtime without copy.
+  py::class_<spu::Value>(m, "Share", "SPU value, held in native buffers")
+      .def_property_readonly("shape", &spu::Value::shape)
+      .def_property_readonly(
+          "data_type",
+          [](const spu::Value& self) { return static_cast<int>(self.dtype()); })
+      .def_property_readonly(
+          "visibility",
+          [](const spu::Value& self) { return static_cast<int>(self.vtype()); })
+      .def(
+          "SerializeToString",
+          [](const spu::Value& self) -> py::bytes {
+            return self.toProto().SerializeAsString();
+          },
+          "Serialize to ValueProto bytes")
+      .def("SerializeToChunks", &SerializeToChunks,
+           "Serialize to ValueMetaProto bytes and ValueChunkProto bytes of at "
+           "most max_chunk_size bytes of content",
+           py::arg("max_chunk_size"))
+      .def_static("FromChunks", &ParseFromChunks,
+                  "Parse from the output of SerializeToChunks",
+                  py::arg("meta"), py::arg("chunks"))
+      // pickled in chunks, so shares are not limited by the 2GB of a proto.
+      .def(py::pickle(
+          [](const spu::Value& self) {
+            return SerializeToChunks(self, kPickleChunkSize);
+          },
+          [](const py::tuple& state) {
+            YACL_ENFORCE(state.size() == 2, "invalid state");
+            return ParseFromChunks(state[0].cast<py::bytes>(),
+                                   state[1].cast<std::vector<py::bytes>>());
+          }));
+
   // bind spu virtual machine.
   py::class_<RuntimeWrapper>(m, "RuntimeWrapper", "SPU virtual device")
       .def(py::init<std::shared_ptr<yacl::link::Context>, std::string>(),
            NO_GIL)
       .def("Run", &RuntimeWrapper::Run, NO_GIL)
+      .def("LoadExecutable", &RuntimeWrapper::LoadExecutable, NO_GIL)
+      .def("RunLoaded", &RuntimeWrapper::RunLoaded, NO_GIL)
+      .def("UnloadExecutable", &RuntimeWrapper::UnloadExecutable, NO_GIL)
       .def("SetVar",
            &RuntimeWrapper::
                SetVar)  // https://github.com/pybind/pybind11/issues/1782
                         // SetVar & GetVar are using
                         // py::byte, so they must acquire gil...
       .def("GetVar", &RuntimeWrapper::GetVar)
+      .def("SetShare", &RuntimeWrapper::SetShare, NO_GIL)
+      .def("GetShare", &RuntimeWrapper::GetShare, NO_GIL)
       .def("DelVar", &RuntimeWrapper::DelVar);
 
   // bind spu io suite.
   py::class_<IoWrapper>(m, "IoWrapper", "SPU VM IO")
       .def(py::init<size_t, std::string>())
       .def("MakeShares", &IoWrapper::MakeShares)
-      .def("Reconstruct", &IoWrapper::reconstruct);
+      .def("MakeRawShares", &IoWrapper::MakeRawShares)
+      .def("Reconstruct", &IoWrapper::reconstruct)
+      .def("ReconstructRaw", &IoWrapper::ReconstructRaw);
+
+  // bind the native simulator.
+  m.def("simulate", &Simulate,
+        "Simulate all parties of an executable on native threads, returns the "
+        "revealed outputs.",
+        py::arg("world_size"), py::arg("config"), py::arg("executable"),
+        py::arg("inputs"), py::arg("input_visibilities") = std::vector<int>{});
 
   // bind compiler.
   m.def(
       "compile",
       [](const py::bytes& ir_text, const std::string& ir_type,
-         const std::string& input_visbility_map, const std::string& dump_path) {
+         const std::string& input_visbility_map, const std::string& dump_path,
+         bool emit_bytecode) {
         py::scoped_ostream_redirect stream(
             std::cout,                                 // std::ostream&
             py::module_::import("sys").attr("stdout")  // Python output
@@ -455,15 +724,21 @@ PYBIND11_MODULE(_lib, m) {
 
         spu::compiler::CompilationContext ctx;
         ctx.setInputVisibilityString(input_visbility_map);
+        ctx.setEmitBytecode(emit_bytecode);
 
         if (!dump_path.empty()) {
           ctx.enablePrettyPrintWithDir(dump_path);
         }
 
-        return py::bytes(spu::compiler::compile(&ctx, ir_text, ir_type));
+        auto code = spu::compiler::compile(&ctx, ir_text, ir_type);
+        return py::make_tuple(
+            py::bytes(code),
+            py::bytes(ctx.getMemoryPlan().SerializeAsString()));
       },
-      "spu compile.", py::arg("ir_text"), py::arg("ir_type"),
-      py::arg("vis_map"), py::arg("dump_path"));
+      "spu compile, returns the code and the memory plan.",
+      py::arg("ir_text"), py::arg("ir_type"),
+      py::arg("vis_map"), py::arg("dump_path"),
+      py::arg("emit_bytecode") = false);
 
   // bind spu libs.
   py::module link_m = m.def_submodule("link");
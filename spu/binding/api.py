@@ -14,15 +14,25 @@
 
 from __future__ import annotations
 
+import hashlib
 import os
-from typing import List
+import tempfile
+from typing import List, Tuple, Union
 
+import numpy as np
 import spu.spu_pb2 as spu_pb2
 
 from cachetools import LRUCache, cached
+from google.protobuf.message import DecodeError
+
+from spu.version import __version__
 
 from . import _lib
 
+# An SPU value held in native buffers, passed between Io and Runtime without
+# serialization. It is picklable for transfer between processes.
+Share = _lib.Share
+
 
 class Runtime(object):
     """The SPU Virtual Machine Slice."""
@@ -45,14 +55,51 @@ class Runtime(object):
         """
         return self._vm.Run(executable.SerializeToString())
 
-    def set_var(self, name: str, value: spu_pb2.ValueProto) -> None:
+    def load_executable(self, executable: spu_pb2.ExecutableProto) -> str:
+        """Parse an SPU executable once and keep it in the runtime.
+
+        Runs of the same code skip parsing until it is unloaded.
+
+        Args:
+            executable (ExecutableProto): executable.
+
+        Returns:
+            str: the key to run or unload it by.
+        """
+        return self._vm.LoadExecutable(executable.SerializeToString())
+
+    def run_loaded(self, key: str) -> None:
+        """Run a loaded SPU executable.
+
+        Args:
+            key (str): key returned by load_executable.
+        """
+        return self._vm.RunLoaded(key)
+
+    def unload_executable(self, key: str) -> bool:
+        """Drop a loaded SPU executable.
+
+        Args:
+            key (str): key returned by load_executable.
+
+        Returns:
+            bool: False if the key is not loaded.
+        """
+        return self._vm.UnloadExecutable(key)
+
+    def set_var(
+        self, name: str, value: Union[spu_pb2.ValueProto, Share]
+    ) -> None:
         """Set an SPU value.
 
         Args:
             name (str): Id of value.
-            value (ValueProto): value data.
+            value (ValueProto | Share): value data, a Share is set without
+                copy.
 
         """
+        if isinstance(value, Share):
+            return self._vm.SetShare(name, value)
         return self._vm.SetVar(name, value.SerializeToString())
 
     def get_var(self, name: str) -> spu_pb2.ValueProto:
@@ -68,6 +115,17 @@ class Runtime(object):
         ret.ParseFromString(self._vm.GetVar(name))
         return ret
 
+    def get_share(self, name: str) -> Share:
+        """Get an SPU value without copy.
+
+        Args:
+            name (str): Id of value.
+
+        Returns:
+            Share: Data data.
+        """
+        return self._vm.GetShare(name)
+
     def del_var(self, name: str) -> None:
         """Delete an SPU value.
 
@@ -114,39 +172,198 @@ class Io(object):
             rets.append(value_share)
         return rets
 
-    def reconstruct(self, xs: List[spu_pb2.ValueProto]) -> 'np.ndarray':
+    def make_raw_shares(
+        self, x: 'np.ndarray', vtype: spu_pb2.Visibility, owner_rank: int = -1
+    ) -> List[Share]:
+        """Convert from NumPy array to list of SPU share(s), without
+        serialization.
+
+        Args:
+            x (np.ndarray): input.
+            vtype (Visibility): visibility.
+            owner_rank (int): the index of the trusted piece. if >= 0, colocation optimization may be applied.
+
+        Returns:
+            [Share]: output.
+        """
+        return self._io.MakeRawShares(x, vtype, owner_rank)
+
+    def reconstruct(
+        self, xs: Union[List[spu_pb2.ValueProto], List[Share]]
+    ) -> 'np.ndarray':
         """Convert from list of SPU value(s) to NumPy array.
 
         Args:
-            xs (ValueProto]): input.
+            xs ([ValueProto] | [Share]): input.
 
         Returns:
             np.ndarray: output.
         """
+        if all(isinstance(x, Share) for x in xs):
+            return self._io.ReconstructRaw(list(xs))
         str_shares = [x.SerializeToString() for x in xs]
         return self._io.Reconstruct(str_shares)
 
 
+def simulate(
+    world_size: int,
+    config: spu_pb2.RuntimeConfig,
+    executable: spu_pb2.ExecutableProto,
+    inputs: List[np.ndarray],
+    input_visibilities: List[spu_pb2.Visibility] = None,
+) -> List[np.ndarray]:
+    """Simulate all the parties of an executable in this process.
+
+    Parties run on native threads over in-memory links, inputs are shared
+    from and outputs are revealed into numpy buffers, and the GIL is
+    released meanwhile.
+
+    Args:
+        world_size (int): the number of parties.
+        config (RuntimeConfig): the runtime config of all parties.
+        executable (ExecutableProto): the executable to run.
+        inputs ([np.ndarray]): the inputs, by executable.input_names.
+        input_visibilities ([Visibility]): the visibilities of the inputs,
+            all secret by default.
+
+    Returns:
+        [np.ndarray]: the revealed outputs, by executable.output_names.
+    """
+    return _lib.simulate(
+        world_size,
+        config.SerializeToString(),
+        executable.SerializeToString(),
+        [np.asarray(x) for x in inputs],
+        list(input_visibilities or []),
+    )
+
+
 @cached(cache=LRUCache(maxsize=128))
-def _spu_compilation(ir_text: str, ir_type: str, json_meta: str):
+def _spu_compilation(
+    ir_text: str, ir_type: str, json_meta: str, emit_bytecode: bool
+):
     pp_dir = os.getenv('SPU_IR_DUMP_DIR')
-    return _lib.compile(ir_text, ir_type, json_meta, pp_dir or "")
+    return _lib.compile(
+        ir_text, ir_type, json_meta, pp_dir or "", emit_bytecode
+    )
 
 
-def compile(ir_text: str, ir_type: str, vis: List[spu_pb2.Visibility]) -> str:
-    """Compile from textual HLO/MHLO IR to SPU bytecode.
+def _compilation_cache_path(
+    cache_dir: str,
+    ir_text: Union[str, bytes],
+    ir_type: str,
+    json_meta: str,
+    emit_bytecode: bool,
+) -> str:
+    # Content addressed, entries of other compiler versions are never hit.
+    h = hashlib.sha256()
+    for field in (__version__, ir_type, json_meta, str(emit_bytecode)):
+        h.update(field.encode('utf-8'))
+        h.update(b'\0')
+    h.update(ir_text.encode('utf-8') if isinstance(ir_text, str) else ir_text)
+    return os.path.join(cache_dir, h.hexdigest() + '.spu')
+
+
+def _compile_to_executable(
+    ir_text: Union[str, bytes],
+    ir_type: str,
+    json_meta: str,
+    emit_bytecode: bool,
+) -> spu_pb2.ExecutableProto:
+    code, plan_str = _spu_compilation(
+        ir_text, ir_type, json_meta, emit_bytecode
+    )
+    executable = spu_pb2.ExecutableProto(code=code)
+    executable.memory_plan.ParseFromString(plan_str)
+    return executable
+
+
+def _cached_spu_compilation(
+    ir_text: Union[str, bytes],
+    ir_type: str,
+    json_meta: str,
+    emit_bytecode: bool,
+) -> spu_pb2.ExecutableProto:
+    cache_dir = os.getenv('SPU_COMPILE_CACHE_DIR')
+    # Dumps are only written by a real compilation.
+    if not cache_dir or os.getenv('SPU_IR_DUMP_DIR'):
+        return _compile_to_executable(
+            ir_text, ir_type, json_meta, emit_bytecode
+        )
+
+    path = _compilation_cache_path(
+        cache_dir, ir_text, ir_type, json_meta, emit_bytecode
+    )
+    executable = spu_pb2.ExecutableProto()
+    try:
+        with open(path, 'rb') as f:
+            executable.ParseFromString(f.read())
+        return executable
+    except (OSError, DecodeError):
+        pass
+
+    executable = _compile_to_executable(
+        ir_text, ir_type, json_meta, emit_bytecode
+    )
+
+    # Written to a temporary file then renamed, so concurrent processes never
+    # read a partial entry.
+    os.makedirs(cache_dir, exist_ok=True)
+    fd, tmp_path = tempfile.mkstemp(dir=cache_dir, suffix='.tmp')
+    try:
+        with os.fdopen(fd, 'wb') as f:
+            f.write(executable.SerializeToString())
+        os.replace(tmp_path, path)
+    except OSError:
+        if os.path.exists(tmp_path):
+            os.remove(tmp_path)
+    return executable
+
+
+def compile_with_memory_plan(
+    ir_text: str,
+    ir_type: str,
+    vis: List[spu_pb2.Visibility],
+    emit_bytecode: bool = False,
+) -> Tuple[str, spu_pb2.MemoryPlanProto]:
+    """Compile from textual HLO/MHLO IR to SPU bytecode and its memory plan.
 
     Args:
         ir_text (str): textual HLO/MHLO IR protobuf binary format.
         ir_type (str): "hlo" or "mhlo".
         vtype (Visibility): Visbilities .
+        emit_bytecode (bool): emit MLIR bytecode instead of text, which is
+            smaller and faster to load for models with large constants.
+
+    When SPU_COMPILE_CACHE_DIR is set, a compilation of the same IR,
+    visibilities and compiler version is loaded from that directory instead,
+    so processes share the results of each other.
 
     Returns:
-        [ValueProto]: output.
+        Tuple[str, MemoryPlanProto]: the bytecode and the static memory plan.
     """
     from google.protobuf.json_format import MessageToJson
 
     # todo: rename XlaMeta to IrMeta?
-    return _spu_compilation(
-        ir_text, ir_type, MessageToJson(spu_pb2.XlaMeta(inputs=vis))
+    executable = _cached_spu_compilation(
+        ir_text,
+        ir_type,
+        MessageToJson(spu_pb2.XlaMeta(inputs=vis)),
+        emit_bytecode,
     )
+    return executable.code, executable.memory_plan
+
+
+def compile(ir_text: str, ir_type: str, vis: List[spu_pb2.Visibility]) -> str:
+    """Compile from textual HLO/MHLO IR to SPU bytecode.
+
+    Args:
+        ir_text (str): textual HLO/MHLO IR protobuf binary format.
+        ir_type (str): "hlo" or "mhlo".
+        vtype (Visibility): Visbilities .
+
+    Returns:
+        [ValueProto]: output.
+    """
+    code, _ = compile_with_memory_plan(ir_text, ir_type, vis)
+    return code
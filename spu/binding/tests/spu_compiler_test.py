@@ -14,11 +14,14 @@
 
 
 import os
+import tempfile
 import unittest
+from unittest import mock
 
 import numpy as np
 import numpy.testing as npt
 
+import spu.binding.api as spu_api
 import spu.binding.util.frontend as spu_fe
 import spu.spu_pb2 as spu_pb2
 
@@ -43,6 +46,37 @@ class UnitTests(unittest.TestCase):
         self.assertIn("@main", ir)
         self.assertIn("pphlo", ir)
 
+    def test_compilation_cache(self):
+        def test(x):
+            return x + 1
+
+        def compile_test():
+            result, *_ = spu_fe.compile(
+                spu_fe.Kind.JAX,
+                test,
+                (np.ones((2, 2), dtype=np.float32),),
+                dict(),
+                ["in1"],
+                [spu_pb2.Visibility.VIS_SECRET],
+                lambda _: ["out1"],
+            )
+            return result
+
+        with tempfile.TemporaryDirectory() as cache_dir:
+            env = {'SPU_COMPILE_CACHE_DIR': cache_dir}
+            with mock.patch.dict(os.environ, env):
+                expected = compile_test()
+                self.assertEqual(len(os.listdir(cache_dir)), 1)
+
+                # a hit never reaches the compiler.
+                with mock.patch.object(
+                    spu_api, '_spu_compilation', side_effect=AssertionError
+                ):
+                    result = compile_test()
+                self.assertEqual(result.code, expected.code)
+                self.assertEqual(result.memory_plan, expected.memory_plan)
+                self.assertEqual(len(os.listdir(cache_dir)), 1)
+
 
 if __name__ == '__main__':
     unittest.main()
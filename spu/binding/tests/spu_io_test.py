@@ -12,7 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-
+import pickle
 import unittest
 
 import numpy as np
@@ -147,6 +147,41 @@ class UnitTests(parameterized.TestCase):
 
         npt.assert_almost_equal(x, y, decimal=5)
 
+    def test_io_raw(self, wsize, prot, field):
+        if prot == spu_pb2.ProtocolKind.ABY3 and wsize != 3:
+            return
+
+        config = spu_pb2.RuntimeConfig(protocol=prot, field=field, fxp_fraction_bits=18)
+        io = ppapi.Io(wsize, config)
+
+        # SINT
+        x = np.random.randint(10, size=(6, 7, 8))
+        x = x[0:5:2, 0:7:2, 0:8:2]
+
+        xs = io.make_raw_shares(x, spu_pb2.Visibility.VIS_SECRET)
+        self.assertEqual(len(xs), wsize)
+        self.assertEqual(xs[0].shape, [3, 4, 4])
+        npt.assert_equal(x, io.reconstruct(xs))
+
+        # pickled and serialized shares are the same values.
+        npt.assert_equal(x, io.reconstruct([pickle.loads(pickle.dumps(s)) for s in xs]))
+        protos = []
+        for s in xs:
+            proto = spu_pb2.ValueProto()
+            proto.ParseFromString(s.SerializeToString())
+            protos.append(proto)
+        npt.assert_equal(x, io.reconstruct(protos))
+
+        # shares in chunks of 7 bytes.
+        chunked = [ppapi.Share.FromChunks(*s.SerializeToChunks(7)) for s in xs]
+        npt.assert_equal(x, io.reconstruct(chunked))
+
+        # SFXP
+        x = np.random.rand(3, 4, 5)
+
+        xs = io.make_raw_shares(x, spu_pb2.Visibility.VIS_SECRET)
+        npt.assert_almost_equal(x, io.reconstruct(xs), decimal=5)
+
 
 if __name__ == '__main__':
     unittest.main()
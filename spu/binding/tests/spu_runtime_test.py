@@ -18,6 +18,7 @@ import unittest
 import numpy as np
 import numpy.testing as npt
 
+import spu.binding.api as ppapi
 import spu.spu_pb2 as spu_pb2
 from spu.binding.util.simulation import Simulator
 
@@ -47,6 +48,37 @@ func.func @main(%arg0: tensor<2x2x!pphlo.sec<i32>>) -> (tensor<2x2x!pphlo.sec<i3
         )
         sim(executable, x)
 
+    def test_simulate(self):
+        config = spu_pb2.RuntimeConfig(
+            protocol=spu_pb2.ProtocolKind.ABY3,
+            field=spu_pb2.FieldType.FM64,
+        )
+
+        x = np.random.randint(10, dtype=np.int32, size=(2, 2))
+        y = np.random.randint(10, dtype=np.int32, size=(2, 2))
+
+        code = """
+func.func @main(%arg0: tensor<2x2x!pphlo.sec<i32>>, %arg1: tensor<2x2x!pphlo.pub<i32>>) -> (tensor<2x2x!pphlo.sec<i32>>, tensor<2x2x!pphlo.pub<i32>>) {
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<2x2x!pphlo.sec<i32>>, tensor<2x2x!pphlo.pub<i32>>) -> tensor<2x2x!pphlo.sec<i32>>
+    return %0, %arg1 : tensor<2x2x!pphlo.sec<i32>>, tensor<2x2x!pphlo.pub<i32>>
+}"""
+        executable = spu_pb2.ExecutableProto(
+            name="test",
+            input_names=["in0", "in1"],
+            output_names=["out0", "out1"],
+            code=code.encode(),
+        )
+
+        z, w = ppapi.simulate(
+            3,
+            config,
+            executable,
+            [x, y.T.copy().T],
+            [spu_pb2.Visibility.VIS_SECRET, spu_pb2.Visibility.VIS_PUBLIC],
+        )
+        npt.assert_equal(z, x * y)
+        npt.assert_equal(w, y)
+
     def test_raise(self):
         wsize = 3
         config = spu_pb2.RuntimeConfig(
@@ -53,14 +53,20 @@ from termcolor import colored
 
 import spu.binding._lib.link as liblink
 import spu.binding.util.frontend as spu_fe
-from spu.binding.api import Io, Runtime, compile
-from spu.binding.util.distributed_pb2 import RunRequest, RunResponse
+from spu.binding.api import Io, Runtime, Share, compile
+from spu.binding.util.distributed_pb2 import (
+    FetchRequest,
+    FetchResponse,
+    RunRequest,
+    RunResponse,
+    ShareHeader,
+)
 from spu.binding.util.distributed_pb2_grpc import (
     NodeServiceServicer,
     NodeServiceStub,
     add_NodeServiceServicer_to_server,
 )
-from spu.spu_pb2 import ExecutableProto, RuntimeConfig, ValueProto
+from spu.spu_pb2 import ExecutableProto, RuntimeConfig
 
 """
 This module is used as a simple scheduler to demonstrate SPU usage.
@@ -181,6 +187,9 @@ class RPC:
         ('grpc.max_receive_message_length', 1024 * 1024 * 1024),
     ]
     CHUNK_SIZE = 10 * 1024 * 1024
+    # objects fetched concurrently by a node, chunks of each are streamed by
+    # grpc flow control, so a slow receiver throttles the sender.
+    MAX_INFLIGHT_FETCHES = 8
 
     @classmethod
     def makeStub(cls, addr):
@@ -256,11 +265,27 @@ class NodeClient:
         return self._call(self._stub.RunReturn, fn, *args, **kwargs)
 
     def get(self, ref: ObjectRef):
-        def builtin_fetch_object(server, refid: str):
-            return server._globals[ObjectRef(refid, server.node_id)]
+        """Fetch an object, shares are streamed in chunks without pickling."""
+        rsp_itr = iter(self._stub.Fetch(FetchRequest(ref_id=ref.uuid)))
+        first = next(rsp_itr)
+        if first.WhichOneof('payload') == 'share_header':
+            header = first.share_header
+            # the chunks are parsed natively as they arrive.
+            share = Share.FromChunks(
+                header.meta, [rsp.share_chunk for rsp in rsp_itr]
+            )
+            return ValueWrapper(
+                tuple(header.shape),
+                np.dtype(header.dtype),
+                header.visibility,
+                share,
+            )
 
-        # use uuid directly to prevent server fetch object ref.
-        return self._call(self._stub.RunReturn, builtin_fetch_object, ref.uuid)
+        rsp_data = first.data + rebuild_messages(rsp.data for rsp in rsp_itr)
+        result = pickle.loads(rsp_data)
+        if isinstance(result, Exception):
+            raise Exception("remote exception", result)
+        return result
 
     def save(self, refs: List[ObjectRef], filename: str):
         def builtin_save_object(server, ref_ids: List[str], filename: str):
@@ -300,12 +325,38 @@ class NodeServicer(NodeServiceServicer):
             node_id: NodeClient(node_id, addr) for node_id, addr in nodes_def.items()
         }
 
+    def Fetch(self, req, ctx):
+        try:
+            obj = self._globals[ObjectRef(req.ref_id, self.node_id)]
+        except Exception:
+            stack_info = traceback.format_exc()
+            logger.info(stack_info)
+            obj = Exception(stack_info)
+
+        if isinstance(obj, ValueWrapper):
+            meta, chunks = obj.share.SerializeToChunks(RPC.CHUNK_SIZE)
+            yield FetchResponse(
+                share_header=ShareHeader(
+                    shape=obj.shape,
+                    dtype=np.dtype(obj.dtype).str,
+                    visibility=obj.vtype,
+                    meta=meta,
+                )
+            )
+            for chunk in chunks:
+                yield FetchResponse(share_chunk=chunk)
+            return
+
+        for split in split_message(cloudpickle.dumps(obj)):
+            yield FetchResponse(data=split)
+
     def RunReturn(self, req_itr, ctx):
         payload = rebuild_messages(itr.data for itr in req_itr)
         # Warning: this is only a demo, do not use in production.
         (fn, args, kwargs) = pickle.loads(payload)
         logger.info(f"RunR: {fn.__name__} at {self.node_id}")
         try:
+            self._prefetch_objects((args, kwargs))
             args, kwargs = tree_map(lambda obj: self._get_object(obj), (args, kwargs))
             result = fn(self, *args, **kwargs)
             response = cloudpickle.dumps(result)
@@ -322,6 +373,7 @@ class NodeServicer(NodeServiceServicer):
         (fn, args, kwargs) = pickle.loads(payload)
         logger.info(f"Run : {fn.__name__} at {self.node_id}")
         try:
+            self._prefetch_objects((args, kwargs))
             args, kwargs = tree_map(lambda obj: self._get_object(obj), (args, kwargs))
             ret_objs = fn(self, *args, **kwargs)
             ret_refs = tree_map(lambda obj: self._add_object(obj), ret_objs)
@@ -333,6 +385,27 @@ class NodeServicer(NodeServiceServicer):
         for split in split_message(response):
             yield RunResponse(data=split)
 
+    def _prefetch_objects(self, tree):
+        """Fetch the remote objects of the tree concurrently."""
+        leaves, _ = tree_flatten(tree)
+        refs = {
+            leaf
+            for leaf in leaves
+            if isObjectRef(leaf) and leaf not in self._globals
+        }
+        if len(refs) < 2:
+            return
+
+        with concurrent.futures.ThreadPoolExecutor(
+            max_workers=min(len(refs), RPC.MAX_INFLIGHT_FETCHES)
+        ) as executor:
+            futures = {
+                ref: executor.submit(self._node_clients[ref.origin_nodeid].get, ref)
+                for ref in refs
+            }
+        for ref, future in futures.items():
+            self._globals[ref] = future.result()
+
     def _get_object(self, ref: Union[ObjectRef, Any]):
         """Get an object from the distributed context."""
         if not isObjectRef(ref):
@@ -517,13 +590,13 @@ class PYU(Device):
 
 
 class ValueWrapper:
-    """Workarounds for ValueProto could not be pickled."""
+    """A share with its meta, pickled in chunks by Share."""
 
-    def __init__(self, shape: Sequence[int], dtype: np.dtype, vtype, value_str: str):
+    def __init__(self, shape: Sequence[int], dtype: np.dtype, vtype, share: Share):
         self.shape = shape
         self.dtype = dtype
         self.vtype = vtype
-        self.value_str = value_str
+        self.share = share
 
     def __repr__(self):
         return f"ValueWrapper({self.shape},{self.dtype},{self.vtype})"
@@ -572,27 +645,25 @@ def builtin_spu_run(
     # do infeed.
     for idx, arg in enumerate(args_flat):
         if isinstance(arg, ValueWrapper):
-            v = ValueProto()
-            v.ParseFromString(arg.value_str)
-            rt.set_var(spu_exec.input_names[idx], v)
+            rt.set_var(spu_exec.input_names[idx], arg.share)
         else:
             arg = np.asarray(jax.numpy.asarray(arg))
-            fst, *_ = io.make_shares(arg, Visibility.VIS_PUBLIC)
+            fst, *_ = io.make_raw_shares(arg, Visibility.VIS_PUBLIC)
             rt.set_var(spu_exec.input_names[idx], fst)
 
     # run
     rt.run(spu_exec)
 
     # do outfeed
-    ret_protos = [rt.get_var(name) for name in spu_exec.output_names]
+    shares = [rt.get_share(name) for name in spu_exec.output_names]
     rets = [
         ValueWrapper(
-            shape_spu_to_np(proto.shape),
-            dtype_spu_to_np(proto.data_type),
-            proto.visibility,
-            proto.SerializeToString(),
+            tuple(share.shape),
+            dtype_spu_to_np(share.data_type),
+            share.visibility,
+            share,
         )
-        for proto in ret_protos
+        for share in shares
     ]
 
     # cleanup
@@ -961,13 +1032,8 @@ class SPU(Device):
 
     def get(self, obj: SPU.Object):
         value_wrappers = [nc.get(ref) for nc, ref in zip(self.node_clients, obj.refs)]
-        protos = []
-        for wrapper in value_wrappers:
-            proto = ValueProto()
-            proto.ParseFromString(wrapper.value_str)
-            protos.append(proto)
         io = Io(len(self.internal_addrs), self.runtime_config)
-        return io.reconstruct(protos)
+        return io.reconstruct([wrapper.share for wrapper in value_wrappers])
 
     def save(self, spu_objects: List[SPU.Object], filename: str):
         assert (
@@ -1195,13 +1261,7 @@ def SPU2PYU(to: PYU, obj: SPU.Object):
         spu_config.ParseFromString(spu_config_str)
         spu_io = Io(wsize, spu_config)
 
-        protos = []
-        for share in shares:
-            proto = ValueProto()
-            proto.ParseFromString(share.value_str)
-            protos.append(proto)
-
-        return spu_io.reconstruct(protos)
+        return spu_io.reconstruct([share.share for share in shares])
 
     return to(reconstruct)(
         len(obj.device.node_clients),
@@ -1230,11 +1290,8 @@ def PYU2SPU(to: SPU, obj: PYU.Object, vtype=Visibility.VIS_SECRET):
         else:
             raise Exception("unsupported frontend framework.")
 
-        shares = spu_io.make_shares(x, vtype, owner_rank)
-        return tuple(
-            ValueWrapper(x.shape, x.dtype, vtype, share.SerializeToString())
-            for share in shares
-        )
+        shares = spu_io.make_raw_shares(x, vtype, owner_rank)
+        return tuple(ValueWrapper(x.shape, x.dtype, vtype, share) for share in shares)
 
     owner_rank = -1
     for index, node_client in enumerate(to.node_clients):
@@ -160,6 +160,14 @@ class UnitTests(unittest.TestCase):
         self.assertTrue(u.device is ppd.current().devices["P3"])
         npt.assert_equal(ppd.get(u), np.array([3, 6]))
 
+    def test_spu_large_value(self):
+        # shares over RPC.CHUNK_SIZE are streamed in multiple chunks.
+        x = np.arange(2 * 1024 * 1024, dtype=np.float32)
+        a = ppd.device("P1")(lambda: x)()
+        b = ppd.device("SPU")(jnp.add)(a, a)
+        self.assertTrue(isinstance(b, ppd.SPU.Object))
+        npt.assert_almost_equal(ppd.get(b)[:16], x[:16] * 2)
+
     def test_basic_spu_jax(self):
         a = ppd.device("SPU")(no_in_one_out)()
         self.assertTrue(isinstance(a, ppd.SPU.Object))
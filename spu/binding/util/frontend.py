@@ -123,11 +123,12 @@ def compile(
     elif kind == Kind.Torch:
         ir_type = "mhlo"
         name = repr(fn)
-    mlir = spuapi.compile(ir_text, ir_type, input_vis)
+    mlir, memory_plan = spuapi.compile_with_memory_plan(ir_text, ir_type, input_vis)
     executable = spu_pb2.ExecutableProto(
         name=name,
         input_names=input_names,
         output_names=output_names,
         code=mlir,
+        memory_plan=memory_plan,
     )
     return executable, output
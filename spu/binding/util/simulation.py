@@ -22,7 +22,6 @@ from jax import linear_util as lu
 from jax._src import api_util as japi_util
 import numpy as np
 
-import spu.binding._lib.link as link
 import spu.binding.api as ppapi
 import spu.binding.util.frontend as spu_fe
 import spu.spu_pb2 as spu_pb2
@@ -48,7 +47,6 @@ class Simulator(object):
     def __init__(self, wsize: int, rt_config: spu_pb2.RuntimeConfig):
         self.wsize = wsize
         self.rt_config = rt_config
-        self.io = ppapi.Io(wsize, rt_config)
 
     @classmethod
     def simple(cls, wsize, prot, field):
@@ -62,45 +60,9 @@ class Simulator(object):
 
     def __call__(self, executable, *flat_args):
         flat_args = [np.array(jnp.array(x)) for x in flat_args]
-        params = [
-            self.io.make_shares(x, spu_pb2.Visibility.VIS_SECRET) for x in flat_args
-        ]
-
-        lctx_desc = link.Desc()
-        for rank in range(self.wsize):
-            lctx_desc.add_party(f"id_{rank}", f"thread_{rank}")
-
-        def wrapper(rank):
-            lctx = link.create_mem(lctx_desc, rank)
-            rank_config = spu_pb2.RuntimeConfig()
-            rank_config.CopyFrom(self.rt_config)
-            if rank != 0:
-                # rank_config.enable_pphlo_trace = False
-                rank_config.enable_action_trace = False
-                rank_config.enable_hal_profile = False
-                rank_config.enable_pphlo_profile = False
-            rt = ppapi.Runtime(lctx, rank_config)
-
-            # do infeed.
-            for idx, param in enumerate(params):
-                rt.set_var(executable.input_names[idx], param[rank])
-
-            # run
-            rt.run(executable)
-
-            # do outfeed
-            return [rt.get_var(name) for name in executable.output_names]
-
-        jobs = [
-            PropagatingThread(target=wrapper, args=(rank,))
-            for rank in range(self.wsize)
-        ]
-
-        [job.start() for job in jobs]
-        parties = [job.join() for job in jobs]
-
-        outputs = zip(*parties)
-        return [self.io.reconstruct(out) for out in outputs]
+        return ppapi.simulate(
+            self.wsize, self.rt_config, executable, flat_args
+        )
 
 
 def sim_jax(
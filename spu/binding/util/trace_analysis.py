@@ -0,0 +1,203 @@
+# Copyright 2022 Ant Group Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Merge the chrome traces of all parties and find the cross-party critical path.
+
+Every party dumps ``<path>.<rank>.json`` by RuntimeConfig.chrome_trace_dump_path,
+of timestamps aligned to the clock of rank 0. Communication actions are named
+``<op>:<tag>``, and all parties run the same program, so the i-th action of a
+tag on every party is one round of the same exchange. A round could not finish
+before its last party arrives, the straggler; the others idle from their own
+arrival until then, and the compute of the straggler since its previous round is
+on the critical path.
+
+Usage:
+    python -m spu.binding.util.trace_analysis trace.0.json trace.1.json \
+        --merged merged.json
+"""
+
+import argparse
+import collections
+import json
+from dataclasses import dataclass
+from typing import Dict, List, NamedTuple, Optional, Tuple
+
+COMM_CATEGORY = 'COMM'
+
+
+class Event(NamedTuple):
+    name: str
+    cat: str
+    pid: int
+    tid: int
+    # microseconds
+    ts: float
+    dur: float
+
+    @property
+    def end(self) -> float:
+        return self.ts + self.dur
+
+
+class Segment(NamedTuple):
+    """The compute of a straggler, from its previous round to its arrival."""
+
+    pid: int
+    op: str
+    begin: float
+    end: float
+
+
+@dataclass
+class OpStat:
+    # waiting for a straggler in the rounds of the op, microseconds.
+    idle_us: float = 0.0
+    # compute on the critical path, microseconds.
+    critical_us: float = 0.0
+
+
+class Report(NamedTuple):
+    # pid -> op -> stat
+    stats: Dict[int, Dict[str, OpStat]]
+    # segments of the critical path, in time order.
+    path: List[Segment]
+
+
+def load_trace(path: str) -> List[Event]:
+    with open(path) as f:
+        trace = json.load(f)
+    return [
+        Event(e['name'], e['cat'], e['pid'], e['tid'], e['ts'], e['dur'])
+        for e in trace['traceEvents']
+        if e.get('ph') == 'X'
+    ]
+
+
+def merge_traces(traces: List[List[Event]]) -> dict:
+    """Merge traces of all parties into one, which could be loaded by perfetto."""
+    return {
+        'traceEvents': [
+            {
+                'name': e.name,
+                'cat': e.cat,
+                'ph': 'X',
+                'ts': e.ts,
+                'dur': e.dur,
+                'pid': e.pid,
+                'tid': e.tid,
+            }
+            for events in traces
+            for e in events
+        ]
+    }
+
+
+def _tag_of(name: str) -> str:
+    return name.split(':', 1)[1] if ':' in name else name
+
+
+def _enclosing_op(ops: List[Event], ev: Event) -> str:
+    # the innermost op of the same thread, i.e. the latest started one which
+    # contains the event.
+    best: Optional[Event] = None
+    for op in ops:
+        if op.ts > ev.ts:
+            break
+        if op.tid == ev.tid and op.end >= ev.end:
+            best = op
+    return best.name if best is not None else '<top>'
+
+
+def analyze(events: List[Event]) -> Report:
+    by_pid: Dict[int, List[Event]] = collections.defaultdict(list)
+    for e in events:
+        by_pid[e.pid].append(e)
+
+    stats: Dict[int, Dict[str, OpStat]] = collections.defaultdict(
+        lambda: collections.defaultdict(OpStat)
+    )
+    # (tag, k) -> pid -> (event, op, end of the previous round of the party)
+    rounds: Dict[Tuple[str, int], Dict[int, Tuple[Event, str, float]]] = (
+        collections.defaultdict(dict)
+    )
+
+    for pid, pid_events in by_pid.items():
+        pid_events.sort(key=lambda e: e.ts)
+        ops = [e for e in pid_events if e.cat != COMM_CATEGORY]
+        prev_end = pid_events[0].ts
+        counts: Dict[str, int] = collections.Counter()
+        for e in pid_events:
+            if e.cat != COMM_CATEGORY:
+                continue
+            tag = _tag_of(e.name)
+            rounds[(tag, counts[tag])][pid] = (e, _enclosing_op(ops, e), prev_end)
+            counts[tag] += 1
+            prev_end = max(prev_end, e.end)
+
+    path: List[Segment] = []
+    for parties in rounds.values():
+        if len(parties) < 2:
+            continue
+        straggler = max(parties, key=lambda pid: parties[pid][0].ts)
+        arrival = parties[straggler][0].ts
+        for pid, (e, op, _) in parties.items():
+            stats[pid][op].idle_us += max(0.0, min(e.end, arrival) - e.ts)
+        _, op, prev_end = parties[straggler]
+        if arrival > prev_end:
+            stats[straggler][op].critical_us += arrival - prev_end
+            path.append(Segment(straggler, op, prev_end, arrival))
+
+    path.sort(key=lambda s: s.end)
+    return Report(stats, path)
+
+
+def format_report(report: Report, top: int = 10) -> str:
+    lines = []
+    for pid in sorted(report.stats):
+        ops = report.stats[pid]
+        idle = sum(s.idle_us for s in ops.values())
+        critical = sum(s.critical_us for s in ops.values())
+        lines.append(
+            f'party {pid}: idle {idle / 1e3:.3f}ms, '
+            f'on critical path {critical / 1e3:.3f}ms'
+        )
+        ranked = sorted(
+            ops.items(), key=lambda kv: kv[1].idle_us + kv[1].critical_us
+        )
+        for op, s in reversed(ranked[-top:]):
+            lines.append(
+                f'- {op}, idle {s.idle_us / 1e3:.3f}ms, '
+                f'critical {s.critical_us / 1e3:.3f}ms'
+            )
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('traces', nargs='+', help='trace of every party')
+    parser.add_argument('--merged', help='path to write the merged trace')
+    parser.add_argument('--top', type=int, default=10, help='ops per party')
+    args = parser.parse_args()
+
+    traces = [load_trace(path) for path in args.traces]
+    if args.merged:
+        with open(args.merged, 'w') as f:
+            json.dump(merge_traces(traces), f)
+    report = analyze([e for events in traces for e in events])
+    print(format_report(report, args.top))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,88 @@
+# Copyright 2022 Ant Group Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+
+import json
+import os
+import tempfile
+import unittest
+
+import spu.binding.util.trace_analysis as ta
+
+
+def _event(name, cat, pid, ts, dur, tid=0):
+    return {
+        'name': name,
+        'cat': cat,
+        'ph': 'X',
+        'ts': ts,
+        'dur': dur,
+        'pid': pid,
+        'tid': tid,
+    }
+
+
+class UnitTests(unittest.TestCase):
+    def setUp(self):
+        # party 0 is late for the first round, party 1 for the second.
+        self.traces = [
+            [
+                _event('mul', 'HAL', 0, 0, 100),
+                _event('rotate:mul', 'COMM', 0, 80, 20),
+                _event('dot', 'HAL', 0, 120, 130),
+                _event('rotate:mul', 'COMM', 0, 150, 100),
+            ],
+            [
+                _event('mul', 'HAL', 1, 0, 100),
+                _event('rotate:mul', 'COMM', 1, 10, 90),
+                _event('dot', 'HAL', 1, 120, 130),
+                _event('rotate:mul', 'COMM', 1, 200, 50),
+            ],
+        ]
+        self.dir = tempfile.TemporaryDirectory()
+        self.paths = []
+        for rank, events in enumerate(self.traces):
+            path = os.path.join(self.dir.name, f'trace.{rank}.json')
+            with open(path, 'w') as f:
+                json.dump({'traceEvents': events}, f)
+            self.paths.append(path)
+
+    def tearDown(self):
+        self.dir.cleanup()
+
+    def test_analyze(self):
+        events = [e for path in self.paths for e in ta.load_trace(path)]
+        report = ta.analyze(events)
+
+        self.assertEqual(report.stats[1]['mul'].idle_us, 70)
+        self.assertEqual(report.stats[0]['mul'].idle_us, 0)
+        self.assertEqual(report.stats[0]['dot'].idle_us, 50)
+        self.assertEqual(report.stats[0]['mul'].critical_us, 80)
+        # party 1 computes from the end of its first round at 100.
+        self.assertEqual(report.stats[1]['dot'].critical_us, 100)
+        self.assertEqual(
+            report.path,
+            [ta.Segment(0, 'mul', 0, 80), ta.Segment(1, 'dot', 100, 200)],
+        )
+        self.assertIn('party 1: idle 0.070ms', ta.format_report(report))
+
+    def test_merge(self):
+        merged = ta.merge_traces([ta.load_trace(path) for path in self.paths])
+        self.assertEqual(len(merged['traceEvents']), 8)
+        self.assertEqual({e['pid'] for e in merged['traceEvents']}, {0, 1})
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -17,13 +17,21 @@
 #include <string>
 
 #include "llvm/Support/raw_os_ostream.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
 
 namespace spu::compiler {
 
-std::string CodeGen::doit(mlir::ModuleOp module) {
+std::string CodeGen::doit(mlir::ModuleOp module, bool emit_bytecode,
+                          bool emit_locations) {
   std::string ir_dump;
   llvm::raw_string_ostream stream(ir_dump);
-  module.print(stream);
+  if (emit_bytecode) {
+    mlir::writeBytecodeToFile(module, stream);
+  } else if (emit_locations) {
+    module.print(stream, mlir::OpPrintingFlags().enableDebugInfo());
+  } else {
+    module.print(stream);
+  }
 
   return stream.str();
 }
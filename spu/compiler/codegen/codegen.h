@@ -24,7 +24,13 @@ namespace spu::compiler {
 
 class CodeGen final {
 public:
-  std::string doit(mlir::ModuleOp module);
+  /// Print the module as text, or as MLIR bytecode if `emit_bytecode`.
+  ///
+  /// Bytecode keeps dense constants as raw buffers, so it is much smaller and
+  /// faster to load than text for modules with large constants. The runtime
+  /// accepts both. Text keeps op locations only if `emit_locations`.
+  std::string doit(mlir::ModuleOp module, bool emit_bytecode = false,
+                   bool emit_locations = false);
 };
 
 } // namespace spu::compiler
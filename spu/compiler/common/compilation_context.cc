@@ -30,16 +30,36 @@ void SPUErrorHandler(void * /*use_data*/, const char *reason,
 
 namespace spu::compiler {
 
-CompilationContext::CompilationContext() {
+CompilationContext::CompilationContext()
+    : context_(mlir::MLIRContext::Threading::DISABLED) {
   // Set an error handler
   llvm::remove_fatal_error_handler();
   llvm::install_fatal_error_handler(SPUErrorHandler);
+
+  setNumThreads(0);
 }
 
 CompilationContext::~CompilationContext() {
   llvm::remove_fatal_error_handler();
 }
 
+void CompilationContext::setNumThreads(unsigned num_threads) {
+  if (num_threads == 1) {
+    context_.disableMultithreading();
+    return;
+  }
+  // The pass manager runs a nested pipeline of every function on the pool of
+  // the context, so large modules of many functions, e.g. the outlined
+  // regions of jax, are optimized in parallel.
+  auto strategy = num_threads == 0
+                      ? llvm::hardware_concurrency()
+                      : llvm::hardware_concurrency(num_threads);
+  // a pool is only attached to a context of multithreading disabled
+  context_.disableMultithreading();
+  thread_pool_ = std::make_unique<llvm::ThreadPool>(strategy);
+  context_.setThreadPool(*thread_pool_);
+}
+
 std::unique_ptr<mlir::PassManager::IRPrinterConfig>
 CompilationContext::getIRPrinterConfig() const {
   if (pp_config_ == nullptr) {
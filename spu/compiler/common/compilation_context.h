@@ -16,12 +16,19 @@
 
 #include <filesystem>
 #include <memory>
+#include <set>
 #include <string>
 #include <string_view>
+#include <utility>
 
+#include "llvm/Support/ThreadPool.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/PassManager.h"
 
+#include "spu/compiler/common/profile_guide.h"
+
+#include "spu/spu.pb.h"
+
 namespace mlir {
 class PassManager;
 }
@@ -36,6 +43,10 @@ public:
 
   mlir::MLIRContext *getMLIRContext() { return &context_; }
 
+  /// Run function level passes of nested pipelines on this many threads, 0
+  /// for the hardware concurrency, 1 to disable multithreading
+  void setNumThreads(unsigned num_threads);
+
   /// Enable pretty print and set folder
   /// If dir does not exist, this api will create new folder
   void enablePrettyPrintWithDir(std::string_view dir);
@@ -51,14 +62,58 @@ public:
 
   std::filesystem::path getPrettyPrintDir() const;
 
+  /// The static memory plan of the last compiled module
+  void setMemoryPlan(MemoryPlanProto plan) { memory_plan_ = std::move(plan); }
+
+  const MemoryPlanProto &getMemoryPlan() const { return memory_plan_; }
+
+  /// Emit MLIR bytecode instead of text, see CodeGen
+  void setEmitBytecode(bool emit_bytecode) { emit_bytecode_ = emit_bytecode; }
+
+  bool getEmitBytecode() const { return emit_bytecode_; }
+
+  /// Print op locations in emitted text, so runtime profiles could refer to
+  /// op sites, bytecode always keeps them
+  void setEmitLocations(bool emit_locations) {
+    emit_locations_ = emit_locations;
+  }
+
+  bool getEmitLocations() const { return emit_locations_; }
+
+  /// Skip an optional optimization pass, e.g. to record the variant profile
+  /// of it, see ProfileGuide
+  void disablePass(const std::string &name) { disabled_passes_.insert(name); }
+
+  bool isPassDisabled(const std::string &name) const {
+    return disabled_passes_.count(name) > 0;
+  }
+
+  /// Runtime profiles to choose lowerings per op site
+  ProfileGuide &getProfileGuide() { return profile_guide_; }
+
+  const ProfileGuide &getProfileGuide() const { return profile_guide_; }
+
 private:
   std::unique_ptr<mlir::PassManager::IRPrinterConfig>
   getIRPrinterConfig() const;
 
+  // declared before the context, which refers to it until destroyed
+  std::unique_ptr<llvm::ThreadPool> thread_pool_;
+
   mlir::MLIRContext context_;
   std::unique_ptr<mlir::PassManager::IRPrinterConfig> pp_config_;
 
   std::string input_vis_;
+
+  MemoryPlanProto memory_plan_;
+
+  bool emit_bytecode_ = false;
+
+  bool emit_locations_ = false;
+
+  std::set<std::string> disabled_passes_;
+
+  ProfileGuide profile_guide_;
 };
 
 } // namespace spu::compiler
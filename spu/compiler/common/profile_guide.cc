@@ -0,0 +1,89 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/compiler/common/profile_guide.h"
+
+#include <optional>
+#include <set>
+
+#include "llvm/Support/raw_ostream.h"
+
+namespace spu::compiler {
+namespace {
+
+std::string printLocation(mlir::Location loc) {
+  std::string buf;
+  llvm::raw_string_ostream os(buf);
+  loc.print(os);
+  os.flush();
+  return buf;
+}
+
+} // namespace
+
+ProfileGuide::Costs ProfileGuide::collect(
+    const ExecutionProfileProto &profile) {
+  Costs costs;
+  for (const auto &op : profile.ops()) {
+    costs[op.location()] += op.time_ns();
+  }
+  return costs;
+}
+
+void ProfileGuide::setBaseline(const ExecutionProfileProto &profile) {
+  baseline_ = collect(profile);
+}
+
+void ProfileGuide::addVariant(const std::string &pass,
+                              const ExecutionProfileProto &profile) {
+  variants_[pass] = collect(profile);
+}
+
+bool ProfileGuide::shouldRewrite(const std::string &pass,
+                                 llvm::ArrayRef<mlir::Location> site) const {
+  auto variant = variants_.find(pass);
+  if (variant == variants_.end() || site.empty()) {
+    return true;
+  }
+
+  // a location may be shared by several ops of the site.
+  std::set<std::string> locations;
+  for (auto loc : site) {
+    if (loc.isa<mlir::UnknownLoc>()) {
+      return true;
+    }
+    locations.insert(printLocation(loc));
+  }
+
+  auto sum = [&](const Costs &costs) -> std::optional<uint64_t> {
+    uint64_t total = 0;
+    for (const auto &loc : locations) {
+      auto itr = costs.find(loc);
+      if (itr == costs.end()) {
+        return std::nullopt;
+      }
+      total += itr->second;
+    }
+    return total;
+  };
+
+  const auto with_rewrite = sum(baseline_);
+  const auto without_rewrite = sum(variant->second);
+  if (!with_rewrite.has_value() || !without_rewrite.has_value()) {
+    return true;
+  }
+  return *with_rewrite <= *without_rewrite;
+}
+
+} // namespace spu::compiler
@@ -0,0 +1,63 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "mlir/IR/Location.h"
+
+#include "spu/spu.pb.h"
+
+namespace spu::compiler {
+
+/// Picks between lowerings of an op site with recorded runtime profiles, see
+/// `RuntimeConfig.pphlo_profile_dump_path`.
+///
+/// The baseline profile is of the module compiled with all rewrites, and a
+/// variant profile of a pass is of the same module compiled with the pass
+/// disabled, both with locations emitted. Rewritten ops keep the locations of
+/// the ops they replace, so the costs of a site in both profiles are the
+/// costs of the ops at its locations.
+class ProfileGuide {
+  // total time in nanoseconds by printed location.
+  using Costs = std::map<std::string, uint64_t>;
+
+  Costs baseline_;
+  std::map<std::string, Costs> variants_;
+
+  static Costs collect(const ExecutionProfileProto &profile);
+
+public:
+  void setBaseline(const ExecutionProfileProto &profile);
+
+  /// Add the profile of the module compiled without `pass`.
+  void addVariant(const std::string &pass,
+                  const ExecutionProfileProto &profile);
+
+  bool hasVariant(const std::string &pass) const {
+    return variants_.count(pass) > 0;
+  }
+
+  /// Return true if the rewrite of `pass` should apply to the site of ops at
+  /// `site`, i.e. unless the site ran faster without it. Sites with unknown
+  /// locations, or not found in both profiles, are rewritten.
+  bool shouldRewrite(const std::string &pass,
+                     llvm::ArrayRef<mlir::Location> site) const;
+};
+
+} // namespace spu::compiler
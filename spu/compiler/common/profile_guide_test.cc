@@ -0,0 +1,107 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/compiler/common/profile_guide.h"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "yacl/base/exception.h"
+
+#include "spu/compiler/passes/passes.h"
+#include "spu/dialect/pphlo_dialect.h"
+#include "spu/dialect/pphlo_ops.h"
+
+namespace spu::compiler {
+namespace {
+
+ExecutionProfileProto makeProfile(
+    const std::vector<std::pair<std::string, uint64_t>> &costs) {
+  ExecutionProfileProto profile;
+  for (const auto &[name, time_ns] : costs) {
+    auto *op = profile.add_ops();
+    op->set_location(fmt::format("loc(\"{}\")", name));
+    op->set_count(1);
+    op->set_time_ns(time_ns);
+  }
+  return profile;
+}
+
+TEST(ProfileGuideTest, ShouldRewrite) {
+  mlir::MLIRContext ctx;
+  auto loc = [&](llvm::StringRef name) -> mlir::Location {
+    return mlir::NameLoc::get(mlir::StringAttr::get(&ctx, name));
+  };
+
+  ProfileGuide guide;
+  guide.setBaseline(makeProfile({{"a", 100}, {"b", 50}}));
+  guide.addVariant("pass", makeProfile({{"a", 60}, {"b", 60}}));
+
+  EXPECT_FALSE(guide.shouldRewrite("pass", {loc("a"), loc("b")}));
+  EXPECT_FALSE(guide.shouldRewrite("pass", {loc("a")}));
+  EXPECT_TRUE(guide.shouldRewrite("pass", {loc("b")}));
+
+  // not profiled.
+  EXPECT_TRUE(guide.shouldRewrite("pass", {loc("a"), loc("c")}));
+  EXPECT_TRUE(guide.shouldRewrite("pass", {mlir::UnknownLoc::get(&ctx)}));
+  EXPECT_TRUE(guide.shouldRewrite("other", {loc("a")}));
+}
+
+// Number of prefer_a ops after optimize-select with the guide.
+size_t countPreferA(const ProfileGuide &guide) {
+  mlir::MLIRContext ctx;
+  ctx.loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
+  auto module = mlir::parseSourceString<mlir::ModuleOp>(R"(
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) {
+  %0 = "pphlo.less"(%arg0, %arg1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<i1>> loc("less")
+  %1 = "pphlo.select"(%0, %arg0, %arg1) : (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>> loc("select.1")
+  %2 = "pphlo.select"(%0, %arg1, %arg0) : (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>> loc("select.2")
+  return %1, %2 : tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>
+})",
+                                                        &ctx);
+  YACL_ENFORCE(module, "invalid module");
+
+  mlir::PassManager pm(&ctx);
+  pm.nest<mlir::func::FuncOp>().addPass(mlir::pphlo::createOptimizeSelectPass(
+      [&](llvm::ArrayRef<mlir::Location> site) {
+        return guide.shouldRewrite("optimize-select", site);
+      }));
+  YACL_ENFORCE(pm.run(*module).succeeded());
+
+  size_t count = 0;
+  module->walk([&](mlir::pphlo::PreferAOp) { count++; });
+  return count;
+}
+
+TEST(ProfileGuideTest, OptimizeSelect) {
+  ProfileGuide guide;
+  guide.setBaseline(
+      makeProfile({{"less", 100}, {"select.1", 20}, {"select.2", 20}}));
+
+  // the prefer_a of the baseline is counted at the location of less.
+  auto slower = makeProfile({{"less", 80}, {"select.1", 50}, {"select.2", 50}});
+  guide.addVariant("optimize-select", slower);
+  EXPECT_EQ(countPreferA(guide), 1U);
+
+  auto faster = makeProfile({{"less", 80}, {"select.1", 25}, {"select.2", 25}});
+  guide.addVariant("optimize-select", faster);
+  EXPECT_EQ(countPreferA(guide), 0U);
+}
+
+} // namespace
+} // namespace spu::compiler
@@ -24,7 +24,9 @@
 #include "yacl/base/exception.h"
 
 #include "spu/compiler/codegen/codegen.h"
+#include "spu/compiler/common/compilation_context.h"
 #include "spu/compiler/core/core.h"
+#include "spu/compiler/core/memory_planner.h"
 #include "spu/compiler/front_end/fe.h"
 
 namespace spu::compiler {
@@ -39,10 +41,15 @@ std::string compile(CompilationContext *ctx, const std::string &serialized_ir,
   Core core(ctx);
   core.doit(mlir_module.get());
 
+  // Plan memory of the lowered module
+  MemoryPlanner planner;
+  ctx->setMemoryPlan(planner.doit(mlir_module.get()));
+
   // Run codegen
   CodeGen codegen;
 
-  return codegen.doit(mlir_module.get());
+  return codegen.doit(mlir_module.get(), ctx->getEmitBytecode(),
+                      ctx->getEmitLocations());
 }
 
 std::string compile(CompilationContext *ctx,
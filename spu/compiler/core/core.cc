@@ -41,12 +41,38 @@ void Core::doit(mlir::ModuleOp module) {
   }
 }
 
+namespace {
+
+// Rewrite the sites of `pass` unless they ran faster without it.
+mlir::pphlo::SiteFilter makeSiteFilter(const CompilationContext *ctx,
+                                       const std::string &pass) {
+  const auto &guide = ctx->getProfileGuide();
+  if (!guide.hasVariant(pass)) {
+    return nullptr;
+  }
+  return [&guide, pass](llvm::ArrayRef<mlir::Location> site) {
+    return guide.shouldRewrite(pass, site);
+  };
+}
+
+} // namespace
+
 void Core::buildPipeline(mlir::PassManager *pm) {
   // lowering
   auto &optPM = pm->nest<mlir::func::FuncOp>();
-  optPM.addPass(mlir::pphlo::createOptimizeMaxPoolingPass());
+  optPM.addPass(mlir::pphlo::createInlineSecretIfPass());
+  // Before unrolling, so invariants are not unrolled
+  optPM.addPass(mlir::pphlo::createHoistLoopInvariantPass());
+  optPM.addPass(mlir::pphlo::createUnrollWhilePass());
+  if (!ctx_->isPassDisabled("optimize-maxpool")) {
+    optPM.addPass(mlir::pphlo::createOptimizeMaxPoolingPass(
+        makeSiteFilter(ctx_, "optimize-maxpool")));
+  }
+  optPM.addPass(mlir::pphlo::createOptimizeTopKPass());
+  optPM.addPass(mlir::pphlo::createOptimizeNormalizationPass());
   optPM.addPass(mlir::pphlo::createDecomposeComparisonPass());
   optPM.addPass(mlir::pphlo::createDecomposeMinMaxPass());
+  optPM.addPass(mlir::pphlo::createFoldPublicConstantPass());
 
   optPM.addPass(mlir::createCSEPass());
 
@@ -55,9 +81,22 @@ void Core::buildPipeline(mlir::PassManager *pm) {
 
   optPM.addPass(mlir::createCanonicalizerPass());
 
-  optPM.addPass(mlir::pphlo::createOptimizeSelectPass());
+  // After the canonicalizer, which puts batched dots in (b, m, k) x (b, k, n)
+  if (!ctx_->isPassDisabled("optimize-dot")) {
+    optPM.addPass(mlir::pphlo::createOptimizeDotPass());
+  }
+
+  if (!ctx_->isPassDisabled("optimize-select")) {
+    optPM.addPass(mlir::pphlo::createOptimizeSelectPass(
+        makeSiteFilter(ctx_, "optimize-select")));
+  }
+
+  optPM.addPass(mlir::pphlo::createVectorizeElementwisePass());
 
   optPM.addPass(mlir::createCSEPass());
+
+  // Last, after all rewrites, since it depends on users of ops.
+  optPM.addPass(mlir::pphlo::createLazyTruncationPass());
 }
 
 } // namespace spu::compiler
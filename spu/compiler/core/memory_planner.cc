@@ -0,0 +1,159 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/compiler/core/memory_planner.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "yacl/base/exception.h"
+
+#include "spu/dialect/pphlo_types.h"
+
+namespace spu::compiler {
+namespace {
+
+using Buffer = MemoryPlanProto::Buffer;
+
+// Place buffers of one visibility, greedy by size, each buffer takes the
+// lowest gap large enough among placed buffers overlapped in time.
+int64_t placeBuffers(std::vector<Buffer *> buffers) {
+  std::stable_sort(buffers.begin(), buffers.end(),
+                   [](const Buffer *lhs, const Buffer *rhs) {
+                     return lhs->numel() > rhs->numel();
+                   });
+
+  int64_t slab_numel = 0;
+  std::vector<const Buffer *> placed;
+  std::vector<const Buffer *> conflicts;
+  for (auto *buf : buffers) {
+    conflicts.clear();
+    for (const auto *other : placed) {
+      if (other->first_step() <= buf->last_step() &&
+          buf->first_step() <= other->last_step()) {
+        conflicts.push_back(other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const Buffer *lhs, const Buffer *rhs) {
+                return lhs->offset() < rhs->offset();
+              });
+
+    int64_t offset = 0;
+    for (const auto *other : conflicts) {
+      if (other->offset() >= offset + buf->numel()) {
+        break;
+      }
+      offset = std::max(offset, other->offset() + other->numel());
+    }
+
+    buf->set_offset(offset);
+    slab_numel = std::max(slab_numel, offset + buf->numel());
+    placed.push_back(buf);
+  }
+  return slab_numel;
+}
+
+int64_t peakNumel(const std::vector<Buffer *> &buffers, int64_t num_steps) {
+  std::vector<int64_t> delta(num_steps + 1, 0);
+  for (const auto *buf : buffers) {
+    delta[buf->first_step()] += buf->numel();
+    delta[buf->last_step() + 1] -= buf->numel();
+  }
+  int64_t live = 0;
+  int64_t peak = 0;
+  for (const auto d : delta) {
+    live += d;
+    peak = std::max(peak, live);
+  }
+  return peak;
+}
+
+} // namespace
+
+MemoryPlanProto MemoryPlanner::doit(mlir::ModuleOp module) {
+  auto entry = module.lookupSymbol<mlir::func::FuncOp>("main");
+  YACL_ENFORCE(entry, "main function not found");
+
+  MemoryPlanProto plan;
+  auto &block = entry.getBody().front();
+
+  int64_t num_steps = 0;
+  llvm::DenseMap<mlir::Operation *, int64_t> op_step;
+  for (auto &op : block.without_terminator()) {
+    op_step[&op] = num_steps++;
+  }
+  plan.set_num_steps(num_steps);
+
+  mlir::pphlo::TypeTools tools;
+  auto visit_value = [&](mlir::Value value, int64_t op_index,
+                         int64_t result_index) {
+    auto type = value.getType().dyn_cast<mlir::RankedTensorType>();
+    if (!type || !type.hasStaticShape()) {
+      return;
+    }
+
+    const int64_t first = std::max<int64_t>(op_index, 0);
+    int64_t last = first;
+    for (auto *user : value.getUsers()) {
+      auto *ancestor = block.findAncestorOpInBlock(*user);
+      auto itr = ancestor == nullptr ? op_step.end() : op_step.find(ancestor);
+      if (itr == op_step.end()) {
+        // used by the terminator, live till the end.
+        last = std::max<int64_t>(num_steps - 1, first);
+        break;
+      }
+      last = std::max(last, itr->second);
+    }
+
+    auto *buf = plan.add_buffers();
+    buf->set_op_index(op_index);
+    buf->set_result_index(result_index);
+    buf->set_visibility(tools.isMPCType<mlir::pphlo::PublicType>(type)
+                            ? VIS_PUBLIC
+                            : VIS_SECRET);
+    buf->set_numel(type.getNumElements());
+    buf->set_first_step(first);
+    buf->set_last_step(last);
+  };
+
+  for (auto arg : block.getArguments()) {
+    visit_value(arg, -1, arg.getArgNumber());
+  }
+  for (auto &op : block.without_terminator()) {
+    for (auto result : op.getResults()) {
+      visit_value(result, op_step.lookup(&op), result.getResultNumber());
+    }
+  }
+
+  std::vector<Buffer *> secrets;
+  std::vector<Buffer *> publics;
+  for (auto &buf : *plan.mutable_buffers()) {
+    (buf.visibility() == VIS_PUBLIC ? publics : secrets).push_back(&buf);
+  }
+
+  // an empty block still holds its arguments at step 0.
+  const int64_t sweep_steps = std::max<int64_t>(num_steps, 1);
+  plan.set_secret_slab_numel(placeBuffers(secrets));
+  plan.set_public_slab_numel(placeBuffers(publics));
+  plan.set_peak_secret_numel(peakNumel(secrets, sweep_steps));
+  plan.set_peak_public_numel(peakNumel(publics, sweep_steps));
+
+  return plan;
+}
+
+} // namespace spu::compiler
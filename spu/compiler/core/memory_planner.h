@@ -0,0 +1,41 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "spu/spu.pb.h"
+
+namespace mlir {
+
+class ModuleOp;
+
+} // namespace mlir
+
+namespace spu::compiler {
+
+/// Compute the static memory plan of the entry function of a lowered module.
+///
+/// Lifetimes follow the sequential schedule of the runtime, a value dies
+/// after the last op using it, uses inside nested regions count as uses of
+/// their top level op, values returned are live till the end. Values with
+/// disjoint lifetimes share the same range of the slab.
+///
+/// Only values of the top level block are planned, temporaries of kernels and
+/// of nested regions are not.
+class MemoryPlanner final {
+public:
+  MemoryPlanProto doit(mlir::ModuleOp module);
+};
+
+} // namespace spu::compiler
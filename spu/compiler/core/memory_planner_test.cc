@@ -0,0 +1,76 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/compiler/core/memory_planner.h"
+
+#include "gtest/gtest.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Parser/Parser.h"
+
+#include "spu/dialect/pphlo_dialect.h"
+
+namespace spu::compiler {
+
+TEST(MemoryPlannerTest, Basic) {
+  mlir::MLIRContext ctx;
+  ctx.loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
+
+  auto module = mlir::parseSourceString<mlir::ModuleOp>(R"(
+func.func @main(%arg0: tensor<4x!pphlo.sec<i32>>, %arg1: tensor<4x!pphlo.sec<i32>>, %arg2: tensor<2x!pphlo.pub<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  %1 = "pphlo.add"(%0, %arg0) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  %2 = "pphlo.add"(%1, %1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  %3 = "pphlo.add"(%2, %2) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  return %3 : tensor<4x!pphlo.sec<i32>>
+})",
+                                                        &ctx);
+  ASSERT_TRUE(module);
+
+  MemoryPlanner planner;
+  const auto plan = planner.doit(module.get());
+
+  EXPECT_EQ(plan.num_steps(), 4);
+  ASSERT_EQ(plan.buffers_size(), 7);
+
+  // lifetimes, in order of arguments then results.
+  const std::vector<std::pair<int64_t, int64_t>> lifetimes = {
+      {0, 1}, {0, 0}, {0, 0}, {0, 1}, {1, 2}, {2, 3}, {3, 3}};
+  for (int idx = 0; idx < plan.buffers_size(); idx++) {
+    EXPECT_EQ(plan.buffers(idx).first_step(), lifetimes[idx].first) << idx;
+    EXPECT_EQ(plan.buffers(idx).last_step(), lifetimes[idx].second) << idx;
+  }
+  EXPECT_EQ(plan.buffers(2).visibility(), VIS_PUBLIC);
+  EXPECT_EQ(plan.buffers(3).visibility(), VIS_SECRET);
+
+  // buffers overlapped in time never overlap in the slab.
+  for (const auto &lhs : plan.buffers()) {
+    for (const auto &rhs : plan.buffers()) {
+      if (&lhs == &rhs || lhs.visibility() != rhs.visibility() ||
+          lhs.last_step() < rhs.first_step() ||
+          rhs.last_step() < lhs.first_step()) {
+        continue;
+      }
+      EXPECT_TRUE(lhs.offset() + lhs.numel() <= rhs.offset() ||
+                  rhs.offset() + rhs.numel() <= lhs.offset());
+    }
+  }
+
+  EXPECT_EQ(plan.peak_secret_numel(), 12);
+  EXPECT_EQ(plan.secret_slab_numel(), 12);
+  EXPECT_EQ(plan.peak_public_numel(), 2);
+  EXPECT_EQ(plan.public_slab_numel(), 2);
+}
+
+} // namespace spu::compiler
@@ -29,8 +29,10 @@
 #include "tensorflow/compiler/xla/service/dot_decomposer.h"
 #include "tensorflow/compiler/xla/service/dot_merger.h"
 #include "tensorflow/compiler/xla/service/gather_expander.h"
+#include "tensorflow/compiler/xla/service/hlo_casting_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
+#include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_module_config.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
@@ -55,6 +57,73 @@
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 
 namespace xla {
+namespace {
+
+// Scatters of one add update computation, indexed along the only inserted
+// window dim, are lowered to pphlo.scatter_add, which adds all updates at once
+// instead of a while loop of dynamic-update-slices.
+bool isNativeScatter(const HloInstruction *inst) {
+  const auto *scatter = Cast<HloScatterInstruction>(inst);
+  if (scatter->scatter_operand_count() != 1) {
+    return false;
+  }
+
+  const HloInstruction *root = scatter->to_apply()->root_instruction();
+  if (root->opcode() != HloOpcode::kAdd ||
+      root->operand(0)->opcode() != HloOpcode::kParameter ||
+      root->operand(1)->opcode() != HloOpcode::kParameter ||
+      root->operand(0) == root->operand(1)) {
+    return false;
+  }
+
+  const Shape &operand_shape = scatter->scatter_operands()[0]->shape();
+  const Shape &indices_shape = scatter->scatter_indices()->shape();
+  const Shape &updates_shape = scatter->scatter_updates()[0]->shape();
+  if (operand_shape.element_type() == PRED) {
+    return false;
+  }
+
+  const auto &dnums = scatter->scatter_dimension_numbers();
+  if (dnums.scatter_dims_to_operand_dims_size() != 1 ||
+      dnums.inserted_window_dims_size() != 1 ||
+      dnums.inserted_window_dims(0) != dnums.scatter_dims_to_operand_dims(0)) {
+    return false;
+  }
+  if (dnums.index_vector_dim() < indices_shape.rank() &&
+      indices_shape.dimensions(dnums.index_vector_dim()) != 1) {
+    return false;
+  }
+
+  // Every update is a full slice of the other dims.
+  if (dnums.update_window_dims_size() != operand_shape.rank() - 1) {
+    return false;
+  }
+  int64_t window = 0;
+  for (int64_t dim = 0; dim < operand_shape.rank(); ++dim) {
+    if (dim == dnums.inserted_window_dims(0)) {
+      continue;
+    }
+    if (updates_shape.dimensions(dnums.update_window_dims(window++)) !=
+        operand_shape.dimensions(dim)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class SpuScatterExpander : public ScatterExpander {
+public:
+  SpuScatterExpander() : ScatterExpander(kEliminateAllScatters) {}
+
+protected:
+  bool InstructionMatchesPattern(HloInstruction *inst) override {
+    return ScatterExpander::InstructionMatchesPattern(inst) &&
+           !isNativeScatter(inst);
+  }
+};
+
+} // namespace
+
 void runHloPasses(xla::HloModule *module) {
   HloPassPipeline pipeline("HLO passes");
   pipeline.AddInvariantChecker<HloVerifier>(/*layout_sensitive=*/false,
@@ -97,7 +166,7 @@ void runHloPasses(xla::HloModule *module) {
       /*rewrite_training_op=*/true,
       /*rewrite_inference_op=*/true,
       /*rewrite_grad_op=*/true);
-  pipeline.AddPass<ScatterExpander>(ScatterExpander::kEliminateAllScatters);
+  pipeline.AddPass<SpuScatterExpander>();
 
   // Run the following passes to a fixed point.
   [&pipeline =
@@ -17,6 +17,7 @@
 #include <iostream>
 
 #include "llvm/Support/CommandLine.h"
+#include "yacl/base/exception.h"
 
 #include "spu/compiler/common/compilation_context.h"
 #include "spu/compiler/compile.h"
@@ -37,6 +38,38 @@ llvm::cl::opt<std::string>
     InputVisibility("invis", llvm::cl::desc("Inputs visibility"),
                     llvm::cl::value_desc("input visibility"));
 
+llvm::cl::opt<bool>
+    EmitLocations("emit-locations",
+                  llvm::cl::desc("Emit op locations, to profile op sites"),
+                  llvm::cl::init(false));
+
+llvm::cl::list<std::string>
+    DisablePasses("disable-pass",
+                  llvm::cl::desc("Skip an optimization pass, e.g. "
+                                 "optimize-maxpool, optimize-dot or "
+                                 "optimize-select"),
+                  llvm::cl::value_desc("pass"));
+
+llvm::cl::opt<std::string>
+    BaselineProfile("profile",
+                    llvm::cl::desc("Runtime profile of the module compiled "
+                                   "with all optimizations"),
+                    llvm::cl::value_desc("filename"));
+
+llvm::cl::list<std::string> VariantProfiles(
+    "variant-profile",
+    llvm::cl::desc("Runtime profile of the module compiled with a pass "
+                   "disabled, as <pass>=<filename>"),
+    llvm::cl::value_desc("pass=filename"));
+
+spu::ExecutionProfileProto loadProfile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  YACL_ENFORCE(in, "can not open {}", path);
+  spu::ExecutionProfileProto profile;
+  YACL_ENFORCE(profile.ParseFromIstream(&in), "invalid profile {}", path);
+  return profile;
+}
+
 int main(int argc, char **argv) {
   llvm::cl::ParseCommandLineOptions(argc, argv);
 
@@ -52,6 +85,22 @@ int main(int argc, char **argv) {
     context->setInputVisibilityString(InputVisibility.getValue());
   }
 
+  context->setEmitLocations(EmitLocations.getValue());
+  for (const auto &pass : DisablePasses) {
+    context->disablePass(pass);
+  }
+  if (!BaselineProfile.getValue().empty()) {
+    context->getProfileGuide().setBaseline(
+        loadProfile(BaselineProfile.getValue()));
+  }
+  for (const auto &variant : VariantProfiles) {
+    const auto pos = variant.find('=');
+    YACL_ENFORCE(pos != std::string::npos, "invalid variant profile {}",
+                 variant);
+    context->getProfileGuide().addVariant(
+        variant.substr(0, pos), loadProfile(variant.substr(pos + 1)));
+  }
+
   auto ret = spu::compiler::compile(context.get(), in_xla, "hlo");
 
   if (OutputFilename.empty()) {
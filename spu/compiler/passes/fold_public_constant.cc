@@ -0,0 +1,414 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <optional>
+#include <vector>
+
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Pass/Pass.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/dialect/pphlo_ops.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Non-splat results larger than this are left to the runtime, so the module
+// does not blow up with huge constants.
+constexpr int64_t kFoldElementLimit = 65536;
+
+// Evaluate `fn` on the elements of `operands` of the same shape, `fn` returns
+// std::nullopt when an element could not be folded, e.g. division by zero.
+template <typename In, typename Out, typename Fn>
+Attribute mapElements(llvm::ArrayRef<DenseElementsAttr> operands,
+                      RankedTensorType type, Fn &&fn) {
+  const bool splat = llvm::all_of(
+      operands, [](DenseElementsAttr attr) { return attr.isSplat(); });
+  const int64_t numel = splat ? 1 : type.getNumElements();
+  if (numel > kFoldElementLimit) {
+    return {};
+  }
+
+  std::vector<std::vector<In>> values;
+  for (auto attr : operands) {
+    if (attr.isSplat()) {
+      values.push_back({attr.getSplatValue<In>()});
+    } else {
+      auto range = attr.getValues<In>();
+      values.emplace_back(range.begin(), range.end());
+    }
+  }
+
+  llvm::SmallVector<Out> results;
+  results.reserve(numel);
+  llvm::SmallVector<In> args;
+  for (int64_t idx = 0; idx < numel; idx++) {
+    args.clear();
+    for (const auto &value : values) {
+      args.push_back(value.size() == 1 ? value[0] : value[idx]);
+    }
+    std::optional<Out> result = fn(args);
+    if (!result.has_value()) {
+      return {};
+    }
+    results.push_back(*result);
+  }
+  return DenseElementsAttr::get(type, results);
+}
+
+// Fold an arithmetic op of float or integer operands.
+template <typename FloatFn, typename IntFn>
+Attribute foldArith(llvm::ArrayRef<DenseElementsAttr> operands,
+                    RankedTensorType type, FloatFn &&float_fn,
+                    IntFn &&int_fn) {
+  auto elt_type = type.getElementType();
+  if (elt_type.isa<FloatType>()) {
+    return mapElements<APFloat, APFloat>(operands, type, float_fn);
+  }
+  if (auto int_type = elt_type.dyn_cast<IntegerType>()) {
+    return mapElements<APInt, APInt>(
+        operands, type, [&](llvm::ArrayRef<APInt> args) {
+          return int_fn(args, int_type.isUnsigned());
+        });
+  }
+  return {};
+}
+
+// Fold a comparison, `pred` maps the three way comparison to the result.
+template <typename Pred>
+Attribute foldCompare(llvm::ArrayRef<DenseElementsAttr> operands,
+                      RankedTensorType type, Pred &&pred) {
+  auto to_bool = [](bool v) -> std::optional<APInt> { return APInt(1, v); };
+  auto operand_type = operands[0].getType().getElementType();
+  if (operand_type.isa<FloatType>()) {
+    return mapElements<APFloat, APInt>(
+        operands, type, [&](llvm::ArrayRef<APFloat> args) {
+          auto cmp = args[0].compare(args[1]);
+          if (cmp == APFloat::cmpUnordered) {
+            // nan is only equal to nothing.
+            return to_bool(pred(0, true));
+          }
+          return to_bool(pred(cmp == APFloat::cmpLessThan      ? -1
+                              : cmp == APFloat::cmpGreaterThan ? 1
+                                                               : 0,
+                              false));
+        });
+  }
+  if (auto int_type = operand_type.dyn_cast<IntegerType>()) {
+    const bool is_unsigned = int_type.isUnsigned() || int_type.getWidth() == 1;
+    return mapElements<APInt, APInt>(
+        operands, type, [&](llvm::ArrayRef<APInt> args) {
+          const bool lt = is_unsigned ? args[0].ult(args[1])
+                                      : args[0].slt(args[1]);
+          const bool gt = is_unsigned ? args[0].ugt(args[1])
+                                      : args[0].sgt(args[1]);
+          return to_bool(pred(lt ? -1 : gt ? 1 : 0, false));
+        });
+  }
+  return {};
+}
+
+Attribute foldConvert(DenseElementsAttr operand, RankedTensorType type) {
+  auto from = operand.getType().getElementType();
+  auto to = type.getElementType();
+  auto from_int = from.dyn_cast<IntegerType>();
+  const bool from_unsigned =
+      from_int && (from_int.isUnsigned() || from_int.getWidth() == 1);
+
+  if (auto to_float = to.dyn_cast<FloatType>()) {
+    const auto &semantics = to_float.getFloatSemantics();
+    if (from.isa<FloatType>()) {
+      return mapElements<APFloat, APFloat>(
+          operand, type, [&](llvm::ArrayRef<APFloat> args) {
+            APFloat v = args[0];
+            bool loses_info = false;
+            v.convert(semantics, APFloat::rmNearestTiesToEven, &loses_info);
+            return std::optional<APFloat>(v);
+          });
+    }
+    return mapElements<APInt, APFloat>(
+        operand, type, [&](llvm::ArrayRef<APInt> args) {
+          APFloat v(semantics);
+          v.convertFromAPInt(args[0], !from_unsigned,
+                             APFloat::rmNearestTiesToEven);
+          return std::optional<APFloat>(v);
+        });
+  }
+
+  auto to_int = to.dyn_cast<IntegerType>();
+  if (!to_int) {
+    return {};
+  }
+  const unsigned width = to_int.getWidth();
+  if (from.isa<FloatType>()) {
+    const bool to_unsigned = to_int.isUnsigned() || width == 1;
+    return mapElements<APFloat, APInt>(
+        operand, type,
+        [&](llvm::ArrayRef<APFloat> args) -> std::optional<APInt> {
+          if (width == 1) {
+            return APInt(1, !args[0].isZero());
+          }
+          APSInt v(width, to_unsigned);
+          bool exact = false;
+          if (args[0].convertToInteger(v, APFloat::rmTowardZero, &exact) ==
+              APFloat::opInvalidOp) {
+            return std::nullopt;
+          }
+          return APInt(v);
+        });
+  }
+  return mapElements<APInt, APInt>(
+      operand, type, [&](llvm::ArrayRef<APInt> args) -> std::optional<APInt> {
+        if (width == 1) {
+          return APInt(1, !args[0].isZero());
+        }
+        return from_unsigned ? args[0].zextOrTrunc(width)
+                             : args[0].sextOrTrunc(width);
+      });
+}
+
+Attribute foldBroadcast(BroadcastOp op, DenseElementsAttr operand,
+                        RankedTensorType type) {
+  if (operand.isSplat()) {
+    return DenseElementsAttr::get(type, operand.getSplatValue<Attribute>());
+  }
+  if (type.getNumElements() > kFoldElementLimit) {
+    return {};
+  }
+
+  auto in_shape = operand.getType().getShape();
+  auto out_shape = type.getShape();
+  auto dims = llvm::to_vector(op.broadcast_dimensions().getValues<int64_t>());
+
+  // strides[d] of the output index into the row-major operand, 0 for
+  // broadcasted dimensions.
+  std::vector<int64_t> strides(out_shape.size(), 0);
+  int64_t stride = 1;
+  for (int64_t d = static_cast<int64_t>(in_shape.size()) - 1; d >= 0; d--) {
+    if (in_shape[d] != 1) {
+      strides[dims[d]] = stride;
+    }
+    stride *= in_shape[d];
+  }
+
+  auto range = operand.getValues<Attribute>();
+  std::vector<Attribute> in(range.begin(), range.end());
+  llvm::SmallVector<Attribute> out;
+  out.reserve(type.getNumElements());
+  std::vector<int64_t> index(out_shape.size(), 0);
+  for (int64_t idx = 0; idx < type.getNumElements(); idx++) {
+    int64_t offset = 0;
+    for (size_t d = 0; d < out_shape.size(); d++) {
+      offset += index[d] * strides[d];
+    }
+    out.push_back(in[offset]);
+    // next row-major index.
+    for (int64_t d = static_cast<int64_t>(out_shape.size()) - 1; d >= 0; d--) {
+      if (++index[d] < out_shape[d]) {
+        break;
+      }
+      index[d] = 0;
+    }
+  }
+  return DenseElementsAttr::get(type, out);
+}
+
+// Fold ops whose operands are all public constants into public constants, so
+// the runtime does not evaluate public-only subgraphs of known inputs.
+struct FoldPublicConstant
+    : public FoldPublicConstantBase<FoldPublicConstant> {
+  void runOnOperation() override {
+    getOperation().walk([&](Operation *op) { fold(op); });
+  }
+
+private:
+  TypeTools tools_;
+
+  void fold(Operation *op) const {
+    if (op->getNumResults() != 1 || op->getNumOperands() == 0 ||
+        !tools_.isMPCType<PublicType>(op->getResult(0).getType())) {
+      return;
+    }
+    auto ret_type = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!ret_type || !ret_type.hasStaticShape()) {
+      return;
+    }
+
+    llvm::SmallVector<DenseElementsAttr> operands;
+    for (auto operand : op->getOperands()) {
+      auto constant = operand.getDefiningOp<ConstantOp>();
+      if (!constant) {
+        return;
+      }
+      auto attr = constant.value().dyn_cast<DenseElementsAttr>();
+      if (!attr) {
+        return;
+      }
+      operands.push_back(attr);
+    }
+
+    auto type = RankedTensorType::get(ret_type.getShape(),
+                                      tools_.getExpressedType(ret_type));
+    auto result = evaluate(op, operands, type);
+    if (!result) {
+      return;
+    }
+
+    OpBuilder builder(op);
+    auto constant = builder.create<ConstantOp>(op->getLoc(), result);
+    if (constant.getType() != ret_type) {
+      constant->erase();
+      return;
+    }
+    op->getResult(0).replaceAllUsesWith(constant.getResult());
+
+    // Operands are visited before `op`, so erasing them keeps the walk valid.
+    llvm::SmallSetVector<Operation *, 4> inputs;
+    for (auto operand : op->getOperands()) {
+      inputs.insert(operand.getDefiningOp());
+    }
+    op->erase();
+    for (auto *input : inputs) {
+      if (input->use_empty()) {
+        input->erase();
+      }
+    }
+  }
+
+  static Attribute evaluate(Operation *op,
+                            llvm::ArrayRef<DenseElementsAttr> xs,
+                            RankedTensorType type) {
+    using FloatArgs = llvm::ArrayRef<APFloat>;
+    using IntArgs = llvm::ArrayRef<APInt>;
+    using OptFloat = std::optional<APFloat>;
+    using OptInt = std::optional<APInt>;
+
+    return llvm::TypeSwitch<Operation *, Attribute>(op)
+        .Case<AddOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs a) { return OptFloat(a[0] + a[1]); },
+              [](IntArgs a, bool) { return OptInt(a[0] + a[1]); });
+        })
+        .Case<SubtractOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs a) { return OptFloat(a[0] - a[1]); },
+              [](IntArgs a, bool) { return OptInt(a[0] - a[1]); });
+        })
+        .Case<MulOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs a) { return OptFloat(a[0] * a[1]); },
+              [](IntArgs a, bool) { return OptInt(a[0] * a[1]); });
+        })
+        .Case<DivOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs a) { return OptFloat(a[0] / a[1]); },
+              [](IntArgs a, bool is_unsigned) -> OptInt {
+                if (a[1].isZero()) {
+                  return std::nullopt;
+                }
+                return is_unsigned ? a[0].udiv(a[1]) : a[0].sdiv(a[1]);
+              });
+        })
+        .Case<MaxOp>([&](auto) {
+          return foldArith(
+              xs, type,
+              [](FloatArgs a) { return OptFloat(llvm::maximum(a[0], a[1])); },
+              [](IntArgs a, bool is_unsigned) {
+                return OptInt(is_unsigned ? APIntOps::umax(a[0], a[1])
+                                          : APIntOps::smax(a[0], a[1]));
+              });
+        })
+        .Case<MinOp>([&](auto) {
+          return foldArith(
+              xs, type,
+              [](FloatArgs a) { return OptFloat(llvm::minimum(a[0], a[1])); },
+              [](IntArgs a, bool is_unsigned) {
+                return OptInt(is_unsigned ? APIntOps::umin(a[0], a[1])
+                                          : APIntOps::smin(a[0], a[1]));
+              });
+        })
+        .Case<NegOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs a) { return OptFloat(-a[0]); },
+              [](IntArgs a, bool) { return OptInt(-a[0]); });
+        })
+        .Case<NotOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs) { return OptFloat(); },
+              [](IntArgs a, bool) { return OptInt(~a[0]); });
+        })
+        .Case<AndOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs) { return OptFloat(); },
+              [](IntArgs a, bool) { return OptInt(a[0] & a[1]); });
+        })
+        .Case<OrOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs) { return OptFloat(); },
+              [](IntArgs a, bool) { return OptInt(a[0] | a[1]); });
+        })
+        .Case<XorOp>([&](auto) {
+          return foldArith(
+              xs, type, [](FloatArgs) { return OptFloat(); },
+              [](IntArgs a, bool) { return OptInt(a[0] ^ a[1]); });
+        })
+        .Case<EqualOp>([&](auto) {
+          return foldCompare(xs, type,
+                             [](int c, bool nan) { return !nan && c == 0; });
+        })
+        .Case<NotEqualOp>([&](auto) {
+          return foldCompare(xs, type,
+                             [](int c, bool nan) { return nan || c != 0; });
+        })
+        .Case<LessOp>([&](auto) {
+          return foldCompare(xs, type,
+                             [](int c, bool nan) { return !nan && c < 0; });
+        })
+        .Case<LessEqualOp>([&](auto) {
+          return foldCompare(xs, type,
+                             [](int c, bool nan) { return !nan && c <= 0; });
+        })
+        .Case<GreaterOp>([&](auto) {
+          return foldCompare(xs, type,
+                             [](int c, bool nan) { return !nan && c > 0; });
+        })
+        .Case<GreaterEqualOp>([&](auto) {
+          return foldCompare(xs, type,
+                             [](int c, bool nan) { return !nan && c >= 0; });
+        })
+        .Case<ConvertOp>([&](auto) { return foldConvert(xs[0], type); })
+        .Case<ReshapeOp>([&](auto) -> Attribute {
+          if (!xs[0].isSplat() && type.getNumElements() > kFoldElementLimit) {
+            return {};
+          }
+          return xs[0].reshape(type);
+        })
+        .Case<BroadcastOp>([&](BroadcastOp broadcast) {
+          return foldBroadcast(broadcast, xs[0], type);
+        })
+        .Default([](Operation *) { return Attribute(); });
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFoldPublicConstantPass() {
+  return std::make_unique<FoldPublicConstant>();
+}
+
+} // namespace mlir::pphlo
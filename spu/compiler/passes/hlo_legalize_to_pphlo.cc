@@ -900,6 +900,70 @@ public:
   }
 };
 
+template <>
+class HloToPPHloOpConverter<mhlo::ScatterOp>
+    : public OpConversionPattern<mhlo::ScatterOp> {
+private:
+  const ValueVisibilityMap &vis_;
+
+  // Whether the update computation is `return add(%arg0, %arg1)`.
+  static bool isAddComputation(Region &region) {
+    auto &block = region.front();
+    if (block.getNumArguments() != 2 ||
+        !llvm::hasSingleElement(block.without_terminator())) {
+      return false;
+    }
+    auto add = llvm::dyn_cast<mhlo::AddOp>(block.front());
+    auto ret = llvm::dyn_cast<mhlo::ReturnOp>(block.getTerminator());
+    if (!add || !ret || ret->getNumOperands() != 1 ||
+        ret->getOperand(0) != add.getResult()) {
+      return false;
+    }
+    return (add.getLhs() == block.getArgument(0) &&
+            add.getRhs() == block.getArgument(1)) ||
+           (add.getLhs() == block.getArgument(1) &&
+            add.getRhs() == block.getArgument(0));
+  }
+
+public:
+  HloToPPHloOpConverter(TypeConverter &type_converter, MLIRContext *context,
+                        const ValueVisibilityMap &vis)
+      : OpConversionPattern<mhlo::ScatterOp>(type_converter, context),
+        vis_(vis) {}
+
+  LogicalResult
+  matchAndRewrite(mhlo::ScatterOp op, mhlo::ScatterOpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // Other scatters are expanded by the importer.
+    if (op.getInputs().size() != 1 ||
+        !isAddComputation(op.getUpdateComputation())) {
+      return rewriter.notifyMatchFailure(
+          op, "only scatters of one add update computation are supported");
+    }
+
+    auto old_attr = op.getScatterDimensionNumbers();
+    pphlo::ScatterDimensionNumbersAttr attr =
+        ScatterDimensionNumbersAttr::get(
+            op.getContext(), old_attr.getUpdateWindowDims(),
+            old_attr.getInsertedWindowDims(),
+            old_attr.getScatterDimsToOperandDims(),
+            old_attr.getIndexVectorDim());
+
+    auto result_vis = vis_.getValueVisibility(op->getResult(0));
+
+    Type resultType = HloToPPHloTypeConverter::getTypeWithVisibility(
+        this->getTypeConverter()->convertType(op->getResult(0).getType()),
+        result_vis);
+
+    rewriter.replaceOpWithNewOp<pphlo::ScatterAddOp>(
+        op, resultType, adaptor.getInputs()[0], adaptor.getScatterIndices(),
+        adaptor.getUpdates()[0], attr, op.getIndicesAreSorted(),
+        op.getUniqueIndices());
+
+    return success();
+  }
+};
+
 template <>
 class HloToPPHloOpConverter<mhlo::ConvolutionOp>
     : public OpConversionPattern<mhlo::ConvolutionOp> {
@@ -1248,6 +1312,7 @@ private:
         HloToPPHloOpConverter<mhlo::RoundOp>,
         HloToPPHloOpConverter<mhlo::ReverseOp>,
         HloToPPHloOpConverter<mhlo::RngOp>,
+        HloToPPHloOpConverter<mhlo::ScatterOp>,
         HloToPPHloOpConverter<mhlo::SelectOp>,
         HloToPPHloOpConverter<mhlo::SelectAndScatterOp>,
         HloToPPHloOpConverter<mhlo::ShiftLeftOp>,
@@ -0,0 +1,168 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/compiler/passes/passes.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Convert the following pattern
+//   %s0 = convert(%p0); %s1 = mul(%s0, %p1)
+// into
+//   %p2 = mul(%p0, %p1); %s1 = convert(%p2)
+// so public inputs are promoted to secret as late as possible, and the ops
+// in between run on public values.
+struct SinkP2SConverter : public RewritePattern {
+private:
+  TypeTools tools_;
+
+  // Ops of the same semantics on public and secret values.
+  static bool isSinkable(Operation *op) {
+    return llvm::isa<AddOp, SubtractOp, MulOp, NegOp, DotOp, ReshapeOp,
+                     TransposeOp, BroadcastOp, SliceOp, ConcatenateOp>(op);
+  }
+
+  // The public value of a p2s convert, which keeps the expressed type.
+  Value getPromotedPublic(Value v) const {
+    auto convert = v.getDefiningOp<ConvertOp>();
+    if (!convert) {
+      return nullptr;
+    }
+    auto in_type = convert.operand().getType();
+    auto out_type = convert.getType();
+    if (!tools_.isMPCType<PublicType>(in_type) ||
+        !tools_.isMPCType<SecretType>(out_type) ||
+        tools_.getExpressedType(in_type) != tools_.getExpressedType(out_type)) {
+      return nullptr;
+    }
+    return convert.operand();
+  }
+
+public:
+  explicit SinkP2SConverter(MLIRContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!isSinkable(op) || op->getNumResults() != 1 ||
+        !tools_.isMPCType<SecretType>(op->getResult(0).getType())) {
+      return failure();
+    }
+
+    // Every secret operand must be a promoted public.
+    SmallVector<Value> operands;
+    for (auto operand : op->getOperands()) {
+      if (tools_.isMPCType<PublicType>(operand.getType())) {
+        operands.emplace_back(operand);
+      } else if (auto promoted = getPromotedPublic(operand)) {
+        operands.emplace_back(promoted);
+      } else {
+        return failure();
+      }
+    }
+
+    auto ret_type = op->getResult(0).getType();
+    auto *pub_op = rewriter.clone(*op);
+    pub_op->setOperands(operands);
+    pub_op->getResult(0).setType(
+        tools_.getTypeWithVisibility(ret_type, Visibility::VIS_PUBLIC));
+    rewriter.replaceOpWithNewOp<ConvertOp>(op, ret_type,
+                                           pub_op->getResult(0));
+    return success();
+  }
+};
+
+// Idea here:
+//   while(%x, %w) cond { f(%i, %w) } body { %t = g(%w); h(%x, %t), %w }
+// has %w unchanged by the body, into
+//   %t = g(%w); while(%x, %w) cond { f(%i, %w) } body { h(%x, %t), %w }
+// Rational:
+// A body runs once per iteration, so its ops of loop invariant inputs, e.g.
+// public sub-expressions of constants and weights, are recomputed as many
+// times. Regions of pphlo could use values defined above, so loop carried
+// values returned as is by the body are replaced by the loop inputs, and
+// side effect free ops of only values defined outside the loop are moved
+// before it. The cond region is hoisted the same way.
+struct HoistLoopInvariant : public HoistLoopInvariantBase<HoistLoopInvariant> {
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    patterns.insert<SinkP2SConverter>(&getContext());
+    (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+
+    // post order, so ops hoisted out of nested loops could be hoisted again.
+    SmallVector<WhileOp> loops;
+    getOperation().walk([&](WhileOp op) { loops.emplace_back(op); });
+    for (auto op : loops) {
+      forwardInvariantArgs(op);
+      hoist(op, op.cond().front());
+      hoist(op, op.body().front());
+    }
+  }
+
+private:
+  static void forwardInvariantArgs(WhileOp op) {
+    auto &cond = op.cond().front();
+    auto &body = op.body().front();
+    auto *terminator = body.getTerminator();
+    for (unsigned idx = 0; idx < op->getNumOperands(); ++idx) {
+      if (terminator->getOperand(idx) != body.getArgument(idx)) {
+        continue;
+      }
+      auto init = op->getOperand(idx);
+      cond.getArgument(idx).replaceAllUsesWith(init);
+      // keep the argument returned by the terminator for the loop signature.
+      body.getArgument(idx).replaceUsesWithIf(init, [&](OpOperand &use) {
+        return use.getOwner() != terminator;
+      });
+      op->getResult(idx).replaceAllUsesWith(init);
+    }
+  }
+
+  static bool isDefinedOutside(WhileOp op, Value v) {
+    return !op->isAncestor(v.getParentRegion()->getParentOp());
+  }
+
+  static void hoist(WhileOp op, Block &block) {
+    // in order, so users of hoisted ops are hoisted in the same sweep.
+    auto ops = llvm::make_early_inc_range(block.without_terminator());
+    for (auto &nested : ops) {
+      if (nested.getNumRegions() != 0 || !isMemoryEffectFree(&nested)) {
+        continue;
+      }
+      if (llvm::all_of(nested.getOperands(),
+                       [&](Value v) { return isDefinedOutside(op, v); })) {
+        nested.moveBefore(op);
+      }
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createHoistLoopInvariantPass() {
+  return std::make_unique<HoistLoopInvariant>();
+}
+
+} // namespace mlir::pphlo
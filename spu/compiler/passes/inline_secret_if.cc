@@ -0,0 +1,208 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <tuple>
+
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Idea here:
+//   %r:2 = if(%c) { return %t0, %t1 } else { return %f0, %f1 }
+// with a secret %c, into
+//   ... ops of both branches ...
+//   %t = concat(reshape(%t0), reshape(%t1))
+//   %f = concat(reshape(%f0), reshape(%f1))
+//   %s = select(broadcast(%c), %t, %f)
+//   %r#0 = reshape(slice(%s, ...)), %r#1 = reshape(slice(%s, ...))
+// Rational:
+// A secret condition can not pick a branch, both branches are evaluated
+// anyway. Once inlined, ops of both branches live in one block, so CSE merges
+// their shared subexpressions, and independent ops of the two branches are
+// scheduled (and batched) together instead of one branch after another. The
+// outputs of the same types are merged by one select, i.e. one round.
+//
+// Only branches free of side effects are inlined, since both are executed.
+struct InlineSecretIf : public InlineSecretIfBase<InlineSecretIf> {
+  void runOnOperation() override {
+    // post order, so nested ifs are inlined first.
+    SmallVector<IfOp> ifs;
+    getOperation().walk([&](IfOp op) { ifs.emplace_back(op); });
+    for (auto op : ifs) {
+      if (canInline(op)) {
+        inlineIf(op);
+      }
+    }
+  }
+
+private:
+  TypeTools tools_;
+
+  bool isSecret(Type type) const {
+    return tools_.getTypeVisibility(type) == Visibility::VIS_SECRET;
+  }
+
+  bool canInline(IfOp op) const {
+    auto cond_type = op.condition().getType().dyn_cast<RankedTensorType>();
+    if (!cond_type || cond_type.getRank() != 0 || !isSecret(cond_type)) {
+      return false;
+    }
+    for (auto result : op->getResults()) {
+      auto type = result.getType().dyn_cast<RankedTensorType>();
+      if (!type || !type.hasStaticShape() || !isSecret(type)) {
+        return false;
+      }
+    }
+    for (auto *region : {&op.true_branch(), &op.false_branch()}) {
+      for (auto &nested : region->front().without_terminator()) {
+        if (!isMemoryEffectFree(&nested)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Clone the ops of a branch before `op`, return the branch outputs.
+  static SmallVector<Value> cloneBranch(OpBuilder &builder, Region &region) {
+    BlockAndValueMapping mapping;
+    auto &block = region.front();
+    for (auto &nested : block.without_terminator()) {
+      builder.clone(nested, mapping);
+    }
+    SmallVector<Value> outputs;
+    for (auto operand : block.getTerminator()->getOperands()) {
+      outputs.emplace_back(mapping.lookupOrDefault(operand));
+    }
+    return outputs;
+  }
+
+  static Value flattenTo1D(OpBuilder &builder, Location loc, Value v) {
+    auto type = v.getType().cast<RankedTensorType>();
+    if (type.getRank() == 1) {
+      return v;
+    }
+    auto flat_type =
+        RankedTensorType::get({type.getNumElements()}, type.getElementType());
+    return builder.create<ReshapeOp>(loc, flat_type, v);
+  }
+
+  static Value pack(OpBuilder &builder, Location loc,
+                    llvm::ArrayRef<Value> values, int64_t total) {
+    if (values.size() == 1) {
+      return flattenTo1D(builder, loc, values.front());
+    }
+    SmallVector<Value> pieces;
+    for (auto v : values) {
+      pieces.emplace_back(flattenTo1D(builder, loc, v));
+    }
+    auto el_type =
+        values.front().getType().cast<RankedTensorType>().getElementType();
+    return builder.create<ConcatenateOp>(
+        loc, RankedTensorType::get({total}, el_type), pieces,
+        builder.getI64IntegerAttr(0));
+  }
+
+  void inlineIf(IfOp op) {
+    OpBuilder builder(op);
+    auto loc = op->getLoc();
+
+    auto on_true = cloneBranch(builder, op.true_branch());
+    auto on_false = cloneBranch(builder, op.false_branch());
+
+    // group outputs by the element types of the select.
+    std::map<std::tuple<std::string, std::string, std::string>,
+             SmallVector<unsigned>>
+        groups;
+    auto typeKey = [](Value v) {
+      std::string key;
+      llvm::raw_string_ostream os(key);
+      os << v.getType().cast<RankedTensorType>().getElementType();
+      return os.str();
+    };
+    for (unsigned idx = 0; idx < op->getNumResults(); ++idx) {
+      groups[{typeKey(on_true[idx]), typeKey(on_false[idx]),
+              typeKey(op->getResult(idx))}]
+          .push_back(idx);
+    }
+
+    for (const auto &[key, indices] : groups) {
+      SmallVector<Value> trues;
+      SmallVector<Value> falses;
+      int64_t total = 0;
+      for (auto idx : indices) {
+        trues.emplace_back(on_true[idx]);
+        falses.emplace_back(on_false[idx]);
+        total += op->getResult(idx)
+                     .getType()
+                     .cast<RankedTensorType>()
+                     .getNumElements();
+      }
+
+      auto ret_el_type = op->getResult(indices.front())
+                             .getType()
+                             .cast<RankedTensorType>()
+                             .getElementType();
+      auto cond_el_type =
+          op.condition().getType().cast<RankedTensorType>().getElementType();
+      auto pred = builder.create<BroadcastOp>(
+          loc, RankedTensorType::get({total}, cond_el_type), op.condition(),
+          builder.getI64TensorAttr({}));
+      auto selected = builder.create<SelectOp>(
+          loc, RankedTensorType::get({total}, ret_el_type), pred,
+          pack(builder, loc, trues, total), pack(builder, loc, falses, total));
+
+      int64_t offset = 0;
+      for (auto idx : indices) {
+        auto ret_type = op->getResult(idx).getType().cast<RankedTensorType>();
+        const int64_t numel = ret_type.getNumElements();
+        Value piece = selected;
+        if (indices.size() > 1) {
+          piece = builder.create<SliceOp>(
+              loc, RankedTensorType::get({numel}, ret_el_type), selected,
+              builder.getI64TensorAttr({offset}),
+              builder.getI64TensorAttr({offset + numel}),
+              builder.getI64TensorAttr({1}));
+        }
+        if (ret_type.getRank() != 1) {
+          piece = builder.create<ReshapeOp>(loc, ret_type, piece);
+        }
+        op->getResult(idx).replaceAllUsesWith(piece);
+        offset += numel;
+      }
+    }
+
+    op->erase();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createInlineSecretIfPass() {
+  return std::make_unique<InlineSecretIf>();
+}
+
+} // namespace mlir::pphlo
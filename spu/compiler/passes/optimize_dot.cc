@@ -0,0 +1,271 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/compiler/passes/passes.h"
+#include "spu/dialect/pphlo_attrs.h"
+#include "spu/dialect/pphlo_base_enums.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// A secret x secret matmul multiplies shares of both sides, which costs
+// communication on top of the local products, while a matmul with a public
+// side is local. Only the ratio matters when ranking orders.
+constexpr double kSecretSecretDotWeight = 64.0;
+
+// Relative cost of a (m, k) x (k, n) matmul of the given visibilities.
+double dotCost(int64_t m, int64_t k, int64_t n, Visibility lhs_vis,
+               Visibility rhs_vis) {
+  double flops = static_cast<double>(m) * static_cast<double>(k) *
+                 static_cast<double>(n);
+  if (lhs_vis == Visibility::VIS_SECRET && rhs_vis == Visibility::VIS_SECRET) {
+    flops *= kSecretSecretDotWeight;
+  }
+  return flops;
+}
+
+RankedTensorType getMatrixType(Value v) {
+  auto type = v.getType().dyn_cast<RankedTensorType>();
+  if (!type || type.getRank() != 2 || !type.hasStaticShape()) {
+    return nullptr;
+  }
+  return type;
+}
+
+// Reassociate a chain of matmuls by the cheaper order, e.g.
+//   %0 = dot(%s0, %s1); %1 = dot(%0, %p0)
+// into
+//   %0 = dot(%s1, %p0); %1 = dot(%s0, %0)
+// which trades a secret x secret matmul of the larger inner dims for a
+// secret x public one. Only intermediates of a single use are reordered.
+struct DotChainConverter : public OpRewritePattern<DotOp> {
+private:
+  TypeTools tools_;
+
+  // Whether `op` is a matrix dot of one expressed type, e.g. no mixed
+  // int/fxp products, so its operands can be regrouped.
+  bool isMatrixDot(DotOp op, Type expressed_type) const {
+    return getMatrixType(op.lhs()) && getMatrixType(op.rhs()) &&
+           getMatrixType(op.getResult()) &&
+           tools_.getExpressedType(op.lhs().getType()) == expressed_type &&
+           tools_.getExpressedType(op.rhs().getType()) == expressed_type &&
+           tools_.getExpressedType(op.getType()) == expressed_type;
+  }
+
+  // The single-use matrix dot defining `v`.
+  DotOp getChainedDot(Value v, Type expressed_type) const {
+    auto dot = v.getDefiningOp<DotOp>();
+    if (!dot || !dot->hasOneUse() || !isMatrixDot(dot, expressed_type)) {
+      return nullptr;
+    }
+    return dot;
+  }
+
+  // Cost of (a * b) * c and a * (b * c), of a (m, k), b (k, n), c (n, p).
+  std::pair<double, double> getChainCosts(Value a, Value b, Value c) const {
+    auto a_shape = getMatrixType(a).getShape();
+    auto c_shape = getMatrixType(c).getShape();
+    const int64_t m = a_shape[0];
+    const int64_t k = a_shape[1];
+    const int64_t n = c_shape[0];
+    const int64_t p = c_shape[1];
+    auto a_vis = tools_.getTypeVisibility(a.getType());
+    auto b_vis = tools_.getTypeVisibility(b.getType());
+    auto c_vis = tools_.getTypeVisibility(c.getType());
+    auto ab_vis = TypeTools::inferResultVisibility({a_vis, b_vis});
+    auto bc_vis = TypeTools::inferResultVisibility({b_vis, c_vis});
+
+    return {dotCost(m, k, n, a_vis, b_vis) + dotCost(m, n, p, ab_vis, c_vis),
+            dotCost(k, n, p, b_vis, c_vis) + dotCost(m, k, p, a_vis, bc_vis)};
+  }
+
+  Value createDot(PatternRewriter &rewriter, Location loc, Value lhs,
+                  Value rhs) const {
+    auto vis = TypeTools::inferResultVisibility(
+        {tools_.getTypeVisibility(lhs.getType()),
+         tools_.getTypeVisibility(rhs.getType())});
+    auto type = RankedTensorType::get(
+        {getMatrixType(lhs).getDimSize(0), getMatrixType(rhs).getDimSize(1)},
+        tools_.getTypeWithVisibility(
+            tools_.getExpressedType(lhs.getType()), vis));
+    return rewriter.create<DotOp>(loc, type, lhs, rhs);
+  }
+
+public:
+  explicit DotChainConverter(MLIRContext *context)
+      : OpRewritePattern(context) {}
+
+  LogicalResult matchAndRewrite(DotOp op,
+                                PatternRewriter &rewriter) const override {
+    auto expressed_type = tools_.getExpressedType(op.getType());
+    if (!isMatrixDot(op, expressed_type)) {
+      return failure();
+    }
+
+    // dot(dot(a, b), c) -> dot(a, dot(b, c))
+    if (auto inner = getChainedDot(op.lhs(), expressed_type)) {
+      auto [cost_ab_c, cost_a_bc] =
+          getChainCosts(inner.lhs(), inner.rhs(), op.rhs());
+      if (cost_a_bc < cost_ab_c) {
+        auto bc = createDot(rewriter, inner.getLoc(), inner.rhs(), op.rhs());
+        rewriter.replaceOp(op,
+                           createDot(rewriter, op.getLoc(), inner.lhs(), bc));
+        return success();
+      }
+    }
+
+    // dot(a, dot(b, c)) -> dot(dot(a, b), c)
+    if (auto inner = getChainedDot(op.rhs(), expressed_type)) {
+      auto [cost_ab_c, cost_a_bc] =
+          getChainCosts(op.lhs(), inner.lhs(), inner.rhs());
+      if (cost_ab_c < cost_a_bc) {
+        auto ab = createDot(rewriter, inner.getLoc(), op.lhs(), inner.lhs());
+        rewriter.replaceOp(op,
+                           createDot(rewriter, op.getLoc(), ab, inner.rhs()));
+        return success();
+      }
+    }
+
+    return failure();
+  }
+};
+
+// A batched dot runs a matmul per batch, when one side is the same matrix
+// broadcasted to all batches, e.g. shared weights, the batches are folded
+// into the other side and run as one matmul:
+//   dot_general(%x (b, m, k), broadcast(%w (k, n)))
+//     -> reshape(dot(reshape(%x) (b * m, k), %w), (b, m, n))
+//   dot_general(broadcast(%w (m, k)), %x (b, k, n))
+//     -> transpose(reshape(dot(%w, reshape(transpose(%x)) (k, b * n))))
+// Reshapes and transposes are local, so it saves the rounds of b - 1
+// matmuls.
+struct BatchDotConverter : public OpRewritePattern<DotGeneralOp> {
+private:
+  // The (rows, cols) matrix broadcasted to all batches of `v`.
+  static Value getBroadcastedMatrix(Value v) {
+    auto broadcast = v.getDefiningOp<BroadcastOp>();
+    if (!broadcast || !getMatrixType(broadcast.operand())) {
+      return nullptr;
+    }
+    auto dims = broadcast.broadcast_dimensions().getValues<int64_t>();
+    if (dims[0] != 1 || dims[1] != 2) {
+      return nullptr;
+    }
+    return broadcast.operand();
+  }
+
+  // Only the canonical (b, m, k) x (b, k, n) form, see the canonicalizer of
+  // DotGeneralOp.
+  static bool isCanonicalBatchDot(DotGeneralOp op) {
+    auto dnum = op.dot_dimension_numbers();
+    auto is = [](ArrayRef<int64_t> dims, int64_t dim) {
+      return dims.size() == 1 && dims[0] == dim;
+    };
+    return is(dnum.getLhsBatchingDimensions(), 0) &&
+           is(dnum.getRhsBatchingDimensions(), 0) &&
+           is(dnum.getLhsContractingDimensions(), 2) &&
+           is(dnum.getRhsContractingDimensions(), 1);
+  }
+
+  static RankedTensorType getStaticType(Value v) {
+    auto type = v.getType().dyn_cast<RankedTensorType>();
+    if (!type || !type.hasStaticShape()) {
+      return nullptr;
+    }
+    return type;
+  }
+
+public:
+  explicit BatchDotConverter(MLIRContext *context)
+      : OpRewritePattern(context) {}
+
+  LogicalResult matchAndRewrite(DotGeneralOp op,
+                                PatternRewriter &rewriter) const override {
+    auto lhs_type = getStaticType(op.lhs());
+    auto rhs_type = getStaticType(op.rhs());
+    auto ret_type = getStaticType(op.getResult());
+    if (!lhs_type || !rhs_type || !ret_type || lhs_type.getRank() != 3 ||
+        rhs_type.getRank() != 3 || ret_type.getRank() != 3 ||
+        !isCanonicalBatchDot(op)) {
+      return failure();
+    }
+
+    const auto ret_shape = ret_type.getShape();
+    const int64_t b = ret_shape[0];
+    const int64_t m = ret_shape[1];
+    const int64_t n = ret_shape[2];
+    const int64_t k = lhs_type.getDimSize(2);
+    auto loc = op.getLoc();
+
+    if (auto w = getBroadcastedMatrix(op.rhs())) {
+      auto x = rewriter.create<ReshapeOp>(
+          loc, RankedTensorType::get({b * m, k}, lhs_type.getElementType()),
+          op.lhs());
+      auto dot = rewriter.create<DotOp>(
+          loc, RankedTensorType::get({b * m, n}, ret_type.getElementType()), x,
+          w);
+      rewriter.replaceOpWithNewOp<ReshapeOp>(op, ret_type, dot);
+      return success();
+    }
+
+    if (auto w = getBroadcastedMatrix(op.lhs())) {
+      auto rhs_element_type = rhs_type.getElementType();
+      auto x = rewriter.create<TransposeOp>(
+          loc, RankedTensorType::get({k, b, n}, rhs_element_type), op.rhs(),
+          rewriter.getI64TensorAttr({1, 0, 2}));
+      auto flat_x = rewriter.create<ReshapeOp>(
+          loc, RankedTensorType::get({k, b * n}, rhs_element_type), x);
+      auto ret_element_type = ret_type.getElementType();
+      auto dot = rewriter.create<DotOp>(
+          loc, RankedTensorType::get({m, b * n}, ret_element_type), w, flat_x);
+      auto ret = rewriter.create<ReshapeOp>(
+          loc, RankedTensorType::get({m, b, n}, ret_element_type), dot);
+      rewriter.replaceOpWithNewOp<TransposeOp>(
+          op, ret_type, ret, rewriter.getI64TensorAttr({1, 0, 2}));
+      return success();
+    }
+
+    return failure();
+  }
+};
+
+struct OptimizeDot : public OptimizeDotBase<OptimizeDot> {
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    populateOwningPatterns(&patterns, &getContext());
+    (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+  }
+
+private:
+  void populateOwningPatterns(RewritePatternSet *patterns,
+                              MLIRContext *ctx) const {
+    patterns->insert<DotChainConverter, BatchDotConverter>(ctx);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeDotPass() {
+  return std::make_unique<OptimizeDot>();
+}
+
+} // namespace mlir::pphlo
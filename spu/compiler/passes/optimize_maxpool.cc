@@ -16,6 +16,7 @@
 
 #include <functional>
 #include <numeric>
+#include <utility>
 
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
@@ -76,9 +77,11 @@ private:
     return false;
   }
 
+  SiteFilter filter_;
+
 public:
-  explicit SelectAndScatterConverter(MLIRContext *context)
-      : OpRewritePattern(context) {}
+  SelectAndScatterConverter(MLIRContext *context, SiteFilter filter)
+      : OpRewritePattern(context), filter_(std::move(filter)) {}
 
   LogicalResult matchAndRewrite(SelectAndScatterOp op,
                                 PatternRewriter &rewriter) const override {
@@ -99,7 +102,6 @@ public:
     auto input = op.operand();
     auto uses = input.getUses();
 
-    LogicalResult status = failure();
     Value selected_indicies;
 
     auto isAllOne = [](const DenseIntElementsAttr &attr) {
@@ -107,6 +109,27 @@ public:
     };
 
     for (const auto &u : uses) {
+      // The forward pass is rewritten already by another select_and_scatter
+      // of the same windows, reuse its one-hot mask.
+      if (auto previous_argmax = mlir::dyn_cast<ArgMaxOp>(u.getOwner())) {
+        if (op.window_dimensions() != previous_argmax.window_dimensions() ||
+            op.window_strides() != previous_argmax.window_strides() ||
+            op.padding() != previous_argmax.padding()) {
+          continue;
+        }
+        auto window_dilation = previous_argmax.window_dilations();
+        auto base_dilation = previous_argmax.base_dilations();
+        if ((window_dilation.has_value() && !isAllOne(*window_dilation)) ||
+            (base_dilation.has_value() && !isAllOne(*base_dilation))) {
+          continue;
+        }
+        if (filter_ && !filter_({previous_argmax->getLoc(), op->getLoc()})) {
+          continue;
+        }
+        selected_indicies = previous_argmax->getResult(1);
+        break;
+      }
+
       if (auto previous_reduce_window =
               mlir::dyn_cast<ReduceWindowOp>(u.getOwner())) {
         if (previous_reduce_window.inputs().size() != 1) {
@@ -146,6 +169,11 @@ public:
           continue;
         }
 
+        if (filter_ && !filter_({previous_reduce_window->getLoc(),
+                                 op->getLoc()})) {
+          continue;
+        }
+
         selected_indicies =
             rewriteReduceWindow(previous_reduce_window, rewriter);
 
@@ -153,16 +181,24 @@ public:
       }
     }
 
+    // No matching reduce window, or the site is filtered out.
+    if (!selected_indicies) {
+      return failure();
+    }
+
     rewriter.replaceOpWithNewOp<pphlo::MaxPoolScatterOp>(
         op, op->getResultTypes()[0], selected_indicies, op.source(),
         op.window_dimensions(), op.window_strides().value_or(nullptr),
         op.padding().value_or(nullptr));
 
-    return status;
+    return success();
   }
 };
 
 struct OptimizeMaxPooling : public OptimizeMaxPoolingBase<OptimizeMaxPooling> {
+  OptimizeMaxPooling() = default;
+  explicit OptimizeMaxPooling(SiteFilter filter) : filter_(std::move(filter)) {}
+
   void runOnOperation() override {
     RewritePatternSet patterns(&getContext());
     populateOwningPatterns(&patterns, &getContext());
@@ -172,8 +208,10 @@ struct OptimizeMaxPooling : public OptimizeMaxPoolingBase<OptimizeMaxPooling> {
 private:
   void populateOwningPatterns(RewritePatternSet *patterns,
                               MLIRContext *ctx) const {
-    patterns->insert<SelectAndScatterConverter>(ctx);
+    patterns->insert<SelectAndScatterConverter>(ctx, filter_);
   }
+
+  SiteFilter filter_;
 };
 
 } // namespace
@@ -182,4 +220,9 @@ std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeMaxPoolingPass() {
   return std::make_unique<OptimizeMaxPooling>();
 }
 
+std::unique_ptr<OperationPass<func::FuncOp>>
+createOptimizeMaxPoolingPass(SiteFilter filter) {
+  return std::make_unique<OptimizeMaxPooling>(std::move(filter));
+}
+
 } // namespace mlir::pphlo
@@ -0,0 +1,343 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "llvm/ADT/APFloat.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/compiler/passes/passes.h"
+#include "spu/dialect/pphlo_base_enums.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Matches the row statistics of a tensor along one axis, i.e. reductions
+// over the axis and the reshapes/broadcasts which bring them back to the
+// full shape, as emitted for `keepdims=True` reductions.
+class RowStatMatcher {
+private:
+  SmallVector<int64_t> full_;
+  int64_t axis_;
+
+  // The shape without the axis, or with the axis of size 1.
+  bool isRowShape(Value v) const {
+    auto type = v.getType().dyn_cast<RankedTensorType>();
+    if (!type) {
+      return false;
+    }
+    auto shape = type.getShape();
+    const auto rank = static_cast<int64_t>(full_.size());
+    if (static_cast<int64_t>(shape.size()) == rank - 1) {
+      for (int64_t dim = 0; dim < rank - 1; ++dim) {
+        if (shape[dim] != full_[dim < axis_ ? dim : dim + 1]) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if (static_cast<int64_t>(shape.size()) == rank) {
+      for (int64_t dim = 0; dim < rank; ++dim) {
+        if (shape[dim] != (dim == axis_ ? 1 : full_[dim])) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool isRowBroadcast(BroadcastOp broadcast) const {
+    if (!isRowShape(broadcast.operand())) {
+      return false;
+    }
+    const auto in_rank = broadcast.operand()
+                             .getType()
+                             .dyn_cast<RankedTensorType>()
+                             .getRank();
+    auto dims = broadcast.broadcast_dimensions().getValues<int64_t>();
+    for (int64_t dim = 0; dim < in_rank; ++dim) {
+      const bool keep = in_rank == static_cast<int64_t>(full_.size());
+      if (dims[dim] != (keep || dim < axis_ ? dim : dim + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+  RowStatMatcher(ArrayRef<int64_t> full, int64_t axis)
+      : full_(full.begin(), full.end()), axis_(axis) {}
+
+  int64_t axisSize() const { return full_[axis_]; }
+
+  // Look through the reshapes and broadcasts of row statistics.
+  Value strip(Value v) const {
+    while (true) {
+      if (auto broadcast = v.getDefiningOp<BroadcastOp>()) {
+        if (!isRowBroadcast(broadcast)) {
+          return v;
+        }
+        v = broadcast.operand();
+      } else if (auto reshape = v.getDefiningOp<ReshapeOp>()) {
+        if (!isRowShape(reshape.getResult()) ||
+            !isRowShape(reshape.operand())) {
+          return v;
+        }
+        v = reshape.operand();
+      } else {
+        return v;
+      }
+    }
+  }
+
+  // Return the input if v is `reduce(%input) {max/add}` over the axis.
+  template <typename ReducerOp>
+  Value matchReduce(Value v) const {
+    auto reduce = v.getDefiningOp<ReduceOp>();
+    if (!reduce || reduce.inputs().size() != 1 ||
+        reduce.dimensions().getNumElements() != 1 ||
+        *reduce.dimensions().getValues<int64_t>().begin() != axis_) {
+      return {};
+    }
+
+    auto &block = reduce.body().front();
+    if (block.getOperations().size() != 2) {
+      return {};
+    }
+    auto reducer = llvm::dyn_cast<ReducerOp>(block.front());
+    auto ret = llvm::dyn_cast<ReturnOp>(block.back());
+    if (!reducer || !ret || ret->getNumOperands() != 1 ||
+        ret->getOperand(0) != reducer.getResult() ||
+        reducer.lhs() != block.getArgument(0) ||
+        reducer.rhs() != block.getArgument(1)) {
+      return {};
+    }
+
+    auto init = getSplatConstant(reduce.init_values()[0]);
+    if (!init.has_value()) {
+      return {};
+    }
+    if (std::is_same_v<ReducerOp, MaxOp>
+            ? *init > std::numeric_limits<float>::lowest()
+            : *init != 0) {
+      return {};
+    }
+    return reduce.inputs()[0];
+  }
+
+  // Return the input if v is `reduce(%input) {add} / n` over the axis.
+  Value matchMean(Value v) const {
+    const auto n = static_cast<double>(axisSize());
+    auto isNear = [](std::optional<double> a, double b) {
+      return a.has_value() && std::abs(*a - b) <= 1e-6 * std::abs(b);
+    };
+    if (auto div = v.getDefiningOp<DivOp>()) {
+      if (isNear(getSplatConstant(div.rhs()), n)) {
+        return matchReduce<AddOp>(strip(div.lhs()));
+      }
+    } else if (auto mul = v.getDefiningOp<MulOp>()) {
+      if (isNear(getSplatConstant(mul.rhs()), 1.0 / n)) {
+        return matchReduce<AddOp>(strip(mul.lhs()));
+      }
+      if (isNear(getSplatConstant(mul.lhs()), 1.0 / n)) {
+        return matchReduce<AddOp>(strip(mul.rhs()));
+      }
+    }
+    return {};
+  }
+
+  // The value of a splat float constant, possibly broadcasted.
+  static std::optional<double> getSplatConstant(Value v) {
+    while (auto broadcast = v.getDefiningOp<BroadcastOp>()) {
+      v = broadcast.operand();
+    }
+    auto constant = v.getDefiningOp<ConstantOp>();
+    if (!constant) {
+      return std::nullopt;
+    }
+    auto attr = constant.value().dyn_cast<DenseFPElementsAttr>();
+    if (!attr || !attr.isSplat()) {
+      return std::nullopt;
+    }
+    auto value = attr.getSplatValue<llvm::APFloat>();
+    bool loses_info = false;
+    value.convert(llvm::APFloat::IEEEdouble(),
+                  llvm::APFloat::rmNearestTiesToEven, &loses_info);
+    return value.convertToDouble();
+  }
+};
+
+bool isSecretFxp(Value v) {
+  TypeTools tools;
+  auto type = v.getType().dyn_cast<RankedTensorType>();
+  return type && type.getRank() > 0 &&
+         tools.getTypeVisibility(type) == Visibility::VIS_SECRET &&
+         tools.getExpressedType(type).isa<FloatType>();
+}
+
+// Rewrite
+//   %m = reduce(%x) {max}
+//   %e = exponential(subtract(%x, broadcast(%m)))
+//   %s = reduce(%e) {add}
+//   %y = divide(%e, broadcast(%s))
+// along one axis, which is how frontends emit a stable softmax, into
+//   %y = softmax(%x) {axis}
+struct DivToSoftmax : public OpRewritePattern<DivOp> {
+  explicit DivToSoftmax(MLIRContext *context) : OpRewritePattern(context) {}
+
+  LogicalResult matchAndRewrite(DivOp op,
+                                PatternRewriter &rewriter) const override {
+    auto type = op.getType().dyn_cast<RankedTensorType>();
+    if (!isSecretFxp(op.getResult())) {
+      return failure();
+    }
+
+    auto exp = op.lhs().getDefiningOp<ExpOp>();
+    if (!exp) {
+      return failure();
+    }
+    auto sub = exp.operand().getDefiningOp<SubtractOp>();
+    if (!sub || sub.lhs().getType() != type) {
+      return failure();
+    }
+
+    for (int64_t axis = 0; axis < type.getRank(); ++axis) {
+      RowStatMatcher matcher(type.getShape(), axis);
+      auto sum = matcher.strip(op.rhs());
+      if (matcher.matchReduce<AddOp>(sum) != op.lhs() ||
+          matcher.matchReduce<MaxOp>(matcher.strip(sub.rhs())) != sub.lhs()) {
+        continue;
+      }
+      // the exponentials are recomputed by softmax.
+      for (auto *user : op.lhs().getUsers()) {
+        if (user != op && user != sum.getDefiningOp()) {
+          return failure();
+        }
+      }
+      rewriter.replaceOpWithNewOp<SoftmaxOp>(op, type, sub.lhs(),
+                                             rewriter.getI64IntegerAttr(axis));
+      return success();
+    }
+    return failure();
+  }
+};
+
+// Rewrite
+//   %xc = subtract(%x, broadcast(mean(%x)))
+//   %v = mean(multiply(%xc, %xc))
+//   %y = multiply(%xc, broadcast(rsqrt(add(%v, %eps))))
+// along one axis, where mean is `reduce {add}` followed by a division by n or
+// a multiplication by 1/n, into
+//   %y = layer_norm(%x) {epsilon, axis}
+struct MulToLayerNorm : public OpRewritePattern<MulOp> {
+  explicit MulToLayerNorm(MLIRContext *context) : OpRewritePattern(context) {}
+
+  // Return epsilon and the square if inv_std is `rsqrt(var(xc) + eps)`.
+  std::optional<std::pair<double, MulOp>>
+  matchInvStd(const RowStatMatcher &matcher, Value xc, Value inv_std) const {
+    auto rsqrt = matcher.strip(inv_std).getDefiningOp<RsqrtOp>();
+    if (!rsqrt) {
+      return std::nullopt;
+    }
+    auto add = matcher.strip(rsqrt.operand()).getDefiningOp<AddOp>();
+    if (!add) {
+      return std::nullopt;
+    }
+    for (auto [var, eps] : {std::make_pair(add.lhs(), add.rhs()),
+                            std::make_pair(add.rhs(), add.lhs())}) {
+      auto epsilon = RowStatMatcher::getSplatConstant(eps);
+      if (!epsilon.has_value()) {
+        continue;
+      }
+      auto square =
+          matcher.matchMean(matcher.strip(var)).getDefiningOp<MulOp>();
+      if (square && square.lhs() == xc && square.rhs() == xc) {
+        return std::make_pair(*epsilon, square);
+      }
+    }
+    return std::nullopt;
+  }
+
+  LogicalResult matchAndRewrite(MulOp op,
+                                PatternRewriter &rewriter) const override {
+    auto type = op.getType().dyn_cast<RankedTensorType>();
+    if (!isSecretFxp(op.getResult())) {
+      return failure();
+    }
+
+    for (auto [xc, inv_std] : {std::make_pair(op.lhs(), op.rhs()),
+                               std::make_pair(op.rhs(), op.lhs())}) {
+      auto sub = xc.getDefiningOp<SubtractOp>();
+      if (!sub || sub.lhs().getType() != type) {
+        continue;
+      }
+      for (int64_t axis = 0; axis < type.getRank(); ++axis) {
+        RowStatMatcher matcher(type.getShape(), axis);
+        if (matcher.matchMean(matcher.strip(sub.rhs())) != sub.lhs()) {
+          continue;
+        }
+        auto matched = matchInvStd(matcher, xc, inv_std);
+        if (!matched.has_value()) {
+          continue;
+        }
+        auto [epsilon, square] = *matched;
+        // the centered values are recomputed by layer_norm.
+        for (auto *user : xc.getUsers()) {
+          if (user != op && user != square) {
+            return failure();
+          }
+        }
+        rewriter.replaceOpWithNewOp<LayerNormOp>(
+            op, type, sub.lhs(), rewriter.getF64FloatAttr(epsilon),
+            rewriter.getI64IntegerAttr(axis));
+        return success();
+      }
+    }
+    return failure();
+  }
+};
+
+struct OptimizeNormalization
+    : public OptimizeNormalizationBase<OptimizeNormalization> {
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    populateOwningPatterns(&patterns, &getContext());
+    (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+  }
+
+private:
+  void populateOwningPatterns(RewritePatternSet *patterns,
+                              MLIRContext *ctx) const {
+    patterns->insert<DivToSoftmax, MulToLayerNorm>(ctx);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeNormalizationPass() {
+  return std::make_unique<OptimizeNormalization>();
+}
+
+} // namespace mlir::pphlo
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <utility>
+
+#include "llvm/ADT/SmallVector.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -34,9 +37,12 @@ namespace {
 // If the predicate is used by multiple select, explicit doing a to_a op can
 // reduce the cost of to_a
 struct SelectConversion : public OpRewritePattern<SelectOp> {
+private:
+  SiteFilter filter_;
+
 public:
-  explicit SelectConversion(MLIRContext *context)
-      : OpRewritePattern<SelectOp>(context) {}
+  SelectConversion(MLIRContext *context, SiteFilter filter)
+      : OpRewritePattern<SelectOp>(context), filter_(std::move(filter)) {}
 
   LogicalResult matchAndRewrite(SelectOp op,
                                 PatternRewriter &rewriter) const override {
@@ -65,6 +71,19 @@ public:
       return failure();
     }
 
+    if (filter_) {
+      // the site is the predicate and all selects of it.
+      llvm::SmallVector<Location> site = {pred.getDefiningOp()->getLoc()};
+      for (auto *user : pred.getUsers()) {
+        if (mlir::isa<SelectOp>(user)) {
+          site.push_back(user->getLoc());
+        }
+      }
+      if (!filter_(site)) {
+        return failure();
+      }
+    }
+
     OpBuilder builder(op);
     builder.setInsertionPoint(pred.getDefiningOp()->getNextNode());
     auto pref_a = builder.create<PreferAOp>(pred.getDefiningOp()->getLoc(),
@@ -80,6 +99,9 @@ public:
 };
 
 struct OptimizeSelect : public OptimizeSelectBase<OptimizeSelect> {
+  OptimizeSelect() = default;
+  explicit OptimizeSelect(SiteFilter filter) : filter_(std::move(filter)) {}
+
   void runOnOperation() override {
     RewritePatternSet patterns(&getContext());
     populateOwningPatterns(&patterns, &getContext());
@@ -89,8 +111,10 @@ struct OptimizeSelect : public OptimizeSelectBase<OptimizeSelect> {
 private:
   void populateOwningPatterns(RewritePatternSet *patterns,
                               MLIRContext *ctx) const {
-    patterns->insert<SelectConversion>(ctx);
+    patterns->insert<SelectConversion>(ctx, filter_);
   }
+
+  SiteFilter filter_;
 };
 } // namespace
 
@@ -98,4 +122,9 @@ std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeSelectPass() {
   return std::make_unique<OptimizeSelect>();
 }
 
+std::unique_ptr<OperationPass<func::FuncOp>>
+createOptimizeSelectPass(SiteFilter filter) {
+  return std::make_unique<OptimizeSelect>(std::move(filter));
+}
+
 } // namespace mlir::pphlo
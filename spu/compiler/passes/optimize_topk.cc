@@ -0,0 +1,179 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <optional>
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/compiler/passes/passes.h"
+#include "spu/dialect/pphlo_base_enums.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Rewrite
+//   %0:2 = sort(%x, iota) {greater(%arg0, %arg1)}
+//   %1 = slice(%0#0) [0:k]
+//   %2 = slice(%0#1) [0:k]
+// along the last dimension, which is how XLA expands top_k, into
+//   %1, %2 = top_k(%x) {k}
+struct SortToTopK : public OpRewritePattern<SortOp> {
+private:
+  TypeTools tools_;
+
+  // The comparator should be `return greater(%arg0, %arg1)`.
+  bool isGreaterComparator(Region &comparator) const {
+    auto &block = comparator.front();
+    if (block.getOperations().size() != 2) {
+      return false;
+    }
+    auto greater = llvm::dyn_cast<GreaterOp>(block.front());
+    auto ret = llvm::dyn_cast<ReturnOp>(block.back());
+    return greater && ret && ret->getNumOperands() == 1 &&
+           ret->getOperand(0) == greater.getResult() &&
+           greater.lhs() == block.getArgument(0) &&
+           greater.rhs() == block.getArgument(1);
+  }
+
+  // Return k if the slice takes the first k elements along the last dimension.
+  std::optional<int64_t> getTopSliceSize(SliceOp slice,
+                                         ArrayRef<int64_t> shape) const {
+    auto starts = slice.start_indices().getValues<int64_t>();
+    auto limits = slice.limit_indices().getValues<int64_t>();
+    auto strides = slice.strides().getValues<int64_t>();
+    const size_t rank = shape.size();
+    for (size_t dim = 0; dim < rank; ++dim) {
+      if (starts[dim] != 0 || strides[dim] != 1) {
+        return std::nullopt;
+      }
+      if (dim + 1 < rank && limits[dim] != shape[dim]) {
+        return std::nullopt;
+      }
+    }
+    return limits[rank - 1];
+  }
+
+public:
+  explicit SortToTopK(MLIRContext *context) : OpRewritePattern(context) {}
+
+  LogicalResult matchAndRewrite(SortOp op,
+                                PatternRewriter &rewriter) const override {
+    if (op->getNumOperands() != 2) {
+      return failure();
+    }
+
+    auto operand = op->getOperand(0);
+    auto type = operand.getType().dyn_cast<RankedTensorType>();
+    if (!type || type.getRank() == 0) {
+      return failure();
+    }
+    // Sorting public keys does not need any comparison protocol.
+    if (tools_.getTypeVisibility(type) != Visibility::VIS_SECRET) {
+      return failure();
+    }
+
+    const int64_t rank = type.getRank();
+    int64_t dim = op.dimension();
+    if (dim < 0) {
+      dim += rank;
+    }
+    if (dim != rank - 1) {
+      return failure();
+    }
+
+    auto iota = op->getOperand(1).getDefiningOp<IotaOp>();
+    if (!iota || static_cast<int64_t>(iota.iota_dimension()) != dim) {
+      return failure();
+    }
+
+    if (!isGreaterComparator(op.comparator())) {
+      return failure();
+    }
+
+    // All users should take the same top k.
+    std::optional<int64_t> k;
+    SmallVector<std::pair<SliceOp, unsigned>> slices;
+    SmallVector<Type, 2> ret_types(2);
+    for (auto result : op->getResults()) {
+      for (auto *user : result.getUsers()) {
+        auto slice = llvm::dyn_cast<SliceOp>(user);
+        if (!slice) {
+          return failure();
+        }
+        auto size = getTopSliceSize(slice, type.getShape());
+        if (!size.has_value() || (k.has_value() && *k != *size)) {
+          return failure();
+        }
+        k = size;
+        slices.emplace_back(slice, result.getResultNumber());
+        ret_types[result.getResultNumber()] = slice.getType();
+      }
+    }
+    if (!k.has_value()) {
+      return failure();
+    }
+
+    // Unused results keep the element type of the sort.
+    SmallVector<int64_t> ret_shape(type.getShape().begin(),
+                                   type.getShape().end());
+    ret_shape.back() = *k;
+    for (auto result : op->getResults()) {
+      auto &ret_type = ret_types[result.getResultNumber()];
+      if (!ret_type) {
+        ret_type = RankedTensorType::get(
+            ret_shape,
+            result.getType().dyn_cast<RankedTensorType>().getElementType());
+      }
+    }
+
+    auto top_k =
+        rewriter.create<TopKOp>(op->getLoc(), ret_types[0], ret_types[1],
+                                operand, rewriter.getI64IntegerAttr(*k));
+
+    for (auto &[slice, idx] : slices) {
+      rewriter.replaceOp(slice, top_k->getResult(idx));
+    }
+    rewriter.eraseOp(op);
+
+    return success();
+  }
+};
+
+struct OptimizeTopK : public OptimizeTopKBase<OptimizeTopK> {
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    populateOwningPatterns(&patterns, &getContext());
+    (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+  }
+
+private:
+  void populateOwningPatterns(RewritePatternSet *patterns,
+                              MLIRContext *ctx) const {
+    patterns->insert<SortToTopK>(ctx);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeTopKPass() {
+  return std::make_unique<OptimizeTopK>();
+}
+
+} // namespace mlir::pphlo
@@ -14,8 +14,12 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "mlir/IR/Location.h"
+
 namespace mlir {
 
 namespace func {
@@ -29,6 +33,10 @@ class OperationPass;
 
 namespace pphlo {
 
+/// Decides whether a rewrite applies to a site, given the locations of the
+/// ops the rewrite replaces. Returns false to keep the site as is.
+using SiteFilter = std::function<bool(llvm::ArrayRef<Location>)>;
+
 /// Lowers from HLO dialect to pphlo dialect with cli io_vis
 std::unique_ptr<OperationPass<ModuleOp>> createLegalizeToPPHloPass();
 
@@ -48,18 +56,54 @@ std::unique_ptr<OperationPass<func::FuncOp>> createLowerConversionCastPass();
 // Lower min/max
 std::unique_ptr<OperationPass<func::FuncOp>> createDecomposeMinMaxPass();
 
+// Fold public constant subgraphs
+std::unique_ptr<OperationPass<func::FuncOp>> createFoldPublicConstantPass();
+
 // Reduce truncation
 std::unique_ptr<OperationPass<func::FuncOp>> createReduceTruncationPass();
 
+// Defer truncations of products to their sums
+std::unique_ptr<OperationPass<func::FuncOp>> createLazyTruncationPass();
+
 // Lower mixed-type op
 std::unique_ptr<OperationPass<func::FuncOp>> createLowerMixedTypeOpPass();
 
+// Inline ifs of secret conditions, merge their outputs by one select
+std::unique_ptr<OperationPass<func::FuncOp>> createInlineSecretIfPass();
+
+// Unroll small loops of constant trip counts
+std::unique_ptr<OperationPass<func::FuncOp>> createUnrollWhilePass();
+
+// Hoist loop invariant ops out of whiles, and sink p2s converts
+std::unique_ptr<OperationPass<func::FuncOp>> createHoistLoopInvariantPass();
+
 // Optimize MaxPooling layer
 std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeMaxPoolingPass();
 
+// Optimize MaxPooling layer of the sites accepted by `filter`
+std::unique_ptr<OperationPass<func::FuncOp>>
+createOptimizeMaxPoolingPass(SiteFilter filter);
+
+// Optimize sort + slice into TopKOp
+std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeTopKPass();
+
+// Optimize softmax and layer normalization into fused ops
+std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeNormalizationPass();
+
 // Optimize SelectOp
 std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeSelectPass();
 
+// Optimize SelectOp of the sites accepted by `filter`
+std::unique_ptr<OperationPass<func::FuncOp>>
+createOptimizeSelectPass(SiteFilter filter);
+
+// Reorder matmul chains by visibility, and run batched dots of broadcasted
+// weights as one dot
+std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeDotPass();
+
+// Pack independent elementwise ops into one
+std::unique_ptr<OperationPass<func::FuncOp>> createVectorizeElementwisePass();
+
 } // namespace pphlo
 
 } // namespace mlir
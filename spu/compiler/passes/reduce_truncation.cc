@@ -17,7 +17,11 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #include "spu/compiler/passes/pass_details.h"
+#include "spu/compiler/passes/passes.h"
+#include "spu/dialect/pphlo_attrs.h"
+#include "spu/dialect/pphlo_base_enums.h"
 #include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
 
 namespace mlir::pphlo {
 
@@ -82,6 +86,44 @@ public:
   }
 };
 
+// Convert the following pattern %s1 = div(%s0, %p0) into
+// %p1 = div(1, %p0); %s1 = mul(%s0, %p1)
+// so a secret divided by a public is scaled by the public reciprocal instead
+// of a secret division, and MulConverter could merge the reciprocal with
+// other public scalings.
+struct DivConverter : public OpRewritePattern<DivOp> {
+private:
+  TypeTools tools_;
+
+public:
+  explicit DivConverter(MLIRContext *context) : OpRewritePattern(context) {}
+
+  LogicalResult matchAndRewrite(DivOp op,
+                                PatternRewriter &rewriter) const override {
+    auto rhs_type = op.rhs().getType().dyn_cast<RankedTensorType>();
+    if (!rhs_type || !rhs_type.hasStaticShape() ||
+        tools_.getTypeVisibility(op.lhs().getType()) !=
+            Visibility::VIS_SECRET ||
+        tools_.getTypeVisibility(rhs_type) != Visibility::VIS_PUBLIC ||
+        !tools_.isExpressedType<FloatType>(op.lhs().getType()) ||
+        !tools_.isExpressedType<FloatType>(rhs_type)) {
+      return failure();
+    }
+
+    auto expressed_type = tools_.getExpressedType(rhs_type);
+    auto one = rewriter.create<ConstantOp>(
+        op.getLoc(),
+        DenseElementsAttr::get(
+            RankedTensorType::get(rhs_type.getShape(), expressed_type),
+            rewriter.getFloatAttr(expressed_type, 1.0).getValue()));
+    auto reciprocal =
+        rewriter.create<DivOp>(op.getLoc(), rhs_type, one, op.rhs());
+    rewriter.replaceOpWithNewOp<MulOp>(op, op.getType(), op.lhs(),
+                                       reciprocal);
+    return success();
+  }
+};
+
 struct ReduceTruncation : public ReduceTruncBase<ReduceTruncation> {
   void runOnOperation() override {
     RewritePatternSet patterns(&getContext());
@@ -92,13 +134,67 @@ struct ReduceTruncation : public ReduceTruncBase<ReduceTruncation> {
 private:
   void populateOwningPatterns(RewritePatternSet *patterns,
                               MLIRContext *ctx) const {
-    patterns->insert<MulConverter>(ctx);
+    patterns->insert<MulConverter, DivConverter>(ctx);
   }
 };
+
+// Mark ops whose fixed-point results could be truncated later by users, so
+// sums of secret products are truncated once, e.g.
+//   %2 = add(mul(%s0, %s1), dot(%s2, %s3))
+// truncates %2 instead of both products. Users which handle pending
+// truncation bits are add, sub, and slice/reshape which pass them along.
+struct LazyTruncation : public LazyTruncBase<LazyTruncation> {
+  void runOnOperation() override {
+    auto *ctx = &getContext();
+    // Operands are visited before their users.
+    getOperation().walk([&](Operation *op) {
+      if (shouldDeferTrunc(op)) {
+        op->setAttr(kLazyTruncAttrName, UnitAttr::get(ctx));
+      }
+    });
+  }
+
+private:
+  TypeTools tools_;
+
+  static bool handlesPendingTrunc(Operation *op) {
+    return llvm::isa<AddOp, SubtractOp, SliceOp, ReshapeOp>(op);
+  }
+
+  bool shouldDeferTrunc(Operation *op) const {
+    if (op->getNumResults() != 1 || op->use_empty() ||
+        !llvm::all_of(op->getUsers(), handlesPendingTrunc)) {
+      return false;
+    }
+
+    if (llvm::isa<MulOp, DotOp>(op)) {
+      // Truncating public products is free, and mixed int/fxp products are
+      // not truncated at all.
+      return tools_.getTypeVisibility(op->getResult(0).getType()) ==
+                 Visibility::VIS_SECRET &&
+             tools_.isExpressedType<FloatType>(op->getOperand(0).getType()) &&
+             tools_.isExpressedType<FloatType>(op->getOperand(1).getType());
+    }
+
+    if (handlesPendingTrunc(op)) {
+      return llvm::any_of(op->getOperands(), [](mlir::Value operand) {
+        auto *def = operand.getDefiningOp();
+        return def != nullptr && def->hasAttr(kLazyTruncAttrName);
+      });
+    }
+
+    return false;
+  }
+};
+
 } // namespace
 
 std::unique_ptr<OperationPass<func::FuncOp>> createReduceTruncationPass() {
   return std::make_unique<ReduceTruncation>();
 }
 
+std::unique_ptr<OperationPass<func::FuncOp>> createLazyTruncationPass() {
+  return std::make_unique<LazyTruncation>();
+}
+
 } // namespace mlir::pphlo
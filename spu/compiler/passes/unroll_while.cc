@@ -0,0 +1,141 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <optional>
+
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Pass/Pass.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Idea here:
+//   %r = while(%c0, %x) cond { less(%i, %n) } body { add(%i, 1), f(%x) }
+// with constants %c0 and %n, into
+//   %x1 = f(%x), %x2 = f(%x1), ... %xk = f(%xk-1), k = %n - %c0
+// Rational:
+// Each iteration of a loop runs its body region after the previous one, so
+// independent ops of different iterations never share a round. Once unrolled,
+// they live in one block, and could be vectorized into one op, e.g. two
+// independent accumulations of a fixed-iteration Newton step. Only loops of
+// at most `max-unrolled-ops` ops in total are unrolled.
+struct UnrollWhile : public UnrollWhileBase<UnrollWhile> {
+  void runOnOperation() override {
+    // post order, so nested loops are unrolled first.
+    SmallVector<WhileOp> loops;
+    getOperation().walk([&](WhileOp op) { loops.emplace_back(op); });
+    for (auto op : loops) {
+      auto trip_count = getTripCount(op);
+      if (!trip_count.has_value()) {
+        continue;
+      }
+      int64_t body_ops = 0;
+      op.body().walk([&](Operation *) { ++body_ops; });
+      if (*trip_count * body_ops <= max_unrolled_ops_) {
+        unroll(op, *trip_count);
+      }
+    }
+  }
+
+private:
+  TypeTools tools_;
+
+  // The value of a public integer scalar constant.
+  std::optional<int64_t> getConstant(Value v) const {
+    auto constant = v.getDefiningOp<ConstantOp>();
+    if (!constant || !tools_.isMPCType<PublicType>(v.getType())) {
+      return std::nullopt;
+    }
+    auto attr = constant.value().dyn_cast<DenseIntElementsAttr>();
+    if (!attr || !attr.isSplat() || attr.getNumElements() != 1) {
+      return std::nullopt;
+    }
+    return attr.getSplatValue<APInt>().getSExtValue();
+  }
+
+  // The trip count of `for (i = init; i < limit; i += 1)`, where i is an
+  // argument of the loop.
+  std::optional<int64_t> getTripCount(WhileOp op) const {
+    auto &cond = op.cond().front();
+    if (!llvm::hasSingleElement(cond.without_terminator())) {
+      return std::nullopt;
+    }
+    auto less = mlir::dyn_cast<LessOp>(cond.front());
+    if (!less || cond.getTerminator()->getOperand(0) != less.getResult()) {
+      return std::nullopt;
+    }
+    auto counter = less.lhs().dyn_cast<BlockArgument>();
+    auto limit = getConstant(less.rhs());
+    if (!counter || counter.getOwner() != &cond || !limit.has_value()) {
+      return std::nullopt;
+    }
+
+    const auto idx = counter.getArgNumber();
+    auto init = getConstant(op->getOperand(idx));
+    if (!init.has_value()) {
+      return std::nullopt;
+    }
+
+    auto &body = op.body().front();
+    auto add = body.getTerminator()->getOperand(idx).getDefiningOp<AddOp>();
+    if (!add || add->getBlock() != &body) {
+      return std::nullopt;
+    }
+    auto is_counter = [&](Value v) { return v == body.getArgument(idx); };
+    auto is_one = [&](Value v) { return getConstant(v) == 1; };
+    if (!(is_counter(add.lhs()) && is_one(add.rhs())) &&
+        !(is_one(add.lhs()) && is_counter(add.rhs()))) {
+      return std::nullopt;
+    }
+
+    return std::max<int64_t>(*limit - *init, 0);
+  }
+
+  static void unroll(WhileOp op, int64_t trip_count) {
+    OpBuilder builder(op);
+    auto &body = op.body().front();
+
+    SmallVector<Value> values(op->getOperands());
+    for (int64_t iter = 0; iter < trip_count; ++iter) {
+      BlockAndValueMapping mapping;
+      mapping.map(body.getArguments(), values);
+      for (auto &nested : body.without_terminator()) {
+        builder.clone(nested, mapping);
+      }
+      auto *terminator = body.getTerminator();
+      for (unsigned idx = 0; idx < terminator->getNumOperands(); ++idx) {
+        values[idx] = mapping.lookupOrDefault(terminator->getOperand(idx));
+      }
+    }
+
+    op->replaceAllUsesWith(values);
+    op->erase();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createUnrollWhilePass() {
+  return std::make_unique<UnrollWhile>();
+}
+
+} // namespace mlir::pphlo
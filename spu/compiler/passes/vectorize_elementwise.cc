@@ -0,0 +1,207 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+
+#include "llvm/ADT/DenseMap.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/TopologicalSortUtils.h"
+
+#include "spu/compiler/passes/pass_details.h"
+#include "spu/dialect/pphlo_ops.h"
+#include "spu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Idea here:
+//   %a = mul(%x0, %y0)       : tensor<2x3x!sec>
+//   %b = mul(%x1, %y1)       : tensor<4x!sec>
+// into
+//   %x = concat(reshape(%x0), reshape(%x1)) : tensor<10x!sec>
+//   %y = concat(reshape(%y0), reshape(%y1)) : tensor<10x!sec>
+//   %c = mul(%x, %y)
+//   %a = reshape(slice(%c, 0, 6))
+//   %b = reshape(slice(%c, 6, 10))
+// Rational:
+// When %a and %b are independent, each mul costs one round at runtime, after
+// packing, the runtime issues one round instead of N.
+//
+// Cost model: only ops whose secret evaluation is communication bound
+// (mul/and/or/comparison, which involve truncation or a boolean circuit) are
+// packed, pure local ops gain nothing from it but extra copies.
+struct VectorizeElementwise
+    : public VectorizeElementwiseBase<VectorizeElementwise> {
+  void runOnOperation() override {
+    SmallVector<Block *> blocks;
+    getOperation().walk([&](Block *block) { blocks.emplace_back(block); });
+    for (auto *block : blocks) {
+      vectorizeBlock(block);
+    }
+  }
+
+private:
+  TypeTools tools_;
+
+  bool isCommunicationBound(Operation *op) const {
+    if (!mlir::isa<MulOp, AndOp, OrOp, LessOp, GreaterOp, LessEqualOp,
+                   GreaterEqualOp, EqualOp, NotEqualOp>(op)) {
+      return false;
+    }
+
+    bool has_secret = false;
+    for (auto operand : op->getOperands()) {
+      auto type = operand.getType().dyn_cast<RankedTensorType>();
+      if (!type || !type.hasStaticShape() || type.getNumElements() == 0) {
+        return false;
+      }
+      has_secret |= tools_.getTypeVisibility(type) == Visibility::VIS_SECRET;
+    }
+
+    return has_secret;
+  }
+
+  // Group key: op name plus element (mpc) types of all operands, shapes are
+  // allowed to differ since operands are flattened.
+  static std::string getGroupKey(Operation *op) {
+    std::string key;
+    llvm::raw_string_ostream os(key);
+    os << op->getName().getStringRef();
+    for (auto operand : op->getOperands()) {
+      os << ":" << operand.getType().cast<RankedTensorType>().getElementType();
+    }
+    os << "->"
+       << op->getResult(0).getType().cast<RankedTensorType>().getElementType();
+    return os.str();
+  }
+
+  void vectorizeBlock(Block *block) {
+    if (block->empty()) {
+      return;
+    }
+
+    // Dependency depth of ops, values captured by nested regions count.
+    llvm::DenseMap<Operation *, int64_t> depth;
+    std::map<std::pair<int64_t, std::string>, SmallVector<Operation *>> groups;
+
+    for (auto &op : block->without_terminator()) {
+      int64_t level = 0;
+      op.walk([&](Operation *nested) {
+        for (auto operand : nested->getOperands()) {
+          auto *def = operand.getDefiningOp();
+          if (def != nullptr && def->getBlock() == block) {
+            level = std::max(level, depth[def] + 1);
+          }
+        }
+      });
+      depth[&op] = level;
+
+      if (isCommunicationBound(&op)) {
+        groups[{level, getGroupKey(&op)}].push_back(&op);
+      }
+    }
+
+    bool changed = false;
+    for (auto &[key, ops] : groups) {
+      if (ops.size() > 1) {
+        vectorizeGroup(block, ops);
+        changed = true;
+      }
+    }
+
+    if (changed) {
+      // users of the packed ops may now precede the new slices, restore the
+      // def-before-use order.
+      (void)sortTopologically(block);
+    }
+  }
+
+  static Value flattenTo1D(OpBuilder &builder, Location loc, Value v) {
+    auto type = v.getType().cast<RankedTensorType>();
+    if (type.getRank() == 1) {
+      return v;
+    }
+    auto flat_type =
+        RankedTensorType::get({type.getNumElements()}, type.getElementType());
+    return builder.create<ReshapeOp>(loc, flat_type, v);
+  }
+
+  void vectorizeGroup(Block *block, llvm::ArrayRef<Operation *> ops) {
+    // Insert before terminator, where all operands are already defined.
+    OpBuilder builder(block->getTerminator());
+    auto loc = ops.front()->getLoc();
+    const auto num_operands = ops.front()->getNumOperands();
+
+    int64_t total = 0;
+    for (auto *op : ops) {
+      total +=
+          op->getResult(0).getType().cast<RankedTensorType>().getNumElements();
+    }
+
+    SmallVector<Value> packed_operands;
+    for (unsigned arg_idx = 0; arg_idx < num_operands; ++arg_idx) {
+      SmallVector<Value> pieces;
+      for (auto *op : ops) {
+        pieces.emplace_back(flattenTo1D(builder, loc, op->getOperand(arg_idx)));
+      }
+      auto el_type = ops.front()
+                         ->getOperand(arg_idx)
+                         .getType()
+                         .cast<RankedTensorType>()
+                         .getElementType();
+      packed_operands.emplace_back(builder.create<ConcatenateOp>(
+          loc, RankedTensorType::get({total}, el_type), pieces,
+          builder.getI64IntegerAttr(0)));
+    }
+
+    auto ret_el_type = ops.front()
+                           ->getResult(0)
+                           .getType()
+                           .cast<RankedTensorType>()
+                           .getElementType();
+    OperationState state(loc, ops.front()->getName());
+    state.addOperands(packed_operands);
+    state.addTypes(RankedTensorType::get({total}, ret_el_type));
+    state.addAttributes(ops.front()->getAttrs());
+    auto *packed = builder.create(state);
+
+    int64_t offset = 0;
+    for (auto *op : ops) {
+      auto ret_type = op->getResult(0).getType().cast<RankedTensorType>();
+      const int64_t numel = ret_type.getNumElements();
+      Value piece = builder.create<SliceOp>(
+          loc, RankedTensorType::get({numel}, ret_el_type),
+          packed->getResult(0), builder.getI64TensorAttr({offset}),
+          builder.getI64TensorAttr({offset + numel}),
+          builder.getI64TensorAttr({1}));
+      if (ret_type.getRank() != 1) {
+        piece = builder.create<ReshapeOp>(loc, ret_type, piece);
+      }
+      op->getResult(0).replaceAllUsesWith(piece);
+      op->erase();
+      offset += numel;
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createVectorizeElementwisePass() {
+  return std::make_unique<VectorizeElementwise>();
+}
+
+} // namespace mlir::pphlo
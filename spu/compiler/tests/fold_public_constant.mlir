@@ -0,0 +1,42 @@
+// RUN: mlir-pphlo-opt --fold-public-constant --split-input-file %s | FileCheck %s
+
+func.func @add() -> (tensor<2x!pphlo.pub<i32>>) {
+    //CHECK: %0 = "pphlo.constant"() {value = dense<[4, 6]> : tensor<2xi32>} : () -> tensor<2x!pphlo.pub<i32>>
+    //CHECK-NEXT: return %0
+    %0 = "pphlo.constant"() {value = dense<[1, 2]> : tensor<2xi32>} : () -> tensor<2x!pphlo.pub<i32>>
+    %1 = "pphlo.constant"() {value = dense<[3, 4]> : tensor<2xi32>} : () -> tensor<2x!pphlo.pub<i32>>
+    %2 = "pphlo.add"(%0, %1) : (tensor<2x!pphlo.pub<i32>>, tensor<2x!pphlo.pub<i32>>) -> tensor<2x!pphlo.pub<i32>>
+    return %2 : tensor<2x!pphlo.pub<i32>>
+}
+
+// -----
+
+func.func @chain() -> (tensor<2x2x!pphlo.pub<i1>>) {
+    //CHECK: %0 = "pphlo.constant"() {value = dense<[true, false]> : tensor<2xi1>} : () -> tensor<2x!pphlo.pub<i1>>
+    //CHECK: %1 = "pphlo.constant"() {value = dense<{{\[\[}}true, false], [true, false]]> : tensor<2x2xi1>} : () -> tensor<2x2x!pphlo.pub<i1>>
+    //CHECK-NEXT: return %1
+    %0 = "pphlo.constant"() {value = dense<[1.0, 3.0]> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<2.0> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    %2 = "pphlo.less"(%0, %1) : (tensor<2x!pphlo.pub<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.pub<i1>>
+    %3 = "pphlo.broadcast"(%2) {broadcast_dimensions = dense<1> : tensor<1xi64>} : (tensor<2x!pphlo.pub<i1>>) -> tensor<2x2x!pphlo.pub<i1>>
+    return %3 : tensor<2x2x!pphlo.pub<i1>>
+}
+
+// -----
+
+func.func @secret(%arg0: tensor<2x!pphlo.sec<f32>>) -> (tensor<2x!pphlo.sec<f32>>) {
+    //CHECK: %1 = "pphlo.multiply"(%arg0, %0)
+    %0 = "pphlo.constant"() {value = dense<2.0> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    %1 = "pphlo.multiply"(%arg0, %0) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    return %1 : tensor<2x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @div_by_zero() -> (tensor<!pphlo.pub<i32>>) {
+    //CHECK: "pphlo.divide"
+    %0 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    %1 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    %2 = "pphlo.divide"(%0, %1) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+    return %2 : tensor<!pphlo.pub<i32>>
+}
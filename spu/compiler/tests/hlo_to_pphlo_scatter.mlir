@@ -0,0 +1,13 @@
+// RUN: mlir-pphlo-opt --hlo-legalize-to-pphlo='io-visibility-json={"inputs":["VIS_PUBLIC","VIS_SECRET","VIS_PUBLIC"]}' --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<5x2xf32>, %arg1: tensor<3x1xi32>, %arg2: tensor<3x2xf32>) -> tensor<5x2xf32> {
+  // CHECK: %0 = "pphlo.scatter_add"(%arg0, %arg1, %arg2)
+  // CHECK-SAME: #pphlo.scatter<update_window_dims = [1], inserted_window_dims = [0], scatter_dims_to_operand_dims = [0], index_vector_dim = 1>
+  // CHECK-SAME: (tensor<5x2x!pphlo.pub<f32>>, tensor<3x1x!pphlo.sec<i32>>, tensor<3x2x!pphlo.pub<f32>>) -> tensor<5x2x!pphlo.sec<f32>>
+  %0 = "mhlo.scatter"(%arg0, %arg1, %arg2) ({
+    ^bb0(%arg3: tensor<f32>, %arg4: tensor<f32>):
+        %1 = mhlo.add %arg3, %arg4 : tensor<f32>
+        "mhlo.return"(%1) : (tensor<f32>) -> ()
+    }) {indices_are_sorted = false, scatter_dimension_numbers = #mhlo.scatter<update_window_dims = [1], inserted_window_dims = [0], scatter_dims_to_operand_dims = [0], index_vector_dim = 1>, unique_indices = false} : (tensor<5x2xf32>, tensor<3x1xi32>, tensor<3x2xf32>) -> tensor<5x2xf32>
+  return %0 : tensor<5x2xf32>
+}
@@ -0,0 +1,39 @@
+// RUN: mlir-pphlo-opt --hoist-loop-invariant --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<3x!pphlo.sec<f32>>, %arg2: tensor<3x!pphlo.pub<f32>>) -> (tensor<3x!pphlo.sec<f32>>) {
+    //CHECK: %[[ONE:.*]] = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    //CHECK: %[[W:.*]] = "pphlo.multiply"(%arg2, %arg2) : (tensor<3x!pphlo.pub<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.pub<f32>>
+    //CHECK: %[[LOOP:.*]]:3 = "pphlo.while"(%arg0, %arg1, %arg2) ({
+    //CHECK: ^bb0(%arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<3x!pphlo.sec<f32>>, %arg5: tensor<3x!pphlo.pub<f32>>):
+    //CHECK: },  {
+    //CHECK: ^bb0(%arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<3x!pphlo.sec<f32>>, %arg5: tensor<3x!pphlo.pub<f32>>):
+    //CHECK-NEXT: %[[I:.*]] = "pphlo.add"(%arg3, %[[ONE]])
+    //CHECK-NEXT: %[[X:.*]] = "pphlo.multiply"(%arg4, %[[W]])
+    //CHECK-NEXT: "pphlo.return"(%[[I]], %[[X]], %arg5)
+    %0:3 = "pphlo.while"(%arg0, %arg1, %arg2) ({
+    ^bb0(%arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<3x!pphlo.sec<f32>>, %arg5: tensor<3x!pphlo.pub<f32>>):
+      %1 = "pphlo.constant"() {value = dense<10> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %2 = "pphlo.less"(%arg3, %1) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%2) : (tensor<!pphlo.pub<i1>>) -> ()
+    },  {
+    ^bb0(%arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<3x!pphlo.sec<f32>>, %arg5: tensor<3x!pphlo.pub<f32>>):
+      %1 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %2 = "pphlo.add"(%arg3, %1) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.multiply"(%arg5, %arg5) : (tensor<3x!pphlo.pub<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.pub<f32>>
+      %4 = "pphlo.multiply"(%arg4, %3) : (tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.sec<f32>>
+      "pphlo.return"(%2, %4, %arg5) : (tensor<!pphlo.pub<i32>>, tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.pub<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.pub<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.pub<f32>>)
+    return %0#1 : tensor<3x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<3x!pphlo.pub<f32>>, %arg1: tensor<3x!pphlo.pub<f32>>) -> (tensor<3x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<3x!pphlo.pub<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.pub<f32>>
+    //CHECK: %1 = "pphlo.add"(%0, %arg1) : (tensor<3x!pphlo.pub<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.pub<f32>>
+    //CHECK: %2 = "pphlo.convert"(%1) : (tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    %0 = "pphlo.convert"(%arg0) : (tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%0, %arg1) : (tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    %2 = "pphlo.add"(%1, %arg1) : (tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    return %2 : tensor<3x!pphlo.sec<f32>>
+}
@@ -0,0 +1,37 @@
+// RUN: mlir-pphlo-opt --inline-secret-if --cse --split-input-file %s | FileCheck %s
+
+func.func @secret_if(%arg0: tensor<2x2x!pphlo.sec<f32>>, %arg1: tensor<2x2x!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<i1>>) -> (tensor<2x2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) {
+    //CHECK-NOT: pphlo.if
+    //CHECK: "pphlo.multiply"(%arg0, %arg1)
+    //CHECK-NOT: "pphlo.multiply"(%arg0, %arg1)
+    //CHECK: %[[T:.*]] = "pphlo.concatenate"
+    //CHECK: %[[F:.*]] = "pphlo.concatenate"
+    //CHECK: %[[C:.*]] = "pphlo.broadcast"(%arg2) {broadcast_dimensions = dense<> : tensor<0xi64>} : (tensor<!pphlo.sec<i1>>) -> tensor<8x!pphlo.sec<i1>>
+    //CHECK: "pphlo.select"(%[[C]], %[[T]], %[[F]]) : (tensor<8x!pphlo.sec<i1>>, tensor<8x!pphlo.sec<f32>>, tensor<8x!pphlo.sec<f32>>) -> tensor<8x!pphlo.sec<f32>>
+    //CHECK-NOT: "pphlo.select"
+    %0:2 = "pphlo.if"(%arg2) ({
+      %1 = "pphlo.multiply"(%arg0, %arg1) : (tensor<2x2x!pphlo.sec<f32>>, tensor<2x2x!pphlo.sec<f32>>) -> tensor<2x2x!pphlo.sec<f32>>
+      %2 = "pphlo.reshape"(%1) : (tensor<2x2x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%1, %2) : (tensor<2x2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.multiply"(%arg0, %arg1) : (tensor<2x2x!pphlo.sec<f32>>, tensor<2x2x!pphlo.sec<f32>>) -> tensor<2x2x!pphlo.sec<f32>>
+      %2 = "pphlo.add"(%1, %arg0) : (tensor<2x2x!pphlo.sec<f32>>, tensor<2x2x!pphlo.sec<f32>>) -> tensor<2x2x!pphlo.sec<f32>>
+      %3 = "pphlo.reshape"(%arg1) : (tensor<2x2x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%2, %3) : (tensor<2x2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.sec<i1>>) -> (tensor<2x2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>)
+    return %0#0, %0#1 : tensor<2x2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @public_if(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<!pphlo.pub<i1>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    //CHECK: pphlo.if
+    //CHECK-NOT: pphlo.select
+    %0 = "pphlo.if"(%arg1) ({
+      %1 = "pphlo.multiply"(%arg0, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%1) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      "pphlo.return"(%arg0) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i1>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0 : tensor<4x!pphlo.sec<f32>>
+}
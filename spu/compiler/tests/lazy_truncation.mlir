@@ -0,0 +1,29 @@
+// RUN: mlir-pphlo-opt --lazy-truncation --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<4x4x!pphlo.sec<f32>>, %arg1: tensor<4x4x!pphlo.pub<f32>>) -> (tensor<4x4x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.multiply"(%arg0, %arg1) {pphlo.lazy_trunc}
+    //CHECK: %1 = "pphlo.dot"(%arg0, %arg0) {pphlo.lazy_trunc}
+    //CHECK: %2 = "pphlo.add"(%0, %1) {pphlo.lazy_trunc}
+    //CHECK: %3 = "pphlo.subtract"(%2, %arg0) :
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x4x!pphlo.sec<f32>>, tensor<4x4x!pphlo.pub<f32>>) -> tensor<4x4x!pphlo.sec<f32>>
+    %1 = "pphlo.dot"(%arg0, %arg0) : (tensor<4x4x!pphlo.sec<f32>>, tensor<4x4x!pphlo.sec<f32>>) -> tensor<4x4x!pphlo.sec<f32>>
+    %2 = "pphlo.add"(%0, %1) : (tensor<4x4x!pphlo.sec<f32>>, tensor<4x4x!pphlo.sec<f32>>) -> tensor<4x4x!pphlo.sec<f32>>
+    %3 = "pphlo.subtract"(%2, %arg0) : (tensor<4x4x!pphlo.sec<f32>>, tensor<4x4x!pphlo.sec<f32>>) -> tensor<4x4x!pphlo.sec<f32>>
+    return %3 : tensor<4x4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<4x!pphlo.pub<f32>>) -> (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) {
+    // used by a non-linear op
+    //CHECK: %0 = "pphlo.multiply"(%arg0, %arg0) :
+    //CHECK: %1 = "pphlo.exponential"(%0) :
+    // public products are truncated for free
+    //CHECK: %2 = "pphlo.multiply"(%arg1, %arg1) :
+    //CHECK: %3 = "pphlo.add"(%2, %arg1) :
+    %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %1 = "pphlo.exponential"(%0) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %2 = "pphlo.multiply"(%arg1, %arg1) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.pub<f32>>
+    %3 = "pphlo.add"(%2, %arg1) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.pub<f32>>
+    return %1, %3 : tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>
+}
@@ -0,0 +1,53 @@
+// RUN: mlir-pphlo-opt --optimize-dot --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<16x64x!pphlo.sec<f32>>, %arg1: tensor<64x64x!pphlo.sec<f32>>, %arg2: tensor<64x2x!pphlo.pub<f32>>) -> (tensor<16x2x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.dot"(%arg1, %arg2) : (tensor<64x64x!pphlo.sec<f32>>, tensor<64x2x!pphlo.pub<f32>>) -> tensor<64x2x!pphlo.sec<f32>>
+    //CHECK: %1 = "pphlo.dot"(%arg0, %0) : (tensor<16x64x!pphlo.sec<f32>>, tensor<64x2x!pphlo.sec<f32>>) -> tensor<16x2x!pphlo.sec<f32>>
+    %0 = "pphlo.dot"(%arg0, %arg1) : (tensor<16x64x!pphlo.sec<f32>>, tensor<64x64x!pphlo.sec<f32>>) -> tensor<16x64x!pphlo.sec<f32>>
+    %1 = "pphlo.dot"(%0, %arg2) : (tensor<16x64x!pphlo.sec<f32>>, tensor<64x2x!pphlo.pub<f32>>) -> tensor<16x2x!pphlo.sec<f32>>
+    return %1 : tensor<16x2x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<2x64x!pphlo.pub<f32>>, %arg1: tensor<64x64x!pphlo.pub<f32>>, %arg2: tensor<64x16x!pphlo.sec<f32>>) -> (tensor<2x16x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.dot"(%arg0, %arg1) : (tensor<2x64x!pphlo.pub<f32>>, tensor<64x64x!pphlo.pub<f32>>) -> tensor<2x64x!pphlo.pub<f32>>
+    //CHECK: %1 = "pphlo.dot"(%0, %arg2) : (tensor<2x64x!pphlo.pub<f32>>, tensor<64x16x!pphlo.sec<f32>>) -> tensor<2x16x!pphlo.sec<f32>>
+    %0 = "pphlo.dot"(%arg1, %arg2) : (tensor<64x64x!pphlo.pub<f32>>, tensor<64x16x!pphlo.sec<f32>>) -> tensor<64x16x!pphlo.sec<f32>>
+    %1 = "pphlo.dot"(%arg0, %0) : (tensor<2x64x!pphlo.pub<f32>>, tensor<64x16x!pphlo.sec<f32>>) -> tensor<2x16x!pphlo.sec<f32>>
+    return %1 : tensor<2x16x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<16x64x!pphlo.sec<f32>>, %arg1: tensor<64x64x!pphlo.sec<f32>>, %arg2: tensor<64x2x!pphlo.pub<f32>>) -> (tensor<16x2x!pphlo.sec<f32>>, tensor<16x64x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.dot"(%arg0, %arg1)
+    //CHECK: %1 = "pphlo.dot"(%0, %arg2)
+    %0 = "pphlo.dot"(%arg0, %arg1) : (tensor<16x64x!pphlo.sec<f32>>, tensor<64x64x!pphlo.sec<f32>>) -> tensor<16x64x!pphlo.sec<f32>>
+    %1 = "pphlo.dot"(%0, %arg2) : (tensor<16x64x!pphlo.sec<f32>>, tensor<64x2x!pphlo.pub<f32>>) -> tensor<16x2x!pphlo.sec<f32>>
+    return %1, %0 : tensor<16x2x!pphlo.sec<f32>>, tensor<16x64x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<8x16x32x!pphlo.sec<f32>>, %arg1: tensor<32x4x!pphlo.pub<f32>>) -> (tensor<8x16x4x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.reshape"(%arg0) : (tensor<8x16x32x!pphlo.sec<f32>>) -> tensor<128x32x!pphlo.sec<f32>>
+    //CHECK: %1 = "pphlo.dot"(%0, %arg1) : (tensor<128x32x!pphlo.sec<f32>>, tensor<32x4x!pphlo.pub<f32>>) -> tensor<128x4x!pphlo.sec<f32>>
+    //CHECK: %2 = "pphlo.reshape"(%1) : (tensor<128x4x!pphlo.sec<f32>>) -> tensor<8x16x4x!pphlo.sec<f32>>
+    %0 = "pphlo.broadcast"(%arg1) {broadcast_dimensions = dense<[1, 2]> : tensor<2xi64>} : (tensor<32x4x!pphlo.pub<f32>>) -> tensor<8x32x4x!pphlo.pub<f32>>
+    %1 = "pphlo.dot_general"(%arg0, %0) {dot_dimension_numbers = #pphlo.dot<lhs_batching_dimensions = [0], rhs_batching_dimensions = [0], lhs_contracting_dimensions = [2], rhs_contracting_dimensions = [1]>} : (tensor<8x16x32x!pphlo.sec<f32>>, tensor<8x32x4x!pphlo.pub<f32>>) -> tensor<8x16x4x!pphlo.sec<f32>>
+    return %1 : tensor<8x16x4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<16x32x!pphlo.sec<f32>>, %arg1: tensor<8x32x4x!pphlo.sec<f32>>) -> (tensor<8x16x4x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.transpose"(%arg1) {permutation = dense<[1, 0, 2]> : tensor<3xi64>} : (tensor<8x32x4x!pphlo.sec<f32>>) -> tensor<32x8x4x!pphlo.sec<f32>>
+    //CHECK: %1 = "pphlo.reshape"(%0) : (tensor<32x8x4x!pphlo.sec<f32>>) -> tensor<32x32x!pphlo.sec<f32>>
+    //CHECK: %2 = "pphlo.dot"(%arg0, %1) : (tensor<16x32x!pphlo.sec<f32>>, tensor<32x32x!pphlo.sec<f32>>) -> tensor<16x32x!pphlo.sec<f32>>
+    //CHECK: %3 = "pphlo.reshape"(%2) : (tensor<16x32x!pphlo.sec<f32>>) -> tensor<16x8x4x!pphlo.sec<f32>>
+    //CHECK: %4 = "pphlo.transpose"(%3) {permutation = dense<[1, 0, 2]> : tensor<3xi64>} : (tensor<16x8x4x!pphlo.sec<f32>>) -> tensor<8x16x4x!pphlo.sec<f32>>
+    %0 = "pphlo.broadcast"(%arg0) {broadcast_dimensions = dense<[1, 2]> : tensor<2xi64>} : (tensor<16x32x!pphlo.sec<f32>>) -> tensor<8x16x32x!pphlo.sec<f32>>
+    %1 = "pphlo.dot_general"(%0, %arg1) {dot_dimension_numbers = #pphlo.dot<lhs_batching_dimensions = [0], rhs_batching_dimensions = [0], lhs_contracting_dimensions = [2], rhs_contracting_dimensions = [1]>} : (tensor<8x16x32x!pphlo.sec<f32>>, tensor<8x32x4x!pphlo.sec<f32>>) -> tensor<8x16x4x!pphlo.sec<f32>>
+    return %1 : tensor<8x16x4x!pphlo.sec<f32>>
+}
@@ -24,4 +24,41 @@ func.func @main(%arg0: tensor<129x24x24x16x!pphlo.sec<f32>>, %arg1: tensor<129x2
     }) {padding = dense<0> : tensor<4x2xi64>, window_dimensions = dense<[1, 2, 2, 1]> : tensor<4xi64>, window_strides = dense<1> : tensor<4xi64>} : (tensor<129x24x24x16x!pphlo.sec<f32>>, tensor<129x23x23x16x!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<129x24x24x16x!pphlo.sec<f32>>
    
     return %4, %5 : tensor<129x23x23x16x!pphlo.sec<f32>>, tensor<129x24x24x16x!pphlo.sec<f32>>
-}
\ No newline at end of file
+}
+
+// -----
+
+func.func @main(%arg0: tensor<1x4x4x1x!pphlo.sec<f32>>, %arg1: tensor<1x2x2x1x!pphlo.sec<f32>>, %arg2: tensor<1x2x2x1x!pphlo.sec<f32>>) -> (tensor<1x2x2x1x!pphlo.sec<f32>>, tensor<1x4x4x1x!pphlo.sec<f32>>, tensor<1x4x4x1x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0xFF800000> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %2 = "pphlo.convert"(%0) : (tensor<!pphlo.pub<f32>>) -> tensor<!pphlo.sec<f32>>
+    %3 = "pphlo.convert"(%1) : (tensor<!pphlo.pub<f32>>) -> tensor<!pphlo.sec<f32>>
+    //CHECK: %[[ARGMAX:.*]]:2 = "pphlo.argmax"(%arg0)
+    //CHECK-NOT: pphlo.argmax
+    %4 = "pphlo.reduce_window"(%arg0, %2) ({
+    ^bb0(%arg3: tensor<!pphlo.sec<f32>>, %arg4: tensor<!pphlo.sec<f32>>):
+      %7 = "pphlo.maximum"(%arg3, %arg4) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%7) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {base_dilations = dense<1> : tensor<4xi64>, padding = dense<0> : tensor<4x2xi64>, window_dilations = dense<1> : tensor<4xi64>, window_dimensions = dense<[1, 2, 2, 1]> : tensor<4xi64>, window_strides = dense<[1, 2, 2, 1]> : tensor<4xi64>} : (tensor<1x4x4x1x!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<1x2x2x1x!pphlo.sec<f32>>
+    //CHECK: "pphlo.maxpool_scatter"(%[[ARGMAX]]#1, %arg1)
+    %5 = "pphlo.select_and_scatter"(%arg0, %arg1, %3) ({
+    ^bb0(%arg3: tensor<!pphlo.sec<f32>>, %arg4: tensor<!pphlo.sec<f32>>):
+      %7 = "pphlo.greater_equal"(%arg3, %arg4) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<i1>>
+      "pphlo.return"(%7) : (tensor<!pphlo.sec<i1>>) -> ()
+    }, {
+    ^bb0(%arg3: tensor<!pphlo.sec<f32>>, %arg4: tensor<!pphlo.sec<f32>>):
+      %7 = "pphlo.add"(%arg3, %arg4) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%7) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {padding = dense<0> : tensor<4x2xi64>, window_dimensions = dense<[1, 2, 2, 1]> : tensor<4xi64>, window_strides = dense<[1, 2, 2, 1]> : tensor<4xi64>} : (tensor<1x4x4x1x!pphlo.sec<f32>>, tensor<1x2x2x1x!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<1x4x4x1x!pphlo.sec<f32>>
+    //CHECK: "pphlo.maxpool_scatter"(%[[ARGMAX]]#1, %arg2)
+    %6 = "pphlo.select_and_scatter"(%arg0, %arg2, %3) ({
+    ^bb0(%arg3: tensor<!pphlo.sec<f32>>, %arg4: tensor<!pphlo.sec<f32>>):
+      %7 = "pphlo.greater_equal"(%arg3, %arg4) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<i1>>
+      "pphlo.return"(%7) : (tensor<!pphlo.sec<i1>>) -> ()
+    }, {
+    ^bb0(%arg3: tensor<!pphlo.sec<f32>>, %arg4: tensor<!pphlo.sec<f32>>):
+      %7 = "pphlo.add"(%arg3, %arg4) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%7) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {padding = dense<0> : tensor<4x2xi64>, window_dimensions = dense<[1, 2, 2, 1]> : tensor<4xi64>, window_strides = dense<[1, 2, 2, 1]> : tensor<4xi64>} : (tensor<1x4x4x1x!pphlo.sec<f32>>, tensor<1x2x2x1x!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<1x4x4x1x!pphlo.sec<f32>>
+    return %4, %5, %6 : tensor<1x2x2x1x!pphlo.sec<f32>>, tensor<1x4x4x1x!pphlo.sec<f32>>, tensor<1x4x4x1x!pphlo.sec<f32>>
+}
@@ -0,0 +1,80 @@
+// RUN: mlir-pphlo-opt --optimize-normalization --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<2x4x!pphlo.sec<f32>>) -> (tensor<2x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0xFF800000> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    //CHECK: "pphlo.softmax"(%arg0) {axis = 1 : i64} : (tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    //CHECK-NOT: pphlo.divide
+    %2 = "pphlo.reduce"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %10 = "pphlo.maximum"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%10) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %3 = "pphlo.reshape"(%2) : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x1x!pphlo.sec<f32>>
+    %4 = "pphlo.broadcast"(%3) {broadcast_dimensions = dense<[0, 1]> : tensor<2xi64>} : (tensor<2x1x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %5 = "pphlo.subtract"(%arg0, %4) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %6 = "pphlo.exponential"(%5) : (tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %7 = "pphlo.reduce"(%6, %1) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %10 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%10) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %8 = "pphlo.broadcast"(%7) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %9 = "pphlo.divide"(%6, %8) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    return %9 : tensor<2x4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<2x4x!pphlo.sec<f32>>) -> (tensor<2x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<4.000000e+00> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    %2 = "pphlo.constant"() {value = dense<1.000000e-03> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    //CHECK: "pphlo.layer_norm"(%arg0) {axis = 1 : i64, epsilon = 1.000000e-03 : f64} : (tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    //CHECK-NOT: pphlo.rsqrt
+    %3 = "pphlo.reduce"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %20 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%20) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %4 = "pphlo.divide"(%3, %1) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %5 = "pphlo.broadcast"(%4) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %6 = "pphlo.subtract"(%arg0, %5) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %7 = "pphlo.multiply"(%6, %6) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %8 = "pphlo.reduce"(%7, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %20 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%20) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %9 = "pphlo.divide"(%8, %1) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %10 = "pphlo.add"(%9, %2) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %11 = "pphlo.rsqrt"(%10) : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %12 = "pphlo.broadcast"(%11) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %13 = "pphlo.multiply"(%6, %12) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    return %13 : tensor<2x4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<2x4x!pphlo.sec<f32>>) -> (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0xFF800000> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    //CHECK-NOT: pphlo.softmax
+    %2 = "pphlo.reduce"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %10 = "pphlo.maximum"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%10) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %4 = "pphlo.broadcast"(%2) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %5 = "pphlo.subtract"(%arg0, %4) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %6 = "pphlo.exponential"(%5) : (tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %7 = "pphlo.reduce"(%6, %1) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %10 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%10) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %8 = "pphlo.broadcast"(%7) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    %9 = "pphlo.divide"(%6, %8) : (tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    // the exponentials are used elsewhere.
+    return %9, %6 : tensor<2x4x!pphlo.sec<f32>>, tensor<2x4x!pphlo.sec<f32>>
+}
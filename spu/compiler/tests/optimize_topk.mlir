@@ -0,0 +1,32 @@
+// RUN: mlir-pphlo-opt --optimize-topk --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<4x16x!pphlo.sec<f32>>) -> (tensor<4x3x!pphlo.sec<f32>>, tensor<4x3x!pphlo.pub<i32>>) {
+    %0 = "pphlo.iota"() {iota_dimension = 1 : i64} : () -> tensor<4x16x!pphlo.pub<i32>>
+    //CHECK-NOT: pphlo.sort
+    //CHECK: "pphlo.top_k"(%arg0) {k = 3 : i64} : (tensor<4x16x!pphlo.sec<f32>>) -> (tensor<4x3x!pphlo.sec<f32>>, tensor<4x3x!pphlo.pub<i32>>)
+    %1:2 = "pphlo.sort"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>, %arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<!pphlo.pub<i32>>):
+      %4 = "pphlo.greater"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<i1>>
+      "pphlo.return"(%4) : (tensor<!pphlo.sec<i1>>) -> ()
+    }) {dimension = 1 : i64, is_stable = true} : (tensor<4x16x!pphlo.sec<f32>>, tensor<4x16x!pphlo.pub<i32>>) -> (tensor<4x16x!pphlo.sec<f32>>, tensor<4x16x!pphlo.pub<i32>>)
+    //CHECK-NOT: pphlo.slice
+    %2 = "pphlo.slice"(%1#0) {limit_indices = dense<[4, 3]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<4x16x!pphlo.sec<f32>>) -> tensor<4x3x!pphlo.sec<f32>>
+    %3 = "pphlo.slice"(%1#1) {limit_indices = dense<[4, 3]> : tensor<2xi64>, start_indices = dense<0> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>} : (tensor<4x16x!pphlo.pub<i32>>) -> tensor<4x3x!pphlo.pub<i32>>
+    return %2, %3 : tensor<4x3x!pphlo.sec<f32>>, tensor<4x3x!pphlo.pub<i32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<16x!pphlo.sec<f32>>) -> (tensor<16x!pphlo.sec<f32>>, tensor<3x!pphlo.sec<f32>>) {
+    %0 = "pphlo.iota"() {iota_dimension = 0 : i64} : () -> tensor<16x!pphlo.pub<i32>>
+    //CHECK-NOT: pphlo.top_k
+    //CHECK: pphlo.sort
+    %1:2 = "pphlo.sort"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>, %arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<!pphlo.pub<i32>>):
+      %3 = "pphlo.greater"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<i1>>
+      "pphlo.return"(%3) : (tensor<!pphlo.sec<i1>>) -> ()
+    }) {dimension = 0 : i64, is_stable = true} : (tensor<16x!pphlo.sec<f32>>, tensor<16x!pphlo.pub<i32>>) -> (tensor<16x!pphlo.sec<f32>>, tensor<16x!pphlo.pub<i32>>)
+    // the sorted values are used as a whole.
+    %2 = "pphlo.slice"(%1#0) {limit_indices = dense<3> : tensor<1xi64>, start_indices = dense<0> : tensor<1xi64>, strides = dense<1> : tensor<1xi64>} : (tensor<16x!pphlo.sec<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    return %1#0, %2 : tensor<16x!pphlo.sec<f32>>, tensor<3x!pphlo.sec<f32>>
+}
@@ -7,3 +7,23 @@ func.func @main(%arg0: tensor<31x1x!pphlo.pub<f32>>, %arg1: tensor<31x1x!pphlo.s
     %1 = "pphlo.multiply"(%0, %arg0) : (tensor<31x1x!pphlo.sec<f32>>, tensor<31x1x!pphlo.pub<f32>>) -> tensor<31x1x!pphlo.sec<f32>>
     return %1 : tensor<31x1x!pphlo.sec<f32>>
 }
+
+// -----
+
+func.func @main(%arg0: tensor<31x1x!pphlo.pub<f32>>, %arg1: tensor<31x1x!pphlo.sec<f32>>) -> (tensor<31x1x!pphlo.sec<f32>>) {
+    //CHECK: %0 = "pphlo.constant"() {value = dense<1.000000e+00> : tensor<31x1xf32>} : () -> tensor<31x1x!pphlo.pub<f32>>
+    //CHECK: %1 = "pphlo.divide"(%0, %arg0) : (tensor<31x1x!pphlo.pub<f32>>, tensor<31x1x!pphlo.pub<f32>>) -> tensor<31x1x!pphlo.pub<f32>>
+    //CHECK: %2 = "pphlo.multiply"(%1, %arg0) : (tensor<31x1x!pphlo.pub<f32>>, tensor<31x1x!pphlo.pub<f32>>) -> tensor<31x1x!pphlo.pub<f32>>
+    //CHECK: %3 = "pphlo.multiply"(%2, %arg1) : (tensor<31x1x!pphlo.pub<f32>>, tensor<31x1x!pphlo.sec<f32>>) -> tensor<31x1x!pphlo.sec<f32>>
+    %0 = "pphlo.divide"(%arg1, %arg0) : (tensor<31x1x!pphlo.sec<f32>>, tensor<31x1x!pphlo.pub<f32>>) -> tensor<31x1x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%0, %arg0) : (tensor<31x1x!pphlo.sec<f32>>, tensor<31x1x!pphlo.pub<f32>>) -> tensor<31x1x!pphlo.sec<f32>>
+    return %1 : tensor<31x1x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<31x1x!pphlo.pub<i32>>, %arg1: tensor<31x1x!pphlo.sec<i32>>) -> (tensor<31x1x!pphlo.sec<i32>>) {
+    //CHECK: %0 = "pphlo.divide"(%arg1, %arg0) : (tensor<31x1x!pphlo.sec<i32>>, tensor<31x1x!pphlo.pub<i32>>) -> tensor<31x1x!pphlo.sec<i32>>
+    %0 = "pphlo.divide"(%arg1, %arg0) : (tensor<31x1x!pphlo.sec<i32>>, tensor<31x1x!pphlo.pub<i32>>) -> tensor<31x1x!pphlo.sec<i32>>
+    return %0 : tensor<31x1x!pphlo.sec<i32>>
+}
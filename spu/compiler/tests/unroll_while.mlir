@@ -0,0 +1,63 @@
+// RUN: mlir-pphlo-opt --unroll-while --split-input-file %s | FileCheck %s
+
+func.func @fixed_trip_count(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    //CHECK-NOT: pphlo.while
+    //CHECK: %[[X1:.*]] = "pphlo.multiply"(%arg0, %arg0)
+    //CHECK: %[[X2:.*]] = "pphlo.multiply"(%[[X1]], %[[X1]])
+    //CHECK: %[[X3:.*]] = "pphlo.multiply"(%[[X2]], %[[X2]])
+    //CHECK-NOT: pphlo.multiply
+    //CHECK: return %[[X3]]
+    %1:2 = "pphlo.while"(%0, %arg0) ({
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.constant"() {value = dense<3> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.less"(%arg1, %2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%3) : (tensor<!pphlo.pub<i1>>) -> ()
+    }, {
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.add"(%arg1, %2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      %4 = "pphlo.multiply"(%arg2, %arg2) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3, %4) : (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>)
+    return %1#1 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @unknown_trip_count(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<!pphlo.pub<i32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    //CHECK: pphlo.while
+    %1:2 = "pphlo.while"(%0, %arg0) ({
+    ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.less"(%arg2, %arg1) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%2) : (tensor<!pphlo.pub<i1>>) -> ()
+    }, {
+    ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.add"(%arg2, %2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      %4 = "pphlo.multiply"(%arg3, %arg3) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3, %4) : (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>)
+    return %1#1 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @large_body(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    //CHECK: pphlo.while
+    %1:2 = "pphlo.while"(%0, %arg0) ({
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.constant"() {value = dense<1000> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.less"(%arg1, %2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%3) : (tensor<!pphlo.pub<i1>>) -> ()
+    }, {
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.add"(%arg1, %2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      %4 = "pphlo.multiply"(%arg2, %arg2) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3, %4) : (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>)
+    return %1#1 : tensor<4x!pphlo.sec<f32>>
+}
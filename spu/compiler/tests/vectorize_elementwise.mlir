@@ -0,0 +1,29 @@
+// RUN: mlir-pphlo-opt --vectorize-elementwise --split-input-file %s | FileCheck %s
+
+func.func @independent_muls(%arg0: tensor<2x3x!pphlo.sec<f32>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<2x3x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) {
+    //CHECK: %[[LHS:.*]] = "pphlo.concatenate"
+    //CHECK: %[[RHS:.*]] = "pphlo.concatenate"
+    //CHECK: "pphlo.multiply"(%[[LHS]], %[[RHS]]) : (tensor<10x!pphlo.sec<f32>>, tensor<10x!pphlo.sec<f32>>) -> tensor<10x!pphlo.sec<f32>>
+    //CHECK-NOT: "pphlo.multiply"
+    %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<f32>>) -> tensor<2x3x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%arg1, %arg1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0, %1 : tensor<2x3x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @dependent_muls(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    //CHECK-NOT: pphlo.concatenate
+    %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%0, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %1 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @public_muls(%arg0: tensor<4x!pphlo.pub<f32>>, %arg1: tensor<4x!pphlo.pub<f32>>) -> (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>) {
+    //CHECK-NOT: pphlo.concatenate
+    %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.pub<f32>>
+    %1 = "pphlo.multiply"(%arg1, %arg1) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.pub<f32>>
+    return %0, %1 : tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>
+}
@@ -14,23 +14,67 @@
 
 #include "spu/core/array_ref.h"
 
+#include <cstring>
 #include <numeric>
 
 #include "fmt/format.h"
 #include "fmt/ostream.h"
 
+#include "spu/core/buffer_pool.h"
 #include "spu/core/parallel_utils.h"
 
 namespace spu {
 namespace detail {
 
+namespace {
+
+// Copy elements of a fixed size, so the loop compiles to plain (vectorized)
+// loads and stores instead of a memcpy call per element.
+template <typename T>
+void typedStridedCopy(int64_t numel, T* dst, int64_t dstride, const T* src,
+                      int64_t sstride) {
+  pfor(0, numel, [&](int64_t begin, int64_t end) {
+    if (dstride == 1 && sstride == 1) {
+      std::memcpy(dst + begin, src + begin, (end - begin) * sizeof(T));
+    } else if (dstride == 1) {
+      for (int64_t idx = begin; idx < end; idx++) {
+        dst[idx] = src[idx * sstride];
+      }
+    } else {
+      for (int64_t idx = begin; idx < end; idx++) {
+        dst[idx * dstride] = src[idx * sstride];
+      }
+    }
+  });
+}
+
+}  // namespace
+
 void strided_copy(int64_t numel, int64_t elsize, void* dst, int64_t dstride,
                   void const* src, int64_t sstride) {
+  switch (elsize) {
+#define CASE(SIZE, T)                                                   \
+  case SIZE:                                                            \
+    return typedStridedCopy<T>(numel, static_cast<T*>(dst), dstride,    \
+                               static_cast<const T*>(src), sstride);
+    CASE(1, uint8_t)
+    CASE(2, uint16_t)
+    CASE(4, uint32_t)
+    CASE(8, uint64_t)
+    CASE(16, uint128_t)
+#undef CASE
+    default:
+      break;
+  }
+
   const char* src_itr = static_cast<const char*>(src);
   char* dst_itr = static_cast<char*>(dst);
 
   if (dstride == 1 && sstride == 1) {
-    std::memcpy(dst_itr, src_itr, elsize * numel);
+    pfor(0, numel, [&](int64_t begin, int64_t end) {
+      std::memcpy(&dst_itr[begin * elsize], &src_itr[begin * elsize],
+                  (end - begin) * elsize);
+    });
   } else {
     dstride *= elsize;
     sstride *= elsize;
@@ -41,6 +85,44 @@ void strided_copy(int64_t numel, int64_t elsize, void* dst, int64_t dstride,
   }
 }
 
+ArrayRef pack_arrays(const std::vector<ArrayRef>& arrs) {
+  YACL_ENFORCE(!arrs.empty());
+
+  const Type ty = arrs.front().eltype();
+  std::vector<int64_t> offsets(arrs.size() + 1, 0);
+  for (size_t idx = 0; idx < arrs.size(); ++idx) {
+    YACL_ENFORCE(arrs[idx].eltype() == ty, "type mismatch {} != {}",
+                 arrs[idx].eltype(), ty);
+    offsets[idx + 1] = offsets[idx] + arrs[idx].numel();
+  }
+
+  ArrayRef result(ty, offsets.back());
+  auto copy = [&](size_t idx) {
+    const auto& arr = arrs[idx];
+    if (arr.numel() == 0) {
+      return;
+    }
+    strided_copy(arr.numel(), ty.size(), &result.at(offsets[idx]),
+                 result.stride(), &arr.at(0), arr.stride());
+  };
+
+  // a large array is copied by a parallel loop itself.
+  const int64_t avg_numel = offsets.back() / static_cast<int64_t>(arrs.size());
+  if (avg_numel >= kMinTaskSize) {
+    for (size_t idx = 0; idx < arrs.size(); ++idx) {
+      copy(idx);
+    }
+  } else {
+    pfor(0, arrs.size(), std::max<int64_t>(avg_numel, 1),
+         [&](int64_t begin, int64_t end) {
+           for (int64_t idx = begin; idx < end; ++idx) {
+             copy(idx);
+           }
+         });
+  }
+  return result;
+}
+
 }  // namespace detail
 
 ArrayRef::ArrayRef(std::shared_ptr<yacl::Buffer> buf, Type eltype,
@@ -64,7 +146,7 @@ ArrayRef::ArrayRef(std::shared_ptr<yacl::Buffer> buf, Type eltype,
 }
 
 ArrayRef::ArrayRef(Type eltype, size_t numel)
-    : ArrayRef(std::make_shared<yacl::Buffer>(numel * eltype.size()),
+    : ArrayRef(makeBuffer(numel * eltype.size()),
                eltype,  // eltype
                numel,   // numel
                1,       // stride,
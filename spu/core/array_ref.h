@@ -113,6 +113,14 @@ class ArrayRef {
 
 std::ostream& operator<<(std::ostream& out, const ArrayRef& v);
 
+namespace detail {
+
+// Concatenate arrays of the same type into a single allocation, many small
+// arrays are copied in parallel, large ones are split themselves.
+ArrayRef pack_arrays(const std::vector<ArrayRef>& arrs);
+
+}  // namespace detail
+
 template <>
 struct SimdTrait<ArrayRef> {
   using PackInfo = std::vector<size_t>;
@@ -121,22 +129,11 @@ struct SimdTrait<ArrayRef> {
   static ArrayRef pack(InputIt first, InputIt last, PackInfo& pi) {
     YACL_ENFORCE(first != last);
 
-    size_t total_numel = 0;
-    const Type ty = first->eltype();
-    for (auto itr = first; itr != last; ++itr) {
-      YACL_ENFORCE(itr->eltype() == ty, "type mismatch {} != {}", itr->eltype(),
-                   ty);
-      total_numel += itr->numel();
+    std::vector<ArrayRef> arrs(first, last);
+    for (const auto& arr : arrs) {
+      pi.push_back(arr.numel());
     }
-    ArrayRef result(first->eltype(), total_numel);
-    size_t res_idx = 0;
-    for (; first != last; ++first) {
-      detail::strided_copy(first->numel(), ty.size(), &result.at(res_idx),
-                           result.stride(), &first->at(0), first->stride());
-      pi.push_back(first->numel());
-      res_idx += first->numel();
-    }
-    return result;
+    return detail::pack_arrays(arrs);
   }
 
   template <typename OutputIt>
@@ -176,6 +173,8 @@ class ArrayView {
 
   int64_t numel() const { return numel_; }
 
+  int64_t stride() const { return stride_; }
+
   bool isCompact() const { return stride_ == 1; }
 
   ArrayRef clone() const {
@@ -0,0 +1,88 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "spu/core/array_ref.h"
+#include "spu/core/parallel_utils.h"
+
+namespace spu {
+namespace {
+
+// The copy of one memcpy call per element, as strided_copy used to do.
+void naiveStridedCopy(int64_t numel, int64_t elsize, void* dst,
+                      int64_t dstride, void const* src, int64_t sstride) {
+  const char* src_itr = static_cast<const char*>(src);
+  char* dst_itr = static_cast<char*>(dst);
+
+  if (dstride == 1 && sstride == 1) {
+    std::memcpy(dst_itr, src_itr, elsize * numel);
+  } else {
+    dstride *= elsize;
+    sstride *= elsize;
+
+    pforeach(0, numel, [&](int64_t idx) {
+      std::memcpy(&dst_itr[idx * dstride], &src_itr[idx * sstride], elsize);
+    });
+  }
+}
+
+using CopyFn = void (*)(int64_t, int64_t, void*, int64_t, void const*,
+                        int64_t);
+
+// range(0): numel, range(1): source stride, range(2): element size.
+void runStridedCopy(benchmark::State& state, CopyFn copy_fn) {
+  const int64_t numel = state.range(0);
+  const int64_t stride = state.range(1);
+  const int64_t elsize = state.range(2);
+
+  std::vector<char> src(std::max<int64_t>(numel * stride, 1) * elsize, 1);
+  std::vector<char> dst(numel * elsize);
+
+  for (auto _ : state) {
+    copy_fn(numel, elsize, dst.data(), 1, src.data(), stride);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * numel * elsize);
+}
+
+void BM_NaiveStridedCopy(benchmark::State& state) {
+  runStridedCopy(state, naiveStridedCopy);
+}
+
+void BM_StridedCopy(benchmark::State& state) {
+  runStridedCopy(state, detail::strided_copy);
+}
+
+void StridedCopyArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t numel : {1 << 12, 1 << 20, 1 << 24}) {
+    for (int64_t stride : {0, 1, 2, 7}) {
+      for (int64_t elsize : {8, 16}) {
+        b->Args({numel, stride, elsize});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_NaiveStridedCopy)->Apply(StridedCopyArgs);
+BENCHMARK(BM_StridedCopy)->Apply(StridedCopyArgs);
+
+}  // namespace
+}  // namespace spu
+
+BENCHMARK_MAIN();
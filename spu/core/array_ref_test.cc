@@ -14,6 +14,8 @@
 
 #include "spu/core/array_ref.h"
 
+#include <numeric>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -162,4 +164,27 @@ TEST(ArrayRefTest, Strides) {
   EXPECT_EQ(b.at<int32_t>(2), 4);
 }
 
+TEST(ArrayRefTest, StridedCopy) {
+  constexpr int64_t kNumel = 100;
+  for (int64_t elsize : {1, 2, 4, 8, 12, 16}) {
+    std::vector<uint8_t> src(3 * kNumel * elsize);
+    std::iota(src.begin(), src.end(), 0);
+
+    for (int64_t sstride : {0, 1, 3}) {
+      for (int64_t dstride : {1, 2}) {
+        std::vector<uint8_t> dst(dstride * kNumel * elsize, 0);
+        detail::strided_copy(kNumel, elsize, dst.data(), dstride, src.data(),
+                             sstride);
+
+        for (int64_t idx = 0; idx < kNumel; idx++) {
+          EXPECT_EQ(memcmp(&dst[idx * dstride * elsize],
+                           &src[idx * sstride * elsize], elsize),
+                    0)
+              << elsize << " " << sstride << " " << dstride << " " << idx;
+        }
+      }
+    }
+  }
+}
+
 }  // namespace spu
@@ -0,0 +1,331 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/core/buffer_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "yacl/base/exception.h"
+
+#include "spu/core/memory_tracker.h"
+
+namespace spu {
+namespace {
+
+constexpr size_t kMinClassBits = 12;
+constexpr size_t kMaxClassBits = 30;
+constexpr size_t kNumClasses = kMaxClassBits - kMinClassBits + 1;
+
+static_assert(BufferPool::kMinBlockBytes == 1UL << kMinClassBits);
+static_assert(BufferPool::kMaxBlockBytes == 1UL << kMaxClassBits);
+
+// Only small classes are cached per thread, large blocks are rare enough that
+// the shared free lists do not contend.
+constexpr size_t kNumThreadCachedClasses = 20 - kMinClassBits + 1;
+constexpr size_t kThreadCacheDepth = 2;
+
+// cache line aligned, which is friendly to vectorized kernels.
+constexpr size_t kBlockAlignment = 64;
+
+size_t classOf(size_t size) {
+  size_t cls = 0;
+  while ((BufferPool::kMinBlockBytes << cls) < size) {
+    cls++;
+  }
+  return cls;
+}
+
+size_t classBytes(size_t cls) { return BufferPool::kMinBlockBytes << cls; }
+
+uint64_t genPoolId() {
+  static std::atomic<uint64_t> counter = 0;
+  return ++counter;
+}
+
+thread_local BufferPool* t_current_pool = nullptr;
+
+}  // namespace
+
+struct BufferPool::State : public std::enable_shared_from_this<State> {
+  // The blocks cached by a thread for a pool. The pool keeps a reference to
+  // it too, so the blocks are freed when the pool is closed, even if the
+  // thread lives on.
+  struct ThreadCache {
+    std::mutex mutex;
+    // set when the pool is closed, the blocks are freed already.
+    std::atomic<bool> dropped = false;
+    std::array<std::vector<void*>, kNumThreadCachedClasses> blocks;
+  };
+
+  // The caches of a thread by pool uid, the blocks go back to the shared free
+  // lists of their pools when the thread exits.
+  struct ThreadCaches {
+    struct Entry {
+      std::weak_ptr<State> state;
+      std::shared_ptr<ThreadCache> cache;
+    };
+    std::unordered_map<uint64_t, Entry> entries;
+
+    ~ThreadCaches() {
+      for (auto& [uid, entry] : entries) {
+        if (auto state = entry.state.lock()) {
+          state->dropThreadCache(entry.cache.get(), /* to_pool */ true);
+        }
+      }
+    }
+  };
+
+  const uint64_t uid = genPoolId();
+  const size_t max_cached_bytes;
+
+  std::mutex mutex;
+  std::array<std::vector<void*>, kNumClasses> blocks;
+  std::atomic<bool> closed = false;
+
+  // the caches of all threads, guarded by their own mutex.
+  std::mutex caches_mutex;
+  std::vector<std::weak_ptr<ThreadCache>> thread_caches;
+
+  std::atomic<uint64_t> hits = 0;
+  std::atomic<uint64_t> misses = 0;
+  std::atomic<uint64_t> bytes_in_use = 0;
+  std::atomic<uint64_t> peak_bytes_in_use = 0;
+  std::atomic<uint64_t> cached_bytes = 0;
+
+  explicit State(size_t max_cached) : max_cached_bytes(max_cached) {}
+
+  ~State() { trim(); }
+
+  // Return the cache of this pool of the calling thread, caches of closed
+  // pools are dropped by the way.
+  ThreadCache& getThreadCache() {
+    thread_local ThreadCaches caches;
+    for (auto itr = caches.entries.begin(); itr != caches.entries.end();) {
+      if (itr->second.cache->dropped) {
+        itr = caches.entries.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+    auto& entry = caches.entries[uid];
+    if (entry.cache == nullptr) {
+      entry.state = weak_from_this();
+      entry.cache = std::make_shared<ThreadCache>();
+
+      std::unique_lock lock(caches_mutex);
+      // forget the caches of exited threads.
+      thread_caches.erase(
+          std::remove_if(thread_caches.begin(), thread_caches.end(),
+                         [](const auto& cache) { return cache.expired(); }),
+          thread_caches.end());
+      thread_caches.push_back(entry.cache);
+    }
+    return *entry.cache;
+  }
+
+  // Move the blocks of a thread cache to the shared free lists, or free them.
+  void dropThreadCache(ThreadCache* cache, bool to_pool) {
+    std::unique_lock lock(cache->mutex);
+    for (size_t cls = 0; cls < cache->blocks.size(); cls++) {
+      for (void* ptr : cache->blocks[cls]) {
+        cached_bytes -= classBytes(cls);
+        if (to_pool) {
+          cacheOrFree(cls, ptr, /* force */ true);
+        } else {
+          std::free(ptr);
+        }
+      }
+      cache->blocks[cls].clear();
+    }
+    if (!to_pool) {
+      cache->dropped = true;
+    }
+  }
+
+  // Free all cached blocks, including the ones of thread caches, blocks
+  // returned later are freed directly.
+  void close() {
+    closed = true;
+    {
+      std::unique_lock lock(caches_mutex);
+      for (const auto& weak : thread_caches) {
+        if (auto cache = weak.lock()) {
+          dropThreadCache(cache.get(), /* to_pool */ false);
+        }
+      }
+      thread_caches.clear();
+    }
+    trim();
+  }
+
+  void* acquire(size_t cls) {
+    const size_t bytes = classBytes(cls);
+
+    void* ptr = nullptr;
+    if (cls < kNumThreadCachedClasses) {
+      auto& cache = getThreadCache();
+      std::unique_lock lock(cache.mutex);
+      auto& list = cache.blocks[cls];
+      if (!list.empty()) {
+        ptr = list.back();
+        list.pop_back();
+      }
+    }
+    if (ptr == nullptr) {
+      std::unique_lock lock(mutex);
+      if (!blocks[cls].empty()) {
+        ptr = blocks[cls].back();
+        blocks[cls].pop_back();
+      }
+    }
+
+    if (ptr != nullptr) {
+      hits++;
+      cached_bytes -= bytes;
+    } else {
+      misses++;
+      ptr = std::aligned_alloc(kBlockAlignment, bytes);
+      YACL_ENFORCE(ptr != nullptr, "out of memory, bytes={}", bytes);
+    }
+
+    const uint64_t in_use = (bytes_in_use += bytes);
+    uint64_t peak = peak_bytes_in_use.load();
+    while (in_use > peak &&
+           !peak_bytes_in_use.compare_exchange_weak(peak, in_use)) {
+    }
+    return ptr;
+  }
+
+  void release(size_t cls, void* ptr) {
+    const size_t bytes = classBytes(cls);
+    bytes_in_use -= bytes;
+
+    if (closed) {
+      std::free(ptr);
+      return;
+    }
+
+    if (cls < kNumThreadCachedClasses &&
+        cached_bytes + bytes <= max_cached_bytes) {
+      auto& cache = getThreadCache();
+      std::unique_lock lock(cache.mutex);
+      auto& list = cache.blocks[cls];
+      if (!cache.dropped && list.size() < kThreadCacheDepth) {
+        list.push_back(ptr);
+        cached_bytes += bytes;
+        return;
+      }
+    }
+
+    cacheOrFree(cls, ptr, /* force */ false);
+  }
+
+  // put the block to shared free lists, or free it if the pool is full.
+  void cacheOrFree(size_t cls, void* ptr, bool force) {
+    const size_t bytes = classBytes(cls);
+    if (!closed) {
+      std::unique_lock lock(mutex);
+      if (force || cached_bytes + bytes <= max_cached_bytes) {
+        blocks[cls].push_back(ptr);
+        cached_bytes += bytes;
+        return;
+      }
+    }
+    std::free(ptr);
+  }
+
+  void reserve(size_t cls, size_t count) {
+    const size_t bytes = classBytes(cls);
+    std::unique_lock lock(mutex);
+    while (blocks[cls].size() < count &&
+           cached_bytes + bytes <= max_cached_bytes) {
+      void* ptr = std::aligned_alloc(kBlockAlignment, bytes);
+      YACL_ENFORCE(ptr != nullptr, "out of memory, bytes={}", bytes);
+      blocks[cls].push_back(ptr);
+      cached_bytes += bytes;
+    }
+  }
+
+  void trim() {
+    std::unique_lock lock(mutex);
+    for (size_t cls = 0; cls < blocks.size(); cls++) {
+      for (void* ptr : blocks[cls]) {
+        std::free(ptr);
+        cached_bytes -= classBytes(cls);
+      }
+      blocks[cls].clear();
+    }
+  }
+};
+
+BufferPool::BufferPool(size_t max_cached_bytes)
+    : state_(std::make_shared<State>(max_cached_bytes)) {}
+
+BufferPool::~BufferPool() { state_->close(); }
+
+std::shared_ptr<yacl::Buffer> BufferPool::allocate(size_t size) {
+  if (size < kMinBlockBytes || size > kMaxBlockBytes) {
+    return std::make_shared<yacl::Buffer>(size);
+  }
+
+  const size_t cls = classOf(size);
+  void* ptr = state_->acquire(cls);
+  return std::make_shared<yacl::Buffer>(
+      ptr, size, [state = state_, cls](void* p) { state->release(cls, p); });
+}
+
+BufferPool::Stats BufferPool::getStats() const {
+  Stats stats;
+  stats.hits = state_->hits;
+  stats.misses = state_->misses;
+  stats.bytes_in_use = state_->bytes_in_use;
+  stats.peak_bytes_in_use = state_->peak_bytes_in_use;
+  stats.cached_bytes = state_->cached_bytes;
+  return stats;
+}
+
+void BufferPool::reserve(size_t size, size_t count) {
+  if (size < kMinBlockBytes || size > kMaxBlockBytes) {
+    return;
+  }
+  state_->reserve(classOf(size), count);
+}
+
+void BufferPool::trim() { state_->trim(); }
+
+BufferPool::Scope::Scope(BufferPool* pool) : prev_(t_current_pool) {
+  t_current_pool = pool;
+}
+
+BufferPool::Scope::~Scope() { t_current_pool = prev_; }
+
+BufferPool* BufferPool::current() { return t_current_pool; }
+
+std::shared_ptr<yacl::Buffer> makeBuffer(size_t size) {
+  auto* pool = BufferPool::current();
+  auto buf = pool != nullptr ? pool->allocate(size)
+                             : std::make_shared<yacl::Buffer>(size);
+  if (auto* tracker = MemoryTracker::current()) {
+    return tracker->track(std::move(buf));
+  }
+  return buf;
+}
+
+}  // namespace spu
@@ -0,0 +1,100 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "yacl/base/buffer.h"
+
+namespace spu {
+
+// A size-class pool of buffer memory.
+//
+// Blocks are rounded up to powers of two, a freed block is kept in a small
+// per-thread cache first, then in the shared free lists of the pool, and
+// reused by later allocations of the same class. Buffers returned by the
+// pool hand their blocks back on destruction, they could safely outlive the
+// pool, then blocks are freed directly. The thread caches are freed with the
+// pool, including the ones of threads still running.
+class BufferPool final {
+ public:
+  struct Stats {
+    // allocations served by cached blocks.
+    uint64_t hits = 0;
+    // allocations served by the system allocator.
+    uint64_t misses = 0;
+    // bytes of blocks handed out and not returned yet.
+    uint64_t bytes_in_use = 0;
+    uint64_t peak_bytes_in_use = 0;
+    // bytes of blocks cached for reuse.
+    uint64_t cached_bytes = 0;
+  };
+
+  // allocations out of [kMinBlockBytes, kMaxBlockBytes] bypass the pool.
+  static constexpr size_t kMinBlockBytes = 1UL << 12;
+  static constexpr size_t kMaxBlockBytes = 1UL << 30;
+
+  static constexpr size_t kDefaultMaxCachedBytes = 1UL << 30;
+
+  explicit BufferPool(size_t max_cached_bytes = kDefaultMaxCachedBytes);
+
+  ~BufferPool();
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Allocate a buffer of `size` bytes, the content is uninitialized.
+  std::shared_ptr<yacl::Buffer> allocate(size_t size);
+
+  Stats getStats() const;
+
+  // Make sure at least `count` blocks large enough for `size` bytes are
+  // cached in the shared free lists, as long as the cache limit allows.
+  void reserve(size_t size, size_t count);
+
+  // Free all blocks cached in the shared free lists.
+  void trim();
+
+  // Make `pool` the current pool of the calling thread in this scope, which
+  // is used by `makeBuffer`, null means no pool.
+  class Scope {
+   public:
+    explicit Scope(BufferPool* pool);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    BufferPool* prev_;
+  };
+
+  // Return the current pool of the calling thread, or null.
+  static BufferPool* current();
+
+ private:
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+// Allocate a buffer of `size` bytes from the current pool of the calling
+// thread, or from the heap if there is none, it's counted by the current
+// MemoryTracker of the thread, if any.
+std::shared_ptr<yacl::Buffer> makeBuffer(size_t size);
+
+}  // namespace spu
@@ -0,0 +1,177 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/core/buffer_pool.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace spu {
+
+TEST(BufferPoolTest, Reuse) {
+  BufferPool pool;
+
+  void* first = nullptr;
+  {
+    auto buf = pool.allocate(5000);
+    EXPECT_EQ(buf->size(), 5000);
+    first = buf->data();
+  }
+
+  // same size class, the cached block is reused.
+  {
+    auto buf = pool.allocate(8000);
+    EXPECT_EQ(buf->size(), 8000);
+    EXPECT_EQ(buf->data(), first);
+  }
+
+  auto stats = pool.getStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.peak_bytes_in_use, 8192);
+  EXPECT_EQ(stats.cached_bytes, 8192);
+
+  // small buffers bypass the pool.
+  auto small = pool.allocate(10);
+  EXPECT_EQ(small->size(), 10);
+  EXPECT_EQ(pool.getStats().misses, 1);
+}
+
+TEST(BufferPoolTest, Scope) {
+  BufferPool pool;
+  EXPECT_EQ(BufferPool::current(), nullptr);
+  {
+    BufferPool::Scope scope(&pool);
+    EXPECT_EQ(BufferPool::current(), &pool);
+    {
+      BufferPool::Scope inner(nullptr);
+      EXPECT_EQ(BufferPool::current(), nullptr);
+      makeBuffer(1 << 16);
+    }
+    EXPECT_EQ(BufferPool::current(), &pool);
+    makeBuffer(1 << 16);
+  }
+  EXPECT_EQ(BufferPool::current(), nullptr);
+
+  EXPECT_EQ(pool.getStats().misses, 1);
+}
+
+TEST(BufferPoolTest, MultiThreads) {
+  BufferPool pool;
+
+  std::vector<std::thread> threads;
+  for (size_t tidx = 0; tidx < 4; tidx++) {
+    threads.emplace_back([&]() {
+      BufferPool::Scope scope(&pool);
+      for (size_t idx = 0; idx < 1000; idx++) {
+        auto small = makeBuffer(4096 * (idx % 7 + 1));
+        auto large = makeBuffer(1 << 21);
+        small->data<char>()[0] = 1;
+        large->data<char>()[0] = 1;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto stats = pool.getStats();
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.hits + stats.misses, 8000);
+  EXPECT_GT(stats.hits, stats.misses);
+
+  pool.trim();
+  EXPECT_EQ(pool.getStats().cached_bytes, 0);
+}
+
+TEST(BufferPoolTest, Reserve) {
+  BufferPool pool(1 << 20);
+
+  pool.reserve(5000, 3);
+  EXPECT_EQ(pool.getStats().cached_bytes, 3 * 8192);
+  // already enough blocks.
+  pool.reserve(8192, 2);
+  EXPECT_EQ(pool.getStats().cached_bytes, 3 * 8192);
+  // bounded by the cache limit.
+  pool.reserve(1 << 19, 4);
+  EXPECT_EQ(pool.getStats().cached_bytes, 3 * 8192 + (1 << 19));
+
+  {
+    auto a = pool.allocate(8000);
+    auto b = pool.allocate(8000);
+    auto c = pool.allocate(8000);
+  }
+  EXPECT_EQ(pool.getStats().misses, 0);
+  EXPECT_EQ(pool.getStats().hits, 3);
+}
+
+TEST(BufferPoolTest, OutlivePool) {
+  std::shared_ptr<yacl::Buffer> buf;
+  {
+    BufferPool pool;
+    buf = pool.allocate(1 << 16);
+  }
+  // the block is freed directly after the pool is gone.
+  buf->data<char>()[0] = 1;
+  buf.reset();
+}
+
+TEST(BufferPoolTest, ThreadOutlivesPool) {
+  auto pool = std::make_unique<BufferPool>();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool cached = false;
+  bool closed = false;
+
+  std::thread thread([&]() {
+    {
+      BufferPool::Scope scope(pool.get());
+      // the block is kept by the cache of this thread.
+      makeBuffer(5000);
+    }
+    {
+      std::unique_lock lock(mutex);
+      cached = true;
+      cv.notify_all();
+      cv.wait(lock, [&] { return closed; });
+    }
+    // the cache of the closed pool is dropped, a new pool starts over.
+    BufferPool other;
+    BufferPool::Scope scope(&other);
+    makeBuffer(5000);
+    EXPECT_EQ(other.getStats().misses, 1);
+  });
+
+  {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] { return cached; });
+  }
+  EXPECT_EQ(pool->getStats().cached_bytes, 8192);
+  // the blocks of the living thread are freed with the pool.
+  pool.reset();
+  {
+    std::unique_lock lock(mutex);
+    closed = true;
+    cv.notify_all();
+  }
+  thread.join();
+}
+
+}  // namespace spu
@@ -14,10 +14,14 @@
 
 #include "spu/core/encoding.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <type_traits>
+#include <vector>
 
 #include "spu/core/parallel_utils.h"
+#include "spu/core/shape_util.h"
 
 namespace spu {
 
@@ -49,27 +53,50 @@ PtType getDecodeType(DataType dtype) {
 #undef CASE
 }
 
-ArrayRef encodeToRing(const ArrayRef& src, FieldType field, size_t fxp_bits,
-                      DataType* out_dtype) {
-  YACL_ENFORCE(src.eltype().isa<PtTy>(), "expect PtType, got={}", src.eltype());
-  const PtType pt_type = src.eltype().as<PtTy>()->pt_type();
-  const size_t numel = src.numel();
-  ArrayRef dst(makeType<RingTy>(field), numel);
-
-  if (out_dtype) {
-    *out_dtype = getEncodeType(pt_type);
+namespace {
+
+// Return true if a view of `strides` in elements is row major compact, the
+// strides of dims of size 1 are ignored, i.e. xtensor makes them 0.
+bool isCompactView(const std::vector<int64_t>& shape,
+                   const std::vector<int64_t>& strides) {
+  int64_t expected = 1;
+  for (int64_t dim = static_cast<int64_t>(shape.size()) - 1; dim >= 0; dim--) {
+    if (shape[dim] != 1 && strides[dim] != expected) {
+      return false;
+    }
+    expected *= shape[dim];
   }
+  return true;
+}
 
-  auto src_stride = src.stride();
-  auto dst_stride = dst.stride();
+// Apply `fn` to all elements in parallel, the loop of compact buffers has no
+// strides, so the compiler vectorizes it.
+template <typename S, typename D, typename Fn>
+void mapStrided(S const* src, int64_t src_stride, D* dst, int64_t dst_stride,
+                int64_t numel, Fn&& fn) {
+  pfor(0, numel, [&](int64_t begin, int64_t end) {
+    if (src_stride == 1 && dst_stride == 1) {
+      for (int64_t idx = begin; idx < end; idx++) {
+        dst[idx] = fn(src[idx]);
+      }
+    } else {
+      for (int64_t idx = begin; idx < end; idx++) {
+        dst[idx * dst_stride] = fn(src[idx * src_stride]);
+      }
+    }
+  });
+}
+
+void encodeImpl(void const* src, PtType pt_type, int64_t src_stride,
+                ArrayRef& dst, size_t fxp_bits) {
+  const FieldType field = dst.eltype().as<Ring2k>()->field();
+  const int64_t numel = dst.numel();
 
   if (pt_type == PT_F32 || pt_type == PT_F64) {
     DISPATCH_FLOAT_PT_TYPES(pt_type, "_", [&]() {
       DISPATCH_ALL_FIELDS(field, "_", [&]() {
         using Float = ScalarT;
         using T = std::make_signed_t<ring2k_t>;
-        T* dst_ptr = &dst.at<T>(0);
-        Float const* src_ptr = &src.at<Float>(0);
 
         // Reference: https://eprint.iacr.org/2019/599.pdf
         // To make `msb based comparison` work, the safe range is
@@ -81,24 +108,22 @@ ArrayRef encodeToRing(const ArrayRef& src, FieldType field, size_t fxp_bits,
         const Float kFlpUpper = static_cast<Float>(kFxpUpper) / kScale;
         const Float kFlpLower = static_cast<Float>(kFxpLower) / kScale;
 
-        pforeach(0, numel, [&](int64_t idx) {
-          auto src_value = src_ptr[idx * src_stride];
-          if (std::isnan(src_value)) {
-            // see numpy.nan_to_num
-            // note(jint) I dont know why nan could be
-            // encoded as zero..
-            dst_ptr[idx * dst_stride] = 0;
-          } else if (src_value >= kFlpUpper) {
-            dst_ptr[idx * dst_stride] = kFxpUpper;
-          } else if (src_value <= kFlpLower) {
-            dst_ptr[idx * dst_stride] = kFxpLower;
-          } else {
-            dst_ptr[idx * dst_stride] = static_cast<T>(src_value * kScale);
-          }
-        });
+        // branch free, the value is clamped before the cast since casting an
+        // out of range float is undefined, and max(lower, nan) is lower.
+        mapStrided(static_cast<Float const*>(src), src_stride,
+                   &dst.at<T>(0), dst.stride(), numel, [&](Float x) {
+                     const Float clamped =
+                         std::min(kFlpUpper, std::max(kFlpLower, x));
+                     T v = static_cast<T>(clamped * kScale);
+                     v = x >= kFlpUpper ? kFxpUpper : v;
+                     v = x <= kFlpLower ? kFxpLower : v;
+                     // see numpy.nan_to_num
+                     // note(jint) I dont know why nan could be
+                     // encoded as zero..
+                     return std::isnan(x) ? T(0) : v;
+                   });
       });
     });
-    return dst;
   } else {
     // handle integer & boolean
     DISPATCH_INT_PT_TYPES(pt_type, "_", [&]() {
@@ -110,18 +135,44 @@ ArrayRef encodeToRing(const ArrayRef& src, FieldType field, size_t fxp_bits,
 
         using T = std::make_signed_t<ring2k_t>;
         // TODO: encoding integer in range [-2^(k-2),2^(k-2))
-        T* dst_ptr = &dst.at<T>(0);
-        Integer const* src_ptr = &src.at<Integer>(0);
-        pforeach(0, numel, [&](int64_t idx) {
-          dst_ptr[idx * dst_stride] = static_cast<T>(src_ptr[idx * src_stride]);
-        });
+        mapStrided(static_cast<Integer const*>(src), src_stride,
+                   &dst.at<T>(0), dst.stride(), numel,
+                   [](Integer x) { return static_cast<T>(x); });
       });
     });
+  }
+}
+
+}  // namespace
 
-    return dst;
+ArrayRef encodeToRing(const ArrayRef& src, FieldType field, size_t fxp_bits,
+                      DataType* out_dtype) {
+  YACL_ENFORCE(src.eltype().isa<PtTy>(), "expect PtType, got={}", src.eltype());
+  const PtType pt_type = src.eltype().as<PtTy>()->pt_type();
+  ArrayRef dst(makeType<RingTy>(field), src.numel());
+
+  if (out_dtype) {
+    *out_dtype = getEncodeType(pt_type);
   }
 
-  YACL_THROW("shold not be here");
+  encodeImpl(src.data(), pt_type, src.stride(), dst, fxp_bits);
+  return dst;
+}
+
+NdArrayRef encodeToRing(PtBufferView bv, FieldType field, size_t fxp_bits,
+                        DataType* out_dtype) {
+  if (!isCompactView(bv.shape, bv.strides)) {
+    return encodeToRing(xt_to_ndarray(bv), field, fxp_bits, out_dtype);
+  }
+
+  // encode from the buffer directly, without a compact copy of it.
+  ArrayRef dst(makeType<RingTy>(field), calcNumel(bv.shape));
+  if (out_dtype) {
+    *out_dtype = getEncodeType(bv.pt_type);
+  }
+
+  encodeImpl(bv.ptr, bv.pt_type, 1, dst, fxp_bits);
+  return unflatten(dst, bv.shape);
 }
 
 NdArrayRef encodeToRing(const NdArrayRef& src, FieldType field, size_t fxp_bits,
@@ -146,9 +197,6 @@ ArrayRef decodeFromRing(const ArrayRef& src, DataType in_dtype, size_t fxp_bits,
 
   ArrayRef dst(makePtType(pt_type), src.numel());
 
-  auto src_stride = src.stride();
-  auto dst_stride = dst.stride();
-
   DISPATCH_ALL_FIELDS(field, "field", [&]() {
     DISPATCH_ALL_PT_TYPES(pt_type, "pt_type", [&]() {
       using T = std::make_signed_t<ring2k_t>;
@@ -158,20 +206,15 @@ ArrayRef decodeFromRing(const ArrayRef& src, DataType in_dtype, size_t fxp_bits,
       if (in_dtype == DT_I1) {
         constexpr bool kSanity = std::is_same_v<ScalarT, bool>;
         YACL_ENFORCE(kSanity);
-        pforeach(0, numel, [&](int64_t idx) {
-          dst_ptr[idx * dst_stride] = !((src_ptr[idx * src_stride] & 0x1) == 0);
-        });
+        mapStrided(src_ptr, src.stride(), dst_ptr, dst.stride(), numel,
+                   [](T x) { return !((x & 0x1) == 0); });
       } else if (in_dtype == DT_FXP) {
         const T kScale = T(1) << fxp_bits;
-        pforeach(0, numel, [&](int64_t idx) {
-          dst_ptr[idx * dst_stride] =
-              static_cast<ScalarT>(src_ptr[idx * src_stride]) / kScale;
-        });
+        mapStrided(src_ptr, src.stride(), dst_ptr, dst.stride(), numel,
+                   [&](T x) { return static_cast<ScalarT>(x) / kScale; });
       } else {
-        pforeach(0, numel, [&](int64_t idx) {
-          dst_ptr[idx * dst_stride] =
-              static_cast<ScalarT>(src_ptr[idx * src_stride]);
-        });
+        mapStrided(src_ptr, src.stride(), dst_ptr, dst.stride(), numel,
+                   [](T x) { return static_cast<ScalarT>(x); });
       }
     });
   });
@@ -17,6 +17,7 @@
 #include "spu/core/array_ref.h"
 #include "spu/core/ndarray_ref.h"
 #include "spu/core/type.h"
+#include "spu/core/xt_helper.h"
 
 namespace spu {
 
@@ -87,6 +88,10 @@ ArrayRef encodeToRing(const ArrayRef& src, FieldType field, size_t fxp_bits,
                       DataType* out_dtype = nullptr);
 NdArrayRef encodeToRing(const NdArrayRef& src, FieldType field, size_t fxp_bits,
                         DataType* out_dtype = nullptr);
+// Encode a buffer in place, a compact buffer is read directly instead of
+// being copied to a ndarray first.
+NdArrayRef encodeToRing(PtBufferView bv, FieldType field, size_t fxp_bits,
+                        DataType* out_dtype = nullptr);
 
 // TODO: document me, verbosely
 ArrayRef decodeFromRing(const ArrayRef& src, DataType in_dtype, size_t fxp_bits,
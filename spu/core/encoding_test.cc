@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xtensor/xrandom.hpp"
 
 #include "spu/core/type.h"
 #include "spu/core/xt_helper.h"
@@ -165,4 +166,39 @@ TYPED_TEST(IntEncodingTest, Works) {
   EXPECT_EQ(out_ptr[4], 1);
 }
 
+TEST(BufferEncodingTest, SameAsNdArray) {
+  constexpr size_t kFxpBits = 18;
+
+  // large enough to run in parallel.
+  xt::xarray<float> x = xt::random::randn<float>({300, 400});
+  x(0, 0) = std::numeric_limits<float>::quiet_NaN();
+  x(0, 1) = 1e30;
+  x(0, 2) = -1e30;
+
+  // a compact view, and a transposed one which is not compact.
+  const xt::xarray<float> x_t = xt::transpose(x);
+  const PtBufferView strided(x.data(), PT_F32, {400, 300}, {1, 400});
+
+  const auto check = [&](PtBufferView bv, const xt::xarray<float>& expected) {
+    DataType dtype;
+    const auto encoded = flatten(encodeToRing(bv, FM64, kFxpBits, &dtype));
+    const auto reference =
+        flatten(encodeToRing(xt_to_ndarray(expected), FM64, kFxpBits));
+    EXPECT_EQ(dtype, DT_FXP);
+    ASSERT_EQ(encoded.numel(), reference.numel());
+    for (int64_t idx = 0; idx < encoded.numel(); idx++) {
+      ASSERT_EQ(encoded.at<int64_t>(idx), reference.at<int64_t>(idx)) << idx;
+    }
+  };
+
+  check(x, x);
+  check(strided, x_t);
+
+  // nan is zero, out of range values are clamped.
+  const auto encoded = flatten(encodeToRing(x, FM64, kFxpBits));
+  EXPECT_EQ(encoded.at<int64_t>(0), 0);
+  EXPECT_EQ(encoded.at<int64_t>(1), (int64_t(1) << 62) - 1);
+  EXPECT_EQ(encoded.at<int64_t>(2), -(int64_t(1) << 62));
+}
+
 }  // namespace spu
@@ -0,0 +1,81 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/core/memory_tracker.h"
+
+#include <atomic>
+
+namespace spu {
+namespace {
+
+thread_local MemoryTracker* t_current_tracker = nullptr;
+
+void updateMax(std::atomic<uint64_t>& peak, uint64_t value) {
+  uint64_t prev = peak.load();
+  while (value > prev && !peak.compare_exchange_weak(prev, value)) {
+  }
+}
+
+}  // namespace
+
+struct MemoryTracker::State {
+  std::atomic<uint64_t> live_bytes = 0;
+  std::atomic<uint64_t> peak_bytes = 0;
+  std::atomic<uint64_t> window_peak_bytes = 0;
+
+  void acquire(uint64_t bytes) {
+    const uint64_t live = (live_bytes += bytes);
+    updateMax(peak_bytes, live);
+    updateMax(window_peak_bytes, live);
+  }
+
+  void release(uint64_t bytes) { live_bytes -= bytes; }
+};
+
+MemoryTracker::MemoryTracker() : state_(std::make_shared<State>()) {}
+
+std::shared_ptr<yacl::Buffer> MemoryTracker::track(
+    std::shared_ptr<yacl::Buffer> buf) {
+  const uint64_t bytes = buf->size();
+  state_->acquire(bytes);
+  auto* ptr = buf.get();
+  // the deleter owns the buffer, which is freed after it's uncounted.
+  return std::shared_ptr<yacl::Buffer>(
+      ptr, [buf = std::move(buf), state = state_, bytes](yacl::Buffer*) {
+        state->release(bytes);
+      });
+}
+
+MemoryTracker::Stats MemoryTracker::getStats() const {
+  Stats stats;
+  stats.live_bytes = state_->live_bytes;
+  stats.peak_bytes = state_->peak_bytes;
+  stats.window_peak_bytes = state_->window_peak_bytes;
+  return stats;
+}
+
+void MemoryTracker::resetWindow() {
+  state_->window_peak_bytes = state_->live_bytes.load();
+}
+
+MemoryTracker::Scope::Scope(MemoryTracker* tracker)
+    : prev_(t_current_tracker) {
+  t_current_tracker = tracker;
+}
+
+MemoryTracker::Scope::~Scope() { t_current_tracker = prev_; }
+
+MemoryTracker* MemoryTracker::current() { return t_current_tracker; }
+
+}  // namespace spu
@@ -0,0 +1,78 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "yacl/base/buffer.h"
+
+namespace spu {
+
+// Counts bytes of live buffers of one party.
+//
+// Buffers made by `makeBuffer` in a scope of a tracker are counted until
+// they are released, i.e. all arrays of a party allocated by its runtime.
+// Besides the peak of the whole life, a window peak is kept, which could be
+// reset to attribute peaks to the steps of an execution. Tracked buffers
+// could safely outlive the tracker.
+class MemoryTracker final {
+ public:
+  struct Stats {
+    // bytes of tracked buffers alive.
+    uint64_t live_bytes = 0;
+    uint64_t peak_bytes = 0;
+    // peak bytes since the last resetWindow.
+    uint64_t window_peak_bytes = 0;
+  };
+
+  MemoryTracker();
+
+  MemoryTracker(const MemoryTracker&) = delete;
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+  // Count `buf` as live, until the returned buffer and all its copies are
+  // released.
+  std::shared_ptr<yacl::Buffer> track(std::shared_ptr<yacl::Buffer> buf);
+
+  Stats getStats() const;
+
+  // Restart the window peak from the live bytes.
+  void resetWindow();
+
+  // Make `tracker` the current tracker of the calling thread in this scope,
+  // which is used by `makeBuffer`, null means no tracker.
+  class Scope {
+   public:
+    explicit Scope(MemoryTracker* tracker);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    MemoryTracker* prev_;
+  };
+
+  // Return the current tracker of the calling thread, or null.
+  static MemoryTracker* current();
+
+ private:
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace spu
@@ -0,0 +1,104 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/core/memory_tracker.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "spu/core/buffer_pool.h"
+
+namespace spu {
+
+TEST(MemoryTrackerTest, Works) {
+  MemoryTracker tracker;
+  {
+    auto a = tracker.track(std::make_shared<yacl::Buffer>(100));
+    auto copy = a;
+    a.reset();
+    EXPECT_EQ(tracker.getStats().live_bytes, 100);
+    {
+      auto b = tracker.track(std::make_shared<yacl::Buffer>(50));
+      EXPECT_EQ(b->size(), 50);
+      EXPECT_EQ(tracker.getStats().live_bytes, 150);
+    }
+    EXPECT_EQ(tracker.getStats().live_bytes, 100);
+  }
+
+  auto stats = tracker.getStats();
+  EXPECT_EQ(stats.live_bytes, 0);
+  EXPECT_EQ(stats.peak_bytes, 150);
+  EXPECT_EQ(stats.window_peak_bytes, 150);
+
+  // window peak restarts, the whole peak is kept.
+  tracker.resetWindow();
+  auto c = tracker.track(std::make_shared<yacl::Buffer>(20));
+  stats = tracker.getStats();
+  EXPECT_EQ(stats.peak_bytes, 150);
+  EXPECT_EQ(stats.window_peak_bytes, 20);
+}
+
+TEST(MemoryTrackerTest, Scope) {
+  MemoryTracker tracker;
+  BufferPool pool;
+  EXPECT_EQ(MemoryTracker::current(), nullptr);
+  {
+    MemoryTracker::Scope scope(&tracker);
+    EXPECT_EQ(MemoryTracker::current(), &tracker);
+    auto heap = makeBuffer(1000);
+    {
+      // pooled buffers are counted by their sizes, not blocks.
+      BufferPool::Scope pool_scope(&pool);
+      auto pooled = makeBuffer(5000);
+      EXPECT_EQ(tracker.getStats().live_bytes, 6000);
+    }
+    {
+      MemoryTracker::Scope inner(nullptr);
+      auto untracked = makeBuffer(1000);
+      EXPECT_EQ(tracker.getStats().live_bytes, 1000);
+    }
+  }
+  EXPECT_EQ(MemoryTracker::current(), nullptr);
+
+  const auto stats = tracker.getStats();
+  EXPECT_EQ(stats.live_bytes, 0);
+  EXPECT_EQ(stats.peak_bytes, 6000);
+  EXPECT_EQ(pool.getStats().bytes_in_use, 0);
+}
+
+TEST(MemoryTrackerTest, MultiThreads) {
+  MemoryTracker tracker;
+
+  std::vector<std::thread> threads;
+  for (size_t tidx = 0; tidx < 4; tidx++) {
+    threads.emplace_back([&]() {
+      MemoryTracker::Scope scope(&tracker);
+      for (size_t idx = 0; idx < 1000; idx++) {
+        auto buf = makeBuffer(100 * (idx % 7 + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto stats = tracker.getStats();
+  EXPECT_EQ(stats.live_bytes, 0);
+  EXPECT_GE(stats.peak_bytes, 700);
+  EXPECT_LE(stats.peak_bytes, 4 * 700);
+}
+
+}  // namespace spu
@@ -17,10 +17,12 @@
 #include <algorithm>
 #include <cstring>
 #include <numeric>
+#include <optional>
 
 #include "fmt/format.h"
 #include "fmt/ostream.h"
 
+#include "spu/core/buffer_pool.h"
 #include "spu/core/parallel_utils.h"
 #include "spu/core/shape_util.h"
 
@@ -65,12 +67,11 @@ NdArrayRef::NdArrayRef(std::shared_ptr<yacl::Buffer> buf, Type eltype,
 
 // constructor, create a new buffer of elements and ref to it.
 NdArrayRef::NdArrayRef(Type eltype, absl::Span<const int64_t> shape)
-    : NdArrayRef(std::make_shared<yacl::Buffer>(calcNumel(shape) *
-                                                eltype.size()),  // buf
-                 eltype,                                         // eltype
-                 shape,                                          // shape
-                 makeCompactStrides(shape),                      // strides
-                 0                                               // offset
+    : NdArrayRef(makeBuffer(calcNumel(shape) * eltype.size()),  // buf
+                 eltype,                                        // eltype
+                 shape,                                         // shape
+                 makeCompactStrides(shape),                     // strides
+                 0                                              // offset
       ) {}
 
 size_t NdArrayRef::dim(size_t idx) const {
@@ -142,55 +143,49 @@ NdArrayRef unflatten(const ArrayRef& arr, std::vector<int64_t> shape) {
                "unflatten numel mismatch, expected={}, got={}",
                calcNumel(shape), arr.numel());
 
-  // FIXME: due to the current implementation,
-  YACL_ENFORCE(arr.isCompact(), "FIXME: impl assume array is flatten");
-
+  // element i of arr is at i * stride, so the compact strides are scaled,
+  // e.g. a broadcasted scalar of stride 0 is of all strides 0.
   auto strides = makeCompactStrides(shape);
+  for (auto& stride : strides) {
+    stride *= arr.stride();
+  }
   return {arr.buf(), arr.eltype(), std::move(shape), std::move(strides),
           arr.offset()};
 }
 
 namespace {
-bool onlyStrideInnerMostDim(absl::Span<const int64_t> shape,
-                            absl::Span<const int64_t> strides) {
-  auto expect_stride = strides.back() * shape.back();
-  for (int64_t dim = strides.size() - 2; dim >= 0; --dim) {
-    if (strides[dim] != expect_stride) {
-      return false;
+// The stride of the 1d-array of all elements, or nullopt if there is none.
+// Dims of size 1 do not matter, so it covers compact arrays, arrays strided
+// at the inner most dim, broadcasted scalars and slices of them.
+std::optional<int64_t> linearStride(absl::Span<const int64_t> shape,
+                                    absl::Span<const int64_t> strides) {
+  std::optional<int64_t> stride;
+  int64_t expect_stride = 0;
+  for (int64_t dim = shape.size() - 1; dim >= 0; --dim) {
+    if (shape[dim] == 1) {
+      continue;
+    }
+    if (!stride.has_value()) {
+      stride = strides[dim];
+    } else if (strides[dim] != expect_stride) {
+      return std::nullopt;
     }
-    expect_stride *= shape[dim];
+    expect_stride = strides[dim] * shape[dim];
   }
-  return true;
+  return stride.value_or(1);
 }
 }  // namespace
 
-ArrayRef flatten(const NdArrayRef& ndarr) {
-  if (ndarr.isCompact()) {
-    // if compact, direct treat it as a 1D array.
-    // TODO: optimize me, in some cases, we may treat it as a strided 1d-array
-    // even ndarray is not compact.
-    return ArrayRef(ndarr.buf(), ndarr.eltype(), ndarr.numel(), 1,
-                    ndarr.offset());
-  }
+bool isFlattenNoCopy(const NdArrayRef& ndarr) {
+  return linearStride(ndarr.shape(), ndarr.strides()).has_value();
+}
 
-  // Basically it's a scalar broadcasted into some shape
-  if (std::all_of(ndarr.strides().begin(), ndarr.strides().end(),
-                  [](int64_t in) { return in == 0; })) {
-    // SPDLOG_INFO("fast zero stride flatten");
-    return ArrayRef(ndarr.buf(), ndarr.eltype(), ndarr.numel(), 0,
+ArrayRef flatten(const NdArrayRef& ndarr) {
+  if (auto stride = linearStride(ndarr.shape(), ndarr.strides())) {
+    return ArrayRef(ndarr.buf(), ndarr.eltype(), ndarr.numel(), *stride,
                     ndarr.offset());
   }
 
-  // Check if only inner most dim has strides
-  if (onlyStrideInnerMostDim(ndarr.shape(), ndarr.strides())) {
-    // SPDLOG_INFO("fast innermost only stride flatten");
-    return ArrayRef(ndarr.buf(), ndarr.eltype(), ndarr.numel(),
-                    ndarr.strides().back(), ndarr.offset());
-  }
-
-  // SPDLOG_INFO("slow flatten..., in strides = {}, shape = {}",
-  // fmt::join(ndarr.strides(), "x"), fmt::join(ndarr.shape(), "x"));
-
   // create a compact clone, it's save here since underline layer will never
   // modify inplace.
   auto compact = ndarr.clone();
@@ -142,6 +142,10 @@ NdArrayRef unflatten(const ArrayRef& arr, std::vector<int64_t> shape);
 // copy is required.
 ArrayRef flatten(const NdArrayRef& ndarr);
 
+// Returns true if flatten shares the underline buffer, i.e. all elements are
+// one strided 1d-array.
+bool isFlattenNoCopy(const NdArrayRef& ndarr);
+
 std::ostream& operator<<(std::ostream& out, const NdArrayRef& v);
 
 }  // namespace spu
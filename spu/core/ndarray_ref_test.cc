@@ -65,4 +65,32 @@ TEST(ArrayRefTest, NdStrides) {
   EXPECT_EQ(b.at<int32_t>({2, 2}), 28);
 }
 
+TEST(NdArrayRefTest, FlattenNoCopy) {
+  auto buf = std::make_shared<yacl::Buffer>(36 * sizeof(int32_t));
+  std::iota(static_cast<int32_t*>(buf->data()),
+            static_cast<int32_t*>(buf->data()) + 36, 0);
+
+  // a column of a 6x6 matrix, the dim of size 1 does not matter.
+  NdArrayRef col(buf, makePtType(PT_I32), {6, 1}, {6, 1}, 4 * sizeof(int32_t));
+  EXPECT_FALSE(col.isCompact());
+  EXPECT_TRUE(isFlattenNoCopy(col));
+  auto flat_col = flatten(col);
+  EXPECT_EQ(flat_col.buf(), buf);
+  EXPECT_EQ(flat_col.stride(), 6);
+  EXPECT_EQ(flat_col.at<int32_t>(2), 16);
+
+  // a scalar broadcasted.
+  NdArrayRef scalar(buf, makePtType(PT_I32), {3, 4}, {0, 0}, 0);
+  EXPECT_TRUE(isFlattenNoCopy(scalar));
+  EXPECT_EQ(flatten(scalar).stride(), 0);
+
+  // a transposed 2x3 matrix has no 1d stride.
+  NdArrayRef transposed(buf, makePtType(PT_I32), {3, 2}, {1, 3}, 0);
+  EXPECT_FALSE(isFlattenNoCopy(transposed));
+  auto flat = flatten(transposed);
+  EXPECT_NE(flat.buf(), buf);
+  EXPECT_EQ(flat.at<int32_t>(1), 3);
+  EXPECT_EQ(flat.at<int32_t>(2), 1);
+}
+
 }  // namespace spu
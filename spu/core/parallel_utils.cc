@@ -14,14 +14,32 @@
 
 #include "spu/core/parallel_utils.h"
 
+#include <atomic>
+
 #include "llvm/Support/Threading.h"
 
 namespace spu {
 
-int getNumberOfProc() {
-  static int nProc =
-      llvm::heavyweight_hardware_concurrency().compute_thread_count() - 1;
+namespace {
+
+std::atomic<int> gNumberOfProc{0};
+
+int defaultNumberOfProc() {
+  static int nProc = std::max(
+      llvm::heavyweight_hardware_concurrency().compute_thread_count() - 1, 1);
   return nProc;
 }
 
+}  // namespace
+
+int getNumberOfProc() {
+  const int nProc = gNumberOfProc.load(std::memory_order_relaxed);
+  return nProc > 0 ? nProc : defaultNumberOfProc();
+}
+
+void setNumberOfProc(int num_threads) {
+  gNumberOfProc.store(std::max(num_threads, 0), std::memory_order_relaxed);
+  yacl::set_num_threads(getNumberOfProc());
+}
+
 }  // namespace spu
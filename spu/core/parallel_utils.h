@@ -23,12 +23,25 @@ namespace spu {
 
 constexpr int64_t kMinTaskSize = 50000;
 
+// Tasks per thread of a large parallel loop. The pool hands tasks to idle
+// threads, so with more tasks than threads a thread slowed down, e.g. by
+// remote memory or other processes, is caught up by others.
+constexpr int64_t kTasksPerProc = 4;
+
 int getNumberOfProc();
 
-inline int64_t computeTaskSize(int64_t numel) {
-  auto grain_size = static_cast<int64_t>(
-      std::ceil(static_cast<float>(numel) / getNumberOfProc()));
-  return std::max(grain_size, kMinTaskSize);
+// Limit threads of parallel loops and Eigen matmuls to `num_threads`, which
+// applies to the whole process, 0 resets to the default of all cores but one.
+void setNumberOfProc(int num_threads);
+
+// The grain size of a parallel loop of `numel` elements, where `cost` is the
+// relative cost of an element, i.e. tasks of expensive elements are smaller.
+inline int64_t computeTaskSize(int64_t numel, int64_t cost = 1) {
+  auto grain_size = static_cast<int64_t>(std::ceil(
+      static_cast<float>(numel) / (getNumberOfProc() * kTasksPerProc)));
+  return std::max(grain_size,
+                  std::max<int64_t>(kMinTaskSize / std::max<int64_t>(cost, 1),
+                                    1));
 }
 
 template <class F>
@@ -37,6 +50,13 @@ inline void pfor(const int64_t begin, const int64_t end, F&& f) {
   return yacl::parallel_for(begin, end, grain_size, f);
 }
 
+template <class F>
+inline void pfor(const int64_t begin, const int64_t end, int64_t cost,
+                 F&& f) {
+  const int64_t grain_size = computeTaskSize(end - begin, cost);
+  return yacl::parallel_for(begin, end, grain_size, f);
+}
+
 template <class F>
 inline void pforeach(const int64_t begin, const int64_t end, F&& fn) {
   const int64_t grain_size = computeTaskSize(end - begin);
@@ -14,6 +14,7 @@
 
 #include "spu/core/trace.h"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstdlib>
@@ -26,6 +27,8 @@
 #include "absl/strings/str_split.h"
 #include "yacl/base/exception.h"
 
+#include "spu/core/memory_tracker.h"
+
 #ifdef __APPLE__
 #include <mach/mach.h>
 #endif
@@ -111,6 +114,17 @@ namespace {
 
 #endif
 
+// The live bytes of arrays of the current tracker, if any, in MB like the
+// process memory.
+std::string liveBytes() {
+  const auto* tracker = MemoryTracker::current();
+  if (tracker == nullptr) {
+    return "";
+  }
+  const auto live = static_cast<float>(tracker->getStats().live_bytes);
+  return fmt::format(" L{}", live / 1024 / 1024);
+}
+
 [[maybe_unused]] std::string getIndentString(size_t indent) {
   constexpr size_t kMaxIndent = 30;
 
@@ -146,8 +160,170 @@ std::shared_ptr<spdlog::logger> getDefaultLogger() {
   return g_trace_logger;
 }
 
+// escape a string as json string content.
+std::string jsonEscape(std::string_view str) {
+  std::string res;
+  res.reserve(str.size());
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        res += "\\\"";
+        break;
+      case '\\':
+        res += "\\\\";
+        break;
+      case '\n':
+        res += "\\n";
+        break;
+      case '\t':
+        res += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          res += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+          res += c;
+        }
+    }
+  }
+  return res;
+}
+
+std::string_view getModuleName(int64_t flag) {
+  if ((flag & TR_HLO) != 0) {
+    return "HLO";
+  }
+  if ((flag & TR_HAL) != 0) {
+    return "HAL";
+  }
+  if ((flag & TR_MPC) != 0) {
+    return "MPC";
+  }
+  if ((flag & TR_COMM) != 0) {
+    return "COMM";
+  }
+  return "UNKNOWN";
+}
+
+// chrome trace uses microseconds.
+double toMicroseconds(const Duration& dur) {
+  using Micros = std::chrono::duration<double, std::micro>;
+  return std::chrono::duration_cast<Micros>(dur).count();
+}
+
 }  // namespace
 
+Tracer::Tracer(std::string name, int64_t mask,
+               std::shared_ptr<spdlog::logger> logger, size_t buffer_capacity)
+    : name_(std::move(name)),
+      mask_(mask),
+      logger_(std::move(logger)),
+      uid_(internal::genActionUuid()),
+      buffer_capacity_(buffer_capacity) {
+  YACL_ENFORCE(buffer_capacity_ > 0);
+}
+
+Tracer::ThreadBuffer* Tracer::getThreadBuffer() {
+  // keyed by uid, so a tracer allocated at a recycled address never sees a
+  // stale buffer.
+  thread_local std::unordered_map<int64_t, std::shared_ptr<ThreadBuffer>>
+      t_buffers;
+
+  auto& buf = t_buffers[uid_];
+  if (buf == nullptr) {
+    std::unique_lock lock(buffers_mutex_);
+    buf = std::make_shared<ThreadBuffer>(buffers_.size());
+    buffers_.push_back(buf);
+  }
+  return buf.get();
+}
+
+void Tracer::addRecord(ActionRecord&& rec) {
+  const int64_t mask = mask_;
+  if ((rec.flag & mask & TR_MODALL) == 0 || (mask & TR_REC) == 0) {
+    return;
+  }
+
+  auto* buf = getThreadBuffer();
+  rec.tid = buf->tid;
+
+  const size_t head = buf->head.load(std::memory_order_relaxed);
+  if (buf->slots.size() < buffer_capacity_) {
+    buf->slots.push_back(std::move(rec));
+  } else {
+    buf->slots[head % buffer_capacity_] = std::move(rec);
+  }
+  buf->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::setSampleRate(size_t rate) {
+  YACL_ENFORCE(rate > 0, "sample rate should be positive");
+  sample_rate_ = rate;
+}
+
+bool Tracer::sampleRecord() {
+  const size_t rate = sample_rate_;
+  if (rate == 1) {
+    return true;
+  }
+
+  // per thread counter, so sampling never contends between threads.
+  thread_local size_t t_counter = 0;
+  return (t_counter++ % rate) == 0;
+}
+
+std::vector<ActionRecord> Tracer::getRecords() const {
+  std::vector<ActionRecord> res;
+
+  std::unique_lock lock(buffers_mutex_);
+  for (const auto& buf : buffers_) {
+    const size_t head = buf->head.load(std::memory_order_acquire);
+    const size_t num = std::min(head, buf->slots.size());
+    for (size_t idx = head - num; idx < head; idx++) {
+      res.push_back(buf->slots[idx % buffer_capacity_]);
+    }
+  }
+
+  return res;
+}
+
+void Tracer::clearRecords() {
+  std::unique_lock lock(buffers_mutex_);
+  for (const auto& buf : buffers_) {
+    buf->slots.clear();
+    buf->head.store(0, std::memory_order_release);
+  }
+}
+
+void Tracer::dumpChromeTrace(std::ostream& os, int64_t pid) const {
+  os << "{\"traceEvents\":[";
+
+  const auto offset = getClockOffset();
+  bool first = true;
+  for (const auto& rec : getRecords()) {
+    if (!first) {
+      os << ",";
+    }
+    first = false;
+
+    // complete events, nesting is implied by the timing.
+    os << fmt::format(
+        "{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+        "\"dur\":{:.3f},\"pid\":{},\"tid\":{},\"args\":{{\"detail\":\"{}\"",
+        jsonEscape(rec.name), getModuleName(rec.flag),
+        toMicroseconds(rec.start.time_since_epoch() + offset),
+        toMicroseconds(rec.end - rec.start), pid, rec.tid,
+        jsonEscape(rec.detail));
+    if (rec.send_bytes != 0 || rec.recv_bytes != 0) {
+      os << fmt::format(",\"send_bytes\":{},\"recv_bytes\":{}",
+                        rec.send_bytes, rec.recv_bytes);
+    }
+    os << "}}";
+  }
+
+  os << "]}";
+}
+
 void Tracer::logActionBegin(int64_t id, int64_t flag, const std::string& name,
                             const std::string& detail) {
   if ((flag & mask_ & TR_MODALL) == 0 || (mask_ & TR_LOGB) == 0) {
@@ -156,7 +332,8 @@ void Tracer::logActionBegin(int64_t id, int64_t flag, const std::string& name,
   }
 
   if (mask_ & TR_LOGM) {
-    logger_->info("[B] [M{}] {}({})", GetPeakMemUsage(), name, detail);
+    logger_->info("[B] [M{}{}] {}({})", GetPeakMemUsage(), liveBytes(), name,
+                  detail);
   } else {
     logger_->info("[B] {}({})", name, detail);
   }
@@ -170,7 +347,8 @@ void Tracer::logActionEnd(int64_t id, int64_t flag, const std::string& name,
   }
 
   if (mask_ & TR_LOGM) {
-    logger_->info("[E] [M{}] {}({})", GetPeakMemUsage(), name, detail);
+    logger_->info("[E] [M{}{}] {}({})", GetPeakMemUsage(), liveBytes(), name,
+                  detail);
   } else {
     logger_->info("[E] {}({})", name, detail);
   }
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -105,7 +109,7 @@ int64_t genActionUuid();
 // is enabled, the statistics could be queried from runtime.
 #define TR_LOGB 0x0100              // log action begin
 #define TR_LOGE 0x0200              // log action end
-#define TR_LOGM 0x0400              // log current memory usage
+#define TR_LOGM 0x0400              // log memory usage and live arrays
 #define TR_REC 0x0800               // record the action
 #define TR_LOG (TR_LOGB | TR_LOGE)  // log action begin & end
 #define TR_LAR (TR_LOG | TR_REC)    // log and record the action
@@ -125,6 +129,11 @@ struct ActionRecord {
   // the action timing information.
   TimePoint start;
   TimePoint end;
+  // bytes on wire during the action, only set by communication actions.
+  int64_t send_bytes = 0;
+  int64_t recv_bytes = 0;
+  // index of the recording thread, assigned by the tracer.
+  size_t tid = 0;
 };
 
 class Tracer final {
@@ -132,18 +141,46 @@ class Tracer final {
   const std::string name_;
 
   // current tracer mask.
-  int64_t mask_;
+  std::atomic<int64_t> mask_;
 
   // the logger
   std::shared_ptr<spdlog::logger> logger_;
 
-  // the recorded action, at ending time.
-  std::vector<ActionRecord> records_;
+  // A per-thread ring buffer of recorded actions, only the owner thread
+  // appends to it, so recording never takes a lock.
+  struct ThreadBuffer {
+    const size_t tid;
+    std::vector<ActionRecord> slots;
+    // number of records ever appended.
+    std::atomic<size_t> head = 0;
+
+    explicit ThreadBuffer(size_t tid) : tid(tid) {}
+  };
+
+  // unique id of this tracer, to find thread local buffers.
+  const int64_t uid_;
+
+  // max number of records kept by each thread, the oldest are overwritten.
+  size_t buffer_capacity_;
+
+  // see setSampleRate.
+  std::atomic<size_t> sample_rate_ = 1;
+
+  // see setClockOffset, in nanoseconds.
+  std::atomic<int64_t> clock_offset_ = 0;
+
+  // all thread buffers, the mutex only guards registration.
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  mutable std::mutex buffers_mutex_;
+
+  ThreadBuffer* getThreadBuffer();
 
  public:
+  static constexpr size_t kDefaultBufferCapacity = 1UL << 20;
+
   explicit Tracer(std::string name, int64_t mask,
-                  std::shared_ptr<spdlog::logger> logger)
-      : name_(std::move(name)), mask_(mask), logger_(std::move(logger)) {}
+                  std::shared_ptr<spdlog::logger> logger,
+                  size_t buffer_capacity = kDefaultBufferCapacity);
 
   const std::string& name() const { return name_; }
 
@@ -160,13 +197,36 @@ class Tracer final {
   void logActionEnd(int64_t id, int64_t flag, const std::string& name,
                     const std::string& detail = "");
 
-  void addRecord(ActionRecord&& rec) {
-    if ((rec.flag & mask_ & TR_MODALL) != 0 && (mask_ & TR_REC) != 0) {
-      records_.push_back(std::move(rec));
-    }
-  }
-  const std::vector<ActionRecord>& getRecords() const { return records_; }
-  void clearRecords() { records_.clear(); }
+  void addRecord(ActionRecord&& rec);
+
+  // Record one of every `rate` recordable actions, 1 means record all.
+  //
+  // Note: statistics derived from records are sampled as well.
+  void setSampleRate(size_t rate);
+  size_t getSampleRate() const { return sample_rate_; }
+
+  // Return true if the next recordable action of this thread is sampled.
+  bool sampleRecord();
+
+  // The offset added to the local clock to align with the clock of rank 0,
+  // so the dumped traces of all parties share one time axis. Records keep
+  // the local clock.
+  void setClockOffset(Duration offset) { clock_offset_ = offset.count(); }
+  Duration getClockOffset() const { return Duration(clock_offset_); }
+
+  // Return recorded actions, in recording order of each thread.
+  //
+  // Note: records and clear should not happen concurrently with recording,
+  // i.e. call them before or after an execution.
+  std::vector<ActionRecord> getRecords() const;
+  void clearRecords();
+
+  // Dump recorded actions in chrome trace event format, which could be loaded
+  // by chrome://tracing or perfetto. Timestamps are shifted by the clock
+  // offset.
+  //
+  // @pid, the process id of the trace, i.e. rank of the party.
+  void dumpChromeTrace(std::ostream& os, int64_t pid) const;
 };
 
 class TraceAction final {
@@ -174,8 +234,8 @@ class TraceAction final {
   int64_t const flag_;
   int64_t const mask_;
 
-  // the uuid of this action.
-  int64_t id_;
+  // the uuid of this action, only assigned when the action is traced.
+  int64_t id_ = 0;
 
   // name of the action.
   std::string name_;
@@ -187,21 +247,44 @@ class TraceAction final {
   TimePoint start_;
   TimePoint end_;
 
+  // bytes on wire.
+  int64_t send_bytes_ = 0;
+  int64_t recv_bytes_ = 0;
+
   int64_t saved_tracer_mask_;
 
+  // the effective action flag, i.e. the requests enabled by the tracer.
+  int64_t active_flag_ = 0;
+
   template <typename... Args>
   void begin(const std::string& name, Args&&... args) {
-    name_ = name;
-    start_ = std::chrono::high_resolution_clock::now();
+    saved_tracer_mask_ = tracer_->getMask();
 
-    if ((flag_ & TR_LOGB) != 0) {
-      // request for logging begin of the acion
+    // only do the work (name copy, argument formatting, timing) when the
+    // module and the request are both enabled by the tracer.
+    if ((flag_ & saved_tracer_mask_ & TR_MODALL) != 0) {
+      active_flag_ = flag_ & saved_tracer_mask_ & (TR_LOG | TR_LOGM | TR_REC);
+      if ((active_flag_ & TR_REC) != 0 && !tracer_->sampleRecord()) {
+        active_flag_ &= ~TR_REC;
+      }
+    }
+
+    if (active_flag_ != 0) {
+      id_ = internal::genActionUuid();
+      name_ = name;
+      start_ = std::chrono::high_resolution_clock::now();
+    }
+
+    if ((active_flag_ & TR_LOG) != 0) {
       detail_ = internal::variadicToString(std::forward<Args>(args)...);
+    }
+
+    if ((active_flag_ & TR_LOGB) != 0) {
+      // request for logging begin of the acion
       tracer_->logActionBegin(id_, flag_, name_, detail_);
     }
 
     // set new mask to the tracer.
-    saved_tracer_mask_ = tracer_->getMask();
     tracer_->setMask(saved_tracer_mask_ & mask_);
   }
 
@@ -209,18 +292,22 @@ class TraceAction final {
     // recover mask of the tracer.
     tracer_->setMask(saved_tracer_mask_);
 
+    if (active_flag_ == 0) {
+      return;
+    }
+
     //
     end_ = std::chrono::high_resolution_clock::now();
 
-    if ((flag_ & TR_LOGE) != 0) {
+    if ((active_flag_ & TR_LOGE) != 0) {
       // request for logging end of the acion
       tracer_->logActionEnd(id_, flag_, name_, detail_);
     }
 
-    if ((flag_ & TR_REC) != 0) {
+    if ((active_flag_ & TR_REC) != 0) {
       // request for recording this action.
-      tracer_->addRecord(
-          ActionRecord{id_, name_, std::move(detail_), flag_, start_, end_});
+      tracer_->addRecord(ActionRecord{id_, name_, std::move(detail_), flag_,
+                                      start_, end_, send_bytes_, recv_bytes_});
     }
   }
 
@@ -240,11 +327,16 @@ class TraceAction final {
   explicit TraceAction(std::shared_ptr<Tracer> tracer, int64_t flag,
                        int64_t mask, const std::string& name, Args&&... args)
       : tracer_(std::move(tracer)), flag_(flag), mask_(mask) {
-    id_ = internal::genActionUuid();
     begin(name, std::forward<Args>(args)...);
   }
 
   ~TraceAction() { end(); }
+
+  // attach bytes on wire to this action.
+  void addCommBytes(int64_t send_bytes, int64_t recv_bytes) {
+    send_bytes_ += send_bytes;
+    recv_bytes_ += recv_bytes;
+  }
 };
 
 // global setting
@@ -255,7 +347,10 @@ std::shared_ptr<Tracer> getTracer(const std::string& name);
 
 void registerTracer(std::shared_ptr<Tracer> tracer);
 
+// Tracing could be disabled at compile time by defining SPU_DISABLE_TRACE.
+#ifndef SPU_DISABLE_TRACE
 #define SPU_ENABLE_TRACE
+#endif
 
 // TODO: support per-context trace.
 #define GET_CTX_NAME(CTX) "CTX:0"
@@ -282,6 +377,7 @@ void registerTracer(std::shared_ptr<Tracer> tracer);
 #define TR_HLO TR_MOD1
 #define TR_HAL TR_MOD2
 #define TR_MPC TR_MOD3
+#define TR_COMM TR_MOD4
 
 // trace a hal layer dispatch
 #define SPU_TRACE_HLO_DISP(CTX, ...)                                     \
@@ -14,10 +14,13 @@
 
 #include "spu/core/trace.h"
 
+#include <thread>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "spdlog/sinks/ostream_sink.h"
 #include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
 
 namespace spu {
 namespace {
@@ -71,6 +74,103 @@ TEST(TraceTest, ActionWorks) {
   EXPECT_EQ(tracer->getRecords()[1].name, "g");
 }
 
+TEST(TraceTest, RecordsPerThread) {
+  std::ostringstream oss;
+  auto tracer = std::make_shared<Tracer>("test", TR_MODALL | TR_LAR,
+                                         makeSStreamLogger(oss), 4);
+
+  auto work = [&](size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+      TraceAction ta(tracer, (TR_MOD1 | TR_REC), ~0, "f");
+    }
+  };
+
+  work(2);
+  std::thread(work, 10).join();
+
+  // the second thread only keeps its latest 4 records.
+  const auto records = tracer->getRecords();
+  ASSERT_EQ(records.size(), 6);
+  EXPECT_EQ(records[0].tid, 0);
+  EXPECT_EQ(records[5].tid, 1);
+
+  tracer->clearRecords();
+  EXPECT_TRUE(tracer->getRecords().empty());
+}
+
+TEST(TraceTest, DumpChromeTrace) {
+  std::ostringstream oss;
+  auto tracer = std::make_shared<Tracer>("test", TR_MODALL | TR_LAR,
+                                         makeSStreamLogger(oss));
+
+  {
+    TraceAction ta0(tracer, (TR_MOD2 | TR_REC), ~0, "f");
+    TraceAction ta1(tracer, (TR_MOD4 | TR_REC), ~0, "send:\"x\"");
+    ta1.addCommBytes(16, 0);
+  }
+
+  std::ostringstream trace;
+  tracer->dumpChromeTrace(trace, 2);
+  const auto json = trace.str();
+
+  using testing::HasSubstr;
+  EXPECT_THAT(json, testing::StartsWith("{\"traceEvents\":["));
+  EXPECT_THAT(json, HasSubstr("\"name\":\"f\",\"cat\":\"HAL\""));
+  EXPECT_THAT(json,
+              HasSubstr("\"name\":\"send:\\\"x\\\"\",\"cat\":\"COMM\""));
+  EXPECT_THAT(json, HasSubstr("\"pid\":2"));
+  EXPECT_THAT(json, HasSubstr("\"send_bytes\":16,\"recv_bytes\":0"));
+}
+
+TEST(TraceTest, ClockOffset) {
+  std::ostringstream oss;
+  auto tracer = std::make_shared<Tracer>("test", TR_MODALL | TR_LAR,
+                                         makeSStreamLogger(oss));
+  tracer->addRecord(ActionRecord{1, "f", "", TR_MOD1 | TR_REC,
+                                 TimePoint(std::chrono::milliseconds(1)),
+                                 TimePoint(std::chrono::milliseconds(3))});
+  tracer->setClockOffset(std::chrono::milliseconds(-5));
+  EXPECT_EQ(tracer->getClockOffset(), std::chrono::milliseconds(-5));
+
+  std::ostringstream trace;
+  tracer->dumpChromeTrace(trace, 0);
+
+  // only the dumped timestamps are shifted.
+  using testing::HasSubstr;
+  EXPECT_THAT(trace.str(), HasSubstr("\"ts\":-4000.000,\"dur\":2000.000"));
+  EXPECT_EQ(tracer->getRecords()[0].start,
+            TimePoint(std::chrono::milliseconds(1)));
+}
+
+TEST(TraceTest, SampledRecords) {
+  std::ostringstream oss;
+  auto tracer = std::make_shared<Tracer>("test", TR_MODALL | TR_LAR,
+                                         makeSStreamLogger(oss));
+  tracer->setSampleRate(4);
+
+  for (size_t idx = 0; idx < 20; idx++) {
+    TraceAction ta(tracer, (TR_MOD1 | TR_REC), ~0, "f", idx);
+  }
+
+  EXPECT_EQ(tracer->getRecords().size(), 5);
+  EXPECT_THROW(tracer->setSampleRate(0), yacl::EnforceNotMet);
+}
+
+TEST(TraceTest, LazyDetail) {
+  std::ostringstream oss;
+  auto tracer = std::make_shared<Tracer>("test", TR_MODALL | TR_REC,
+                                         makeSStreamLogger(oss));
+
+  {
+    // logging is not enabled by the tracer, arguments are not formatted.
+    TraceAction ta(tracer, (TR_MOD1 | TR_LAR), ~0, "f", 10);
+  }
+
+  ASSERT_EQ(tracer->getRecords().size(), 1);
+  EXPECT_TRUE(tracer->getRecords()[0].detail.empty());
+  EXPECT_TRUE(oss.str().empty());
+}
+
 /// macros examples.
 struct Context {
   std::string name() { return "TEST_CTX"; }
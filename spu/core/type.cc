@@ -14,6 +14,7 @@
 
 #include "spu/core/type.h"
 
+#include <map>
 #include <mutex>
 
 #include "absl/strings/match.h"
@@ -21,20 +22,32 @@
 
 namespace spu {
 
-Type::Type()
-    : model_(std::make_unique<VoidTy>()), cached_model_size_(model_->size()) {}
+size_t internTypeId(std::string_view id) {
+  static std::mutex mutex;
+  static std::map<std::string, size_t, std::less<>> indices;
 
-Type::Type(std::unique_ptr<TypeObject> model)
-    : model_(std::move(model)), cached_model_size_(model_->size()) {}
+  std::unique_lock<std::mutex> lock(mutex);
+  auto itr = indices.find(id);
+  if (itr == indices.end()) {
+    itr = indices.emplace(std::string(id), indices.size()).first;
+  }
+  return itr->second;
+}
+
+Type::Type() : model_(std::make_unique<VoidTy>()) { cacheModel(); }
+
+Type::Type(std::unique_ptr<TypeObject> model) : model_(std::move(model)) {
+  cacheModel();
+}
 
 Type& Type::operator=(const Type& other) {
   model_ = other.model_->clone();
-  cached_model_size_ = model_->size();
+  cacheModel();
   return *this;
 }
 
 bool Type::operator==(Type const& other) const {
-  if (model_->getId() != other.model_->getId()) {
+  if (cached_model_index_ != other.cached_model_index_) {
     return false;
   }
   return model_->equals(other.model_.get());
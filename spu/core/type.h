@@ -17,6 +17,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 
 #include "yacl/base/exception.h"
@@ -136,6 +137,9 @@ class BShare {
 // Type interfaces end.
 ////////////////////////////////////////////////////////////////////////////
 
+// Return a dense index of a type id, the same id always gets the same index.
+size_t internTypeId(std::string_view id);
+
 // TODO(jint) document me, how to add a new type.
 class TypeObject {
  public:
@@ -167,6 +171,12 @@ class TypeObject {
   // Return the `id` of this type, which must be THE SAME as getStaticId.
   virtual std::string_view getId() const = 0;
 
+  // Return the interned index of `getId`.
+  virtual size_t getIndex() const = 0;
+
+  // Return the Ring2k interface of this type, or null if it's not a ring.
+  virtual Ring2k* getRing2k() = 0;
+
   // Clone self.
   virtual std::unique_ptr<TypeObject> clone() const = 0;
 };
@@ -178,14 +188,24 @@ class Type final {
   // cache dynamic object size for better performance.
   size_t cached_model_size_ = -1;
 
+  // cache the type index and the ring interface, so equal tests and the
+  // common casts need neither string compares nor dynamic_cast.
+  size_t cached_model_index_ = 0;
+  Ring2k* cached_model_ring_ = nullptr;
+
+  void cacheModel() {
+    cached_model_size_ = model_->size();
+    cached_model_index_ = model_->getIndex();
+    cached_model_ring_ = model_->getRing2k();
+  }
+
  public:
   // default constructable, as the void type.
   Type();
   explicit Type(std::unique_ptr<TypeObject> model);
 
   // copy and move constructable
-  Type(const Type& other)
-      : model_(other.model_->clone()), cached_model_size_(model_->size()) {}
+  Type(const Type& other) : model_(other.model_->clone()) { cacheModel(); }
   Type& operator=(const Type& other);
   Type(Type&& other) = default;
   Type& operator=(Type&& other) = default;
@@ -212,26 +232,52 @@ class Type final {
   bool isa() const;
 };
 
+namespace detail {
+
+// Types are identified by their ids, so a model with the index of a concrete
+// type T is a T, unless T is a base of it, which dynamic_cast handles.
+template <typename T>
+constexpr bool kIsConcreteType =
+    std::is_base_of_v<TypeObject, T> && !std::is_same_v<TypeObject, T>;
+
+}  // namespace detail
+
 template <typename T>
 T const* Type::as() const {
-  T const* concrete_type = dynamic_cast<T const*>(model_.get());
-  YACL_ENFORCE(concrete_type, "casting from {} to {} failed", model_->getId(),
-               typeid(T).name());
-  return concrete_type;
+  return const_cast<Type*>(this)->as<T>();
 }
 
 template <typename T>
 T* Type::as() {
-  T* concrete_type = dynamic_cast<T*>(model_.get());
-  YACL_ENFORCE(concrete_type, "casting from {} to {} failed", model_->getId(),
-               typeid(T).name());
-  return concrete_type;
+  if constexpr (std::is_same_v<T, Ring2k>) {
+    YACL_ENFORCE(cached_model_ring_, "casting from {} to {} failed",
+                 model_->getId(), typeid(T).name());
+    return cached_model_ring_;
+  } else {
+    if constexpr (detail::kIsConcreteType<T>) {
+      if (cached_model_index_ == T::getStaticIndex()) {
+        return static_cast<T*>(model_.get());
+      }
+    }
+    T* concrete_type = dynamic_cast<T*>(model_.get());
+    YACL_ENFORCE(concrete_type, "casting from {} to {} failed",
+                 model_->getId(), typeid(T).name());
+    return concrete_type;
+  }
 }
 
 template <typename T>
 bool Type::isa() const {
-  T const* concrete_type = dynamic_cast<T const*>(model_.get());
-  return concrete_type != nullptr;
+  if constexpr (std::is_same_v<T, Ring2k>) {
+    return cached_model_ring_ != nullptr;
+  } else {
+    if constexpr (detail::kIsConcreteType<T>) {
+      if (cached_model_index_ == T::getStaticIndex()) {
+        return true;
+      }
+    }
+    return dynamic_cast<T const*>(model_.get()) != nullptr;
+  }
 }
 
 std::ostream& operator<<(std::ostream& os, const Type& type);
@@ -246,6 +292,21 @@ class TypeImpl : public BaseT, public InterfaceT... {
  public:
   std::string_view getId() const override { return DerivedT::getStaticId(); }
 
+  static size_t getStaticIndex() {
+    static const size_t index = internTypeId(DerivedT::getStaticId());
+    return index;
+  }
+
+  size_t getIndex() const override { return getStaticIndex(); }
+
+  Ring2k* getRing2k() override {
+    if constexpr (std::is_base_of_v<Ring2k, DerivedT>) {
+      return static_cast<DerivedT*>(this);
+    } else {
+      return nullptr;
+    }
+  }
+
   std::unique_ptr<TypeObject> clone() const override {
     return std::make_unique<DerivedT>(static_cast<DerivedT const&>(*this));
   }
@@ -125,4 +125,24 @@ TEST(TypeTest, RingTy) {
   EXPECT_EQ(Type::fromString(fm128.toString()), fm128);
 }
 
+TEST(TypeTest, CachedCasts) {
+  Type fm64 = makeType<RingTy>(FM64);
+  EXPECT_TRUE(fm64.isa<Ring2k>());
+  EXPECT_EQ(fm64.as<Ring2k>()->field(), FM64);
+  EXPECT_FALSE(fm64.isa<PtTy>());
+  EXPECT_THROW(fm64.as<PtTy>(), yacl::EnforceNotMet);
+
+  // the cache follows the model of a copy.
+  Type copy = fm64;
+  fm64 = makeType<RingTy>(FM32);
+  EXPECT_EQ(copy.as<Ring2k>()->field(), FM64);
+  EXPECT_EQ(fm64.as<Ring2k>()->field(), FM32);
+  EXPECT_NE(copy, fm64);
+
+  Type pt = makePtType(PT_I32);
+  EXPECT_FALSE(pt.isa<Ring2k>());
+  EXPECT_THROW(pt.as<Ring2k>(), yacl::EnforceNotMet);
+  EXPECT_NE(pt, copy);
+}
+
 }  // namespace spu
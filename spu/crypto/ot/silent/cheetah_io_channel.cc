@@ -14,11 +14,13 @@
 
 #include "cheetah_io_channel.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "spdlog/spdlog.h"
 #include "utils.h"
 #include "yacl/base/byte_container_view.h"
+#include "yacl/base/exception.h"
 #include "yacl/link/link.h"
 
 using std::shared_ptr;
@@ -26,13 +28,16 @@ using std::string;
 
 namespace spu {
 
-CheetahIo::CheetahIo(shared_ptr<yacl::link::Context> ctx)
+CheetahIo::CheetahIo(shared_ptr<yacl::link::Context> ctx,
+                     uint64_t send_buffer_size)
     : ctx_(std::move(ctx)),
       send_op_(0),
       recv_op_(0),
+      send_buffer_size_(send_buffer_size),
       send_buffer_used_(0),
       recv_buffer_used_(0) {
-  send_buffer_.resize(SEND_BUFFER_SIZE);
+  YACL_ENFORCE(send_buffer_size_ > 0);
+  send_buffer_.resize(send_buffer_size_);
 }
 
 CheetahIo::~CheetahIo() {
@@ -43,17 +48,22 @@ CheetahIo::~CheetahIo() {
   }
 }
 
+void CheetahIo::send_message(const void *data, uint64_t len) {
+  ctx_->SendAsync(
+      ctx_->NextRank(),
+      yacl::ByteContainerView(static_cast<const uint8_t *>(data), len),
+      fmt::format("Cheetah send:{}", send_op_++));
+  stats_.sent_bytes += len;
+  stats_.sent_msgs++;
+}
+
 void CheetahIo::flush() {
   if (send_buffer_used_ == 0) {
     return;
   }
 
-  ctx_->SendAsync(
-      ctx_->NextRank(),
-      yacl::ByteContainerView(send_buffer_.data(), send_buffer_used_),
-      fmt::format("Cheetah send:{}", send_op_++));
-
-  memset(send_buffer_.data(), 0, SEND_BUFFER_SIZE);
+  send_message(send_buffer_.data(), send_buffer_used_);
+  stats_.flushes++;
   send_buffer_used_ = 0;
 }
 
@@ -61,20 +71,31 @@ void CheetahIo::fill_recv() {
   recv_buffer_ =
       ctx_->Recv(ctx_->NextRank(), fmt::format("Cheetah recv:{}", recv_op_++));
   recv_buffer_used_ = 0;
+  stats_.recv_bytes += recv_buffer_.size();
+  stats_.recv_msgs++;
 }
 
 void CheetahIo::send_data_internal(const void *data, int len) {
-  size_t send_buffer_left = SEND_BUFFER_SIZE - send_buffer_used_;
-  if (send_buffer_left <= static_cast<size_t>(len)) {
-    memcpy(send_buffer_.data() + send_buffer_used_, data, send_buffer_left);
-    send_buffer_used_ += send_buffer_left;
-    flush();
+  const auto *ptr = static_cast<const uint8_t *>(data);
+  size_t left = len;
+  while (left > 0) {
+    // whole segments go out directly without the copy into the buffer.
+    if (send_buffer_used_ == 0 && left >= send_buffer_size_) {
+      send_message(ptr, send_buffer_size_);
+      ptr += send_buffer_size_;
+      left -= send_buffer_size_;
+      continue;
+    }
 
-    send_data_internal(static_cast<const char *>(data) + send_buffer_left,
-                       len - send_buffer_left);
-  } else {
-    memcpy(send_buffer_.data() + send_buffer_used_, data, len);
-    send_buffer_used_ += len;
+    size_t n = std::min<size_t>(left, send_buffer_size_ - send_buffer_used_);
+    memcpy(send_buffer_.data() + send_buffer_used_, ptr, n);
+    send_buffer_used_ += n;
+    ptr += n;
+    left -= n;
+    if (send_buffer_used_ == send_buffer_size_) {
+      send_message(send_buffer_.data(), send_buffer_used_);
+      send_buffer_used_ = 0;
+    }
   }
 }
 
@@ -22,19 +22,40 @@ namespace spu {
 
 class CheetahIo : public emp::IOChannel<CheetahIo> {
  public:
+  struct Stats {
+    size_t sent_bytes = 0;
+    size_t sent_msgs = 0;
+    size_t recv_bytes = 0;
+    size_t recv_msgs = 0;
+    // number of flush() calls that sent a message, including the ones before
+    // receiving.
+    size_t flushes = 0;
+
+    Stats operator-(const Stats& rhs) const {
+      return {sent_bytes - rhs.sent_bytes, sent_msgs - rhs.sent_msgs,
+              recv_bytes - rhs.recv_bytes, recv_msgs - rhs.recv_msgs,
+              flushes - rhs.flushes};
+    }
+  };
+
   std::shared_ptr<yacl::link::Context> ctx_;
 
   const static uint64_t SEND_BUFFER_SIZE = 1024 * 1024;
   uint32_t send_op_;
   uint32_t recv_op_;
 
+  // Small messages are coalesced until the buffer is full or flushed, and a
+  // large one is sent in segments of the buffer size, so that it does not
+  // hold the link for long if it's shared by threads.
+  const uint64_t send_buffer_size_;
   std::vector<uint8_t> send_buffer_;
   uint64_t send_buffer_used_;
 
   yacl::Buffer recv_buffer_;
   uint64_t recv_buffer_used_;
 
-  explicit CheetahIo(std::shared_ptr<yacl::link::Context> ctx);
+  explicit CheetahIo(std::shared_ptr<yacl::link::Context> ctx,
+                     uint64_t send_buffer_size = SEND_BUFFER_SIZE);
 
   ~CheetahIo();
 
@@ -51,6 +72,13 @@ class CheetahIo : public emp::IOChannel<CheetahIo> {
 
   template <typename T>
   void recv_data_partial(T* data, int len, int bitlength);
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  void send_message(const void* data, uint64_t len);
+
+  Stats stats_;
 };
 
 }  // namespace spu
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <future>
+#include <string>
 #include <thread>
 
 #include "gtest/gtest.h"
@@ -51,6 +52,42 @@ TEST(CheetahIoTest, Test) {
   player2.get();
 }
 
+TEST(CheetahIoTest, Coalescing) {
+  const int kWorldSize = 2;
+  auto contexts = yacl::link::test::SetupWorld(kWorldSize);
+  const std::string msg = "hello world, goodbye world.";
+
+  std::future<void> player1 = std::async([&] {
+    CheetahIo io(contexts[0], /*send_buffer_size*/ 8);
+    // small messages are coalesced until flushed.
+    io.send_data(msg.data(), 5);
+    io.send_data(msg.data() + 5, 2);
+    EXPECT_EQ(io.stats().sent_msgs, 0);
+    io.flush();
+    // two segments go out directly, 4 bytes left in the buffer.
+    io.send_data(msg.data() + 7, 20);
+    EXPECT_EQ(io.stats().sent_msgs, 3);
+    io.flush();
+
+    const auto& stats = io.stats();
+    EXPECT_EQ(stats.sent_bytes, 27);
+    EXPECT_EQ(stats.sent_msgs, 4);
+    EXPECT_EQ(stats.flushes, 2);
+  });
+
+  std::future<void> player2 = std::async([&] {
+    CheetahIo io(contexts[1]);
+    std::string got(msg.size(), '\0');
+    io.recv_data(got.data(), got.size());
+    EXPECT_EQ(got, msg);
+    EXPECT_EQ(io.stats().recv_msgs, 4);
+    EXPECT_EQ(io.stats().recv_bytes, 27);
+  });
+
+  player1.get();
+  player2.get();
+}
+
 TEST(CheetahIoTest, TestPartial) {
   const int kWorldSize = 2;
   auto contexts = yacl::link::test::SetupWorld(kWorldSize);
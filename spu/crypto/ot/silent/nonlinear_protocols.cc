@@ -14,11 +14,80 @@
 
 #include "nonlinear_protocols.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
 #include "spdlog/spdlog.h"
 #include "utils.h"
 
 namespace spu {
 
+namespace {
+
+// Rough costs on one x86 core, they only need to rank the digit sizes.
+constexpr double kSecondsPerCot = 2e-8;
+constexpr double kSecondsPerLeafMessage = 2e-9;
+
+// The leaf OTs, and the triples by two COTs of each direction.
+constexpr int kMillionaireSetupRounds = 3;
+
+constexpr int kProbePings = 3;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point begin) {
+  return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+}  // namespace
+
+int choose_millionaire_radix(int bitlength, int num_cmps,
+                             const OTLinkProfile &profile) {
+  const int max_radix = std::min(KKOT_TYPES, bitlength - 1);
+  // configureMillionaire rejects it.
+  if (max_radix < 1) {
+    return 1;
+  }
+
+  const double cmps = std::ceil(std::max(num_cmps, 1) / 8.0) * 8;
+  const double rtt_seconds = std::max(profile.rtt_seconds, 0.0);
+  const double bytes_per_second = std::max(profile.bytes_per_second, 1.0);
+
+  int best_radix = 1;
+  double best_seconds = std::numeric_limits<double>::max();
+  for (int beta = 1; beta <= max_radix; beta++) {
+    const int num_digits = (bitlength + beta - 1) / beta;
+    const int log_num_digits = bitlen(num_digits);
+    const int num_triples = 2 * num_digits - 2 - log_num_digits;
+    int and_rounds = 0;
+    for (int i = 1; i < num_digits; i *= 2) {
+      and_rounds++;
+    }
+
+    // A leaf is a 1-out-of-2^beta OT of 2-bit messages by beta COTs, and a
+    // triple takes two COTs and opens 2 bits of each party.
+    const double leaf_bits = (beta + 2.0 * (1 << beta)) * num_digits;
+    const double triple_bits = 6.0 * num_triples;
+    const double compute_seconds =
+        num_digits * (beta * kSecondsPerCot +
+                      (1 << beta) * kSecondsPerLeafMessage) +
+        num_triples * 2 * kSecondsPerCot;
+
+    const double seconds =
+        cmps * ((leaf_bits + triple_bits) / 8 / bytes_per_second +
+                compute_seconds) +
+        (and_rounds + kMillionaireSetupRounds) * rtt_seconds;
+    // ties go to the smaller digits.
+    if (seconds < best_seconds) {
+      best_seconds = seconds;
+      best_radix = beta;
+    }
+  }
+  return best_radix;
+}
+
 Triple::Triple(int num_triples, bool packed)
     : packed(packed), num_triples(num_triples) {
   if (packed) {
@@ -60,6 +129,72 @@ void NonlinearProtocols::open(T *plain, const T *share, int size,
   }
 }
 
+template <typename T>
+void NonlinearProtocols::open_batch(const std::vector<T *> &plain,
+                                    const std::vector<const T *> &share,
+                                    const std::vector<int> &size,
+                                    std::function<T(T, T)> op, int bw) {
+  if (plain.size() != share.size() || plain.size() != size.size()) {
+    throw std::invalid_argument("Mismatched sizes of open_batch");
+  }
+  if (bw <= 0) {
+    bw = sizeof(T) * 8;
+  }
+
+  // all shares go in one flush before the first receive.
+  for (size_t i = 0; i < share.size(); i++) {
+    otpack_->io_->send_data_partial(share[i], size[i], bw);
+  }
+  flush();
+  for (size_t i = 0; i < plain.size(); i++) {
+    otpack_->io_->recv_data_partial(plain[i], size[i], bw);
+    for (int j = 0; j < size[i]; j++) {
+      plain[i][j] = op(plain[i][j], share[i][j]);
+    }
+  }
+}
+
+void NonlinearProtocols::probe_link(int probe_bytes) {
+  uint8_t ping = 0;
+  if (party_ == emp::ALICE) {
+    OTLinkProfile profile;
+    profile.rtt_seconds = std::numeric_limits<double>::max();
+    for (int i = 0; i < kProbePings; i++) {
+      const auto begin = Clock::now();
+      otpack_->io_->send_data(&ping, 1);
+      flush();
+      otpack_->io_->recv_data(&ping, 1);
+      profile.rtt_seconds = std::min(profile.rtt_seconds, seconds_since(begin));
+    }
+
+    std::vector<uint8_t> probe(probe_bytes);
+    const auto begin = Clock::now();
+    otpack_->io_->send_data(probe.data(), probe_bytes);
+    flush();
+    otpack_->io_->recv_data(&ping, 1);
+    const double seconds =
+        std::max(seconds_since(begin) - profile.rtt_seconds, 1e-6);
+    profile.bytes_per_second = probe_bytes / seconds;
+
+    otpack_->io_->send_data(&profile, sizeof(profile));
+    flush();
+    link_profile_ = profile;
+  } else {
+    for (int i = 0; i < kProbePings; i++) {
+      otpack_->io_->recv_data(&ping, 1);
+      otpack_->io_->send_data(&ping, 1);
+      flush();
+    }
+
+    std::vector<uint8_t> probe(probe_bytes);
+    otpack_->io_->recv_data(probe.data(), probe_bytes);
+    otpack_->io_->send_data(&ping, 1);
+    flush();
+
+    otpack_->io_->recv_data(&link_profile_, sizeof(link_profile_));
+  }
+}
+
 void NonlinearProtocols::beaver_triple(Triple *triples) {
   beaver_triple(triples->ai.data(), triples->bi.data(), triples->ci.data(),
                 triples->num_triples, triples->packed);
@@ -676,7 +811,10 @@ void NonlinearProtocols::msb1_to_wrap(uint8_t *wrap_x, const T *x, int32_t size,
 }
 
 std::unique_ptr<MillionaireConfig> NonlinearProtocols::configureMillionaire(
-    int bitlength, int radix_base) {
+    int bitlength, int num_cmps, int radix_base) {
+  if (radix_base <= 0) {
+    radix_base = choose_millionaire_radix(bitlength, num_cmps, link_profile_);
+  }
   assert(radix_base <= 8);
   std::unique_ptr<MillionaireConfig> config =
       std::make_unique<MillionaireConfig>();
@@ -918,7 +1056,7 @@ void NonlinearProtocols::compare(uint8_t *res, const T *data, int num_cmps,
   if (bitlength <= 0) bitlength = sizeof(T) * 8;
 
   std::unique_ptr<MillionaireConfig> config =
-      configureMillionaire(bitlength, radix_base);
+      configureMillionaire(bitlength, num_cmps, radix_base);
   const int num_digits = config->num_digits;
   const int r = config->r;
   const int beta = config->beta;
@@ -1012,6 +1150,35 @@ void NonlinearProtocols::compare(uint8_t *res, const T *data, int num_cmps,
   }
 }
 
+template <typename T>
+void NonlinearProtocols::compare_batch(const std::vector<uint8_t *> &res,
+                                       const std::vector<const T *> &data,
+                                       const std::vector<int> &num_cmps,
+                                       int bitlength, bool greater_than,
+                                       int radix_base) {
+  if (res.size() != data.size() || res.size() != num_cmps.size()) {
+    throw std::invalid_argument("Mismatched sizes of compare_batch");
+  }
+
+  std::vector<T> data_all;
+  for (size_t i = 0; i < data.size(); i++) {
+    data_all.insert(data_all.end(), data[i], data[i] + num_cmps[i]);
+  }
+  if (data_all.empty()) {
+    return;
+  }
+
+  std::vector<uint8_t> res_all(data_all.size());
+  compare(res_all.data(), data_all.data(), static_cast<int>(data_all.size()),
+          bitlength, greater_than, false, radix_base);
+
+  auto iter = res_all.begin();
+  for (size_t i = 0; i < res.size(); i++) {
+    std::copy(iter, iter + num_cmps[i], res[i]);
+    iter += num_cmps[i];
+  }
+}
+
 template void NonlinearProtocols::open<uint32_t>(
     uint32_t *plain, const uint32_t *share, int size,
     std::function<uint32_t(uint32_t, uint32_t)> op, int bw);
@@ -1022,6 +1189,19 @@ template void NonlinearProtocols::open<uint128_t>(
     uint128_t *plain, const uint128_t *share, int size,
     std::function<uint128_t(uint128_t, uint128_t)> op, int bw);
 
+template void NonlinearProtocols::open_batch<uint32_t>(
+    const std::vector<uint32_t *> &plain,
+    const std::vector<const uint32_t *> &share, const std::vector<int> &size,
+    std::function<uint32_t(uint32_t, uint32_t)> op, int bw);
+template void NonlinearProtocols::open_batch<uint64_t>(
+    const std::vector<uint64_t *> &plain,
+    const std::vector<const uint64_t *> &share, const std::vector<int> &size,
+    std::function<uint64_t(uint64_t, uint64_t)> op, int bw);
+template void NonlinearProtocols::open_batch<uint128_t>(
+    const std::vector<uint128_t *> &plain,
+    const std::vector<const uint128_t *> &share, const std::vector<int> &size,
+    std::function<uint128_t(uint128_t, uint128_t)> op, int bw);
+
 template void NonlinearProtocols::randbit<uint32_t>(uint32_t *r, int num);
 template void NonlinearProtocols::randbit<uint64_t>(uint64_t *r, int num);
 template void NonlinearProtocols::randbit<uint128_t>(uint128_t *r, int num);
@@ -1105,6 +1285,22 @@ template void NonlinearProtocols::compare<uint128_t>(
     uint8_t *res, const uint128_t *data, int num_cmps, int bitlength,
     bool greater_than, bool equality, int radix_base);
 
+template void NonlinearProtocols::compare_batch<uint32_t>(
+    const std::vector<uint8_t *> &res,
+    const std::vector<const uint32_t *> &data,
+    const std::vector<int> &num_cmps, int bitlength, bool greater_than,
+    int radix_base);
+template void NonlinearProtocols::compare_batch<uint64_t>(
+    const std::vector<uint8_t *> &res,
+    const std::vector<const uint64_t *> &data,
+    const std::vector<int> &num_cmps, int bitlength, bool greater_than,
+    int radix_base);
+template void NonlinearProtocols::compare_batch<uint128_t>(
+    const std::vector<uint8_t *> &res,
+    const std::vector<const uint128_t *> &data,
+    const std::vector<int> &num_cmps, int bitlength, bool greater_than,
+    int radix_base);
+
 template void NonlinearProtocols::truncate<uint32_t>(
     uint32_t *outB, const uint32_t *inA, int32_t dim, int32_t shift, int32_t bw,
     bool signed_arithmetic, uint8_t *msb_x);
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 #include "cheetah_io_channel.h"
 #include "silent_ot_pack.h"
@@ -40,6 +41,21 @@ struct DReluConfig {
 
 #define MILL_PARAM 4
 
+// The link between the two parties, the digit size of the millionaire
+// comparison is chosen by it.
+struct OTLinkProfile {
+  double rtt_seconds = 1e-4;
+  double bytes_per_second = 1e9;
+};
+
+// The digit size in [1, min(8, bitlength - 1)] of the least expected time of
+// `num_cmps` comparisons of `bitlength` bits. Large digits take fewer rounds
+// of ANDs but 2^digit OT messages per digit, so they pay off on slow RTT or
+// small batches. It is deterministic, parties of the same arguments choose
+// the same.
+int choose_millionaire_radix(int bitlength, int num_cmps,
+                             const OTLinkProfile &profile);
+
 struct MillionaireConfig {
   int l, r, log_alpha, beta, beta_pow;
   int num_digits, num_triples_corr, num_triples_std, log_num_digits;
@@ -73,6 +89,24 @@ class NonlinearProtocols {
   void open(T *plain, const T *share, int size, std::function<T(T, T)> op,
             int bw = 0);
 
+  // open several arrays in one round, the i-th of `size[i]` elements.
+  template <typename T>
+  void open_batch(const std::vector<T *> &plain,
+                  const std::vector<const T *> &share,
+                  const std::vector<int> &size, std::function<T(T, T)> op,
+                  int bw = 0);
+
+  // Measure the link to the peer by a few pings and a transfer of
+  // `probe_bytes`, both parties should call it at the same point and then use
+  // the profile measured by ALICE.
+  void probe_link(int probe_bytes = 1 << 20);
+
+  void set_link_profile(const OTLinkProfile &profile) {
+    link_profile_ = profile;
+  }
+
+  const OTLinkProfile &link_profile() const { return link_profile_; }
+
   void beaver_triple(uint8_t *ai, uint8_t *bi, uint8_t *ci, int num_triples,
                      bool packed = true) const;
 
@@ -135,17 +169,28 @@ class NonlinearProtocols {
   void msb1_to_wrap(uint8_t *wrap_x, const T *x, int32_t size,
                     int32_t bw_x = 0);
 
+  // `radix_base` is the digit size, or 0 to choose it by the link profile.
   template <typename T>
   void compare(uint8_t *res, const T *data, int num_cmps, int bitlength = 0,
                bool greater_than = true, bool equality = false,
-               int radix_base = MILL_PARAM);
+               int radix_base = 0);
+
+  // compare several arrays of the same bitlength in one run of the protocol,
+  // so they share the OT and AND rounds.
+  template <typename T>
+  void compare_batch(const std::vector<uint8_t *> &res,
+                     const std::vector<const T *> &data,
+                     const std::vector<int> &num_cmps, int bitlength = 0,
+                     bool greater_than = true, int radix_base = 0);
 
  private:
+  OTLinkProfile link_profile_;
+
   template <typename type>
   std::unique_ptr<DReluConfig<type> > configureDRelu(int l);
 
   std::unique_ptr<MillionaireConfig> configureMillionaire(
-      int bitlength, int radix_base = MILL_PARAM);
+      int bitlength, int num_cmps, int radix_base = MILL_PARAM);
 
   void set_leaf_ot_messages(uint8_t *ot_messages, uint8_t digit, int N,
                             uint8_t mask_cmp, uint8_t mask_eq,
@@ -0,0 +1,178 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/crypto/ot/silent/nonlinear_protocols.h"
+
+#include <algorithm>
+#include <future>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "yacl/link/test_util.h"
+
+namespace spu {
+
+namespace {
+
+// Run `fn(protocols)` by both parties.
+template <typename Fn>
+void RunTwoParties(Fn &&fn) {
+  auto lctxs = yacl::link::test::SetupWorld(2);
+  auto party = [&](int rank) {
+    auto otpack = std::make_shared<SilentOTPack>(
+        rank == 0 ? emp::ALICE : emp::BOB,
+        std::make_unique<CheetahIo>(lctxs[rank]));
+    NonlinearProtocols protocols(otpack);
+    fn(rank, &protocols);
+  };
+  auto alice = std::async(party, 0);
+  auto bob = std::async(party, 1);
+  alice.get();
+  bob.get();
+}
+
+std::vector<uint64_t> RandomValues(size_t num, int bitlength, uint32_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<uint64_t> values(num);
+  for (auto &value : values) {
+    value = rng() & ((uint64_t(1) << bitlength) - 1);
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST(NonlinearProtocolsTest, ChooseMillionaireRadix) {
+  OTLinkProfile lan;
+  OTLinkProfile wan{0.05, 1e7};
+
+  for (int bitlength : {2, 8, 32, 63, 64}) {
+    for (int num_cmps : {1, 1000, 1 << 20}) {
+      const int lan_radix = choose_millionaire_radix(bitlength, num_cmps, lan);
+      const int wan_radix = choose_millionaire_radix(bitlength, num_cmps, wan);
+      EXPECT_GE(lan_radix, 1);
+      EXPECT_LE(lan_radix, std::min(8, bitlength - 1));
+      EXPECT_GE(wan_radix, 1);
+      EXPECT_LE(wan_radix, std::min(8, bitlength - 1));
+    }
+  }
+
+  // fewer rounds pay off for a few comparisons on a slow link.
+  EXPECT_GT(choose_millionaire_radix(64, 8, wan),
+            choose_millionaire_radix(64, 1 << 20, lan));
+}
+
+TEST(NonlinearProtocolsTest, CompareBatch) {
+  const int bitlength = 40;
+  const std::vector<int> num_cmps = {7, 100, 0, 33};
+
+  std::vector<std::vector<uint64_t>> inputs[2];
+  std::vector<std::vector<uint8_t>> outputs[2];
+  for (int rank = 0; rank < 2; rank++) {
+    for (size_t i = 0; i < num_cmps.size(); i++) {
+      inputs[rank].push_back(
+          RandomValues(num_cmps[i], bitlength, rank * 10 + i));
+      outputs[rank].emplace_back(num_cmps[i]);
+    }
+  }
+
+  RunTwoParties([&](int rank, NonlinearProtocols *protocols) {
+    std::vector<uint8_t *> res;
+    std::vector<const uint64_t *> data;
+    for (size_t i = 0; i < num_cmps.size(); i++) {
+      res.push_back(outputs[rank][i].data());
+      data.push_back(inputs[rank][i].data());
+    }
+    protocols->compare_batch(res, data, num_cmps, bitlength);
+  });
+
+  for (size_t i = 0; i < num_cmps.size(); i++) {
+    for (int j = 0; j < num_cmps[i]; j++) {
+      EXPECT_EQ(outputs[0][i][j] ^ outputs[1][i][j],
+                inputs[0][i][j] > inputs[1][i][j] ? 1 : 0);
+    }
+  }
+}
+
+TEST(NonlinearProtocolsTest, CompareByRadix) {
+  const int bitlength = 17;
+  const int num_cmps = 64;
+
+  std::vector<uint64_t> inputs[2] = {RandomValues(num_cmps, bitlength, 1),
+                                     RandomValues(num_cmps, bitlength, 2)};
+  for (int radix = 0; radix <= 8; radix++) {
+    std::vector<uint8_t> outputs[2] = {std::vector<uint8_t>(num_cmps),
+                                       std::vector<uint8_t>(num_cmps)};
+    RunTwoParties([&](int rank, NonlinearProtocols *protocols) {
+      protocols->compare(outputs[rank].data(), inputs[rank].data(), num_cmps,
+                         bitlength, true, false, radix);
+    });
+
+    for (int i = 0; i < num_cmps; i++) {
+      EXPECT_EQ(outputs[0][i] ^ outputs[1][i],
+                inputs[0][i] > inputs[1][i] ? 1 : 0)
+          << "radix " << radix;
+    }
+  }
+}
+
+TEST(NonlinearProtocolsTest, OpenBatch) {
+  const std::vector<int> size = {5, 0, 17};
+
+  std::vector<std::vector<uint64_t>> shares[2];
+  std::vector<std::vector<uint64_t>> plains[2];
+  for (int rank = 0; rank < 2; rank++) {
+    for (size_t i = 0; i < size.size(); i++) {
+      shares[rank].push_back(RandomValues(size[i], 64 - 1, rank * 10 + i));
+      plains[rank].emplace_back(size[i]);
+    }
+  }
+
+  RunTwoParties([&](int rank, NonlinearProtocols *protocols) {
+    std::vector<uint64_t *> plain;
+    std::vector<const uint64_t *> share;
+    for (size_t i = 0; i < size.size(); i++) {
+      plain.push_back(plains[rank][i].data());
+      share.push_back(shares[rank][i].data());
+    }
+    const auto flushes = protocols->otpack_->io_->stats().flushes;
+    protocols->open_batch<uint64_t>(plain, share, size,
+                                    std::bit_xor<uint64_t>());
+    EXPECT_EQ(protocols->otpack_->io_->stats().flushes, flushes + 1);
+  });
+
+  for (size_t i = 0; i < size.size(); i++) {
+    for (int j = 0; j < size[i]; j++) {
+      const uint64_t expected = shares[0][i][j] ^ shares[1][i][j];
+      EXPECT_EQ(plains[0][i][j], expected);
+      EXPECT_EQ(plains[1][i][j], expected);
+    }
+  }
+}
+
+TEST(NonlinearProtocolsTest, ProbeLink) {
+  OTLinkProfile profiles[2];
+  RunTwoParties([&](int rank, NonlinearProtocols *protocols) {
+    protocols->probe_link(1 << 16);
+    profiles[rank] = protocols->link_profile();
+  });
+
+  EXPECT_GE(profiles[0].rtt_seconds, 0);
+  EXPECT_GT(profiles[0].bytes_per_second, 0);
+  EXPECT_DOUBLE_EQ(profiles[0].rtt_seconds, profiles[1].rtt_seconds);
+  EXPECT_DOUBLE_EQ(profiles[0].bytes_per_second,
+                   profiles[1].bytes_per_second);
+}
+
+}  // namespace spu
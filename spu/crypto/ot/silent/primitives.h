@@ -26,17 +26,26 @@ class CheetahPrimitives {
   std::unique_ptr<NonlinearProtocols> nonlinear_;
 
  public:
-  explicit CheetahPrimitives(std::shared_ptr<yacl::link::Context> lctx) {
+  explicit CheetahPrimitives(std::shared_ptr<yacl::link::Context> lctx,
+                             int ot_threads = kSilentOTThreads) {
     // Map rank to party.
     cheetah_party_ = lctx->Rank() == 0 ? emp::ALICE : emp::BOB;
     // Setup silent ot.
     silent_ot_pack_ = std::make_shared<SilentOTPack>(
-        cheetah_party_, std::make_unique<CheetahIo>(lctx));
+        cheetah_party_, std::make_unique<CheetahIo>(lctx), ot_threads);
     // Setup primitive protocols.
     nonlinear_ = std::make_unique<NonlinearProtocols>(silent_ot_pack_);
+    // The digit size of comparisons is chosen by the link.
+    nonlinear_->probe_link();
   }
 
   NonlinearProtocols* nonlinear() { return nonlinear_.get(); }
+
+  // Pre-generate `num_ot` random COTs of each direction, both parties should
+  // call it at the same point.
+  void prefetch(int64_t num_ot) { silent_ot_pack_->prefetch(num_ot); }
+
+  CheetahIo::Stats ioStats() const { return silent_ot_pack_->stats(); }
 };
 
 }  // namespace spu
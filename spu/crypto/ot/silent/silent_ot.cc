@@ -313,14 +313,59 @@ void SilentOT::recv_ot_cm_cc(T* data, const uint8_t* r, int64_t length, int l) {
   }
 }
 
-// random correlated message, chosen choice
+// Generate `length` random correlated OTs into the pool, after the ones not
+// consumed yet.
+void SilentOT::prefetch_rcot(int64_t length) {
+  if (length <= 0) {
+    return;
+  }
+  // drop the consumed ones.
+  rcot_pool_.erase(rcot_pool_.begin(), rcot_pool_.begin() + rcot_pool_pos_);
+  rcot_pool_pos_ = 0;
+
+  const size_t old_size = rcot_pool_.size();
+  rcot_pool_.resize(old_size + length);
+  ferret->rcot(rcot_pool_.data() + old_size, length);
+}
+
+// Random correlated OTs, taken from the prefetched pool first.
+void SilentOT::rcot(block* data, int64_t length) {
+  const int64_t cached = std::min(length, num_prefetched_rcot());
+  if (cached > 0) {
+    std::copy_n(rcot_pool_.data() + rcot_pool_pos_, cached, data);
+    rcot_pool_pos_ += cached;
+    if (num_prefetched_rcot() == 0) {
+      rcot_pool_.clear();
+      rcot_pool_pos_ = 0;
+    }
+  }
+  if (cached < length) {
+    ferret->rcot(data + cached, length - cached);
+  }
+}
+
+// Same as COT::send_cot, the receiver sends the choice bits corrected by
+// the random ones.
 void SilentOT::send_ot_rcm_cc(block* data0, int64_t length) {
-  ferret->send_cot(data0, length);
+  rcot(data0, length);
+  std::vector<uint8_t> bo(length);
+  ferret->io->recv_bool(reinterpret_cast<bool*>(bo.data()), length);
+  for (int64_t i = 0; i < length; ++i) {
+    if (bo[i]) {
+      data0[i] = data0[i] ^ ferret->Delta;
+    }
+  }
 }
 
-// random correlated message, chosen choice
+// Same as COT::recv_cot, the choice bits corrected by the random ones are
+// sent to the sender.
 void SilentOT::recv_ot_rcm_cc(block* data, const bool* b, int64_t length) {
-  ferret->recv_cot(data, b, length);
+  rcot(data, length);
+  std::vector<uint8_t> bo(length);
+  for (int64_t i = 0; i < length; ++i) {
+    bo[i] = getLSB(data[i]) ^ b[i];
+  }
+  ferret->io->send_bool(reinterpret_cast<bool*>(bo.data()), length);
 }
 
 // random message, chosen choice
@@ -355,7 +400,7 @@ void SilentOT::recv_ot_rm_cc(block* data, const bool* r, int64_t length) {
 
 // random message, random choice
 void SilentOT::send_ot_rm_rc(block* data0, block* data1, int64_t length) {
-  ferret->rcot(data0, length);
+  rcot(data0, length);
 
   block pad[ot_bsize * 2];
   for (int64_t i = 0; i < length; i += ot_bsize) {
@@ -373,7 +418,7 @@ void SilentOT::send_ot_rm_rc(block* data0, block* data1, int64_t length) {
 
 // random message, random choice
 void SilentOT::recv_ot_rm_rc(block* data, bool* r, int64_t length) {
-  ferret->rcot(data, length);
+  rcot(data, length);
   for (int64_t i = 0; i < length; i++) {
     r[i] = getLSB(data[i]);
   }
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include "cheetah_io_channel.h"
 #include "emp-ot/cot.h"
@@ -187,6 +188,23 @@ class SilentOT {
                         int num_ot, int msgs_per_ot = 1) {
     throw std::logic_error("Not implemented");
   }
+
+  // Pre-generate `length` random COTs, the following OTs consume them before
+  // extending new ones, so the online phase only derandomizes. It runs the
+  // OT extension with the peer, both parties should prefetch the same length
+  // at the same point of the protocol.
+  void prefetch_rcot(int64_t length);
+
+  int64_t num_prefetched_rcot() const {
+    return static_cast<int64_t>(rcot_pool_.size()) - rcot_pool_pos_;
+  }
+
+ private:
+  // random COTs, from the prefetched ones first.
+  void rcot(block *data, int64_t length);
+
+  std::vector<block> rcot_pool_;
+  int64_t rcot_pool_pos_ = 0;
 };
 
 class SilentOTN {
@@ -0,0 +1,82 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The random COT throughput of the ferret OT extension by threads, the
+// `rots` counter of each direction is in rot/s.
+//
+// e.g.
+// bazel run -c opt //spu/crypto/ot/silent:silent_ot_bench
+
+#include <future>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "yacl/link/test_util.h"
+
+#include "spu/crypto/ot/silent/silent_ot_pack.h"
+
+namespace spu {
+namespace {
+
+void BM_SilentOTPrefetch(benchmark::State& state) {
+  const int threads = static_cast<int>(state.range(0));
+  const int64_t num_ot = state.range(1);
+
+  double sent_bytes = 0;
+  for (auto _ : state) {
+    // the setup runs the base OTs and the first extension, not timed.
+    state.PauseTiming();
+    auto lctxs = yacl::link::test::SetupWorld(2);
+    std::unique_ptr<SilentOTPack> packs[2];
+    auto alice_setup = std::async([&] {
+      packs[0] = std::make_unique<SilentOTPack>(
+          emp::ALICE, std::make_unique<CheetahIo>(lctxs[0]), threads);
+    });
+    auto bob_setup = std::async([&] {
+      packs[1] = std::make_unique<SilentOTPack>(
+          emp::BOB, std::make_unique<CheetahIo>(lctxs[1]), threads);
+    });
+    alice_setup.get();
+    bob_setup.get();
+    const auto begin = packs[0]->stats();
+    state.ResumeTiming();
+
+    auto alice = std::async([&] { packs[0]->prefetch(num_ot); });
+    auto bob = std::async([&] { packs[1]->prefetch(num_ot); });
+    alice.get();
+    bob.get();
+
+    state.PauseTiming();
+    sent_bytes += (packs[0]->stats() - begin).sent_bytes;
+    packs[0].reset();
+    packs[1].reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["rots"] =
+      benchmark::Counter(static_cast<double>(num_ot),
+                         benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["sent_bytes_per_ot"] =
+      sent_bytes / (static_cast<double>(num_ot) * 2 * state.iterations());
+}
+
+BENCHMARK(BM_SilentOTPrefetch)
+    ->ArgNames({"threads", "num_ot"})
+    ->ArgsProduct({{1, 2, 4, 8}, {1 << 20, 1 << 23}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace spu
+
+BENCHMARK_MAIN();
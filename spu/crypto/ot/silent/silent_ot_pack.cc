@@ -18,17 +18,23 @@
 #include <utility>
 
 namespace spu {
-SilentOTPack::SilentOTPack(int party, std::unique_ptr<IO> io) {
+SilentOTPack::SilentOTPack(int party, std::unique_ptr<IO> io, int threads) {
   party_ = party;
   io_ = std::move(io);
-  ios_[0] = io_.get();
-  silent_ot_ = std::make_unique<SilentOT>(party, 1, ios_.data(), false, true,
-                                          party == emp::ALICE
-                                              ? PRE_OT_DATA_REG_SEND_FILE_ALICE
-                                              : PRE_OT_DATA_REG_RECV_FILE_BOB,
-                                          false);
+  ios_.push_back(io_.get());
+  // Both parties spawn the links in the same order.
+  for (int i = 1; i < threads; i++) {
+    thread_ios_.push_back(std::make_unique<IO>(io_->ctx_->Spawn()));
+    ios_.push_back(thread_ios_.back().get());
+  }
+
+  silent_ot_ = std::make_unique<SilentOT>(
+      party, threads, ios_.data(), false, true,
+      party == emp::ALICE ? PRE_OT_DATA_REG_SEND_FILE_ALICE
+                          : PRE_OT_DATA_REG_RECV_FILE_BOB,
+      false);
   silent_ot_reversed_ = std::make_unique<SilentOT>(
-      3 - party, 1, ios_.data(), false, true,
+      3 - party, threads, ios_.data(), false, true,
       party == emp::ALICE ? PRE_OT_DATA_REG_RECV_FILE_ALICE
                           : PRE_OT_DATA_REG_SEND_FILE_BOB,
       false);
@@ -38,4 +44,23 @@ SilentOTPack::SilentOTPack(int party, std::unique_ptr<IO> io) {
   }
 }
 
+CheetahIo::Stats SilentOTPack::stats() const {
+  CheetahIo::Stats stats = io_->stats();
+  for (const auto& io : thread_ios_) {
+    stats.sent_bytes += io->stats().sent_bytes;
+    stats.recv_bytes += io->stats().recv_bytes;
+  }
+  return stats;
+}
+
+void SilentOTPack::prefetch(int64_t num_ot) {
+  // the same order on both parties, silent_ot_ of one party pairs with
+  // silent_ot_ of the other.
+  silent_ot_->prefetch_rcot(num_ot);
+  silent_ot_reversed_->prefetch_rcot(num_ot);
+  for (auto* io : ios_) {
+    io->flush();
+  }
+}
+
 }  // namespace spu
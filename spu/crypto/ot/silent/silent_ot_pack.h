@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "cheetah_io_channel.h"
 #include "silent_ot.h"
 
@@ -27,18 +30,34 @@
 namespace spu {
 using IO = CheetahIo;
 
+// The default threads of the ferret OT extension, both parties must use the
+// same number.
+inline constexpr int kSilentOTThreads = 4;
+
 class SilentOTPack {
  public:
   int party_;
   std::unique_ptr<IO> io_ = nullptr;
-  std::array<IO*, 1> ios_ = {nullptr};
+  // the ios of the other threads, on their own spawned links.
+  std::vector<std::unique_ptr<IO>> thread_ios_;
+  std::vector<IO*> ios_;
   std::unique_ptr<SilentOT> silent_ot_ = nullptr;
   std::unique_ptr<SilentOT> silent_ot_reversed_ = nullptr;
 
   std::array<std::unique_ptr<SilentOTN>, KKOT_TYPES> kkot_;
 
-  SilentOTPack(int party, std::unique_ptr<IO> io);
+  // The ferret OT extension runs the LPN encoding and the GGM trees of
+  // MPCOT by `threads`, the trees of each thread go through its own io.
+  SilentOTPack(int party, std::unique_ptr<IO> io, int threads = 1);
   ~SilentOTPack() = default;
+
+  // The traffic of all ios. The thread ios run in parallel with the first
+  // one, so only the messages received by the first one are counted.
+  CheetahIo::Stats stats() const;
+
+  // Pre-generate random COTs of both directions, e.g. between requests, so
+  // that the following nonlinear protocols skip the OT extension.
+  void prefetch(int64_t num_ot);
 };
 
 }  // namespace spu
@@ -24,6 +24,8 @@
 #include "gtest/gtest.h"
 #include "yacl/link/test_util.h"
 
+#include "spu/crypto/ot/silent/silent_ot_pack.h"
+
 // https://gcc.gnu.org/bugzilla/show_bug.cgi?id=69884
 #if defined __GNUC__ && __GNUC__ >= 6
 #pragma GCC diagnostic ignored "-Wignored-attributes"
@@ -445,6 +447,82 @@ void test_silent(int party, IO *ios[threads], int64_t num_ot) {
   }
 }
 
+void test_prefetch(int party, IO *ios[threads], int64_t num_ot) {
+  auto silent_ot = std::make_unique<SilentOT>(
+      party, threads, ios, false, true,
+      (party == ALICE ? "tmp_silent_ot_pre_alice" : "tmp_silent_ot_pre_bob"));
+  int64_t num = 1LL << num_ot;
+  const char *who = party == ALICE ? "[ALICE]\t" : "[BOB]\t";
+
+  double online = test_ot_rcm_cc(silent_ot.get(), ios, party, num);
+  std::cout << who << "Online COT without prefetch:\t" << online << " us"
+            << std::endl;
+
+  auto start = clock_start();
+  silent_ot->prefetch_rcot(num);
+  ios[0]->flush();
+  std::cout << who << "Prefetch:\t" << time_from(start) << " us" << std::endl;
+  EXPECT_EQ(silent_ot->num_prefetched_rcot(), num);
+
+  // a part of the pool, then all the rest and beyond.
+  online = test_ot_rcm_cc(silent_ot.get(), ios, party, num / 2);
+  std::cout << who << "Online COT with prefetch:\t" << online << " us"
+            << std::endl;
+  EXPECT_EQ(silent_ot->num_prefetched_rcot(), num - num / 2);
+  test_ot_rm_rc(silent_ot.get(), ios, party, num);
+  EXPECT_EQ(silent_ot->num_prefetched_rcot(), 0);
+}
+
+TEST(SilentOTTest, Prefetch) {
+  const int kWorldSize = 2;
+  auto contexts = yacl::link::test::SetupWorld(kWorldSize);
+
+  int length = 16;
+  auto run = [&](int party, const std::shared_ptr<yacl::link::Context> &ctx) {
+    CheetahIo *ios[threads];
+    for (auto &io : ios) {
+      io = new CheetahIo(ctx);
+    }
+    test_prefetch(party, ios, length);
+    for (auto &io : ios) {
+      delete io;
+    }
+  };
+
+  std::future<void> alice = std::async([&] { run(emp::ALICE, contexts[0]); });
+  std::future<void> bob = std::async([&] { run(emp::BOB, contexts[1]); });
+
+  alice.get();
+  bob.get();
+}
+
+// The ferret extension of a pack runs its LPN and MPCOT by threads on
+// spawned links.
+TEST(SilentOTTest, PackThreads) {
+  const int kWorldSize = 2;
+  const int kThreads = 3;
+  auto contexts = yacl::link::test::SetupWorld(kWorldSize);
+
+  int64_t length = 1000;
+  auto run = [&](int party, const std::shared_ptr<yacl::link::Context> &ctx) {
+    SilentOTPack pack(party, std::make_unique<CheetahIo>(ctx), kThreads);
+    EXPECT_EQ(pack.ios_.size(), static_cast<size_t>(kThreads));
+    pack.prefetch(length);
+    EXPECT_EQ(pack.silent_ot_->num_prefetched_rcot(), length);
+    // both directions, silent_ot_ of a party pairs with the one of the other.
+    test_ot_rcm_cc(pack.silent_ot_.get(), pack.ios_.data(), party, length);
+    test_ot_rcm_cc(pack.silent_ot_reversed_.get(), pack.ios_.data(),
+                   3 - party, length);
+    EXPECT_GT(pack.stats().sent_bytes, 0);
+  };
+
+  std::future<void> alice = std::async([&] { run(emp::ALICE, contexts[0]); });
+  std::future<void> bob = std::async([&] { run(emp::BOB, contexts[1]); });
+
+  alice.get();
+  bob.get();
+}
+
 TEST(SilentOTTest, Test) {
   const int kWorldSize = 2;
   auto contexts = yacl::link::test::SetupWorld(kWorldSize);
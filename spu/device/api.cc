@@ -14,18 +14,21 @@
 
 #include "spu/device/api.h"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <optional>
 #include <vector>
 
+#include "absl/numeric/bits.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "mlir/Dialect/Func/IR/FuncOps.h"
-#include "mlir/Parser/Parser.h"
 #include "spdlog/spdlog.h"
 
+#include "spu/core/type_util.h"
 #include "spu/device/pphlo/pphlo_executor.h"
-#include "spu/dialect/pphlo_dialect.h"
+#include "spu/mpc/util/communicator.h"
 
 namespace spu::device {
 namespace {
@@ -84,6 +87,30 @@ struct CommunicationStats {
   }
 };
 
+using KernelCommStats = std::map<std::string, mpc::Communicator::KernelStats>;
+
+KernelCommStats getKernelCommStats(spu::HalContext *hctx) {
+  auto *prot = hctx->prot();
+  if (prot == nullptr || !prot->hasState<mpc::Communicator>()) {
+    return {};
+  }
+  return prot->getState<mpc::Communicator>()->getKernelStats();
+}
+
+// stats of kernels which communicated during [before, after).
+KernelCommStats diffKernelCommStats(const KernelCommStats &after,
+                                    const KernelCommStats &before) {
+  KernelCommStats res;
+  for (const auto &[name, stats] : after) {
+    const auto itr = before.find(name);
+    const auto diff = itr == before.end() ? stats : stats - itr->second;
+    if (diff.send_bytes != 0 || diff.recv_bytes != 0 || diff.latency != 0) {
+      res.emplace(name, diff);
+    }
+  }
+  return res;
+}
+
 struct ActionKey {
   std::string_view name;
   int64_t flag;
@@ -136,7 +163,10 @@ void dumpExecutableToFolder(const ExecutableProto &executable, size_t rank,
 
 void printProfilingData(const std::string &name,
                         const ExecutionStats &exec_stats,
-                        const CommunicationStats &comm_stats) {
+                        const CommunicationStats &comm_stats,
+                        const KernelCommStats &kernel_comm_stats,
+                        const BufferPool *buffer_pool,
+                        const ExecutionProfileProto *op_profile) {
   // print overall information
   SPDLOG_INFO(
       "[Profiling] SPU execution {} completed, input processing took {}s, "
@@ -151,6 +181,10 @@ void printProfilingData(const std::string &name,
 
     const auto &tracer = getTracer(GET_CTX_NAME(hctx_));
     const auto &records = tracer->getRecords();
+    if (tracer->getSampleRate() > 1) {
+      SPDLOG_INFO("Actions are sampled, 1 of every {} is recorded",
+                  tracer->getSampleRate());
+    }
 
     for (const auto &rec : records) {
       auto &stat = stats[{rec.name, rec.flag}];
@@ -160,7 +194,10 @@ void printProfilingData(const std::string &name,
     }
 
     static std::map<int64_t, std::string> kModules = {
-        {TR_HLO, "HLO"}, {TR_HAL, "HAL"}, {TR_MPC, "MPC"}};
+        {TR_HLO, "HLO"},
+        {TR_HAL, "HAL"},
+        {TR_MPC, "MPC"},
+        {TR_COMM, "COMM"}};
 
     for (const auto &[mod_flag, mod_name] : kModules) {
       double total_time = 0.0;
@@ -182,6 +219,44 @@ void printProfilingData(const std::string &name,
   // print link statistics
   SPDLOG_INFO("Link details: total send bytes {}, send actions {}",
               comm_stats.send_bytes, comm_stats.send_actions);
+
+  // print per kernel communication statistics
+  if ((getTracer(GET_CTX_NAME(hctx_))->getMask() & TR_MPC) != 0) {
+    SPDLOG_INFO("MPC communication profiling:");
+    for (const auto &[kernel, stats] : kernel_comm_stats) {
+      SPDLOG_INFO("- {}, send {} bytes, recv {} bytes, latency {}, blocked in "
+                  "recv {}s",
+                  kernel, stats.send_bytes, stats.recv_bytes, stats.latency,
+                  getSeconds(stats.recv_time));
+    }
+  }
+
+  // print buffer pool statistics, accumulated since the context is created.
+  if (buffer_pool != nullptr) {
+    const auto stats = buffer_pool->getStats();
+    SPDLOG_INFO("Buffer pool: hits {}, misses {}, in use {} bytes, peak {} "
+                "bytes, cached {} bytes",
+                stats.hits, stats.misses, stats.bytes_in_use,
+                stats.peak_bytes_in_use, stats.cached_bytes);
+  }
+
+  // print peak memory of arrays, and the ops with the highest peaks.
+  if (op_profile != nullptr) {
+    constexpr size_t kMaxOps = 10;
+    SPDLOG_INFO("Memory profiling: peak {} bytes", op_profile->peak_bytes());
+    std::vector<const OpProfileProto *> ops;
+    for (const auto &op : op_profile->ops()) {
+      ops.push_back(&op);
+    }
+    std::stable_sort(ops.begin(), ops.end(), [](const auto *a, const auto *b) {
+      return a->peak_bytes() > b->peak_bytes();
+    });
+    for (size_t idx = 0; idx < std::min(ops.size(), kMaxOps); idx++) {
+      SPDLOG_INFO("- {} {}, executed {} times, peak {} bytes",
+                  ops[idx]->op_name(), ops[idx]->location(), ops[idx]->count(),
+                  ops[idx]->peak_bytes());
+    }
+  }
 }
 
 void setupTrace(const spu::RuntimeConfig &rt_config) {
@@ -196,11 +271,13 @@ void setupTrace(const spu::RuntimeConfig &rt_config) {
   }
 
   if (rt_config.enable_hal_profile()) {
-    tr_mask |= TR_HAL | TR_MPC;
+    tr_mask |= TR_HAL | TR_MPC | TR_COMM;
     tr_mask |= TR_REC;
   }
 
   getTracer(GET_CTX_NAME(ctx))->setMask(tr_mask);
+  getTracer(GET_CTX_NAME(ctx))->setSampleRate(
+      std::max<uint64_t>(rt_config.trace_sample_rate(), 1));
   getTracer(GET_CTX_NAME(ctx))->clearRecords();
 }
 
@@ -217,20 +294,93 @@ void installLLVMErrorHandler() {
   llvm::install_fatal_error_handler(SPUErrorHandler);
 }
 
+void dumpChromeTrace(const std::string &path, size_t rank) {
+  auto fname = fmt::format("{}.{}.json", path, rank);
+  SPDLOG_INFO("Dump chrome trace to {}", fname);
+  std::ofstream trace_file(fname, std::ios::out | std::ios::trunc);
+  getTracer(GET_CTX_NAME(hctx_))->dumpChromeTrace(trace_file, rank);
+}
+
+void dumpOpProfile(const ExecutionProfileProto &profile,
+                   const std::string &path, size_t rank) {
+  auto fname = fmt::format("{}.{}.pb", path, rank);
+  SPDLOG_INFO("Dump pphlo op profile to {}", fname);
+  std::ofstream out(fname, std::ios::out | std::ios::trunc | std::ios::binary);
+  YACL_ENFORCE(profile.SerializeToOstream(&out), "failed to write {}", fname);
+}
+
 [[maybe_unused]] void removeLLVMErrorHandler() {
   std::lock_guard<std::mutex> guard(ErrorHandlerMutex);
   llvm::remove_fatal_error_handler();
 }
 
+// Bytes held by one party for each element of a value.
+size_t bytesPerElement(Visibility vis, const RuntimeConfig &config) {
+  const size_t ring_bytes = SizeOf(config.field());
+  // aby3 holds two of three replicated shares.
+  if (vis == VIS_SECRET && config.protocol() == ABY3) {
+    return 2 * ring_bytes;
+  }
+  return ring_bytes;
+}
+
+// Fill the pool with blocks for values of the plan, the max number of blocks
+// of each size live at the same time, so the execution hardly hits the system
+// allocator for them. Arguments are allocated already, not counted.
+void reserveBuffers(BufferPool *pool, const MemoryPlanProto &plan,
+                    const RuntimeConfig &config) {
+  std::map<size_t, std::vector<int64_t>> deltas;
+  for (const auto &buf : plan.buffers()) {
+    const size_t bytes =
+        buf.numel() * bytesPerElement(buf.visibility(), config);
+    if (buf.op_index() < 0 || bytes < BufferPool::kMinBlockBytes ||
+        bytes > BufferPool::kMaxBlockBytes) {
+      continue;
+    }
+    auto &delta = deltas[absl::bit_ceil(bytes)];
+    delta.resize(plan.num_steps() + 1, 0);
+    delta[buf.first_step()]++;
+    delta[buf.last_step() + 1]--;
+  }
+
+  for (const auto &[bytes, delta] : deltas) {
+    int64_t live = 0;
+    int64_t peak = 0;
+    for (const auto d : delta) {
+      live += d;
+      peak = std::max(peak, live);
+    }
+    pool->reserve(bytes, peak);
+  }
+}
+
+void applyMemoryPlan(HalContext *hctx, const MemoryPlanProto &plan) {
+  const auto &config = hctx->rt_config();
+  SPDLOG_INFO("Memory plan of {} values, estimated peak {} bytes per party",
+              plan.buffers_size(), estimatePeakMemory(plan, config));
+
+  if (hctx->buffer_pool() != nullptr) {
+    reserveBuffers(hctx->buffer_pool(), plan, config);
+  }
+}
+
 } // namespace
 
+int64_t estimatePeakMemory(const MemoryPlanProto &plan,
+                           const RuntimeConfig &config) {
+  return plan.peak_secret_numel() * bytesPerElement(VIS_SECRET, config) +
+         plan.peak_public_numel() * bytesPerElement(VIS_PUBLIC, config);
+}
+
 void executeImpl(OpExecutor *executor, spu::HalContext *hctx,
-                 const ExecutableProto &executable, SymbolTable *env) {
+                 const ParsedExecutable &parsed, SymbolTable *env) {
+  const ExecutableProto &executable = parsed.executable();
   setupTrace(hctx->rt_config());
   installLLVMErrorHandler();
 
   CommunicationStats comm_stats;
   comm_stats.reset(hctx->lctx());
+  const auto kernel_comm_stats = getKernelCommStats(hctx);
   ExecutionStats exec_stats;
 
   // prepare inputs from environment.
@@ -254,33 +404,42 @@ void executeImpl(OpExecutor *executor, spu::HalContext *hctx,
 
   // execution
   std::vector<spu::Value> outputs;
+  OpProfiler op_profiler;
+  ExecutionOptions opts;
   {
     TimeitGuard timeit(exec_stats.execution_time);
 
-    mlir::MLIRContext mlir_ctx;
-    mlir_ctx.loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
-
-    auto &engine = mlir_ctx.getDiagEngine();
-    engine.registerHandler(
-        [&](mlir::Diagnostic &diag) { SPDLOG_ERROR(diag.str()); });
-
-    mlir_ctx.loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
-    auto moduleOpRef =
-        mlir::parseSourceString<mlir::ModuleOp>(executable.code(), &mlir_ctx);
-
-    YACL_ENFORCE(moduleOpRef, "MLIR parser failure");
-
     SPDLOG_INFO("Executing module {}",
-                moduleOpRef->getName().value_or("Unnamed"));
+                parsed.module().getName().value_or("Unnamed"));
 
-    auto entry_function = moduleOpRef->lookupSymbol<mlir::func::FuncOp>("main");
-    YACL_ENFORCE(entry_function, "main module not found");
+    if (executable.has_memory_plan()) {
+      applyMemoryPlan(hctx, executable.memory_plan());
+    }
 
-    ExecutionOptions opts;
     opts.do_type_check = rt_config.enable_type_checker();
     opts.do_log_execution = rt_config.enable_pphlo_trace();
-    outputs = runRegion(executor, hctx, nullptr, entry_function.getBody(),
-                        inputs, opts);
+    opts.do_parallel = rt_config.experimental_enable_inter_op_par();
+    opts.do_batch_kernels = rt_config.experimental_enable_kernel_batching();
+    opts.schedule_cache = parsed.schedule_cache();
+    opts.type_cache = parsed.type_cache();
+    opts.chunk_rows =
+        static_cast<int64_t>(rt_config.experimental_chunk_rows());
+    if (rt_config.enable_pphlo_profile() ||
+        !rt_config.pphlo_profile_dump_path().empty()) {
+      opts.profiler = &op_profiler;
+    }
+    outputs = runRegion(executor, hctx, nullptr,
+                        parsed.entry_function().getBody(), inputs, opts);
+    executor->finishExecution(hctx);
+  }
+
+  std::optional<ExecutionProfileProto> op_profile;
+  if (opts.profiler != nullptr) {
+    op_profile = op_profiler.toProto(executable.name());
+  }
+  if (op_profile && !rt_config.pphlo_profile_dump_path().empty()) {
+    const size_t rank = hctx->lctx() == nullptr ? 0 : hctx->lctx()->Rank();
+    dumpOpProfile(*op_profile, rt_config.pphlo_profile_dump_path(), rank);
   }
 
   // sync output to environment.
@@ -293,12 +452,27 @@ void executeImpl(OpExecutor *executor, spu::HalContext *hctx,
 
   comm_stats.diff(hctx->lctx());
   if ((getTracer(GET_CTX_NAME(hctx))->getMask() & TR_REC) != 0) {
-    printProfilingData(executable.name(), exec_stats, comm_stats);
+    printProfilingData(
+        executable.name(), exec_stats, comm_stats,
+        diffKernelCommStats(getKernelCommStats(hctx), kernel_comm_stats),
+        hctx->buffer_pool(), op_profile ? &*op_profile : nullptr);
+
+    if (!rt_config.chrome_trace_dump_path().empty()) {
+      const size_t rank = hctx->lctx() == nullptr ? 0 : hctx->lctx()->Rank();
+      dumpChromeTrace(rt_config.chrome_trace_dump_path(), rank);
+    }
   }
 }
 
 void execute(OpExecutor *executor, spu::HalContext *hctx,
              const spu::ExecutableProto &executable, SymbolTable *env) {
+  installLLVMErrorHandler();
+  const ParsedExecutable parsed(executable);
+  return executeImpl(executor, hctx, parsed, env);
+}
+
+void execute(OpExecutor *executor, spu::HalContext *hctx,
+             const ParsedExecutable &executable, SymbolTable *env) {
   return executeImpl(executor, hctx, executable, env);
 }
 
@@ -313,7 +487,7 @@ void execute(OpExecutor *executor, spu::HalContext *hctx,
                                         output_names.end()};
   executable.set_code(text);
 
-  return executeImpl(executor, hctx, executable, env);
+  return execute(executor, hctx, executable, env);
 }
 
 } // namespace spu::device
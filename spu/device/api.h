@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 
+#include "spu/device/executable_cache.h"
 #include "spu/device/executor.h"
 #include "spu/device/symbol_table.h"
 #include "spu/kernel/context.h"
@@ -26,9 +27,19 @@
 
 namespace spu::device {
 
+/// Estimate the peak memory in bytes of one party to hold values planned by
+/// the compiler, temporaries of kernels are not counted.
+int64_t estimatePeakMemory(const MemoryPlanProto &plan,
+                           const RuntimeConfig &config);
+
 void execute(OpExecutor *executor, HalContext *hctx,
              const ExecutableProto &executable, SymbolTable *env);
 
+/// Run an executable parsed already, e.g. one loaded by an ExecutableCache,
+/// without parsing the code again.
+void execute(OpExecutor *executor, HalContext *hctx,
+             const ParsedExecutable &executable, SymbolTable *env);
+
 ///
 void execute(OpExecutor *executor, spu::HalContext *hctx,
              const std::string &text,
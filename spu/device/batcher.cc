@@ -0,0 +1,283 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+#include "yacl/base/buffer.h"
+#include "yacl/base/exception.h"
+
+#include "spu/device/api.h"
+#include "spu/device/pphlo/pphlo_executor.h"
+#include "spu/kernel/hal/concat.h"
+#include "spu/kernel/hal/shape_ops.h"
+
+namespace spu::device {
+namespace {
+
+constexpr char kBatchTag[] = "batcher";
+
+// Rows [start, end) of the first dim.
+spu::Value sliceRows(HalContext *hctx, const spu::Value &in, int64_t start,
+                     int64_t end) {
+  std::vector<int64_t> start_indices(in.shape().size(), 0);
+  std::vector<int64_t> end_indices = in.shape();
+  std::vector<int64_t> strides(in.shape().size(), 1);
+  start_indices[0] = start;
+  end_indices[0] = end;
+  return kernel::hal::slice(hctx, in, start_indices, end_indices, strides);
+}
+
+} // namespace
+
+Batcher::Batcher(RuntimeService *service, RuntimeService::SessionId session,
+                 std::map<size_t, std::string> executables,
+                 std::shared_ptr<yacl::link::Context> lctx,
+                 BatcherOptions options)
+    : service_(service), session_(session),
+      executables_(std::move(executables)), lctx_(std::move(lctx)),
+      options_(options) {
+  YACL_ENFORCE(!executables_.empty(), "no executable to batch");
+  YACL_ENFORCE(executables_.begin()->first > 0, "batch size should be > 0");
+  YACL_ENFORCE(options_.max_batch_size > 0, "max batch size should be > 0");
+
+  const auto first = service_->getExecutable(executables_.begin()->second);
+  YACL_ENFORCE(first != nullptr, "executable {} is not loaded",
+               executables_.begin()->second);
+  for (const auto &[batch_size, key] : executables_) {
+    const auto parsed = service_->getExecutable(key);
+    YACL_ENFORCE(parsed != nullptr, "executable {} is not loaded", key);
+
+    const auto &lhs = first->executable();
+    const auto &rhs = parsed->executable();
+    YACL_ENFORCE(
+        std::equal(lhs.input_names().begin(), lhs.input_names().end(),
+                   rhs.input_names().begin(), rhs.input_names().end()) &&
+            std::equal(lhs.output_names().begin(), lhs.output_names().end(),
+                       rhs.output_names().begin(), rhs.output_names().end()),
+        "executable of batch size {} has different io names", batch_size);
+  }
+
+  num_inputs_ = first->executable().input_names_size();
+  YACL_ENFORCE(num_inputs_ > 0, "executable has no input to batch");
+  max_rows_ = std::min(options_.max_batch_size, executables_.rbegin()->first);
+
+  worker_ = std::thread([this] {
+    if (isLeader()) {
+      leaderLoop();
+    } else {
+      followerLoop();
+    }
+  });
+}
+
+Batcher::~Batcher() {
+  {
+    std::unique_lock lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::future<std::vector<spu::Value>>
+Batcher::submit(uint64_t request_id, std::vector<spu::Value> inputs) {
+  YACL_ENFORCE(inputs.size() == num_inputs_, "expect {} inputs, got {}",
+               num_inputs_, inputs.size());
+
+  const int64_t rows = inputs[0].shape().empty() ? 0 : inputs[0].shape()[0];
+  YACL_ENFORCE(rows > 0 && static_cast<size_t>(rows) <= max_rows_,
+               "rows of a request should be in [1, {}], got {}", max_rows_,
+               rows);
+  for (const auto &input : inputs) {
+    YACL_ENFORCE(!input.shape().empty() && input.shape()[0] == rows,
+                 "inputs should have the same rows {}", rows);
+  }
+
+  Request request;
+  request.inputs = std::move(inputs);
+  request.rows = rows;
+  request.arrival = std::chrono::steady_clock::now();
+  auto future = request.promise.get_future();
+  {
+    std::unique_lock lock(mutex_);
+    YACL_ENFORCE(!stopping_, "batcher is stopping");
+    YACL_ENFORCE(pending_.emplace(request_id, std::move(request)).second,
+                 "request {} is submitted already", request_id);
+    if (isLeader()) {
+      order_.push_back(request_id);
+      queued_rows_ += rows;
+    }
+  }
+  cv_.notify_all();
+  return future;
+}
+
+std::vector<uint64_t> Batcher::takeBatch() {
+  std::vector<uint64_t> ids;
+  size_t rows = 0;
+  while (!order_.empty()) {
+    const size_t next = pending_.at(order_.front()).rows;
+    if (rows + next > max_rows_) {
+      break;
+    }
+    rows += next;
+    ids.push_back(order_.front());
+    order_.pop_front();
+  }
+  queued_rows_ -= rows;
+  return ids;
+}
+
+void Batcher::leaderLoop() {
+  while (true) {
+    std::vector<uint64_t> ids;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || !order_.empty(); });
+      if (order_.empty()) {
+        break;
+      }
+      // wait for more requests, unless the batch is full or due.
+      const auto deadline =
+          pending_.at(order_.front()).arrival + options_.max_latency;
+      cv_.wait_until(lock, deadline,
+                     [&] { return stopping_ || queued_rows_ >= max_rows_; });
+      ids = takeBatch();
+    }
+    sendBatch(ids);
+    runBatch(ids);
+  }
+
+  // an empty batch stops the others.
+  sendBatch({});
+}
+
+void Batcher::followerLoop() {
+  while (true) {
+    const auto ids = recvBatch();
+    if (ids.empty()) {
+      break;
+    }
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [&] {
+        return std::all_of(ids.begin(), ids.end(), [&](uint64_t id) {
+          return pending_.count(id) > 0;
+        });
+      });
+    }
+    runBatch(ids);
+  }
+}
+
+void Batcher::sendBatch(const std::vector<uint64_t> &ids) {
+  for (size_t idx = 0; idx < lctx_->WorldSize(); idx++) {
+    if (idx == lctx_->Rank()) {
+      continue;
+    }
+    yacl::Buffer buf;
+    buf.resize(ids.size() * sizeof(uint64_t));
+    if (!ids.empty()) {
+      std::memcpy(buf.data(), ids.data(), buf.size());
+    }
+    lctx_->SendAsync(idx, std::move(buf), kBatchTag);
+  }
+}
+
+std::vector<uint64_t> Batcher::recvBatch() {
+  auto buf = lctx_->Recv(0, kBatchTag);
+  YACL_ENFORCE(buf.size() % sizeof(uint64_t) == 0);
+
+  std::vector<uint64_t> ids(buf.size() / sizeof(uint64_t));
+  if (!ids.empty()) {
+    std::memcpy(ids.data(), buf.data(), buf.size());
+  }
+  return ids;
+}
+
+void Batcher::runBatch(const std::vector<uint64_t> &ids) {
+  std::vector<Request> batch;
+  {
+    std::unique_lock lock(mutex_);
+    for (const auto id : ids) {
+      auto itr = pending_.find(id);
+      batch.push_back(std::move(itr->second));
+      pending_.erase(itr);
+    }
+  }
+
+  std::vector<std::vector<spu::Value>> results(batch.size());
+  try {
+    int64_t rows = 0;
+    for (const auto &request : batch) {
+      rows += request.rows;
+    }
+    const auto itr = executables_.lower_bound(static_cast<size_t>(rows));
+    YACL_ENFORCE(itr != executables_.end(), "no executable of {} rows", rows);
+    const auto batch_size = static_cast<int64_t>(itr->first);
+    const auto parsed = service_->getExecutable(itr->second);
+    YACL_ENFORCE(parsed != nullptr, "executable {} is not loaded", itr->second);
+
+    auto task = [&](HalContext *hctx, SymbolTable *env) {
+      const auto &exec = parsed->executable();
+
+      for (size_t idx = 0; idx < num_inputs_; idx++) {
+        std::vector<spu::Value> parts;
+        for (const auto &request : batch) {
+          parts.push_back(request.inputs[idx]);
+        }
+        if (rows < batch_size) {
+          // any valid share works as the padding, which is dropped later.
+          const auto pad = sliceRows(hctx, batch.back().inputs[idx], 0, 1);
+          parts.insert(parts.end(), batch_size - rows, pad);
+        }
+        env->setVar(exec.input_names(idx),
+                    kernel::hal::concatenate(hctx, parts, 0));
+      }
+
+      pphlo::PPHloExecutor executor;
+      execute(&executor, hctx, *parsed, env);
+
+      for (const auto &name : exec.output_names()) {
+        const auto out = env->getVar(name);
+        YACL_ENFORCE(!out.shape().empty() && out.shape()[0] == batch_size,
+                     "output {} is not of batch size {}", name, batch_size);
+
+        int64_t start = 0;
+        for (size_t idx = 0; idx < batch.size(); idx++) {
+          const int64_t end = start + batch[idx].rows;
+          results[idx].push_back(sliceRows(hctx, out, start, end));
+          start = end;
+        }
+      }
+    };
+    service_->post(session_, task).get();
+  } catch (...) {
+    for (auto &request : batch) {
+      request.promise.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  for (size_t idx = 0; idx < batch.size(); idx++) {
+    batch[idx].promise.set_value(std::move(results[idx]));
+  }
+}
+
+} // namespace spu::device
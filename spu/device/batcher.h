@@ -0,0 +1,122 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "yacl/link/link.h"
+
+#include "spu/device/runtime_service.h"
+#include "spu/kernel/value.h"
+
+namespace spu::device {
+
+struct BatcherOptions {
+  /// The max number of rows of a batch.
+  size_t max_batch_size = 32;
+
+  /// The max time to wait for a batch to fill since its first request.
+  std::chrono::microseconds max_latency{2000};
+};
+
+/// Run many small requests of an executable as one batch in a session, since
+/// a batch takes the same rounds as a single request.
+///
+/// A request is the inputs of the executable with the rows of a batch, i.e.
+/// the first dim of every input. The inputs of the requests in a batch are
+/// concatenated along the first dim, padded by copies of the first row of the
+/// last request to the batch size of an executable, and the outputs are split
+/// back by the rows of the requests.
+///
+/// Executables are static shaped, so `executables` maps a batch size to the
+/// key of the executable of it loaded in the service, a batch runs the one of
+/// the smallest batch size it fits in. They should have the same io names.
+///
+/// The party of rank 0 of `lctx` decides the requests of a batch, and sends
+/// their ids to the others, which wait for the requests of the same ids to be
+/// submitted to them. So all parties should submit the same requests with
+/// the same ids, and `max_latency` is of rank 0 only.
+///
+/// `lctx` is used by the batcher only, e.g. a link spawned in the same order
+/// by all parties.
+class Batcher {
+  struct Request {
+    std::vector<spu::Value> inputs;
+    int64_t rows;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<std::vector<spu::Value>> promise;
+  };
+
+  RuntimeService *const service_;
+  const RuntimeService::SessionId session_;
+  const std::map<size_t, std::string> executables_;
+  const std::shared_ptr<yacl::link::Context> lctx_;
+  const BatcherOptions options_;
+
+  size_t num_inputs_;
+  size_t max_rows_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unordered_map<uint64_t, Request> pending_;
+  // ids of the pending requests in arrival order, of rank 0 only.
+  std::deque<uint64_t> order_;
+  size_t queued_rows_ = 0;
+  bool stopping_ = false;
+
+  std::thread worker_;
+
+  bool isLeader() const { return lctx_->Rank() == 0; }
+
+  void leaderLoop();
+  void followerLoop();
+
+  // Ids of the next batch, in arrival order.
+  std::vector<uint64_t> takeBatch();
+
+  void sendBatch(const std::vector<uint64_t> &ids);
+  std::vector<uint64_t> recvBatch();
+
+  void runBatch(const std::vector<uint64_t> &ids);
+
+public:
+  explicit Batcher(RuntimeService *service, RuntimeService::SessionId session,
+                   std::map<size_t, std::string> executables,
+                   std::shared_ptr<yacl::link::Context> lctx,
+                   BatcherOptions options = {});
+
+  /// Run the submitted requests, all parties should destroy their batchers.
+  ~Batcher();
+
+  Batcher(const Batcher &) = delete;
+  Batcher &operator=(const Batcher &) = delete;
+
+  /// Submit the inputs of a request, return the future of its outputs.
+  std::future<std::vector<spu::Value>> submit(uint64_t request_id,
+                                              std::vector<spu::Value> inputs);
+};
+
+} // namespace spu::device
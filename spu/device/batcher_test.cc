@@ -0,0 +1,117 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/batcher.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+
+#include "spu/device/io.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::device {
+namespace {
+
+// y = x * x + x, with x of batch_size x 2.
+ExecutableProto makeExecutable(size_t batch_size) {
+  const auto type = fmt::format("tensor<{}x2x!pphlo.sec<i32>>", batch_size);
+
+  ExecutableProto exec;
+  exec.set_name(fmt::format("square_{}", batch_size));
+  exec.add_input_names("x");
+  exec.add_output_names("y");
+  exec.set_code(fmt::format(R"(
+func.func @main(%arg0: {0}) -> ({0}) {{
+  %0 = "pphlo.multiply"(%arg0, %arg0) : ({0}, {0}) -> {0}
+  %1 = "pphlo.add"(%0, %arg0) : ({0}, {0}) -> {0}
+  return %1 : {0}
+}})",
+                            type));
+  return exec;
+}
+
+class BatcherTest
+    : public ::testing::TestWithParam<std::tuple<size_t, ProtocolKind>> {};
+
+TEST_P(BatcherTest, Works) {
+  const size_t kWorldSize = std::get<0>(GetParam());
+  // rows of requests, 9 rows run in at least 3 batches of 4 rows.
+  const std::vector<size_t> kRows = {1, 2, 1, 1, 3, 1};
+
+  RuntimeConfig conf;
+  conf.set_protocol(std::get<1>(GetParam()));
+  conf.set_field(FieldType::FM64);
+  IoClient io(kWorldSize, conf);
+
+  std::vector<xt::xarray<int>> inputs;
+  std::vector<std::vector<spu::Value>> shares;
+  for (size_t idx = 0; idx < kRows.size(); idx++) {
+    xt::xarray<int> x =
+        static_cast<int>(idx) * xt::ones<int>({kRows[idx], size_t{2}});
+    shares.push_back(io.makeShares(x, VIS_SECRET));
+    inputs.push_back(std::move(x));
+  }
+
+  // outputs[request][rank]
+  std::vector<std::vector<spu::Value>> outputs(
+      kRows.size(), std::vector<spu::Value>(kWorldSize));
+  mpc::util::simulate(
+      kWorldSize, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        const size_t rank = lctx->Rank();
+        RuntimeService service(conf, lctx->Spawn());
+        std::map<size_t, std::string> executables;
+        for (size_t batch_size : {2, 4}) {
+          executables[batch_size] =
+              service.loadExecutable(makeExecutable(batch_size));
+        }
+
+        BatcherOptions options;
+        options.max_batch_size = 4;
+        options.max_latency = std::chrono::milliseconds(10);
+        Batcher batcher(&service, service.openSession(), executables,
+                        lctx->Spawn(), options);
+
+        // the followers submit in the reverse order.
+        std::vector<std::future<std::vector<spu::Value>>> futures(
+            kRows.size());
+        for (size_t idx = 0; idx < kRows.size(); idx++) {
+          const size_t req = rank == 0 ? idx : kRows.size() - 1 - idx;
+          futures[req] = batcher.submit(req, {shares[req][rank]});
+        }
+        EXPECT_THROW(batcher.submit(100, {}), yacl::EnforceNotMet);
+
+        for (size_t req = 0; req < kRows.size(); req++) {
+          auto out = futures[req].get();
+          ASSERT_EQ(out.size(), 1U);
+          outputs[req][rank] = out[0];
+        }
+      });
+
+  for (size_t req = 0; req < kRows.size(); req++) {
+    const auto &x = inputs[req];
+    xt::xarray<int> expected = x * x + x;
+    EXPECT_EQ(xt_adapt<int>(io.combineShares(outputs[req])), expected);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BatcherTestInstance, BatcherTest,
+    testing::Values(std::make_tuple(size_t{2}, ProtocolKind::SEMI2K),
+                    std::make_tuple(size_t{3}, ProtocolKind::ABY3)),
+    [](const testing::TestParamInfo<BatcherTest::ParamType> &p) {
+      return fmt::format("{}x{}", std::get<0>(p.param), std::get<1>(p.param));
+    });
+
+} // namespace
+} // namespace spu::device
@@ -0,0 +1,106 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "spu/device/executable_cache.h"
+
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "fmt/format.h"
+#include "mlir/Parser/Parser.h"
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+
+#include "spu/dialect/pphlo_dialect.h"
+
+namespace spu::device {
+
+ParsedExecutable::ParsedExecutable(ExecutableProto executable)
+    : executable_(std::move(executable)),
+      mlir_ctx_(std::make_unique<mlir::MLIRContext>()) {
+  mlir_ctx_->loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
+
+  auto &engine = mlir_ctx_->getDiagEngine();
+  engine.registerHandler(
+      [](mlir::Diagnostic &diag) { SPDLOG_ERROR(diag.str()); });
+
+  // the parser tells MLIR bytecode from text by its magic number.
+  module_ = mlir::parseSourceString<mlir::ModuleOp>(executable_.code(),
+                                                    mlir_ctx_.get());
+  YACL_ENFORCE(module_, "MLIR parser failure");
+
+  entry_function_ = module_->lookupSymbol<mlir::func::FuncOp>("main");
+  YACL_ENFORCE(entry_function_, "main module not found");
+}
+
+std::string ExecutableCache::getKey(std::string_view code) {
+  return fmt::format("{:016x}", absl::Hash<std::string_view>{}(code));
+}
+
+std::string ExecutableCache::load(const ExecutableProto &executable) {
+  auto key = getKey(executable.code());
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto itr = entries_.find(key);
+    if (itr != entries_.end()) {
+      YACL_ENFORCE(itr->second->executable().code() == executable.code(),
+                   "executable {} collides with a loaded one of key {}",
+                   executable.name(), key);
+      return key;
+    }
+  }
+
+  // parse out of the lock, a racing load of the same code keeps the first.
+  auto parsed = std::make_shared<const ParsedExecutable>(executable);
+  SPDLOG_INFO("Loaded executable {} as {}, {} bytes of code",
+              executable.name(), key, executable.code().size());
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.emplace(key, std::move(parsed));
+  return key;
+}
+
+std::shared_ptr<const ParsedExecutable>
+ExecutableCache::get(const std::string &key) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto itr = entries_.find(key);
+  return itr == entries_.end() ? nullptr : itr->second;
+}
+
+std::shared_ptr<const ParsedExecutable>
+ExecutableCache::find(std::string_view code) const {
+  auto parsed = get(getKey(code));
+  if (parsed == nullptr || parsed->executable().code() != code) {
+    return nullptr;
+  }
+  return parsed;
+}
+
+bool ExecutableCache::unload(const std::string &key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.erase(key) != 0;
+}
+
+void ExecutableCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+}
+
+size_t ExecutableCache::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+} // namespace spu::device
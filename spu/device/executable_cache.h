@@ -0,0 +1,97 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+
+#include "spu/device/executor.h"
+
+#include "spu/spu.pb.h"
+
+namespace spu::device {
+
+/// An executable with its code parsed, and the states reused by its runs.
+class ParsedExecutable {
+  ExecutableProto executable_;
+
+  std::unique_ptr<mlir::MLIRContext> mlir_ctx_;
+  mlir::OwningOpRef<mlir::ModuleOp> module_;
+  mlir::func::FuncOp entry_function_;
+
+  mutable BlockScheduleCache schedule_cache_;
+  mutable TypeSignatureCache type_cache_;
+
+public:
+  /// Parse the code of `executable`, throws if it is not a valid module with
+  /// a main function.
+  explicit ParsedExecutable(ExecutableProto executable);
+
+  ParsedExecutable(const ParsedExecutable &) = delete;
+  ParsedExecutable &operator=(const ParsedExecutable &) = delete;
+
+  const ExecutableProto &executable() const { return executable_; }
+
+  mlir::ModuleOp module() const { return *module_; }
+
+  mlir::func::FuncOp entry_function() const { return entry_function_; }
+
+  BlockScheduleCache *schedule_cache() const { return &schedule_cache_; }
+
+  TypeSignatureCache *type_cache() const { return &type_cache_; }
+};
+
+/// Executables parsed once and shared by all their runs, keyed by the hash
+/// of the code. Thread safe.
+///
+/// A serving loop loads an executable once and runs it by the key, instead
+/// of parsing and verifying the module on every run.
+class ExecutableCache {
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<const ParsedExecutable>> entries_;
+
+public:
+  /// The key of an executable of `code`, stable in the process.
+  static std::string getKey(std::string_view code);
+
+  /// Parse `executable` unless the same code is loaded already, and return
+  /// the key of it.
+  std::string load(const ExecutableProto &executable);
+
+  /// The loaded executable of `key`, or null.
+  std::shared_ptr<const ParsedExecutable> get(const std::string &key) const;
+
+  /// The loaded executable of the same code, or null.
+  std::shared_ptr<const ParsedExecutable> find(std::string_view code) const;
+
+  /// Return false if `key` is not loaded. Runs holding the executable keep it
+  /// until they are done.
+  bool unload(const std::string &key);
+
+  void clear();
+
+  size_t size() const;
+};
+
+} // namespace spu::device
@@ -14,21 +14,35 @@
 
 #include "spu/device/executor.h"
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Value.h"
 #include "yacl/base/exception.h"
 
+#include "spu/device/spill.h"
 #include "spu/kernel/context.h"
 #include "spu/kernel/value.h"
 
 namespace spu::device {
 
-const spu::Value &SymbolScope::lookupValue(mlir::Value key) const {
-  auto itr = symbols_.find(key);
+spu::Value SymbolScope::lookupValue(mlir::Value key) const {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto itr = symbols_.find(key);
 
-  if (itr != symbols_.end()) {
-    return itr->second;
+    if (itr != symbols_.end()) {
+      return itr->second;
+    }
   }
 
   if (parent_ != nullptr) {
@@ -41,56 +55,646 @@ const spu::Value &SymbolScope::lookupValue(mlir::Value key) const {
   //            mlirObjectToString(*v.getDefiningOp()));
 }
 
+bool SymbolScope::hasValue(mlir::Value key) const {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (symbols_.count(key) != 0) {
+      return true;
+    }
+  }
+
+  return parent_ != nullptr && parent_->hasValue(key);
+}
+
 void SymbolScope::addValue(mlir::Value key, const spu::Value &val) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   symbols_[key] = val;
 }
 
 void SymbolScope::addValue(mlir::Value key, spu::Value &&val) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   symbols_[key] = std::move(val);
 }
 
+void SymbolScope::removeValue(mlir::Value key) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  symbols_.erase(key);
+}
+
+void SymbolScope::clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  symbols_.clear();
+}
+
+std::vector<std::pair<mlir::Value, spu::Value>>
+SymbolScope::localValues() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return {symbols_.begin(), symbols_.end()};
+}
+
+namespace {
+
+// Max number of concurrent workers used by runBlockParallel.
+//
+// Note: this number must NOT depend on local hardware, since all parties
+// should fork exactly the same number of sub-contexts.
+constexpr size_t kMaxConcurrency = 4;
+
+std::vector<spu::Value> collectResults(SymbolScope *symbols,
+                                       mlir::Block &block) {
+  if (auto *termOp = block.getTerminator()) {
+    // TODO: enforce ReturnLike
+    std::vector<spu::Value> results;
+    results.reserve(termOp->getNumOperands());
+    for (const auto operand : termOp->getOperands()) {
+      results.emplace_back(symbols->lookupValue(operand));
+    }
+    return results;
+  }
+
+  // No terminator
+  YACL_THROW("Should not be here");
+}
+
+// Group ops of a block into levels, where level(op) = 1 + max(level(deps)).
+//
+// Values captured by nested regions are also treated as dependencies.
+std::vector<std::vector<mlir::Operation *>> buildLevels(mlir::Block &block) {
+  llvm::DenseMap<mlir::Operation *, size_t> op_level;
+  std::vector<std::vector<mlir::Operation *>> levels;
+
+  for (auto &op : block.without_terminator()) {
+    size_t level = 0;
+    auto visit_operand = [&](mlir::Value operand) {
+      auto *def = operand.getDefiningOp();
+      if (def == nullptr || def->getBlock() != &block) {
+        // block argument or defined outside of this block.
+        return;
+      }
+      auto itr = op_level.find(def);
+      YACL_ENFORCE(itr != op_level.end());
+      level = std::max(level, itr->second + 1);
+    };
+
+    op.walk([&](mlir::Operation *nested) {
+      for (auto operand : nested->getOperands()) {
+        visit_operand(operand);
+      }
+    });
+
+    op_level[&op] = level;
+    if (levels.size() <= level) {
+      levels.resize(level + 1);
+    }
+    levels[level].push_back(&op);
+  }
+
+  return levels;
+}
+
+// For each step of a schedule, return values of `block` which are no longer
+// used once the step is done, where a step is a group of top level ops
+// executed together and steps are executed in order.
+//
+// A use inside a nested region counts as a use of its top level ancestor op.
+// Values used by the terminator are never released.
+std::vector<std::vector<mlir::Value>>
+computeDeadValues(mlir::Block &block,
+                  absl::Span<const std::vector<mlir::Operation *>> steps) {
+  llvm::DenseMap<mlir::Operation *, size_t> op_step;
+  for (size_t idx = 0; idx < steps.size(); idx++) {
+    for (auto *op : steps[idx]) {
+      op_step[op] = idx;
+    }
+  }
+
+  std::vector<std::vector<mlir::Value>> dead(steps.size());
+  auto visit_value = [&](mlir::Value value, std::optional<size_t> def_step) {
+    std::optional<size_t> last = def_step;
+    for (auto *user : value.getUsers()) {
+      auto *ancestor = block.findAncestorOpInBlock(*user);
+      auto itr = ancestor == nullptr ? op_step.end() : op_step.find(ancestor);
+      if (itr == op_step.end()) {
+        // used by the terminator (or out of this block), keep it.
+        return;
+      }
+      last = std::max(last.value_or(0), itr->second);
+    }
+    if (last.has_value()) {
+      dead[*last].push_back(value);
+    }
+  };
+
+  for (auto arg : block.getArguments()) {
+    visit_value(arg, std::nullopt);
+  }
+  for (auto &op : block.without_terminator()) {
+    const size_t step = op_step.lookup(&op);
+    for (auto result : op.getResults()) {
+      visit_value(result, step);
+    }
+  }
+
+  return dead;
+}
+
+void removeValues(SymbolScope *symbols, absl::Span<const mlir::Value> values) {
+  for (const auto &value : values) {
+    symbols->removeValue(value);
+  }
+}
+
+// The schedule of a block from the cache of the options, or computed into
+// `local` if there is no cache.
+const BlockSchedule &getBlockSchedule(mlir::Block &block, bool by_level,
+                                      const ExecutionOptions &opts,
+                                      std::optional<BlockSchedule> *local) {
+  if (opts.schedule_cache != nullptr) {
+    return opts.schedule_cache->get(block, by_level);
+  }
+  local->emplace(computeBlockSchedule(block, by_level));
+  return **local;
+}
+
+// A run of steps [begin, end) of element-wise ops over `rows` rows.
+struct RowSegment {
+  size_t begin;
+  size_t end;
+  int64_t rows;
+};
+
+// The rows of an op evaluated row by row, i.e. an element-wise op whose
+// operands and result have the same rows, or nullopt if it's not.
+std::optional<int64_t> getParallelRows(mlir::Operation *op) {
+  if (!op->hasTrait<mlir::OpTrait::Elementwise>() ||
+      op->getNumRegions() != 0 || op->getNumResults() != 1) {
+    return std::nullopt;
+  }
+  auto rowsOf = [](mlir::Value value) -> std::optional<int64_t> {
+    auto type = value.getType().dyn_cast<mlir::RankedTensorType>();
+    if (!type || type.getRank() == 0 || !type.hasStaticShape()) {
+      return std::nullopt;
+    }
+    return type.getDimSize(0);
+  };
+  const auto rows = rowsOf(op->getResult(0));
+  for (auto operand : op->getOperands()) {
+    if (!rows || rowsOf(operand) != rows) {
+      return std::nullopt;
+    }
+  }
+  return rows;
+}
+
+// Maximal runs of at least two steps of element-wise ops over the same rows,
+// more than `chunk_rows`.
+std::vector<RowSegment>
+findRowSegments(absl::Span<const std::vector<mlir::Operation *>> steps,
+                int64_t chunk_rows) {
+  std::vector<RowSegment> segments;
+  std::optional<RowSegment> cur;
+  auto flush = [&]() {
+    if (cur && cur->end - cur->begin >= 2 && cur->rows > chunk_rows) {
+      segments.push_back(*cur);
+    }
+    cur.reset();
+  };
+
+  for (size_t idx = 0; idx < steps.size(); idx++) {
+    std::optional<int64_t> rows;
+    for (auto *op : steps[idx]) {
+      const auto op_rows = getParallelRows(op);
+      if (!op_rows || (rows && *rows != *op_rows)) {
+        rows.reset();
+        break;
+      }
+      rows = op_rows;
+    }
+    if (!rows || (cur && cur->rows != *rows)) {
+      flush();
+    }
+    if (rows) {
+      if (!cur) {
+        cur = RowSegment{idx, idx, *rows};
+      }
+      cur->end = idx + 1;
+    }
+  }
+  flush();
+  return segments;
+}
+
+// The end of the run of coalescable steps from `begin` and before `limit`,
+// whose ops only use values defined before the run, so they could be handed
+// to the executor together.
+size_t findCoalescedRun(OpExecutor *executor,
+                        absl::Span<const std::vector<mlir::Operation *>> steps,
+                        size_t begin, size_t limit) {
+  llvm::DenseSet<mlir::Operation *> run;
+  size_t end = begin;
+  for (; end < limit; end++) {
+    auto *op = steps[end].front();
+    if (steps[end].size() != 1 || !executor->isCoalescable(*op) ||
+        llvm::any_of(op->getOperands(), [&](mlir::Value v) {
+          return run.contains(v.getDefiningOp());
+        })) {
+      break;
+    }
+    run.insert(op);
+  }
+  return end;
+}
+
+// A view of rows [begin, end) of `val`.
+spu::Value sliceRows(const spu::Value &val, int64_t begin, int64_t end) {
+  const auto &arr = val.data();
+  auto shape = arr.shape();
+  shape[0] = end - begin;
+  const auto elsize = static_cast<int64_t>(arr.elsize());
+  const int64_t offset = arr.offset() + begin * arr.strides()[0] * elsize;
+  spu::Value res = val;
+  res.data() =
+      NdArrayRef(arr.buf(), arr.eltype(), shape, arr.strides(), offset);
+  return res;
+}
+
+// Copy `part` to rows from `begin` of `full`, which is allocated like `part`
+// with `rows` rows first.
+void assembleRows(const spu::Value &part, int64_t begin, int64_t rows,
+                  spu::Value *full) {
+  if (begin == 0) {
+    auto shape = part.shape();
+    shape[0] = rows;
+    *full = spu::Value(NdArrayRef(part.storage_type(), shape), part.dtype());
+    full->setPendingTruncBits(part.pendingTruncBits());
+  }
+  YACL_ENFORCE(full->storage_type() == part.storage_type() &&
+                   full->pendingTruncBits() == part.pendingTruncBits(),
+               "chunks of a value differ, {} vs {}", full->storage_type(),
+               part.storage_type());
+
+  const auto compact =
+      part.data().isCompact() ? part.data() : part.data().clone();
+  const int64_t row_bytes = full->numel() / rows * full->elsize();
+  std::memcpy(static_cast<std::byte *>(full->data().data()) + begin * row_bytes,
+              compact.data(), compact.numel() * compact.elsize());
+}
+
+// Run the steps of `seg` by chunks of `chunk_rows` rows, so values defined
+// and dropped in the segment are only as large as a chunk. Values used after
+// the segment are assembled from the chunks.
+void runRowSegment(OpExecutor *executor, HalContext *hctx, SymbolScope *symbols,
+                   mlir::Block &block,
+                   absl::Span<const std::vector<mlir::Operation *>> steps,
+                   const RowSegment &seg, const ExecutionOptions &opts) {
+  llvm::DenseSet<mlir::Operation *> seg_ops;
+  for (size_t idx = seg.begin; idx < seg.end; idx++) {
+    seg_ops.insert(steps[idx].begin(), steps[idx].end());
+  }
+
+  std::vector<mlir::Value> inputs;
+  std::vector<mlir::Value> outputs;
+  llvm::DenseSet<mlir::Value> seen;
+  for (size_t idx = seg.begin; idx < seg.end; idx++) {
+    for (auto *op : steps[idx]) {
+      for (auto operand : op->getOperands()) {
+        if (!seg_ops.contains(operand.getDefiningOp()) &&
+            seen.insert(operand).second) {
+          inputs.push_back(operand);
+        }
+      }
+      const auto result = op->getResult(0);
+      const bool used_after =
+          llvm::any_of(result.getUsers(), [&](mlir::Operation *user) {
+            return !seg_ops.contains(block.findAncestorOpInBlock(*user));
+          });
+      if (used_after) {
+        outputs.push_back(result);
+      }
+    }
+  }
+
+  std::vector<spu::Value> in_vals;
+  in_vals.reserve(inputs.size());
+  for (const auto &input : inputs) {
+    in_vals.push_back(symbols->lookupValue(input));
+  }
+
+  std::vector<spu::Value> out_vals(outputs.size());
+  for (int64_t begin = 0; begin < seg.rows; begin += opts.chunk_rows) {
+    const int64_t end = std::min(begin + opts.chunk_rows, seg.rows);
+    // inputs are shadowed by chunks of them.
+    SymbolScope chunk(symbols);
+    for (size_t idx = 0; idx < inputs.size(); idx++) {
+      chunk.addValue(inputs[idx], sliceRows(in_vals[idx], begin, end));
+    }
+
+    for (size_t idx = seg.begin; idx < seg.end; idx++) {
+      if (opts.do_batch_kernels) {
+        executor->runKernels(hctx, &chunk, steps[idx], opts);
+      } else {
+        executor->runKernel(hctx, &chunk, *steps[idx].front(), opts);
+      }
+    }
+
+    for (size_t idx = 0; idx < outputs.size(); idx++) {
+      assembleRows(chunk.lookupValue(outputs[idx]), begin, seg.rows,
+                   &out_vals[idx]);
+    }
+  }
+
+  for (size_t idx = 0; idx < outputs.size(); idx++) {
+    symbols->addValue(outputs[idx], std::move(out_vals[idx]));
+  }
+}
+
+// Keeps the live arrays of a party under `experimental_spill_memory_cap` in a
+// run of a block, by spilling local values used last by later steps first.
+// Values shared with others, e.g. arguments, are skipped since spilling them
+// frees nothing.
+class BlockSpiller {
+  MemoryTracker *tracker_ = nullptr;
+  uint64_t cap_ = 0;
+  std::string dir_;
+  SymbolScope *symbols_;
+  mlir::Block &block_;
+  const size_t num_steps_;
+  llvm::DenseMap<mlir::Operation *, size_t> op_step_;
+  llvm::DenseSet<mlir::Value> spilled_;
+
+  // The first step after `step` which uses `value`, the terminator uses it
+  // after all steps.
+  size_t nextUse(mlir::Value value, size_t step) const {
+    size_t next = num_steps_;
+    for (auto *user : value.getUsers()) {
+      auto *ancestor = block_.findAncestorOpInBlock(*user);
+      auto itr = ancestor == nullptr ? op_step_.end() : op_step_.find(ancestor);
+      if (itr != op_step_.end() && itr->second > step) {
+        next = std::min(next, itr->second);
+      }
+    }
+    return next;
+  }
+
+public:
+  BlockSpiller(HalContext *hctx, SymbolScope *symbols, mlir::Block &block,
+               const BlockSchedule &schedule)
+      : symbols_(symbols), block_(block), num_steps_(schedule.steps.size()) {
+    const auto &config = hctx->rt_config();
+    if (config.experimental_spill_memory_cap() == 0 ||
+        hctx->memory_tracker() == nullptr) {
+      return;
+    }
+    tracker_ = hctx->memory_tracker();
+    cap_ = config.experimental_spill_memory_cap();
+    dir_ = config.experimental_spill_dir().empty()
+               ? std::filesystem::temp_directory_path().string()
+               : config.experimental_spill_dir();
+    for (size_t idx = 0; idx < num_steps_; idx++) {
+      for (auto *op : schedule.steps[idx]) {
+        op_step_[op] = idx;
+      }
+    }
+  }
+
+  // Spill values once `step` is done, until the live bytes are under the cap.
+  void spill(size_t step) {
+    if (tracker_ == nullptr || tracker_->getStats().live_bytes <= cap_) {
+      return;
+    }
+
+    struct Candidate {
+      size_t next_use;
+      mlir::Value key;
+      spu::Value val;
+    };
+    std::vector<Candidate> candidates;
+    for (auto &[key, val] : symbols_->localValues()) {
+      const auto buf = val.data().buf();
+      // held by the scope, the copy and `buf` only.
+      if (spilled_.contains(key) || buf == nullptr ||
+          buf->size() < static_cast<int64_t>(kMinSpillBytes) ||
+          buf.use_count() > 3) {
+        continue;
+      }
+      candidates.push_back({nextUse(key, step), key, std::move(val)});
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const auto &lhs, const auto &rhs) {
+                       return lhs.next_use > rhs.next_use;
+                     });
+
+    for (auto &cand : candidates) {
+      if (tracker_->getStats().live_bytes <= cap_) {
+        break;
+      }
+      auto spilled = spillValue(cand.val, dir_);
+      cand.val = spu::Value();
+      symbols_->addValue(cand.key, std::move(spilled));
+      spilled_.insert(cand.key);
+    }
+  }
+};
+
+} // namespace
+
+BlockSchedule computeBlockSchedule(mlir::Block &block, bool by_level) {
+  BlockSchedule schedule;
+  if (by_level) {
+    schedule.steps = buildLevels(block);
+  } else {
+    for (auto &op : block.without_terminator()) {
+      schedule.steps.push_back({&op});
+    }
+  }
+  schedule.dead_values = computeDeadValues(block, schedule.steps);
+  return schedule;
+}
+
+const BlockSchedule &BlockScheduleCache::get(mlir::Block &block,
+                                             bool by_level) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &schedule = schedules_[{&block, by_level}];
+  if (schedule == nullptr) {
+    schedule =
+        std::make_unique<BlockSchedule>(computeBlockSchedule(block, by_level));
+  }
+  return *schedule;
+}
+
+const TypeSignature &TypeSignatureCache::get(
+    mlir::Value value, TypeSignature (*compute)(mlir::Type)) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto itr = signatures_.find(value);
+    if (itr != signatures_.end()) {
+      return *itr->second;
+    }
+  }
+  auto signature = std::make_unique<TypeSignature>(compute(value.getType()));
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto &entry = signatures_[value];
+  if (entry == nullptr) {
+    entry = std::move(signature);
+  }
+  return *entry;
+}
+
+void OpProfiler::record(mlir::Operation &op, uint64_t time_ns,
+                        uint64_t send_bytes, uint64_t send_actions,
+                        uint64_t peak_bytes) {
+  std::string location;
+  llvm::raw_string_ostream os(location);
+  op.getLoc().print(os);
+  os.flush();
+  std::string op_name = op.getName().getStringRef().str();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &proto = ops_[{location, op_name}];
+  if (proto.count() == 0) {
+    proto.set_location(location);
+    proto.set_op_name(op_name);
+  }
+  proto.set_count(proto.count() + 1);
+  proto.set_time_ns(proto.time_ns() + time_ns);
+  proto.set_send_bytes(proto.send_bytes() + send_bytes);
+  proto.set_send_actions(proto.send_actions() + send_actions);
+  proto.set_peak_bytes(std::max(proto.peak_bytes(), peak_bytes));
+}
+
+ExecutionProfileProto OpProfiler::toProto(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ExecutionProfileProto profile;
+  profile.set_name(name);
+  for (const auto &[key, proto] : ops_) {
+    *profile.add_ops() = proto;
+    profile.set_peak_bytes(std::max(profile.peak_bytes(), proto.peak_bytes()));
+  }
+  return profile;
+}
+
 std::vector<spu::Value> runRegion(OpExecutor *executor,                //
                                   HalContext *hctx,                    //
                                   SymbolScope *parent_scope,           //
                                   mlir::Region &region,                //
                                   absl::Span<spu::Value const> params, //
                                   const ExecutionOptions &opts) {
+  // create a new scope for this region.
+  SymbolScope sscope(parent_scope);
+  return runRegionInScope(executor, hctx, &sscope, region, params, opts);
+}
+
+namespace {
+
+// Run a region of parameters bound to `sscope`.
+std::vector<spu::Value> runBoundRegion(OpExecutor *executor, HalContext *hctx,
+                                       SymbolScope *sscope,
+                                       mlir::Region &region,
+                                       const ExecutionOptions &opts) {
+  // allocate buffers from the context's pool (if any) in this thread, and
+  // count them by its tracker (if any).
+  BufferPool::Scope pool_scope(hctx->buffer_pool());
+  MemoryTracker::Scope tracker_scope(hctx->memory_tracker());
+
+  YACL_ENFORCE(region.hasOneBlock());
+  if (opts.do_parallel) {
+    return runBlockParallel(executor, hctx, sscope, region.front(), {}, opts);
+  }
+  return runBlock(executor, hctx, sscope, region.front(), {}, opts);
+}
+
+} // namespace
+
+std::vector<spu::Value> runRegionInScope(OpExecutor *executor, HalContext *hctx,
+                                         SymbolScope *sscope,
+                                         mlir::Region &region,
+                                         absl::Span<spu::Value const> params,
+                                         const ExecutionOptions &opts) {
   YACL_ENFORCE(region.getNumArguments() == params.size(),
                "region requires {} arguments while got number of params {}",
                region.getRegionNumber(), params.size());
 
-  // create a new scope for this region.
-  SymbolScope sscope(parent_scope);
+  sscope->clear();
 
   // inject the parameters to region's symbol table.
   for (const auto &blkarg : region.getArguments()) {
-    sscope.addValue(blkarg, params[blkarg.getArgNumber()]);
+    sscope->addValue(blkarg, params[blkarg.getArgNumber()]);
   }
 
-  YACL_ENFORCE(region.hasOneBlock());
-  return runBlock(executor, hctx, &sscope, region.front(), params, opts);
+  return runBoundRegion(executor, hctx, sscope, region, opts);
+}
+
+std::vector<spu::Value> runRegionInScope(OpExecutor *executor, HalContext *hctx,
+                                         SymbolScope *sscope,
+                                         mlir::Region &region,
+                                         std::vector<spu::Value> &&params,
+                                         const ExecutionOptions &opts) {
+  YACL_ENFORCE(region.getNumArguments() == params.size(),
+               "region requires {} arguments while got number of params {}",
+               region.getRegionNumber(), params.size());
+
+  sscope->clear();
+
+  for (const auto &blkarg : region.getArguments()) {
+    sscope->addValue(blkarg, std::move(params[blkarg.getArgNumber()]));
+  }
+  params.clear();
+
+  return runBoundRegion(executor, hctx, sscope, region, opts);
 }
 
 std::vector<spu::Value> runBlock(OpExecutor *executor, HalContext *hctx,
                                  SymbolScope *symbols, mlir::Block &block,
                                  absl::Span<spu::Value const> params,
                                  const ExecutionOptions &opts) {
-  for (auto &op : block.without_terminator()) {
-    executor->runKernel(hctx, symbols, op);
+  std::optional<BlockSchedule> local;
+  const auto &schedule =
+      getBlockSchedule(block, opts.do_batch_kernels, opts, &local);
+  const auto &steps = schedule.steps;
+  const auto &dead_values = schedule.dead_values;
+  BlockSpiller spiller(hctx, symbols, block, schedule);
+
+  std::vector<RowSegment> segments;
+  if (opts.chunk_rows > 0) {
+    segments = findRowSegments(steps, opts.chunk_rows);
   }
+  auto next_seg = segments.begin();
 
-  if (auto *termOp = block.getTerminator()) {
-    // TODO: enforce ReturnLike
-    std::vector<spu::Value> results;
-    results.reserve(termOp->getNumOperands());
-    for (const auto operand : termOp->getOperands()) {
-      results.emplace_back(symbols->lookupValue(operand));
+  for (size_t idx = 0; idx < steps.size(); idx++) {
+    if (next_seg != segments.end() && next_seg->begin == idx) {
+      runRowSegment(executor, hctx, symbols, block, steps, *next_seg, opts);
+      for (size_t step = idx; step < next_seg->end; step++) {
+        removeValues(symbols, dead_values[step]);
+      }
+      idx = next_seg->end - 1;
+      spiller.spill(idx);
+      ++next_seg;
+      continue;
     }
-    return results;
+    if (opts.do_batch_kernels) {
+      executor->runKernels(hctx, symbols, steps[idx], opts);
+    } else if (const size_t end = findCoalescedRun(
+                   executor, steps, idx,
+                   next_seg != segments.end() ? next_seg->begin
+                                              : steps.size());
+               end > idx + 1) {
+      std::vector<mlir::Operation *> ops;
+      for (size_t step = idx; step < end; step++) {
+        ops.push_back(steps[step].front());
+      }
+      executor->runKernels(hctx, symbols, ops, opts);
+      for (size_t step = idx; step + 1 < end; step++) {
+        removeValues(symbols, dead_values[step]);
+      }
+      idx = end - 1;
+    } else {
+      executor->runKernel(hctx, symbols, *steps[idx].front(), opts);
+    }
+    removeValues(symbols, dead_values[idx]);
+    spiller.spill(idx);
   }
 
-  // No terminator
-  YACL_THROW("Should not be here");
+  return collectResults(symbols, block);
 }
 
 std::vector<spu::Value> runBlockParallel(OpExecutor *executor, HalContext *hctx,
@@ -98,7 +702,94 @@ std::vector<spu::Value> runBlockParallel(OpExecutor *executor, HalContext *hctx,
                                          mlir::Block &block,
                                          absl::Span<spu::Value const> params,
                                          const ExecutionOptions &opts) {
-  YACL_THROW("TODO");
+  std::optional<BlockSchedule> local;
+  const auto &schedule = getBlockSchedule(block, true, opts, &local);
+  const auto &levels = schedule.steps;
+
+  size_t max_width = 0;
+  for (const auto &level : levels) {
+    max_width = std::max(max_width, level.size());
+  }
+
+  // worker 0 is the caller's context, others are forked from it. Forking is
+  // done in the same order on all parties.
+  const size_t num_workers = std::min(max_width, kMaxConcurrency);
+  std::vector<std::unique_ptr<HalContext>> forks;
+  for (size_t idx = 1; idx < num_workers; idx++) {
+    forks.emplace_back(hctx->fork());
+  }
+  auto get_worker_ctx = [&](size_t widx) {
+    return widx == 0 ? hctx : forks[widx - 1].get();
+  };
+
+  const auto &tracer = getTracer(GET_CTX_NAME(hctx));
+  const auto &dead_values = schedule.dead_values;
+  BlockSpiller spiller(hctx, symbols, block, schedule);
+  for (size_t lidx = 0; lidx < levels.size(); lidx++) {
+    const auto &level = levels[lidx];
+    if (level.size() == 1) {
+      executor->runKernel(hctx, symbols, *level.front(), opts);
+      removeValues(symbols, dead_values[lidx]);
+      spiller.spill(lidx);
+      continue;
+    }
+
+    // TraceAction saves and restores tracer mask, which may interleave
+    // between workers, restore it once the level is done.
+    const int64_t saved_mask = tracer->getMask();
+
+    const size_t num_active = std::min(level.size(), num_workers);
+    auto run_worker = [&](size_t widx) {
+      auto *wctx = get_worker_ctx(widx);
+      BufferPool::Scope pool_scope(wctx->buffer_pool());
+      MemoryTracker::Scope tracker_scope(wctx->memory_tracker());
+      std::vector<mlir::Operation *> ops;
+      for (size_t idx = widx; idx < level.size(); idx += num_active) {
+        ops.push_back(level[idx]);
+      }
+      if (opts.do_batch_kernels) {
+        executor->runKernels(wctx, symbols, ops, opts);
+      } else {
+        for (auto *op : ops) {
+          executor->runKernel(wctx, symbols, *op, opts);
+        }
+      }
+    };
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_active - 1);
+    for (size_t widx = 1; widx < num_active; widx++) {
+      futures.emplace_back(std::async(std::launch::async, run_worker, widx));
+    }
+
+    // run worker 0 in current thread, always join all workers before
+    // propagating any error.
+    std::exception_ptr error;
+    try {
+      run_worker(0);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    for (auto &future : futures) {
+      try {
+        future.get();
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+
+    tracer->setMask(saved_mask);
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    removeValues(symbols, dead_values[lidx]);
+    spiller.spill(lidx);
+  }
+
+  return collectResults(symbols, block);
 }
 
 } // namespace spu::device
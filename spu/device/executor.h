@@ -15,6 +15,13 @@
 #pragma once
 
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "llvm/ADT/DenseMap.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -23,6 +30,8 @@
 #include "spu/kernel/context.h"
 #include "spu/kernel/value.h"
 
+#include "spu/spu.pb.h"
+
 namespace spu::device {
 
 //
@@ -31,25 +40,121 @@ class SymbolScope final {
   SymbolScope *parent_;
 
   // Local symbols inside this value.
-  // TODO: thread safety for parallel execution.
   llvm::DenseMap<mlir::Value, spu::Value> symbols_;
 
+  // Guards symbols_, ops from the same block may be evaluated concurrently
+  // when parallel execution is enabled.
+  mutable std::shared_mutex mutex_;
+
 public:
   explicit SymbolScope(SymbolScope *parent = nullptr) : parent_(parent) {}
 
   // return true if this is the root scope.
   bool isRoot() const { return parent_ == nullptr; }
 
-  //
-  const spu::Value &lookupValue(mlir::Value key) const;
+  // Note: the value is returned by copy, since a concurrent insertion may
+  // rehash the underline map and invalidate references.
+  spu::Value lookupValue(mlir::Value key) const;
+  bool hasValue(mlir::Value key) const;
   void addValue(::mlir::Value key, const spu::Value &val);
   void addValue(::mlir::Value key, spu::Value &&val);
+
+  // Drop a local value once it's no longer used, so its buffers are released
+  // before the region ends.
+  void removeValue(::mlir::Value key);
+
+  // Drop all local values, the allocated buckets are kept for reuse.
+  void clear();
+
+  // Return copies of all local values.
+  std::vector<std::pair<mlir::Value, spu::Value>> localValues() const;
+};
+
+// The order to run the top level ops of a block and the values released after
+// each step. It only depends on the program, so it could be computed once for
+// all runs of a parsed module.
+struct BlockSchedule {
+  // groups of top level ops executed together, steps are executed in order.
+  std::vector<std::vector<mlir::Operation *>> steps;
+  // values no longer used once each step is done.
+  std::vector<std::vector<mlir::Value>> dead_values;
+};
+
+// Compute the schedule of a block, with one op per step in program order, or
+// with one level of the def-use DAG per step if `by_level`.
+BlockSchedule computeBlockSchedule(mlir::Block &block, bool by_level);
+
+// Schedules of the blocks of a module, computed on first use. Thread safe.
+class BlockScheduleCache {
+  std::mutex mutex_;
+  std::map<std::pair<mlir::Block *, bool>, std::unique_ptr<BlockSchedule>>
+      schedules_;
+
+public:
+  // The returned schedule lives as long as the cache.
+  const BlockSchedule &get(mlir::Block &block, bool by_level);
+};
+
+// The static type of a value of a module, see
+// `ExecutionOptions.do_type_check`.
+struct TypeSignature {
+  std::vector<int64_t> shape;
+  DataType dtype = DT_INVALID;
+  // VIS_INVALID if the type has no visibility.
+  Visibility vis = VIS_INVALID;
+};
+
+// Type signatures of the values of a module, computed on first check, so
+// runs of a cached module only compare them. Thread safe.
+class TypeSignatureCache {
+  std::shared_mutex mutex_;
+  llvm::DenseMap<mlir::Value, std::unique_ptr<TypeSignature>> signatures_;
+
+public:
+  // The returned signature lives as long as the cache.
+  const TypeSignature &get(mlir::Value value,
+                           TypeSignature (*compute)(mlir::Type));
+};
+
+// Time, communication and peak memory of ops recorded by their source
+// locations, see `RuntimeConfig.pphlo_profile_dump_path`. Thread safe.
+class OpProfiler {
+  std::mutex mutex_;
+  // by printed location then op name, ordered so dumps are stable.
+  std::map<std::pair<std::string, std::string>, OpProfileProto> ops_;
+
+public:
+  // Record one run of `op`, which took `time_ns`, sent the given bytes and
+  // messages, and had at most `peak_bytes` of arrays alive.
+  void record(mlir::Operation &op, uint64_t time_ns, uint64_t send_bytes,
+              uint64_t send_actions, uint64_t peak_bytes);
+
+  ExecutionProfileProto toProto(const std::string &name);
 };
 
 // This class encapsulate execution states used during the evaluation.
 struct ExecutionOptions {
   bool do_type_check = false;
   bool do_log_execution = false;
+  // When enabled, independent ops of the top level block are dispatched
+  // concurrently, see `runBlockParallel`.
+  bool do_parallel = false;
+  // When enabled, independent ops of the top level block are handed to the
+  // executor level by level, so it could pack same-kind kernels into one
+  // call (and one communication round), see `OpExecutor::runKernelsImpl`.
+  bool do_batch_kernels = false;
+  // Optional, reuse the schedules of the blocks across runs of a module, or
+  // they are computed on every run.
+  BlockScheduleCache *schedule_cache = nullptr;
+  // Optional, reuse the type signatures of values across runs of a module
+  // when checking types, or they are computed on every check.
+  TypeSignatureCache *type_cache = nullptr;
+  // Optional, record the cost of every top level op run by the executor.
+  OpProfiler *profiler = nullptr;
+  // When positive, runs of element-wise ops of a block over more rows are
+  // evaluated by chunks of rows, see `RuntimeConfig.experimental_chunk_rows`.
+  // Only applies to blocks run sequentially.
+  int64_t chunk_rows = 0;
 };
 
 class OpExecutor {
@@ -67,10 +172,35 @@ public:
                              mlir::Operation &op,
                              const ExecutionOptions &opts) = 0;
 
+  // run a list of mutually independent ops in a given region, executor may
+  // fuse them into fewer kernel calls. Default runs them one by one.
+  virtual void runKernelsImpl(HalContext *hctx, SymbolScope *sscope,
+                              absl::Span<mlir::Operation *const> ops,
+                              const ExecutionOptions &opts) {
+    for (auto *op : ops) {
+      runKernelImpl(hctx, sscope, *op, opts);
+    }
+  }
+
+  // Whether consecutive independent runs of `op` are handed to
+  // runKernelsImpl together even if kernels are not batched by level, e.g.
+  // reveals which could be opened in one round.
+  virtual bool isCoalescable(mlir::Operation &op) const { return false; }
+
+  // called once the entry region of an execution returns, before its module
+  // is released, e.g. to wait for deferred work on ops of the module.
+  virtual void finishExecution(HalContext *hctx) {}
+
   void runKernel(HalContext *hctx, SymbolScope *sscope, mlir::Operation &op,
                  const ExecutionOptions &opts = {}) {
     return runKernelImpl(hctx, sscope, op, opts);
   }
+
+  void runKernels(HalContext *hctx, SymbolScope *sscope,
+                  absl::Span<mlir::Operation *const> ops,
+                  const ExecutionOptions &opts = {}) {
+    return runKernelsImpl(hctx, sscope, ops, opts);
+  }
 };
 
 std::vector<spu::Value> runRegion(OpExecutor *executor, HalContext *hctx,
@@ -79,11 +209,38 @@ std::vector<spu::Value> runRegion(OpExecutor *executor, HalContext *hctx,
                                   absl::Span<spu::Value const> params,
                                   const ExecutionOptions &opts = {});
 
+// Run a region in `sscope`, which is cleared first. Callers running a region
+// many times, e.g. loop bodies, could reuse one scope across runs.
+std::vector<spu::Value> runRegionInScope(OpExecutor *executor, HalContext *hctx,
+                                         SymbolScope *sscope,
+                                         mlir::Region &region,
+                                         absl::Span<spu::Value const> params,
+                                         const ExecutionOptions &opts = {});
+
+// Same as above, the params are moved into `sscope`, so a buffer no longer
+// held by the caller is only held by the scope, and could be updated in place,
+// see `DynamicUpdateSlice`.
+std::vector<spu::Value> runRegionInScope(OpExecutor *executor, HalContext *hctx,
+                                         SymbolScope *sscope,
+                                         mlir::Region &region,
+                                         std::vector<spu::Value> &&params,
+                                         const ExecutionOptions &opts = {});
+
+// Run the ops of a block in program order.
+//
+// Values defined in the block (and block arguments) are removed from the
+// scope right after their last use, values used by the terminator are kept.
 std::vector<spu::Value> runBlock(OpExecutor *executor, HalContext *hctx,
                                  SymbolScope *symbols, mlir::Block &block,
                                  absl::Span<spu::Value const> params,
                                  const ExecutionOptions &opts);
 
+// Run a block with inter-op parallelism.
+//
+// Ops are grouped into levels of the block's def-use DAG, all ops of a level
+// are independent and spread over a fixed number of forked hal contexts (each
+// one owns a spawned link and protocol state). The schedule only depends on
+// the program, so all parties issue the same ops on the same sub-links.
 std::vector<spu::Value> runBlockParallel(OpExecutor *executor, HalContext *hctx,
                                          SymbolScope *symbols,
                                          mlir::Block &block,
@@ -14,7 +14,14 @@
 
 #include "spu/device/io.h"
 
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+
 #include "spu/core/encoding.h"
+#include "spu/core/shape_util.h"
 #include "spu/kernel/hal/constants.h"
 #include "spu/mpc/factory.h"
 
@@ -49,8 +56,7 @@ std::vector<spu::Value> IoClient::makeShares(PtBufferView bv, Visibility vtype,
 
   // encode to ring.
   DataType dtype;
-  NdArrayRef encoded =
-      encodeToRing(xt_to_ndarray(bv), config_.field(), fxp_bits, &dtype);
+  NdArrayRef encoded = encodeToRing(bv, config_.field(), fxp_bits, &dtype);
 
   // make shares.
   std::vector<NdArrayRef> shares;
@@ -99,6 +105,133 @@ NdArrayRef IoClient::combineShares(absl::Span<spu::Value const> values) {
   return decodeFromRing(encoded, dtype, fxp_bits);
 }
 
+std::vector<NdArrayRef> IoClient::batchCombineShares(
+    absl::Span<std::vector<spu::Value> const> values) {
+  // FIXME(jint), this should be in the io context.
+  const size_t fxp_bits = getDefaultFxpBits(config_);
+  YACL_ENFORCE(fxp_bits != 0, "fxp should never be zero, please check default");
+
+  // indices of the values by (storage type, dtype), ordered to be stable.
+  std::map<std::pair<std::string, DataType>, std::vector<size_t>> groups;
+  for (size_t idx = 0; idx < values.size(); idx++) {
+    YACL_ENFORCE(values[idx].size() == world_size_,
+                 "wrong number of shares, got={}, expect={}",
+                 values[idx].size(), world_size_);
+    const auto &share = values[idx].front();
+    groups[{share.storage_type().toString(), share.dtype()}].push_back(idx);
+  }
+
+  std::vector<NdArrayRef> results(values.size());
+  for (const auto &[key, indices] : groups) {
+    // pack the shares of each party.
+    std::vector<ArrayRef> flat_shares;
+    SimdTrait<ArrayRef>::PackInfo pi;
+    for (size_t rank = 0; rank < world_size_; rank++) {
+      std::vector<ArrayRef> pieces;
+      pieces.reserve(indices.size());
+      for (size_t idx : indices) {
+        pieces.push_back(flatten(values[idx][rank].data()));
+      }
+      pi.clear();
+      flat_shares.push_back(
+          SimdTrait<ArrayRef>::pack(pieces.begin(), pieces.end(), pi));
+    }
+
+    ArrayRef flat_encoded = base_io_->fromShares(flat_shares);
+    const int64_t numel = flat_encoded.numel();
+    auto decoded =
+        decodeFromRing(unflatten(flat_encoded, {numel}), key.second, fxp_bits);
+
+    std::vector<ArrayRef> unpacked;
+    unpacked.reserve(indices.size());
+    SimdTrait<ArrayRef>::unpack(flatten(decoded), std::back_inserter(unpacked),
+                                pi);
+    for (size_t i = 0; i < indices.size(); i++) {
+      const size_t idx = indices[i];
+      results[idx] = unflatten(unpacked[i], values[idx].front().shape());
+    }
+  }
+  return results;
+}
+
+bool IoClient::hasSeededShareSupport(PtType pt_type) const {
+  // keep the booleans of bit secrets to makeBitSecret.
+  if (pt_type == PT_BOOL && base_io_->hasBitSecretSupport()) {
+    return false;
+  }
+  return base_io_->hasSeededSecretSupport();
+}
+
+std::vector<SeededShareProto> IoClient::makeSeededShares(PtBufferView bv,
+                                                         size_t owner_rank) {
+  YACL_ENFORCE(hasSeededShareSupport(bv.pt_type),
+               "protocol {} has no seeded shares of {}",
+               ProtocolKind_Name(config_.protocol()), bv.pt_type);
+  YACL_ENFORCE(owner_rank < world_size_, "invalid owner {}", owner_rank);
+
+  // FIXME(jint), this should be in the io context.
+  const size_t fxp_bits = getDefaultFxpBits(config_);
+  YACL_ENFORCE(fxp_bits != 0, "fxp should never be zero, please check default");
+
+  DataType dtype;
+  NdArrayRef encoded = encodeToRing(bv, config_.field(), fxp_bits, &dtype);
+
+  auto seeded = base_io_->makeSeededSecret(flatten(encoded), owner_rank);
+  YACL_ENFORCE(seeded.size() == world_size_);
+
+  // the meta is of the owner's share, which has the same type as the others.
+  const auto owner_share =
+      base_io_->expandSeededShare(seeded[owner_rank], encoded.numel(),
+                                  owner_rank, owner_rank);
+  const auto meta =
+      spu::Value(unflatten(owner_share, encoded.shape()), dtype).toMetaProto();
+
+  std::vector<SeededShareProto> protos(world_size_);
+  for (size_t rank = 0; rank < world_size_; rank++) {
+    auto &proto = protos[rank];
+    *proto.mutable_meta() = meta;
+    proto.set_owner_rank(owner_rank);
+    const auto &plain = seeded[rank].plain;
+    if (plain.numel() > 0) {
+      YACL_ENFORCE(plain.isCompact());
+      proto.set_plain(plain.data(), plain.numel() * plain.elsize());
+    }
+    for (const auto &seed : seeded[rank].seeds) {
+      proto.add_seeds(&seed, sizeof(seed));
+    }
+  }
+  return protos;
+}
+
+spu::Value IoClient::expandSeededShare(const SeededShareProto &proto,
+                                       size_t rank) {
+  const auto &meta = proto.meta();
+  std::vector<int64_t> shape(meta.shape().dims().begin(),
+                             meta.shape().dims().end());
+  const int64_t numel = calcNumel(shape);
+
+  mpc::SeededShare share;
+  if (!proto.plain().empty()) {
+    share.plain = ArrayRef(makeType<RingTy>(config_.field()), numel);
+    YACL_ENFORCE(static_cast<size_t>(share.plain.buf()->size()) ==
+                     proto.plain().size(),
+                 "plain of {} bytes, expect {}", proto.plain().size(),
+                 share.plain.buf()->size());
+    std::memcpy(share.plain.data(), proto.plain().data(),
+                proto.plain().size());
+  }
+  for (const auto &seed : proto.seeds()) {
+    YACL_ENFORCE(seed.size() == sizeof(uint128_t), "invalid seed");
+    std::memcpy(&share.seeds.emplace_back(), seed.data(), sizeof(uint128_t));
+  }
+
+  auto arr =
+      base_io_->expandSeededShare(share, numel, rank, proto.owner_rank());
+  YACL_ENFORCE(arr.eltype().toString() == meta.storage_type(),
+               "expect share of {}, got {}", meta.storage_type(), arr.eltype());
+  return spu::Value(unflatten(arr, shape), meta.data_type());
+}
+
 ColocatedIo::ColocatedIo(HalContext *hctx) : hctx_(hctx) {}
 
 void ColocatedIo::hostSetVar(const std::string &name, PtBufferView bv,
@@ -146,9 +279,9 @@ bool ColocatedIo::deviceHasVar(const std::string &name) const {
 //   Alice: {x0, y0, z0}
 //   Bob:   {x1, y1, z1}
 //   Carol: {x2, y2, z2}
-static std::vector<SymbolTableProto>
+static std::vector<ColocatedSyncProto>
 all2all(const std::shared_ptr<yacl::link::Context> &lctx,
-        const std::vector<SymbolTableProto> &rows) {
+        const std::vector<ColocatedSyncProto> &rows) {
   // TODO: implement all2all in yacl::link
   for (size_t idx = 0; idx < lctx->WorldSize(); idx++) {
     if (idx == lctx->Rank()) {
@@ -160,14 +293,14 @@ all2all(const std::shared_ptr<yacl::link::Context> &lctx,
     lctx->SendAsync(idx, std::move(buf), "all2all");
   }
 
-  std::vector<SymbolTableProto> cols;
+  std::vector<ColocatedSyncProto> cols;
   for (size_t idx = 0; idx < lctx->WorldSize(); idx++) {
     if (idx == lctx->Rank()) {
       cols.push_back(rows[idx]);
       continue;
     }
     auto data = lctx->Recv(idx, "all2all");
-    SymbolTableProto vars;
+    ColocatedSyncProto vars;
     YACL_ENFORCE(vars.ParseFromArray(data.data(), data.size()));
     cols.push_back(std::move(vars));
   }
@@ -176,30 +309,14 @@ all2all(const std::shared_ptr<yacl::link::Context> &lctx,
 }
 
 void ColocatedIo::sync() {
-  // TODO: optimize this.
-  //
-  // Intuition, if the input-provider is colocated with runtime, we can send
-  // less information to other hosts. i.e.
-  //
-  // For additive share, we can let the data owner's share as origin value,
-  // and other parties as zero.
-  //   P0  P1  P2
-  //   x   0   0
-  //
-  // For replicated share from P0, we can let x3 to be zero, and send x1, x2
-  // to P2, P1 respectively, the communication will be halved.
-  //   P0  P1  P2
-  //   x1      x1
-  //   x2  x2
-  //       0   0
-  //
-  // Currently, we implement the naive method, that is, using hal link context
-  // to send all shares to others.
+  // Secrets of protocols with seeded shares are sent as much as possible as
+  // prg seeds, that is, seeds only for semi2k, and a quarter of the shares
+  // for aby3. Others are sent as full shares.
 
   const auto &lctx = hctx_->lctx();
 
   IoClient io(lctx->WorldSize(), hctx_->rt_config());
-  std::vector<SymbolTableProto> shares_per_party(lctx->WorldSize());
+  std::vector<ColocatedSyncProto> shares_per_party(lctx->WorldSize());
   for (const auto &[name, priv] : unsynced_) {
     const auto &arr = priv.arr;
     YACL_ENFORCE(arr.eltype().isa<PtTy>(), "unsupported type={}", arr.eltype());
@@ -207,31 +324,51 @@ void ColocatedIo::sync() {
     PtBufferView bv(arr.data(), arr.eltype().as<PtTy>()->pt_type(), arr.shape(),
                     arr.strides());
 
+    if (priv.vtype == VIS_SECRET && io.hasSeededShareSupport(bv.pt_type)) {
+      auto shares = io.makeSeededShares(bv, lctx->Rank());
+      YACL_ENFORCE(shares.size() == lctx->WorldSize());
+
+      for (size_t idx = 0; idx < shares.size(); idx++) {
+        shares_per_party[idx].mutable_seeded()->insert(
+            {name, std::move(shares[idx])});
+      }
+      continue;
+    }
+
     auto shares = io.makeShares(bv, priv.vtype);
     YACL_ENFORCE(shares.size() == lctx->WorldSize());
 
     for (size_t idx = 0; idx < shares.size(); idx++) {
-      shares_per_party[idx].mutable_symbols()->insert(
+      shares_per_party[idx].mutable_values()->insert(
           {name, shares[idx].toProto()});
     }
   }
 
-  std::vector<SymbolTableProto> values_per_party =
+  std::vector<ColocatedSyncProto> values_per_party =
       all2all(lctx, shares_per_party);
 
   std::set<std::string> all_names;
+  const auto add_name = [&](const std::string &name) {
+    YACL_ENFORCE(all_names.find(name) == all_names.end(), "name duplicated {}",
+                 name);
+    all_names.insert(name);
+  };
   for (const auto &values : values_per_party) {
-    for (const auto &[name, _] : values.symbols()) {
-      YACL_ENFORCE(all_names.find(name) == all_names.end(),
-                   "name duplicated {}", name);
-      all_names.insert(name);
+    for (const auto &[name, _] : values.values()) {
+      add_name(name);
+    }
+    for (const auto &[name, _] : values.seeded()) {
+      add_name(name);
     }
   }
 
   for (const auto &values : values_per_party) {
-    for (const auto &[name, proto] : values.symbols()) {
+    for (const auto &[name, proto] : values.values()) {
       symbols_.setVar(name, spu::Value::fromProto(proto));
     }
+    for (const auto &[name, proto] : values.seeded()) {
+      symbols_.setVar(name, io.expandSeededShare(proto, lctx->Rank()));
+    }
   }
 
   unsynced_.clear();
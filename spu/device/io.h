@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "spu/core/xt_helper.h"
+#include "spu/device/device.pb.h"
 #include "spu/device/symbol_table.h"
 #include "spu/kernel/context.h"
 #include "spu/kernel/value.h"
@@ -111,6 +112,27 @@ public:
 
   // Combine shares to a plaintext ndarray.
   NdArrayRef combineShares(absl::Span<spu::Value const> values);
+
+  // Combine the shares of several values, i.e. `values[i]` are the shares of
+  // the i-th value. Values of the same storage and data type are packed and
+  // reconstructed by one call.
+  std::vector<NdArrayRef>
+  batchCombineShares(absl::Span<std::vector<spu::Value> const> values);
+
+  // Whether the protocol could make secrets of `pt_type` by makeSeededShares.
+  bool hasSeededShareSupport(PtType pt_type) const;
+
+  // Make secret shares whose parts are expanded from fresh prg seeds as much
+  // as the protocol allows, so the owner sends seeds instead of most of the
+  // shares, i.e. seeds only for semi2k.
+  //
+  // Returns what to send to each party, the share of `owner_rank` is kept by
+  // the owner.
+  std::vector<SeededShareProto> makeSeededShares(PtBufferView bv,
+                                                 size_t owner_rank);
+
+  // The share of `rank` from what makeSeededShares made for it.
+  spu::Value expandSeededShare(const SeededShareProto &share, size_t rank);
 };
 
 class ColocatedIo {
@@ -0,0 +1,94 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xrandom.hpp"
+
+#include "spu/device/io.h"
+
+namespace spu::device {
+namespace {
+
+RuntimeConfig makeConfig(ProtocolKind protocol) {
+  RuntimeConfig config;
+  config.set_protocol(protocol);
+  config.set_field(FieldType::FM64);
+  return config;
+}
+
+xt::xarray<float> makeInput(int64_t numel) {
+  return xt::random::rand<float>({static_cast<size_t>(numel)});
+}
+
+void BM_MakeShares(benchmark::State &state, ProtocolKind protocol,
+                   size_t world_size) {
+  IoClient io(world_size, makeConfig(protocol));
+  const auto in = makeInput(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(io.makeShares(in, VIS_SECRET));
+  }
+  state.SetBytesProcessed(state.iterations() * in.size() * sizeof(float));
+}
+
+void BM_MakeSeededShares(benchmark::State &state) {
+  IoClient io(3, makeConfig(ProtocolKind::SEMI2K));
+  const auto in = makeInput(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(io.makeSeededShares(in, 0));
+  }
+  state.SetBytesProcessed(state.iterations() * in.size() * sizeof(float));
+}
+
+void BM_CombineShares(benchmark::State &state, ProtocolKind protocol,
+                      size_t world_size) {
+  IoClient io(world_size, makeConfig(protocol));
+  const auto in = makeInput(state.range(0));
+  const auto shares = io.makeShares(in, VIS_SECRET);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(io.combineShares(shares));
+  }
+  state.SetBytesProcessed(state.iterations() * in.size() * sizeof(float));
+}
+
+BENCHMARK_CAPTURE(BM_MakeShares, semi2k, ProtocolKind::SEMI2K, 3)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24);
+BENCHMARK_CAPTURE(BM_MakeShares, aby3, ProtocolKind::ABY3, 3)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24);
+BENCHMARK(BM_MakeSeededShares)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24);
+BENCHMARK_CAPTURE(BM_CombineShares, semi2k, ProtocolKind::SEMI2K, 3)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24);
+BENCHMARK_CAPTURE(BM_CombineShares, aby3, ProtocolKind::ABY3, 3)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24);
+
+} // namespace
+} // namespace spu::device
+
+BENCHMARK_MAIN();
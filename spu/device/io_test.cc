@@ -66,6 +66,79 @@ TEST_P(IoClientTest, Int) {
   EXPECT_EQ(in_data, out_data);
 }
 
+TEST_P(IoClientTest, BatchCombine) {
+  const size_t kWorldSize = std::get<0>(GetParam());
+  const Visibility kVisibility = std::get<3>(GetParam());
+
+  RuntimeConfig hconf;
+  hconf.set_protocol(std::get<1>(GetParam()));
+  hconf.set_field(std::get<2>(GetParam()));
+  IoClient io(kWorldSize, hconf);
+
+  xt::xarray<float> x({{1, -2, 3, 0}});
+  xt::xarray<int> y({{4, 5}, {-6, 7}});
+  xt::xarray<float> z({0.5, -1.5});
+
+  std::vector<std::vector<spu::Value>> shares = {
+      io.makeShares(x, kVisibility), io.makeShares(y, kVisibility),
+      io.makeShares(z, kVisibility)};
+  auto outs = io.batchCombineShares(shares);
+  ASSERT_EQ(outs.size(), shares.size());
+
+  EXPECT_EQ(outs[0].eltype().as<PtTy>()->pt_type(), PT_F32);
+  EXPECT_EQ(outs[1].eltype().as<PtTy>()->pt_type(), PT_I32);
+  EXPECT_EQ(xt_adapt<float>(outs[0]), x);
+  EXPECT_EQ(xt_adapt<int32_t>(outs[1]), y);
+  EXPECT_EQ(xt_adapt<float>(outs[2]), z);
+}
+
+class IoClientSeededTest
+    : public ::testing::TestWithParam<std::tuple<size_t, ProtocolKind>> {};
+
+TEST_P(IoClientSeededTest, Works) {
+  const size_t kWorldSize = std::get<0>(GetParam());
+
+  RuntimeConfig hconf;
+  hconf.set_protocol(std::get<1>(GetParam()));
+  hconf.set_field(FieldType::FM64);
+  IoClient io(kWorldSize, hconf);
+  ASSERT_TRUE(io.hasSeededShareSupport(PT_F32));
+
+  xt::xarray<float> in_data({{1, -2, 3, 0}, {4.5, 5, -6, 7}});
+
+  for (size_t owner = 0; owner < kWorldSize; owner++) {
+    auto seeded = io.makeSeededShares(in_data, owner);
+    ASSERT_EQ(seeded.size(), kWorldSize);
+
+    std::vector<spu::Value> shares;
+    for (size_t rank = 0; rank < kWorldSize; rank++) {
+      shares.push_back(io.expandSeededShare(seeded[rank], rank));
+      EXPECT_TRUE(shares.back().isSecret());
+    }
+
+    auto out = io.combineShares(shares);
+    EXPECT_EQ(out.eltype().as<PtTy>()->pt_type(), PT_F32);
+    EXPECT_EQ(in_data, xt_adapt<float>(out));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    IoClientSeededTestInstance, IoClientSeededTest,
+    testing::Values(std::make_tuple(size_t{2}, ProtocolKind::SEMI2K),
+                    std::make_tuple(size_t{3}, ProtocolKind::SEMI2K),
+                    std::make_tuple(size_t{3}, ProtocolKind::ABY3)),
+    [](const testing::TestParamInfo<IoClientSeededTest::ParamType> &p) {
+      return fmt::format("{}x{}", std::get<0>(p.param), std::get<1>(p.param));
+    });
+
+TEST(IoClientSeededShareTest, Unsupported) {
+  RuntimeConfig hconf;
+  hconf.set_protocol(ProtocolKind::REF2K);
+  hconf.set_field(FieldType::FM64);
+  IoClient io(2, hconf);
+  EXPECT_FALSE(io.hasSeededShareSupport(PT_F32));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     IoClientTestInstance, IoClientTest,
     testing::Combine(
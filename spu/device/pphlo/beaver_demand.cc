@@ -0,0 +1,114 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/pphlo/beaver_demand.h"
+
+#include <vector>
+
+#include "yacl/base/exception.h"
+
+#include "spu/device/api.h"
+#include "spu/device/executable_cache.h"
+#include "spu/device/pphlo/pphlo_executor.h"
+#include "spu/dialect/pphlo_types.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/mpc/semi2k/object.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+DataType getDtype(mlir::Type type) {
+  mlir::pphlo::TypeTools tools;
+  auto expressed = tools.getExpressedType(type);
+  if (expressed.isa<mlir::FloatType>()) {
+    return DT_FXP;
+  }
+  auto int_type = expressed.dyn_cast<mlir::IntegerType>();
+  YACL_ENFORCE(int_type, "unsupported input type");
+  const bool is_unsigned = int_type.isUnsigned();
+  switch (int_type.getWidth()) {
+  case 1:
+    return DT_I1;
+  case 8:
+    return is_unsigned ? DT_U8 : DT_I8;
+  case 16:
+    return is_unsigned ? DT_U16 : DT_I16;
+  case 32:
+    return is_unsigned ? DT_U32 : DT_I32;
+  case 64:
+    return is_unsigned ? DT_U64 : DT_I64;
+  default:
+    YACL_THROW("unsupported input width {}", int_type.getWidth());
+  }
+}
+
+// Zeros of the types of the entry function arguments.
+void feedZeros(HalContext *hctx, const ParsedExecutable &parsed,
+               SymbolTable *env) {
+  mlir::pphlo::TypeTools tools;
+  const auto &input_names = parsed.executable().input_names();
+  auto arg_types = parsed.entry_function().getArgumentTypes();
+  YACL_ENFORCE(static_cast<size_t>(input_names.size()) == arg_types.size(),
+               "{} input names of {} arguments", input_names.size(),
+               arg_types.size());
+
+  for (size_t idx = 0; idx < arg_types.size(); ++idx) {
+    auto type = arg_types[idx].dyn_cast<mlir::RankedTensorType>();
+    YACL_ENFORCE(type && type.hasStaticShape(),
+                 "input {} is not of a static shape", input_names[idx]);
+    const auto vis =
+        tools.getTypeVisibility(type) == mlir::pphlo::Visibility::VIS_PUBLIC
+            ? VIS_PUBLIC
+            : VIS_SECRET;
+    std::vector<int64_t> shape(type.getShape().begin(),
+                               type.getShape().end());
+    env->setVar(input_names[idx],
+                kernel::hal::zeros(hctx, vis, getDtype(type), shape));
+  }
+}
+
+} // namespace
+
+mpc::BeaverDemand countBeaverDemand(const ExecutableProto &executable,
+                                    const RuntimeConfig &config,
+                                    size_t world_size) {
+  YACL_ENFORCE(config.protocol() == ProtocolKind::SEMI2K,
+               "only semi2k consumes beavers, got {}",
+               ProtocolKind_Name(config.protocol()));
+
+  RuntimeConfig conf = config;
+  conf.set_experimental_enable_inter_op_par(false);
+
+  const ParsedExecutable parsed(executable);
+  mpc::BeaverDemand demand;
+  mpc::util::simulate(
+      world_size, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        HalContext hctx(conf, lctx);
+        auto *counter =
+            hctx.prot()->getState<mpc::Semi2kState>()->enableBeaverCounter();
+
+        SymbolTable env;
+        feedZeros(&hctx, parsed, &env);
+        PPHloExecutor executor;
+        execute(&executor, &hctx, parsed, &env);
+
+        if (lctx->Rank() == 0) {
+          demand = counter->demand();
+        }
+      });
+  return demand;
+}
+
+} // namespace spu::device::pphlo
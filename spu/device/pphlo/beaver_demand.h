@@ -0,0 +1,40 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+
+#include "spu/mpc/beaver/beaver_counter.h"
+
+#include "spu/spu.pb.h"
+
+namespace spu::device::pphlo {
+
+/// Count the beaver correlations one party of semi2k consumes to run
+/// `executable`, by a dry run of `world_size` parties in process, so the
+/// offline phase of a real run could prefill exactly that, e.g.
+///
+///   countBeaverDemand(executable, config, 2).PrefillTo(state->beaverPool());
+///
+/// Inputs are zeros of the shapes and visibilities of the entry function.
+/// The demand of a program does not depend on input values, unless its
+/// control flow does, e.g. a while of a revealed condition, in which case
+/// the count is of zero inputs. Inter-op parallelism is disabled by the dry
+/// run, since forked contexts have their own beavers.
+mpc::BeaverDemand countBeaverDemand(const ExecutableProto &executable,
+                                    const RuntimeConfig &config,
+                                    size_t world_size);
+
+} // namespace spu::device::pphlo
@@ -0,0 +1,85 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/pphlo/beaver_demand.h"
+
+#include "gtest/gtest.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+ExecutableProto makeExecutable(const std::string &code,
+                               const std::vector<std::string> &inputs) {
+  ExecutableProto executable;
+  executable.set_name("test");
+  executable.set_code(code);
+  for (const auto &name : inputs) {
+    executable.add_input_names(name);
+  }
+  return executable;
+}
+
+RuntimeConfig makeConfig(ProtocolKind protocol) {
+  RuntimeConfig conf;
+  conf.set_protocol(protocol);
+  conf.set_field(FieldType::FM64);
+  return conf;
+}
+
+TEST(BeaverDemandTest, MulAndDot) {
+  auto executable = makeExecutable(R"(
+func.func @main(%arg0: tensor<2x3x!pphlo.sec<i32>>, %arg1: tensor<3x4x!pphlo.sec<i32>>) -> (tensor<2x4x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<2x3x!pphlo.sec<i32>>, tensor<2x3x!pphlo.sec<i32>>) -> tensor<2x3x!pphlo.sec<i32>>
+  %1 = "pphlo.dot"(%0, %arg1) : (tensor<2x3x!pphlo.sec<i32>>, tensor<3x4x!pphlo.sec<i32>>) -> tensor<2x4x!pphlo.sec<i32>>
+  return %1 : tensor<2x4x!pphlo.sec<i32>>
+})",
+                                   {"x", "y"});
+
+  auto demand =
+      countBeaverDemand(executable, makeConfig(ProtocolKind::SEMI2K), 2);
+
+  ASSERT_EQ(demand.elts.size(), 1U);
+  EXPECT_EQ((demand.elts[{mpc::BeaverPool::Kind::Mul, FieldType::FM64, 0}]),
+            6U);
+  ASSERT_EQ(demand.dots.size(), 1U);
+  EXPECT_EQ((demand.dots[{FieldType::FM64, 2, 4, 3}]), 1U);
+}
+
+TEST(BeaverDemandTest, PublicIsFree) {
+  auto executable = makeExecutable(R"(
+func.func @main(%arg0: tensor<4x!pphlo.pub<i32>>, %arg1: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.pub<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  return %0 : tensor<4x!pphlo.sec<i32>>
+})",
+                                   {"x", "y"});
+
+  auto demand =
+      countBeaverDemand(executable, makeConfig(ProtocolKind::SEMI2K), 2);
+  EXPECT_TRUE(demand.elts.empty());
+  EXPECT_TRUE(demand.dots.empty());
+}
+
+TEST(BeaverDemandTest, OnlySemi2k) {
+  auto executable = makeExecutable(R"(
+func.func @main(%arg0: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+  return %arg0 : tensor<4x!pphlo.sec<i32>>
+})",
+                                   {"x"});
+
+  EXPECT_ANY_THROW(
+      countBeaverDemand(executable, makeConfig(ProtocolKind::ABY3), 3));
+}
+
+} // namespace
+} // namespace spu::device::pphlo
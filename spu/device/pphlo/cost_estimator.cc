@@ -0,0 +1,258 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/pphlo/cost_estimator.h"
+
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "yacl/base/exception.h"
+
+#include "spu/dialect/pphlo_types.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+// Ops which lower to local kernels only, e.g. add_aa and shape ops.
+const std::set<std::string> kFreeOps = {
+    "pphlo.add",       "pphlo.subtract",  "pphlo.negate",
+    "pphlo.not",       "pphlo.xor",       "pphlo.constant",
+    "pphlo.iota",      "pphlo.broadcast", "pphlo.reshape",
+    "pphlo.transpose", "pphlo.slice",     "pphlo.concatenate",
+    "pphlo.reverse",   "pphlo.pad",       "pphlo.prefer_a",
+    "pphlo.dbg_print", "pphlo.return",    "pphlo.bitcast_convert",
+};
+
+class Estimator {
+  mpc::Object *const prot_;
+  const RuntimeConfig &config_;
+  const size_t world_size_;
+
+  mlir::pphlo::TypeTools tools_;
+
+  CostEstimate estimate_;
+
+  // rounds of the longest chain of ops to compute a value.
+  llvm::DenseMap<mlir::Value, size_t> depth_;
+
+  bool isSecret(mlir::Value v) const {
+    return tools_.isMPCType<mlir::pphlo::SecretType>(v.getType());
+  }
+
+  bool isFxp(mlir::Value v) const {
+    return tools_.isExpressedType<mlir::FloatType>(v.getType());
+  }
+
+  static size_t numel(mlir::Value v) {
+    auto type = v.getType().dyn_cast<mlir::RankedTensorType>();
+    return type ? type.getNumElements() : 1;
+  }
+
+  // Rounds and comm bits per element of a kernel, or nullopt if unknown.
+  std::optional<std::pair<size_t, size_t>> evalKernel(
+      const std::string &name) const {
+    if (!prot_->hasKernel(name)) {
+      return std::nullopt;
+    }
+    auto *kernel = prot_->getKernel(name);
+    auto latency = kernel->latency();
+    auto comm = kernel->comm();
+    if (latency == nullptr || comm == nullptr) {
+      return std::nullopt;
+    }
+    return std::make_pair(latency->eval(config_.field(), world_size_),
+                          comm->eval(config_.field(), world_size_));
+  }
+
+  // Record a kernel call of `n` elements, return its rounds.
+  size_t addKernel(const std::string &name, size_t n) {
+    auto &cost = estimate_.kernels[name];
+    cost.calls += 1;
+    cost.numel += n;
+
+    auto eval = evalKernel(name);
+    if (!eval.has_value()) {
+      cost.unknown = true;
+      return 0;
+    }
+    const size_t bytes = (eval->second * n + 7) / 8;
+    cost.rounds += eval->first;
+    cost.comm_bytes += bytes;
+    estimate_.comm_bytes += bytes;
+    return eval->first;
+  }
+
+  // A matrix multiplication of secrets, modeled by mul_aa.
+  size_t addMmul(mlir::Value lhs, mlir::Value rhs, mlir::Value ret) {
+    auto &cost = estimate_.kernels["mmul_aa"];
+    cost.calls += 1;
+    cost.numel += numel(ret);
+
+    auto eval = evalKernel("mul_aa");
+    if (!eval.has_value()) {
+      cost.unknown = true;
+      return 0;
+    }
+    // a beaver triple opens lhs and rhs, mul_aa opens two elements.
+    const size_t bits = config_.protocol() == ProtocolKind::SEMI2K
+                            ? eval->second * (numel(lhs) + numel(rhs)) / 2
+                            : eval->second * numel(ret);
+    const size_t bytes = (bits + 7) / 8;
+    cost.rounds += eval->first;
+    cost.comm_bytes += bytes;
+    estimate_.comm_bytes += bytes;
+    return eval->first;
+  }
+
+  // a secret bit selects between a and b, i.e. b + bit * (a - b).
+  size_t addSelect(size_t n) {
+    if (prot_->hasKernel("mul_a1b")) {
+      return addKernel("mul_a1b", n);
+    }
+    return addKernel("b2a", n) + addKernel("mul_aa", n);
+  }
+
+  // msb of the difference, or of the a2b of it for protocols without msb_a.
+  size_t addLess(size_t n) {
+    if (evalKernel("msb_a").has_value()) {
+      return addKernel("msb_a", n);
+    }
+    return addKernel("a2b", n);
+  }
+
+  // Rounds of an op on secrets, nullopt if it has no cost model.
+  std::optional<size_t> visitSecretOp(mlir::Operation &op) {
+    const std::string name = op.getName().getStringRef().str();
+    if (kFreeOps.count(name) > 0) {
+      return 0;
+    }
+
+    auto ret = op.getResult(0);
+    const size_t n = numel(ret);
+
+    if (name == "pphlo.multiply") {
+      auto lhs = op.getOperand(0);
+      auto rhs = op.getOperand(1);
+      const bool ss = isSecret(lhs) && isSecret(rhs);
+      size_t rounds = addKernel(ss ? "mul_aa" : "mul_ap", n);
+      if (isFxp(lhs) && isFxp(rhs)) {
+        rounds += addKernel("truncpr_a", n);
+      }
+      return rounds;
+    }
+    if (name == "pphlo.dot" || name == "pphlo.dot_general") {
+      auto lhs = op.getOperand(0);
+      auto rhs = op.getOperand(1);
+      size_t rounds = isSecret(lhs) && isSecret(rhs)
+                          ? addMmul(lhs, rhs, ret)
+                          : addKernel("mmul_ap", n);
+      if (isFxp(lhs) && isFxp(rhs)) {
+        rounds += addKernel("truncpr_a", n);
+      }
+      return rounds;
+    }
+    if (name == "pphlo.less" || name == "pphlo.greater" ||
+        name == "pphlo.less_equal" || name == "pphlo.greater_equal") {
+      return addLess(n);
+    }
+    if (name == "pphlo.equal" || name == "pphlo.not_equal") {
+      // eqz(x) = not(lsb(prefix_or(x))), prefix_or takes log(k) and_bb.
+      size_t rounds = addKernel("a2b", n);
+      for (size_t bits = 1; bits < SizeOf(config_.field()) * 8; bits *= 2) {
+        rounds += addKernel("and_bb", n);
+      }
+      return rounds;
+    }
+    if (name == "pphlo.maximum" || name == "pphlo.minimum") {
+      return addLess(n) + addSelect(n);
+    }
+    if (name == "pphlo.clamp") {
+      return 2 * (addLess(n) + addSelect(n));
+    }
+    if (name == "pphlo.convert") {
+      // to fxp is a local left shift, fxp to int rounds by the sign.
+      if (isFxp(op.getOperand(0)) && !isFxp(ret)) {
+        return std::nullopt;
+      }
+      return 0;
+    }
+    if (name == "pphlo.select") {
+      return isSecret(op.getOperand(0)) ? addSelect(n) : 0;
+    }
+    if (name == "pphlo.abs" || name == "pphlo.sign") {
+      return addLess(n) + addKernel("mul_aa", n);
+    }
+    if (name == "pphlo.and" || name == "pphlo.or") {
+      const bool ss = isSecret(op.getOperand(0)) && isSecret(op.getOperand(1));
+      return ss ? addKernel("and_bb", n) : 0;
+    }
+    return std::nullopt;
+  }
+
+public:
+  Estimator(mpc::Object *prot, const RuntimeConfig &config, size_t world_size)
+      : prot_(prot), config_(config), world_size_(world_size) {}
+
+  CostEstimate run(mlir::func::FuncOp entry) {
+    auto &block = entry.getBody().front();
+    for (auto &op : block.without_terminator()) {
+      size_t depth = 0;
+      for (auto operand : op.getOperands()) {
+        depth = std::max<size_t>(depth, depth_.lookup(operand));
+      }
+
+      const bool on_secrets =
+          std::any_of(op.operand_begin(), op.operand_end(),
+                      [&](mlir::Value v) { return isSecret(v); }) ||
+          std::any_of(op.result_begin(), op.result_end(),
+                      [&](mlir::Value v) { return isSecret(v); });
+
+      size_t rounds = 0;
+      if (on_secrets && op.getNumResults() > 0) {
+        auto op_rounds = op.getNumRegions() == 0
+                             ? visitSecretOp(op)
+                             : std::optional<size_t>();
+        if (op_rounds.has_value()) {
+          rounds = *op_rounds;
+        } else {
+          estimate_.unmodeled_ops[op.getName().getStringRef().str()] += 1;
+        }
+      }
+
+      estimate_.rounds += rounds;
+      for (auto result : op.getResults()) {
+        depth_[result] = depth + rounds;
+      }
+      estimate_.critical_path_rounds =
+          std::max(estimate_.critical_path_rounds, depth + rounds);
+    }
+    return std::move(estimate_);
+  }
+};
+
+} // namespace
+
+CostEstimate estimateCost(mlir::ModuleOp module, mpc::Object *prot,
+                          const RuntimeConfig &config, size_t world_size) {
+  auto entry = module.lookupSymbol<mlir::func::FuncOp>("main");
+  YACL_ENFORCE(entry, "main function not found");
+
+  return Estimator(prot, config, world_size).run(entry);
+}
+
+} // namespace spu::device::pphlo
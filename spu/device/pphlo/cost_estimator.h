@@ -0,0 +1,73 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "spu/mpc/object.h"
+
+#include "spu/spu.pb.h"
+
+namespace spu::device::pphlo {
+
+struct KernelCost {
+  size_t calls = 0;
+  size_t numel = 0;
+  size_t rounds = 0;
+  size_t comm_bytes = 0;
+  // the kernel has no complexity expression, its cost is not counted.
+  bool unknown = false;
+};
+
+struct CostEstimate {
+  /// Rounds of ops in the order of the program, i.e. nothing overlaps.
+  size_t rounds = 0;
+
+  /// Rounds of the longest chain of dependent ops, the lower bound of rounds
+  /// when independent ops are packed into one kernel call.
+  size_t critical_path_rounds = 0;
+
+  /// Bytes sent by one party.
+  size_t comm_bytes = 0;
+
+  /// Costs of the mpc kernels the ops lower to, by kernel name.
+  std::map<std::string, KernelCost> kernels;
+
+  /// Ops on secrets of no cost model, by op name, e.g. the polynomial
+  /// approximations of exp, and ops with regions. Their costs are not
+  /// counted, so the estimate is a lower bound if this is not empty.
+  std::map<std::string, size_t> unmodeled_ops;
+};
+
+/// Estimate the cost of one party to run the entry function of a pphlo
+/// module, without running it.
+///
+/// Every op on secrets is mapped to the mpc kernels hal lowers it to, e.g. a
+/// fixed point multiplication to mul_aa and truncpr_a, and the complexity
+/// expressions of the kernels of `prot` are evaluated with the field and
+/// number of parties of it. Ops of linear or shape only kernels, and ops on
+/// publics are free.
+///
+/// Matrix multiplications have no complexity expression since they depend on
+/// shapes, they are modeled by mul_aa, i.e. a beaver triple opens both
+/// operands for semi2k, and others reshare the products.
+CostEstimate estimateCost(mlir::ModuleOp module, mpc::Object *prot,
+                          const RuntimeConfig &config, size_t world_size);
+
+} // namespace spu::device::pphlo
@@ -0,0 +1,151 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/pphlo/cost_estimator.h"
+
+#include "gtest/gtest.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+
+#include "spu/dialect/pphlo_dialect.h"
+#include "spu/mpc/factory.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+// Estimate the cost of `code` with the protocol of party 0.
+CostEstimate estimate(const std::string &code, const RuntimeConfig &config,
+                      size_t world_size) {
+  mlir::MLIRContext mlir_ctx;
+  mlir_ctx.loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
+  auto module = mlir::parseSourceString<mlir::ModuleOp>(code, &mlir_ctx);
+  YACL_ENFORCE(module, "invalid module");
+
+  CostEstimate result;
+  mpc::util::simulate(
+      world_size, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        if (lctx->Rank() != 0) {
+          return;
+        }
+        auto prot = mpc::Factory::CreateCompute(config, lctx);
+        result = estimateCost(*module, prot.get(), config, world_size);
+      });
+  return result;
+}
+
+class CostEstimatorTest : public ::testing::TestWithParam<
+                              std::tuple<size_t, ProtocolKind, FieldType>> {
+protected:
+  size_t world_size() const { return std::get<0>(GetParam()); }
+
+  RuntimeConfig config() const {
+    RuntimeConfig conf;
+    conf.set_protocol(std::get<1>(GetParam()));
+    conf.set_field(std::get<2>(GetParam()));
+    return conf;
+  }
+
+  // Rounds and comm bits of one element of a kernel.
+  std::pair<size_t, size_t> kernelCost(const std::string &name) const {
+    std::pair<size_t, size_t> cost;
+    const auto conf = config();
+    mpc::util::simulate(
+        world_size(), [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+          if (lctx->Rank() != 0) {
+            return;
+          }
+          auto prot = mpc::Factory::CreateCompute(conf, lctx);
+          auto *kernel = prot->getKernel(name);
+          cost = {kernel->latency()->eval(conf.field(), world_size()),
+                  kernel->comm()->eval(conf.field(), world_size())};
+        });
+    return cost;
+  }
+};
+
+TEST_P(CostEstimatorTest, Multiply) {
+  auto est = estimate(R"(
+func.func @main(%arg0: tensor<2x3x!pphlo.sec<f32>>, %arg1: tensor<2x3x!pphlo.sec<f32>>) -> (tensor<2x3x!pphlo.sec<f32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<f32>>) -> tensor<2x3x!pphlo.sec<f32>>
+  %1 = "pphlo.multiply"(%arg0, %arg0) : (tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<f32>>) -> tensor<2x3x!pphlo.sec<f32>>
+  %2 = "pphlo.add"(%0, %1) : (tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<f32>>) -> tensor<2x3x!pphlo.sec<f32>>
+  return %2 : tensor<2x3x!pphlo.sec<f32>>
+})",
+                      config(), world_size());
+
+  const auto [mul_rounds, mul_bits] = kernelCost("mul_aa");
+  const auto [trunc_rounds, trunc_bits] = kernelCost("truncpr_a");
+
+  EXPECT_EQ(est.kernels["mul_aa"].calls, 2U);
+  EXPECT_EQ(est.kernels["mul_aa"].numel, 12U);
+  EXPECT_EQ(est.kernels["truncpr_a"].calls, 2U);
+  EXPECT_TRUE(est.unmodeled_ops.empty());
+
+  // the two multiplications are independent.
+  EXPECT_EQ(est.rounds, 2 * (mul_rounds + trunc_rounds));
+  EXPECT_EQ(est.critical_path_rounds, mul_rounds + trunc_rounds);
+  EXPECT_EQ(est.comm_bytes,
+            2 * ((mul_bits * 6 + 7) / 8 + (trunc_bits * 6 + 7) / 8));
+}
+
+TEST_P(CostEstimatorTest, PublicAndUnmodeled) {
+  auto est = estimate(R"(
+func.func @main(%arg0: tensor<4x!pphlo.pub<f32>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.pub<f32>>
+  %1 = "pphlo.exponential"(%arg1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+  return %0, %1 : tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>
+})",
+                      config(), world_size());
+
+  EXPECT_EQ(est.rounds, 0U);
+  EXPECT_EQ(est.comm_bytes, 0U);
+  EXPECT_TRUE(est.kernels.empty());
+  ASSERT_EQ(est.unmodeled_ops.size(), 1U);
+  EXPECT_EQ(est.unmodeled_ops["pphlo.exponential"], 1U);
+}
+
+TEST_P(CostEstimatorTest, Dot) {
+  auto est = estimate(R"(
+func.func @main(%arg0: tensor<2x3x!pphlo.sec<i32>>, %arg1: tensor<3x4x!pphlo.sec<i32>>) -> (tensor<2x4x!pphlo.sec<i32>>) {
+  %0 = "pphlo.dot"(%arg0, %arg1) : (tensor<2x3x!pphlo.sec<i32>>, tensor<3x4x!pphlo.sec<i32>>) -> tensor<2x4x!pphlo.sec<i32>>
+  return %0 : tensor<2x4x!pphlo.sec<i32>>
+})",
+                      config(), world_size());
+
+  const auto [mul_rounds, mul_bits] = kernelCost("mul_aa");
+  EXPECT_EQ(est.kernels["mmul_aa"].calls, 1U);
+  EXPECT_EQ(est.kernels.count("truncpr_a"), 0U);
+  EXPECT_EQ(est.rounds, mul_rounds);
+
+  const size_t bits = config().protocol() == ProtocolKind::SEMI2K
+                          ? mul_bits * (6 + 12) / 2
+                          : mul_bits * 8;
+  EXPECT_EQ(est.comm_bytes, (bits + 7) / 8);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CostEstimatorTestInstances, CostEstimatorTest,
+    testing::Values(
+        std::make_tuple(size_t{2}, ProtocolKind::SEMI2K, FieldType::FM64),
+        std::make_tuple(size_t{3}, ProtocolKind::SEMI2K, FieldType::FM128),
+        std::make_tuple(size_t{3}, ProtocolKind::ABY3, FieldType::FM64)),
+    [](const testing::TestParamInfo<CostEstimatorTest::ParamType> &p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param), std::get<1>(p.param),
+                         std::get<2>(p.param));
+    });
+
+} // namespace
+} // namespace spu::device::pphlo
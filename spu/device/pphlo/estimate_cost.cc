@@ -0,0 +1,102 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Estimate the rounds and communication of a compiled pphlo module, e.g.
+//
+//   estimate_cost --protocol=ABY3 --field=FM64 --parties=3 model.mlir
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "fmt/format.h"
+#include "llvm/Support/CommandLine.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "spdlog/spdlog.h"
+
+#include "spu/device/pphlo/cost_estimator.h"
+#include "spu/dialect/pphlo_dialect.h"
+#include "spu/mpc/factory.h"
+#include "spu/mpc/util/simulate.h"
+
+llvm::cl::opt<std::string> InputFilename(llvm::cl::Positional,
+                                         llvm::cl::desc("<pphlo module>"),
+                                         llvm::cl::Required);
+
+llvm::cl::opt<std::string> Protocol("protocol", llvm::cl::desc("protocol kind"),
+                                    llvm::cl::init("ABY3"));
+
+llvm::cl::opt<std::string> Field("field", llvm::cl::desc("ring field size"),
+                                 llvm::cl::init("FM64"));
+
+llvm::cl::opt<uint32_t> Parties("parties", llvm::cl::init(3),
+                                llvm::cl::desc("number of parties"));
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  // suppress all link logs.
+  spdlog::set_level(spdlog::level::off);
+
+  spu::ProtocolKind pk;
+  YACL_ENFORCE(spu::ProtocolKind_Parse(Protocol.getValue(), &pk),
+               "Invalid protocol kind {}", Protocol.getValue());
+  spu::FieldType field;
+  YACL_ENFORCE(spu::FieldType_Parse(Field.getValue(), &field),
+               "Invalid field {}", Field.getValue());
+
+  spu::RuntimeConfig config;
+  config.set_protocol(pk);
+  config.set_field(field);
+
+  std::ifstream in(InputFilename.getValue(), std::ios::binary);
+  YACL_ENFORCE(in, "can not open {}", InputFilename.getValue());
+  std::stringstream code;
+  code << in.rdbuf();
+
+  mlir::MLIRContext mlir_ctx;
+  mlir_ctx.loadDialect<mlir::pphlo::PPHloDialect, mlir::func::FuncDialect>();
+  auto module = mlir::parseSourceString<mlir::ModuleOp>(code.str(), &mlir_ctx);
+  YACL_ENFORCE(module, "invalid pphlo module {}", InputFilename.getValue());
+
+  spu::device::pphlo::CostEstimate est;
+  spu::mpc::util::simulate(
+      Parties.getValue(),
+      [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        if (lctx->Rank() != 0) {
+          return;
+        }
+        auto prot = spu::mpc::Factory::CreateCompute(config, lctx);
+        est = spu::device::pphlo::estimateCost(*module, prot.get(), config,
+                                               Parties.getValue());
+      });
+
+  fmt::print("{:<20}, {:<10}, {:<12}, {:<10}, {:<16}\n", "kernel", "calls",
+             "numel", "rounds", "comm(bytes)");
+  for (const auto &[name, cost] : est.kernels) {
+    fmt::print("{:<20}, {:<10}, {:<12}, {:<10}, {:<16}\n", name, cost.calls,
+               cost.numel,
+               cost.unknown ? "unknown" : std::to_string(cost.rounds),
+               cost.unknown ? "unknown" : std::to_string(cost.comm_bytes));
+  }
+  for (const auto &[name, count] : est.unmodeled_ops) {
+    fmt::print("unmodeled op {} x {}\n", name, count);
+  }
+
+  fmt::print("rounds: {}\n", est.rounds);
+  fmt::print("critical path rounds: {}\n", est.critical_path_rounds);
+  fmt::print("comm bytes per party: {}\n", est.comm_bytes);
+}
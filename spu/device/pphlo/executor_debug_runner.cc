@@ -12,21 +12,41 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// Replay a program dumped by `RuntimeConfig.enable_processor_dump` and break
+// down its cost by pphlo ops, i.e. the time, bytes sent and messages of every
+// op, optionally on an emulated network and side by side of two runtime
+// configs, e.g.
+//
+//   executor_debug_runner --dump_dir=/tmp/dump/my_exec --network=wan \
+//       --config=baseline.txt --compare_config=tuned.txt --flame_graph
+//
+// where configs are RuntimeConfig in protobuf text format. All parties run in
+// this process unless `--parties` is given, then it runs party `--rank` only.
+// Profiles go to `<out_dir>/<label>.<rank>.pb`, and with `--flame_graph` the
+// chrome traces to `<out_dir>/<label>.<rank>.json`, load them in perfetto for
+// the flame graph.
+
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "absl/strings/str_split.h"
+#include "google/protobuf/text_format.h"
 #include "llvm/Support/CommandLine.h"
 #include "spdlog/spdlog.h"
-#include "yacl/link/test_util.h"
+#include "yacl/link/factory.h"
 
-#include "spu/device/pphlo/executor.h"
+#include "spu/device/api.h"
+#include "spu/device/pphlo/pphlo_executor.h"
+#include "spu/device/pphlo/profile_report.h"
 #include "spu/device/symbol_table.h"
-#include "spu/device/test_utils.h"
-#include "spu/kernel/hal/debug.h"
+#include "spu/kernel/context.h"
 #include "spu/kernel/value.h"
+#include "spu/mpc/util/communicator.h"
 #include "spu/mpc/util/simulate.h"
 
 llvm::cl::opt<std::string>
@@ -38,13 +58,54 @@ llvm::cl::opt<std::string> Field("field", llvm::cl::desc("ring field size"),
 llvm::cl::opt<std::string> Protocol("protocol", llvm::cl::desc("protocol kind"),
                                     llvm::cl::init("ABY3"));
 
+llvm::cl::opt<std::string>
+    Config("config",
+           llvm::cl::desc("RuntimeConfig in text format, overrides protocol "
+                          "and field"),
+           llvm::cl::init(""));
+llvm::cl::opt<std::string> CompareConfig(
+    "compare_config",
+    llvm::cl::desc("another RuntimeConfig in text format to compare with"),
+    llvm::cl::init(""));
+
+llvm::cl::opt<uint32_t> WorldSize(
+    "world_size",
+    llvm::cl::desc("number of parties, 0 means the number of dumped parties"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<std::string>
+    Network("network", llvm::cl::desc("emulated network, none/lan/wan"),
+            llvm::cl::init("none"));
+llvm::cl::opt<double>
+    RttMs("rtt_ms", llvm::cl::desc("round trip time of the network, in ms"),
+          llvm::cl::init(-1));
+llvm::cl::opt<double> BandwidthMbps(
+    "bandwidth_mbps", llvm::cl::desc("bandwidth of the network, in Mbps"),
+    llvm::cl::init(-1));
+
+llvm::cl::opt<std::string> OutDir("out_dir",
+                                  llvm::cl::desc("folder of the profiles"),
+                                  llvm::cl::init("."));
+llvm::cl::opt<bool> FlameGraph("flame_graph",
+                               llvm::cl::desc("dump chrome traces of hal ops"),
+                               llvm::cl::init(false));
+llvm::cl::opt<uint32_t> TopOps("top_ops",
+                               llvm::cl::desc("number of ops to report"),
+                               llvm::cl::init(20));
+
 llvm::cl::opt<std::string> Parties(
-    "parties", llvm::cl::init("127.0.0.1:9530,127.0.0.1:9531,127.0.0.1:9532"),
-    llvm::cl::desc("server list, format: host1:port1[,host2:port2, ...]"));
+    "parties", llvm::cl::init(""),
+    llvm::cl::desc("server list, format: host1:port1[,host2:port2, ...], "
+                   "empty means all parties run in this process"));
 
 llvm::cl::opt<uint32_t> Rank("rank", llvm::cl::init(0),
                              llvm::cl::desc("self rank"));
 
+namespace {
+
+using spu::device::pphlo::formatProfile;
+using spu::device::pphlo::formatProfileDiff;
+
 std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
                                               size_t rank) {
   yacl::link::ContextDesc lctx_desc;
@@ -58,75 +119,192 @@ std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
   return lctx;
 }
 
-std::unique_ptr<spu::HalContext> MakeHalContext() {
-  auto lctx = MakeLink(Parties.getValue(), Rank.getValue());
-
+spu::RuntimeConfig ParseConfig(const std::string &path) {
   spu::RuntimeConfig config;
+  if (path.empty()) {
+    spu::ProtocolKind pk;
+    YACL_ENFORCE(spu::ProtocolKind_Parse(Protocol.getValue(), &pk),
+                 "Invalid protocol kind {}", Protocol.getValue());
+    spu::FieldType field;
+    YACL_ENFORCE(spu::FieldType_Parse(Field.getValue(), &field),
+                 "Invalid field {}", Field.getValue());
+    config.set_protocol(pk);
+    config.set_field(field);
+    return config;
+  }
 
-  // Parse protocol
-  spu::ProtocolKind pk;
-  YACL_ENFORCE(spu::ProtocolKind_Parse(Protocol.getValue(), &pk),
-               "Invalid protocol kind {}", Protocol.getValue());
-
-  // Parse field
-  spu::FieldType field;
-  YACL_ENFORCE(spu::FieldType_Parse(Field.getValue(), &field),
-               "Invalid field {}", Field.getValue());
+  std::ifstream stream(path);
+  YACL_ENFORCE(stream.good(), "Config file {} does not exist", path);
+  const std::string text((std::istreambuf_iterator<char>(stream)),
+                         std::istreambuf_iterator<char>());
+  YACL_ENFORCE(google::protobuf::TextFormat::ParseFromString(text, &config),
+               "Invalid config file {}", path);
+  return config;
+}
 
-  config.set_protocol(pk);
-  config.set_field(field);
-  config.set_enable_pphlo_trace(true);
-  config.set_enable_type_checker(true);
+std::optional<spu::mpc::NetworkProfile> MakeNetworkProfile() {
+  using spu::mpc::NetworkProfile;
+  std::optional<NetworkProfile> profile;
+  if (Network.getValue() == "lan") {
+    profile = NetworkProfile::lan();
+  } else if (Network.getValue() == "wan") {
+    profile = NetworkProfile::wan();
+  } else {
+    YACL_ENFORCE(Network.getValue() == "none",
+                 "unknown network: {}, supported = none/lan/wan",
+                 Network.getValue());
+  }
 
-  return std::make_unique<spu::HalContext>(config, lctx);
+  if (RttMs.getValue() >= 0 || BandwidthMbps.getValue() >= 0) {
+    profile = profile.value_or(NetworkProfile{});
+  }
+  if (RttMs.getValue() >= 0) {
+    profile->rtt = std::chrono::duration_cast<spu::Duration>(
+        std::chrono::duration<double, std::milli>(RttMs.getValue()));
+  }
+  if (BandwidthMbps.getValue() >= 0) {
+    profile->bandwidth = BandwidthMbps.getValue() * 1e6 / 8;
+  }
+  return profile;
 }
 
-int main(int argc, char **argv) {
-  llvm::cl::ParseCommandLineOptions(argc, argv);
-
-  std::filesystem::path core_dump_dir = DumpDir.getValue();
+spu::ExecutableProto ReadExecutable(const std::filesystem::path &dump_dir) {
+  // files of the current dump, then the legacy one.
+  auto exec_file = dump_dir / "executable.txt";
+  if (!std::filesystem::exists(exec_file)) {
+    exec_file = dump_dir / "exec.txt";
+  }
+  YACL_ENFORCE(std::filesystem::exists(exec_file),
+               "Serialized executable file does not exist in {}",
+               dump_dir.c_str());
+  SPDLOG_INFO("Read executable file from {}", exec_file.c_str());
 
   spu::ExecutableProto exec;
-  {
-    auto exec_file = core_dump_dir / "exec.txt";
-    YACL_ENFORCE(std::filesystem::exists(exec_file),
-                 "Serialized executable file does not exit");
-    SPDLOG_INFO("Read executable file from {}", exec_file.c_str());
-    std::ifstream stream(exec_file, std::ios::binary);
-    if (!exec.ParseFromIstream(&stream)) {
-      // Try raw mlir with 0 inputs
-      // Rewind fp
-      stream.clear();
-      stream.seekg(0);
-      exec.set_code(std::string((std::istreambuf_iterator<char>(stream)),
-                                std::istreambuf_iterator<char>()));
+  std::ifstream stream(exec_file, std::ios::binary);
+  if (!exec.ParseFromIstream(&stream)) {
+    // Try raw mlir with 0 inputs
+    // Rewind fp
+    stream.clear();
+    stream.seekg(0);
+    exec.Clear();
+    exec.set_code(std::string((std::istreambuf_iterator<char>(stream)),
+                              std::istreambuf_iterator<char>()));
+  }
+  return exec;
+}
+
+std::filesystem::path DataFile(const std::filesystem::path &dump_dir,
+                               size_t rank, int idx) {
+  return dump_dir / fmt::format("data_{}_{}.txt", rank, idx);
+}
+
+// The parties of the dump, by the first inputs of each rank.
+size_t GetWorldSize(const std::filesystem::path &dump_dir,
+                    const spu::ExecutableProto &exec,
+                    const spu::RuntimeConfig &config) {
+  if (WorldSize.getValue() != 0) {
+    return WorldSize.getValue();
+  }
+  if (exec.input_names_size() != 0) {
+    size_t world_size = 0;
+    while (std::filesystem::exists(DataFile(dump_dir, world_size, 0))) {
+      world_size++;
     }
+    YACL_ENFORCE(world_size != 0, "Data files do not exist in {}",
+                 dump_dir.c_str());
+    return world_size;
+  }
+  return config.protocol() == spu::ProtocolKind::ABY3 ? 3 : 2;
+}
+
+void FeedInputs(const std::filesystem::path &dump_dir,
+                const spu::ExecutableProto &exec, size_t rank,
+                spu::device::SymbolTable *table) {
+  for (int idx = 0; idx < exec.input_names_size(); ++idx) {
+    auto data_file = DataFile(dump_dir, rank, idx);
+    YACL_ENFORCE(std::filesystem::exists(data_file),
+                 "Data file {} does not exist", data_file.c_str());
+
+    std::ifstream stream(data_file, std::ios::binary);
+    spu::ValueProto vp;
+    YACL_ENFORCE(vp.ParseFromIstream(&stream), "Invalid data file {}",
+                 data_file.c_str());
+    table->setVar(exec.input_names(idx), spu::Value::fromProto(vp));
+  }
+}
+
+void RunParty(const std::filesystem::path &dump_dir,
+              const spu::ExecutableProto &exec,
+              const spu::RuntimeConfig &config,
+              const std::optional<spu::mpc::NetworkProfile> &network,
+              const std::shared_ptr<yacl::link::Context> &lctx) {
+  spu::HalContext hctx(config, lctx);
+  if (network) {
+    hctx.prot()->getState<spu::mpc::Communicator>()->setNetworkProfile(
+        *network);
   }
 
   spu::device::SymbolTable table;
-  auto hctx = MakeHalContext();
-  spu::device::pphlo::PPHloExecutor executor(hctx.get());
+  FeedInputs(dump_dir, exec, lctx->Rank(), &table);
 
-  SPDLOG_INFO("Run with config {}", hctx->rt_config().DebugString());
+  spu::device::pphlo::PPHloExecutor executor;
+  spu::device::execute(&executor, &hctx, exec, &table);
+}
 
-  for (int var_counter = 0; var_counter < exec.input_names_size();
-       ++var_counter) {
-    auto data_file =
-        core_dump_dir /
-        fmt::format("data_{}_{}.txt", hctx->lctx()->Rank(), var_counter);
+// Run with `config` and return the profile of this party.
+spu::ExecutionProfileProto Run(const std::filesystem::path &dump_dir,
+                               const spu::ExecutableProto &exec,
+                               spu::RuntimeConfig config,
+                               const std::string &label) {
+  const auto out_path = std::filesystem::path(OutDir.getValue()) / label;
+  config.set_pphlo_profile_dump_path(out_path.string());
+  if (FlameGraph.getValue()) {
+    config.set_enable_hal_profile(true);
+    config.set_chrome_trace_dump_path(out_path.string());
+  }
+  const auto network = MakeNetworkProfile();
+  SPDLOG_INFO("Run {} with config {}", label, config.DebugString());
 
-    YACL_ENFORCE(std::filesystem::exists(data_file),
-                 "Data file does not exist");
+  size_t rank = Rank.getValue();
+  if (Parties.getValue().empty()) {
+    rank = 0;
+    spu::mpc::util::simulate(
+        GetWorldSize(dump_dir, exec, config),
+        [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+          RunParty(dump_dir, exec, config, network, lctx);
+        });
+  } else {
+    RunParty(dump_dir, exec, config, network,
+             MakeLink(Parties.getValue(), rank));
+  }
 
-    std::ifstream stream(data_file, std::ios::binary);
+  const auto profile_file = fmt::format("{}.{}.pb", out_path.string(), rank);
+  std::ifstream stream(profile_file, std::ios::binary);
+  spu::ExecutionProfileProto profile;
+  YACL_ENFORCE(profile.ParseFromIstream(&stream), "Invalid profile {}",
+               profile_file);
+  return profile;
+}
 
-    spu::ValueProto vp;
-    YACL_ENFORCE(vp.ParseFromIstream(&stream));
-    auto v = spu::Value::fromProto(vp);
-    SPDLOG_INFO("Read input {} {} for processor {} from {}, v = {}",
-                var_counter, exec.input_names(var_counter),
-                hctx->lctx()->Rank(), data_file.c_str(), v);
-    table.setVar(exec.input_names(var_counter), v);
+} // namespace
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  const std::filesystem::path dump_dir = DumpDir.getValue();
+  std::filesystem::create_directories(OutDir.getValue());
+  const auto exec = ReadExecutable(dump_dir);
+
+  const auto profile = Run(dump_dir, exec, ParseConfig(Config.getValue()),
+                           "config");
+  std::cout << formatProfile(profile, TopOps.getValue());
+
+  if (!CompareConfig.getValue().empty()) {
+    const auto other = Run(dump_dir, exec,
+                           ParseConfig(CompareConfig.getValue()), "compare");
+    std::cout << "\n" << formatProfile(other, TopOps.getValue());
+    std::cout << "\nconfig vs compare\n"
+              << formatProfileDiff(profile, other, TopOps.getValue());
   }
-  spu::device::execute(&executor, exec, &table);
+  return 0;
 }
@@ -0,0 +1,228 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end benchmark of small models compiled to pphlo, on every protocol
+// and field. Besides the wall time of a run (the slowest party), it reports
+// the rounds and bytes sent by each party, and the peak rss of the process.
+//
+// Results of two commits are compared by the json outputs, e.g.
+//
+//   model_bench --benchmark_out=new.json --benchmark_out_format=json
+//   compare.py benchmarks old.json new.json
+//
+// where compare.py is the one shipped with google benchmark.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xrandom.hpp"
+
+#include "spu/device/api.h"
+#include "spu/device/executable_cache.h"
+#include "spu/device/pphlo/pphlo_executor.h"
+#include "spu/device/test_utils.h"
+#include "spu/kernel/context.h"
+#include "spu/mpc/util/communicator.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+struct Model {
+  std::string name;
+  std::vector<std::vector<size_t>> input_shapes;
+  std::string code;
+};
+
+// Logistic regression, 1024 samples of 16 features.
+const char *kLrCode = R"(
+func.func @main(%arg0: tensor<1024x16x!pphlo.sec<f32>>, %arg1: tensor<16x1x!pphlo.sec<f32>>) -> (tensor<1024x1x!pphlo.sec<f32>>) {
+  %0 = "pphlo.dot"(%arg0, %arg1) : (tensor<1024x16x!pphlo.sec<f32>>, tensor<16x1x!pphlo.sec<f32>>) -> tensor<1024x1x!pphlo.sec<f32>>
+  %1 = "pphlo.logistic"(%0) : (tensor<1024x1x!pphlo.sec<f32>>) -> tensor<1024x1x!pphlo.sec<f32>>
+  return %1 : tensor<1024x1x!pphlo.sec<f32>>
+})";
+
+// Two layer perceptron, 128 samples of 64 features, 32 hidden units.
+const char *kMlpCode = R"(
+func.func @main(%arg0: tensor<128x64x!pphlo.sec<f32>>, %arg1: tensor<64x32x!pphlo.sec<f32>>, %arg2: tensor<32x10x!pphlo.sec<f32>>) -> (tensor<128x10x!pphlo.sec<f32>>) {
+  %0 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<128x32xf32>} : () -> tensor<128x32x!pphlo.pub<f32>>
+  %1 = "pphlo.dot"(%arg0, %arg1) : (tensor<128x64x!pphlo.sec<f32>>, tensor<64x32x!pphlo.sec<f32>>) -> tensor<128x32x!pphlo.sec<f32>>
+  %2 = "pphlo.maximum"(%1, %0) : (tensor<128x32x!pphlo.sec<f32>>, tensor<128x32x!pphlo.pub<f32>>) -> tensor<128x32x!pphlo.sec<f32>>
+  %3 = "pphlo.dot"(%2, %arg2) : (tensor<128x32x!pphlo.sec<f32>>, tensor<32x10x!pphlo.sec<f32>>) -> tensor<128x10x!pphlo.sec<f32>>
+  return %3 : tensor<128x10x!pphlo.sec<f32>>
+})";
+
+// A convolution of 4 images, 8x8 outputs of a 3x3x3 kernel of 16 channels,
+// fed as im2col patches, then relu, mean pooling and a dense layer.
+const char *kCnnCode = R"(
+func.func @main(%arg0: tensor<256x27x!pphlo.sec<f32>>, %arg1: tensor<27x16x!pphlo.sec<f32>>, %arg2: tensor<16x10x!pphlo.sec<f32>>) -> (tensor<4x10x!pphlo.sec<f32>>) {
+  %0 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<256x16xf32>} : () -> tensor<256x16x!pphlo.pub<f32>>
+  %1 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+  %2 = "pphlo.constant"() {value = dense<1.562500e-02> : tensor<4x16xf32>} : () -> tensor<4x16x!pphlo.pub<f32>>
+  %3 = "pphlo.dot"(%arg0, %arg1) : (tensor<256x27x!pphlo.sec<f32>>, tensor<27x16x!pphlo.sec<f32>>) -> tensor<256x16x!pphlo.sec<f32>>
+  %4 = "pphlo.maximum"(%3, %0) : (tensor<256x16x!pphlo.sec<f32>>, tensor<256x16x!pphlo.pub<f32>>) -> tensor<256x16x!pphlo.sec<f32>>
+  %5 = "pphlo.reshape"(%4) : (tensor<256x16x!pphlo.sec<f32>>) -> tensor<4x64x16x!pphlo.sec<f32>>
+  %6 = "pphlo.reduce"(%5, %1) ({
+  ^bb0(%arg3: tensor<!pphlo.sec<f32>>, %arg4: tensor<!pphlo.sec<f32>>):
+    %9 = "pphlo.add"(%arg3, %arg4) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+    "pphlo.return"(%9) : (tensor<!pphlo.sec<f32>>) -> ()
+  }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<4x64x16x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<4x16x!pphlo.sec<f32>>
+  %7 = "pphlo.multiply"(%6, %2) : (tensor<4x16x!pphlo.sec<f32>>, tensor<4x16x!pphlo.pub<f32>>) -> tensor<4x16x!pphlo.sec<f32>>
+  %8 = "pphlo.dot"(%7, %arg2) : (tensor<4x16x!pphlo.sec<f32>>, tensor<16x10x!pphlo.sec<f32>>) -> tensor<4x10x!pphlo.sec<f32>>
+  return %8 : tensor<4x10x!pphlo.sec<f32>>
+})";
+
+// A single head transformer block, 32 tokens of 64 dims, 128 ffn units.
+const char *kTransformerCode = R"(
+func.func @main(%arg0: tensor<32x64x!pphlo.sec<f32>>, %arg1: tensor<64x64x!pphlo.sec<f32>>, %arg2: tensor<64x64x!pphlo.sec<f32>>, %arg3: tensor<64x64x!pphlo.sec<f32>>, %arg4: tensor<64x128x!pphlo.sec<f32>>, %arg5: tensor<128x64x!pphlo.sec<f32>>) -> (tensor<32x64x!pphlo.sec<f32>>) {
+  %0 = "pphlo.constant"() {value = dense<1.250000e-01> : tensor<32x32xf32>} : () -> tensor<32x32x!pphlo.pub<f32>>
+  %1 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<32x128xf32>} : () -> tensor<32x128x!pphlo.pub<f32>>
+  %2 = "pphlo.dot"(%arg0, %arg1) : (tensor<32x64x!pphlo.sec<f32>>, tensor<64x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %3 = "pphlo.dot"(%arg0, %arg2) : (tensor<32x64x!pphlo.sec<f32>>, tensor<64x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %4 = "pphlo.dot"(%arg0, %arg3) : (tensor<32x64x!pphlo.sec<f32>>, tensor<64x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %5 = "pphlo.transpose"(%3) {permutation = dense<[1, 0]> : tensor<2xi64>} : (tensor<32x64x!pphlo.sec<f32>>) -> tensor<64x32x!pphlo.sec<f32>>
+  %6 = "pphlo.dot"(%2, %5) : (tensor<32x64x!pphlo.sec<f32>>, tensor<64x32x!pphlo.sec<f32>>) -> tensor<32x32x!pphlo.sec<f32>>
+  %7 = "pphlo.multiply"(%6, %0) : (tensor<32x32x!pphlo.sec<f32>>, tensor<32x32x!pphlo.pub<f32>>) -> tensor<32x32x!pphlo.sec<f32>>
+  %8 = "pphlo.softmax"(%7) {axis = 1 : i64} : (tensor<32x32x!pphlo.sec<f32>>) -> tensor<32x32x!pphlo.sec<f32>>
+  %9 = "pphlo.dot"(%8, %4) : (tensor<32x32x!pphlo.sec<f32>>, tensor<32x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %10 = "pphlo.add"(%arg0, %9) : (tensor<32x64x!pphlo.sec<f32>>, tensor<32x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %11 = "pphlo.layer_norm"(%10) {axis = 1 : i64, epsilon = 1.000000e-03 : f64} : (tensor<32x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %12 = "pphlo.dot"(%11, %arg4) : (tensor<32x64x!pphlo.sec<f32>>, tensor<64x128x!pphlo.sec<f32>>) -> tensor<32x128x!pphlo.sec<f32>>
+  %13 = "pphlo.maximum"(%12, %1) : (tensor<32x128x!pphlo.sec<f32>>, tensor<32x128x!pphlo.pub<f32>>) -> tensor<32x128x!pphlo.sec<f32>>
+  %14 = "pphlo.dot"(%13, %arg5) : (tensor<32x128x!pphlo.sec<f32>>, tensor<128x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  %15 = "pphlo.add"(%11, %14) : (tensor<32x64x!pphlo.sec<f32>>, tensor<32x64x!pphlo.sec<f32>>) -> tensor<32x64x!pphlo.sec<f32>>
+  return %15 : tensor<32x64x!pphlo.sec<f32>>
+})";
+
+const std::vector<Model> &getModels() {
+  static const std::vector<Model> models = {
+      {"lr", {{1024, 16}, {16, 1}}, kLrCode},
+      {"mlp", {{128, 64}, {64, 32}, {32, 10}}, kMlpCode},
+      {"cnn", {{256, 27}, {27, 16}, {16, 10}}, kCnnCode},
+      {"transformer",
+       {{32, 64}, {64, 64}, {64, 64}, {64, 64}, {64, 128}, {128, 64}},
+       kTransformerCode},
+  };
+  return models;
+}
+
+// Peak resident set of the whole process in bytes. All parties run in this
+// process, so it bounds the peak of a single party from above.
+size_t getPeakRss() {
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+}
+
+void BM_Model(benchmark::State &state, const Model &model,
+              ProtocolKind protocol, FieldType field, size_t npc) {
+  RuntimeConfig config;
+  config.set_protocol(protocol);
+  config.set_field(field);
+
+  ExecutableProto executable;
+  executable.set_name(model.name);
+  executable.set_code(model.code);
+  LocalIo io(npc, config);
+  for (size_t idx = 0; idx < model.input_shapes.size(); idx++) {
+    const auto name = fmt::format("input{}", idx);
+    // keep the inputs small, softmax and layer_norm of big ones overflow.
+    xt::xarray<float> in =
+        xt::random::rand<float>(model.input_shapes[idx], -0.5, 0.5);
+    io.InFeed(name, in, VIS_SECRET);
+    executable.add_input_names(name);
+  }
+  executable.add_output_names("output");
+  const ParsedExecutable parsed(executable);
+
+  std::vector<mpc::Communicator::Stats> stats(npc);
+  std::vector<double> seconds(npc);
+  for (auto _ : state) {
+    try {
+      mpc::util::simulate(
+          npc, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+            const size_t rank = lctx->Rank();
+            HalContext hctx(config, lctx);
+            auto *comm = hctx.prot()->getState<mpc::Communicator>();
+            const auto begin_stats = comm->getStats();
+            const auto begin = std::chrono::steady_clock::now();
+
+            PPHloExecutor executor;
+            execute(&executor, &hctx, parsed, io.GetSymbolTable(rank));
+
+            seconds[rank] = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - begin)
+                                .count();
+            stats[rank] = comm->getStats() - begin_stats;
+          });
+    } catch (const std::exception &e) {
+      state.SkipWithError(e.what());
+      return;
+    }
+    // parties run in lock step, the run ends with the slowest one.
+    state.SetIterationTime(*std::max_element(seconds.begin(), seconds.end()));
+  }
+
+  for (size_t rank = 0; rank < npc; rank++) {
+    state.counters[fmt::format("rounds_p{}", rank)] =
+        static_cast<double>(stats[rank].latency);
+    state.counters[fmt::format("bytes_p{}", rank)] =
+        static_cast<double>(stats[rank].comm);
+  }
+  state.counters["peak_rss"] = static_cast<double>(getPeakRss());
+}
+
+void registerBenchmarks() {
+  const std::vector<std::pair<ProtocolKind, size_t>> protocols = {
+      {ProtocolKind::SEMI2K, 2},
+      {ProtocolKind::ABY3, 3},
+      {ProtocolKind::CHEETAH, 2},
+  };
+  for (const auto &model : getModels()) {
+    for (const auto &[protocol, npc] : protocols) {
+      for (auto field : {FieldType::FM64, FieldType::FM128}) {
+        benchmark::RegisterBenchmark(
+            fmt::format("BM_Model/{}/{}/{}", model.name,
+                        ProtocolKind_Name(protocol), FieldType_Name(field))
+                .c_str(),
+            BM_Model, model, protocol, field, npc)
+            ->UseManualTime()
+            ->Unit(benchmark::kMillisecond);
+      }
+    }
+  }
+}
+
+} // namespace
+} // namespace spu::device::pphlo
+
+int main(int argc, char **argv) {
+  // suppress all link logs.
+  spdlog::set_level(spdlog::level::off);
+
+  benchmark::Initialize(&argc, argv);
+  spu::device::pphlo::registerBenchmarks();
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
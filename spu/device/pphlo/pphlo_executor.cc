@@ -14,6 +14,11 @@
 
 #include "spu/device/pphlo/pphlo_executor.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <optional>
+
 #include "llvm/Support/raw_os_ostream.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Location.h"
@@ -30,6 +35,8 @@
 #include "spu/kernel/hlo/dynamic_slice.h"
 #include "spu/kernel/hlo/geometrical.h"
 #include "spu/kernel/hlo/indexing.h"
+#include "spu/kernel/hlo/join.h"
+#include "spu/kernel/hlo/normalization.h"
 #include "spu/kernel/hlo/rand.h"
 #include "spu/kernel/hlo/reduce.h"
 #include "spu/kernel/hlo/select_and_scatter.h"
@@ -131,47 +138,82 @@ spu::Visibility convertVisibility(mlir::pphlo::Visibility vis) {
 namespace spu::device::pphlo {
 namespace {
 
-const spu::Value &lookupValue(SymbolScope *scope, mlir::Value key,
-                              const ExecutionOptions &opts) {
-  const auto &val = scope->lookupValue(key);
+TypeSignature getTypeSignature(mlir::Type mlir_type) {
+  TypeSignature signature;
+  const auto mlir_shape =
+      mlir_type.dyn_cast<mlir::RankedTensorType>().getShape();
+  signature.shape.assign(mlir_shape.begin(), mlir_shape.end());
+  signature.dtype = getDtypeFromMlirType(mlir_type);
 
-  if (opts.do_type_check) {
-    const auto mlir_type = key.getType();
-    {
-      const auto &mlir_shape =
-          mlir_type.dyn_cast<mlir::RankedTensorType>().getShape();
-      const auto &spu_shape = val.shape();
-
-      YACL_ENFORCE(mlir_shape.size() == spu_shape.size(),
-                   "Runtime shape mismatch, expected={}, got={}",
-                   fmt::join(mlir_shape, "x"), fmt::join(spu_shape, "x"));
-
-      for (size_t idx = 0; idx < mlir_shape.size(); ++idx) {
-        YACL_ENFORCE(mlir_shape[idx] == spu_shape[idx],
-                     "Runtime shape mismatch at dim {}, expected={}, got={}",
-                     idx, fmt::join(mlir_shape, "x"),
-                     fmt::join(spu_shape, "x"));
-      }
+  mlir::pphlo::TypeTools tool;
+  if (tool.isMPCType<mlir::pphlo::PublicType>(mlir_type)) {
+    signature.vis = VIS_PUBLIC;
+  } else if (tool.isMPCType<mlir::pphlo::SecretType>(mlir_type)) {
+    signature.vis = VIS_SECRET;
+  }
+  return signature;
+}
+
+void checkTypeSignature(const TypeSignature &expected, const spu::Value &val) {
+  const auto &spu_shape = val.shape();
+  if (!std::equal(expected.shape.begin(), expected.shape.end(),
+                  spu_shape.begin(), spu_shape.end())) {
+    YACL_ENFORCE(expected.shape.size() == spu_shape.size(),
+                 "Runtime shape mismatch, expected={}, got={}",
+                 fmt::join(expected.shape, "x"), fmt::join(spu_shape, "x"));
+    for (size_t idx = 0; idx < expected.shape.size(); ++idx) {
+      YACL_ENFORCE(expected.shape[idx] == spu_shape[idx],
+                   "Runtime shape mismatch at dim {}, expected={}, got={}",
+                   idx, fmt::join(expected.shape, "x"),
+                   fmt::join(spu_shape, "x"));
     }
+  }
+
+  // Check dtype
+  YACL_ENFORCE(expected.dtype == val.dtype(), "Expected mlir_type {}, got {}",
+               expected.dtype, val.dtype());
 
-    // Check dtype
-    mlir::pphlo::TypeTools tool;
-    auto expectedType = getDtypeFromMlirType(mlir_type);
-    YACL_ENFORCE(expectedType == val.dtype(), "Expected mlir_type {}, got {}",
-                 expectedType, val.dtype());
-
-    // Check vtype
-    if (tool.isMPCType<mlir::pphlo::PublicType>(mlir_type)) {
-      YACL_ENFORCE(val.isPublic());
-    } else if (tool.isMPCType<mlir::pphlo::SecretType>(mlir_type)) {
-      YACL_ENFORCE(val.isSecret());
+  // Check vtype
+  if (expected.vis != VIS_INVALID) {
+    YACL_ENFORCE(expected.vis == val.vtype(), "Expected vtype {}, got {}",
+                 expected.vis, val.vtype());
+  }
+}
+
+spu::Value lookupValue(SymbolScope *scope, mlir::Value key,
+                       const ExecutionOptions &opts) {
+  auto val = scope->lookupValue(key);
+
+  if (opts.do_type_check) {
+    if (opts.type_cache != nullptr) {
+      checkTypeSignature(opts.type_cache->get(key, getTypeSignature), val);
     } else {
-      YACL_ENFORCE("Unknown vtype");
+      checkTypeSignature(getTypeSignature(key.getType()), val);
     }
   }
   return val;
 }
 
+// The result of an op could keep its truncation pending if the compiler
+// allows and all users handle pending truncation bits.
+bool canDeferTrunc(mlir::Operation *op) {
+  if (!op->hasAttr(mlir::pphlo::kLazyTruncAttrName) || op->use_empty()) {
+    return false;
+  }
+  return llvm::all_of(op->getUsers(), [](mlir::Operation *user) {
+    return mlir::isa<mlir::pphlo::AddOp, mlir::pphlo::SubtractOp,
+                     mlir::pphlo::SliceOp, mlir::pphlo::ReshapeOp>(user);
+  });
+}
+
+void addResult(HalContext *hctx, SymbolScope *sscope, mlir::Operation *op,
+               spu::Value ret) {
+  if (!canDeferTrunc(op)) {
+    ret = kernel::hlo::TruncPending(hctx, ret);
+  }
+  sscope->addValue(op->getResult(0), std::move(ret));
+}
+
 //
 #define STANDARD_UNARY_OP_EXEC_IMPL(OpName, KernelName)                        \
   void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,    \
@@ -208,15 +250,12 @@ STANDARD_UNARY_OP_EXEC_IMPL(RoundOp, Round_AFZ)
                                 lookupValue(sscope, op.rhs(), opts)));         \
   }
 
-STANDARD_BINARY_OP_EXEC_IMPL(AddOp, Add)
 STANDARD_BINARY_OP_EXEC_IMPL(EqualOp, Equal)
 STANDARD_BINARY_OP_EXEC_IMPL(NotEqualOp, NotEqual)
 STANDARD_BINARY_OP_EXEC_IMPL(LessEqualOp, LessEqual)
 STANDARD_BINARY_OP_EXEC_IMPL(GreaterEqualOp, GreaterEqual)
-STANDARD_BINARY_OP_EXEC_IMPL(SubtractOp, Sub)
 STANDARD_BINARY_OP_EXEC_IMPL(LessOp, Less)
 STANDARD_BINARY_OP_EXEC_IMPL(GreaterOp, Greater)
-STANDARD_BINARY_OP_EXEC_IMPL(MulOp, Mul)
 STANDARD_BINARY_OP_EXEC_IMPL(PowOp, Power)
 STANDARD_BINARY_OP_EXEC_IMPL(MaxOp, Max)
 STANDARD_BINARY_OP_EXEC_IMPL(MinOp, Min)
@@ -230,15 +269,37 @@ STANDARD_BINARY_OP_EXEC_IMPL(ShiftRightLogicalOp, Rshift)
 
 #undef STANDARD_BINARY_OP_EXEC_IMPL
 
+// Add and sub align pending truncation bits of operands.
+#define LAZY_TRUNC_BINARY_OP_EXEC_IMPL(OpName, KernelName, LazyKernelName)     \
+  void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,    \
+               mlir::pphlo::OpName &op, const ExecutionOptions &opts) {        \
+    const auto lhs = lookupValue(sscope, op.lhs(), opts);                      \
+    const auto rhs = lookupValue(sscope, op.rhs(), opts);                      \
+    addResult(hctx, sscope, op,                                                \
+              canDeferTrunc(op)                                                \
+                  ? kernel::hlo::LazyKernelName(hctx, lhs, rhs)                \
+                  : kernel::hlo::KernelName(hctx, lhs, rhs));                  \
+  }
+
+LAZY_TRUNC_BINARY_OP_EXEC_IMPL(AddOp, Add, Add)
+LAZY_TRUNC_BINARY_OP_EXEC_IMPL(SubtractOp, Sub, Sub)
+LAZY_TRUNC_BINARY_OP_EXEC_IMPL(MulOp, Mul, LazyMul)
+
+#undef LAZY_TRUNC_BINARY_OP_EXEC_IMPL
+
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::DotOp &op, const ExecutionOptions &opts) {
-  auto ret = kernel::hlo::Dot(hctx, lookupValue(sscope, op.lhs(), opts),
-                              lookupValue(sscope, op.rhs(), opts));
+  const auto lhs = lookupValue(sscope, op.lhs(), opts);
+  const auto rhs = lookupValue(sscope, op.rhs(), opts);
+  auto ret = canDeferTrunc(op) ? kernel::hlo::LazyDot(hctx, lhs, rhs)
+                               : kernel::hlo::Dot(hctx, lhs, rhs);
 
   const auto ret_shape =
       op.getResult().getType().dyn_cast<mlir::TensorType>().getShape();
 
-  sscope->addValue(op.getResult(), kernel::hlo::Reshape(hctx, ret, ret_shape));
+  addResult(hctx, sscope, op,
+            kernel::hlo::Reshape(hctx, ret, ret_shape)
+                .setPendingTruncBits(ret.pendingTruncBits()));
 }
 
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
@@ -259,39 +320,12 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
   auto lhs = lookupValue(sscope, op.lhs(), opts);
   auto rhs = lookupValue(sscope, op.rhs(), opts);
   YACL_ENFORCE(lhs.shape()[0] == rhs.shape()[0], "Batch dim should equal");
-  int64_t num_batch = lhs.shape()[0];
-
-  std::vector<spu::Value> results(num_batch);
-  std::vector<int64_t> lhs_slice_begin(3, 0);
-  std::vector<int64_t> lhs_slice_end = lhs.shape();
-  std::vector<int64_t> rhs_slice_begin(3, 0);
-  std::vector<int64_t> rhs_slice_end = rhs.shape();
-  std::vector<int64_t> strides(lhs.shape().size(), 1);
-
-  std::vector<int64_t> lhs_slice_shape{lhs.shape()[1], lhs.shape()[2]};
-  std::vector<int64_t> rhs_slice_shape{rhs.shape()[1], rhs.shape()[2]};
-  std::vector<int64_t> ret_slice_shape{1, lhs.shape()[1], rhs.shape()[2]};
-
-  for (int64_t batch_idx = 0; batch_idx < num_batch; ++batch_idx) {
-    lhs_slice_begin[0] = batch_idx;
-    lhs_slice_end[0] = batch_idx + 1;
-    rhs_slice_begin[0] = batch_idx;
-    rhs_slice_end[0] = batch_idx + 1;
-    auto lhs_slice = kernel::hlo::Reshape(
-        hctx,
-        kernel::hlo::Slice(hctx, lhs, lhs_slice_begin, lhs_slice_end, strides),
-        lhs_slice_shape);
-    auto rhs_slice = kernel::hlo::Reshape(
-        hctx,
-        kernel::hlo::Slice(hctx, rhs, rhs_slice_begin, rhs_slice_end, strides),
-        rhs_slice_shape);
-    results[batch_idx] = kernel::hlo::Reshape(
-        hctx, kernel::hlo::Dot(hctx, lhs_slice, rhs_slice), ret_slice_shape);
-  }
 
+  // the batch runs as one protocol invocation, which packs the small matmuls
+  // of protocols such as cheetah into shared ciphertexts.
   auto ret_type = op.getResult().getType().dyn_cast<mlir::RankedTensorType>();
-  auto ret = kernel::hlo::Reshape(
-      hctx, kernel::hlo::Concatenate(hctx, results, 0), ret_type.getShape());
+  auto ret = kernel::hlo::Reshape(hctx, kernel::hlo::BatchDot(hctx, lhs, rhs),
+                                  ret_type.getShape());
 
   sscope->addValue(op.getResult(), std::move(ret));
 }
@@ -349,15 +383,25 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
   // Basic idea here, get a ref slice and update the whole slice..
   // Start indicies
   std::vector<spu::Value> start_indicies(op.start_indices().size());
-  const auto &operand = lookupValue(sscope, op.operand(), opts);
+  auto operand = lookupValue(sscope, op.operand(), opts);
   const auto &update = lookupValue(sscope, op.update(), opts);
 
   for (const auto &idx : llvm::enumerate(op.start_indices())) {
     start_indicies[idx.index()] = lookupValue(sscope, idx.value(), opts);
   }
 
-  sscope->addValue(op.getResult(), kernel::hlo::DynamicUpdateSlice(
-                                       hctx, operand, update, start_indicies));
+  // The last use of a local operand is dropped from the scope, so its buffer
+  // could be updated in place, e.g. a loop carried buffer of one slice per
+  // iteration. The xla verifier looks up the operands after the op, so they
+  // are kept (and copied on write) when it is on.
+  if (op.operand().hasOneUse() &&
+      hctx->rt_config().xla_verifier_sample_rate() == 0) {
+    sscope->removeValue(op.operand());
+  }
+
+  sscope->addValue(op.getResult(),
+                   kernel::hlo::DynamicUpdateSlice(hctx, std::move(operand),
+                                                   update, start_indicies));
 }
 
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
@@ -405,6 +449,78 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
       kernel::hlo::Gather(hctx, operand, start_indicies, config, output_shape));
 }
 
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::ScatterAddOp &op, const ExecutionOptions &opts) {
+  auto operand = lookupValue(sscope, op.operand(), opts);
+  auto scatter_indices = lookupValue(sscope, op.scatter_indices(), opts);
+  auto updates = lookupValue(sscope, op.updates(), opts);
+
+  const auto &dim_numbers = op.scatter_dimension_numbers();
+
+  kernel::hlo::ScatterConfig config;
+  config.updateWindowDims = dim_numbers.getUpdateWindowDims();
+  config.insertedWindowDims = dim_numbers.getInsertedWindowDims();
+  config.scatterDimsToOperandDims = dim_numbers.getScatterDimsToOperandDims();
+  config.indexVectorDim = dim_numbers.getIndexVectorDim();
+
+  sscope->addValue(op.getResult(),
+                   kernel::hlo::ScatterAdd(hctx, operand, scatter_indices,
+                                           updates, config));
+}
+
+// Match reducer bodies of the form `return max/min/add(%arg0, %arg1)` of a
+// single operand, which have faster reductions than the generic tree.
+kernel::hlo::ReduceKind matchSimpleReducer(mlir::Region &body) {
+  auto &block = body.front();
+  if (block.getNumArguments() != 2 || block.getOperations().size() != 2) {
+    return kernel::hlo::ReduceKind::None;
+  }
+  auto &reduce = block.front();
+  auto ret = llvm::dyn_cast<mlir::pphlo::ReturnOp>(block.back());
+  if (!ret || ret->getNumOperands() != 1 ||
+      ret->getOperand(0) != reduce.getResult(0) ||
+      reduce.getNumOperands() != 2 ||
+      reduce.getOperand(0) != block.getArgument(0) ||
+      reduce.getOperand(1) != block.getArgument(1)) {
+    return kernel::hlo::ReduceKind::None;
+  }
+  if (llvm::isa<mlir::pphlo::MaxOp>(reduce)) {
+    return kernel::hlo::ReduceKind::Max;
+  }
+  if (llvm::isa<mlir::pphlo::MinOp>(reduce)) {
+    return kernel::hlo::ReduceKind::Min;
+  }
+  if (llvm::isa<mlir::pphlo::AddOp>(reduce)) {
+    return kernel::hlo::ReduceKind::Add;
+  }
+  return kernel::hlo::ReduceKind::None;
+}
+
+// Match comparators of the form `return less/greater(%arg0, %arg1)`, which
+// only compare the first operand and could be sorted without the region.
+std::optional<kernel::hlo::SortDirection>
+matchSimpleComparator(mlir::Region &comparator) {
+  auto &block = comparator.front();
+  if (block.getOperations().size() != 2 || block.getNumArguments() < 2) {
+    return std::nullopt;
+  }
+  auto &cmp = block.front();
+  auto ret = llvm::dyn_cast<mlir::pphlo::ReturnOp>(block.back());
+  if (!ret || ret->getNumOperands() != 1 ||
+      ret->getOperand(0) != cmp.getResult(0) || cmp.getNumOperands() != 2 ||
+      cmp.getOperand(0) != block.getArgument(0) ||
+      cmp.getOperand(1) != block.getArgument(1)) {
+    return std::nullopt;
+  }
+  if (llvm::isa<mlir::pphlo::LessOp>(cmp)) {
+    return kernel::hlo::SortDirection::Ascending;
+  }
+  if (llvm::isa<mlir::pphlo::GreaterOp>(cmp)) {
+    return kernel::hlo::SortDirection::Descending;
+  }
+  return std::nullopt;
+}
+
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::SortOp &op, const ExecutionOptions &opts) {
   auto sort_dim = op.dimension();
@@ -414,6 +530,14 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
     inputs[idx] = lookupValue(sscope, op->getOperand(idx), opts);
   }
 
+  if (auto direction = matchSimpleComparator(op.comparator())) {
+    auto ret = kernel::hlo::SimpleSort(hctx, inputs, sort_dim, *direction);
+    for (int64_t idx = 0; idx < op->getNumResults(); ++idx) {
+      sscope->addValue(op->getResult(idx), std::move(ret[idx]));
+    }
+    return;
+  }
+
   auto body_return =
       llvm::dyn_cast<mlir::pphlo::ReturnOp>(op.comparator().back().back());
   YACL_ENFORCE(body_return, "Cannot find body return");
@@ -550,14 +674,29 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
     inputs.emplace_back(lookupValue(sscope, operand, opts));
   }
 
+  // the scopes and block schedules are reused by all iterations.
+  SymbolScope cond_scope(sscope);
+  SymbolScope body_scope(sscope);
+  BlockScheduleCache local_cache;
+  ExecutionOptions loop_opts;
+  loop_opts.schedule_cache =
+      opts.schedule_cache != nullptr ? opts.schedule_cache : &local_cache;
+
   auto ret = kernel::hlo::While(
       hctx, inputs, //
       [&](absl::Span<const spu::Value> inputs) {
-        return runRegion(executor, hctx, sscope, op.cond(), inputs)[0];
+        auto c = runRegionInScope(executor, hctx, &cond_scope, op.cond(),
+                                  inputs, loop_opts)[0];
+        // drop the copies of the loop values before the body.
+        cond_scope.clear();
+        return c;
       },
-      [&](absl::Span<const spu::Value> inputs) {
-        return runRegion(executor, hctx, sscope, op.body(), inputs);
+      [&](std::vector<spu::Value> &&inputs) {
+        return runRegionInScope(executor, hctx, &body_scope, op.body(),
+                                std::move(inputs), loop_opts);
       });
+  cond_scope.clear();
+  body_scope.clear();
 
   for (size_t idx = 0; idx < op->getNumResults(); ++idx) {
     sscope->addValue(op->getResult(idx), std::move(ret[idx]));
@@ -636,10 +775,10 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::ReshapeOp &op, const ExecutionOptions &opts) {
   auto to_shape = op.getType().dyn_cast<mlir::RankedTensorType>().getShape();
-  sscope->addValue(
-      op.getResult(),
-      kernel::hlo::Reshape(hctx, lookupValue(sscope, op.getOperand(), opts),
-                           to_shape));
+  const auto in = lookupValue(sscope, op.getOperand(), opts);
+  addResult(hctx, sscope, op,
+            kernel::hlo::Reshape(hctx, in, to_shape)
+                .setPendingTruncBits(in.pendingTruncBits()));
 }
 
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
@@ -657,12 +796,13 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
 
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::SliceOp &op, const ExecutionOptions &opts) {
-  sscope->addValue(
-      op.getResult(),
-      kernel::hlo::Slice(hctx, lookupValue(sscope, op.getOperand(), opts),
-                         convertDenseIntElementAttr(op.start_indices()),
-                         convertDenseIntElementAttr(op.limit_indices()),
-                         convertDenseIntElementAttr(op.strides())));
+  const auto in = lookupValue(sscope, op.getOperand(), opts);
+  addResult(hctx, sscope, op,
+            kernel::hlo::Slice(hctx, in,
+                               convertDenseIntElementAttr(op.start_indices()),
+                               convertDenseIntElementAttr(op.limit_indices()),
+                               convertDenseIntElementAttr(op.strides()))
+                .setPendingTruncBits(in.pendingTruncBits()));
 }
 
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
@@ -716,7 +856,8 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
         operands.insert(operands.end(), lhs.begin(), lhs.end());
         operands.insert(operands.end(), rhs.begin(), rhs.end());
         return runRegion(executor, hctx, sscope, op.body(), operands);
-      });
+      },
+      matchSimpleReducer(op.body()));
 
   const auto &output_shape =
       op->getResultTypes()[0].dyn_cast<mlir::RankedTensorType>().getShape();
@@ -791,7 +932,8 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
         operands.insert(operands.end(), lhs.begin(), lhs.end());
         operands.insert(operands.end(), rhs.begin(), rhs.end());
         return runRegion(executor, hctx, sscope, op.body(), operands);
-      });
+      },
+      matchSimpleReducer(op.body()));
 
   for (int64_t idx = 0; idx < op->getNumResults(); ++idx) {
     sscope->addValue(op->getResults()[idx], std::move(rets[idx]));
@@ -854,6 +996,63 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
   sscope->addValue(op.getResult(1), ret.second);
 }
 
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::TopKOp &op, const ExecutionOptions &opts) {
+  auto [values, indices] = kernel::hlo::TopK(
+      hctx, lookupValue(sscope, op.operand(), opts), op.k());
+
+  auto indices_dtype = getDtypeFromMlirType(op.indices().getType());
+  if (indices.dtype() != indices_dtype) {
+    indices = kernel::hlo::Cast(hctx, indices, indices.vtype(), indices_dtype);
+  }
+
+  sscope->addValue(op.values(), std::move(values));
+  sscope->addValue(op.indices(), std::move(indices));
+}
+
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::JoinOp &op, const ExecutionOptions &opts) {
+  std::vector<spu::Value> inputs;
+  for (auto operand : op.inputs()) {
+    inputs.emplace_back(lookupValue(sscope, operand, opts));
+  }
+  const auto num_lhs = static_cast<size_t>(op.num_lhs_payloads()) + 1;
+  YACL_ENFORCE(num_lhs < inputs.size(), "expect keys of both tables");
+  auto lhs = absl::MakeSpan(inputs).subspan(0, num_lhs);
+  auto rhs = absl::MakeSpan(inputs).subspan(num_lhs);
+
+  auto results = kernel::hlo::Join(hctx, lhs, rhs);
+  YACL_ENFORCE(results.size() == op->getNumResults(),
+               "expect {} results, got {}", results.size(),
+               op->getNumResults());
+
+  auto &count = results.back();
+  auto count_dtype = getDtypeFromMlirType(op->getResults().back().getType());
+  if (count.dtype() != count_dtype) {
+    count = kernel::hlo::Cast(hctx, count, count.vtype(), count_dtype);
+  }
+
+  for (size_t idx = 0; idx < results.size(); ++idx) {
+    sscope->addValue(op->getResult(idx), std::move(results[idx]));
+  }
+}
+
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::SoftmaxOp &op, const ExecutionOptions &opts) {
+  sscope->addValue(op.getResult(),
+                   kernel::hlo::Softmax(hctx,
+                                        lookupValue(sscope, op.operand(), opts),
+                                        op.axis()));
+}
+
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::LayerNormOp &op, const ExecutionOptions &opts) {
+  sscope->addValue(
+      op.getResult(),
+      kernel::hlo::LayerNorm(hctx, lookupValue(sscope, op.operand(), opts),
+                             op.epsilon().convertToDouble(), op.axis()));
+}
+
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::SelectOp &op, const ExecutionOptions &opts) {
   auto pred = lookupValue(sscope, op.pred(), opts);
@@ -961,6 +1160,150 @@ DEFINE_UNIMPLEMENTED_OP(ReturnOp)
 
 #undef DEFINE_UNIMPLEMENTED_OP
 
+// Element-wise kernels, which could be evaluated on packed operands.
+using BatchableKernel =
+    std::function<spu::Value(HalContext *, absl::Span<spu::Value const>)>;
+
+#define BATCHABLE_UNARY_KERNEL(OpName, KernelName)                             \
+  {mlir::pphlo::OpName::getOperationName(),                                    \
+   [](HalContext *hctx, absl::Span<spu::Value const> ins) {                    \
+     return kernel::hlo::KernelName(hctx, ins[0]);                             \
+   }},
+
+#define BATCHABLE_BINARY_KERNEL(OpName, KernelName)                            \
+  {mlir::pphlo::OpName::getOperationName(),                                    \
+   [](HalContext *hctx, absl::Span<spu::Value const> ins) {                    \
+     return kernel::hlo::KernelName(hctx, ins[0], ins[1]);                     \
+   }},
+
+const std::map<llvm::StringRef, BatchableKernel> &getBatchableKernels() {
+  static const std::map<llvm::StringRef, BatchableKernel> kKernels = {
+      // Only kernels which cost communication are worth packing.
+      BATCHABLE_UNARY_KERNEL(ReciprocalOp, Reciprocal)     //
+      BATCHABLE_UNARY_KERNEL(ExpOp, Exp)                   //
+      BATCHABLE_UNARY_KERNEL(LogOp, Log)                   //
+      BATCHABLE_UNARY_KERNEL(LogisticOp, Logistic)         //
+      BATCHABLE_UNARY_KERNEL(TanhOp, Tanh)                 //
+      BATCHABLE_UNARY_KERNEL(RsqrtOp, Rsqrt)               //
+      BATCHABLE_UNARY_KERNEL(SqrtOp, Sqrt)                 //
+      BATCHABLE_UNARY_KERNEL(AbsOp, Abs)                   //
+      BATCHABLE_UNARY_KERNEL(SignOp, Sign)                 //
+      BATCHABLE_BINARY_KERNEL(MulOp, Mul)                  //
+      BATCHABLE_BINARY_KERNEL(DivOp, Div)                  //
+      BATCHABLE_BINARY_KERNEL(AndOp, And)                  //
+      BATCHABLE_BINARY_KERNEL(OrOp, Or)                    //
+      BATCHABLE_BINARY_KERNEL(EqualOp, Equal)              //
+      BATCHABLE_BINARY_KERNEL(NotEqualOp, NotEqual)        //
+      BATCHABLE_BINARY_KERNEL(LessOp, Less)                //
+      BATCHABLE_BINARY_KERNEL(LessEqualOp, LessEqual)      //
+      BATCHABLE_BINARY_KERNEL(GreaterOp, Greater)          //
+      BATCHABLE_BINARY_KERNEL(GreaterEqualOp, GreaterEqual) //
+      BATCHABLE_BINARY_KERNEL(MaxOp, Max)                  //
+      BATCHABLE_BINARY_KERNEL(MinOp, Min)                  //
+  };
+  return kKernels;
+}
+
+#undef BATCHABLE_BINARY_KERNEL
+#undef BATCHABLE_UNARY_KERNEL
+
+// A convert of a secret to a public value, e.g. of the outputs or conditions,
+// whose opening could be packed with other reveals.
+bool isReveal(mlir::Operation &op) {
+  auto convert = llvm::dyn_cast<mlir::pphlo::ConvertOp>(op);
+  if (!convert) {
+    return false;
+  }
+  mlir::pphlo::TypeTools tool;
+  return tool.isMPCType<mlir::pphlo::SecretType>(
+             convert.getOperand().getType()) &&
+         tool.isMPCType<mlir::pphlo::PublicType>(convert.getType());
+}
+
+// Run `fn` and record its time and communication to the profiler of `opts`,
+// if any, split evenly over `ops`, and the peak memory to each of `ops`.
+// Concurrent ops share the window of the tracker, so their peaks are upper
+// bounds.
+template <typename Fn>
+void runProfiled(HalContext *hctx, absl::Span<mlir::Operation *const> ops,
+                 const ExecutionOptions &opts, Fn &&fn) {
+  if (opts.profiler == nullptr) {
+    fn();
+    return;
+  }
+
+  const auto &lctx = hctx->lctx();
+  const size_t bytes_before = lctx ? lctx->GetStats()->sent_bytes : 0;
+  const size_t actions_before = lctx ? lctx->GetStats()->sent_actions : 0;
+  auto *tracker = hctx->memory_tracker();
+  if (tracker != nullptr) {
+    tracker->resetWindow();
+  }
+  const auto start = std::chrono::steady_clock::now();
+
+  fn();
+
+  const auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  const size_t bytes = lctx ? lctx->GetStats()->sent_bytes - bytes_before : 0;
+  const size_t actions =
+      lctx ? lctx->GetStats()->sent_actions - actions_before : 0;
+  const size_t peak_bytes =
+      tracker ? tracker->getStats().window_peak_bytes : 0;
+  for (auto *op : ops) {
+    opts.profiler->record(*op, time_ns / ops.size(), bytes / ops.size(),
+                          actions / ops.size(), peak_bytes);
+  }
+}
+
+// Run a group of same-kind element-wise ops with one kernel call.
+//
+// Operands at the same position are flattened and packed into one 1-D value,
+// the packed result is then split and reshaped back to each op.
+void executeBatched(HalContext *hctx, SymbolScope *sscope,
+                    const BatchableKernel &kernel,
+                    absl::Span<mlir::Operation *const> ops,
+                    absl::Span<std::vector<spu::Value> const> operands) {
+  const size_t num_args = operands.front().size();
+
+  std::vector<spu::Value> packed_args;
+  SimdTrait<ArrayRef>::PackInfo pi;
+  for (size_t arg_idx = 0; arg_idx < num_args; ++arg_idx) {
+    std::vector<ArrayRef> flattened;
+    flattened.reserve(ops.size());
+    for (const auto &args : operands) {
+      flattened.emplace_back(flatten(args[arg_idx].data()));
+    }
+
+    SimdTrait<ArrayRef>::PackInfo arg_pi;
+    auto packed =
+        SimdTrait<ArrayRef>::pack(flattened.begin(), flattened.end(), arg_pi);
+    const int64_t numel = packed.numel();
+    packed_args.emplace_back(unflatten(packed, {numel}),
+                             operands.front()[arg_idx].dtype());
+    pi = std::move(arg_pi);
+  }
+
+  spu::Value packed_ret;
+  {
+    const auto fn_name =
+        fmt::format("batched.{}", ops.front()->getName().getStringRef().str());
+    SPU_TRACE_ACTION(GET_CTX_NAME(hctx_), (TR_HLO | TR_LAR), ~TR_HLO, fn_name);
+    packed_ret = kernel(hctx, packed_args);
+  }
+
+  std::vector<ArrayRef> rets;
+  rets.reserve(ops.size());
+  SimdTrait<ArrayRef>::unpack(flatten(packed_ret.data()),
+                              std::back_inserter(rets), pi);
+  for (size_t idx = 0; idx < ops.size(); ++idx) {
+    sscope->addValue(ops[idx]->getResult(0),
+                     spu::Value(unflatten(rets[idx], operands[idx][0].shape()),
+                                packed_ret.dtype()));
+  }
+}
+
 } // namespace
 
 template <typename OpT, typename... MoreOpT>
@@ -986,7 +1329,8 @@ bool PPHloExecutor::hasKernel(mlir::Operation &op) const {
 template <typename OpT, typename... MoreOpT>
 static void dispatchOp(OpExecutor *executor, HalContext *hctx,
                        SymbolScope *sscope, mlir::Operation &op,
-                       const ExecutionOptions &opts) {
+                       const ExecutionOptions &opts,
+                       SampledXlaVerifier *verifier) {
   if (auto casted = llvm::dyn_cast<OpT>(op)) {
     // Execute op
     {
@@ -996,10 +1340,7 @@ static void dispatchOp(OpExecutor *executor, HalContext *hctx,
       execute(executor, hctx, sscope, casted, opts);
     }
 
-    // currently we only support config verifier statically.
-    constexpr bool kEnableXlaVerifier = false;
-    if (kEnableXlaVerifier) {
-      XlaVerifier verifier(hctx);
+    if (verifier != nullptr && verifier->sample()) {
       // handle mixed (int, fxp) multiplication
       if constexpr (std::is_same_v<OpT, mlir::pphlo::MulOp> or
                     std::is_same_v<OpT, mlir::pphlo::DotOp> or
@@ -1020,7 +1361,7 @@ static void dispatchOp(OpExecutor *executor, HalContext *hctx,
           rhs = kernel::hlo::Cast(hctx, rhs, rhs.vtype(), ret.dtype());
         }
 
-        verifier.verify(casted, {lhs, rhs}, {ret});
+        verifier->verify(casted, {lhs, rhs}, {ret});
       } else {
         // Collect inputs
         std::vector<spu::Value> ins;
@@ -1032,7 +1373,7 @@ static void dispatchOp(OpExecutor *executor, HalContext *hctx,
           outs.emplace_back(sscope->lookupValue(operand));
         }
 
-        verifier.verify(casted, ins, outs);
+        verifier->verify(casted, std::move(ins), std::move(outs));
       }
     }
   } else {
@@ -1040,7 +1381,7 @@ static void dispatchOp(OpExecutor *executor, HalContext *hctx,
       YACL_THROW("Unhandled mlir op {} at {}", mlirObjectToString(op),
                  mlirObjectToString(op.getLoc()));
     } else {
-      dispatchOp<MoreOpT...>(executor, hctx, sscope, op, opts);
+      dispatchOp<MoreOpT...>(executor, hctx, sscope, op, opts, verifier);
     }
   }
 }
@@ -1051,10 +1392,141 @@ void PPHloExecutor::runKernelImpl(HalContext *hctx, SymbolScope *sscope,
   if (opts.do_log_execution) {
     SPDLOG_INFO("PPHLO {}", mlirObjectToString(op));
   }
-  dispatchOp<
+  if (verifier_ == nullptr &&
+      hctx->rt_config().xla_verifier_sample_rate() != 0) {
+    YACL_ENFORCE(!hctx->rt_config().experimental_enable_inter_op_par(),
+                 "xla verifier samples ops by order, disable inter-op "
+                 "parallelism");
+    verifier_ = std::make_unique<SampledXlaVerifier>(hctx);
+  }
+  mlir::Operation *const ops[] = {&op};
+  runProfiled(hctx, ops, opts, [&]() {
+    dispatchOp<
 #define GET_OP_LIST
 #include "spu/dialect/pphlo_ops.cc.inc"
-      >(this, hctx, sscope, op, opts);
+        >(this, hctx, sscope, op, opts, verifier_.get());
+  });
+}
+
+// Reveal the operands of convert `ops` together, then cast to the result
+// dtypes.
+void executeReveals(HalContext *hctx, SymbolScope *sscope,
+                    absl::Span<mlir::Operation *const> ops,
+                    const ExecutionOptions &opts) {
+  std::vector<spu::Value> ins;
+  ins.reserve(ops.size());
+  for (auto *op : ops) {
+    ins.emplace_back(lookupValue(sscope, op->getOperand(0), opts));
+  }
+
+  std::vector<spu::Value> rets;
+  {
+    SPU_TRACE_ACTION(GET_CTX_NAME(hctx_), (TR_HLO | TR_LAR), ~TR_HLO,
+                     "batched.pphlo.convert");
+    rets = kernel::hlo::Reveal(hctx, ins);
+  }
+  for (size_t idx = 0; idx < ops.size(); ++idx) {
+    auto ret = ops[idx]->getResult(0);
+    auto dst_dtype = getDtypeFromMlirType(ret.getType());
+    sscope->addValue(ret,
+                     kernel::hlo::Cast(hctx, rets[idx], VIS_PUBLIC, dst_dtype));
+  }
+}
+
+bool PPHloExecutor::isCoalescable(mlir::Operation &op) const {
+  return isReveal(op);
+}
+
+void PPHloExecutor::runKernelsImpl(HalContext *hctx, SymbolScope *sscope,
+                                   absl::Span<mlir::Operation *const> ops,
+                                   const ExecutionOptions &opts) {
+  const auto &kernels = getBatchableKernels();
+
+  std::vector<mlir::Operation *> reveals;
+  for (auto *op : ops) {
+    if (isReveal(*op)) {
+      reveals.push_back(op);
+    }
+  }
+  if (reveals.size() > 1) {
+    if (opts.do_log_execution) {
+      for (auto *op : reveals) {
+        SPDLOG_INFO("PPHLO(batched) {}", mlirObjectToString(*op));
+      }
+    }
+    runProfiled(hctx, reveals, opts,
+                [&]() { executeReveals(hctx, sscope, reveals, opts); });
+  }
+
+  struct Batch {
+    const BatchableKernel *kernel = nullptr;
+    std::vector<mlir::Operation *> ops;
+    std::vector<std::vector<spu::Value>> operands;
+  };
+
+  // Group by op name and operands' runtime types, std::map keeps the groups in
+  // the same order on all parties.
+  std::map<std::string, Batch> batches;
+  for (auto *op : ops) {
+    if (reveals.size() > 1 && isReveal(*op)) {
+      continue;
+    }
+    const auto itr = kernels.find(op->getName().getStringRef());
+    // packing drops pending truncation bits.
+    if (itr == kernels.end() || canDeferTrunc(op)) {
+      runKernelImpl(hctx, sscope, *op, opts);
+      continue;
+    }
+
+    std::vector<spu::Value> args;
+    bool has_secret = false;
+    bool is_empty = false;
+    std::string key = op->getName().getStringRef().str();
+    for (auto operand : op->getOperands()) {
+      args.emplace_back(lookupValue(sscope, operand, opts));
+      has_secret |= args.back().isSecret();
+      is_empty |= args.back().numel() == 0;
+      key += fmt::format(":{}/{}", args.back().storage_type(),
+                         args.back().dtype());
+    }
+
+    if (!has_secret || is_empty) {
+      // nothing to save for local kernels.
+      runKernelImpl(hctx, sscope, *op, opts);
+      continue;
+    }
+
+    auto &batch = batches[key];
+    batch.kernel = &itr->second;
+    batch.ops.push_back(op);
+    batch.operands.emplace_back(std::move(args));
+  }
+
+  for (const auto &[key, batch] : batches) {
+    if (batch.ops.size() == 1) {
+      runKernelImpl(hctx, sscope, *batch.ops.front(), opts);
+      continue;
+    }
+    if (opts.do_log_execution) {
+      for (auto *op : batch.ops) {
+        SPDLOG_INFO("PPHLO(batched) {}", mlirObjectToString(*op));
+      }
+    }
+    runProfiled(hctx, batch.ops, opts, [&]() {
+      executeBatched(hctx, sscope, *batch.kernel, batch.ops, batch.operands);
+    });
+  }
+}
+
+void PPHloExecutor::finishExecution(HalContext *hctx) {
+  if (verifier_ == nullptr) {
+    return;
+  }
+  verifier_->flush();
+  SPDLOG_INFO("Xla verifier checked {} ops, {} mismatches",
+              verifier_->numVerified(), verifier_->numMismatches());
+  // sampled ops of the next execution start over.
+  verifier_.reset();
 }
 
 void PPHloExecutor::checkType(mlir::Type mlir_type, const spu::Value &v) const {
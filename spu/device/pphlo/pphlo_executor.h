@@ -26,6 +26,10 @@
 namespace spu::device::pphlo {
 
 class PPHloExecutor : public OpExecutor {
+private:
+  // of the running execution, when the xla verifier is enabled.
+  std::unique_ptr<SampledXlaVerifier> verifier_;
+
 public:
   void checkType(mlir::Type mlir_type, const spu::Value &v) const override;
 
@@ -35,6 +39,18 @@ public:
   // run a kernel in a given region.
   void runKernelImpl(HalContext *hcts, SymbolScope *sscope, mlir::Operation &op,
                      const ExecutionOptions &opts) override;
+
+  // reveals are coalesced, so consecutive ones are opened together.
+  bool isCoalescable(mlir::Operation &op) const override;
+
+  // run independent ops, same-kind element-wise ops on secret operands are
+  // packed into one kernel call, and reveals are opened together.
+  void runKernelsImpl(HalContext *hctx, SymbolScope *sscope,
+                      absl::Span<mlir::Operation *const> ops,
+                      const ExecutionOptions &opts) override;
+
+  // wait for the checks of the xla verifier.
+  void finishExecution(HalContext *hctx) override;
 };
 
 } // namespace spu::device::pphlo
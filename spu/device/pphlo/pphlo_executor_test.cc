@@ -53,8 +53,10 @@ public:
     executable_.add_input_names(name);
   }
 
-  std::string compileMHlo(const std::string &mhlo) {
+  std::string compileMHlo(const std::string &mhlo,
+                          bool emit_bytecode = false) {
     compiler::CompilationContext ctx;
+    ctx.setEmitBytecode(emit_bytecode);
     return compiler::compile(&ctx, mhlo, "mhlo");
   }
 
@@ -77,6 +79,37 @@ public:
         });
   }
 
+  // Run a cached executable `num_runs` times.
+  void runCached(const std::string &mlir, size_t num_runs,
+                 size_t num_output = 1) {
+    for (size_t idx = 0; idx < num_output; ++idx) {
+      executable_.add_output_names(fmt::format("output{}", idx));
+    }
+    executable_.set_code(mlir);
+    ::spu::mpc::util::simulate(
+        world_size_, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+          RuntimeConfig conf;
+          conf.CopyFrom(config_);
+          HalContext hctx(conf, lctx);
+          auto *env = io_->GetSymbolTable(lctx->Rank());
+
+          ExecutableCache cache;
+          const auto key = cache.load(executable_);
+          EXPECT_EQ(cache.load(executable_), key);
+          EXPECT_EQ(cache.size(), 1U);
+          EXPECT_EQ(cache.find(mlir), cache.get(key));
+
+          for (size_t run = 0; run < num_runs; ++run) {
+            pphlo::PPHloExecutor executor;
+            execute(&executor, &hctx, *cache.get(key), env);
+          }
+
+          EXPECT_TRUE(cache.unload(key));
+          EXPECT_FALSE(cache.unload(key));
+          EXPECT_EQ(cache.size(), 0U);
+        });
+  }
+
   template <typename T>
   void verifyOutput(const T *expected, size_t idx = 0) {
     const auto &out = io_->OutFeed(fmt::format("output{}", idx));
@@ -129,6 +162,58 @@ func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<!pphlo.pub<i32>>)
   r.verifyScalarOutput(3);
 }
 
+TEST_P(ExecutorTest, CachedExecutable) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(1);
+  r.addInput(2);
+
+  r.runCached(R"(
+func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<!pphlo.pub<i32>>) -> (tensor<!pphlo.pub<i32>>) {
+  %0 = "pphlo.add"(%arg0, %arg1) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+  return %0 : tensor<!pphlo.pub<i32>>
+})",
+              2);
+
+  r.verifyScalarOutput(3);
+}
+
+TEST_P(ExecutorTest, TypeCheckerMismatch) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  // a public input of a secret argument.
+  r.addInput(1, VIS_PUBLIC);
+  r.addInput(2, VIS_PUBLIC);
+
+  EXPECT_ANY_THROW(r.runCached(R"(
+func.func @main(%arg0: tensor<!pphlo.sec<i32>>, %arg1: tensor<!pphlo.pub<i32>>) -> (tensor<!pphlo.sec<i32>>) {
+  %0 = "pphlo.add"(%arg0, %arg1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.sec<i32>>
+  return %0 : tensor<!pphlo.sec<i32>>
+})",
+                               2));
+}
+
+TEST_P(ExecutorTest, Bytecode) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(xt::xarray<int>{1, 2, 3, 4});
+
+  auto code = r.compileMHlo(R"(
+func.func @main(%arg0: tensor<4xi32>) -> (tensor<4xi32>) {
+  %0 = mhlo.constant dense<[10, 20, 30, 40]> : tensor<4xi32>
+  %1 = mhlo.add %arg0, %0 : tensor<4xi32>
+  return %1 : tensor<4xi32>
+})",
+                            true);
+  // MLIR bytecode starts with "ML\xefR".
+  EXPECT_EQ(code.substr(0, 4), "ML\xefR");
+
+  r.run(code);
+
+  xt::xarray<int> expected = {11, 22, 33, 44};
+  r.verifyOutput(expected.data());
+}
+
 TEST_P(ExecutorTest, InvalidIR) {
   Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
            std::get<2>(GetParam()));
@@ -286,6 +371,35 @@ func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<!pphlo.pub<i32>>)
   r.verifyScalarOutput(3);
 }
 
+TEST_P(ExecutorTest, WhileCapturesOuterValues) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(0);
+  r.addInput(2, VIS_SECRET);
+
+  // scopes are reused across iterations, values of the parent stay visible.
+  // for (i = 0; i < 4; i++) { acc = acc + x }
+  r.run(R"(
+func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>> {
+  %0 = "pphlo.constant"() {value = dense<4> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+  %1 = "pphlo.convert"(%arg0) : (tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.sec<i32>>
+  %2, %3 = "pphlo.while"(%arg0, %1) ( {
+  ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<!pphlo.sec<i32>>):
+    %4 = "pphlo.less"(%arg2, %0) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+    "pphlo.return"(%4) : (tensor<!pphlo.pub<i1>>) -> ()
+  },  {
+  ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<!pphlo.sec<i32>>):
+    %4 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    %5 = "pphlo.add"(%arg2, %4) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+    %6 = "pphlo.add"(%arg3, %arg1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+    "pphlo.return"(%5, %6) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.sec<i32>>) -> ()
+  }) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.sec<i32>>) -> (tensor<!pphlo.pub<i32>>, tensor<!pphlo.sec<i32>>)
+  return %3 : tensor<!pphlo.sec<i32>>
+})");
+
+  r.verifyScalarOutput(8);
+}
+
 TEST_P(ExecutorTest, Reduce1D) {
   Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
            std::get<2>(GetParam()));
@@ -850,6 +964,26 @@ func.func @main(%arg0: tensor<3x3x2x!pphlo.pub<i32>>, %arg1: tensor<2x2x!pphlo.p
   r.verifyOutput(expected.data());
 }
 
+TEST_P(ExecutorTest, ScatterAdd) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+
+  r.addInput(xt::xarray<int>{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
+  // Scatter indices, the duplicated ones are summed.
+  r.addInput(xt::xarray<int>{2, 0, 2}, VIS_SECRET);
+  // Updates
+  r.addInput(xt::xarray<int>{{10, 20, 30}, {40, 50, 60}, {70, 80, 90}});
+
+  r.run(R"(
+func.func @main(%arg0: tensor<3x3x!pphlo.pub<i32>>, %arg1: tensor<3x!pphlo.sec<i32>>, %arg2: tensor<3x3x!pphlo.pub<i32>>) -> (tensor<3x3x!pphlo.sec<i32>>) {
+    %0 = "pphlo.scatter_add"(%arg0, %arg1, %arg2) {scatter_dimension_numbers = #pphlo.scatter<update_window_dims = [1], inserted_window_dims = [0], scatter_dims_to_operand_dims = [0], index_vector_dim = 1>, indices_are_sorted = false, unique_indices = false} : (tensor<3x3x!pphlo.pub<i32>>, tensor<3x!pphlo.sec<i32>>, tensor<3x3x!pphlo.pub<i32>>) -> tensor<3x3x!pphlo.sec<i32>>
+    return %0 : tensor<3x3x!pphlo.sec<i32>>
+})");
+
+  xt::xarray<int> expected = {{41, 52, 63}, {4, 5, 6}, {87, 108, 129}};
+  r.verifyOutput(expected.data());
+}
+
 TEST_P(ExecutorTest, Simple4x4Conv2DWith2x2Kernel) {
   Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
            std::get<2>(GetParam()));
@@ -1269,6 +1403,119 @@ func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>> {
   }
 }
 
+TEST_P(ExecutorTest, TopK) {
+  xt::xarray<float> op = {{2.0, 1.0, 3.0, -10.0, 11.0}, //
+                          {4.0, 3.0, 2.0, 1.0, 6.0}};
+
+  xt::xarray<float> expected_values = {{11.0, 3.0, 2.0}, //
+                                       {6.0, 4.0, 3.0}};
+  xt::xarray<int32_t> expected_indices = {{4, 2, 0}, //
+                                          {4, 0, 1}};
+
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(op, VIS_SECRET);
+  r.run(R"(
+func.func @main(%arg0: tensor<2x5x!pphlo.sec<f32>>) -> (tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<i32>>) {
+    %0:2 = "pphlo.top_k"(%arg0) {k = 3 : i64} : (tensor<2x5x!pphlo.sec<f32>>) -> (tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<i32>>)
+    return %0#0, %0#1 : tensor<2x3x!pphlo.sec<f32>>, tensor<2x3x!pphlo.sec<i32>>
+})",
+        2);
+
+  r.verifyOutput(expected_values.data(), 0);
+  r.verifyOutput(expected_indices.data(), 1);
+}
+
+TEST_P(ExecutorTest, Join) {
+  xt::xarray<int32_t> lhs_key = {7, 3, 9, 1, 5};
+  xt::xarray<float> lhs_value = {0.7, 0.3, 0.9, 0.1, 0.5};
+  xt::xarray<int32_t> rhs_key = {5, 2, 7, 4};
+  xt::xarray<int32_t> rhs_value = {50, 20, 70, 40};
+
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(lhs_key, VIS_SECRET);
+  r.addInput(lhs_value, VIS_SECRET);
+  r.addInput(rhs_key, VIS_SECRET);
+  r.addInput(rhs_value, VIS_SECRET);
+  r.run(R"(
+func.func @main(%arg0: tensor<5x!pphlo.sec<i32>>, %arg1: tensor<5x!pphlo.sec<f32>>, %arg2: tensor<4x!pphlo.sec<i32>>, %arg3: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) {
+    %0:4 = "pphlo.join"(%arg0, %arg1, %arg2, %arg3) {num_lhs_payloads = 1 : i64} : (tensor<5x!pphlo.sec<i32>>, tensor<5x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>)
+    return %0#0, %0#1, %0#2, %0#3 : tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>
+})",
+        4);
+
+  // rows beyond the count are unspecified.
+  r.verifyScalarOutput(static_cast<int32_t>(2), 3);
+}
+
+TEST_P(ExecutorTest, Softmax) {
+  xt::xarray<float> op = {{1.0, 2.0, 3.0, 4.0}, //
+                          {-1.5, 0.5, 2.0, -3.0}};
+
+  xt::xarray<float> e = xt::exp(op - xt::amax(op, {1}, xt::keep_dims));
+  xt::xarray<float> expected = e / xt::sum(e, {1}, xt::keep_dims);
+
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(op, VIS_SECRET);
+  r.run(R"(
+func.func @main(%arg0: tensor<2x4x!pphlo.sec<f32>>) -> (tensor<2x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.softmax"(%arg0) {axis = 1 : i64} : (tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    return %0 : tensor<2x4x!pphlo.sec<f32>>
+})");
+
+  r.verifyOutput(expected.data());
+}
+
+TEST_P(ExecutorTest, LayerNorm) {
+  xt::xarray<float> op = {{1.0, 2.0, 3.0, 4.0}, //
+                          {-1.5, 0.5, 2.0, -3.0}};
+
+  xt::xarray<float> xc = op - xt::mean(op, {1}, xt::keep_dims);
+  xt::xarray<float> var = xt::mean(xc * xc, {1}, xt::keep_dims);
+  xt::xarray<float> expected = xc / xt::sqrt(var + 0.001F);
+
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(op, VIS_SECRET);
+  r.run(R"(
+func.func @main(%arg0: tensor<2x4x!pphlo.sec<f32>>) -> (tensor<2x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.layer_norm"(%arg0) {axis = 1 : i64, epsilon = 1.000000e-03 : f64} : (tensor<2x4x!pphlo.sec<f32>>) -> tensor<2x4x!pphlo.sec<f32>>
+    return %0 : tensor<2x4x!pphlo.sec<f32>>
+})");
+
+  r.verifyOutput(expected.data());
+}
+
+TEST_P(ExecutorTest, LazyTruncation) {
+  xt::xarray<float> x = {1.5, -2.0, 0.25, 3.0};
+  xt::xarray<float> y = {2.0, 0.5, -4.0, 1.25};
+
+  xt::xarray<float> expected_sum = {2.0, 2.75};
+  xt::xarray<float> expected_neg = {-2.25, -4.0, -0.0625, -9.0};
+
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(x, VIS_SECRET);
+  r.addInput(y, VIS_SECRET);
+  // %4 is not handled by its user, so it's truncated anyway.
+  r.run(R"(
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.multiply"(%arg0, %arg1) {pphlo.lazy_trunc} : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %1 = "pphlo.slice"(%0) {limit_indices = dense<2> : tensor<1xi64>, start_indices = dense<0> : tensor<1xi64>, strides = dense<1> : tensor<1xi64>, pphlo.lazy_trunc} : (tensor<4x!pphlo.sec<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %2 = "pphlo.slice"(%0) {limit_indices = dense<4> : tensor<1xi64>, start_indices = dense<2> : tensor<1xi64>, strides = dense<1> : tensor<1xi64>} : (tensor<4x!pphlo.sec<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %3 = "pphlo.add"(%1, %2) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.sec<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %4 = "pphlo.multiply"(%arg0, %arg0) {pphlo.lazy_trunc} : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %5 = "pphlo.negate"(%4) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %3, %5 : tensor<2x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>
+})",
+        2);
+
+  r.verifyOutput(expected_sum.data(), 0);
+  r.verifyOutput(expected_neg.data(), 1);
+}
+
 TEST_P(ExecutorTest, Sort2DRow) {
   xt::xarray<float> op = {{2.0, 1.0, 3.0, -10.0, 11.0}, //
                           {4.0, 3.0, 2.0, 1.0, 6.0}};
@@ -1979,6 +2226,209 @@ func.func @main() -> (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i1>>) {
   }
 }
 
+TEST_P(ExecutorTest, InterOpParallel) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.getConfig().set_experimental_enable_inter_op_par(true);
+
+  r.addInput(2, VIS_SECRET);
+  r.addInput(3, VIS_SECRET);
+
+  r.run(R"(
+func.func @main(%arg0: tensor<!pphlo.sec<i32>>, %arg1: tensor<!pphlo.sec<i32>>) -> (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %1 = "pphlo.multiply"(%arg0, %arg0) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %2 = "pphlo.multiply"(%arg1, %arg1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %3 = "pphlo.add"(%0, %1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %4 = "pphlo.add"(%1, %2) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  return %3, %4 : tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>
+})",
+        2);
+
+  r.verifyScalarOutput(2 * 3 + 2 * 2, 0);
+  r.verifyScalarOutput(2 * 2 + 3 * 3, 1);
+}
+
+TEST_P(ExecutorTest, KernelBatching) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.getConfig().set_experimental_enable_kernel_batching(true);
+
+  const xt::xarray<int32_t> x = {1, 2, 3};
+  const xt::xarray<int32_t> y = {{4, 5}, {6, 7}};
+  r.addInput(x, VIS_SECRET);
+  r.addInput(y, VIS_SECRET);
+
+  r.run(R"(
+func.func @main(%arg0: tensor<3x!pphlo.sec<i32>>, %arg1: tensor<2x2x!pphlo.sec<i32>>) -> (tensor<3x!pphlo.sec<i32>>, tensor<2x2x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg0) : (tensor<3x!pphlo.sec<i32>>, tensor<3x!pphlo.sec<i32>>) -> tensor<3x!pphlo.sec<i32>>
+  %1 = "pphlo.multiply"(%arg1, %arg1) : (tensor<2x2x!pphlo.sec<i32>>, tensor<2x2x!pphlo.sec<i32>>) -> tensor<2x2x!pphlo.sec<i32>>
+  return %0, %1 : tensor<3x!pphlo.sec<i32>>, tensor<2x2x!pphlo.sec<i32>>
+})",
+        2);
+
+  const xt::xarray<int32_t> expected0 = x * x;
+  const xt::xarray<int32_t> expected1 = y * y;
+  r.verifyOutput(expected0.data(), 0);
+  r.verifyOutput(expected1.data(), 1);
+}
+
+TEST_P(ExecutorTest, RevealTogether) {
+  for (bool batching : {false, true}) {
+    Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+             std::get<2>(GetParam()));
+    r.getConfig().set_experimental_enable_kernel_batching(batching);
+
+    const xt::xarray<int32_t> x = {1, 2, 3};
+    const xt::xarray<int32_t> y = {{4, 5}, {6, 7}};
+    r.addInput(x, VIS_SECRET);
+    r.addInput(y, VIS_SECRET);
+
+    // the outputs are opened together, %2 also casts to fxp.
+    r.run(R"(
+func.func @main(%arg0: tensor<3x!pphlo.sec<i32>>, %arg1: tensor<2x2x!pphlo.sec<i32>>) -> (tensor<3x!pphlo.pub<i32>>, tensor<2x2x!pphlo.pub<i32>>, tensor<3x!pphlo.pub<f32>>) {
+  %0 = "pphlo.convert"(%arg0) : (tensor<3x!pphlo.sec<i32>>) -> tensor<3x!pphlo.pub<i32>>
+  %1 = "pphlo.convert"(%arg1) : (tensor<2x2x!pphlo.sec<i32>>) -> tensor<2x2x!pphlo.pub<i32>>
+  %2 = "pphlo.convert"(%arg0) : (tensor<3x!pphlo.sec<i32>>) -> tensor<3x!pphlo.pub<f32>>
+  return %0, %1, %2 : tensor<3x!pphlo.pub<i32>>, tensor<2x2x!pphlo.pub<i32>>, tensor<3x!pphlo.pub<f32>>
+})",
+          3);
+
+    const xt::xarray<float> expected2 = xt::cast<float>(x);
+    r.verifyOutput(x.data(), 0);
+    r.verifyOutput(y.data(), 1);
+    r.verifyOutput(expected2.data(), 2);
+  }
+}
+
+TEST_P(ExecutorTest, ReleaseDeadValues) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+
+  r.addInput(2, VIS_SECRET);
+  r.addInput(3, VIS_SECRET);
+
+  // %0 is used again after other values die, %2 is never used, %1 is
+  // returned.
+  r.run(R"(
+func.func @main(%arg0: tensor<!pphlo.sec<i32>>, %arg1: tensor<!pphlo.sec<i32>>) -> (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %1 = "pphlo.add"(%0, %arg0) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %2 = "pphlo.add"(%arg1, %arg1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %3 = "pphlo.multiply"(%1, %1) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  %4 = "pphlo.add"(%3, %0) : (tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<i32>>
+  return %4, %1 : tensor<!pphlo.sec<i32>>, tensor<!pphlo.sec<i32>>
+})",
+        2);
+
+  r.verifyScalarOutput((2 * 3 + 2) * (2 * 3 + 2) + 2 * 3, 0);
+  r.verifyScalarOutput(2 * 3 + 2, 1);
+}
+
+TEST_P(ExecutorTest, SpillValues) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  // spill all values large enough.
+  r.getConfig().set_experimental_spill_memory_cap(1);
+
+  const xt::xarray<int32_t> x = xt::arange<int32_t>(0, 1024);
+  const xt::xarray<int32_t> y = 3 * xt::ones<int32_t>({1024});
+  r.addInput(x, VIS_SECRET);
+  r.addInput(y, VIS_SECRET);
+
+  // %0 is spilled while %1 and %3 are computed, then read back.
+  r.run(R"(
+func.func @main(%arg0: tensor<1024x!pphlo.sec<i32>>, %arg1: tensor<1024x!pphlo.sec<i32>>) -> (tensor<1024x!pphlo.sec<i32>>, tensor<1024x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<1024x!pphlo.sec<i32>>, tensor<1024x!pphlo.sec<i32>>) -> tensor<1024x!pphlo.sec<i32>>
+  %1 = "pphlo.add"(%0, %arg0) : (tensor<1024x!pphlo.sec<i32>>, tensor<1024x!pphlo.sec<i32>>) -> tensor<1024x!pphlo.sec<i32>>
+  %2 = "pphlo.multiply"(%1, %1) : (tensor<1024x!pphlo.sec<i32>>, tensor<1024x!pphlo.sec<i32>>) -> tensor<1024x!pphlo.sec<i32>>
+  %3 = "pphlo.add"(%2, %0) : (tensor<1024x!pphlo.sec<i32>>, tensor<1024x!pphlo.sec<i32>>) -> tensor<1024x!pphlo.sec<i32>>
+  return %3, %1 : tensor<1024x!pphlo.sec<i32>>, tensor<1024x!pphlo.sec<i32>>
+})",
+        2);
+
+  const xt::xarray<int32_t> expected1 = x * y + x;
+  const xt::xarray<int32_t> expected0 = expected1 * expected1 + x * y;
+  r.verifyOutput(expected0.data(), 0);
+  r.verifyOutput(expected1.data(), 1);
+}
+
+TEST_P(ExecutorTest, SampledXlaVerifier) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  // checks run in background, outputs are not touched.
+  r.getConfig().set_xla_verifier_sample_rate(2);
+  r.getConfig().set_xla_verifier_async(true);
+
+  const xt::xarray<int32_t> x = {1, 2, 3, 4};
+  const xt::xarray<int32_t> y = {5, 6, 7, 8};
+  r.addInput(x, VIS_SECRET);
+  r.addInput(y, VIS_SECRET);
+
+  r.run(R"(
+func.func @main(%arg0: tensor<4x!pphlo.sec<i32>>, %arg1: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  %1 = "pphlo.add"(%0, %arg0) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  %2 = "pphlo.negate"(%1) : (tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  return %2 : tensor<4x!pphlo.sec<i32>>
+})");
+
+  const xt::xarray<int32_t> expected = -(x * y + x);
+  r.verifyOutput(expected.data());
+}
+
+TEST_P(ExecutorTest, SampledXlaVerifierDynamicUpdateSlice) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  // every op is checked, including the update of a single use operand.
+  r.getConfig().set_xla_verifier_sample_rate(1);
+
+  const xt::xarray<int32_t> x = {0, 1, 2, 3, 4};
+  const xt::xarray<int32_t> u = {5, 6};
+  r.addInput(x, VIS_SECRET);
+  r.addInput(u, VIS_SECRET);
+  r.addInput(2);
+
+  r.run(R"(
+func.func @main(%arg0: tensor<5x!pphlo.sec<i32>>, %arg1: tensor<2x!pphlo.sec<i32>>, %arg2: tensor<!pphlo.pub<i32>>) -> (tensor<5x!pphlo.sec<i32>>) {
+  %0 = "pphlo.add"(%arg0, %arg0) : (tensor<5x!pphlo.sec<i32>>, tensor<5x!pphlo.sec<i32>>) -> tensor<5x!pphlo.sec<i32>>
+  %1 = "pphlo.dynamic-update-slice"(%0, %arg1, %arg2) : (tensor<5x!pphlo.sec<i32>>, tensor<2x!pphlo.sec<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<5x!pphlo.sec<i32>>
+  return %1 : tensor<5x!pphlo.sec<i32>>
+})");
+
+  const xt::xarray<int32_t> expected = {0, 2, 5, 6, 8};
+  r.verifyOutput(expected.data());
+}
+
+TEST_P(ExecutorTest, ChunkRows) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  // 10 rows run by chunks of 4, 4 and 2 rows.
+  r.getConfig().set_experimental_chunk_rows(4);
+
+  const xt::xarray<int32_t> x = xt::arange<int32_t>(0, 20).reshape({10, 2});
+  const xt::xarray<int32_t> y = xt::arange<int32_t>(5, 25).reshape({10, 2});
+  r.addInput(x, VIS_SECRET);
+  r.addInput(y, VIS_PUBLIC);
+
+  // %0, %2 and %1 run by chunks, %2 stays inside the run, %1 is returned and
+  // used after it by the transpose.
+  r.run(R"(
+func.func @main(%arg0: tensor<10x2x!pphlo.sec<i32>>, %arg1: tensor<10x2x!pphlo.pub<i32>>) -> (tensor<10x2x!pphlo.sec<i32>>, tensor<2x10x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<10x2x!pphlo.sec<i32>>, tensor<10x2x!pphlo.pub<i32>>) -> tensor<10x2x!pphlo.sec<i32>>
+  %2 = "pphlo.multiply"(%0, %arg0) : (tensor<10x2x!pphlo.sec<i32>>, tensor<10x2x!pphlo.sec<i32>>) -> tensor<10x2x!pphlo.sec<i32>>
+  %1 = "pphlo.add"(%2, %arg0) : (tensor<10x2x!pphlo.sec<i32>>, tensor<10x2x!pphlo.sec<i32>>) -> tensor<10x2x!pphlo.sec<i32>>
+  %3 = "pphlo.transpose"(%1) {permutation = dense<[1, 0]> : tensor<2xi64>} : (tensor<10x2x!pphlo.sec<i32>>) -> tensor<2x10x!pphlo.sec<i32>>
+  return %1, %3 : tensor<10x2x!pphlo.sec<i32>>, tensor<2x10x!pphlo.sec<i32>>
+})",
+        2);
+
+  const xt::xarray<int32_t> expected0 = x * y * x + x;
+  const xt::xarray<int32_t> expected1 = xt::transpose(expected0);
+  r.verifyOutput(expected0.data(), 0);
+  r.verifyOutput(expected1.data(), 1);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ExecutorTestInstances, ExecutorTest,
     testing::Combine(testing::Values(4, 3, 2),
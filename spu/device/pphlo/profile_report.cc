@@ -0,0 +1,158 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/pphlo/profile_report.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+using OpKey = std::pair<std::string, std::string>;
+
+struct Totals {
+  uint64_t time_ns = 0;
+  uint64_t send_bytes = 0;
+  uint64_t send_actions = 0;
+};
+
+Totals getTotals(const ExecutionProfileProto &profile) {
+  Totals totals;
+  for (const auto &op : profile.ops()) {
+    totals.time_ns += op.time_ns();
+    totals.send_bytes += op.send_bytes();
+    totals.send_actions += op.send_actions();
+  }
+  return totals;
+}
+
+std::map<OpKey, const OpProfileProto *>
+indexOps(const ExecutionProfileProto &profile) {
+  std::map<OpKey, const OpProfileProto *> ops;
+  for (const auto &op : profile.ops()) {
+    ops[{op.location(), op.op_name()}] = &op;
+  }
+  return ops;
+}
+
+double toMs(uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+std::string formatTotals(const Totals &totals, size_t num_ops) {
+  return fmt::format("total {:.3f}ms, {} bytes sent, {} messages, {} ops\n",
+                     toMs(totals.time_ns), totals.send_bytes,
+                     totals.send_actions, num_ops);
+}
+
+} // namespace
+
+std::string formatProfile(const ExecutionProfileProto &profile,
+                          size_t max_ops) {
+  const auto totals = getTotals(profile);
+
+  std::vector<const OpProfileProto *> ops;
+  for (const auto &op : profile.ops()) {
+    ops.push_back(&op);
+  }
+  std::stable_sort(ops.begin(), ops.end(), [](const auto *a, const auto *b) {
+    return a->time_ns() > b->time_ns();
+  });
+
+  std::string out = formatTotals(totals, ops.size());
+  out += fmt::format("{:<24} {:<32} {:>8} {:>12} {:>7} {:>14} {:>8}\n", "op",
+                     "location", "count", "time(ms)", "share", "bytes",
+                     "msgs");
+  for (size_t idx = 0; idx < std::min(ops.size(), max_ops); idx++) {
+    const auto *op = ops[idx];
+    const double share =
+        totals.time_ns == 0 ? 0
+                            : 100.0 * static_cast<double>(op->time_ns()) /
+                                  static_cast<double>(totals.time_ns);
+    out += fmt::format("{:<24} {:<32} {:>8} {:>12.3f} {:>6.1f}% {:>14} {:>8}\n",
+                       op->op_name(), op->location(), op->count(),
+                       toMs(op->time_ns()), share, op->send_bytes(),
+                       op->send_actions());
+  }
+  return out;
+}
+
+std::string formatProfileDiff(const ExecutionProfileProto &lhs,
+                              const ExecutionProfileProto &rhs,
+                              size_t max_ops) {
+  const auto lhs_ops = indexOps(lhs);
+  const auto rhs_ops = indexOps(rhs);
+
+  std::vector<OpKey> keys;
+  for (const auto &[key, op] : lhs_ops) {
+    keys.push_back(key);
+  }
+  for (const auto &[key, op] : rhs_ops) {
+    if (lhs_ops.count(key) == 0) {
+      keys.push_back(key);
+    }
+  }
+
+  auto find = [](const std::map<OpKey, const OpProfileProto *> &ops,
+                 const OpKey &key) -> const OpProfileProto * {
+    auto iter = ops.find(key);
+    return iter == ops.end() ? nullptr : iter->second;
+  };
+  auto time_of = [](const OpProfileProto *op) -> uint64_t {
+    return op == nullptr ? 0 : op->time_ns();
+  };
+  std::stable_sort(keys.begin(), keys.end(), [&](const auto &a, const auto &b) {
+    return std::max(time_of(find(lhs_ops, a)), time_of(find(rhs_ops, a))) >
+           std::max(time_of(find(lhs_ops, b)), time_of(find(rhs_ops, b)));
+  });
+
+  auto time_str = [](const OpProfileProto *op) {
+    return op == nullptr ? std::string("-")
+                         : fmt::format("{:.3f}", toMs(op->time_ns()));
+  };
+  auto bytes_str = [](const OpProfileProto *op) {
+    return op == nullptr ? std::string("-")
+                         : std::to_string(op->send_bytes());
+  };
+  auto msgs_str = [](const OpProfileProto *op) {
+    return op == nullptr ? std::string("-")
+                         : std::to_string(op->send_actions());
+  };
+
+  std::string out = "lhs: " + formatTotals(getTotals(lhs), lhs_ops.size());
+  out += "rhs: " + formatTotals(getTotals(rhs), rhs_ops.size());
+  out += fmt::format(
+      "{:<24} {:<32} {:>12} {:>12} {:>8} {:>14} {:>14} {:>8} {:>8}\n", "op",
+      "location", "lhs(ms)", "rhs(ms)", "ratio", "lhs bytes", "rhs bytes",
+      "lhs msgs", "rhs msgs");
+  for (size_t idx = 0; idx < std::min(keys.size(), max_ops); idx++) {
+    const auto *l = find(lhs_ops, keys[idx]);
+    const auto *r = find(rhs_ops, keys[idx]);
+    std::string ratio = "-";
+    if (l != nullptr && r != nullptr && l->time_ns() != 0) {
+      ratio = fmt::format("{:.2f}x", static_cast<double>(r->time_ns()) /
+                                          static_cast<double>(l->time_ns()));
+    }
+    out += fmt::format(
+        "{:<24} {:<32} {:>12} {:>12} {:>8} {:>14} {:>14} {:>8} {:>8}\n",
+        keys[idx].second, keys[idx].first, time_str(l), time_str(r), ratio,
+        bytes_str(l), bytes_str(r), msgs_str(l), msgs_str(r));
+  }
+  return out;
+}
+
+} // namespace spu::device::pphlo
@@ -0,0 +1,41 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "spu/spu.pb.h"
+
+namespace spu::device::pphlo {
+
+/// A table of the ops of `profile` by time, the most expensive `max_ops`
+/// first, with the count, time, bytes sent and messages of each, and the
+/// totals of the run, e.g.
+///
+///   total 12.500ms, 3145728 bytes sent, 84 messages, 7 ops
+///   op               location          count   time(ms)  share  bytes  msgs
+///   pphlo.dot        loc("dot.3")          1      8.100  64.8%  ...
+std::string formatProfile(const ExecutionProfileProto &profile,
+                          size_t max_ops);
+
+/// A side by side table of the ops of two runs of one executable, e.g. of two
+/// runtime configs, matched by location and op name. The `max_ops` ops of the
+/// highest time of either run come first, ops missing in a run are `-`.
+std::string formatProfileDiff(const ExecutionProfileProto &lhs,
+                              const ExecutionProfileProto &rhs,
+                              size_t max_ops);
+
+} // namespace spu::device::pphlo
@@ -0,0 +1,82 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/pphlo/profile_report.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace spu::device::pphlo {
+namespace {
+
+void addOp(ExecutionProfileProto *profile, const std::string &location,
+           const std::string &op_name, uint64_t time_ns, uint64_t send_bytes) {
+  auto *op = profile->add_ops();
+  op->set_location(location);
+  op->set_op_name(op_name);
+  op->set_count(1);
+  op->set_time_ns(time_ns);
+  op->set_send_bytes(send_bytes);
+  op->set_send_actions(1);
+}
+
+std::vector<std::string> getRows(const std::string &report) {
+  std::vector<std::string> rows;
+  size_t begin = 0;
+  while (begin < report.size()) {
+    auto end = report.find('\n', begin);
+    rows.emplace_back(report.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return rows;
+}
+
+} // namespace
+
+TEST(ProfileReportTest, TopOpsByTime) {
+  ExecutionProfileProto profile;
+  addOp(&profile, "loc(\"a\")", "pphlo.add", 1000000, 8);
+  addOp(&profile, "loc(\"b\")", "pphlo.dot", 3000000, 64);
+  addOp(&profile, "loc(\"c\")", "pphlo.less", 2000000, 16);
+
+  auto rows = getRows(formatProfile(profile, 2));
+  // totals, header and the 2 slowest ops.
+  ASSERT_EQ(rows.size(), 4);
+  EXPECT_EQ(rows[0], "total 6.000ms, 88 bytes sent, 3 messages, 3 ops");
+  EXPECT_EQ(rows[2].rfind("pphlo.dot", 0), 0);
+  EXPECT_NE(rows[2].find("50.0%"), std::string::npos);
+  EXPECT_EQ(rows[3].rfind("pphlo.less", 0), 0);
+}
+
+TEST(ProfileReportTest, Diff) {
+  ExecutionProfileProto lhs;
+  addOp(&lhs, "loc(\"a\")", "pphlo.add", 1000000, 8);
+  addOp(&lhs, "loc(\"b\")", "pphlo.dot", 2000000, 64);
+  ExecutionProfileProto rhs;
+  addOp(&rhs, "loc(\"b\")", "pphlo.dot", 4000000, 64);
+  addOp(&rhs, "loc(\"c\")", "pphlo.less", 3000000, 16);
+
+  auto rows = getRows(formatProfileDiff(lhs, rhs, 10));
+  // 2 totals, header and the union of ops.
+  ASSERT_EQ(rows.size(), 6);
+  EXPECT_EQ(rows[3].rfind("pphlo.dot", 0), 0);
+  EXPECT_NE(rows[3].find("2.00x"), std::string::npos);
+  EXPECT_EQ(rows[4].rfind("pphlo.less", 0), 0);
+  EXPECT_EQ(rows[5].rfind("pphlo.add", 0), 0);
+  EXPECT_NE(rows[5].find(" - "), std::string::npos);
+}
+
+} // namespace spu::device::pphlo
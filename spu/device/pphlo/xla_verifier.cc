@@ -14,6 +14,8 @@
 
 #include "spu/device/pphlo/xla_verifier.h"
 
+#include <algorithm>
+
 #include "spdlog/spdlog.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/literal_util.h"
@@ -851,4 +853,96 @@ UNIMPL_VERIFIER(mlir::pphlo::ReduceWindowOp)
 
 UNIMPL_VERIFIER(mlir::pphlo::SortOp)
 
+SampledXlaVerifier::SampledXlaVerifier(HalContext *hctx)
+    : sample_rate_(std::max<size_t>(
+          hctx->rt_config().xla_verifier_sample_rate(), 1)),
+      verifier_(hctx) {
+  auto handler = [this](bool pass) { onVerified(pass); };
+  verifier_.setMismatchHandler(handler);
+  if (hctx->rt_config().xla_verifier_async()) {
+    worker_ctx_ = hctx->fork();
+    worker_verifier_ = std::make_unique<XlaVerifier>(worker_ctx_.get());
+    worker_verifier_->setMismatchHandler(handler);
+    worker_ = std::thread([this] { workerLoop(); });
+  }
+}
+
+SampledXlaVerifier::~SampledXlaVerifier() {
+  if (worker_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+      tasks_.clear();
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+}
+
+void SampledXlaVerifier::onVerified(bool pass) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++num_verified_;
+  if (!pass) {
+    ++num_mismatches_;
+    SPDLOG_WARN("Xla verifier found a mismatch, {} of {} checks failed",
+                num_mismatches_, num_verified_);
+  }
+}
+
+void SampledXlaVerifier::runChecked(const std::function<void()> &check) {
+  try {
+    check();
+  } catch (const std::exception &e) {
+    SPDLOG_WARN("Xla verifier skipped an op, {}", e.what());
+  }
+}
+
+void SampledXlaVerifier::enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.emplace_back(std::move(task));
+  }
+  cv_.notify_all();
+}
+
+void SampledXlaVerifier::workerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+      if (stop_) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      busy_ = true;
+    }
+    runChecked(task);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_ = false;
+    }
+    cv_.notify_all();
+  }
+}
+
+void SampledXlaVerifier::flush() {
+  if (!worker_.joinable()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] { return tasks_.empty() && !busy_; });
+}
+
+size_t SampledXlaVerifier::numVerified() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_verified_;
+}
+
+size_t SampledXlaVerifier::numMismatches() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_mismatches_;
+}
+
 } // namespace spu::device::pphlo
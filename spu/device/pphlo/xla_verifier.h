@@ -14,6 +14,14 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "spu/dialect/pphlo_dialect.h"
 #include "spu/dialect/pphlo_ops.h"
 #include "spu/dialect/pphlo_types.h"
@@ -137,10 +145,80 @@ public:
   NO_VERIFY_DEFN(RngOp)
   NO_VERIFY_DEFN(ConstantOp)
   NO_VERIFY_DEFN(MaxPoolScatterOp)
+  NO_VERIFY_DEFN(ScatterAddOp)
   NO_VERIFY_DEFN(PreferAOp)
   NO_VERIFY_DEFN(ArgMaxOp)
+  NO_VERIFY_DEFN(TopKOp)
+  NO_VERIFY_DEFN(JoinOp)
+  NO_VERIFY_DEFN(SoftmaxOp)
+  NO_VERIFY_DEFN(LayerNormOp)
 
 #undef NO_VERIFY_DEFN
 };
 
+// Verify sampled ops of an execution by XlaVerifier, one of every
+// `RuntimeConfig.xla_verifier_sample_rate` ops. Ops are sampled by their run
+// order, so all parties should run ops in the same order.
+//
+// With `RuntimeConfig.xla_verifier_async`, checks are queued to a background
+// thread, which reveals over a forked context, so the execution only pays the
+// bandwidth of the reveals. Mismatches are logged and counted.
+class SampledXlaVerifier {
+private:
+  size_t sample_rate_;
+  size_t num_ops_{0};
+  size_t num_verified_{0};
+  size_t num_mismatches_{0};
+
+  XlaVerifier verifier_;
+
+  // async mode only, the worker owns the forked context.
+  std::unique_ptr<HalContext> worker_ctx_;
+  std::unique_ptr<XlaVerifier> worker_verifier_;
+  std::deque<std::function<void()>> tasks_;
+  // guards the tasks and the counters.
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  bool busy_{false};
+  std::thread worker_;
+
+  void onVerified(bool pass);
+  // not all ops have a verifier, log the failed checks and keep going.
+  static void runChecked(const std::function<void()> &check);
+  void enqueue(std::function<void()> task);
+  void workerLoop();
+
+public:
+  explicit SampledXlaVerifier(HalContext *hctx);
+
+  SampledXlaVerifier(const SampledXlaVerifier &) = delete;
+  SampledXlaVerifier &operator=(const SampledXlaVerifier &) = delete;
+
+  // pending checks are dropped, call flush() first to wait for them.
+  ~SampledXlaVerifier();
+
+  // Whether to verify the next op, called once per op.
+  bool sample() { return num_ops_++ % sample_rate_ == 0; }
+
+  template <typename OpT>
+  void verify(OpT op, std::vector<spu::Value> operands,
+              std::vector<spu::Value> expected) {
+    if (!worker_) {
+      runChecked([&] { verifier_.verify(op, operands, expected); });
+      return;
+    }
+    enqueue([this, op, operands = std::move(operands),
+             expected = std::move(expected)]() mutable {
+      worker_verifier_->verify(op, operands, expected);
+    });
+  }
+
+  // Wait for the queued checks.
+  void flush();
+
+  size_t numVerified() const;
+  size_t numMismatches() const;
+};
+
 } // namespace spu::device::pphlo
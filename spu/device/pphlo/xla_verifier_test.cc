@@ -327,4 +327,48 @@ TEST(Verify, DynamicUpdateSlice) {
                            {xt::xarray<int32_t>{1, 1, 1, 1, 1}});
 }
 
+class SampledVerify : public ::testing::TestWithParam<bool> {};
+
+TEST_P(SampledVerify, Neg) {
+  RuntimeConfig conf;
+  conf.set_field(FM64);
+  conf.set_protocol(SEMI2K);
+  conf.set_xla_verifier_sample_rate(2);
+  conf.set_xla_verifier_async(GetParam());
+  LocalIo io(2, conf);
+  io.InFeed("in", xt::xarray<int32_t>{0, 1, 2}, VIS_SECRET);
+  io.InFeed("pout", xt::xarray<int32_t>{0, -1, -2}, VIS_SECRET);
+  io.InFeed("nout", xt::xarray<int32_t>{0, 1, 2}, VIS_SECRET);
+
+  ::spu::mpc::util::simulate(
+      2, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        HalContext hctx(conf, lctx);
+        SampledXlaVerifier verifier(&hctx);
+        auto *table = io.GetSymbolTable(lctx->Rank());
+        auto in = table->getVar("in");
+
+        // ops 0, 2 and 4 are sampled, the op 2 mismatches.
+        for (size_t idx = 0; idx < 6; ++idx) {
+          auto out = table->getVar(idx == 2 ? "nout" : "pout");
+          if (verifier.sample()) {
+            verifier.verify(mlir::pphlo::NegOp{}, {in}, {out});
+          }
+        }
+        // not all ops have a verifier, they are skipped.
+        if (verifier.sample()) {
+          verifier.verify(mlir::pphlo::SortOp{}, {in}, {in});
+        }
+        verifier.flush();
+
+        EXPECT_EQ(verifier.numVerified(), 3);
+        EXPECT_EQ(verifier.numMismatches(), 1);
+      });
+}
+
+INSTANTIATE_TEST_SUITE_P(SampledVerifyInstances, SampledVerify,
+                         testing::Values(false, true),
+                         [](const testing::TestParamInfo<bool> &p) {
+                           return p.param ? "Async" : "Sync";
+                         });
+
 } // namespace spu::device::pphlo
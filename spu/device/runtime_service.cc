@@ -0,0 +1,196 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/runtime_service.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "yacl/base/exception.h"
+
+#include "spu/device/api.h"
+#include "spu/device/pphlo/pphlo_executor.h"
+
+namespace spu::device {
+
+class RuntimeService::Session {
+  std::unique_ptr<HalContext> hctx_;
+  SymbolTable env_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopped_ = false;
+
+  // the last member, so it starts after and joins before the others.
+  std::thread worker_;
+
+  void loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [&] { return stopped_ || !tasks_.empty(); });
+        // pending tasks are done before stopping.
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+public:
+  explicit Session(std::unique_ptr<HalContext> hctx)
+      : hctx_(std::move(hctx)), worker_([this] { loop(); }) {}
+
+  ~Session() {
+    {
+      std::unique_lock lock(mutex_);
+      stopped_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+  }
+
+  Session(const Session &) = delete;
+  Session &operator=(const Session &) = delete;
+
+  // Queue `fn(hctx, env)` to the worker, errors are thrown by the future.
+  template <typename Fn>
+  auto submit(Fn &&fn) -> std::future<decltype(fn(nullptr, nullptr))> {
+    using Result = decltype(fn(nullptr, nullptr));
+
+    auto task = std::make_shared<std::packaged_task<Result()>>(
+        [this, fn = std::forward<Fn>(fn)]() mutable {
+          return fn(hctx_.get(), &env_);
+        });
+    auto future = task->get_future();
+    {
+      std::unique_lock lock(mutex_);
+      YACL_ENFORCE(!stopped_, "session is closed");
+      tasks_.emplace_back([task] { (*task)(); });
+    }
+    cv_.notify_one();
+    return future;
+  }
+};
+
+RuntimeService::RuntimeService(RuntimeConfig config,
+                               std::shared_ptr<yacl::link::Context> lctx)
+    : root_(std::make_unique<HalContext>(std::move(config), std::move(lctx))) {
+}
+
+RuntimeService::~RuntimeService() {
+  std::map<SessionId, std::shared_ptr<Session>> sessions;
+  {
+    std::unique_lock lock(mutex_);
+    sessions.swap(sessions_);
+  }
+  // sessions are joined out of the lock.
+  sessions.clear();
+}
+
+std::string RuntimeService::loadExecutable(const ExecutableProto &executable) {
+  return exec_cache_.load(executable);
+}
+
+bool RuntimeService::unloadExecutable(const std::string &key) {
+  return exec_cache_.unload(key);
+}
+
+std::shared_ptr<const ParsedExecutable>
+RuntimeService::getExecutable(const std::string &key) const {
+  return exec_cache_.get(key);
+}
+
+RuntimeService::SessionId RuntimeService::openSession() {
+  std::unique_lock lock(mutex_);
+  // fork in the order of ids, which is the same for all parties.
+  const SessionId id = next_id_++;
+  sessions_.emplace(id, std::make_shared<Session>(root_->fork()));
+  return id;
+}
+
+void RuntimeService::closeSession(SessionId id) {
+  std::shared_ptr<Session> session;
+  {
+    std::unique_lock lock(mutex_);
+    auto itr = sessions_.find(id);
+    YACL_ENFORCE(itr != sessions_.end(), "session {} not found", id);
+    session = std::move(itr->second);
+    sessions_.erase(itr);
+  }
+  // joined here unless a submitting thread still holds it.
+  session.reset();
+}
+
+size_t RuntimeService::numSessions() const {
+  std::unique_lock lock(mutex_);
+  return sessions_.size();
+}
+
+std::shared_ptr<RuntimeService::Session>
+RuntimeService::getSession(SessionId id) const {
+  std::unique_lock lock(mutex_);
+  auto itr = sessions_.find(id);
+  YACL_ENFORCE(itr != sessions_.end(), "session {} not found", id);
+  return itr->second;
+}
+
+std::future<void> RuntimeService::setVar(SessionId id, const std::string &name,
+                                         spu::Value value) {
+  return getSession(id)->submit(
+      [name, value = std::move(value)](HalContext *, SymbolTable *env) {
+        env->setVar(name, value);
+      });
+}
+
+std::future<spu::Value> RuntimeService::getVar(SessionId id,
+                                               const std::string &name) {
+  return getSession(id)->submit([name](HalContext *, SymbolTable *env) {
+    return env->getVar(name);
+  });
+}
+
+std::future<void> RuntimeService::delVar(SessionId id,
+                                         const std::string &name) {
+  return getSession(id)->submit(
+      [name](HalContext *, SymbolTable *env) { env->delVar(name); });
+}
+
+std::future<void> RuntimeService::run(SessionId id, const std::string &key) {
+  // hold the executable from now on, so an unload does not drop it.
+  auto parsed = exec_cache_.get(key);
+  YACL_ENFORCE(parsed != nullptr, "executable {} is not loaded", key);
+
+  return getSession(id)->submit(
+      [parsed = std::move(parsed)](HalContext *hctx, SymbolTable *env) {
+        pphlo::PPHloExecutor executor;
+        execute(&executor, hctx, *parsed, env);
+      });
+}
+
+std::future<void>
+RuntimeService::post(SessionId id,
+                     std::function<void(HalContext *, SymbolTable *)> fn) {
+  return getSession(id)->submit(std::move(fn));
+}
+
+} // namespace spu::device
@@ -0,0 +1,110 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "yacl/link/link.h"
+
+#include "spu/device/executable_cache.h"
+#include "spu/device/symbol_table.h"
+#include "spu/kernel/context.h"
+#include "spu/kernel/value.h"
+
+#include "spu/spu.pb.h"
+
+namespace spu::device {
+
+/// A long lived runtime of one party, which runs many sessions concurrently.
+///
+/// Every session owns a context forked from the root one, i.e. a spawned link
+/// and an independent protocol instance, a symbol table, and a worker thread
+/// which runs the tasks of the session in the order they are submitted.
+/// Sessions run in parallel with each other, and share the loaded executables
+/// and the buffer pool of the root context.
+///
+/// Protocol states like beaver triples are kept per session, since the
+/// parties of a session should consume them in the same order, which is not
+/// guaranteed across concurrent sessions.
+///
+/// Note: all parties should open sessions in the same order, so that the i-th
+/// session of every party gets the same id and links with each other.
+class RuntimeService {
+public:
+  using SessionId = uint64_t;
+
+private:
+  class Session;
+
+  std::unique_ptr<HalContext> root_;
+
+  ExecutableCache exec_cache_;
+
+  mutable std::mutex mutex_;
+  SessionId next_id_ = 0;
+  std::map<SessionId, std::shared_ptr<Session>> sessions_;
+
+  std::shared_ptr<Session> getSession(SessionId id) const;
+
+public:
+  explicit RuntimeService(RuntimeConfig config,
+                          std::shared_ptr<yacl::link::Context> lctx);
+
+  /// Close all sessions, pending tasks of them are done before.
+  ~RuntimeService();
+
+  RuntimeService(const RuntimeService &) = delete;
+  RuntimeService &operator=(const RuntimeService &) = delete;
+
+  /// Parse `executable` once for all sessions, return the key to run it by.
+  std::string loadExecutable(const ExecutableProto &executable);
+
+  /// Return false if `key` is not loaded, running sessions keep the
+  /// executable until they are done.
+  bool unloadExecutable(const std::string &key);
+
+  /// The loaded executable of `key`, or null.
+  std::shared_ptr<const ParsedExecutable>
+  getExecutable(const std::string &key) const;
+
+  SessionId openSession();
+
+  /// Wait for the submitted tasks of the session, and release it.
+  void closeSession(SessionId id);
+
+  size_t numSessions() const;
+
+  /// Tasks of a session, they are queued after the submitted ones.
+  std::future<void> setVar(SessionId id, const std::string &name,
+                           spu::Value value);
+  std::future<spu::Value> getVar(SessionId id, const std::string &name);
+  std::future<void> delVar(SessionId id, const std::string &name);
+
+  /// Run the loaded executable of `key` with the symbols of the session.
+  std::future<void> run(SessionId id, const std::string &key);
+
+  /// Run `fn` with the context and symbols of the session, for tasks other
+  /// than the ones above, e.g. to batch the inputs of a run.
+  std::future<void> post(SessionId id,
+                         std::function<void(HalContext *, SymbolTable *)> fn);
+};
+
+} // namespace spu::device
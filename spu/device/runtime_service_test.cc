@@ -0,0 +1,153 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/runtime_service.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+
+#include "spu/device/io.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::device {
+namespace {
+
+constexpr char kCode[] = R"(
+func.func @main(%arg0: tensor<4x!pphlo.sec<i32>>, %arg1: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+  return %0 : tensor<4x!pphlo.sec<i32>>
+})";
+
+ExecutableProto makeExecutable() {
+  ExecutableProto exec;
+  exec.set_name("mul");
+  exec.add_input_names("x");
+  exec.add_input_names("y");
+  exec.add_output_names("z");
+  exec.set_code(kCode);
+  return exec;
+}
+
+class RuntimeServiceTest
+    : public ::testing::TestWithParam<std::tuple<size_t, ProtocolKind>> {};
+
+TEST_P(RuntimeServiceTest, ConcurrentSessions) {
+  const size_t kWorldSize = std::get<0>(GetParam());
+  const size_t kNumSessions = 4;
+  const size_t kNumRuns = 3;
+
+  RuntimeConfig conf;
+  conf.set_protocol(std::get<1>(GetParam()));
+  conf.set_field(FieldType::FM64);
+  IoClient io(kWorldSize, conf);
+
+  // session s multiplies {s, s + 1, ...} and {1, 2, 3, 4} kNumRuns times.
+  std::vector<std::vector<spu::Value>> xs;
+  const auto ys = io.makeShares(xt::xarray<int>{1, 2, 3, 4}, VIS_SECRET);
+  for (size_t s = 0; s < kNumSessions; s++) {
+    const int v = static_cast<int>(s);
+    xs.push_back(io.makeShares(xt::xarray<int>{v, v + 1, v + 2, v + 3},
+                               VIS_SECRET));
+  }
+
+  // outputs[s][rank]
+  std::vector<std::vector<spu::Value>> outputs(
+      kNumSessions, std::vector<spu::Value>(kWorldSize));
+  mpc::util::simulate(
+      kWorldSize, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+        const size_t rank = lctx->Rank();
+        RuntimeService service(conf, lctx);
+        const auto key = service.loadExecutable(makeExecutable());
+
+        std::vector<RuntimeService::SessionId> ids;
+        for (size_t s = 0; s < kNumSessions; s++) {
+          ids.push_back(service.openSession());
+        }
+        EXPECT_EQ(service.numSessions(), kNumSessions);
+
+        // queue all runs first, so sessions run concurrently.
+        std::vector<std::future<void>> runs;
+        for (size_t s = 0; s < kNumSessions; s++) {
+          runs.push_back(service.setVar(ids[s], "x", xs[s][rank]));
+          runs.push_back(service.setVar(ids[s], "y", ys[rank]));
+        }
+        for (size_t run = 0; run < kNumRuns; run++) {
+          for (size_t s = 0; s < kNumSessions; s++) {
+            runs.push_back(service.run(ids[s], key));
+          }
+        }
+        std::vector<std::future<spu::Value>> results;
+        for (size_t s = 0; s < kNumSessions; s++) {
+          results.push_back(service.getVar(ids[s], "z"));
+        }
+
+        for (auto &f : runs) {
+          f.get();
+        }
+        for (size_t s = 0; s < kNumSessions; s++) {
+          outputs[s][rank] = results[s].get();
+        }
+
+        EXPECT_TRUE(service.unloadExecutable(key));
+        EXPECT_THROW(service.run(ids[0], key), yacl::EnforceNotMet);
+
+        service.closeSession(ids[0]);
+        EXPECT_EQ(service.numSessions(), kNumSessions - 1);
+        EXPECT_THROW(service.getVar(ids[0], "z"), yacl::EnforceNotMet);
+      });
+
+  for (size_t s = 0; s < kNumSessions; s++) {
+    const int v = static_cast<int>(s);
+    xt::xarray<int> expected = {v * 1, (v + 1) * 2, (v + 2) * 3, (v + 3) * 4};
+    EXPECT_EQ(xt_adapt<int>(io.combineShares(outputs[s])), expected);
+  }
+}
+
+TEST(RuntimeServiceErrorTest, RunError) {
+  RuntimeConfig conf;
+  conf.set_protocol(ProtocolKind::REF2K);
+  conf.set_field(FieldType::FM64);
+
+  mpc::util::simulate(1, [&](const std::shared_ptr<yacl::link::Context> &lctx) {
+    RuntimeService service(conf, lctx);
+    const auto key = service.loadExecutable(makeExecutable());
+    const auto id = service.openSession();
+
+    // inputs are not set, the error is thrown by the future.
+    auto run = service.run(id, key);
+    EXPECT_THROW(run.get(), yacl::Exception);
+
+    // the session is still usable.
+    IoClient io(1, conf);
+    auto x = io.makeShares(xt::xarray<int>{1, 2, 3, 4}, VIS_SECRET);
+    service.setVar(id, "x", x[0]).get();
+    service.setVar(id, "y", x[0]).get();
+    service.run(id, key).get();
+
+    xt::xarray<int> expected = {1, 4, 9, 16};
+    EXPECT_EQ(xt_adapt<int>(io.combineShares({service.getVar(id, "z").get()})),
+              expected);
+  });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    RuntimeServiceTestInstance, RuntimeServiceTest,
+    testing::Values(std::make_tuple(size_t{2}, ProtocolKind::SEMI2K),
+                    std::make_tuple(size_t{3}, ProtocolKind::ABY3)),
+    [](const testing::TestParamInfo<RuntimeServiceTest::ParamType> &p) {
+      return fmt::format("{}x{}", std::get<0>(p.param), std::get<1>(p.param));
+    });
+
+} // namespace
+} // namespace spu::device
@@ -0,0 +1,82 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/spill.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "yacl/base/exception.h"
+
+namespace spu::device {
+namespace {
+
+void writeAll(int fd, const std::byte *data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = ::write(fd, data, size);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    YACL_ENFORCE(written > 0, "failed to write spill file, {}",
+                 std::strerror(errno));
+    data += written;
+    size -= written;
+  }
+}
+
+} // namespace
+
+spu::Value spillValue(const spu::Value &val, const std::string &dir) {
+  const auto &arr = val.data();
+  const auto buf = arr.buf();
+  const size_t size = buf->size();
+  if (size == 0) {
+    return val;
+  }
+
+  std::string path = dir + "/spu_spill_XXXXXX";
+  std::vector<char> name(path.begin(), path.end());
+  name.push_back('\0');
+  const int fd = ::mkstemp(name.data());
+  YACL_ENFORCE(fd >= 0, "failed to create spill file under {}, {}", dir,
+               std::strerror(errno));
+  // the file lives as long as it's opened or mapped.
+  ::unlink(name.data());
+
+  void *ptr = MAP_FAILED;
+  try {
+    writeAll(fd, buf->data<std::byte>(), size);
+    ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  YACL_ENFORCE(ptr != MAP_FAILED, "failed to map spill file, {}",
+               std::strerror(errno));
+
+  auto mapped = std::make_shared<yacl::Buffer>(
+      ptr, size, [size](void *p) { ::munmap(p, size); });
+  spu::Value res = val;
+  res.data() = NdArrayRef(std::move(mapped), arr.eltype(), arr.shape(),
+                          arr.strides(), arr.offset());
+  return res;
+}
+
+} // namespace spu::device
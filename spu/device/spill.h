@@ -0,0 +1,35 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+#include "spu/kernel/value.h"
+
+namespace spu::device {
+
+// Buffers smaller than this are not worth a file.
+constexpr size_t kMinSpillBytes = 4096;
+
+// Copy the buffer of `val` to an unlinked file under `dir`, and return the
+// same value viewing a private mapping of the file.
+//
+// The mapped pages are backed by the file, the OS reads them back on access
+// and could drop them under memory pressure, so the heap buffer of `val`
+// is freed once it's released by others. The file is removed with the
+// mapping.
+spu::Value spillValue(const spu::Value &val, const std::string &dir);
+
+} // namespace spu::device
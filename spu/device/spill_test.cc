@@ -0,0 +1,69 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/spill.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+#include "spu/mpc/util/ring_ops.h"
+
+namespace spu::device {
+
+TEST(SpillTest, Works) {
+  const auto dir = std::filesystem::temp_directory_path().string();
+  const auto arr = mpc::ring_rand(FieldType::FM64, 100 * 100);
+  const spu::Value val(unflatten(arr, {100, 100}), DT_I64);
+
+  const auto spilled = spillValue(val, dir);
+  EXPECT_NE(spilled.data().buf(), val.data().buf());
+  EXPECT_EQ(spilled.shape(), val.shape());
+  EXPECT_EQ(spilled.strides(), val.strides());
+  EXPECT_EQ(spilled.dtype(), val.dtype());
+  EXPECT_EQ(spilled.storage_type(), val.storage_type());
+  EXPECT_EQ(std::memcmp(spilled.data().data(), val.data().data(),
+                        arr.numel() * arr.elsize()),
+            0);
+
+  // the mapping is private, writes do not reach the file or the origin.
+  auto copy = spilled;
+  static_cast<uint64_t *>(copy.data().data())[0] ^= 1;
+  EXPECT_NE(std::memcmp(spilled.data().data(), val.data().data(), 8), 0);
+  EXPECT_EQ(std::memcmp(val.data().data(), arr.data(), 8), 0);
+}
+
+TEST(SpillTest, View) {
+  const auto dir = std::filesystem::temp_directory_path().string();
+  const auto arr = mpc::ring_rand(FieldType::FM64, 10);
+  // every other element, from the second one.
+  const spu::Value val(NdArrayRef(arr.buf(), arr.eltype(), {4}, {2}, 8),
+                       DT_I64);
+
+  const auto spilled = spillValue(val, dir);
+  EXPECT_EQ(spilled.data().offset(), 8);
+  for (int64_t idx = 0; idx < 4; idx++) {
+    EXPECT_EQ(spilled.data().at<uint64_t>({idx}),
+              val.data().at<uint64_t>({idx}));
+  }
+}
+
+TEST(SpillTest, BadDir) {
+  const auto arr = mpc::ring_rand(FieldType::FM64, 10);
+  const spu::Value val(unflatten(arr, {10}), DT_I64);
+  EXPECT_THROW(spillValue(val, "/non/existent/dir"), yacl::EnforceNotMet);
+}
+
+} // namespace spu::device
@@ -14,7 +14,68 @@
 
 #include "spu/device/symbol_table.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+#include "spu/core/shape_util.h"
+
 namespace spu::device {
+namespace {
+
+// "SPUCKPT1", followed by the byte size of the header.
+constexpr uint64_t kCheckpointMagic = 0x3154504b43555053;
+constexpr size_t kCheckpointPreambleBytes = 2 * sizeof(uint64_t);
+
+size_t alignUp(size_t size) {
+  return (size + kCheckpointAlignment - 1) / kCheckpointAlignment *
+         kCheckpointAlignment;
+}
+
+void pwriteAll(int fd, const std::byte *data, size_t size, size_t offset) {
+  while (size > 0) {
+    const ssize_t written = ::pwrite(fd, data, size, offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    YACL_ENFORCE(written > 0, "failed to write checkpoint, {}",
+                 std::strerror(errno));
+    data += written;
+    size -= written;
+    offset += written;
+  }
+}
+
+void preadAll(int fd, std::byte *data, size_t size, size_t offset) {
+  while (size > 0) {
+    const ssize_t read = ::pread(fd, data, size, offset);
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    YACL_ENFORCE(read > 0, "failed to read checkpoint, {}",
+                 read == 0 ? "unexpected end of file" : std::strerror(errno));
+    data += read;
+    size -= read;
+    offset += read;
+  }
+}
+
+// Closes the descriptor when leaving the scope.
+struct FdGuard {
+  int fd;
+  ~FdGuard() { ::close(fd); }
+};
+
+} // namespace
 
 void SymbolTable::setVar(const std::string &name, const spu::Value &val) {
   data_[name] = val;
@@ -50,4 +111,133 @@ SymbolTable SymbolTable::fromProto(const SymbolTableProto &proto) {
   return st;
 }
 
+void SymbolTable::saveCheckpoint(const std::string &path) const {
+  CheckpointHeaderProto header;
+  std::vector<NdArrayRef> contents;
+  contents.reserve(data_.size());
+  size_t data_bytes = 0;
+  for (const auto &[name, value] : data_) {
+    const auto &arr = value.data();
+    auto &content = contents.emplace_back(arr.isCompact() ? arr : arr.clone());
+
+    auto *entry = header.add_entries();
+    entry->set_name(name);
+    *entry->mutable_meta() = value.toMetaProto();
+    entry->set_offset(data_bytes);
+    entry->set_size(content.numel() * content.elsize());
+    data_bytes = alignUp(data_bytes + entry->size());
+  }
+
+  const std::string header_str = header.SerializeAsString();
+  // contents are placed from the first aligned offset after the header, the
+  // entry offsets are relative to it.
+  const size_t data_start =
+      alignUp(kCheckpointPreambleBytes + header_str.size());
+
+  const std::string tmp_path = path + ".tmp";
+  const int fd = ::open(tmp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  YACL_ENFORCE(fd >= 0, "failed to create checkpoint {}, {}", tmp_path,
+               std::strerror(errno));
+  try {
+    FdGuard guard{fd};
+    YACL_ENFORCE(::ftruncate(fd, data_start + data_bytes) == 0,
+                 "failed to resize checkpoint, {}", std::strerror(errno));
+
+    const uint64_t preamble[2] = {kCheckpointMagic, header_str.size()};
+    pwriteAll(fd, reinterpret_cast<const std::byte *>(preamble),
+              sizeof(preamble), 0);
+    pwriteAll(fd, reinterpret_cast<const std::byte *>(header_str.data()),
+              header_str.size(), kCheckpointPreambleBytes);
+
+    // one task per variable, large model states are dominated by a few
+    // weights, which are written concurrently.
+    yacl::parallel_for(0, contents.size(), 1, [&](int64_t begin, int64_t end) {
+      for (int64_t idx = begin; idx < end; idx++) {
+        const auto &entry = header.entries(idx);
+        pwriteAll(fd, static_cast<const std::byte *>(contents[idx].data()),
+                  entry.size(), data_start + entry.offset());
+      }
+    });
+
+    YACL_ENFORCE(::fsync(fd) == 0, "failed to sync checkpoint, {}",
+                 std::strerror(errno));
+  } catch (...) {
+    ::unlink(tmp_path.c_str());
+    throw;
+  }
+
+  YACL_ENFORCE(std::rename(tmp_path.c_str(), path.c_str()) == 0,
+               "failed to rename checkpoint to {}, {}", path,
+               std::strerror(errno));
+}
+
+SymbolTable SymbolTable::loadCheckpoint(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  YACL_ENFORCE(fd >= 0, "failed to open checkpoint {}, {}", path,
+               std::strerror(errno));
+  FdGuard guard{fd};
+
+  struct stat st;
+  YACL_ENFORCE(::fstat(fd, &st) == 0, "failed to stat checkpoint, {}",
+               std::strerror(errno));
+  const auto file_bytes = static_cast<size_t>(st.st_size);
+  YACL_ENFORCE(file_bytes >= kCheckpointPreambleBytes,
+               "{} is not a checkpoint", path);
+
+  uint64_t preamble[2];
+  preadAll(fd, reinterpret_cast<std::byte *>(preamble), sizeof(preamble), 0);
+  YACL_ENFORCE(preamble[0] == kCheckpointMagic, "{} is not a checkpoint",
+               path);
+  YACL_ENFORCE(preamble[1] <= file_bytes - kCheckpointPreambleBytes,
+               "truncated checkpoint header");
+
+  std::string header_str(preamble[1], '\0');
+  preadAll(fd, reinterpret_cast<std::byte *>(header_str.data()),
+           header_str.size(), kCheckpointPreambleBytes);
+  CheckpointHeaderProto header;
+  YACL_ENFORCE(header.ParseFromString(header_str),
+               "failed to parse checkpoint header");
+  const size_t data_start =
+      alignUp(kCheckpointPreambleBytes + header_str.size());
+
+  SymbolTable st_out;
+  for (const auto &entry : header.entries()) {
+    const auto &meta = entry.meta();
+    const auto eltype = Type::fromString(meta.storage_type());
+    YACL_ENFORCE(meta.data_type() != DT_INVALID, "invalid data type of {}",
+                 entry.name());
+
+    std::vector<int64_t> shape(meta.shape().dims().begin(),
+                               meta.shape().dims().end());
+    const size_t size = calcNumel(shape) * eltype.size();
+    YACL_ENFORCE(entry.size() == size, "{} has {} bytes, expect {}",
+                 entry.name(), entry.size(), size);
+    YACL_ENFORCE(entry.offset() % kCheckpointAlignment == 0 &&
+                     data_start + entry.offset() + size <= file_bytes,
+                 "{} is out of range", entry.name());
+
+    std::shared_ptr<yacl::Buffer> buf;
+    if (size == 0) {
+      buf = std::make_shared<yacl::Buffer>(0);
+    } else {
+      // private, so updates of the restored variables never reach the file.
+      void *ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         fd, data_start + entry.offset());
+      YACL_ENFORCE(ptr != MAP_FAILED, "failed to map {}, {}", entry.name(),
+                   std::strerror(errno));
+      buf = std::make_shared<yacl::Buffer>(
+          ptr, size, [size](void *p) { ::munmap(p, size); });
+    }
+
+    NdArrayRef arr(std::move(buf), eltype, shape, makeCompactStrides(shape),
+                   0);
+    spu::Value value(std::move(arr), meta.data_type());
+    YACL_ENFORCE(value.vtype() == meta.visibility(),
+                 "visibility {} does not match storage_type {}",
+                 meta.visibility(), eltype);
+    st_out.setVar(entry.name(), value);
+  }
+  return st_out;
+}
+
 } // namespace spu::device
@@ -23,6 +23,10 @@
 
 namespace spu::device {
 
+// Contents in a checkpoint are aligned to this, which is a multiple of the
+// page sizes of common platforms, so each could be mapped on its own.
+constexpr size_t kCheckpointAlignment = size_t{1} << 16;
+
 class SymbolTable {
   std::unordered_map<std::string, spu::Value> data_;
 
@@ -41,6 +45,15 @@ public:
 
   SymbolTableProto toProto() const;
   static SymbolTable fromProto(const SymbolTableProto &proto);
+
+  /// Write all variables to a binary checkpoint at `path`, a header of the
+  /// metas then the raw buffers, one per variable, written in parallel. The
+  /// file is replaced atomically.
+  void saveCheckpoint(const std::string &path) const;
+
+  /// Restore from a checkpoint of saveCheckpoint, every variable views a
+  /// private mapping of its part of the file, pages are read on access.
+  static SymbolTable loadCheckpoint(const std::string &path);
 };
 
 } // namespace spu::device
@@ -0,0 +1,96 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/device/symbol_table.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+namespace spu::device {
+namespace {
+
+spu::Value makeValue(const std::vector<int64_t> &shape, int32_t seed) {
+  NdArrayRef arr(makePtType(PT_I32), shape);
+  for (int64_t idx = 0; idx < arr.numel(); ++idx) {
+    static_cast<int32_t *>(arr.data())[idx] =
+        static_cast<int32_t>(idx * 7 + seed);
+  }
+  return spu::Value(arr, DT_I32);
+}
+
+std::string tempPath(const std::string &name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+TEST(SymbolTableTest, Checkpoint) {
+  SymbolTable st;
+  st.setVar("w", makeValue({300, 200}, 1));
+  st.setVar("b", makeValue({200}, 2));
+  st.setVar("empty", makeValue({0, 3}, 3));
+  // every other element, not compact.
+  const auto base = makeValue({10}, 4);
+  st.setVar("view", spu::Value(NdArrayRef(base.data().buf(),
+                                          base.storage_type(), {5}, {2}, 4),
+                               DT_I32));
+
+  const auto path = tempPath("symbol_table_test.ckpt");
+  st.saveCheckpoint(path);
+  const auto restored = SymbolTable::loadCheckpoint(path);
+  std::filesystem::remove(path);
+
+  for (const auto &[name, value] : st) {
+    ASSERT_TRUE(restored.hasVar(name)) << name;
+    const auto got = restored.getVar(name);
+    EXPECT_EQ(got.dtype(), value.dtype());
+    EXPECT_EQ(got.shape(), value.shape());
+    EXPECT_EQ(got.storage_type(), value.storage_type());
+    EXPECT_EQ(got.toProto().content(), value.toProto().content()) << name;
+  }
+
+  // the mapping is private, so restored values are writable.
+  auto w = restored.getVar("w");
+  static_cast<int32_t *>(w.data().data())[0] = -1;
+  EXPECT_EQ(w.data().at<int32_t>({0, 0}), -1);
+}
+
+TEST(SymbolTableTest, BadCheckpoint) {
+  const auto path = tempPath("symbol_table_test_bad.ckpt");
+  {
+    std::ofstream out(path);
+    out << "not a checkpoint at all";
+  }
+  EXPECT_THROW(SymbolTable::loadCheckpoint(path), yacl::EnforceNotMet);
+  std::filesystem::remove(path);
+
+  EXPECT_THROW(SymbolTable::loadCheckpoint("/non/existent/ckpt"),
+               yacl::EnforceNotMet);
+}
+
+TEST(SymbolTableTest, TruncatedCheckpoint) {
+  SymbolTable st;
+  st.setVar("w", makeValue({100, 100}, 1));
+
+  const auto path = tempPath("symbol_table_test_truncated.ckpt");
+  st.saveCheckpoint(path);
+  std::filesystem::resize_file(path, kCheckpointAlignment + 100);
+  EXPECT_THROW(SymbolTable::loadCheckpoint(path), yacl::EnforceNotMet);
+  std::filesystem::remove(path);
+}
+
+} // namespace spu::device
@@ -26,4 +26,8 @@ namespace mlir::pphlo {
 void printConvolutionDimensions(AsmPrinter &p, Operation *,
                                 ConvDimensionNumbersAttr dnums);
 
+// A unit attribute which allows an op to leave the truncation of its
+// fixed-point result to users, see the lazy-truncation pass.
+inline constexpr char kLazyTruncAttrName[] = "pphlo.lazy_trunc";
+
 }
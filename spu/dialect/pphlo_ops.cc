@@ -850,6 +850,44 @@ Attribute GatherDimensionNumbersAttr::parse(AsmParser& parser, Type type) {
                                          index_vector_dim);
 }
 
+void ScatterDimensionNumbersAttr::print(AsmPrinter& printer) const {
+  printStruct(
+      printer, "scatter",
+      std::make_pair("update_window_dims", getUpdateWindowDims()),
+      std::make_pair("inserted_window_dims", getInsertedWindowDims()),
+      std::make_pair("scatter_dims_to_operand_dims",
+                     getScatterDimsToOperandDims()),
+      std::make_pair("index_vector_dim", getIndexVectorDim()));
+}
+
+Attribute ScatterDimensionNumbersAttr::parse(AsmParser& parser, Type type) {
+  if (failed(parser.parseLess())) {
+    return {};
+  }
+
+  SmallVector<int64_t> update_window_dims;
+  SmallVector<int64_t> inserted_window_dims;
+  SmallVector<int64_t> scatter_dims_to_operand_dims;
+  int64_t index_vector_dim = 0;
+
+  if (failed(parseStruct(
+          parser,
+          {"update_window_dims", "inserted_window_dims",
+           "scatter_dims_to_operand_dims", "index_vector_dim"},
+          {[&]() { return parseDims(parser, update_window_dims); },
+           [&]() { return parseDims(parser, inserted_window_dims); },
+           [&]() { return parseDims(parser, scatter_dims_to_operand_dims); },
+           [&]() { return parser.parseInteger(index_vector_dim); }}))) {
+    parser.emitError(parser.getCurrentLocation())
+        << "failed parsing scatter dimension numbers attribute";
+    return {};
+  }
+
+  return ScatterDimensionNumbersAttr::get(
+      parser.getContext(), update_window_dims, inserted_window_dims,
+      scatter_dims_to_operand_dims, index_vector_dim);
+}
+
 // Custom printer and parser for DotDimensionNumbersAttr.
 void DotDimensionNumbersAttr::print(AsmPrinter& printer) const {
   printStruct(
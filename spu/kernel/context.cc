@@ -14,15 +14,103 @@
 
 #include "spu/kernel/context.h"
 
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include "spu/core/parallel_utils.h"
 #include "spu/mpc/factory.h"
+#include "spu/mpc/util/mmul_backend.h"
 
 namespace spu {
+namespace {
+
+// Estimate the offset of the local clock to the clock of rank 0, by the ping
+// of the least round trip of a few, as NTP does:
+//   offset = t_0 - (t_send + t_recv) / 2
+Duration estimateClockOffset(const std::shared_ptr<yacl::link::Context>& lctx) {
+  constexpr size_t kRounds = 8;
+  constexpr auto kTag = "clock_sync";
+  auto now = [] {
+    return std::chrono::duration_cast<Duration>(
+               std::chrono::high_resolution_clock::now().time_since_epoch())
+        .count();
+  };
+
+  if (lctx->Rank() == 0) {
+    for (size_t round = 0; round < kRounds; round++) {
+      for (size_t rank = 1; rank < lctx->WorldSize(); rank++) {
+        lctx->Recv(rank, kTag);
+        const int64_t t0 = now();
+        lctx->SendAsync(rank, yacl::ByteContainerView(&t0, sizeof(t0)), kTag);
+      }
+    }
+    return Duration(0);
+  }
+
+  int64_t best_rtt = std::numeric_limits<int64_t>::max();
+  int64_t best_offset = 0;
+  for (size_t round = 0; round < kRounds; round++) {
+    const int64_t t_send = now();
+    lctx->SendAsync(0, yacl::ByteContainerView(&t_send, sizeof(t_send)), kTag);
+    auto buf = lctx->Recv(0, kTag);
+    const int64_t t_recv = now();
+    YACL_ENFORCE(buf.size() == sizeof(int64_t));
+    int64_t t0;
+    std::memcpy(&t0, buf.data(), sizeof(t0));
+    if (t_recv - t_send < best_rtt) {
+      best_rtt = t_recv - t_send;
+      best_offset = t0 - t_send - best_rtt / 2;
+    }
+  }
+  return Duration(best_offset);
+}
+
+}  // namespace
 
 HalContext::HalContext(RuntimeConfig config,
                        std::shared_ptr<yacl::link::Context> lctx)
     : rt_config_(config),
       lctx_(lctx),
       prot_(mpc::Factory::CreateCompute(config, lctx)),
-      rand_engine_(config.public_random_seed()) {}
+      rand_engine_(config.public_random_seed()) {
+  if (config.experimental_enable_buffer_pool()) {
+    buffer_pool_ = std::make_shared<BufferPool>();
+  }
+  if (config.enable_pphlo_profile() ||
+      !config.pphlo_profile_dump_path().empty() ||
+      config.experimental_spill_memory_cap() > 0) {
+    memory_tracker_ = std::make_shared<MemoryTracker>();
+  }
+  if (config.num_threads() > 0) {
+    setNumberOfProc(static_cast<int>(config.num_threads()));
+  }
+  if (!config.experimental_mmul_backend().empty()) {
+    mpc::setMmulBackend(config.experimental_mmul_backend());
+  }
+  // align the dumped traces of all parties, see
+  // spu/binding/util/trace_analysis.py.
+  if (!config.chrome_trace_dump_path().empty() && lctx_ != nullptr &&
+      lctx_->WorldSize() > 1) {
+    getTracer(GET_CTX_NAME(this))->setClockOffset(estimateClockOffset(lctx_));
+  }
+}
+
+std::unique_ptr<HalContext> HalContext::fork() {
+  std::shared_ptr<yacl::link::Context> sub_lctx;
+  if (lctx_ != nullptr) {
+    sub_lctx = lctx_->Spawn();
+  }
+
+  RuntimeConfig sub_config = rt_config_;
+  // public random sequence is shared by all parties, derive a new seed from
+  // it so forked contexts do not repeat the parent's sequence.
+  sub_config.set_public_random_seed(rand_engine_());
+
+  auto sub_ctx = std::make_unique<HalContext>(sub_config, std::move(sub_lctx));
+  sub_ctx->buffer_pool_ = buffer_pool_;
+  sub_ctx->memory_tracker_ = memory_tracker_;
+  return sub_ctx;
+}
 
 }  // namespace spu
@@ -19,6 +19,8 @@
 
 #include "yacl/link/link.h"
 
+#include "spu/core/buffer_pool.h"
+#include "spu/core/memory_tracker.h"
 #include "spu/core/trace.h"
 #include "spu/mpc/object.h"
 
@@ -36,6 +38,12 @@ class HalContext final {
 
   std::default_random_engine rand_engine_;
 
+  // shared with forked contexts.
+  std::shared_ptr<BufferPool> buffer_pool_;
+
+  // shared with forked contexts.
+  std::shared_ptr<MemoryTracker> memory_tracker_;
+
  public:
   explicit HalContext(RuntimeConfig config,
                       std::shared_ptr<yacl::link::Context> lctx);
@@ -45,6 +53,13 @@ class HalContext final {
 
   HalContext(HalContext&& other) = default;
 
+  // Create a new context with the same runtime config, but owns a spawned
+  // link and an independent protocol instance, the new context could be used
+  // concurrently with this one.
+  //
+  // Note: all parties should fork in the same order.
+  std::unique_ptr<HalContext> fork();
+
   //
   const std::shared_ptr<yacl::link::Context>& lctx() const { return lctx_; }
 
@@ -61,6 +76,13 @@ class HalContext final {
 
   //
   std::default_random_engine& rand_engine() { return rand_engine_; }
+
+  // Return the buffer pool of this context, or null if it's not enabled.
+  BufferPool* buffer_pool() const { return buffer_pool_.get(); }
+
+  // Return the memory tracker of this context, or null if ops are neither
+  // profiled nor spilled.
+  MemoryTracker* memory_tracker() const { return memory_tracker_.get(); }
 };
 
 }  // namespace spu
@@ -15,6 +15,8 @@
 #include "spu/kernel/hal/concat.h"
 
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <numeric>
 
 #include "yacl/base/exception.h"
@@ -71,6 +73,51 @@ Value concatenate(HalContext* ctx, absl::Span<const Value> values,
                values.front().dtype());
   auto elsize = result.elsize();
 
+  // The layout of the result, i.e. `outer` rows, each of them is the inner
+  // part of every value one by one, the j-th value starts at row_offsets[j].
+  const int64_t outer = std::accumulate(
+      result_shape.begin(), result_shape.begin() + axis, int64_t{1},
+      std::multiplies<>());
+  std::vector<int64_t> row_offsets(values.size() + 1, 0);
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    const auto& shape = values[idx].shape();
+    row_offsets[idx + 1] =
+        row_offsets[idx] + std::accumulate(shape.begin() + axis, shape.end(),
+                                           int64_t{1}, std::multiplies<>());
+  }
+  const int64_t row_size = row_offsets.back();
+
+  // compact values are copied by a memcpy per row, the others elementwise.
+  std::vector<size_t> compact;
+  std::vector<size_t> strided;
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    if (values[idx].numel() == 0) {
+      continue;
+    }
+    (values[idx].data().isCompact() ? compact : strided).push_back(idx);
+  }
+
+  if (!compact.empty()) {
+    auto* to_base = static_cast<std::byte*>(result.data().data());
+    const int64_t num_tasks = static_cast<int64_t>(compact.size()) * outer;
+    pfor(0, num_tasks, std::max<int64_t>(row_size / values.size(), 1),
+         [&](int64_t begin, int64_t end) {
+           for (int64_t task = begin; task < end; ++task) {
+             const auto idx = compact[task % compact.size()];
+             const int64_t row = task / compact.size();
+             const int64_t len = row_offsets[idx + 1] - row_offsets[idx];
+             const auto* from_ptr =
+                 static_cast<const std::byte*>(values[idx].data().data());
+             std::memcpy(to_base + (row * row_size + row_offsets[idx]) * elsize,
+                         from_ptr + row * len * elsize, len * elsize);
+           }
+         });
+  }
+
+  if (strided.empty()) {
+    return result;
+  }
+
   // Generating slices
   std::vector<Value> result_slices(values.size());
   {
@@ -104,10 +151,10 @@ Value concatenate(HalContext* ctx, absl::Span<const Value> values,
       };
 
   // 5 here is just a magic number
-  if (values.size() < 5) {
+  if (strided.size() < 5) {
     // When there are just a few values to concat. Try to parallel on value
     // level...
-    for (size_t idx = 0; idx < values.size(); ++idx) {
+    for (const auto idx : strided) {
       auto g_size = std::max<int64_t>(
           (values[idx].numel() + getNumberOfProc()) / getNumberOfProc(), 2048);
       yacl::parallel_for(
@@ -129,10 +176,11 @@ Value concatenate(HalContext* ctx, absl::Span<const Value> values,
     // When there are a lot of values to concat (usually during im2col, where
     // each value is just a window), try to parallel on inputs
     yacl::parallel_for(
-        0, values.size(),
-        (values.size() + getNumberOfProc()) / getNumberOfProc(),
+        0, strided.size(),
+        (strided.size() + getNumberOfProc()) / getNumberOfProc(),
         [&](int64_t begin, int64_t end) {
-          for (int64_t idx = begin; idx < end; ++idx) {
+          for (int64_t i = begin; i < end; ++i) {
+            const auto idx = strided[i];
             std::vector<int64_t> indicies(values[idx].shape().size(), 0);
             const auto* from_ptr =
                 static_cast<const std::byte*>(values[idx].data().data());
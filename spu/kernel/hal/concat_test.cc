@@ -15,8 +15,12 @@
 #include "spu/kernel/hal/concat.h"
 
 #include "gtest/gtest.h"
+#include "xtensor/xmanipulation.hpp"
 #include "xtensor/xtensor.hpp"
 
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/prot_wrapper.h"
+#include "spu/kernel/hal/shape_ops.h"
 #include "spu/kernel/hal/test_util.h"
 
 namespace spu::kernel::hal {
@@ -65,4 +69,40 @@ TYPED_TEST(ConcatTest, Concatenate) {
       << z;
 }
 
+TEST(ConcatTest, ManyValues) {
+  HalContext ctx = test::makeRefHalContext();
+
+  // 300 values of (2, i % 3 + 1, 4) along axis 1, every third value is a
+  // strided transpose.
+  const int64_t kNumValues = 300;
+  std::vector<xt::xarray<int64_t>> xs;
+  std::vector<Value> values;
+  for (int64_t i = 0; i < kNumValues; ++i) {
+    const size_t len = i % 3 + 1;
+    xt::xarray<int64_t> x = test::xt_random<int64_t>({2, len, 4});
+    Value v;
+    if (i % 3 == 1) {
+      xt::xarray<int64_t> xt_x = xt::transpose(x, {2, 1, 0});
+      v = transpose(&ctx, make_value(&ctx, VIS_SECRET, xt_x), {2, 1, 0});
+      EXPECT_FALSE(v.data().isCompact());
+    } else {
+      v = make_value(&ctx, VIS_SECRET, x);
+    }
+    xs.push_back(std::move(x));
+    values.push_back(std::move(v));
+  }
+
+  auto z = concatenate(&ctx, values, 1);
+
+  int64_t offset = 0;
+  for (const auto& x : xs) {
+    const auto len = static_cast<int64_t>(x.shape()[1]);
+    auto part = slice(&ctx, z, {0, offset, 0}, {2, offset + len, 4}, {});
+    auto revealed = _s2p(&ctx, part).setDtype(part.dtype());
+    EXPECT_EQ(test::dump_public_as<int64_t>(&ctx, revealed), x) << offset;
+    offset += len;
+  }
+  EXPECT_EQ(z.shape(), (std::vector<int64_t>{2, offset, 4}));
+}
+
 }  // namespace spu::kernel::hal
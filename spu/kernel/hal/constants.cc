@@ -29,11 +29,9 @@ namespace {
 Value make_pub2k(HalContext* ctx, PtBufferView bv) {
   SPU_TRACE_HAL_DISP(ctx, bv);
 
-  NdArrayRef raw = xt_to_ndarray(bv);
-
   DataType dtype;
   NdArrayRef encoded =
-      encodeToRing(raw, ctx->getField(), ctx->getFxpBits(), &dtype);
+      encodeToRing(bv, ctx->getField(), ctx->getFxpBits(), &dtype);
 
   return Value(encoded.as(makeType<mpc::Pub2kTy>(ctx->getField())), dtype);
 }
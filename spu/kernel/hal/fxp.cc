@@ -16,13 +16,18 @@
 
 #include <algorithm>
 #include <cmath>
+#include <optional>
 
 #include "absl/numeric/bits.h"
 
+#include "spu/core/type_util.h"
+#include "spu/core/xt_helper.h"
+#include "spu/kernel/hal/concat.h"
 #include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/integer.h"
 #include "spu/kernel/hal/public_intrinsic.h"
 #include "spu/kernel/hal/ring.h"
+#include "spu/kernel/hal/shape_ops.h"
 
 namespace spu::kernel::hal {
 namespace {
@@ -39,14 +44,14 @@ Value f_polynomial(HalContext* ctx, const Value& x,
   YACL_ENFORCE(!coeffs.empty());
 
   Value x_pow = x;
-  Value res = _mul(ctx, x_pow, coeffs[0]);
+  Value res = f_mul_lazy(ctx, x_pow, coeffs[0]);
 
   for (size_t i = 1; i < coeffs.size(); i++) {
-    x_pow = _trunc(ctx, _mul(ctx, x_pow, x));
-    res = _add(ctx, res, _mul(ctx, x_pow, coeffs[i]));
+    x_pow = f_mul(ctx, x_pow, x);
+    res = f_add(ctx, res, f_mul_lazy(ctx, x_pow, coeffs[i]));
   }
 
-  return _trunc(ctx, res).asFxp();
+  return f_trunc_pending(ctx, res);
 }
 
 // Extract the most significant bit. see
@@ -66,6 +71,102 @@ void hintNumberOfBits(const Value& a, size_t nbits) {
   }
 }
 
+// The k if all elements of a public fixed-point `x` are 2^k, so scaling by
+// `x` is a shift or a truncation.
+std::optional<int64_t> getPow2Exponent(HalContext* ctx, const Value& x) {
+  if (!x.isPublic() || !x.isFxp() || x.pendingTruncBits() != 0 ||
+      x.numel() == 0) {
+    return std::nullopt;
+  }
+
+  std::optional<int64_t> exponent;
+  DISPATCH_ALL_FIELDS(ctx->getField(), "_", [&]() {
+    using S = typename std::make_signed<ring2k_t>::type;
+    const auto x_xt = xt_adapt<ring2k_t>(x.data());
+    const ring2k_t first = x_xt(0);
+    if (static_cast<S>(first) <= 0 || (first & (first - 1)) != 0) {
+      return;
+    }
+    for (int64_t idx = 1; idx < x.numel(); idx++) {
+      if (x_xt(idx) != first) {
+        return;
+      }
+    }
+    int64_t bits = 0;
+    for (auto v = first; v > 1; v >>= 1) {
+      ++bits;
+    }
+    exponent = bits - static_cast<int64_t>(ctx->getFxpBits());
+  });
+  return exponent;
+}
+
+// Whether all elements of a public fixed-point `x` are below 2^bits in
+// magnitude, as ring values.
+bool isPublicBelow(HalContext* ctx, const Value& x, size_t bits) {
+  if (!x.isPublic() || !x.isFxp() || x.pendingTruncBits() != 0) {
+    return false;
+  }
+
+  bool below = true;
+  DISPATCH_ALL_FIELDS(ctx->getField(), "_", [&]() {
+    using S = typename std::make_signed<ring2k_t>::type;
+    if (bits >= sizeof(ring2k_t) * 8 - 1) {
+      return;
+    }
+    const auto bound = static_cast<ring2k_t>(1) << bits;
+    const auto x_xt = xt_adapt<ring2k_t>(x.data());
+    for (int64_t idx = 0; idx < x.numel() && below; idx++) {
+      const auto v = static_cast<S>(x_xt(idx));
+      below = static_cast<ring2k_t>(v < 0 ? -v : v) < bound;
+    }
+  });
+  return below;
+}
+
+// x * 2^k, by a local shift when k >= 0 and one truncation otherwise.
+Value f_scale_pow2(HalContext* ctx, const Value& x, int64_t k) {
+  const auto y = f_trunc_pending(ctx, x);
+  if (k >= 0) {
+    return _lshift(ctx, y, k).asFxp();
+  }
+  return _trunc(ctx, y, -k).asFxp();
+}
+
+bool isPolyReciprocalMode(HalContext* ctx) {
+  return ctx->rt_config().fxp_reciprocal_mode() ==
+         RuntimeConfig::RECIPROCAL_POLY;
+}
+
+// The initial guess of 1/c for c in [0.5, 1).
+Value reciprocalSeed(HalContext* ctx, const Value& c) {
+  if (isPolyReciprocalMode(ctx)) {
+    // minimax of the relative error, |1 - c*w| < 1.8e-3
+    std::vector<Value> coeffs = {constant(ctx, -11.757366f, c.shape()),
+                                 constant(ctx, 10.64818f, c.shape()),
+                                 constant(ctx, -3.549393f, c.shape())};
+    return f_add(ctx, f_polynomial(ctx, c, coeffs),
+                 constant(ctx, 5.656846f, c.shape()));
+  }
+
+  // w = 2.9142 - 2c
+  const auto k2 = constant(ctx, 2, c.shape());
+  const auto k2_9142 = constant(ctx, 2.9142f, c.shape());
+  return f_sub(ctx, k2_9142, _mul(ctx, k2, c).asFxp());
+}
+
+size_t goldschmidtIters(HalContext* ctx) {
+  const size_t config_num_iters = ctx->rt_config().fxp_div_goldschmidt_iters();
+  if (config_num_iters != 0) {
+    return config_num_iters;
+  }
+  // the error of the poly seed squares to 2^-18.3 by one iteration.
+  if (isPolyReciprocalMode(ctx)) {
+    return ctx->getFxpBits() <= 18 ? 1 : 2;
+  }
+  return 2;
+}
+
 }  // namespace
 
 namespace detail {
@@ -113,18 +214,16 @@ Value div_goldschmidt(HalContext* ctx, const Value& a, const Value& b) {
   auto c = f_mul(ctx, b_abs, factor);
 
   // initial guess:
-  //   w = 1/c ≈ 2.9142 - 2c when c >= 0.5 and c < 1
-  const auto k2 = constant(ctx, 2, c.shape());
-  const auto k2_9142 = constant(ctx, 2.9142f, c.shape());
-  auto w = f_sub(ctx, k2_9142, _mul(ctx, k2, c).asFxp());
+  //   w = 1/c ≈ 2.9142 - 2c when c >= 0.5 and c < 1, or a cubic of c, see
+  //   `RuntimeConfig.fxp_reciprocal_mode`.
+  auto w = reciprocalSeed(ctx, c);
 
   // init r=w, e=1-c*w
   const auto& k1_ = constant(ctx, 1.0f, c.shape());
   auto r = w;
   auto e = f_sub(ctx, k1_, f_mul(ctx, c, w));
 
-  const size_t config_num_iters = ctx->rt_config().fxp_div_goldschmidt_iters();
-  const size_t num_iters = config_num_iters == 0 ? 2 : config_num_iters;
+  const size_t num_iters = goldschmidtIters(ctx);
 
   // iterate, r=r(1+e), e=e*e
   for (size_t itr = 0; itr < num_iters; itr++) {
@@ -149,18 +248,16 @@ Value reciprocal_goldschmidt_positive(HalContext* ctx, const Value& b_abs) {
   auto c = f_mul(ctx, b_abs, factor);
 
   // initial guess:
-  //   w = 1/b = 2.9142 - 2c when c >= 0.5 and c < 1
-  const auto k2 = constant(ctx, 2, c.shape());
-  const auto k2_9142 = constant(ctx, 2.9142f, c.shape());
-  auto w = f_mul(ctx, f_sub(ctx, k2_9142, _mul(ctx, k2, c).asFxp()), factor);
+  //   w = 1/b = (2.9142 - 2c) * 2^{-m} when c >= 0.5 and c < 1, or a cubic of
+  //   c, see `RuntimeConfig.fxp_reciprocal_mode`.
+  auto w = f_mul(ctx, reciprocalSeed(ctx, c), factor);
 
   // init r=a*w, e=1-b*w
   const auto& k1_ = constant(ctx, 1.0f, c.shape());
   auto r = w;
   auto e = f_sub(ctx, k1_, f_mul(ctx, b_abs, w));
 
-  const size_t config_num_iters = ctx->rt_config().fxp_div_goldschmidt_iters();
-  const size_t num_iters = config_num_iters == 0 ? 2 : config_num_iters;
+  const size_t num_iters = goldschmidtIters(ctx);
 
   // iterate, r=r(1+e), e=e*e
   for (size_t itr = 0; itr < num_iters; itr++) {
@@ -383,6 +480,108 @@ Value exp_pade_approx(HalContext* ctx, const Value& x) {
       ctx, f_mul(ctx, x, constant(ctx, std::log2(std::exp(1)), x.shape())));
 }
 
+// exp(x) = 2^n * 2^f, of y = x * log2(e) = n + f, n = floor(y), f in [0, 1).
+//
+// The bits of n select public factors 2^(2^i), which are multiplied by a
+// product tree together with a degree 5 polynomial of 2^f, so the depth is
+// constant of the input range, unlike the iterations of taylor series.
+//
+// A negative n is decomposed as ~n = -n - 1 >= 0, so 2^n = 2^(-~n) / 2 and
+// every factor is of the same side of 1, and no partial product exceeds the
+// result. Every fixed-point product must fit the ring, so |n| is below 2^K of
+// 2^K + 2 * fxp_bits below the ring bits, results above saturate to 2^(2^K),
+// and those below 2^(-2^K) to 0.
+Value exp_range_reduced(HalContext* ctx, const Value& x) {
+  const size_t fbits = ctx->getFxpBits();
+  const size_t bit_width = SizeOf(ctx->getField()) * 8;
+  YACL_ENFORCE(bit_width > 2 * fbits + 2, "fxp bits {} too large for ring {}",
+               fbits, bit_width);
+  size_t num_bits = 0;
+  while ((size_t{1} << (num_bits + 1)) + 2 * fbits < bit_width) {
+    num_bits++;
+  }
+
+  const auto k0 = constant(ctx, 0U, x.shape());
+  const auto k1 = constant(ctx, 1U, x.shape());
+  const auto one = constant(ctx, 1.0, x.shape());
+  // to ashare of a single bit.
+  auto to_arith = [&](Value bit) {
+    hintNumberOfBits(bit, 1);
+    return _mul(ctx, k1, bit);
+  };
+
+  const auto y =
+      f_mul(ctx, x, constant(ctx, std::log2(std::exp(1)), x.shape()));
+  const auto y_bshare = _or(ctx, y, k0);  // noop, to bshare
+  const auto sign_mask = _arshift(ctx, y_bshare, bit_width - 1);
+  // n for n >= 0, ~n for n < 0.
+  const auto n_abs = _rshift(ctx, _xor(ctx, y_bshare, sign_mask), fbits);
+  const auto sign = _and(ctx, sign_mask, k1);
+  const auto fraction =
+      _sub(ctx, y, _lshift(ctx, _arshift(ctx, y_bshare, fbits), fbits))
+          .asFxp();
+
+  // 2^f of p1015, see exp2_pade_approx_for_positive_pure_decimal, powers by
+  // squaring for depth 3.
+  const auto f2 = f_square(ctx, fraction);
+  const auto f3 = f_mul(ctx, f2, fraction);
+  const auto f4 = f_square(ctx, f2);
+  const auto f5 = f_mul(ctx, f4, fraction);
+  const std::vector<Value> powers = {fraction, f2, f3, f4, f5};
+  const std::vector<double> coeffs = {
+      0.693147180426163, 0.240226510710170, 0.555040686204663 / 10,
+      0.961834122588046 / 100, 0.133273035928143 / 100};
+  auto poly = constant(ctx, 0.100000007744302 * 10, x.shape());
+  for (size_t idx = 0; idx < powers.size(); idx++) {
+    const auto coeff = constant(ctx, coeffs[idx], x.shape());
+    poly = f_add(ctx, poly, f_mul(ctx, powers[idx], coeff));
+  }
+
+  const auto sign_a = to_arith(sign);
+  std::vector<Value> factors = {poly};
+  // 1 for n >= 0, 1/2 for n < 0.
+  factors.emplace_back(
+      f_sub(ctx, one, _mul(ctx, sign_a, constant(ctx, 0.5, x.shape()))
+                          .asFxp()));
+  for (size_t idx = 0; idx < num_bits; idx++) {
+    const auto bit = _and(ctx, _rshift(ctx, n_abs, idx), k1);
+    const auto bit_a = to_arith(bit);
+    const auto neg_bit_a = to_arith(_and(ctx, bit, sign));
+    const double pos = std::pow(2.0, std::pow(2.0, idx));
+    const double neg = 1.0 / pos;
+    // 1, pos or neg of the bit and the sign.
+    auto factor =
+        f_add(ctx, one,
+              _mul(ctx, bit_a, constant(ctx, pos - 1, x.shape())).asFxp());
+    factors.emplace_back(f_add(
+        ctx, factor,
+        _mul(ctx, neg_bit_a, constant(ctx, neg - pos, x.shape())).asFxp()));
+  }
+
+  // any bit of n out of range.
+  const auto overflow_bit =
+      _and(ctx, _prefix_or(ctx, _rshift(ctx, n_abs, num_bits)), k1);
+  const auto overflow = to_arith(overflow_bit);
+  factors.emplace_back(f_sub(ctx, one, _mul(ctx, overflow, one).asFxp()));
+
+  while (factors.size() > 1) {
+    std::vector<Value> next;
+    for (size_t idx = 0; idx + 1 < factors.size(); idx += 2) {
+      next.emplace_back(f_mul(ctx, factors[idx], factors[idx + 1]));
+    }
+    if (factors.size() % 2 == 1) {
+      next.emplace_back(factors.back());
+    }
+    factors = std::move(next);
+  }
+
+  // saturates of positive overflow, 0 for the negative.
+  const auto saturated = to_arith(_and(ctx, overflow_bit, _xor(ctx, sign, k1)));
+  const auto big = constant(ctx, std::pow(2.0, std::pow(2.0, num_bits)),
+                            x.shape());
+  return f_add(ctx, factors[0], _mul(ctx, saturated, big).asFxp());
+}
+
 // Refer to
 // https://www.wolframalpha.com/input?i=Pade+approximation+tanh%28x%29+order+5%2C5.
 // tanh(x) = (x + x^3 / 9.0 + x^5 /945.0) /
@@ -432,6 +631,10 @@ Value f_exp(HalContext* ctx, const Value& x) {
       return detail::exp_taylor_series(ctx, x);
     case RuntimeConfig::EXP_PADE:
       return detail::exp_pade_approx(ctx, x);
+    case RuntimeConfig::EXP_PIECEWISE:
+      return f_piecewise(ctx, x, getPiecewiseSpec(PiecewiseFunction::Exp));
+    case RuntimeConfig::EXP_RANGE_REDUCED:
+      return detail::exp_range_reduced(ctx, x);
     default:
       YACL_THROW("unexpected exp approxmation method {}",
                  ctx->rt_config().fxp_exp_mode());
@@ -442,7 +645,7 @@ Value f_negate(HalContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
 
   YACL_ENFORCE(x.isFxp());
-  return _negate(ctx, x).asFxp();
+  return _negate(ctx, x).asFxp().setPendingTruncBits(x.pendingTruncBits());
 }
 
 Value f_abs(HalContext* ctx, const Value& x) {
@@ -471,7 +674,14 @@ Value f_add(HalContext* ctx, const Value& x, const Value& y) {
   YACL_ENFORCE(x.isFxp());
   YACL_ENFORCE(y.isFxp());
 
-  return _add(ctx, x, y).asFxp();
+  // align pending bits, shifting left is local.
+  const size_t bits = std::max(x.pendingTruncBits(), y.pendingTruncBits());
+  auto align = [&](const Value& v) {
+    const size_t shift = bits - v.pendingTruncBits();
+    return shift == 0 ? v : _lshift(ctx, v, shift);
+  };
+
+  return _add(ctx, align(x), align(y)).asFxp().setPendingTruncBits(bits);
 }
 
 Value f_sub(HalContext* ctx, const Value& x, const Value& y) {
@@ -488,7 +698,37 @@ Value f_mul(HalContext* ctx, const Value& x, const Value& y) {
   YACL_ENFORCE(x.isFxp());
   YACL_ENFORCE(y.isFxp());
 
-  return _trunc(ctx, _mul(ctx, x, y)).asFxp();
+  // scaling a secret by a public power of two.
+  if (!x.isPublic() && x.shape() == y.shape()) {
+    if (auto k = getPow2Exponent(ctx, y)) {
+      return f_scale_pow2(ctx, x, *k);
+    }
+  }
+  if (!y.isPublic() && x.shape() == y.shape()) {
+    if (auto k = getPow2Exponent(ctx, x)) {
+      return f_scale_pow2(ctx, y, *k);
+    }
+  }
+
+  return _trunc(ctx, _mul(ctx, f_trunc_pending(ctx, x),
+                          f_trunc_pending(ctx, y)))
+      .asFxp();
+}
+
+Value f_mul_lazy(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  YACL_ENFORCE(x.isFxp());
+  YACL_ENFORCE(y.isFxp());
+
+  // truncating a public is free.
+  if (x.isPublic() && y.isPublic()) {
+    return f_mul(ctx, x, y);
+  }
+
+  return _mul(ctx, f_trunc_pending(ctx, x), f_trunc_pending(ctx, y))
+      .asFxp()
+      .setPendingTruncBits(ctx->getFxpBits());
 }
 
 Value f_mmul(HalContext* ctx, const Value& x, const Value& y) {
@@ -497,7 +737,45 @@ Value f_mmul(HalContext* ctx, const Value& x, const Value& y) {
   YACL_ENFORCE(x.isFxp());
   YACL_ENFORCE(y.isFxp());
 
-  return _trunc(ctx, _mmul(ctx, x, y)).asFxp();
+  return _mmul_trunc(ctx, f_trunc_pending(ctx, x), f_trunc_pending(ctx, y))
+      .asFxp();
+}
+
+Value f_batch_mmul(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  YACL_ENFORCE(x.isFxp());
+  YACL_ENFORCE(y.isFxp());
+
+  return _batch_mmul_trunc(ctx, f_trunc_pending(ctx, x),
+                           f_trunc_pending(ctx, y))
+      .asFxp();
+}
+
+Value f_mmul_lazy(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  YACL_ENFORCE(x.isFxp());
+  YACL_ENFORCE(y.isFxp());
+
+  if (x.isPublic() && y.isPublic()) {
+    return f_mmul(ctx, x, y);
+  }
+
+  return _mmul(ctx, f_trunc_pending(ctx, x), f_trunc_pending(ctx, y))
+      .asFxp()
+      .setPendingTruncBits(ctx->getFxpBits());
+}
+
+Value f_trunc_pending(HalContext* ctx, const Value& x) {
+  if (x.pendingTruncBits() == 0) {
+    return x;
+  }
+
+  SPU_TRACE_HAL_LEAF(ctx, x);
+
+  YACL_ENFORCE(x.isFxp());
+  return _trunc(ctx, x, x.pendingTruncBits()).asFxp();
 }
 
 Value f_div(HalContext* ctx, const Value& x, const Value& y) {
@@ -510,6 +788,18 @@ Value f_div(HalContext* ctx, const Value& x, const Value& y) {
     return f_div_p(ctx, x, y);
   }
 
+  // dividing by a public is a scaling by its reciprocal, if the reciprocal
+  // keeps half of the fraction bits at least.
+  if (y.isPublic() && x.shape() == y.shape()) {
+    if (auto k = getPow2Exponent(ctx, y)) {
+      return f_scale_pow2(ctx, x, -*k);
+    }
+    const size_t fxp_bits = ctx->getFxpBits();
+    if (isPublicBelow(ctx, y, fxp_bits + fxp_bits / 2)) {
+      return f_mul(ctx, x, f_reciprocal_p(ctx, y));
+    }
+  }
+
   return detail::div_goldschmidt(ctx, x, y);
 }
 
@@ -627,10 +917,21 @@ Value f_rsqrt(HalContext* ctx, const Value& x) {
   auto u = _trunc(ctx, _mul(ctx, x, z_rev)).asFxp();
 
   // let rsqrt(u) = 4.7979 * u^2 - 5.9417 * u + 3.1855
-  std::vector<Value> coeffs = {constant(ctx, -5.9417, x.shape()),
-                               constant(ctx, 4.7979, x.shape())};
-  auto r = f_add(ctx, f_polynomial(ctx, u, coeffs),
-                 constant(ctx, 3.1855, x.shape()));
+  //   or, the minimax cubic of the relative error, below 4.8e-4
+  //   rsqrt(u) = -10.823523 * u^3 + 16.916998 * u^2 - 10.294481 * u + 3.684467
+  Value r;
+  if (isPolyReciprocalMode(ctx)) {
+    std::vector<Value> coeffs = {constant(ctx, -10.294481, x.shape()),
+                                 constant(ctx, 16.916998, x.shape()),
+                                 constant(ctx, -10.823523, x.shape())};
+    r = f_add(ctx, f_polynomial(ctx, u, coeffs),
+              constant(ctx, 3.684467, x.shape()));
+  } else {
+    std::vector<Value> coeffs = {constant(ctx, -5.9417, x.shape()),
+                                 constant(ctx, 4.7979, x.shape())};
+    r = f_add(ctx, f_polynomial(ctx, u, coeffs),
+              constant(ctx, 3.1855, x.shape()));
+  }
 
   // Newton Method to reduce error
   // r' = r * ( threehalfs - ( u * half * r * r ) );
@@ -715,4 +1016,209 @@ Value f_sqrt(HalContext* ctx, const Value& x) {
   return g;
 }
 
+namespace {
+
+// Solve the dense linear system a * x = b by Gaussian elimination with
+// partial pivoting.
+std::vector<double> solveLinearSystem(std::vector<std::vector<double>> a,
+                                      std::vector<double> b) {
+  const size_t n = b.size();
+  for (size_t col = 0; col < n; col++) {
+    size_t pivot = col;
+    for (size_t row = col + 1; row < n; row++) {
+      if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+        pivot = row;
+      }
+    }
+    std::swap(a[col], a[pivot]);
+    std::swap(b[col], b[pivot]);
+    YACL_ENFORCE(a[col][col] != 0, "singular linear system");
+
+    for (size_t row = col + 1; row < n; row++) {
+      const double factor = a[row][col] / a[col][col];
+      for (size_t k = col; k < n; k++) {
+        a[row][k] -= factor * a[col][k];
+      }
+      b[row] -= factor * b[col];
+    }
+  }
+
+  std::vector<double> x(n);
+  for (size_t row = n; row-- > 0;) {
+    double sum = b[row];
+    for (size_t k = row + 1; k < n; k++) {
+      sum -= a[row][k] * x[k];
+    }
+    x[row] = sum / a[row][row];
+  }
+  return x;
+}
+
+}  // namespace
+
+PiecewisePolynomial compilePiecewisePolynomial(
+    const std::function<double(double)>& fn,
+    const std::vector<double>& breakpoints, size_t degree,
+    const std::vector<double>& left_tail,
+    const std::vector<double>& right_tail) {
+  YACL_ENFORCE(!breakpoints.empty());
+  YACL_ENFORCE(std::is_sorted(breakpoints.begin(), breakpoints.end()));
+  YACL_ENFORCE(!left_tail.empty() && !right_tail.empty());
+
+  PiecewisePolynomial pp;
+  pp.breakpoints = breakpoints;
+  pp.segments.push_back({0, left_tail});
+
+  // interpolate at the chebyshev nodes, which minimizes the max error.
+  const size_t num_nodes = degree + 1;
+  for (size_t idx = 0; idx + 1 < breakpoints.size(); idx++) {
+    const double center = (breakpoints[idx] + breakpoints[idx + 1]) / 2;
+    const double radius = (breakpoints[idx + 1] - breakpoints[idx]) / 2;
+
+    std::vector<std::vector<double>> vandermonde(num_nodes);
+    std::vector<double> values(num_nodes);
+    for (size_t node = 0; node < num_nodes; node++) {
+      const double t =
+          radius * std::cos(M_PI * (2 * node + 1) / (2 * num_nodes));
+      values[node] = fn(center + t);
+
+      double t_pow = 1;
+      for (size_t k = 0; k < num_nodes; k++) {
+        vandermonde[node].push_back(t_pow);
+        t_pow *= t;
+      }
+    }
+    pp.segments.push_back({center, solveLinearSystem(vandermonde, values)});
+  }
+
+  pp.segments.push_back({0, right_tail});
+  return pp;
+}
+
+const PiecewisePolynomial& getPiecewiseSpec(PiecewiseFunction fn) {
+  switch (fn) {
+    case PiecewiseFunction::Exp: {
+      // segments get narrower as exp grows.
+      static const auto spec = compilePiecewisePolynomial(
+          [](double x) { return std::exp(x); },
+          {-16, -12, -8, -6, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6, 7, 8}, 3,
+          {0}, {std::exp(8.0)});
+      return spec;
+    }
+    case PiecewiseFunction::Sigmoid: {
+      static const auto spec = compilePiecewisePolynomial(
+          [](double x) { return 1 / (1 + std::exp(-x)); },
+          {-8, -6, -4, -3, -2, -1, 0, 1, 2, 3, 4, 6, 8}, 3, {0}, {1});
+      return spec;
+    }
+    case PiecewiseFunction::Gelu: {
+      static const auto spec = compilePiecewisePolynomial(
+          [](double x) { return x * (1 + std::erf(x / std::sqrt(2.0))) / 2; },
+          {-4, -3, -2, -1, 0, 1, 2, 3, 4}, 3, {0}, {0, 1});
+      return spec;
+    }
+  }
+  YACL_THROW("unknown piecewise function {}", static_cast<int>(fn));
+}
+
+// Let lt[i] = x < breakpoints[i], the segment of x is the first i with
+// lt[i] = 1, so any per-segment parameter p could be selected by
+//   p = p[n] + sum_i lt[i] * (p[i] - p[i+1])
+// which is a public matrix times the secret bits, i.e. local. With all
+// coefficients selected, the polynomial is
+//   sum_k coeffs[k] * t^k, where t = x - center
+// the powers of t are computed once, then all terms are multiplied in one
+// round and summed before a single truncation.
+Value f_piecewise(HalContext* ctx, const Value& x,
+                  const PiecewisePolynomial& pp) {
+  SPU_TRACE_HAL_LEAF(ctx, x);
+
+  YACL_ENFORCE(x.isFxp());
+  YACL_ENFORCE(pp.segments.size() == pp.breakpoints.size() + 1,
+               "expect {} segments, got {}", pp.breakpoints.size() + 1,
+               pp.segments.size());
+
+  size_t degree = 0;
+  for (const auto& segment : pp.segments) {
+    YACL_ENFORCE(!segment.coeffs.empty());
+    degree = std::max(degree, segment.coeffs.size() - 1);
+  }
+
+  // row 0 is the center, row k+1 is the k-th coefficient.
+  const auto num_params = static_cast<int64_t>(degree + 2);
+  const auto num_bps = static_cast<int64_t>(pp.breakpoints.size());
+  auto param = [&](int64_t seg, int64_t row) -> double {
+    const auto& segment = pp.segments[seg];
+    if (row == 0) {
+      return segment.center;
+    }
+    return row <= static_cast<int64_t>(segment.coeffs.size())
+               ? segment.coeffs[row - 1]
+               : 0;
+  };
+
+  const int64_t numel = x.numel();
+  const auto flat = reshape(ctx, x, {numel});
+
+  std::vector<double> last(num_params);
+  for (int64_t row = 0; row < num_params; row++) {
+    last[row] = param(num_bps, row);
+  }
+  Value params =
+      broadcast_to(ctx, constant(ctx, last), {num_params, numel}, {0});
+
+  if (num_bps > 0) {
+    // compare with all breakpoints at once.
+    auto lt = _less(ctx, broadcast_to(ctx, flat, {num_bps, numel}, {1}),
+                    broadcast_to(ctx, constant(ctx, pp.breakpoints),
+                                 {num_bps, numel}, {0}));
+    hintNumberOfBits(lt, 1);
+    lt = _mul(ctx, lt, constant(ctx, 1, lt.shape()));  // nop, cast to ashr.
+
+    std::vector<double> deltas(num_params * num_bps);
+    for (int64_t row = 0; row < num_params; row++) {
+      for (int64_t idx = 0; idx < num_bps; idx++) {
+        deltas[row * num_bps + idx] = param(idx, row) - param(idx + 1, row);
+      }
+    }
+    params = _add(
+        ctx, params,
+        _mmul(ctx, constant(ctx, deltas, {num_params, num_bps}), lt));
+  }
+
+  auto param_row = [&](int64_t row) {
+    return reshape(ctx, slice(ctx, params, {row, 0}, {row + 1, numel}, {}),
+                   {numel});
+  };
+
+  Value res = param_row(1);
+  if (degree > 0) {
+    const auto t = _sub(ctx, flat, param_row(0));
+
+    std::vector<Value> powers = {reshape(ctx, t, {1, numel})};
+    Value t_pow = t;
+    for (size_t k = 2; k <= degree; k++) {
+      t_pow = _trunc(ctx, _mul(ctx, t_pow, t));
+      powers.push_back(reshape(ctx, t_pow, {1, numel}));
+    }
+
+    const auto coeffs =
+        slice(ctx, params, {2, 0}, {num_params, numel}, {});
+    const auto terms = _mul(ctx, coeffs, concatenate(ctx, powers, 0));
+    const auto sum = _mmul(
+        ctx, constant(ctx, 1, {1, static_cast<int64_t>(degree)}), terms);
+    res = _add(ctx, res, reshape(ctx, _trunc(ctx, sum), {numel}));
+  }
+
+  return reshape(ctx, res, x.shape()).asFxp();
+}
+
+Value f_gelu(HalContext* ctx, const Value& x) {
+  SPU_TRACE_HAL_LEAF(ctx, x);
+
+  YACL_ENFORCE(x.isFxp());
+
+  return f_piecewise(ctx, x, getPiecewiseSpec(PiecewiseFunction::Gelu));
+}
+
 }  // namespace spu::kernel::hal
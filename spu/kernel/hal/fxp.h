@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "spu/kernel/context.h"
 #include "spu/kernel/value.h"
 
@@ -37,6 +40,10 @@ Value exp2_pade_approx(HalContext* ctx, const Value& x);
 // Works for range [-12.0, 18.0]
 Value exp_pade_approx(HalContext* ctx, const Value& x);
 
+// Works for range [-2^K, 2^K) * ln(2), of 2^K + 2 * fxp_bits below the ring
+// bits, e.g. [-11.0, 11.0] of FM64.
+Value exp_range_reduced(HalContext* ctx, const Value& x);
+
 }  // namespace detail
 
 Value f_negate(HalContext* ctx, const Value& x);
@@ -51,8 +58,20 @@ Value f_sub(HalContext* ctx, const Value& x, const Value& y);
 
 Value f_mul(HalContext* ctx, const Value& x, const Value& y);
 
+// Multiply without truncation, the product carries pending truncation bits,
+// which are aligned by f_add and truncated once by f_trunc_pending.
+Value f_mul_lazy(HalContext* ctx, const Value& x, const Value& y);
+
 Value f_mmul(HalContext* ctx, const Value& x, const Value& y);
 
+// (B, M, K) x (B, K, N) of fixed-points, truncated once for the batch.
+Value f_batch_mmul(HalContext* ctx, const Value& x, const Value& y);
+
+Value f_mmul_lazy(HalContext* ctx, const Value& x, const Value& y);
+
+// Truncate the pending bits of a fixed-point, if any.
+Value f_trunc_pending(HalContext* ctx, const Value& x);
+
 Value f_div(HalContext* ctx, const Value& x, const Value& y);
 
 Value f_square(HalContext* ctx, const Value& x);
@@ -81,4 +100,54 @@ Value f_rsqrt(HalContext* ctx, const Value& x);
 
 Value f_sqrt(HalContext* ctx, const Value& x);
 
+/// A piecewise polynomial approximation of a fixed-point function.
+//
+// The sorted breakpoints split the real line into breakpoints.size() + 1
+// segments, the i-th segment is [breakpoints[i-1], breakpoints[i]). On each
+// segment, f(x) = sum_k coeffs[k] * (x - center)^k.
+struct PiecewisePolynomial {
+  struct Segment {
+    double center = 0;
+    std::vector<double> coeffs;
+  };
+
+  std::vector<double> breakpoints;
+  std::vector<Segment> segments;
+};
+
+/// Compile a function into a piecewise polynomial by interpolating it at the
+/// Chebyshev nodes of each finite segment.
+// @param fn, the function to approximate.
+// @param breakpoints, the sorted breakpoints, at least one.
+// @param degree, the degree of polynomials of finite segments.
+// @param left_tail, coefficients of the polynomial of x below the first
+//        breakpoint, constant term first.
+// @param right_tail, coefficients of the polynomial of x above the last
+//        breakpoint, constant term first.
+PiecewisePolynomial compilePiecewisePolynomial(
+    const std::function<double(double)>& fn,
+    const std::vector<double>& breakpoints, size_t degree,
+    const std::vector<double>& left_tail,
+    const std::vector<double>& right_tail);
+
+/// The builtin piecewise polynomials.
+enum class PiecewiseFunction {
+  Exp,      // exp(x), 0 below -16, saturates at exp(8)
+  Sigmoid,  // 1 / (1 + exp(-x)), 0 below -8, 1 above 8
+  Gelu,     // x * Phi(x), 0 below -4, x above 4
+};
+
+// Return the builtin piecewise polynomial of a function, compiled once.
+const PiecewisePolynomial& getPiecewiseSpec(PiecewiseFunction fn);
+
+/// Evaluate a piecewise polynomial.
+//
+// The segment of each element is selected by one batched comparison against
+// all breakpoints, coefficients of the segment are then picked locally, and
+// all terms are multiplied in one round and truncated once.
+Value f_piecewise(HalContext* ctx, const Value& x,
+                  const PiecewisePolynomial& pp);
+
+Value f_gelu(HalContext* ctx, const Value& x);
+
 }  // namespace spu::kernel::hal
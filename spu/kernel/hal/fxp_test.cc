@@ -14,6 +14,8 @@
 
 #include "spu/kernel/hal/fxp.h"
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 #include "xtensor/xio.hpp"
 
@@ -99,6 +101,40 @@ TEST_P(ParamFxpTest, DISABLED_mmul) {
   }
 }
 
+TEST(FxpTest, LazyMul) {
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> a{1.5, -2.25, 3.0, 0.125};
+  xt::xarray<float> b{0.5, 4.0, -1.25, 7.0};
+  xt::xarray<float> c{-3.0, 0.75, 2.5, -0.5};
+
+  Value sa = const_secret(&ctx, a);
+  Value sb = const_secret(&ctx, b);
+  Value pc = constant(&ctx, c);
+
+  Value ab = f_mul_lazy(&ctx, sa, sb);
+  EXPECT_EQ(ab.pendingTruncBits(), ctx.getFxpBits());
+
+  // pending bits are aligned, a + a*b - b*c.
+  Value sum = f_sub(&ctx, f_add(&ctx, sa, ab), f_mul_lazy(&ctx, sb, pc));
+  EXPECT_EQ(sum.pendingTruncBits(), ctx.getFxpBits());
+
+  Value res = f_trunc_pending(&ctx, sum);
+  EXPECT_EQ(res.dtype(), DT_FXP);
+  EXPECT_EQ(res.pendingTruncBits(), 0);
+  auto y = test::dump_public_as<float>(&ctx, _s2p(&ctx, res).asFxp());
+  EXPECT_TRUE(xt::allclose(a + a * b - b * c, y, 0.01, 0.001)) << y;
+
+  // operands are truncated before multiplication.
+  Value abb = f_mul(&ctx, ab, sb);
+  EXPECT_EQ(abb.pendingTruncBits(), 0);
+  y = test::dump_public_as<float>(&ctx, _s2p(&ctx, abb).asFxp());
+  EXPECT_TRUE(xt::allclose(a * b * b, y, 0.01, 0.001)) << y;
+
+  // truncating public products is free.
+  EXPECT_EQ(f_mul_lazy(&ctx, constant(&ctx, a), pc).pendingTruncBits(), 0);
+}
+
 TEST(FxpTest, Reciprocal) {
   // GIVEN
   HalContext ctx = test::makeRefHalContext();
@@ -179,6 +215,76 @@ TEST(FxpTest, Div) {
   }
 }
 
+TEST(FxpTest, ReciprocalPolySeed) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_fxp_reciprocal_mode(RuntimeConfig::RECIPROCAL_POLY);
+  HalContext ctx = test::makeRefHalContext(config);
+
+  xt::xarray<float> x{
+      {1.0, -2.0, -15000}, {-0.5, 3.14, 15000}, {10000, 60000, 260000}};
+  xt::xarray<float> y{{1.0, 200000.0, 200000, 100, 3.14, 0.003}};
+  xt::xarray<float> z{{1.0, -200000.0, 7000000, -0.5, 314000, 1.5}};
+  xt::xarray<float> u{0.36, 1.25, 2.5, 32, 123, 234.75, 556.6, 12142};
+
+  // one goldschmidt iteration.
+  {
+    auto c = f_reciprocal(&ctx, const_secret(&ctx, x));
+    auto r = test::dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+    EXPECT_TRUE(xt::allclose(1.0f / x, r, 0.001, 0.0001))
+        << (1.0 / x) << std::endl
+        << r;
+  }
+
+  {
+    auto c = f_div(&ctx, const_secret(&ctx, z), const_secret(&ctx, y));
+    auto r = test::dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+    EXPECT_TRUE(xt::allclose(z / y, r, 0.01, 0.001)) << (z / y) << std::endl
+                                                     << r;
+  }
+
+  {
+    auto c = f_rsqrt(&ctx, const_secret(&ctx, u));
+    auto r = test::dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+    auto expected = 1.0f / xt::sqrt(u);
+    EXPECT_TRUE(xt::allclose(expected, r, 0.01, 0.001)) << expected << std::endl
+                                                        << r;
+  }
+}
+
+TEST(FxpTest, ScaleByPublic) {
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x{1.5, -2.25, 3.0, 0.125, -700.0};
+  Value a = const_secret(&ctx, x);
+  auto reveal = [&](const Value& v) {
+    EXPECT_EQ(v.dtype(), DT_FXP);
+    return test::dump_public_as<float>(&ctx, _s2p(&ctx, v).asFxp());
+  };
+
+  // powers of two are shifts and truncations, exact for these inputs.
+  for (float scale : {1.0F, 4.0F, 0.25F, 1024.0F}) {
+    Value s = constant(&ctx, scale, {5});
+    EXPECT_TRUE(xt::allclose(x * scale, reveal(f_mul(&ctx, a, s)), 0, 0));
+    EXPECT_TRUE(xt::allclose(x * scale, reveal(f_mul(&ctx, s, a)), 0, 0));
+    EXPECT_TRUE(xt::allclose(x / scale, reveal(f_div(&ctx, a, s)), 0, 0));
+  }
+
+  // not all the same power of two.
+  xt::xarray<float> y{2.0, 4.0, 0.5, 8.0, -2.0};
+  EXPECT_TRUE(xt::allclose(x * y, reveal(f_mul(&ctx, a, constant(&ctx, y))),
+                           0.001, 0.001));
+
+  // divisions by publics, by reciprocals or goldschmidt.
+  for (float divisor : {3.0F, -0.003F, 7.5F, 200000.0F}) {
+    Value d = constant(&ctx, divisor, {5});
+    EXPECT_TRUE(xt::allclose(x / divisor, reveal(f_div(&ctx, a, d)), 0.01,
+                             0.001))
+        << divisor;
+  }
+}
+
 TEST(FxpTest, ExponentialPublic) {
   HalContext ctx = test::makeRefHalContext();
 
@@ -234,6 +340,109 @@ TEST(FxpTest, ExponentialPade) {
       << y;
 }
 
+TEST(FxpTest, ExponentialPiecewise) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_fxp_exp_mode(RuntimeConfig::EXP_PIECEWISE);
+  HalContext ctx = test::makeRefHalContext(config);
+
+  xt::xarray<float> x = xt::linspace<float>(-20., 8., 4000);
+
+  Value a = const_secret(&ctx, x);
+  Value c = f_exp(&ctx, a);
+  EXPECT_EQ(c.dtype(), DT_FXP);
+
+  auto y = test::dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+  EXPECT_TRUE(xt::allclose(xt::exp(x), y, 0.01, 0.001))
+      << xt::exp(x) << std::endl
+      << y;
+}
+
+TEST(FxpTest, ExponentialRangeReduced) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_fxp_exp_mode(RuntimeConfig::EXP_RANGE_REDUCED);
+  HalContext ctx = test::makeRefHalContext(config);
+
+  xt::xarray<float> x = xt::linspace<float>(-20., 11., 4000);
+
+  Value a = const_secret(&ctx, x);
+  Value c = f_exp(&ctx, a);
+  EXPECT_EQ(c.dtype(), DT_FXP);
+
+  auto y = test::dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+  EXPECT_TRUE(xt::allclose(xt::exp(x), y, 0.01, 0.001))
+      << xt::exp(x) << std::endl
+      << y;
+
+  // out of range, 0 below and saturates above.
+  xt::xarray<float> wide{-500.0, -100.0, 20.0, 100.0};
+  auto z = test::dump_public_as<float>(
+      &ctx, _s2p(&ctx, f_exp(&ctx, const_secret(&ctx, wide))).asFxp());
+  EXPECT_NEAR(z(0), 0, 0.001);
+  EXPECT_NEAR(z(1), 0, 0.001);
+  EXPECT_EQ(z(2), 65536);
+  EXPECT_EQ(z(3), 65536);
+}
+
+TEST(FxpTest, Gelu) {
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = xt::linspace<float>(-8., 8., 1000);
+  xt::xarray<float> expected = xt::zeros<float>(x.shape());
+  for (size_t idx = 0; idx < x.size(); idx++) {
+    expected(idx) = x(idx) * (1 + std::erf(x(idx) / std::sqrt(2.0F))) / 2;
+  }
+
+  Value a = const_secret(&ctx, x);
+  Value c = f_gelu(&ctx, a);
+  EXPECT_EQ(c.dtype(), DT_FXP);
+
+  auto y = test::dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+  EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001))
+      << expected << std::endl
+      << y;
+}
+
+TEST(FxpTest, Piecewise) {
+  HalContext ctx = test::makeRefHalContext();
+
+  // |x| - 1 below -1, x^2 on [-1, 0), 2x + x^2 on [0, 2), 8 above 2.
+  PiecewisePolynomial pp;
+  pp.breakpoints = {-1, 0, 2};
+  pp.segments = {{0, {-1, -1}}, {0, {0, 0, 1}}, {1, {3, 4, 1}}, {0, {8}}};
+
+  xt::xarray<float> x{-3.5, -1.0, -0.5, 0.0, 0.25, 1.5, 2.0, 7.0};
+  xt::xarray<float> expected{2.5, 1.0, 0.25, 0.0, 0.5625, 5.25, 8.0, 8.0};
+
+  for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+    Value a = make_value(&ctx, vis, x);
+    Value c = f_piecewise(&ctx, a, pp);
+    EXPECT_EQ(c.dtype(), DT_FXP);
+    EXPECT_EQ(c.vtype(), vis);
+
+    auto y = test::dump_public_as<float>(
+        &ctx, c.isSecret() ? _s2p(&ctx, c).asFxp() : c);
+    EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001)) << y;
+  }
+
+  // the compiled spec interpolates a cubic exactly.
+  auto cubic = [](double v) { return v * v * v - 2 * v + 1; };
+  auto spec = compilePiecewisePolynomial(cubic, {-2, 0, 2}, 3, {0}, {0});
+  ASSERT_EQ(spec.segments.size(), 4);
+  for (const auto& segment : {spec.segments[1], spec.segments[2]}) {
+    for (double t : {-0.5, 0.3, 0.9}) {
+      double got = 0;
+      for (size_t k = 0; k < segment.coeffs.size(); k++) {
+        got += segment.coeffs[k] * std::pow(t, k);
+      }
+      EXPECT_NEAR(got, cubic(segment.center + t), 1e-9);
+    }
+  }
+}
+
 TEST(FxpTest, Log) {
   // GIVEN
   HalContext ctx = test::makeRefHalContext();
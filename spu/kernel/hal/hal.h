@@ -20,4 +20,6 @@
 #include "spu/kernel/hal/polymorphic.h"
 #include "spu/kernel/hal/random.h"
 #include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/shuffle.h"
+#include "spu/kernel/hal/stats.h"
 #include "spu/kernel/hal/type_cast.h"
@@ -14,6 +14,14 @@
 
 #include "spu/kernel/hal/integer.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "absl/numeric/bits.h"
+
+#include "spu/core/type_util.h"
+#include "spu/core/xt_helper.h"
+#include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/prot_wrapper.h"
 #include "spu/kernel/hal/ring.h"
 
@@ -24,6 +32,131 @@ namespace spu::kernel::hal {
   YACL_ENFORCE(X.isInt(), "expect lhs int, got {]", X.dtype()); \
   YACL_ENFORCE(Y.isInt(), "expect rhs int, got {]", X.dtype());
 
+namespace {
+
+// TODO: same as fxp, use range propatation instead of directly set.
+void hintNumberOfBits(const Value& a, size_t nbits) {
+  if (a.storage_type().isa<BShare>()) {
+    const_cast<Type&>(a.storage_type()).as<BShare>()->setNbits(nbits);
+  }
+}
+
+// The corrections of a reciprocal division beyond this many comparisons
+// cost more than a long division.
+constexpr size_t kMaxDivCorrections = 4;
+
+// The bits of magnitudes of divisions, the remainder is compared with the
+// divisor on 2 more bits, which should fit the ring.
+size_t getDivBits(HalContext* ctx, const Value& x, const Value& y) {
+  size_t nbits = ctx->rt_config().int_div_bits();
+  if (nbits == 0) {
+    nbits = std::max(getWidth(x.dtype()), getWidth(y.dtype()));
+  }
+  return std::min(nbits, SizeOf(ctx->getField()) * 8 - 2);
+}
+
+// x < y as an arithmetic bit, of |x - y| <= 2^nbits.
+Value lessInBits(HalContext* ctx, const Value& x, const Value& y,
+                 size_t nbits) {
+  auto diff = _sub(ctx, x, y);
+  Value lt;
+  if (diff.isSecret() && ctx->prot()->hasKernel("msb_narrow_s") &&
+      nbits + 1 < SizeOf(ctx->getField()) * 8) {
+    lt = _msb_narrow_s(ctx, diff, nbits + 1);
+  } else {
+    lt = _msb(ctx, diff);
+  }
+  return _mul(ctx, constant(ctx, 1U, x.shape()), lt);  // noop, to ashare
+}
+
+// The quotient and remainder of magnitudes below 2^nbits, by a restoring long
+// division from the most significant bit, a comparison per bit.
+std::pair<Value, Value> longDivide(HalContext* ctx, const Value& x,
+                                   const Value& y, size_t nbits) {
+  const auto k0 = constant(ctx, 0U, x.shape());
+  const auto k1 = constant(ctx, 1U, x.shape());
+
+  const auto x_bits = _or(ctx, x, k0);  // noop, to bshare
+  Value q = k0;
+  Value r = k0;
+  for (size_t idx = nbits; idx-- > 0;) {
+    auto bit = _and(ctx, _rshift(ctx, x_bits, idx), k1);
+    hintNumberOfBits(bit, 1);
+    bit = _mul(ctx, k1, bit);  // noop, to ashare
+
+    // r < y before the shift, so |r - y| <= y after it.
+    r = _add(ctx, _lshift(ctx, r, 1), bit);
+    auto lt = lessInBits(ctx, r, y, nbits);
+    r = _mux(ctx, lt, r, _sub(ctx, r, y));
+    q = _add(ctx, q, _lshift(ctx, _sub(ctx, k1, lt), idx));
+  }
+  return {q, r};
+}
+
+// The quotient and remainder of magnitudes x below 2^nbits and a public y.
+// q' = x * ceil(2^s / y) >> s overshoots q = x / y by up to 2^(nbits - s),
+// and the remainder x - q' * y of the overshoot t is in [-t * y, (1 - t) * y),
+// so t is counted by comparisons of the remainder, which run in parallel.
+std::pair<Value, Value> reciprocalDivide(HalContext* ctx, const Value& x,
+                                         const Value& y, size_t nbits,
+                                         size_t num_corrections) {
+  const auto field = ctx->getField();
+  const size_t s = SizeOf(field) * 8 - nbits;
+
+  // x * m is below 2^(nbits + s), so the shift is exact.
+  NdArrayRef m = y.data().clone();
+  DISPATCH_ALL_FIELDS(field, "_", [&]() {
+    auto m_xt = xt_mutable_adapt<ring2k_t>(m);
+    for (auto& v : m_xt) {
+      YACL_ENFORCE(v != 0, "integer division by zero");
+      v = ((static_cast<ring2k_t>(1) << s) + v - 1) / v;
+    }
+  });
+  auto q = _rshift(ctx, _mul(ctx, x, Value(m, y.dtype())), s);
+  auto r = _sub(ctx, x, _mul(ctx, q, y));
+
+  const size_t cmp_bits = nbits + absl::bit_width(num_corrections);
+  auto t = constant(ctx, 0U, x.shape());
+  for (size_t idx = 0; idx < num_corrections; idx++) {
+    // r < -idx * y
+    auto bound = _mul(ctx, constant(ctx, -static_cast<int64_t>(idx),
+                                    x.shape()), y);
+    t = _add(ctx, t, lessInBits(ctx, r, bound, cmp_bits));
+  }
+  return {_sub(ctx, q, t), _add(ctx, r, _mul(ctx, t, y))};
+}
+
+// The truncated quotient and remainder of x / y.
+std::pair<Value, Value> divide(HalContext* ctx, const Value& x,
+                               const Value& y) {
+  ENSURE_INT_AND_DTYPE_MATCH(x, y);
+
+  const auto sign_x = _sign(ctx, x);
+  const auto sign_y = _sign(ctx, y);
+  const auto abs_x = _mul(ctx, sign_x, x);
+  const auto abs_y = _mul(ctx, sign_y, y);
+
+  const size_t nbits = getDivBits(ctx, x, y);
+  const size_t s = SizeOf(ctx->getField()) * 8 - nbits;
+  const size_t num_corrections =
+      nbits > s ? (static_cast<size_t>(1) << std::min<size_t>(nbits - s, 8))
+                : 1;
+
+  Value q;
+  Value r;
+  if (y.isPublic() && num_corrections <= kMaxDivCorrections) {
+    std::tie(q, r) = reciprocalDivide(ctx, abs_x, abs_y, nbits,
+                                      num_corrections);
+  } else {
+    std::tie(q, r) = longDivide(ctx, abs_x, abs_y, nbits);
+  }
+
+  return {_mul(ctx, q, _mul(ctx, sign_x, sign_y)).setDtype(x.dtype()),
+          _mul(ctx, r, sign_x).setDtype(x.dtype())};
+}
+
+}  // namespace
+
 #define DEF_UNARY_OP(Name, Fn2K)                              \
   Value Name(HalContext* ctx, const Value& x) {               \
     SPU_TRACE_HAL_LEAF(ctx, x);                               \
@@ -47,6 +180,7 @@ DEF_UNARY_OP(i_negate, _negate)
 DEF_BINARY_OP(i_add, _add)
 DEF_BINARY_OP(i_mul, _mul)
 DEF_BINARY_OP(i_mmul, _mmul)
+DEF_BINARY_OP(i_batch_mmul, _batch_mmul)
 
 Value i_less(HalContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_LEAF(ctx, x, y);
@@ -83,4 +217,16 @@ Value i_sub(HalContext* ctx, const Value& x, const Value& y) {
   return i_add(ctx, x, i_negate(ctx, y));
 }
 
+Value i_div(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  return divide(ctx, x, y).first;
+}
+
+Value i_rem(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  return divide(ctx, x, y).second;
+}
+
 }  // namespace spu::kernel::hal
@@ -37,8 +37,22 @@ Value i_mul(HalContext* ctx, const Value& x, const Value& y);
 
 Value i_mmul(HalContext* ctx, const Value& x, const Value& y);
 
+Value i_batch_mmul(HalContext* ctx, const Value& x, const Value& y);
+
 Value i_equal(HalContext* ctx, const Value& x, const Value& y);
 
 Value i_less(HalContext* ctx, const Value& x, const Value& y);
 
+// Integer division of truncated semantics, i.e. the quotient rounds toward
+// zero and the remainder takes the sign of x, as C++ does.
+//
+// A secret divisor takes a bitwise long division of the magnitudes, a
+// comparison per bit of `RuntimeConfig.int_div_bits`. A public divisor is
+// multiplied by its reciprocal then corrected exactly, which takes an exact
+// shift and a few comparisons in parallel, of any bit-width. Divisions by
+// zero are undefined.
+Value i_div(HalContext* ctx, const Value& x, const Value& y);
+
+Value i_rem(HalContext* ctx, const Value& x, const Value& y);
+
 }  // namespace spu::kernel::hal
@@ -14,7 +14,10 @@
 
 #include "spu/kernel/hal/integer.h"
 
+#include <limits>
+
 #include "gtest/gtest.h"
+#include "xtensor/xoperation.hpp"
 
 #include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/test_util.h"
@@ -72,4 +75,40 @@ TEST(IntegralTest, Sub) {
   }
 }
 
+TEST(IntegralTest, DivRem) {
+  xt::xarray<int32_t> x = test::xt_random<int32_t>({4, 5});
+  xt::xarray<int32_t> y = test::xt_random<int32_t>({4, 5}, -10, 10);
+  y = xt::where(xt::equal(y, 0), 7, y);
+  x(0, 0) = std::numeric_limits<int32_t>::max();
+  x(0, 1) = std::numeric_limits<int32_t>::min() + 1;
+  y(0, 2) = std::numeric_limits<int32_t>::max();
+  y(0, 3) = 1;
+
+  for (auto x_vtype : {VIS_PUBLIC, VIS_SECRET}) {
+    for (auto y_vtype : {VIS_PUBLIC, VIS_SECRET}) {
+      auto q = test::evalBinaryOp<int32_t>(x_vtype, y_vtype, i_div, x, y);
+      auto r = test::evalBinaryOp<int32_t>(x_vtype, y_vtype, i_rem, x, y);
+
+      EXPECT_EQ(q, x / y) << x_vtype << " " << y_vtype;
+      EXPECT_EQ(r, x % y) << x_vtype << " " << y_vtype;
+    }
+  }
+}
+
+TEST(IntegralTest, DivBits) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_int_div_bits(8);
+  HalContext ctx = test::makeRefHalContext(config);
+
+  xt::xarray<int32_t> x = {200, -200, 13, 0};
+  xt::xarray<int32_t> y = {7, 9, -255, 3};
+  Value a = make_value(&ctx, VIS_SECRET, x);
+  Value b = make_value(&ctx, VIS_SECRET, y);
+
+  Value q = _s2p(&ctx, i_div(&ctx, a, b)).setDtype(DT_I32);
+  EXPECT_EQ(test::dump_public_as<int32_t>(&ctx, q), x / y);
+}
+
 }  // namespace spu::kernel::hal
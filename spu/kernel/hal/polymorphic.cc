@@ -14,6 +14,8 @@
 
 #include "spu/kernel/hal/polymorphic.h"
 
+#include <numeric>
+
 #include "fmt/format.h"
 #include "fmt/ostream.h"
 #include "yacl/base/exception.h"
@@ -27,6 +29,7 @@
 #include "spu/kernel/hal/permute_util.h"
 #include "spu/kernel/hal/ring.h"  // for fast fxp x int
 #include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/shuffle.h"
 #include "spu/kernel/hal/type_cast.h"
 
 // TODO: handle dtype promotion inside integer dtypes.
@@ -153,6 +156,16 @@ Value matmul(HalContext* ctx, const Value& x, const Value& y) {
   return dtypeBinaryDispatch<f_mmul, i_mmul>("mmul", ctx, x, y);
 }
 
+Value batch_matmul(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_DISP(ctx, x, y);
+  if (isCrossIntFxp(x, y)) {
+    return _batch_mmul(ctx, x, y).asFxp();
+  }
+
+  return dtypeBinaryDispatch<f_batch_mmul, i_batch_mmul>("batch_mmul", ctx, x,
+                                                         y);
+}
+
 Value logical_not(HalContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
 
@@ -170,13 +183,9 @@ Value equal(HalContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_DISP(ctx, x, y);
   YACL_ENFORCE(x.shape() == y.shape(), "x = {}, y = {}", x, y);
 
-  // TODO(junfeng): Implement the real equal!
-  return bitwise_and(ctx, logical_not(ctx, less(ctx, x, y)),
-                     logical_not(ctx, less(ctx, y, x)));
-
-  // TODO(jint) following method not work, but slower ...
-  // With highly optimized msb implementation, A2B+PreOr is slower than 2*MSB
-  // return _eqz(ctx, sub(ctx, x, y)).setDtype(DT_I1);
+  // eqz(x - y) reduces the bits of the difference by a log-depth or-tree,
+  // which is cheaper than two comparisons.
+  return dtypeBinaryDispatch<f_equal, i_equal>("equal", ctx, x, y);
 }
 
 Value not_equal(HalContext* ctx, const Value& x, const Value& y) {
@@ -313,6 +322,10 @@ Value logistic(HalContext* ctx, const Value& in) {
     case RuntimeConfig::SIGMOID_REAL: {
       return logisticReal(ctx, in);
     }
+    case RuntimeConfig::SIGMOID_PIECEWISE: {
+      return f_piecewise(ctx, in,
+                         getPiecewiseSpec(PiecewiseFunction::Sigmoid));
+    }
     default: {
       YACL_THROW("Should not hit");
     }
@@ -376,42 +389,11 @@ Value power(HalContext* ctx, const Value& x, const Value& y) {
   return exp(ctx, mul(ctx, y, log(ctx, x)));
 }
 
-Value idiv(HalContext* ctx, const Value& x, const Value& y) {
-  auto sign_x = sign(ctx, x);
-  auto sign_y = sign(ctx, y);
-
-  auto abs_x = mul(ctx, x, sign_x);
-  auto abs_y = mul(ctx, y, sign_y);
-
-  Value q;
-  {
-    const auto x_f = dtype_cast(ctx, abs_x, DT_FXP);
-    const auto y_f = dtype_cast(ctx, abs_y, DT_FXP);
-
-    auto approx_q = div(ctx, x_f, y_f);
-
-    // Due to truncation error and limited precision of fxp, the approximate
-    // quotient shoud be corrected
-    approx_q = dtype_cast(ctx, approx_q, x.dtype());
-
-    auto approx_x = mul(ctx, abs_y, approx_q);
-
-    // if (approx_q + 1) * y <= x, then ++approx_q;
-    auto v1 = less_equal(ctx, add(ctx, approx_x, abs_y), abs_x);
-    // if approx_q * y > x, then --approx_q;
-    auto v2 = greater(ctx, approx_x, abs_x);
-
-    q = sub(ctx, add(ctx, approx_q, v1), v2);
-  }
-
-  return mul(ctx, q, mul(ctx, sign_x, sign_y));
-}
-
 Value div(HalContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_DISP(ctx, x, y);
 
   if (x.isInt() && y.isInt()) {
-    return idiv(ctx, x, y);
+    return i_div(ctx, x, y);
   }
 
   const auto x_f = dtype_cast(ctx, x, DT_FXP);
@@ -477,7 +459,17 @@ Value permute(HalContext* ctx, const Value& x, size_t dimension,
       return permute(ctx, x, dimension, xt::eval(permutations_xt_casted));
     });
   } else if (permutations.isSecret()) {
-    YACL_THROW("unimplemented.");
+    YACL_ENFORCE(x.shape().size() == 1 && dimension == 0 &&
+                     has_secret_shuffle(ctx),
+                 "secret permutation is only supported for 1-D values with "
+                 "a shuffle capable protocol");
+    YACL_ENFORCE(x.numel() == permutations.numel());
+    // out[i] = x[perm[i]], that is, x[j] is scattered to the inverse of perm.
+    std::vector<int64_t> iota(x.numel());
+    std::iota(iota.begin(), iota.end(), 0);
+    auto inverse = apply_perm(ctx, {constant(ctx, iota, {x.numel()})},
+                              permutations)[0];
+    return apply_perm(ctx, {x}, inverse)[0];
   }
 
   YACL_THROW("unsupport op={} for {}", "permute", permutations);
@@ -56,6 +56,11 @@ Value bitwise_not(HalContext* ctx, const Value& in);
 // @param y, the second parameter
 Value matmul(HalContext* ctx, const Value& x, const Value& y);
 
+/// batched matrix production operator, (B, M, K) x (B, K, N) -> (B, M, N)
+// @param x, the first parameter
+// @param y, the second parameter
+Value batch_matmul(HalContext* ctx, const Value& x, const Value& y);
+
 /// general element-wise bitwise equal operator
 // @param x, the first parameter
 // @param y, the second parameter
@@ -176,6 +181,9 @@ Value right_shift_logical(HalContext* ctx, const Value& x, size_t bits);
 Value right_shift_arithmetic(HalContext* ctx, const Value& x, size_t bits);
 
 // TODO: why this function? It's not involoved in XLA dispatch path.
+//
+// out[i] = x[permutations[i]], secret permutations are only supported for
+// 1-D values with protocols which could shuffle secrets.
 Value permute(HalContext* ctx, const Value& x, size_t dimension,
               const Value& permutations);
 
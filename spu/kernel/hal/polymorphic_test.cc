@@ -221,6 +221,34 @@ TYPED_TEST(MathTest, Matmul) {
   // }
 }
 
+TYPED_TEST(MathTest, BatchMatmul) {
+  using LHS_DT = typename std::tuple_element<0, TypeParam>::type;
+  using LHS_VT = typename std::tuple_element<1, TypeParam>::type;
+  using RHS_DT = typename std::tuple_element<2, TypeParam>::type;
+  using RHS_VT = typename std::tuple_element<3, TypeParam>::type;
+  using RES_DT = typename std::tuple_element<4, TypeParam>::type;
+  using PT = std::common_type_t<LHS_DT, RHS_DT>;
+
+  // GIVEN
+  const xt::xarray<LHS_DT> x = test::xt_random<LHS_DT>({3, 5, 6});
+  const xt::xarray<RHS_DT> y = test::xt_random<RHS_DT>({3, 6, 7});
+
+  // WHAT
+  auto z = test::evalBinaryOp<RES_DT>(LHS_VT(), RHS_VT(), batch_matmul, x, y);
+
+  // THEN
+  const xt::xarray<PT> xp = xt::cast<PT>(x);
+  const xt::xarray<PT> yp = xt::cast<PT>(y);
+  xt::xarray<PT> expected = xt::zeros<PT>({3, 5, 7});
+  for (size_t b = 0; b < 3; ++b) {
+    mpc::linalg::matmul(5, 7, 6, xp.data() + b * 30, 6, 1, yp.data() + b * 42,
+                        7, 1, expected.data() + b * 35, 7, 1);
+  }
+
+  EXPECT_TRUE(xt::allclose(expected, z, 0.01, 0.001)) << expected << std::endl
+                                                      << z << std::endl;
+}
+
 using LogicOpTestTypes = ::testing::Types<
     // ss
     std::tuple<float, secret_v, float, secret_v, int64_t>,      // (sfxp, sfxp)
@@ -711,7 +739,8 @@ TEST(MathTest, GreaterWithLargeNumber) {
 INSTANTIATE_TEST_SUITE_P(
     LogisticTestInstance, LogisticTest,
     testing::Values(RuntimeConfig::SIGMOID_MM1, RuntimeConfig::SIGMOID_SEG3,
-                    RuntimeConfig::SIGMOID_REAL),
+                    RuntimeConfig::SIGMOID_REAL,
+                    RuntimeConfig::SIGMOID_PIECEWISE),
     [](const testing::TestParamInfo<LogisticTest::ParamType>& p) {
       return fmt::format("{}", p.param);
     });
@@ -25,6 +25,7 @@
 #include "spu/core/shape_util.h"
 #include "spu/core/type_util.h"
 #include "spu/mpc/api.h"
+#include "spu/mpc/common/pub2k.h"
 
 namespace spu::kernel::hal {
 namespace {
@@ -42,6 +43,10 @@ ArrayRef flattenValue(const Value& v) {
   return flatten(v.data());
 }
 
+// Pub2k values are plain rings, which could be evaluated locally without
+// going through the kernel dispatch of the protocol.
+bool isPub2k(const Value& v) { return v.storage_type().isa<mpc::Pub2kTy>(); }
+
 std::tuple<int64_t, int64_t, int64_t> deduceMmulArgs(
     const std::vector<int64_t>& lhs, const std::vector<int64_t>& rhs) {
   YACL_ENFORCE(!lhs.empty() && lhs.size() <= 2);
@@ -104,6 +109,57 @@ std::tuple<int64_t, int64_t, int64_t> deduceMmulArgs(
     return unflattenValue(ret, {m, n});                                    \
   }
 
+// The public only ops skip the kernel dispatch if operands are Pub2k.
+#define MAP_PUB_UNARY_OP(NAME)                                         \
+  Value _##NAME(HalContext* ctx, const Value& in) {                    \
+    SPU_TRACE_HAL_DISP(ctx, in);                                       \
+    auto ret = isPub2k(in) ? mpc::pub2k::NAME(flattenValue(in))        \
+                           : mpc::NAME(ctx->prot(), flattenValue(in)); \
+    return unflattenValue(ret, in.shape());                            \
+  }
+
+#define MAP_PUB_SHIFT_OP(NAME)                                       \
+  Value _##NAME(HalContext* ctx, const Value& in, size_t bits) {     \
+    SPU_TRACE_HAL_DISP(ctx, in, bits);                               \
+    auto ret = isPub2k(in)                                           \
+                   ? mpc::pub2k::NAME(flattenValue(in), bits)        \
+                   : mpc::NAME(ctx->prot(), flattenValue(in), bits); \
+    return unflattenValue(ret, in.shape());                          \
+  }
+
+#define MAP_PUB_BITREV_OP(NAME)                                               \
+  Value _##NAME(HalContext* ctx, const Value& in, size_t start, size_t end) { \
+    SPU_TRACE_HAL_DISP(ctx, in, start, end);                                  \
+    auto ret = isPub2k(in)                                                    \
+                   ? mpc::pub2k::NAME(flattenValue(in), start, end)           \
+                   : mpc::NAME(ctx->prot(), flattenValue(in), start, end);    \
+    return unflattenValue(ret, in.shape());                                   \
+  }
+
+#define MAP_PUB_BINARY_OP(NAME)                                         \
+  Value _##NAME(HalContext* ctx, const Value& x, const Value& y) {      \
+    SPU_TRACE_HAL_DISP(ctx, x, y);                                      \
+    YACL_ENFORCE(x.shape() == y.shape(), "shape mismatch: x={}, y={}",  \
+                 x.shape(), y.shape());                                 \
+    auto ret =                                                          \
+        isPub2k(x) && isPub2k(y)                                        \
+            ? mpc::pub2k::NAME(flattenValue(x), flattenValue(y))        \
+            : mpc::NAME(ctx->prot(), flattenValue(x), flattenValue(y)); \
+    return unflattenValue(ret, x.shape());                              \
+  }
+
+#define MAP_PUB_MMUL_OP(NAME)                                              \
+  Value _##NAME(HalContext* ctx, const Value& x, const Value& y) {         \
+    SPU_TRACE_HAL_DISP(ctx, x, y);                                         \
+    auto [m, n, k] = deduceMmulArgs(x.shape(), y.shape());                 \
+    auto ret = isPub2k(x) && isPub2k(y)                                    \
+                   ? mpc::pub2k::NAME(flattenValue(x), flattenValue(y), m, \
+                                      n, k)                                \
+                   : mpc::NAME(ctx->prot(), flattenValue(x),               \
+                               flattenValue(y), m, n, k);                  \
+    return unflattenValue(ret, {m, n});                                    \
+  }
+
 Type _common_type_s(HalContext* ctx, const Type& a, const Type& b) {
   SPU_TRACE_HAL_DISP(ctx, a, b);
   return mpc::common_type_s(ctx->prot(), a, b);
@@ -115,37 +171,74 @@ Value _cast_type_s(HalContext* ctx, const Value& in, const Type& to) {
   return unflattenValue(ret, in.shape());
 }
 
+Value _rand_s(HalContext* ctx, absl::Span<const int64_t> shape) {
+  SPU_TRACE_HAL_DISP(ctx, shape);
+  auto ret = mpc::rand_s(ctx->prot(), ctx->getField(), calcNumel(shape));
+  return unflattenValue(ret, {shape.begin(), shape.end()});
+}
+
+Value _shuffle_s(HalContext* ctx, const Value& x) {
+  SPU_TRACE_HAL_DISP(ctx, x);
+  YACL_ENFORCE(x.shape().size() == 2, "expect 2-D, got shape={}", x.shape());
+  // a row-major (k, n) array is a column-major n x k matrix.
+  auto ret = mpc::shuffle_s(ctx->prot(), flattenValue(x), x.shape()[1]);
+  return unflattenValue(ret, x.shape());
+}
+
 MAP_UNARY_OP(p2s)
 MAP_UNARY_OP(s2p)
-MAP_UNARY_OP(not_p)
+MAP_PUB_UNARY_OP(not_p)
 MAP_UNARY_OP(not_s)
-MAP_UNARY_OP(msb_p)
+MAP_PUB_UNARY_OP(msb_p)
 MAP_UNARY_OP(msb_s)
-MAP_UNARY_OP(eqz_p)
+MAP_PUB_UNARY_OP(eqz_p)
 MAP_UNARY_OP(eqz_s)
-MAP_SHIFT_OP(lshift_p)
+MAP_PUB_SHIFT_OP(lshift_p)
 MAP_SHIFT_OP(lshift_s)
-MAP_SHIFT_OP(rshift_p)
+MAP_PUB_SHIFT_OP(rshift_p)
 MAP_SHIFT_OP(rshift_s)
-MAP_SHIFT_OP(arshift_p)
+MAP_PUB_SHIFT_OP(arshift_p)
 MAP_SHIFT_OP(arshift_s)
 MAP_SHIFT_OP(truncpr_s)
-MAP_BITREV_OP(bitrev_p)
+MAP_SHIFT_OP(msb_narrow_s)
+MAP_PUB_BITREV_OP(bitrev_p)
 MAP_BITREV_OP(bitrev_s)
-MAP_BINARY_OP(add_pp)
+MAP_PUB_BINARY_OP(add_pp)
 MAP_BINARY_OP(add_sp)
 MAP_BINARY_OP(add_ss)
-MAP_BINARY_OP(mul_pp)
+MAP_PUB_BINARY_OP(mul_pp)
 MAP_BINARY_OP(mul_sp)
 MAP_BINARY_OP(mul_ss)
-MAP_BINARY_OP(and_pp)
+MAP_PUB_BINARY_OP(and_pp)
 MAP_BINARY_OP(and_sp)
 MAP_BINARY_OP(and_ss)
-MAP_BINARY_OP(xor_pp)
+MAP_PUB_BINARY_OP(xor_pp)
 MAP_BINARY_OP(xor_sp)
 MAP_BINARY_OP(xor_ss)
-MAP_MMUL_OP(mmul_pp)
+MAP_PUB_MMUL_OP(mmul_pp)
 MAP_MMUL_OP(mmul_sp)
 MAP_MMUL_OP(mmul_ss)
 
+Value _mmul_ss_trunc(HalContext* ctx, const Value& x, const Value& y,
+                     size_t bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, y, bits);
+  auto [m, n, k] = deduceMmulArgs(x.shape(), y.shape());
+  auto ret = mpc::mmul_ss_trunc(ctx->prot(), flattenValue(x), flattenValue(y),
+                                m, n, k, bits);
+  return unflattenValue(ret, {m, n});
+}
+
+Value _batch_mmul_ss(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_DISP(ctx, x, y);
+  YACL_ENFORCE(x.shape().size() == 3 && y.shape().size() == 3);
+  YACL_ENFORCE(x.shape()[0] == y.shape()[0] && x.shape()[2] == y.shape()[1]);
+  const int64_t batch = x.shape()[0];
+  const int64_t m = x.shape()[1];
+  const int64_t n = y.shape()[2];
+  const int64_t k = x.shape()[2];
+  auto ret = mpc::batch_mmul_ss(ctx->prot(), flattenValue(x), flattenValue(y),
+                                batch, m, n, k);
+  return unflattenValue(ret, {batch, m, n});
+}
+
 }  // namespace spu::kernel::hal
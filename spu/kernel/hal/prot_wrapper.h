@@ -31,6 +31,7 @@ Value _not_s(HalContext* ctx, const Value& x);
 
 Value _msb_p(HalContext* ctx, const Value& x);
 Value _msb_s(HalContext* ctx, const Value& x);
+Value _msb_narrow_s(HalContext* ctx, const Value& x, size_t nbits);
 
 Value _eqz_p(HalContext* ctx, const Value& x);
 Value _eqz_s(HalContext* ctx, const Value& x);
@@ -56,6 +57,9 @@ Value _mul_ss(HalContext* ctx, const Value& x, const Value& y);
 Value _mmul_pp(HalContext* ctx, const Value& x, const Value& y);
 Value _mmul_sp(HalContext* ctx, const Value& x, const Value& y);
 Value _mmul_ss(HalContext* ctx, const Value& x, const Value& y);
+Value _mmul_ss_trunc(HalContext* ctx, const Value& x, const Value& y,
+                     size_t bits);
+Value _batch_mmul_ss(HalContext* ctx, const Value& x, const Value& y);
 
 Value _and_pp(HalContext* ctx, const Value& x, const Value& y);
 Value _and_sp(HalContext* ctx, const Value& x, const Value& y);
@@ -68,4 +72,11 @@ Value _xor_ss(HalContext* ctx, const Value& x, const Value& y);
 Value _bitrev_p(HalContext* ctx, const Value& in, size_t start, size_t end);
 Value _bitrev_s(HalContext* ctx, const Value& in, size_t start, size_t end);
 
+// A secret of uniform random ring elements, unknown to all parties.
+Value _rand_s(HalContext* ctx, absl::Span<const int64_t> shape);
+
+// Shuffle a 2-D secret of shape (k, n) along the last axis, the k lines are
+// permuted by the same secret permutation.
+Value _shuffle_s(HalContext* ctx, const Value& x);
+
 }  // namespace spu::kernel::hal
@@ -14,15 +14,47 @@
 
 #include "spu/kernel/hal/random.h"
 
+#include <vector>
+
+#include "absl/numeric/bits.h"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xio.hpp"
 #include "xtensor/xrandom.hpp"
 #include "yacl/base/exception.h"
 
+#include "spu/core/shape_util.h"
+#include "spu/core/type_util.h"
 #include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/prot_wrapper.h"
+#include "spu/kernel/hal/ring.h"
+#include "spu/kernel/hal/shape_ops.h"
 #include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
 
 namespace spu::kernel::hal {
+namespace {
+
+// Secret uniform ints in [0, 2^bits), i.e. the high bits of random rings.
+Value randBits(HalContext* ctx, size_t bits,
+               absl::Span<const int64_t> to_shape) {
+  const size_t field_bits = SizeOf(ctx->getField()) * 8;
+  YACL_ENFORCE(bits > 0 && bits < field_bits, "bits={}", bits);
+  return _rshift(ctx, _rand_s(ctx, to_shape), field_bits - bits);
+}
+
+// Secret fxp uniform in [0, 1).
+Value randUnit(HalContext* ctx, absl::Span<const int64_t> to_shape) {
+  return randBits(ctx, ctx->getFxpBits(), to_shape).setDtype(DT_FXP);
+}
+
+Value broadcastScalar(HalContext* ctx, const Value& x,
+                      absl::Span<const int64_t> to_shape) {
+  YACL_ENFORCE(x.numel() == 1, "expect a scalar, got {}", x);
+  return broadcast_to(ctx, reshape(ctx, x, {}), to_shape);
+}
+
+}  // namespace
 
 Value rng_uniform(HalContext* ctx, const Value& a, const Value& b,
                   absl::Span<const int64_t> to_shape) {
@@ -46,4 +78,56 @@ Value rng_uniform(HalContext* ctx, const Value& a, const Value& b,
   return constant(ctx, randv);
 }
 
+bool has_secret_rand(HalContext* ctx) {
+  return ctx->prot()->hasKernel("rand_s");
+}
+
+Value rng_uniform_s(HalContext* ctx, const Value& a, const Value& b,
+                    absl::Span<const int64_t> to_shape) {
+  SPU_TRACE_HAL_DISP(ctx, a, b, to_shape);
+  YACL_ENFORCE(a.dtype() == b.dtype());
+  YACL_ENFORCE(has_secret_rand(ctx), "protocol could not draw secrets");
+
+  const auto lo = broadcastScalar(ctx, a, to_shape);
+  if (a.isInt() && a.isPublic() && b.isPublic()) {
+    const auto range = static_cast<uint64_t>(
+        test::dump_public_as<int64_t>(ctx, b)[0] -
+        test::dump_public_as<int64_t>(ctx, a)[0]);
+    YACL_ENFORCE(range > 0, "empty range");
+    if (range == 1) {
+      return p2s(ctx, lo);
+    }
+    if (absl::has_single_bit(range)) {
+      const auto bits = static_cast<size_t>(absl::countr_zero(range));
+      return add(ctx, lo, randBits(ctx, bits, to_shape).setDtype(a.dtype()));
+    }
+  }
+
+  auto range = broadcastScalar(ctx, sub(ctx, b, a), to_shape);
+  auto scaled = mul(ctx, randUnit(ctx, to_shape), range);
+  if (a.isInt()) {
+    // u * (b - a) is non-negative, the cast floors it into [0, b - a).
+    scaled = dtype_cast(ctx, scaled, a.dtype());
+  }
+  return add(ctx, lo, scaled);
+}
+
+Value rng_normal_s(HalContext* ctx, absl::Span<const int64_t> to_shape) {
+  SPU_TRACE_HAL_DISP(ctx, to_shape);
+  YACL_ENFORCE(has_secret_rand(ctx), "protocol could not draw secrets");
+
+  constexpr int64_t kTerms = 12;
+  const int64_t numel = calcNumel(to_shape);
+  if (numel == 0) {
+    return p2s(ctx, constant(ctx, 0.0F, to_shape));
+  }
+
+  // the sum of the uniforms is local, by a public int matmul.
+  auto u = randUnit(ctx, {kTerms, numel});
+  auto sum = matmul(ctx, constant(ctx, static_cast<int64_t>(1), {1, kTerms}),
+                    u);
+  auto normal = sub(ctx, sum, constant(ctx, 6.0F, {1, numel}));
+  return reshape(ctx, normal, to_shape);
+}
+
 }  // namespace spu::kernel::hal
@@ -26,4 +26,25 @@ namespace spu::kernel::hal {
 Value rng_uniform(HalContext* ctx, const Value& a, const Value& b,
                   absl::Span<const int64_t> to_shape);
 
+// Return true if the protocol could draw secret randomness locally.
+bool has_secret_rand(HalContext* ctx);
+
+/// Secret uniform rand, no party knows the values.
+// @param a, lower limit (include), a scalar of any visibility
+// @param b, upper limit (exclude), a scalar of the same dtype
+// @param to_shape, the target shape
+//
+// The ring elements are drawn by the protocol without communication, fxp
+// values in [0, 1) are their high fxp_bits bits, by one batched right shift
+// of all elements. Ints of a public power of two range are shifted the same.
+Value rng_uniform_s(HalContext* ctx, const Value& a, const Value& b,
+                    absl::Span<const int64_t> to_shape);
+
+/// Secret fxp rand of the standard normal distribution approximately, by the
+/// Irwin-Hall sum of 12 uniforms in [0, 1) minus 6, i.e. of mean 0 and
+/// variance 1, and tails cut at 6. Uniforms of all elements are drawn and
+/// shifted in one batch.
+// @param to_shape, the target shape
+Value rng_normal_s(HalContext* ctx, absl::Span<const int64_t> to_shape);
+
 }  // namespace spu::kernel::hal
@@ -0,0 +1,83 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hal/random.h"
+
+#include <set>
+
+#include "gtest/gtest.h"
+#include "xtensor/xio.hpp"
+#include "xtensor/xmath.hpp"
+
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hal {
+namespace {
+
+constexpr int64_t kNumel = 10000;
+
+TEST(RandomTest, UniformFxp) {
+  HalContext ctx = test::makeRefHalContext();
+  ASSERT_TRUE(has_secret_rand(&ctx));
+
+  auto r = rng_uniform_s(&ctx,
+                         make_value(&ctx, VIS_PUBLIC, xt::xarray<float>{-2}),
+                         make_value(&ctx, VIS_PUBLIC, xt::xarray<float>{3}),
+                         {kNumel});
+  EXPECT_TRUE(r.isSecret());
+  EXPECT_TRUE(r.isFxp());
+
+  auto got = test::dump_public_as<float>(&ctx, reveal(&ctx, r));
+  EXPECT_GE(xt::amin(got)(), -2);
+  EXPECT_LT(xt::amax(got)(), 3);
+  EXPECT_NEAR(xt::mean(got)(), 0.5, 0.1);
+}
+
+TEST(RandomTest, UniformInt) {
+  HalContext ctx = test::makeRefHalContext();
+
+  // a power of two range, and any other.
+  for (auto [lo, hi] : {std::pair<int64_t, int64_t>{0, 16}, {5, 12}}) {
+    auto a = make_value(&ctx, VIS_PUBLIC, xt::xarray<int64_t>{lo});
+    auto b = make_value(&ctx, VIS_PUBLIC, xt::xarray<int64_t>{hi});
+    auto r = rng_uniform_s(&ctx, a, b, {kNumel});
+    EXPECT_TRUE(r.isSecret());
+    EXPECT_TRUE(r.isInt());
+
+    auto got = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, r));
+    std::set<int64_t> seen(got.begin(), got.end());
+    EXPECT_EQ(seen.size(), static_cast<size_t>(hi - lo));
+    EXPECT_EQ(*seen.begin(), lo);
+    EXPECT_EQ(*seen.rbegin(), hi - 1);
+  }
+}
+
+TEST(RandomTest, Normal) {
+  HalContext ctx = test::makeRefHalContext();
+
+  auto r = rng_normal_s(&ctx, {100, kNumel / 100});
+  EXPECT_TRUE(r.isSecret());
+  EXPECT_EQ(r.shape(), (std::vector<int64_t>{100, kNumel / 100}));
+
+  auto got = test::dump_public_as<float>(&ctx, reveal(&ctx, r));
+  EXPECT_NEAR(xt::mean(got)(), 0, 0.05);
+  EXPECT_NEAR(xt::stddev(got)(), 1, 0.05);
+  EXPECT_GE(xt::amin(got)(), -6);
+  EXPECT_LE(xt::amax(got)(), 6);
+}
+
+}  // namespace
+}  // namespace spu::kernel::hal
@@ -14,11 +14,13 @@
 
 #include "spu/kernel/hal/ring.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 
 #include "yacl/base/exception.h"
 
+#include "spu/core/type_util.h"
 #include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/prot_wrapper.h"
 #include "spu/kernel/hal/shape_ops.h"
@@ -157,6 +159,13 @@ Value _sub(HalContext* ctx, const Value& x, const Value& y) {
 Value _eqz(HalContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
 
+  if (x.isPublic()) {
+    return _eqz_p(ctx, x);
+  }
+  if (x.isSecret() && ctx->prot()->hasKernel("eqz_s")) {
+    return _eqz_s(ctx, x);
+  }
+
   // eqz(x) = not(lsb(pre_or(x)))
   // all equal to zero means lsb equals to zero
   auto _k1 = constant(ctx, 1U, x.shape());
@@ -272,6 +281,109 @@ Value _mmul(HalContext* ctx, const Value& x, const Value& y) {
   return ret;
 }
 
+Value _mmul_trunc(HalContext* ctx, const Value& x, const Value& y,
+                  size_t bits) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y, bits);
+  bits = (bits == 0) ? ctx->getFxpBits() : bits;
+
+  if (x.isSecret() && y.isSecret() &&
+      ctx->prot()->hasKernel("mmul_ss_trunc")) {
+    auto [m, n, k] = deduceMmulArgs(x.shape(), y.shape());
+    auto [m_step, n_step, k_step] =
+        calcMmulTilingSize(m, n, k, x.elsize(), 256UL * 1024 * 1024);
+    // blocks of a split matmul are summed before the truncation.
+    if (ctx->rt_config().experimental_disable_mmul_split() ||
+        (m_step == m && n_step == n && k_step == k)) {
+      return _mmul_ss_trunc(ctx, x, y, bits);
+    }
+  }
+  return _trunc(ctx, _mmul(ctx, x, y), bits);
+}
+
+namespace {
+
+// Check the (B, M, K) x (B, K, N) shapes of a batched matmul, return (M, N, K).
+std::tuple<int64_t, int64_t, int64_t> deduceBatchMmulArgs(const Value& x,
+                                                          const Value& y) {
+  YACL_ENFORCE(x.shape().size() == 3 && y.shape().size() == 3);
+  YACL_ENFORCE(x.shape()[0] == y.shape()[0], "batch mismatch, x={}, y={}",
+               x, y);
+  YACL_ENFORCE(x.shape()[0] > 0 && y.shape()[1] == x.shape()[2]);
+  return {x.shape()[1], y.shape()[2], x.shape()[2]};
+}
+
+// Whether a batch of secret matmuls runs as one protocol invocation.
+bool useBatchKernel(HalContext* ctx, const Value& x, const Value& y,
+                    std::string_view kernel) {
+  if (!x.isSecret() || !y.isSecret() || !ctx->prot()->hasKernel(kernel)) {
+    return false;
+  }
+  auto [m, n, k] = deduceBatchMmulArgs(x, y);
+  auto [m_step, n_step, k_step] =
+      calcMmulTilingSize(m, n, k, x.elsize(), 256UL * 1024 * 1024);
+  // large matmuls are split by _mmul, and gain nothing from batching.
+  return m_step == m && n_step == n && k_step == k;
+}
+
+// Run `mmul` on every item of the batch and stack the products.
+template <typename Fn>
+Value batchByItems(HalContext* ctx, const Value& x, const Value& y,
+                   Fn&& mmul) {
+  auto [m, n, k] = deduceBatchMmulArgs(x, y);
+  const int64_t batch = x.shape()[0];
+
+  std::vector<Value> rets;
+  rets.reserve(batch);
+  for (int64_t i = 0; i < batch; ++i) {
+    auto x_i = reshape(ctx, slice(ctx, x, {i, 0, 0}, {i + 1, m, k}, {}),
+                       {m, k});
+    auto y_i = reshape(ctx, slice(ctx, y, {i, 0, 0}, {i + 1, k, n}, {}),
+                       {k, n});
+    rets.push_back(mmul(x_i, y_i));
+  }
+
+  // merge the products.
+  const auto& eltype = rets[0].data().eltype();
+  const auto& dtype = rets[0].dtype();
+  Value ret(NdArrayRef(eltype, {batch, m, n}), dtype);
+  for (int64_t i = 0; i < batch; ++i) {
+    const auto& prod = rets[i];
+    YACL_ENFORCE(prod.data().isCompact());
+    char* dst = &ret.data().at<char>({i, 0, 0});
+    const char* src = &prod.data().at<char>({0, 0});
+    std::memcpy(dst, src, prod.elsize() * prod.numel());
+  }
+  return ret;
+}
+
+}  // namespace
+
+Value _batch_mmul(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  if (useBatchKernel(ctx, x, y, "batch_mmul_ss")) {
+    return _batch_mmul_ss(ctx, x, y);
+  }
+  return batchByItems(ctx, x, y, [&](const Value& a, const Value& b) {
+    return _mmul(ctx, a, b);
+  });
+}
+
+Value _batch_mmul_trunc(HalContext* ctx, const Value& x, const Value& y,
+                        size_t bits) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y, bits);
+  bits = (bits == 0) ? ctx->getFxpBits() : bits;
+
+  // only a protocol packing the batch (cheetah) pays the one truncation of
+  // the packed products, the others keep the fused truncation of each item.
+  if (useBatchKernel(ctx, x, y, "batch_mmul_aa")) {
+    return _trunc(ctx, _batch_mmul_ss(ctx, x, y), bits);
+  }
+  return batchByItems(ctx, x, y, [&](const Value& a, const Value& b) {
+    return _mmul_trunc(ctx, a, b, bits);
+  });
+}
+
 Value _or(HalContext* ctx, const Value& x, const Value& y) {
   // X or Y = X xor Y xor (X and Y)
   return _xor(ctx, x, _xor(ctx, y, _and(ctx, x, y)));
@@ -317,7 +429,19 @@ Value _less(HalContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_LEAF(ctx, x, y);
 
   // test msb(x-y) == 1
-  return _msb(ctx, _sub(ctx, x, y));
+  auto diff = _sub(ctx, x, y);
+
+  // the difference of w-bit integers fits in w+1 signed bits, its sign could
+  // be tested on a narrower ring.
+  if (diff.isSecret() && isInteger(x.dtype()) && isInteger(y.dtype()) &&
+      ctx->prot()->hasKernel("msb_narrow_s")) {
+    const size_t nbits =
+        std::max(getWidth(x.dtype()), getWidth(y.dtype())) + 1;
+    if (nbits < SizeOf(ctx->getField()) * 8) {
+      return _msb_narrow_s(ctx, diff, nbits);
+    }
+  }
+  return _msb(ctx, diff);
 }
 
 // swap bits of [start, end)
@@ -46,6 +46,20 @@ Value _mul(HalContext* ctx, const Value& x, const Value& y);
 
 Value _mmul(HalContext* ctx, const Value& x, const Value& y);
 
+// _trunc(_mmul(x, y), bits), which the protocol fuses for secrets if it can,
+// e.g. aby3 truncates before resharing the products.
+Value _mmul_trunc(HalContext* ctx, const Value& x, const Value& y,
+                  size_t bits = 0);
+
+// The batched matmul of (B, M, K) x (B, K, N), the batch of secrets runs in
+// one protocol invocation if the protocol supports it.
+Value _batch_mmul(HalContext* ctx, const Value& x, const Value& y);
+
+// _trunc(_batch_mmul(x, y), bits), by a fused _mmul_trunc of every item unless
+// the protocol packs the batch into one invocation.
+Value _batch_mmul_trunc(HalContext* ctx, const Value& x, const Value& y,
+                        size_t bits = 0);
+
 Value _and(HalContext* ctx, const Value& x, const Value& y);
 
 Value _xor(HalContext* ctx, const Value& x, const Value& y);
@@ -81,12 +81,15 @@ Value transpose(HalContext* ctx, const Value& in,
     ret_strides[i] = in.strides()[perm[i]];
   }
 
+  auto transposed = NdArrayRef{in.data().buf(), in.storage_type(), ret_shape,
+                               ret_strides, in.data().offset()};
   // compact clone is a rather expensive memory operation.
   // To prevent transposed value being cloned multiple times in later ops, clone
-  // the value here.
-  auto transposed = NdArrayRef{in.data().buf(), in.storage_type(), ret_shape,
-                               ret_strides, in.data().offset()}
-                        .clone();
+  // the value here, unless kernels could use it without a copy, i.e. only dims
+  // of size 1 move.
+  if (!isFlattenNoCopy(transposed)) {
+    transposed = transposed.clone();
+  }
   return Value(transposed, in.dtype());
 }
 
@@ -233,14 +236,19 @@ Value broadcast_to(HalContext* ctx, const Value& in,
 
   std::vector<int64_t> new_strides(to_shape.size(), 0);
 
+  // a dim of size 1 repeats its only element, i.e. a zero stride.
+  auto in_stride = [&](size_t dim) {
+    return in.shape()[dim] == 1 ? 0 : in.strides()[dim];
+  };
+
   if (!in_dims.empty()) {
     for (size_t idx = 0; idx < in_dims.size(); ++idx) {
-      new_strides[in_dims[idx]] = in.strides()[idx];
+      new_strides[in_dims[idx]] = in_stride(idx);
     }
   } else {
     for (size_t idx = 0; idx < in.strides().size(); ++idx) {
       new_strides.at(new_strides.size() - 1 - idx) =
-          in.strides().at(in.strides().size() - 1 - idx);
+          in_stride(in.strides().size() - 1 - idx);
     }
   }
 
@@ -282,6 +290,48 @@ Value pad(HalContext* ctx, const Value& in, const Value& padding_value,
 
   auto elsize = result.elsize();
 
+  // Without interior padding of the minor dimension, the source is written
+  // into the padded buffer by rows.
+  const int64_t rank = input_shape.size();
+  if (rank > 0 && interior_padding[rank - 1] == 0 &&
+      in.data().strides()[rank - 1] == 1) {
+    const int64_t low = edge_padding_low[rank - 1];
+    // columns of a row in range, negative paddings remove some.
+    const int64_t begin_col = std::max<int64_t>(0, -low);
+    const int64_t end_col =
+        std::min(input_shape[rank - 1], result_shape[rank - 1] - low);
+    if (begin_col >= end_col) {
+      return result;
+    }
+
+    std::vector<int64_t> rows_shape = input_shape;
+    rows_shape[rank - 1] = 1;
+    yacl::parallel_for(
+        0, calcNumel(rows_shape), 64, [&](int64_t begin, int64_t end) {
+          std::vector<int64_t> target_index(rank);
+          for (int64_t row = begin; row < end; ++row) {
+            auto index = unflattenIndex(row, rows_shape);
+            bool valid = true;
+            for (int64_t i = 0; i + 1 < rank; ++i) {
+              target_index[i] =
+                  edge_padding_low[i] + index[i] * (interior_padding[i] + 1);
+              if (target_index[i] < 0 || target_index[i] >= result_shape[i]) {
+                valid = false;
+                break;
+              }
+            }
+            if (!valid) {
+              continue;
+            }
+            index[rank - 1] = begin_col;
+            target_index[rank - 1] = low + begin_col;
+            std::memcpy(&result.data().at(target_index), &in.data().at(index),
+                        (end_col - begin_col) * elsize);
+          }
+        });
+    return result;
+  }
+
   yacl::parallel_for(0, in.numel(), 1024, [&](int64_t begin, int64_t end) {
     std::vector<int64_t> unflatten = unflattenIndex(begin, input_shape);
 
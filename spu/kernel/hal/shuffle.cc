@@ -0,0 +1,230 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hal/shuffle.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "xtensor/xadapt.hpp"
+#include "yacl/base/exception.h"
+
+#include "spu/core/type_util.h"
+#include "spu/core/xt_helper.h"
+#include "spu/kernel/hal/concat.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/permute_util.h"
+#include "spu/kernel/hal/prot_wrapper.h"
+#include "spu/kernel/hal/ring.h"
+#include "spu/kernel/hal/shape_ops.h"
+
+namespace spu::kernel::hal {
+namespace {
+
+// Drop the dtype, values of different dtypes could be concatenated as rings.
+Value asRing(const Value& x) { return Value(x.data(), DT_INVALID); }
+
+std::vector<int64_t> revealIndices(HalContext* ctx, const Value& x) {
+  const auto p = _s2p(ctx, x);
+  std::vector<int64_t> indices(p.numel());
+  DISPATCH_ALL_FIELDS(ctx->getField(), "_", [&]() {
+    const auto p_xt = xt_adapt<ring2k_t>(p.data());
+    for (int64_t idx = 0; idx < p.numel(); idx++) {
+      indices[idx] = static_cast<int64_t>(p_xt(idx));
+    }
+  });
+  return indices;
+}
+
+// Inclusive prefix sum along the last axis of a 2-D value, in log rounds of
+// local additions.
+Value prefixSum(HalContext* ctx, const Value& x) {
+  const int64_t rows = x.shape()[0];
+  const int64_t n = x.shape()[1];
+
+  auto res = asRing(x);
+  for (int64_t offset = 1; offset < n; offset *= 2) {
+    auto zero = asRing(constant(ctx, 0, {rows, offset}));
+    auto shifted = concatenate(
+        ctx, {zero, slice(ctx, res, {0, 0}, {rows, n - offset}, {})}, 1);
+    res = _add(ctx, res, shifted);
+  }
+  return res;
+}
+
+// The destination of each element after a stable partition of each row by a
+// secret arithmetic bit, zeros first.
+//
+// With c the inclusive prefix sum of bits in a row, element j goes to
+//   j - c[j]                       if b[j] = 0
+//   (n - c[n-1]) + c[j] - 1        if b[j] = 1
+// that is, (j - c) + b * (n - 1 - j - c[n-1] + 2c).
+Value genBitPerm(HalContext* ctx, const Value& b) {
+  const int64_t rows = b.shape()[0];
+  const int64_t n = b.shape()[1];
+  const std::vector<int64_t> shape = {rows, n};
+
+  std::vector<int64_t> base(rows * n);
+  std::vector<int64_t> rest(rows * n);
+  for (int64_t row = 0; row < rows; row++) {
+    for (int64_t col = 0; col < n; col++) {
+      base[row * n + col] = row * n + col;
+      rest[row * n + col] = n - 1 - col;
+    }
+  }
+
+  auto c = prefixSum(ctx, b);
+  auto c_last = broadcast_to(
+      ctx, reshape(ctx, slice(ctx, c, {0, n - 1}, {rows, n}, {}), {rows}),
+      shape, {0});
+
+  auto offset = _add(ctx, _sub(ctx, constant(ctx, rest, shape), c_last),
+                     _add(ctx, c, c));
+  auto dest = _add(ctx, _sub(ctx, constant(ctx, base, shape), c),
+                   _mul(ctx, b, offset));
+  return reshape(ctx, dest, {rows * n});
+}
+
+bool isUnsigned(DataType dtype) {
+  return dtype == DT_I1 || dtype == DT_U8 || dtype == DT_U16 ||
+         dtype == DT_U32 || dtype == DT_U64;
+}
+
+}  // namespace
+
+bool has_secret_shuffle(HalContext* ctx) {
+  return ctx->prot()->hasKernel("shuffle_s");
+}
+
+std::vector<Value> shuffle(HalContext* ctx, absl::Span<const Value> xs) {
+  SPU_TRACE_HAL_DISP(ctx, xs.size());
+  YACL_ENFORCE(!xs.empty());
+
+  const int64_t n = xs[0].numel();
+  std::vector<Value> lines;
+  for (const auto& x : xs) {
+    YACL_ENFORCE(x.shape().size() == 1 && x.numel() == n,
+                 "expect 1-D values of length {}, got shape={}", n, x.shape());
+    auto line = x.isPublic() ? _p2s(ctx, x) : x;
+    lines.push_back(reshape(ctx, asRing(line), {1, n}));
+  }
+
+  auto shuffled = _shuffle_s(ctx, concatenate(ctx, lines, 0));
+
+  std::vector<Value> results;
+  for (size_t idx = 0; idx < xs.size(); idx++) {
+    const auto k = static_cast<int64_t>(idx);
+    auto line = slice(ctx, shuffled, {k, 0}, {k + 1, n}, {});
+    results.push_back(reshape(ctx, line, {n}).setDtype(xs[idx].dtype()));
+  }
+  return results;
+}
+
+std::vector<Value> apply_perm(HalContext* ctx, absl::Span<const Value> xs,
+                              const Value& perm) {
+  SPU_TRACE_HAL_DISP(ctx, xs.size(), perm);
+  YACL_ENFORCE(perm.isSecret() && perm.shape().size() == 1);
+
+  std::vector<Value> columns = {perm};
+  columns.insert(columns.end(), xs.begin(), xs.end());
+  auto shuffled = shuffle(ctx, columns);
+
+  // the shuffled permutation is uniformly random, it's safe to reveal.
+  const auto dest = revealIndices(ctx, shuffled[0]);
+  std::vector<int64_t> gather(dest.size(), -1);
+  for (size_t idx = 0; idx < dest.size(); idx++) {
+    YACL_ENFORCE(dest[idx] >= 0 &&
+                     dest[idx] < static_cast<int64_t>(dest.size()) &&
+                     gather[dest[idx]] == -1,
+                 "invalid permutation");
+    gather[dest[idx]] = static_cast<int64_t>(idx);
+  }
+
+  std::vector<Value> results;
+  for (size_t idx = 1; idx < shuffled.size(); idx++) {
+    results.push_back(permute(ctx, shuffled[idx], 0, xt::adapt(gather)));
+  }
+  return results;
+}
+
+std::pair<std::vector<Value>, Value> compact(HalContext* ctx,
+                                             absl::Span<const Value> xs,
+                                             const Value& mask) {
+  SPU_TRACE_HAL_DISP(ctx, xs.size(), mask);
+  YACL_ENFORCE(mask.isSecret() && mask.shape().size() == 1);
+
+  const int64_t n = mask.numel();
+  const auto k1 = constant(ctx, 1, {1, n});
+  auto b = _mul(ctx, reshape(ctx, asRing(mask), {1, n}), k1);  // nop, to ashr.
+
+  // the count is a local dot with ones.
+  auto count = _mmul(ctx, b, constant(ctx, 1, {n, 1}));
+
+  // selected elements are the zeros of the partition.
+  const auto dest = genBitPerm(ctx, _sub(ctx, k1, b));
+  return {apply_perm(ctx, xs, dest), reshape(ctx, count, {}).setDtype(DT_I64)};
+}
+
+Value gen_sort_perm(HalContext* ctx, const Value& keys, bool descending) {
+  SPU_TRACE_HAL_DISP(ctx, keys, descending);
+  YACL_ENFORCE(keys.isSecret() && keys.shape().size() == 2);
+
+  const int64_t total = keys.numel();
+  const std::vector<int64_t> shape = keys.shape();
+
+  // sign-extended integers only have getWidth(dtype) meaningful bits, the
+  // highest is the sign, which is flipped to order negatives first.
+  const size_t field_bits = SizeOf(ctx->getField()) * 8;
+  size_t nbits = field_bits;
+  if (isInteger(keys.dtype())) {
+    nbits = std::min(getWidth(keys.dtype()), field_bits);
+  }
+  const bool is_signed = !isUnsigned(keys.dtype());
+
+  std::vector<int64_t> iota(total);
+  std::iota(iota.begin(), iota.end(), 0);
+
+  const auto k1 = constant(ctx, 1, shape);
+
+  // LSD radix sort, each round stably partitions rows by one bit and moves
+  // the key and the tracking indices t there, where t[r] is the original
+  // position of the element ranked r.
+  auto key = asRing(keys);
+  auto t = _p2s(ctx, constant(ctx, iota, {total}));
+  for (size_t bit = 0; bit < nbits; bit++) {
+    auto b = _and(ctx, _rshift(ctx, key, bit), k1);
+    if ((is_signed && bit + 1 == nbits) != descending) {
+      b = _xor(ctx, b, k1);
+    }
+    // like _eqz, hint the bit width so the conversion is cheap.
+    if (b.storage_type().isa<BShare>()) {
+      const_cast<Type&>(b.storage_type()).as<BShare>()->setNbits(1);
+    }
+    b = _mul(ctx, b, k1);  // nop, cast to ashr.
+
+    const auto dest = genBitPerm(ctx, b);
+    if (bit + 1 < nbits) {
+      auto moved = apply_perm(ctx, {reshape(ctx, key, {total}), t}, dest);
+      key = reshape(ctx, moved[0], shape);
+      t = moved[1];
+    } else {
+      t = apply_perm(ctx, {t}, dest)[0];
+    }
+  }
+
+  // invert t, the destination of element j is the rank r where t[r] = j.
+  return apply_perm(ctx, {constant(ctx, iota, {total})}, t)[0];
+}
+
+}  // namespace spu::kernel::hal
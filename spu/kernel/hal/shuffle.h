@@ -0,0 +1,64 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+
+#include "spu/kernel/context.h"
+#include "spu/kernel/value.h"
+
+namespace spu::kernel::hal {
+
+// Return true if the protocol could shuffle secrets.
+bool has_secret_shuffle(HalContext* ctx);
+
+/// Shuffle 1-D values of the same length by one secret random permutation.
+// @param xs, the values, public ones are shuffled as secrets.
+std::vector<Value> shuffle(HalContext* ctx, absl::Span<const Value> xs);
+
+/// Apply a secret permutation in scatter form, out[perm[i]] = x[i].
+//
+// The values and the permutation are shuffled together, then the shuffled
+// permutation is revealed, which is uniformly random, and the values are
+// moved to their destinations locally.
+// @param xs, 1-D values of the same length as perm.
+// @param perm, a secret permutation of [0, n).
+std::vector<Value> apply_perm(HalContext* ctx, absl::Span<const Value> xs,
+                              const Value& perm);
+
+/// Stably move the elements of a secret mask 1 to the front.
+//
+// The destinations are one stable partition by the mask bit, like a round of
+// `gen_sort_perm`, then applied by `apply_perm`, so it takes the rounds of
+// one shuffle instead of a sort. The order of the rest is stable too.
+// @param xs, 1-D values of the same length as mask.
+// @param mask, a 1-D secret of 0 and 1.
+// @return the moved values and the secret count of selected elements.
+std::pair<std::vector<Value>, Value> compact(HalContext* ctx,
+                                             absl::Span<const Value> xs,
+                                             const Value& mask);
+
+/// Generate the secret permutation which stably sorts each row of a 2-D
+/// secret by a radix sort over its bits.
+// @param keys, a secret of shape (num_rows, n).
+// @param descending, sort in descending order.
+// @return the permutation in scatter form over the flattened keys, i.e. the
+//         destination of each element, as a 1-D secret int.
+Value gen_sort_perm(HalContext* ctx, const Value& keys, bool descending);
+
+}  // namespace spu::kernel::hal
@@ -0,0 +1,136 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hal/shuffle.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "gtest/gtest.h"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xio.hpp"
+#include "xtensor/xsort.hpp"
+
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hal {
+namespace {
+
+TEST(ShuffleTest, Shuffle) {
+  HalContext ctx = test::makeRefHalContext();
+  ASSERT_TRUE(has_secret_shuffle(&ctx));
+
+  const xt::xarray<int64_t> x = xt::arange<int64_t>(100);
+  const xt::xarray<int64_t> y = x * 3 + 7;
+
+  auto res = shuffle(&ctx, {make_value(&ctx, VIS_SECRET, x),
+                            make_value(&ctx, VIS_PUBLIC, y)});
+  ASSERT_EQ(res.size(), 2);
+  EXPECT_TRUE(res[1].isSecret());
+
+  auto sx = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, res[0]));
+  auto sy = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, res[1]));
+  // rows are moved together.
+  EXPECT_EQ(sy, sx * 3 + 7);
+  auto sorted = xt::xarray<int64_t>(xt::sort(sx));
+  EXPECT_EQ(sorted, x);
+}
+
+TEST(ShuffleTest, Compact) {
+  HalContext ctx = test::makeRefHalContext();
+
+  const xt::xarray<int64_t> x = {5, 1, 4, 2, 8, 3};
+  const xt::xarray<int64_t> mask = {0, 1, 1, 0, 1, 0};
+
+  auto [res, count] = compact(&ctx, {make_value(&ctx, VIS_SECRET, x)},
+                              make_value(&ctx, VIS_SECRET, mask));
+  ASSERT_EQ(res.size(), 1);
+  EXPECT_TRUE(count.isSecret());
+
+  auto got = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, res[0]));
+  const xt::xarray<int64_t> expected = {1, 4, 8, 5, 2, 3};
+  EXPECT_EQ(got, expected);
+  EXPECT_EQ(test::dump_public_as<int64_t>(&ctx, reveal(&ctx, count))(), 3);
+}
+
+TEST(ShuffleTest, ApplyPerm) {
+  HalContext ctx = test::makeRefHalContext();
+
+  const xt::xarray<float> x = {1, 2, 3, 4, 5};
+  const xt::xarray<int64_t> perm = {2, 0, 4, 1, 3};
+
+  auto res = apply_perm(&ctx, {make_value(&ctx, VIS_SECRET, x)},
+                        make_value(&ctx, VIS_SECRET, perm));
+  ASSERT_EQ(res.size(), 1);
+
+  // out[perm[i]] = x[i]
+  const xt::xarray<float> expected = {2, 4, 1, 5, 3};
+  auto got = test::dump_public_as<float>(&ctx, reveal(&ctx, res[0]));
+  EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.001)) << got;
+
+  EXPECT_THROW(apply_perm(&ctx, {make_value(&ctx, VIS_SECRET, x)},
+                          make_value(&ctx, VIS_SECRET,
+                                     xt::xarray<int64_t>{0, 0, 1, 2, 3})),
+               yacl::EnforceNotMet);
+}
+
+// The expected destinations of a stable sort of each row.
+xt::xarray<int64_t> stableSortDest(const xt::xarray<float>& keys,
+                                   bool descending) {
+  const size_t rows = keys.shape(0);
+  const size_t n = keys.shape(1);
+  xt::xarray<int64_t> dest = xt::zeros<int64_t>({rows * n});
+  for (size_t row = 0; row < rows; row++) {
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return descending ? keys(row, a) > keys(row, b)
+                        : keys(row, a) < keys(row, b);
+    });
+    for (size_t rank = 0; rank < n; rank++) {
+      dest(row * n + order[rank]) = row * n + rank;
+    }
+  }
+  return dest;
+}
+
+TEST(ShuffleTest, GenSortPerm) {
+  HalContext ctx = test::makeRefHalContext();
+
+  // with duplicates and negatives.
+  const xt::xarray<int32_t> ikeys = {{3, -1, 7, 3, 0, -5, 2},
+                                     {-2, -2, 9, 1, 1, 0, -7}};
+  const xt::xarray<float> fkeys = {{0.5, -1.25, 3, 0.5, -0.75, 2.5, -1.25},
+                                   {1, 0, -3.5, 2, -128, 64, 0}};
+
+  for (bool descending : {false, true}) {
+    {
+      auto perm = gen_sort_perm(&ctx, make_value(&ctx, VIS_SECRET, ikeys),
+                                descending);
+      auto got = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, perm));
+      EXPECT_EQ(got, stableSortDest(xt::cast<float>(ikeys), descending))
+          << got;
+    }
+    {
+      auto perm = gen_sort_perm(&ctx, make_value(&ctx, VIS_SECRET, fkeys),
+                                descending);
+      auto got = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, perm));
+      EXPECT_EQ(got, stableSortDest(fkeys, descending)) << got;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace spu::kernel::hal
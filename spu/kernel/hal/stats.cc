@@ -0,0 +1,190 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hal/stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "yacl/base/exception.h"
+
+#include "spu/kernel/hal/concat.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/shuffle.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hal {
+namespace {
+
+void checkPoints(const Value& points) {
+  YACL_ENFORCE(points.isPublic() && points.shape().size() == 1 &&
+                   points.numel() > 0,
+               "expect public 1-D points, got {}", points);
+}
+
+// The (n, m) comparison bits of x[i] >= points[j], or of x[i] <= points[j],
+// in a single batched comparison.
+Value compareAll(HalContext* ctx, const Value& x, const Value& points,
+                 bool at_least) {
+  const int64_t n = x.numel();
+  const int64_t m = points.numel();
+  auto xb = broadcast_to(ctx, x, {n, m}, {0});
+  auto pb = broadcast_to(ctx, points, {n, m}, {1});
+  return at_least ? greater_equal(ctx, xb, pb) : less_equal(ctx, xb, pb);
+}
+
+// The (1, m) column sums of (n, m) bits, by a public matmul, which is local.
+Value countBits(HalContext* ctx, const Value& bits) {
+  const int64_t n = bits.shape()[0];
+  auto ones = constant(ctx, static_cast<int64_t>(1), {1, n});
+  return matmul(ctx, ones, dtype_cast(ctx, bits, DT_I64));
+}
+
+// Inclusive prefix sum of a 1-D value, in log rounds of local additions.
+Value prefixSum(HalContext* ctx, const Value& x) {
+  const int64_t n = x.numel();
+  auto res = x;
+  for (int64_t offset = 1; offset < n; offset *= 2) {
+    auto zero = zeros(ctx, VIS_PUBLIC, x.dtype(), {offset});
+    auto shifted =
+        concatenate(ctx, {zero, slice(ctx, res, {0}, {n - offset}, {})}, 0);
+    res = add(ctx, res, shifted);
+  }
+  return res;
+}
+
+// The smallest unsigned dtype holding [0, bound).
+DataType unsignedDtypeOf(int64_t bound) {
+  if (bound <= (int64_t(1) << 8)) {
+    return DT_U8;
+  }
+  if (bound <= (int64_t(1) << 16)) {
+    return DT_U16;
+  }
+  if (bound <= (int64_t(1) << 32)) {
+    return DT_U32;
+  }
+  return DT_U64;
+}
+
+}  // namespace
+
+Value histogram(HalContext* ctx, const Value& x, const Value& edges) {
+  SPU_TRACE_HAL_DISP(ctx, x, edges);
+  YACL_ENFORCE(x.shape().size() == 1, "expect 1-D x, got {}", x);
+  checkPoints(edges);
+  const int64_t bins = edges.numel() - 1;
+  YACL_ENFORCE(bins > 0, "expect at least 2 edges, got {}", edges.numel());
+
+  // c[j] = #(x >= edges[j]), the bin j holds c[j] - c[j + 1].
+  auto counts = reshape(ctx, countBits(ctx, compareAll(ctx, x, edges, true)),
+                        {bins + 1});
+  return sub(ctx, slice(ctx, counts, {0}, {bins}, {}),
+             slice(ctx, counts, {1}, {bins + 1}, {}));
+}
+
+Value quantile(HalContext* ctx, const Value& x, absl::Span<const double> qs,
+               const Value& candidates) {
+  SPU_TRACE_HAL_DISP(ctx, x, qs.size(), candidates);
+  YACL_ENFORCE(x.shape().size() == 1 && x.numel() > 0,
+               "expect non-empty 1-D x, got {}", x);
+  YACL_ENFORCE(!qs.empty());
+  checkPoints(candidates);
+
+  const int64_t n = x.numel();
+  const int64_t m = candidates.numel();
+  const auto num_qs = static_cast<int64_t>(qs.size());
+  auto first = broadcast_to(ctx, slice(ctx, candidates, {0}, {1}, {}),
+                            {num_qs}, {0});
+  if (m == 1) {
+    return first;
+  }
+
+  std::vector<int64_t> targets;
+  for (double q : qs) {
+    YACL_ENFORCE(q > 0 && q <= 1, "q={} is not in (0, 1]", q);
+    targets.push_back(std::max<int64_t>(
+        static_cast<int64_t>(std::ceil(q * static_cast<double>(n))), 1));
+  }
+
+  // r[j] = #(x <= candidates[j]) is ascending, so the bits r[j] < target
+  // are ones then zeros, and the quantile is candidates[0] plus the steps
+  // of the ones, i.e. a (qs, m - 1) x (m - 1, 1) matmul.
+  auto ranks = reshape(ctx, countBits(ctx, compareAll(ctx, x, candidates,
+                                                      false)),
+                       {m});
+  auto ranks_b = broadcast_to(ctx, slice(ctx, ranks, {0}, {m - 1}, {}),
+                              {num_qs, m - 1}, {1});
+  auto targets_b = broadcast_to(ctx, constant(ctx, targets, {num_qs}),
+                                {num_qs, m - 1}, {0});
+  auto below = dtype_cast(ctx, less(ctx, ranks_b, targets_b), DT_I64);
+
+  auto steps = sub(ctx, slice(ctx, candidates, {1}, {m}, {}),
+                   slice(ctx, candidates, {0}, {m - 1}, {}));
+  auto offsets = matmul(ctx, below, reshape(ctx, steps, {m - 1, 1}));
+  return add(ctx, first, reshape(ctx, offsets, {num_qs}));
+}
+
+Value groupby_sum(HalContext* ctx, const Value& keys, const Value& values,
+                  int64_t num_groups) {
+  SPU_TRACE_HAL_DISP(ctx, keys, values, num_groups);
+  YACL_ENFORCE(keys.isSecret() && keys.isInt() && keys.shape().size() == 1,
+               "expect secret 1-D int keys, got {}", keys);
+  YACL_ENFORCE(values.shape() == keys.shape(), "keys = {}, values = {}", keys,
+               values);
+  YACL_ENFORCE(num_groups > 0, "num_groups={}", num_groups);
+  YACL_ENFORCE(has_secret_shuffle(ctx), "protocol could not shuffle secrets");
+
+  const int64_t n = keys.numel();
+  const int64_t total = n + num_groups;
+
+  // tag keys as 2 * key, and the dummy of group g as 2 * g + 1, which sorts
+  // after all elements of g. Tags are in [0, 2 * num_groups), so only their
+  // low bits are sorted.
+  std::vector<int64_t> dummies(num_groups);
+  std::vector<int64_t> iota(total);
+  std::iota(iota.begin(), iota.end(), 0);
+  for (int64_t g = 0; g < num_groups; g++) {
+    dummies[g] = 2 * g + 1;
+  }
+  auto tags = concatenate(
+      ctx,
+      {left_shift(ctx, dtype_cast(ctx, keys, DT_I64), 1),
+       constant(ctx, dummies, {num_groups})},
+      0);
+  tags.setDtype(unsignedDtypeOf(2 * num_groups), true);
+  auto dest = gen_sort_perm(ctx, reshape(ctx, tags, {1, total}), false);
+
+  auto padded = concatenate(
+      ctx, {values, zeros(ctx, VIS_PUBLIC, values.dtype(), {num_groups})}, 0);
+  auto sums = prefixSum(ctx, apply_perm(ctx, {padded}, dest)[0]);
+
+  // back to the original order by the inverse of dest.
+  auto inverse = apply_perm(ctx, {constant(ctx, iota, {total})}, dest)[0];
+  auto ends = slice(ctx, apply_perm(ctx, {sums}, inverse)[0], {n}, {total},
+                    {});
+
+  auto prev = concatenate(
+      ctx,
+      {zeros(ctx, VIS_PUBLIC, values.dtype(), {1}),
+       slice(ctx, ends, {0}, {num_groups - 1}, {})},
+      0);
+  return sub(ctx, ends, prev);
+}
+
+}  // namespace spu::kernel::hal
@@ -0,0 +1,60 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+#include "spu/kernel/context.h"
+#include "spu/kernel/value.h"
+
+namespace spu::kernel::hal {
+
+/// Count the elements of x in each bin [edges[j], edges[j+1]).
+//
+// All elements are compared with all edges in one batched comparison, and
+// the counts of x >= edges[j] are reduced by a local matmul.
+// @param x, a 1-D value.
+// @param edges, a public 1-D ascending value of bins + 1 edges.
+// @return the 1-D int counts of the bins.
+Value histogram(HalContext* ctx, const Value& x, const Value& edges);
+
+/// Approximate quantiles of x, the smallest candidate c for each q such that
+/// at least ceil(q * n) elements of x are <= c, or the last candidate.
+//
+// No sort, the ranks of all candidates are counted by one batched comparison
+// and compared with the targets, the selection is a local matmul of the
+// comparison bits and the candidate steps.
+// @param x, a 1-D value of n elements.
+// @param qs, quantiles in (0, 1].
+// @param candidates, a public 1-D ascending value, e.g. a grid of the domain.
+// @return a 1-D value of the quantiles.
+Value quantile(HalContext* ctx, const Value& x, absl::Span<const double> qs,
+               const Value& candidates);
+
+/// Sum values by keys, as if sums[keys[i]] += values[i].
+//
+// One dummy of value zero is appended after every group, the values are
+// sorted by keys by the shuffle based permutations of shuffle.h, so the
+// prefix sums at the dummies end the groups. The prefix sums are sent back
+// to the original order, where the dummies are at public positions.
+// @param keys, a secret 1-D int value in [0, num_groups).
+// @param values, a 1-D value of the same length.
+// @return the 1-D secret sums of the groups.
+Value groupby_sum(HalContext* ctx, const Value& keys, const Value& values,
+                  int64_t num_groups);
+
+}  // namespace spu::kernel::hal
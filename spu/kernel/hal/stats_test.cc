@@ -0,0 +1,91 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hal/stats.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xio.hpp"
+
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hal {
+namespace {
+
+TEST(StatsTest, Histogram) {
+  HalContext ctx = test::makeRefHalContext();
+
+  const xt::xarray<float> x = {0.5, 1.5, 1.75, 2, 3.25, -1, 5, 0};
+  const xt::xarray<float> edges = {0, 1, 2, 3, 4};
+
+  auto hist = histogram(&ctx, make_value(&ctx, VIS_SECRET, x),
+                        make_value(&ctx, VIS_PUBLIC, edges));
+  EXPECT_TRUE(hist.isSecret());
+  auto got = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, hist));
+  EXPECT_EQ(got, (xt::xarray<int64_t>{2, 2, 1, 1})) << got;
+
+  EXPECT_THROW(histogram(&ctx, make_value(&ctx, VIS_SECRET, x),
+                         make_value(&ctx, VIS_SECRET, edges)),
+               yacl::EnforceNotMet);
+}
+
+TEST(StatsTest, Quantile) {
+  HalContext ctx = test::makeRefHalContext();
+
+  const xt::xarray<float> x = xt::arange<float>(100, 0, -1);
+  const xt::xarray<float> candidates = xt::arange<float>(0, 101);
+
+  auto q = quantile(&ctx, make_value(&ctx, VIS_SECRET, x),
+                    {0.01, 0.5, 0.905, 1},
+                    make_value(&ctx, VIS_PUBLIC, candidates));
+  EXPECT_TRUE(q.isSecret());
+  auto got = test::dump_public_as<float>(&ctx, reveal(&ctx, q));
+  const xt::xarray<float> expected = {1, 50, 91, 100};
+  EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.001)) << got;
+
+  // a coarse grid rounds up to the next candidate.
+  const xt::xarray<float> coarse = {0, 25, 50, 75, 100};
+  q = quantile(&ctx, make_value(&ctx, VIS_SECRET, x), {0.3, 0.5},
+               make_value(&ctx, VIS_PUBLIC, coarse));
+  got = test::dump_public_as<float>(&ctx, reveal(&ctx, q));
+  EXPECT_TRUE(xt::allclose(xt::xarray<float>{50, 50}, got, 0.01, 0.001))
+      << got;
+}
+
+TEST(StatsTest, GroupBySum) {
+  HalContext ctx = test::makeRefHalContext();
+
+  const xt::xarray<int64_t> keys = {2, 0, 1, 2, 0, 2};
+  const xt::xarray<float> values = {1.5, 2, 3, 4, 5.5, 6};
+
+  auto sums = groupby_sum(&ctx, make_value(&ctx, VIS_SECRET, keys),
+                          make_value(&ctx, VIS_SECRET, values), 4);
+  EXPECT_TRUE(sums.isSecret());
+  auto got = test::dump_public_as<float>(&ctx, reveal(&ctx, sums));
+  const xt::xarray<float> expected = {7.5, 3, 11.5, 0};
+  EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.001)) << got;
+
+  // public values are summed as secrets, e.g. counts of the groups.
+  auto counts = groupby_sum(
+      &ctx, make_value(&ctx, VIS_SECRET, keys),
+      make_value(&ctx, VIS_PUBLIC, xt::xarray<int64_t>(xt::ones<int64_t>({6}))),
+      3);
+  auto got_counts = test::dump_public_as<int64_t>(&ctx, reveal(&ctx, counts));
+  EXPECT_EQ(got_counts, (xt::xarray<int64_t>{2, 1, 3})) << got_counts;
+}
+
+}  // namespace
+}  // namespace spu::kernel::hal
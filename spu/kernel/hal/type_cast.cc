@@ -14,6 +14,11 @@
 
 #include "spu/kernel/hal/type_cast.h"
 
+#include <iterator>
+#include <map>
+#include <string>
+
+#include "spu/core/ndarray_ref.h"
 #include "spu/core/type_util.h"
 #include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/prot_wrapper.h"  // vtype_cast
@@ -70,6 +75,49 @@ Value reveal(HalContext* ctx, const Value& x) {
   return _s2p(ctx, x).setDtype(x.dtype());
 }
 
+std::vector<Value> reveal(HalContext* ctx, absl::Span<Value const> ins) {
+  std::vector<Value> rets(ins.begin(), ins.end());
+
+  // indices of the secrets by storage type, ordered so all parties open the
+  // groups in the same order.
+  std::map<std::string, std::vector<size_t>> groups;
+  for (size_t idx = 0; idx < ins.size(); idx++) {
+    if (ins[idx].isSecret() && ins[idx].numel() > 0) {
+      groups[ins[idx].storage_type().toString()].push_back(idx);
+    }
+  }
+
+  for (const auto& [storage_type, indices] : groups) {
+    if (indices.size() == 1) {
+      rets[indices[0]] = reveal(ctx, ins[indices[0]]);
+      continue;
+    }
+
+    std::vector<ArrayRef> flattened;
+    flattened.reserve(indices.size());
+    for (size_t idx : indices) {
+      flattened.emplace_back(flatten(ins[idx].data()));
+    }
+    SimdTrait<ArrayRef>::PackInfo pi;
+    auto packed =
+        SimdTrait<ArrayRef>::pack(flattened.begin(), flattened.end(), pi);
+    const int64_t numel = packed.numel();
+    // the dtype is not used by the opening.
+    auto opened =
+        reveal(ctx, Value(unflatten(packed, {numel}), ins[indices[0]].dtype()));
+
+    std::vector<ArrayRef> unpacked;
+    unpacked.reserve(indices.size());
+    SimdTrait<ArrayRef>::unpack(flatten(opened.data()),
+                                std::back_inserter(unpacked), pi);
+    for (size_t i = 0; i < indices.size(); i++) {
+      const auto& in = ins[indices[i]];
+      rets[indices[i]] = Value(unflatten(unpacked[i], in.shape()), in.dtype());
+    }
+  }
+  return rets;
+}
+
 Value dtype_cast(HalContext* ctx, const Value& in, DataType to_type) {
   SPU_TRACE_HAL_DISP(ctx, in, to_type);
 
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <vector>
+
+#include "absl/types/span.h"
+
 #include "spu/kernel/context.h"
 #include "spu/kernel/value.h"
 
@@ -32,4 +36,10 @@ Value p2s(HalContext* ctx, const Value& in);
 // @param in, the input value
 Value reveal(HalContext* ctx, const Value& in);
 
+/// reveal secrets together
+// Secrets of the same storage type are packed and opened by one call, so they
+// share the communication rounds. Public values are returned as is.
+// @param ins, the input values
+std::vector<Value> reveal(HalContext* ctx, absl::Span<Value const> ins);
+
 }  // namespace spu::kernel::hal
@@ -15,6 +15,7 @@
 #include "spu/kernel/hal/type_cast.h"
 
 #include <cstdint>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "xtensor/xio.hpp"
@@ -86,5 +87,27 @@ TEST(TypeCastTest, fxp2int) {
   // TODO: cast to other int than DT_I32
 }
 
+TEST(TypeCastTest, RevealTogether) {
+  const xt::xarray<int32_t> x = test::xt_random<int32_t>({3, 4});
+  const xt::xarray<float> y = {1.5, -2.25, 0.0};
+  const xt::xarray<int32_t> z = {7, 8};
+  HalContext ctx = test::makeRefHalContext();
+
+  std::vector<Value> ins = {const_secret(&ctx, x), const_secret(&ctx, y),
+                            constant(&ctx, z), const_secret(&ctx, z)};
+  auto rets = reveal(&ctx, ins);
+  ASSERT_EQ(rets.size(), ins.size());
+  for (size_t idx = 0; idx < rets.size(); idx++) {
+    EXPECT_TRUE(rets[idx].isPublic());
+    EXPECT_EQ(rets[idx].dtype(), ins[idx].dtype());
+    EXPECT_EQ(rets[idx].shape(), ins[idx].shape());
+  }
+
+  EXPECT_EQ(test::dump_public_as<int32_t>(&ctx, rets[0]), x);
+  EXPECT_TRUE(xt::allclose(test::dump_public_as<float>(&ctx, rets[1]), y));
+  EXPECT_EQ(test::dump_public_as<int32_t>(&ctx, rets[2]), z);
+  EXPECT_EQ(test::dump_public_as<int32_t>(&ctx, rets[3]), z);
+}
+
 }  // namespace
 }  // namespace spu::kernel::hal
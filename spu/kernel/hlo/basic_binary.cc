@@ -15,6 +15,8 @@
 #include "spu/kernel/hlo/basic_binary.h"
 
 #include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/fxp.h"
+#include "spu/kernel/hal/integer.h"
 #include "spu/kernel/hal/polymorphic.h"
 #include "spu/kernel/hal/type_cast.h"
 
@@ -50,6 +52,10 @@ spu::Value Remainder(HalContext *ctx, const spu::Value &lhs,
   YACL_ENFORCE(lhs.dtype() == rhs.dtype(), "dtype mismatch {} != {}",
                lhs.dtype(), rhs.dtype());
 
+  if (lhs.isInt() && rhs.isInt()) {
+    return hal::i_rem(ctx, lhs, rhs);
+  }
+
   // 1st: find quotient by x/y
   auto quotient = hal::div(ctx, lhs, rhs);
 
@@ -71,4 +77,30 @@ spu::Value Dot(HalContext *ctx, const spu::Value &lhs, const spu::Value &rhs) {
   return hal::matmul(ctx, lhs, rhs);
 }
 
+spu::Value BatchDot(HalContext *ctx, const spu::Value &lhs,
+                    const spu::Value &rhs) {
+  YACL_ENFORCE(lhs.shape().size() == 3 && rhs.shape().size() == 3);
+
+  return hal::batch_matmul(ctx, lhs, rhs);
+}
+
+spu::Value LazyMul(HalContext *ctx, const spu::Value &lhs,
+                   const spu::Value &rhs) {
+  if (lhs.isFxp() && rhs.isFxp()) {
+    return hal::f_mul_lazy(ctx, lhs, rhs);
+  }
+  return hal::mul(ctx, lhs, rhs);
+}
+
+spu::Value LazyDot(HalContext *ctx, const spu::Value &lhs,
+                   const spu::Value &rhs) {
+  YACL_ENFORCE(!lhs.shape().empty() && lhs.shape().size() <= 2);
+  YACL_ENFORCE(!rhs.shape().empty() && rhs.shape().size() <= 2);
+
+  if (lhs.isFxp() && rhs.isFxp()) {
+    return hal::f_mmul_lazy(ctx, lhs, rhs);
+  }
+  return hal::matmul(ctx, lhs, rhs);
+}
+
 }  // namespace spu::kernel::hlo
@@ -44,6 +44,12 @@ SIMPLE_BINARY_KERNEL_DECL(Xor)
 SIMPLE_BINARY_KERNEL_DECL(Div)
 SIMPLE_BINARY_KERNEL_DECL(Remainder)
 SIMPLE_BINARY_KERNEL_DECL(Dot)
+SIMPLE_BINARY_KERNEL_DECL(BatchDot)
+
+// Multiply fixed-points without truncation, the result carries pending
+// truncation bits, which are handled by Add, Sub and TruncPending.
+SIMPLE_BINARY_KERNEL_DECL(LazyMul)
+SIMPLE_BINARY_KERNEL_DECL(LazyDot)
 
 #undef SIMPLE_BINARY_KERNEL_DECL
 
@@ -16,6 +16,7 @@
 
 #include "spu/kernel/context.h"
 #include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/fxp.h"
 #include "spu/kernel/hal/polymorphic.h"
 #include "spu/kernel/hal/type_cast.h"
 #include "spu/kernel/value.h"
@@ -81,4 +82,11 @@ spu::Value Round_AFZ(HalContext *ctx, const spu::Value &in) {
   return hal::dtype_cast(ctx, hal::dtype_cast(ctx, round, DT_I64), in.dtype());
 }
 
+spu::Value TruncPending(HalContext *ctx, const spu::Value &in) {
+  if (in.pendingTruncBits() == 0) {
+    return in;
+  }
+  return hal::f_trunc_pending(ctx, in);
+}
+
 }  // namespace spu::kernel::hlo
@@ -37,6 +37,7 @@ SIMPLE_UNARY_KERNEL_DECL(Rsqrt)
 SIMPLE_UNARY_KERNEL_DECL(Sqrt)
 SIMPLE_UNARY_KERNEL_DECL(Sign)
 SIMPLE_UNARY_KERNEL_DECL(Round_AFZ)
+SIMPLE_UNARY_KERNEL_DECL(TruncPending)
 
 #undef SIMPLE_UNARY_KERNEL_DECL
 
@@ -43,6 +43,11 @@ spu::Value Reveal(HalContext *ctx, const spu::Value &in) {
   return hal::reveal(ctx, in);
 }
 
+std::vector<spu::Value> Reveal(HalContext *ctx,
+                               absl::Span<const spu::Value> ins) {
+  return hal::reveal(ctx, ins);
+}
+
 spu::Value Seal(HalContext *ctx, const spu::Value &in) {
   return hal::p2s(ctx, in);
 }
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "spu/kernel/hlo/utils.h"
 
 namespace spu::kernel::hlo {
@@ -25,6 +27,10 @@ spu::Value Bitcast(HalContext *ctx, const spu::Value &in, DataType dst_dtype);
 
 spu::Value Reveal(HalContext *ctx, const spu::Value &in);
 
+// Reveal all of `ins`, secrets of the same storage type are opened together.
+std::vector<spu::Value> Reveal(HalContext *ctx,
+                               absl::Span<const spu::Value> ins);
+
 spu::Value Seal(HalContext *ctx, const spu::Value &in);
 
 }  // namespace spu::kernel::hlo
@@ -61,8 +61,9 @@ std::vector<spu::Value> While(HalContext *ctx,
   };
 
   while (eval_cond(ret)) {
-    // dispatch body
-    ret = body(ret);
+    // dispatch body, the values are moved in, so a body taking them by value
+    // holds the only references of their buffers.
+    ret = body(std::move(ret));
   }
 
   return ret;
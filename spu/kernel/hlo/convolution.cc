@@ -18,6 +18,7 @@
 #include "spu/kernel/hal/concat.h"
 #include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/ring.h"
 #include "spu/kernel/hal/shape_ops.h"
 #include "spu/kernel/hlo/utils.h"
 #include "spu/kernel/value.h"
@@ -205,15 +206,191 @@ spu::Value extractImagePatches(HalContext *ctx, spu::Value &input,
       {input_batch, stacked.shape()[1], kernel_x * kernel_y, input_channels});
 }
 
+// The same dtype rule as hal::matmul, for products accumulated in ring.
+spu::Value FinalizeRingProduct(HalContext *ctx, spu::Value acc,
+                               const spu::Value &input,
+                               const spu::Value &kernel) {
+  if (input.isFxp() && kernel.isFxp()) {
+    return hal::_trunc(ctx, acc).asFxp();
+  }
+  if (input.isFxp() || kernel.isFxp()) {
+    return acc.asFxp();
+  }
+  return acc.setDtype(input.dtype());
+}
+
+// The strided window of the input at kernel position (x, y), i.e. the
+// [batch, output_x, output_y, channels] input of all outputs at it.
+spu::Value KernelPositionWindow(HalContext *ctx, const spu::Value &input,
+                                const ConvolutionConfig &config,
+                                absl::Span<const int64_t> result_shape,
+                                int64_t x, int64_t y) {
+  const auto stride_x = config.window_strides[0];
+  const auto stride_y = config.window_strides[1];
+  return hal::slice(ctx, input, {0, x, y, 0},
+                    {input.shape()[0], x + (result_shape[1] - 1) * stride_x + 1,
+                     y + (result_shape[2] - 1) * stride_y + 1,
+                     input.shape()[3]},
+                    {1, stride_x, stride_y, 1});
+}
+
+// Conv2D as a sum of one matmul per kernel position, each takes a strided
+// window of the input, so there is no im2col buffer of kernel_x * kernel_y
+// times the input. Products are accumulated in ring and truncated once.
+//
+// Only used when one side is public, where each matmul is local, otherwise
+// every kernel position would cost a round.
+spu::Value Convolution2DByWindows(HalContext *ctx, const spu::Value &input,
+                                  const spu::Value &kernel,
+                                  const ConvolutionConfig &config,
+                                  absl::Span<const int64_t> result_shape) {
+  const auto input_batch = input.shape()[0];
+  const auto input_channels = input.shape()[3];
+
+  const auto kernel_x = kernel.shape()[0];
+  const auto kernel_y = kernel.shape()[1];
+  const auto kernel_filters = kernel.shape()[3];
+
+  const auto output_x = result_shape[1];
+  const auto output_y = result_shape[2];
+
+  spu::Value acc;
+  for (int64_t x = 0; x < kernel_x; ++x) {
+    for (int64_t y = 0; y < kernel_y; ++y) {
+      auto window =
+          KernelPositionWindow(ctx, input, config, result_shape, x, y);
+      window = hal::reshape(
+          ctx, window, {input_batch * output_x * output_y, input_channels});
+      auto weight = hal::reshape(
+          ctx,
+          hal::slice(ctx, kernel, {x, y, 0, 0},
+                     {x + 1, y + 1, input_channels, kernel_filters}, {}),
+          {input_channels, kernel_filters});
+
+      auto product = hal::_mmul(ctx, window, weight);
+      acc = (x == 0 && y == 0) ? product : hal::_add(ctx, acc, product);
+    }
+  }
+
+  acc = FinalizeRingProduct(ctx, acc, input, kernel);
+  return hal::reshape(ctx, acc, result_shape);
+}
+
+// Depthwise conv2D, i.e. every input channel is convolved with its own
+// `multiplier` filters of a [kx, ky, 1, channels * multiplier] kernel. Each
+// output is a dot over the kernel positions only, so all positions are
+// multiplied elementwise at once, i.e. a single mul of the stacked shifted
+// windows, then summed locally and truncated once, instead of an im2col
+// buffer of every channel.
+spu::Value DepthwiseConvolution2D(HalContext *ctx, const spu::Value &input,
+                                  const spu::Value &kernel,
+                                  const ConvolutionConfig &config,
+                                  absl::Span<const int64_t> result_shape) {
+  const auto input_batch = input.shape()[0];
+  const auto input_channels = input.shape()[3];
+
+  const auto kernel_x = kernel.shape()[0];
+  const auto kernel_y = kernel.shape()[1];
+  const auto kernel_filters = kernel.shape()[3];
+  const auto multiplier = kernel_filters / input_channels;
+
+  const auto output_x = result_shape[1];
+  const auto output_y = result_shape[2];
+  const std::vector<int64_t> out_shape = {input_batch, output_x, output_y,
+                                          kernel_filters};
+  const std::vector<int64_t> stacked_shape = {1, input_batch, output_x,
+                                              output_y, kernel_filters};
+
+  std::vector<spu::Value> windows;
+  std::vector<spu::Value> weights;
+  for (int64_t x = 0; x < kernel_x; ++x) {
+    for (int64_t y = 0; y < kernel_y; ++y) {
+      auto window =
+          KernelPositionWindow(ctx, input, config, result_shape, x, y);
+      // output channel o reads input channel o / multiplier.
+      if (multiplier > 1) {
+        window = hal::reshape(
+            ctx,
+            hal::broadcast_to(
+                ctx,
+                hal::reshape(ctx, window,
+                             {input_batch, output_x, output_y, input_channels,
+                              1}),
+                {input_batch, output_x, output_y, input_channels, multiplier}),
+            out_shape);
+      }
+      windows.push_back(hal::reshape(ctx, window, stacked_shape));
+
+      auto weight = hal::reshape(
+          ctx,
+          hal::slice(ctx, kernel, {x, y, 0, 0},
+                     {x + 1, y + 1, 1, kernel_filters}, {}),
+          {kernel_filters});
+      weights.push_back(hal::reshape(
+          ctx, hal::broadcast_to(ctx, weight, out_shape), stacked_shape));
+    }
+  }
+
+  const int64_t num_positions = kernel_x * kernel_y;
+  auto products = hal::_mul(ctx, hal::concatenate(ctx, windows, 0),
+                            hal::concatenate(ctx, weights, 0));
+  spu::Value acc;
+  for (int64_t pos = 0; pos < num_positions; ++pos) {
+    auto product = hal::slice(
+        ctx, products, {pos, 0, 0, 0, 0},
+        {pos + 1, input_batch, output_x, output_y, kernel_filters}, {});
+    acc = pos == 0 ? product : hal::_add(ctx, acc, product);
+  }
+
+  acc = FinalizeRingProduct(ctx, acc, input, kernel);
+  return hal::reshape(ctx, acc, result_shape);
+}
+
+// Pointwise conv2D, i.e. a 1x1 kernel, is a single matmul of the strided
+// input view by the [channels, filters] kernel.
+spu::Value PointwiseConvolution2D(HalContext *ctx, const spu::Value &input,
+                                  const spu::Value &kernel,
+                                  const ConvolutionConfig &config,
+                                  absl::Span<const int64_t> result_shape) {
+  const auto input_channels = input.shape()[3];
+  const auto kernel_filters = kernel.shape()[3];
+
+  auto window = KernelPositionWindow(ctx, input, config, result_shape, 0, 0);
+  window = hal::reshape(ctx, window,
+                        {window.numel() / input_channels, input_channels});
+  auto weight = hal::reshape(ctx, kernel, {input_channels, kernel_filters});
+
+  return hal::reshape(ctx, hal::matmul(ctx, window, weight), result_shape);
+}
+
 // This is an optimized conv2D with im2col
 spu::Value Convolution2D(HalContext *ctx, spu::Value input, spu::Value kernel,
                          const ConvolutionConfig &config,
                          absl::Span<const int64_t> result_shape) {
+  const auto input_channels = input.shape()[3];
+  const auto kernel_channels = kernel.shape()[2];
+  // grouped convolutions other than depthwise take the general path.
+  if (config.batchGroupCount != 1 ||
+      (config.featureGroupCount != 1 &&
+       !(config.featureGroupCount == input_channels && kernel_channels == 1 &&
+         kernel.shape()[3] % input_channels == 0))) {
+    return Convolution(ctx, input, kernel, config, result_shape);
+  }
+  if (config.featureGroupCount != 1) {
+    return DepthwiseConvolution2D(ctx, input, kernel, config, result_shape);
+  }
+  if (kernel.shape()[0] == 1 && kernel.shape()[1] == 1) {
+    return PointwiseConvolution2D(ctx, input, kernel, config, result_shape);
+  }
+
+  if (!(input.isSecret() && kernel.isSecret())) {
+    return Convolution2DByWindows(ctx, input, kernel, config, result_shape);
+  }
+
   auto input_batch = input.shape()[0];
 
   auto kernel_x = kernel.shape()[0];
   auto kernel_y = kernel.shape()[1];
-  auto kernel_channels = kernel.shape()[2];
   auto kernel_filters = kernel.shape()[3];
 
   auto output_x = result_shape[1];
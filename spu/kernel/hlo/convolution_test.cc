@@ -0,0 +1,137 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/convolution.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/test_util.h"
+
+namespace spu::kernel::hlo {
+
+class Conv2DTest : public ::testing::TestWithParam<
+                       std::tuple<Visibility, Visibility, int64_t>> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    Conv2DTestInstances, Conv2DTest,
+    testing::Combine(testing::Values(VIS_PUBLIC, VIS_SECRET),
+                     testing::Values(VIS_PUBLIC, VIS_SECRET),
+                     testing::Values(1, 2)),
+    [](const testing::TestParamInfo<Conv2DTest::ParamType> &p) {
+      return fmt::format("{}x{}xStride{}",
+                         Visibility_Name(std::get<0>(p.param)),
+                         Visibility_Name(std::get<1>(p.param)),
+                         std::get<2>(p.param));
+    });
+
+TEST_P(Conv2DTest, SameAsGeneralConv) {
+  HalContext ctx = hal::test::makeRefHalContext();
+  const auto [input_vis, kernel_vis, stride] = GetParam();
+
+  // NHWC input and HWIO kernel.
+  xt::xarray<float> input = hal::test::xt_random<float>({2, 7, 6, 3}, -1, 1);
+  xt::xarray<float> kernel = hal::test::xt_random<float>({3, 2, 3, 4}, -1, 1);
+  const int64_t out_x = (7 - 3) / stride + 1;
+  const int64_t out_y = (6 - 2) / stride + 1;
+  const std::vector<int64_t> result_shape = {2, out_x, out_y, 4};
+
+  const std::vector<int64_t> strides = {stride, stride};
+  const std::vector<int64_t> spatial_dims = {1, 2};
+  const std::vector<int64_t> kernel_spatial_dims = {0, 1};
+  ConvolutionConfig config;
+  config.featureGroupCount = 1;
+  config.batchGroupCount = 1;
+  config.window_strides = strides;
+  config.inputBatchDimension = 0;
+  config.inputFeatureDimension = 3;
+  config.inputSpatialDimensions = spatial_dims;
+  config.kernelInputFeatureDimension = 2;
+  config.kernelOutputFeatureDimension = 3;
+  config.kernelSpatialDimensions = kernel_spatial_dims;
+  config.outputBatchDimension = 0;
+  config.outputFeatureDimension = 3;
+  config.outputSpatialDimensions = spatial_dims;
+
+  auto x = hal::make_value(&ctx, input_vis, input);
+  auto w = hal::make_value(&ctx, kernel_vis, kernel);
+
+  auto dump = [&](const spu::Value &v) {
+    return hal::test::dump_public_as<float>(
+        &ctx, v.isSecret() ? hal::_s2p(&ctx, v).setDtype(v.dtype()) : v);
+  };
+
+  auto expected = dump(Convolution(&ctx, x, w, config, result_shape));
+  auto ret = Convolution2D(&ctx, x, w, config, result_shape);
+  EXPECT_EQ(ret.shape(), result_shape);
+  EXPECT_TRUE(ret.isFxp());
+  auto got = dump(ret);
+  EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.01)) << got;
+}
+
+TEST_P(Conv2DTest, DepthwiseAndPointwise) {
+  HalContext ctx = hal::test::makeRefHalContext();
+  const auto [input_vis, kernel_vis, stride] = GetParam();
+
+  xt::xarray<float> input = hal::test::xt_random<float>({2, 7, 6, 3}, -1, 1);
+  // depthwise of multiplier 2, and a 1x1 kernel.
+  xt::xarray<float> depthwise =
+      hal::test::xt_random<float>({3, 2, 1, 6}, -1, 1);
+  xt::xarray<float> pointwise =
+      hal::test::xt_random<float>({1, 1, 3, 4}, -1, 1);
+
+  const std::vector<int64_t> strides = {stride, stride};
+  const std::vector<int64_t> spatial_dims = {1, 2};
+  const std::vector<int64_t> kernel_spatial_dims = {0, 1};
+  ConvolutionConfig config;
+  config.batchGroupCount = 1;
+  config.window_strides = strides;
+  config.inputBatchDimension = 0;
+  config.inputFeatureDimension = 3;
+  config.inputSpatialDimensions = spatial_dims;
+  config.kernelInputFeatureDimension = 2;
+  config.kernelOutputFeatureDimension = 3;
+  config.kernelSpatialDimensions = kernel_spatial_dims;
+  config.outputBatchDimension = 0;
+  config.outputFeatureDimension = 3;
+  config.outputSpatialDimensions = spatial_dims;
+
+  auto dump = [&](const spu::Value &v) {
+    return hal::test::dump_public_as<float>(
+        &ctx, v.isSecret() ? hal::_s2p(&ctx, v).setDtype(v.dtype()) : v);
+  };
+
+  auto x = hal::make_value(&ctx, input_vis, input);
+  for (const auto *kernel : {&depthwise, &pointwise}) {
+    const bool is_depthwise = kernel == &depthwise;
+    config.featureGroupCount = is_depthwise ? 3 : 1;
+    const int64_t kx = kernel->shape()[0];
+    const int64_t ky = kernel->shape()[1];
+    const std::vector<int64_t> result_shape = {
+        2, (7 - kx) / stride + 1, (6 - ky) / stride + 1,
+        static_cast<int64_t>(kernel->shape()[3])};
+
+    auto w = hal::make_value(&ctx, kernel_vis, *kernel);
+    auto expected = dump(Convolution(&ctx, x, w, config, result_shape));
+    auto ret = Convolution2D(&ctx, x, w, config, result_shape);
+    EXPECT_EQ(ret.shape(), result_shape);
+    EXPECT_TRUE(ret.isFxp());
+    auto got = dump(ret);
+    EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.01))
+        << is_depthwise << got;
+  }
+}
+
+}  // namespace spu::kernel::hlo
@@ -14,15 +14,18 @@
 
 #include "spu/kernel/hlo/dynamic_slice.h"
 
+#include <cstring>
+
 #include "llvm/ADT/STLExtras.h"
 
 #include "spu/kernel/hal/hal.h"
+#include "spu/kernel/hlo/indexing.h"
 #include "spu/kernel/hlo/utils.h"
 
 namespace spu::kernel::hlo {
 
 spu::Value DynamicUpdateSlice(
-    HalContext *ctx, const spu::Value &operand, const spu::Value &update,
+    HalContext *ctx, spu::Value operand, const spu::Value &update,
     absl::Span<const spu::Value>
         start_indicies) {  // Basic idea here, get a ref slice and
                            // update the whole slice..
@@ -52,8 +55,17 @@ spu::Value DynamicUpdateSlice(
   // Strides is always 1
   std::vector<int64_t> strides(limit.size(), 1);
 
+  // Copy on write, `buf()` returns a copy, so a buffer of no other holders
+  // counts 2. Broadcasted operands alias elements, they are copied too.
+  auto result = std::move(operand);
+  if (result.data().buf().use_count() > 2 || !result.data().isCompact()) {
+    result = result.clone();
+  }
+  if (update.numel() == 0) {
+    return result;
+  }
+
   // First get a slice
-  auto result = operand.clone();
   auto slice = hal::slice(ctx, result, start_indicies_i64, limit, strides);
 
   // (xiaochen): I know it's hacky here, but make life easier
@@ -62,10 +74,24 @@ spu::Value DynamicUpdateSlice(
   YACL_ENFORCE(slice.shape() == update.shape(),
                "slice shape should equal to update shape");
 
-  std::vector<int64_t> indicies(slice.shape().size(), 0);
+  const auto &shape = update.shape();
+  std::vector<int64_t> indicies(shape.size(), 0);
+  if (shape.empty() || update.data().strides().back() != 1) {
+    do {
+      slice.copyElementFrom(update, indicies, indicies);
+    } while (bumpIndices<int64_t>(shape, absl::MakeSpan(indicies)));
+    return result;
+  }
+
+  // The slice of a compact result is contiguous in the minor dimension, so
+  // rows are copied at once.
+  const int64_t row_bytes = shape.back() * update.elsize();
+  std::vector<int64_t> rows(shape.begin(), shape.end());
+  rows.back() = 1;
   do {
-    slice.copyElementFrom(update, indicies, indicies);
-  } while (bumpIndices<int64_t>(slice.shape(), absl::MakeSpan(indicies)));
+    std::memcpy(&slice.data().at(indicies), &update.data().at(indicies),
+                row_bytes);
+  } while (bumpIndices<int64_t>(rows, absl::MakeSpan(indicies)));
 
   return result;
 }
@@ -75,12 +101,18 @@ spu::Value DynamicSlice(HalContext *ctx, const spu::Value &operand,
                         absl::Span<const spu::Value> start_indicies) {
   // Start indicies
   std::vector<int64_t> start_indicies_i64(start_indicies.size());
+  std::vector<size_t> secret_dims;
   for (const auto &idx : llvm::enumerate(start_indicies)) {
     auto v_idx = idx.value();
     if (v_idx.isSecret() && ctx->rt_config().reveal_secret_indicies()) {
       v_idx = hal::reveal(ctx, v_idx);
       SPDLOG_WARN("Reveal {}th start index of DynamicSlice", idx.index());
     }
+    if (v_idx.isSecret()) {
+      // Keep the whole dimension, it is sliced obliviously below.
+      secret_dims.push_back(idx.index());
+      continue;
+    }
     start_indicies_i64[idx.index()] = getIndicies(ctx, v_idx)[0];
     // Transform start_indicies
     // start_indices[i] = clamp(start_indices[i], 0, operand.dimension_size[i] -
@@ -95,11 +127,22 @@ spu::Value DynamicSlice(HalContext *ctx, const spu::Value &operand,
   for (size_t idx = 0; idx < limit.size(); ++idx) {
     limit[idx] += slice_size[idx];
   }
+  for (auto dim : secret_dims) {
+    limit[dim] = operand.shape()[dim];
+  }
 
   // Strides is always 1
   std::vector<int64_t> strides(limit.size(), 1);
 
-  return hal::slice(ctx, operand, start_indicies_i64, limit, strides);
+  auto result = hal::slice(ctx, operand, start_indicies_i64, limit, strides);
+  for (auto dim : secret_dims) {
+    result = ObliviousSlice(ctx, result, dim, slice_size[dim],
+                            start_indicies[dim]);
+    result = hal::reshape(
+        ctx, result,
+        std::vector<int64_t>(result.shape().begin() + 1, result.shape().end()));
+  }
+  return result;
 }
 
 }  // namespace spu::kernel::hlo
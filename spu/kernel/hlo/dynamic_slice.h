@@ -18,7 +18,9 @@
 
 namespace spu::kernel::hlo {
 
-spu::Value DynamicUpdateSlice(HalContext *ctx, const spu::Value &operand,
+// The operand is updated in place if its buffer is held by it only, e.g.
+// moved in at its last use, otherwise it is copied first.
+spu::Value DynamicUpdateSlice(HalContext *ctx, spu::Value operand,
                               const spu::Value &update,
                               absl::Span<const spu::Value> start_indicies);
 
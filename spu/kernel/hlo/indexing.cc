@@ -14,9 +14,13 @@
 
 #include "spu/kernel/hlo/indexing.h"
 
+#include <algorithm>
 #include <cstring>
+#include <numeric>
 
 #include "spu/core/ndarray_ref.h"
+#include "spu/core/parallel_utils.h"
+#include "spu/core/shape_util.h"
 #include "spu/kernel/hal/hal.h"
 #include "spu/kernel/hlo/utils.h"
 #include "spu/kernel/value.h"
@@ -301,6 +305,141 @@ spu::Value reshapedGatherIndices(spu::HalContext *ctx, int64_t index_vector_dim,
 
 namespace spu::kernel::hlo {
 
+spu::Value ObliviousSlice(HalContext *ctx, const spu::Value &operand,
+                          int64_t dim, int64_t size,
+                          const spu::Value &start_indices) {
+  const auto &shape = operand.shape();
+  YACL_ENFORCE(dim >= 0 && dim < static_cast<int64_t>(shape.size()),
+               "slice dim {} out of range, shape = {}", dim, shape);
+  YACL_ENFORCE(size > 0 && size <= shape[dim],
+               "slice size {} out of range, shape = {}", size, shape);
+  YACL_ENFORCE(start_indices.isInt(), "indicies value must be integers.");
+
+  const int64_t num_starts = shape[dim] - size + 1;
+  const int64_t num_indices = start_indices.numel();
+
+  // Move dim to the front, so a candidate slice is a row of the table.
+  std::vector<int64_t> perm(shape.size());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::rotate(perm.begin(), perm.begin() + dim, perm.begin() + dim + 1);
+  auto moved = hal::transpose(ctx, operand, perm);
+
+  std::vector<int64_t> slice_shape = moved.shape();
+  slice_shape[0] = size;
+  const int64_t row_size = calcNumel(slice_shape);
+
+  spu::Value table;
+  if (size == 1) {
+    table = hal::reshape(ctx, moved, {num_starts, row_size});
+  } else {
+    std::vector<spu::Value> rows;
+    rows.reserve(num_starts);
+    std::vector<int64_t> start(shape.size(), 0);
+    std::vector<int64_t> limit = moved.shape();
+    std::vector<int64_t> strides(shape.size(), 1);
+    for (int64_t idx = 0; idx < num_starts; ++idx) {
+      start[0] = idx;
+      limit[0] = idx + size;
+      rows.push_back(hal::reshape(
+          ctx, hal::slice(ctx, moved, start, limit, strides), {1, row_size}));
+    }
+    table = hal::concatenate(ctx, rows, 0);
+  }
+
+  // Clamp the starts, then compare all of them with all candidates at once.
+  const auto dtype = start_indices.dtype();
+  auto starts = hal::reshape(ctx, start_indices, {num_indices});
+  starts = hal::clamp(
+      ctx,
+      hal::dtype_cast(ctx, hal::constant(ctx, int64_t{0}, {num_indices}),
+                      dtype),
+      starts,
+      hal::dtype_cast(
+          ctx, hal::constant(ctx, num_starts - 1, {num_indices}), dtype));
+
+  std::vector<int64_t> candidates(num_starts);
+  std::iota(candidates.begin(), candidates.end(), 0);
+  auto one_hot = hal::equal(
+      ctx, hal::broadcast_to(ctx, starts, {num_indices, num_starts}, {0}),
+      hal::broadcast_to(
+          ctx, hal::dtype_cast(ctx, hal::constant(ctx, candidates), dtype),
+          {num_indices, num_starts}, {1}));
+
+  // An integer one-hot matrix needs no truncation with a fxp table.
+  one_hot = hal::dtype_cast(ctx, one_hot,
+                            table.isInt() ? table.dtype() : DT_I64);
+  auto ret = hal::matmul(ctx, one_hot, table);
+
+  std::vector<int64_t> ret_shape = {num_indices};
+  ret_shape.insert(ret_shape.end(), slice_shape.begin(), slice_shape.end());
+  ret = hal::reshape(ctx, ret, ret_shape);
+
+  // Move dim back.
+  std::vector<int64_t> back_perm = {0};
+  for (int64_t idx = 0; idx < static_cast<int64_t>(shape.size()); ++idx) {
+    back_perm.push_back(idx == dim ? 1 : (idx < dim ? idx + 2 : idx + 1));
+  }
+  return hal::transpose(ctx, ret, back_perm);
+}
+
+namespace {
+
+// Gather slices along the only dimension of startIndexMap from secret
+// indices, the other dimensions start at 0.
+spu::Value GatherBySecretIndices(HalContext *ctx, const spu::Value &operand,
+                                 const spu::Value &start_indices,
+                                 const GatherConfig &config,
+                                 absl::Span<const int64_t> result_shape) {
+  const int64_t dim = config.startIndexMap[0];
+  const int64_t rank = operand.shape().size();
+
+  std::vector<int64_t> start(rank, 0);
+  std::vector<int64_t> limit(config.sliceSizes.begin(),
+                             config.sliceSizes.end());
+  limit[dim] = operand.shape()[dim];
+  std::vector<int64_t> strides(rank, 1);
+  auto window = hal::slice(ctx, operand, start, limit, strides);
+
+  auto slices = ObliviousSlice(ctx, window, dim, config.sliceSizes[dim],
+                               start_indices);
+
+  // Slices of batch dims ++ offset dims, collapsed dims are dropped.
+  std::vector<int64_t> shape = start_indices.shape();
+  shape.erase(shape.begin() + config.indexVectorDim);
+  const int64_t num_batch_dims = shape.size();
+  for (int64_t idx = 0; idx < rank; ++idx) {
+    if (!std::binary_search(config.collapsedSliceDims.begin(),
+                            config.collapsedSliceDims.end(), idx)) {
+      shape.push_back(config.sliceSizes[idx]);
+    }
+  }
+  YACL_ENFORCE(shape.size() == result_shape.size(),
+               "gather result rank mismatch, expected {}, got {}",
+               result_shape.size(), shape.size());
+  auto ret = hal::reshape(ctx, slices, shape);
+
+  // Place offset dims at offsetDims of result, batch dims at the rest.
+  std::vector<int64_t> perm;
+  int64_t batch_dim = 0;
+  int64_t offset_dim = num_batch_dims;
+  for (int64_t idx = 0; idx < static_cast<int64_t>(result_shape.size());
+       ++idx) {
+    if (std::binary_search(config.offsetDims.begin(), config.offsetDims.end(),
+                           idx)) {
+      perm.push_back(offset_dim++);
+    } else {
+      perm.push_back(batch_dim++);
+    }
+  }
+  ret = hal::transpose(ctx, ret, perm);
+  YACL_ENFORCE(absl::MakeConstSpan(ret.shape()) == result_shape,
+               "gather result shape mismatch, expected {}, got {}",
+               fmt::join(result_shape, "x"), fmt::join(ret.shape(), "x"));
+  return ret;
+}
+
+}  // namespace
+
 spu::Value Gather(HalContext *ctx, const spu::Value &operand,
                   const spu::Value &start_indicies, const GatherConfig &config,
                   absl::Span<const int64_t> result_shape) {
@@ -318,6 +457,12 @@ spu::Value Gather(HalContext *ctx, const spu::Value &operand,
     SPDLOG_WARN("Reveal start indicies value of GatherOp");
   }
 
+  // Indices of one dimension are the common form of embedding lookups.
+  if (start_indices_value.isSecret() && config.startIndexMap.size() == 1) {
+    return GatherBySecretIndices(ctx, operand, start_indices_value, config,
+                                 result_shape);
+  }
+
   auto start_induces = getIndicies(ctx, start_indices_value);
 
   // We iterate over the gather dimensions in the output shape in an outer
@@ -328,12 +473,9 @@ spu::Value Gather(HalContext *ctx, const spu::Value &operand,
   IndexIterationSpace offset_indices_iteration_space =
       iterationSpaceForOutputOffsetIndices(result_shape.size(), config);
 
-  // Scratch buffers that hold an index in the output shape and the
-  // corresponding index in the input shape.
-  // If input is empty, short circuit it
+  // Scratch buffer that holds the clamped start of a batch in the input
+  // shape.
   auto operand_shape = operand.shape();
-  std::vector<int64_t> input_index(operand_shape.size());
-  std::vector<int64_t> output_index(result_shape.size());
   std::vector<int64_t> input_index_clamped(operand_shape.size());
 
   OutputBatchIndexToInputIndex output_batch_index_to_input_index(
@@ -343,18 +485,62 @@ spu::Value Gather(HalContext *ctx, const spu::Value &operand,
       config, /*input_shape=*/operand_shape,
       /*output_shape=*/result_shape);
 
-  spu::Value result(NdArrayRef(operand.data().eltype(), result_shape),
-                    operand.dtype());
-
-  auto gather_inner_loop_body =
-      [&](absl::Span<const int64_t> output_window_index,
-          absl::Span<const int64_t> input_gather_index,
-          absl::Span<const int64_t> output_gather_index) {
-        auto input_window_index =
-            output_offset_index_to_input_index(output_window_index);
-        for (int i = 0, e = output_index.size(); i < e; i++) {
-          output_index[i] = output_gather_index[i] + output_window_index[i];
-        }
+  const auto &in = operand.data();
+  const auto &in_strides = in.strides();
+  spu::Value result(NdArrayRef(in.eltype(), result_shape), operand.dtype());
+  const auto out_strides = makeCompactStrides(result_shape);
+  auto offsetOf = [](absl::Span<const int64_t> index,
+                     absl::Span<const int64_t> strides) {
+    return std::inner_product(index.begin(), index.end(), strides.begin(),
+                              int64_t{0});
+  };
+
+  // An input element is at the clamped start of its batch plus its window
+  // index, so the offsets of both are computed once, and elements of a window
+  // consecutive in both sides are copied as a run.
+  struct Run {
+    int64_t in_offset;
+    int64_t out_offset;
+    int64_t size;
+  };
+  std::vector<Run> window_runs;
+  forEachIndex(result_shape, offset_indices_iteration_space.index_base,
+               offset_indices_iteration_space.index_count,
+               offset_indices_iteration_space.index_incr,
+               [&](absl::Span<const int64_t> output_window_index) {
+                 window_runs.push_back(
+                     {offsetOf(output_offset_index_to_input_index(
+                                   output_window_index),
+                               in_strides),
+                      offsetOf(output_window_index, out_strides), 1});
+               });
+  // forEachIndex steps the major dimension first, runs follow the output.
+  std::sort(window_runs.begin(), window_runs.end(),
+            [](const Run &lhs, const Run &rhs) {
+              return lhs.out_offset < rhs.out_offset;
+            });
+  size_t num_runs = 0;
+  for (const auto &run : window_runs) {
+    if (num_runs != 0) {
+      auto &last = window_runs[num_runs - 1];
+      if (run.in_offset == last.in_offset + last.size &&
+          run.out_offset == last.out_offset + last.size) {
+        last.size++;
+        continue;
+      }
+    }
+    window_runs[num_runs++] = run;
+  }
+  window_runs.resize(num_runs);
+
+  std::vector<std::pair<int64_t, int64_t>> batch_offsets;
+  forEachIndex(
+      result_shape, start_indices_iteration_space.index_base,
+      start_indices_iteration_space.index_count,
+      start_indices_iteration_space.index_incr,
+      [&](absl::Span<const int64_t> output_gather_index) {
+        auto input_gather_index =
+            output_batch_index_to_input_index(output_gather_index);
         for (int i = 0, e = input_gather_index.size(); i < e; i++) {
           int64_t output_dim = output_offset_index_to_input_index
                                    .input_dim_value_to_output_index(i);
@@ -365,42 +551,210 @@ spu::Value Gather(HalContext *ctx, const spu::Value &operand,
           int64_t output_dim_size =
               output_dim == -1 ? 1 : result_shape[output_dim];
           // Clamp the gather index so that the gather region fits in the
-          // operand. input_index_clamped[i] = clamp(input_gather_index[i], 0,
-          //                                       operand_shape.dimensions(i)
-          //                                       - output_dim_size);
+          // operand.
           input_index_clamped[i] =
               std::min(operand_shape[i] - output_dim_size,
                        std::max(int64_t{0}, input_gather_index[i]));
         }
-        for (int i = 0, e = input_index.size(); i < e; i++) {
-          input_index[i] = input_index_clamped[i] + input_window_index[i];
-        }
+        batch_offsets.emplace_back(offsetOf(input_index_clamped, in_strides),
+                                   offsetOf(output_gather_index, out_strides));
+      });
+
+  // Indices are public, so shares of all parties are copied the same way
+  // without communication.
+  const auto elsize = static_cast<int64_t>(in.elsize());
+  const auto *src = static_cast<const std::byte *>(in.data());
+  auto *dst = static_cast<std::byte *>(result.data().data());
+  const auto runs = static_cast<int64_t>(num_runs);
+  pforeach(0, static_cast<int64_t>(batch_offsets.size()) * runs,
+           [&](int64_t idx) {
+             const auto &[in_base, out_base] = batch_offsets[idx / runs];
+             const auto &run = window_runs[idx % runs];
+             std::memcpy(dst + (out_base + run.out_offset) * elsize,
+                         src + (in_base + run.in_offset) * elsize,
+                         run.size * elsize);
+           });
 
-        result.copyElementFrom(operand, input_index, output_index);
-      };
+  return result;
+}
 
-  auto gather_outer_loop_body =
-      [&](absl::Span<const int64_t> output_gather_index) {
-        auto input_gather_index =
-            output_batch_index_to_input_index(output_gather_index);
-        forEachIndex(result_shape, offset_indices_iteration_space.index_base,
-                     offset_indices_iteration_space.index_count,
-                     offset_indices_iteration_space.index_incr,
-                     [&](absl::Span<const int64_t> output_window_index) {
-                       return gather_inner_loop_body(output_window_index,
-                                                     input_gather_index,
-                                                     output_gather_index);
-                     });
-      };
-
-  forEachIndex(result_shape, start_indices_iteration_space.index_base,
-               start_indices_iteration_space.index_count,
-               start_indices_iteration_space.index_incr,
-               gather_outer_loop_body);
+namespace {
 
+// Rows of a 2-D `table` at public `rows`.
+spu::Value GatherRows(const spu::Value &table,
+                      absl::Span<const int64_t> rows) {
+  const auto num_rows = static_cast<int64_t>(rows.size());
+  const int64_t num_cols = table.shape()[1];
+  spu::Value result(NdArrayRef(table.data().eltype(), {num_rows, num_cols}),
+                    table.dtype());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    for (int64_t col = 0; col < num_cols; ++col) {
+      result.copyElementFrom(table, {rows[row], col}, {row, col});
+    }
+  }
   return result;
 }
 
+// The sum of the rows of 2-D `updates` scattered to each of `num_rows` rows
+// by public `indices`, all adds are local.
+spu::Value ScatterSumsByPublicIndices(HalContext *ctx,
+                                      const spu::Value &updates,
+                                      const xt::xarray<int64_t> &indices,
+                                      int64_t num_rows) {
+  const int64_t num_cols = updates.shape()[1];
+  auto zeros = [&](int64_t rows) {
+    return hal::zeros(ctx, VIS_PUBLIC, updates.dtype(), {rows, num_cols});
+  };
+
+  std::vector<int64_t> order;
+  for (int64_t idx = 0; idx < static_cast<int64_t>(indices.size()); ++idx) {
+    if (indices(idx) >= 0 && indices(idx) < num_rows) {
+      order.push_back(idx);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int64_t lhs, int64_t rhs) {
+    return indices(lhs) < indices(rhs);
+  });
+  const auto num_valid = static_cast<int64_t>(order.size());
+  if (num_valid == 0) {
+    return zeros(num_rows);
+  }
+
+  // Inclusive prefix sums of the sorted updates, by log rounds of adds.
+  auto sums = GatherRows(updates, order);
+  for (int64_t shift = 1; shift < num_valid; shift *= 2) {
+    auto head = hal::slice(ctx, sums, {0, 0}, {num_valid - shift, num_cols},
+                           {1, 1});
+    sums = hal::add(ctx, sums, hal::concatenate(ctx, {zeros(shift), head}, 0));
+  }
+  sums = hal::concatenate(ctx, {zeros(1), sums}, 0);
+
+  // Row r receives the run [begin[r], end[r]) of the sorted updates.
+  std::vector<int64_t> begin(num_rows);
+  std::vector<int64_t> end(num_rows);
+  int64_t pos = 0;
+  for (int64_t row = 0; row < num_rows; ++row) {
+    begin[row] = pos;
+    while (pos < num_valid && indices(order[pos]) == row) {
+      ++pos;
+    }
+    end[row] = pos;
+  }
+  return hal::sub(ctx, GatherRows(sums, end), GatherRows(sums, begin));
+}
+
+// The sum of the rows of 2-D `updates` scattered to each of `num_rows` rows
+// by secret `indices`, out of range indices match no row.
+spu::Value ScatterSumsBySecretIndices(HalContext *ctx,
+                                      const spu::Value &updates,
+                                      const spu::Value &indices,
+                                      int64_t num_rows) {
+  const int64_t num_indices = indices.numel();
+  const auto dtype = indices.dtype();
+
+  std::vector<int64_t> candidates(num_rows);
+  std::iota(candidates.begin(), candidates.end(), 0);
+  auto one_hot = hal::equal(
+      ctx,
+      hal::broadcast_to(
+          ctx, hal::dtype_cast(ctx, hal::constant(ctx, candidates), dtype),
+          {num_rows, num_indices}, {0}),
+      hal::broadcast_to(ctx, indices, {num_rows, num_indices}, {1}));
+
+  // An integer one-hot matrix needs no truncation with fxp updates.
+  one_hot = hal::dtype_cast(ctx, one_hot,
+                            updates.isInt() ? updates.dtype() : DT_I64);
+  return hal::matmul(ctx, one_hot, updates);
+}
+
+}  // namespace
+
+spu::Value ScatterAdd(HalContext *ctx, const spu::Value &operand,
+                      const spu::Value &scatter_indices,
+                      const spu::Value &updates, const ScatterConfig &config) {
+  const auto &shape = operand.shape();
+  const auto rank = static_cast<int64_t>(shape.size());
+  YACL_ENFORCE(config.scatterDimsToOperandDims.size() == 1 &&
+                   config.insertedWindowDims.size() == 1 &&
+                   config.insertedWindowDims[0] ==
+                       config.scatterDimsToOperandDims[0],
+               "only scatters to one inserted window dim are supported");
+  const int64_t dim = config.scatterDimsToOperandDims[0];
+  YACL_ENFORCE(dim >= 0 && dim < rank,
+               "scatter dim {} out of range, shape = {}", dim, shape);
+  YACL_ENFORCE(scatter_indices.isInt(), "indicies value must be integers.");
+
+  const auto &indices_shape = scatter_indices.shape();
+  if (config.indexVectorDim < static_cast<int64_t>(indices_shape.size())) {
+    YACL_ENFORCE(indices_shape[config.indexVectorDim] == 1,
+                 "index vector should be of one dim, indices shape = {}",
+                 indices_shape);
+  }
+
+  // Update windows are full slices of the other dims of operand.
+  YACL_ENFORCE(static_cast<int64_t>(config.updateWindowDims.size()) ==
+                   rank - 1,
+               "update windows should be of rank {}, got {}", rank - 1,
+               config.updateWindowDims.size());
+  std::vector<int64_t> perm = {dim};
+  for (int64_t idx = 0; idx < rank; ++idx) {
+    if (idx != dim) {
+      const int64_t window_dim = config.updateWindowDims[perm.size() - 1];
+      YACL_ENFORCE(updates.shape()[window_dim] == shape[idx],
+                   "update windows should be full slices, operand shape = {}, "
+                   "updates shape = {}",
+                   shape, updates.shape());
+      perm.push_back(idx);
+    }
+  }
+
+  const int64_t num_indices = scatter_indices.numel();
+  if (operand.numel() == 0 || num_indices == 0) {
+    return operand;
+  }
+  const int64_t row_size = operand.numel() / shape[dim];
+
+  // Updates of [scatter dims ++ window dims] as rows.
+  std::vector<int64_t> update_perm;
+  for (int64_t idx = 0; idx < static_cast<int64_t>(updates.shape().size());
+       ++idx) {
+    if (!std::binary_search(config.updateWindowDims.begin(),
+                            config.updateWindowDims.end(), idx)) {
+      update_perm.push_back(idx);
+    }
+  }
+  update_perm.insert(update_perm.end(), config.updateWindowDims.begin(),
+                     config.updateWindowDims.end());
+  auto updates_2d = hal::reshape(ctx, hal::transpose(ctx, updates, update_perm),
+                                 {num_indices, row_size});
+
+  // Move dim to the front, so an update is added to a row.
+  auto moved = hal::transpose(ctx, operand, perm);
+  const auto moved_shape = moved.shape();
+  auto operand_2d = hal::reshape(ctx, moved, {shape[dim], row_size});
+
+  auto indices = hal::reshape(ctx, scatter_indices, {num_indices});
+  if (indices.isSecret() && ctx->rt_config().reveal_secret_indicies()) {
+    indices = hal::reveal(ctx, indices);
+    SPDLOG_WARN("Reveal scatter indicies value of ScatterOp");
+  }
+
+  auto sums = indices.isSecret()
+                  ? ScatterSumsBySecretIndices(ctx, updates_2d, indices,
+                                               shape[dim])
+                  : ScatterSumsByPublicIndices(ctx, updates_2d,
+                                               getIndicies(ctx, indices),
+                                               shape[dim]);
+  auto ret = hal::reshape(ctx, hal::add(ctx, operand_2d, sums), moved_shape);
+
+  // Move dim back.
+  std::vector<int64_t> back_perm(rank);
+  for (int64_t idx = 0; idx < rank; ++idx) {
+    back_perm[perm[idx]] = idx;
+  }
+  return hal::transpose(ctx, ret, back_perm);
+}
+
 spu::Value FilterByMask(HalContext *ctx, const spu::Value &operand,
                         absl::Span<const uint8_t> mask) {
   // Sanity
@@ -434,4 +788,33 @@ spu::Value FilterByMask(HalContext *ctx, const spu::Value &operand,
   return result;
 }
 
+std::pair<spu::Value, spu::Value> ObliviousFilterByMask(
+    HalContext *ctx, const spu::Value &operand, const spu::Value &mask) {
+  YACL_ENFORCE(!operand.shape().empty() && operand.numel() > 0,
+               "Operand must be a non-empty array");
+  YACL_ENFORCE(mask.shape().size() == 1 &&
+                   mask.numel() == operand.shape()[0],
+               "filter must be same length as operand");
+  YACL_ENFORCE(hal::has_secret_shuffle(ctx),
+               "secret filtering requires shuffle of the protocol");
+
+  // each column of the rows is moved as a line.
+  const int64_t n = operand.shape()[0];
+  const int64_t width = operand.numel() / n;
+  auto columns =
+      hal::transpose(ctx, hal::reshape(ctx, operand, {n, width}), {1, 0});
+  std::vector<spu::Value> lines;
+  for (int64_t col = 0; col < width; ++col) {
+    auto line = hal::slice(ctx, columns, {col, 0}, {col + 1, n}, {});
+    lines.push_back(hal::reshape(ctx, line, {n}));
+  }
+
+  auto [moved, count] = hal::compact(ctx, lines, mask);
+  for (auto &line : moved) {
+    line = hal::reshape(ctx, line, {1, n});
+  }
+  auto rows = hal::transpose(ctx, hal::concatenate(ctx, moved, 0), {1, 0});
+  return {hal::reshape(ctx, rows, operand.shape()), count};
+}
+
 }  // namespace spu::kernel::hlo
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <utility>
+
 #include "spu/kernel/context.h"
 #include "spu/kernel/hlo/utils.h"
 
@@ -33,7 +35,49 @@ spu::Value Gather(HalContext *ctx, const spu::Value &operand,
                   const spu::Value &start_indicies, const GatherConfig &config,
                   absl::Span<const int64_t> result_shape);
 
+struct ScatterConfig {
+  absl::Span<const int64_t> updateWindowDims;
+  absl::Span<const int64_t> insertedWindowDims;
+  absl::Span<const int64_t> scatterDimsToOperandDims;
+  int64_t indexVectorDim;
+};
+
+/// The scatter of XLA whose update computation is an add, of the form
+/// operand[..., indices[i], ...] += updates[i] where every update is a full
+/// slice of operand with the only scatter dim collapsed, e.g. the gradient
+/// of an embedding lookup. Out of range indices are skipped.
+///
+/// Public indices sort the updates, sum every run of the same index by one
+/// prefix sum, and add the sums in one strided update. Secret indices are
+/// turned into a one-hot matrix by one batched equality, the sums are then
+/// the matmul of it and the updates.
+spu::Value ScatterAdd(HalContext *ctx, const spu::Value &operand,
+                      const spu::Value &scatter_indices,
+                      const spu::Value &updates, const ScatterConfig &config);
+
+/// Slices of `size` along `dim` of operand from every start index, i.e.
+/// result[i] = operand[..., start_indices[i] : start_indices[i] + size, ...].
+/// Returns slices of shape [start_indices.numel()] ++ slice shape, each start
+/// is clamped so that the slice fits in operand.
+///
+/// Secret starts are never revealed, every start is turned into a one-hot
+/// vector by one batched equality with the public range of all starts, the
+/// slices are then the matmul of the one-hot matrix and the table of all
+/// candidate slices. With a public operand the matmul is local.
+spu::Value ObliviousSlice(HalContext *ctx, const spu::Value &operand,
+                          int64_t dim, int64_t size,
+                          const spu::Value &start_indices);
+
 spu::Value FilterByMask(HalContext *ctx, const spu::Value &operand,
                         absl::Span<const uint8_t> mask);
 
+/// Filter the rows of an operand by a secret mask without revealing it.
+///
+/// The rows of mask 1 are moved to the front stably by one secret partition,
+/// see `hal::compact`, so the shape is kept and only the first `count` rows
+/// are selected, the rest are the unselected rows.
+/// @return the compacted operand and the secret count of selected rows.
+std::pair<spu::Value, spu::Value> ObliviousFilterByMask(
+    HalContext *ctx, const spu::Value &operand, const spu::Value &mask);
+
 }  // namespace spu::kernel::hlo
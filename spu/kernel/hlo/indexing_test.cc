@@ -15,9 +15,17 @@
 #include "spu/kernel/hlo/indexing.h"
 
 #include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xmanipulation.hpp"
+#include "xtensor/xview.hpp"
 
 #include "spu/core/ndarray_ref.h"
 #include "spu/core/type.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+#include "spu/kernel/hlo/dynamic_slice.h"
 #include "spu/kernel/value.h"
 
 namespace spu::kernel::hlo {
@@ -62,4 +70,205 @@ TEST(IndexingTest, Take2) {
   EXPECT_EQ(r.data().at<int64_t>({1}), 4);
 }
 
+TEST(IndexingTest, SecretGather) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  // an embedding table of 5 rows of 3.
+  xt::xarray<float> table = {{0.0, 0.5, 1.0},
+                             {1.0, 1.5, 2.0},
+                             {2.0, 2.5, 3.0},
+                             {3.0, 3.5, 4.0},
+                             {4.0, 4.5, 5.0}};
+  // out of range indices are clamped.
+  xt::xarray<int64_t> indices = {{3, 0}, {7, -1}};
+
+  std::vector<int64_t> slice_sizes = {1, 3};
+  std::vector<int64_t> offset_dims = {2};
+  std::vector<int64_t> collapsed_slice_dims = {0};
+  std::vector<int64_t> start_index_map = {0};
+  GatherConfig config{slice_sizes, 2, offset_dims, collapsed_slice_dims,
+                      start_index_map};
+
+  for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+    auto t = hal::make_value(&ctx, vis, table);
+    auto i = hal::make_value(&ctx, VIS_SECRET, indices);
+    auto ret = Gather(&ctx, t, i, config, {2, 2, 3});
+    EXPECT_TRUE(ret.isSecret());
+
+    auto r = hal::test::dump_public_as<float>(&ctx, hal::reveal(&ctx, ret));
+    xt::xarray<float> expected = {{{3.0, 3.5, 4.0}, {0.0, 0.5, 1.0}},
+                                  {{4.0, 4.5, 5.0}, {0.0, 0.5, 1.0}}};
+    EXPECT_TRUE(xt::allclose(r, expected, 0.01, 0.001)) << r;
+  }
+}
+
+TEST(IndexingTest, PublicGather) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<float> table = {{0.0, 0.5, 1.0},
+                             {1.0, 1.5, 2.0},
+                             {2.0, 2.5, 3.0},
+                             {3.0, 3.5, 4.0},
+                             {4.0, 4.5, 5.0}};
+  // window of 2x2 at (row, col), out of range starts are clamped.
+  xt::xarray<int64_t> indices = {{1, 0}, {3, 2}};
+
+  std::vector<int64_t> slice_sizes = {2, 2};
+  std::vector<int64_t> offset_dims = {1, 2};
+  std::vector<int64_t> collapsed_slice_dims = {};
+  std::vector<int64_t> start_index_map = {0, 1};
+  GatherConfig config{slice_sizes, 1, offset_dims, collapsed_slice_dims,
+                      start_index_map};
+  xt::xarray<float> expected = {{{1.0, 1.5}, {2.0, 2.5}},
+                                {{3.5, 4.0}, {4.5, 5.0}}};
+
+  auto dump = [&](const spu::Value &v) {
+    return hal::test::dump_public_as<float>(
+        &ctx, v.isSecret() ? hal::reveal(&ctx, v) : v);
+  };
+
+  auto i = hal::make_value(&ctx, VIS_PUBLIC, indices);
+  for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+    auto t = hal::make_value(&ctx, vis, table);
+    auto ret = Gather(&ctx, t, i, config, {2, 2, 2});
+    EXPECT_EQ(ret.vtype(), vis);
+    EXPECT_TRUE(xt::allclose(dump(ret), expected, 0.01, 0.001));
+
+    // a strided view of the table.
+    xt::xarray<float> transposed = xt::transpose(table);
+    auto view =
+        hal::transpose(&ctx, hal::make_value(&ctx, vis, transposed), {});
+    ret = Gather(&ctx, view, i, config, {2, 2, 2});
+    EXPECT_TRUE(xt::allclose(dump(ret), expected, 0.01, 0.001));
+  }
+}
+
+TEST(IndexingTest, ScatterAdd) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<float> operand = {{0.0, 0.5}, {1.0, 1.5}, {2.0, 2.5}};
+  // duplicated indices are summed, out of range ones are skipped.
+  xt::xarray<int64_t> indices = {{2}, {0}, {2}, {5}, {-1}};
+  xt::xarray<float> updates = {
+      {1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}, {7.0, 8.0}, {9.0, 10.0}};
+
+  std::vector<int64_t> update_window_dims = {1};
+  std::vector<int64_t> inserted_window_dims = {0};
+  std::vector<int64_t> scatter_dims_to_operand_dims = {0};
+  ScatterConfig config{update_window_dims, inserted_window_dims,
+                       scatter_dims_to_operand_dims, 1};
+
+  xt::xarray<float> expected = {{3.0, 4.5}, {1.0, 1.5}, {8.0, 10.5}};
+  for (auto indices_vis : {VIS_PUBLIC, VIS_SECRET}) {
+    for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+      auto o = hal::make_value(&ctx, vis, operand);
+      auto i = hal::make_value(&ctx, indices_vis, indices);
+      auto u = hal::make_value(&ctx, vis, updates);
+      auto ret = ScatterAdd(&ctx, o, i, u, config);
+      EXPECT_EQ(ret.isSecret(), vis == VIS_SECRET || indices_vis == VIS_SECRET);
+      if (ret.isSecret()) {
+        ret = hal::reveal(&ctx, ret);
+      }
+
+      auto r = hal::test::dump_public_as<float>(&ctx, ret);
+      EXPECT_TRUE(xt::allclose(r, expected, 0.01, 0.001)) << r;
+    }
+  }
+}
+
+TEST(IndexingTest, ScatterAddColumns) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<int64_t> operand = {{0, 1, 2}, {3, 4, 5}};
+  // updates of 2 batches of 2 columns, the window dim goes first.
+  xt::xarray<int64_t> indices = {{1, 1}, {0, 2}};
+  xt::xarray<int64_t> updates = {{{1, 2}, {3, 4}}, {{5, 6}, {7, 8}}};
+
+  std::vector<int64_t> update_window_dims = {0};
+  std::vector<int64_t> inserted_window_dims = {1};
+  std::vector<int64_t> scatter_dims_to_operand_dims = {1};
+  ScatterConfig config{update_window_dims, inserted_window_dims,
+                       scatter_dims_to_operand_dims, 2};
+
+  xt::xarray<int64_t> expected = {{3, 4, 6}, {10, 15, 13}};
+  for (auto indices_vis : {VIS_PUBLIC, VIS_SECRET}) {
+    auto o = hal::make_value(&ctx, VIS_SECRET, operand);
+    auto i = hal::make_value(&ctx, indices_vis, indices);
+    auto u = hal::make_value(&ctx, VIS_SECRET, updates);
+    auto ret = ScatterAdd(&ctx, o, i, u, config);
+
+    auto r = hal::test::dump_public_as<int64_t>(&ctx, hal::reveal(&ctx, ret));
+    EXPECT_EQ(r, expected) << r;
+  }
+}
+
+TEST(IndexingTest, SecretDynamicSlice) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<int64_t> x = {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}};
+  auto v = hal::make_value(&ctx, VIS_SECRET, x);
+
+  for (int64_t row = 0; row < 3; ++row) {
+    for (int64_t col = 0; col < 4; ++col) {
+      // the secret column start is clamped to 2.
+      auto r = hal::make_value(&ctx, VIS_PUBLIC, row);
+      auto c = hal::make_value(&ctx, VIS_SECRET, col);
+      auto ret = DynamicSlice(&ctx, v, {2, 2}, {r, c});
+
+      const int64_t r0 = std::min<int64_t>(row, 1);
+      const int64_t c0 = std::min<int64_t>(col, 2);
+      xt::xarray<int64_t> expected =
+          xt::view(x, xt::range(r0, r0 + 2), xt::range(c0, c0 + 2));
+      auto got =
+          hal::test::dump_public_as<int64_t>(&ctx, hal::reveal(&ctx, ret));
+      EXPECT_EQ(got, expected) << row << " " << col;
+    }
+  }
+}
+
+TEST(IndexingTest, DynamicUpdateSliceInPlace) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<int64_t> x = {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}};
+  xt::xarray<int64_t> u = {{-1, -2}, {-3, -4}};
+  xt::xarray<int64_t> expected = {
+      {0, 1, 2, 3}, {4, 5, -1, -2}, {8, 9, -3, -4}};
+  auto update = hal::make_value(&ctx, VIS_SECRET, u);
+  // the column start is clamped to 2.
+  std::vector<spu::Value> starts = {hal::make_value(&ctx, VIS_PUBLIC, 1),
+                                    hal::make_value(&ctx, VIS_PUBLIC, 3)};
+  auto dump = [&](const spu::Value &v) {
+    return hal::test::dump_public_as<int64_t>(&ctx, hal::reveal(&ctx, v));
+  };
+
+  // a shared operand is copied.
+  auto v = hal::make_value(&ctx, VIS_SECRET, x);
+  auto ret = DynamicUpdateSlice(&ctx, v, update, starts);
+  EXPECT_NE(ret.data().buf(), v.data().buf());
+  EXPECT_EQ(dump(ret), expected);
+  EXPECT_EQ(dump(v), x);
+
+  // a moved operand is updated in place.
+  const auto *buf = v.data().buf().get();
+  ret = DynamicUpdateSlice(&ctx, std::move(v), update, starts);
+  EXPECT_EQ(ret.data().buf().get(), buf);
+  EXPECT_EQ(dump(ret), expected);
+}
+
+TEST(IndexingTest, ObliviousFilterByMask) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<int64_t> x = {{0, 1}, {2, 3}, {4, 5}, {6, 7}};
+  xt::xarray<int64_t> mask = {0, 1, 0, 1};
+  auto [ret, count] =
+      ObliviousFilterByMask(&ctx, hal::make_value(&ctx, VIS_SECRET, x),
+                            hal::make_value(&ctx, VIS_SECRET, mask));
+
+  auto got = hal::test::dump_public_as<int64_t>(&ctx, hal::reveal(&ctx, ret));
+  xt::xarray<int64_t> expected = {{2, 3}, {6, 7}, {0, 1}, {4, 5}};
+  EXPECT_EQ(got, expected);
+  EXPECT_EQ(
+      hal::test::dump_public_as<int64_t>(&ctx, hal::reveal(&ctx, count))(), 2);
+}
+
 }  // namespace spu::kernel::hlo
@@ -0,0 +1,123 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/join.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "spu/kernel/hal/concat.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/shuffle.h"
+#include "spu/kernel/hal/type_cast.h"
+#include "spu/kernel/hlo/indexing.h"
+#include "spu/kernel/hlo/sort.h"
+
+namespace spu::kernel::hlo {
+namespace {
+
+// The column of a table padded by zeros to the rows of both tables, the left
+// table goes first.
+spu::Value padColumn(HalContext *ctx, const spu::Value &column, int64_t before,
+                     int64_t after) {
+  std::vector<spu::Value> parts;
+  if (before > 0) {
+    parts.push_back(hal::zeros(ctx, VIS_PUBLIC, column.dtype(), {before}));
+  }
+  parts.push_back(column);
+  if (after > 0) {
+    parts.push_back(hal::zeros(ctx, VIS_PUBLIC, column.dtype(), {after}));
+  }
+  return hal::concatenate(ctx, parts, 0);
+}
+
+void checkTable(absl::Span<const spu::Value> table) {
+  YACL_ENFORCE(!table.empty(), "expect a key column");
+  YACL_ENFORCE(table[0].isInt(), "expect integer keys, got {}",
+               table[0].dtype());
+  for (const auto &column : table) {
+    YACL_ENFORCE(column.shape().size() == 1 &&
+                     column.numel() == table[0].numel(),
+                 "expect 1-D columns of {} rows, got shape={}",
+                 table[0].numel(), column.shape());
+  }
+}
+
+}  // namespace
+
+std::vector<spu::Value> Join(HalContext *ctx, absl::Span<const spu::Value> lhs,
+                             absl::Span<const spu::Value> rhs) {
+  checkTable(lhs);
+  checkTable(rhs);
+  YACL_ENFORCE(lhs[0].dtype() == rhs[0].dtype(), "key dtype mismatch {} != {}",
+               lhs[0].dtype(), rhs[0].dtype());
+
+  const int64_t n_lhs = lhs[0].numel();
+  const int64_t n_rhs = rhs[0].numel();
+  const int64_t n = n_lhs + n_rhs;
+  const int64_t rows = std::min(n_lhs, n_rhs);
+  YACL_ENFORCE(rows > 0, "expect non-empty tables");
+
+  // [key, left payloads..., right payloads...] of both tables.
+  std::vector<spu::Value> columns = {
+      hal::concatenate(ctx, {lhs[0], rhs[0]}, 0)};
+  for (size_t idx = 1; idx < lhs.size(); ++idx) {
+    columns.push_back(padColumn(ctx, lhs[idx], 0, n_rhs));
+  }
+  for (size_t idx = 1; idx < rhs.size(); ++idx) {
+    columns.push_back(padColumn(ctx, rhs[idx], n_lhs, 0));
+  }
+
+  // stable, so left rows go before right rows of the same key.
+  auto sorted = SimpleSort(ctx, columns, 0, SortDirection::Ascending);
+
+  // row i + 1 matches iff keys of rows i and i + 1 are equal, its left
+  // payloads are moved from row i.
+  const auto &key = sorted[0];
+  auto eq = hal::equal(ctx, hal::slice(ctx, key, {0}, {n - 1}, {}),
+                       hal::slice(ctx, key, {1}, {n}, {}));
+  auto mask = padColumn(ctx, hal::dtype_cast(ctx, eq, DT_I64), 1, 0);
+  for (size_t idx = 1; idx < lhs.size(); ++idx) {
+    sorted[idx] =
+        padColumn(ctx, hal::slice(ctx, sorted[idx], {0}, {n - 1}, {}), 1, 0);
+  }
+
+  std::vector<spu::Value> moved;
+  spu::Value count;
+  if (mask.isSecret() && hal::has_secret_shuffle(ctx)) {
+    std::tie(moved, count) = hal::compact(ctx, sorted, mask);
+  } else {
+    // like pphlo level joins, matches go first by a sort of the mask.
+    std::vector<spu::Value> inputs = {mask};
+    inputs.insert(inputs.end(), sorted.begin(), sorted.end());
+    moved = SimpleSort(ctx, inputs, 0, SortDirection::Descending);
+    moved.erase(moved.begin());
+    count = hal::reshape(
+        ctx,
+        hal::matmul(ctx, hal::reshape(ctx, mask, {1, n}),
+                    hal::constant(ctx, static_cast<int64_t>(1), {n, 1})),
+        {});
+  }
+
+  std::vector<spu::Value> results;
+  for (const auto &column : moved) {
+    results.push_back(hal::slice(ctx, column, {0}, {rows}, {}));
+  }
+  results.push_back(count);
+  return results;
+}
+
+}  // namespace spu::kernel::hlo
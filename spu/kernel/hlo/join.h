@@ -0,0 +1,42 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "absl/types/span.h"
+
+#include "spu/kernel/context.h"
+#include "spu/kernel/value.h"
+
+namespace spu::kernel::hlo {
+
+/// Inner join of two tables on keys unique within each table, i.e. 1:1 joins
+/// of ids, without revealing the keys or the matches.
+///
+/// Both tables are sorted together by key with a stable SimpleSort, left rows
+/// first, so a match is a left row followed by a right row of the same key,
+/// which is found by one batched equality of adjacent keys. The matched rows
+/// are then compacted to the front, see `ObliviousFilterByMask`.
+/// @param lhs, the 1-D integer key followed by the payload columns of the
+///        left table, of the same length.
+/// @param rhs, the right table, as lhs.
+/// @return the key, the left payloads and the right payloads of
+///         min(n_lhs, n_rhs) rows, where only the first `count` rows are
+///         matched, followed by the secret count.
+std::vector<spu::Value> Join(HalContext *ctx, absl::Span<const spu::Value> lhs,
+                             absl::Span<const spu::Value> rhs);
+
+}  // namespace spu::kernel::hlo
@@ -0,0 +1,61 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/join.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hlo {
+
+TEST(JoinTest, UniqueKeys) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<int64_t> lhs_key = {7, 3, 9, 1, 5};
+  xt::xarray<float> lhs_value = {0.7, 0.3, 0.9, 0.1, 0.5};
+  xt::xarray<int64_t> rhs_key = {5, 2, 7, 4};
+  xt::xarray<int64_t> rhs_value = {50, 20, 70, 40};
+
+  for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+    auto ret = Join(&ctx,
+                    {hal::make_value(&ctx, vis, lhs_key),
+                     hal::make_value(&ctx, VIS_SECRET, lhs_value)},
+                    {hal::make_value(&ctx, vis, rhs_key),
+                     hal::make_value(&ctx, vis, rhs_value)});
+    ASSERT_EQ(ret.size(), 4);
+    EXPECT_EQ(ret[0].numel(), 4);
+
+    auto reveal = [&](const spu::Value &v) {
+      auto p = v.isSecret() ? hal::reveal(&ctx, v) : v;
+      return hal::test::dump_public_as<double>(&ctx, p);
+    };
+    EXPECT_EQ(reveal(ret[3])(), 2);
+
+    // matched rows are sorted by key.
+    auto key = reveal(ret[0]);
+    auto lhs_ret = reveal(ret[1]);
+    auto rhs_ret = reveal(ret[2]);
+    EXPECT_EQ(key(0), 5);
+    EXPECT_NEAR(lhs_ret(0), 0.5, 0.01);
+    EXPECT_EQ(rhs_ret(0), 50);
+    EXPECT_EQ(key(1), 7);
+    EXPECT_NEAR(lhs_ret(1), 0.7, 0.01);
+    EXPECT_EQ(rhs_ret(1), 70);
+  }
+}
+
+}  // namespace spu::kernel::hlo
@@ -0,0 +1,105 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/normalization.h"
+
+#include <cmath>
+#include <vector>
+
+#include "yacl/base/exception.h"
+
+#include "spu/core/type_util.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hlo/reduce.h"
+
+namespace spu::kernel::hlo {
+namespace {
+
+int64_t normalizeAxis(const spu::Value &x, int64_t axis) {
+  const auto rank = static_cast<int64_t>(x.shape().size());
+  if (axis < 0) {
+    axis += rank;
+  }
+  YACL_ENFORCE(axis >= 0 && axis < rank, "invalid axis {} for shape {}", axis,
+               x.shape());
+  return axis;
+}
+
+// The row sums of x along axis, keeping the dimension.
+spu::Value RowSum(HalContext *ctx, const spu::Value &x, int64_t axis) {
+  auto zero = hal::constant(ctx, 0.0F);
+  return Reduce(ctx, {x}, {zero}, {axis},
+                [&](absl::Span<const spu::Value> lhs,
+                    absl::Span<const spu::Value> rhs) {
+                  return std::vector<spu::Value>{
+                      hal::add(ctx, lhs[0], rhs[0])};
+                })[0];
+}
+
+// The row max of x along axis, keeping the dimension.
+spu::Value RowMax(HalContext *ctx, const spu::Value &x, int64_t axis) {
+  // fixed-points have no -inf, the init only has to be below all values.
+  const size_t k = SizeOf(ctx->getField()) * 8;
+  auto lowest = hal::constant(
+      ctx, -std::ldexp(1.0, static_cast<int>(k - ctx->getFxpBits() - 2)));
+  return Reduce(
+      ctx, {x}, {lowest}, {axis},
+      [&](absl::Span<const spu::Value> lhs,
+          absl::Span<const spu::Value> rhs) {
+        return std::vector<spu::Value>{hal::max(ctx, lhs[0], rhs[0])};
+      },
+      ReduceKind::Max)[0];
+}
+
+}  // namespace
+
+spu::Value Softmax(HalContext *ctx, const spu::Value &x, int64_t axis) {
+  YACL_ENFORCE(x.isFxp(), "expect fxp, got {}", x.dtype());
+  axis = normalizeAxis(x, axis);
+  if (x.numel() == 0) {
+    return x;
+  }
+
+  const auto &shape = x.shape();
+  auto max = hal::broadcast_to(ctx, RowMax(ctx, x, axis), shape);
+  auto e = hal::exp(ctx, hal::sub(ctx, x, max));
+  auto inv = hal::reciprocal(ctx, RowSum(ctx, e, axis));
+  return hal::mul(ctx, e, hal::broadcast_to(ctx, inv, shape));
+}
+
+spu::Value LayerNorm(HalContext *ctx, const spu::Value &x, double epsilon,
+                     int64_t axis) {
+  YACL_ENFORCE(x.isFxp(), "expect fxp, got {}", x.dtype());
+  axis = normalizeAxis(x, axis);
+  if (x.numel() == 0) {
+    return x;
+  }
+
+  const auto &shape = x.shape();
+  auto inv_n = hal::constant(ctx, 1.0 / static_cast<double>(shape[axis]));
+  auto scale = [&](const spu::Value &sum) {
+    return hal::mul(ctx, sum, hal::broadcast_to(ctx, inv_n, sum.shape()));
+  };
+
+  auto mean = scale(RowSum(ctx, x, axis));
+  auto xc = hal::sub(ctx, x, hal::broadcast_to(ctx, mean, shape));
+  auto var = scale(RowSum(ctx, hal::mul(ctx, xc, xc), axis));
+  auto eps = hal::broadcast_to(ctx, hal::constant(ctx, epsilon), var.shape());
+  auto inv_std = hal::rsqrt(ctx, hal::add(ctx, var, eps));
+  return hal::mul(ctx, xc, hal::broadcast_to(ctx, inv_std, shape));
+}
+
+}  // namespace spu::kernel::hlo
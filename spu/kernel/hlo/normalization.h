@@ -0,0 +1,36 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "spu/kernel/context.h"
+#include "spu/kernel/value.h"
+
+namespace spu::kernel::hlo {
+
+// Return exp(x - max(x)) / sum(exp(x - max(x))) along axis.
+//
+// The row max is reduced by the comparison trees of Reduce, and only the row
+// sums are inverted, i.e. one reciprocal per row instead of a division per
+// element.
+spu::Value Softmax(HalContext *ctx, const spu::Value &x, int64_t axis);
+
+// Return (x - mean(x)) * rsqrt(var(x) + epsilon) along axis, without scale
+// and offset. Only the row variances go through rsqrt.
+spu::Value LayerNorm(HalContext *ctx, const spu::Value &x, double epsilon,
+                     int64_t axis);
+
+}  // namespace spu::kernel::hlo
@@ -0,0 +1,62 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/normalization.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xmath.hpp"
+
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hlo {
+
+TEST(NormalizationTest, Softmax) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  const xt::xarray<float> x = {{1.0, 2.0, 3.0, 4.0}, {-1.5, 0.5, 2.0, -3.0}};
+
+  for (int64_t axis : {0, 1, -1}) {
+    const size_t a = axis < 0 ? 1 : axis;
+    const xt::xarray<float> e = xt::exp(x - xt::amax(x, {a}, xt::keep_dims));
+    const xt::xarray<float> expected = e / xt::sum(e, {a}, xt::keep_dims);
+
+    auto ret = Softmax(&ctx, hal::make_value(&ctx, VIS_SECRET, x), axis);
+    EXPECT_EQ(ret.shape(), x.shape());
+    auto got =
+        hal::test::dump_public_as<float>(&ctx, hal::reveal(&ctx, ret));
+    EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.001)) << got;
+  }
+}
+
+TEST(NormalizationTest, LayerNorm) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  const xt::xarray<float> x = {{1.0, 2.0, 3.0, 4.0}, {-1.5, 0.5, 2.0, -3.0}};
+  const double eps = 1e-3;
+
+  const xt::xarray<float> xc = x - xt::mean(x, {1}, xt::keep_dims);
+  const xt::xarray<float> var = xt::mean(xc * xc, {1}, xt::keep_dims);
+  const xt::xarray<float> expected = xc / xt::sqrt(var + eps);
+
+  auto ret = LayerNorm(&ctx, hal::make_value(&ctx, VIS_SECRET, x), eps, 1);
+  auto got = hal::test::dump_public_as<float>(&ctx, hal::reveal(&ctx, ret));
+  EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.01)) << got;
+
+  EXPECT_THROW(LayerNorm(&ctx, hal::make_value(&ctx, VIS_SECRET, x), eps, 2),
+               yacl::EnforceNotMet);
+}
+
+}  // namespace spu::kernel::hlo
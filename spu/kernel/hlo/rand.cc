@@ -21,6 +21,9 @@ namespace spu::kernel::hlo {
 spu::Value Uniform_rand(HalContext *ctx, const spu::Value &lo,
                         const spu::Value &hi,
                         absl::Span<const int64_t> to_shape) {
+  if (lo.isSecret() || hi.isSecret()) {
+    return hal::rng_uniform_s(ctx, lo, hi, to_shape);
+  }
   return hal::rng_uniform(ctx, lo, hi, to_shape);
 }
 
@@ -18,6 +18,8 @@
 
 namespace spu::kernel::hlo {
 
+// Uniform rand in [lo, hi), secret if either bound is, drawn by the protocol
+// without communication, see hal::rng_uniform_s.
 spu::Value Uniform_rand(HalContext *ctx, const spu::Value &lo,
                         const spu::Value &hi,
                         absl::Span<const int64_t> to_shape);
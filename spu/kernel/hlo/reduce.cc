@@ -16,12 +16,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <future>
 #include <iostream>
-#include <stack>
 #include <vector>
 
-#include "spu/core/parallel_utils.h"
 #include "spu/core/shape_util.h"
 #include "spu/kernel/hal/concat.h"
 #include "spu/kernel/hal/constants.h"
@@ -43,8 +42,7 @@ std::vector<spu::Value> TreeReduce(HalContext *ctx,
 
   std::vector<spu::Value> lhs(nargs);
   std::vector<spu::Value> rhs(nargs);
-
-  std::stack<std::vector<spu::Value>> tails;
+  std::vector<spu::Value> tail(nargs);
 
   std::vector<int64_t> slice_begin(inputs.back().shape().size(), 0);
   std::vector<int64_t> slice_end = inputs.back().shape();
@@ -74,10 +72,10 @@ std::vector<spu::Value> TreeReduce(HalContext *ctx,
     }
 
     // tail
-    if (len % 2 == 1) {
+    const bool has_tail = len % 2 == 1;
+    if (has_tail) {
       slice_begin[axis] = 2 * half;
       slice_end[axis] = len;
-      std::vector<spu::Value> &tail = tails.emplace(nargs);
       for (size_t idx = 0; idx < outputs.size(); ++idx) {
         tail[idx] = hal::slice(
             ctx, outputs[idx],
@@ -88,87 +86,236 @@ std::vector<spu::Value> TreeReduce(HalContext *ctx,
     }
 
     outputs = reducer(lhs, rhs);
-    len /= 2;
+
+    // the tail joins the next level instead of being reduced at last, so
+    // there are exactly ceil(lg(n)) reducer calls, i.e. len = 63 iterates 6
+    // times (32, 16, 8, 4, 2, 1).
+    if (has_tail) {
+      for (size_t idx = 0; idx < outputs.size(); ++idx) {
+        outputs[idx] = hal::concatenate(ctx, {outputs[idx], tail[idx]}, axis);
+      }
+    }
+    len = half + (has_tail ? 1 : 0);
 
     YACL_ENFORCE(outputs[0].shape()[axis] == len);
   }
 
-  // TODO: this may cause at worst 2*lg(n) time of reducer call, compare the
-  // best case lg(n) times.
-  //
-  // consider len = 63, will iterate 5 (31, 15, 7, 3, 1), and generate
-  // len(tails) = 5, the total number is 5 + 5 = 10 times.
-  //
-  // Optimize ME.
-  while (!tails.empty()) {
-    outputs = reducer(outputs, tails.top());
-    tails.pop();
+  return outputs;
+}
+
+namespace {
+
+// Reduce the last axis of a secret by max or min with k-ary comparison trees.
+//
+// Each level compares all pairs of every k candidates in one comparison, the
+// winner of a group is the one which beats all others, i.e. an AND of k-1
+// bits, then one select picks it. So a level takes one comparison,
+// ceil(lg(k-1)) ANDs and one select to reduce the length by k times, instead
+// of lg(k) levels of one comparison and one select each, at the cost of
+// k(k-1)/2 instead of k-1 comparisons per group.
+spu::Value KAryTreeReduce(HalContext *ctx, const spu::Value &input,
+                          ReduceKind kind, int64_t arity) {
+  std::vector<int64_t> ret_shape = input.shape();
+  const int64_t len = ret_shape.back();
+  const int64_t rows = input.numel() / len;
+  ret_shape.back() = 1;
+
+  auto x = hal::reshape(ctx, input, {rows, len});
+  int64_t cur = len;
+  while (cur > 1) {
+    const int64_t k = std::min(arity, cur);
+    const int64_t groups = cur / k;
+    const int64_t rest = cur % k;
+    const int64_t m = rows * groups;
+
+    auto candidates = hal::reshape(
+        ctx, hal::slice(ctx, x, {0, 0}, {rows, groups * k}, {}), {m, k});
+    std::vector<spu::Value> cols;
+    for (int64_t i = 0; i < k; i++) {
+      cols.push_back(hal::reshape(
+          ctx, hal::slice(ctx, candidates, {0, i}, {m, i + 1}, {}), {m}));
+    }
+
+    // candidate i beats j, ties go to the lower index.
+    std::vector<spu::Value> lhs;
+    std::vector<spu::Value> rhs;
+    for (int64_t i = 0; i < k; i++) {
+      for (int64_t j = i + 1; j < k; j++) {
+        lhs.push_back(cols[i]);
+        rhs.push_back(cols[j]);
+      }
+    }
+    auto lhs_all = hal::concatenate(ctx, lhs, 0);
+    auto rhs_all = hal::concatenate(ctx, rhs, 0);
+    auto beats = kind == ReduceKind::Max
+                     ? hal::greater_equal(ctx, lhs_all, rhs_all)
+                     : hal::less_equal(ctx, lhs_all, rhs_all);
+    auto beaten = hal::logical_not(ctx, beats);
+
+    auto pairBits = [&](const spu::Value &bits, int64_t i, int64_t j) {
+      // index of pair (i, j), i < j, in the lexicographical order.
+      const int64_t pair = i * (2 * k - i - 1) / 2 + (j - i - 1);
+      return hal::slice(ctx, bits, {pair * m}, {(pair + 1) * m}, {});
+    };
+
+    // the t-th opponent of all candidates, candidate-major.
+    std::vector<spu::Value> wins;
+    for (int64_t t = 0; t + 1 < k; t++) {
+      std::vector<spu::Value> parts;
+      for (int64_t i = 0; i < k; i++) {
+        const int64_t j = t < i ? t : t + 1;
+        parts.push_back(i < j ? pairBits(beats, i, j)
+                              : pairBits(beaten, j, i));
+      }
+      wins.push_back(hal::concatenate(ctx, parts, 0));
+    }
+    while (wins.size() > 1) {
+      std::vector<spu::Value> next;
+      for (size_t idx = 0; idx + 1 < wins.size(); idx += 2) {
+        next.push_back(hal::bitwise_and(ctx, wins[idx], wins[idx + 1]));
+      }
+      if (wins.size() % 2 == 1) {
+        next.push_back(wins.back());
+      }
+      wins = std::move(next);
+    }
+
+    // exactly one winner per group, pick it by a sum of selects.
+    auto all = hal::concatenate(ctx, cols, 0);
+    auto picked = hal::select(
+        ctx, wins[0], all,
+        hal::zeros(ctx, VIS_PUBLIC, all.dtype(), all.shape()));
+    auto reduced = hal::slice(ctx, picked, {0}, {m}, {});
+    for (int64_t i = 1; i < k; i++) {
+      reduced = hal::add(ctx, reduced,
+                         hal::slice(ctx, picked, {i * m}, {(i + 1) * m}, {}));
+    }
+    reduced = hal::reshape(ctx, reduced, {rows, groups});
+
+    if (rest > 0) {
+      x = hal::concatenate(
+          ctx, {reduced, hal::slice(ctx, x, {0, groups * k}, {rows, cur}, {})},
+          1);
+    } else {
+      x = reduced;
+    }
+    cur = groups + rest;
   }
 
-  return outputs;
+  return hal::reshape(ctx, x, ret_shape);
 }
 
-spu::Value ExpandStridedWindow(
+// Sum the last axis by a matmul with public ones, which is local for all
+// visibilities, so the whole axis is reduced at once without the lg(n) levels
+// of sliced intermediates of a tree.
+spu::Value SumLastAxis(HalContext *ctx, const spu::Value &input) {
+  std::vector<int64_t> ret_shape = input.shape();
+  const int64_t len = ret_shape.back();
+  const int64_t rows = input.numel() / len;
+  ret_shape.back() = 1;
+
+  auto x = hal::reshape(ctx, input, {rows, len});
+  auto ones = hal::constant(ctx, static_cast<int64_t>(1), {len, 1});
+  if (x.isInt()) {
+    ones = hal::dtype_cast(ctx, ones, x.dtype());
+  }
+  // fxp x int ones does not truncate, so pending bits are kept as is.
+  auto sum = hal::matmul(ctx, x, ones).setDtype(input.dtype());
+  return hal::reshape(ctx, sum, ret_shape)
+      .setPendingTruncBits(input.pendingTruncBits());
+}
+
+// Reduce the last axis, by one local sum for additions, by k-ary comparison
+// trees when possible.
+std::vector<spu::Value> ReduceLastAxis(HalContext *ctx,
+                                       absl::Span<const spu::Value> inputs,
+                                       const BatchedValueBinaryFn &reducer,
+                                       ReduceKind reduce_kind) {
+  const auto arity =
+      static_cast<int64_t>(ctx->rt_config().reduce_tree_arity());
+  const auto axis = static_cast<int64_t>(inputs[0].shape().size()) - 1;
+  if ((reduce_kind == ReduceKind::Max || reduce_kind == ReduceKind::Min) &&
+      arity > 2 && inputs.size() == 1 && inputs[0].isSecret() &&
+      inputs[0].numel() > 0) {
+    return {KAryTreeReduce(ctx, inputs[0], reduce_kind, arity)};
+  }
+  if (reduce_kind == ReduceKind::Add && inputs.size() == 1 &&
+      inputs[0].numel() > 0 && inputs[0].dtype() != DT_I1) {
+    return {SumLastAxis(ctx, inputs[0])};
+  }
+  return TreeReduce(ctx, inputs, axis, reducer);
+}
+
+}  // namespace
+
+spu::Value ExpandTiledWindow(
     HalContext *ctx, const spu::Value &base,
     absl::Span<const int64_t> window_shape,
     absl::Span<const int64_t> window_strides,
     absl::Span<const std::pair<int64_t, int64_t>> padding) {
-  const auto &base_shape = base.shape();
-  const size_t ndim = base_shape.size();
+  const size_t ndim = base.shape().size();
 
   YACL_ENFORCE(ndim == window_shape.size() &&    //
                ndim == window_strides.size() &&  //
                ndim == padding.size());
 
-  // calculate output shape
-  std::vector<int64_t> expanded_shape(ndim, 0);
+  spu::Value padded = base;
+  if (std::any_of(padding.begin(), padding.end(), [](const auto &p) {
+        return p.first != 0 || p.second != 0;
+      })) {
+    // padding element is zero, i.e. a share of all zero bytes.
+    spu::Value zero(NdArrayRef(base.storage_type(), {}), base.dtype());
+    std::memset(zero.data().data(), 0, zero.elsize());
+
+    std::vector<int64_t> padding_low(ndim, 0);
+    std::vector<int64_t> padding_high(ndim, 0);
+    for (size_t dim = 0; dim < ndim; dim++) {
+      padding_low[dim] = padding[dim].first;
+      padding_high[dim] = padding[dim].second;
+    }
+    padded = hal::pad(ctx, base, zero, padding_low, padding_high,
+                      std::vector<int64_t>(ndim, 0));
+  }
+
+  // window i of a dim starts at i * stride of the padded base, so windows are
+  // a strided view of it, which overlap when stride < window.
+  std::vector<int64_t> tiled_shape(2 * ndim, 0);
+  std::vector<int64_t> tiled_strides(2 * ndim, 0);
   for (size_t dim = 0; dim < ndim; dim++) {
-    int64_t padded_size =
-        padding[dim].first + padding[dim].second + base_shape[dim];
+    const int64_t padded_size = padded.shape()[dim];
     YACL_ENFORCE((padded_size - window_shape[dim]) % window_strides[dim] == 0);
-    expanded_shape[dim] =
-        ((padded_size - window_shape[dim]) / window_strides[dim] + 1) *
-        window_shape[dim];
+    tiled_shape[dim] =
+        (padded_size - window_shape[dim]) / window_strides[dim] + 1;
+    tiled_shape[ndim + dim] = window_shape[dim];
+    tiled_strides[dim] = padded.strides()[dim] * window_strides[dim];
+    tiled_strides[ndim + dim] = padded.strides()[dim];
   }
 
-  const std::vector<int64_t> window_dilations(window_shape.size(), 1);
-  const std::vector<int64_t> base_dilations(base.shape().size(), 1);
-  // expand it, assume padding & dialation element is zero.
-  spu::Value expanded =
-      hal::zeros(ctx, base.vtype(), base.dtype(), expanded_shape);
-
-  auto numel = calcNumel(expanded_shape);
-
-  yacl::parallel_for(
-      0, numel, computeTaskSize(numel), [&](int64_t begin, int64_t end) {
-        std::vector<int64_t> expanded_index =
-            unflattenIndex(begin, expanded_shape);
-
-        std::vector<int64_t> window_count_index(ndim, 0);
-        std::vector<int64_t> window_index(ndim, 0);
+  return spu::Value(NdArrayRef(padded.data().buf(), padded.data().eltype(),
+                               tiled_shape, tiled_strides,
+                               padded.data().offset()),
+                    padded.dtype());
+}
 
-        for (int64_t idx = begin; idx < end; ++idx) {
-          for (size_t dim = 0; dim < ndim; dim++) {
-            window_index[dim] = expanded_index[dim] % window_shape[dim];
-            window_count_index[dim] = expanded_index[dim] / window_shape[dim];
-          }
+spu::Value ExpandStridedWindow(
+    HalContext *ctx, const spu::Value &base,
+    absl::Span<const int64_t> window_shape,
+    absl::Span<const int64_t> window_strides,
+    absl::Span<const std::pair<int64_t, int64_t>> padding) {
+  auto tiled =
+      ExpandTiledWindow(ctx, base, window_shape, window_strides, padding);
 
-          std::vector<int64_t> base_index(ndim, 0);
-          bool out_of_bound = getBaseIndexFromWindowIndex(
-              window_shape, window_strides, window_dilations, padding,
-              base_shape, base_dilations, window_count_index, window_index,
-              absl::MakeSpan(base_index));
-          if (!out_of_bound) {
-            expanded.copyElementFrom(base, base_index, expanded_index);
-          }
-          if (!bumpIndices<int64_t>(expanded_shape,
-                                    absl::MakeSpan(expanded_index))) {
-            break;
-          }
-        }
-      });
+  // [c0, c1, w0, w1] -> [c0, w0, c1, w1] -> [c0 * w0, c1 * w1]
+  const size_t ndim = window_shape.size();
+  std::vector<int64_t> perm;
+  std::vector<int64_t> expanded_shape;
+  for (size_t dim = 0; dim < ndim; dim++) {
+    perm.push_back(dim);
+    perm.push_back(ndim + dim);
+    expanded_shape.push_back(tiled.shape()[dim] * window_shape[dim]);
+  }
 
-  return expanded;
+  return hal::reshape(ctx, hal::transpose(ctx, tiled, perm), expanded_shape);
 }
 
 spu::Value ConvertToTiledLayout(HalContext *ctx, const spu::Value &in,
@@ -201,7 +348,8 @@ std::vector<spu::Value> ReduceWindowWithoutDilation(
     absl::Span<const int64_t> window_strides,
     absl::Span<const std::pair<int64_t, int64_t>> window_padding,
     bool last_operand_is_window_mask, bool ignore_init_value,
-    absl::Span<const int64_t> ret_shape, const BatchedValueBinaryFn &reducer) {
+    absl::Span<const int64_t> ret_shape, const BatchedValueBinaryFn &reducer,
+    ReduceKind reduce_kind) {
   const size_t nargs =
       last_operand_is_window_mask ? inputs.size() - 1 : inputs.size();
 
@@ -212,9 +360,8 @@ std::vector<spu::Value> ReduceWindowWithoutDilation(
   std::vector<spu::Value> expanded;
   for (size_t idx = 0; idx < nargs; ++idx) {
     const auto &input = inputs[idx];
-    auto x = ExpandStridedWindow(ctx, input, window_shape, window_strides,
-                                 window_padding);
-    expanded.emplace_back(ConvertToTiledLayout(ctx, x, window_shape));
+    expanded.emplace_back(ExpandTiledWindow(ctx, input, window_shape,
+                                            window_strides, window_padding));
   }
 
   if (last_operand_is_window_mask) {
@@ -253,7 +400,12 @@ std::vector<spu::Value> ReduceWindowWithoutDilation(
   }
 
   // reduce the last axis
-  auto outputs = TreeReduce(ctx, expanded, tiled_1d_shape.size() - 1, reducer);
+  std::vector<spu::Value> outputs;
+  if (last_operand_is_window_mask) {
+    outputs = TreeReduce(ctx, expanded, tiled_1d_shape.size() - 1, reducer);
+  } else {
+    outputs = ReduceLastAxis(ctx, expanded, reducer, reduce_kind);
+  }
 
   // reduce the last axis
   for (size_t idx = 0; idx < nargs; idx++) {
@@ -282,7 +434,8 @@ std::vector<spu::Value> ReduceWindowImpl(
     absl::Span<const spu::Value> init_values,
     absl::Span<const int64_t> ret_shape, const ReduceWindowConfig &config,
     bool last_operand_is_window_mask, bool ignore_init_value,
-    const BatchedValueBinaryFn &reducer) {
+    const BatchedValueBinaryFn &reducer,
+    ReduceKind reduce_kind = ReduceKind::None) {
   if (std::all_of(config.window_dilations.begin(),
                   config.window_dilations.end(),
                   [](const int64_t x) { return x == 1; }) &&
@@ -291,7 +444,7 @@ std::vector<spu::Value> ReduceWindowImpl(
     return ReduceWindowWithoutDilation(
         ctx, inputs, init_values, config.window_shape, config.window_strides,
         config.window_padding, last_operand_is_window_mask, ignore_init_value,
-        ret_shape, reducer);
+        ret_shape, reducer, reduce_kind);
   }
 
   YACL_ENFORCE(!last_operand_is_window_mask);
@@ -355,16 +508,18 @@ std::vector<spu::Value> ReduceWindow(HalContext *ctx,
                                      absl::Span<const spu::Value> init_values,
                                      absl::Span<const int64_t> ret_shape,
                                      const ReduceWindowConfig &config,
-                                     const BatchedValueBinaryFn &reducer) {
+                                     const BatchedValueBinaryFn &reducer,
+                                     ReduceKind reduce_kind) {
   return ReduceWindowImpl(ctx, inputs, init_values, ret_shape, config, false,
-                          false, reducer);
+                          false, reducer, reduce_kind);
 }
 
 std::vector<spu::Value> Reduce(HalContext *ctx,
                                absl::Span<const spu::Value> inputs,
                                absl::Span<const spu::Value> init_values,
                                absl::Span<const int64_t> dims_to_reduce,
-                               const BatchedValueBinaryFn &reducer) {
+                               const BatchedValueBinaryFn &reducer,
+                               ReduceKind reduce_kind) {
   // Reduce multiple dimension
   //
   // The straight-forward method iterates dimension_to_reduce with each dim a
@@ -388,9 +543,6 @@ std::vector<spu::Value> Reduce(HalContext *ctx,
   // to
   //   ceil(lg(3 * 5)) = 4
   //
-  // But in current TreeReduce (unoptimized) implementation, this method is
-  // slower.
-  //
   // Note(jint): this `lowering` progress is easy to be ported to
   // compile-time.
 
@@ -423,8 +575,7 @@ std::vector<spu::Value> Reduce(HalContext *ctx,
   }
 
   // reduce the inner most axis
-  auto results =
-      TreeReduce(ctx, flattened, flattened[0].shape().size() - 1, reducer);
+  auto results = ReduceLastAxis(ctx, flattened, reducer, reduce_kind);
 
   // broadcast to origin shape.
   std::vector<int64_t> out_shape = inputs[0].shape();
@@ -27,6 +27,27 @@ namespace spu::kernel::hlo {
 using BatchedValueBinaryFn = std::function<std::vector<spu::Value>(
     absl::Span<spu::Value const> lhs, absl::Span<spu::Value const> rhs)>;
 
+// Reducers which are a plain binary op of a single operand. Max and min could
+// be reduced by k-ary comparison trees, see RuntimeConfig.reduce_tree_arity,
+// and add is reduced in one local pass instead of a tree.
+enum class ReduceKind {
+  None,
+  Max,
+  Min,
+  Add,
+};
+
+/// Windows of base in tiled layout, i.e. [window counts..., window_shape...],
+/// the same as ConvertToTiledLayout of ExpandStridedWindow. It is a strided
+/// view of base, or of the zero padded base, so nothing is copied for
+/// overlapping windows.
+spu::Value ExpandTiledWindow(
+    HalContext *ctx, const spu::Value &base,
+    absl::Span<const int64_t> window_shape,
+    absl::Span<const int64_t> window_strides,
+    absl::Span<const std::pair<int64_t, int64_t>> padding);
+
+/// Windows of base in column layout, i.e. [window counts x window_shape].
 spu::Value ExpandStridedWindow(
     HalContext *ctx, const spu::Value &base,
     absl::Span<const int64_t> window_shape,
@@ -54,13 +75,15 @@ std::vector<spu::Value> ReduceWindow(HalContext *ctx,
                                      absl::Span<const spu::Value> init_values,
                                      absl::Span<const int64_t> ret_shape,
                                      const ReduceWindowConfig &config,
-                                     const BatchedValueBinaryFn &reducer);
+                                     const BatchedValueBinaryFn &reducer,
+                                     ReduceKind reduce_kind = ReduceKind::None);
 
 std::vector<spu::Value> Reduce(HalContext *ctx,
                                absl::Span<const spu::Value> inputs,
                                absl::Span<const spu::Value> init_values,
                                absl::Span<const int64_t> dimensions_to_reduce,
-                               const BatchedValueBinaryFn &reducer);
+                               const BatchedValueBinaryFn &reducer,
+                               ReduceKind reduce_kind = ReduceKind::None);
 
 std::pair<spu::Value, spu::Value> ArgMax(HalContext *ctx,
                                          const spu::Value &input,
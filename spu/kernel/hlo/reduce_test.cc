@@ -0,0 +1,164 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/reduce.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xmath.hpp"
+
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+
+namespace spu::kernel::hlo {
+
+TEST(ReduceTest, TreeReduceCalls) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  for (int64_t n : {1, 2, 5, 63, 64}) {
+    xt::xarray<int64_t> x = hal::test::xt_random<int64_t>({3, size_t(n)});
+
+    size_t calls = 0;
+    auto ret = TreeReduce(
+        &ctx, {hal::make_value(&ctx, VIS_PUBLIC, x)}, 1,
+        [&](absl::Span<const spu::Value> lhs,
+            absl::Span<const spu::Value> rhs) {
+          calls++;
+          return std::vector<spu::Value>{hal::add(&ctx, lhs[0], rhs[0])};
+        });
+
+    // exactly ceil(lg(n)) reducer calls.
+    size_t expected_calls = 0;
+    while ((int64_t(1) << expected_calls) < n) {
+      expected_calls++;
+    }
+    EXPECT_EQ(calls, expected_calls) << n;
+
+    const xt::xarray<int64_t> expected = xt::sum(x, {1}, xt::keep_dims);
+    EXPECT_EQ(hal::test::dump_public_as<int64_t>(&ctx, ret[0]), expected) << n;
+  }
+}
+
+TEST(ReduceTest, SumWithoutTree) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<float> x = hal::test::xt_random<float>({3, 4, 5});
+  xt::xarray<int64_t> y = hal::test::xt_random<int64_t>({3, 4, 5});
+
+  for (auto vis : {VIS_PUBLIC, VIS_SECRET}) {
+    auto open = [&](const spu::Value &v) {
+      return v.isSecret() ? hal::reveal(&ctx, v) : v;
+    };
+    size_t calls = 0;
+    auto add = [&](absl::Span<const spu::Value> lhs,
+                   absl::Span<const spu::Value> rhs) {
+      calls++;
+      return std::vector<spu::Value>{hal::add(&ctx, lhs[0], rhs[0])};
+    };
+
+    auto fxp_ret = Reduce(&ctx, {hal::make_value(&ctx, vis, x)},
+                          {hal::constant(&ctx, 1.0F)}, {0, 2}, add,
+                          ReduceKind::Add);
+    auto int_ret = Reduce(&ctx, {hal::make_value(&ctx, vis, y)},
+                          {hal::constant(&ctx, int64_t{0})}, {1}, add,
+                          ReduceKind::Add);
+    // only the init values are applied by the reducer.
+    EXPECT_EQ(calls, 2U);
+
+    const xt::xarray<float> fxp_expected =
+        xt::sum(x, {0, 2}, xt::keep_dims) + 1.0F;
+    auto fxp_got = hal::test::dump_public_as<float>(&ctx, open(fxp_ret[0]));
+    EXPECT_TRUE(xt::allclose(fxp_expected, fxp_got, 0.01, 0.001)) << fxp_got;
+
+    const xt::xarray<int64_t> int_expected = xt::sum(y, {1}, xt::keep_dims);
+    EXPECT_EQ(hal::test::dump_public_as<int64_t>(&ctx, open(int_ret[0])),
+              int_expected);
+  }
+}
+
+TEST(ReduceTest, ExpandTiledWindow) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  xt::xarray<int64_t> x = {{1, 2, 3}, {4, 5, 6}};
+  auto v = hal::make_value(&ctx, VIS_SECRET, x);
+
+  // 2x2 windows of stride 1, with one zero column padded on the left.
+  std::vector<int64_t> window_shape = {2, 2};
+  std::vector<int64_t> window_strides = {1, 1};
+  std::vector<std::pair<int64_t, int64_t>> padding = {{0, 0}, {1, 0}};
+
+  auto tiled =
+      ExpandTiledWindow(&ctx, v, window_shape, window_strides, padding);
+  EXPECT_EQ(tiled.shape(), (std::vector<int64_t>{1, 3, 2, 2}));
+
+  xt::xarray<int64_t> expected = {
+      {{{0, 1}, {0, 4}}, {{1, 2}, {4, 5}}, {{2, 3}, {5, 6}}}};
+  EXPECT_EQ(hal::test::dump_public_as<int64_t>(&ctx, hal::reveal(&ctx, tiled)),
+            expected);
+
+  auto expanded =
+      ExpandStridedWindow(&ctx, v, window_shape, window_strides, padding);
+  EXPECT_EQ(hal::test::dump_public_as<int64_t>(
+                &ctx, hal::reveal(&ctx, ConvertToTiledLayout(&ctx, expanded,
+                                                             window_shape))),
+            expected);
+}
+
+class KAryReduceTest
+    : public ::testing::TestWithParam<std::tuple<uint64_t, int64_t>> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    KAryReduceTestInstances, KAryReduceTest,
+    testing::Combine(testing::Values(0, 3, 4, 8), testing::Values(1, 7, 16)),
+    [](const testing::TestParamInfo<KAryReduceTest::ParamType> &p) {
+      return fmt::format("arity{}x{}", std::get<0>(p.param),
+                         std::get<1>(p.param));
+    });
+
+TEST_P(KAryReduceTest, MaxMin) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_reduce_tree_arity(std::get<0>(GetParam()));
+  HalContext ctx = hal::test::makeRefHalContext(config);
+
+  const auto n = static_cast<size_t>(std::get<1>(GetParam()));
+  // with duplicates.
+  xt::xarray<float> x =
+      xt::cast<float>(hal::test::xt_random<int64_t>({4, n}, -5, 5));
+
+  for (auto kind : {ReduceKind::Max, ReduceKind::Min}) {
+    const bool is_max = kind == ReduceKind::Max;
+    auto init = hal::constant(&ctx, is_max ? -100.0F : 100.0F);
+    auto ret = Reduce(
+        &ctx, {hal::make_value(&ctx, VIS_SECRET, x)}, {init}, {1},
+        [&](absl::Span<const spu::Value> lhs,
+            absl::Span<const spu::Value> rhs) {
+          return std::vector<spu::Value>{
+              is_max ? hal::max(&ctx, lhs[0], rhs[0])
+                     : hal::min(&ctx, lhs[0], rhs[0])};
+        },
+        kind);
+
+    const xt::xarray<float> expected =
+        is_max ? xt::xarray<float>(xt::amax(x, {1}, xt::keep_dims))
+               : xt::xarray<float>(xt::amin(x, {1}, xt::keep_dims));
+    auto got = hal::test::dump_public_as<float>(
+        &ctx, hal::_s2p(&ctx, ret[0]).setDtype(ret[0].dtype()));
+    EXPECT_TRUE(xt::allclose(expected, got, 0.01, 0.001)) << got;
+  }
+}
+
+}  // namespace spu::kernel::hlo
@@ -16,17 +16,16 @@
 #include "spu/kernel/hlo/select_and_scatter.h"
 
 #include <cstdint>
-#include <future>
 #include <iostream>
 #include <vector>
 
-#include "yacl/utils/parallel.h"
-
 #include "spu/core/shape_util.h"
 #include "spu/kernel/context.h"
+#include "spu/kernel/hal/concat.h"
 #include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/debug.h"
 #include "spu/kernel/hal/polymorphic.h"  // for select
+#include "spu/kernel/hal/prot_wrapper.h"
 #include "spu/kernel/hal/shape_ops.h"
 #include "spu/kernel/hal/type_cast.h"
 #include "spu/kernel/hlo/const.h"
@@ -36,50 +35,49 @@
 
 namespace spu::kernel::hlo {
 
-spu::Value MaxPoolScatter1x2x2x1NoPaddingNoStrides(
-    HalContext *ctx, const spu::Value &scatter_indices,
-    const spu::Value &source) {
-  std::vector<spu::Value> slices(4);
-  for (int64_t idx = 0; idx < 4; ++idx) {
-    slices[idx] = hal::slice(
-        ctx, scatter_indices, {0, 0, 0, 0, idx},
-        {scatter_indices.shape()[0], scatter_indices.shape()[1],
-         scatter_indices.shape()[2], scatter_indices.shape()[3], idx + 1},
-        {1, 1, 1, 1, 1});
-    slices[idx] =
-        hal::mul(ctx, hal::reshape(ctx, slices[idx], source.shape()), source);
-
-    // FIXME(jint), handle int type promotion
-    slices[idx] = hal::dtype_cast(ctx, slices[idx], source.dtype());
-  }
+namespace {
+
+// Element k of the last axis of windows [window counts..., window_numel].
+spu::Value WindowElement(HalContext *ctx, const spu::Value &tiled_1d,
+                         int64_t k) {
+  std::vector<int64_t> shape = tiled_1d.shape();
+  std::vector<int64_t> start(shape.size(), 0);
+  std::vector<int64_t> end = shape;
+  std::vector<int64_t> strides(shape.size(), 1);
+  start.back() = k;
+  end.back() = k + 1;
+
+  shape.pop_back();
+  return hal::reshape(ctx, hal::slice(ctx, tiled_1d, start, end, strides),
+                      shape);
+}
 
-  auto z = hal::zeros(ctx, slices[0].vtype(), slices[0].dtype());
-
-  std::vector<std::future<spu::Value>> f_slices(4);
-  f_slices[0] = std::async(std::launch::async, hal::pad, ctx, slices[0], z,
-                           std::vector<int64_t>{0, 0, 0, 0},
-                           std::vector<int64_t>{0, 1, 1, 0},
-                           std::vector<int64_t>{0, 0, 0, 0});
-  f_slices[1] = std::async(std::launch::async, hal::pad, ctx, slices[1], z,
-                           std::vector<int64_t>{0, 0, 1, 0},
-                           std::vector<int64_t>{0, 1, 0, 0},
-                           std::vector<int64_t>{0, 0, 0, 0});
-  f_slices[2] = std::async(std::launch::async, hal::pad, ctx, slices[2], z,
-                           std::vector<int64_t>{0, 1, 0, 0},
-                           std::vector<int64_t>{0, 0, 1, 0},
-                           std::vector<int64_t>{0, 0, 0, 0});
-  f_slices[3] = std::async(std::launch::async, hal::pad, ctx, slices[3], z,
-                           std::vector<int64_t>{0, 1, 1, 0},
-                           std::vector<int64_t>{0, 0, 0, 0},
-                           std::vector<int64_t>{0, 0, 0, 0});
-
-  spu::Value ret = f_slices[0].get();
-  for (size_t idx = 1; idx < 4; ++idx) {
-    ret = hal::add(ctx, ret, f_slices[idx].get());
+// Scatter one element of all windows back to the base. The element of window
+// c goes to c * stride + window_index - padding_low of a dim, i.e. a strided
+// pad of the elements, where negative edge paddings drop those out of base.
+spu::Value ScatterWindowElement(
+    HalContext *ctx, const spu::Value &element,
+    const spu::Value &padding_value, absl::Span<const int64_t> window_index,
+    absl::Span<const int64_t> base_shape,
+    absl::Span<const int64_t> window_strides,
+    absl::Span<const std::pair<int64_t, int64_t>> window_padding) {
+  const size_t ndim = base_shape.size();
+  std::vector<int64_t> padding_low(ndim, 0);
+  std::vector<int64_t> padding_high(ndim, 0);
+  std::vector<int64_t> padding_interior(ndim, 0);
+  for (size_t dim = 0; dim < ndim; dim++) {
+    const int64_t count = element.shape()[dim];
+    padding_low[dim] = window_index[dim] - window_padding[dim].first;
+    padding_interior[dim] = window_strides[dim] - 1;
+    padding_high[dim] = base_shape[dim] - padding_low[dim] -
+                        (count - 1) * window_strides[dim] - 1;
   }
 
-  return ret;
-};
+  return hal::pad(ctx, element, padding_value, padding_low, padding_high,
+                  padding_interior);
+}
+
+}  // namespace
 
 spu::Value MaxPoolScatter(
     HalContext *ctx, const spu::Value &scatter_indices,
@@ -87,18 +85,6 @@ spu::Value MaxPoolScatter(
     absl::Span<const int64_t> base_shape,
     absl::Span<const int64_t> window_strides,
     absl::Span<const std::pair<int64_t, int64_t>> window_padding) {
-  // Add a fast 1x2x2x1, no padding fast reduce
-  auto no_padding = std::all_of(window_padding.begin(), window_padding.end(),
-                                [](const std::pair<int64_t, int64_t> &p) {
-                                  return p.first == 0 && p.second == 0;
-                                });
-  auto one_stride = std::all_of(window_strides.begin(), window_strides.end(),
-                                [](auto v) { return v == 1; });
-  if (window_shape == absl::Span<const int64_t>{1, 2, 2, 1} && no_padding &&
-      one_stride) {
-    return MaxPoolScatter1x2x2x1NoPaddingNoStrides(ctx, scatter_indices,
-                                                   source);
-  }
   //  source_shape * window_numel
   std::vector<int64_t> tiled_1d_shape = source.shape();
   const int64_t window_numel = std::accumulate(
@@ -111,65 +97,27 @@ spu::Value MaxPoolScatter(
   auto tiled_1d_source =
       hal::broadcast_to(ctx, source, tiled_1d_shape, broadcast_dims);
 
-  // selected_pos is the one hot encoding for each window.
+  // scatter_indices is the one hot encoding for each window, computed by
+  // ArgMax of the forward pass, so no comparison is needed here.
   auto selected = hal::mul(ctx, tiled_1d_source, scatter_indices);
 
-  std::vector<int64_t> tiled_shape(source.shape().begin(),
-                                   source.shape().end());
-  tiled_shape.insert(tiled_shape.end(), window_shape.begin(),
-                     window_shape.end());
-
-  selected = hal::reshape(ctx, selected, tiled_shape);
-
-  const size_t ndim = base_shape.size();
-  std::vector<int64_t> base_x_window_shape(base_shape.begin(),
-                                           base_shape.end());
-  base_x_window_shape.insert(base_x_window_shape.end(), window_shape.begin(),
-                             window_shape.end());
-  auto output =
-      hal::zeros(ctx, source.vtype(), source.dtype(), base_x_window_shape);
-
-  const std::vector<int64_t> window_dilations(window_shape.size(), 1);
-  const std::vector<int64_t> base_dilations(source.shape().size(), 1);
-  std::vector<int64_t> window_index(ndim, 0);
+  // FIXME(jint), handle int type promotion
+  selected = hal::dtype_cast(ctx, selected, source.dtype());
 
+  // Scatter each element of all windows at once, the adds are local.
+  auto zero = hal::zeros(ctx, selected.vtype(), selected.dtype());
+  std::vector<int64_t> window_index(window_shape.size(), 0);
+  spu::Value output;
+  int64_t k = 0;
   do {
-    yacl::parallel_for(
-        0, source.numel(), 2048, [&](int64_t begin, int64_t end) {
-          std::vector<int64_t> tiled_index(2 * ndim, 0);
-          std::vector<int64_t> base_x_window_index(2 * ndim, 0);
-          std::copy(window_index.begin(), window_index.end(),
-                    base_x_window_index.begin() + ndim);
-          std::copy(window_index.begin(), window_index.end(),
-                    tiled_index.begin() + ndim);
-          auto source_index = unflattenIndex(begin, source.shape());
-          for (int64_t idx = begin; idx < end; ++idx) {
-            bool out_of_bound = getBaseIndexFromWindowIndex(
-                window_shape, window_strides, window_dilations, window_padding,
-                base_shape, base_dilations,
-                absl::MakeSpan(tiled_index).subspan(0, ndim), window_index,
-                absl::MakeSpan(base_x_window_index).subspan(0, ndim));
-            if (!out_of_bound) {
-              output.copyElementFrom(selected, tiled_index,
-                                     base_x_window_index);
-            }
-            bumpIndices<int64_t>(source.shape(),
-                                 absl::MakeSpan(tiled_index).subspan(0, ndim));
-          }
-        });
+    auto scattered = ScatterWindowElement(
+        ctx, WindowElement(ctx, selected, k), zero, window_index, base_shape,
+        window_strides, window_padding);
+    output = k == 0 ? scattered : hal::add(ctx, output, scattered);
+    k++;
   } while (bumpIndices<int64_t>(window_shape, absl::MakeSpan(window_index)));
 
-  std::vector<int64_t> base_1d_shape(base_shape.begin(), base_shape.end());
-  base_1d_shape.push_back(window_numel);
-  output = hal::reshape(ctx, output, base_1d_shape);
-
-  output = TreeReduce(
-      ctx, {output}, base_1d_shape.size() - 1,
-      [&](absl::Span<const spu::Value> lhs, absl::Span<const spu::Value> rhs) {
-        return std::vector<spu::Value>{hal::add(ctx, lhs[0], rhs[0])};
-      })[0];
-
-  return hal::reshape(ctx, output, base_shape);
+  return output;
 }
 
 spu::Value SelectAndScatterExpanded(
@@ -181,18 +129,14 @@ spu::Value SelectAndScatterExpanded(
   const size_t ndim = base.shape().size();
 
   // expand the base, simplify following actions without strides and padding.
-  auto expanded = ExpandStridedWindow(ctx, base, window_shape, window_strides,
-                                      window_padding);
+  auto tiled = ExpandTiledWindow(ctx, base, window_shape, window_strides,
+                                 window_padding);
 
   // sanity check, make (source x window == expanded)
   for (size_t dim = 0; dim < ndim; dim++) {
-    YACL_ENFORCE(expanded.shape()[dim] % window_shape[dim] == 0);
-    YACL_ENFORCE(expanded.shape()[dim] / window_shape[dim] ==
-                 source.shape()[dim]);
+    YACL_ENFORCE(tiled.shape()[dim] == source.shape()[dim]);
   }
 
-  auto tiled = ConvertToTiledLayout(ctx, expanded, window_shape);
-
   // collapse the tile to 1d for better reduce performance
   std::vector<int64_t> tiled_1d_shape = source.shape();
   const int64_t window_numel = std::accumulate(
@@ -232,46 +176,27 @@ spu::Value SelectAndScatterExpanded(
       hal::broadcast_to(ctx, source, tiled_1d_shape, broadcast_dims),
       hal::broadcast_to(ctx, init_val, tiled_1d_shape));
 
-  // last step, collapse expanded shape to strided window
-  // build a tensor with [base.shape() x window_shape], so each
+  // last step, scatter each element of all windows back to the base, so each
   // [base.shape(), window_index] does not overlap with each other.
-  selected = hal::reshape(ctx, selected, tiled.shape());
-
-  std::vector<int64_t> base_x_window_shape = base.shape();
-  base_x_window_shape.insert(base_x_window_shape.end(), window_shape.begin(),
-                             window_shape.end());
-  auto output = hal::expand(ctx, init_val, base_x_window_shape);
+  auto padding_value = init_val;
+  if (padding_value.isPublic() && selected.isSecret()) {
+    padding_value = hal::_p2s(ctx, padding_value).setDtype(init_val.dtype());
+  }
 
-  const std::vector<int64_t> window_dilations(window_shape.size(), 1);
-  const std::vector<int64_t> base_dilations(source.shape().size(), 1);
+  std::vector<int64_t> base_1d_shape = base.shape();
+  base_1d_shape.push_back(1);
+  std::vector<spu::Value> scattered;
   std::vector<int64_t> window_index(ndim, 0);
-  std::vector<int64_t> tiled_index(2 * ndim, 0);
-  std::vector<int64_t> base_x_window_index(2 * ndim, 0);
-  std::vector<int64_t> base_index(ndim, 0);
+  int64_t k = 0;
   do {
-    std::copy(window_index.begin(), window_index.end(),
-              base_x_window_index.begin() + ndim);
-    std::fill(tiled_index.begin(), tiled_index.begin() + ndim, 0);
-    std::copy(window_index.begin(), window_index.end(),
-              tiled_index.begin() + ndim);
-
-    do {
-      bool out_of_bound = getBaseIndexFromWindowIndex(
-          window_shape, window_strides, window_dilations, window_padding,
-          base.shape(), base_dilations,
-          absl::MakeSpan(tiled_index).subspan(0, ndim), window_index,
-          absl::MakeSpan(base_x_window_index).subspan(0, ndim));
-      if (!out_of_bound) {
-        output.copyElementFrom(selected, tiled_index, base_x_window_index);
-      }
-
-    } while (bumpIndices<int64_t>(
-        source.shape(), absl::MakeSpan(tiled_index).subspan(0, ndim)));
+    auto element = ScatterWindowElement(
+        ctx, WindowElement(ctx, selected, k++), padding_value, window_index,
+        base.shape(), window_strides, window_padding);
+    scattered.push_back(hal::reshape(ctx, element, base_1d_shape));
   } while (bumpIndices<int64_t>(window_shape, absl::MakeSpan(window_index)));
 
-  std::vector<int64_t> base_1d_shape = base.shape();
-  base_1d_shape.push_back(window_numel);
-  output = hal::reshape(ctx, output, base_1d_shape);
+  auto output = hal::concatenate(ctx, scattered, ndim);
+  base_1d_shape.back() = window_numel;
 
   output = TreeReduce(
       ctx, {output}, base_1d_shape.size() - 1,
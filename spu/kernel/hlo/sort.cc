@@ -14,11 +14,17 @@
 
 #include "sort.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "absl/numeric/bits.h"
-#include "emp-tool/circuits/number.h"
 
+#include "spu/kernel/hal/concat.h"
+#include "spu/kernel/hal/constants.h"
 #include "spu/kernel/hal/permute_util.h"
 #include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/shuffle.h"
 #include "spu/kernel/hlo/casting.h"
 #include "spu/kernel/hlo/utils.h"
 
@@ -55,165 +61,304 @@ std::vector<spu::Value> getValuesToSort(HalContext *ctx,
   return values_to_sort;
 }
 
-// Refers to implementation of emp-tool:
-// https://github.com/emp-toolkit/emp-tool/blob/b07a7d9ab3053a3e16991751402742d418377f63/emp-tool/circuits/number.h
-void cmpSwap(HalContext *ctx, const CompFn &comparator_body,
-             std::vector<spu::Value> *values_to_sort, int64_t x_start_indices,
-             int64_t y_start_indices, int64_t n, bool acc) {
-  size_t num_operands = values_to_sort->size();
+// A compare-exchange, after which `lhs` holds the one ordered first by the
+// comparator.
+struct CompareExchange {
+  size_t lhs;
+  size_t rhs;
+};
 
-  std::vector<spu::Value> values;
-  values.reserve(2 * num_operands);
-  for (size_t i = 0; i < num_operands; ++i) {
-    values.push_back(hal::slice(ctx, values_to_sort->at(i), {x_start_indices},
-                                {x_start_indices + n}, {1}));
-    values.push_back(hal::slice(ctx, values_to_sort->at(i), {y_start_indices},
-                                {y_start_indices + n}, {1}));
-  }
-  spu::Value predicate = comparator_body(values);
-
-  for (size_t i = 0; i < num_operands; ++i) {
-    auto fst = hal::slice(ctx, values_to_sort->at(i), {x_start_indices},
-                          {x_start_indices + n}, {1});
-    auto snd = hal::slice(ctx, values_to_sort->at(i), {y_start_indices},
-                          {y_start_indices + n}, {1});
-
-    auto greater = spu::kernel::hal::select(ctx, predicate, fst, snd);
-    auto less = spu::kernel::hal::select(ctx, predicate, snd, fst);
-
-    if (acc) {
-      values_to_sort->at(i).copyElementFrom(
-          greater, {}, {static_cast<int64_t>(x_start_indices)},
-          static_cast<int64_t>(n * values_to_sort->front().elsize()));
-      values_to_sort->at(i).copyElementFrom(
-          less, {}, {static_cast<int64_t>(y_start_indices)},
-          static_cast<int64_t>(n * values_to_sort->front().elsize()));
-    } else {
-      values_to_sort->at(i).copyElementFrom(
-          less, {}, {static_cast<int64_t>(x_start_indices)},
-          static_cast<int64_t>(n * values_to_sort->front().elsize()));
-      values_to_sort->at(i).copyElementFrom(
-          greater, {}, {static_cast<int64_t>(y_start_indices)},
-          static_cast<int64_t>(n * values_to_sort->front().elsize()));
+// Comparators of the bitonic sorting network of arbitrary n.
+void genBitonicMerge(std::vector<CompareExchange> *network, size_t lo,
+                     size_t n, bool acc) {
+  if (n > 1) {
+    size_t m = absl::bit_floor(n - 1);
+    for (size_t idx = lo; idx < lo + n - m; idx++) {
+      if (acc) {
+        network->push_back({idx, idx + m});
+      } else {
+        network->push_back({idx + m, idx});
+      }
     }
+    genBitonicMerge(network, lo, m, acc);
+    genBitonicMerge(network, lo + m, n - m, acc);
   }
 }
 
-void sequentialBitonicMerge(HalContext *ctx, const CompFn &comparator_body,
-                            std::vector<spu::Value> *values_to_sort, size_t lo,
-                            size_t n, bool acc) {
+void genBitonicSort(std::vector<CompareExchange> *network, size_t lo,
+                    size_t n, bool acc) {
   if (n > 1) {
-    size_t m = emp::greatestPowerOfTwoLessThan(n);
-    cmpSwap(ctx, comparator_body, values_to_sort, lo, lo + m, n - m, acc);
-
-    sequentialBitonicMerge(ctx, comparator_body, values_to_sort, lo, m, acc);
-    sequentialBitonicMerge(ctx, comparator_body, values_to_sort, lo + m, n - m,
-                           acc);
+    size_t m = (n >> 1);
+    genBitonicSort(network, lo, m, !acc);
+    genBitonicSort(network, lo + m, n - m, acc);
+    genBitonicMerge(network, lo, n, acc);
   }
 }
 
-void sequentialBitonicSort(HalContext *ctx, const CompFn &comparator_body,
-                           std::vector<spu::Value> *values_to_sort, size_t lo,
-                           size_t n, bool acc) {
-  if (n > 1) {
-    size_t m = (n >> 1);
-    sequentialBitonicSort(ctx, comparator_body, values_to_sort, lo, m, !acc);
-    sequentialBitonicSort(ctx, comparator_body, values_to_sort, lo + m, n - m,
-                          acc);
-    sequentialBitonicMerge(ctx, comparator_body, values_to_sort, lo, n, acc);
+// Comparators of Batcher's odd-even merge sorting network, the network of the
+// next power of two is truncated, which is fine since all comparators are
+// ascending, elements out of range act as maximums and never move.
+void genOddEvenMergeSort(std::vector<CompareExchange> *network, size_t n) {
+  const size_t padded = absl::bit_ceil(n);
+  for (size_t p = 1; p < padded; p <<= 1) {
+    for (size_t k = p; k >= 1; k >>= 1) {
+      for (size_t j = k % p; j + k < padded; j += 2 * k) {
+        for (size_t i = 0; i < k; i++) {
+          const size_t lhs = i + j;
+          const size_t rhs = i + j + k;
+          if (rhs < n && lhs / (2 * p) == rhs / (2 * p)) {
+            network->push_back({lhs, rhs});
+          }
+        }
+      }
+    }
   }
 }
 
-void generateBitonicSortIndex(size_t n,
-                              std::vector<std::vector<size_t>> *indices) {
-  YACL_ENFORCE(absl::has_single_bit(n));
-  size_t stage = absl::bit_width(n) - 1;
+// Group comparators into layers, comparators of a layer touch disjoint
+// elements, so they run together. Each comparator goes to the earliest layer
+// after all previous comparators of its elements.
+std::vector<std::vector<CompareExchange>> buildLayers(
+    size_t n, absl::Span<const CompareExchange> network) {
+  std::vector<std::vector<CompareExchange>> layers;
+  std::vector<size_t> depth(n, 0);
+  for (const auto &ce : network) {
+    const size_t layer = std::max(depth[ce.lhs], depth[ce.rhs]);
+    if (layer == layers.size()) {
+      layers.emplace_back();
+    }
+    layers[layer].push_back(ce);
+    depth[ce.lhs] = depth[ce.rhs] = layer + 1;
+  }
+  return layers;
+}
 
-  for (int i = static_cast<int>(stage); i > 0; i--) {
-    std::vector<size_t> fst;
-    std::vector<size_t> sec;
+// Comparators selecting the top k of n elements, ordered first by the
+// comparator, and the positions they end up at.
+//
+// Elements are split into blocks of K = bit_ceil(k), each block is sorted by a
+// bitonic network, then pairs of blocks are merged until one is left. To merge
+// sorted blocks A and B, B is compared reversely against A, which keeps the
+// top K of both in A as a bitonic sequence, then a bitonic merge of A sorts
+// it. This takes O(n*log^2(k)) comparators with a depth of
+// O(log^2(k) + log(n/k)*log(k)), instead of O(n*log^2(n)) of a full sort.
+std::vector<size_t> genTopK(std::vector<CompareExchange> *network, size_t n,
+                            size_t k) {
+  const size_t block_size = absl::bit_ceil(std::max<size_t>(k, 1));
+
+  std::vector<std::vector<size_t>> blocks;
+  for (size_t lo = 0; lo < n; lo += block_size) {
+    const size_t size = std::min(block_size, n - lo);
+    genBitonicSort(network, lo, size, true);
+    blocks.emplace_back(size);
+    std::iota(blocks.back().begin(), blocks.back().end(), lo);
+  }
 
-    for (size_t j = 0; j < n; j++) {
-      if (((j >> (i - 1)) & 1) == 0) {
-        fst.emplace_back(j);
-      } else {
-        sec.emplace_back(j);
+  // only the last block could be partial, so `lhs` is always a full one.
+  std::vector<CompareExchange> merge;
+  genBitonicMerge(&merge, 0, block_size, true);
+  while (blocks.size() > 1) {
+    std::vector<std::vector<size_t>> merged;
+    for (size_t idx = 0; idx + 1 < blocks.size(); idx += 2) {
+      const auto &lhs = blocks[idx];
+      const auto &rhs = blocks[idx + 1];
+      for (size_t i = block_size - rhs.size(); i < block_size; i++) {
+        network->push_back({lhs[i], rhs[block_size - 1 - i]});
+      }
+      for (const auto &ce : merge) {
+        network->push_back({lhs[ce.lhs], lhs[ce.rhs]});
       }
+      merged.push_back(lhs);
     }
-
-    fst.insert(fst.end(), sec.begin(), sec.end());
-    indices->emplace_back(fst);
+    if (blocks.size() % 2 == 1) {
+      merged.push_back(blocks.back());
+    }
+    blocks = std::move(merged);
   }
+
+  auto &top = blocks[0];
+  top.resize(std::min(k, top.size()));
+  return top;
 }
 
-void generateBitonicMergeIndex(size_t n,
-                               std::vector<std::vector<size_t>> *indices) {
-  YACL_ENFORCE(absl::has_single_bit(n));
-  size_t stage = absl::bit_width(n) - 1;
-
-  for (int stage_idx = 0; stage_idx < static_cast<int>(stage - 1);
-       stage_idx++) {
-    for (int substage_idx = static_cast<int>(stage_idx); substage_idx > -1;
-         substage_idx--) {
-      std::vector<size_t> fst;
-      std::vector<size_t> sec;
-      for (size_t i = 0; i < n; i++) {
-        bool asc_flag = ((i >> (stage_idx + 1)) & 1) == 0;
-        bool fst_flag = ((i >> substage_idx) & 1) == 0;
-
-        if (asc_flag ^ fst_flag) {
-          sec.emplace_back(i);
-        } else {
-          fst.emplace_back(i);
+// Apply the layers of a network to `num_rows` rows of `n` elements, the i-th
+// row of operands lies in [i*n, (i+1)*n) of the flatten values.
+//
+// All compare-exchanges of a layer across all rows are packed into one
+// comparator call and one select per operand, so the number of rounds only
+// depends on the depth of the network.
+std::vector<spu::Value> applyNetwork(
+    HalContext *ctx, const CompFn &comparator_body,
+    std::vector<spu::Value> values, size_t num_rows, size_t n,
+    absl::Span<const std::vector<CompareExchange>> layers) {
+  const size_t total = num_rows * n;
+  std::vector<size_t> gather(total);
+  std::vector<size_t> scatter(total);
+  std::vector<bool> touched(n);
+  for (const auto &layer : layers) {
+    const auto num_pairs = static_cast<int64_t>(num_rows * layer.size());
+
+    // gather as [lhs of all rows, rhs of all rows, untouched].
+    std::fill(touched.begin(), touched.end(), false);
+    size_t pos = 0;
+    for (size_t row = 0; row < num_rows; row++) {
+      for (const auto &ce : layer) {
+        gather[pos++] = row * n + ce.lhs;
+      }
+    }
+    for (size_t row = 0; row < num_rows; row++) {
+      for (const auto &ce : layer) {
+        gather[pos++] = row * n + ce.rhs;
+      }
+    }
+    for (const auto &ce : layer) {
+      touched[ce.lhs] = touched[ce.rhs] = true;
+    }
+    for (size_t row = 0; row < num_rows; row++) {
+      for (size_t idx = 0; idx < n; idx++) {
+        if (!touched[idx]) {
+          gather[pos++] = row * n + idx;
         }
       }
+    }
+    for (size_t idx = 0; idx < total; idx++) {
+      scatter[gather[idx]] = idx;
+    }
 
-      fst.insert(fst.end(), sec.begin(), sec.end());
-      indices->emplace_back(fst);
+    std::vector<spu::Value> lhs;
+    std::vector<spu::Value> rhs;
+    std::vector<spu::Value> rest;
+    std::vector<spu::Value> cmp_inputs;
+    for (const auto &v : values) {
+      auto g = hal::permute(ctx, v, 0, xt::adapt(gather));
+      lhs.push_back(hal::slice(ctx, g, {0}, {num_pairs}, {1}));
+      rhs.push_back(hal::slice(ctx, g, {num_pairs}, {2 * num_pairs}, {1}));
+      if (2 * num_pairs < static_cast<int64_t>(total)) {
+        rest.push_back(hal::slice(ctx, g, {2 * num_pairs},
+                                  {static_cast<int64_t>(total)}, {1}));
+      }
+      cmp_inputs.push_back(lhs.back());
+      cmp_inputs.push_back(rhs.back());
     }
-  }
-}
 
-std::vector<spu::Value> parallelBitonicSort(
-    HalContext *ctx, const CompFn &comparator_body,
-    const std::vector<spu::Value> &values_to_sort, size_t n) {
-  YACL_ENFORCE(absl::has_single_bit(n));
+    auto predicate = comparator_body(cmp_inputs);
+    predicate = hal::concatenate(ctx, {predicate, predicate}, 0);
 
-  std::vector<std::vector<size_t>> indices;
-  generateBitonicMergeIndex(n, &indices);
-  generateBitonicSortIndex(n, &indices);
+    for (size_t i = 0; i < values.size(); ++i) {
+      // [first, second] in one select.
+      auto exchanged = hal::select(
+          ctx, predicate, hal::concatenate(ctx, {lhs[i], rhs[i]}, 0),
+          hal::concatenate(ctx, {rhs[i], lhs[i]}, 0));
+      if (!rest.empty()) {
+        exchanged = hal::concatenate(ctx, {exchanged, rest[i]}, 0);
+      }
+      values[i] = hal::permute(ctx, exchanged, 0, xt::adapt(scatter));
+    }
+  }
 
-  std::vector<spu::Value> target = values_to_sort;
+  return values;
+}
 
-  for (const auto &index : indices) {
-    // permute
-    std::vector<spu::Value> permuted_values;
+// Sort rows by a sorting network, i.e. O(log^2(n)) rounds.
+std::vector<spu::Value> sortRowsByNetwork(
+    HalContext *ctx, const CompFn &comparator_body,
+    std::vector<spu::Value> values, size_t num_rows, size_t n,
+    RuntimeConfig::SortNetwork kind) {
+  std::vector<CompareExchange> network;
+  if (kind == RuntimeConfig::SORT_ODD_EVEN_MERGE) {
+    genOddEvenMergeSort(&network, n);
+  } else {
+    genBitonicSort(&network, 0, n, true);
+  }
+  return applyNetwork(ctx, comparator_body, std::move(values), num_rows, n,
+                      buildLayers(n, network));
+}
 
-    for (auto v : target) {
-      permuted_values.emplace_back(hal::permute(ctx, v, 0, xt::adapt(index)));
+// Rows along `sort_dim` of the inputs, moved to the last dimension and
+// flattened, so all rows are sorted together.
+struct FlattenedRows {
+  std::vector<spu::Value> values;
+  int64_t num_rows = 0;
+  int64_t n = 0;
+  std::vector<int64_t> transposed_shape;
+  std::vector<int64_t> inverse_perm;
+};
+
+FlattenedRows flattenRows(HalContext *ctx, absl::Span<const spu::Value> inputs,
+                          int64_t sort_dim) {
+  FlattenedRows rows;
+  const int64_t numel = inputs[0].numel();
+  rows.n = inputs[0].shape()[sort_dim];
+  rows.num_rows = numel / rows.n;
+
+  const auto rank = static_cast<int64_t>(inputs[0].shape().size());
+  std::vector<int64_t> perm;
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (dim != sort_dim) {
+      perm.push_back(dim);
     }
+  }
+  perm.push_back(sort_dim);
+  rows.inverse_perm.resize(rank);
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    rows.inverse_perm[perm[dim]] = dim;
+  }
+
+  for (const auto &input : inputs) {
+    auto transposed = hal::transpose(ctx, input, perm);
+    rows.transposed_shape = transposed.shape();
+    rows.values.push_back(hal::reshape(ctx, transposed, {numel}));
+  }
+  return rows;
+}
 
-    // cmp and swap
-    cmpSwap(ctx, comparator_body, &permuted_values, 0,
-            static_cast<int64_t>(n / 2), static_cast<int64_t>(n / 2), true);
+std::vector<spu::Value> restoreRows(HalContext *ctx, const FlattenedRows &rows,
+                                    absl::Span<const spu::Value> values) {
+  std::vector<spu::Value> results;
+  for (const auto &value : values) {
+    results.push_back(hal::transpose(
+        ctx, hal::reshape(ctx, value, rows.transposed_shape),
+        rows.inverse_perm));
+  }
+  return results;
+}
 
-    // inverse permute
-    std::vector<size_t> inverse_permutation(index.size());
-    std::iota(inverse_permutation.begin(), inverse_permutation.end(), 0);
-    std::sort(inverse_permutation.begin(), inverse_permutation.end(),
-              [&index](int left, int right) -> bool {
-                return index[left] < index[right];
-              });
+// Sort along `sort_dim` by a secret comparator, with a sorting network.
+std::vector<spu::Value> sortByNetwork(HalContext *ctx,
+                                      absl::Span<const spu::Value> inputs,
+                                      int64_t sort_dim,
+                                      const CompFn &comparator_body) {
+  if (inputs[0].numel() == 0) {
+    return {inputs.begin(), inputs.end()};
+  }
 
-    target.clear();
+  auto rows = flattenRows(ctx, inputs, sort_dim);
+  auto kind = ctx->rt_config().sort_network();
+  if (kind == RuntimeConfig::SORT_RADIX) {
+    // radix sort could not take arbitrary comparators.
+    kind = RuntimeConfig::SORT_DEFAULT;
+  }
+  auto values = sortRowsByNetwork(ctx, comparator_body, std::move(rows.values),
+                                  rows.num_rows, rows.n, kind);
+  return restoreRows(ctx, rows, values);
+}
 
-    for (auto v : permuted_values) {
-      target.emplace_back(
-          hal::permute(ctx, v, 0, xt::adapt(inverse_permutation)));
-    }
+// Sort along `sort_dim` by the secret key inputs[0], with a radix sort over
+// secret shuffles. The permutation is generated once by the key, then all
+// inputs are permuted by it.
+std::vector<spu::Value> sortByRadix(HalContext *ctx,
+                                    absl::Span<const spu::Value> inputs,
+                                    int64_t sort_dim, bool descending) {
+  if (inputs[0].numel() == 0) {
+    return {inputs.begin(), inputs.end()};
   }
 
-  return target;
+  auto rows = flattenRows(ctx, inputs, sort_dim);
+  auto perm = hal::gen_sort_perm(
+      ctx, hal::reshape(ctx, rows.values[0], {rows.num_rows, rows.n}),
+      descending);
+  auto values = hal::apply_perm(ctx, rows.values, perm);
+  return restoreRows(ctx, rows, values);
 }
 
 }  // namespace
@@ -226,88 +371,150 @@ std::vector<spu::Value> Sort(HalContext *ctx,
   int64_t num_operands = inputs.size();
   auto key_shape = inputs[0].shape();
   auto rank = key_shape.size();
-  std::vector<spu::Value> results;
-  results.reserve(num_operands);
-  for (int64_t i = 0; i < num_operands; ++i) {
-    results.emplace_back(
-        NdArrayRef(inputs[i].data().eltype(), inputs[i].shape()),
-        inputs[i].dtype());
-  }
   std::vector<int64_t> zero_base(rank, 0);
   std::vector<int64_t> increment(rank, 1);
-  int64_t sort_dim_elements = key_shape[sort_dim];
   YACL_ENFORCE(
       sort_dim >= 0 && sort_dim < static_cast<int64_t>(increment.size()),
       "Unexpected out-of-bound sort dimension {}"
       " accessing increment of size {} ",
       sort_dim, increment.size());
+  int64_t sort_dim_elements = key_shape[sort_dim];
   increment[sort_dim] = sort_dim_elements;
 
-  if (comparator_ret_vis == VIS_PUBLIC) {
-    // Iterate through each dimension except 'sort_dim'.
-    forEachIndex(key_shape, zero_base, key_shape, increment,
-                 [&](const std::vector<int64_t> &indices) {
-                   // Extract a slice from each operand literal that corresponds
-                   // to exactly the row in dimension 'sort_dim'.
-                   std::vector<spu::Value> values_to_sort =
-                       getValuesToSort(ctx, inputs, indices, sort_dim,
-                                       sort_dim_elements, num_operands);
-
-                   std::vector<int64_t> indices_to_sort(sort_dim_elements);
-                   std::iota(indices_to_sort.begin(), indices_to_sort.end(), 0);
-                   auto comparator = [&comparator_body, &num_operands, &ctx,
-                                      &values_to_sort](int64_t a, int64_t b) {
-                     std::vector<spu::Value> values;
-                     values.reserve(2 * num_operands);
-                     for (int64_t i = 0; i < num_operands; ++i) {
-                       values.push_back(values_to_sort[i].getElementAt(a));
-                       values.push_back(values_to_sort[i].getElementAt(b));
-                     }
-                     spu::Value ret = comparator_body(values);
-                     return getConditionValue(ctx, ret);
-                   };
-
-                   if (is_stable) {
-                     std::stable_sort(indices_to_sort.begin(),
-                                      indices_to_sort.end(), comparator);
-                   } else {
-                     std::sort(indices_to_sort.begin(), indices_to_sort.end(),
-                               comparator);
-                   }
+  if (comparator_ret_vis != VIS_PUBLIC) {
+    return sortByNetwork(ctx, inputs, sort_dim, comparator_body);
+  }
+
+  std::vector<spu::Value> results;
+  results.reserve(num_operands);
+  for (int64_t i = 0; i < num_operands; ++i) {
+    results.emplace_back(
+        NdArrayRef(inputs[i].data().eltype(), inputs[i].shape()),
+        inputs[i].dtype());
+  }
 
-                   std::vector<int64_t> start_indices(rank, 0);
+  // Iterate through each dimension except 'sort_dim'.
+  forEachIndex(key_shape, zero_base, key_shape, increment,
+               [&](const std::vector<int64_t> &indices) {
+                 // Extract a slice from each operand literal that corresponds
+                 // to exactly the row in dimension 'sort_dim'.
+                 std::vector<spu::Value> values_to_sort =
+                     getValuesToSort(ctx, inputs, indices, sort_dim,
+                                     sort_dim_elements, num_operands);
+
+                 std::vector<int64_t> indices_to_sort(sort_dim_elements);
+                 std::iota(indices_to_sort.begin(), indices_to_sort.end(), 0);
+                 auto comparator = [&comparator_body, &num_operands, &ctx,
+                                    &values_to_sort](int64_t a, int64_t b) {
+                   std::vector<spu::Value> values;
+                   values.reserve(2 * num_operands);
                    for (int64_t i = 0; i < num_operands; ++i) {
-                     auto sorted_value = hal::permute(
-                         ctx, values_to_sort[i], 0, xt::adapt(indices_to_sort));
-                     sliceCopy(results[i], sorted_value, indices, sort_dim);
+                     values.push_back(values_to_sort[i].getElementAt(a));
+                     values.push_back(values_to_sort[i].getElementAt(b));
                    }
-                 });
-  } else {
-    // Iterate through each dimension except 'sort_dim'.
-    forEachIndex(
-        key_shape, zero_base, key_shape, increment,
-        [&](const std::vector<int64_t> &indices) {
-          std::vector<spu::Value> values_to_sort = getValuesToSort(
-              ctx, inputs, indices, sort_dim, sort_dim_elements, num_operands);
-
-          int64_t n = values_to_sort[0].numel();
-          if (absl::has_single_bit(static_cast<size_t>(n))) {
-            // TODO(junfeng): add paddings when n x is not an integral power of
-            // two.
-            values_to_sort =
-                parallelBitonicSort(ctx, comparator_body, values_to_sort, n);
-          } else {
-            sequentialBitonicSort(ctx, comparator_body, &values_to_sort, 0, n,
-                                  true);
-          }
+                   spu::Value ret = comparator_body(values);
+                   return getConditionValue(ctx, ret);
+                 };
+
+                 if (is_stable) {
+                   std::stable_sort(indices_to_sort.begin(),
+                                    indices_to_sort.end(), comparator);
+                 } else {
+                   std::sort(indices_to_sort.begin(), indices_to_sort.end(),
+                             comparator);
+                 }
+
+                 std::vector<int64_t> start_indices(rank, 0);
+                 for (int64_t i = 0; i < num_operands; ++i) {
+                   auto sorted_value = hal::permute(
+                       ctx, values_to_sort[i], 0, xt::adapt(indices_to_sort));
+                   sliceCopy(results[i], sorted_value, indices, sort_dim);
+                 }
+               });
 
-          for (int64_t i = 0; i < num_operands; ++i) {
-            sliceCopy(results[i], values_to_sort[i], indices, sort_dim);
-          }
-        });
+  return results;
+}
+
+std::vector<spu::Value> SimpleSort(HalContext *ctx,
+                                   absl::Span<const spu::Value> inputs,
+                                   int64_t sort_dim, SortDirection direction) {
+  const auto &key = inputs[0];
+  const bool descending = direction == SortDirection::Descending;
+  if (ctx->rt_config().sort_network() == RuntimeConfig::SORT_RADIX &&
+      key.isSecret() && hal::has_secret_shuffle(ctx)) {
+    return sortByRadix(ctx, inputs, sort_dim, descending);
   }
 
-  return results;
+  return Sort(
+      ctx, inputs, sort_dim, /* is_stable */ true,
+      [&](absl::Span<const spu::Value> values) {
+        return descending ? hal::greater(ctx, values[0], values[1])
+                          : hal::less(ctx, values[0], values[1]);
+      },
+      key.isSecret() ? VIS_SECRET : VIS_PUBLIC);
+}
+
+std::pair<spu::Value, spu::Value> TopK(HalContext *ctx,
+                                       const spu::Value &input, int64_t k) {
+  const auto &shape = input.shape();
+  YACL_ENFORCE(!shape.empty(), "top_k expects at least 1-D input");
+  const int64_t n = shape.back();
+  YACL_ENFORCE(k >= 0 && k <= n, "invalid k={}, n={}", k, n);
+
+  std::vector<int64_t> ret_shape = shape;
+  ret_shape.back() = k;
+  const int64_t numel = input.numel();
+
+  std::vector<int32_t> iota(numel);
+  for (int64_t idx = 0; idx < numel; idx++) {
+    iota[idx] = static_cast<int32_t>(idx % n);
+  }
+  auto indices = hal::constant(ctx, iota, shape);
+
+  if (numel == 0) {
+    std::vector<int64_t> limit = shape;
+    limit.back() = k;
+    const std::vector<int64_t> start(shape.size(), 0);
+    return {hal::slice(ctx, input, start, limit, {}),
+            hal::slice(ctx, indices, start, limit, {})};
+  }
+
+  const int64_t num_rows = numel / n;
+  std::vector<CompareExchange> network;
+  const auto top = genTopK(&network, n, k);
+  auto values = applyNetwork(
+      ctx,
+      [&](absl::Span<const spu::Value> operands) {
+        return hal::greater(ctx, operands[0], operands[1]);
+      },
+      {hal::reshape(ctx, input, {numel}), hal::reshape(ctx, indices, {numel})},
+      num_rows, n, buildLayers(n, network));
+
+  // move the top k of each row to the front, then drop the rest.
+  std::vector<size_t> gather;
+  gather.reserve(numel);
+  for (int64_t row = 0; row < num_rows; row++) {
+    for (size_t pos : top) {
+      gather.push_back(row * n + pos);
+    }
+  }
+  std::vector<bool> picked(numel, false);
+  for (size_t idx : gather) {
+    picked[idx] = true;
+  }
+  for (int64_t idx = 0; idx < numel; idx++) {
+    if (!picked[idx]) {
+      gather.push_back(idx);
+    }
+  }
+
+  std::vector<spu::Value> results;
+  for (const auto &v : values) {
+    auto g = hal::permute(ctx, v, 0, xt::adapt(gather));
+    results.push_back(hal::reshape(
+        ctx, hal::slice(ctx, g, {0}, {num_rows * k}, {1}), ret_shape));
+  }
+  return {results[0], results[1]};
 }
 
 }  // namespace spu::kernel::hlo
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <cstdint>
+#include <utility>
 
 #include "absl/types/span.h"
 
@@ -31,4 +32,24 @@ std::vector<spu::Value> Sort(HalContext *ctx,
                              const CompFn &comparator_body,
                              Visibility comparator_ret_vis);
 
+enum class SortDirection {
+  Ascending,
+  Descending,
+};
+
+// Sort by inputs[0] with a plain less (ascending) or greater (descending)
+// comparator, other inputs are permuted along. When configured, secret keys
+// are sorted by a radix sort over secret shuffles.
+std::vector<spu::Value> SimpleSort(HalContext *ctx,
+                                   absl::Span<const spu::Value> inputs,
+                                   int64_t sort_dim, SortDirection direction);
+
+// Return the k largest elements along the last dimension, largest first, and
+// their indices as int32. The order of tied elements is unspecified.
+//
+// Unlike Sort followed by a slice, only a partial bitonic selection network is
+// evaluated, see the implementation for the cost.
+std::pair<spu::Value, spu::Value> TopK(HalContext *ctx,
+                                       const spu::Value &input, int64_t k);
+
 }  // namespace spu::kernel::hlo
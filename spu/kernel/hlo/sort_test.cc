@@ -0,0 +1,144 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/kernel/hlo/sort.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xmanipulation.hpp"
+#include "xtensor/xsort.hpp"
+
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/test_util.h"
+
+namespace spu::kernel::hlo {
+
+class SortTest : public ::testing::TestWithParam<
+                     std::tuple<RuntimeConfig::SortNetwork, size_t>> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    SortTestInstances, SortTest,
+    testing::Combine(testing::Values(RuntimeConfig::SORT_BITONIC,
+                                     RuntimeConfig::SORT_ODD_EVEN_MERGE,
+                                     RuntimeConfig::SORT_RADIX),
+                     testing::Values(1, 7, 16, 33)),
+    [](const testing::TestParamInfo<SortTest::ParamType> &p) {
+      return fmt::format("{}x{}",
+                         RuntimeConfig::SortNetwork_Name(std::get<0>(p.param)),
+                         std::get<1>(p.param));
+    });
+
+TEST_P(SortTest, SecretComparator) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_sort_network(std::get<0>(GetParam()));
+  HalContext ctx = hal::test::makeRefHalContext(config);
+
+  const size_t n = std::get<1>(GetParam());
+  xt::xarray<int64_t> keys = hal::test::xt_random<int64_t>({3, n});
+  // the payload follows its key.
+  xt::xarray<int64_t> payload = keys * 2 + 1;
+
+  CompFn comparator = [&](absl::Span<const spu::Value> values) {
+    return hal::less(&ctx, values[0], values[1]);
+  };
+
+  for (int64_t sort_dim = 0; sort_dim < 2; sort_dim++) {
+    auto k = hal::make_value(&ctx, VIS_SECRET, keys);
+    auto v = hal::make_value(&ctx, VIS_SECRET, payload);
+    auto ret = Sort(&ctx, {k, v}, sort_dim, false, comparator, VIS_SECRET);
+    ASSERT_EQ(ret.size(), 2);
+
+    const xt::xarray<int64_t> expected = xt::sort(keys, sort_dim);
+    auto sorted_keys = hal::test::dump_public_as<int64_t>(
+        &ctx, hal::_s2p(&ctx, ret[0]).setDtype(ret[0].dtype()));
+    auto sorted_payload = hal::test::dump_public_as<int64_t>(
+        &ctx, hal::_s2p(&ctx, ret[1]).setDtype(ret[1].dtype()));
+    EXPECT_EQ(sorted_keys, expected) << sort_dim;
+    EXPECT_EQ(sorted_payload, expected * 2 + 1) << sort_dim;
+  }
+}
+
+TEST_P(SortTest, SimpleSort) {
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::REF2K);
+  config.set_field(FieldType::FM64);
+  config.set_sort_network(std::get<0>(GetParam()));
+  HalContext ctx = hal::test::makeRefHalContext(config);
+
+  const size_t n = std::get<1>(GetParam());
+  xt::xarray<int64_t> keys = hal::test::xt_random<int64_t>({3, n});
+  xt::xarray<int64_t> payload = keys * 2 + 1;
+
+  for (auto direction : {SortDirection::Ascending, SortDirection::Descending}) {
+    for (int64_t sort_dim = 0; sort_dim < 2; sort_dim++) {
+      auto k = hal::make_value(&ctx, VIS_SECRET, keys);
+      auto v = hal::make_value(&ctx, VIS_PUBLIC, payload);
+      auto ret = SimpleSort(&ctx, {k, v}, sort_dim, direction);
+      ASSERT_EQ(ret.size(), 2);
+
+      xt::xarray<int64_t> expected = xt::sort(keys, sort_dim);
+      if (direction == SortDirection::Descending) {
+        expected = xt::flip(expected, sort_dim);
+      }
+      auto sorted_keys = hal::test::dump_public_as<int64_t>(
+          &ctx, hal::_s2p(&ctx, ret[0]).setDtype(ret[0].dtype()));
+      auto sorted_payload = hal::test::dump_public_as<int64_t>(
+          &ctx, hal::_s2p(&ctx, ret[1]).setDtype(ret[1].dtype()));
+      EXPECT_EQ(sorted_keys, expected) << sort_dim;
+      EXPECT_EQ(sorted_payload, expected * 2 + 1) << sort_dim;
+    }
+  }
+}
+
+TEST_P(SortTest, TopK) {
+  HalContext ctx = hal::test::makeRefHalContext();
+
+  const auto n = static_cast<int64_t>(std::get<1>(GetParam()));
+  // distinct keys, since the order of ties is unspecified.
+  xt::xarray<int64_t> keys = xt::zeros<int64_t>({3L, n});
+  for (int64_t row = 0; row < 3; row++) {
+    for (int64_t col = 0; col < n; col++) {
+      keys(row, col) = (col * 37 + row) % n - n / 2;
+    }
+  }
+
+  for (int64_t k : {int64_t(1), n / 2, n}) {
+    auto [values, indices] =
+        TopK(&ctx, hal::make_value(&ctx, VIS_SECRET, keys), k);
+    ASSERT_EQ(values.shape(), (std::vector<int64_t>{3, k}));
+    ASSERT_EQ(indices.shape(), (std::vector<int64_t>{3, k}));
+    EXPECT_EQ(indices.dtype(), DT_I32);
+
+    // indices are public without any compare-exchange, i.e. n = 1.
+    auto dump = [&](const spu::Value &v) {
+      return hal::test::dump_public_as<int64_t>(
+          &ctx, v.isSecret() ? hal::_s2p(&ctx, v).setDtype(v.dtype()) : v);
+    };
+    auto got_values = dump(values);
+    auto got_indices = dump(indices);
+
+    const xt::xarray<int64_t> sorted = xt::flip(xt::sort(keys, 1), 1);
+    for (int64_t row = 0; row < 3; row++) {
+      for (int64_t idx = 0; idx < k; idx++) {
+        EXPECT_EQ(got_values(row, idx), sorted(row, idx)) << k;
+        EXPECT_EQ(keys(row, got_indices(row, idx)), got_values(row, idx)) << k;
+      }
+    }
+  }
+}
+
+}  // namespace spu::kernel::hlo
@@ -59,6 +59,13 @@ Value& Value::setDtype(DataType new_dtype, bool force) {
   return *this;
 }
 
+Value& Value::setPendingTruncBits(size_t bits) {
+  YACL_ENFORCE(bits == 0 || isFxp(), "only fxp could defer truncation, got {}",
+               dtype_);
+  pending_trunc_bits_ = bits;
+  return *this;
+}
+
 // #define SANITY_ELEWRITE
 
 void Value::copyElementFrom(const Value& v, absl::Span<const int64_t> input_idx,
@@ -96,26 +103,24 @@ Value Value::getElementAt(int64_t idx) const {
   return getElementAt(unflattenIndex(idx, shape()));
 }
 
-ValueProto Value::toProto() const {
-  ValueProto proto;
-  proto.set_data_type(dtype_);
-  proto.set_visibility(vtype());
-  proto.set_storage_type(data_.eltype().toString());
-  for (const auto& d : shape()) {
-    proto.mutable_shape()->add_dims(d);
-  }
-  if (data_.isCompact()) {
-    proto.set_content(data_.data(), numel() * data_.elsize());
-  } else {
-    // Make a compact clone
-    auto copy = data_.clone();
-    YACL_ENFORCE(copy.isCompact(), "Must be a compact copy.");
-    proto.set_content(copy.data(), copy.buf()->size());
+namespace {
+
+template <typename ProtoT>
+void fillMeta(const Value& value, ProtoT* proto) {
+  YACL_ENFORCE(value.pendingTruncBits() == 0,
+               "should truncate pending bits before serialization");
+
+  proto->set_data_type(value.dtype());
+  proto->set_visibility(value.vtype());
+  proto->set_storage_type(value.storage_type().toString());
+  for (const auto& d : value.shape()) {
+    proto->mutable_shape()->add_dims(d);
   }
-  return proto;
 }
 
-Value Value::fromProto(const ValueProto& proto) {
+// An uninitialized value of the meta.
+template <typename ProtoT>
+Value makeValue(const ProtoT& proto) {
   const auto eltype = Type::fromString(proto.storage_type());
 
   YACL_ENFORCE(proto.data_type() != DT_INVALID, "invalid data type={}",
@@ -129,15 +134,101 @@ Value Value::fromProto(const ValueProto& proto) {
   std::vector<int64_t> shape(proto.shape().dims().begin(),
                              proto.shape().dims().end());
 
-  NdArrayRef data(eltype, shape);
+  return Value(NdArrayRef(eltype, shape), proto.data_type());
+}
+
+// The data if it is compact, or a compact clone.
+NdArrayRef compactData(const NdArrayRef& data) {
+  if (data.isCompact()) {
+    return data;
+  }
+  auto copy = data.clone();
+  YACL_ENFORCE(copy.isCompact(), "Must be a compact copy.");
+  return copy;
+}
+
+}  // namespace
+
+ValueProto Value::toProto() const {
+  ValueProto proto;
+  fillMeta(*this, &proto);
+
+  const auto data = compactData(data_);
+  proto.set_content(data.data(), numel() * data.elsize());
+  return proto;
+}
+
+Value Value::fromProto(const ValueProto& proto) {
+  Value value = makeValue(proto);
+
+  NdArrayRef& data = value.data();
   YACL_ENFORCE(static_cast<size_t>(data.buf()->size()) ==
                proto.content().size());
   memcpy(data.data(), proto.content().c_str(), data.buf()->size());
 
-  return Value(data, proto.data_type());
+  return value;
+}
+
+ValueMetaProto Value::toMetaProto() const {
+  ValueMetaProto meta;
+  fillMeta(*this, &meta);
+  return meta;
+}
+
+std::pair<ValueMetaProto, std::vector<ValueChunkProto>> Value::toProto(
+    size_t max_chunk_size) const {
+  YACL_ENFORCE(max_chunk_size > 0);
+
+  ValueMetaProto meta = toMetaProto();
+
+  const auto data = compactData(data_);
+  const size_t total_bytes = numel() * data.elsize();
+  const auto* content = static_cast<const char*>(data.data());
+
+  std::vector<ValueChunkProto> chunks;
+  chunks.reserve((total_bytes + max_chunk_size - 1) / max_chunk_size);
+  for (size_t offset = 0; offset < total_bytes; offset += max_chunk_size) {
+    auto& chunk = chunks.emplace_back();
+    chunk.set_total_bytes(total_bytes);
+    chunk.set_chunk_offset(offset);
+    chunk.set_content(content + offset,
+                      std::min(max_chunk_size, total_bytes - offset));
+  }
+  return {std::move(meta), std::move(chunks)};
+}
+
+Value Value::fromProto(const ValueMetaProto& meta,
+                       absl::Span<ValueChunkProto const> chunks) {
+  Value value = makeValue(meta);
+
+  NdArrayRef& data = value.data();
+  const auto total_bytes = static_cast<size_t>(data.buf()->size());
+  auto* content = static_cast<char*>(data.data());
+
+  size_t offset = 0;
+  for (const auto& chunk : chunks) {
+    YACL_ENFORCE(chunk.total_bytes() == total_bytes,
+                 "chunk of {} bytes content, expect {}", chunk.total_bytes(),
+                 total_bytes);
+    YACL_ENFORCE(chunk.chunk_offset() == offset,
+                 "chunk offset {} is out of order, expect {}",
+                 chunk.chunk_offset(), offset);
+    YACL_ENFORCE(chunk.content().size() <= total_bytes - offset,
+                 "chunk at {} is out of range", offset);
+    memcpy(content + offset, chunk.content().data(), chunk.content().size());
+    offset += chunk.content().size();
+  }
+  YACL_ENFORCE(offset == total_bytes, "got {} bytes of content, expect {}",
+               offset, total_bytes);
+
+  return value;
 }
 
-Value Value::clone() const { return Value(data_.clone(), dtype()); }
+Value Value::clone() const {
+  Value ret(data_.clone(), dtype());
+  ret.pending_trunc_bits_ = pending_trunc_bits_;
+  return ret;
+}
 
 std::ostream& operator<<(std::ostream& out, const Value& v) {
   out << fmt::format("Value<{}x{}{},s={}>", fmt::join(v.shape(), "x"),
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/types/span.h"
 
@@ -27,6 +29,7 @@ namespace spu {
 class Value final {
   NdArrayRef data_;
   DataType dtype_ = DT_INVALID;
+  size_t pending_trunc_bits_ = 0;
 
  public:
   Value() = default;
@@ -62,12 +65,34 @@ class Value final {
   Value& setDtype(DataType new_dtype, bool force = false);
   Value& asFxp() { return setDtype(DT_FXP); }
 
+  // Get the number of fractional bits pending truncation.
+  //
+  // A fixed-point value with p pending bits encodes x as x * 2^(fxp_bits + p),
+  // products of fixed-points could defer the truncation, so sums of products
+  // are truncated only once. Only fxp add/sub/negate/mul/mmul accept such
+  // values, see hal::f_trunc_pending.
+  size_t pendingTruncBits() const { return pending_trunc_bits_; }
+  Value& setPendingTruncBits(size_t bits);
+
   // Serialize to protobuf.
   ValueProto toProto() const;
 
   // Deserialize from protobuf.
   static Value fromProto(const ValueProto& proto);
 
+  // The meta of toProto, without the content.
+  ValueMetaProto toMetaProto() const;
+
+  // Serialize to the meta and chunks of at most `max_chunk_size` bytes, for
+  // values over the 2GB limit of a protobuf message. Chunks are in the order
+  // of the content.
+  std::pair<ValueMetaProto, std::vector<ValueChunkProto>> toProto(
+      size_t max_chunk_size) const;
+
+  // Deserialize from the meta and all the chunks in order.
+  static Value fromProto(const ValueMetaProto& meta,
+                         absl::Span<ValueChunkProto const> chunks);
+
   /// Element-wise accessor, it's kind of anti-pattern.
   void copyElementFrom(const Value& v, absl::Span<const int64_t> input_idx,
                        absl::Span<const int64_t> output_idx,
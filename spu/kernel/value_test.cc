@@ -14,6 +14,8 @@
 
 #include "spu/kernel/value.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 namespace spu {
@@ -31,6 +33,36 @@ TEST(ValueTest, Empty) {
   EXPECT_FALSE(a.isInt());
 }
 
+TEST(ValueTest, ChunkedProto) {
+  NdArrayRef arr(makePtType(PT_I32), {3, 5});
+  for (int64_t idx = 0; idx < arr.numel(); ++idx) {
+    static_cast<int32_t*>(arr.data())[idx] = static_cast<int32_t>(idx * 7);
+  }
+  Value a(arr, DT_I32);
+
+  // 60 bytes in chunks of 16 bytes.
+  auto [meta, chunks] = a.toProto(16);
+  ASSERT_EQ(chunks.size(), 4U);
+  EXPECT_EQ(chunks.back().content().size(), 12U);
+
+  auto b = Value::fromProto(meta, chunks);
+  EXPECT_EQ(b.dtype(), DT_I32);
+  EXPECT_EQ(b.shape(), a.shape());
+  EXPECT_EQ(b.storage_type(), a.storage_type());
+  EXPECT_EQ(std::memcmp(b.data().data(), arr.data(), 60), 0);
+
+  // same content as the single proto.
+  EXPECT_EQ(b.toProto().content(), a.toProto().content());
+
+  // missing chunks.
+  chunks.pop_back();
+  EXPECT_THROW(Value::fromProto(meta, chunks), yacl::EnforceNotMet);
+
+  // chunks out of order.
+  std::swap(chunks[0], chunks[1]);
+  EXPECT_THROW(Value::fromProto(meta, chunks), yacl::EnforceNotMet);
+}
+
 // FIXME(jint)
 // TEST(ValueTest, Sanity) {
 //   // default constructor makes a placeholder value.
@@ -146,6 +146,31 @@ ArrayRef A2P::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
   });
 }
 
+ArrayRef RandA::proc(KernelEvalContext* ctx, FieldType field,
+                     size_t size) const {
+  SPU_TRACE_MPC_LEAF(ctx, size);
+
+  auto* prg_state = ctx->caller()->getState<PrgState>();
+
+  return DISPATCH_ALL_FIELDS(field, "_", [&]() {
+    using AShrT = ring2k_t;
+
+    // r1 is the r0 of the next party, i.e. the replicated shares of sum(r0),
+    // and r0 of each party is unknown to the next.
+    std::vector<AShrT> r0(size);
+    std::vector<AShrT> r1(size);
+    prg_state->fillPrssPair(absl::MakeSpan(r0), absl::MakeSpan(r1));
+
+    ArrayRef out(makeType<AShrTy>(field), size);
+    auto _out = ArrayView<std::array<AShrT, 2>>(out);
+    pforeach(0, static_cast<int64_t>(size), [&](int64_t idx) {
+      _out[idx][0] = r0[idx];
+      _out[idx][1] = r1[idx];
+    });
+    return out;
+  });
+}
+
 ArrayRef P2A::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
   SPU_TRACE_MPC_LEAF(ctx, in);
 
@@ -180,11 +205,11 @@ ArrayRef P2A::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
     for (int64_t idx = 0; idx < in.numel(); idx++) {
       r0[idx] = r0[idx] - r1[idx];
     }
-    r1 = comm->rotate<AShrT>(r0, "p2b.zero");
+    auto r0_next = comm->rotate<AShrT>(r0, "p2b.zero");
 
     for (int64_t idx = 0; idx < in.numel(); idx++) {
       _out[idx][0] += r0[idx];
-      _out[idx][1] += r1[idx];
+      _out[idx][1] += r0_next[idx];
     }
 #endif
 
@@ -342,14 +367,14 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                 (r0[idx] - r1[idx]);
     });
 
-    r1 = comm->rotate<U>(r0, "mulaa");  // comm => 1, k
+    auto r0_next = comm->rotate<U>(r0, "mulaa");  // comm => 1, k
 
     ArrayRef out(makeType<AShrTy>(field), lhs.numel());
     auto _out = ArrayView<std::array<U, 2>>(out);
 
     pforeach(0, lhs.numel(), [&](int64_t idx) {
       _out[idx][0] = r0[idx];
-      _out[idx][1] = r1[idx];
+      _out[idx][1] = r0_next[idx];
     });
 
     return out;
@@ -648,30 +673,22 @@ std::vector<T> openWith(Communicator* comm, size_t peer_rank,
   return out;
 }
 
-// PRECISE VERSION
-// Refer to:
-// 3.2.2 Truncation by a public value, P10,
-// Secure Evaluation of Quantized Neural Networks
-// - https://arxiv.org/pdf/1910.12435.pdf
-ArrayRef TruncPrAPrecise::proc(KernelEvalContext* ctx, const ArrayRef& in,
-                               size_t bits) const {
-  SPU_TRACE_MPC_LEAF(ctx, in, bits);
+namespace {
 
-  const auto field = in.eltype().as<AShrTy>()->field();
-  const auto numel = in.numel();
+// The precise truncation of x = x0 + x1 shared 2-out-of-2 by P0 and P1, the x
+// of P2 is not used. Returns 2-out-of-3 shares of x >> bits.
+ArrayRef truncPrecise2PC(KernelEvalContext* ctx, FieldType field,
+                         int64_t numel, const ArrayRef& x, size_t bits) {
   const size_t k = SizeOf(field) * 8;
 
   auto* prg_state = ctx->caller()->getState<PrgState>();
   auto* comm = ctx->caller()->getState<Communicator>();
 
-  // TODO: cost model is asymmetric, but test framework requires the same.
-  comm->addCommStatsManually(3, 4 * SizeOf(field) * numel);
-
-  ArrayRef out(in.eltype(), numel);
+  ArrayRef out(makeType<AShrTy>(field), numel);
   DISPATCH_ALL_FIELDS(field, "aby3.truncpr", [&]() {
     using U = ring2k_t;
 
-    auto _in = ArrayView<std::array<U, 2>>(in);
+    auto _x = ArrayView<U>(x);
     auto _out = ArrayView<std::array<U, 2>>(out);
 
     // 1. P0 & P1 samples r together.
@@ -683,17 +700,14 @@ ArrayRef TruncPrAPrecise::proc(KernelEvalContext* ctx, const ArrayRef& in,
 
         std::vector<U> x_plus_r(numel);
         pforeach(0, numel, [&](int64_t idx) {
-          // convert to 2-outof-2 share.
-          auto x = _in[idx][0] + _in[idx][1];
-
           // handle negative number.
           // assume secret x in [-2^(k-2), 2^(k-2)), by
           // adding 2^(k-2) x' = x + 2^(k-2) in [0,
           // 2^(k-1)), with msb(x') == 0
-          x += U(1) << (k - 2);
+          auto x0 = _x[idx] + (U(1) << (k - 2));
 
           // mask it with ra
-          x_plus_r[idx] = x + r[idx];
+          x_plus_r[idx] = x0 + r[idx];
         });
 
         // open c = <x> + <r>
@@ -748,8 +762,8 @@ ArrayRef TruncPrAPrecise::proc(KernelEvalContext* ctx, const ArrayRef& in,
 
         std::vector<U> x_plus_r(numel);
         pforeach(0, numel, [&](int64_t idx) {
-          // let t as 2-out-of-2 share, mask it with ra.
-          x_plus_r[idx] = _in[idx][1] + r[idx];
+          // mask the 2-out-of-2 share with ra.
+          x_plus_r[idx] = _x[idx] + r[idx];
         });
 
         // open c = <x> + <r>
@@ -837,6 +851,69 @@ ArrayRef TruncPrAPrecise::proc(KernelEvalContext* ctx, const ArrayRef& in,
   return out;
 }
 
+}  // namespace
+
+// PRECISE VERSION
+// Refer to:
+// 3.2.2 Truncation by a public value, P10,
+// Secure Evaluation of Quantized Neural Networks
+// - https://arxiv.org/pdf/1910.12435.pdf
+ArrayRef TruncPrAPrecise::proc(KernelEvalContext* ctx, const ArrayRef& in,
+                               size_t bits) const {
+  SPU_TRACE_MPC_LEAF(ctx, in, bits);
+
+  const auto field = in.eltype().as<AShrTy>()->field();
+  auto* comm = ctx->caller()->getState<Communicator>();
+
+  // TODO: cost model is asymmetric, but test framework requires the same.
+  comm->addCommStatsManually(3, 4 * SizeOf(field) * in.numel());
+
+  // convert to 2-outof-2 share of P0 and P1.
+  auto x = getSecondShare(in);
+  if (comm->getRank() == 0) {
+    x = ring_add(getFirstShare(in), x);
+  }
+  return truncPrecise2PC(ctx, field, in.numel(), x, bits);
+}
+
+ArrayRef MatMulAATrunc::proc(KernelEvalContext* ctx, const ArrayRef& x,
+                             const ArrayRef& y, size_t M, size_t N, size_t K,
+                             size_t bits) const {
+  SPU_TRACE_MPC_LEAF(ctx, x, y, bits);
+
+  const auto field = x.eltype().as<Ring2k>()->field();
+  auto* comm = ctx->caller()->getState<Communicator>();
+  auto* prg_state = ctx->caller()->getState<PrgState>();
+
+  auto r = std::async([&] {
+    auto [r0, r1] = prg_state->genPrssPair(field, M * N);
+    return ring_sub(r0, r1);
+  });
+
+  auto x1 = getFirstShare(x);
+  auto x2 = getSecondShare(x);
+
+  auto y1 = getFirstShare(y);
+  auto y2 = getSecondShare(y);
+
+  // the 3-out-of-3 share of MatMulAA.
+  auto t2 = std::async(ring_mmul, x2, y1, M, N, K);
+  auto t0 = ring_mmul(x1, ring_add(y1, y2), M, N, K);  //
+  auto z = ring_sum({t0, t2.get(), r.get()});
+
+  // TODO: cost model is asymmetric, but test framework requires the same.
+  comm->addCommStatsManually(3, 5 * SizeOf(field) * M * N);
+
+  // P2 sends its share to P1, in parallel with the correlated randomness of
+  // the truncation, then P0 and P1 hold a 2-out-of-2 share.
+  if (comm->getRank() == 1) {
+    ring_add_(z, comm->recv(2, z.eltype(), kBindName));
+  } else if (comm->getRank() == 2) {
+    comm->sendAsync(1, z, kBindName);
+  }
+  return truncPrecise2PC(ctx, field, M * N, z, bits);
+}
+
 namespace {
 // split even and odd bits. e.g.
 //   xAyBzCwD -> (xyzw, ABCD)
@@ -983,11 +1060,11 @@ ArrayRef MsbA::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
       }
     });
 
-    r1 = comm->rotate<U>(r0, "m");
+    auto r0_next = comm->rotate<U>(r0, "m");
 
     pforeach(0, in.numel(), [&](int64_t idx) {
       _m[idx][0] = r0[idx];
-      _m[idx][1] = r1[idx];
+      _m[idx][1] = r0_next[idx];
       _n[idx][0] = comm->getRank() == 2 ? _in[idx][0] : 0;
       _n[idx][1] = comm->getRank() == 1 ? _in[idx][1] : 0;
     });
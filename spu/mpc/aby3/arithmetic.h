@@ -43,6 +43,23 @@ class A2P : public UnaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
 };
 
+// A random secret of the replicated PRSS pairs, no communication.
+class RandA : public Kernel {
+ public:
+  static constexpr char kBindName[] = "rand_a";
+
+  CExpr latency() const override { return Const(0); }
+
+  CExpr comm() const override { return Const(0); }
+
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(
+        proc(ctx, ctx->getParam<FieldType>(0), ctx->getParam<size_t>(1)));
+  }
+
+  ArrayRef proc(KernelEvalContext* ctx, FieldType field, size_t size) const;
+};
+
 class P2A : public UnaryKernel {
  public:
   static constexpr char kBindName[] = "p2a";
@@ -179,6 +196,23 @@ class MatMulAA : public MatmulKernel {
                 size_t M, size_t N, size_t K) const override;
 };
 
+// A matmul followed by the precise truncation, the products are summed to a
+// 2-out-of-2 share of P0 and P1 which the truncation starts from, instead of
+// being reshared first, i.e. one round and 2k bits less per element.
+class MatMulAATrunc : public MatmulTruncKernel {
+ public:
+  static constexpr char kBindName[] = "mmul_aa_trunc";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  CExpr latency() const override { return nullptr; }
+
+  CExpr comm() const override { return nullptr; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& A, const ArrayRef& B,
+                size_t M, size_t N, size_t K, size_t bits) const override;
+};
+
 class LShiftA : public ShiftKernel {
  public:
   static constexpr char kBindName[] = "lshift_a";
@@ -238,9 +272,9 @@ class MsbA : public UnaryKernel {
   }
 
   util::CExpr comm() const override {
-    // 1 * carry_out: k + 2 * k
+    // 1 * carry_out: k + 2 * (k - 1), levels of k/2, k/4, ..., 1 bits.
     // 1 * rotate: k
-    return K() * 4;
+    return K() * 4 - 2;
   }
 
   float getCommTolerance() const override { return 0.2; }
@@ -22,9 +22,39 @@
 #include "spu/mpc/aby3/value.h"
 #include "spu/mpc/common/prg_state.h"
 #include "spu/mpc/common/pub2k.h"
+#include "spu/mpc/util/bit_utils.h"
 #include "spu/mpc/util/communicator.h"
 
 namespace spu::mpc::aby3 {
+namespace {
+
+// Rotate shares of `nbits` valid bits, the bits are packed on the wire when
+// the backtype is wider, e.g. 1 bit of uint8 takes 1/8 of the bandwidth.
+//
+// Note: the bits above nbits of `in` are cleared, so all parties hold zero
+// shares of them.
+template <typename T>
+TypedBuffer<T> rotateBits(Communicator* comm, std::vector<T>& in,
+                          size_t nbits, std::string_view tag) {
+  if (nbits == 0 || nbits >= sizeof(T) * 8) {
+    return comm->rotate<T>(in, tag);
+  }
+
+  const T mask = static_cast<T>((T(1) << nbits) - 1);
+  for (auto& v : in) {
+    v &= mask;
+  }
+  auto packed = packBits<T>(in, nbits);
+  auto packed_next = comm->rotate<uint64_t>(packed, tag);
+  YACL_ENFORCE(packed_next.size() == packed.size());
+
+  yacl::Buffer next(static_cast<int64_t>(in.size() * sizeof(T)));
+  unpackBits<T>(absl::MakeConstSpan(packed_next.data(), packed_next.size()),
+                nbits, absl::MakeSpan(next.data<T>(), in.size()));
+  return TypedBuffer<T>(std::move(next));
+}
+
+}  // namespace
 
 void CommonTypeB::evaluate(EvalContext* ctx) const {
   const Type& lhs = ctx->getParam<Type>(0);
@@ -199,12 +229,13 @@ ArrayRef AndBB::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                     (_lhs[idx][1] & _rhs[idx][0]) ^ (r0[idx] ^ r1[idx]);
         });
 
-        r1 = comm->rotate<OutT>(r0, "andbb");  // comm => 1, k
+        // comm => 1, nbits
+        auto r0_next = rotateBits<OutT>(comm, r0, out_nbits, "andbb");
 
         auto _out = ArrayView<std::array<OutT, 2>>(out);
         pforeach(0, lhs.numel(), [&](int64_t idx) {
           _out[idx][0] = r0[idx];
-          _out[idx][1] = r1[idx];
+          _out[idx][1] = r0_next[idx];
         });
         return out;
       });
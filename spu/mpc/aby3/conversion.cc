@@ -72,13 +72,13 @@ ArrayRef A2B::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
         }
       });
 
-      r1 = comm->rotate<BShrT>(r0, "a2b");  // comm => 1, k
+      auto r0_next = comm->rotate<BShrT>(r0, "a2b");  // comm => 1, k
 
       auto _m = ArrayView<std::array<BShrT, 2>>(m);
       auto _n = ArrayView<std::array<BShrT, 2>>(n);
       pforeach(0, in.numel(), [&](int64_t idx) {
         _m[idx][0] = r0[idx];
-        _m[idx][1] = r1[idx];
+        _m[idx][1] = r0_next[idx];
 
         if (comm->getRank() == 0) {
           _n[idx][0] = 0;
@@ -94,7 +94,7 @@ ArrayRef A2B::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
     });
   });
 
-  return add_bb(ctx->caller(), m, n);  // comm => log(k) + 1, 2k(logk) + k
+  return add_bb(ctx->caller(), m, n);  // comm => log(k) + 1, 2k(logk)
 }
 
 // Referrence:
@@ -121,7 +121,7 @@ ArrayRef B2A::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
   }
   auto rb2 = comm->rotate(rb1, kBindName);  // comm => 1, k
 
-  // comm => log(k) + 1, 2k(logk) + k
+  // comm => log(k) + 1, 2k(logk)
   auto x_plus_r = add_bb(ctx->caller(), x, makeBShare(rb1, rb2, field));
 
   const auto& x_plus_r_1 = getFirstShare(x_plus_r);
@@ -146,22 +146,22 @@ ArrayRef B2A::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
 }
 
 template <typename T>
-static std::vector<bool> bitDecompose(ArrayView<T> in, size_t nbits) {
+static std::vector<uint8_t> bitDecompose(ArrayView<T> in, size_t nbits) {
   // decompose each bit of an array of element.
-  std::vector<bool> dep(in.numel() * nbits);
+  std::vector<uint8_t> dep(in.numel() * nbits);
   pforeach(0, in.numel(), [&](int64_t idx) {
     for (size_t bit = 0; bit < nbits; bit++) {
       size_t flat_idx = idx * nbits + bit;
-      dep[flat_idx] = static_cast<bool>((in[idx] >> bit) & 0x1);
+      dep[flat_idx] = static_cast<uint8_t>((in[idx] >> bit) & 0x1);
     }
   });
   return dep;
 }
 
 template <typename T>
-static std::vector<T> bitCompose(absl::Span<T const> in, size_t nbits) {
-  YACL_ENFORCE(in.size() % nbits == 0);
-  std::vector<T> out(in.size() / nbits, 0);
+static std::vector<T> bitCompose(ArrayView<T> in, size_t nbits) {
+  YACL_ENFORCE(in.numel() % nbits == 0);
+  std::vector<T> out(in.numel() / nbits, 0);
   pforeach(0, out.size(), [&](int64_t idx) {
     for (size_t bit = 0; bit < nbits; bit++) {
       size_t flat_idx = idx * nbits + bit;
@@ -193,6 +193,8 @@ static std::vector<T> bitCompose(absl::Span<T const> in, size_t nbits) {
 //
 // Current implementation
 // - P2 could send c2 resulting in 2 rounds and 4k bits of communication.
+// - All bits are chosen by one batched OT, since c2 = sum(m{b2_i} << i), the
+//   msg of bit i is only needed modulo 2^(k-i), which halves the OT.
 //
 // TODO:
 // - Alternatively, the three-party OT procedure can be repeated (in parallel)
@@ -235,30 +237,24 @@ ArrayRef B2AByOT::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
       auto _out = ArrayView<std::array<AShrT, 2>>(out);
 
       const size_t total_nbits = in.numel() * in_nbits;
-      std::vector<AShrT> r0(total_nbits);
-      std::vector<AShrT> r1(total_nbits);
-      prg_state->fillPrssPair(absl::MakeSpan(r0), absl::MakeSpan(r1));
+      ArrayRef r0;
+      ArrayRef r1;
+      std::tie(r0, r1) = prg_state->genPrssPair(field, total_nbits);
+
+      // the msg of bit i is shifted by i when composed, so only its low
+      // k - i bits are sent.
+      std::vector<size_t> msg_nbits(in_nbits);
+      for (size_t bit = 0; bit < in_nbits; bit++) {
+        msg_nbits[bit] = SizeOf(field) * 8 - bit;
+      }
+      Ot3 ot(field, total_nbits, std::move(msg_nbits), Ot3::RoleRanks{2, 1, 0},
+             comm, prg_state);
 
       switch (comm->getRank()) {
         case 0: {  // the helper
-          auto b2 = bitDecompose(ArrayView<BShrT>(getShare(in, 1)), in_nbits);
-
-          // gen masks with helper.
-          std::vector<AShrT> m0(total_nbits);
-          std::vector<AShrT> m1(total_nbits);
-          prg_state->fillPrssPair(absl::MakeSpan(m0), {}, false, true);
-          prg_state->fillPrssPair(absl::MakeSpan(m1), {}, false, true);
-
-          // build selected mask
-          YACL_ENFORCE(b2.size() == m0.size() && b2.size() == m1.size());
-          pforeach(0, total_nbits, [&](int64_t idx) {
-            m0[idx] = !b2[idx] ? m0[idx] : m1[idx];
-          });
+          ot.help(bitDecompose(ArrayView<BShrT>(getShare(in, 1)), in_nbits));
 
-          // send selected masked to receiver.
-          comm->sendAsync<AShrT>(1, m0, "mc");
-
-          auto c1 = bitCompose<AShrT>(r0, in_nbits);
+          auto c1 = bitCompose(ArrayView<AShrT>(r0), in_nbits);
           auto c2 = comm->recv<AShrT>(1, "c2");
 
           pforeach(0, in.numel(), [&](int64_t idx) {
@@ -269,23 +265,12 @@ ArrayRef B2AByOT::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
           break;
         }
         case 1: {  // the receiver
-          prg_state->fillPrssPair(absl::MakeSpan(r0), {}, false, false);
-          prg_state->fillPrssPair(absl::MakeSpan(r0), {}, false, false);
-
-          auto b2 = bitDecompose(ArrayView<BShrT>(getShare(in, 0)), in_nbits);
-
-          // ot.recv
-          auto mc = comm->recv<AShrT>(0, "mc");
-          auto m0 = comm->recv<AShrT>(2, "m0");
-          auto m1 = comm->recv<AShrT>(2, "m1");
-
           // rebuild c2 = (b1^b2^b3)-c1-c3
-          pforeach(0, total_nbits, [&](int64_t idx) {
-            mc[idx] = !b2[idx] ? m0[idx] ^ mc[idx] : m1[idx] ^ mc[idx];
-          });
-          auto c2 = bitCompose<AShrT>(mc, in_nbits);
+          auto mc = ot.recv(
+              bitDecompose(ArrayView<BShrT>(getShare(in, 0)), in_nbits));
+          auto c2 = bitCompose(ArrayView<AShrT>(mc), in_nbits);
           comm->sendAsync<AShrT>(0, c2, "c2");
-          auto c3 = bitCompose<AShrT>(r1, in_nbits);
+          auto c3 = bitCompose(ArrayView<AShrT>(r1), in_nbits);
 
           pforeach(0, in.numel(), [&](int64_t idx) {
             _out[idx][0] = c2[idx];
@@ -295,34 +280,25 @@ ArrayRef B2AByOT::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
           break;
         }
         case 2: {  // the sender.
-          auto c3 = bitCompose<AShrT>(r0, in_nbits);
-          auto c1 = bitCompose<AShrT>(r1, in_nbits);
+          auto c3 = bitCompose(ArrayView<AShrT>(r0), in_nbits);
+          auto c1 = bitCompose(ArrayView<AShrT>(r1), in_nbits);
 
           // c3 = r0, c1 = r1
           // let mi := (i^b1^b3)−c1−c3 for i in {0, 1}
           // reuse r's memory for m
+          auto _m0 = ArrayView<AShrT>(r0);
+          auto _m1 = ArrayView<AShrT>(r1);
           pforeach(0, in.numel(), [&](int64_t idx) {
             auto xx = _in[idx][0] ^ _in[idx][1];
             for (size_t bit = 0; bit < in_nbits; bit++) {
               size_t flat_idx = idx * in_nbits + bit;
-              AShrT t = r0[flat_idx] + r1[flat_idx];
-              r0[flat_idx] = ((xx >> bit) & 0x1) - t;
-              r1[flat_idx] = ((~xx >> bit) & 0x1) - t;
+              AShrT t = _m0[flat_idx] + _m1[flat_idx];
+              _m0[flat_idx] = ((xx >> bit) & 0x1) - t;
+              _m1[flat_idx] = ((~xx >> bit) & 0x1) - t;
             }
           });
 
-          // gen masks with helper.
-          std::vector<AShrT> m0(total_nbits);
-          std::vector<AShrT> m1(total_nbits);
-          prg_state->fillPrssPair({}, absl::MakeSpan(m0), true, false);
-          prg_state->fillPrssPair({}, absl::MakeSpan(m1), true, false);
-          pforeach(0, total_nbits, [&](int64_t idx) {
-            m0[idx] ^= r0[idx];
-            m1[idx] ^= r1[idx];
-          });
-
-          comm->sendAsync<AShrT>(1, m0, "m0");
-          comm->sendAsync<AShrT>(1, m1, "m1");
+          ot.send(r0, r1);
 
           pforeach(0, in.numel(), [&](int64_t idx) {
             _out[idx][0] = c3[idx];
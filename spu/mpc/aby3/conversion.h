@@ -44,9 +44,9 @@ class A2B : public UnaryKernel {
   }
 
   CExpr comm() const override {
-    // 1 * AddBB : logk * 2k + k
+    // 1 * AddBB : logk * 2k
     // 1 * rotate: k
-    return Log(K()) * K() * 2 + K() * 2;
+    return Log(K()) * K() * 2 + K();
   }
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
@@ -71,9 +71,9 @@ class B2A : public UnaryKernel {
 
   CExpr comm() const override {
     // 3 * rotate   : 3k
-    // 1 * AddBB    : logk * 2k + k
+    // 1 * AddBB    : logk * 2k
     // manual add   : k
-    return Log(K()) * K() * 2 + K() * 5;
+    return Log(K()) * K() * 2 + K() * 4;
   }
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& x) const override;
@@ -92,8 +92,8 @@ class B2AByOT : public UnaryKernel {
 
   // Note: when nbits is large, OT method will be slower then circuit method.
   CExpr comm() const override {
-    return 2 * K() * K()  // the OT
-           + K()          // partial send
+    return K() * (K() + 1)  // the OT, msg of bit i has k - i bits
+           + K()            // partial send
         ;
   }
 
@@ -116,9 +116,10 @@ class AddBB : public BinaryKernel {
 
   CExpr comm() const override {
     // Cost from other gates (from KoggeStoneAdder):
-    // 1 * AddBB    : k
-    // logk * AndBB : logk * 2k
-    return Log(K()) * K() * 2 + K();
+    // 1 * AndBB        : k
+    // logk - 1 * AndBB : (logk - 1) * 2k
+    // 1 * AndBB        : k, no propagates for the last level.
+    return Log(K()) * K() * 2;
   }
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& lhs,
@@ -17,6 +17,7 @@
 #include "yacl/crypto/tools/prg.h"
 #include "yacl/crypto/utils/rand.h"
 
+#include "spu/core/parallel_utils.h"
 #include "spu/mpc/aby3/type.h"
 #include "spu/mpc/aby3/value.h"
 #include "spu/mpc/common/pub2k.h"
@@ -64,6 +65,59 @@ std::vector<ArrayRef> Aby3Io::toShares(const ArrayRef& raw, Visibility vis,
   YACL_THROW("unsupported vis type {}", vis);
 }
 
+namespace {
+
+ArrayRef expandSeed(FieldType field, size_t numel, uint128_t seed) {
+  uint64_t counter = 0;
+  return ring_rand(field, numel, seed, &counter);
+}
+
+}  // namespace
+
+std::vector<SeededShare> Aby3Io::makeSeededSecret(const ArrayRef& raw,
+                                                  size_t owner_rank) const {
+  YACL_ENFORCE(raw.eltype().isa<RingTy>(), "expected RingTy, got {}",
+               raw.eltype());
+  YACL_ENFORCE(owner_rank < 3, "invalid owner {}", owner_rank);
+
+  const size_t next_rank = (owner_rank + 1) % 3;
+  const size_t prev_rank = (owner_rank + 2) % 3;
+
+  // s_next = prg(k_next), s_prev = prg(k_prev), s_owner = x - s_next - s_prev
+  const uint128_t k_next = yacl::RandSeed();
+  const uint128_t k_prev = yacl::RandSeed();
+  ArrayRef rest = raw.clone();
+  ring_sub_(rest, expandSeed(field_, raw.numel(), k_next));
+  ring_sub_(rest, expandSeed(field_, raw.numel(), k_prev));
+
+  // party i holds (s_i, s_{i+1}).
+  std::vector<SeededShare> shares(3);
+  shares[owner_rank] = {rest, {k_next}};
+  shares[next_rank] = {ArrayRef(), {k_next, k_prev}};
+  shares[prev_rank] = {rest, {k_prev}};
+  return shares;
+}
+
+ArrayRef Aby3Io::expandSeededShare(const SeededShare& share, size_t numel,
+                                   size_t rank, size_t owner_rank) const {
+  YACL_ENFORCE(rank < 3 && owner_rank < 3, "invalid rank {} or owner {}",
+               rank, owner_rank);
+
+  if (rank == (owner_rank + 1) % 3) {
+    YACL_ENFORCE(share.seeds.size() == 2);
+    return makeAShare(expandSeed(field_, numel, share.seeds[0]),
+                      expandSeed(field_, numel, share.seeds[1]), field_);
+  }
+
+  YACL_ENFORCE(share.seeds.size() == 1);
+  YACL_ENFORCE(share.plain.numel() == static_cast<int64_t>(numel));
+  auto seeded = expandSeed(field_, numel, share.seeds[0]);
+  if (rank == owner_rank) {
+    return makeAShare(share.plain, seeded, field_);
+  }
+  return makeAShare(seeded, share.plain, field_);
+}
+
 std::vector<ArrayRef> Aby3Io::makeBitSecret(const ArrayRef& in) const {
   YACL_ENFORCE(in.eltype().isa<PtTy>(), "expected PtType, got {}", in.eltype());
   PtType in_pt_type = in.eltype().as<PtTy>()->pt_type();
@@ -100,7 +154,7 @@ std::vector<ArrayRef> Aby3Io::makeBitSecret(const ArrayRef& in) const {
     auto _s1 = ArrayView<std::array<BShrT, 2>>(shares[1]);
     auto _s2 = ArrayView<std::array<BShrT, 2>>(shares[2]);
 
-    for (int64_t idx = 0; idx < in.numel(); idx++) {
+    pforeach(0, in.numel(), [&](int64_t idx) {
       const BShrT r2 = static_cast<BShrT>(_in[idx]) - r0[idx] - r1[idx];
 
       _s0[idx][0] = r0[idx] & 0x1;
@@ -111,7 +165,7 @@ std::vector<ArrayRef> Aby3Io::makeBitSecret(const ArrayRef& in) const {
 
       _s2[idx][0] = r2 & 0x1;
       _s2[idx][1] = r0[idx] & 0x1;
-    }
+    });
     return shares;
   });
 }
@@ -127,15 +181,14 @@ ArrayRef Aby3Io::fromShares(const std::vector<ArrayRef>& shares) const {
     ArrayRef out(makeType<Pub2kTy>(field_), shares[0].numel());
     DISPATCH_ALL_FIELDS(field_, "_", [&]() {
       auto _out = ArrayView<ring2k_t>(out);
-      for (size_t si = 0; si < shares.size(); si++) {
-        auto _share = ArrayView<std::array<ring2k_t, 2>>(shares[si]);
-        for (auto idx = 0; idx < shares[0].numel(); idx++) {
-          if (si == 0) {
-            _out[idx] = 0;
-          }
+      std::vector<ArrayView<std::array<ring2k_t, 2>>> _shares(shares.begin(),
+                                                              shares.end());
+      pforeach(0, shares[0].numel(), [&](int64_t idx) {
+        _out[idx] = 0;
+        for (const auto& _share : _shares) {
           _out[idx] += _share[idx][0];
         }
-      }
+      });
     });
     return out;
   } else if (eltype.isa<BShrTy>()) {
@@ -146,15 +199,14 @@ ArrayRef Aby3Io::fromShares(const std::vector<ArrayRef>& shares) const {
       auto _out = ArrayView<OutT>(out);
       DISPATCH_UINT_PT_TYPES(eltype.as<BShrTy>()->getBacktype(), "_", [&] {
         using BShrT = ScalarT;
-        for (size_t si = 0; si < shares.size(); si++) {
-          auto _share = ArrayView<std::array<BShrT, 2>>(shares[si]);
-          for (auto idx = 0; idx < shares[0].numel(); idx++) {
-            if (si == 0) {
-              _out[idx] = 0;
-            }
+        std::vector<ArrayView<std::array<BShrT, 2>>> _shares(shares.begin(),
+                                                             shares.end());
+        pforeach(0, shares[0].numel(), [&](int64_t idx) {
+          _out[idx] = 0;
+          for (const auto& _share : _shares) {
             _out[idx] ^= _share[idx][0];
           }
-        }
+        });
       });
     });
 
@@ -29,6 +29,15 @@ class Aby3Io final : public BaseIo {
 
   std::vector<ArrayRef> makeBitSecret(const ArrayRef& raw) const override;
   bool hasBitSecretSupport() const override { return true; }
+
+  // With owner o, the shares s_{o+1} and s_{o+2} are expanded from two seeds
+  // and s_o holds the rest. Party o+1 gets the seeds only, and party o+2 gets
+  // s_o in plain and one seed, a quarter of the data of toShares.
+  std::vector<SeededShare> makeSeededSecret(const ArrayRef& raw,
+                                            size_t owner_rank) const override;
+  ArrayRef expandSeededShare(const SeededShare& share, size_t numel,
+                             size_t rank, size_t owner_rank) const override;
+  bool hasSeededSecretSupport() const override { return true; }
 };
 
 std::unique_ptr<Aby3Io> makeAby3Io(FieldType type, size_t npc);
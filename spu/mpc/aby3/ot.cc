@@ -14,6 +14,10 @@
 
 #include "spu/mpc/aby3/ot.h"
 
+#include <algorithm>
+
+#include "spu/core/parallel_utils.h"
+#include "spu/mpc/util/bit_utils.h"
 #include "spu/mpc/util/ring_ops.h"
 
 namespace spu::mpc::aby3 {
@@ -26,12 +30,25 @@ inline bool inFrontOf(size_t a, size_t b) { return (a + 1) % 3 == b; }
 
 Ot3::Ot3(FieldType field, int64_t numel, const RoleRanks& roles,
          Communicator* comm, PrgState* prg_state, bool reentrancy)
+    : Ot3(field, numel, {}, roles, comm, prg_state, reentrancy) {}
+
+Ot3::Ot3(FieldType field, int64_t numel, std::vector<size_t> msg_nbits,
+         const RoleRanks& roles, Communicator* comm, PrgState* prg_state,
+         bool reentrancy)
     : field_(field),
       numel_(numel),
       roles_(roles),
+      msg_nbits_(std::move(msg_nbits)),
       comm_(comm),
       prg_state_(prg_state),
       reentrancy_(reentrancy) {
+  if (!msg_nbits_.empty()) {
+    YACL_ENFORCE(numel_ % msg_nbits_.size() == 0, "numel={}, period={}",
+                 numel_, msg_nbits_.size());
+    for (auto nbits : msg_nbits_) {
+      YACL_ENFORCE(nbits <= SizeOf(field_) * 8, "invalid msg nbits={}", nbits);
+    }
+  }
   if (!reentrancy_) {
     masks_ = genMasks();
   }
@@ -67,6 +84,59 @@ std::pair<ArrayRef, ArrayRef> Ot3::genMasks() {
   return {w0, w1};
 }
 
+void Ot3::sendMsgs(size_t dst_rank, const std::vector<ArrayRef>& msgs,
+                   std::string_view tag) {
+  DISPATCH_ALL_FIELDS(field_, "_", [&]() {
+    using T = ring2k_t;
+
+    std::vector<T> buf(msgs.size() * numel_);
+    for (size_t i = 0; i < msgs.size(); i++) {
+      YACL_ENFORCE(msgs[i].numel() == numel_);
+      auto _msg = ArrayView<T>(msgs[i]);
+      pforeach(0, numel_,
+               [&](int64_t idx) { buf[i * numel_ + idx] = _msg[idx]; });
+    }
+
+    if (msg_nbits_.empty()) {
+      comm_->sendAsync<T>(dst_rank, buf, tag);
+    } else {
+      comm_->sendAsync<uint64_t>(dst_rank, packBits<T>(buf, msg_nbits_), tag);
+    }
+  });
+}
+
+std::vector<ArrayRef> Ot3::recvMsgs(size_t src_rank, size_t num_msgs,
+                                    std::string_view tag) {
+  const auto ty = makeType<RingTy>(field_);
+  const size_t numel = num_msgs * numel_;
+
+  // all messages refer to one buffer, received or unpacked in place.
+  ArrayRef all;
+  DISPATCH_ALL_FIELDS(field_, "_", [&]() {
+    using T = ring2k_t;
+
+    if (msg_nbits_.empty()) {
+      auto recv = comm_->recv<T>(src_rank, tag);
+      YACL_ENFORCE(recv.size() == numel);
+      all = ArrayRef(std::make_shared<yacl::Buffer>(recv.release()), ty,
+                     numel, 1, 0);
+    } else {
+      auto words = comm_->recv<uint64_t>(src_rank, tag);
+      YACL_ENFORCE(words.size() == packedWords(numel, msg_nbits_));
+      all = ArrayRef(ty, numel);
+      unpackBits<T>(absl::MakeConstSpan(words.data(), words.size()),
+                    msg_nbits_, absl::MakeSpan(&all.at<T>(0), numel));
+    }
+  });
+
+  std::vector<ArrayRef> msgs;
+  msgs.reserve(num_msgs);
+  for (size_t i = 0; i < num_msgs; i++) {
+    msgs.push_back(all.slice(i * numel_, (i + 1) * numel_));
+  }
+  return msgs;
+}
+
 void Ot3::send(ArrayRef m0, ArrayRef m1) {
   // sanity check.
   YACL_ENFORCE(comm_->getRank() == roles_.sender);
@@ -90,8 +160,8 @@ void Ot3::send(ArrayRef m0, ArrayRef m1) {
   auto masked_m0 = ring_xor(m0, w0);
   auto masked_m1 = ring_xor(m1, w1);
 
-  comm_->sendAsync(roles_.receiver, masked_m0, "m0");
-  comm_->sendAsync(roles_.receiver, masked_m1, "m1");
+  // both msgs in one message.
+  sendMsgs(roles_.receiver, {masked_m0, masked_m1}, "m");
 }
 
 ArrayRef Ot3::recv(const std::vector<uint8_t>& choices) {
@@ -99,8 +169,6 @@ ArrayRef Ot3::recv(const std::vector<uint8_t>& choices) {
   YACL_ENFORCE(comm_->getRank() == roles_.receiver);
   YACL_ENFORCE(choices.size() == static_cast<size_t>(numel_));
 
-  const auto ty = makeType<RingTy>(field_);
-
   if (!reentrancy_) {
     YACL_ENFORCE(masks_.has_value(), "this OT instance can only use once.");
     masks_.reset();
@@ -109,12 +177,13 @@ ArrayRef Ot3::recv(const std::vector<uint8_t>& choices) {
   }
 
   // get masked messages from sender.
-  auto m0 = comm_->recv(roles_.sender, ty, "m0");
-  auto m1 = comm_->recv(roles_.sender, ty, "m1");
+  auto ms = recvMsgs(roles_.sender, 2, "m");
+  const auto& m0 = ms[0];
+  const auto& m1 = ms[1];
 
   auto mc = ring_select(choices, m0, m1);
   // get chosen masks
-  auto wc = comm_->recv(roles_.helper, ty, "wc");
+  auto wc = recvMsgs(roles_.helper, 1, "wc")[0];
 
   YACL_ENFORCE(m0.numel() == static_cast<int64_t>(choices.size()));
 
@@ -146,7 +215,7 @@ void Ot3::help(const std::vector<uint8_t>& choices) {
   ArrayRef wc = ring_select(choices, w0, w1);
 
   // send to receiver
-  comm_->sendAsync(roles_.receiver, wc, "wc");
+  sendMsgs(roles_.receiver, {wc}, "wc");
 }
 
 }  // namespace spu::mpc::aby3
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <optional>
+#include <string_view>
+#include <vector>
 
 #include "yacl/link/link.h"
 
@@ -43,6 +45,9 @@ class Ot3 {
   const FieldType field_;  // each msg has SizeOf(field_) bits
   const int64_t numel_;    // total num of msgs
   const RoleRanks roles_;
+  // valid bits of msgs, msg i has msg_nbits_[i % msg_nbits_.size()] bits,
+  // empty if all bits are valid.
+  const std::vector<size_t> msg_nbits_;
 
   // state information
   Communicator* const comm_;
@@ -53,6 +58,12 @@ class Ot3 {
   std::optional<std::pair<ArrayRef, ArrayRef>> masks_;
   std::pair<ArrayRef, ArrayRef> genMasks();
 
+  // send/recv same sized msgs in one message, only valid bits are on wire.
+  void sendMsgs(size_t dst_rank, const std::vector<ArrayRef>& msgs,
+                std::string_view tag);
+  std::vector<ArrayRef> recvMsgs(size_t src_rank, size_t num_msgs,
+                                 std::string_view tag);
+
  public:
   // reentrancy == true, gen marks by prg_state inside send/recv/help function.
   // and ot instance can used repeatedly.
@@ -68,6 +79,14 @@ class Ot3 {
   explicit Ot3(FieldType field, int64_t numel, const RoleRanks& roles,
                Communicator* comm, PrgState* prg_state, bool reentrancy = true);
 
+  // Batched OT of narrow msgs, i.e. many bits of each element are chosen in
+  // one round. Msg i is only valid for its low msg_nbits[i %
+  // msg_nbits.size()] bits, the receiver gets msgs with higher bits cleared.
+  // `numel` should be a multiple of msg_nbits.size().
+  explicit Ot3(FieldType field, int64_t numel, std::vector<size_t> msg_nbits,
+               const RoleRanks& roles, Communicator* comm, PrgState* prg_state,
+               bool reentrancy = true);
+
   void send(ArrayRef m0, ArrayRef m1);
 
   ArrayRef recv(const std::vector<uint8_t>& choices);
@@ -53,6 +53,47 @@ TEST_P(OTTest, OT3Party) {
   });
 }
 
+TEST_P(OTTest, OT3PartyNarrow) {
+  const FieldType field = std::get<1>(GetParam());
+  const Ot3::RoleRanks roles = std::get<2>(GetParam());
+  const size_t k = SizeOf(field) * 8;
+  const std::vector<size_t> msg_nbits = {k, k - 1, 1, 3};
+  const int64_t numel = std::get<0>(GetParam()) * msg_nbits.size();
+
+  ArrayRef m0 = ring_rand(field, numel);
+  ArrayRef m1 = ring_rand(field, numel);
+  std::vector<uint8_t> choices(numel);
+  for (int64_t idx = 0; idx < numel; idx++) {
+    choices[idx] = static_cast<uint8_t>(idx % 3 == 0);
+  }
+
+  // only the low bits of msgs are chosen.
+  auto expected = ring_select(choices, m0, m1);
+  for (int64_t idx = 0; idx < numel; idx++) {
+    const size_t nbits = msg_nbits[idx % msg_nbits.size()];
+    if (nbits < k) {
+      auto elem = expected.slice(idx, idx + 1);
+      ring_bitmask_(elem, 0, nbits);
+    }
+  }
+
+  util::simulate(3u, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator comm(lctx);
+    PrgState prg_state(lctx);
+
+    Ot3 ot(field, numel, msg_nbits, roles, &comm, &prg_state);
+
+    if (comm.getRank() == roles.sender) {
+      ot.send(m0, m1);
+    } else if (comm.getRank() == roles.receiver) {
+      EXPECT_TRUE(ring_all_equal(expected, ot.recv(choices)));
+    } else {
+      EXPECT_EQ(comm.getRank(), roles.helper);
+      ot.help(choices);
+    }
+  });
+}
+
 INSTANTIATE_TEST_SUITE_P(
     OTTestInstances, OTTest,
     testing::Combine(testing::Values(0, 1, 3, 100),
@@ -48,6 +48,8 @@ std::unique_ptr<Object> makeAby3Protocol(
   regABKernels(obj.get());
 
   // register arithmetic & binary kernels
+  obj->regKernel<aby3::RandA>();
+  regABRandKernels(obj.get());
   obj->regKernel<aby3::P2A>();
   obj->regKernel<aby3::A2P>();
   obj->regKernel<aby3::NotA>();
@@ -64,6 +66,7 @@ std::unique_ptr<Object> makeAby3Protocol(
 #define ENABLE_PRECISE_ABY3_TRUNCPR
 #ifdef ENABLE_PRECISE_ABY3_TRUNCPR
   obj->regKernel<aby3::TruncPrAPrecise>();
+  obj->regKernel<aby3::MatMulAATrunc>();
 #else
   obj->regKernel<aby3::TruncPrA>();
 #endif
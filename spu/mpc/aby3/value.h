@@ -58,7 +58,10 @@ size_t maxBitWidth(ArrayView<T> av) {
     // TODO: absl::bit_width can not handle int128
     return 128;
   } else {
-    for (auto idx = 0; idx < av.numel(); idx++) {
+    // a broadcasted scalar is read once.
+    const int64_t numel =
+        av.stride() == 0 ? std::min<int64_t>(av.numel(), 1) : av.numel();
+    for (int64_t idx = 0; idx < numel; idx++) {
       res = std::max(res, static_cast<size_t>(absl::bit_width(av[idx])));
     }
   }
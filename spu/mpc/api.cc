@@ -17,23 +17,28 @@
 namespace spu::mpc {
 
 ArrayRef make_p(Object* ctx, const ArrayRef& plaintext) {
-  return ctx->call("make_p", plaintext);
+  static const KernelName kName("make_p");
+  return ctx->call(kName, plaintext);
 }
 
 ArrayRef rand_p(Object* ctx, FieldType field, size_t sz) {
-  return ctx->call("rand_p", field, sz);
+  static const KernelName kName("rand_p");
+  return ctx->call(kName, field, sz);
 }
 
 ArrayRef rand_s(Object* ctx, FieldType field, size_t sz) {
-  return ctx->call("rand_s", field, sz);
+  static const KernelName kName("rand_s");
+  return ctx->call(kName, field, sz);
 }
 
 Type common_type_s(Object* ctx, const Type& a, const Type& b) {
-  return ctx->call<Type>("common_type_s", a, b);
+  static const KernelName kName("common_type_s");
+  return ctx->call<Type>(kName, a, b);
 }
 
 ArrayRef cast_type_s(Object* ctx, const ArrayRef& a, const Type& to_type) {
-  return ctx->call("cast_type_s", a, to_type);
+  static const KernelName kName("cast_type_s");
+  return ctx->call(kName, a, to_type);
 }
 
 SPU_MPC_DEF_UNARY_OP(p2s)
@@ -51,6 +56,8 @@ SPU_MPC_DEF_UNARY_OP_WITH_SIZE(rshift_s)
 SPU_MPC_DEF_UNARY_OP_WITH_SIZE(arshift_p)
 SPU_MPC_DEF_UNARY_OP_WITH_SIZE(arshift_s)
 SPU_MPC_DEF_UNARY_OP_WITH_SIZE(truncpr_s)
+SPU_MPC_DEF_UNARY_OP_WITH_SIZE(msb_narrow_s)
+SPU_MPC_DEF_UNARY_OP_WITH_SIZE(shuffle_s)
 SPU_MPC_DEF_UNARY_OP_WITH_2SIZE(bitrev_s)
 SPU_MPC_DEF_UNARY_OP_WITH_2SIZE(bitrev_p)
 SPU_MPC_DEF_BINARY_OP(add_pp)
@@ -69,4 +76,16 @@ SPU_MPC_DEF_MMUL(mmul_pp)
 SPU_MPC_DEF_MMUL(mmul_sp)
 SPU_MPC_DEF_MMUL(mmul_ss)
 
+ArrayRef mmul_ss_trunc(Object* ctx, const ArrayRef& x, const ArrayRef& y,
+                       size_t M, size_t N, size_t K, size_t bits) {
+  static const KernelName kName("mmul_ss_trunc");
+  return ctx->call(kName, x, y, M, N, K, bits);
+}
+
+ArrayRef batch_mmul_ss(Object* ctx, const ArrayRef& x, const ArrayRef& y,
+                       size_t batch, size_t M, size_t N, size_t K) {
+  static const KernelName kName("batch_mmul_ss");
+  return ctx->call(kName, x, y, batch, M, N, K);
+}
+
 }  // namespace spu::mpc
@@ -57,6 +57,9 @@ ArrayRef not_p(Object* ctx, const ArrayRef&);
 
 ArrayRef msb_p(Object* ctx, const ArrayRef&);
 ArrayRef msb_s(Object* ctx, const ArrayRef&);
+// The msb of a secret known to fit in the given number of signed bits, it
+// may be computed on a narrower ring.
+ArrayRef msb_narrow_s(Object* ctx, const ArrayRef&, size_t);
 
 ArrayRef eqz_p(Object* ctx, const ArrayRef&);
 ArrayRef eqz_s(Object* ctx, const ArrayRef&);
@@ -71,6 +74,10 @@ ArrayRef arshift_p(Object* ctx, const ArrayRef&, size_t);
 ArrayRef arshift_s(Object* ctx, const ArrayRef&, size_t);
 ArrayRef truncpr_s(Object* ctx, const ArrayRef&, size_t);
 
+// Shuffle rows of a column-major matrix of `rows` rows with a secret random
+// permutation, all columns are permuted in the same way.
+ArrayRef shuffle_s(Object* ctx, const ArrayRef&, size_t rows);
+
 // Reverse bit, like MISP BITREV instruction, and linux bitrev library.
 ArrayRef bitrev_s(Object* ctx, const ArrayRef&, size_t, size_t);
 ArrayRef bitrev_p(Object* ctx, const ArrayRef&, size_t, size_t);
@@ -98,30 +105,44 @@ ArrayRef mmul_sp(Object* ctx, const ArrayRef&, const ArrayRef&, size_t, size_t,
 ArrayRef mmul_ss(Object* ctx, const ArrayRef&, const ArrayRef&, size_t, size_t,
                  size_t);
 
+// mmul_ss truncated by `bits`, for protocols which register it.
+ArrayRef mmul_ss_trunc(Object* ctx, const ArrayRef&, const ArrayRef&, size_t,
+                       size_t, size_t, size_t);
+
+// `batch` independent mmul_ss of [M, K] x [K, N], the operands and the result
+// are concatenated by batch, for protocols which register it.
+ArrayRef batch_mmul_ss(Object* ctx, const ArrayRef&, const ArrayRef&, size_t,
+                       size_t, size_t, size_t);
+
 }  // namespace spu::mpc
 
 #define SPU_MPC_DEF_UNARY_OP(NAME)                 \
   ArrayRef NAME(Object* ctx, const ArrayRef& in) { \
-    return ctx->call(#NAME, in);                   \
+    static const KernelName kName(#NAME);          \
+    return ctx->call(kName, in);                   \
   }
 
 #define SPU_MPC_DEF_UNARY_OP_WITH_SIZE(NAME)                  \
   ArrayRef NAME(Object* ctx, const ArrayRef& in, size_t sz) { \
-    return ctx->call(#NAME, in, sz);                          \
+    static const KernelName kName(#NAME);                     \
+    return ctx->call(kName, in, sz);                          \
   }
 
 #define SPU_MPC_DEF_UNARY_OP_WITH_2SIZE(NAME)                              \
   ArrayRef NAME(Object* ctx, const ArrayRef& in, size_t sz1, size_t sz2) { \
-    return ctx->call(#NAME, in, sz1, sz2);                                 \
+    static const KernelName kName(#NAME);                                  \
+    return ctx->call(kName, in, sz1, sz2);                                 \
   }
 
 #define SPU_MPC_DEF_BINARY_OP(NAME)                                  \
   ArrayRef NAME(Object* ctx, const ArrayRef& x, const ArrayRef& y) { \
-    return ctx->call(#NAME, x, y);                                   \
+    static const KernelName kName(#NAME);                            \
+    return ctx->call(kName, x, y);                                   \
   }
 
 #define SPU_MPC_DEF_MMUL(NAME)                                                 \
   ArrayRef NAME(Object* ctx, const ArrayRef& x, const ArrayRef& y, size_t sz1, \
                 size_t sz2, size_t sz3) {                                      \
-    return ctx->call(#NAME, x, y, sz1, sz2, sz3);                              \
+    static const KernelName kName(#NAME);                                      \
+    return ctx->call(kName, x, y, sz1, sz2, sz3);                              \
   }
@@ -14,9 +14,12 @@
 
 #include "spu/mpc/api_test.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 
 #include "spu/core/shape_util.h"
+#include "spu/core/type_util.h"
 #include "spu/mpc/api.h"
 #include "spu/mpc/util/communicator.h"
 #include "spu/mpc/util/ring_ops.h"
@@ -134,6 +137,61 @@ TEST_BINARY_OP(xor)
 TEST_UNARY_OP(not )
 TEST_UNARY_OP(msb)
 
+TEST_P(ApiTest, MsbNarrowS) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto obj = factory(conf, lctx);
+    if (!obj->hasKernel("msb_narrow_s")) {
+      return;
+    }
+
+    const size_t k = SizeOf(conf.field()) * 8;
+    for (size_t nbits : {size_t(9), size_t(32), size_t(33), k}) {
+      if (nbits > k) {
+        continue;
+      }
+      /* GIVEN */
+      // sign-extend random values of nbits.
+      auto p0 = ring_arshift(
+          ring_lshift(rand_p(obj.get(), conf.field(), kNumel), k - nbits),
+          k - nbits);
+
+      /* WHEN */
+      auto r_s = s2p(obj.get(),
+                     msb_narrow_s(obj.get(), p2s(obj.get(), p0), nbits));
+      auto r_p = msb_p(obj.get(), p0);
+
+      /* THEN */
+      EXPECT_TRUE(ring_all_equal(r_s, r_p)) << nbits;
+    }
+  });
+}
+
+TEST_P(ApiTest, EqzS) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto obj = factory(conf, lctx);
+
+    /* GIVEN */
+    // about half of the elements are zero.
+    auto p0 = ring_mul(rand_p(obj.get(), conf.field(), kNumel),
+                       ring_randbit(conf.field(), kNumel));
+
+    /* WHEN */
+    auto r_s = s2p(obj.get(), eqz_s(obj.get(), p2s(obj.get(), p0)));
+    auto r_p = eqz_p(obj.get(), p0);
+
+    /* THEN */
+    EXPECT_TRUE(ring_all_equal(r_s, r_p));
+  });
+}
+
 #define TEST_UNARY_OP_WITH_BIT_S(OP)                                     \
   TEST_P(ApiTest, OP##S) {                                               \
     const auto factory = std::get<0>(GetParam());                        \
@@ -242,6 +300,36 @@ TEST_P(ApiTest, MatMulSS) {
   });
 }
 
+TEST_P(ApiTest, MatMulSSTrunc) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  const int64_t M = 3;
+  const int64_t K = 4;
+  const int64_t N = 3;
+  const size_t bits = 2;
+
+  // trunc_pr only work for small range.
+  auto p0 = ring_rand_range(conf.field(), M * K, 0, 100);
+  auto p1 = ring_rand_range(conf.field(), K * N, 0, 100);
+  util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto obj = factory(conf, lctx);
+    if (!obj->hasKernel("mmul_ss_trunc")) {
+      return;
+    }
+
+    /* WHEN */
+    auto tmp = mmul_ss_trunc(obj.get(), p2s(obj.get(), p0),
+                             p2s(obj.get(), p1), M, N, K, bits);
+    auto r_ss = s2p(obj.get(), tmp);
+    auto r_pp = arshift_p(obj.get(), mmul_pp(obj.get(), p0, p1, M, N, K), bits);
+
+    /* THEN */
+    EXPECT_TRUE(ring_all_equal(r_ss, r_pp, npc));
+  });
+}
+
 TEST_P(ApiTest, MmulSP) {
   const auto factory = std::get<0>(GetParam());
   const RuntimeConfig& conf = std::get<1>(GetParam());
@@ -290,4 +378,64 @@ TEST_P(ApiTest, P2S_S2P) {
   });
 }
 
+TEST_P(ApiTest, ShuffleS) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  const size_t kRows = 100;
+
+  util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto obj = factory(conf, lctx);
+    if (!obj->hasKernel("shuffle_s")) {
+      return;
+    }
+
+    /* GIVEN */
+    auto p0 = rand_p(obj.get(), conf.field(), 2 * kRows);
+
+    /* WHEN */
+    auto r = s2p(obj.get(), shuffle_s(obj.get(), p2s(obj.get(), p0), kRows));
+
+    /* THEN */
+    // rows are permuted together, the multiset of rows is kept.
+    DISPATCH_ALL_FIELDS(conf.field(), "_", [&]() {
+      using U = ring2k_t;
+      std::vector<std::pair<U, U>> expected;
+      std::vector<std::pair<U, U>> got;
+      for (size_t row = 0; row < kRows; row++) {
+        expected.emplace_back(p0.at<U>(row), p0.at<U>(kRows + row));
+        got.emplace_back(r.at<U>(row), r.at<U>(kRows + row));
+      }
+      std::sort(expected.begin(), expected.end());
+      std::sort(got.begin(), got.end());
+      EXPECT_TRUE(expected == got);
+    });
+  });
+}
+
+TEST_P(ApiTest, RandS) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto obj = factory(conf, lctx);
+    if (!obj->hasKernel("rand_s")) {
+      return;
+    }
+
+    /* WHEN */
+    auto r0 = rand_s(obj.get(), conf.field(), kNumel);
+    auto r1 = rand_s(obj.get(), conf.field(), kNumel);
+
+    /* THEN */
+    // two draws differ.
+    auto p0 = s2p(obj.get(), r0);
+    auto p1 = s2p(obj.get(), r1);
+    EXPECT_FALSE(ring_all_equal(p0, p1));
+    EXPECT_FALSE(ring_all_equal(p0, ring_zeros(conf.field(), kNumel)));
+  });
+}
+
 }  // namespace spu::mpc::test
@@ -14,6 +14,12 @@
 
 #pragma once
 
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "yacl/base/exception.h"
+
 #include "spu/core/array_ref.h"
 
 namespace spu::mpc {
@@ -32,6 +38,27 @@ class Beaver {
 
   virtual Triple Dot(FieldType field, size_t M, size_t N, size_t K) = 0;
 
+  // `batch` independent Dot triples, stacked in order, i.e. the b-th triple
+  // is the b-th (M * K, K * N, M * N) slices of the arrays.
+  virtual Triple BatchDot(FieldType field, size_t batch, size_t M, size_t N,
+                          size_t K) {
+    YACL_ENFORCE(batch > 0);
+    std::vector<ArrayRef> as;
+    std::vector<ArrayRef> bs;
+    std::vector<ArrayRef> cs;
+    for (size_t idx = 0; idx < batch; idx++) {
+      auto [a, b, c] = Dot(field, M, N, K);
+      as.push_back(std::move(a));
+      bs.push_back(std::move(b));
+      cs.push_back(std::move(c));
+    }
+    auto concat = [](std::vector<ArrayRef>& arrs) {
+      SimdTrait<ArrayRef>::PackInfo pi;
+      return SimdTrait<ArrayRef>::pack(arrs.begin(), arrs.end(), pi);
+    };
+    return {concat(as), concat(bs), concat(cs)};
+  }
+
   // out.b = out.a >> bits, only for TruncateABY3.
   virtual bool SupportTrunc() { return true; }
   virtual Pair Trunc(FieldType field, size_t size, size_t bits) = 0;
@@ -39,6 +66,19 @@ class Beaver {
   // Return size of random bits, with given field.
   virtual bool SupportRandBit() { return true; }
   virtual ArrayRef RandBit(FieldType field, size_t size) = 0;
+
+  // Permutation correlation of a `rows` x `cols` column-major matrix, the
+  // same random permutation `perm` is applied to each column.
+  //
+  // - party `perm_rank` gets ({}, delta) and `perm`.
+  // - other party j gets (a_j, b_j).
+  //
+  // where delta = perm(sum(a_j)) - sum(b_j).
+  virtual bool SupportPerm() { return false; }
+  virtual Pair Perm(FieldType field, size_t rows, size_t cols,
+                    size_t perm_rank, std::vector<int64_t>* perm) {
+    YACL_THROW("permutation correlation not supported");
+  }
 };
 
 }  // namespace spu::mpc
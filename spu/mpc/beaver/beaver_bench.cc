@@ -0,0 +1,104 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+#include "benchmark/benchmark.h"
+#include "spdlog/spdlog.h"
+#include "yacl/link/test_util.h"
+
+#include "spu/mpc/beaver/beaver_tfp.h"
+#include "spu/mpc/beaver/beaver_ttp.h"
+
+namespace spu::mpc {
+namespace {
+
+enum class Mode : int64_t {
+  Tfp = 0,
+  Ttp = 1,
+  TtpBatch = 2,
+};
+
+// The random bits consumed by b2a of 2 parties on 64 bits arrays of `numel`,
+// 64 calls in a row, each requests numel * 64 bits, see semi2k B2A_Randbit.
+void BM_B2ARandBit(benchmark::State& state) {
+  const auto mode = static_cast<Mode>(state.range(0));
+  const size_t numel = state.range(1);
+  const size_t calls = 64;
+  const size_t kWorldSize = 2;
+  const FieldType kField = FieldType::FM64;
+  const size_t kBits = 64;
+  const size_t kBatch = 1UL << 20;
+
+  for (auto _ : state) {
+    // the last rank is the server, unused by tfp.
+    auto lctxs = yacl::link::test::SetupWorld("bench", kWorldSize + 1);
+    auto tfp_lctxs = yacl::link::test::SetupWorld("bench_tfp", kWorldSize);
+    TrustedPartyServer server;
+    if (mode != Mode::Tfp) {
+      server.AddSession(lctxs[kWorldSize]);
+    }
+
+    std::vector<std::future<double>> futures;
+    for (size_t rank = 0; rank < kWorldSize; rank++) {
+      futures.push_back(std::async([&, rank]() {
+        std::unique_ptr<Beaver> beaver;
+        if (mode == Mode::Tfp) {
+          beaver = std::make_unique<BeaverTfpUnsafe>(tfp_lctxs[rank]);
+        } else {
+          beaver = std::make_unique<BeaverTtp>(
+              lctxs[rank], mode == Mode::TtpBatch ? kBatch : 0);
+        }
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (size_t idx = 0; idx < calls; idx++) {
+          benchmark::DoNotOptimize(beaver->RandBit(kField, numel * kBits));
+        }
+        return std::chrono::duration<double>(
+                   std::chrono::high_resolution_clock::now() - start)
+            .count();
+      }));
+    }
+    double seconds = 0;
+    for (auto& future : futures) {
+      seconds = std::max(seconds, future.get());
+    }
+    server.Wait();
+    state.SetIterationTime(seconds);
+  }
+}
+
+BENCHMARK(BM_B2ARandBit)
+    ->ArgsProduct({
+        {static_cast<int64_t>(Mode::Tfp), static_cast<int64_t>(Mode::Ttp),
+         static_cast<int64_t>(Mode::TtpBatch)},
+        {1, 16, 256, 4096},  // numel
+    })
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace spu::mpc
+
+int main(int argc, char** argv) {
+  // suppress all link logs.
+  spdlog::set_level(spdlog::level::off);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -15,8 +15,11 @@
 
 #include <future>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <unordered_map>
 
+#include "absl/numeric/bits.h"
 #include "absl/types/span.h"
 #include "seal/batchencoder.h"
 #include "seal/context.h"
@@ -33,10 +36,12 @@
 #include "spdlog/spdlog.h"
 #include "xtensor/xvectorize.hpp"
 #include "xtensor/xview.hpp"
+#include "yacl/crypto/utils/hash_util.h"
 #include "yacl/link/link.h"
 #include "yacl/utils/parallel.h"
 
 #include "spu/core/xt_helper.h"
+#include "spu/mpc/beaver/cheetah_key_cache.h"
 #include "spu/mpc/beaver/cheetah/lwe_decryptor.h"
 #include "spu/mpc/beaver/cheetah/matvec.h"
 #include "spu/mpc/beaver/cheetah/modswitch_helper.h"
@@ -71,6 +76,72 @@ static void TransposeInplace(ArrayRef mat, size_t nrows, size_t ncols) {
   });
 }
 
+// The cached keys of `purpose` if both parties have the keys of each other
+// of `epoch`, agreed by the digests of both public keys.
+static std::optional<CheetahKeyCache::Entry> AgreeCachedKeys(
+    yacl::link::Context *conn, const std::string &epoch,
+    const std::string &purpose) {
+  auto entry = CheetahKeyCache::instance().get(
+      epoch, CheetahKeyCache::makeKey(*conn, purpose));
+  std::string digest;
+  if (entry) {
+    const bool is_first = conn->Rank() == 0;
+    const auto &first = is_first ? entry->public_key : entry->peer_public_key;
+    const auto &second = is_first ? entry->peer_public_key : entry->public_key;
+    std::string keys(first.data<char>(), first.size());
+    keys.append(second.data<char>(), second.size());
+    auto hash = yacl::crypto::Sha256(keys);
+    digest.assign(reinterpret_cast<const char *>(hash.data()), hash.size());
+  }
+
+  int nxt_rank = conn->NextRank();
+  conn->SendAsync(nxt_rank, yacl::Buffer(digest.data(), digest.size()),
+                  "send key digest");
+  auto peer_digest = conn->Recv(nxt_rank, "recv key digest");
+  if (!entry ||
+      digest != std::string_view(peer_digest.data<char>(),
+                                 peer_digest.size())) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+// Generate the secret key of `context` and exchange the public keys with the
+// peer. When `epoch` is not empty, the keys of `purpose` cached by an earlier
+// session are reused instead if both parties have them.
+static void SetupKeys(yacl::link::Context *conn,
+                      const seal::SEALContext &context,
+                      const std::string &epoch, const std::string &purpose,
+                      seal::SecretKey *secret_key,
+                      seal::PublicKey *pair_public_key) {
+  if (!epoch.empty()) {
+    if (auto cached = AgreeCachedKeys(conn, epoch, purpose)) {
+      DecodeSEALObject(cached->secret_key, context, secret_key);
+      DecodeSEALObject(cached->peer_public_key, context, pair_public_key);
+      return;
+    }
+  }
+
+  seal::KeyGenerator keygen(context);
+  *secret_key = keygen.secret_key();
+
+  auto pk = keygen.create_public_key();
+  // NOTE(juhou): we patched seal/util/serializable.h
+  auto pk_buf = EncodeSEALObject(pk.obj());
+  // exchange the public key
+  int nxt_rank = conn->NextRank();
+  conn->SendAsync(nxt_rank, pk_buf, "send Pk");
+  auto pair_pk_buf = conn->Recv(nxt_rank, "recv pk");
+  DecodeSEALObject(pair_pk_buf, context, pair_public_key);
+
+  if (!epoch.empty()) {
+    CheetahKeyCache::instance().put(
+        epoch, CheetahKeyCache::makeKey(*conn, purpose),
+        {EncodeSEALObject(*secret_key), std::move(pk_buf),
+         std::move(pair_pk_buf)});
+  }
+}
+
 struct EnablePRNG {
   explicit EnablePRNG() : seed_(GetHardwareRandom128()), prng_counter_(0) {}
 
@@ -124,8 +195,8 @@ struct BeaverCheetah::MulImpl : public EnablePRNG {
   static constexpr int kNoiseFloodRandomBits = 50;
   static constexpr size_t kParallelGrain = 1;
 
-  MulImpl(std::shared_ptr<yacl::link::Context> lctx)
-      : EnablePRNG(), lctx_(lctx) {
+  MulImpl(std::shared_ptr<yacl::link::Context> lctx, std::string key_epoch)
+      : EnablePRNG(), lctx_(lctx), key_epoch_(std::move(key_epoch)) {
     parms_ = DecideSEALParameters(kSmallPrimeBitLen);
   }
 
@@ -234,6 +305,9 @@ struct BeaverCheetah::MulImpl : public EnablePRNG {
  private:
   std::shared_ptr<yacl::link::Context> lctx_;
 
+  // reuse the keys of this epoch if not empty.
+  std::string key_epoch_;
+
   seal::EncryptionParameters parms_;
 
   uint32_t current_crt_plain_bitlen_{0};
@@ -320,18 +394,12 @@ void BeaverCheetah::MulImpl::LazyExpandSEALContexts(uint32_t field_bitlen,
     seal_cntxts_.emplace_back(parms_, true, seal::sec_level_type::tc128);
 
     if (pair_public_key_ == nullptr) {
-      seal::KeyGenerator keygen(seal_cntxts_[0]);
-      secret_key_ = std::make_shared<seal::SecretKey>(keygen.secret_key());
-
-      auto pk = keygen.create_public_key();
-      // NOTE(juhou): we patched seal/util/serializable.h
-      auto pk_buf = EncodeSEALObject(pk.obj());
-      // exchange the public key
-      int nxt_rank = conn->NextRank();
-      conn->SendAsync(nxt_rank, pk_buf, "send Pk");
-      pk_buf = conn->Recv(nxt_rank, "recv pk");
+      secret_key_ = std::make_shared<seal::SecretKey>();
       pair_public_key_ = std::make_shared<seal::PublicKey>();
-      DecodeSEALObject(pk_buf, seal_cntxts_[0], pair_public_key_.get());
+      // keys of the first context depend on the plain modulus of it.
+      SetupKeys(conn, seal_cntxts_[0], key_epoch_,
+                fmt::format("mul:{}", target_plain_bitlen), secret_key_.get(),
+                pair_public_key_.get());
 
       // create the functors
       sym_encryptors_.push_back(
@@ -765,11 +833,21 @@ void BeaverCheetah::MulImpl::RandomizeCipherForDecryption(RLWECt &ct,
 
 struct BeaverCheetah::DotImpl : public EnablePRNG {
  public:
-  DotImpl(std::shared_ptr<yacl::link::Context> lctx)
-      : EnablePRNG(), lctx_(lctx) {}
+  static constexpr size_t kParallelGrain = 1;
+  // number of items whose matvecs are in flight together
+  static constexpr size_t kBatchSize = 16;
+
+  DotImpl(std::shared_ptr<yacl::link::Context> lctx, std::string key_epoch)
+      : EnablePRNG(), lctx_(lctx), key_epoch_(std::move(key_epoch)) {}
 
   // Compute C = A*B where |A|=M*K, |B|=K*N
-  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K);
+  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) {
+    return BatchDot(field, 1, M, N, K);
+  }
+
+  // `batch` triples of Dot, stacked in order.
+  Beaver::Triple BatchDot(FieldType field, size_t batch, size_t M, size_t N,
+                          size_t K);
 
   seal::EncryptionParameters DecideSEALParameters(uint32_t ring_bitlen) {
     size_t poly_deg;
@@ -836,14 +914,17 @@ struct BeaverCheetah::DotImpl : public EnablePRNG {
     YACL_ENFORCE(rnd_mask != nullptr);
 
     rnd_mask->resize(num_poly);
-    for (size_t idx = 0; idx < num_poly; ++idx) {
-      auto &rnd = rnd_mask->at(idx);
-      UniformPoly(rnd, context);
-      if (ct[idx].is_ntt_form()) {
-        NttInplace(rnd, context);
-      }
-      AddPlainInplace(ct[idx], rnd, context);
-    }
+    yacl::parallel_for(
+        0, num_poly, kParallelGrain, [&](size_t bgn, size_t end) {
+          for (size_t idx = bgn; idx < end; ++idx) {
+            auto &rnd = rnd_mask->at(idx);
+            UniformPoly(rnd, context);
+            if (ct[idx].is_ntt_form()) {
+              NttInplace(rnd, context);
+            }
+            AddPlainInplace(ct[idx], rnd, context);
+          }
+        });
   }
 
   void RandomizeCipherForDecryption(std::vector<RLWECt> &ct_array,
@@ -862,6 +943,9 @@ struct BeaverCheetah::DotImpl : public EnablePRNG {
  private:
   std::shared_ptr<yacl::link::Context> lctx_;
 
+  // reuse the keys of this epoch if not empty.
+  std::string key_epoch_;
+
   mutable std::shared_mutex context_lock_;
   // field_bitlen -> functor mapping
   std::unordered_map<size_t, std::shared_ptr<seal::SEALContext>> seal_cntxts_;
@@ -885,18 +969,11 @@ void BeaverCheetah::DotImpl::LazyInit(size_t field_bitlen) {
   auto parms = DecideSEALParameters(field_bitlen);
   auto this_context =
       new seal::SEALContext(parms, true, seal::sec_level_type::none);
-  seal::KeyGenerator keygen(*this_context);
-  auto rlwe_sk = new seal::SecretKey(keygen.secret_key());
-
-  auto pk = keygen.create_public_key();
-  // NOTE(juhou): we patched seal/util/serializable.h
-  auto pk_buf = EncodeSEALObject(pk.obj());
-  // exchange the public key
-  int nxt_rank = lctx_->NextRank();
-  lctx_->SendAsync(nxt_rank, pk_buf, "send Pk");
-  pk_buf = lctx_->Recv(nxt_rank, "recv pk");
+  auto rlwe_sk = new seal::SecretKey();
   auto pair_public_key = std::make_shared<seal::PublicKey>();
-  DecodeSEALObject(pk_buf, *this_context, pair_public_key.get());
+  SetupKeys(lctx_.get(), *this_context, key_epoch_,
+            fmt::format("dot:{}", field_bitlen), rlwe_sk,
+            pair_public_key.get());
 
   auto modulus = parms.coeff_modulus();
   if (parms.use_special_prime()) {
@@ -921,9 +998,9 @@ void BeaverCheetah::DotImpl::LazyInit(size_t field_bitlen) {
               modulus.size(), parms.poly_modulus_degree(), field_bitlen);
 }
 
-// Compute C = A*B where |A|=M*K, |B|=K*N
-Beaver::Triple BeaverCheetah::DotImpl::Dot(FieldType field, size_t M, size_t N,
-                                           size_t K) {
+// Compute C_b = A_b*B_b where |A_b|=M*K, |B_b|=K*N, for b in [0, batch)
+Beaver::Triple BeaverCheetah::DotImpl::BatchDot(FieldType field, size_t batch,
+                                                size_t M, size_t N, size_t K) {
   const size_t field_bitlen = FieldBitLen(field);
   LazyInit(field_bitlen);
   const auto &this_context = *seal_cntxts_.find(field_bitlen)->second;
@@ -939,125 +1016,294 @@ Beaver::Triple BeaverCheetah::DotImpl::Dot(FieldType field, size_t M, size_t N,
   const size_t lhs_nrows = std::max(M, N);
   const size_t loop_dim = std::min(M, N);
   const int nxt_rank = lctx_->NextRank();
+  // sizes of one matrix of the batch
+  const size_t lhs_size = lhs_nrows * K;
+  const size_t rhs_size = loop_dim * K;
+  const size_t ans_size = loop_dim * lhs_nrows;
+
+  // To compute lhs_mat * rhs_mat = ans_mat + mask_mat for every matrix
+  auto lhs_mat = CPRNG(field, batch * lhs_size);
+  auto rhs_mat = CPRNG(field, batch * rhs_size);
+  auto ans_mat = ring_zeros(field, batch * ans_size);
+  auto mask_mat = ring_zeros(field, batch * ans_size);
+
+  // Small matrices are packed by groups. A group of g matrices is encoded as
+  // one block diagonal matrix of (g * lhs_nrows, g * K), and multiplied by
+  // the concatenated columns of the group, so the g matvecs share the
+  // plaintexts and ciphertexts instead of one poorly packed set per matrix.
+  // g is bounded so the block diagonal matrix fits one plaintext, i.e. the
+  // zero blocks cost no extra ciphertext.
+  const size_t poly_deg = matvec_prot.poly_degree();
+  auto fits = [&](size_t g) {
+    return absl::bit_ceil(g * lhs_nrows) * g * K <= poly_deg;
+  };
+  size_t group = 1;
+  while (group < batch && fits(group + 1)) {
+    group++;
+  }
+  const size_t num_groups = CeilDiv(batch, group);
+  auto group_size = [&](size_t g) {
+    return std::min(group, batch - g * group);
+  };
 
-  // To compute lhs_mat * rhs_mat = ans_mat + mask_mat
-  auto lhs_mat = CPRNG(field, lhs_nrows * K);
-  auto rhs_mat = CPRNG(field, loop_dim * K);
-  auto ans_mat = ring_zeros(field, loop_dim * lhs_nrows);
-  auto mask_mat = ring_zeros(field, loop_dim * lhs_nrows);
-
-  MatVecProtocol::Meta meta;
-  meta.nrows = lhs_nrows;
-  meta.ncols = K;
-
-  std::vector<RLWEPt> ecd_lhs_mat;
-  matvec_prot.EncodeMatrix(meta, lhs_mat, &ecd_lhs_mat);
+  std::vector<MatVecProtocol::Meta> metas(num_groups);
+  std::vector<std::vector<RLWEPt>> ecd_lhs_mats(num_groups);
+  for (size_t g = 0; g < num_groups; ++g) {
+    const size_t gsize = group_size(g);
+    metas[g].nrows = gsize * lhs_nrows;
+    metas[g].ncols = gsize * K;
+
+    auto diag_mat = lhs_mat.slice(g * group * lhs_size,
+                                  (g * group + gsize) * lhs_size);
+    if (gsize > 1) {
+      diag_mat = ring_zeros(field, metas[g].nrows * metas[g].ncols);
+      DISPATCH_ALL_FIELDS(field, "BatchDot-0", [&]() {
+        auto xdiag = xt_mutable_adapt<ring2k_t>(diag_mat);
+        xdiag = xdiag.reshape({metas[g].nrows, metas[g].ncols});
+        for (size_t i = 0; i < gsize; ++i) {
+          const size_t b = g * group + i;
+          auto xlhs = xt_adapt<ring2k_t>(
+              lhs_mat.slice(b * lhs_size, (b + 1) * lhs_size));
+          xlhs = xlhs.reshape({lhs_nrows, K});
+          xt::view(xdiag, xt::range(i * lhs_nrows, (i + 1) * lhs_nrows),
+                   xt::range(i * K, (i + 1) * K)) = xlhs;
+        }
+      });
+    }
+    matvec_prot.EncodeMatrix(metas[g], diag_mat, &ecd_lhs_mats[g]);
+  }
 
-  std::vector<RLWEPt> ecd_vec;
-  std::vector<RLWECt> enc_vec;
+  // An item is a column of all matrices of a group, the rhs columns of the
+  // group are concatenated, and so are the products.
+  const size_t num_items = num_groups * loop_dim;
+  auto item_vector = [&](size_t item) {
+    const size_t g = item / loop_dim;
+    const size_t n = item % loop_dim;
+    std::vector<ArrayRef> cols;
+    for (size_t i = 0; i < group_size(g); ++i) {
+      const size_t offset = (g * group + i) * rhs_size + n * K;
+      cols.push_back(rhs_mat.slice(offset, offset + K));
+    }
+    SimdTrait<ArrayRef>::PackInfo pi;
+    return SimdTrait<ArrayRef>::pack(cols.begin(), cols.end(), pi);
+  };
+  // scatter the product of an item to the n-th rows of the matrices.
+  auto scatter_item = [&](ArrayRef &dst, size_t item, const ArrayRef &prod) {
+    const size_t g = item / loop_dim;
+    const size_t n = item % loop_dim;
+    DISPATCH_ALL_FIELDS(field, "BatchDot-1", [&]() {
+      auto xprod = xt_adapt<ring2k_t>(prod);
+      for (size_t i = 0; i < group_size(g); ++i) {
+        const size_t b = g * group + i;
+        auto dst_b = dst.slice(b * ans_size, (b + 1) * ans_size);
+        auto xdst = xt_mutable_adapt<ring2k_t>(dst_b);
+        xdst = xdst.reshape({loop_dim, lhs_nrows});
+        xt::row(xdst, n) =
+            xt::view(xprod, xt::range(i * lhs_nrows, (i + 1) * lhs_nrows));
+      }
+    });
+  };
 
   // FIXME: sendAsync may blocking when concurrent sending task exceed
   // `ThrottleWindowSize`, so temporary disable the window, but there's no API
   // to recover it back.
   lctx_->SetThrottleWindowSize(0);
 
-  for (size_t n = 0; n < loop_dim; ++n) {
-    auto rhs_slice = rhs_mat.slice(n * K, n * K + K);
-    matvec_prot.EncodeVector(meta, rhs_slice, &ecd_vec);
-    enc_vec.resize(ecd_vec.size());
+  // The items are handled in batches of kBatchSize. Within a batch, the
+  // encryption, the matvec and the decryption of each item run across the
+  // thread pool. The vectors of the next batch are encrypted and sent before
+  // computing on the current one, so that the peer could start on them while
+  // we are busy. Both parties send and receive in the order
+  //   V0, V1, P0, V2, P1, ...
+  // where Vb are the encrypted vectors and Pb the masked products of batch b.
+  const size_t num_batches = CeilDiv(num_items, kBatchSize);
+  auto batch_begin = [&](size_t b) { return b * kBatchSize; };
+  auto batch_end = [&](size_t b) {
+    return std::min(num_items, (b + 1) * kBatchSize);
+  };
+  // number of ciphertexts of the encrypted vector and the product of an item,
+  // the same for both parties.
+  std::vector<size_t> vec_sizes(num_items);
+  std::vector<size_t> prod_sizes(num_items);
+
+  auto send_vectors = [&](size_t b) {
+    const size_t bgn = batch_begin(b);
+    std::vector<std::vector<yacl::Buffer>> payloads(batch_end(b) - bgn);
+    yacl::parallel_for(
+        bgn, batch_end(b), kParallelGrain, [&](size_t i_bgn, size_t i_end) {
+          std::vector<RLWEPt> ecd_vec;
+          for (size_t item = i_bgn; item < i_end; ++item) {
+            const auto &meta = metas[item / loop_dim];
+            matvec_prot.EncodeVector(meta, item_vector(item), &ecd_vec);
+            auto &payload = payloads[item - bgn];
+            payload.resize(ecd_vec.size());
+            for (size_t idx = 0; idx < ecd_vec.size(); ++idx) {
+              NttInplace(ecd_vec[idx], this_context);
+              auto ct = this_encryptor->encrypt_symmetric(ecd_vec[idx]).obj();
+              payload[idx] = EncodeSEALObject(ct);
+            }
+            vec_sizes[item] = payload.size();
+          }
+        });
 
-    // send encrypted to the peer
-    for (size_t idx = 0; idx < ecd_vec.size(); ++idx) {
-      NttInplace(ecd_vec[idx], this_context);
-      auto ct = this_encryptor->encrypt_symmetric(ecd_vec[idx]).obj();
-      lctx_->SendAsync(nxt_rank, EncodeSEALObject(ct), "");
+    for (auto &payload : payloads) {
+      for (auto &ct : payload) {
+        lctx_->SendAsync(nxt_rank, ct, "");
+      }
     }
+  };
 
-    // recv encrypted vector from the peer
-    for (size_t idx = 0; idx < ecd_vec.size(); ++idx) {
-      auto payload = lctx_->Recv(nxt_rank, "");
-      DecodeSEALObject(payload, this_context, enc_vec.data() + idx);
+  // Receive `counts[item]` ciphertexts for each item of the batch, the
+  // decoding runs in parallel after all of them are arrived.
+  auto recv_ciphers = [&](size_t b, const std::vector<size_t> &counts) {
+    const size_t bgn = batch_begin(b);
+    const size_t num_cols = batch_end(b) - bgn;
+    std::vector<std::vector<yacl::Buffer>> payloads(num_cols);
+    for (size_t c = 0; c < num_cols; ++c) {
+      payloads[c].resize(counts[bgn + c]);
+      for (auto &payload : payloads[c]) {
+        payload = lctx_->Recv(nxt_rank, "");
+      }
     }
 
-    // M_a, [v_b] -> [M_a * v_b]
-    std::vector<RLWECt> prod;
-    matvec_prot.MatVecNoExtract(meta, ecd_lhs_mat, enc_vec, &prod);
-
-    // Re-sharing the matvec product homomorphically
-    std::vector<RLWEPt> rnd_masks(prod.size());
-    H2A(prod, this_context, &rnd_masks);
-    // NOTE(juhou): the random mask is sampled from the whole ciphertext
-    // modulus We need to cast it down to mod 2^k using `ParseMatVecResult`
-    DISPATCH_ALL_FIELDS(field, "Dot-1", [&]() {
-      auto xmask_mat = xt_mutable_adapt<ring2k_t>(mask_mat);
-      auto xans_mat = xt_mutable_adapt<ring2k_t>(ans_mat);
-      xmask_mat = xmask_mat.reshape({loop_dim, lhs_nrows});
-      xans_mat = xans_mat.reshape({loop_dim, lhs_nrows});
-
-      xt::row(xmask_mat, n) = xt_adapt<ring2k_t>(
-          matvec_prot.ParseMatVecResult(field, meta, rnd_masks));
-    });
+    std::vector<std::vector<RLWECt>> ciphers(num_cols);
+    yacl::parallel_for(
+        0, num_cols, kParallelGrain, [&](size_t c_bgn, size_t c_end) {
+          for (size_t c = c_bgn; c < c_end; ++c) {
+            ciphers[c].resize(payloads[c].size());
+            for (size_t idx = 0; idx < payloads[c].size(); ++idx) {
+              DecodeSEALObject(payloads[c][idx], this_context,
+                               ciphers[c].data() + idx);
+            }
+          }
+        });
+    return ciphers;
+  };
 
-    // Before sending the masked matvec product, we need to re-randomize the
-    // ciphertext via adding fresh encryption of zero.
-    RandomizeCipherForDecryption(prod, *this_pk_encryptor, evaluator);
-    // Also, we need to clean up unused coefficients.
-    // `ExtractLWEsInplace` should be placed **after**
-    // `RandomizeCipherForDecryption` for a smaller communication cost.
-    matvec_prot.ExtractLWEsInplace(meta, prod);
+  std::vector<std::vector<RLWECt>> enc_vecs;
+  if (num_batches > 0) {
+    send_vectors(0);
+    enc_vecs = recv_ciphers(0, vec_sizes);
+  }
+
+  for (size_t b = 0; b < num_batches; ++b) {
+    const size_t bgn = batch_begin(b);
+    const size_t num_cols = batch_end(b) - bgn;
+
+    if (b + 1 < num_batches) {
+      send_vectors(b + 1);
+    }
+
+    std::vector<std::vector<yacl::Buffer>> response(num_cols);
+    yacl::parallel_for(
+        0, num_cols, kParallelGrain, [&](size_t c_bgn, size_t c_end) {
+          for (size_t c = c_bgn; c < c_end; ++c) {
+            const size_t item = bgn + c;
+            const auto g = item / loop_dim;
+            const auto &meta = metas[g];
+            // M_a, [v_b] -> [M_a * v_b]
+            std::vector<RLWECt> prod;
+            matvec_prot.MatVecNoExtract(meta, ecd_lhs_mats[g], enc_vecs[c],
+                                        &prod);
+
+            // Re-sharing the matvec product homomorphically
+            std::vector<RLWEPt> rnd_masks(prod.size());
+            H2A(prod, this_context, &rnd_masks);
+            // NOTE(juhou): the random mask is sampled from the whole
+            // ciphertext modulus We need to cast it down to mod 2^k using
+            // `ParseMatVecResult`
+            scatter_item(mask_mat, item,
+                         matvec_prot.ParseMatVecResult(field, meta, rnd_masks));
+
+            // Before sending the masked matvec product, we need to
+            // re-randomize the ciphertext via adding fresh encryption of zero.
+            RandomizeCipherForDecryption(prod, *this_pk_encryptor, evaluator);
+            // Also, we need to clean up unused coefficients.
+            // `ExtractLWEsInplace` should be placed **after**
+            // `RandomizeCipherForDecryption` for a smaller communication cost.
+            matvec_prot.ExtractLWEsInplace(meta, prod);
+
+            response[c].resize(prod.size());
+            for (size_t idx = 0; idx < prod.size(); ++idx) {
+              response[c][idx] = EncodeSEALObject(prod[idx]);
+            }
+            prod_sizes[item] = prod.size();
+          }
+        });
 
     // send the masked product to the peer
-    for (size_t idx = 0; idx < prod.size(); ++idx) {
-      lctx_->SendAsync(nxt_rank, EncodeSEALObject(prod[idx]), "");
+    for (auto &payload : response) {
+      for (auto &ct : payload) {
+        lctx_->SendAsync(nxt_rank, ct, "");
+      }
     }
-    // recv RLWE vector from the peer
-    for (size_t idx = 0; idx < prod.size(); ++idx) {
-      auto payload = lctx_->Recv(nxt_rank, "");
-      DecodeSEALObject(payload, this_context, prod.data() + idx);
+
+    if (b + 1 < num_batches) {
+      enc_vecs = recv_ciphers(b + 1, vec_sizes);
     }
+    // recv RLWE vector from the peer
+    auto prods = recv_ciphers(b, prod_sizes);
 
     // Finally, decrypt the RLWEs and parse some of the coefficients as the
     // matvec result.
-    for (size_t idx = 0; idx < prod.size(); ++idx) {
-      evaluator.transform_to_ntt_inplace(prod[idx]);
-      // re-use the RLWEPt array
-      this_decryptor->decrypt(prod[idx], rnd_masks[idx]);
-      InvNttInplace(rnd_masks[idx], this_context);
-    }
+    yacl::parallel_for(
+        0, num_cols, kParallelGrain, [&](size_t c_bgn, size_t c_end) {
+          std::vector<RLWEPt> pts;
+          for (size_t c = c_bgn; c < c_end; ++c) {
+            const size_t item = bgn + c;
+            pts.resize(prods[c].size());
+            for (size_t idx = 0; idx < prods[c].size(); ++idx) {
+              evaluator.transform_to_ntt_inplace(prods[c][idx]);
+              this_decryptor->decrypt(prods[c][idx], pts[idx]);
+              InvNttInplace(pts[idx], this_context);
+            }
 
-    // r_b := M_a * v_b + r_a
-    DISPATCH_ALL_FIELDS(field, "Dot-2", [&]() {
-      auto xans_mat = xt_mutable_adapt<ring2k_t>(ans_mat);
-      xans_mat = xans_mat.reshape({loop_dim, lhs_nrows});
-      xt::row(xans_mat, n) = xt_adapt<ring2k_t>(
-          matvec_prot.ParseMatVecResult(field, meta, rnd_masks));
-    });
-  }  // end loop_dim
-
-  if (M == lhs_nrows) {
-    // A = lhs_mat
-    // B = rhs_mat^T
-    // C = ans_mat^T
-    TransposeInplace(rhs_mat, loop_dim, K);
-    TransposeInplace(ans_mat, loop_dim, lhs_nrows);
-    TransposeInplace(mask_mat, loop_dim, lhs_nrows);
-  } else {
-    // A = rhs_mat
-    // B = lhs_mat^T,
-    // C = ans_mat
-    TransposeInplace(lhs_mat, lhs_nrows, K);
+            // r_b := M_a * v_b + r_a
+            scatter_item(
+                ans_mat, item,
+                matvec_prot.ParseMatVecResult(
+                    field, metas[item / loop_dim], pts));
+          }
+        });
+  }  // end num_items
+
+  for (size_t b = 0; b < batch; ++b) {
+    auto lhs_b = lhs_mat.slice(b * lhs_size, (b + 1) * lhs_size);
+    auto rhs_b = rhs_mat.slice(b * rhs_size, (b + 1) * rhs_size);
+    auto ans_b = ans_mat.slice(b * ans_size, (b + 1) * ans_size);
+    auto mask_b = mask_mat.slice(b * ans_size, (b + 1) * ans_size);
+    if (M == lhs_nrows) {
+      // A = lhs_mat
+      // B = rhs_mat^T
+      // C = ans_mat^T
+      TransposeInplace(rhs_b, loop_dim, K);
+      TransposeInplace(ans_b, loop_dim, lhs_nrows);
+      TransposeInplace(mask_b, loop_dim, lhs_nrows);
+      ring_add_(ans_b, ring_sub(ring_mmul(lhs_b, rhs_b, M, N, K), mask_b));
+    } else {
+      // A = rhs_mat
+      // B = lhs_mat^T,
+      // C = ans_mat
+      TransposeInplace(lhs_b, lhs_nrows, K);
+      ring_add_(ans_b, ring_sub(ring_mmul(rhs_b, lhs_b, M, N, K), mask_b));
+    }
+  }
+  if (M != lhs_nrows) {
     std::swap(lhs_mat, rhs_mat);
   }
 
-  ans_mat = ring_add(ans_mat,
-                     ring_sub(ring_mmul(lhs_mat, rhs_mat, M, N, K), mask_mat));
-
   return {lhs_mat, rhs_mat, ans_mat};
 }
-BeaverCheetah::BeaverCheetah(std::shared_ptr<yacl::link::Context> lctx)
-    : mul_impl_(std::make_shared<MulImpl>(lctx)),
-      dot_impl_(std::make_shared<DotImpl>(lctx)) {
-  ot_primitives_ = std::make_shared<spu::CheetahPrimitives>(lctx);
+BeaverCheetah::BeaverCheetah(std::shared_ptr<yacl::link::Context> lctx,
+                             std::string key_epoch)
+    : mul_impl_(std::make_shared<MulImpl>(lctx, key_epoch)),
+      dot_impl_(std::make_shared<DotImpl>(lctx, key_epoch)),
+      lctx_(std::move(lctx)) {}
+
+void BeaverCheetah::LazyInitOT() const {
+  std::call_once(ot_once_, [&]() {
+    ot_primitives_ = std::make_shared<spu::CheetahPrimitives>(lctx_);
+  });
 }
 
 Beaver::Triple BeaverCheetah::Mul(FieldType field, size_t size) {
@@ -1065,6 +1311,56 @@ Beaver::Triple BeaverCheetah::Mul(FieldType field, size_t size) {
   return mul_impl_->Mul(field, size);
 }
 
+size_t BeaverCheetah::MulPackSize() const {
+  yacl::CheckNotNull(mul_impl_.get());
+  return mul_impl_->num_slots();
+}
+
+void BeaverCheetah::RefillPackedTriples(FieldType field, size_t size) {
+  const size_t pack_size = MulPackSize();
+  auto [a, b, c] = mul_impl_->Mul(field, CeilDiv(size, pack_size) * pack_size);
+
+  auto &triples = packed_triples_[field];
+  if (triples.a.numel() == triples.consumed) {
+    triples = {std::move(a), std::move(b), std::move(c), 0};
+    return;
+  }
+
+  // keep the unconsumed triples before the fresh ones.
+  auto concat = [&](const ArrayRef &prev, const ArrayRef &fresh) {
+    std::vector<ArrayRef> pieces = {
+        prev.slice(triples.consumed, prev.numel()), fresh};
+    SimdTrait<ArrayRef>::PackInfo pi;
+    return SimdTrait<ArrayRef>::pack(pieces.begin(), pieces.end(), pi);
+  };
+  triples = {concat(triples.a, a), concat(triples.b, b),
+             concat(triples.c, c), 0};
+}
+
+void BeaverCheetah::PrefetchMul(FieldType field, size_t size) {
+  yacl::CheckNotNull(mul_impl_.get());
+  YACL_ENFORCE(size > 0);
+  std::scoped_lock guard(packed_mutex_);
+  RefillPackedTriples(field, size);
+}
+
+Beaver::Triple BeaverCheetah::PackedMul(FieldType field, size_t size) {
+  yacl::CheckNotNull(mul_impl_.get());
+  YACL_ENFORCE(size > 0);
+  std::scoped_lock guard(packed_mutex_);
+  auto &triples = packed_triples_[field];
+  const int64_t avail = triples.a.numel() - triples.consumed;
+  if (avail < static_cast<int64_t>(size)) {
+    RefillPackedTriples(field, size - avail);
+  }
+
+  const int64_t begin = triples.consumed;
+  const int64_t end = begin + static_cast<int64_t>(size);
+  triples.consumed = end;
+  return {triples.a.slice(begin, end), triples.b.slice(begin, end),
+          triples.c.slice(begin, end)};
+}
+
 ArrayRef BeaverCheetah::MulAShr(const ArrayRef &shr, yacl::link::Context *conn,
                                 bool evaluator) {
   yacl::CheckNotNull(mul_impl_.get());
@@ -1077,8 +1373,14 @@ Beaver::Triple BeaverCheetah::Dot(FieldType field, size_t M, size_t N,
   return dot_impl_->Dot(field, M, N, K);
 }
 
+Beaver::Triple BeaverCheetah::BatchDot(FieldType field, size_t batch, size_t M,
+                                       size_t N, size_t K) {
+  yacl::CheckNotNull(dot_impl_.get());
+  return dot_impl_->BatchDot(field, batch, M, N, K);
+}
+
 Beaver::Triple BeaverCheetah::And(FieldType field, size_t size) {
-  yacl::CheckNotNull(ot_primitives_.get());
+  LazyInitOT();
 
   ArrayRef a(makeType<RingTy>(field), size);
   ArrayRef b(makeType<RingTy>(field), size);
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <string>
+
 #include "yacl/link/context.h"
 
 #include "spu/crypto/ot/silent/primitives.h"
@@ -44,27 +48,74 @@ class BeaverCheetah : public Beaver {
 
   std::shared_ptr<DotImpl> dot_impl_;
 
-  std::shared_ptr<spu::CheetahPrimitives> ot_primitives_{nullptr};
+  std::shared_ptr<yacl::link::Context> lctx_;
+
+  // the silent OT setup runs base OTs, so it is deferred to the first use.
+  mutable std::once_flag ot_once_;
+  mutable std::shared_ptr<spu::CheetahPrimitives> ot_primitives_{nullptr};
+
+  void LazyInitOT() const;
+
+  // Mul triples generated by fully packed ciphertexts but not consumed yet.
+  struct PackedTriples {
+    ArrayRef a;
+    ArrayRef b;
+    ArrayRef c;
+    int64_t consumed = 0;
+  };
+
+  std::mutex packed_mutex_;
+  std::map<FieldType, PackedTriples> packed_triples_;
+
+  // Append `size` fresh triples, rounded up to full ciphertexts, to the
+  // unconsumed ones. Called with `packed_mutex_` held.
+  void RefillPackedTriples(FieldType field, size_t size);
 
   friend class cheetah::MulAA;
   ArrayRef MulAShr(const ArrayRef& shr, yacl::link::Context* conn,
                    bool evaluator);
 
  public:
-  BeaverCheetah(std::shared_ptr<yacl::link::Context> lctx);
+  // When `key_epoch` is not empty, the HE keys are reused by sessions of the
+  // same peers and epoch in this process, see `CheetahKeyCache`.
+  explicit BeaverCheetah(std::shared_ptr<yacl::link::Context> lctx,
+                         std::string key_epoch = "");
 
+  // Both parties should call it at the same point on the first use.
   const spu::CheetahPrimitives* OTPrimitives() const {
+    LazyInitOT();
     return ot_primitives_.get();
   }
 
-  spu::CheetahPrimitives* OTPrimitives() { return ot_primitives_.get(); }
+  spu::CheetahPrimitives* OTPrimitives() {
+    LazyInitOT();
+    return ot_primitives_.get();
+  }
 
   Beaver::Triple Mul(FieldType field, size_t size) override;
 
+  // The number of elements packed by one ciphertext of Mul, a smaller Mul
+  // leaves most slots unused.
+  size_t MulPackSize() const;
+
+  // Generate at least `size` triples ahead for `PackedMul`.
+  void PrefetchMul(FieldType field, size_t size);
+
+  // Mul triples served from a buffer which is refilled by fully packed
+  // ciphertexts, so many small requests share the HE cost of one Mul.
+  //
+  // Note: both parties should request the same sizes in the same order.
+  Beaver::Triple PackedMul(FieldType field, size_t size);
+
   Beaver::Triple And(FieldType field, size_t size) override;
 
   Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
 
+  // Small matrices of the batch are packed together into the plaintexts and
+  // ciphertexts of one matvec protocol run.
+  Beaver::Triple BatchDot(FieldType field, size_t batch, size_t M, size_t N,
+                          size_t K) override;
+
   bool SupportTrunc() override { return false; }
   Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
 
@@ -14,8 +14,16 @@
 
 #include "spu/mpc/beaver/beaver_cheetah.h"
 
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
 #include "spu/crypto/ot/silent/primitives.h"
 #include "spu/mpc/beaver/beaver_test.h"
+#include "spu/mpc/beaver/cheetah_key_cache.h"
+#include "spu/mpc/util/ring_ops.h"
+#include "spu/mpc/util/simulate.h"
 
 namespace spu::mpc {
 
@@ -37,4 +45,82 @@ INSTANTIATE_TEST_SUITE_P(
       return fmt::format("{}x{}", std::get<1>(p.param), std::get<2>(p.param));
     });
 
+// sessions after the first one reuse the keys.
+INSTANTIATE_TEST_SUITE_P(
+    BeaverCheetahCachedKeysTest, BeaverTest,
+    testing::Combine(
+        testing::Values([](const std::shared_ptr<yacl::link::Context>& lctx) {
+          std::unique_ptr<BeaverCheetah> beaver =
+              std::make_unique<BeaverCheetah>(lctx, "test");
+          return beaver;
+        }),
+        testing::Values(2),  // parties
+        testing::Values(FieldType::FM32, FieldType::FM64, FieldType::FM128),  //
+        testing::Values(1)  // max beaver diff,
+        ),
+    [](const testing::TestParamInfo<BeaverTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<1>(p.param), std::get<2>(p.param));
+    });
+
+TEST(BeaverCheetahPackedMulTest, ServeAcrossRefills) {
+  const auto field = FieldType::FM64;
+  // the first refill leaves a tail shorter than the last request.
+  const std::vector<size_t> sizes = {100, 5000, 4000, 1};
+
+  std::vector<std::vector<Beaver::Triple>> triples(2);
+  util::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    BeaverCheetah beaver(lctx);
+    ASSERT_GT(beaver.MulPackSize(), sizes[0] + sizes[1]);
+    for (size_t size : sizes) {
+      triples[lctx->Rank()].emplace_back(beaver.PackedMul(field, size));
+    }
+  });
+
+  for (size_t idx = 0; idx < sizes.size(); idx++) {
+    auto [a0, b0, c0] = triples[0][idx];
+    auto [a1, b1, c1] = triples[1][idx];
+    ASSERT_EQ(a0.numel(), static_cast<int64_t>(sizes[idx]));
+    auto a = ring_add(a0, a1);
+    auto b = ring_add(b0, b1);
+    auto c = ring_add(c0, c1);
+    EXPECT_TRUE(ring_all_equal(ring_mul(a, b), c, 1));
+  }
+}
+
+TEST(BeaverCheetahKeyCacheTest, ReuseAndRotate) {
+  auto& cache = CheetahKeyCache::instance();
+  cache.clear();
+
+  auto dot = [](const std::string& epoch) {
+    util::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+      BeaverCheetah beaver(lctx, epoch);
+      beaver.Dot(FieldType::FM64, 2, 3, 4);
+    });
+  };
+  auto public_key = [&](const std::string& epoch, const std::string& key) {
+    auto entry = cache.get(epoch, key);
+    EXPECT_TRUE(entry.has_value());
+    return entry ? std::string(entry->public_key.data<char>(),
+                               entry->public_key.size())
+                 : std::string();
+  };
+
+  // one key of each party.
+  dot("epoch0");
+  const auto keys = cache.keys("epoch0");
+  ASSERT_EQ(keys.size(), 2);
+  const auto pk0 = public_key("epoch0", keys[0]);
+
+  dot("epoch0");
+  EXPECT_EQ(public_key("epoch0", keys[0]), pk0);
+
+  // a new epoch generates new keys and drops the old ones.
+  dot("epoch1");
+  EXPECT_TRUE(cache.keys("epoch0").empty());
+  ASSERT_EQ(cache.keys("epoch1"), keys);
+  EXPECT_NE(public_key("epoch1", keys[0]), pk0);
+
+  cache.clear();
+}
+
 }  // namespace spu::mpc
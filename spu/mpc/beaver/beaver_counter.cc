@@ -0,0 +1,64 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_counter.h"
+
+#include "yacl/base/exception.h"
+
+namespace spu::mpc {
+
+void BeaverDemand::PrefillTo(BeaverPool* pool) const {
+  YACL_ENFORCE(pool != nullptr);
+  for (const auto& [key, numel] : elts) {
+    const auto& [kind, field, bits] = key;
+    pool->Prefill(kind, field, numel, bits);
+  }
+  for (const auto& [key, count] : dots) {
+    const auto& [field, M, N, K] = key;
+    pool->PrefillDot(field, M, N, K, count);
+  }
+}
+
+BeaverCounter::BeaverCounter(std::unique_ptr<Beaver> inner)
+    : inner_(std::move(inner)) {
+  YACL_ENFORCE(inner_ != nullptr);
+}
+
+Beaver::Triple BeaverCounter::Mul(FieldType field, size_t size) {
+  demand_.elts[{BeaverPool::Kind::Mul, field, 0}] += size;
+  return inner_->Mul(field, size);
+}
+
+Beaver::Triple BeaverCounter::And(FieldType field, size_t size) {
+  demand_.elts[{BeaverPool::Kind::And, field, 0}] += size;
+  return inner_->And(field, size);
+}
+
+Beaver::Triple BeaverCounter::Dot(FieldType field, size_t M, size_t N,
+                                  size_t K) {
+  demand_.dots[{field, M, N, K}] += 1;
+  return inner_->Dot(field, M, N, K);
+}
+
+Beaver::Pair BeaverCounter::Trunc(FieldType field, size_t size, size_t bits) {
+  demand_.elts[{BeaverPool::Kind::Trunc, field, bits}] += size;
+  return inner_->Trunc(field, size, bits);
+}
+
+ArrayRef BeaverCounter::RandBit(FieldType field, size_t size) {
+  demand_.elts[{BeaverPool::Kind::RandBit, field, 0}] += size;
+  return inner_->RandBit(field, size);
+}
+
+}  // namespace spu::mpc
@@ -0,0 +1,75 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "spu/mpc/beaver/beaver.h"
+#include "spu/mpc/beaver/beaver_pool.h"
+
+namespace spu::mpc {
+
+// The correlations consumed by a run, i.e. the exact amounts to prefill a
+// BeaverPool with for the same run.
+struct BeaverDemand {
+  // (kind, field, bits) -> number of elements, bits are of Kind::Trunc only.
+  std::map<std::tuple<BeaverPool::Kind, FieldType, size_t>, size_t> elts;
+
+  // (field, M, N, K) -> number of dot triples.
+  std::map<std::tuple<FieldType, size_t, size_t, size_t>, size_t> dots;
+
+  // Schedule all correlations of this demand, in the order of the keys, so
+  // parties of the same demand schedule the same.
+  void PrefillTo(BeaverPool* pool) const;
+};
+
+// A beaver decorator which counts the correlations pulled from it, e.g. to
+// dry run a program and size the offline phase by the counts.
+//
+// Permutations are not counted, since they are not pooled.
+class BeaverCounter : public Beaver {
+ public:
+  explicit BeaverCounter(std::unique_ptr<Beaver> inner);
+
+  const BeaverDemand& demand() const { return demand_; }
+
+  Beaver::Triple Mul(FieldType field, size_t size) override;
+
+  Beaver::Triple And(FieldType field, size_t size) override;
+
+  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  bool SupportTrunc() override { return inner_->SupportTrunc(); }
+  Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
+
+  bool SupportRandBit() override { return inner_->SupportRandBit(); }
+  ArrayRef RandBit(FieldType field, size_t size) override;
+
+  bool SupportPerm() override { return inner_->SupportPerm(); }
+  Beaver::Pair Perm(FieldType field, size_t rows, size_t cols,
+                    size_t perm_rank, std::vector<int64_t>* perm) override {
+    return inner_->Perm(field, rows, cols, perm_rank, perm);
+  }
+
+ private:
+  const std::unique_ptr<Beaver> inner_;
+
+  BeaverDemand demand_;
+};
+
+}  // namespace spu::mpc
@@ -0,0 +1,96 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_counter.h"
+
+#include "spu/mpc/beaver/beaver_test.h"
+#include "spu/mpc/beaver/beaver_tfp.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc {
+
+// Counting passes the correlations of the underline beaver through.
+INSTANTIATE_TEST_SUITE_P(
+    BeaverCounterTest, BeaverTest,
+    testing::Combine(
+        testing::Values([](const std::shared_ptr<yacl::link::Context>& lctx)
+                            -> std::unique_ptr<Beaver> {
+          return std::make_unique<BeaverCounter>(
+              std::make_unique<BeaverTfpUnsafe>(lctx));
+        }),
+        testing::Values(4, 3, 2),
+        testing::Values(FieldType::FM32, FieldType::FM64, FieldType::FM128),
+        testing::Values(0)),  // max beaver diff,
+    [](const testing::TestParamInfo<BeaverTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<1>(p.param), std::get<2>(p.param));
+    });
+
+TEST(BeaverCounterTest, PrefillsExactly) {
+  const size_t kWorldSize = 2;
+  const FieldType kField = FM64;
+
+  auto consume = [&](Beaver* beaver) {
+    beaver->Mul(kField, 7);
+    beaver->Mul(kField, 5);
+    beaver->And(kField, 3);
+    beaver->Trunc(kField, 4, 18);
+    beaver->Trunc(kField, 2, 10);
+    beaver->RandBit(kField, 6);
+    beaver->Dot(kField, 2, 3, 4);
+    beaver->Dot(kField, 2, 3, 4);
+    beaver->Dot(kField, 1, 3, 4);
+  };
+
+  std::vector<BeaverDemand> demands(kWorldSize);
+  std::vector<std::vector<size_t>> remaining(kWorldSize);
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    BeaverCounter counter(std::make_unique<BeaverTfpUnsafe>(lctx));
+    consume(&counter);
+    const auto& demand = counter.demand();
+    demands[lctx->Rank()] = demand;
+
+    // a pool of the counted demand serves the same run.
+    BeaverPool pool(std::make_unique<BeaverTfpUnsafe>(lctx),
+                    std::make_unique<BeaverTfpUnsafe>(lctx->Spawn()));
+    demand.PrefillTo(&pool);
+    pool.Wait();
+    consume(&pool);
+    for (const auto& [key, numel] : demand.elts) {
+      const auto& [kind, field, bits] = key;
+      remaining[lctx->Rank()].push_back(pool.Remaining(kind, field, bits));
+    }
+  });
+
+  using Kind = BeaverPool::Kind;
+  const auto& demand = demands[0];
+  EXPECT_EQ(demand.elts.size(), 5U);
+  EXPECT_EQ(demand.elts.at({Kind::Mul, kField, 0}), 12U);
+  EXPECT_EQ(demand.elts.at({Kind::And, kField, 0}), 3U);
+  EXPECT_EQ(demand.elts.at({Kind::Trunc, kField, 18}), 4U);
+  EXPECT_EQ(demand.elts.at({Kind::Trunc, kField, 10}), 2U);
+  EXPECT_EQ(demand.elts.at({Kind::RandBit, kField, 0}), 6U);
+  EXPECT_EQ(demand.dots.size(), 2U);
+  EXPECT_EQ(demand.dots.at({kField, 2, 3, 4}), 2U);
+  EXPECT_EQ(demand.dots.at({kField, 1, 3, 4}), 1U);
+
+  EXPECT_EQ(demands[1].elts, demand.elts);
+  EXPECT_EQ(demands[1].dots, demand.dots);
+  for (const auto& party : remaining) {
+    for (auto left : party) {
+      EXPECT_EQ(left, 0U);
+    }
+  }
+}
+
+}  // namespace spu::mpc
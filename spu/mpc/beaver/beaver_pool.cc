@@ -0,0 +1,265 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_pool.h"
+
+#include "yacl/base/exception.h"
+
+namespace spu::mpc {
+
+BeaverPool::BeaverPool(std::unique_ptr<Beaver> online,
+                       std::unique_ptr<Beaver> offline, size_t chunk_size)
+    : online_(std::move(online)),
+      offline_(std::move(offline)),
+      chunk_size_(chunk_size) {
+  YACL_ENFORCE(online_ != nullptr && offline_ != nullptr);
+  YACL_ENFORCE(chunk_size_ > 0);
+  worker_ = std::thread([this]() { workerLoop(); });
+}
+
+BeaverPool::~BeaverPool() {
+  {
+    std::unique_lock lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+void BeaverPool::Prefill(Kind kind, FieldType field, size_t numel,
+                         size_t bits) {
+  if (numel == 0) {
+    return;
+  }
+  Job job;
+  job.elt_key = {kind, field, kind == Kind::Trunc ? bits : 0};
+  job.num = numel;
+  schedule(std::move(job));
+}
+
+void BeaverPool::PrefillDot(FieldType field, size_t M, size_t N, size_t K,
+                            size_t count) {
+  if (count == 0) {
+    return;
+  }
+  Job job;
+  job.is_dot = true;
+  job.dot_key = {field, M, N, K};
+  job.num = count;
+  schedule(std::move(job));
+}
+
+void BeaverPool::schedule(Job&& job) {
+  {
+    std::unique_lock lock(mutex_);
+    YACL_ENFORCE(!stopped_, "beaver pool already stopped");
+    if (job.is_dot) {
+      dot_pools_[job.dot_key].remaining += job.num;
+    } else {
+      elt_pools_[job.elt_key].remaining += job.num;
+    }
+    jobs_.push_back(std::move(job));
+  }
+  cv_.notify_all();
+}
+
+void BeaverPool::Wait() {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [&] { return (jobs_.empty() && !busy_) || error_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+size_t BeaverPool::Remaining(Kind kind, FieldType field, size_t bits) const {
+  std::unique_lock lock(mutex_);
+  const auto itr =
+      elt_pools_.find({kind, field, kind == Kind::Trunc ? bits : 0});
+  return itr == elt_pools_.end() ? 0 : itr->second.remaining;
+}
+
+std::vector<ArrayRef> BeaverPool::generate(const EltKey& key, size_t numel) {
+  const auto& [kind, field, bits] = key;
+  switch (kind) {
+    case Kind::Mul: {
+      auto [a, b, c] = offline_->Mul(field, numel);
+      return {a, b, c};
+    }
+    case Kind::And: {
+      auto [a, b, c] = offline_->And(field, numel);
+      return {a, b, c};
+    }
+    case Kind::Trunc: {
+      auto [a, b] = offline_->Trunc(field, numel, bits);
+      return {a, b};
+    }
+    case Kind::RandBit: {
+      return {offline_->RandBit(field, numel)};
+    }
+  }
+  YACL_THROW("should not be here");
+}
+
+void BeaverPool::workerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [&] { return stopped_ || !jobs_.empty(); });
+      if (stopped_ || error_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      busy_ = true;
+    }
+
+    try {
+      if (job.is_dot) {
+        const auto& [field, M, N, K] = job.dot_key;
+        for (size_t idx = 0; idx < job.num; idx++) {
+          auto triple = offline_->Dot(field, M, N, K);
+          {
+            std::unique_lock lock(mutex_);
+            dot_pools_[job.dot_key].triples.push_back(std::move(triple));
+          }
+          cv_.notify_all();
+        }
+      } else {
+        for (size_t done = 0; done < job.num;) {
+          const size_t numel = std::min(chunk_size_, job.num - done);
+          Chunk chunk{generate(job.elt_key, numel), 0};
+          {
+            std::unique_lock lock(mutex_);
+            auto& pool = elt_pools_[job.elt_key];
+            pool.chunks.push_back(std::move(chunk));
+            pool.ready += numel;
+          }
+          cv_.notify_all();
+          done += numel;
+        }
+      }
+    } catch (...) {
+      std::unique_lock lock(mutex_);
+      error_ = std::current_exception();
+    }
+
+    {
+      std::unique_lock lock(mutex_);
+      busy_ = false;
+    }
+    cv_.notify_all();
+  }
+}
+
+std::vector<ArrayRef> BeaverPool::pull(const EltKey& key, size_t numel) {
+  std::unique_lock lock(mutex_);
+  auto& pool = elt_pools_[key];
+  if (pool.remaining < numel || numel == 0) {
+    return {};
+  }
+  pool.remaining -= numel;
+
+  cv_.wait(lock, [&] { return pool.ready >= numel || error_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  pool.ready -= numel;
+
+  // collect pieces from the front chunks.
+  std::vector<std::vector<ArrayRef>> pieces;
+  for (size_t need = numel; need > 0;) {
+    auto& chunk = pool.chunks.front();
+    const int64_t avail = chunk.arrs.front().numel() - chunk.consumed;
+    const int64_t take = std::min<int64_t>(avail, need);
+
+    pieces.resize(chunk.arrs.size());
+    for (size_t idx = 0; idx < chunk.arrs.size(); idx++) {
+      pieces[idx].emplace_back(
+          chunk.arrs[idx].slice(chunk.consumed, chunk.consumed + take));
+    }
+
+    chunk.consumed += take;
+    need -= take;
+    if (chunk.consumed == chunk.arrs.front().numel()) {
+      pool.chunks.pop_front();
+    }
+  }
+  lock.unlock();
+
+  std::vector<ArrayRef> res;
+  for (auto& piece : pieces) {
+    if (piece.size() == 1) {
+      res.emplace_back(std::move(piece.front()));
+    } else {
+      SimdTrait<ArrayRef>::PackInfo pi;
+      res.emplace_back(
+          SimdTrait<ArrayRef>::pack(piece.begin(), piece.end(), pi));
+    }
+  }
+  return res;
+}
+
+Beaver::Triple BeaverPool::Mul(FieldType field, size_t size) {
+  auto arrs = pull({Kind::Mul, field, 0}, size);
+  if (arrs.empty()) {
+    return online_->Mul(field, size);
+  }
+  return {arrs[0], arrs[1], arrs[2]};
+}
+
+Beaver::Triple BeaverPool::And(FieldType field, size_t size) {
+  auto arrs = pull({Kind::And, field, 0}, size);
+  if (arrs.empty()) {
+    return online_->And(field, size);
+  }
+  return {arrs[0], arrs[1], arrs[2]};
+}
+
+Beaver::Pair BeaverPool::Trunc(FieldType field, size_t size, size_t bits) {
+  auto arrs = pull({Kind::Trunc, field, bits}, size);
+  if (arrs.empty()) {
+    return online_->Trunc(field, size, bits);
+  }
+  return {arrs[0], arrs[1]};
+}
+
+ArrayRef BeaverPool::RandBit(FieldType field, size_t size) {
+  auto arrs = pull({Kind::RandBit, field, 0}, size);
+  if (arrs.empty()) {
+    return online_->RandBit(field, size);
+  }
+  return arrs[0];
+}
+
+Beaver::Triple BeaverPool::Dot(FieldType field, size_t M, size_t N, size_t K) {
+  {
+    std::unique_lock lock(mutex_);
+    auto& pool = dot_pools_[{field, M, N, K}];
+    if (pool.remaining > 0) {
+      pool.remaining--;
+      cv_.wait(lock, [&] { return !pool.triples.empty() || error_; });
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+      auto triple = std::move(pool.triples.front());
+      pool.triples.pop_front();
+      return triple;
+    }
+  }
+
+  return online_->Dot(field, M, N, K);
+}
+
+}  // namespace spu::mpc
@@ -0,0 +1,156 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "spu/mpc/beaver/beaver.h"
+
+namespace spu::mpc {
+
+// A beaver decorator which splits correlation generation into offline and
+// online phases.
+//
+// Offline phase: `Prefill` schedules correlations, which are generated by a
+// background thread with the `offline` beaver, and kept in a pool per (kind,
+// field).
+//
+// Online phase: the beaver interfaces pull correlations from the pool, or fall
+// back to the `online` beaver when the pool could not serve the request.
+//
+// Note: the two underline beavers should work on different links, and all
+// parties should schedule exactly the same prefill requests in the same
+// order. The decision to use the pool only depends on scheduled (instead of
+// generated) amount, so it's the same for all parties, when the scheduled
+// correlations are not ready yet, the consumer waits for the producer.
+class BeaverPool : public Beaver {
+ public:
+  enum class Kind {
+    Mul,
+    And,
+    Trunc,
+    RandBit,
+  };
+
+  // the default number of elements generated by each background step.
+  static constexpr size_t kDefaultChunkSize = 1UL << 20;
+
+  BeaverPool(std::unique_ptr<Beaver> online, std::unique_ptr<Beaver> offline,
+             size_t chunk_size = kDefaultChunkSize);
+
+  ~BeaverPool() override;
+
+  // Schedule `numel` element-wise correlations.
+  //
+  // @param bits, the truncation bits, only used by Kind::Trunc.
+  void Prefill(Kind kind, FieldType field, size_t numel, size_t bits = 0);
+
+  // Schedule `count` dot triples with shape (M, N, K).
+  void PrefillDot(FieldType field, size_t M, size_t N, size_t K, size_t count);
+
+  // Block until all scheduled correlations are generated.
+  void Wait();
+
+  // Return number of scheduled but not consumed correlations.
+  size_t Remaining(Kind kind, FieldType field, size_t bits = 0) const;
+
+  Beaver::Triple Mul(FieldType field, size_t size) override;
+
+  Beaver::Triple And(FieldType field, size_t size) override;
+
+  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  bool SupportTrunc() override { return online_->SupportTrunc(); }
+  Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
+
+  bool SupportRandBit() override { return online_->SupportRandBit(); }
+  ArrayRef RandBit(FieldType field, size_t size) override;
+
+  // permutations are not pooled, they are generated online.
+  bool SupportPerm() override { return online_->SupportPerm(); }
+  Beaver::Pair Perm(FieldType field, size_t rows, size_t cols,
+                    size_t perm_rank, std::vector<int64_t>* perm) override {
+    return online_->Perm(field, rows, cols, perm_rank, perm);
+  }
+
+ private:
+  // (kind, field, bits)
+  using EltKey = std::tuple<Kind, FieldType, size_t>;
+  // (field, M, N, K)
+  using DotKey = std::tuple<FieldType, size_t, size_t, size_t>;
+
+  // A generated chunk, the arrays are the components of a correlation, i.e.
+  // (a, b, c) for Mul.
+  struct Chunk {
+    std::vector<ArrayRef> arrs;
+    int64_t consumed = 0;
+  };
+
+  struct EltPool {
+    // scheduled but not consumed.
+    size_t remaining = 0;
+    std::deque<Chunk> chunks;
+    // number of generated but not consumed.
+    size_t ready = 0;
+  };
+
+  struct DotPool {
+    size_t remaining = 0;
+    std::deque<Beaver::Triple> triples;
+  };
+
+  struct Job {
+    bool is_dot = false;
+    EltKey elt_key;
+    DotKey dot_key;
+    size_t num = 0;
+  };
+
+  std::vector<ArrayRef> generate(const EltKey& key, size_t numel);
+
+  // pull `numel` correlations from the pool, return empty if the pool could
+  // not serve it.
+  std::vector<ArrayRef> pull(const EltKey& key, size_t numel);
+
+  void schedule(Job&& job);
+
+  void workerLoop();
+
+  const std::unique_ptr<Beaver> online_;
+  const std::unique_ptr<Beaver> offline_;
+  const size_t chunk_size_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+
+  std::map<EltKey, EltPool> elt_pools_;
+  std::map<DotKey, DotPool> dot_pools_;
+
+  std::deque<Job> jobs_;
+  bool busy_ = false;
+  bool stopped_ = false;
+  std::exception_ptr error_;
+
+  std::thread worker_;
+};
+
+}  // namespace spu::mpc
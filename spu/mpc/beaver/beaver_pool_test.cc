@@ -0,0 +1,92 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_pool.h"
+
+#include "spu/mpc/beaver/beaver_test.h"
+#include "spu/mpc/beaver/beaver_tfp.h"
+#include "spu/mpc/util/ring_ops.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc {
+namespace {
+
+std::unique_ptr<BeaverPool> makePool(
+    const std::shared_ptr<yacl::link::Context>& lctx, size_t chunk_size) {
+  return std::make_unique<BeaverPool>(
+      std::make_unique<BeaverTfpUnsafe>(lctx),
+      std::make_unique<BeaverTfpUnsafe>(lctx->Spawn()), chunk_size);
+}
+
+}  // namespace
+
+// Small requests are served by the pool, large ones fall back to online.
+INSTANTIATE_TEST_SUITE_P(
+    BeaverPoolTest, BeaverTest,
+    testing::Combine(
+        testing::Values([](const std::shared_ptr<yacl::link::Context>& lctx)
+                            -> std::unique_ptr<Beaver> {
+          auto pool = makePool(lctx, 5);
+          for (auto field : {FM32, FM64, FM128}) {
+            pool->Prefill(BeaverPool::Kind::Mul, field, 100);
+            pool->Prefill(BeaverPool::Kind::And, field, 100);
+            pool->Prefill(BeaverPool::Kind::RandBit, field, 100);
+          }
+          return pool;
+        }),
+        testing::Values(4, 3, 2),
+        testing::Values(FieldType::FM32, FieldType::FM64, FieldType::FM128),
+        testing::Values(0)),  // max beaver diff,
+    [](const testing::TestParamInfo<BeaverTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<1>(p.param), std::get<2>(p.param));
+    });
+
+TEST(BeaverPoolTest, MulAcrossChunks) {
+  const size_t kWorldSize = 2;
+  const FieldType kField = FM64;
+  const size_t kNumel = 7;
+
+  std::vector<std::vector<Beaver::Triple>> triples(kWorldSize);
+  std::vector<size_t> remaining(kWorldSize);
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto pool = makePool(lctx, 3);
+    pool->Prefill(BeaverPool::Kind::Mul, kField, 2 * kNumel);
+    pool->Wait();
+
+    // two from pool, one fallback.
+    for (size_t idx = 0; idx < 3; idx++) {
+      triples[lctx->Rank()].push_back(pool->Mul(kField, kNumel));
+    }
+    remaining[lctx->Rank()] = pool->Remaining(BeaverPool::Kind::Mul, kField);
+  });
+
+  for (size_t idx = 0; idx < 3; idx++) {
+    auto sum_a = ring_zeros(kField, kNumel);
+    auto sum_b = ring_zeros(kField, kNumel);
+    auto sum_c = ring_zeros(kField, kNumel);
+    for (size_t r = 0; r < kWorldSize; r++) {
+      const auto& [a, b, c] = triples[r][idx];
+      ring_add_(sum_a, a);
+      ring_add_(sum_b, b);
+      ring_add_(sum_c, c);
+    }
+    EXPECT_TRUE(ring_all_equal(ring_mul(sum_a, sum_b), sum_c)) << idx;
+  }
+
+  EXPECT_EQ(remaining[0], 0U);
+  EXPECT_EQ(remaining[1], 0U);
+}
+
+}  // namespace spu::mpc
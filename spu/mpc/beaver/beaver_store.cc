@@ -0,0 +1,340 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "yacl/base/exception.h"
+
+#include "spu/mpc/util/ring_ops.h"
+
+namespace spu::mpc {
+namespace {
+
+using beaver_store::FileHeader;
+using beaver_store::Kind;
+using beaver_store::RecordHeader;
+
+// records are aligned, so headers could be accessed in place.
+constexpr size_t kAlignment = 16;
+
+size_t alignUp(size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// number of (prg-derived) components of each kind.
+size_t numComponents(Kind kind) {
+  switch (kind) {
+    case Kind::Mul:
+    case Kind::And:
+    case Kind::Dot:
+      return 3;
+    case Kind::Trunc:
+      return 2;
+    case Kind::RandBit:
+      return 1;
+  }
+  YACL_THROW("unknown beaver store kind {}", static_cast<uint32_t>(kind));
+}
+
+}  // namespace
+
+BeaverStoreWriter::BeaverStoreWriter(std::shared_ptr<yacl::link::Context> lctx,
+                                     const std::string& path)
+    : BeaverTfpUnsafe(std::move(lctx)),
+      out_(path, std::ios::binary | std::ios::out | std::ios::trunc) {
+  YACL_ENFORCE(out_.is_open(), "open beaver store {} failed", path);
+
+  FileHeader header{};
+  header.magic = beaver_store::kMagic;
+  header.version = beaver_store::kVersion;
+  header.rank = lctx_->Rank();
+  header.seed = seed_;
+  out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  YACL_ENFORCE(out_.good(), "write beaver store {} failed", path);
+}
+
+void BeaverStoreWriter::append(Kind kind, FieldType field, size_t numel,
+                               size_t arg0, size_t arg1, PrgCounter counter,
+                               const ArrayRef* adjusted) {
+  ArrayRef payload;
+  if (adjusted != nullptr) {
+    payload = adjusted->isCompact() ? *adjusted : adjusted->clone();
+  }
+
+  RecordHeader header{};
+  header.kind = static_cast<uint32_t>(kind);
+  header.field = static_cast<uint32_t>(field);
+  header.numel = numel;
+  header.arg0 = arg0;
+  header.arg1 = arg1;
+  header.prg_counter = counter;
+  header.payload_bytes = payload.numel() * payload.elsize();
+
+  static_assert(sizeof(RecordHeader) % kAlignment == 0);
+  out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (header.payload_bytes > 0) {
+    out_.write(static_cast<const char*>(payload.data()),
+               header.payload_bytes);
+    const std::vector<char> padding(
+        alignUp(header.payload_bytes) - header.payload_bytes, 0);
+    out_.write(padding.data(), padding.size());
+  }
+  YACL_ENFORCE(out_.good(), "write beaver store failed");
+}
+
+Beaver::Triple BeaverStoreWriter::Mul(FieldType field, size_t size) {
+  const auto counter = counter_;
+  auto [a, b, c] = BeaverTfpUnsafe::Mul(field, size);
+  append(Kind::Mul, field, size, 0, 0, counter,
+         lctx_->Rank() == 0 ? &c : nullptr);
+  return {a, b, c};
+}
+
+Beaver::Triple BeaverStoreWriter::And(FieldType field, size_t size) {
+  const auto counter = counter_;
+  auto [a, b, c] = BeaverTfpUnsafe::And(field, size);
+  append(Kind::And, field, size, 0, 0, counter,
+         lctx_->Rank() == 0 ? &c : nullptr);
+  return {a, b, c};
+}
+
+Beaver::Triple BeaverStoreWriter::Dot(FieldType field, size_t M, size_t N,
+                                      size_t K) {
+  const auto counter = counter_;
+  auto [a, b, c] = BeaverTfpUnsafe::Dot(field, M, N, K);
+  append(Kind::Dot, field, M, N, K, counter,
+         lctx_->Rank() == 0 ? &c : nullptr);
+  return {a, b, c};
+}
+
+Beaver::Pair BeaverStoreWriter::Trunc(FieldType field, size_t size,
+                                      size_t bits) {
+  const auto counter = counter_;
+  auto [a, b] = BeaverTfpUnsafe::Trunc(field, size, bits);
+  append(Kind::Trunc, field, size, bits, 0, counter,
+         lctx_->Rank() == 0 ? &b : nullptr);
+  return {a, b};
+}
+
+ArrayRef BeaverStoreWriter::RandBit(FieldType field, size_t size) {
+  const auto counter = counter_;
+  auto a = BeaverTfpUnsafe::RandBit(field, size);
+  append(Kind::RandBit, field, size, 0, 0, counter,
+         lctx_->Rank() == 0 ? &a : nullptr);
+  return a;
+}
+
+BeaverStore::BeaverStore(const std::string& path,
+                         std::unique_ptr<Beaver> fallback)
+    : fallback_(std::move(fallback)) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  YACL_ENFORCE(fd >= 0, "open beaver store {} failed, errno={}", path, errno);
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    YACL_THROW("stat beaver store {} failed, errno={}", path, errno);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ < sizeof(FileHeader)) {
+    ::close(fd);
+    YACL_THROW("beaver store {} is truncated", path);
+  }
+
+  data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  YACL_ENFORCE(data_ != MAP_FAILED, "mmap beaver store {} failed, errno={}",
+               path, errno);
+  // correlations are consumed in file order mostly.
+  ::madvise(data_, size_, MADV_SEQUENTIAL);
+
+  const auto* base = static_cast<const std::byte*>(data_);
+  FileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  YACL_ENFORCE(header.magic == beaver_store::kMagic,
+               "{} is not a beaver store", path);
+  YACL_ENFORCE(header.version == beaver_store::kVersion,
+               "unsupported beaver store version {}", header.version);
+  rank_ = header.rank;
+  seed_ = header.seed;
+
+  // index the records, only headers are touched.
+  for (size_t offset = sizeof(FileHeader); offset < size_;) {
+    YACL_ENFORCE(offset + sizeof(RecordHeader) <= size_,
+                 "beaver store {} is truncated", path);
+    const auto* rec = reinterpret_cast<const RecordHeader*>(base + offset);
+    offset += sizeof(RecordHeader);
+    const std::byte* payload = base + offset;
+    offset += alignUp(rec->payload_bytes);
+    YACL_ENFORCE(offset <= size_, "beaver store {} is truncated", path);
+
+    const auto kind = static_cast<Kind>(rec->kind);
+    const auto field = static_cast<FieldType>(rec->field);
+    Key key =
+        kind == Kind::Dot
+            ? Key{kind, field, rec->numel, rec->arg0, rec->arg1}
+            : Key{kind, field, kind == Kind::Trunc ? rec->arg0 : 0, 0, 0};
+    auto& stream = streams_[key];
+    stream.records.push_back({rec, payload});
+    stream.remaining += kind == Kind::Dot ? 1 : rec->numel;
+  }
+}
+
+BeaverStore::~BeaverStore() {
+  if (data_ != nullptr && data_ != MAP_FAILED) {
+    ::munmap(data_, size_);
+  }
+}
+
+size_t BeaverStore::Remaining(Kind kind, FieldType field, size_t bits) const {
+  const auto itr =
+      streams_.find({kind, field, kind == Kind::Trunc ? bits : 0, 0, 0});
+  return itr == streams_.end() ? 0 : itr->second.remaining;
+}
+
+std::vector<ArrayRef> BeaverStore::replay(const Record& record) const {
+  const auto& header = *record.header;
+  const auto kind = static_cast<Kind>(header.kind);
+  const auto field = static_cast<FieldType>(header.field);
+
+  // the component sizes, in the same order as BeaverTfpUnsafe creates them.
+  std::vector<size_t> sizes(numComponents(kind), header.numel);
+  if (kind == Kind::Dot) {
+    const size_t M = header.numel;
+    const size_t N = header.arg0;
+    const size_t K = header.arg1;
+    sizes = {M * K, K * N, M * N};
+  }
+
+  PrgCounter counter = header.prg_counter;
+  std::vector<ArrayRef> res;
+  for (const auto size : sizes) {
+    res.push_back(ring_rand(field, size, seed_, &counter));
+  }
+
+  if (header.payload_bytes > 0) {
+    auto& adjusted = res.back();
+    YACL_ENFORCE(header.payload_bytes == adjusted.numel() * adjusted.elsize(),
+                 "beaver store payload size mismatch");
+    std::memcpy(adjusted.data(), record.payload, header.payload_bytes);
+  }
+
+  return res;
+}
+
+std::vector<ArrayRef> BeaverStore::pull(const Key& key, size_t numel) {
+  auto itr = streams_.find(key);
+  if (itr == streams_.end() || itr->second.remaining < numel || numel == 0) {
+    return {};
+  }
+  auto& stream = itr->second;
+  stream.remaining -= numel;
+
+  std::vector<std::vector<ArrayRef>> pieces;
+  for (size_t need = numel; need > 0;) {
+    if (stream.front.empty()) {
+      stream.front = replay(stream.records.front());
+      stream.consumed = 0;
+    }
+
+    const int64_t avail = stream.front.front().numel() - stream.consumed;
+    const int64_t take = std::min<int64_t>(avail, need);
+
+    pieces.resize(stream.front.size());
+    for (size_t idx = 0; idx < stream.front.size(); idx++) {
+      pieces[idx].emplace_back(
+          stream.front[idx].slice(stream.consumed, stream.consumed + take));
+    }
+
+    stream.consumed += take;
+    need -= take;
+    if (stream.consumed == stream.front.front().numel()) {
+      stream.front.clear();
+      stream.records.pop_front();
+    }
+  }
+
+  std::vector<ArrayRef> res;
+  for (auto& piece : pieces) {
+    if (piece.size() == 1) {
+      res.emplace_back(std::move(piece.front()));
+    } else {
+      SimdTrait<ArrayRef>::PackInfo pi;
+      res.emplace_back(
+          SimdTrait<ArrayRef>::pack(piece.begin(), piece.end(), pi));
+    }
+  }
+  return res;
+}
+
+Beaver::Triple BeaverStore::Mul(FieldType field, size_t size) {
+  auto arrs = pull({Kind::Mul, field, 0, 0, 0}, size);
+  if (arrs.empty()) {
+    YACL_ENFORCE(fallback_, "beaver store exhausted, Mul size={}", size);
+    return fallback_->Mul(field, size);
+  }
+  return {arrs[0], arrs[1], arrs[2]};
+}
+
+Beaver::Triple BeaverStore::And(FieldType field, size_t size) {
+  auto arrs = pull({Kind::And, field, 0, 0, 0}, size);
+  if (arrs.empty()) {
+    YACL_ENFORCE(fallback_, "beaver store exhausted, And size={}", size);
+    return fallback_->And(field, size);
+  }
+  return {arrs[0], arrs[1], arrs[2]};
+}
+
+Beaver::Pair BeaverStore::Trunc(FieldType field, size_t size, size_t bits) {
+  auto arrs = pull({Kind::Trunc, field, bits, 0, 0}, size);
+  if (arrs.empty()) {
+    YACL_ENFORCE(fallback_, "beaver store exhausted, Trunc size={}", size);
+    return fallback_->Trunc(field, size, bits);
+  }
+  return {arrs[0], arrs[1]};
+}
+
+ArrayRef BeaverStore::RandBit(FieldType field, size_t size) {
+  auto arrs = pull({Kind::RandBit, field, 0, 0, 0}, size);
+  if (arrs.empty()) {
+    YACL_ENFORCE(fallback_, "beaver store exhausted, RandBit size={}", size);
+    return fallback_->RandBit(field, size);
+  }
+  return arrs[0];
+}
+
+Beaver::Triple BeaverStore::Dot(FieldType field, size_t M, size_t N,
+                                size_t K) {
+  auto itr = streams_.find({Kind::Dot, field, M, N, K});
+  if (itr == streams_.end() || itr->second.records.empty()) {
+    YACL_ENFORCE(fallback_, "beaver store exhausted, Dot M={}, N={}, K={}", M,
+                 N, K);
+    return fallback_->Dot(field, M, N, K);
+  }
+
+  auto& stream = itr->second;
+  auto arrs = replay(stream.records.front());
+  stream.records.pop_front();
+  stream.remaining--;
+  return {arrs[0], arrs[1], arrs[2]};
+}
+
+}  // namespace spu::mpc
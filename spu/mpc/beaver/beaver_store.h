@@ -0,0 +1,170 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "spu/mpc/beaver/beaver.h"
+#include "spu/mpc/beaver/beaver_tfp.h"
+
+namespace spu::mpc {
+
+// The on-disk layout of a beaver store, each party has its own file.
+//
+//   FileHeader | RecordHeader | payload | RecordHeader | payload | ...
+//
+// Every record is one correlation produced by BeaverTfpUnsafe, all components
+// except the one adjusted by the trusted party are derived from (seed,
+// prg_counter) like `prgReplayArray` does, so only rank 0 has non-empty
+// payloads, which is the adjusted component in ring layout.
+namespace beaver_store {
+
+enum class Kind : uint32_t {
+  Mul = 0,
+  And = 1,
+  Dot = 2,
+  Trunc = 3,
+  RandBit = 4,
+};
+
+// "SPUBVSTR"
+inline constexpr uint64_t kMagic = 0x5254535642555053ULL;
+inline constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t rank;
+  PrgSeed seed;
+};
+
+struct RecordHeader {
+  uint32_t kind;
+  uint32_t field;
+  // number of elements of element-wise correlations, or M of Dot.
+  uint64_t numel;
+  // truncation bits of Trunc, or N of Dot.
+  uint64_t arg0;
+  // K of Dot.
+  uint64_t arg1;
+  PrgCounter prg_counter;
+  uint64_t payload_bytes;
+};
+
+}  // namespace beaver_store
+
+// Offline phase: a TFP beaver which appends every generated correlation to
+// a store file, the returned correlations are exactly the recorded ones.
+class BeaverStoreWriter : public BeaverTfpUnsafe {
+  std::ofstream out_;
+
+  void append(beaver_store::Kind kind, FieldType field, size_t numel,
+              size_t arg0, size_t arg1, PrgCounter counter,
+              const ArrayRef* adjusted);
+
+ public:
+  BeaverStoreWriter(std::shared_ptr<yacl::link::Context> lctx,
+                    const std::string& path);
+
+  Beaver::Triple Mul(FieldType field, size_t size) override;
+
+  Beaver::Triple And(FieldType field, size_t size) override;
+
+  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
+
+  ArrayRef RandBit(FieldType field, size_t size) override;
+};
+
+// Online phase: streams correlations from a memory-mapped store file, so the
+// store could be much larger than memory.
+//
+// Element-wise requests consume records of the same (kind, field, bits) in
+// file order, a request may span several records. Dot requests consume a
+// whole record with the same shape. When the store is exhausted, requests are
+// served by `fallback`, or throw if it's null.
+//
+// Note: all parties must write and read their stores with the same request
+// sequence, then record layouts are identical and the fallback decision is
+// the same for all parties.
+class BeaverStore : public Beaver {
+ public:
+  explicit BeaverStore(const std::string& path,
+                       std::unique_ptr<Beaver> fallback = nullptr);
+
+  ~BeaverStore() override;
+
+  BeaverStore(const BeaverStore&) = delete;
+  BeaverStore& operator=(const BeaverStore&) = delete;
+
+  size_t rank() const { return rank_; }
+
+  // Return number of not consumed element-wise correlations.
+  size_t Remaining(beaver_store::Kind kind, FieldType field,
+                   size_t bits = 0) const;
+
+  Beaver::Triple Mul(FieldType field, size_t size) override;
+
+  Beaver::Triple And(FieldType field, size_t size) override;
+
+  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
+
+  ArrayRef RandBit(FieldType field, size_t size) override;
+
+ private:
+  // (kind, field, bits) for element-wise, (kind, field, M, N, K) for Dot.
+  using Key =
+      std::tuple<beaver_store::Kind, FieldType, size_t, size_t, size_t>;
+
+  struct Record {
+    const beaver_store::RecordHeader* header;
+    const std::byte* payload;
+  };
+
+  struct Stream {
+    std::deque<Record> records;
+    // not consumed elements of all records.
+    size_t remaining = 0;
+    // replayed components of the front record.
+    std::vector<ArrayRef> front;
+    int64_t consumed = 0;
+  };
+
+  std::vector<ArrayRef> replay(const Record& record) const;
+
+  // pull `numel` correlations, return empty if the store is exhausted.
+  std::vector<ArrayRef> pull(const Key& key, size_t numel);
+
+  std::unique_ptr<Beaver> fallback_;
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+
+  size_t rank_ = 0;
+  PrgSeed seed_ = 0;
+
+  std::map<Key, Stream> streams_;
+};
+
+}  // namespace spu::mpc
@@ -0,0 +1,125 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_store.h"
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+#include "spu/mpc/util/ring_ops.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc {
+
+class BeaverStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tmp_dir_ = "./tmp_beaver_store";
+    std::filesystem::create_directory(tmp_dir_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(tmp_dir_, ec);
+  }
+
+  std::string storePath(size_t rank) const {
+    return fmt::format("{}/party-{}", tmp_dir_, rank);
+  }
+
+  std::string tmp_dir_;
+};
+
+TEST_F(BeaverStoreTest, Replay) {
+  const size_t kWorldSize = 3;
+  const FieldType kField = FieldType::FM64;
+  const size_t kNumel = 10;
+  const size_t kBits = 5;
+  const size_t M = 2;
+  const size_t N = 3;
+  const size_t K = 4;
+
+  std::vector<Beaver::Triple> dots(kWorldSize);
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    BeaverStoreWriter writer(lctx, storePath(lctx->Rank()));
+    writer.Mul(kField, kNumel);
+    writer.Mul(kField, kNumel);
+    dots[lctx->Rank()] = writer.Dot(kField, M, N, K);
+    writer.Trunc(kField, kNumel, kBits);
+    writer.RandBit(kField, kNumel);
+  });
+
+  std::vector<std::vector<Beaver::Triple>> muls(kWorldSize);
+  std::vector<Beaver::Triple> replayed_dots(kWorldSize);
+  std::vector<Beaver::Pair> truncs(kWorldSize);
+  std::vector<ArrayRef> bits(kWorldSize);
+  for (size_t rank = 0; rank < kWorldSize; rank++) {
+    BeaverStore store(storePath(rank));
+    EXPECT_EQ(store.rank(), rank);
+    EXPECT_EQ(store.Remaining(beaver_store::Kind::Mul, kField), 2 * kNumel);
+
+    // the first request spans two records.
+    muls[rank].push_back(store.Mul(kField, kNumel + kNumel / 2));
+    muls[rank].push_back(store.Mul(kField, kNumel / 2));
+    EXPECT_EQ(store.Remaining(beaver_store::Kind::Mul, kField), 0U);
+    EXPECT_THROW(store.Mul(kField, 1), yacl::EnforceNotMet);
+
+    replayed_dots[rank] = store.Dot(kField, M, N, K);
+    truncs[rank] = store.Trunc(kField, kNumel, kBits);
+    bits[rank] = store.RandBit(kField, kNumel);
+  }
+
+  for (const auto& idx : {0, 1}) {
+    const size_t numel = std::get<0>(muls[0][idx]).numel();
+    auto sum_a = ring_zeros(kField, numel);
+    auto sum_b = ring_zeros(kField, numel);
+    auto sum_c = ring_zeros(kField, numel);
+    for (size_t r = 0; r < kWorldSize; r++) {
+      const auto& [a, b, c] = muls[r][idx];
+      ring_add_(sum_a, a);
+      ring_add_(sum_b, b);
+      ring_add_(sum_c, c);
+    }
+    EXPECT_TRUE(ring_all_equal(ring_mul(sum_a, sum_b), sum_c)) << idx;
+  }
+
+  {
+    // replayed dot triples are exactly the generated ones.
+    for (size_t r = 0; r < kWorldSize; r++) {
+      EXPECT_TRUE(
+          ring_all_equal(std::get<0>(dots[r]), std::get<0>(replayed_dots[r])));
+      EXPECT_TRUE(
+          ring_all_equal(std::get<1>(dots[r]), std::get<1>(replayed_dots[r])));
+      EXPECT_TRUE(
+          ring_all_equal(std::get<2>(dots[r]), std::get<2>(replayed_dots[r])));
+    }
+  }
+
+  {
+    auto sum_a = ring_zeros(kField, kNumel);
+    auto sum_b = ring_zeros(kField, kNumel);
+    auto sum_bit = ring_zeros(kField, kNumel);
+    for (size_t r = 0; r < kWorldSize; r++) {
+      ring_add_(sum_a, truncs[r].first);
+      ring_add_(sum_b, truncs[r].second);
+      ring_add_(sum_bit, bits[r]);
+    }
+    EXPECT_TRUE(ring_all_equal(ring_arshift(sum_a, kBits), sum_b));
+    EXPECT_TRUE(
+        ring_all_equal(ring_rshift(sum_bit, 1), ring_zeros(kField, kNumel)));
+  }
+}
+
+}  // namespace spu::mpc
@@ -14,6 +14,11 @@
 
 #include "spu/mpc/beaver/beaver_test.h"
 
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "xtensor/xarray.hpp"
 
 #include "spu/core/type_util.h"
@@ -180,6 +185,56 @@ TEST_P(BeaverTest, Dot) {
   });
 }
 
+TEST_P(BeaverTest, BatchDot) {
+  const auto factory = std::get<0>(GetParam());
+  const size_t kWorldSize = std::get<1>(GetParam());
+  const FieldType kField = std::get<2>(GetParam());
+  const int64_t kMaxDiff = std::get<3>(GetParam());
+  // small matrices, M > N and M < N.
+  const size_t kBatch = 7;
+  const size_t K = 9;
+  const std::vector<std::pair<size_t, size_t>> shapes = {{5, 3}, {3, 6}};
+  for (const auto& shape : shapes) {
+    const size_t M = shape.first;
+    const size_t N = shape.second;
+
+    std::vector<Beaver::Triple> triples(kWorldSize);
+    util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto beaver = factory(lctx);
+      triples[lctx->Rank()] = beaver->BatchDot(kField, kBatch, M, N, K);
+    });
+
+    auto sum_a = ring_zeros(kField, kBatch * M * K);
+    auto sum_b = ring_zeros(kField, kBatch * K * N);
+    auto sum_c = ring_zeros(kField, kBatch * M * N);
+    for (Rank r = 0; r < kWorldSize; r++) {
+      const auto& [a, b, c] = triples[r];
+      ASSERT_EQ(a.numel(), kBatch * M * K);
+      ASSERT_EQ(b.numel(), kBatch * K * N);
+      ASSERT_EQ(c.numel(), kBatch * M * N);
+
+      ring_add_(sum_a, a);
+      ring_add_(sum_b, b);
+      ring_add_(sum_c, c);
+    }
+
+    for (size_t idx = 0; idx < kBatch; idx++) {
+      auto res = ring_mmul(sum_a.slice(idx * M * K, (idx + 1) * M * K),
+                           sum_b.slice(idx * K * N, (idx + 1) * K * N), M, N,
+                           K);
+      auto c = sum_c.slice(idx * M * N, (idx + 1) * M * N);
+      DISPATCH_ALL_FIELDS(kField, "_", [&]() {
+        auto _r = ArrayView<ring2k_t>(res);
+        auto _c = ArrayView<ring2k_t>(c);
+        for (auto i = 0; i < _r.numel(); i++) {
+          auto err = _r[i] > _c[i] ? _r[i] - _c[i] : _c[i] - _r[i];
+          EXPECT_LE(err, kMaxDiff) << idx << " " << i;
+        }
+      });
+    }
+  }
+}
+
 TEST_P(BeaverTest, Dot_large) {
   const auto factory = std::get<0>(GetParam());
   const size_t kWorldSize = std::get<1>(GetParam());
@@ -297,4 +352,65 @@ TEST_P(BeaverTest, Randbit) {
   });
 }
 
+TEST_P(BeaverTest, Perm) {
+  const auto factory = std::get<0>(GetParam());
+  const size_t kWorldSize = std::get<1>(GetParam());
+  const FieldType kField = std::get<2>(GetParam());
+  const size_t kRows = 7;
+  const size_t kCols = 3;
+
+  for (size_t perm_rank = 0; perm_rank < kWorldSize; perm_rank++) {
+    std::vector<Beaver::Pair> pairs(kWorldSize);
+    std::vector<int64_t> perm;
+    std::atomic<bool> supported = true;
+
+    util::simulate(kWorldSize,
+                   [&](std::shared_ptr<yacl::link::Context> lctx) {
+                     auto beaver = factory(lctx);
+                     if (!beaver->SupportPerm()) {
+                       supported = false;
+                       return;
+                     }
+                     std::vector<int64_t> local_perm;
+                     pairs[lctx->Rank()] = beaver->Perm(
+                         kField, kRows, kCols, perm_rank, &local_perm);
+                     if (lctx->Rank() == perm_rank) {
+                       perm = local_perm;
+                     }
+                   });
+    if (!supported) {
+      return;
+    }
+
+    ASSERT_EQ(perm.size(), kRows);
+    std::vector<int64_t> sorted = perm;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t idx = 0; idx < kRows; idx++) {
+      EXPECT_EQ(sorted[idx], static_cast<int64_t>(idx));
+    }
+
+    auto sum_a = ring_zeros(kField, kRows * kCols);
+    auto sum_b = ring_zeros(kField, kRows * kCols);
+    for (Rank r = 0; r < kWorldSize; r++) {
+      const auto& [a, b] = pairs[r];
+      EXPECT_EQ(b.numel(), kRows * kCols);
+      if (r != perm_rank) {
+        EXPECT_EQ(a.numel(), kRows * kCols);
+        ring_add_(sum_a, a);
+      }
+      ring_add_(sum_b, b);
+    }
+
+    DISPATCH_ALL_FIELDS(kField, "_", [&]() {
+      using U = ring2k_t;
+      for (size_t col = 0; col < kCols; col++) {
+        for (size_t row = 0; row < kRows; row++) {
+          EXPECT_EQ(sum_b.at<U>(col * kRows + row),
+                    sum_a.at<U>(col * kRows + perm[row]));
+        }
+      }
+    });
+  }
+}
+
 }  // namespace spu::mpc
@@ -14,6 +14,7 @@
 
 #include "spu/mpc/beaver/beaver_tfp.h"
 
+#include <cstring>
 #include <random>
 
 #include "yacl/link/link.h"
@@ -117,4 +118,43 @@ ArrayRef BeaverTfpUnsafe::RandBit(FieldType field, size_t size) {
   return a;
 }
 
+Beaver::Pair BeaverTfpUnsafe::Perm(FieldType field, size_t rows, size_t cols,
+                                   size_t perm_rank,
+                                   std::vector<int64_t>* perm) {
+  YACL_ENFORCE(perm_rank < lctx_->WorldSize());
+  YACL_ENFORCE(perm != nullptr);
+
+  // all parties create the same arrays to keep prg counters aligned, only
+  // perm_rank's random array derives the permutation.
+  std::vector<PrgArrayDesc> descs(3);
+
+  auto a = prgCreateArray(field, rows * cols, seed_, &counter_, &descs[0]);
+  auto b = prgCreateArray(field, rows * cols, seed_, &counter_, &descs[1]);
+  auto r = prgCreateArray(FieldType::FM64, rows, seed_, &counter_, &descs[2]);
+
+  constexpr char kTag[] = "BEAVER_TFP:PERM";
+  ArrayRef delta;
+  if (lctx_->Rank() == 0) {
+    delta = tp_.adjustPerm(descs, rows, cols, perm_rank);
+    if (perm_rank != 0) {
+      lctx_->SendAsync(perm_rank,
+                       yacl::ByteContainerView(delta.data(),
+                                               delta.numel() * delta.elsize()),
+                       kTag);
+    }
+  } else if (lctx_->Rank() == perm_rank) {
+    auto buf = lctx_->Recv(0, kTag);
+    delta = ArrayRef(a.eltype(), rows * cols);
+    YACL_ENFORCE(static_cast<size_t>(buf.size()) ==
+                 delta.numel() * delta.elsize());
+    std::memcpy(delta.data(), buf.data(), buf.size());
+  }
+
+  if (lctx_->Rank() == perm_rank) {
+    *perm = prgPermutation(r);
+    return {ArrayRef(), delta};
+  }
+  return {a, b};
+}
+
 }  // namespace spu::mpc
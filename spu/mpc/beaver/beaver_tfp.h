@@ -50,6 +50,10 @@ class BeaverTfpUnsafe : public Beaver {
   Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
 
   ArrayRef RandBit(FieldType field, size_t size) override;
+
+  bool SupportPerm() override { return true; }
+  Beaver::Pair Perm(FieldType field, size_t rows, size_t cols,
+                    size_t perm_rank, std::vector<int64_t>* perm) override;
 };
 
 }  // namespace spu::mpc
@@ -0,0 +1,359 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_ttp.h"
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+#include "yacl/link/link.h"
+#include "yacl/utils/serialize.h"
+
+#include "spu/mpc/beaver/prg_tensor.h"
+#include "spu/mpc/util/ring_ops.h"
+
+namespace spu::mpc {
+namespace {
+
+constexpr char kSeedTag[] = "BEAVER_TTP:SYNC_SEEDS";
+constexpr char kRequestTag[] = "BEAVER_TTP:REQUEST";
+constexpr char kAdjustTag[] = "BEAVER_TTP:ADJUST";
+
+enum class Kind : uint32_t {
+  Close = 0,
+  Mul = 1,
+  And = 2,
+  Dot = 3,
+  Trunc = 4,
+  RandBit = 5,
+  Perm = 6,
+};
+
+// A request is a RequestHeader followed by `num_descs` WireDesc.
+struct RequestHeader {
+  uint32_t kind;
+  uint32_t num_descs;
+  // (M, N, K) of Dot, (bits) of Trunc, (rows, cols, perm_rank) of Perm.
+  uint64_t args[3];
+};
+
+struct WireDesc {
+  uint64_t numel;
+  uint64_t field;
+  uint64_t prg_counter;
+};
+
+uint128_t GetHardwareRandom128() {
+  std::random_device rd;
+  // call random_device four times, make sure uint128 is random in 2^128 set.
+  uint64_t lhs = static_cast<uint64_t>(rd()) << 32 | rd();
+  uint64_t rhs = static_cast<uint64_t>(rd()) << 32 | rd();
+  return yacl::MakeUint128(lhs, rhs);
+}
+
+void sendRequest(const std::shared_ptr<yacl::link::Context>& lctx,
+                 size_t ttp_rank, Kind kind,
+                 absl::Span<const PrgArrayDesc> descs,
+                 std::array<uint64_t, 3> args = {}) {
+  RequestHeader header{static_cast<uint32_t>(kind),
+                       static_cast<uint32_t>(descs.size()),
+                       {args[0], args[1], args[2]}};
+
+  std::vector<char> buf(sizeof(header) + descs.size() * sizeof(WireDesc));
+  std::memcpy(buf.data(), &header, sizeof(header));
+  for (size_t idx = 0; idx < descs.size(); idx++) {
+    WireDesc wire{descs[idx].numel, static_cast<uint64_t>(descs[idx].field),
+                  descs[idx].prg_counter};
+    std::memcpy(buf.data() + sizeof(header) + idx * sizeof(WireDesc), &wire,
+                sizeof(wire));
+  }
+  lctx->SendAsync(ttp_rank, yacl::ByteContainerView(buf.data(), buf.size()),
+                  kRequestTag);
+}
+
+void sendArray(const std::shared_ptr<yacl::link::Context>& lctx,
+               size_t dst_rank, const ArrayRef& arr) {
+  const auto compact = arr.isCompact() ? arr : arr.clone();
+  lctx->SendAsync(dst_rank,
+                  yacl::ByteContainerView(compact.data(),
+                                          compact.numel() * compact.elsize()),
+                  kAdjustTag);
+}
+
+ArrayRef recvArray(const std::shared_ptr<yacl::link::Context>& lctx,
+                   size_t src_rank, FieldType field, size_t numel) {
+  const Type ty = makeType<RingTy>(field);
+  auto buf = std::make_shared<yacl::Buffer>(lctx->Recv(src_rank, kAdjustTag));
+  YACL_ENFORCE(static_cast<size_t>(buf->size()) == numel * ty.size(),
+               "adjustment size mismatch, got={}, expected={}", buf->size(),
+               numel * ty.size());
+  return ArrayRef(buf, ty, numel, 1, 0);
+}
+
+}  // namespace
+
+BeaverTtp::BeaverTtp(std::shared_ptr<yacl::link::Context> ttp_lctx,
+                     size_t randbit_batch)
+    : ttp_lctx_(std::move(ttp_lctx)),
+      seed_(GetHardwareRandom128()),
+      counter_(0),
+      randbit_batch_(randbit_batch) {
+  YACL_ENFORCE(ttp_lctx_->WorldSize() > 1 && ttp_lctx_->Rank() < ttpRank(),
+               "computing parties should precede the ttp, rank={}, world={}",
+               ttp_lctx_->Rank(), ttp_lctx_->WorldSize());
+
+  auto buf = yacl::SerializeUint128(seed_);
+  yacl::link::Gather(ttp_lctx_, buf, ttpRank(), kSeedTag);
+}
+
+BeaverTtp::~BeaverTtp() {
+  if (ttp_lctx_->Rank() != 0) {
+    return;
+  }
+  try {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::Close, {});
+  } catch (const std::exception& e) {
+    SPDLOG_WARN("failed to close ttp session, {}", e.what());
+  }
+}
+
+Beaver::Triple BeaverTtp::Mul(FieldType field, size_t size) {
+  std::vector<PrgArrayDesc> descs(3);
+
+  auto a = prgCreateArray(field, size, seed_, &counter_, &descs[0]);
+  auto b = prgCreateArray(field, size, seed_, &counter_, &descs[1]);
+  auto c = prgCreateArray(field, size, seed_, &counter_, &descs[2]);
+
+  if (ttp_lctx_->Rank() == 0) {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::Mul, descs);
+    c = recvArray(ttp_lctx_, ttpRank(), field, size);
+  }
+
+  return {a, b, c};
+}
+
+Beaver::Triple BeaverTtp::Dot(FieldType field, size_t M, size_t N, size_t K) {
+  std::vector<PrgArrayDesc> descs(3);
+
+  auto a = prgCreateArray(field, M * K, seed_, &counter_, &descs[0]);
+  auto b = prgCreateArray(field, K * N, seed_, &counter_, &descs[1]);
+  auto c = prgCreateArray(field, M * N, seed_, &counter_, &descs[2]);
+
+  if (ttp_lctx_->Rank() == 0) {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::Dot, descs, {M, N, K});
+    c = recvArray(ttp_lctx_, ttpRank(), field, M * N);
+  }
+
+  return {a, b, c};
+}
+
+Beaver::Triple BeaverTtp::And(FieldType field, size_t size) {
+  std::vector<PrgArrayDesc> descs(3);
+
+  auto a = prgCreateArray(field, size, seed_, &counter_, &descs[0]);
+  auto b = prgCreateArray(field, size, seed_, &counter_, &descs[1]);
+  auto c = prgCreateArray(field, size, seed_, &counter_, &descs[2]);
+
+  if (ttp_lctx_->Rank() == 0) {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::And, descs);
+    c = recvArray(ttp_lctx_, ttpRank(), field, size);
+  }
+
+  return {a, b, c};
+}
+
+Beaver::Pair BeaverTtp::Trunc(FieldType field, size_t size, size_t bits) {
+  std::vector<PrgArrayDesc> descs(2);
+
+  auto a = prgCreateArray(field, size, seed_, &counter_, &descs[0]);
+  auto b = prgCreateArray(field, size, seed_, &counter_, &descs[1]);
+
+  if (ttp_lctx_->Rank() == 0) {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::Trunc, descs, {bits, 0, 0});
+    b = recvArray(ttp_lctx_, ttpRank(), field, size);
+  }
+
+  return {a, b};
+}
+
+ArrayRef BeaverTtp::RandBit(FieldType field, size_t size) {
+  if (size >= randbit_batch_) {
+    return requestRandBit(field, size);
+  }
+
+  // the tail of a batch is dropped, so a request never spans batches.
+  auto& batch = randbit_batches_[field];
+  const auto num = static_cast<int64_t>(size);
+  if (batch.bits.numel() - batch.consumed < num) {
+    batch.bits = requestRandBit(field, randbit_batch_);
+    batch.consumed = 0;
+  }
+  auto bits = batch.bits.slice(batch.consumed, batch.consumed + num);
+  batch.consumed += num;
+  return bits;
+}
+
+ArrayRef BeaverTtp::requestRandBit(FieldType field, size_t size) {
+  PrgArrayDesc desc{};
+  auto a = prgCreateArray(field, size, seed_, &counter_, &desc);
+
+  if (ttp_lctx_->Rank() == 0) {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::RandBit, absl::MakeSpan(&desc, 1));
+    a = recvArray(ttp_lctx_, ttpRank(), field, size);
+  }
+
+  return a;
+}
+
+Beaver::Pair BeaverTtp::Perm(FieldType field, size_t rows, size_t cols,
+                             size_t perm_rank, std::vector<int64_t>* perm) {
+  YACL_ENFORCE(perm_rank < ttpRank());
+  YACL_ENFORCE(perm != nullptr);
+
+  std::vector<PrgArrayDesc> descs(3);
+
+  auto a = prgCreateArray(field, rows * cols, seed_, &counter_, &descs[0]);
+  auto b = prgCreateArray(field, rows * cols, seed_, &counter_, &descs[1]);
+  auto r = prgCreateArray(FieldType::FM64, rows, seed_, &counter_, &descs[2]);
+
+  if (ttp_lctx_->Rank() == 0) {
+    sendRequest(ttp_lctx_, ttpRank(), Kind::Perm, descs,
+                {rows, cols, perm_rank});
+  }
+
+  if (ttp_lctx_->Rank() == perm_rank) {
+    *perm = prgPermutation(r);
+    return {ArrayRef(), recvArray(ttp_lctx_, ttpRank(), field, rows * cols)};
+  }
+  return {a, b};
+}
+
+TrustedPartyServer::~TrustedPartyServer() {
+  for (auto& session : sessions_) {
+    session.join();
+  }
+}
+
+void TrustedPartyServer::AddSession(std::shared_ptr<yacl::link::Context> lctx) {
+  std::unique_lock lock(mutex_);
+  sessions_.emplace_back([this, lctx = std::move(lctx)]() {
+    try {
+      Serve(lctx);
+    } catch (...) {
+      std::unique_lock lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  });
+}
+
+void TrustedPartyServer::Wait() {
+  std::vector<std::thread> sessions;
+  {
+    std::unique_lock lock(mutex_);
+    sessions.swap(sessions_);
+  }
+  for (auto& session : sessions) {
+    session.join();
+  }
+
+  std::unique_lock lock(mutex_);
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+void TrustedPartyServer::Serve(
+    const std::shared_ptr<yacl::link::Context>& lctx) {
+  const size_t world_size = lctx->WorldSize() - 1;
+  YACL_ENFORCE(world_size > 0 && lctx->Rank() == world_size,
+               "ttp should be the last rank, rank={}, world={}", lctx->Rank(),
+               lctx->WorldSize());
+
+  TrustedParty tp;
+  auto bufs =
+      yacl::link::Gather(lctx, yacl::ByteContainerView(), world_size, kSeedTag);
+  for (size_t rank = 0; rank < world_size; rank++) {
+    tp.setSeed(rank, world_size, yacl::DeserializeUint128(bufs[rank]));
+  }
+
+  while (true) {
+    auto buf = lctx->Recv(0, kRequestTag);
+    RequestHeader header;
+    YACL_ENFORCE(static_cast<size_t>(buf.size()) >= sizeof(header));
+    std::memcpy(&header, buf.data(), sizeof(header));
+    YACL_ENFORCE(static_cast<size_t>(buf.size()) ==
+                     sizeof(header) + header.num_descs * sizeof(WireDesc),
+                 "malformed ttp request of {} bytes", buf.size());
+
+    std::vector<PrgArrayDesc> descs(header.num_descs);
+    for (size_t idx = 0; idx < descs.size(); idx++) {
+      WireDesc wire;
+      std::memcpy(&wire,
+                  buf.data<char>() + sizeof(header) + idx * sizeof(WireDesc),
+                  sizeof(wire));
+      descs[idx] = {wire.numel, static_cast<FieldType>(wire.field),
+                    wire.prg_counter};
+    }
+
+    const auto* args = header.args;
+    switch (static_cast<Kind>(header.kind)) {
+      case Kind::Close:
+        return;
+      case Kind::Mul:
+        sendArray(lctx, 0, tp.adjustMul(descs));
+        break;
+      case Kind::And:
+        sendArray(lctx, 0, tp.adjustAnd(descs));
+        break;
+      case Kind::Dot:
+        sendArray(lctx, 0, tp.adjustDot(descs, args[0], args[1], args[2]));
+        break;
+      case Kind::Trunc:
+        sendArray(lctx, 0, tp.adjustTrunc(descs, args[0]));
+        break;
+      case Kind::RandBit:
+        YACL_ENFORCE_EQ(descs.size(), 1u);
+        sendArray(lctx, 0, tp.adjustRandBit(descs[0]));
+        break;
+      case Kind::Perm:
+        sendArray(lctx, args[2],
+                  tp.adjustPerm(descs, args[0], args[1], args[2]));
+        break;
+      default:
+        YACL_THROW("unknown ttp request kind {}", header.kind);
+    }
+  }
+}
+
+yacl::link::ContextDesc MakeTtpLinkDesc(const TtpBeaverConfig& config) {
+  YACL_ENFORCE(!config.server_host().empty() && config.party_hosts_size() > 0,
+               "ttp beaver requires the server and party hosts");
+
+  yacl::link::ContextDesc desc;
+  desc.id = config.session_id().empty() ? "ttp" : config.session_id();
+  for (int rank = 0; rank < config.party_hosts_size(); rank++) {
+    desc.parties.push_back(
+        {fmt::format("party{}", rank), config.party_hosts(rank)});
+  }
+  desc.parties.push_back({"ttp", config.server_host()});
+  return desc;
+}
+
+}  // namespace spu::mpc
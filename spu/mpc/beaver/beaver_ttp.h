@@ -0,0 +1,132 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "yacl/link/context.h"
+
+#include "spu/mpc/beaver/beaver.h"
+#include "spu/mpc/beaver/trusted_party.h"
+#include "spu/spu.pb.h"
+
+namespace spu::mpc {
+
+// Trusted Third Party beaver implementation.
+//
+// The adjustments are computed by a standalone TrustedPartyServer instead of
+// rank 0, so no computing party pays the extra compute and memory of
+// replaying all parties' prg streams.
+//
+// `ttp_lctx` links the computing parties and the server, the server is the
+// last rank, computing parties keep their ranks. Only rank 0 sends requests,
+// requests are described by prg descs, i.e. a few words instead of arrays.
+//
+// RandBit requests below `randbit_batch` elements are served from a batch of
+// that size, adjusted by one server request, so b2a of small arrays, which is
+// on the critical path of every comparison, does not wait for the server per
+// call. All parties request the same sizes, so the batches stay aligned.
+class BeaverTtp : public Beaver {
+ public:
+  static constexpr size_t kDefaultRandBitBatch = 1UL << 16;
+
+ private:
+  // Generated but not consumed random bits of a field.
+  struct RandBitBatch {
+    ArrayRef bits;
+    int64_t consumed = 0;
+  };
+
+  std::shared_ptr<yacl::link::Context> ttp_lctx_;
+
+  PrgSeed seed_;
+
+  PrgCounter counter_;
+
+  const size_t randbit_batch_;
+
+  std::map<FieldType, RandBitBatch> randbit_batches_;
+
+  // the rank of the server in ttp link.
+  size_t ttpRank() const { return ttp_lctx_->WorldSize() - 1; }
+
+  ArrayRef requestRandBit(FieldType field, size_t size);
+
+ public:
+  // @param randbit_batch, 0 to request every RandBit from the server.
+  explicit BeaverTtp(std::shared_ptr<yacl::link::Context> ttp_lctx,
+                     size_t randbit_batch = kDefaultRandBitBatch);
+
+  // rank 0 tells the server to close the session.
+  ~BeaverTtp() override;
+
+  Beaver::Triple Mul(FieldType field, size_t size) override;
+
+  Beaver::Triple And(FieldType field, size_t size) override;
+
+  Beaver::Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  Beaver::Pair Trunc(FieldType field, size_t size, size_t bits) override;
+
+  ArrayRef RandBit(FieldType field, size_t size) override;
+
+  // the server sends the adjusted permuted mask to `perm_rank` directly.
+  bool SupportPerm() override { return true; }
+  Beaver::Pair Perm(FieldType field, size_t rows, size_t cols,
+                    size_t perm_rank, std::vector<int64_t>* perm) override;
+};
+
+// The trusted third party of BeaverTtp, which serves many computing
+// sessions concurrently, each session on its own link and thread.
+//
+// Warn: the server learns all shares of the correlations, it should be run by
+// a party trusted by all computing parties.
+class TrustedPartyServer {
+ public:
+  TrustedPartyServer() = default;
+
+  // Join all sessions.
+  ~TrustedPartyServer();
+
+  TrustedPartyServer(const TrustedPartyServer&) = delete;
+  TrustedPartyServer& operator=(const TrustedPartyServer&) = delete;
+
+  // Serve a session in background until its rank 0 closes it, the server
+  // should be the last rank of `lctx`.
+  void AddSession(std::shared_ptr<yacl::link::Context> lctx);
+
+  // Block until all sessions are closed, rethrow the first session error.
+  void Wait();
+
+  // Serve a session in the calling thread.
+  static void Serve(const std::shared_ptr<yacl::link::Context>& lctx);
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::thread> sessions_;
+  std::exception_ptr error_;
+};
+
+// The link of the computing parties and the server of a ttp session by
+// `config`, the computing parties keep their ranks and the server is the last
+// rank, i.e. `config.party_hosts_size()`.
+yacl::link::ContextDesc MakeTtpLinkDesc(const TtpBeaverConfig& config);
+
+}  // namespace spu::mpc
@@ -0,0 +1,272 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/beaver_ttp.h"
+
+#include <future>
+
+#include "gtest/gtest.h"
+#include "yacl/link/link.h"
+#include "yacl/link/test_util.h"
+
+#include "spu/core/type_util.h"
+#include "spu/mpc/util/ring_ops.h"
+
+namespace spu::mpc {
+namespace {
+
+// Run `fn` on every computing party of a ttp link, and a server of
+// `num_sessions` sessions on the last rank, session `idx` of a party is on
+// the `idx`-th spawn of its link.
+template <typename Fn>
+void simulateWithTtp(size_t world_size, size_t num_sessions, Fn&& fn) {
+  auto lctxs = yacl::link::test::SetupWorld(
+      fmt::format("ttp.{}", world_size), world_size + 1);
+
+  TrustedPartyServer server;
+  for (size_t idx = 0; idx < num_sessions; idx++) {
+    server.AddSession(lctxs[world_size]->Spawn());
+  }
+
+  std::vector<std::future<void>> futures;
+  for (size_t rank = 0; rank < world_size; rank++) {
+    futures.push_back(std::async([&, rank]() {
+      std::vector<std::shared_ptr<yacl::link::Context>> sessions;
+      for (size_t idx = 0; idx < num_sessions; idx++) {
+        sessions.push_back(lctxs[rank]->Spawn());
+      }
+      fn(sessions);
+    }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  server.Wait();
+}
+
+void checkMul(const std::vector<Beaver::Triple>& triples, FieldType field) {
+  auto sum_a = ring_zeros(field, std::get<0>(triples[0]).numel());
+  auto sum_b = sum_a.clone();
+  auto sum_c = sum_a.clone();
+  for (const auto& [a, b, c] : triples) {
+    ring_add_(sum_a, a);
+    ring_add_(sum_b, b);
+    ring_add_(sum_c, c);
+  }
+  EXPECT_TRUE(ring_all_equal(ring_mul(sum_a, sum_b), sum_c));
+}
+
+}  // namespace
+
+class BeaverTtpTest
+    : public ::testing::TestWithParam<std::tuple<size_t, FieldType>> {};
+
+TEST_P(BeaverTtpTest, Works) {
+  const size_t kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  const size_t kNumel = 7;
+  const size_t M = 3;
+  const size_t N = 4;
+  const size_t K = 5;
+  const size_t kBits = 5;
+
+  std::vector<Beaver::Triple> muls(kWorldSize);
+  std::vector<Beaver::Triple> dots(kWorldSize);
+  std::vector<Beaver::Pair> truncs(kWorldSize);
+  std::vector<ArrayRef> bits(kWorldSize);
+  simulateWithTtp(kWorldSize, 1, [&](const auto& sessions) {
+    BeaverTtp beaver(sessions[0]);
+    const size_t rank = sessions[0]->Rank();
+    muls[rank] = beaver.Mul(kField, kNumel);
+    dots[rank] = beaver.Dot(kField, M, N, K);
+    truncs[rank] = beaver.Trunc(kField, kNumel, kBits);
+    bits[rank] = beaver.RandBit(kField, kNumel);
+  });
+
+  checkMul(muls, kField);
+
+  auto sum_a = ring_zeros(kField, M * K);
+  auto sum_b = ring_zeros(kField, K * N);
+  auto sum_c = ring_zeros(kField, M * N);
+  auto sum_r = ring_zeros(kField, kNumel);
+  auto sum_rb = ring_zeros(kField, kNumel);
+  auto sum_bit = ring_zeros(kField, kNumel);
+  for (size_t rank = 0; rank < kWorldSize; rank++) {
+    ring_add_(sum_a, std::get<0>(dots[rank]));
+    ring_add_(sum_b, std::get<1>(dots[rank]));
+    ring_add_(sum_c, std::get<2>(dots[rank]));
+    ring_add_(sum_r, std::get<0>(truncs[rank]));
+    ring_add_(sum_rb, std::get<1>(truncs[rank]));
+    ring_add_(sum_bit, bits[rank]);
+  }
+  EXPECT_TRUE(ring_all_equal(ring_mmul(sum_a, sum_b, M, N, K), sum_c));
+  EXPECT_TRUE(ring_all_equal(ring_arshift(sum_r, kBits), sum_rb));
+
+  DISPATCH_ALL_FIELDS(kField, "_", [&]() {
+    auto _bit = ArrayView<ring2k_t>(sum_bit);
+    for (int64_t idx = 0; idx < _bit.numel(); idx++) {
+      EXPECT_TRUE(_bit[idx] == 0 || _bit[idx] == 1);
+    }
+  });
+}
+
+TEST_P(BeaverTtpTest, Perm) {
+  const size_t kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  const size_t kRows = 6;
+  const size_t kCols = 2;
+
+  // the server sends the mask to perm_rank directly, including rank 0.
+  for (size_t perm_rank = 0; perm_rank < kWorldSize; perm_rank++) {
+    std::vector<Beaver::Pair> pairs(kWorldSize);
+    std::vector<int64_t> perm;
+    simulateWithTtp(kWorldSize, 1, [&](const auto& sessions) {
+      BeaverTtp beaver(sessions[0]);
+      const size_t rank = sessions[0]->Rank();
+      std::vector<int64_t> local_perm;
+      pairs[rank] = beaver.Perm(kField, kRows, kCols, perm_rank, &local_perm);
+      if (rank == perm_rank) {
+        perm = local_perm;
+      }
+    });
+
+    ASSERT_EQ(perm.size(), kRows);
+    auto sum_a = ring_zeros(kField, kRows * kCols);
+    auto sum_b = ring_zeros(kField, kRows * kCols);
+    for (size_t rank = 0; rank < kWorldSize; rank++) {
+      const auto& [a, b] = pairs[rank];
+      if (rank != perm_rank) {
+        ring_add_(sum_a, a);
+      }
+      ring_add_(sum_b, b);
+    }
+
+    DISPATCH_ALL_FIELDS(kField, "_", [&]() {
+      using U = ring2k_t;
+      for (size_t col = 0; col < kCols; col++) {
+        for (size_t row = 0; row < kRows; row++) {
+          EXPECT_EQ(sum_b.at<U>(col * kRows + row),
+                    sum_a.at<U>(col * kRows + perm[row]));
+        }
+      }
+    });
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BeaverTtpTestInstances, BeaverTtpTest,
+    testing::Combine(testing::Values(2, 3),
+                     testing::Values(FieldType::FM32, FieldType::FM64,
+                                     FieldType::FM128)),
+    [](const testing::TestParamInfo<BeaverTtpTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<0>(p.param), std::get<1>(p.param));
+    });
+
+// Small requests are served from batches, large ones are requested directly.
+TEST(BeaverTtpRandBitTest, Batch) {
+  const size_t kWorldSize = 2;
+  const size_t kBatch = 16;
+  const FieldType kField = FieldType::FM64;
+  const std::vector<size_t> kSizes = {5, 7, 6, 20, 3, 16, 1};
+
+  std::vector<std::vector<ArrayRef>> bits(kWorldSize);
+  simulateWithTtp(kWorldSize, 1, [&](const auto& sessions) {
+    BeaverTtp beaver(sessions[0], kBatch);
+    const size_t rank = sessions[0]->Rank();
+    for (auto size : kSizes) {
+      bits[rank].push_back(beaver.RandBit(kField, size));
+    }
+  });
+
+  for (size_t idx = 0; idx < kSizes.size(); idx++) {
+    auto sum = ring_zeros(kField, kSizes[idx]);
+    for (size_t rank = 0; rank < kWorldSize; rank++) {
+      ASSERT_EQ(bits[rank][idx].numel(), static_cast<int64_t>(kSizes[idx]));
+      ring_add_(sum, bits[rank][idx]);
+    }
+    DISPATCH_ALL_FIELDS(kField, "_", [&]() {
+      auto _sum = ArrayView<ring2k_t>(sum);
+      for (int64_t i = 0; i < _sum.numel(); i++) {
+        EXPECT_TRUE(_sum[i] == 0 || _sum[i] == 1) << idx << " " << i;
+      }
+    });
+  }
+}
+
+// One server serves many sessions concurrently.
+TEST(BeaverTtpServerTest, Sessions) {
+  const size_t kWorldSize = 2;
+  const size_t kSessions = 3;
+  const FieldType kField = FieldType::FM64;
+
+  std::vector<std::vector<Beaver::Triple>> triples(
+      kSessions, std::vector<Beaver::Triple>(kWorldSize));
+  simulateWithTtp(kWorldSize, kSessions, [&](const auto& sessions) {
+    std::vector<std::future<void>> futures;
+    for (size_t idx = 0; idx < kSessions; idx++) {
+      futures.push_back(std::async([&, idx]() {
+        BeaverTtp beaver(sessions[idx]);
+        triples[idx][sessions[idx]->Rank()] = beaver.Mul(kField, 10 + idx);
+      }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+  });
+
+  for (size_t idx = 0; idx < kSessions; idx++) {
+    checkMul(triples[idx], kField);
+  }
+}
+
+// The link of a RuntimeConfig.ttp_beaver_config, over in-memory channels.
+TEST(BeaverTtpConfigTest, LinkDesc) {
+  const size_t kWorldSize = 2;
+  const FieldType kField = FieldType::FM64;
+
+  TtpBeaverConfig config;
+  config.set_server_host("127.0.0.1:9530");
+  config.add_party_hosts("127.0.0.1:9531");
+  config.add_party_hosts("127.0.0.1:9532");
+  config.set_session_id("ttp.config");
+
+  const auto desc = MakeTtpLinkDesc(config);
+  ASSERT_EQ(desc.parties.size(), kWorldSize + 1);
+  EXPECT_EQ(desc.id, "ttp.config");
+  EXPECT_EQ(desc.parties[kWorldSize].host, config.server_host());
+
+  std::vector<Beaver::Triple> muls(kWorldSize);
+  std::vector<std::future<void>> futures;
+  for (size_t rank = 0; rank <= kWorldSize; rank++) {
+    futures.push_back(std::async([&, rank]() {
+      auto lctx = yacl::link::FactoryMem().CreateContext(desc, rank);
+      lctx->ConnectToMesh();
+      if (rank == kWorldSize) {
+        TrustedPartyServer::Serve(lctx);
+      } else {
+        BeaverTtp beaver(lctx);
+        muls[rank] = beaver.Mul(kField, 7);
+      }
+    }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  checkMul(muls, kField);
+
+  config.clear_party_hosts();
+  EXPECT_THROW(MakeTtpLinkDesc(config), ::yacl::EnforceNotMet);
+}
+
+}  // namespace spu::mpc
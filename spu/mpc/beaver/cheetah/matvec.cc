@@ -107,36 +107,41 @@ void MatVecProtocol::MatVecNoExtract(const Meta& meta,
   YACL_ENFORCE_EQ(num_col_blks, vec.size());
 
   out->resize(num_row_blks);
-  seal::Evaluator evaluator(context_);
-  for (size_t rb = 0; rb < num_row_blks; ++rb) {
-    RLWECt accumulated;
-    for (size_t cb = 0; cb < num_col_blks; ++cb) {
-      const auto& mat_pt = mat[rb * num_col_blks + cb];
-      size_t n = mat_pt.coeff_count();
-      if (0 == n) continue;
-      if (std::all_of(mat_pt.data(), mat_pt.data() + n,
-                      [](uint64_t x) { return x == 0; })) {
-        continue;
-      }
-
-      RLWECt tmp;
-      evaluator.multiply_plain(vec.at(cb), mat_pt, tmp);
-      if (accumulated.size() > 0) {
-        evaluator.add_inplace(accumulated, tmp);
-      } else {
-        accumulated = tmp;
-      }
-    }
-    YACL_ENFORCE(accumulated.size() > 0,
-                 fmt::format("all zero matrix is not supported for MatVec"));
-
-    // position form for RLWE2LWE
-    if (accumulated.is_ntt_form()) {
-      evaluator.transform_from_ntt(accumulated, out->at(rb));
-    } else {
-      out->at(rb) = accumulated;
-    }
-  }
+  // the row blocks are independent, each task owns an evaluator.
+  constexpr size_t kParallelGrain = 1;
+  yacl::parallel_for(
+      0, num_row_blks, kParallelGrain, [&](size_t rb_bgn, size_t rb_end) {
+        seal::Evaluator evaluator(context_);
+        for (size_t rb = rb_bgn; rb < rb_end; ++rb) {
+          RLWECt accumulated;
+          for (size_t cb = 0; cb < num_col_blks; ++cb) {
+            const auto& mat_pt = mat[rb * num_col_blks + cb];
+            size_t n = mat_pt.coeff_count();
+            if (0 == n) continue;
+            if (std::all_of(mat_pt.data(), mat_pt.data() + n,
+                            [](uint64_t x) { return x == 0; })) {
+              continue;
+            }
+
+            RLWECt tmp;
+            evaluator.multiply_plain(vec.at(cb), mat_pt, tmp);
+            if (accumulated.size() > 0) {
+              evaluator.add_inplace(accumulated, tmp);
+            } else {
+              accumulated = tmp;
+            }
+          }
+          YACL_ENFORCE(accumulated.size() > 0,
+                       "all zero matrix is not supported for MatVec");
+
+          // position form for RLWE2LWE
+          if (accumulated.is_ntt_form()) {
+            evaluator.transform_from_ntt(accumulated, out->at(rb));
+          } else {
+            out->at(rb) = accumulated;
+          }
+        }
+      });
 
   ExtractLWEsInplace(meta, *out);
 }
@@ -156,9 +161,13 @@ void MatVecProtocol::ExtractLWEsInplace(const Meta& meta,
     size_t target_coeff = r * submat_shape[1];
     to_keep.insert(target_coeff);
   }
-  for (size_t rb = 0; rb + 1 < num_row_blks; ++rb) {
-    KeepCoefficientsInplace(rlwes[rb], to_keep);
-  }
+  constexpr size_t kParallelGrain = 1;
+  yacl::parallel_for(0, num_row_blks - 1, kParallelGrain,
+                     [&](size_t rb_bgn, size_t rb_end) {
+                       for (size_t rb = rb_bgn; rb < rb_end; ++rb) {
+                         KeepCoefficientsInplace(rlwes[rb], to_keep);
+                       }
+                     });
 
   // take care the last row-block which might contains less rows
   to_keep.clear();
@@ -0,0 +1,155 @@
+// Copyright 2021 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "seal/seal.h"
+#include "yacl/base/exception.h"
+
+#include "spu/mpc/beaver/cheetah/modswitch_helper.h"
+#include "spu/mpc/beaver/cheetah/poly_encoder.h"
+#include "spu/mpc/beaver/cheetah/util.h"
+#include "spu/mpc/beaver/prg_tensor.h"
+#include "spu/mpc/util/ring_ops.h"
+
+namespace spu::mpc {
+namespace {
+
+constexpr size_t kPolyDegree = 4096;
+
+// Same parameters as rlwe2lwe_test.
+struct Setup {
+  std::shared_ptr<seal::SEALContext> context;
+  std::shared_ptr<ModulusSwitchHelper> ms_helper;
+
+  explicit Setup(FieldType field) {
+    std::vector<int> modulus_bits;
+    switch (field) {
+      case FieldType::FM32:
+        modulus_bits = {40, 24 + 5};
+        break;
+      case FieldType::FM64:
+        modulus_bits = {45, 45, 38 + 5};
+        break;
+      case FieldType::FM128:
+        modulus_bits = {55, 55, 55, 55, 36 + 5};
+        break;
+      default:
+        YACL_THROW("Not support field type {}", field);
+    }
+
+    seal::EncryptionParameters parms(seal::scheme_type::ckks);
+    parms.set_poly_modulus_degree(kPolyDegree);
+    parms.set_coeff_modulus(
+        seal::CoeffModulus::Create(kPolyDegree, modulus_bits));
+    parms.set_use_special_prime(false);
+    context = std::make_shared<seal::SEALContext>(parms, false,
+                                                  seal::sec_level_type::none);
+    ms_helper =
+        std::make_shared<ModulusSwitchHelper>(*context, SizeOf(field) * 8);
+  }
+};
+
+ArrayRef RandomArray(FieldType field, size_t numel) {
+  PrgArrayDesc desc;
+  PrgCounter counter = 0;
+  return prgCreateArray(field, numel, /*seed*/ 0, &counter, &desc);
+}
+
+void FieldArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({{FM32, FM64, FM128}});
+}
+
+void BM_ModulusUpAt(benchmark::State& state) {
+  const auto field = static_cast<FieldType>(state.range(0));
+  Setup setup(field);
+  auto src = RandomArray(field, kPolyDegree);
+  std::vector<uint64_t> dst(kPolyDegree);
+
+  for (auto _ : state) {
+    for (size_t l = 0; l < setup.ms_helper->coeff_modulus_size(); ++l) {
+      setup.ms_helper->ModulusUpAt(src, l, absl::MakeSpan(dst));
+    }
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPolyDegree);
+}
+
+void BM_ModulusDownRNS(benchmark::State& state) {
+  const auto field = static_cast<FieldType>(state.range(0));
+  Setup setup(field);
+  const size_t num_modulus = setup.ms_helper->coeff_modulus_size();
+  const auto& modulus =
+      setup.context->key_context_data()->parms().coeff_modulus();
+  std::vector<uint64_t> src(kPolyDegree * num_modulus);
+  for (size_t l = 0; l < num_modulus; ++l) {
+    for (size_t i = 0; i < kPolyDegree; ++i) {
+      src[l * kPolyDegree + i] =
+          (i * 0x9e3779b97f4a7c15ULL) % modulus[l].value();
+    }
+  }
+  auto out = ring_zeros(field, kPolyDegree);
+
+  for (auto _ : state) {
+    setup.ms_helper->ModulusDownRNS(absl::MakeConstSpan(src), out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPolyDegree);
+}
+
+void BM_PolyEncoderBackward(benchmark::State& state) {
+  const auto field = static_cast<FieldType>(state.range(0));
+  const size_t numel = state.range(1);
+  Setup setup(field);
+  PolyEncoder encoder(*setup.context, *setup.ms_helper);
+  auto vec = RandomArray(field, numel);
+  RLWEPt pt;
+
+  for (auto _ : state) {
+    encoder.Backward(vec, &pt, /*scale_delta*/ true);
+    benchmark::DoNotOptimize(pt.data());
+  }
+  state.SetItemsProcessed(state.iterations() * numel);
+}
+
+void BM_KeepCoefficients(benchmark::State& state) {
+  Setup setup(FieldType::FM64);
+  RLWECt ct;
+  ct.resize(*setup.context, setup.context->first_parms_id(), 2);
+
+  // keep one coefficient out of each block, as ExtractLWEsInplace does.
+  std::set<size_t> to_keep;
+  for (size_t i = 0; i < kPolyDegree; i += state.range(0)) {
+    to_keep.insert(i);
+  }
+
+  for (auto _ : state) {
+    KeepCoefficientsInplace(ct, to_keep);
+    benchmark::DoNotOptimize(ct.data());
+  }
+}
+
+BENCHMARK(BM_ModulusUpAt)->Apply(FieldArgs);
+BENCHMARK(BM_ModulusDownRNS)->Apply(FieldArgs);
+BENCHMARK(BM_PolyEncoderBackward)
+    ->ArgsProduct({{FM32, FM64, FM128}, {16, 256, kPolyDegree}});
+BENCHMARK(BM_KeepCoefficients)->Arg(16)->Arg(256);
+
+}  // namespace
+}  // namespace spu::mpc
+
+BENCHMARK_MAIN();
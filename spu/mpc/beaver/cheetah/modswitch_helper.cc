@@ -20,6 +20,7 @@
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/uintarith.h"
 #include "yacl/base/int128.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/mpc/util/ring_ops.h"
 #include "spu/mpc/util/seal_help.h"
@@ -84,6 +85,9 @@ uint64_t BarrettReduce(uint32_t x, const seal::Modulus &prime) {
 
 struct ModulusSwitchHelper::Impl {
  public:
+  // number of coefficients per task of the element-wise loops.
+  static constexpr int64_t kParallelGrain = 2048;
+
   explicit Impl(uint32_t base_mod_bitlen, seal::SEALContext context)
       : base_mod_bitlen_(base_mod_bitlen), context_(std::move(context)) {
     YACL_ENFORCE(context_.parameters_set(), "invalid seal context");
@@ -131,18 +135,21 @@ struct ModulusSwitchHelper::Impl {
                              num_modulus));
     auto &modulus = context_.key_context_data()->parms().coeff_modulus();
 
-    auto begin = src.data();
-    auto end = begin + src.size();
+    const auto &qi = modulus[mod_idx];
+    const auto &k_mod_qi = Q_div_t_mod_qi_[mod_idx];
     // round(Q/t*x) = k*x + round(r*x/t) where k = floor(Q/t), r = Q mod t
     // round(Q/t*x) mod qi = ((k mod qi)*x + round(r*x/t)) mod qi
-    std::transform(begin, end, out.data(), [&](Scalar x) {
-      // u = (Q mod t)*x mod qi
-      uint64_t x64 = BarrettReduce(x, modulus[mod_idx]);
-      uint64_t u = seal::util::multiply_uint_mod(x64, Q_div_t_mod_qi_[mod_idx],
-                                                 modulus[mod_idx]);
-      // uint128_t can conver uint32_t/uint64_t mult here
-      Scalar v = ((Q_mod_t_ * x + t_half_) >> base_mod_bitlen_);
-      return BarrettReduce(u + v, modulus[mod_idx]);
+    yacl::parallel_for(0, src.size(), kParallelGrain, [&](int64_t bgn,
+                                                          int64_t end) {
+      for (int64_t i = bgn; i < end; ++i) {
+        const Scalar x = src[i];
+        // u = (Q mod t)*x mod qi
+        uint64_t x64 = BarrettReduce(x, qi);
+        uint64_t u = multiply_uint_mod(x64, k_mod_qi, qi);
+        // uint128_t can conver uint32_t/uint64_t mult here
+        Scalar v = ((Q_mod_t_ * x + t_half_) >> base_mod_bitlen_);
+        out[i] = BarrettReduce(u + v, qi);
+      }
     });
   }
 
@@ -160,33 +167,35 @@ struct ModulusSwitchHelper::Impl {
                              num_modulus));
     auto &modulus = context_.key_context_data()->parms().coeff_modulus();
 
-    auto begin = src.data();
-    auto end = begin + src.size();
-    std::transform(begin, end, out.data(), [&](uint128_t x) {
-      uint64_t x64 = BarrettReduce(x, modulus[mod_idx]);
-      uint64_t u = seal::util::multiply_uint_mod(x64, Q_div_t_mod_qi_[mod_idx],
-                                                 modulus[mod_idx]);
-      using namespace seal::util;
-      auto Q_mod_t = reinterpret_cast<const uint64_t *>(&Q_mod_t_);
-      auto xlimbs = reinterpret_cast<const uint64_t *>(&x);
-      auto t_half = reinterpret_cast<const uint64_t *>(&t_half_);
-      constexpr size_t kU128Limbs = 2;
-
-      // Compute round(x * Q_mod_t / t) for 2^64 < x, t <= 2^128
-      // round(x * Q_mod_t / t) = floor((x * Q_mod_t + t_half) / t)
-      // We need 4 limbs to store the product x * Q_mod_t
-      std::vector<uint64_t> mul_limbs(2 * kU128Limbs);
-      std::vector<uint64_t> add_limbs(2 * kU128Limbs);
-      std::vector<uint64_t> rs_limbs(kU128Limbs + 1);
-      multiply_uint(Q_mod_t, kU128Limbs, xlimbs, kU128Limbs, 2 * kU128Limbs,
-                    mul_limbs.data());
-      add_uint(mul_limbs.data(), 2 * kU128Limbs, t_half, kU128Limbs,
-               /*carry*/ 0, 2 * kU128Limbs, add_limbs.data());
-      // NOTE(juhou) base_mod_bitlen_ > 64, we can direct drop the LSB here.
-      right_shift_uint192(add_limbs.data() + 1, base_mod_bitlen_ - 64,
-                          rs_limbs.data());
-      return BarrettReduce(u + AssignU128(rs_limbs[0], rs_limbs[1]),
-                           modulus[mod_idx]);
+    const auto &qi = modulus[mod_idx];
+    const auto &k_mod_qi = Q_div_t_mod_qi_[mod_idx];
+    const auto *Q_mod_t = reinterpret_cast<const uint64_t *>(&Q_mod_t_);
+    const auto *t_half = reinterpret_cast<const uint64_t *>(&t_half_);
+    constexpr size_t kU128Limbs = 2;
+
+    yacl::parallel_for(0, src.size(), kParallelGrain, [&](int64_t bgn,
+                                                          int64_t end) {
+      // the limbs live on the stack, this is the hot loop of the encoding.
+      uint64_t mul_limbs[2 * kU128Limbs];
+      uint64_t add_limbs[2 * kU128Limbs];
+      uint64_t rs_limbs[kU128Limbs + 1];
+      for (int64_t i = bgn; i < end; ++i) {
+        const uint128_t x = src[i];
+        uint64_t x64 = BarrettReduce(x, qi);
+        uint64_t u = multiply_uint_mod(x64, k_mod_qi, qi);
+        auto xlimbs = reinterpret_cast<const uint64_t *>(&x);
+
+        // Compute round(x * Q_mod_t / t) for 2^64 < x, t <= 2^128
+        // round(x * Q_mod_t / t) = floor((x * Q_mod_t + t_half) / t)
+        // We need 4 limbs to store the product x * Q_mod_t
+        multiply_uint(Q_mod_t, kU128Limbs, xlimbs, kU128Limbs, 2 * kU128Limbs,
+                      mul_limbs);
+        add_uint(mul_limbs, 2 * kU128Limbs, t_half, kU128Limbs,
+                 /*carry*/ 0, 2 * kU128Limbs, add_limbs);
+        // NOTE(juhou) base_mod_bitlen_ > 64, we can direct drop the LSB here.
+        right_shift_uint192(add_limbs + 1, base_mod_bitlen_ - 64, rs_limbs);
+        out[i] = BarrettReduce(u + AssignU128(rs_limbs[0], rs_limbs[1]), qi);
+      }
     });
   }
 
@@ -203,18 +212,19 @@ struct ModulusSwitchHelper::Impl {
                  "Centeralize: invalid mod_idx");
     YACL_ENFORCE(src.size() == out.size(), "Centeralize: size mismatch");
 
-    auto begin = src.data();
-    auto end = begin + src.size();
     const auto &mod_qj = modulus[mod_idx];
 
     // view x \in [0, 2^k) as [-2^{k-1}, 2^{k-1})
-    std::transform(begin, end, out.data(), [&](Scalar x) -> uint64_t {
-      uint128_t x128 = static_cast<uint128_t>(x);
-      if (x128 > t_half_) {
-        uint64_t u = BarrettReduce(-x128 & mod_t_mask_, mod_qj);
-        return negate_uint_mod(u, mod_qj);
-      } else {
-        return BarrettReduce(x, mod_qj);
+    yacl::parallel_for(0, src.size(), kParallelGrain, [&](int64_t bgn,
+                                                          int64_t end) {
+      for (int64_t i = bgn; i < end; ++i) {
+        uint128_t x128 = static_cast<uint128_t>(src[i]);
+        if (x128 > t_half_) {
+          uint64_t u = BarrettReduce(-x128 & mod_t_mask_, mod_qj);
+          out[i] = negate_uint_mod(u, mod_qj);
+        } else {
+          out[i] = BarrettReduce(src[i], mod_qj);
+        }
       }
     });
   }
@@ -241,12 +251,14 @@ struct ModulusSwitchHelper::Impl {
     auto tmp = allocate_uint(src.size(), pool);
 
     // 1. multiply with gamma*t
-    for (size_t l = 0; l < num_modulus; ++l) {
-      auto src_ptr = src.data() + l * coeff_count;
-      auto dst_ptr = tmp.get() + l * coeff_count;
-      multiply_poly_scalar_coeffmod(src_ptr, coeff_count, gamma_t_mod_Q_[l],
-                                    coeff_modulus[l], dst_ptr);
-    }
+    yacl::parallel_for(0, num_modulus, 1, [&](int64_t bgn, int64_t end) {
+      for (int64_t l = bgn; l < end; ++l) {
+        auto src_ptr = src.data() + l * coeff_count;
+        auto dst_ptr = tmp.get() + l * coeff_count;
+        multiply_poly_scalar_coeffmod(src_ptr, coeff_count, gamma_t_mod_Q_[l],
+                                      coeff_modulus[l], dst_ptr);
+      }
+    });
 
     // 2-1 FastBase convert from baseQ to {gamma}
     auto base_on_gamma = allocate_uint(coeff_count, pool);
@@ -261,28 +273,13 @@ struct ModulusSwitchHelper::Impl {
     // 3-1 FastBase convert from baseQ to {t}
     // NOTE: overwrite the `tmp` (tmp is gamma*t*x mod Q)
     auto inv_punctured = base_Q.inv_punctured_prod_mod_base_array();
-    for (size_t l = 0; l < num_modulus; ++l) {
-      auto src_ptr = tmp.get() + l * coeff_count;
-      multiply_poly_scalar_coeffmod(src_ptr, coeff_count, inv_punctured[l],
-                                    coeff_modulus[l], src_ptr);
-    }
-
-    // sum_i (x * (Q/qi)^{-1} mod qi) * (Q/qi) mod t
-    std::vector<Scalar> base_on_t(coeff_count);
-    std::fill_n(base_on_t.data(), coeff_count, 0);
-    for (size_t l = 0; l < num_modulus; ++l) {
-      const Scalar factor = punctured_base_mod_t_[l];
-      auto ptr = tmp.get() + l * coeff_count;
-      std::transform(ptr, ptr + coeff_count, base_on_t.data(), base_on_t.data(),
-                     [factor](uint64_t x, Scalar y) {
-                       return y + static_cast<Scalar>(x) * factor;
-                     });
-    }
-
-    // 3-2 Then multiply with -Q^{-1} mod t
-    std::transform(
-        base_on_t.begin(), base_on_t.end(), base_on_t.data(),
-        [&](Scalar x) { return (x * neg_inv_Q_mod_t_) & mod_t_mask_; });
+    yacl::parallel_for(0, num_modulus, 1, [&](int64_t bgn, int64_t end) {
+      for (int64_t l = bgn; l < end; ++l) {
+        auto src_ptr = tmp.get() + l * coeff_count;
+        multiply_poly_scalar_coeffmod(src_ptr, coeff_count, inv_punctured[l],
+                                      coeff_modulus[l], src_ptr);
+      }
+    });
 
     // clang-format off
     // 4 Correct sign: (base_on_t - [base_on_gamma]_gamma) * gamma^{-1} mod t
@@ -297,18 +294,34 @@ struct ModulusSwitchHelper::Impl {
     // last term and gives `gamma*(x + t*r) mod t`.
     // Finally, multiply with `gamma^{-1} mod t` gives `x mod t`.
     // clang-format on
-    uint64_t gamma_div_2 = gamma_.value() >> 1;
-    std::transform(
-        base_on_gamma.get(), base_on_gamma.get() + coeff_count,
-        base_on_t.data(), out.data(), [&](uint64_t on_gamma, Scalar on_t) {
-          // [0, gamma) -> [-gamma/2, gamma/2]
-          if (on_gamma > gamma_div_2) {
-            return ((on_t + gamma_.value() - on_gamma) * inv_gamma_mod_t_) &
-                   mod_t_mask_;
-          } else {
-            return ((on_t - on_gamma) * inv_gamma_mod_t_) & mod_t_mask_;
-          }
-        });
+    //
+    // The rest of step 3-1, step 3-2 and step 4 are element-wise, they run
+    // in one pass.
+    const uint64_t gamma = gamma_.value();
+    const uint64_t gamma_div_2 = gamma >> 1;
+    const uint64_t *on_gamma_ptr = base_on_gamma.get();
+    const uint64_t *tmp_ptr = tmp.get();
+    yacl::parallel_for(0, coeff_count, kParallelGrain, [&](int64_t bgn,
+                                                           int64_t end) {
+      for (int64_t i = bgn; i < end; ++i) {
+        // sum_i (x * (Q/qi)^{-1} mod qi) * (Q/qi) mod t
+        Scalar on_t = 0;
+        for (size_t l = 0; l < num_modulus; ++l) {
+          on_t += static_cast<Scalar>(tmp_ptr[l * coeff_count + i]) *
+                  static_cast<Scalar>(punctured_base_mod_t_[l]);
+        }
+        // 3-2 Then multiply with -Q^{-1} mod t
+        on_t = (on_t * neg_inv_Q_mod_t_) & mod_t_mask_;
+
+        // [0, gamma) -> [-gamma/2, gamma/2]
+        uint64_t on_gamma = on_gamma_ptr[i];
+        if (on_gamma > gamma_div_2) {
+          out[i] = ((on_t + gamma - on_gamma) * inv_gamma_mod_t_) & mod_t_mask_;
+        } else {
+          out[i] = ((on_t - on_gamma) * inv_gamma_mod_t_) & mod_t_mask_;
+        }
+      }
+    });
   }
 
  private:
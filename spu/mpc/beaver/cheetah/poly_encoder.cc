@@ -83,31 +83,44 @@ void PolyEncoder::Backward(const ArrayRef &vec, RLWEPt *out,
   const auto field = eltype.as<Ring2k>()->field();
 
   DISPATCH_ALL_FIELDS(field, "Backward", [&]() {
-    ArrayRef tmp_buff = ring_zeros(field, poly_deg_);
+    // Only a0 and the last (num_coeffs - 1) coefficients are non-zero, and
+    // both conversions map zero to zero, so skip the middle ones.
+    // tmp_buff = [a0, -an, ..., -a1]
+    const size_t tail = num_coeffs - 1;
+    ArrayRef tmp_buff = ring_zeros(field, num_coeffs);
     auto xvec = xt_adapt<ring2k_t>(vec);
     auto xtmp = xt_mutable_adapt<ring2k_t>(tmp_buff);
 
     xtmp[0] = xvec[0];
     // reverse and sign flip
     std::transform(xvec.data() + 1, xvec.data() + num_coeffs,
-                   std::reverse_iterator<ring2k_t *>(xtmp.data() + poly_deg_),
+                   std::reverse_iterator<ring2k_t *>(xtmp.data() + num_coeffs),
                    [](ring2k_t x) { return -x; });
+    auto head = tmp_buff.slice(0, 1);
+    auto rest = tmp_buff.slice(1, num_coeffs);
 
     uint64_t *dst = out->data();
     for (size_t mod_idx = 0; mod_idx < num_modulus; ++mod_idx) {
       std::fill_n(dst, poly_deg_, 0);
-      absl::Span<uint64_t> dst_wrap(dst, poly_deg_);
+      absl::Span<uint64_t> head_wrap(dst, 1);
+      absl::Span<uint64_t> tail_wrap(dst + poly_deg_ - tail, tail);
 
       if (scale_delta) {
-        ms_helper_.ModulusUpAt(tmp_buff, mod_idx, dst_wrap);
+        ms_helper_.ModulusUpAt(head, mod_idx, head_wrap);
+        if (tail > 0) {
+          ms_helper_.ModulusUpAt(rest, mod_idx, tail_wrap);
+        }
       } else {
-        ms_helper_.CenteralizeAt(tmp_buff, mod_idx, dst_wrap);
+        ms_helper_.CenteralizeAt(head, mod_idx, head_wrap);
+        if (tail > 0) {
+          ms_helper_.CenteralizeAt(rest, mod_idx, tail_wrap);
+        }
       }
       dst += poly_deg_;
     }
 
     // clean up sensitive data
-    seal::util::seal_memzero(xtmp.data(), sizeof(ring2k_t) * poly_deg_);
+    seal::util::seal_memzero(xtmp.data(), sizeof(ring2k_t) * num_coeffs);
   });
 
   out->parms_id() = ms_helper_.parms_id();
@@ -14,6 +14,8 @@
 
 #include "spu/mpc/beaver/cheetah/util.h"
 
+#include <vector>
+
 #include "spdlog/spdlog.h"
 #include "yacl/base/exception.h"
 
@@ -52,13 +54,19 @@ void KeepCoefficientsInplace(RLWECt& ciphertext,
                            [&](size_t idx) { return idx < num_coeff; }));
   if (to_keep.size() == num_coeff) return;
 
-  std::set<size_t> to_remove;
-  for (size_t idx = 0; idx < num_coeff; ++idx) {
-    if (to_keep.find(idx) == to_keep.end()) {
-      to_remove.insert(idx);
+  // a dense mask instead of the set of removed ones, which is known to be
+  // almost all of the coefficients.
+  std::vector<uint8_t> keep(num_coeff, 0);
+  for (size_t idx : to_keep) {
+    keep[idx] = 1;
+  }
+  size_t num_modulus = ciphertext.coeff_modulus_size();
+  for (size_t l = 0; l < num_modulus; ++l) {
+    auto ct_ptr = ciphertext.data(0) + l * num_coeff;
+    for (size_t idx = 0; idx < num_coeff; ++idx) {
+      ct_ptr[idx] = keep[idx] ? ct_ptr[idx] : 0;
     }
   }
-  RemoveCoefficientsInplace(ciphertext, to_remove);
 }
 
 AutoMemGuard::AutoMemGuard(ArrayRef* obj) : obj_(obj) {
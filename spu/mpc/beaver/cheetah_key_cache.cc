@@ -0,0 +1,75 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/beaver/cheetah_key_cache.h"
+
+#include <utility>
+
+#include "fmt/format.h"
+
+namespace spu::mpc {
+
+CheetahKeyCache& CheetahKeyCache::instance() {
+  static CheetahKeyCache cache;
+  return cache;
+}
+
+std::string CheetahKeyCache::makeKey(const yacl::link::Context& lctx,
+                                     std::string_view purpose) {
+  return fmt::format("{}:{}->{}", purpose, lctx.PartyIdByRank(lctx.Rank()),
+                     lctx.PartyIdByRank(lctx.NextRank()));
+}
+
+std::optional<CheetahKeyCache::Entry> CheetahKeyCache::get(
+    const std::string& epoch, const std::string& key) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (epoch != epoch_) {
+    return std::nullopt;
+  }
+  auto itr = entries_.find(key);
+  if (itr == entries_.end()) {
+    return std::nullopt;
+  }
+  return itr->second;
+}
+
+void CheetahKeyCache::put(const std::string& epoch, const std::string& key,
+                          Entry entry) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (epoch != epoch_) {
+    entries_.clear();
+    epoch_ = epoch;
+  }
+  entries_[key] = std::move(entry);
+}
+
+std::vector<std::string> CheetahKeyCache::keys(
+    const std::string& epoch) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<std::string> ret;
+  if (epoch == epoch_) {
+    for (const auto& [key, entry] : entries_) {
+      ret.push_back(key);
+    }
+  }
+  return ret;
+}
+
+void CheetahKeyCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  epoch_.clear();
+}
+
+}  // namespace spu::mpc
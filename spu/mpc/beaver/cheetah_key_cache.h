@@ -0,0 +1,67 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yacl/base/buffer.h"
+#include "yacl/link/context.h"
+
+namespace spu::mpc {
+
+// The HE keys of cheetah beavers kept by sessions of the same peers in this
+// process, so later sessions skip the key generation and the key exchange,
+// see `RuntimeConfig.cheetah_key_epoch`.
+//
+// Keys only live in one epoch, putting a key of a new epoch rotates the keys,
+// i.e. the keys of the previous epoch are dropped. Thread safe.
+class CheetahKeyCache {
+ public:
+  struct Entry {
+    yacl::Buffer secret_key;
+    yacl::Buffer public_key;
+    // the public key received from the peer.
+    yacl::Buffer peer_public_key;
+  };
+
+  // The cache of the process.
+  static CheetahKeyCache& instance();
+
+  // The key of `purpose` keys between this party of `lctx` and the next one.
+  static std::string makeKey(const yacl::link::Context& lctx,
+                             std::string_view purpose);
+
+  std::optional<Entry> get(const std::string& epoch,
+                           const std::string& key) const;
+
+  void put(const std::string& epoch, const std::string& key, Entry entry);
+
+  // The keys of the entries of `epoch`.
+  std::vector<std::string> keys(const std::string& epoch) const;
+
+  void clear();
+
+ private:
+  mutable std::mutex mutex_;
+  std::string epoch_;
+  std::map<std::string, Entry> entries_;
+};
+
+}  // namespace spu::mpc
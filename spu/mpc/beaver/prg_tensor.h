@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 #include "spu/core/array_ref.h"
 #include "spu/mpc/util/ring_ops.h"
 
@@ -39,4 +43,19 @@ inline ArrayRef prgReplayArray(PrgSeed seed, const PrgArrayDesc& desc) {
   return ring_rand(desc.field, desc.numel, seed, &counter);
 }
 
+// Derive a permutation of [0, rand.numel()) from a FM64 random array, which
+// is the argsort of the random elements, ties are broken by index.
+inline std::vector<int64_t> prgPermutation(const ArrayRef& rand) {
+  YACL_ENFORCE(rand.eltype().as<Ring2k>()->field() == FieldType::FM64);
+
+  std::vector<int64_t> perm(rand.numel());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::sort(perm.begin(), perm.end(), [&](int64_t lhs, int64_t rhs) {
+    const auto l = rand.at<uint64_t>(lhs);
+    const auto r = rand.at<uint64_t>(rhs);
+    return l < r || (l == r && lhs < rhs);
+  });
+  return perm;
+}
+
 }  // namespace spu::mpc
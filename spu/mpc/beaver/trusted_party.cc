@@ -14,6 +14,7 @@
 
 #include "spu/mpc/beaver/trusted_party.h"
 
+#include "spu/core/type_util.h"
 #include "spu/mpc/util/ring_ops.h"
 
 namespace spu::mpc {
@@ -103,7 +104,8 @@ ArrayRef TrustedParty::adjustMul(absl::Span<const PrgArrayDesc> descs) {
 
   auto [r0, rs] = reconstruct(RecOp::ADD, getSeeds(), descs);
   // r0[2] += rs[0] * rs[1] - rs[2];
-  ring_add_(r0[2], ring_sub(ring_mul(rs[0], rs[1]), rs[2]));
+  ring_linear_combination_(
+      r0[2], {{r0[2]}, {rs[0], rs[1]}, {rs[2], std::nullopt, true}});
   return r0[2];
 }
 
@@ -150,4 +152,40 @@ ArrayRef TrustedParty::adjustRandBit(const PrgArrayDesc& desc) {
   return r0[0];
 }
 
+ArrayRef TrustedParty::adjustPerm(absl::Span<const PrgArrayDesc> descs,
+                                  size_t rows, size_t cols, size_t perm_rank) {
+  YACL_ENFORCE_EQ(descs.size(), 3u);
+  YACL_ENFORCE(descs[0].numel == rows * cols);
+  YACL_ENFORCE(descs[1].numel == rows * cols);
+  YACL_ENFORCE(descs[2].numel == rows);
+
+  const auto seeds = getSeeds();
+  YACL_ENFORCE(perm_rank < seeds.size());
+
+  // sum of (a, b) of all parties except perm_rank.
+  auto sum_a = ring_zeros(descs[0].field, rows * cols);
+  auto sum_b = ring_zeros(descs[1].field, rows * cols);
+  for (size_t rank = 0; rank < seeds.size(); rank++) {
+    if (rank != perm_rank) {
+      ring_add_(sum_a, prgReplayArray(seeds[rank], descs[0]));
+      ring_add_(sum_b, prgReplayArray(seeds[rank], descs[1]));
+    }
+  }
+  const auto perm = prgPermutation(prgReplayArray(seeds[perm_rank], descs[2]));
+
+  // delta = perm(sum_a) - sum_b, column by column.
+  ArrayRef delta(sum_a.eltype(), rows * cols);
+  DISPATCH_ALL_FIELDS(descs[0].field, "_", [&]() {
+    using U = ring2k_t;
+    for (size_t col = 0; col < cols; col++) {
+      for (size_t row = 0; row < rows; row++) {
+        const size_t idx = col * rows + row;
+        delta.at<U>(idx) =
+            sum_a.at<U>(col * rows + perm[row]) - sum_b.at<U>(idx);
+      }
+    }
+  });
+  return delta;
+}
+
 }  // namespace spu::mpc
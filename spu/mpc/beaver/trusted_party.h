@@ -43,6 +43,10 @@ class TrustedParty {
   ArrayRef adjustTrunc(absl::Span<const PrgArrayDesc> descs, size_t bits);
 
   ArrayRef adjustRandBit(const PrgArrayDesc& descs);
+
+  // descs are (a, b, r), where r derives the permutation of `perm_rank`.
+  ArrayRef adjustPerm(absl::Span<const PrgArrayDesc> descs, size_t rows,
+                      size_t cols, size_t perm_rank);
 };
 
 }  // namespace spu::mpc
@@ -0,0 +1,125 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The latency and accuracy of the reciprocal based fixed-point functions by
+// `RuntimeConfig.fxp_reciprocal_mode`, the `max_rel_err` counter is the max
+// relative error of the revealed results.
+//
+// e.g.
+// bazel run -c opt //spu/mpc/benchmark:fxp_bench
+
+#include <chrono>
+
+#include "benchmark/benchmark.h"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xrandom.hpp"
+
+#include "spu/core/xt_helper.h"
+#include "spu/kernel/context.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/fxp.h"
+#include "spu/kernel/hal/type_cast.h"
+#include "spu/mpc/util/communicator.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc::bench {
+
+enum class FxpFn {
+  Reciprocal,
+  Div,
+  Rsqrt,
+};
+
+// Evaluate the function of range(2) on n secret elements with semi2k, range(0)
+// is n, range(1) is the reciprocal mode.
+static void BM_SecretReciprocal(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto fn = static_cast<FxpFn>(state.range(2));
+
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::SEMI2K);
+  config.set_field(FieldType::FM64);
+  config.set_fxp_reciprocal_mode(
+      static_cast<RuntimeConfig::ReciprocalMode>(state.range(1)));
+
+  const xt::xarray<float> x = xt::random::rand<float>({n}, 1, 1000);
+  const xt::xarray<float> y = xt::random::rand<float>({n}, 0.01, 10000);
+  xt::xarray<float> expected;
+  switch (fn) {
+    case FxpFn::Reciprocal:
+      expected = 1.0f / y;
+      break;
+    case FxpFn::Div:
+      expected = x / y;
+      break;
+    case FxpFn::Rsqrt:
+      expected = 1.0f / xt::sqrt(y);
+      break;
+  }
+
+  for (auto _ : state) {
+    util::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+      HalContext ctx(config, lctx);
+      auto* comm = ctx.prot()->getState<Communicator>();
+
+      auto a = kernel::hal::make_value(&ctx, VIS_SECRET, x);
+      auto b = kernel::hal::make_value(&ctx, VIS_SECRET, y);
+
+      const auto prev = comm->getStats();
+      const auto start = std::chrono::high_resolution_clock::now();
+      spu::Value c;
+      switch (fn) {
+        case FxpFn::Reciprocal:
+          c = kernel::hal::f_reciprocal(&ctx, b);
+          break;
+        case FxpFn::Div:
+          c = kernel::hal::f_div(&ctx, a, b);
+          break;
+        case FxpFn::Rsqrt:
+          c = kernel::hal::f_rsqrt(&ctx, b);
+          break;
+      }
+      const auto end = std::chrono::high_resolution_clock::now();
+      const auto cost = comm->getStats() - prev;
+
+      auto arr = kernel::hal::dump_public(&ctx, kernel::hal::reveal(&ctx, c));
+      if (lctx->Rank() == 0) {
+        auto got = xt_adapt<float>(arr);
+        state.SetIterationTime(
+            std::chrono::duration<double>(end - start).count());
+        state.counters["latency"] = cost.latency;
+        state.counters["comm"] = cost.comm;
+        state.counters["max_rel_err"] =
+            xt::amax(xt::abs(got - expected) / xt::abs(expected))();
+      }
+    });
+  }
+}
+
+BENCHMARK(BM_SecretReciprocal)
+    ->ArgsProduct({
+        benchmark::CreateRange(1 << 10, 1 << 16, /*multi=*/8),  // n
+        {RuntimeConfig::RECIPROCAL_LINEAR,
+         RuntimeConfig::RECIPROCAL_POLY},  // mode
+        {static_cast<int64_t>(FxpFn::Reciprocal),
+         static_cast<int64_t>(FxpFn::Div),
+         static_cast<int64_t>(FxpFn::Rsqrt)},  // fn
+    })
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1);
+
+}  // namespace spu::mpc::bench
+
+BENCHMARK_MAIN();
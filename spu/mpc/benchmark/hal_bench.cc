@@ -0,0 +1,303 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The cost and accuracy of the hal nonlinear functions on secret inputs, by
+// protocol, field, number of elements and the approximation mode of the
+// function, to pick the modes of a model by data.
+//
+// The `latency` counter is the number of rounds and `comm` the bytes sent by
+// rank 0, `max_abs_err` and `max_rel_err` compare the revealed results to the
+// plaintext function, `mismatch` is the number of wrong argmax indices.
+//
+// e.g.
+// bazel run -c opt //spu/mpc/benchmark:hal_bench -- \
+//   --benchmark_filter='BM_HalFn/exp/.*'
+
+#include <chrono>
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xsort.hpp"
+
+#include "spu/core/xt_helper.h"
+#include "spu/kernel/context.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/fxp.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hal/shape_ops.h"
+#include "spu/kernel/hal/type_cast.h"
+#include "spu/kernel/hlo/reduce.h"
+#include "spu/kernel/hlo/sort.h"
+#include "spu/mpc/util/communicator.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc::bench {
+namespace {
+
+enum class HalFn {
+  Exp,
+  Log,
+  Tanh,
+  Rsqrt,
+  Div,
+  Sigmoid,
+  Sort,
+  ArgMax,
+};
+
+// ArgMax reduces every row of this many elements.
+constexpr int64_t kArgMaxWindow = 16;
+
+void SetMode(RuntimeConfig* config, HalFn fn, int64_t mode) {
+  switch (fn) {
+    case HalFn::Exp:
+      config->set_fxp_exp_mode(static_cast<RuntimeConfig::ExpMode>(mode));
+      break;
+    case HalFn::Log:
+      config->set_fxp_log_mode(static_cast<RuntimeConfig::LogMode>(mode));
+      break;
+    case HalFn::Rsqrt:
+    case HalFn::Div:
+      config->set_fxp_reciprocal_mode(
+          static_cast<RuntimeConfig::ReciprocalMode>(mode));
+      break;
+    case HalFn::Sigmoid:
+      config->set_sigmoid_mode(static_cast<RuntimeConfig::SigmoidMode>(mode));
+      break;
+    case HalFn::Sort:
+      config->set_sort_network(static_cast<RuntimeConfig::SortNetwork>(mode));
+      break;
+    case HalFn::Tanh:
+    case HalFn::ArgMax:
+      break;
+  }
+}
+
+// The functions of outputs bounded away from zero report the relative error.
+bool HasRelativeError(HalFn fn) {
+  return fn == HalFn::Exp || fn == HalFn::Rsqrt || fn == HalFn::Div ||
+         fn == HalFn::Sigmoid;
+}
+
+std::pair<xt::xarray<float>, xt::xarray<float>> MakeInputs(HalFn fn,
+                                                           size_t n) {
+  switch (fn) {
+    case HalFn::Exp:
+      return {xt::random::rand<float>({n}, -8, 8), {}};
+    case HalFn::Log:
+      return {xt::random::rand<float>({n}, 0.1, 100), {}};
+    case HalFn::Tanh:
+      return {xt::random::rand<float>({n}, -4, 4), {}};
+    case HalFn::Rsqrt:
+      return {xt::random::rand<float>({n}, 0.01, 10000), {}};
+    case HalFn::Div:
+      return {xt::random::rand<float>({n}, 1, 1000),
+              xt::random::rand<float>({n}, 0.01, 10000)};
+    case HalFn::Sigmoid:
+      return {xt::random::rand<float>({n}, -8, 8), {}};
+    case HalFn::Sort:
+      return {xt::random::rand<float>({n}, -1000, 1000), {}};
+    case HalFn::ArgMax:
+      return {xt::random::rand<float>(
+                  {n / kArgMaxWindow, static_cast<size_t>(kArgMaxWindow)},
+                  -1000, 1000),
+              {}};
+  }
+  YACL_THROW("unknown fn {}", static_cast<int>(fn));
+}
+
+xt::xarray<float> Expected(HalFn fn, const xt::xarray<float>& x,
+                           const xt::xarray<float>& y) {
+  switch (fn) {
+    case HalFn::Exp:
+      return xt::exp(x);
+    case HalFn::Log:
+      return xt::log(x);
+    case HalFn::Tanh:
+      return xt::tanh(x);
+    case HalFn::Rsqrt:
+      return 1.0f / xt::sqrt(x);
+    case HalFn::Div:
+      return x / y;
+    case HalFn::Sigmoid:
+      return 1.0f / (1.0f + xt::exp(-x));
+    case HalFn::Sort:
+      return xt::sort(x);
+    case HalFn::ArgMax:
+      return xt::amax(x, {1});
+  }
+  YACL_THROW("unknown fn {}", static_cast<int>(fn));
+}
+
+// Return the function values first, followed by the argmax mask.
+std::vector<spu::Value> Eval(HalContext* ctx, HalFn fn, const spu::Value& a,
+                             const spu::Value& b) {
+  switch (fn) {
+    case HalFn::Exp:
+      return {kernel::hal::f_exp(ctx, a)};
+    case HalFn::Log:
+      return {kernel::hal::f_log(ctx, a)};
+    case HalFn::Tanh:
+      return {kernel::hal::f_tanh(ctx, a)};
+    case HalFn::Rsqrt:
+      return {kernel::hal::f_rsqrt(ctx, a)};
+    case HalFn::Div:
+      return {kernel::hal::f_div(ctx, a, b)};
+    case HalFn::Sigmoid:
+      return {kernel::hal::logistic(ctx, a)};
+    case HalFn::Sort: {
+      auto comparator = [&](absl::Span<const spu::Value> values) {
+        return kernel::hal::less(ctx, values[0], values[1]);
+      };
+      return kernel::hlo::Sort(ctx, {a}, 0, false, comparator, VIS_SECRET);
+    }
+    case HalFn::ArgMax: {
+      const int64_t rows = a.shape()[0];
+      const std::vector<int64_t> window = {1, kArgMaxWindow};
+      const std::vector<int64_t> ones = {1, 1};
+      const std::vector<std::pair<int64_t, int64_t>> padding(2, {0, 0});
+      auto [value, mask] = kernel::hlo::ArgMax(
+          ctx, a, {rows, 1},
+          kernel::hlo::ReduceWindowConfig{window, ones, ones, padding, ones});
+      return {kernel::hal::reshape(ctx, value, {rows}),
+              kernel::hal::reshape(ctx, mask, {rows, kArgMaxWindow})};
+    }
+  }
+  YACL_THROW("unknown fn {}", static_cast<int>(fn));
+}
+
+xt::xarray<float> Open(HalContext* ctx, const spu::Value& v) {
+  auto p = v.isSecret() ? kernel::hal::reveal(ctx, v) : v;
+  if (!p.isFxp()) {
+    p = kernel::hal::dtype_cast(ctx, p, DT_FXP);
+  }
+  return xt_adapt<float>(kernel::hal::dump_public(ctx, p));
+}
+
+// Evaluate `fn` on n secret elements, range(0) is the protocol, range(1) is
+// the field, range(2) is n and range(3) is the mode of the function.
+void BM_HalFn(benchmark::State& state, HalFn fn) {
+  const auto protocol = static_cast<ProtocolKind>(state.range(0));
+  const auto n = static_cast<size_t>(state.range(2));
+
+  RuntimeConfig config;
+  config.set_protocol(protocol);
+  config.set_field(static_cast<FieldType>(state.range(1)));
+  SetMode(&config, fn, state.range(3));
+
+  const size_t world_size = protocol == ProtocolKind::ABY3 ? 3 : 2;
+  const auto inputs = MakeInputs(fn, n);
+  const auto& x = inputs.first;
+  const auto& y = inputs.second;
+  const xt::xarray<float> expected = Expected(fn, x, y);
+
+  for (auto _ : state) {
+    util::simulate(world_size, [&](const std::shared_ptr<yacl::link::Context>&
+                                       lctx) {
+      HalContext ctx(config, lctx);
+      auto* comm = ctx.prot()->getState<Communicator>();
+
+      auto a = kernel::hal::make_value(&ctx, VIS_SECRET, x);
+      spu::Value b;
+      if (y.size() != 0) {
+        b = kernel::hal::make_value(&ctx, VIS_SECRET, y);
+      }
+
+      const auto prev = comm->getStats();
+      const auto start = std::chrono::high_resolution_clock::now();
+      const auto outs = Eval(&ctx, fn, a, b);
+      const auto end = std::chrono::high_resolution_clock::now();
+      const auto cost = comm->getStats() - prev;
+
+      std::vector<xt::xarray<float>> got;
+      for (const auto& out : outs) {
+        got.push_back(Open(&ctx, out));
+      }
+      if (lctx->Rank() != 0) {
+        return;
+      }
+
+      state.SetIterationTime(
+          std::chrono::duration<double>(end - start).count());
+      state.counters["latency"] = cost.latency;
+      state.counters["comm"] = cost.comm;
+
+      const xt::xarray<float> abs_err = xt::abs(got[0] - expected);
+      state.counters["max_abs_err"] = xt::amax(abs_err)();
+      if (HasRelativeError(fn)) {
+        state.counters["max_rel_err"] =
+            xt::amax(abs_err / xt::abs(expected))();
+      }
+      if (fn == HalFn::ArgMax) {
+        const xt::xarray<size_t> want = xt::argmax(x, 1);
+        const xt::xarray<size_t> idx = xt::argmax(got[1], 1);
+        state.counters["mismatch"] =
+            static_cast<double>(xt::sum(xt::not_equal(idx, want))());
+      }
+    });
+  }
+}
+
+// The sizes are multiples of kArgMaxWindow.
+const std::vector<int64_t> kSizes =
+    benchmark::CreateRange(1 << 10, 1 << 16, /*multi=*/8);
+
+const std::vector<int64_t> kProtocols = {
+    ProtocolKind::SEMI2K, ProtocolKind::ABY3, ProtocolKind::CHEETAH};
+
+const std::vector<int64_t> kFields = {FieldType::FM64, FieldType::FM128};
+
+void Register(const char* name, HalFn fn, const std::vector<int64_t>& modes) {
+  benchmark::RegisterBenchmark(
+      fmt::format("BM_HalFn/{}", name).c_str(),
+      [fn](benchmark::State& state) { BM_HalFn(state, fn); })
+      ->ArgNames({"protocol", "field", "n", "mode"})
+      ->ArgsProduct({kProtocols, kFields, kSizes, modes})
+      ->UseManualTime()
+      ->Unit(benchmark::kMillisecond)
+      ->Iterations(1);
+}
+
+}  // namespace
+}  // namespace spu::mpc::bench
+
+int main(int argc, char** argv) {
+  using spu::RuntimeConfig;
+  using spu::mpc::bench::HalFn;
+  using spu::mpc::bench::Register;
+
+  Register("exp", HalFn::Exp,
+           {RuntimeConfig::EXP_PADE, RuntimeConfig::EXP_TAYLOR,
+            RuntimeConfig::EXP_PIECEWISE, RuntimeConfig::EXP_RANGE_REDUCED});
+  Register("log", HalFn::Log,
+           {RuntimeConfig::LOG_PADE, RuntimeConfig::LOG_NEWTON});
+  Register("tanh", HalFn::Tanh, {0});
+  Register("rsqrt", HalFn::Rsqrt,
+           {RuntimeConfig::RECIPROCAL_LINEAR, RuntimeConfig::RECIPROCAL_POLY});
+  Register("div", HalFn::Div,
+           {RuntimeConfig::RECIPROCAL_LINEAR, RuntimeConfig::RECIPROCAL_POLY});
+  Register("sigmoid", HalFn::Sigmoid,
+           {RuntimeConfig::SIGMOID_MM1, RuntimeConfig::SIGMOID_SEG3,
+            RuntimeConfig::SIGMOID_REAL, RuntimeConfig::SIGMOID_PIECEWISE});
+  Register("sort", HalFn::Sort,
+           {RuntimeConfig::SORT_BITONIC, RuntimeConfig::SORT_ODD_EVEN_MERGE});
+  Register("argmax", HalFn::ArgMax, {0});
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
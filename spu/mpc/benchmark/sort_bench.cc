@@ -0,0 +1,80 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+
+#include "benchmark/benchmark.h"
+#include "xtensor/xrandom.hpp"
+
+#include "spu/kernel/context.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/polymorphic.h"
+#include "spu/kernel/hlo/sort.h"
+#include "spu/mpc/util/communicator.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc::bench {
+
+// Sort secret keys of one row by a secret comparator with semi2k, range(0) is
+// the number of elements, range(1) is the sorting network.
+static void BM_SecretSort(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::SEMI2K);
+  config.set_field(FieldType::FM64);
+  config.set_sort_network(
+      static_cast<RuntimeConfig::SortNetwork>(state.range(1)));
+
+  const xt::xarray<int64_t> keys = xt::random::randint<int64_t>({n});
+
+  for (auto _ : state) {
+    util::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+      HalContext ctx(config, lctx);
+      auto* comm = ctx.prot()->getState<Communicator>();
+
+      auto k = kernel::hal::make_value(&ctx, VIS_SECRET, keys);
+      auto comparator = [&](absl::Span<const spu::Value> values) {
+        return kernel::hal::less(&ctx, values[0], values[1]);
+      };
+
+      const auto prev = comm->getStats();
+      const auto start = std::chrono::high_resolution_clock::now();
+      kernel::hlo::Sort(&ctx, {k}, 0, false, comparator, VIS_SECRET);
+      const auto end = std::chrono::high_resolution_clock::now();
+
+      if (lctx->Rank() == 0) {
+        const auto cost = comm->getStats() - prev;
+        state.SetIterationTime(
+            std::chrono::duration<double>(end - start).count());
+        state.counters["latency"] = cost.latency;
+        state.counters["comm"] = cost.comm;
+      }
+    });
+  }
+}
+
+BENCHMARK(BM_SecretSort)
+    ->ArgsProduct({
+        benchmark::CreateRange(1 << 10, 1 << 20, /*multi=*/4),  // n
+        {RuntimeConfig::SORT_BITONIC,
+         RuntimeConfig::SORT_ODD_EVEN_MERGE},  // network
+    })
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1);
+
+}  // namespace spu::mpc::bench
+
+BENCHMARK_MAIN();
@@ -14,12 +14,16 @@
 
 #include "standalone_bench.h"
 
+#include <chrono>
+#include <optional>
+
 #include "absl/strings/str_split.h"
 #include "llvm/Support/CommandLine.h"
 #include "utils.h"
 
 #include "spu/mpc/aby3/protocol.h"
 #include "spu/mpc/semi2k/protocol.h"
+#include "spu/mpc/util/network_emulator.h"
 
 namespace spu::mpc::bench {
 
@@ -36,10 +40,44 @@ void DefaultBMArguments(benchmark::internal::Benchmark* b) {
 // register benchmarks with arguments
 SPU_BM_PROTOCOL_REGISTER(DefaultBMArguments);
 
+void TruncModeBMArguments(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({{FieldType::FM32, FieldType::FM64, FieldType::FM128},
+                  {RuntimeConfig::TRUNC_DEFAULT, RuntimeConfig::TRUNC_LOCAL,
+                   RuntimeConfig::TRUNC_PAIR}})
+      ->Iterations(100);
+}
+
+SPU_BM_REGISTER_OP(truncpr_s_mode, TruncModeBMArguments);
+
 }  // namespace spu::mpc::bench
 
+// the emulated network of `net`, nullopt means no emulation.
+std::optional<spu::mpc::NetworkProfile> MakeNetworkProfile(
+    const std::string& net) {
+  using spu::mpc::NetworkProfile;
+  auto ms = [](double v) {
+    return std::chrono::duration_cast<spu::Duration>(
+        std::chrono::duration<double, std::milli>(v));
+  };
+
+  if (net == "none") {
+    return std::nullopt;
+  } else if (net == "lan") {
+    return NetworkProfile::lan();
+  } else if (net == "wan") {
+    return NetworkProfile::wan();
+  } else if (net == "custom") {
+    NetworkProfile profile;
+    profile.rtt = ms(cli_rtt_ms.getValue());
+    profile.bandwidth = cli_bandwidth_mbps.getValue() * 1e6 / 8;
+    profile.jitter = ms(cli_jitter_ms.getValue());
+    return profile;
+  }
+  YACL_THROW("unknown net: {}, supported = none/lan/wan/custom", net);
+}
+
 void PrepareBenchmark(uint32_t party_num, uint32_t numel, uint32_t shiftbit,
-                      std::string& protocol) {
+                      std::string& protocol, const std::string& net) {
   using BenchInteral = spu::mpc::bench::ComputeBench;
 
   if (protocol == "semi2k") {
@@ -60,11 +98,24 @@ void PrepareBenchmark(uint32_t party_num, uint32_t numel, uint32_t shiftbit,
 
   BenchInteral::bench_npc = party_num;
 
+  if (auto profile = MakeNetworkProfile(net)) {
+    auto factory = BenchInteral::bench_factory;
+    BenchInteral::bench_factory =
+        [factory, profile = *profile](
+            const spu::RuntimeConfig& conf,
+            const std::shared_ptr<yacl::link::Context>& lctx) {
+          auto obj = factory(conf, lctx);
+          obj->getState<spu::mpc::Communicator>()->setNetworkProfile(profile);
+          return obj;
+        };
+  }
+
   benchmark::AddCustomContext("Benchmark Party Number",
                               std::to_string(party_num));
   benchmark::AddCustomContext("Benchmark Data Size", std::to_string(numel));
   benchmark::AddCustomContext("Benchmark Shift Bits", std::to_string(shiftbit));
   benchmark::AddCustomContext("Benchmark Protocol", protocol);
+  benchmark::AddCustomContext("Benchmark Network", net);
 }
 
 // the main function
@@ -76,8 +127,8 @@ int main(int argc, char** argv) {
   auto bench_shiftbit = cli_shiftbit.getValue();
   auto bench_protocol = cli_protocol.getValue();
 
-  PrepareBenchmark(bench_party_num, bench_numel, bench_shiftbit,
-                   bench_protocol);
+  PrepareBenchmark(bench_party_num, bench_numel, bench_shiftbit, bench_protocol,
+                   cli_net.getValue());
 
   // these entries are from BENCHMARK_MAIN
   // ::benchmark::Initialize(&argc, argv); // remove all benchmark flags
@@ -14,13 +14,16 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 
 #include "benchmark/benchmark.h"
 #include "yacl/link/link.h"
 
 #include "spu/core/shape_util.h"  // calcNumel
 #include "spu/mpc/api.h"
+#include "spu/mpc/common/abprotocol.h"
 #include "spu/mpc/object.h"
 #include "spu/mpc/util/communicator.h"
 #include "spu/mpc/util/ring_ops.h"
@@ -266,6 +269,58 @@ SPU_BM_DEFINE_F(ComputeBench, truncpr_s)
   }
 }
 
+// truncpr_s by RuntimeConfig::TruncMode range(1), "error" is the max abs
+// error in units of the last bit, 1 is expected for probabilistic methods.
+SPU_BM_DEFINE_F(ComputeBench, truncpr_s_mode)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t npc = bench_npc;
+    const auto field = static_cast<spu::FieldType>(state.range(0));
+    const auto mode = static_cast<RuntimeConfig::TruncMode>(state.range(1));
+    if (mode == RuntimeConfig::TRUNC_LOCAL && npc != 2) {
+      state.SkipWithError("local truncation is for 2PC only");
+      break;
+    }
+    RuntimeConfig conf;
+    conf.set_field(field);
+    conf.set_trunc_mode(mode);
+
+    auto p0 = ring_rand_range(field, kNumel, /*min*/ -10000,
+                              /*max*/ 10000);
+
+    const size_t bits = 2;
+    ArrayRef revealed;
+    util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto obj = bench_factory(conf, lctx);
+      auto* comm = obj->getState<Communicator>();
+
+      auto s0 = p2s(obj.get(), p0);
+
+      ArrayRef r;
+      SPU_BM_SECTION(comm, r = truncpr_s(obj.get(), s0, bits));
+
+      auto p1 = s2p(obj.get(), r);
+      if (lctx->Rank() == 0) {
+        revealed = p1;
+      }
+    });
+
+    state.PauseTiming();
+    auto diff = ring_sub(revealed, ring_arshift(p0, bits));
+    int64_t error = 0;
+    DISPATCH_ALL_FIELDS(field, "_", [&]() {
+      using S = std::make_signed_t<ring2k_t>;
+      for (int64_t idx = 0; idx < diff.numel(); idx++) {
+        auto v = static_cast<S>(diff.at<ring2k_t>(idx));
+        error = std::max(error, static_cast<int64_t>(v < 0 ? -v : v));
+      }
+    });
+    state.counters["error"] = error;
+    state.ResumeTiming();
+  }
+}
+
 SPU_BM_DEFINE_F(ComputeBench, mmul_ss)
 (benchmark::State& state) {
   for (auto _ : state) {
@@ -372,6 +427,124 @@ SPU_BM_DEFINE_F(ComputeBench, s2p)
   }
 }
 
+// the msb by the dedicated msb_a kernel, vs. the full adder of a2b below.
+SPU_BM_DEFINE_F(ComputeBench, msb_a)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t npc = bench_npc;
+    const auto field = static_cast<spu::FieldType>(state.range(0));
+    RuntimeConfig conf;
+    conf.set_field(field);
+
+    util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto obj = bench_factory(conf, lctx);
+      auto* comm = obj->getState<Communicator>();
+
+      /* GIVEN */
+      auto p0 = rand_p(obj.get(), field, kNumel);
+      auto a0 = p2a(obj.get(), p0);
+
+      /* WHEN */
+      SPU_BM_SECTION(comm, msb_a(obj.get(), a0));
+    });
+  }
+}
+
+SPU_BM_DEFINE_F(ComputeBench, msb_a2b)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t npc = bench_npc;
+    const auto field = static_cast<spu::FieldType>(state.range(0));
+    RuntimeConfig conf;
+    conf.set_field(field);
+
+    util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto obj = bench_factory(conf, lctx);
+      auto* comm = obj->getState<Communicator>();
+
+      /* GIVEN */
+      auto p0 = rand_p(obj.get(), field, kNumel);
+      auto a0 = p2a(obj.get(), p0);
+
+      /* WHEN */
+      SPU_BM_SECTION(comm, rshift_b(obj.get(), a2b(obj.get(), a0),
+                                    SizeOf(field) * 8 - 1));
+    });
+  }
+}
+
+// the share conversions through the parallel prefix adder.
+SPU_BM_DEFINE_F(ComputeBench, a2b)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t npc = bench_npc;
+    const auto field = static_cast<spu::FieldType>(state.range(0));
+    RuntimeConfig conf;
+    conf.set_field(field);
+
+    util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto obj = bench_factory(conf, lctx);
+      auto* comm = obj->getState<Communicator>();
+
+      /* GIVEN */
+      auto p0 = rand_p(obj.get(), field, kNumel);
+      auto a0 = p2a(obj.get(), p0);
+
+      /* WHEN */
+      SPU_BM_SECTION(comm, a2b(obj.get(), a0));
+    });
+  }
+}
+
+SPU_BM_DEFINE_F(ComputeBench, b2a)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t npc = bench_npc;
+    const auto field = static_cast<spu::FieldType>(state.range(0));
+    RuntimeConfig conf;
+    conf.set_field(field);
+
+    util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto obj = bench_factory(conf, lctx);
+      auto* comm = obj->getState<Communicator>();
+
+      /* GIVEN */
+      auto p0 = rand_p(obj.get(), field, kNumel);
+      auto b0 = p2b(obj.get(), p0);
+
+      /* WHEN */
+      SPU_BM_SECTION(comm, b2a(obj.get(), b0));
+    });
+  }
+}
+
+SPU_BM_DEFINE_F(ComputeBench, add_bb)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t npc = bench_npc;
+    const auto field = static_cast<spu::FieldType>(state.range(0));
+    RuntimeConfig conf;
+    conf.set_field(field);
+
+    util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      auto obj = bench_factory(conf, lctx);
+      auto* comm = obj->getState<Communicator>();
+
+      /* GIVEN */
+      auto b0 = p2b(obj.get(), rand_p(obj.get(), field, kNumel));
+      auto b1 = p2b(obj.get(), rand_p(obj.get(), field, kNumel));
+
+      /* WHEN */
+      SPU_BM_SECTION(comm, add_bb(obj.get(), b0, b1));
+    });
+  }
+}
+
 /*
  * Benchmark Registers
  */
@@ -399,6 +572,11 @@ SPU_BM_DEFINE_F(ComputeBench, s2p)
   SPU_BM_REGISTER_OP(mmul_ss, Arguments)       \
   SPU_BM_REGISTER_OP(mmul_sp, Arguments)       \
   SPU_BM_REGISTER_OP(p2s, Arguments)           \
-  SPU_BM_REGISTER_OP(s2p, Arguments)
+  SPU_BM_REGISTER_OP(s2p, Arguments)           \
+  SPU_BM_REGISTER_OP(msb_a, Arguments)         \
+  SPU_BM_REGISTER_OP(msb_a2b, Arguments)       \
+  SPU_BM_REGISTER_OP(a2b, Arguments)           \
+  SPU_BM_REGISTER_OP(b2a, Arguments)           \
+  SPU_BM_REGISTER_OP(add_bb, Arguments)
 
 }  // namespace spu::mpc::bench
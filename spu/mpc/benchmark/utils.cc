@@ -29,3 +29,15 @@ llvm::cl::opt<uint32_t> cli_numel(
     "numel", llvm::cl::init(7), llvm::cl::desc("number of benchmark elements"));
 llvm::cl::opt<uint32_t> cli_shiftbit("shiftbit", llvm::cl::init(2),
                                      llvm::cl::desc("benchmark shift bit"));
+llvm::cl::opt<std::string> cli_net(
+    "net", llvm::cl::init("none"),
+    llvm::cl::desc("emulated network of standalone benchmarks, supported: "
+                   "none / lan / wan / custom"));
+llvm::cl::opt<double> cli_rtt_ms("rtt_ms", llvm::cl::init(0),
+                                 llvm::cl::desc("custom network rtt in ms"));
+llvm::cl::opt<double> cli_bandwidth_mbps(
+    "bandwidth_mbps", llvm::cl::init(0),
+    llvm::cl::desc("custom network bandwidth in Mbps, 0 means unlimited"));
+llvm::cl::opt<double> cli_jitter_ms(
+    "jitter_ms", llvm::cl::init(0),
+    llvm::cl::desc("custom network max jitter in ms"));
@@ -23,6 +23,10 @@ extern llvm::cl::opt<uint32_t> cli_party_num;
 extern llvm::cl::opt<uint32_t> cli_numel;
 extern llvm::cl::opt<uint32_t> cli_shiftbit;
 extern llvm::cl::opt<std::string> cli_protocol;
+extern llvm::cl::opt<std::string> cli_net;
+extern llvm::cl::opt<double> cli_rtt_ms;
+extern llvm::cl::opt<double> cli_bandwidth_mbps;
+extern llvm::cl::opt<double> cli_jitter_ms;
 
 namespace spu::mpc::bench {
 
@@ -15,6 +15,7 @@
 #include "spu/mpc/cheetah/arithmetic.h"
 
 #include <future>
+#include <vector>
 
 #include "spu/core/trace.h"
 #include "spu/core/vectorize.h"
@@ -30,6 +31,7 @@ ArrayRef TruncPrA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   SPU_TRACE_MPC_LEAF(ctx, x, bits);
   auto primitives =
       ctx->caller()->getState<CheetahState>()->beaver()->OTPrimitives();
+  OTCommScope comm_scope(ctx->caller()->getState<Communicator>(), primitives);
   size_t size = x.numel();
   const auto field = x.eltype().as<Ring2k>()->field();
   ArrayRef y(makeType<RingTy>(field), size);
@@ -37,8 +39,8 @@ ArrayRef TruncPrA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   if (heuristic) {
     // Use heuristic optimization from SecureQ8: Add a large positive to make
     // sure the value is always positive
-    ArrayRef adjusted_x =
-        ring_add(x, ring_lshift(ring_ones(field, size), x.elsize() * 8 - 5));
+    const auto big = uint128_t(1) << (x.elsize() * 8 - 5);
+    ArrayRef adjusted_x = ring_add(x, ring_constant_packed(field, size, big));
 
     DISPATCH_ALL_FIELDS(field, kBindName, [&]() {
       using U = ring2k_t;
@@ -48,8 +50,7 @@ ArrayRef TruncPrA::proc(KernelEvalContext* ctx, const ArrayRef& x,
                                              size, bits, sizeof(U) * 8);
       primitives->nonlinear()->flush();
     });
-    ring_sub_(y,
-              ring_lshift(ring_ones(field, size), x.elsize() * 8 - 5 - bits));
+    ring_sub_(y, ring_constant_packed(field, size, big >> bits));
   } else {
     DISPATCH_ALL_FIELDS(field, kBindName, [&]() {
       using U = ring2k_t;
@@ -67,6 +68,7 @@ ArrayRef MsbA::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
   SPU_TRACE_MPC_LEAF(ctx, x);
   auto primitives =
       ctx->caller()->getState<CheetahState>()->beaver()->OTPrimitives();
+  OTCommScope comm_scope(ctx->caller()->getState<Communicator>(), primitives);
 
   size_t size = x.numel();
   const auto field = x.eltype().as<Ring2k>()->field();
@@ -96,6 +98,29 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   auto beaver = ctx->caller()->getState<CheetahState>()->beaver();
   int rank = comm->getRank();
 
+  // A small array leaves most slots of the ciphertexts unused, so it takes
+  // triples from the ones generated by fully packed ciphertexts instead, and
+  // the HE cost is shared by the following small multiplies.
+  if (static_cast<size_t>(lhs.numel()) < beaver->MulPackSize()) {
+    const auto field = lhs.eltype().as<Ring2k>()->field();
+    auto [a, b, c] = beaver->PackedMul(field, lhs.numel());
+
+    // Open x-a & y-b
+    auto res =
+        vectorize({ring_sub(lhs, a), ring_sub(rhs, b)}, [&](const ArrayRef& s) {
+          return comm->allReduce(ReduceOp::ADD, s, kBindName);
+        });
+    auto x_a = std::move(res[0]);
+    auto y_b = std::move(res[1]);
+
+    // Zi = Ci + (X - A) * Bi + (Y - B) * Ai + <(X - A) * (Y - B)>
+    auto z = ring_add(ring_add(ring_mul(x_a, b), ring_mul(y_b, a)), c);
+    if (rank == 0) {
+      ring_add_(z, ring_mul(x_a, y_b));
+    }
+    return z.as(lhs.eltype());
+  }
+
   auto dupx = comm->lctx_->Spawn();
   // NOTE(juhou): we suppose rank0 and rank1 have the same level of computation
   // power. So we parallel the two computation by switching the role of
@@ -151,4 +176,45 @@ ArrayRef MatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   return z.as(x.eltype());
 }
 
+// The triples of the whole batch come from one BatchDot, which packs the small
+// matrices into shared ciphertexts, and the batch is opened at once.
+ArrayRef BatchMatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& x,
+                             const ArrayRef& y, size_t batch, size_t M,
+                             size_t N, size_t K) const {
+  SPU_TRACE_MPC_LEAF(ctx, x, y, batch);
+
+  const auto field = x.eltype().as<Ring2k>()->field();
+  auto comm = ctx->caller()->getState<Communicator>();
+  auto beaver = ctx->caller()->getState<CheetahState>()->beaver();
+
+  auto [a, b, c] = beaver->BatchDot(field, batch, M, N, K);
+
+  auto res =
+      vectorize({ring_sub(x, a), ring_sub(y, b)}, [&](const ArrayRef& s) {
+        return comm->allReduce(ReduceOp::ADD, s, kBindName);
+      });
+  auto x_a = std::move(res[0]);
+  auto y_b = std::move(res[1]);
+
+  std::vector<ArrayRef> zs;
+  zs.reserve(batch);
+  for (size_t i = 0; i < batch; ++i) {
+    auto lhs = [&](const ArrayRef& v) {
+      return v.slice(i * M * K, (i + 1) * M * K);
+    };
+    auto rhs = [&](const ArrayRef& v) {
+      return v.slice(i * K * N, (i + 1) * K * N);
+    };
+    auto z = ring_add(ring_add(ring_mmul(lhs(x_a), rhs(b), M, N, K),
+                               ring_mmul(lhs(a), rhs(y_b), M, N, K)),
+                      c.slice(i * M * N, (i + 1) * M * N));
+    if (comm->getRank() == 0) {
+      ring_add_(z, ring_mmul(lhs(x_a), rhs(y_b), M, N, K));
+    }
+    zs.push_back(std::move(z));
+  }
+  SimdTrait<ArrayRef>::PackInfo pi;
+  return SimdTrait<ArrayRef>::pack(zs.begin(), zs.end(), pi).as(x.eltype());
+}
+
 }  // namespace spu::mpc::cheetah
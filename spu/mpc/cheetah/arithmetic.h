@@ -27,6 +27,8 @@ using util::N;
 
 typedef spu::mpc::semi2k::ZeroA ZeroA;
 
+typedef spu::mpc::semi2k::RandA RandA;
+
 typedef spu::mpc::semi2k::P2A P2A;
 
 typedef spu::mpc::semi2k::A2P A2P;
@@ -102,4 +104,18 @@ class MatMulAA : public MatmulKernel {
                 size_t M, size_t N, size_t K) const override;
 };
 
+class BatchMatMulAA : public BatchMatmulKernel {
+ public:
+  static constexpr char kBindName[] = "batch_mmul_aa";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  util::CExpr latency() const override { return Const(1); }
+
+  util::CExpr comm() const override { return nullptr; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& A, const ArrayRef& B,
+                size_t batch, size_t M, size_t N, size_t K) const override;
+};
+
 }  // namespace spu::mpc::cheetah
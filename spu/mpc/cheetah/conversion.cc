@@ -31,6 +31,7 @@ ArrayRef B2A::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
 
   auto primitives =
       ctx->caller()->getState<CheetahState>()->beaver()->OTPrimitives();
+  OTCommScope comm_scope(ctx->caller()->getState<Communicator>(), primitives);
   auto shareType = x.eltype().as<semi2k::BShrTy>();
   const auto field = x.eltype().as<Ring2k>()->field();
   size_t size = x.numel();
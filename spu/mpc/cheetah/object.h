@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "spu/mpc/beaver/beaver_cheetah.h"
 #include "spu/mpc/util/communicator.h"
 
@@ -26,8 +28,9 @@ class CheetahState : public State {
  public:
   static constexpr char kBindName[] = "CheetahState";
 
-  explicit CheetahState(std::shared_ptr<yacl::link::Context> lctx) {
-    beaver_ = std::make_unique<BeaverCheetah>(lctx);
+  explicit CheetahState(std::shared_ptr<yacl::link::Context> lctx,
+                        std::string key_epoch = "") {
+    beaver_ = std::make_unique<BeaverCheetah>(lctx, std::move(key_epoch));
   }
 
   ~CheetahState() {}
@@ -35,4 +38,22 @@ class CheetahState : public State {
   BeaverCheetah* beaver() { return beaver_.get(); }
 };
 
+// The OT primitives talk over their own CheetahIo channel, which bypasses
+// the communicator. This attributes the traffic of the channel within the
+// scope to the communicator, each received message is counted as a round.
+class OTCommScope {
+  Communicator* comm_;
+  const spu::CheetahPrimitives* primitives_;
+  const spu::CheetahIo::Stats begin_;
+
+ public:
+  OTCommScope(Communicator* comm, const spu::CheetahPrimitives* primitives)
+      : comm_(comm), primitives_(primitives), begin_(primitives->ioStats()) {}
+
+  ~OTCommScope() {
+    const auto diff = primitives_->ioStats() - begin_;
+    comm_->addCommStatsManually(diff.recv_msgs, diff.sent_bytes);
+  }
+};
+
 }  // namespace spu::mpc
@@ -51,8 +51,10 @@ std::unique_ptr<Object> makeCheetahProtocol(
   regABKernels(obj.get());
 
   // register arithmetic & binary kernels
-  obj->addState<CheetahState>(lctx);
+  obj->addState<CheetahState>(lctx, conf.cheetah_key_epoch());
   obj->regKernel<cheetah::ZeroA>();
+  obj->regKernel<cheetah::RandA>();
+  regABRandKernels(obj.get());
   obj->regKernel<cheetah::P2A>();
   obj->regKernel<cheetah::A2P>();
   obj->regKernel<cheetah::NotA>();
@@ -62,6 +64,7 @@ std::unique_ptr<Object> makeCheetahProtocol(
   obj->regKernel<cheetah::MulAA>();
   obj->regKernel<cheetah::MatMulAP>();
   obj->regKernel<cheetah::MatMulAA>();
+  obj->regKernel<cheetah::BatchMatMulAA>();
   obj->regKernel<cheetah::LShiftA>();
   obj->regKernel<cheetah::TruncPrA>();
   obj->regKernel<cheetah::MsbA>();
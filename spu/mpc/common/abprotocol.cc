@@ -16,6 +16,7 @@
 
 #include "spu/core/trace.h"
 #include "spu/mpc/common/pub2k.h"
+#include "spu/mpc/util/ring_ops.h"
 
 namespace spu::mpc {
 namespace {
@@ -60,6 +61,7 @@ ArrayRef _Lazy2A(Object* obj, const ArrayRef& in) {
 #define _MulA1B(lhs, rhs) ctx->caller()->call("mul_a1b", lhs, rhs)
 #define _LShiftA(in, bits) ctx->caller()->call("lshift_a", in, bits)
 #define _TruncPrA(in, bits) ctx->caller()->call("truncpr_a", in, bits)
+#define _ShuffleA(in, rows) ctx->caller()->call("shuffle_a", in, rows)
 #define _MatMulAP(A, B, M, N, K) ctx->caller()->call("mmul_ap", A, B, M, N, K)
 #define _MatMulAA(A, B, M, N, K) ctx->caller()->call("mmul_aa", A, B, M, N, K)
 #define _B2P(x) ctx->caller()->call("b2p", x)
@@ -76,6 +78,9 @@ ArrayRef _Lazy2A(Object* obj, const ArrayRef& in) {
 #define _ARShiftB(in, bits) ctx->caller()->call("arshift_b", in, bits)
 #define _RitrevB(in, start, end) ctx->caller()->call("bitrev_b", in, start, end)
 #define _MsbA(in) ctx->caller()->call("msb_a", in)
+#define _RingCastDownA(in, field) \
+  ctx->caller()->call("ring_cast_down_a", in, field)
+#define _RingCastB(in, field) ctx->caller()->call("ring_cast_b", in, field)
 
 class ABProtState : public State {
  public:
@@ -278,6 +283,26 @@ class ABProtMatMulSP : public MatmulKernel {
   }
 };
 
+// The matmul of secrets truncated by `bits`, fused by protocols which
+// implement mmul_aa_trunc.
+class ABProtMatMulSSTrunc : public MatmulTruncKernel {
+ public:
+  static constexpr char kBindName[] = "mmul_ss_trunc";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& A, const ArrayRef& B,
+                size_t M, size_t N, size_t K, size_t bits) const override {
+    SPU_TRACE_MPC_DISP(ctx, A, B, bits);
+    const auto a = _LAZY_AB ? _2A(A) : A;
+    const auto b = _LAZY_AB ? _2A(B) : B;
+    if (ctx->caller()->hasKernel("mmul_aa_trunc")) {
+      return ctx->caller()->call("mmul_aa_trunc", a, b, M, N, K, bits);
+    }
+    return _TruncPrA(_MatMulAA(a, b, M, N, K), bits);
+  }
+};
+
 class ABProtMatMulSS : public MatmulKernel {
  public:
   static constexpr char kBindName[] = "mmul_ss";
@@ -294,6 +319,37 @@ class ABProtMatMulSS : public MatmulKernel {
   }
 };
 
+// Independent matmuls of secrets, run in one protocol invocation by protocols
+// which implement batch_mmul_aa, one by one otherwise.
+class ABProtBatchMatMulSS : public BatchMatmulKernel {
+ public:
+  static constexpr char kBindName[] = "batch_mmul_ss";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& A, const ArrayRef& B,
+                size_t batch, size_t M, size_t N, size_t K) const override {
+    SPU_TRACE_MPC_DISP(ctx, A, B, batch);
+    YACL_ENFORCE(A.numel() == static_cast<int64_t>(batch * M * K));
+    YACL_ENFORCE(B.numel() == static_cast<int64_t>(batch * K * N));
+    const auto a = _LAZY_AB ? _2A(A) : A;
+    const auto b = _LAZY_AB ? _2A(B) : B;
+    if (ctx->caller()->hasKernel("batch_mmul_aa")) {
+      return ctx->caller()->call("batch_mmul_aa", a, b, batch, M, N, K);
+    }
+
+    std::vector<ArrayRef> rets;
+    rets.reserve(batch);
+    for (size_t i = 0; i < batch; ++i) {
+      auto a_i = a.slice(i * M * K, (i + 1) * M * K);
+      auto b_i = b.slice(i * K * N, (i + 1) * K * N);
+      rets.push_back(_MatMulAA(a_i, b_i, M, N, K));
+    }
+    SimdTrait<ArrayRef>::PackInfo pi;
+    return SimdTrait<ArrayRef>::pack(rets.begin(), rets.end(), pi);
+  }
+};
+
 class ABProtAndSP : public BinaryKernel {
  public:
   static constexpr char kBindName[] = "and_sp";
@@ -366,8 +422,30 @@ class ABProtEqzS : public UnaryKernel {
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override {
     SPU_TRACE_MPC_DISP(ctx, in);
-    //
-    YACL_THROW("TODO");
+    if (_IsA(in) && ctx->caller()->hasKernel("eqz_a")) {
+      return ctx->caller()->call("eqz_a", in);
+    }
+
+    // or-tree of the bits, each level ors the low and high halves by one AND,
+    // over all elements in one round. The halves only hold the valid bits, so
+    // levels open fewer bits as they narrow.
+    const auto field = in.eltype().as<Ring2k>()->field();
+    const size_t k = SizeOf(field) * 8;
+    auto x = _2B(in);
+    for (size_t nbits = _NBits(x); nbits > 1;) {
+      const size_t half = (nbits + 1) / 2;
+      auto hi = _RShiftB(x, half);
+      auto lo = _RShiftB(_LShiftB(x, k - half), k - half);
+      x = _XorBB(_XorBB(lo, hi), _AndBB(lo, hi));
+      nbits = half;
+    }
+
+    // eqz = not(or), the shifts clear the bits above the lsb.
+    const auto one = ring_constant_packed(field, x.numel(), 1)
+                         .as(makeType<Pub2kTy>(field));
+    auto eq = _XorBP(x, one);
+    eq = _RShiftB(_LShiftB(eq, k - 1), k - 1);
+    return _LAZY_AB ? eq : _B2A(eq);
   }
 };
 
@@ -494,6 +572,66 @@ class ABProtMsbS : public UnaryKernel {
   }
 };
 
+// The msb of a secret which is known to fit in `nbits` signed bits.
+//
+// The arithmetic share is narrowed to the smallest ring holding nbits, which
+// is local, so the boolean circuits of the msb run on k' instead of k bits,
+// then the result bit is moved back to the original ring, which is local for
+// boolean shares too.
+class ABProtMsbNarrowS : public ShiftKernel {
+ public:
+  static constexpr char kBindName[] = "msb_narrow_s";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t nbits) const override {
+    SPU_TRACE_MPC_DISP(ctx, in, nbits);
+    const auto field = in.eltype().as<Ring2k>()->field();
+    const auto narrow = nbits <= 32 ? FM32 : nbits <= 64 ? FM64 : FM128;
+    if (SizeOf(narrow) >= SizeOf(field) || in.eltype().isa<BShare>() ||
+        !ctx->caller()->hasKernel("ring_cast_down_a") ||
+        !ctx->caller()->hasKernel("ring_cast_b")) {
+      return ctx->caller()->call("msb_s", in);
+    }
+
+    auto x = _RingCastDownA(in, narrow);
+    auto bit = ctx->caller()->hasKernel("msb_a")
+                   ? _MsbA(x)
+                   : _RShiftB(_A2B(x), SizeOf(narrow) * 8 - 1);
+    bit = _RingCastB(bit, field);
+    return _LAZY_AB ? bit : _B2A(bit);
+  }
+};
+
+class ABProtShuffleS : public ShuffleKernel {
+ public:
+  static constexpr char kBindName[] = "shuffle_s";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t rows) const override {
+    SPU_TRACE_MPC_DISP(ctx, in, rows);
+    // shuffle is linear, it only works on arithmetic shares.
+    return _ShuffleA(_2A(in), rows);
+  }
+};
+
+class ABProtRandS : public Kernel {
+ public:
+  static constexpr char kBindName[] = "rand_s";
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  void evaluate(KernelEvalContext* ctx) const override {
+    const auto field = ctx->getParam<FieldType>(0);
+    const auto size = ctx->getParam<size_t>(1);
+    SPU_TRACE_MPC_DISP(ctx, size);
+    ctx->setOutput(ctx->caller()->call("rand_a", field, size));
+  }
+};
+
 }  // namespace
 
 Type common_type_b(Object* ctx, const Type& a, const Type& b) {
@@ -508,6 +646,10 @@ ArrayRef zero_a(Object* ctx, FieldType field, size_t sz) {
   return ctx->call("zero_a", field, sz);
 }
 
+ArrayRef rand_a(Object* ctx, FieldType field, size_t sz) {
+  return ctx->call("rand_a", field, sz);
+}
+
 SPU_MPC_DEF_UNARY_OP(a2p)
 SPU_MPC_DEF_UNARY_OP(p2a)
 SPU_MPC_DEF_UNARY_OP(not_a)
@@ -519,6 +661,7 @@ SPU_MPC_DEF_BINARY_OP(mul_aa)
 SPU_MPC_DEF_BINARY_OP(mul_a1b)
 SPU_MPC_DEF_UNARY_OP_WITH_SIZE(lshift_a)
 SPU_MPC_DEF_UNARY_OP_WITH_SIZE(truncpr_a)
+SPU_MPC_DEF_UNARY_OP_WITH_SIZE(shuffle_a)
 SPU_MPC_DEF_MMUL(mmul_ap)
 SPU_MPC_DEF_MMUL(mmul_aa)
 
@@ -554,6 +697,8 @@ void regABKernels(Object* obj) {
   obj->regKernel<ABProtMulSS>();
   obj->regKernel<ABProtMatMulSP>();
   obj->regKernel<ABProtMatMulSS>();
+  obj->regKernel<ABProtMatMulSSTrunc>();
+  obj->regKernel<ABProtBatchMatMulSS>();
   obj->regKernel<ABProtAndSP>();
   obj->regKernel<ABProtAndSS>();
   obj->regKernel<ABProtXorSP>();
@@ -565,8 +710,15 @@ void regABKernels(Object* obj) {
   obj->regKernel<ABProtTruncPrS>();
   obj->regKernel<ABProtBitrevS>();
   obj->regKernel<ABProtMsbS>();
+  obj->regKernel<ABProtMsbNarrowS>();
 }
 
+void regABShuffleKernels(Object* obj) {
+  obj->regKernel<ABProtShuffleS>();
+}
+
+void regABRandKernels(Object* obj) { obj->regKernel<ABProtRandS>(); }
+
 #define COMMUTATIVE_DISPATCH(FnPP, FnBP, FnBB)     \
   if (_IsP(x) && _IsP(y)) {                        \
     return FnPP(ctx, x, y);                        \
@@ -24,6 +24,7 @@ ArrayRef a2p(Object* ctx, const ArrayRef&);
 ArrayRef p2a(Object* ctx, const ArrayRef&);
 
 ArrayRef zero_a(Object* ctx, FieldType, size_t);
+ArrayRef rand_a(Object* ctx, FieldType, size_t);
 
 ArrayRef not_a(Object* ctx, const ArrayRef&);
 ArrayRef msb_a(Object* ctx, const ArrayRef&);
@@ -38,6 +39,8 @@ ArrayRef mul_a1b(Object* ctx, const ArrayRef&, const ArrayRef&);
 ArrayRef lshift_a(Object* ctx, const ArrayRef&, size_t);
 ArrayRef truncpr_a(Object* ctx, const ArrayRef&, size_t);
 
+ArrayRef shuffle_a(Object* ctx, const ArrayRef&, size_t);
+
 ArrayRef mmul_ap(Object* ctx, const ArrayRef&, const ArrayRef&, size_t, size_t,
                  size_t);
 ArrayRef mmul_aa(Object* ctx, const ArrayRef&, const ArrayRef&, size_t, size_t,
@@ -70,6 +73,12 @@ ArrayRef add_bb(Object* ctx, const ArrayRef&, const ArrayRef&);
 
 void regABKernels(Object* obj);
 
+// Register shuffle_s, for protocols which implement shuffle_a.
+void regABShuffleKernels(Object* obj);
+
+// Register rand_s, for protocols which implement rand_a.
+void regABRandKernels(Object* obj);
+
 CircuitBasicBlock<ArrayRef> makeABProtBasicBlock(Object* ctx);
 
 }  // namespace spu::mpc
@@ -562,6 +562,43 @@ TEST_P(BooleanTest, BitrevB) {
   });
 }
 
+// and_bb of shares narrower than the ring only sends the valid bits.
+TEST_P(BooleanTest, AndBBNarrow) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+  const size_t k = SizeOf(conf.field()) * 8;
+
+  util::simulate(npc, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto obj = factory(conf, lctx);
+
+    for (size_t nbits : {1, 3}) {
+      /* GIVEN */
+      auto r0 = rand_p(obj.get(), conf.field(), kNumel);
+      auto r1 = rand_p(obj.get(), conf.field(), kNumel);
+      auto b0 = rshift_b(obj.get(), p2b(obj.get(), r0), k - nbits);
+      auto b1 = rshift_b(obj.get(), p2b(obj.get(), r1), k - nbits);
+
+      /* WHEN */
+      auto prev = obj->getState<Communicator>()->getStats();
+      auto tmp = and_bb(obj.get(), b0, b1);
+      auto cost = obj->getState<Communicator>()->getStats() - prev;
+
+      /* THEN */
+      auto rp = and_pp(obj.get(), rshift_p(obj.get(), r0, k - nbits),
+                       rshift_p(obj.get(), r1, k - nbits));
+      EXPECT_TRUE(ring_all_equal(b2p(obj.get(), tmp), rp));
+
+      auto* kernel = obj->getKernel("and_bb");
+      if (kernel->kind() == Kernel::Kind::kStatic) {
+        const size_t full_bits =
+            kernel->comm()->eval(conf.field(), npc) * kNumel;
+        EXPECT_LE(cost.comm * 8 * 4, full_bits) << nbits;
+      }
+    }
+  });
+}
+
 TEST_P(ConversionTest, A2B) {
   const auto factory = std::get<0>(GetParam());
   const RuntimeConfig& conf = std::get<1>(GetParam());
@@ -14,8 +14,11 @@
 
 #include "spu/mpc/common/prg_state.h"
 
+#include <algorithm>
+
 #include "yacl/crypto/tools/prg.h"
 #include "yacl/crypto/utils/rand.h"
+#include "yacl/utils/parallel.h"
 #include "yacl/utils/serialize.h"
 
 namespace spu::mpc {
@@ -71,6 +74,41 @@ PrgState::PrgState(std::shared_ptr<yacl::link::Context> lctx) {
   }
 }
 
+uint64_t PrgState::fillStreams(uint64_t counter,
+                               absl::Span<const Stream> streams) {
+  // chunks of the counter range, every chunk is filled at its own counter, as
+  // consecutive calls do.
+  constexpr size_t kChunkBlocks = 1 << 16;
+  constexpr size_t kChunkBytes = kChunkBlocks * sizeof(uint128_t);
+
+  // chunk_begin[i] is the index of the first chunk of streams[i].
+  std::vector<size_t> chunk_begin(streams.size() + 1, 0);
+  size_t max_bytes = 0;
+  for (size_t idx = 0; idx < streams.size(); idx++) {
+    const size_t nbytes = streams[idx].second.size();
+    chunk_begin[idx + 1] =
+        chunk_begin[idx] + (nbytes + kChunkBytes - 1) / kChunkBytes;
+    max_bytes = std::max(max_bytes, nbytes);
+  }
+
+  yacl::parallel_for(
+      0, chunk_begin.back(), 1, [&](int64_t begin, int64_t end) {
+        for (size_t chunk = begin; chunk < static_cast<size_t>(end); ++chunk) {
+          const size_t idx =
+              std::upper_bound(chunk_begin.begin(), chunk_begin.end(), chunk) -
+              chunk_begin.begin() - 1;
+          const auto& [seed, out] = streams[idx];
+          const size_t nth = chunk - chunk_begin[idx];
+          const size_t offset = nth * kChunkBytes;
+          yacl::FillPseudoRandom(
+              kAesType, seed, 0, counter + nth * kChunkBlocks,
+              out.subspan(offset, std::min(kChunkBytes, out.size() - offset)));
+        }
+      });
+
+  return counter + (max_bytes + sizeof(uint128_t) - 1) / sizeof(uint128_t);
+}
+
 std::pair<ArrayRef, ArrayRef> PrgState::genPrssPair(FieldType field,
                                                     size_t size,
                                                     bool ignore_first,
@@ -80,45 +118,31 @@ std::pair<ArrayRef, ArrayRef> PrgState::genPrssPair(FieldType field,
   ArrayRef r_self(ty, size);
   ArrayRef r_next(ty, size);
 
-  uint64_t new_counter = prss_counter_;
-  if (!ignore_first) {
-    new_counter =
-        yacl::FillPseudoRandom(kAesType, self_seed_, 0, prss_counter_,
-                               absl::MakeSpan(static_cast<char*>(r_self.data()),
-                                              r_self.buf()->size()));
-  }
-  if (!ignore_second) {
-    new_counter =
-        yacl::FillPseudoRandom(kAesType, next_seed_, 0, prss_counter_,
-                               absl::MakeSpan(static_cast<char*>(r_next.data()),
-                                              r_next.buf()->size()));
-  }
-
-  if (new_counter == prss_counter_) {
-    // both part ignored, dummy run to update counter...
-    new_counter = yacl::DummyUpdateRandomCount(
-        prss_counter_, absl::MakeSpan(static_cast<char*>(r_next.data()),
-                                      r_next.buf()->size()));
-  }
+  auto self_span = absl::MakeSpan(static_cast<char*>(r_self.data()),
+                                  r_self.buf()->size());
+  auto next_span = absl::MakeSpan(static_cast<char*>(r_next.data()),
+                                  r_next.buf()->size());
+  fillPrssPair(self_span, next_span, ignore_first, ignore_second);
 
-  prss_counter_ = new_counter;
   return std::make_pair(r_self, r_next);
 }
 
 ArrayRef PrgState::genPriv(FieldType field, size_t numel) {
   ArrayRef res(makeType<RingTy>(field), numel);
-  priv_counter_ = yacl::FillPseudoRandom(
-      kAesType, priv_seed_, 0, priv_counter_,
-      absl::MakeSpan(static_cast<char*>(res.data()), res.buf()->size()));
+  priv_counter_ = fillStreams(
+      priv_counter_,
+      {{priv_seed_, absl::MakeSpan(static_cast<char*>(res.data()),
+                                   res.buf()->size())}});
 
   return res;
 }
 
 ArrayRef PrgState::genPubl(FieldType field, size_t numel) {
   ArrayRef res(makeType<RingTy>(field), numel);
-  pub_counter_ = yacl::FillPseudoRandom(
-      kAesType, pub_seed_, 0, pub_counter_,
-      absl::MakeSpan(static_cast<char*>(res.data()), res.buf()->size()));
+  pub_counter_ = fillStreams(
+      pub_counter_,
+      {{pub_seed_, absl::MakeSpan(static_cast<char*>(res.data()),
+                                  res.buf()->size())}});
 
   return res;
 }
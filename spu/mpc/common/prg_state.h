@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "absl/types/span.h"
 #include "yacl/crypto/tools/prg.h"
 #include "yacl/link/link.h"
@@ -67,29 +70,45 @@ class PrgState : public State {
 
   template <typename T>
   void fillPriv(absl::Span<T> r) {
-    priv_counter_ =
-        yacl::FillPseudoRandom(kAesType, priv_seed_, 0, priv_counter_, r);
+    priv_counter_ = fillStreams(priv_counter_, {{priv_seed_, asBytes(r)}});
   }
 
   template <typename T>
   void fillPrssPair(absl::Span<T> r0, absl::Span<T> r1,
                     bool ignore_first = false, bool ignore_second = false) {
-    uint64_t new_counter = prss_counter_;
+    std::vector<Stream> streams;
     if (!ignore_first) {
-      new_counter =
-          yacl::FillPseudoRandom(kAesType, self_seed_, 0, prss_counter_, r0);
+      streams.emplace_back(self_seed_, asBytes(r0));
     }
     if (!ignore_second) {
-      new_counter =
-          yacl::FillPseudoRandom(kAesType, next_seed_, 0, prss_counter_, r1);
+      streams.emplace_back(next_seed_, asBytes(r1));
     }
 
-    if (new_counter == prss_counter_) {
+    if (streams.empty()) {
       // both part ignored, dummy run to update counter...
-      new_counter = yacl::DummyUpdateRandomCount(prss_counter_, r0);
+      prss_counter_ = yacl::DummyUpdateRandomCount(prss_counter_, r0);
+      return;
     }
-    prss_counter_ = new_counter;
+    prss_counter_ = fillStreams(prss_counter_, streams);
   }
+
+ private:
+  // A seed and the bytes filled by its AES-CTR stream.
+  using Stream = std::pair<uint128_t, absl::Span<char>>;
+
+  template <typename T>
+  static absl::Span<char> asBytes(absl::Span<T> r) {
+    return absl::MakeSpan(reinterpret_cast<char*>(r.data()),
+                          r.size() * sizeof(T));
+  }
+
+  // Fill all streams from `counter` on, return the counter after the longest.
+  //
+  // The counter ranges are cut into fixed chunks which threads fill
+  // concurrently, across streams too, so the output is the same as serial
+  // calls regardless of the number of threads.
+  static uint64_t fillStreams(uint64_t counter,
+                              absl::Span<const Stream> streams);
 };
 
 }  // namespace spu::mpc
@@ -12,4 +12,49 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// TODO(jint) test me
+#include "spu/mpc/common/prg_state.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc {
+
+TEST(PrgStateTest, PrssPair) {
+  constexpr size_t kWorldSize = 3;
+  // 3 chunks of the prg plus a partial block in FM64.
+  constexpr size_t kNumel = (3 << 17) + 1;
+  constexpr size_t kBytes = kNumel * sizeof(uint64_t);
+
+  std::vector<std::pair<ArrayRef, ArrayRef>> pairs(kWorldSize);
+  std::vector<std::array<std::vector<uint64_t>, 2>> fills(kWorldSize);
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    PrgState state(lctx);
+    pairs[lctx->Rank()] = state.genPrssPair(FM64, kNumel);
+
+    // the next counter range.
+    auto& [r0, r1] = fills[lctx->Rank()];
+    r0.resize(kNumel);
+    r1.resize(kNumel);
+    state.fillPrssPair(absl::MakeSpan(r0), absl::MakeSpan(r1));
+  });
+
+  for (size_t rank = 0; rank < kWorldSize; rank++) {
+    const size_t next = (rank + 1) % kWorldSize;
+    // r1 = next_party.r0
+    EXPECT_EQ(std::memcmp(pairs[rank].second.data(), pairs[next].first.data(),
+                          kBytes),
+              0);
+    EXPECT_EQ(fills[rank][1], fills[next][0]);
+
+    EXPECT_NE(std::memcmp(pairs[rank].first.data(), fills[rank][0].data(),
+                          kBytes),
+              0);
+  }
+}
+
+}  // namespace spu::mpc
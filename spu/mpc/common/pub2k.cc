@@ -23,6 +23,68 @@
 #include "spu/mpc/util/ring_ops.h"
 
 namespace spu::mpc {
+namespace pub2k {
+
+ArrayRef not_p(const ArrayRef& in) {
+  const auto field = in.eltype().as<Ring2k>()->field();
+  return ring_not(in).as(makeType<Pub2kTy>(field));
+}
+
+ArrayRef eqz_p(const ArrayRef& in) {
+  const auto field = in.eltype().as<Ring2k>()->field();
+  return ring_equal(in, ring_zeros_packed(field, in.numel())).as(in.eltype());
+}
+
+ArrayRef msb_p(const ArrayRef& in) {
+  return ring_rshift(in, in.elsize() * 8 - 1).as(in.eltype());
+}
+
+ArrayRef add_pp(const ArrayRef& lhs, const ArrayRef& rhs) {
+  YACL_ENFORCE(lhs.eltype() == rhs.eltype());
+  return ring_add(lhs, rhs).as(lhs.eltype());
+}
+
+ArrayRef mul_pp(const ArrayRef& lhs, const ArrayRef& rhs) {
+  YACL_ENFORCE(lhs.eltype() == rhs.eltype());
+  return ring_mul(lhs, rhs).as(lhs.eltype());
+}
+
+ArrayRef and_pp(const ArrayRef& lhs, const ArrayRef& rhs) {
+  YACL_ENFORCE(lhs.eltype() == rhs.eltype());
+  return ring_and(lhs, rhs).as(lhs.eltype());
+}
+
+ArrayRef xor_pp(const ArrayRef& lhs, const ArrayRef& rhs) {
+  YACL_ENFORCE(lhs.eltype() == rhs.eltype());
+  return ring_xor(lhs, rhs).as(lhs.eltype());
+}
+
+ArrayRef mmul_pp(const ArrayRef& lhs, const ArrayRef& rhs, size_t M, size_t N,
+                 size_t K) {
+  YACL_ENFORCE(lhs.eltype() == rhs.eltype());
+  return ring_mmul(lhs, rhs, M, N, K).as(lhs.eltype());
+}
+
+ArrayRef lshift_p(const ArrayRef& in, size_t bits) {
+  return ring_lshift(in, bits).as(in.eltype());
+}
+
+ArrayRef rshift_p(const ArrayRef& in, size_t bits) {
+  return ring_rshift(in, bits).as(in.eltype());
+}
+
+ArrayRef arshift_p(const ArrayRef& in, size_t bits) {
+  return ring_arshift(in, bits).as(in.eltype());
+}
+
+ArrayRef bitrev_p(const ArrayRef& in, size_t start, size_t end) {
+  const auto field = in.eltype().as<Ring2k>()->field();
+  YACL_ENFORCE(start <= end);
+  YACL_ENFORCE(end <= SizeOf(field) * 8);
+  return ring_bitrev(in, start, end).as(in.eltype());
+}
+
+}  // namespace pub2k
 
 class Pub2kRandP : public Kernel {
  public:
@@ -54,8 +116,7 @@ class Pub2kNotP : public UnaryKernel {
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override {
     SPU_TRACE_MPC_LEAF(ctx, in);
-    const auto field = in.eltype().as<Ring2k>()->field();
-    return ring_not(in).as(makeType<Pub2kTy>(field));
+    return pub2k::not_p(in);
   }
 };
 
@@ -69,8 +130,7 @@ class Pub2kEqzP : public UnaryKernel {
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override {
     SPU_TRACE_MPC_LEAF(ctx, in);
-    const auto field = in.eltype().as<Ring2k>()->field();
-    return ring_equal(in, ring_zeros(field, in.numel())).as(in.eltype());
+    return pub2k::eqz_p(in);
   }
 };
 
@@ -85,8 +145,7 @@ class Pub2kAddPP : public BinaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                 const ArrayRef& rhs) const override {
     SPU_TRACE_MPC_LEAF(ctx, lhs, rhs);
-    YACL_ENFORCE(lhs.eltype() == rhs.eltype());
-    return ring_add(lhs, rhs).as(lhs.eltype());
+    return pub2k::add_pp(lhs, rhs);
   }
 };
 
@@ -101,8 +160,7 @@ class Pub2kMulPP : public BinaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                 const ArrayRef& rhs) const override {
     SPU_TRACE_MPC_LEAF(ctx, lhs, rhs);
-    YACL_ENFORCE(lhs.eltype() == rhs.eltype());
-    return ring_mul(lhs, rhs).as(lhs.eltype());
+    return pub2k::mul_pp(lhs, rhs);
   }
 };
 
@@ -118,8 +176,7 @@ class Pub2kMatMulPP : public MatmulKernel {
                 const ArrayRef& rhs, size_t M, size_t N,
                 size_t K) const override {
     SPU_TRACE_MPC_LEAF(ctx, lhs, rhs);
-    YACL_ENFORCE(lhs.eltype() == rhs.eltype());
-    return ring_mmul(lhs, rhs, M, N, K).as(lhs.eltype());
+    return pub2k::mmul_pp(lhs, rhs, M, N, K);
   }
 };
 
@@ -134,8 +191,7 @@ class Pub2kAndPP : public BinaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                 const ArrayRef& rhs) const override {
     SPU_TRACE_MPC_LEAF(ctx, lhs, rhs);
-    YACL_ENFORCE(lhs.eltype() == rhs.eltype());
-    return ring_and(lhs, rhs).as(lhs.eltype());
+    return pub2k::and_pp(lhs, rhs);
   }
 };
 
@@ -150,8 +206,7 @@ class Pub2kXorPP : public BinaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                 const ArrayRef& rhs) const override {
     SPU_TRACE_MPC_LEAF(ctx, lhs, rhs);
-    YACL_ENFORCE(lhs.eltype() == rhs.eltype());
-    return ring_xor(lhs, rhs).as(lhs.eltype());
+    return pub2k::xor_pp(lhs, rhs);
   }
 };
 
@@ -166,7 +221,7 @@ class Pub2kLShiftP : public ShiftKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
                 size_t bits) const override {
     SPU_TRACE_MPC_LEAF(ctx, in, bits);
-    return ring_lshift(in, bits).as(in.eltype());
+    return pub2k::lshift_p(in, bits);
   }
 };
 
@@ -181,7 +236,7 @@ class Pub2kRShiftP : public ShiftKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
                 size_t bits) const override {
     SPU_TRACE_MPC_LEAF(ctx, in, bits);
-    return ring_rshift(in, bits).as(in.eltype());
+    return pub2k::rshift_p(in, bits);
   }
 };
 
@@ -195,12 +250,8 @@ class Pub2kBitrevP : public BitrevKernel {
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in, size_t start,
                 size_t end) const override {
-    const auto field = in.eltype().as<Ring2k>()->field();
-    YACL_ENFORCE(start <= end);
-    YACL_ENFORCE(end <= SizeOf(field) * 8);
-
     SPU_TRACE_MPC_LEAF(ctx, in, start, end);
-    return ring_bitrev(in, start, end).as(in.eltype());
+    return pub2k::bitrev_p(in, start, end);
   }
 };
 
@@ -215,7 +266,7 @@ class Pub2kARShiftP : public ShiftKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
                 size_t bits) const override {
     SPU_TRACE_MPC_LEAF(ctx, in, bits);
-    return ring_arshift(in, bits).as(in.eltype());
+    return pub2k::arshift_p(in, bits);
   }
 };
 
@@ -229,7 +280,7 @@ class Pub2kMsbP : public UnaryKernel {
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override {
     SPU_TRACE_MPC_LEAF(ctx, in);
-    return ring_rshift(in, in.elsize() * 8 - 1).as(in.eltype());
+    return pub2k::msb_p(in);
   }
 };
 
@@ -33,4 +33,29 @@ void regPub2kTypes();
 
 void regPub2kKernels(Object* obj);
 
+// The bodies of Pub2k kernels, public values are the same on all parties and
+// need no communication, so callers which know the inputs are Pub2k could call
+// them directly and skip the kernel dispatch.
+namespace pub2k {
+
+ArrayRef not_p(const ArrayRef& in);
+ArrayRef eqz_p(const ArrayRef& in);
+ArrayRef msb_p(const ArrayRef& in);
+
+ArrayRef add_pp(const ArrayRef& lhs, const ArrayRef& rhs);
+ArrayRef mul_pp(const ArrayRef& lhs, const ArrayRef& rhs);
+ArrayRef and_pp(const ArrayRef& lhs, const ArrayRef& rhs);
+ArrayRef xor_pp(const ArrayRef& lhs, const ArrayRef& rhs);
+
+ArrayRef mmul_pp(const ArrayRef& lhs, const ArrayRef& rhs, size_t M, size_t N,
+                 size_t K);
+
+ArrayRef lshift_p(const ArrayRef& in, size_t bits);
+ArrayRef rshift_p(const ArrayRef& in, size_t bits);
+ArrayRef arshift_p(const ArrayRef& in, size_t bits);
+
+ArrayRef bitrev_p(const ArrayRef& in, size_t start, size_t end);
+
+}  // namespace pub2k
+
 }  // namespace spu::mpc
@@ -33,6 +33,16 @@ std::unique_ptr<Object> Factory::CreateCompute(
     const std::shared_ptr<yacl::link::Context>& lctx) {
   switch (conf.protocol()) {
     case ProtocolKind::REF2K: {
+      if (conf.sim_protocol() != ProtocolKind::PROT_INVALID) {
+        YACL_ENFORCE(conf.sim_protocol() != ProtocolKind::REF2K,
+                     "can not simulate ref2k by itself");
+        // only the kernel complexities of the simulated protocol are used.
+        RuntimeConfig sim_conf = conf;
+        sim_conf.set_protocol(conf.sim_protocol());
+        sim_conf.clear_sim_protocol();
+        auto sim_prot = CreateCompute(sim_conf, lctx);
+        return makeRef2kSimProtocol(conf, lctx, sim_prot.get());
+      }
       return makeRef2kProtocol(conf, lctx);
     }
     case ProtocolKind::SEMI2K: {
@@ -17,10 +17,20 @@
 #include <utility>
 #include <vector>
 
+#include "yacl/base/int128.h"
+
 #include "spu/core/array_ref.h"
 
 namespace spu::mpc {
 
+// A share made by makeSeededSecret.
+struct SeededShare {
+  // The part sent as is with type as RingTy, empty if it is all seeded.
+  ArrayRef plain;
+  // The seeds of the other parts.
+  std::vector<uint128_t> seeds;
+};
+
 // The basic io interface of protocols.
 class IoInterface {
  public:
@@ -44,6 +54,20 @@ class IoInterface {
   virtual std::vector<ArrayRef> makeBitSecret(const ArrayRef& raw) const = 0;
   virtual bool hasBitSecretSupport() const = 0;
 
+  // Make a secret whose shares are expanded from prg seeds as much as the
+  // protocol allows, so the owner sends seeds instead of most of the shares.
+  //
+  // @param raw, with type as RingTy.
+  // @param owner_rank, the party making the shares.
+  // @return what to send to each party.
+  virtual std::vector<SeededShare> makeSeededSecret(
+      const ArrayRef& raw, size_t owner_rank) const = 0;
+  // Rebuild the share of party `rank` of `numel` elements from what
+  // makeSeededSecret of `owner_rank` made for it.
+  virtual ArrayRef expandSeededShare(const SeededShare& share, size_t numel,
+                                     size_t rank, size_t owner_rank) const = 0;
+  virtual bool hasSeededSecretSupport() const = 0;
+
   // Reconstruct shares into a RingTy value.
   //
   // @param shares, a list of secret shares.
@@ -65,6 +89,16 @@ class BaseIo : public IoInterface {
     YACL_THROW("should not be here");
   }
   bool hasBitSecretSupport() const override { return false; }
+
+  std::vector<SeededShare> makeSeededSecret(const ArrayRef& raw,
+                                            size_t owner_rank) const override {
+    YACL_THROW("should not be here");
+  }
+  ArrayRef expandSeededShare(const SeededShare& share, size_t numel,
+                             size_t rank, size_t owner_rank) const override {
+    YACL_THROW("should not be here");
+  }
+  bool hasSeededSecretSupport() const override { return false; }
 };
 
 }  // namespace spu::mpc
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <type_traits>
 #include <variant>
 
 #include "yacl/base/exception.h"
@@ -44,6 +45,11 @@ class KernelEvalContext final {
  public:
   explicit KernelEvalContext(Object* caller) : caller_(caller) {}
 
+  // Reserve room for `num_params` params, so binding does not reallocate.
+  KernelEvalContext(Object* caller, size_t num_params) : caller_(caller) {
+    params_.reserve(num_params);
+  }
+
   size_t numParams() const { return params_.size(); }
 
   // Steal the output from this evaluation context.
@@ -67,6 +73,9 @@ class KernelEvalContext final {
   // * usually called by kernel callee.
   template <typename T = Object>
   T* caller() {
+    if constexpr (std::is_same_v<T, Object>) {
+      return caller_;
+    }
     if (auto caller = dynamic_cast<T*>(caller_)) {
       return caller;
     }
@@ -176,6 +185,35 @@ class MatmulKernel : public Kernel {
                         size_t K) const = 0;
 };
 
+class MatmulTruncKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(proc(ctx, ctx->getParam<ArrayRef>(0),
+                        ctx->getParam<ArrayRef>(1), ctx->getParam<size_t>(2),
+                        ctx->getParam<size_t>(3), ctx->getParam<size_t>(4),
+                        ctx->getParam<size_t>(5)));
+  }
+  // A * B truncated by `bits`.
+  virtual ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& A,
+                        const ArrayRef& B, size_t M, size_t N, size_t K,
+                        size_t bits) const = 0;
+};
+
+class BatchMatmulKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(proc(ctx, ctx->getParam<ArrayRef>(0),
+                        ctx->getParam<ArrayRef>(1), ctx->getParam<size_t>(2),
+                        ctx->getParam<size_t>(3), ctx->getParam<size_t>(4),
+                        ctx->getParam<size_t>(5)));
+  }
+  // `batch` independent products A[i] * B[i], each of A, B and the output is
+  // the row-major concatenation of the batch.
+  virtual ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& A,
+                        const ArrayRef& B, size_t batch, size_t M, size_t N,
+                        size_t K) const = 0;
+};
+
 class BitrevKernel : public Kernel {
  public:
   void evaluate(KernelEvalContext* ctx) const override {
@@ -186,6 +224,29 @@ class BitrevKernel : public Kernel {
                         size_t start, size_t end) const = 0;
 };
 
+class CastRingKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(
+        proc(ctx, ctx->getParam<ArrayRef>(0), ctx->getParam<FieldType>(1)));
+  }
+  // Move `in` to the ring of `to_field`.
+  virtual ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                        FieldType to_field) const = 0;
+};
+
+class ShuffleKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(
+        proc(ctx, ctx->getParam<ArrayRef>(0), ctx->getParam<size_t>(1)));
+  }
+  // `in` is a column-major matrix of `rows` rows, all columns are shuffled by
+  // the same random permutation.
+  virtual ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                        size_t rows) const = 0;
+};
+
 class TruncPrAKernel : public ShiftKernel {
  public:
   virtual bool isPrecise() const = 0;
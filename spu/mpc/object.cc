@@ -14,12 +14,47 @@
 
 #include "spu/mpc/object.h"
 
+#include <functional>
+#include <mutex>
+
 namespace spu::mpc {
+namespace {
+
+// Interned kernel names, the nodes of std::map are stable, so names could be
+// referred by string_view.
+struct KernelNameTable {
+  std::mutex mutex;
+  std::map<std::string, size_t, std::less<>> indices;
+};
+
+KernelNameTable& getKernelNameTable() {
+  static KernelNameTable table;
+  return table;
+}
+
+}  // namespace
+
+KernelName::KernelName(std::string_view name) {
+  auto& table = getKernelNameTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto itr = table.indices.find(name);
+  if (itr == table.indices.end()) {
+    itr = table.indices.emplace(std::string(name), table.indices.size()).first;
+  }
+  name_ = itr->first;
+  index_ = itr->second;
+}
 
 void Object::regKernel(std::string_view name, std::unique_ptr<Kernel> kernel) {
-  const auto itr = kernels_.find(name);
+  const KernelName kname(name);
+  const auto itr = kernels_.find(kname.name());
   YACL_ENFORCE(itr == kernels_.end(), "kernel={} already exist", name);
-  kernels_.insert({name, std::move(kernel)});
+
+  if (kernel_table_.size() <= kname.index()) {
+    kernel_table_.resize(kname.index() + 1, nullptr);
+  }
+  kernel_table_[kname.index()] = kernel.get();
+  kernels_.insert({kname.name(), std::move(kernel)});
 }
 
 Kernel* Object::getKernel(std::string_view name) {
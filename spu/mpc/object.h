@@ -17,6 +17,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "spu/core/trace.h"
 #include "spu/mpc/kernel.h"
@@ -28,6 +29,33 @@ class State {
   virtual ~State() = default;
 };
 
+// An interface which could be implemented by states to observe kernel calls,
+// i.e. to attribute statistics to the running kernel.
+class KernelObserver {
+ public:
+  virtual ~KernelObserver() = default;
+
+  virtual void onKernelBegin(std::string_view name) = 0;
+  virtual void onKernelEnd(std::string_view name) = 0;
+};
+
+// A kernel name interned to a process wide dense index, objects resolve it by
+// indexing a table instead of searching the name. Call sites should resolve it
+// once, i.e.
+//
+//   static const KernelName kName("add_pp");
+//   obj->call(kName, x, y);
+class KernelName {
+  std::string_view name_;
+  size_t index_;
+
+ public:
+  explicit KernelName(std::string_view name);
+
+  std::string_view name() const { return name_; }
+  size_t index() const { return index_; }
+};
+
 // A (kernel) dynamic object dispatch a function to a kernel at runtime.
 //
 // Class that inherit from this class could do `dynamic binding`.
@@ -35,6 +63,33 @@ class Object {
   std::map<std::string_view, std::unique_ptr<Kernel>> kernels_;
   std::map<std::string_view, std::unique_ptr<State>> states_;
 
+  // kernels_ indexed by KernelName::index, nullptr if not registered.
+  std::vector<Kernel*> kernel_table_;
+
+  // states which implement KernelObserver, owned by states_.
+  std::vector<KernelObserver*> observers_;
+
+  // notify observers even when the kernel throws.
+  class ObserverGuard {
+    const std::vector<KernelObserver*>& observers_;
+    std::string_view name_;
+
+   public:
+    ObserverGuard(const std::vector<KernelObserver*>& observers,
+                  std::string_view name)
+        : observers_(observers), name_(name) {
+      for (auto* observer : observers_) {
+        observer->onKernelBegin(name_);
+      }
+    }
+
+    ~ObserverGuard() {
+      for (auto* observer : observers_) {
+        observer->onKernelEnd(name_);
+      }
+    }
+  };
+
  public:
   std::string name() const { return "TODO"; }
 
@@ -51,11 +106,23 @@ class Object {
   }
 
   Kernel* getKernel(std::string_view name);
+
+  Kernel* getKernel(const KernelName& name) {
+    const size_t index = name.index();
+    if (index < kernel_table_.size() && kernel_table_[index] != nullptr) {
+      return kernel_table_[index];
+    }
+    YACL_THROW("kernel={} not found", name.name());
+  }
+
   bool hasKernel(std::string_view name) const;
 
   void addState(std::string_view name, std::unique_ptr<State> state) {
     const auto& itr = states_.find(name);
     YACL_ENFORCE(itr == states_.end(), "state={} already exist", name);
+    if (auto* observer = dynamic_cast<KernelObserver*>(state.get())) {
+      observers_.push_back(observer);
+    }
     states_.emplace(name, std::move(state));
   }
 
@@ -72,6 +139,11 @@ class Object {
     return dynamic_cast<StateT*>(itr->second.get());
   }
 
+  template <typename StateT>
+  bool hasState() const {
+    return states_.find(StateT::kBindName) != states_.end();
+  }
+
   //
   std::vector<std::string_view> getKernelNames() const {
     std::vector<std::string_view> names;
@@ -99,11 +171,23 @@ class Object {
   }
 
   template <typename Ret = ArrayRef, typename... Args>
-  Ret call(std::string_view name, Args&&... args) {
-    Kernel* kernel = getKernel(name);
-    KernelEvalContext ctx(this);
+  Ret callKernel(Kernel* kernel, std::string_view name, Args&&... args) {
+    KernelEvalContext ctx(this, sizeof...(Args));
+    ObserverGuard guard(observers_, name);
     return callImpl<Ret>(kernel, &ctx, std::forward<Args>(args)...);
   }
+
+  template <typename Ret = ArrayRef, typename... Args>
+  Ret call(std::string_view name, Args&&... args) {
+    return callKernel<Ret>(getKernel(name), name, std::forward<Args>(args)...);
+  }
+
+  // Prefer this on hot paths, it skips the search of the name.
+  template <typename Ret = ArrayRef, typename... Args>
+  Ret call(const KernelName& name, Args&&... args) {
+    return callKernel<Ret>(getKernel(name), name.name(),
+                           std::forward<Args>(args)...);
+  }
 };
 
 }  // namespace spu::mpc
@@ -0,0 +1,84 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Latency of the kernel dispatch of Object::call, the kernel does nothing so
+// the time is all dispatch overhead.
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+
+#include "spu/mpc/object.h"
+
+namespace spu::mpc {
+namespace {
+
+class NopKernel : public BinaryKernel {
+ public:
+  static constexpr char kBindName[] = "nop_pp";
+
+  ArrayRef proc(KernelEvalContext*, const ArrayRef& lhs,
+                const ArrayRef&) const override {
+    return lhs;
+  }
+};
+
+// about as many kernels as a protocol.
+void regKernels(Object* obj) {
+  for (size_t idx = 0; idx < 64; idx++) {
+    obj->regKernel<NopKernel>(fmt::format("padding_{}", idx));
+  }
+  obj->regKernel<NopKernel>();
+}
+
+void BM_CallByString(benchmark::State& state) {
+  Object obj;
+  regKernels(&obj);
+  const ArrayRef x(makeType<RingTy>(FM64), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(obj.call(NopKernel::kBindName, x, x));
+  }
+}
+
+void BM_CallByKernelName(benchmark::State& state) {
+  Object obj;
+  regKernels(&obj);
+  const ArrayRef x(makeType<RingTy>(FM64), 1);
+  static const KernelName kName(NopKernel::kBindName);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(obj.call(kName, x, x));
+  }
+}
+
+void BM_DirectEvaluate(benchmark::State& state) {
+  Object obj;
+  regKernels(&obj);
+  const ArrayRef x(makeType<RingTy>(FM64), 1);
+  auto* kernel = obj.getKernel(NopKernel::kBindName);
+  for (auto _ : state) {
+    KernelEvalContext ctx(&obj, 2);
+    ctx.bindParam(x);
+    ctx.bindParam(x);
+    kernel->evaluate(&ctx);
+    benchmark::DoNotOptimize(ctx.stealOutput());
+  }
+}
+
+BENCHMARK(BM_CallByString);
+BENCHMARK(BM_CallByKernelName);
+BENCHMARK(BM_DirectEvaluate);
+
+}  // namespace
+}  // namespace spu::mpc
+
+BENCHMARK_MAIN();
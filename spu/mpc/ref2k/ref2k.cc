@@ -14,11 +14,19 @@
 
 #include "spu/mpc/ref2k/ref2k.h"
 
+#include <map>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "spu/core/type.h"
+#include "spu/core/type_util.h"
+#include "spu/mpc/beaver/prg_tensor.h"
 #include "spu/mpc/common/prg_state.h"
 #include "spu/mpc/common/pub2k.h"
+#include "spu/mpc/util/communicator.h"
 #include "spu/mpc/util/ring_ops.h"
 
 namespace spu::mpc {
@@ -148,7 +156,7 @@ class Ref2kEqzS : public UnaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override {
     SPU_TRACE_MPC_LEAF(ctx, in);
     const auto field = in.eltype().as<Ring2k>()->field();
-    return ring_equal(in, ring_zeros(field, in.numel())).as(in.eltype());
+    return ring_equal(in, ring_zeros_packed(field, in.numel())).as(in.eltype());
   }
 };
 
@@ -387,6 +395,195 @@ class Ref2kMsbS : public UnaryKernel {
   }
 };
 
+class Ref2kShuffleS : public ShuffleKernel {
+ public:
+  static constexpr char kBindName[] = "shuffle_s";
+
+  util::CExpr latency() const override { return util::Const(0); }
+
+  util::CExpr comm() const override { return util::Const(0); }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t rows) const override {
+    SPU_TRACE_MPC_LEAF(ctx, in, rows);
+    YACL_ENFORCE(rows > 0 && in.numel() % rows == 0);
+
+    // all parties hold the plaintext, use a public permutation.
+    auto* state = ctx->caller()->getState<PrgState>();
+    const auto perm = prgPermutation(state->genPubl(FieldType::FM64, rows));
+
+    const size_t cols = in.numel() / rows;
+    ArrayRef out(in.eltype(), in.numel());
+    DISPATCH_ALL_FIELDS(in.eltype().as<Ring2k>()->field(), "_", [&]() {
+      using U = ring2k_t;
+      for (size_t col = 0; col < cols; col++) {
+        for (size_t row = 0; row < rows; row++) {
+          out.at<U>(col * rows + row) = in.at<U>(col * rows + perm[row]);
+        }
+      }
+    });
+    return out;
+  }
+};
+
+// The costs of a simulated protocol, i.e. the kernels of it a ref2k kernel
+// would have called, which follows the non-lazy path of abprotocol, secrets
+// are arithmetic shares between kernels.
+class Ref2kSimCost : public State {
+ public:
+  static constexpr char kBindName[] = "Ref2kSimCost";
+
+  Ref2kSimCost(Object* sim_prot, ProtocolKind sim_protocol, FieldType field,
+               size_t world_size)
+      : open_mmul_operands_(sim_protocol == ProtocolKind::SEMI2K) {
+    using Plan = std::vector<std::string>;
+    const Plan msb_plan = sim_prot->hasKernel("msb_a")
+                              ? Plan{"msb_a", "b2a"}
+                              : Plan{"a2b", "rshift_b", "b2a"};
+    plans_ = {
+        {"s2p", {"a2p"}},
+        {"mul_sp", {"mul_ap"}},
+        {"mul_ss", {"mul_aa"}},
+        {"mmul_sp", {"mmul_ap"}},
+        {"and_sp", {"a2b", "and_bp", "b2a"}},
+        {"and_ss", {"a2b", "a2b", "and_bb", "b2a"}},
+        {"xor_sp", {"a2b", "xor_bp", "b2a"}},
+        {"xor_ss", {"a2b", "a2b", "xor_bb", "b2a"}},
+        {"rshift_s", {"a2b", "rshift_b", "b2a"}},
+        {"arshift_s", {"a2b", "arshift_b", "b2a"}},
+        {"bitrev_s", {"a2b", "bitrev_b", "b2a"}},
+        {"truncpr_s", {"truncpr_a"}},
+        {"msb_s", msb_plan},
+    };
+
+    for (const auto& [name, plan] : plans_) {
+      for (const auto& kernel : plan) {
+        if (costs_.count(kernel) > 0 || !sim_prot->hasKernel(kernel)) {
+          continue;
+        }
+        auto* impl = sim_prot->getKernel(kernel);
+        auto latency = impl->latency();
+        auto comm = impl->comm();
+        if (latency != nullptr && comm != nullptr) {
+          costs_[kernel] = {latency->eval(field, world_size),
+                            comm->eval(field, world_size)};
+        }
+      }
+    }
+    // matrix multiplications depend on shapes, they are modeled by mul_aa.
+    if (auto itr = costs_.find("mul_aa"); itr != costs_.end()) {
+      mmul_cost_ = itr->second;
+    }
+  }
+
+  // Account the simulated cost of a call of `name` to `comm`.
+  void account(std::string_view name, KernelEvalContext* ctx,
+               Communicator* comm) const {
+    if (name == "mmul_ss") {
+      accountMmul(ctx, comm);
+      return;
+    }
+    auto itr = plans_.find(name);
+    if (itr == plans_.end()) {
+      return;
+    }
+    const size_t numel = ctx->getParam<ArrayRef>(0).numel();
+    for (const auto& kernel : itr->second) {
+      auto cost = costs_.find(kernel);
+      if (cost != costs_.end()) {
+        add(comm, cost->second.first, cost->second.second * numel);
+      }
+    }
+  }
+
+ private:
+  // a beaver triple opens both operands for semi2k, others reshare the
+  // products.
+  void accountMmul(KernelEvalContext* ctx, Communicator* comm) const {
+    if (!mmul_cost_.has_value()) {
+      return;
+    }
+    const auto M = ctx->getParam<size_t>(2);
+    const auto N = ctx->getParam<size_t>(3);
+    const auto K = ctx->getParam<size_t>(4);
+    const size_t bits = open_mmul_operands_
+                            ? mmul_cost_->second * (M * K + K * N) / 2
+                            : mmul_cost_->second * M * N;
+    add(comm, mmul_cost_->first, bits);
+  }
+
+  static void add(Communicator* comm, size_t latency, size_t bits) {
+    comm->addCommStatsManually(latency, (bits + 7) / 8);
+  }
+
+  const bool open_mmul_operands_;
+
+  // the kernels of the simulated protocol run by a ref2k kernel.
+  std::map<std::string, std::vector<std::string>, std::less<>> plans_;
+
+  // rounds and comm bits per element of a kernel of the simulated protocol,
+  // kernels of no complexity expression are absent, i.e. free.
+  std::map<std::string, std::pair<size_t, size_t>, std::less<>> costs_;
+
+  std::optional<std::pair<size_t, size_t>> mmul_cost_;
+};
+
+// Run a ref2k kernel, then account the cost of the simulated protocol.
+class Ref2kSimKernel : public Kernel {
+  const std::string name_;
+  const std::unique_ptr<Kernel> kernel_;
+
+ public:
+  Ref2kSimKernel(std::string_view name, std::unique_ptr<Kernel> kernel)
+      : name_(name), kernel_(std::move(kernel)) {}
+
+  Kind kind() const override { return Kind::kDynamic; }
+
+  void evaluate(KernelEvalContext* ctx) const override {
+    kernel_->evaluate(ctx);
+    auto* obj = ctx->caller();
+    obj->getState<Ref2kSimCost>()->account(name_, ctx,
+                                           obj->getState<Communicator>());
+  }
+};
+
+template <typename KernelT>
+void regRef2kKernel(Object* obj, bool simulated,
+                    std::string_view name = KernelT::kBindName) {
+  if (simulated) {
+    obj->regKernel(name, std::make_unique<Ref2kSimKernel>(
+                             name, std::make_unique<KernelT>()));
+  } else {
+    obj->regKernel<KernelT>(name);
+  }
+}
+
+void regRef2kKernels(Object* obj, bool simulated) {
+  regRef2kKernel<Ref2kCommonTypeS>(obj, simulated);
+  regRef2kKernel<Ref2kCastTypeS>(obj, simulated);
+  regRef2kKernel<Ref2kP2S>(obj, simulated);
+  regRef2kKernel<Ref2kS2P>(obj, simulated);
+  regRef2kKernel<Ref2kNotS>(obj, simulated);
+  regRef2kKernel<Ref2kEqzS>(obj, simulated);
+  regRef2kKernel<Ref2kAddSS>(obj, simulated);
+  regRef2kKernel<Ref2kAddSP>(obj, simulated);
+  regRef2kKernel<Ref2kMulSS>(obj, simulated);
+  regRef2kKernel<Ref2kMulSP>(obj, simulated);
+  regRef2kKernel<Ref2kMatMulSS>(obj, simulated);
+  regRef2kKernel<Ref2kMatMulSP>(obj, simulated);
+  regRef2kKernel<Ref2kAndSS>(obj, simulated);
+  regRef2kKernel<Ref2kAndSP>(obj, simulated);
+  regRef2kKernel<Ref2kXorSS>(obj, simulated);
+  regRef2kKernel<Ref2kXorSP>(obj, simulated);
+  regRef2kKernel<Ref2kLShiftS>(obj, simulated);
+  regRef2kKernel<Ref2kRShiftS>(obj, simulated);
+  regRef2kKernel<Ref2kBitrevS>(obj, simulated);
+  regRef2kKernel<Ref2kARShiftS>(obj, simulated);
+  regRef2kKernel<Ref2kARShiftS>(obj, simulated, "truncpr_s");
+  regRef2kKernel<Ref2kMsbS>(obj, simulated);
+  regRef2kKernel<Ref2kShuffleS>(obj, simulated);
+}
+
 }  // namespace
 
 std::unique_ptr<Object> makeRef2kProtocol(
@@ -403,28 +600,25 @@ std::unique_ptr<Object> makeRef2kProtocol(
   regPub2kKernels(obj.get());
 
   // register compute kernels
-  obj->regKernel<Ref2kCommonTypeS>();
-  obj->regKernel<Ref2kCastTypeS>();
-  obj->regKernel<Ref2kP2S>();
-  obj->regKernel<Ref2kS2P>();
-  obj->regKernel<Ref2kNotS>();
-  obj->regKernel<Ref2kEqzS>();
-  obj->regKernel<Ref2kAddSS>();
-  obj->regKernel<Ref2kAddSP>();
-  obj->regKernel<Ref2kMulSS>();
-  obj->regKernel<Ref2kMulSP>();
-  obj->regKernel<Ref2kMatMulSS>();
-  obj->regKernel<Ref2kMatMulSP>();
-  obj->regKernel<Ref2kAndSS>();
-  obj->regKernel<Ref2kAndSP>();
-  obj->regKernel<Ref2kXorSS>();
-  obj->regKernel<Ref2kXorSP>();
-  obj->regKernel<Ref2kLShiftS>();
-  obj->regKernel<Ref2kRShiftS>();
-  obj->regKernel<Ref2kBitrevS>();
-  obj->regKernel<Ref2kARShiftS>();
-  obj->regKernel<Ref2kARShiftS>("truncpr_s");
-  obj->regKernel<Ref2kMsbS>();
+  regRef2kKernels(obj.get(), /*simulated*/ false);
+
+  return obj;
+}
+
+std::unique_ptr<Object> makeRef2kSimProtocol(
+    const RuntimeConfig& conf,
+    const std::shared_ptr<yacl::link::Context>& lctx, Object* sim_prot) {
+  registerTypes();
+
+  auto obj = std::make_unique<Object>();
+
+  obj->addState<PrgState>();
+  obj->addState<Communicator>(lctx);
+  obj->addState<Ref2kSimCost>(sim_prot, conf.sim_protocol(), conf.field(),
+                              lctx->WorldSize());
+
+  regPub2kKernels(obj.get());
+  regRef2kKernels(obj.get(), /*simulated*/ true);
 
   return obj;
 }
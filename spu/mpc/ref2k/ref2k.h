@@ -35,6 +35,14 @@ std::unique_ptr<Object> makeRef2kProtocol(
     const RuntimeConfig& conf,
     const std::shared_ptr<yacl::link::Context>& lctx);
 
+// A ref2k protocol which accounts the rounds and communication `sim_prot`,
+// the protocol of conf.sim_protocol(), would have taken, to the kernel stats
+// of its Communicator. Costs follow the complexity expressions of the kernels
+// of `sim_prot`, kernels of no expression count as free.
+std::unique_ptr<Object> makeRef2kSimProtocol(
+    const RuntimeConfig& conf,
+    const std::shared_ptr<yacl::link::Context>& lctx, Object* sim_prot);
+
 std::unique_ptr<Ref2kIo> makeRef2kIo(FieldType field, size_t npc);
 
 }  // namespace spu::mpc
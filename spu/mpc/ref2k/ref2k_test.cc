@@ -14,8 +14,14 @@
 
 #include "spu/mpc/ref2k/ref2k.h"
 
+#include "gtest/gtest.h"
+
+#include "spu/mpc/api.h"
 #include "spu/mpc/api_test.h"
+#include "spu/mpc/factory.h"
 #include "spu/mpc/io_test.h"
+#include "spu/mpc/util/communicator.h"
+#include "spu/mpc/util/simulate.h"
 
 namespace spu::mpc::test {
 namespace {
@@ -51,4 +57,34 @@ INSTANTIATE_TEST_SUITE_P(
       return fmt::format("{}x{}", std::get<1>(p.param), std::get<2>(p.param));
     });
 
+// The simulated costs match the costs of the real protocol.
+TEST(Ref2kSimTest, Semi2k) {
+  const size_t kWorldSize = 2;
+  const size_t kNumel = 100;
+
+  RuntimeConfig conf = makeConfig(FieldType::FM64);
+  conf.set_protocol(ProtocolKind::SEMI2K);
+  RuntimeConfig sim_conf = conf;
+  sim_conf.set_protocol(ProtocolKind::REF2K);
+  sim_conf.set_sim_protocol(ProtocolKind::SEMI2K);
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    auto run = [&](const RuntimeConfig& c) {
+      auto obj = Factory::CreateCompute(c, lctx);
+      auto x = p2s(obj.get(), rand_p(obj.get(), c.field(), kNumel));
+      auto y = p2s(obj.get(), rand_p(obj.get(), c.field(), kNumel));
+
+      auto* comm = obj->getState<Communicator>();
+      const auto prev = comm->getStats();
+      s2p(obj.get(), truncpr_s(obj.get(), mul_ss(obj.get(), x, y), 10));
+      return comm->getStats() - prev;
+    };
+
+    const auto real = run(conf);
+    const auto sim = run(sim_conf);
+    EXPECT_EQ(sim.latency, real.latency);
+    EXPECT_EQ(sim.comm, real.comm);
+  });
+}
+
 }  // namespace spu::mpc::test
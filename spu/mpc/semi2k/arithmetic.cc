@@ -14,6 +14,10 @@
 
 #include "spu/mpc/semi2k/arithmetic.h"
 
+#include <vector>
+
+#include "absl/types/span.h"
+
 #include "spu/core/trace.h"
 #include "spu/core/vectorize.h"
 #include "spu/mpc/common/abprotocol.h"  // zero_a
@@ -36,6 +40,16 @@ ArrayRef ZeroA::proc(KernelEvalContext* ctx, FieldType field,
   return ring_sub(r0, r1).as(makeType<AShrTy>(field));
 }
 
+ArrayRef RandA::proc(KernelEvalContext* ctx, FieldType field,
+                     size_t size) const {
+  SPU_TRACE_MPC_LEAF(ctx, size);
+
+  auto* prg_state = ctx->caller()->getState<PrgState>();
+
+  // the sum of shares is uniform unless all parties collude.
+  return prg_state->genPriv(field, size).as(makeType<AShrTy>(field));
+}
+
 ArrayRef P2A::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
   SPU_TRACE_MPC_LEAF(ctx, in);
 
@@ -83,7 +97,7 @@ ArrayRef NotA::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
   auto res = ring_neg(in);
   if (comm->getRank() == 0) {
     const auto field = in.eltype().as<Ring2k>()->field();
-    ring_add_(res, ring_not(ring_zeros(field, in.numel())));
+    ring_add_(res, ring_constant_packed(field, in.numel(), ~uint128_t(0)));
   }
 
   return res.as(in.eltype());
@@ -126,6 +140,58 @@ ArrayRef MulAP::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   return ring_mul(lhs, rhs).as(lhs.eltype());
 }
 
+namespace {
+
+// Zi = Ci + (X - A) * Bi + (Y - B) * Ai + <(X - A) * (Y - B)>
+//
+// All terms are evaluated in one pass and written to `z` directly.
+void mulOpened(Communicator* comm, const ArrayRef& x_a, const ArrayRef& y_b,
+               const ArrayRef& a, const ArrayRef& b, const ArrayRef& c,
+               ArrayRef& z) {
+  std::vector<RingTerm> terms = {{c}, {x_a, b}, {y_b, a}};
+  if (comm->getRank() == 0) {
+    // z += (X-A) * (Y-B);
+    terms.push_back({x_a, y_b});
+  }
+  ring_linear_combination_(z, terms);
+}
+
+// Open (x-a, y-b) chunk by chunk, all chunks are issued first, so the local
+// computation of chunk i overlaps with the transfer of the following ones.
+ArrayRef mulPipelined(Communicator* comm, const ArrayRef& lhs,
+                      const ArrayRef& rhs, const ArrayRef& a, const ArrayRef& b,
+                      const ArrayRef& c, int64_t chunk_size) {
+  const int64_t numel = lhs.numel();
+
+  std::vector<std::future<ArrayRef>> opened;
+  for (int64_t begin = 0; begin < numel; begin += chunk_size) {
+    const int64_t end = std::min(begin + chunk_size, numel);
+    std::vector<ArrayRef> masked = {
+        ring_sub(lhs.slice(begin, end), a.slice(begin, end)),
+        ring_sub(rhs.slice(begin, end), b.slice(begin, end))};
+    SimdTrait<ArrayRef>::PackInfo pi;
+    opened.push_back(comm->iallReduce(
+        ReduceOp::ADD,
+        SimdTrait<ArrayRef>::pack(masked.begin(), masked.end(), pi),
+        MulAA::kBindName));
+  }
+
+  ArrayRef z(c.eltype(), numel);
+  for (int64_t begin = 0, idx = 0; begin < numel; begin += chunk_size, idx++) {
+    const int64_t end = std::min(begin + chunk_size, numel);
+    const int64_t n = end - begin;
+    auto res = opened[idx].get();
+
+    auto z_chunk = z.slice(begin, end);
+    mulOpened(comm, res.slice(0, n), res.slice(n, 2 * n), a.slice(begin, end),
+              b.slice(begin, end), c.slice(begin, end), z_chunk);
+  }
+
+  return z;
+}
+
+}  // namespace
+
 ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
                      const ArrayRef& rhs) const {
   SPU_TRACE_MPC_LEAF(ctx, lhs, rhs);
@@ -135,6 +201,11 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   auto* beaver = ctx->caller()->getState<Semi2kState>()->beaver();
   auto [a, b, c] = beaver->Mul(field, lhs.numel());
 
+  const auto chunk_size = static_cast<int64_t>(comm->getPipelineChunkSize());
+  if (chunk_size > 0 && lhs.numel() > chunk_size) {
+    return mulPipelined(comm, lhs, rhs, a, b, c, chunk_size).as(lhs.eltype());
+  }
+
   // Open x-a & y-b
   auto res =
       vectorize({ring_sub(lhs, a), ring_sub(rhs, b)}, [&](const ArrayRef& s) {
@@ -144,13 +215,8 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   auto x_a = std::move(res[0]);
   auto y_b = std::move(res[1]);
 
-  // Zi = Ci + (X - A) * Bi + (Y - B) * Ai + <(X - A) * (Y - B)>
-  auto z = ring_add(ring_add(ring_mul(x_a, b), ring_mul(y_b, a)), c);
-  if (comm->getRank() == 0) {
-    // z += (X-A) * (Y-B);
-    ring_add_(z, ring_mul(x_a, y_b));
-  }
-
+  ArrayRef z(c.eltype(), lhs.numel());
+  mulOpened(comm, x_a, y_b, a, b, c, z);
   return z.as(lhs.eltype());
 }
 
@@ -183,13 +249,13 @@ ArrayRef MatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   auto y_b = std::move(res[1]);
 
   // Zi = Ci + (X - A) dot Bi + Ai dot (Y - B) + <(X - A) dot (Y - B)>
-  auto z = ring_add(
-      ring_add(ring_mmul(x_a, b, M, N, K), ring_mmul(a, y_b, M, N, K)), c);
+  std::vector<ArrayRef> terms = {ring_mmul(x_a, b, M, N, K),
+                                 ring_mmul(a, y_b, M, N, K), c};
   if (comm->getRank() == 0) {
     // z += (X-A) * (Y-B);
-    ring_add_(z, ring_mmul(x_a, y_b, M, N, K));
+    terms.push_back(ring_mmul(x_a, y_b, M, N, K));
   }
-  return z.as(x.eltype());
+  return ring_sum(terms).as(x.eltype());
 }
 
 ArrayRef LShiftA::proc(KernelEvalContext* ctx, const ArrayRef& in,
@@ -206,30 +272,103 @@ ArrayRef TruncPrA::proc(KernelEvalContext* ctx, const ArrayRef& x,
                         size_t bits) const {
   SPU_TRACE_MPC_LEAF(ctx, x, bits);
   auto* comm = ctx->caller()->getState<Communicator>();
+  auto* state = ctx->caller()->getState<Semi2kState>();
+  auto* beaver = state->beaver();
+
+  auto mode = state->truncMode();
+  if (mode == RuntimeConfig::TRUNC_DEFAULT) {
+    mode = comm->getWorldSize() == 2u || !beaver->SupportTrunc()
+               ? RuntimeConfig::TRUNC_LOCAL
+               : RuntimeConfig::TRUNC_PAIR;
+  }
 
-  // TODO: add trunction method to options.
-  if (comm->getWorldSize() == 2u) {
+  if (mode == RuntimeConfig::TRUNC_LOCAL) {
+    YACL_ENFORCE(comm->getWorldSize() == 2u,
+                 "local truncation is for 2PC only, got {} parties",
+                 comm->getWorldSize());
     // SecurlML, local trunction.
     // Ref: Theorem 1. https://eprint.iacr.org/2017/396.pdf
     return ring_arshift(x, bits).as(x.eltype());
-  } else {
-    // ABY3, truncation pair method.
-    // Ref: Section 5.1.2 https://eprint.iacr.org/2018/403.pdf
-    auto* beaver = ctx->caller()->getState<Semi2kState>()->beaver();
-
-    const auto field = x.eltype().as<Ring2k>()->field();
-    const auto& [r, rb] = beaver->Trunc(field, x.numel(), bits);
-
-    // open x - r
-    auto x_r = comm->allReduce(ReduceOp::ADD, ring_sub(x, r), kBindName);
-    auto res = rb;
-    if (comm->getRank() == 0) {
-      ring_add_(res, ring_arshift(x_r, bits));
+  }
+
+  // ABY3, truncation pair method.
+  // Ref: Section 5.1.2 https://eprint.iacr.org/2018/403.pdf
+  YACL_ENFORCE(beaver->SupportTrunc(), "beaver does not support trunc pairs");
+
+  const auto field = x.eltype().as<Ring2k>()->field();
+  const auto& [r, rb] = beaver->Trunc(field, x.numel(), bits);
+
+  // open x - r to rank 0 only, the only party which uses it, so other parties
+  // send k bits each instead of broadcasting.
+  auto x_r = comm->reduce(ReduceOp::ADD, ring_sub(x, r), 0, kBindName);
+  auto res = rb;
+  if (comm->getRank() == 0) {
+    ring_add_(res, ring_arshift(x_r, bits));
+  }
+
+  // res = [x-r] + [r], x which [*] is truncation operation.
+  return res.as(x.eltype());
+}
+
+namespace {
+
+// out[col, row] = in[col, perm[row]], of a column-major matrix.
+ArrayRef permuteRows(const ArrayRef& in, size_t rows,
+                     absl::Span<const int64_t> perm) {
+  const auto field = in.eltype().as<Ring2k>()->field();
+  const size_t cols = in.numel() / rows;
+  ArrayRef out(in.eltype(), in.numel());
+
+  DISPATCH_ALL_FIELDS(field, "_", [&]() {
+    using U = ring2k_t;
+    for (size_t col = 0; col < cols; col++) {
+      for (size_t row = 0; row < rows; row++) {
+        out.at<U>(col * rows + row) = in.at<U>(col * rows + perm[row]);
+      }
     }
+  });
+  return out;
+}
+
+}  // namespace
+
+ArrayRef ShuffleA::proc(KernelEvalContext* ctx, const ArrayRef& in,
+                        size_t rows) const {
+  SPU_TRACE_MPC_LEAF(ctx, in, rows);
 
-    // res = [x-r] + [r], x which [*] is truncation operation.
-    return res.as(x.eltype());
+  YACL_ENFORCE(rows > 0 && in.numel() % rows == 0,
+               "numel={} is not a multiple of rows={}", in.numel(), rows);
+
+  const auto field = in.eltype().as<Ring2k>()->field();
+  const size_t cols = in.numel() / rows;
+  auto* comm = ctx->caller()->getState<Communicator>();
+  auto* beaver = ctx->caller()->getState<Semi2kState>()->beaver();
+  YACL_ENFORCE(beaver->SupportPerm(), "beaver does not support permutation");
+
+  // In the round of party r, with correlation (a_j, b_j) and (perm, delta):
+  //   party j sends x_j - a_j to r, and sets y_j = b_j.
+  //   party r sets y_r = perm(x_r + sum(x_j - a_j)) + delta.
+  // so that sum(y) = perm(sum(x)).
+  ArrayRef out = in;
+  for (size_t perm_rank = 0; perm_rank < comm->getWorldSize(); perm_rank++) {
+    std::vector<int64_t> perm;
+    auto [a, b] = beaver->Perm(field, rows, cols, perm_rank, &perm);
+
+    if (comm->getRank() == perm_rank) {
+      auto masked = out.clone();
+      for (size_t rank = 0; rank < comm->getWorldSize(); rank++) {
+        if (rank != perm_rank) {
+          ring_add_(masked, comm->recv(rank, in.eltype(), kBindName));
+        }
+      }
+      out = ring_add(permuteRows(masked, rows, perm), b);
+    } else {
+      comm->sendAsync(perm_rank, ring_sub(out, a), kBindName);
+      out = b;
+    }
   }
+
+  return out.as(in.eltype());
 }
 
 }  // namespace spu::mpc::semi2k
@@ -41,6 +41,23 @@ class ZeroA : public Kernel {
   ArrayRef proc(KernelEvalContext* ctx, FieldType field, size_t size) const;
 };
 
+// A random secret of private randomness of every party, no communication.
+class RandA : public Kernel {
+ public:
+  static constexpr char kBindName[] = "rand_a";
+
+  CExpr latency() const override { return Const(0); }
+
+  CExpr comm() const override { return Const(0); }
+
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(
+        proc(ctx, ctx->getParam<FieldType>(0), ctx->getParam<size_t>(1)));
+  }
+
+  ArrayRef proc(KernelEvalContext* ctx, FieldType field, size_t size) const;
+};
+
 class P2A : public UnaryKernel {
  public:
   static constexpr char kBindName[] = "p2a";
@@ -177,7 +194,8 @@ class TruncPrA : public TruncPrAKernel {
  public:
   static constexpr char kBindName[] = "truncpr_a";
 
-  // TODO: handle case > 3PC
+  // the cost depends on RuntimeConfig::trunc_mode, truncation pairs take one
+  // round of k bits sent to rank 0, local truncation takes nothing.
   Kind kind() const override { return Kind::kDynamic; }
 
   CExpr latency() const override { return Const(0); }
@@ -190,4 +208,18 @@ class TruncPrA : public TruncPrAKernel {
   bool isPrecise() const override { return false; }
 };
 
+// Shuffle rows with a secret permutation, each party permutes in turn with a
+// permutation correlation of the beaver, so no party knows the composition.
+class ShuffleA : public ShuffleKernel {
+ public:
+  static constexpr char kBindName[] = "shuffle_a";
+
+  CExpr latency() const override { return N(); }
+
+  CExpr comm() const override { return K() * (N() - 1); }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t rows) const override;
+};
+
 }  // namespace spu::mpc::semi2k
@@ -14,6 +14,8 @@
 
 #include "spu/mpc/semi2k/boolean.h"
 
+#include <cstring>
+
 #include "spu/core/trace.h"
 #include "spu/mpc/common/abprotocol.h"  // zero_b
 #include "spu/mpc/common/prg_state.h"
@@ -21,6 +23,7 @@
 #include "spu/mpc/kernel.h"
 #include "spu/mpc/semi2k/object.h"
 #include "spu/mpc/semi2k/type.h"
+#include "spu/mpc/util/bit_utils.h"
 #include "spu/mpc/util/communicator.h"
 #include "spu/mpc/util/ring_ops.h"
 
@@ -34,6 +37,36 @@ size_t maxNumBits(const ArrayRef& lhs, const ArrayRef& rhs) {
   return res;
 }
 
+// Open boolean shares of `nbits` valid bits by xor, the bits are packed on
+// the wire when the ring is wider, e.g. 1 bit of FM64 takes 1/64 of the
+// bandwidth. The bits above nbits of the result are zeros.
+ArrayRef openBits(Communicator* comm, const ArrayRef& x, size_t nbits,
+                  std::string_view tag) {
+  const auto field = x.eltype().as<Ring2k>()->field();
+  if (nbits == 0 || nbits >= SizeOf(field) * 8) {
+    return comm->allReduce(ReduceOp::XOR, x, tag);
+  }
+
+  return DISPATCH_ALL_FIELDS(field, "_", [&]() {
+    const auto _x = ArrayView<ring2k_t>(x);
+    std::vector<ring2k_t> elts(x.numel());
+    for (int64_t idx = 0; idx < x.numel(); idx++) {
+      elts[idx] = _x[idx];
+    }
+    const auto words = packBits<ring2k_t>(elts, nbits);
+
+    ArrayRef packed(makeType<RingTy>(FM64), words.size());
+    std::memcpy(packed.data(), words.data(), words.size() * sizeof(uint64_t));
+    packed = comm->allReduce(ReduceOp::XOR, packed, tag);
+
+    ArrayRef out(x.eltype(), x.numel());
+    unpackBits<ring2k_t>(
+        absl::MakeConstSpan(&packed.at<uint64_t>(0), words.size()), nbits,
+        absl::MakeSpan(&out.at<ring2k_t>(0), out.numel()));
+    return out;
+  });
+}
+
 ArrayRef makeBShare(const ArrayRef& r, FieldType field,
                     size_t nbits = std::numeric_limits<size_t>::max()) {
   const auto ty = makeType<BShrTy>(field, nbits);
@@ -119,10 +152,11 @@ ArrayRef AndBB::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   // generate beaver and triple.
   auto [a, b, c] = beaver->And(field, lhs.numel());
 
-  // open x^a, y^b
+  // open x^a, y^b, only the valid bits.
+  const size_t nbits = maxNumBits(lhs, rhs);
   auto res =
       vectorize({ring_xor(lhs, a), ring_xor(rhs, b)}, [&](const ArrayRef& s) {
-        return comm->allReduce(ReduceOp::XOR, s, kBindName);
+        return openBits(comm, s, nbits, kBindName);
       });
   auto x_a = std::move(res[0]);
   auto y_b = std::move(res[1]);
@@ -132,8 +166,12 @@ ArrayRef AndBB::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   if (comm->getRank() == 0) {
     ring_xor_(z, ring_and(x_a, y_b));
   }
+  // zero shares of the invalid bits, which are left by Ci.
+  if (nbits > 0 && nbits < SizeOf(field) * 8) {
+    ring_bitmask_(z, 0, nbits);
+  }
 
-  return makeBShare(z, field, maxNumBits(lhs, rhs));
+  return makeBShare(z, field, nbits);
 }
 
 ArrayRef XorBP::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
@@ -149,4 +149,144 @@ ArrayRef B2A_Randbit::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
   return res;
 }
 
+namespace {
+
+// Move boolean shares of nbits to the smallest ring holding them, it's local.
+ArrayRef narrowB(const ArrayRef& x, size_t nbits) {
+  const auto field = x.eltype().as<Ring2k>()->field();
+  const auto to_field = nbits <= 32 ? FM32 : nbits <= 64 ? FM64 : FM128;
+  if (SizeOf(to_field) >= SizeOf(field)) {
+    return x;
+  }
+  return ring_cast(x, to_field).as(makeType<BShrTy>(to_field, nbits));
+}
+
+// The carry into bit k of x + y.
+ArrayRef carryOut(Object* obj, const ArrayRef& x, const ArrayRef& y,
+                  size_t k) {
+  auto cbb = makeABProtBasicBlock(obj);
+
+  // split even and odd bits of the low kk bits, i.e. xAyBzCwD -> [xyzw, ABCD]
+  auto bit_split = [&](const ArrayRef& in, size_t kk) {
+    const size_t hk = kk / 2;
+    auto perm = odd_even_split(cbb, in, kk);
+    auto mask = cbb.init_like(perm, 0, hk == 64 ? ~0ULL : (1ULL << hk) - 1);
+    auto t0 = cbb._and(perm, mask);
+    auto t1 = cbb._and(cbb.rshift(perm, hk), mask);
+    return std::make_pair(narrowB(t0, hk), narrowB(t1, hk));
+  };
+
+  auto P = xor_bb(obj, x, y);
+  auto G = and_bb(obj, x, y);
+  while (k > 1) {
+    if (k % 2 != 0) {
+      k += 1;
+      P = lshift_b(obj, P, 1);
+      G = lshift_b(obj, G, 1);
+    }
+    auto [P0, P1] = bit_split(P, k);
+    auto [G0, G1] = bit_split(G, k);
+
+    //   P = P1 & P0
+    //   G = G1 ^ (P1 & G0)
+    std::vector<ArrayRef> v = vectorize(
+        {P0, G0}, {P1, P1}, [&](const ArrayRef& xx, const ArrayRef& yy) {
+          return and_bb(obj, xx, yy);
+        });
+    P = std::move(v[0]);
+    G = xor_bb(obj, G1, v[1]);
+    k >>= 1;
+  }
+  return G;
+}
+
+}  // namespace
+
+ArrayRef MsbA::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
+  SPU_TRACE_MPC_LEAF(ctx, in);
+
+  const auto field = in.eltype().as<Ring2k>()->field();
+  const size_t k = SizeOf(field) * 8;
+  auto* obj = ctx->caller();
+  auto* comm = obj->getState<Communicator>();
+
+  // each party's share as a boolean share, like A2B.
+  std::vector<ArrayRef> addends;
+  const auto bty = makeType<BShrTy>(field);
+  for (size_t idx = 0; idx < comm->getWorldSize(); idx++) {
+    auto b = zero_b(obj, field, in.numel());
+    if (idx == comm->getRank()) {
+      ring_xor_(b, in);
+    }
+    addends.push_back(b.as(bty));
+  }
+
+  // reduce to two addends by carry-save adders, each takes one AND, i.e.
+  //   a + b + c = (a ^ b ^ c) + (maj(a, b, c) << 1)
+  //   maj(a, b, c) = ((a ^ c) & (b ^ c)) ^ c
+  while (addends.size() > 2) {
+    auto c = std::move(addends.back());
+    addends.pop_back();
+    auto b = std::move(addends.back());
+    addends.pop_back();
+    auto a = std::move(addends.back());
+    addends.pop_back();
+
+    auto ac = xor_bb(obj, a, c);
+    auto bc = xor_bb(obj, b, c);
+    auto maj = xor_bb(obj, and_bb(obj, ac, bc), c);
+    addends.push_back(xor_bb(obj, ac, b));
+    addends.push_back(lshift_b(obj, maj, 1));
+  }
+
+  if (addends.size() == 1) {
+    return rshift_b(obj, addends[0], k - 1);
+  }
+
+  // msb = (x ^ y)[k-1] ^ carry into bit k-1.
+  const auto& x = addends[0];
+  const auto& y = addends[1];
+  auto carry = carryOut(obj, x, y, k - 1);
+  carry = ring_cast(carry, field).as(makeType<BShrTy>(field, 1));
+  return xor_bb(obj, rshift_b(obj, xor_bb(obj, x, y), k - 1), carry);
+}
+
+ArrayRef EqzA::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
+  SPU_TRACE_MPC_LEAF(ctx, in);
+
+  const auto field = in.eltype().as<Ring2k>()->field();
+  auto* obj = ctx->caller();
+  auto* comm = obj->getState<Communicator>();
+
+  if (comm->getWorldSize() != 2) {
+    return obj->call("eqz_s", a2b(obj, in));
+  }
+
+  const auto bty = makeType<BShrTy>(field);
+  if (comm->getRank() == 0) {
+    return obj->call("eqz_s", in.as(bty));
+  }
+  return obj->call("eqz_s", ring_neg(in).as(bty));
+}
+
+ArrayRef RingCastDownA::proc(KernelEvalContext* ctx, const ArrayRef& in,
+                             FieldType to_field) const {
+  SPU_TRACE_MPC_LEAF(ctx, in);
+
+  const auto field = in.eltype().as<Ring2k>()->field();
+  YACL_ENFORCE(SizeOf(to_field) <= SizeOf(field),
+               "can not widen arithmetic shares from {} to {}", field,
+               to_field);
+  return ring_cast(in, to_field).as(makeType<AShrTy>(to_field));
+}
+
+ArrayRef RingCastB::proc(KernelEvalContext* ctx, const ArrayRef& in,
+                         FieldType to_field) const {
+  SPU_TRACE_MPC_LEAF(ctx, in);
+
+  const size_t nbits = std::min(in.eltype().as<BShare>()->nbits(),
+                                SizeOf(to_field) * 8);
+  return ring_cast(in, to_field).as(makeType<BShrTy>(to_field, nbits));
+}
+
 }  // namespace spu::mpc::semi2k
@@ -31,7 +31,11 @@ class AddBB : public BinaryKernel {
 
   CExpr latency() const override { return Log(K()) + 1; }
 
-  CExpr comm() const override { return Log(K()) * K(); }
+  CExpr comm() const override {
+    return 2 * Log(K())          // KS-adder-circuit
+           * 2 * K() * (N() - 1)  // And gate, for nPC
+        ;
+  }
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& x,
                 const ArrayRef& y) const override;
@@ -48,7 +52,7 @@ class A2B : public UnaryKernel {
   }
 
   CExpr comm() const override {
-    return (2 * Log(K()) + 1)     // KS-adder-circuit
+    return 2 * Log(K())           // KS-adder-circuit
            * 2 * K() * (N() - 1)  // And gate, for nPC
            * (N() - 1)            // (no-matter tree or ring) redue
         ;
@@ -82,4 +86,68 @@ class B2A_Randbit : public UnaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& x) const override;
 };
 
+// The msb of an arithmetic share, without the full bit decomposition of A2B.
+//
+// The shares of parties are reduced to two boolean addends by carry-save
+// adders first, then the msb is the xor of their top bits and the carry into
+// the top bit. Only the carry-out of the low k-1 bits is computed, with the
+// P/G tree of circuits.h, and the halves of each level are narrowed to the
+// smallest ring holding them, so the ANDs after the first level run on at
+// most 32-bit rings.
+class MsbA : public UnaryKernel {
+ public:
+  static constexpr char kBindName[] = "msb_a";
+
+  // the cost depends on the number of parties and the ring narrowing.
+  Kind kind() const override { return Kind::kDynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
+};
+
+// Whether an arithmetic share is zero, without the adders of A2B for 2PC.
+//
+// x0 + x1 == 0 iff x0 == -x1, so x0 and -x1 are boolean shares of a value
+// which is zero iff x is, then only the or-tree of `eqz_s` is left. More
+// parties fall back to A2B.
+class EqzA : public UnaryKernel {
+ public:
+  static constexpr char kBindName[] = "eqz_a";
+
+  // the cost depends on the number of parties.
+  Kind kind() const override { return Kind::kDynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
+};
+
+// Narrow an arithmetic share to a smaller ring, each party reduces its share
+// locally. The result is x mod 2^k' where k' is the bit width of to_field,
+// i.e. x itself when it fits in k' signed bits.
+//
+// Widening is not local since the shares may wrap, so it's not supported.
+class RingCastDownA : public CastRingKernel {
+ public:
+  static constexpr char kBindName[] = "ring_cast_down_a";
+
+  CExpr latency() const override { return Const(0); }
+
+  CExpr comm() const override { return Const(0); }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                FieldType to_field) const override;
+};
+
+// Move a boolean share to another ring locally, the high bits are dropped
+// when narrowing and zero-extended when widening.
+class RingCastB : public CastRingKernel {
+ public:
+  static constexpr char kBindName[] = "ring_cast_b";
+
+  CExpr latency() const override { return Const(0); }
+
+  CExpr comm() const override { return Const(0); }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                FieldType to_field) const override;
+};
+
 }  // namespace spu::mpc::semi2k
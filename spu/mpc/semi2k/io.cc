@@ -14,6 +14,8 @@
 
 #include "spu/mpc/semi2k/io.h"
 
+#include "yacl/crypto/utils/rand.h"
+
 #include "spu/mpc/common/pub2k.h"
 #include "spu/mpc/semi2k/type.h"
 #include "spu/mpc/util/ring_ops.h"
@@ -85,6 +87,41 @@ ArrayRef Semi2kIo::fromShares(const std::vector<ArrayRef>& shares) const {
   YACL_THROW("unsupported eltype {}", eltype);
 }
 
+std::vector<SeededShare> Semi2kIo::makeSeededSecret(const ArrayRef& raw,
+                                                    size_t owner_rank) const {
+  YACL_ENFORCE(raw.eltype().isa<RingTy>(), "expected RingTy, got {}",
+               raw.eltype());
+  YACL_ENFORCE(owner_rank < world_size_, "invalid owner {}", owner_rank);
+
+  std::vector<SeededShare> shares(world_size_);
+  ArrayRef rest = raw.clone();
+  for (size_t rank = 0; rank < world_size_; rank++) {
+    if (rank == owner_rank) {
+      continue;
+    }
+    const uint128_t seed = yacl::RandSeed();
+    uint64_t counter = 0;
+    ring_sub_(rest, ring_rand(field_, raw.numel(), seed, &counter));
+    shares[rank].seeds = {seed};
+  }
+  shares[owner_rank].plain = rest;
+  return shares;
+}
+
+ArrayRef Semi2kIo::expandSeededShare(const SeededShare& share, size_t numel,
+                                     size_t rank, size_t owner_rank) const {
+  const auto ty = makeType<semi2k::AShrTy>(field_);
+  if (rank == owner_rank) {
+    YACL_ENFORCE(share.plain.numel() == static_cast<int64_t>(numel));
+    return share.plain.as(ty);
+  }
+
+  YACL_ENFORCE(share.seeds.size() == 1, "expect 1 seed, got {}",
+               share.seeds.size());
+  uint64_t counter = 0;
+  return ring_rand(field_, numel, share.seeds[0], &counter).as(ty);
+}
+
 std::unique_ptr<Semi2kIo> makeSemi2kIo(FieldType field, size_t npc) {
   registerTypes();
   return std::make_unique<Semi2kIo>(field, npc);
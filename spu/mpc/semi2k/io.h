@@ -28,6 +28,14 @@ class Semi2kIo : public BaseIo {
                                  int owner_rank) const override;
 
   ArrayRef fromShares(const std::vector<ArrayRef>& shares) const override;
+
+  // The additive share of every party other than the owner is the prg output
+  // of a seed, and the owner holds the rest, so nothing but seeds is sent.
+  std::vector<SeededShare> makeSeededSecret(const ArrayRef& raw,
+                                            size_t owner_rank) const override;
+  ArrayRef expandSeededShare(const SeededShare& share, size_t numel,
+                             size_t rank, size_t owner_rank) const override;
+  bool hasSeededSecretSupport() const override { return true; }
 };
 
 std::unique_ptr<Semi2kIo> makeSemi2kIo(FieldType field, size_t npc);
@@ -14,23 +14,95 @@
 
 #pragma once
 
+#include "yacl/link/link.h"
+
+#include "spu/mpc/beaver/beaver_counter.h"
+#include "spu/mpc/beaver/beaver_pool.h"
 #include "spu/mpc/beaver/beaver_tfp.h"
+#include "spu/mpc/beaver/beaver_ttp.h"
 #include "spu/mpc/util/communicator.h"
+#include "spu/spu.pb.h"
 
 namespace spu::mpc {
 
 // TODO(jint) split this into individual states.
 class Semi2kState : public State {
+  std::shared_ptr<yacl::link::Context> lctx_;
+
+  // The link to the TrustedPartyServer, null for the trusted first party.
+  std::shared_ptr<yacl::link::Context> ttp_lctx_;
+
   std::unique_ptr<Beaver> beaver_;
 
+  // Not null when offline phase is enabled, owned by beaver_.
+  BeaverPool* beaver_pool_ = nullptr;
+
+  // Not null when correlations are counted, owned by beaver_.
+  BeaverCounter* beaver_counter_ = nullptr;
+
+  RuntimeConfig::TruncMode trunc_mode_ = RuntimeConfig::TRUNC_DEFAULT;
+
  public:
   static constexpr char kBindName[] = "Semi2kState";
 
-  explicit Semi2kState(std::shared_ptr<yacl::link::Context> lctx) {
-    beaver_ = std::make_unique<BeaverTfpUnsafe>(lctx);
+  Semi2kState(const RuntimeConfig& conf,
+              std::shared_ptr<yacl::link::Context> lctx)
+      : lctx_(std::move(lctx)) {
+    if (conf.beaver_type() == RuntimeConfig::BEAVER_TRUSTED_THIRD_PARTY) {
+      const auto desc = MakeTtpLinkDesc(conf.ttp_beaver_config());
+      YACL_ENFORCE(desc.parties.size() == lctx_->WorldSize() + 1,
+                   "ttp beaver expects {} party hosts, got {}",
+                   lctx_->WorldSize(), desc.parties.size() - 1);
+      ttp_lctx_ = yacl::link::FactoryBrpc().CreateContext(desc, lctx_->Rank());
+      ttp_lctx_->ConnectToMesh();
+    }
+    beaver_ = makeBeaver(false);
+  }
+
+  // A beaver of the configured type, on a spawned link if `spawn`.
+  std::unique_ptr<Beaver> makeBeaver(bool spawn) {
+    if (ttp_lctx_ != nullptr) {
+      return std::make_unique<BeaverTtp>(spawn ? ttp_lctx_->Spawn()
+                                               : ttp_lctx_);
+    }
+    return std::make_unique<BeaverTfpUnsafe>(spawn ? lctx_->Spawn() : lctx_);
   }
 
   Beaver* beaver() { return beaver_.get(); }
+
+  // Enable the offline phase, correlations could then be pre-generated in
+  // background by `beaverPool()->Prefill(...)`.
+  //
+  // Note: all parties should call it at the same time, since the offline
+  // beaver is created on a spawned link.
+  BeaverPool* enableOfflinePhase() {
+    if (beaver_pool_ == nullptr) {
+      auto pool =
+          std::make_unique<BeaverPool>(std::move(beaver_), makeBeaver(true));
+      beaver_pool_ = pool.get();
+      beaver_ = std::move(pool);
+    }
+    return beaver_pool_;
+  }
+
+  BeaverPool* beaverPool() { return beaver_pool_; }
+
+  // Count the correlations pulled from the beaver from now on, e.g. by a dry
+  // run to learn the demand of a program, see BeaverDemand::PrefillTo.
+  BeaverCounter* enableBeaverCounter() {
+    if (beaver_counter_ == nullptr) {
+      auto counter = std::make_unique<BeaverCounter>(std::move(beaver_));
+      beaver_counter_ = counter.get();
+      beaver_ = std::move(counter);
+    }
+    return beaver_counter_;
+  }
+
+  BeaverCounter* beaverCounter() { return beaver_counter_; }
+
+  RuntimeConfig::TruncMode truncMode() const { return trunc_mode_; }
+
+  void setTruncMode(RuntimeConfig::TruncMode mode) { trunc_mode_ = mode; }
 };
 
 }  // namespace spu::mpc
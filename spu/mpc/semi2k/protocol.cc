@@ -35,6 +35,8 @@ std::unique_ptr<Object> makeSemi2kProtocol(
 
   // add communicator
   obj->addState<Communicator>(lctx);
+  obj->getState<Communicator>()->setPipelineChunkSize(
+      conf.experimental_comm_pipeline_chunk_size());
 
   // register random states & kernels.
   obj->addState<PrgState>(lctx);
@@ -46,8 +48,11 @@ std::unique_ptr<Object> makeSemi2kProtocol(
   regABKernels(obj.get());
 
   // register arithmetic & binary kernels
-  obj->addState<Semi2kState>(lctx);
+  obj->addState<Semi2kState>(conf, lctx);
+  obj->getState<Semi2kState>()->setTruncMode(conf.trunc_mode());
   obj->regKernel<semi2k::ZeroA>();
+  obj->regKernel<semi2k::RandA>();
+  regABRandKernels(obj.get());
   obj->regKernel<semi2k::P2A>();
   obj->regKernel<semi2k::A2P>();
   obj->regKernel<semi2k::NotA>();
@@ -59,6 +64,8 @@ std::unique_ptr<Object> makeSemi2kProtocol(
   obj->regKernel<semi2k::MatMulAA>();
   obj->regKernel<semi2k::LShiftA>();
   obj->regKernel<semi2k::TruncPrA>();
+  obj->regKernel<semi2k::ShuffleA>();
+  regABShuffleKernels(obj.get());
 
   obj->regKernel<semi2k::CommonTypeB>();
   obj->regKernel<semi2k::CastTypeB>();
@@ -69,6 +76,10 @@ std::unique_ptr<Object> makeSemi2kProtocol(
   obj->regKernel<semi2k::A2B>();
   // obj->regKernel<semi2k::B2A>();
   obj->regKernel<semi2k::B2A_Randbit>();
+  obj->regKernel<semi2k::MsbA>();
+  obj->regKernel<semi2k::EqzA>();
+  obj->regKernel<semi2k::RingCastDownA>();
+  obj->regKernel<semi2k::RingCastB>();
   obj->regKernel<semi2k::AndBP>();
   obj->regKernel<semi2k::AndBB>();
   obj->regKernel<semi2k::XorBP>();
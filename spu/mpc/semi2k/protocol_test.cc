@@ -26,6 +26,18 @@ RuntimeConfig makeConfig(FieldType field) {
   return conf;
 }
 
+RuntimeConfig makePipelinedConfig(FieldType field) {
+  RuntimeConfig conf = makeConfig(field);
+  conf.set_experimental_comm_pipeline_chunk_size(7);
+  return conf;
+}
+
+RuntimeConfig makeTruncPairConfig(FieldType field) {
+  RuntimeConfig conf = makeConfig(field);
+  conf.set_trunc_mode(RuntimeConfig::TRUNC_PAIR);
+  return conf;
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
@@ -52,6 +64,31 @@ INSTANTIATE_TEST_SUITE_P(
                          std::get<2>(p.param));
     });
 
+INSTANTIATE_TEST_SUITE_P(
+    Semi2kPipelined, ArithmeticTest,
+    testing::Combine(testing::Values(makeSemi2kProtocol),                     //
+                     testing::Values(makePipelinedConfig(FieldType::FM32),    //
+                                     makePipelinedConfig(FieldType::FM64),    //
+                                     makePipelinedConfig(FieldType::FM128)),  //
+                     testing::Values(2, 3)),                                  //
+    [](const testing::TestParamInfo<ArithmeticTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<1>(p.param).field(),
+                         std::get<2>(p.param));
+    });
+
+// truncation pairs for 2PC too.
+INSTANTIATE_TEST_SUITE_P(
+    Semi2kTruncPair, ArithmeticTest,
+    testing::Combine(testing::Values(makeSemi2kProtocol),                     //
+                     testing::Values(makeTruncPairConfig(FieldType::FM32),    //
+                                     makeTruncPairConfig(FieldType::FM64),    //
+                                     makeTruncPairConfig(FieldType::FM128)),  //
+                     testing::Values(2)),                                     //
+    [](const testing::TestParamInfo<ArithmeticTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<1>(p.param).field(),
+                         std::get<2>(p.param));
+    });
+
 INSTANTIATE_TEST_SUITE_P(
     Semi2k, BooleanTest,
     testing::Combine(testing::Values(makeSemi2kProtocol),            //
@@ -14,7 +14,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "absl/numeric/bits.h"
+#include "absl/types/span.h"
 
 namespace spu::mpc {
 
@@ -26,4 +32,77 @@ inline constexpr int log2Ceil(uint64_t n) {
   return (n <= 1) ? 0 : (64 - absl::countl_zero(n - 1));
 }
 
+// Number of 64-bit words to pack `numel` elements of `nbits`.
+inline constexpr size_t packedWords(size_t numel, size_t nbits) {
+  return (numel * nbits + 63) / 64;
+}
+
+// Number of 64-bit words to pack `numel` elements, element i of `widths[i %
+// widths.size()]` bits, `numel` should be a multiple of widths.size().
+inline size_t packedWords(size_t numel, absl::Span<size_t const> widths) {
+  size_t period_bits = 0;
+  for (auto width : widths) {
+    period_bits += width;
+  }
+  return (numel / widths.size() * period_bits + 63) / 64;
+}
+
+inline constexpr uint64_t lowBitsMask(size_t nbits) {
+  return nbits >= 64 ? ~uint64_t(0) : (uint64_t(1) << nbits) - 1;
+}
+
+// Pack the low `widths[i % widths.size()]` bits of every element i into
+// consecutive bits of 64-bit words, so messages whose valid bits vary by a
+// fixed pattern could be sent without padding.
+template <typename T>
+std::vector<uint64_t> packBits(absl::Span<T const> in,
+                               absl::Span<size_t const> widths) {
+  std::vector<uint64_t> out(packedWords(in.size(), widths), 0);
+  size_t pos = 0;
+  for (size_t idx = 0; idx < in.size(); idx++) {
+    T v = in[idx];
+    for (size_t rem = widths[idx % widths.size()]; rem > 0;) {
+      const size_t shift = pos % 64;
+      const size_t take = std::min(rem, 64 - shift);
+      out[pos / 64] |= (static_cast<uint64_t>(v) & lowBitsMask(take)) << shift;
+      v = take < sizeof(T) * 8 ? static_cast<T>(v >> take) : T(0);
+      pos += take;
+      rem -= take;
+    }
+  }
+  return out;
+}
+
+// Pack the low `nbits` of every element into consecutive bits of 64-bit
+// words, element i takes bits [i * nbits, (i + 1) * nbits) of the stream.
+template <typename T>
+std::vector<uint64_t> packBits(absl::Span<T const> in, size_t nbits) {
+  return packBits<T>(in, absl::MakeConstSpan(&nbits, 1));
+}
+
+// The inverse of packBits, bits above the width of outputs are zeros.
+template <typename T>
+void unpackBits(absl::Span<uint64_t const> in,
+                absl::Span<size_t const> widths, absl::Span<T> out) {
+  size_t pos = 0;
+  for (size_t idx = 0; idx < out.size(); idx++) {
+    const size_t width = widths[idx % widths.size()];
+    T v = 0;
+    for (size_t got = 0; got < width;) {
+      const size_t shift = pos % 64;
+      const size_t take = std::min(width - got, 64 - shift);
+      v |= static_cast<T>((in[pos / 64] >> shift) & lowBitsMask(take)) << got;
+      pos += take;
+      got += take;
+    }
+    out[idx] = v;
+  }
+}
+
+template <typename T>
+void unpackBits(absl::Span<uint64_t const> in, size_t nbits,
+                absl::Span<T> out) {
+  unpackBits<T>(in, absl::MakeConstSpan(&nbits, 1), out);
+}
+
 }  // namespace spu::mpc
@@ -14,8 +14,11 @@
 
 #include "spu/mpc/util/bit_utils.h"
 
+#include <random>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "yacl/base/int128.h"
 
 namespace spu::mpc {
 
@@ -48,4 +51,58 @@ TEST(BitUtilsTest, Log2Ceil) {
   ASSERT_EQ(log2Ceil((1U << 31) + 1), 32);
 }
 
+template <typename T>
+class PackBitsTest : public ::testing::Test {};
+
+using PackBitsTypes = ::testing::Types<uint8_t, uint32_t, uint64_t, uint128_t>;
+TYPED_TEST_SUITE(PackBitsTest, PackBitsTypes);
+
+TYPED_TEST(PackBitsTest, RoundTrip) {
+  using T = TypeParam;
+  std::mt19937_64 rng(0);
+
+  for (size_t nbits = 1; nbits <= sizeof(T) * 8; nbits += 3) {
+    std::vector<T> in(37);
+    for (auto& v : in) {
+      // garbage above nbits is dropped.
+      v = static_cast<T>(yacl::MakeUint128(rng(), rng()));
+    }
+    const auto packed = packBits<T>(in, nbits);
+    ASSERT_EQ(packed.size(), packedWords(in.size(), nbits));
+
+    std::vector<T> out(in.size());
+    unpackBits<T>(packed, nbits, absl::MakeSpan(out));
+    for (size_t idx = 0; idx < in.size(); idx++) {
+      const T mask = nbits == sizeof(T) * 8
+                         ? static_cast<T>(~T(0))
+                         : static_cast<T>((T(1) << nbits) - 1);
+      EXPECT_EQ(out[idx], static_cast<T>(in[idx] & mask)) << nbits;
+    }
+  }
+}
+
+TYPED_TEST(PackBitsTest, Widths) {
+  using T = TypeParam;
+  std::mt19937_64 rng(0);
+
+  // e.g. the bit decomposed messages of the aby3 b2a.
+  const size_t kBits = sizeof(T) * 8;
+  const std::vector<size_t> widths = {kBits, kBits - 1, 1, kBits / 2};
+  std::vector<T> in(widths.size() * 9);
+  for (auto& v : in) {
+    v = static_cast<T>(yacl::MakeUint128(rng(), rng()));
+  }
+  const auto packed = packBits<T>(in, widths);
+  ASSERT_EQ(packed.size(), packedWords(in.size(), widths));
+
+  std::vector<T> out(in.size());
+  unpackBits<T>(packed, widths, absl::MakeSpan(out));
+  for (size_t idx = 0; idx < in.size(); idx++) {
+    const size_t width = widths[idx % widths.size()];
+    const T mask = width == kBits ? static_cast<T>(~T(0))
+                                  : static_cast<T>((T(1) << width) - 1);
+    EXPECT_EQ(out[idx], static_cast<T>(in[idx] & mask)) << idx;
+  }
+}
+
 }  // namespace spu::mpc
@@ -62,7 +62,8 @@ struct CircuitBasicBlock {
 // The `o` here is:
 //  (G0, P0) o (G1, P1) = (G0 ^ (P0 & G1), P0 & P1)
 //
-// Latency log(k) + 1
+// Latency log(k) + 1, and gates 2log(k), since the propagates of the last
+// level are not used.
 template <typename T>
 T kogge_stone(const CircuitBasicBlock<T>& ctx, T const& lhs, T const& rhs,
               size_t nbits) {
@@ -70,9 +71,16 @@ T kogge_stone(const CircuitBasicBlock<T>& ctx, T const& lhs, T const& rhs,
   auto P = ctx._xor(lhs, rhs);
   auto G = ctx._and(lhs, rhs);
 
-  for (int idx = 0; idx < log2Ceil(nbits); ++idx) {
+  const int levels = log2Ceil(nbits);
+  for (int idx = 0; idx < levels; ++idx) {
     const size_t offset = 1UL << idx;
     auto G1 = ctx.lshift(G, offset);
+
+    if (idx + 1 == levels) {
+      G = ctx._xor(G, ctx._and(P, G1));
+      break;
+    }
+
     auto P1 = ctx.lshift(P, offset);
 
     // P1 = P & P1
@@ -121,13 +129,22 @@ T sklansky(const CircuitBasicBlock<T>& ctx, T const& lhs, T const& rhs,
   // Generate p & g.
   auto P = ctx._xor(lhs, rhs);
   auto G = ctx._and(lhs, rhs);
-  for (int idx = 0; idx < log2Ceil(nbits); ++idx) {
+  const int levels = log2Ceil(nbits);
+  for (int idx = 0; idx < levels; ++idx) {
     const auto s_mask = ctx.init_like(G, kSelMask[idx][0], kSelMask[idx][1]);
     auto G1 = ctx.lshift(ctx._and(G, s_mask), 1);
-    auto P1 = ctx.lshift(ctx._and(P, s_mask), 1);
-
     for (int j = 0; j < idx; j++) {
       G1 = ctx._xor(G1, ctx.lshift(G1, 1 << j));
+    }
+
+    // the propagates of the last level are not used.
+    if (idx + 1 == levels) {
+      G = ctx._xor(G, ctx._and(P, G1));
+      break;
+    }
+
+    auto P1 = ctx.lshift(ctx._and(P, s_mask), 1);
+    for (int j = 0; j < idx; j++) {
       P1 = ctx._xor(P1, ctx.lshift(P1, 1 << j));
     }
 
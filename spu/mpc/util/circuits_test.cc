@@ -14,6 +14,8 @@
 
 #include "spu/mpc/util/circuits.h"
 
+#include <random>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "yacl/base/int128.h"
@@ -147,6 +149,22 @@ TEST(SklanskyAdder, Vectorized) {
   EXPECT_THAT(r1, testing::ElementsAreArray(args[2].begin(), args[2].end()));
 }
 
+TEST(Adders, Widths) {
+  using T = uint64_t;
+  const auto cbb = makeScalarCBB<T>();
+
+  std::mt19937_64 rng(0);
+  for (size_t nbits : {1, 2, 3, 8, 17, 32, 64}) {
+    const T mask = nbits == 64 ? ~T(0) : (T(1) << nbits) - 1;
+    for (size_t idx = 0; idx < 100; idx++) {
+      const T x = rng();
+      const T y = rng();
+      EXPECT_EQ(kogge_stone(cbb, x, y, nbits) & mask, (x + y) & mask);
+      EXPECT_EQ(sklansky(cbb, x, y, nbits) & mask, (x + y) & mask);
+    }
+  }
+}
+
 TEST(UtilTest, Works) {
   using T = uint32_t;
   const auto cbb = makeScalarCBB<T>();
@@ -14,6 +14,12 @@
 
 #include "spu/mpc/util/communicator.h"
 
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+#include "spu/mpc/util/bit_utils.h"
+#include "spu/mpc/util/message_codec.h"
 #include "spu/mpc/util/ring_ops.h"
 
 namespace spu::mpc {
@@ -27,34 +33,89 @@ std::shared_ptr<yacl::Buffer> stealBuffer(yacl::Buffer&& buf) {
   return std::make_shared<yacl::Buffer>(std::move(buf));
 }
 
-}  // namespace
-
-ArrayRef Communicator::allReduce(ReduceOp op, const ArrayRef& in,
-                                 std::string_view tag) {
-  const auto buf = in.getOrCreateCompactBuf();
-
-  std::vector<yacl::Buffer> bufs = yacl::link::AllGather(lctx_, *buf, tag);
+void reduceInplace(ReduceOp op, ArrayRef& res, const ArrayRef& arr) {
+  if (op == ReduceOp::ADD) {
+    ring_add_(res, arr);
+  } else if (op == ReduceOp::XOR) {
+    ring_xor_(res, arr);
+  } else {
+    YACL_THROW("unsupported reduce op={}", static_cast<int>(op));
+  }
+}
 
-  YACL_ENFORCE(bufs.size() == getWorldSize());
-  ArrayRef res = in.clone();
+// Reduce `in` with peers' received buffers. The first peer buffer is adopted
+// as the accumulator, so no extra copy is made for the result.
+ArrayRef reduceBuffers(ReduceOp op, const ArrayRef& in, size_t self_rank,
+                       std::vector<yacl::Buffer>&& bufs) {
+  ArrayRef res;
   for (size_t idx = 0; idx < bufs.size(); idx++) {
-    if (idx == getRank()) {
+    if (idx == self_rank) {
       continue;
     }
 
     auto arr = ArrayRef(stealBuffer(std::move(bufs[idx])), in.eltype(),
                         in.numel(), kStride, kOffset);
-    if (op == ReduceOp::ADD) {
-      ring_add_(res, arr);
-    } else if (op == ReduceOp::XOR) {
-      ring_xor_(res, arr);
+    if (res.buf() == nullptr) {
+      res = std::move(arr);
     } else {
-      YACL_THROW("unsupported reduce op={}", static_cast<int>(op));
+      reduceInplace(op, res, arr);
     }
   }
 
+  if (res.buf() == nullptr) {
+    // no peers.
+    return in.clone();
+  }
+  reduceInplace(op, res, in);
+  return res;
+}
+
+Duration since(const TimePoint& start) {
+  return std::chrono::duration_cast<Duration>(
+      std::chrono::high_resolution_clock::now() - start);
+}
+
+}  // namespace
+
+Communicator::~Communicator() {
+  {
+    std::unique_lock lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+ArrayRef Communicator::allReduce(ReduceOp op, const ArrayRef& in,
+                                 std::string_view tag) {
+  auto trace = traceComm("allreduce", tag);
+  if (useBandwidthOptimal(in.numel() * in.elsize())) {
+    KernelStats stats;
+    auto res = ringAllReduce(op, in, tag, &stats);
+    stats_.latency += stats.latency;
+    stats_.comm += stats.send_bytes;
+    recordKernelStats(stats);
+    trace.addCommBytes(stats.send_bytes, stats.recv_bytes);
+    return res;
+  }
+
+  const auto buf = in.getOrCreateCompactBuf();
+
+  const auto start = std::chrono::high_resolution_clock::now();
+  std::vector<yacl::Buffer> bufs = yacl::link::AllGather(lctx_, *buf, tag);
+  emulateRecv(buf->size() * (lctx_->WorldSize() - 1));
+  const auto recv_time = since(start);
+
+  YACL_ENFORCE(bufs.size() == getWorldSize());
+  ArrayRef res = reduceBuffers(op, in, getRank(), std::move(bufs));
+
+  const size_t bytes = buf->size() * (lctx_->WorldSize() - 1);
   stats_.latency += 1;
-  stats_.comm += buf->size() * (lctx_->WorldSize() - 1);
+  stats_.comm += bytes;
+  recordKernelStats({bytes, bytes, 1, recv_time});
+  trace.addCommBytes(bytes, bytes);
 
   return res;
 }
@@ -62,62 +123,382 @@ ArrayRef Communicator::allReduce(ReduceOp op, const ArrayRef& in,
 ArrayRef Communicator::reduce(ReduceOp op, const ArrayRef& in, size_t root,
                               std::string_view tag) {
   YACL_ENFORCE(root < lctx_->WorldSize());
+  auto trace = traceComm("reduce", tag);
+  if (useBandwidthOptimal(in.numel() * in.elsize())) {
+    KernelStats stats;
+    auto res = treeReduce(op, in, root, tag, &stats);
+    stats_.latency += stats.latency;
+    stats_.comm += stats.send_bytes;
+    recordKernelStats(stats);
+    trace.addCommBytes(stats.send_bytes, stats.recv_bytes);
+    return res;
+  }
+
   const auto buf = in.getOrCreateCompactBuf();
 
+  const auto start = std::chrono::high_resolution_clock::now();
   std::vector<yacl::Buffer> bufs = yacl::link::Gather(lctx_, *buf, root, tag);
-
-  ArrayRef res = in.clone();
   if (getRank() == root) {
-    for (size_t idx = 0; idx < bufs.size(); idx++) {
-      if (idx == getRank()) {
-        continue;
-      }
-
-      auto arr = ArrayRef(stealBuffer(std::move(bufs[idx])), in.eltype(),
-                          in.numel(), kStride, kOffset);
-      if (op == ReduceOp::ADD) {
-        ring_add_(res, arr);
-      } else if (op == ReduceOp::XOR) {
-        ring_xor_(res, arr);
-      } else {
-        YACL_THROW("unsupported reduce op={}", static_cast<int>(op));
-      }
-    }
+    emulateRecv(buf->size() * (lctx_->WorldSize() - 1));
   }
+  const auto recv_time = since(start);
+
+  ArrayRef res = getRank() == root
+                     ? reduceBuffers(op, in, getRank(), std::move(bufs))
+                     : in.clone();
 
   stats_.latency += 1;
   stats_.comm += buf->size();
+  if (getRank() == root) {
+    recordKernelStats(
+        {0, buf->size() * (lctx_->WorldSize() - 1), 1, recv_time});
+    trace.addCommBytes(0, buf->size() * (lctx_->WorldSize() - 1));
+  } else {
+    recordKernelStats({static_cast<size_t>(buf->size()), 0, 1, recv_time});
+    trace.addCommBytes(buf->size(), 0);
+  }
 
   return res;
 }
 
-ArrayRef Communicator::rotate(const ArrayRef& in, std::string_view tag) {
+void Communicator::sendPart(size_t dst_rank, const ArrayRef& in,
+                            std::string_view tag, KernelStats* stats) {
+  const size_t bytes = in.numel() * in.elsize();
+  if (in.stride() == kStride) {
+    // parts are slices of a compact array, send them without a copy.
+    lctx_->SendAsync(
+        dst_rank,
+        yacl::ByteContainerView(static_cast<uint8_t const*>(in.data()), bytes),
+        tag);
+  } else {
+    lctx_->SendAsync(dst_rank, *in.getOrCreateCompactBuf(), tag);
+  }
+  stats->send_bytes += bytes;
+}
+
+ArrayRef Communicator::recvPart(size_t src_rank, const Type& eltype,
+                                std::string_view tag, KernelStats* stats) {
+  const auto start = std::chrono::high_resolution_clock::now();
+  auto buf = lctx_->Recv(src_rank, tag);
+  emulateRecv(buf.size());
+  stats->recv_time += since(start);
+  stats->recv_bytes += buf.size();
+
+  auto numel = buf.size() / eltype.size();
+  return ArrayRef(stealBuffer(std::move(buf)), eltype, numel, kStride, kOffset);
+}
+
+// Reduce-scatter then all-gather along the ring, the array is cut into n
+// parts, in each round a party sends a part to the next party and receives
+// another part from the previous one.
+ArrayRef Communicator::ringAllReduce(ReduceOp op, const ArrayRef& in,
+                                     std::string_view tag,
+                                     KernelStats* stats) {
+  const size_t world_size = getWorldSize();
+  const size_t rank = getRank();
+  const int64_t numel = in.numel();
+
+  ArrayRef res = in.clone();
+  const auto part = [&](size_t idx) {
+    idx %= world_size;
+    return res.slice(idx * numel / world_size,
+                     (idx + 1) * numel / world_size);
+  };
+
+  // after the round `step`, part `rank - step - 1` has `step + 2` inputs, so
+  // a party has the sum of part `rank + 1` in the end.
+  for (size_t step = 0; step + 1 < world_size; step++) {
+    sendPart(lctx_->NextRank(), part(rank + world_size - step), tag, stats);
+    auto dst = part(rank + world_size - step - 1);
+    reduceInplace(op, dst,
+                  recvPart(lctx_->PrevRank(), in.eltype(), tag, stats));
+  }
+
+  for (size_t step = 0; step + 1 < world_size; step++) {
+    sendPart(lctx_->NextRank(), part(rank + world_size + 1 - step), tag, stats);
+    auto dst = part(rank + world_size - step);
+    ring_assign(dst, recvPart(lctx_->PrevRank(), in.eltype(), tag, stats));
+  }
+
+  stats->latency += 2 * (world_size - 1);
+  return res;
+}
+
+// Binomial tree reduce, in round i, parties of relative rank 2^i (mod 2^(i+1))
+// send their partial sums to the one 2^i before them and quit.
+ArrayRef Communicator::treeReduce(ReduceOp op, const ArrayRef& in, size_t root,
+                                  std::string_view tag, KernelStats* stats) {
+  const size_t world_size = getWorldSize();
+  const size_t rel_rank = (getRank() + world_size - root) % world_size;
+  const auto to_rank = [&](size_t rel) { return (rel + root) % world_size; };
+
+  ArrayRef acc = in.clone();
+  size_t mask = 1;
+  for (; mask < world_size; mask <<= 1) {
+    if ((rel_rank & mask) != 0) {
+      sendPart(to_rank(rel_rank - mask), acc, tag, stats);
+      break;
+    }
+    if (rel_rank + mask < world_size) {
+      reduceInplace(
+          op, acc,
+          recvPart(to_rank(rel_rank + mask), in.eltype(), tag, stats));
+    }
+  }
+
+  // all parties count the rounds of the root.
+  stats->latency += log2Ceil(world_size);
+  return root == getRank() ? acc : in.clone();
+}
+
+void Communicator::setNumLinks(size_t num_links) {
+  YACL_ENFORCE(num_links >= 1, "invalid number of links {}", num_links);
+  while (stripes_.size() + 1 < num_links) {
+    stripes_.push_back(lctx_->Spawn());
+  }
+  stripes_.resize(num_links - 1);
+}
+
+// A striped message starts with the number of parts on lctx_, followed by
+// the first part, the i-th part is on the i-th link.
+void Communicator::sendStriped(size_t dst_rank, const yacl::Buffer& buf,
+                               std::string_view tag) {
+  const size_t bytes = buf.size();
+  const auto* data = buf.data<uint8_t>();
+  if (stripes_.empty()) {
+    lctx_->SendAsync(dst_rank, yacl::ByteContainerView(data, bytes), tag);
+    return;
+  }
+
+  const uint64_t num_parts =
+      std::clamp<size_t>(bytes / kMinStripeBytes, 1, stripes_.size() + 1);
+  const size_t part_bytes = (bytes + num_parts - 1) / num_parts;
+
+  yacl::Buffer first(sizeof(num_parts) + std::min(part_bytes, bytes));
+  std::memcpy(first.data<uint8_t>(), &num_parts, sizeof(num_parts));
+  std::memcpy(first.data<uint8_t>() + sizeof(num_parts), data,
+              std::min(part_bytes, bytes));
+  lctx_->SendAsync(dst_rank, std::move(first), tag);
+
+  for (size_t idx = 1; idx < num_parts; idx++) {
+    const size_t begin = std::min(idx * part_bytes, bytes);
+    const size_t end = std::min(begin + part_bytes, bytes);
+    stripes_[idx - 1]->SendAsync(
+        dst_rank, yacl::ByteContainerView(data + begin, end - begin), tag);
+  }
+}
+
+std::pair<std::shared_ptr<yacl::Buffer>, int64_t> Communicator::recvStriped(
+    size_t src_rank, std::string_view tag) {
+  auto first = lctx_->Recv(src_rank, tag);
+  if (stripes_.empty()) {
+    return {stealBuffer(std::move(first)), 0};
+  }
+
+  uint64_t num_parts = 0;
+  YACL_ENFORCE(first.size() >= static_cast<int64_t>(sizeof(num_parts)));
+  std::memcpy(&num_parts, first.data<uint8_t>(), sizeof(num_parts));
+  YACL_ENFORCE(num_parts >= 1 && num_parts <= stripes_.size() + 1,
+               "invalid number of parts {}, the number of links of peers "
+               "mismatch?",
+               num_parts);
+  if (num_parts == 1) {
+    // skip the header without a copy.
+    return {stealBuffer(std::move(first)), sizeof(num_parts)};
+  }
+
+  std::vector<yacl::Buffer> parts;
+  size_t bytes = first.size() - sizeof(num_parts);
+  for (size_t idx = 1; idx < num_parts; idx++) {
+    parts.push_back(stripes_[idx - 1]->Recv(src_rank, tag));
+    bytes += parts.back().size();
+  }
+
+  auto res = std::make_shared<yacl::Buffer>(bytes);
+  auto* dst = res->data<uint8_t>();
+  std::memcpy(dst, first.data<uint8_t>() + sizeof(num_parts),
+              first.size() - sizeof(num_parts));
+  dst += first.size() - sizeof(num_parts);
+  for (const auto& part : parts) {
+    std::memcpy(dst, part.data<uint8_t>(), part.size());
+    dst += part.size();
+  }
+  return {std::move(res), 0};
+}
+
+size_t Communicator::sendArray(size_t dst_rank, const ArrayRef& in,
+                               std::string_view tag) {
   const auto buf = in.getOrCreateCompactBuf();
+  if (!compression_) {
+    sendStriped(dst_rank, *buf, tag);
+    return buf->size();
+  }
 
-  lctx_->SendAsync(lctx_->PrevRank(), *buf, tag);
+  const auto encoded =
+      encodeMessage(buf->data(), in.numel() * in.elsize(), in.elsize());
+  sendStriped(dst_rank, encoded, tag);
+  return encoded.size();
+}
 
-  auto res_buf = lctx_->Recv(lctx_->NextRank(), tag);
+ArrayRef Communicator::recvArray(size_t src_rank, const Type& eltype,
+                                 std::string_view tag, size_t* wire_bytes) {
+  auto [buf, offset] = recvStriped(src_rank, tag);
+  *wire_bytes = buf->size() - offset;
+  if (compression_) {
+    std::tie(buf, offset) = decodeMessage(std::move(buf), offset);
+  }
+
+  auto numel = (buf->size() - offset) / eltype.size();
+  return ArrayRef(std::move(buf), eltype, numel, kStride, offset);
+}
+
+ArrayRef Communicator::rotate(const ArrayRef& in, std::string_view tag) {
+  auto trace = traceComm("rotate", tag);
+  const size_t bytes = sendArray(lctx_->PrevRank(), in, tag);
+
+  const auto start = std::chrono::high_resolution_clock::now();
+  size_t res_bytes = 0;
+  auto res = recvArray(lctx_->NextRank(), in.eltype(), tag, &res_bytes);
+  emulateRecv(res_bytes);
+  const auto recv_time = since(start);
 
   stats_.latency += 1;
-  stats_.comm += buf->size();
+  stats_.comm += bytes;
+  recordKernelStats({bytes, res_bytes, 1, recv_time});
+  trace.addCommBytes(bytes, res_bytes);
 
-  return ArrayRef(stealBuffer(std::move(res_buf)), in.eltype(), in.numel(),
-                  kStride, kOffset);
+  YACL_ENFORCE(res.numel() == in.numel());
+  return res;
 }
 
 void Communicator::sendAsync(size_t dst_rank, const ArrayRef& in,
                              std::string_view tag) {
-  const auto buf = in.getOrCreateCompactBuf();
-
-  lctx_->SendAsync(dst_rank, *buf, tag);
+  auto trace = traceComm("send", tag);
+  const size_t bytes = sendArray(dst_rank, in, tag);
+  recordKernelStats({bytes, 0, 0, {}});
+  trace.addCommBytes(bytes, 0);
 }
 
 ArrayRef Communicator::recv(size_t src_rank, Type eltype,
                             std::string_view tag) {
-  auto buf = lctx_->Recv(src_rank, tag);
+  auto trace = traceComm("recv", tag);
+  const auto start = std::chrono::high_resolution_clock::now();
+  size_t bytes = 0;
+  auto res = recvArray(src_rank, eltype, tag, &bytes);
+  emulateRecv(bytes);
+  recordKernelStats({0, bytes, 0, since(start)});
+  trace.addCommBytes(0, bytes);
 
-  auto numel = buf.size() / eltype.size();
-  return ArrayRef(stealBuffer(std::move(buf)), eltype, numel, kStride, kOffset);
+  return res;
+}
+
+void Communicator::recordKernelStats(const KernelStats& stats) {
+  const std::string_view name =
+      kernel_stack_.empty() ? kNoKernel : kernel_stack_.back();
+  kernel_stats_[std::string(name)] += stats;
+}
+
+void Communicator::submit(
+    std::function<void(const std::shared_ptr<yacl::link::Context>&)> job) {
+  {
+    std::unique_lock lock(mutex_);
+    if (async_error_) {
+      std::rethrow_exception(async_error_);
+    }
+    if (async_lctx_ == nullptr) {
+      // all parties issue async ops in the same order, so the spawned link
+      // is consistent.
+      async_lctx_ = lctx_->Spawn();
+      worker_ = std::thread([this]() { workerLoop(); });
+    }
+    jobs_.push_back(std::move(job));
+  }
+  cv_.notify_all();
+}
+
+void Communicator::workerLoop() {
+  while (true) {
+    std::function<void(const std::shared_ptr<yacl::link::Context>&)> job;
+    {
+      std::unique_lock lock(mutex_);
+      // drain pending jobs before stop, peers may wait for them.
+      cv_.wait(lock, [&] { return stopped_ || !jobs_.empty(); });
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    try {
+      job(async_lctx_);
+    } catch (...) {
+      std::unique_lock lock(mutex_);
+      async_error_ = std::current_exception();
+    }
+  }
+}
+
+std::future<ArrayRef> Communicator::iallReduce(ReduceOp op, const ArrayRef& in,
+                                               std::string_view tag) {
+  auto buf = in.getOrCreateCompactBuf();
+
+  // stats are accounted at issue time, so readers never race with the worker.
+  const size_t bytes = buf->size() * (lctx_->WorldSize() - 1);
+  stats_.latency += 1;
+  stats_.comm += bytes;
+  recordKernelStats({bytes, bytes, 1, {}});
+
+  auto promise = std::make_shared<std::promise<ArrayRef>>();
+  auto future = promise->get_future();
+  submit([promise, op, in, buf, tag = std::string(tag), emulator = emulator_](
+             const std::shared_ptr<yacl::link::Context>& lctx) {
+    try {
+      std::vector<yacl::Buffer> bufs = yacl::link::AllGather(lctx, *buf, tag);
+      YACL_ENFORCE(bufs.size() == lctx->WorldSize());
+      if (emulator != nullptr) {
+        emulator->wait(buf->size() * (lctx->WorldSize() - 1));
+      }
+
+      promise->set_value(
+          reduceBuffers(op, in, lctx->Rank(), std::move(bufs)));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+
+  return future;
+}
+
+void Communicator::isend(size_t dst_rank, const ArrayRef& in,
+                         std::string_view tag) {
+  auto buf = in.getOrCreateCompactBuf();
+  recordKernelStats({static_cast<size_t>(buf->size()), 0, 0, {}});
+  submit([dst_rank, buf, tag = std::string(tag)](
+             const std::shared_ptr<yacl::link::Context>& lctx) {
+    lctx->SendAsync(dst_rank, *buf, tag);
+  });
+}
+
+std::future<ArrayRef> Communicator::irecv(size_t src_rank, Type eltype,
+                                          std::string_view tag) {
+  auto promise = std::make_shared<std::promise<ArrayRef>>();
+  auto future = promise->get_future();
+  submit([promise, src_rank, eltype, tag = std::string(tag),
+          emulator = emulator_](
+             const std::shared_ptr<yacl::link::Context>& lctx) {
+    try {
+      auto buf = lctx->Recv(src_rank, tag);
+      if (emulator != nullptr) {
+        emulator->wait(buf.size());
+      }
+      auto numel = buf.size() / eltype.size();
+      promise->set_value(ArrayRef(stealBuffer(std::move(buf)), eltype, numel,
+                                  kStride, kOffset));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
 }
 
 }  // namespace spu::mpc
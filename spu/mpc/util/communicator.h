@@ -14,9 +14,17 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -25,6 +33,7 @@
 #include "yacl/link/link.h"
 
 #include "spu/mpc/object.h"
+#include "spu/mpc/util/network_emulator.h"
 
 // This module defines the protocol comm pattern used for all
 // protocols.
@@ -37,13 +46,43 @@ enum class ReduceOp {
   XOR = 2,
 };
 
+// A typed view of a received buffer. It owns the buffer, so the received bytes
+// are used in place instead of being copied into a new container.
+template <typename T>
+class TypedBuffer {
+  yacl::Buffer buf_;
+
+ public:
+  using value_type = T;
+
+  explicit TypedBuffer(yacl::Buffer&& buf) : buf_(std::move(buf)) {
+    YACL_ENFORCE(buf_.size() % sizeof(T) == 0);
+  }
+
+  T* data() { return buf_.data<T>(); }
+  const T* data() const { return buf_.data<T>(); }
+
+  size_t size() const { return buf_.size() / sizeof(T); }
+
+  T& operator[](size_t idx) { return data()[idx]; }
+  const T& operator[](size_t idx) const { return data()[idx]; }
+
+  T* begin() { return data(); }
+  T* end() { return data() + size(); }
+  const T* begin() const { return data(); }
+  const T* end() const { return data() + size(); }
+
+  // Give up the buffer, e.g. to be referred by ArrayRefs without a copy.
+  yacl::Buffer release() { return std::move(buf_); }
+};
+
 // yacl::link does not make assumption on data types, (it works on buffer),
 // which means it's hard to write algorithms which depends on data arithmetics
 // like reduce/allreduce.
 //
 // In mpc module, we have concrete data type definition, so we can fill this
 // gap.
-class Communicator : public State {
+class Communicator : public State, public KernelObserver {
  public:
   static constexpr char kBindName[] = "Communicator";
 
@@ -62,6 +101,34 @@ class Communicator : public State {
     }
   };
 
+  // Per kernel statistics, communication is attributed to the innermost
+  // running kernel. Bytes of `irecv` are not counted since they are unknown
+  // at issue time.
+  struct KernelStats {
+    size_t send_bytes = 0;
+    size_t recv_bytes = 0;
+    // number of rounds, same as Stats::latency.
+    size_t latency = 0;
+    // wall time blocked in receiving.
+    Duration recv_time = {};
+
+    KernelStats& operator+=(const KernelStats& rhs) {
+      send_bytes += rhs.send_bytes;
+      recv_bytes += rhs.recv_bytes;
+      latency += rhs.latency;
+      recv_time += rhs.recv_time;
+      return *this;
+    }
+
+    KernelStats operator-(const KernelStats& rhs) const {
+      return {send_bytes - rhs.send_bytes, recv_bytes - rhs.recv_bytes,
+              latency - rhs.latency, recv_time - rhs.recv_time};
+    }
+  };
+
+  // the name used for communication outside of any kernel.
+  static constexpr char kNoKernel[] = "<no_kernel>";
+
   mutable Stats stats_;
 
   const std::shared_ptr<yacl::link::Context> lctx_;
@@ -69,20 +136,42 @@ class Communicator : public State {
   explicit Communicator(std::shared_ptr<yacl::link::Context> lctx)
       : lctx_(std::move(lctx)) {}
 
+  ~Communicator() override;
+
   Stats getStats() const { return stats_; }
 
+  const std::map<std::string, KernelStats>& getKernelStats() const {
+    return kernel_stats_;
+  }
+
   // only use when you're 100% sure what you are doing
   void addCommStatsManually(size_t latency, size_t comm) {
     stats_.latency += latency;
     stats_.comm += comm;
+    recordKernelStats({comm, 0, latency, {}});
+  }
+
+  void onKernelBegin(std::string_view name) override {
+    kernel_stack_.push_back(name);
+  }
+
+  void onKernelEnd(std::string_view name) override {
+    YACL_ENFORCE(!kernel_stack_.empty() && kernel_stack_.back() == name);
+    kernel_stack_.pop_back();
   }
 
   size_t getWorldSize() const { return lctx_->WorldSize(); }
 
   size_t getRank() const { return lctx_->Rank(); }
 
+  // With more than 3 parties, messages of at least the collective threshold
+  // use a ring all-reduce, which sends 2(n-1)/n of the message per party
+  // in 2(n-1) rounds, instead of n-1 messages in a round.
   ArrayRef allReduce(ReduceOp op, const ArrayRef& in, std::string_view tag);
 
+  // With more than 3 parties, messages of at least the collective threshold
+  // use a binomial tree, the root receives log(n) messages in log(n) rounds
+  // instead of n-1 messages in a round. Non-root parties get a copy of `in`.
   ArrayRef reduce(ReduceOp op, const ArrayRef& in, size_t root,
                   std::string_view tag);
 
@@ -92,46 +181,209 @@ class Communicator : public State {
 
   ArrayRef recv(size_t src_rank, Type eltype, std::string_view tag);
 
+  // Non-blocking variants.
+  //
+  // These are served in issue order by a background worker on a link spawned
+  // from lctx_, so the caller could overlap local computation with the
+  // transfer. Since the order is kept, `isend` should be issued before the
+  // `irecv` which depends on peers' sends. Messages sent with `isend` must be
+  // received with `irecv`, they are not interchangeable with sync ones.
+  std::future<ArrayRef> iallReduce(ReduceOp op, const ArrayRef& in,
+                                   std::string_view tag);
+
+  void isend(size_t dst_rank, const ArrayRef& in, std::string_view tag);
+
+  std::future<ArrayRef> irecv(size_t src_rank, Type eltype,
+                              std::string_view tag);
+
+  // The max number of elements each message carries when a protocol pipelines
+  // a large array, 0 means pipelining is disabled.
+  size_t getPipelineChunkSize() const { return pipeline_chunk_size_; }
+
+  void setPipelineChunkSize(size_t chunk_size) {
+    pipeline_chunk_size_ = chunk_size;
+  }
+
+  // The min bytes of a message to use the bandwidth optimal collectives, 0
+  // disables them. The async `iallReduce` always gathers.
+  size_t getCollectiveThreshold() const { return collective_threshold_; }
+
+  void setCollectiveThreshold(size_t bytes) { collective_threshold_ = bytes; }
+
+  // Stripe large messages of sendAsync, recv and rotate of ArrayRef over up
+  // to `num_links` links to each peer, i.e. lctx_ and links spawned from
+  // it, so they are not bound by the throughput of a single connection. A
+  // message takes a link per kMinStripeBytes, 1 disables striping.
+  //
+  // Warn: all parties should set the same number, before any message.
+  void setNumLinks(size_t num_links);
+
+  size_t getNumLinks() const { return stripes_.size() + 1; }
+
+  static constexpr size_t kMinStripeBytes = 1024 * 1024;
+
+  // Compress arrays of sendAsync, recv and rotate on the wire, by packing the
+  // unused high bits or zstd, see message_codec.h. A message is sent as is if
+  // it does not compress, e.g. random arithmetic shares. Stats count the
+  // bytes on the wire.
+  //
+  // Warn: all parties should set the same, before any message.
+  void setCompression(bool enable) { compression_ = enable; }
+
+  bool getCompression() const { return compression_; }
+
+  // Emulate a network of `profile` on receives of this communicator, for
+  // benchmarks on in-memory links. Links used directly, i.e. not through the
+  // communicator, are not emulated.
+  void setNetworkProfile(const NetworkProfile& profile) {
+    emulator_ = std::make_shared<NetworkEmulator>(profile);
+  }
+
   template <typename T>
-  std::vector<T> rotate(absl::Span<T const> in, std::string_view tag);
+  TypedBuffer<T> rotate(absl::Span<T const> in, std::string_view tag);
 
   template <typename T>
   void sendAsync(size_t dst_rank, absl::Span<T const> in, std::string_view tag);
 
   template <typename T>
-  std::vector<T> recv(size_t src_rank, std::string_view tag);
+  TypedBuffer<T> recv(size_t src_rank, std::string_view tag);
+
+ private:
+  void recordKernelStats(const KernelStats& stats);
+
+  // Send or receive a message striped over the links, see setNumLinks. The
+  // received data starts at the returned offset of the buffer.
+  void sendStriped(size_t dst_rank, const yacl::Buffer& buf,
+                   std::string_view tag);
+
+  std::pair<std::shared_ptr<yacl::Buffer>, int64_t> recvStriped(
+      size_t src_rank, std::string_view tag);
+
+  // Send or receive an array, compressed if enabled, return or set the bytes
+  // on the wire.
+  size_t sendArray(size_t dst_rank, const ArrayRef& in, std::string_view tag);
+
+  ArrayRef recvArray(size_t src_rank, const Type& eltype, std::string_view tag,
+                     size_t* wire_bytes);
+
+  bool useBandwidthOptimal(size_t bytes) const {
+    return getWorldSize() > 3 && collective_threshold_ != 0 &&
+           bytes >= collective_threshold_;
+  }
+
+  // Send and receive a message of a collective, bytes and the blocked time
+  // are added to `stats`.
+  void sendPart(size_t dst_rank, const ArrayRef& in, std::string_view tag,
+                KernelStats* stats);
+
+  ArrayRef recvPart(size_t src_rank, const Type& eltype, std::string_view tag,
+                    KernelStats* stats);
+
+  ArrayRef ringAllReduce(ReduceOp op, const ArrayRef& in, std::string_view tag,
+                         KernelStats* stats);
+
+  ArrayRef treeReduce(ReduceOp op, const ArrayRef& in, size_t root,
+                      std::string_view tag, KernelStats* stats);
+
+  // trace a communication action, bytes on wire are attached by the caller.
+  TraceAction traceComm(std::string_view op, std::string_view tag) const {
+    constexpr int64_t kFlag = TR_COMM | TR_REC;
+    auto tracer = getTracer(GET_CTX_NAME(this));
+    // the name is only formatted when the tracer records comm actions, as
+    // TraceAction does for its arguments.
+    const int64_t mask = tracer->getMask();
+    std::string name;
+    if ((kFlag & mask & TR_MODALL) != 0 && (kFlag & mask & TR_REC) != 0) {
+      name = fmt::format("{}:{}", op, tag);
+    }
+    return TraceAction(std::move(tracer), kFlag, ~0, name);
+  }
+
+  // Enqueue a job for the background worker, which runs jobs in order.
+  void submit(std::function<void(
+                  const std::shared_ptr<yacl::link::Context>& async_lctx)>
+                  job);
+
+  void workerLoop();
+
+  // delay a receive of `bytes` by the emulated network, if any.
+  void emulateRecv(size_t bytes) const {
+    if (emulator_ != nullptr) {
+      emulator_->wait(bytes);
+    }
+  }
+
+  std::vector<std::string_view> kernel_stack_;
+  std::map<std::string, KernelStats> kernel_stats_;
+
+  size_t pipeline_chunk_size_ = 0;
+
+  // 1MB, smaller messages are bound by latency.
+  size_t collective_threshold_ = 1024 * 1024;
+
+  bool compression_ = false;
+
+  // links spawned for striping, lctx_ is the first link.
+  std::vector<std::shared_ptr<yacl::link::Context>> stripes_;
+
+  // shared with the jobs of the async worker.
+  std::shared_ptr<NetworkEmulator> emulator_;
+
+  std::shared_ptr<yacl::link::Context> async_lctx_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void(const std::shared_ptr<yacl::link::Context>&)>>
+      jobs_;
+  bool stopped_ = false;
+  // error of jobs without a future, i.e. isend.
+  std::exception_ptr async_error_;
+  std::thread worker_;
 };
 
 template <typename T>
-std::vector<T> Communicator::rotate(absl::Span<T const> in,
+TypedBuffer<T> Communicator::rotate(absl::Span<T const> in,
                                     std::string_view tag) {
+  auto trace = traceComm("rotate", tag);
   yacl::ByteContainerView bv(reinterpret_cast<uint8_t const*>(in.data()),
                              sizeof(T) * in.size());
   lctx_->SendAsync(lctx_->PrevRank(), bv, tag);
+  const auto start = std::chrono::high_resolution_clock::now();
   auto buf = lctx_->Recv(lctx_->NextRank(), tag);
+  emulateRecv(buf.size());
+  const auto end = std::chrono::high_resolution_clock::now();
 
   stats_.latency += 1;
   stats_.comm += in.size() * sizeof(T);
+  recordKernelStats({bv.size(), static_cast<size_t>(buf.size()), 1,
+                     std::chrono::duration_cast<Duration>(end - start)});
+  trace.addCommBytes(bv.size(), buf.size());
 
   YACL_ENFORCE(buf.size() == static_cast<int64_t>(sizeof(T) * in.size()));
-  return std::vector<T>(buf.data<T>(), buf.data<T>() + in.size());
+  return TypedBuffer<T>(std::move(buf));
 }
 
 template <typename T>
 void Communicator::sendAsync(size_t dst_rank, absl::Span<T const> in,
                              std::string_view tag) {
+  auto trace = traceComm("send", tag);
   yacl::ByteContainerView bv(reinterpret_cast<uint8_t const*>(in.data()),
                              sizeof(T) * in.size());
   lctx_->SendAsync(dst_rank, bv, tag);
+  recordKernelStats({bv.size(), 0, 0, {}});
+  trace.addCommBytes(bv.size(), 0);
 }
 
 template <typename T>
-std::vector<T> Communicator::recv(size_t src_rank, std::string_view tag) {
+TypedBuffer<T> Communicator::recv(size_t src_rank, std::string_view tag) {
+  auto trace = traceComm("recv", tag);
+  const auto start = std::chrono::high_resolution_clock::now();
   auto buf = lctx_->Recv(src_rank, tag);
-  YACL_ENFORCE(buf.size() % sizeof(T) == 0);
-  auto numel = buf.size() / sizeof(T);
-  // TODO: use a container which memory could be stealed.
-  return std::vector<T>(buf.data<T>(), buf.data<T>() + numel);
+  emulateRecv(buf.size());
+  const auto end = std::chrono::high_resolution_clock::now();
+  recordKernelStats({0, static_cast<size_t>(buf.size()), 0,
+                     std::chrono::duration_cast<Duration>(end - start)});
+  trace.addCommBytes(0, buf.size());
+  return TypedBuffer<T>(std::move(buf));
 }
 
 }  // namespace spu::mpc
@@ -0,0 +1,97 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+
+#include "benchmark/benchmark.h"
+#include "spdlog/spdlog.h"
+
+#include "spu/mpc/util/communicator.h"
+#include "spu/mpc/util/ring_ops.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::mpc::util {
+
+// Collectives of 2..16 parties on an emulated lan, where the last arg picks
+// the direct gather (0) or the bandwidth optimal algorithms (1).
+static void makeCollectiveArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({
+      {2, 3, 4, 5, 7, 9, 16},  // world size
+      {1 << 10, 1 << 20},      // numel
+      {0, 1},                  // bandwidth optimal
+  });
+}
+
+template <typename Fn>
+static void runCollective(benchmark::State& state, Fn&& fn) {
+  const size_t world_size = state.range(0);
+  const int64_t numel = state.range(1);
+  const bool optimal = state.range(2) != 0;
+
+  for (auto _ : state) {
+    double seconds = 0;
+    Communicator::Stats stats;
+    simulate(world_size, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+      Communicator com(lctx);
+      com.setNetworkProfile(NetworkProfile::lan());
+      com.setCollectiveThreshold(optimal ? 1 : 0);
+      const auto x = ring_rand(FM64, numel);
+
+      const auto start = std::chrono::high_resolution_clock::now();
+      fn(com, x);
+      if (lctx->Rank() == 0) {
+        seconds = std::chrono::duration<double>(
+                      std::chrono::high_resolution_clock::now() - start)
+                      .count();
+        stats = com.getStats();
+      }
+    });
+    state.SetIterationTime(seconds);
+    state.counters["rounds"] = static_cast<double>(stats.latency);
+    state.counters["send_bytes"] = static_cast<double>(stats.comm);
+  }
+}
+
+static void BM_AllReduce(benchmark::State& state) {
+  runCollective(state, [](Communicator& com, const ArrayRef& x) {
+    benchmark::DoNotOptimize(com.allReduce(ReduceOp::ADD, x, "_"));
+  });
+}
+
+static void BM_Reduce(benchmark::State& state) {
+  runCollective(state, [](Communicator& com, const ArrayRef& x) {
+    benchmark::DoNotOptimize(com.reduce(ReduceOp::ADD, x, 0, "_"));
+  });
+}
+
+BENCHMARK(BM_AllReduce)
+    ->Apply(makeCollectiveArgs)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Reduce)
+    ->Apply(makeCollectiveArgs)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace spu::mpc::util
+
+int main(int argc, char** argv) {
+  // suppress all link logs.
+  spdlog::set_level(spdlog::level::off);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
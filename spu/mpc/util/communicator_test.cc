@@ -16,6 +16,7 @@
 
 #include "gtest/gtest.h"
 
+#include "spu/mpc/util/bit_utils.h"
 #include "spu/mpc/util/ring_ops.h"
 #include "spu/mpc/util/simulate.h"
 
@@ -105,6 +106,238 @@ TEST_P(CommTest, Rotate) {
   });
 }
 
+TEST_P(CommTest, IAllReduce) {
+  const Rank kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  const int64_t kNumel = 1000;
+  const size_t kChunks = 4;
+
+  std::vector<std::vector<ArrayRef>> xs(kWorldSize);
+  std::vector<ArrayRef> sum_xs(kChunks);
+  for (size_t chunk = 0; chunk < kChunks; chunk++) {
+    sum_xs[chunk] = ring_zeros(kField, kNumel);
+    for (size_t idx = 0; idx < kWorldSize; idx++) {
+      xs[idx].push_back(ring_rand(kField, kNumel));
+      ring_add_(sum_xs[chunk], xs[idx][chunk]);
+    }
+  }
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator com(lctx);
+    // WHEN
+    std::vector<std::future<ArrayRef>> futures;
+    for (size_t chunk = 0; chunk < kChunks; chunk++) {
+      futures.push_back(
+          com.iallReduce(ReduceOp::ADD, xs[com.getRank()][chunk], "_"));
+    }
+    // sync ops are not blocked by pending async ones.
+    auto r = com.rotate(xs[com.getRank()][0], "_");
+
+    // THEN
+    EXPECT_TRUE(ring_all_equal(r, xs[(com.getRank() + 1) % kWorldSize][0]));
+    for (size_t chunk = 0; chunk < kChunks; chunk++) {
+      EXPECT_TRUE(ring_all_equal(futures[chunk].get(), sum_xs[chunk]));
+    }
+    EXPECT_EQ(com.getStats().latency, kChunks + 1);
+  });
+}
+
+TEST_P(CommTest, IRecv) {
+  const Rank kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  const int64_t kNumel = 1000;
+
+  std::vector<ArrayRef> xs(kWorldSize);
+  for (size_t idx = 0; idx < kWorldSize; idx++) {
+    xs[idx] = ring_rand(kField, kNumel);
+  }
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator com(lctx);
+    // WHEN
+    const size_t next = (com.getRank() + 1) % kWorldSize;
+    const size_t prev = (com.getRank() + kWorldSize - 1) % kWorldSize;
+    com.isend(prev, xs[com.getRank()], "_");
+    auto future = com.irecv(next, xs[0].eltype(), "_");
+
+    // THEN
+    EXPECT_TRUE(ring_all_equal(future.get(), xs[next]));
+  });
+}
+
+TEST_P(CommTest, KernelStats) {
+  const Rank kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  const int64_t kNumel = 1000;
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator com(lctx);
+    auto x = ring_rand(kField, kNumel);
+    const size_t bytes = x.numel() * x.elsize();
+
+    // WHEN
+    com.onKernelBegin("outer");
+    com.rotate(x, "_");
+    com.onKernelBegin("inner");
+    com.allReduce(ReduceOp::ADD, x, "_");
+    com.onKernelEnd("inner");
+    com.onKernelEnd("outer");
+    com.rotate(x, "_");
+
+    // THEN
+    const auto& stats = com.getKernelStats();
+    ASSERT_EQ(stats.size(), 3U);
+    EXPECT_EQ(stats.at("outer").send_bytes, bytes);
+    EXPECT_EQ(stats.at("outer").recv_bytes, bytes);
+    EXPECT_EQ(stats.at("outer").latency, 1U);
+    EXPECT_EQ(stats.at("inner").send_bytes, bytes * (kWorldSize - 1));
+    EXPECT_EQ(stats.at("inner").recv_bytes, bytes * (kWorldSize - 1));
+    EXPECT_EQ(stats.at("inner").latency, 1U);
+    EXPECT_EQ(stats.at(Communicator::kNoKernel).latency, 1U);
+  });
+}
+
+TEST_P(CommTest, BandwidthOptimal) {
+  const Rank kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  // not a multiple of world size.
+  const int64_t kNumel = 1001;
+
+  std::vector<ArrayRef> xs(kWorldSize);
+  ArrayRef sum_x = ring_zeros(kField, kNumel);
+  for (size_t idx = 0; idx < kWorldSize; idx++) {
+    xs[idx] = ring_rand(kField, kNumel);
+    ring_add_(sum_x, xs[idx]);
+  }
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator com(lctx);
+    com.setCollectiveThreshold(1);
+    const bool optimal = kWorldSize > 3;
+
+    // WHEN
+    auto prev = com.getStats();
+    auto sum_r = com.allReduce(ReduceOp::ADD, xs[com.getRank()], "_");
+
+    // THEN
+    EXPECT_TRUE(ring_all_equal(sum_r, sum_x));
+    EXPECT_EQ((com.getStats() - prev).latency,
+              optimal ? 2 * (kWorldSize - 1) : 1);
+
+    for (size_t root = 0; root < kWorldSize; root++) {
+      // WHEN
+      prev = com.getStats();
+      auto r = com.reduce(ReduceOp::ADD, xs[com.getRank()], root, "_");
+
+      // THEN
+      EXPECT_TRUE(ring_all_equal(
+          r, com.getRank() == root ? sum_x : xs[com.getRank()]));
+      EXPECT_EQ((com.getStats() - prev).latency,
+                optimal ? log2Ceil(kWorldSize) : 1);
+    }
+  });
+}
+
+TEST_P(CommTest, Striped) {
+  const Rank kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  // a small message, and messages of 2 and more parts than links.
+  const std::vector<size_t> kSizes = {1000,
+                                      Communicator::kMinStripeBytes * 5 / 2,
+                                      Communicator::kMinStripeBytes * 9};
+
+  for (size_t bytes : kSizes) {
+    std::vector<ArrayRef> xs(kWorldSize);
+    for (size_t idx = 0; idx < kWorldSize; idx++) {
+      xs[idx] = ring_rand(kField, bytes / SizeOf(kField));
+    }
+
+    util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+      Communicator com(lctx);
+      com.setNumLinks(3);
+      EXPECT_EQ(com.getNumLinks(), 3U);
+
+      // WHEN
+      auto rotated = com.rotate(xs[lctx->Rank()], "_");
+      com.sendAsync(lctx->NextRank(), xs[lctx->Rank()], "_");
+      auto received = com.recv(lctx->PrevRank(), xs[0].eltype(), "_");
+
+      // THEN
+      EXPECT_TRUE(ring_all_equal(rotated, xs[lctx->NextRank()]));
+      EXPECT_TRUE(ring_all_equal(received, xs[lctx->PrevRank()]));
+    });
+  }
+}
+
+TEST_P(CommTest, Compressed) {
+  const Rank kWorldSize = std::get<0>(GetParam());
+  const FieldType kField = std::get<1>(GetParam());
+  const int64_t kNumel = 10000;
+
+  // random shares that can't be compressed, and bits that can.
+  std::vector<ArrayRef> xs(kWorldSize);
+  std::vector<ArrayRef> bits(kWorldSize);
+  for (size_t idx = 0; idx < kWorldSize; idx++) {
+    xs[idx] = ring_rand(kField, kNumel);
+    bits[idx] = ring_rshift(ring_rand(kField, kNumel), SizeOf(kField) * 8 - 1);
+  }
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator com(lctx);
+    com.setCompression(true);
+    EXPECT_TRUE(com.getCompression());
+    const size_t bytes = kNumel * SizeOf(kField);
+
+    // WHEN
+    auto rotated = com.rotate(xs[lctx->Rank()], "_");
+    const auto after_rand = com.getStats();
+    auto rotated_bits = com.rotate(bits[lctx->Rank()], "_");
+    const auto after_bits = com.getStats();
+    com.sendAsync(lctx->NextRank(), bits[lctx->Rank()], "_");
+    auto received = com.recv(lctx->PrevRank(), bits[0].eltype(), "_");
+
+    // THEN
+    EXPECT_TRUE(ring_all_equal(rotated, xs[lctx->NextRank()]));
+    EXPECT_TRUE(ring_all_equal(rotated_bits, bits[lctx->NextRank()]));
+    EXPECT_TRUE(ring_all_equal(received, bits[lctx->PrevRank()]));
+    EXPECT_GE(after_rand.comm, bytes);
+    EXPECT_LT(after_bits.comm - after_rand.comm, bytes / 16);
+  });
+}
+
+TEST(CommManyPartyTest, BandwidthOptimal) {
+  const size_t kWorldSize = 9;
+  const int64_t kNumel = 1 << 16;
+
+  std::vector<ArrayRef> xs(kWorldSize);
+  ArrayRef xor_x = ring_zeros(FM64, kNumel);
+  for (size_t idx = 0; idx < kWorldSize; idx++) {
+    xs[idx] = ring_rand(FM64, kNumel);
+    ring_xor_(xor_x, xs[idx]);
+  }
+
+  util::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    Communicator com(lctx);
+    com.setCollectiveThreshold(1);
+
+    // WHEN
+    auto xor_r = com.allReduce(ReduceOp::XOR, xs[com.getRank()], "_");
+    auto reduced = com.reduce(ReduceOp::XOR, xs[com.getRank()], 5, "_");
+
+    // THEN
+    EXPECT_TRUE(ring_all_equal(xor_r, xor_x));
+    if (com.getRank() == 5) {
+      EXPECT_TRUE(ring_all_equal(reduced, xor_x));
+    }
+    // each party sends about 2(n-1)/n of the array in all-reduce, parts are
+    // rounded to elements, and at most one array in reduce.
+    const size_t bytes = kNumel * sizeof(uint64_t);
+    const size_t slack = 4 * sizeof(uint64_t);
+    EXPECT_LE(com.getStats().comm,
+              2 * bytes * (kWorldSize - 1) / kWorldSize + slack + bytes);
+  });
+}
+
 INSTANTIATE_TEST_SUITE_P(
     CommTestInstances, CommTest,
     testing::Combine(testing::Values(4, 3, 2),
@@ -14,10 +14,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <type_traits>
+#include <vector>
 
 #include "spdlog/spdlog.h"
 #include "yacl/base/exception.h"
+#include "yacl/base/int128.h"
 
 #include "spu/core/parallel_utils.h"
 
@@ -31,15 +35,178 @@ namespace detail {
 
 void setEigenParallelLevel(int64_t expected_threads);
 
+// Blocking of matmulTiled, a task computes a kTileM x kTileN tile of C, by
+// panels of kTileK, and a micro kernel a kMicroM x kMicroN block in registers.
+constexpr int64_t kTileM = 64;
+constexpr int64_t kTileN = 128;
+constexpr int64_t kTileK = 128;
+constexpr int64_t kMicroM = 2;
+constexpr int64_t kMicroN = 2;
+
+// C[0:m, 0:n] (+)= A * B of packed panels, where pa has kMicroM rows of every
+// k and pb kMicroN columns of every k.
+template <typename T>
+void microKernel(int64_t m, int64_t n, int64_t kc, const T* pa, const T* pb,
+                 T* C, int64_t LDC, int64_t IDC, bool accumulate) {
+  T acc[kMicroM][kMicroN] = {};
+  for (int64_t k = 0; k < kc; k++) {
+    const T* a = pa + k * kMicroM;
+    const T* b = pb + k * kMicroN;
+    for (int64_t i = 0; i < kMicroM; i++) {
+      for (int64_t j = 0; j < kMicroN; j++) {
+        acc[i][j] += a[i] * b[j];
+      }
+    }
+  }
+  for (int64_t i = 0; i < m; i++) {
+    for (int64_t j = 0; j < n; j++) {
+      T& c = C[i * LDC + j * IDC];
+      c = accumulate ? c + acc[i][j] : acc[i][j];
+    }
+  }
+}
+
+// The cross products of the halves of 128 bits only reach the high 64 bits,
+// so they are summed by 64x64 multiplies, only the product of the low halves
+// takes a 64x64->128 one, and the carries are added once per block.
+template <>
+inline void microKernel<uint128_t>(int64_t m, int64_t n, int64_t kc,
+                                   const uint128_t* pa, const uint128_t* pb,
+                                   uint128_t* C, int64_t LDC, int64_t IDC,
+                                   bool accumulate) {
+  uint128_t low[kMicroM][kMicroN] = {};
+  uint64_t cross[kMicroM][kMicroN] = {};
+  for (int64_t k = 0; k < kc; k++) {
+    const uint128_t* a = pa + k * kMicroM;
+    const uint128_t* b = pb + k * kMicroN;
+    for (int64_t i = 0; i < kMicroM; i++) {
+      const auto a_lo = static_cast<uint64_t>(a[i]);
+      const auto a_hi = static_cast<uint64_t>(a[i] >> 64);
+      for (int64_t j = 0; j < kMicroN; j++) {
+        const auto b_lo = static_cast<uint64_t>(b[j]);
+        low[i][j] += static_cast<uint128_t>(a_lo) * b_lo;
+      }
+      for (int64_t j = 0; j < kMicroN; j++) {
+        cross[i][j] += a_lo * static_cast<uint64_t>(b[j] >> 64) +
+                       a_hi * static_cast<uint64_t>(b[j]);
+      }
+    }
+  }
+  for (int64_t i = 0; i < m; i++) {
+    for (int64_t j = 0; j < n; j++) {
+      const auto v = low[i][j] + (static_cast<uint128_t>(cross[i][j]) << 64);
+      uint128_t& c = C[i * LDC + j * IDC];
+      c = accumulate ? c + v : v;
+    }
+  }
+}
+
+// Copy a rows x cols block of a strided matrix to panels of `panel` rows,
+// each stored k-major, i.e. panels of A when traversed by (row, k) and of B
+// when traversed by (col, k). Rows beyond the block are zeros.
+template <typename T>
+void packPanels(int64_t rows, int64_t cols, int64_t panel, const T* X,
+                int64_t row_stride, int64_t col_stride, T* packed) {
+  for (int64_t r0 = 0; r0 < rows; r0 += panel) {
+    const int64_t pr = std::min(panel, rows - r0);
+    for (int64_t c = 0; c < cols; c++) {
+      for (int64_t r = 0; r < pr; r++) {
+        packed[c * panel + r] = X[(r0 + r) * row_stride + c * col_stride];
+      }
+      std::fill_n(packed + c * panel + pr, panel - pr, T(0));
+    }
+    packed += panel * cols;
+  }
+}
+
+}  // namespace detail
+
+namespace detail {
+
+// Run `fn(begin, end, compact)` over parallel ranges of [0, numel), where
+// `compact` is std::true_type when all strides are 1, the layout is decided
+// once per call so the contiguous loops are instantiated without strides and
+// vectorized.
+template <typename Fn>
+void forEachLayout(int64_t numel, bool compact, Fn&& fn) {
+  if (compact) {
+    pfor(0, numel,
+         [&](int64_t begin, int64_t end) { fn(begin, end, std::true_type{}); });
+  } else {
+    pfor(0, numel, [&](int64_t begin, int64_t end) {
+      fn(begin, end, std::false_type{});
+    });
+  }
+}
+
+// The stride in a loop of the layout, a constant 1 for the compact one.
+template <typename Compact>
+constexpr int64_t strideOf(Compact, int64_t stride) {
+  if constexpr (Compact::value) {
+    return 1;
+  } else {
+    return stride;
+  }
+}
+
+// C[0:numel] := value, a stride 0 C, e.g. a broadcasted scalar updated in
+// place, is written once.
+template <typename T>
+void fill(int64_t numel, T* C, int64_t stride_C, T value) {
+  if (stride_C == 0) {
+    if (numel > 0) {
+      C[0] = value;
+    }
+    return;
+  }
+  forEachLayout(numel, stride_C == 1,
+                [&](int64_t begin, int64_t end, auto layout) {
+                  const int64_t sc = strideOf(layout, stride_C);
+                  for (int64_t idx = begin; idx < end; idx++) {
+                    C[idx * sc] = value;
+                  }
+                });
+}
+
 }  // namespace detail
 
-#define EIGEN_BINARY_FCN(NAME, OP)                                   \
-  template <typename T>                                              \
-  void NAME(int64_t numel, const T* A, int64_t stride_A, const T* B, \
-            int64_t stride_B, T* C, int64_t stride_C) {              \
-    pforeach(0, numel, [&](int64_t idx) {                            \
-      C[idx * stride_C] = A[idx * stride_A] OP B[idx * stride_B];    \
-    });                                                              \
+// Operands of stride 0, e.g. broadcasted public scalars, are read once and
+// kept in a register, so a compact operand and output still run the
+// contiguous loop instead of the strided one, and constant inputs only take
+// a single evaluation.
+#define EIGEN_BINARY_FCN(NAME, OP)                                             \
+  template <typename T>                                                        \
+  void NAME(int64_t numel, const T* A, int64_t stride_A, const T* B,           \
+            int64_t stride_B, T* C, int64_t stride_C) {                        \
+    if (numel > 0 && stride_A == 0 && stride_B == 0) {                         \
+      return detail::fill(numel, C, stride_C, static_cast<T>(A[0] OP B[0]));   \
+    }                                                                          \
+    if (stride_A == 0 && stride_B == 1 && stride_C == 1) {                     \
+      const T a = numel > 0 ? A[0] : T(0);                                     \
+      return pfor(0, numel, [&](int64_t begin, int64_t end) {                  \
+        for (int64_t idx = begin; idx < end; idx++) {                          \
+          C[idx] = a OP B[idx];                                                \
+        }                                                                      \
+      });                                                                      \
+    }                                                                          \
+    if (stride_B == 0 && stride_A == 1 && stride_C == 1) {                     \
+      const T b = numel > 0 ? B[0] : T(0);                                     \
+      return pfor(0, numel, [&](int64_t begin, int64_t end) {                  \
+        for (int64_t idx = begin; idx < end; idx++) {                          \
+          C[idx] = A[idx] OP b;                                                \
+        }                                                                      \
+      });                                                                      \
+    }                                                                          \
+    const bool compact = stride_A == 1 && stride_B == 1 && stride_C == 1;      \
+    detail::forEachLayout(                                                     \
+        numel, compact, [&](int64_t begin, int64_t end, auto layout) {         \
+          const int64_t sa = detail::strideOf(layout, stride_A);               \
+          const int64_t sb = detail::strideOf(layout, stride_B);               \
+          const int64_t sc = detail::strideOf(layout, stride_C);               \
+          for (int64_t idx = begin; idx < end; idx++) {                        \
+            C[idx * sc] = A[idx * sa] OP B[idx * sb];                          \
+          }                                                                    \
+        });                                                                    \
   }
 
 EIGEN_BINARY_FCN(mul, *)
@@ -51,12 +218,28 @@ EIGEN_BINARY_FCN(bitwise_xor, ^)
 
 #undef EIGEN_BINARY_FCN
 
+template <typename T, typename OP>
+void unaryWithOp(int64_t numel, const T* A, int64_t stride_A, T* C,
+                 int64_t stride_C, const OP& op) {
+  if (stride_A == 0 && numel > 0) {
+    return detail::fill(numel, C, stride_C, static_cast<T>(op(A[0])));
+  }
+  const bool compact = stride_A == 1 && stride_C == 1;
+  detail::forEachLayout(
+      numel, compact, [&](int64_t begin, int64_t end, auto layout) {
+        const int64_t sa = detail::strideOf(layout, stride_A);
+        const int64_t sc = detail::strideOf(layout, stride_C);
+        for (int64_t idx = begin; idx < end; idx++) {
+          C[idx * sc] = op(A[idx * sa]);
+        }
+      });
+}
+
 #define EIGEN_UNARY_FCN_WITH_OP(NAME, OP)                                     \
   template <typename T>                                                       \
   void NAME(int64_t numel, const T* A, int64_t stride_A, T* C,                \
             int64_t stride_C) {                                               \
-    pforeach(0, numel,                                                        \
-             [&](int64_t idx) { C[idx * stride_C] = OP A[idx * stride_A]; }); \
+    unaryWithOp(numel, A, stride_A, C, stride_C, [](T v) { return OP v; });   \
   }
 
 EIGEN_UNARY_FCN_WITH_OP(bitwise_not, ~)
@@ -64,13 +247,12 @@ EIGEN_UNARY_FCN_WITH_OP(negate, -)
 
 #undef EIGEN_UNARY_FCN_WITH_OP
 
-#define EIGEN_SHIFT_FCN_WITH_OP(NAME, OP)                      \
-  template <typename T>                                        \
-  void NAME(int64_t numel, const T* A, int64_t stride_A, T* C, \
-            int64_t stride_C, int64_t bits) {                  \
-    pforeach(0, numel, [&](int64_t idx) {                      \
-      C[idx * stride_C] = A[idx * stride_A] OP bits;           \
-    });                                                        \
+#define EIGEN_SHIFT_FCN_WITH_OP(NAME, OP)                                    \
+  template <typename T>                                                      \
+  void NAME(int64_t numel, const T* A, int64_t stride_A, T* C,               \
+            int64_t stride_C, int64_t bits) {                                \
+    unaryWithOp(numel, A, stride_A, C, stride_C,                             \
+                [bits](T v) { return static_cast<T>(v OP bits); });          \
   }
 
 EIGEN_SHIFT_FCN_WITH_OP(rshift, >>)
@@ -78,41 +260,43 @@ EIGEN_SHIFT_FCN_WITH_OP(lshift, <<)
 
 #undef EIGEN_SHIFT_FCN_WITH_OP
 
-template <typename T, typename OP>
-void unaryWithOp(int64_t numel, const T* A, int64_t stride_A, T* C,
-                 int64_t stride_C, const OP& op) {
-  pforeach(0, numel, [&](int64_t idx) {  //
-    C[idx * stride_C] = op(A[idx * stride_A]);
-  });
-}
-
 template <typename T>
 void assign(int64_t numel, const T* A, int64_t stride_A, T* C,
             int64_t stride_C) {
-  pforeach(0, numel, [&](int64_t idx) {  //
-    C[idx * stride_C] = A[idx * stride_A];
-  });
+  unaryWithOp(numel, A, stride_A, C, stride_C, [](T v) { return v; });
 }
 
 template <typename T>
 void setConstantValue(int64_t numel, T* A, int64_t stride_A, T value) {
-  pforeach(0, numel, [&](int64_t idx) {  //
-    A[idx * stride_A] = value;
-  });
+  detail::forEachLayout(
+      numel, stride_A == 1, [&](int64_t begin, int64_t end, auto layout) {
+        const int64_t sa = detail::strideOf(layout, stride_A);
+        for (int64_t idx = begin; idx < end; idx++) {
+          A[idx * sa] = value;
+        }
+      });
 }
 
 template <typename T>
 void select(int64_t numel, const uint8_t* cond, const T* on_true,
             int64_t on_true_stride, const T* on_false, int64_t on_false_stride,
             T* ret, int64_t ret_stride) {
-  pforeach(0, numel, [&](int64_t idx) {
-    ret[idx * ret_stride] = (cond[idx] ? on_true[idx * on_true_stride]
-                                       : on_false[idx * on_false_stride]);
-  });
+  const bool compact =
+      on_true_stride == 1 && on_false_stride == 1 && ret_stride == 1;
+  detail::forEachLayout(
+      numel, compact, [&](int64_t begin, int64_t end, auto layout) {
+        const int64_t st = detail::strideOf(layout, on_true_stride);
+        const int64_t sf = detail::strideOf(layout, on_false_stride);
+        const int64_t sr = detail::strideOf(layout, ret_stride);
+        for (int64_t idx = begin; idx < end; idx++) {
+          ret[idx * sr] = cond[idx] ? on_true[idx * st] : on_false[idx * sf];
+        }
+      });
 }
 
 /**
- * @brief C := op( A )*op( B )
+ * @brief C := op( A )*op( B ) of ring elements, blocked by tiles of C and
+ * multithreaded over them, with panels of A and B packed to be contiguous.
  *
  * @tparam T Type of A, B, C
  * @param M   Number of rows in A
@@ -129,9 +313,61 @@ void select(int64_t numel, const uint8_t* cond, const T* on_true,
  * @param IDC Inner dimension stride of C
  */
 template <typename T>
+void matmulTiled(int64_t M, int64_t N, int64_t K, const T* A, int64_t LDA,
+                 int64_t IDA, const T* B, int64_t LDB, int64_t IDB, T* C,
+                 int64_t LDC, int64_t IDC) {
+  using namespace detail;
+  if (K == 0) {
+    for (int64_t i = 0; i < M; i++) {
+      setConstantValue(N, C + i * LDC, IDC, T(0));
+    }
+    return;
+  }
+
+  const int64_t tiles_m = (M + kTileM - 1) / kTileM;
+  const int64_t tiles_n = (N + kTileN - 1) / kTileN;
+  yacl::parallel_for(0, tiles_m * tiles_n, 1, [&](int64_t begin, int64_t end) {
+    std::vector<T> pa(kTileM * kTileK);
+    std::vector<T> pb(kTileN * kTileK);
+    for (int64_t tile = begin; tile < end; tile++) {
+      const int64_t m0 = (tile / tiles_n) * kTileM;
+      const int64_t n0 = (tile % tiles_n) * kTileN;
+      const int64_t mc = std::min(kTileM, M - m0);
+      const int64_t nc = std::min(kTileN, N - n0);
+      for (int64_t k0 = 0; k0 < K; k0 += kTileK) {
+        const int64_t kc = std::min(kTileK, K - k0);
+        packPanels(mc, kc, kMicroM, A + m0 * LDA + k0 * IDA, LDA, IDA,
+                   pa.data());
+        packPanels(nc, kc, kMicroN, B + k0 * LDB + n0 * IDB, IDB, LDB,
+                   pb.data());
+        for (int64_t i = 0; i < mc; i += kMicroM) {
+          for (int64_t j = 0; j < nc; j += kMicroN) {
+            microKernel(std::min(kMicroM, mc - i), std::min(kMicroN, nc - j),
+                        kc, pa.data() + i * kc, pb.data() + j * kc,
+                        C + (m0 + i) * LDC + (n0 + j) * IDC, LDC, IDC,
+                        k0 > 0);
+          }
+        }
+      }
+    }
+  });
+}
+
+/**
+ * @brief C := op( A )*op( B )
+ *
+ * Eigen has no vectorized path of 128 bits, so its generic kernel is no faster
+ * than matmulTiled, which also runs on all threads of the pool, where Eigen
+ * is limited to two, so 128 bits go to matmulTiled.
+ */
+template <typename T>
 void matmul(int64_t M, int64_t N, int64_t K, const T* A, int64_t LDA,
             int64_t IDA, const T* B, int64_t LDB, int64_t IDB, T* C,
             int64_t LDC, int64_t IDC) {
+  if constexpr (std::is_same_v<T, uint128_t>) {
+    return matmulTiled(M, N, K, A, LDA, IDA, B, LDB, IDB, C, LDC, IDC);
+  }
+
   using StrideT = Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>;
   using MapMatrixConstT = Eigen::Map<
       const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
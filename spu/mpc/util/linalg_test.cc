@@ -14,6 +14,7 @@
 
 #include "spu/mpc/util/linalg.h"
 
+#include <random>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -52,6 +53,44 @@ TEST(LinalgTest, MatMulStrides) {
   EXPECT_EQ(C, expected);
 }
 
+template <typename T>
+class LinalgTiledTest : public ::testing::Test {};
+
+using RingTypes = ::testing::Types<uint32_t, uint64_t, uint128_t>;
+TYPED_TEST_SUITE(LinalgTiledTest, RingTypes);
+
+TYPED_TEST(LinalgTiledTest, MatMulTiled) {
+  using T = TypeParam;
+  std::mt19937_64 rng(0);
+  // sizes across tiles, micro kernel tails, and K panels.
+  for (auto [M, N, K] : std::vector<std::tuple<int64_t, int64_t, int64_t>>{
+           {1, 1, 1}, {3, 5, 7}, {65, 130, 129}, {200, 3, 260}, {4, 4, 0}}) {
+    // A and B are strided by 2, C by 3.
+    std::vector<T> A(M * K * 2);
+    std::vector<T> B(K * N * 2);
+    for (auto& x : A) {
+      x = static_cast<T>((static_cast<uint128_t>(rng()) << 64) | rng());
+    }
+    for (auto& x : B) {
+      x = static_cast<T>((static_cast<uint128_t>(rng()) << 64) | rng());
+    }
+    std::vector<T> C(M * N * 3, 1);
+
+    matmulTiled(M, N, K, A.data(), 2 * K, 2, B.data(), 2 * N, 2, C.data(),
+                3 * N, 3);
+
+    for (int64_t i = 0; i < M; i++) {
+      for (int64_t j = 0; j < N; j++) {
+        T expected = 0;
+        for (int64_t k = 0; k < K; k++) {
+          expected += A[2 * (i * K + k)] * B[2 * (k * N + j)];
+        }
+        ASSERT_EQ(C[3 * (i * N + j)], expected) << i << "," << j;
+      }
+    }
+  }
+}
+
 TEST(LinalgTest, Select) {
   std::vector<float> A = {1,  2,  3,    //
                           5,  6,  7,    //
@@ -0,0 +1,286 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/message_codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "yacl/base/exception.h"
+#include "zstd.h"
+
+#include "spu/core/parallel_utils.h"
+
+namespace spu::mpc {
+namespace {
+
+enum class Codec : uint8_t {
+  Raw = 0,
+  Packed = 1,
+  Zstd = 2,
+};
+
+struct Header {
+  // size of the decoded data in bytes.
+  uint64_t size;
+  Codec codec;
+  // bits of a packed word, a power of 2.
+  uint8_t width;
+  uint8_t word_size;
+  uint8_t reserved[5];
+};
+static_assert(sizeof(Header) == 16);
+
+// the words checked before a full scan, random words use all bits.
+constexpr size_t kProbeWords = 64;
+
+// messages smaller than this are not worth a try of zstd.
+constexpr size_t kMinZstdBytes = 4096;
+
+// zstd is tried on a sample of this size first.
+constexpr size_t kZstdSampleBytes = 64 * 1024;
+
+// the max ratio of compressed size to take zstd.
+constexpr double kZstdMaxRatio = 0.8;
+
+template <typename U>
+uint64_t orAll(U const* words, size_t count) {
+  std::atomic<uint64_t> result = 0;
+  pfor(0, count, [&](int64_t begin, int64_t end) {
+    U acc = 0;
+    for (int64_t idx = begin; idx < end; idx++) {
+      acc |= words[idx];
+    }
+    result.fetch_or(acc);
+  });
+  return result.load();
+}
+
+// The packed width of words, or 0 if they use all bits.
+template <typename U>
+uint8_t packedWidth(U const* words, size_t count) {
+  constexpr size_t kBits = sizeof(U) * 8;
+  U probe = 0;
+  for (size_t idx = 0; idx < std::min(count, kProbeWords); idx++) {
+    probe |= words[idx];
+  }
+  if (absl::bit_width(probe) > static_cast<int>(kBits / 2)) {
+    return 0;
+  }
+
+  const auto bits = absl::bit_width(orAll(words, count));
+  const auto width = std::max<uint64_t>(absl::bit_ceil<uint64_t>(bits), 1);
+  return width < kBits ? static_cast<uint8_t>(width) : 0;
+}
+
+template <typename U, typename P>
+void narrow(U const* words, size_t count, uint8_t* out) {
+  auto* packed = reinterpret_cast<P*>(out);
+  pforeach(0, count,
+           [&](int64_t idx) { packed[idx] = static_cast<P>(words[idx]); });
+}
+
+template <typename P, typename U>
+void widen(uint8_t const* in, size_t count, U* words) {
+  auto const* packed = reinterpret_cast<P const*>(in);
+  pforeach(0, count, [&](int64_t idx) { words[idx] = packed[idx]; });
+}
+
+// pack words of width 1, 2 or 4 into bytes.
+template <typename U>
+void packBits(U const* words, size_t count, uint8_t width, uint8_t* out) {
+  const size_t per_byte = 8 / width;
+  const size_t num_bytes = (count + per_byte - 1) / per_byte;
+  pforeach(0, num_bytes, [&](int64_t byte) {
+    uint8_t acc = 0;
+    const size_t end = std::min((byte + 1) * per_byte, count);
+    for (size_t idx = byte * per_byte; idx < end; idx++) {
+      acc |= static_cast<uint8_t>(words[idx]) << ((idx % per_byte) * width);
+    }
+    out[byte] = acc;
+  });
+}
+
+template <typename U>
+void unpackBits(uint8_t const* in, size_t count, uint8_t width, U* words) {
+  const size_t per_byte = 8 / width;
+  const uint8_t mask = (1 << width) - 1;
+  pforeach(0, count, [&](int64_t idx) {
+    words[idx] = (in[idx / per_byte] >> ((idx % per_byte) * width)) & mask;
+  });
+}
+
+size_t packedSize(size_t count, uint8_t width) {
+  return (count * width + 7) / 8;
+}
+
+template <typename U>
+void pack(U const* words, size_t count, uint8_t width, uint8_t* out) {
+  switch (width) {
+    case 8:
+      return narrow<U, uint8_t>(words, count, out);
+    case 16:
+      return narrow<U, uint16_t>(words, count, out);
+    case 32:
+      return narrow<U, uint32_t>(words, count, out);
+    default:
+      return packBits(words, count, width, out);
+  }
+}
+
+template <typename U>
+void unpack(uint8_t const* in, size_t count, uint8_t width, U* words) {
+  switch (width) {
+    case 8:
+      return widen<uint8_t>(in, count, words);
+    case 16:
+      return widen<uint16_t>(in, count, words);
+    case 32:
+      return widen<uint32_t>(in, count, words);
+    default:
+      return unpackBits(in, count, width, words);
+  }
+}
+
+#define DISPATCH_WORD_SIZE(WORD_SIZE, ...)                 \
+  [&] {                                                    \
+    switch (WORD_SIZE) {                                   \
+      case 2: {                                            \
+        using U = uint16_t;                                \
+        return __VA_ARGS__();                              \
+      }                                                    \
+      case 4: {                                            \
+        using U = uint32_t;                                \
+        return __VA_ARGS__();                              \
+      }                                                    \
+      case 8: {                                            \
+        using U = uint64_t;                                \
+        return __VA_ARGS__();                              \
+      }                                                    \
+      default:                                             \
+        YACL_THROW("unsupported word size {}", WORD_SIZE); \
+    }                                                      \
+  }()
+
+// The largest packable word of a message of `size` and elements of
+// `word_size`, or 0 if it can't be packed.
+size_t packableWordSize(size_t size, size_t word_size) {
+  for (size_t unit : {8, 4, 2}) {
+    if (word_size % unit == 0 && size % unit == 0) {
+      return unit;
+    }
+  }
+  return 0;
+}
+
+yacl::Buffer makeMessage(const Header& header, size_t payload_size) {
+  yacl::Buffer buf(sizeof(Header) + payload_size);
+  std::memcpy(buf.data<uint8_t>(), &header, sizeof(Header));
+  return buf;
+}
+
+}  // namespace
+
+yacl::Buffer encodeMessage(const void* data, size_t size, size_t word_size) {
+  Header header{};
+  header.size = size;
+
+  const size_t unit = packableWordSize(size, word_size);
+  if (unit != 0) {
+    const size_t count = size / unit;
+    const uint8_t width = DISPATCH_WORD_SIZE(unit, [&]() {
+      return packedWidth(static_cast<U const*>(data), count);
+    });
+    if (width != 0) {
+      header.codec = Codec::Packed;
+      header.width = width;
+      header.word_size = static_cast<uint8_t>(unit);
+      auto buf = makeMessage(header, packedSize(count, width));
+      DISPATCH_WORD_SIZE(unit, [&]() {
+        pack(static_cast<U const*>(data), count, width,
+             buf.data<uint8_t>() + sizeof(Header));
+      });
+      return buf;
+    }
+  }
+
+  if (size >= kMinZstdBytes) {
+    const size_t sample = std::min(size, kZstdSampleBytes);
+    std::vector<uint8_t> out(ZSTD_compressBound(sample));
+    size_t csize = ZSTD_compress(out.data(), out.size(), data, sample, 1);
+    YACL_ENFORCE(!ZSTD_isError(csize), "zstd failed, {}",
+                 ZSTD_getErrorName(csize));
+    if (csize <= kZstdMaxRatio * sample) {
+      if (sample < size) {
+        out.resize(ZSTD_compressBound(size));
+        csize = ZSTD_compress(out.data(), out.size(), data, size, 1);
+        YACL_ENFORCE(!ZSTD_isError(csize), "zstd failed, {}",
+                     ZSTD_getErrorName(csize));
+      }
+      if (csize <= kZstdMaxRatio * size) {
+        header.codec = Codec::Zstd;
+        auto buf = makeMessage(header, csize);
+        std::memcpy(buf.data<uint8_t>() + sizeof(Header), out.data(), csize);
+        return buf;
+      }
+    }
+  }
+
+  header.codec = Codec::Raw;
+  auto buf = makeMessage(header, size);
+  std::memcpy(buf.data<uint8_t>() + sizeof(Header), data, size);
+  return buf;
+}
+
+std::pair<std::shared_ptr<yacl::Buffer>, int64_t> decodeMessage(
+    std::shared_ptr<yacl::Buffer> buf, int64_t offset) {
+  Header header;
+  YACL_ENFORCE(buf->size() >= offset + static_cast<int64_t>(sizeof(Header)),
+               "invalid message of {} bytes", buf->size() - offset);
+  std::memcpy(&header, buf->data<uint8_t>() + offset, sizeof(Header));
+  uint8_t const* payload = buf->data<uint8_t>() + offset + sizeof(Header);
+  const size_t payload_size = buf->size() - offset - sizeof(Header);
+
+  switch (header.codec) {
+    case Codec::Raw: {
+      YACL_ENFORCE(payload_size == header.size);
+      return {std::move(buf), offset + static_cast<int64_t>(sizeof(Header))};
+    }
+    case Codec::Packed: {
+      const size_t count = header.size / header.word_size;
+      YACL_ENFORCE(payload_size == packedSize(count, header.width));
+      auto res = std::make_shared<yacl::Buffer>(header.size);
+      DISPATCH_WORD_SIZE(header.word_size, [&]() {
+        unpack(payload, count, header.width, res->data<U>());
+      });
+      return {std::move(res), 0};
+    }
+    case Codec::Zstd: {
+      auto res = std::make_shared<yacl::Buffer>(header.size);
+      const size_t dsize = ZSTD_decompress(res->data<uint8_t>(), header.size,
+                                           payload, payload_size);
+      YACL_ENFORCE(!ZSTD_isError(dsize) && dsize == header.size,
+                   "zstd failed to decode a message of {} bytes",
+                   header.size);
+      return {std::move(res), 0};
+    }
+    default:
+      YACL_THROW("unknown codec {}", static_cast<int>(header.codec));
+  }
+}
+
+}  // namespace spu::mpc
@@ -0,0 +1,43 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "yacl/base/buffer.h"
+
+namespace spu::mpc {
+
+// Adaptive compression of messages of ring arrays. A message is encoded by
+// the first codec that pays off:
+//  - bit packing, when the high bits of all words are zero, e.g. boolean
+//    shares of a few bits or comparison results.
+//  - zstd level 1, when a sample of the message compresses well.
+//  - otherwise the message is sent as is, e.g. random arithmetic shares,
+//    which are detected by their first words without a full scan.
+//
+// `word_size` is the size in bytes of the words to pack, i.e. the storage
+// size of a ring element.
+yacl::Buffer encodeMessage(const void* data, size_t size, size_t word_size);
+
+// Decode a message of encodeMessage at `offset` of `buf`, return the buffer
+// of the data and its offset in bytes, raw messages are not copied.
+std::pair<std::shared_ptr<yacl::Buffer>, int64_t> decodeMessage(
+    std::shared_ptr<yacl::Buffer> buf, int64_t offset = 0);
+
+}  // namespace spu::mpc
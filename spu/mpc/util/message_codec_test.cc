@@ -0,0 +1,88 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/message_codec.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace spu::mpc {
+namespace {
+
+size_t roundTrip(const void* data, size_t size, size_t word_size) {
+  auto encoded = std::make_shared<yacl::Buffer>(
+      encodeMessage(data, size, word_size));
+  const size_t encoded_size = encoded->size();
+
+  auto [buf, offset] = decodeMessage(std::move(encoded));
+  EXPECT_EQ(buf->size() - offset, static_cast<int64_t>(size));
+  EXPECT_EQ(std::memcmp(buf->data<uint8_t>() + offset, data, size), 0);
+  return encoded_size;
+}
+
+template <typename T>
+size_t roundTrip(const std::vector<T>& words, size_t word_size = sizeof(T)) {
+  return roundTrip(words.data(), words.size() * sizeof(T), word_size);
+}
+
+}  // namespace
+
+TEST(MessageCodecTest, Packed) {
+  std::mt19937_64 rng(0);
+  const size_t kCount = 100003;
+
+  for (size_t bits : {1, 2, 3, 4, 7, 8, 13, 16, 31, 32}) {
+    std::vector<uint64_t> words(kCount);
+    for (auto& word : words) {
+      word = rng() & ((uint64_t(1) << bits) - 1);
+    }
+    const size_t width = bits <= 4 ? (bits == 3 ? 4 : bits)
+                                   : (bits <= 8 ? 8 : (bits <= 16 ? 16 : 32));
+    EXPECT_LE(roundTrip(words), 16 + (kCount * width + 7) / 8) << bits;
+  }
+
+  // words of 128 bits are packed as 64 bits words.
+  std::vector<uint32_t> small(kCount, 1);
+  EXPECT_LE(roundTrip(small, 16), 16 + kCount / 8 + 1);
+}
+
+TEST(MessageCodecTest, Zstd) {
+  // high bits are used, but the pattern repeats.
+  std::vector<uint64_t> words(1 << 16);
+  for (size_t idx = 0; idx < words.size(); idx++) {
+    words[idx] = ~uint64_t(0) - (idx % 7);
+  }
+  EXPECT_LT(roundTrip(words), words.size() * sizeof(uint64_t) / 4);
+}
+
+TEST(MessageCodecTest, Raw) {
+  std::mt19937_64 rng(0);
+  std::vector<uint64_t> words(1 << 16);
+  for (auto& word : words) {
+    word = rng();
+  }
+  EXPECT_EQ(roundTrip(words), 16 + words.size() * sizeof(uint64_t));
+
+  // odd sizes are not packed.
+  std::vector<uint8_t> bytes(5, 0);
+  EXPECT_EQ(roundTrip(bytes), 16 + bytes.size());
+
+  std::vector<uint64_t> empty;
+  roundTrip(empty);
+}
+
+}  // namespace spu::mpc
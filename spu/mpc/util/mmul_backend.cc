@@ -0,0 +1,65 @@
+// Copyright 2021 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/mmul_backend.h"
+
+#include <map>
+#include <mutex>
+
+#include "yacl/base/exception.h"
+
+namespace spu::mpc {
+namespace {
+
+struct MmulBackendRegistry {
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<MmulBackend>> backends;
+  std::shared_ptr<MmulBackend> selected;
+};
+
+MmulBackendRegistry& getRegistry() {
+  static MmulBackendRegistry registry;
+  return registry;
+}
+
+}  // namespace
+
+void registerMmulBackend(const std::string& name,
+                         std::shared_ptr<MmulBackend> backend) {
+  YACL_ENFORCE(!name.empty() && backend != nullptr);
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  registry.backends[name] = std::move(backend);
+}
+
+void setMmulBackend(const std::string& name) {
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  if (name.empty()) {
+    registry.selected = nullptr;
+    return;
+  }
+  auto itr = registry.backends.find(name);
+  YACL_ENFORCE(itr != registry.backends.end(),
+               "mmul backend {} is not registered", name);
+  registry.selected = itr->second;
+}
+
+std::shared_ptr<MmulBackend> getMmulBackend() {
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  return registry.selected;
+}
+
+}  // namespace spu::mpc
@@ -0,0 +1,56 @@
+// Copyright 2021 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "spu/spu.pb.h"
+
+namespace spu::mpc {
+
+// An accelerator of the local products of ring_mmul, e.g. an integer GEMM
+// of wrap-around products on a GPU, with 128 bits by 64 bits limbs.
+//
+// Backends are linked in and registered by name, then selected by
+// RuntimeConfig.experimental_mmul_backend. A backend could keep device copies
+// of operands across calls, e.g. the weights of chained layers, keyed by the
+// host buffers.
+class MmulBackend {
+ public:
+  virtual ~MmulBackend() = default;
+
+  // C := A * B over the ring of `field`, of elements of 4, 8 or 16 bytes by
+  // the field, strides are in elements as linalg::matmul. Return false to
+  // decline, e.g. products too small to pay off the transfers, then the cpu
+  // kernels run instead.
+  virtual bool mmul(FieldType field, int64_t M, int64_t N, int64_t K,
+                    const void* A, int64_t LDA, int64_t IDA, const void* B,
+                    int64_t LDB, int64_t IDB, void* C, int64_t LDC,
+                    int64_t IDC) = 0;
+};
+
+void registerMmulBackend(const std::string& name,
+                         std::shared_ptr<MmulBackend> backend);
+
+// Select a registered backend, empty for the cpu kernels. It applies to the
+// process, like RuntimeConfig.num_threads.
+void setMmulBackend(const std::string& name);
+
+// The selected backend, nullptr for none.
+std::shared_ptr<MmulBackend> getMmulBackend();
+
+}  // namespace spu::mpc
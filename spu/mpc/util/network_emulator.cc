@@ -0,0 +1,66 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/network_emulator.h"
+
+#include <thread>
+
+#include "yacl/base/exception.h"
+
+namespace spu::mpc {
+
+NetworkProfile NetworkProfile::lan() {
+  NetworkProfile profile;
+  profile.rtt = std::chrono::microseconds(100);
+  profile.bandwidth = 10e9 / 8;
+  return profile;
+}
+
+NetworkProfile NetworkProfile::wan() {
+  NetworkProfile profile;
+  profile.rtt = std::chrono::milliseconds(40);
+  profile.bandwidth = 100e6 / 8;
+  profile.jitter = std::chrono::milliseconds(2);
+  return profile;
+}
+
+NetworkEmulator::NetworkEmulator(const NetworkProfile& profile)
+    : profile_(profile), rng_(profile.seed) {
+  YACL_ENFORCE(profile.rtt.count() >= 0 && profile.jitter.count() >= 0 &&
+               profile.bandwidth >= 0);
+}
+
+Duration NetworkEmulator::delay(size_t bytes) {
+  Duration result = profile_.rtt / 2;
+  if (profile_.jitter.count() > 0) {
+    std::uniform_int_distribution<Duration::rep> dist(0,
+                                                      profile_.jitter.count());
+    std::unique_lock lock(mutex_);
+    result += Duration(dist(rng_));
+  }
+  if (profile_.bandwidth > 0) {
+    result += std::chrono::duration_cast<Duration>(
+        std::chrono::duration<double>(bytes / profile_.bandwidth));
+  }
+  return result;
+}
+
+void NetworkEmulator::wait(size_t bytes) {
+  const auto duration = delay(bytes);
+  if (duration.count() > 0) {
+    std::this_thread::sleep_for(duration);
+  }
+}
+
+}  // namespace spu::mpc
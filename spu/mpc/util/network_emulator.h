@@ -0,0 +1,74 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+#include "spu/core/trace.h"
+
+namespace spu::mpc {
+
+// The shape of an emulated network.
+struct NetworkProfile {
+  // round trip time, each message takes half of it.
+  Duration rtt = {};
+
+  // bytes per second of the link of a party, 0 means unlimited.
+  double bandwidth = 0;
+
+  // each message takes an extra delay uniformly drawn in [0, jitter].
+  Duration jitter = {};
+
+  // the seed of jitters, so runs are reproducible.
+  uint64_t seed = 0;
+
+  // 0.1ms rtt, 10Gbps.
+  static NetworkProfile lan();
+
+  // 40ms rtt, 100Mbps, 2ms jitter.
+  static NetworkProfile wan();
+};
+
+// Emulate a network on a fast (i.e. in-memory) link by delaying receivers.
+//
+// A party waits for the one-way latency, the jitter and the transfer time of
+// the received bytes after each receive. Since MPC protocols receive in lock
+// step, every round takes about the latency and the transfer time of the
+// network, but the latency does not overlap with the computation of the
+// receiver, so it is an upper bound of a real network.
+class NetworkEmulator {
+ public:
+  explicit NetworkEmulator(const NetworkProfile& profile);
+
+  const NetworkProfile& profile() const { return profile_; }
+
+  // The delay of receiving `bytes`, draws a jitter.
+  Duration delay(size_t bytes);
+
+  // Sleep for delay(bytes).
+  void wait(size_t bytes);
+
+ private:
+  const NetworkProfile profile_;
+
+  // receives of async workers race with the caller thread.
+  std::mutex mutex_;
+  std::mt19937_64 rng_;
+};
+
+}  // namespace spu::mpc
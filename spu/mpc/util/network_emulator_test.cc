@@ -0,0 +1,51 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/network_emulator.h"
+
+#include "gtest/gtest.h"
+
+namespace spu::mpc {
+
+TEST(NetworkEmulatorTest, Delay) {
+  NetworkProfile profile;
+  profile.rtt = std::chrono::milliseconds(10);
+  profile.bandwidth = 1e6;
+  NetworkEmulator emulator(profile);
+
+  // half rtt, plus 1ms per 1000 bytes.
+  EXPECT_EQ(emulator.delay(0), std::chrono::milliseconds(5));
+  EXPECT_EQ(emulator.delay(1000), std::chrono::milliseconds(6));
+}
+
+TEST(NetworkEmulatorTest, Jitter) {
+  NetworkProfile profile = NetworkProfile::wan();
+  profile.bandwidth = 0;
+  profile.seed = 7;
+  NetworkEmulator lhs(profile);
+  NetworkEmulator rhs(profile);
+
+  bool jittered = false;
+  for (size_t idx = 0; idx < 100; idx++) {
+    const auto delay = lhs.delay(0);
+    // same seed, same jitters.
+    EXPECT_EQ(delay, rhs.delay(0));
+    EXPECT_GE(delay, profile.rtt / 2);
+    EXPECT_LE(delay, profile.rtt / 2 + profile.jitter);
+    jittered |= delay != profile.rtt / 2;
+  }
+  EXPECT_TRUE(jittered);
+}
+
+}  // namespace spu::mpc
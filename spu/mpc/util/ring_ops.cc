@@ -16,8 +16,11 @@
 
 #include "spu/mpc/util/ring_ops.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <random>
+#include <vector>
 
 #define EIGEN_HAS_OPENMP
 #include "Eigen/Core"
@@ -28,6 +31,8 @@
 
 #include "spu/core/array_ref.h"
 #include "spu/mpc/util/linalg.h"
+#include "spu/mpc/util/mmul_backend.h"
+#include "spu/mpc/util/ring_simd.h"
 
 // TODO: ArrayRef is simple enough, consider using other SIMD libraries.
 namespace spu::mpc {
@@ -35,6 +40,9 @@ namespace {
 
 constexpr char kModule[] = "RingOps";
 
+// The least inner dimension of a matmul per thread when it is split along K.
+constexpr int64_t kSplitKGrainSize = 4096;
+
 #define YACL_ENFORCE_RING(x)                                         \
   YACL_ENFORCE(x.eltype().isa<Ring2k>(), "expect ring type, got={}", \
                x.eltype());
@@ -69,19 +77,50 @@ constexpr char kModule[] = "RingOps";
     });                                                                   \
   }
 
+// Vectorized kernels only handle the compact layout, others go through the
+// generic strided loops.
+bool isCompact(const ArrayRef& x) { return x.stride() == 1; }
+
+#define DEF_BINARY_RING_OP_SIMD(NAME, OP, FNAME)                          \
+  void NAME##_impl(ArrayRef& ret, const ArrayRef& x, const ArrayRef& y) { \
+    ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, x);                                  \
+    ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, y);                                  \
+    const auto field = x.eltype().as<Ring2k>()->field();                  \
+    const int64_t numel = ret.numel();                                    \
+    if (isCompact(ret) && isCompact(x) && isCompact(y) &&                 \
+        simd::binary(OP, SizeOf(field), x.data(), y.data(), ret.data(),   \
+                     numel)) {                                            \
+      return;                                                             \
+    }                                                                     \
+    return DISPATCH_ALL_FIELDS(field, kModule, [&]() {                    \
+      FNAME(numel, &x.at<ring2k_t>(0), x.stride(), &y.at<ring2k_t>(0),    \
+            y.stride(), &ret.at<ring2k_t>(0), ret.stride());              \
+    });                                                                   \
+  }
+
+bool trySimdShift(simd::ShiftOp op, ArrayRef& ret, const ArrayRef& x,
+                  size_t bits) {
+  return isCompact(ret) && isCompact(x) &&
+         simd::shift(op, ret.elsize(), x.data(), ret.data(), ret.numel(),
+                     bits);
+}
+
 DEF_UNARY_RING_OP_EIGEN(ring_not, linalg::bitwise_not);
 DEF_UNARY_RING_OP_EIGEN(ring_neg, linalg::negate);
 
-DEF_BINARY_RING_OP_EIGEN(ring_add, linalg::add)
-DEF_BINARY_RING_OP_EIGEN(ring_sub, linalg::sub)
-DEF_BINARY_RING_OP_EIGEN(ring_mul, linalg::mul)
+DEF_BINARY_RING_OP_SIMD(ring_add, simd::BinaryOp::Add, linalg::add)
+DEF_BINARY_RING_OP_SIMD(ring_sub, simd::BinaryOp::Sub, linalg::sub)
+DEF_BINARY_RING_OP_SIMD(ring_mul, simd::BinaryOp::Mul, linalg::mul)
 DEF_BINARY_RING_OP_EIGEN(ring_equal, linalg::equal)
 
-DEF_BINARY_RING_OP_EIGEN(ring_and, linalg::bitwise_and);
-DEF_BINARY_RING_OP_EIGEN(ring_xor, linalg::bitwise_xor);
+DEF_BINARY_RING_OP_SIMD(ring_and, simd::BinaryOp::And, linalg::bitwise_and);
+DEF_BINARY_RING_OP_SIMD(ring_xor, simd::BinaryOp::Xor, linalg::bitwise_xor);
 
 void ring_arshift_impl(ArrayRef& ret, const ArrayRef& x, size_t bits) {
   ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, x);
+  if (trySimdShift(simd::ShiftOp::ARShift, ret, x, bits)) {
+    return;
+  }
   const auto numel = ret.numel();
   const auto field = x.eltype().as<Ring2k>()->field();
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
@@ -96,6 +135,9 @@ void ring_arshift_impl(ArrayRef& ret, const ArrayRef& x, size_t bits) {
 
 void ring_rshift_impl(ArrayRef& ret, const ArrayRef& x, size_t bits) {
   ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, x);
+  if (trySimdShift(simd::ShiftOp::RShift, ret, x, bits)) {
+    return;
+  }
   const auto numel = ret.numel();
   const auto field = x.eltype().as<Ring2k>()->field();
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
@@ -108,6 +150,9 @@ void ring_rshift_impl(ArrayRef& ret, const ArrayRef& x, size_t bits) {
 
 void ring_lshift_impl(ArrayRef& ret, const ArrayRef& x, size_t bits) {
   ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, x);
+  if (trySimdShift(simd::ShiftOp::LShift, ret, x, bits)) {
+    return;
+  }
   const auto numel = ret.numel();
   const auto field = x.eltype().as<Ring2k>()->field();
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
@@ -164,6 +209,71 @@ void ring_bitmask_impl(ArrayRef& ret, const ArrayRef& x, size_t low,
   });
 }
 
+void ring_linear_combination_impl(ArrayRef& ret,
+                                  absl::Span<RingTerm const> terms) {
+  YACL_ENFORCE(!terms.empty(), "expected non empty terms");
+  YACL_ENFORCE_RING(ret);
+  for (const auto& term : terms) {
+    ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, term.x);
+    if (term.y.has_value()) {
+      ENFORCE_EQ_ELSIZE_AND_NUMEL(ret, (*term.y));
+    }
+  }
+
+  const auto field = ret.eltype().as<Ring2k>()->field();
+  const int64_t numel = ret.numel();
+  return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
+    using U = ring2k_t;
+
+    // Accumulate a small block of outputs in L1 term by term, so every input
+    // and output is touched exactly once, and the per term loops are still
+    // simple enough to be vectorized. `ret` may alias the terms, since a
+    // block is written after all terms of it are read.
+    constexpr int64_t kBlockSize = 256;
+    pfor(0, numel, [&](int64_t begin, int64_t end) {
+      std::array<U, kBlockSize> acc;
+      for (int64_t base = begin; base < end; base += kBlockSize) {
+        const int64_t n = std::min(kBlockSize, end - base);
+        std::fill_n(acc.begin(), n, U(0));
+
+        for (const auto& term : terms) {
+          const U* x = &term.x.at<U>(base);
+          const int64_t sx = term.x.stride();
+          if (term.y.has_value()) {
+            const U* y = &term.y->at<U>(base);
+            const int64_t sy = term.y->stride();
+            if (term.negative) {
+              for (int64_t idx = 0; idx < n; idx++) {
+                acc[idx] -= x[idx * sx] * y[idx * sy];
+              }
+            } else {
+              for (int64_t idx = 0; idx < n; idx++) {
+                acc[idx] += x[idx * sx] * y[idx * sy];
+              }
+            }
+          } else {
+            if (term.negative) {
+              for (int64_t idx = 0; idx < n; idx++) {
+                acc[idx] -= x[idx * sx];
+              }
+            } else {
+              for (int64_t idx = 0; idx < n; idx++) {
+                acc[idx] += x[idx * sx];
+              }
+            }
+          }
+        }
+
+        U* out = &ret.at<U>(base);
+        const int64_t so = ret.stride();
+        for (int64_t idx = 0; idx < n; idx++) {
+          out[idx * so] = acc[idx];
+        }
+      }
+    });
+  });
+}
+
 }  // namespace
 
 // debug only
@@ -200,11 +310,27 @@ ArrayRef ring_rand(FieldType field, size_t size, uint128_t prg_seed,
   constexpr yacl::SymmetricCrypto::CryptoType kCryptoType =
       yacl::SymmetricCrypto::CryptoType::AES128_CTR;
   constexpr uint128_t kAesInitialVector = 0U;
+  // Fixed chunks, so the output does not depend on the number of threads.
+  constexpr size_t kChunkBlocks = 1 << 16;
+  constexpr size_t kChunkBytes = kChunkBlocks * sizeof(uint128_t);
 
   ArrayRef res(makeType<RingTy>(field), size);
-  *prg_counter = yacl::FillPseudoRandom(
-      kCryptoType, prg_seed, kAesInitialVector, *prg_counter,
-      absl::MakeSpan(static_cast<char*>(res.data()), res.buf()->size()));
+  auto* data = static_cast<char*>(res.data());
+  const size_t nbytes = res.buf()->size();
+  const uint64_t counter = *prg_counter;
+
+  // every chunk is filled at its own counter, as consecutive calls do.
+  const size_t num_chunks = (nbytes + kChunkBytes - 1) / kChunkBytes;
+  yacl::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; ++chunk) {
+      const size_t offset = chunk * kChunkBytes;
+      const size_t len = std::min(kChunkBytes, nbytes - offset);
+      yacl::FillPseudoRandom(kCryptoType, prg_seed, kAesInitialVector,
+                             counter + chunk * kChunkBlocks,
+                             absl::MakeSpan(data + offset, len));
+    }
+  });
+  *prg_counter = counter + (nbytes + sizeof(uint128_t) - 1) / sizeof(uint128_t);
 
   return res;
 }
@@ -263,6 +389,14 @@ ArrayRef ring_zeros_packed(FieldType field, size_t size) {
   });
 }
 
+ArrayRef ring_constant_packed(FieldType field, size_t size, uint128_t value) {
+  return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
+    ArrayRef ret = makeConstantArrayRef(makeType<RingTy>(field), size);
+    ret.at<ring2k_t>(0) = static_cast<ring2k_t>(value);
+    return ret;
+  });
+}
+
 ArrayRef ring_ones(FieldType field, size_t size) {
   return DISPATCH_ALL_FIELDS(field, kModule, [&]() {
     ArrayRef ret(makeType<RingTy>(field), size);
@@ -348,13 +482,51 @@ void ring_mmul_(ArrayRef& z, const ArrayRef& lhs, const ArrayRef& rhs, size_t M,
     const auto& ret_strides = z.stride();
     const auto ret_stride_scale = z.elsize() / sizeof(ring2k_t);
 
-    linalg::matmul(
-        M, N, K, static_cast<const ring2k_t*>(lhs.data()),
-        lhs_stride_scale * K * lhs_strides, lhs_stride_scale * lhs_strides,
-        static_cast<const ring2k_t*>(rhs.data()),
-        rhs_stride_scale * N * rhs_strides, rhs_stride_scale * rhs_strides,
-        static_cast<ring2k_t*>(z.data()), ret_stride_scale * N * ret_strides,
-        ret_stride_scale * ret_strides);
+    const auto* A = static_cast<const ring2k_t*>(lhs.data());
+    const int64_t LDA = lhs_stride_scale * K * lhs_strides;
+    const int64_t IDA = lhs_stride_scale * lhs_strides;
+    const auto* B = static_cast<const ring2k_t*>(rhs.data());
+    const int64_t LDB = rhs_stride_scale * N * rhs_strides;
+    const int64_t IDB = rhs_stride_scale * rhs_strides;
+    auto* C = static_cast<ring2k_t*>(z.data());
+    const int64_t LDC = ret_stride_scale * N * ret_strides;
+    const int64_t IDC = ret_stride_scale * ret_strides;
+
+    if (auto backend = getMmulBackend();
+        backend != nullptr && backend->mmul(field, M, N, K, A, LDA, IDA, B, LDB,
+                                            IDB, C, LDC, IDC)) {
+      return;
+    }
+
+    // a small output of a long inner dimension, e.g. a dot product, leaves
+    // threads idle, so K is split over threads and the partial products are
+    // summed after all.
+    const int64_t MN = M * N;
+    const int64_t splits =
+        std::min<int64_t>(getNumberOfProc(), K / kSplitKGrainSize);
+    if (splits > 1 && MN < kMinTaskSize) {
+      std::vector<ring2k_t> partials(splits * MN);
+      yacl::parallel_for(0, splits, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t idx = begin; idx < end; idx++) {
+          const int64_t k0 = K * idx / splits;
+          const int64_t k1 = K * (idx + 1) / splits;
+          linalg::matmul(M, N, k1 - k0, A + k0 * IDA, LDA, IDA, B + k0 * LDB,
+                         LDB, IDB, &partials[idx * MN], N, 1);
+        }
+      });
+      for (int64_t i = 0; i < static_cast<int64_t>(M); i++) {
+        for (int64_t j = 0; j < static_cast<int64_t>(N); j++) {
+          ring2k_t sum = 0;
+          for (int64_t idx = 0; idx < splits; idx++) {
+            sum += partials[idx * MN + i * N + j];
+          }
+          C[i * LDC + j * IDC] = sum;
+        }
+      }
+      return;
+    }
+
+    linalg::matmul(M, N, K, A, LDA, IDA, B, LDB, IDB, C, LDC, IDC);
   });
 }
 
@@ -433,6 +605,28 @@ void ring_bitmask_(ArrayRef& x, size_t low, size_t high) {
   ring_bitmask_impl(x, x, low, high);
 }
 
+ArrayRef ring_fma(const ArrayRef& x, const ArrayRef& y, const ArrayRef& z) {
+  return ring_linear_combination({{x, y}, {z}});
+}
+
+void ring_fma_(ArrayRef& z, const ArrayRef& x, const ArrayRef& y) {
+  ring_linear_combination_impl(z, {{z}, {x, y}});
+}
+
+ArrayRef ring_linear_combination(absl::Span<RingTerm const> terms) {
+  YACL_ENFORCE(!terms.empty(), "expected non empty terms");
+  YACL_ENFORCE_RING(terms[0].x);
+
+  const auto field = terms[0].x.eltype().as<Ring2k>()->field();
+  ArrayRef ret(makeType<RingTy>(field), terms[0].x.numel());
+  ring_linear_combination_impl(ret, terms);
+  return ret;
+}
+
+void ring_linear_combination_(ArrayRef& ret, absl::Span<RingTerm const> terms) {
+  ring_linear_combination_impl(ret, terms);
+}
+
 ArrayRef ring_sum(absl::Span<ArrayRef const> arrs) {
   YACL_ENFORCE(!arrs.empty(), "expected non empty, got size={}", arrs.size());
 
@@ -440,12 +634,12 @@ ArrayRef ring_sum(absl::Span<ArrayRef const> arrs) {
     return arrs[0];
   }
 
-  YACL_ENFORCE(arrs.size() >= 2);
-  auto res = ring_add(arrs[0], arrs[1]);
-  for (size_t idx = 2; idx < arrs.size(); idx++) {
-    ring_add_(res, arrs[idx]);
+  std::vector<RingTerm> terms;
+  terms.reserve(arrs.size());
+  for (const auto& arr : arrs) {
+    terms.push_back({arr});
   }
-  return res;
+  return ring_linear_combination(terms);
 }
 
 bool ring_all_equal(const ArrayRef& x, const ArrayRef& y, size_t abs_err) {
@@ -495,6 +689,30 @@ std::vector<uint8_t> ring_cast_boolean(const ArrayRef& x) {
   return res;
 }
 
+ArrayRef ring_cast(const ArrayRef& x, FieldType to_field) {
+  YACL_ENFORCE_RING(x);
+  const auto field = x.eltype().as<Ring2k>()->field();
+
+  ArrayRef res(makeType<RingTy>(to_field), x.numel());
+  DISPATCH_ALL_FIELDS(field, kModule, [&]() {
+    using S = ring2k_t;
+    const S* src = &x.at<S>(0);
+    const auto stride = x.stride();
+    DISPATCH_ALL_FIELDS(to_field, kModule, [&]() {
+      using T = ring2k_t;
+      T* dst = &res.at<T>(0);
+      yacl::parallel_for(0, x.numel(), PFOR_GRAIN_SIZE,
+                         [&](int64_t start, int64_t end) {
+                           for (int64_t i = start; i < end; i++) {
+                             dst[i] = static_cast<T>(src[i * stride]);
+                           }
+                         });
+    });
+  });
+
+  return res;
+}
+
 ArrayRef ring_select(const std::vector<uint8_t>& c, const ArrayRef& x,
                      const ArrayRef& y) {
   ENFORCE_EQ_ELSIZE_AND_NUMEL(x, y);
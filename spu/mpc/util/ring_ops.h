@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "spu/core/array_ref.h"
 #include "spu/core/type.h"
 
@@ -30,6 +32,10 @@ ArrayRef ring_rand_range(FieldType field, size_t size, int32_t min,
 ArrayRef ring_zeros(FieldType field, size_t size);
 ArrayRef ring_zeros_packed(FieldType field, size_t size);
 
+// A stride 0 array of `size` elements all of `value`, the storage of a
+// single element, e.g. a public scalar operand of the ring ops.
+ArrayRef ring_constant_packed(FieldType field, size_t size, uint128_t value);
+
 ArrayRef ring_ones(FieldType field, size_t size);
 
 ArrayRef ring_randbit(FieldType field, size_t size);
@@ -49,6 +55,24 @@ void ring_sub_(ArrayRef& x, const ArrayRef& y);
 ArrayRef ring_mul(const ArrayRef& x, const ArrayRef& y);
 void ring_mul_(ArrayRef& x, const ArrayRef& y);
 
+// fused multiply-add, ret = x * y + z.
+ArrayRef ring_fma(const ArrayRef& x, const ArrayRef& y, const ArrayRef& z);
+// z += x * y
+void ring_fma_(ArrayRef& z, const ArrayRef& x, const ArrayRef& y);
+
+// A term of `ring_linear_combination`, `x * y`, or `x` if `y` is empty.
+struct RingTerm {
+  ArrayRef x;
+  std::optional<ArrayRef> y = std::nullopt;
+  bool negative = false;
+};
+
+// ret = sum(terms), evaluated in a single pass over inputs without
+// materializing any intermediate array.
+ArrayRef ring_linear_combination(absl::Span<RingTerm const> terms);
+// the in-place version, `ret` could be one of the terms.
+void ring_linear_combination_(ArrayRef& ret, absl::Span<RingTerm const> terms);
+
 ArrayRef ring_mmul(const ArrayRef& x, const ArrayRef& y, size_t M, size_t N,
                    size_t K);
 
@@ -87,6 +111,10 @@ bool ring_all_equal(const ArrayRef& x, const ArrayRef& y, size_t abs_err = 0);
 // boolean will participate in arithmetic computation in the future.
 std::vector<uint8_t> ring_cast_boolean(const ArrayRef& x);
 
+// Reinterpret ring elements in another field, the high bits are dropped when
+// narrowing and zero-extended when widening.
+ArrayRef ring_cast(const ArrayRef& x, FieldType to_field);
+
 // x & bits[low, high)
 ArrayRef ring_bitmask(const ArrayRef& x, size_t low, size_t high);
 void ring_bitmask_(ArrayRef& x, size_t low, size_t high);
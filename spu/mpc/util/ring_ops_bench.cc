@@ -18,6 +18,7 @@
 #include "benchmark/benchmark.h"
 
 #include "spu/mpc/util/ring_ops.h"
+#include "spu/mpc/util/ring_simd.h"
 
 namespace spu::mpc::util {
 
@@ -37,6 +38,13 @@ static void makeUnaryArgs(benchmark::internal::Benchmark* b) {
   });
 }
 
+// bytes read and written by one element-wise call.
+static void setBytesProcessed(benchmark::State& state, FieldType field,
+                              int64_t numel, int64_t num_arrays) {
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * numel *
+                          num_arrays * SizeOf(field));
+}
+
 static void BM_RingAdd(benchmark::State& state) {
   const int64_t numel = state.range(0);
   const int64_t stride = state.range(1);
@@ -48,6 +56,7 @@ static void BM_RingAdd(benchmark::State& state) {
   for (auto _ : state) {
     ring_add(x, y);
   }
+  setBytesProcessed(state, field, numel, 3);
 }
 
 static void BM_RingAdd_(benchmark::State& state) {
@@ -61,11 +70,181 @@ static void BM_RingAdd_(benchmark::State& state) {
   for (auto _ : state) {
     ring_add_(x, y);
   }
+  setBytesProcessed(state, field, numel, 3);
 }
 
 BENCHMARK(BM_RingAdd)->Apply(makeUnaryArgs);
 BENCHMARK(BM_RingAdd_)->Apply(makeUnaryArgs);
 
+// Ops of the generic kernels, which are specialized on the compact layout.
+template <ArrayRef (*kOp)(const ArrayRef&)>
+static void BM_RingUnary(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const int64_t stride = state.range(1);
+  const FieldType field = spu::FieldType(state.range(2));
+
+  const ArrayRef x = makeRandomArray(field, numel, stride);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(x));
+  }
+  setBytesProcessed(state, field, numel, 2);
+}
+
+static void BM_RingEqual(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const int64_t stride = state.range(1);
+  const FieldType field = spu::FieldType(state.range(2));
+
+  const ArrayRef x = makeRandomArray(field, numel, stride);
+  const ArrayRef y = makeRandomArray(field, numel, stride);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ring_equal(x, y));
+  }
+  setBytesProcessed(state, field, numel, 3);
+}
+
+BENCHMARK_TEMPLATE(BM_RingUnary, ring_neg)->Apply(makeUnaryArgs);
+BENCHMARK_TEMPLATE(BM_RingUnary, ring_not)->Apply(makeUnaryArgs);
+BENCHMARK(BM_RingEqual)->Apply(makeUnaryArgs);
+
+// Throughput of compact element-wise ops per instruction set, the reported
+// bytes_per_second counts all inputs and outputs.
+static void makeSimdArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({
+      {1 << 12, 1 << 20},   // numel
+      {FM32, FM64, FM128},  // field
+      {static_cast<int64_t>(simd::Isa::Scalar),
+       static_cast<int64_t>(simd::Isa::Avx2),
+       static_cast<int64_t>(simd::Isa::Avx512)},  // isa
+  });
+}
+
+static bool setupIsa(benchmark::State& state, int64_t isa) {
+  if (isa > static_cast<int64_t>(simd::detectIsa())) {
+    state.SkipWithError("isa not supported by this cpu");
+    return false;
+  }
+  simd::setIsa(static_cast<simd::Isa>(isa));
+  state.SetLabel(std::string(simd::IsaName(simd::getIsa())));
+  return true;
+}
+
+template <ArrayRef (*kOp)(const ArrayRef&, const ArrayRef&)>
+static void BM_RingBinary(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const FieldType field = spu::FieldType(state.range(1));
+  if (!setupIsa(state, state.range(2))) {
+    return;
+  }
+
+  const ArrayRef x = makeRandomArray(field, numel, 1);
+  const ArrayRef y = makeRandomArray(field, numel, 1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(x, y));
+  }
+  setBytesProcessed(state, field, numel, 3);
+  simd::setIsa(simd::detectIsa());
+}
+
+template <ArrayRef (*kOp)(const ArrayRef&, size_t)>
+static void BM_RingShift(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const FieldType field = spu::FieldType(state.range(1));
+  if (!setupIsa(state, state.range(2))) {
+    return;
+  }
+
+  const ArrayRef x = makeRandomArray(field, numel, 1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(x, 13));
+  }
+  setBytesProcessed(state, field, numel, 2);
+  simd::setIsa(simd::detectIsa());
+}
+
+BENCHMARK_TEMPLATE(BM_RingBinary, ring_add)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingBinary, ring_sub)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingBinary, ring_mul)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingBinary, ring_and)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingBinary, ring_xor)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingShift, ring_arshift)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingShift, ring_rshift)->Apply(makeSimdArgs);
+BENCHMARK_TEMPLATE(BM_RingShift, ring_lshift)->Apply(makeSimdArgs);
+
+// c + x * b + y * a + x * y, composed by temporaries vs. fused.
+static void makeFusedArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({
+      {1 << 12, 1 << 20},   // numel
+      {FM32, FM64, FM128},  // field
+  });
+}
+
+static void BM_RingMulOpenedComposed(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const FieldType field = spu::FieldType(state.range(1));
+
+  const ArrayRef x = makeRandomArray(field, numel, 1);
+  const ArrayRef y = makeRandomArray(field, numel, 1);
+  const ArrayRef a = makeRandomArray(field, numel, 1);
+  const ArrayRef b = makeRandomArray(field, numel, 1);
+  const ArrayRef c = makeRandomArray(field, numel, 1);
+
+  for (auto _ : state) {
+    auto z = ring_add(ring_add(ring_mul(x, b), ring_mul(y, a)), c);
+    ring_add_(z, ring_mul(x, y));
+    benchmark::DoNotOptimize(z);
+  }
+  setBytesProcessed(state, field, numel, 6);
+}
+
+static void BM_RingMulOpenedFused(benchmark::State& state) {
+  const int64_t numel = state.range(0);
+  const FieldType field = spu::FieldType(state.range(1));
+
+  const ArrayRef x = makeRandomArray(field, numel, 1);
+  const ArrayRef y = makeRandomArray(field, numel, 1);
+  const ArrayRef a = makeRandomArray(field, numel, 1);
+  const ArrayRef b = makeRandomArray(field, numel, 1);
+  const ArrayRef c = makeRandomArray(field, numel, 1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ring_linear_combination({{c}, {x, b}, {y, a}, {x, y}}));
+  }
+  setBytesProcessed(state, field, numel, 6);
+}
+
+BENCHMARK(BM_RingMulOpenedComposed)->Apply(makeFusedArgs);
+BENCHMARK(BM_RingMulOpenedFused)->Apply(makeFusedArgs);
+
+// Square matmuls, the reported items_per_second counts multiply-adds.
+static void makeMmulArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({
+      {64, 256, 1024},      // M = N = K
+      {FM32, FM64, FM128},  // field
+  });
+}
+
+static void BM_RingMmul(benchmark::State& state) {
+  const int64_t n = state.range(0);
+  const FieldType field = spu::FieldType(state.range(1));
+
+  const ArrayRef x = makeRandomArray(field, n * n, 1);
+  const ArrayRef y = makeRandomArray(field, n * n, 1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ring_mmul(x, y, n, n, n));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * n * n *
+                          n);
+}
+
+BENCHMARK(BM_RingMmul)->Apply(makeMmulArgs)->Unit(benchmark::kMillisecond);
+
 }  // namespace spu::mpc::util
 
 BENCHMARK_MAIN();
@@ -14,10 +14,16 @@
 
 #include "spu/mpc/util/ring_ops.h"
 
+#include <algorithm>
+#include <cstring>
 #include <random>
 
 #include "gtest/gtest.h"
 
+#include "spu/core/ndarray_ref.h"
+#include "spu/core/parallel_utils.h"
+#include "spu/mpc/util/mmul_backend.h"
+
 namespace spu::mpc {
 
 class RingArrayRefTest
@@ -238,4 +244,209 @@ TEST_P(RingArrayRefTest, RingBitMask) {
   }
 }
 
+TEST_P(RingArrayRefTest, LinearCombination) {
+  const FieldType field = std::get<0>(GetParam());
+  const int64_t numel = std::get<1>(GetParam());
+  const int64_t stride_x = std::get<2>(GetParam());
+  const int64_t stride_y = std::get<3>(GetParam());
+
+  {
+    // GIVEN
+    const ArrayRef x = makeRandomArray(field, numel, stride_x);
+    const ArrayRef y = makeRandomArray(field, numel, stride_y);
+    const ArrayRef z = makeRandomArray(field, numel, stride_x);
+    const ArrayRef w = makeRandomArray(field, numel, stride_y);
+
+    // WHEN
+    auto r = ring_linear_combination(
+        {{z}, {x, y}, {y, z, true}, {x, w}, {w, std::nullopt, true}});
+
+    // THEN
+    auto expected = ring_add(z, ring_mul(x, y));
+    ring_sub_(expected, ring_mul(y, z));
+    ring_add_(expected, ring_mul(x, w));
+    ring_sub_(expected, w);
+    EXPECT_TRUE(ring_all_equal(r, expected));
+  }
+
+  {
+    // GIVEN
+    const ArrayRef x = makeRandomArray(field, numel, stride_x);
+    const ArrayRef y = makeRandomArray(field, numel, stride_y);
+    ArrayRef z = makeRandomArray(field, numel, stride_x);
+    auto zbuf = z.buf();
+    const ArrayRef expected = ring_add(ring_mul(x, y), z);
+
+    // THEN
+    EXPECT_TRUE(ring_all_equal(ring_fma(x, y, z), expected));
+
+    ring_fma_(z, x, y);
+    EXPECT_EQ(z.buf(), zbuf);
+    EXPECT_TRUE(ring_all_equal(z, expected));
+  }
+}
+
+TEST_P(RingArrayRefTest, Cast) {
+  const FieldType field = std::get<0>(GetParam());
+  const int64_t numel = std::get<1>(GetParam());
+  const int64_t stride = std::get<2>(GetParam());
+  const size_t k = SizeOf(field) * 8;
+
+  // GIVEN
+  const ArrayRef x = makeRandomArray(field, numel, stride);
+
+  for (auto to_field : {FM32, FM64, FM128}) {
+    const size_t bits = std::min(k, SizeOf(to_field) * 8);
+
+    // WHEN
+    auto y = ring_cast(x, to_field);
+
+    // THEN
+    EXPECT_EQ(y.eltype().as<Ring2k>()->field(), to_field);
+    // the low bits are kept, the rest are zeros.
+    EXPECT_TRUE(ring_all_equal(ring_cast(y, field), ring_bitmask(x, 0, bits)));
+  }
+}
+
+TEST_P(RingArrayRefTest, BroadcastScalar) {
+  const FieldType field = std::get<0>(GetParam());
+  const int64_t numel = std::get<1>(GetParam());
+  const int64_t stride = std::get<2>(GetParam());
+
+  // GIVEN
+  const ArrayRef x = makeRandomArray(field, numel, stride);
+  const ArrayRef c = ring_constant_packed(field, numel, 5);
+  const ArrayRef full = ring_add(ring_ones(field, numel),
+                                 ring_lshift(ring_ones(field, numel), 2));
+  EXPECT_EQ(c.stride(), 0);
+  EXPECT_TRUE(ring_all_equal(c, full));
+
+  // THEN stride 0 operands on either side are the same as expanded ones.
+  EXPECT_TRUE(ring_all_equal(ring_add(x, c), ring_add(x, full)));
+  EXPECT_TRUE(ring_all_equal(ring_sub(c, x), ring_sub(full, x)));
+  EXPECT_TRUE(ring_all_equal(ring_mul(c, c), ring_mul(full, full)));
+  EXPECT_TRUE(ring_all_equal(ring_xor(x, c), ring_xor(x, full)));
+  EXPECT_TRUE(ring_all_equal(ring_not(c), ring_not(full)));
+  EXPECT_TRUE(ring_all_equal(ring_lshift(c, 3), ring_lshift(full, 3)));
+  EXPECT_TRUE(ring_all_equal(ring_equal(x, ring_zeros_packed(field, numel)),
+                             ring_equal(x, ring_zeros(field, numel))));
+
+  // unflatten keeps the stride.
+  auto nd = unflatten(c, {numel});
+  EXPECT_EQ(nd.strides()[0], 0);
+}
+
+TEST(RingOpsTest, MmulSplitK) {
+  // a small output of a long inner dimension is split over 4 threads.
+  setNumberOfProc(4);
+  const size_t M = 2;
+  const size_t N = 3;
+  const size_t K = 4 * 4096 + 5;
+
+  for (auto field : {FM32, FM64, FM128}) {
+    const ArrayRef x = makeRandomArray(field, M * K, 1);
+    const ArrayRef y = makeRandomArray(field, K * N, 1);
+
+    auto z = ring_mmul(x, y, M, N, K);
+
+    DISPATCH_ALL_FIELDS(field, "_", [&]() {
+      for (size_t i = 0; i < M; i++) {
+        for (size_t j = 0; j < N; j++) {
+          ring2k_t expected = 0;
+          for (size_t k = 0; k < K; k++) {
+            expected += x.at<ring2k_t>(i * K + k) * y.at<ring2k_t>(k * N + j);
+          }
+          EXPECT_EQ(z.at<ring2k_t>(i * N + j), expected);
+        }
+      }
+    });
+  }
+  setNumberOfProc(0);
+}
+
+namespace {
+
+// Takes FM64 products only, as the naive sum of products plus one.
+class FakeMmulBackend : public MmulBackend {
+ public:
+  size_t calls = 0;
+
+  bool mmul(FieldType field, int64_t M, int64_t N, int64_t K, const void* A,
+            int64_t LDA, int64_t IDA, const void* B, int64_t LDB, int64_t IDB,
+            void* C, int64_t LDC, int64_t IDC) override {
+    if (field != FM64) {
+      return false;
+    }
+    calls++;
+    const auto* a = static_cast<const uint64_t*>(A);
+    const auto* b = static_cast<const uint64_t*>(B);
+    auto* c = static_cast<uint64_t*>(C);
+    for (int64_t i = 0; i < M; i++) {
+      for (int64_t j = 0; j < N; j++) {
+        uint64_t sum = 1;
+        for (int64_t k = 0; k < K; k++) {
+          sum += a[i * LDA + k * IDA] * b[k * LDB + j * IDB];
+        }
+        c[i * LDC + j * IDC] = sum;
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST(RingOpsTest, MmulBackend) {
+  auto backend = std::make_shared<FakeMmulBackend>();
+  registerMmulBackend("fake", backend);
+  EXPECT_THROW(setMmulBackend("unknown"), yacl::EnforceNotMet);
+  setMmulBackend("fake");
+
+  const size_t M = 3;
+  const size_t N = 4;
+  const size_t K = 5;
+  for (auto field : {FM32, FM64, FM128}) {
+    const ArrayRef x = makeRandomArray(field, M * K, 1);
+    const ArrayRef y = makeRandomArray(field, K * N, 1);
+
+    auto z = ring_mmul(x, y, M, N, K);
+
+    // the backend declines other fields, which run on the cpu kernels.
+    DISPATCH_ALL_FIELDS(field, "_", [&]() {
+      for (size_t i = 0; i < M; i++) {
+        for (size_t j = 0; j < N; j++) {
+          ring2k_t expected = field == FM64 ? 1 : 0;
+          for (size_t k = 0; k < K; k++) {
+            expected += x.at<ring2k_t>(i * K + k) * y.at<ring2k_t>(k * N + j);
+          }
+          EXPECT_EQ(z.at<ring2k_t>(i * N + j), expected);
+        }
+      }
+    });
+  }
+  EXPECT_EQ(backend->calls, 1U);
+
+  setMmulBackend("");
+  EXPECT_EQ(getMmulBackend(), nullptr);
+}
+
+TEST(RingOpsTest, RandChunks) {
+  // 3 chunks of the prg plus a partial block in FM64.
+  const size_t numel = (3 << 17) + 1;
+  const uint128_t seed = 0x1234;
+
+  uint64_t counter = 5;
+  auto x = ring_rand(FM64, numel, seed, &counter);
+  EXPECT_EQ(counter, 5 + (numel * 8 + 15) / 16);
+
+  // same as consecutive calls.
+  uint64_t counter2 = 5;
+  auto lo = ring_rand(FM64, 1 << 17, seed, &counter2);
+  auto hi = ring_rand(FM64, numel - (1 << 17), seed, &counter2);
+  EXPECT_EQ(counter2, counter);
+  EXPECT_EQ(std::memcmp(x.data(), lo.data(), lo.buf()->size()), 0);
+  EXPECT_EQ(std::memcmp(&x.at<uint64_t>(1 << 17), hi.data(), hi.buf()->size()),
+            0);
+}
+
 }  // namespace spu::mpc
@@ -0,0 +1,134 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/ring_simd.h"
+
+#include <atomic>
+
+#include "yacl/base/exception.h"
+
+#include "spu/core/parallel_utils.h"
+#include "spu/mpc/util/ring_simd_kernels.h"
+
+#ifdef __x86_64__
+#include "cpu_features/cpuinfo_x86.h"
+#endif
+
+namespace spu::mpc::simd {
+namespace {
+
+std::atomic<Isa>& currentIsa() {
+  static std::atomic<Isa> isa(detectIsa());
+  return isa;
+}
+
+BinaryFn getBinaryFn(Isa isa, BinaryOp op, size_t elsize) {
+  switch (isa) {
+#ifdef __x86_64__
+    case Isa::Avx512:
+      return avx512::getBinaryFn(op, elsize);
+    case Isa::Avx2:
+      return avx2::getBinaryFn(op, elsize);
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+ShiftFn getShiftFn(Isa isa, ShiftOp op, size_t elsize) {
+  switch (isa) {
+#ifdef __x86_64__
+    case Isa::Avx512:
+      return avx512::getShiftFn(op, elsize);
+    case Isa::Avx2:
+      return avx2::getShiftFn(op, elsize);
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+std::string_view IsaName(Isa isa) {
+  switch (isa) {
+    case Isa::Scalar:
+      return "scalar";
+    case Isa::Avx2:
+      return "avx2";
+    case Isa::Avx512:
+      return "avx512";
+  }
+  YACL_THROW("unknown isa {}", static_cast<int>(isa));
+}
+
+Isa detectIsa() {
+#ifdef __x86_64__
+  static const auto kCpuFeatures = cpu_features::GetX86Info().features;
+  if (kCpuFeatures.avx512f && kCpuFeatures.avx512dq) {
+    return Isa::Avx512;
+  }
+  if (kCpuFeatures.avx2) {
+    return Isa::Avx2;
+  }
+#endif
+  return Isa::Scalar;
+}
+
+Isa getIsa() { return currentIsa().load(); }
+
+void setIsa(Isa isa) {
+  YACL_ENFORCE(static_cast<int>(isa) <= static_cast<int>(detectIsa()),
+               "isa {} is not supported by this cpu", IsaName(isa));
+  currentIsa().store(isa);
+}
+
+bool binary(BinaryOp op, size_t elsize, const void* x, const void* y,
+            void* ret, int64_t numel) {
+  const auto fn = getBinaryFn(getIsa(), op, elsize);
+  if (fn == nullptr) {
+    return false;
+  }
+
+  const auto* px = static_cast<const std::byte*>(x);
+  const auto* py = static_cast<const std::byte*>(y);
+  auto* pr = static_cast<std::byte*>(ret);
+  pfor(0, numel, [&](int64_t begin, int64_t end) {
+    const size_t offset = begin * elsize;
+    fn(px + offset, py + offset, pr + offset, end - begin);
+  });
+  return true;
+}
+
+bool shift(ShiftOp op, size_t elsize, const void* x, void* ret, int64_t numel,
+           size_t bits) {
+  // keep the (undefined) behavior of over shifting to the generic path.
+  if (bits >= elsize * 8) {
+    return false;
+  }
+  const auto fn = getShiftFn(getIsa(), op, elsize);
+  if (fn == nullptr) {
+    return false;
+  }
+
+  const auto* px = static_cast<const std::byte*>(x);
+  auto* pr = static_cast<std::byte*>(ret);
+  pfor(0, numel, [&](int64_t begin, int64_t end) {
+    const size_t offset = begin * elsize;
+    fn(px + offset, pr + offset, end - begin, bits);
+  });
+  return true;
+}
+
+}  // namespace spu::mpc::simd
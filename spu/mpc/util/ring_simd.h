@@ -0,0 +1,73 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Explicitly vectorized kernels of ring element-wise arithmetic.
+//
+// Kernels only handle the compact (all strides equal to one) fast path of
+// 32/64/128 bits rings, the 128 bits ring is processed in 128-bit lanes with
+// carry/borrow propagated between the 64-bit halves. The instruction set is
+// selected at runtime according to the running cpu.
+namespace spu::mpc::simd {
+
+enum class Isa {
+  Scalar = 0,
+  Avx2 = 1,
+  Avx512 = 2,
+};
+
+std::string_view IsaName(Isa isa);
+
+// Return the best instruction set supported by the running cpu.
+Isa detectIsa();
+
+// Return the instruction set used by kernels, default to `detectIsa()`.
+Isa getIsa();
+
+// Override the instruction set used by kernels, mainly for testing and
+// benchmarking, throws if the cpu does not support it.
+void setIsa(Isa isa);
+
+enum class BinaryOp {
+  Add,
+  Sub,
+  Mul,
+  And,
+  Xor,
+};
+
+enum class ShiftOp {
+  LShift,
+  RShift,
+  ARShift,
+};
+
+// ret[i] = x[i] op y[i] for `numel` compact elements of `elsize` bytes.
+//
+// Return false if there is no kernel for (op, elsize) with the current
+// instruction set, then nothing is written and the caller should use the
+// generic path.
+bool binary(BinaryOp op, size_t elsize, const void* x, const void* y,
+            void* ret, int64_t numel);
+
+// ret[i] = x[i] op bits, see `binary`.
+bool shift(ShiftOp op, size_t elsize, const void* x, void* ret, int64_t numel,
+           size_t bits);
+
+}  // namespace spu::mpc::simd
@@ -0,0 +1,104 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file is compiled with -mavx2.
+
+#include <immintrin.h>
+
+#include "spu/mpc/util/ring_simd_kernels.h"
+
+namespace spu::mpc::simd::avx2 {
+namespace {
+
+struct Avx2 {
+  using Reg = __m256i;
+  static constexpr int64_t kBytes = 32;
+
+  static Reg load(const void* ptr) {
+    return _mm256_loadu_si256(static_cast<const __m256i*>(ptr));
+  }
+  static void store(void* ptr, Reg v) {
+    _mm256_storeu_si256(static_cast<__m256i*>(ptr), v);
+  }
+
+  static Reg and_(Reg a, Reg b) { return _mm256_and_si256(a, b); }
+  static Reg or_(Reg a, Reg b) { return _mm256_or_si256(a, b); }
+  static Reg xor_(Reg a, Reg b) { return _mm256_xor_si256(a, b); }
+
+  static Reg add32(Reg a, Reg b) { return _mm256_add_epi32(a, b); }
+  static Reg sub32(Reg a, Reg b) { return _mm256_sub_epi32(a, b); }
+  static Reg mul32(Reg a, Reg b) { return _mm256_mullo_epi32(a, b); }
+
+  static Reg add64(Reg a, Reg b) { return _mm256_add_epi64(a, b); }
+  static Reg sub64(Reg a, Reg b) { return _mm256_sub_epi64(a, b); }
+  // there is no 64-bit multiply in avx2, compose it with 32x32->64 ones:
+  //   a * b = lo(a) * lo(b) + ((hi(a) * lo(b) + lo(a) * hi(b)) << 32)
+  static Reg mul64(Reg a, Reg b) {
+    const Reg lo = _mm256_mul_epu32(a, b);
+    const Reg cross =
+        _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                         _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+  }
+
+  // shift counts not less than the lane width give zero (or the sign).
+  static Reg sll32(Reg a, size_t bits) {
+    return _mm256_sll_epi32(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg srl32(Reg a, size_t bits) {
+    return _mm256_srl_epi32(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg sra32(Reg a, size_t bits) {
+    return _mm256_sra_epi32(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg sll64(Reg a, size_t bits) {
+    return _mm256_sll_epi64(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg srl64(Reg a, size_t bits) {
+    return _mm256_srl_epi64(a, _mm_cvtsi64_si128(bits));
+  }
+  // there is no 64-bit arithmetic shift in avx2, fill the sign manually.
+  static Reg sra64(Reg a, size_t bits) {
+    const Reg sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), a);
+    return _mm256_or_si256(srl64(a, bits), sll64(sign, 64 - bits));
+  }
+
+  // all-ones where a < b as unsigned 64-bit integers.
+  static Reg lt64(Reg a, Reg b) {
+    const Reg sign = _mm256_set1_epi64x(INT64_MIN);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign),
+                              _mm256_xor_si256(a, sign));
+  }
+
+  // move the low/high 64-bit half of each 128-bit lane to the other half.
+  static Reg bslli8(Reg a) { return _mm256_slli_si256(a, 8); }
+  static Reg bsrli8(Reg a) { return _mm256_srli_si256(a, 8); }
+
+  // low halves from `lo`, high halves from `hi`.
+  static Reg blendHi64(Reg lo, Reg hi) {
+    return _mm256_blend_epi32(lo, hi, 0xCC);
+  }
+};
+
+}  // namespace
+
+BinaryFn getBinaryFn(BinaryOp op, size_t elsize) {
+  return detail::getBinaryFn<Avx2>(op, elsize);
+}
+
+ShiftFn getShiftFn(ShiftOp op, size_t elsize) {
+  return detail::getShiftFn<Avx2>(op, elsize);
+}
+
+}  // namespace spu::mpc::simd::avx2
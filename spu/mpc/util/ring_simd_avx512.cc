@@ -0,0 +1,93 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file is compiled with -mavx512f -mavx512dq.
+
+#include <immintrin.h>
+
+#include "spu/mpc/util/ring_simd_kernels.h"
+
+namespace spu::mpc::simd::avx512 {
+namespace {
+
+struct Avx512 {
+  using Reg = __m512i;
+  static constexpr int64_t kBytes = 64;
+
+  static Reg load(const void* ptr) { return _mm512_loadu_si512(ptr); }
+  static void store(void* ptr, Reg v) { _mm512_storeu_si512(ptr, v); }
+
+  static Reg and_(Reg a, Reg b) { return _mm512_and_si512(a, b); }
+  static Reg or_(Reg a, Reg b) { return _mm512_or_si512(a, b); }
+  static Reg xor_(Reg a, Reg b) { return _mm512_xor_si512(a, b); }
+
+  static Reg add32(Reg a, Reg b) { return _mm512_add_epi32(a, b); }
+  static Reg sub32(Reg a, Reg b) { return _mm512_sub_epi32(a, b); }
+  static Reg mul32(Reg a, Reg b) { return _mm512_mullo_epi32(a, b); }
+
+  static Reg add64(Reg a, Reg b) { return _mm512_add_epi64(a, b); }
+  static Reg sub64(Reg a, Reg b) { return _mm512_sub_epi64(a, b); }
+  static Reg mul64(Reg a, Reg b) { return _mm512_mullo_epi64(a, b); }
+
+  // shift counts not less than the lane width give zero (or the sign).
+  static Reg sll32(Reg a, size_t bits) {
+    return _mm512_sll_epi32(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg srl32(Reg a, size_t bits) {
+    return _mm512_srl_epi32(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg sra32(Reg a, size_t bits) {
+    return _mm512_sra_epi32(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg sll64(Reg a, size_t bits) {
+    return _mm512_sll_epi64(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg srl64(Reg a, size_t bits) {
+    return _mm512_srl_epi64(a, _mm_cvtsi64_si128(bits));
+  }
+  static Reg sra64(Reg a, size_t bits) {
+    return _mm512_sra_epi64(a, _mm_cvtsi64_si128(bits));
+  }
+
+  // all-ones where a < b as unsigned 64-bit integers.
+  static Reg lt64(Reg a, Reg b) {
+    return _mm512_movm_epi64(_mm512_cmplt_epu64_mask(a, b));
+  }
+
+  // move the low/high 64-bit half of each 128-bit lane to the other half,
+  // byte shifts of 512 bits registers require avx512bw, use unpacks instead.
+  static Reg bslli8(Reg a) {
+    return _mm512_unpacklo_epi64(_mm512_setzero_si512(), a);
+  }
+  static Reg bsrli8(Reg a) {
+    return _mm512_unpackhi_epi64(a, _mm512_setzero_si512());
+  }
+
+  // low halves from `lo`, high halves from `hi`.
+  static Reg blendHi64(Reg lo, Reg hi) {
+    return _mm512_mask_blend_epi64(0xAA, lo, hi);
+  }
+};
+
+}  // namespace
+
+BinaryFn getBinaryFn(BinaryOp op, size_t elsize) {
+  return detail::getBinaryFn<Avx512>(op, elsize);
+}
+
+ShiftFn getShiftFn(ShiftOp op, size_t elsize) {
+  return detail::getShiftFn<Avx512>(op, elsize);
+}
+
+}  // namespace spu::mpc::simd::avx512
@@ -0,0 +1,269 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+// Internal header of ring_simd, the kernel templates are instantiated once per
+// instruction set, by translation units compiled with the matching target
+// flags.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "yacl/base/int128.h"
+
+#include "spu/mpc/util/ring_simd.h"
+
+namespace spu::mpc::simd {
+
+// Process x[0, n), y[0, n) into ret[0, n), pointers are not required to be
+// aligned and `ret` may alias the inputs.
+using BinaryFn = void (*)(const void* x, const void* y, void* ret, int64_t n);
+using ShiftFn = void (*)(const void* x, void* ret, int64_t n, size_t bits);
+
+namespace avx2 {
+BinaryFn getBinaryFn(BinaryOp op, size_t elsize);
+ShiftFn getShiftFn(ShiftOp op, size_t elsize);
+}  // namespace avx2
+
+namespace avx512 {
+BinaryFn getBinaryFn(BinaryOp op, size_t elsize);
+ShiftFn getShiftFn(ShiftOp op, size_t elsize);
+}  // namespace avx512
+
+namespace detail {
+
+template <size_t kElSize>
+struct IntOf;
+
+template <>
+struct IntOf<4> {
+  using U = uint32_t;
+  using S = int32_t;
+};
+
+template <>
+struct IntOf<8> {
+  using U = uint64_t;
+  using S = int64_t;
+};
+
+template <>
+struct IntOf<16> {
+  using U = uint128_t;
+  using S = int128_t;
+};
+
+template <BinaryOp kOp, typename U>
+inline U scalarBinary(U x, U y) {
+  if constexpr (kOp == BinaryOp::Add) {
+    return x + y;
+  } else if constexpr (kOp == BinaryOp::Sub) {
+    return x - y;
+  } else if constexpr (kOp == BinaryOp::Mul) {
+    return x * y;
+  } else if constexpr (kOp == BinaryOp::And) {
+    return x & y;
+  } else {
+    return x ^ y;
+  }
+}
+
+template <ShiftOp kOp, size_t kElSize>
+inline typename IntOf<kElSize>::U scalarShift(typename IntOf<kElSize>::U x,
+                                              size_t bits) {
+  using U = typename IntOf<kElSize>::U;
+  using S = typename IntOf<kElSize>::S;
+  if constexpr (kOp == ShiftOp::LShift) {
+    return x << bits;
+  } else if constexpr (kOp == ShiftOp::RShift) {
+    return x >> bits;
+  } else {
+    return static_cast<U>(static_cast<S>(x) >> bits);
+  }
+}
+
+// `V` is the instruction set traits, which wraps a vector register type
+// `Reg` of `kBytes` bytes and the lane-wise primitives used below, the 128
+// bits ring is laid out as (lo, hi) pairs of 64-bit lanes.
+template <typename V, BinaryOp kOp, size_t kElSize>
+inline typename V::Reg vecBinary(typename V::Reg a, typename V::Reg b) {
+  if constexpr (kOp == BinaryOp::And) {
+    return V::and_(a, b);
+  } else if constexpr (kOp == BinaryOp::Xor) {
+    return V::xor_(a, b);
+  } else if constexpr (kElSize == 16) {
+    static_assert(kOp == BinaryOp::Add || kOp == BinaryOp::Sub);
+    if constexpr (kOp == BinaryOp::Add) {
+      // the low half carries iff the sum wraps, move the all-ones carry mask
+      // to the high half and subtract it, i.e. add one.
+      const auto sum = V::add64(a, b);
+      return V::sub64(sum, V::bslli8(V::lt64(sum, a)));
+    } else {
+      const auto diff = V::sub64(a, b);
+      return V::add64(diff, V::bslli8(V::lt64(a, b)));
+    }
+  } else if constexpr (kElSize == 8) {
+    if constexpr (kOp == BinaryOp::Add) {
+      return V::add64(a, b);
+    } else if constexpr (kOp == BinaryOp::Sub) {
+      return V::sub64(a, b);
+    } else {
+      return V::mul64(a, b);
+    }
+  } else {
+    static_assert(kElSize == 4);
+    if constexpr (kOp == BinaryOp::Add) {
+      return V::add32(a, b);
+    } else if constexpr (kOp == BinaryOp::Sub) {
+      return V::sub32(a, b);
+    } else {
+      return V::mul32(a, b);
+    }
+  }
+}
+
+// requires bits < kElSize * 8.
+template <typename V, ShiftOp kOp, size_t kElSize>
+inline typename V::Reg vecShift(typename V::Reg a, size_t bits) {
+  if constexpr (kElSize == 16) {
+    if constexpr (kOp == ShiftOp::LShift) {
+      if (bits < 64) {
+        return V::or_(V::sll64(a, bits), V::bslli8(V::srl64(a, 64 - bits)));
+      }
+      return V::sll64(V::bslli8(a), bits - 64);
+    } else {
+      // the low half of the result.
+      typename V::Reg lo;
+      if (bits < 64) {
+        lo = V::or_(V::srl64(a, bits), V::bsrli8(V::sll64(a, 64 - bits)));
+      } else if constexpr (kOp == ShiftOp::RShift) {
+        return V::srl64(V::bsrli8(a), bits - 64);
+      } else {
+        lo = V::bsrli8(V::sra64(a, bits - 64));
+      }
+
+      if constexpr (kOp == ShiftOp::RShift) {
+        return lo;
+      } else {
+        return V::blendHi64(lo, V::sra64(a, bits < 64 ? bits : 63));
+      }
+    }
+  } else if constexpr (kElSize == 8) {
+    if constexpr (kOp == ShiftOp::LShift) {
+      return V::sll64(a, bits);
+    } else if constexpr (kOp == ShiftOp::RShift) {
+      return V::srl64(a, bits);
+    } else {
+      return V::sra64(a, bits);
+    }
+  } else {
+    static_assert(kElSize == 4);
+    if constexpr (kOp == ShiftOp::LShift) {
+      return V::sll32(a, bits);
+    } else if constexpr (kOp == ShiftOp::RShift) {
+      return V::srl32(a, bits);
+    } else {
+      return V::sra32(a, bits);
+    }
+  }
+}
+
+template <typename V, BinaryOp kOp, size_t kElSize>
+void binaryKernel(const void* x, const void* y, void* ret, int64_t n) {
+  using U = typename IntOf<kElSize>::U;
+  constexpr int64_t kLanes = V::kBytes / kElSize;
+
+  const auto* px = static_cast<const U*>(x);
+  const auto* py = static_cast<const U*>(y);
+  auto* pr = static_cast<U*>(ret);
+
+  int64_t idx = 0;
+  for (; idx + kLanes <= n; idx += kLanes) {
+    V::store(pr + idx,
+             vecBinary<V, kOp, kElSize>(V::load(px + idx), V::load(py + idx)));
+  }
+  for (; idx < n; idx++) {
+    pr[idx] = scalarBinary<kOp>(px[idx], py[idx]);
+  }
+}
+
+template <typename V, ShiftOp kOp, size_t kElSize>
+void shiftKernel(const void* x, void* ret, int64_t n, size_t bits) {
+  using U = typename IntOf<kElSize>::U;
+  constexpr int64_t kLanes = V::kBytes / kElSize;
+
+  const auto* px = static_cast<const U*>(x);
+  auto* pr = static_cast<U*>(ret);
+
+  int64_t idx = 0;
+  for (; idx + kLanes <= n; idx += kLanes) {
+    V::store(pr + idx, vecShift<V, kOp, kElSize>(V::load(px + idx), bits));
+  }
+  for (; idx < n; idx++) {
+    pr[idx] = scalarShift<kOp, kElSize>(px[idx], bits);
+  }
+}
+
+// The 128 bits multiplication stays on the generic path, it's dominated by
+// the 64x64->128 scalar multiply which has no vector counterpart.
+template <typename V>
+BinaryFn getBinaryFn(BinaryOp op, size_t elsize) {
+#define CASE_BINARY(OP, ELSIZE)                    \
+  if (op == BinaryOp::OP && elsize == ELSIZE) {    \
+    return &binaryKernel<V, BinaryOp::OP, ELSIZE>; \
+  }
+
+  CASE_BINARY(Add, 4)
+  CASE_BINARY(Add, 8)
+  CASE_BINARY(Add, 16)
+  CASE_BINARY(Sub, 4)
+  CASE_BINARY(Sub, 8)
+  CASE_BINARY(Sub, 16)
+  CASE_BINARY(Mul, 4)
+  CASE_BINARY(Mul, 8)
+  CASE_BINARY(And, 4)
+  CASE_BINARY(And, 8)
+  CASE_BINARY(And, 16)
+  CASE_BINARY(Xor, 4)
+  CASE_BINARY(Xor, 8)
+  CASE_BINARY(Xor, 16)
+
+#undef CASE_BINARY
+  return nullptr;
+}
+
+template <typename V>
+ShiftFn getShiftFn(ShiftOp op, size_t elsize) {
+#define CASE_SHIFT(OP, ELSIZE)                   \
+  if (op == ShiftOp::OP && elsize == ELSIZE) {   \
+    return &shiftKernel<V, ShiftOp::OP, ELSIZE>; \
+  }
+
+  CASE_SHIFT(LShift, 4)
+  CASE_SHIFT(LShift, 8)
+  CASE_SHIFT(LShift, 16)
+  CASE_SHIFT(RShift, 4)
+  CASE_SHIFT(RShift, 8)
+  CASE_SHIFT(RShift, 16)
+  CASE_SHIFT(ARShift, 4)
+  CASE_SHIFT(ARShift, 8)
+  CASE_SHIFT(ARShift, 16)
+
+#undef CASE_SHIFT
+  return nullptr;
+}
+
+}  // namespace detail
+}  // namespace spu::mpc::simd
@@ -0,0 +1,106 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/mpc/util/ring_simd.h"
+
+#include <functional>
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+
+#include "spu/mpc/util/ring_ops.h"
+
+namespace spu::mpc {
+
+class RingSimdTest
+    : public ::testing::TestWithParam<std::tuple<FieldType, simd::Isa>> {
+ protected:
+  void SetUp() override {
+    if (static_cast<int>(std::get<1>(GetParam())) >
+        static_cast<int>(simd::detectIsa())) {
+      GTEST_SKIP() << "isa not supported by this cpu";
+    }
+  }
+
+  void TearDown() override { simd::setIsa(simd::detectIsa()); }
+
+  // run `fn` with the scalar path and the tested isa, expect same results.
+  void expectSameAsScalar(const std::function<ArrayRef()>& fn) {
+    simd::setIsa(simd::Isa::Scalar);
+    const auto expected = fn();
+    simd::setIsa(std::get<1>(GetParam()));
+    const auto got = fn();
+    EXPECT_TRUE(ring_all_equal(expected, got));
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    RingSimdTestSuite, RingSimdTest,
+    testing::Combine(testing::Values(FM32, FM64, FM128),
+                     testing::Values(simd::Isa::Avx2, simd::Isa::Avx512)),
+    [](const testing::TestParamInfo<RingSimdTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<0>(p.param),
+                         simd::IsaName(std::get<1>(p.param)));
+    });
+
+TEST_P(RingSimdTest, Binary) {
+  const FieldType field = std::get<0>(GetParam());
+  // not a multiple of vector lanes, to cover the tails.
+  const int64_t numel = 1003;
+
+  const auto x = ring_rand(field, numel);
+  const auto y = ring_rand(field, numel);
+  // make sure carries (borrows) propagate between 64-bit halves.
+  const auto z = ring_neg(x);
+
+  expectSameAsScalar([&]() { return ring_add(x, y); });
+  expectSameAsScalar([&]() { return ring_add(x, z); });
+  expectSameAsScalar([&]() { return ring_sub(x, y); });
+  expectSameAsScalar([&]() { return ring_sub(x, z); });
+  expectSameAsScalar([&]() { return ring_mul(x, y); });
+  expectSameAsScalar([&]() { return ring_and(x, y); });
+  expectSameAsScalar([&]() { return ring_xor(x, y); });
+  expectSameAsScalar([&]() {
+    auto res = x.clone();
+    ring_add_(res, y);
+    return res;
+  });
+}
+
+TEST_P(RingSimdTest, Shift) {
+  const FieldType field = std::get<0>(GetParam());
+  const int64_t numel = 1003;
+
+  const auto x = ring_rand(field, numel);
+  for (size_t bits = 0; bits < SizeOf(field) * 8; bits++) {
+    expectSameAsScalar([&]() { return ring_lshift(x, bits); });
+    expectSameAsScalar([&]() { return ring_rshift(x, bits); });
+    expectSameAsScalar([&]() { return ring_arshift(x, bits); });
+  }
+}
+
+TEST(RingSimdIsaTest, Detect) {
+  const auto isa = simd::detectIsa();
+  EXPECT_EQ(simd::getIsa(), isa);
+
+  simd::setIsa(simd::Isa::Scalar);
+  EXPECT_EQ(simd::getIsa(), simd::Isa::Scalar);
+  simd::setIsa(isa);
+
+  if (isa != simd::Isa::Avx512) {
+    EXPECT_THROW(simd::setIsa(simd::Isa::Avx512), yacl::EnforceNotMet);
+  }
+}
+
+}  // namespace spu::mpc
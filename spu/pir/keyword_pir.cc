@@ -0,0 +1,232 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/pir/keyword_pir.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+#include "yacl/crypto/utils/hash_util.h"
+#include "yacl/utils/parallel.h"
+
+#include "spu/psi/core/ecdh_oprf/ecdh_oprf_selector.h"
+#include "spu/psi/utils/serialize.h"
+
+namespace spu::pir {
+
+KeywordPir::KeywordPir(const KeywordPirOptions &options,
+                       yacl::ByteContainerView seed)
+    : options_(options), seed_(seed.begin(), seed.end()) {
+  YACL_ENFORCE(options_.key_number > 0, "empty keyword pir db");
+  YACL_ENFORCE(options_.value_size > 0);
+  YACL_ENFORCE(options_.batch_number > 0);
+
+  table_params_ = psi::CuckooIndex::SelectParams(options_.key_number, 0,
+                                                 kCuckooHashNumber);
+  query_params_ = psi::CuckooIndex::SelectParams(
+      options_.batch_number * kCuckooHashNumber, 0, kCuckooHashNumber);
+}
+
+std::vector<KeywordPir::KeyHash> KeywordPir::HashKeys(
+    const std::vector<std::string> &keys) {
+  std::vector<KeyHash> key_hashes(keys.size());
+  yacl::parallel_for(0, keys.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      // the first half decides the slots, and the second half is the tag.
+      std::vector<uint8_t> digest = yacl::crypto::Blake3(keys[idx]);
+      YACL_ENFORCE(digest.size() >= sizeof(psi::CuckooIndex::HashType) +
+                                        kTagSize);
+      std::memcpy(&key_hashes[idx].code, digest.data(),
+                  sizeof(psi::CuckooIndex::HashType));
+      std::memcpy(key_hashes[idx].tag.data(),
+                  digest.data() + sizeof(psi::CuckooIndex::HashType),
+                  kTagSize);
+    }
+  });
+  return key_hashes;
+}
+
+std::vector<size_t> KeywordPir::GetCandidateSlots(
+    const KeyHash &key_hash) const {
+  psi::CuckooIndex::HashRoom hash_room(key_hash.code);
+  std::vector<size_t> slots;
+  for (size_t j = 0; j < kCuckooHashNumber; ++j) {
+    // same as the bin of the j-th hash function in CuckooIndex::Insert.
+    size_t slot = hash_room.GetHash(j) % GetTableSize();
+    if (std::find(slots.begin(), slots.end(), slot) == slots.end()) {
+      slots.push_back(slot);
+    }
+  }
+  return slots;
+}
+
+MultiQueryOptions KeywordPir::GetMultiQueryOptions() const {
+  return MultiQueryOptions{{options_.poly_modulus_degree, GetTableSize(),
+                            GetElementSize()},
+                           options_.batch_number * kCuckooHashNumber,
+                           kCuckooHashNumber};
+}
+
+KeywordPirServer::KeywordPirServer(const KeywordPirOptions &options,
+                                   yacl::ByteContainerView seed)
+    : KeywordPir(options, seed) {
+  if (options_.use_oprf) {
+    oprf_server_ = psi::CreateEcdhOprfServer(psi::OprfType::Basic,
+                                             psi::CurveType::CURVE_FOURQ);
+  }
+  mpir_server_ = std::make_unique<MultiQueryServer>(GetMultiQueryOptions(),
+                                                    query_params_, seed_);
+}
+
+void KeywordPirServer::SetDatabase(const std::vector<std::string> &keys,
+                                   yacl::ByteContainerView values) {
+  YACL_ENFORCE(keys.size() == options_.key_number,
+               "keys size {} mismatch key_number {}", keys.size(),
+               options_.key_number);
+  YACL_ENFORCE(values.size() == keys.size() * options_.value_size,
+               "values size {} mismatch {} keys of value size {}",
+               values.size(), keys.size(), options_.value_size);
+
+  std::vector<KeyHash> key_hashes;
+  if (oprf_server_ != nullptr) {
+    key_hashes = HashKeys(oprf_server_->FullEvaluate(keys));
+  } else {
+    key_hashes = HashKeys(keys);
+  }
+
+  std::vector<psi::CuckooIndex::HashType> codes(key_hashes.size());
+  for (size_t idx = 0; idx < key_hashes.size(); ++idx) {
+    codes[idx] = key_hashes[idx].code;
+  }
+  psi::CuckooIndex cuckoo_index(table_params_);
+  cuckoo_index.Insert(codes);
+
+  // empty slots are zeros, whose tag never matches.
+  const size_t element_size = GetElementSize();
+  std::vector<uint8_t> db_bytes(GetTableSize() * element_size, 0);
+  const auto &bins = cuckoo_index.bins();
+  yacl::parallel_for(0, bins.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      if (bins[idx].IsEmpty()) {
+        continue;
+      }
+      size_t key_idx = bins[idx].InputIdx();
+      uint8_t *element = &db_bytes[idx * element_size];
+      std::memcpy(element, key_hashes[key_idx].tag.data(), kTagSize);
+      std::memcpy(element + kTagSize,
+                  values.data() + key_idx * options_.value_size,
+                  options_.value_size);
+    }
+  });
+
+  mpir_server_->SetDatabase(db_bytes);
+}
+
+void KeywordPirServer::DoKeywordPirAnswer(
+    const std::shared_ptr<yacl::link::Context> &link_ctx) {
+  if (oprf_server_ != nullptr) {
+    std::vector<std::string> blinded_items;
+    psi::utils::DeserializeStrItems(
+        link_ctx->Recv(link_ctx->NextRank(), fmt::format("recv blinded keys")),
+        &blinded_items);
+    YACL_ENFORCE(blinded_items.size() <= options_.batch_number,
+                 "query of {} keys exceeds batch_number {}",
+                 blinded_items.size(), options_.batch_number);
+
+    link_ctx->SendAsync(
+        link_ctx->NextRank(),
+        psi::utils::SerializeStrItems(oprf_server_->Evaluate(blinded_items)),
+        fmt::format("send evaluated keys"));
+  }
+
+  mpir_server_->DoMultiPirAnswer(link_ctx);
+}
+
+KeywordPirClient::KeywordPirClient(const KeywordPirOptions &options,
+                                   yacl::ByteContainerView seed)
+    : KeywordPir(options, seed) {
+  mpir_client_ = std::make_unique<MultiQueryClient>(GetMultiQueryOptions(),
+                                                    query_params_, seed_);
+}
+
+std::vector<std::optional<std::vector<uint8_t>>>
+KeywordPirClient::DoKeywordPirQuery(
+    const std::shared_ptr<yacl::link::Context> &link_ctx,
+    const std::vector<std::string> &keys) {
+  YACL_ENFORCE(!keys.empty());
+  YACL_ENFORCE(keys.size() <= options_.batch_number,
+               "query of {} keys exceeds batch_number {}", keys.size(),
+               options_.batch_number);
+
+  std::vector<KeyHash> key_hashes;
+  if (options_.use_oprf) {
+    auto oprf_client = psi::CreateEcdhOprfClient(psi::OprfType::Basic,
+                                                 psi::CurveType::CURVE_FOURQ);
+    link_ctx->SendAsync(
+        link_ctx->NextRank(),
+        psi::utils::SerializeStrItems(oprf_client->Blind(keys)),
+        fmt::format("send blinded keys"));
+
+    std::vector<std::string> evaluated_items;
+    psi::utils::DeserializeStrItems(
+        link_ctx->Recv(link_ctx->NextRank(),
+                       fmt::format("recv evaluated keys")),
+        &evaluated_items);
+    YACL_ENFORCE(evaluated_items.size() == keys.size());
+
+    key_hashes = HashKeys(oprf_client->Finalize(keys, evaluated_items));
+  } else {
+    key_hashes = HashKeys(keys);
+  }
+
+  // query every candidate slot of the keys once.
+  std::vector<std::vector<size_t>> key_slots(keys.size());
+  std::set<size_t> slot_set;
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    key_slots[idx] = GetCandidateSlots(key_hashes[idx]);
+    slot_set.insert(key_slots[idx].begin(), key_slots[idx].end());
+  }
+  std::vector<size_t> slots(slot_set.begin(), slot_set.end());
+
+  std::vector<std::vector<uint8_t>> elements =
+      mpir_client_->DoMultiPirQuery(link_ctx, slots);
+  YACL_ENFORCE(elements.size() == slots.size());
+
+  std::map<size_t, const std::vector<uint8_t> *> slot_elements;
+  for (size_t idx = 0; idx < slots.size(); ++idx) {
+    YACL_ENFORCE(elements[idx].size() == GetElementSize());
+    slot_elements.emplace(slots[idx], &elements[idx]);
+  }
+
+  std::vector<std::optional<std::vector<uint8_t>>> values(keys.size());
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    for (size_t slot : key_slots[idx]) {
+      const std::vector<uint8_t> &element = *slot_elements.at(slot);
+      if (std::memcmp(element.data(), key_hashes[idx].tag.data(), kTagSize) !=
+          0) {
+        continue;
+      }
+      values[idx].emplace(element.begin() + kTagSize, element.end());
+      break;
+    }
+  }
+  return values;
+}
+
+}  // namespace spu::pir
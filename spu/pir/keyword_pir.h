@@ -0,0 +1,139 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "yacl/base/byte_container_view.h"
+#include "yacl/link/link.h"
+
+#include "spu/pir/seal_mpir.h"
+#include "spu/psi/core/cuckoo_index.h"
+#include "spu/psi/core/ecdh_oprf/ecdh_oprf.h"
+
+namespace spu::pir {
+
+// Keyword PIR over SealPir.
+//
+// The server places every key into a cuckoo table with 3 hash functions, and
+// each slot of the table holds the tag of its key and the value. The slots
+// are the elements of an index PIR db. A client looks up a key by querying
+// all of its candidate slots with one batched MultiQuery, and picks the slot
+// whose tag matches. It is cheaper than labeled psi when the values are large
+// and a query holds a few keys.
+//
+// With `use_oprf`, keys are mapped by an ecdh oprf of the server before
+// hashing, so the client learns nothing of the table but the slots of the
+// keys it queries.
+struct KeywordPirOptions {
+  // The number of keys in the server db, known to both sides.
+  size_t key_number = 0;
+  // The size of every value in bytes.
+  size_t value_size = 0;
+  // The max number of keys in a query.
+  size_t batch_number = 1;
+  size_t poly_modulus_degree = 8192;
+  bool use_oprf = false;
+};
+
+class KeywordPir {
+ public:
+  // Tag stored with the value to tell it is the slot of the queried key.
+  static constexpr size_t kTagSize = 16;
+  // CuckooIndex::SelectParams supports 3 hash functions only.
+  static constexpr size_t kCuckooHashNumber = 3;
+
+  KeywordPir(const KeywordPirOptions &options, yacl::ByteContainerView seed);
+
+  size_t GetElementSize() const { return kTagSize + options_.value_size; }
+
+  size_t GetTableSize() const { return table_params_.NumBins(); }
+
+ protected:
+  struct KeyHash {
+    psi::CuckooIndex::HashType code;
+    std::array<uint8_t, kTagSize> tag;
+  };
+
+  static std::vector<KeyHash> HashKeys(const std::vector<std::string> &keys);
+
+  // The distinct table slots a key could be placed in.
+  std::vector<size_t> GetCandidateSlots(const KeyHash &key_hash) const;
+
+  MultiQueryOptions GetMultiQueryOptions() const;
+
+  KeywordPirOptions options_;
+  std::vector<uint8_t> seed_;
+
+  // cuckoo table of the keys.
+  psi::CuckooIndex::Options table_params_;
+  // cuckoo hashing of the slots queried in a batch.
+  psi::CuckooIndex::Options query_params_;
+};
+
+class KeywordPirServer : public KeywordPir {
+ public:
+  KeywordPirServer(const KeywordPirOptions &options,
+                   yacl::ByteContainerView seed);
+
+  // `keys` should be distinct and `values` holds keys.size() values of
+  // value_size bytes in the order of the keys.
+  void SetDatabase(const std::vector<std::string> &keys,
+                   yacl::ByteContainerView values);
+
+  void SetGaloisKeys(const seal::GaloisKeys &galkey) {
+    mpir_server_->SetGaloisKeys(galkey);
+  }
+
+  void RecvGaloisKeys(const std::shared_ptr<yacl::link::Context> &link_ctx) {
+    mpir_server_->RecvGaloisKeys(link_ctx);
+  }
+
+  // Answer one query of DoKeywordPirQuery.
+  void DoKeywordPirAnswer(const std::shared_ptr<yacl::link::Context> &link_ctx);
+
+ private:
+  std::unique_ptr<psi::IEcdhOprfServer> oprf_server_;
+  std::unique_ptr<MultiQueryServer> mpir_server_;
+};
+
+class KeywordPirClient : public KeywordPir {
+ public:
+  KeywordPirClient(const KeywordPirOptions &options,
+                   yacl::ByteContainerView seed);
+
+  seal::GaloisKeys GenerateGaloisKeys() {
+    return mpir_client_->GenerateGaloisKeys();
+  }
+
+  void SendGaloisKeys(const std::shared_ptr<yacl::link::Context> &link_ctx) {
+    mpir_client_->SendGaloisKeys(link_ctx);
+  }
+
+  // Return the value of every key, or std::nullopt if it is not in the db.
+  // At most batch_number keys are queried at once.
+  std::vector<std::optional<std::vector<uint8_t>>> DoKeywordPirQuery(
+      const std::shared_ptr<yacl::link::Context> &link_ctx,
+      const std::vector<std::string> &keys);
+
+ private:
+  std::unique_ptr<MultiQueryClient> mpir_client_;
+};
+
+}  // namespace spu::pir
@@ -0,0 +1,86 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/pir/keyword_pir.h"
+
+#include <future>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "yacl/link/test_util.h"
+
+namespace spu::pir {
+
+class KeywordPirTest : public testing::TestWithParam<bool> {};
+
+TEST_P(KeywordPirTest, Works) {
+  KeywordPirOptions options;
+  options.key_number = 200;
+  options.value_size = 64;
+  options.batch_number = 4;
+  options.use_oprf = GetParam();
+
+  std::mt19937 gen(42);
+  std::vector<std::string> keys;
+  std::vector<uint8_t> values(options.key_number * options.value_size);
+  for (size_t idx = 0; idx < options.key_number; ++idx) {
+    keys.push_back(fmt::format("key-{}", idx));
+  }
+  for (auto &value : values) {
+    value = gen() % 256;
+  }
+
+  // the seed is shared by both sides, say by a key exchange.
+  std::vector<uint8_t> seed(32, 0x5a);
+  KeywordPirServer server(options, seed);
+  KeywordPirClient client(options, seed);
+
+  server.SetDatabase(keys, values);
+  server.SetGaloisKeys(client.GenerateGaloisKeys());
+
+  auto ctxs = yacl::link::test::SetupWorld(2);
+  std::vector<std::string> query_keys = {"key-7", "not-a-key", "key-199",
+                                         "key-0"};
+  std::vector<size_t> query_index = {7, 0, 199, 0};
+
+  std::future<void> server_func =
+      std::async([&] { return server.DoKeywordPirAnswer(ctxs[0]); });
+  std::future<std::vector<std::optional<std::vector<uint8_t>>>> client_func =
+      std::async([&] { return client.DoKeywordPirQuery(ctxs[1], query_keys); });
+
+  server_func.get();
+  auto query_values = client_func.get();
+  ASSERT_EQ(query_values.size(), query_keys.size());
+
+  for (size_t idx = 0; idx < query_keys.size(); ++idx) {
+    if (query_keys[idx] == "not-a-key") {
+      EXPECT_FALSE(query_values[idx].has_value());
+      continue;
+    }
+    ASSERT_TRUE(query_values[idx].has_value());
+    std::vector<uint8_t> expected(
+        values.begin() + query_index[idx] * options.value_size,
+        values.begin() + (query_index[idx] + 1) * options.value_size);
+    EXPECT_EQ(*query_values[idx], expected);
+  }
+
+  EXPECT_THROW(client.DoKeywordPirQuery(
+                   ctxs[1], {"key-1", "key-2", "key-3", "key-4", "key-5"}),
+               yacl::EnforceNotMet);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, KeywordPirTest,
+                         testing::Values(false, true));
+
+}  // namespace spu::pir
@@ -72,21 +72,27 @@ void MultiQueryServer::SetDatabase(yacl::ByteContainerView db_bytes) {
   std::vector<uint8_t> zero_bytes(query_options_.seal_options.element_size);
   std::memset(zero_bytes.data(), 0, query_options_.seal_options.element_size);
 
-  for (size_t idx = 0; idx < cuckoo_params_.NumBins(); ++idx) {
-    std::vector<yacl::ByteContainerView> db_vec;
-
-    for (size_t j = 0; j < simple_hash_[idx].size(); ++j) {
-      db_vec.emplace_back(yacl::ByteContainerView(
-          &db_bytes[simple_hash_[idx][j] *
-                    query_options_.seal_options.element_size],
-          query_options_.seal_options.element_size));
-    }
-    for (size_t j = simple_hash_[idx].size(); j < max_bin_item_size_; ++j) {
-      db_vec.emplace_back(yacl::ByteContainerView(zero_bytes));
-    }
-
-    pir_server_[idx]->SetDatabase(db_vec);
-  }
+  // Buckets are encoded and NTT transformed in parallel, each by its own
+  // server.
+  yacl::parallel_for(
+      0, cuckoo_params_.NumBins(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t idx = begin; idx < end; ++idx) {
+          std::vector<yacl::ByteContainerView> db_vec;
+
+          for (size_t j = 0; j < simple_hash_[idx].size(); ++j) {
+            db_vec.emplace_back(yacl::ByteContainerView(
+                &db_bytes[simple_hash_[idx][j] *
+                          query_options_.seal_options.element_size],
+                query_options_.seal_options.element_size));
+          }
+          for (size_t j = simple_hash_[idx].size(); j < max_bin_item_size_;
+               ++j) {
+            db_vec.emplace_back(yacl::ByteContainerView(zero_bytes));
+          }
+
+          pir_server_[idx]->SetDatabase(db_vec);
+        }
+      });
 }
 
 void MultiQueryServer::RecvGaloisKeys(
@@ -97,9 +103,11 @@ void MultiQueryServer::RecvGaloisKeys(
 
   std::string galkey_str(galkey_buffer.size(), '\0');
   std::memcpy(&galkey_str[0], galkey_buffer.data(), galkey_buffer.size());
-  seal::GaloisKeys galkey =
-      pir_server_[0]->DeSerializeSealObject<seal::GaloisKeys>(galkey_str);
-  SetGaloisKeys(galkey);
+  auto galkey = std::make_shared<const seal::GaloisKeys>(
+      pir_server_[0]->DeSerializeSealObject<seal::GaloisKeys>(galkey_str));
+  for (size_t idx = 0; idx < pir_server_.size(); ++idx) {
+    pir_server_[idx]->SetGaloisKeys(galkey);
+  }
 }
 
 void MultiQueryServer::DoMultiPirAnswer(
@@ -114,8 +122,14 @@ void MultiQueryServer::DoMultiPirAnswer(
   YACL_ENFORCE((uint64_t)multi_query_proto.querys().size() ==
                cuckoo_params_.NumBins());
 
-  std::vector<yacl::Buffer> reply_cipher_buffers(
-      multi_query_proto.querys().size());
+  // The answers are allocated up front, so that every bucket fills its own
+  // answer in the parallel loop.
+  SealMultiPirAnswerProto mpir_answer_reply_proto;
+  for (int idx = 0; idx < multi_query_proto.querys().size(); ++idx) {
+    SealPirAnswerProto *answer = mpir_answer_reply_proto.add_answers();
+    answer->set_query_size(0);
+    answer->set_start_pos(0);
+  }
 
   yacl::parallel_for(
       0, multi_query_proto.querys().size(), 1, [&](int64_t begin, int64_t end) {
@@ -125,20 +139,16 @@ void MultiQueryServer::DoMultiPirAnswer(
 
           std::vector<seal::Ciphertext> query_reply =
               pir_server_[idx]->GenerateReply(query_ciphers);
-          reply_cipher_buffers[idx] =
-              pir_server_[idx]->SerializeCiphertexts(query_reply);
+          yacl::Buffer reply_cipher_buffer =
+              pir_server_[idx]->SerializeCiphertexts(
+                  query_reply, query_options_.seal_options.reply_compr_mode);
+          mpir_answer_reply_proto.mutable_answers(idx)
+              ->mutable_answer()
+              ->ParseFromArray(reply_cipher_buffer.data(),
+                               reply_cipher_buffer.size());
         }
       });
 
-  SealMultiPirAnswerProto mpir_answer_reply_proto;
-  for (int idx = 0; idx < multi_query_proto.querys().size(); ++idx) {
-    SealPirAnswerProto *answer = mpir_answer_reply_proto.add_answers();
-    answer->set_query_size(0);
-    answer->set_start_pos(0);
-    answer->mutable_answer()->ParseFromArray(reply_cipher_buffers[idx].data(),
-                                             reply_cipher_buffers[idx].size());
-  }
-
   yacl::Buffer mpir_answer_buffer(mpir_answer_reply_proto.ByteSizeLong());
   mpir_answer_reply_proto.SerializePartialToArray(mpir_answer_buffer.data(),
                                                   mpir_answer_buffer.size());
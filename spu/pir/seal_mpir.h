@@ -92,7 +92,9 @@ class MultiQueryServer : public MultiQuery {
 
     spu::pir::SealPirOptions pir_options{
         query_options_.seal_options.poly_modulus_degree, max_bin_item_size_,
-        query_options_.seal_options.element_size};
+        query_options_.seal_options.element_size, 0,
+        query_options_.seal_options.mod_switch_reply,
+        query_options_.seal_options.reply_compr_mode};
 
     for (size_t idx = 0; idx < cuckoo_params.NumBins(); ++idx) {
       std::shared_ptr<IDbPlaintextStore> plaintext_store =
@@ -110,9 +112,11 @@ class MultiQueryServer : public MultiQuery {
 
   void SetDatabase(yacl::ByteContainerView db_bytes);
 
+  // All buckets share one copy of the keys.
   void SetGaloisKeys(const seal::GaloisKeys &galkey) {
+    auto shared_galkey = std::make_shared<const seal::GaloisKeys>(galkey);
     for (size_t idx = 0; idx < pir_server_.size(); ++idx) {
-      pir_server_[idx]->SetGaloisKeys(galkey);
+      pir_server_[idx]->SetGaloisKeys(shared_galkey);
     }
   }
 
@@ -14,6 +14,7 @@
 
 #include "spu/pir/seal_pir.h"
 
+#include <algorithm>
 #include <cmath>
 #include <utility>
 
@@ -245,12 +246,13 @@ std::vector<seal::Plaintext> SealPir::DeSerializePlaintexts(
 }
 
 yacl::Buffer SealPir::SerializeCiphertexts(
-    const std::vector<seal::Ciphertext> &ciphers) {
+    const std::vector<seal::Ciphertext> &ciphers,
+    seal::compr_mode_type compr_mode) {
   spu::pir::CiphertextsProto ciphers_proto;
 
   for (size_t i = 0; i < ciphers.size(); ++i) {
     std::string cipher_bytes =
-        SerializeSealObject<seal::Ciphertext>(ciphers[i]);
+        SerializeSealObject<seal::Ciphertext>(ciphers[i], compr_mode);
 
     ciphers_proto.add_ciphers(cipher_bytes.data(), cipher_bytes.length());
   }
@@ -397,7 +399,8 @@ void SealPirServer::SetDatabase(
     std::vector<seal::Plaintext> db_vec;
     db_vec.reserve(matrix_plaintexts);
 
-    uint32_t offset = idx * options_.query_size * options_.element_size;
+    uint64_t offset = static_cast<uint64_t>(idx) * options_.query_size *
+                      options_.element_size;
 
     for (uint64_t i = 0; i < plaintext_num; i++) {
       uint64_t process_bytes = 0;
@@ -481,7 +484,8 @@ std::vector<seal::Ciphertext> SealPirServer::ExpandQuery(
     const seal::Ciphertext &encrypted, std::uint32_t m) {
   uint64_t plain_mod = seal_params_->plain_modulus().value();
 
-  seal::GaloisKeys &galkey = galois_key_;
+  YACL_ENFORCE(galois_key_ != nullptr, "GaloisKeys is not set");
+  const seal::GaloisKeys &galkey = *galois_key_;
 
   // Assume that m is a power of 2. If not, round it to the next power of 2.
   uint32_t logm = std::ceil(std::log2(m));
@@ -545,23 +549,25 @@ std::vector<seal::Ciphertext> SealPirServer::ExpandQuery(
   pt1.set_zero();
   pt1[index] = 1;
 
-  for (uint32_t k = 0; k < results.size(); k++) {
-    if (k >= (m - (1 << (logm - 1)))) {  // corner case.
-      evaluator_->multiply_plain(results[k], two,
-                                 results2[k]);  // plain multiplication by 2.
-    } else {
-      seal::Ciphertext c0, c1;
-      seal::Ciphertext t0, t1;
+  yacl::parallel_for(0, results.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t k = begin; k < end; k++) {
+      if (k >= (m - (1 << (logm - 1)))) {  // corner case.
+        evaluator_->multiply_plain(results[k], two,
+                                   results2[k]);  // plain multiplication by 2.
+      } else {
+        seal::Ciphertext c0, c1;
+        seal::Ciphertext t0, t1;
 
-      c0 = results[k];
-      evaluator_->apply_galois(c0, galois_elts[logm - 1], galkey, t0);
-      evaluator_->add(c0, t0, results2[k]);
+        c0 = results[k];
+        evaluator_->apply_galois(c0, galois_elts[logm - 1], galkey, t0);
+        evaluator_->add(c0, t0, results2[k]);
 
-      evaluator_->multiply_plain(c0, pt0, c1);
-      evaluator_->multiply_plain(t0, pt1, t1);
-      evaluator_->add(c1, t1, results2[k + results.size()]);
+        evaluator_->multiply_plain(c0, pt0, c1);
+        evaluator_->multiply_plain(t0, pt1, t1);
+        evaluator_->add(c1, t1, results2[k + results.size()]);
+      }
     }
-  }
+  });
 
   std::vector<seal::Ciphertext>::const_iterator first = results2.begin();
   std::vector<seal::Ciphertext>::const_iterator last = results2.begin() + m;
@@ -586,9 +592,10 @@ std::vector<seal::Ciphertext> SealPirServer::GenerateReply(
     sub_db_index = start_pos / options_.query_size;
   }
 
-  std::vector<seal::Plaintext> db_plaintexts =
+  // the store keeps the NTT form db, which is shared by all queries.
+  std::shared_ptr<const std::vector<seal::Plaintext>> db_plaintexts =
       plaintext_store_->ReadPlaintexts(sub_db_index);
-  std::vector<seal::Plaintext> *cur = &db_plaintexts;
+  const std::vector<seal::Plaintext> *cur = db_plaintexts.get();
 
   std::vector<seal::Plaintext> intermediate_plain;  // decompose....
 
@@ -603,15 +610,20 @@ std::vector<seal::Ciphertext> SealPirServer::GenerateReply(
 
     uint64_t n_i = nvec[i];
 
-    for (uint32_t j = 0; j < query_ciphers[i].size(); j++) {
-      uint64_t total = N;
-      if (j == query_ciphers[i].size() - 1) {
-        total = n_i % N;
-      }
-
-      std::vector<seal::Ciphertext> expanded_query_part =
-          ExpandQuery(query_ciphers[i][j], total);
-
+    // the parts expand concurrently, a single part is parallel by levels.
+    std::vector<std::vector<seal::Ciphertext>> expanded_query_parts(
+        query_ciphers[i].size());
+    yacl::parallel_for(
+        0, query_ciphers[i].size(), 1, [&](int64_t begin, int64_t end) {
+          for (int64_t j = begin; j < end; j++) {
+            uint64_t total = N;
+            if (j == static_cast<int64_t>(query_ciphers[i].size()) - 1) {
+              total = n_i % N;
+            }
+            expanded_query_parts[j] = ExpandQuery(query_ciphers[i][j], total);
+          }
+        });
+    for (auto &expanded_query_part : expanded_query_parts) {
       expanded_query.insert(
           expanded_query.end(),
           std::make_move_iterator(expanded_query_part.begin()),
@@ -646,9 +658,10 @@ std::vector<seal::Ciphertext> SealPirServer::GenerateReply(
 
     // Transform plaintext to NTT. If database is pre-processed, can skip
     if (i > 0) {
-      yacl::parallel_for(0, (*cur).size(), 1, [&](int64_t begin, int64_t end) {
+      yacl::parallel_for(0, intermediate_plain.size(), 1,
+                         [&](int64_t begin, int64_t end) {
         for (uint32_t jj = begin; jj < end; jj++) {
-          evaluator_->transform_to_ntt_inplace((*cur)[jj],
+          evaluator_->transform_to_ntt_inplace(intermediate_plain[jj],
                                                context_->first_parms_id());
         }
       });
@@ -665,27 +678,66 @@ std::vector<seal::Ciphertext> SealPirServer::GenerateReply(
     product /= n_i;
     std::vector<seal::Ciphertext> intermediateCtxts(product);
 
-    yacl::parallel_for(0, product, 1, [&](int64_t begin, int64_t end) {
-      for (int k = begin; k < end; k++) {
-        uint64_t j = 0;
-        while ((*cur)[k + j * product].is_zero()) {
-          j++;
+    // the dot of the expanded query with the db column k, by the rows
+    // [j_begin, j_end), returns false if all of the plaintexts are zero.
+    auto dot_rows = [&](uint64_t k, uint64_t j_begin, uint64_t j_end,
+                        seal::Ciphertext *out) {
+      bool is_empty = true;
+      seal::Ciphertext temp;
+      for (uint64_t j = j_begin; j < j_end; j++) {
+        const auto &plain = (*cur)[k + j * product];
+        if (plain.is_zero()) {
+          continue;
         }
+        if (is_empty) {
+          evaluator_->multiply_plain(expanded_query[j], plain, *out);
+          is_empty = false;
+        } else {
+          evaluator_->multiply_plain(expanded_query[j], plain, temp);
+          evaluator_->add_inplace(*out, temp);  // Adds to first component.
+        }
+      }
+      return !is_empty;
+    };
+
+    // a few columns, e.g. the first dimension of a tall db, do not occupy
+    // all the threads, then the rows of a column are partitioned too.
+    const auto num_threads = static_cast<uint64_t>(yacl::get_num_threads());
+    const uint64_t row_parts =
+        product >= num_threads
+            ? 1
+            : std::min<uint64_t>(n_i, (num_threads + product - 1) / product);
+    const uint64_t rows_per_part = (n_i + row_parts - 1) / row_parts;
+
+    std::vector<seal::Ciphertext> partial_ctxts(product * row_parts);
+    std::vector<uint8_t> partial_valid(product * row_parts, 0);
+    yacl::parallel_for(
+        0, product * row_parts, 1, [&](int64_t begin, int64_t end) {
+          for (int64_t t = begin; t < end; t++) {
+            const uint64_t k = t / row_parts;
+            const uint64_t part = t % row_parts;
+            const uint64_t j_begin = std::min(n_i, part * rows_per_part);
+            const uint64_t j_end = std::min(n_i, j_begin + rows_per_part);
+            partial_valid[t] = dot_rows(k, j_begin, j_end, &partial_ctxts[t]);
+          }
+        });
 
-        evaluator_->multiply_plain(expanded_query[j], (*cur)[k + j * product],
-                                   intermediateCtxts[k]);
-
-        seal::Ciphertext temp;
-        for (j += 1; j < n_i; j++) {
-          if ((*cur)[k + j * product].is_zero()) {
-            SPDLOG_INFO("cur[{}] is zero, k:{}, j:{}", (k + j * product), k, j);
+    yacl::parallel_for(0, product, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; k++) {
+        bool is_empty = true;
+        for (uint64_t part = 0; part < row_parts; part++) {
+          const uint64_t t = k * row_parts + part;
+          if (partial_valid[t] == 0) {
             continue;
           }
-          evaluator_->multiply_plain(expanded_query[j], (*cur)[k + j * product],
-                                     temp);
-          evaluator_->add_inplace(intermediateCtxts[k],
-                                  temp);  // Adds to first component.
+          if (is_empty) {
+            intermediateCtxts[k] = std::move(partial_ctxts[t]);
+            is_empty = false;
+          } else {
+            evaluator_->add_inplace(intermediateCtxts[k], partial_ctxts[t]);
+          }
         }
+        YACL_ENFORCE(!is_empty, "all plaintexts of column {} are zero", k);
       }
     });
 
@@ -697,25 +749,37 @@ std::vector<seal::Ciphertext> SealPirServer::GenerateReply(
         });
 
     if (i == nvec.size() - 1) {
+      if (options_.mod_switch_reply) {
+        yacl::parallel_for(0, intermediateCtxts.size(), 1,
+                           [&](int64_t begin, int64_t end) {
+                             for (int64_t jj = begin; jj < end; jj++) {
+                               evaluator_->mod_switch_to_inplace(
+                                   intermediateCtxts[jj],
+                                   context_->last_parms_id());
+                             }
+                           });
+      }
       return intermediateCtxts;
     } else {
       intermediate_plain.clear();
-      intermediate_plain.reserve(pir_params_.expansion_ratio * product);
+      intermediate_plain.resize(pir_params_.expansion_ratio * product);
       cur = &intermediate_plain;
 
       auto tempplain = seal::util::allocate<seal::Plaintext>(
           pir_params_.expansion_ratio * product, pool, coeff_count);
 
-      for (uint64_t rr = 0; rr < product; rr++) {
-        DecomposeToPlaintextsPtr(
-            intermediateCtxts[rr],
-            tempplain.get() + rr * pir_params_.expansion_ratio, logt);
+      yacl::parallel_for(0, product, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t rr = begin; rr < end; rr++) {
+          DecomposeToPlaintextsPtr(
+              intermediateCtxts[rr],
+              tempplain.get() + rr * pir_params_.expansion_ratio, logt);
 
-        for (uint32_t jj = 0; jj < pir_params_.expansion_ratio; jj++) {
-          auto offset = rr * pir_params_.expansion_ratio + jj;
-          intermediate_plain.emplace_back(tempplain[offset]);
+          for (uint32_t jj = 0; jj < pir_params_.expansion_ratio; jj++) {
+            auto offset = rr * pir_params_.expansion_ratio + jj;
+            intermediate_plain[offset] = tempplain[offset];
+          }
         }
-      }
+      });
       product *= pir_params_.expansion_ratio;  // multiply by expansion rate.
     }
     SPDLOG_INFO("Server: {}-th recursion level finished", (i + 1));
@@ -844,7 +908,8 @@ void SealPirServer::DoPirAnswer(
   std::vector<seal::Ciphertext> reply_ciphers =
       GenerateReply(query_ciphers, query_proto.start_pos());
 
-  yacl::Buffer reply_buffer = SerializeCiphertexts(reply_ciphers);
+  yacl::Buffer reply_buffer =
+      SerializeCiphertexts(reply_ciphers, options_.reply_compr_mode);
   link_ctx->SendAsync(
       link_ctx->NextRank(), reply_buffer,
       fmt::format("send query reply size:{}", reply_buffer.size()));
@@ -17,6 +17,7 @@
 #include <cmath>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "seal/seal.h"
@@ -45,6 +46,13 @@ struct SealPirOptions {
   size_t element_size;
   // number of real query data
   size_t query_size = 0;
+  // server switches the reply ciphertexts to the last coeff modulus before
+  // sending them, which shrinks the reply by the number of coeff moduli of
+  // the first data level. the client decrypts them as is.
+  bool mod_switch_reply = false;
+  // compression of the serialized reply ciphertexts.
+  seal::compr_mode_type reply_compr_mode =
+      seal::Serialization::compr_mode_default;
 };
 
 struct PirParams {
@@ -85,9 +93,11 @@ class SealPir {
   void SetPirParams(size_t element_number, size_t element_size);
 
   template <typename T>
-  std::string SerializeSealObject(const T &object) {
+  std::string SerializeSealObject(
+      const T &object, seal::compr_mode_type compr_mode =
+                           seal::Serialization::compr_mode_default) {
     std::ostringstream output;
-    object.save(output);
+    object.save(output, compr_mode);
     return output.str();
   }
 
@@ -110,7 +120,9 @@ class SealPir {
       const std::string &plaintext_bytes, bool safe_load = false);
 
   yacl::Buffer SerializeCiphertexts(
-      const std::vector<seal::Ciphertext> &ciphers);
+      const std::vector<seal::Ciphertext> &ciphers,
+      seal::compr_mode_type compr_mode =
+          seal::Serialization::compr_mode_default);
 
   std::vector<seal::Ciphertext> DeSerializeCiphertexts(
       const CiphertextsProto &ciphers_proto, bool safe_load = false);
@@ -187,7 +199,15 @@ class SealPirServer : public SealPir {
   void SetDatabase(const std::vector<yacl::ByteContainerView> &db_vec);
 
   // set client GaloisKeys
-  void SetGaloisKeys(const seal::GaloisKeys &galkey) { galois_key_ = galkey; }
+  void SetGaloisKeys(const seal::GaloisKeys &galkey) {
+    galois_key_ = std::make_shared<const seal::GaloisKeys>(galkey);
+  }
+
+  // share one set of client GaloisKeys between servers, e.g. the buckets of
+  // MultiQueryServer.
+  void SetGaloisKeys(std::shared_ptr<const seal::GaloisKeys> galkey) {
+    galois_key_ = std::move(galkey);
+  }
 
   // expand one query Seal:Ciphertext
   std::vector<seal::Ciphertext> ExpandQuery(const seal::Ciphertext &encrypted,
@@ -216,7 +236,7 @@ class SealPirServer : public SealPir {
   std::vector<std::unique_ptr<std::vector<seal::Plaintext>>> db_vec_;
   std::shared_ptr<IDbPlaintextStore> plaintext_store_;
 
-  seal::GaloisKeys galois_key_;
+  std::shared_ptr<const seal::GaloisKeys> galois_key_;
 
   void DecomposeToPlaintextsPtr(const seal::Ciphertext &encrypted,
                                 seal::Plaintext *plain_ptr, int logt);
@@ -0,0 +1,84 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+#include "spu/pir/seal_pir.h"
+
+namespace {
+
+constexpr size_t kPolyDegree = 8192;
+constexpr size_t kElementSize = 288;
+
+std::vector<uint8_t> GenerateDbData(size_t element_number) {
+  std::vector<uint8_t> db_data(element_number * kElementSize);
+  std::mt19937 gen(0);
+  for (auto &byte : db_data) {
+    byte = gen() % 256;
+  }
+  return db_data;
+}
+
+}  // namespace
+
+// The server time of a single query, i.e. ExpandQuery and GenerateReply.
+// range(0): elements of the db, range(1): threads of the server.
+static void BM_SealPirReply(benchmark::State &state) {
+  const size_t element_number = state.range(0);
+  yacl::set_num_threads(state.range(1));
+
+  std::vector<uint8_t> db_data = GenerateDbData(element_number);
+  spu::pir::SealPirOptions options{kPolyDegree, element_number, kElementSize};
+  spu::pir::SealPirClient client(options);
+  spu::pir::SealPirServer server(
+      options, std::make_shared<spu::pir::MemoryDbPlaintextStore>());
+  server.SetDatabase(std::make_shared<spu::pir::MemoryDbElementProvider>(
+      db_data, kElementSize));
+  server.SetGaloisKeys(client.GenerateGaloisKeys());
+
+  std::mt19937 gen(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t index = gen() % element_number;
+    auto query = client.GenerateQuery(index);
+    state.ResumeTiming();
+
+    auto reply = server.GenerateReply(query);
+
+    state.PauseTiming();
+    std::vector<uint8_t> plaintext_bytes =
+        client.PlaintextToBytes(client.DecodeReply(reply));
+    const size_t offset = client.GetQueryOffset(index);
+    YACL_ENFORCE(std::memcmp(&plaintext_bytes[offset * kElementSize],
+                             &db_data[index * kElementSize],
+                             kElementSize) == 0);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// [64k, 1m] elements x [1, 2, 4, 8, 16] threads, ms per query.
+BENCHMARK(BM_SealPirReply)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgsProduct({{64 << 10, 1 << 20}, {1, 2, 4, 8, 16}});
+
+BENCHMARK_MAIN();
@@ -15,6 +15,7 @@
 #include "spu/pir/seal_pir.h"
 
 #include <chrono>
+#include <filesystem>
 #include <memory>
 #include <random>
 
@@ -134,4 +135,93 @@ INSTANTIATE_TEST_SUITE_P(
                     TestParams{3000, 288, 1000})  //
 );
 
+#ifndef DEC_DEBUG_
+TEST(SealPirReplyTest, ModSwitch) {
+  size_t n = 8192;
+  TestParams params{3000};
+  std::vector<uint8_t> db_data = GenerateDbData(params);
+
+  spu::pir::SealPirOptions options{n, params.element_number,
+                                   params.element_size, params.query_size};
+  spu::pir::SealPirClient client(options);
+  seal::GaloisKeys galkey = client.GenerateGaloisKeys();
+
+  spu::pir::SealPirOptions switch_options = options;
+  switch_options.mod_switch_reply = true;
+
+  std::vector<size_t> reply_sizes;
+  for (const auto &server_options : {options, switch_options}) {
+    spu::pir::SealPirServer server(server_options,
+                                   std::make_shared<MemoryDbPlaintextStore>());
+    server.SetDatabase(std::make_shared<MemoryDbElementProvider>(
+        db_data, params.element_size));
+    server.SetGaloisKeys(galkey);
+
+    size_t index = 2999;
+    std::vector<seal::Ciphertext> reply =
+        server.GenerateReply(client.GenerateQuery(index));
+    reply_sizes.push_back(
+        server.SerializeCiphertexts(reply, server_options.reply_compr_mode)
+            .size());
+
+    std::vector<uint8_t> plaintext_bytes =
+        client.PlaintextToBytes(client.DecodeReply(reply));
+    size_t offset = client.GetQueryOffset(index);
+    EXPECT_EQ(std::memcmp(&plaintext_bytes[offset * params.element_size],
+                          &db_data[index * params.element_size],
+                          params.element_size),
+              0);
+  }
+
+  SPDLOG_INFO("reply size: {}, mod switched: {}", reply_sizes[0],
+              reply_sizes[1]);
+  EXPECT_LT(reply_sizes[1] * 2, reply_sizes[0]);
+}
+
+TEST(SealPirFileStoreTest, Works) {
+  size_t n = 8192;
+  TestParams params{1000};
+  auto ctxs = yacl::link::test::SetupWorld(2);
+
+  std::vector<uint8_t> db_data = GenerateDbData(params);
+  spu::pir::SealPirOptions options{n, params.element_number,
+                                   params.element_size, params.query_size};
+  spu::pir::SealPirClient client(options);
+
+  auto dir = std::filesystem::temp_directory_path() /
+             fmt::format("seal_pir_db_{}", std::random_device()());
+  {
+    // setup the db from elements into the file store.
+    spu::pir::SealPirServer server(
+        options, std::make_shared<FileDbPlaintextStore>(dir.string()));
+    server.SetDatabase(std::make_shared<MemoryDbElementProvider>(
+        db_data, params.element_size));
+  }
+
+  // a new server loads the preprocessed db without SetDatabase.
+  auto plaintext_store = std::make_shared<FileDbPlaintextStore>(dir.string());
+  EXPECT_GT(plaintext_store->GetSubDbNumber(), 0);
+  plaintext_store->LoadAll();
+  spu::pir::SealPirServer server(options, plaintext_store);
+  server.SetGaloisKeys(client.GenerateGaloisKeys());
+
+  // the db is not consumed by a query.
+  for (size_t index : {size_t(3), params.element_number - 1}) {
+    std::future<std::vector<uint8_t>> pir_client_func =
+        std::async([&] { return client.DoPirQuery(ctxs[0], index); });
+    std::future<void> pir_service_func =
+        std::async([&] { return server.DoPirAnswer(ctxs[1]); });
+
+    pir_service_func.get();
+    std::vector<uint8_t> query_reply_bytes = pir_client_func.get();
+    EXPECT_EQ(std::memcmp(query_reply_bytes.data(),
+                          &db_data[index * params.element_size],
+                          params.element_size),
+              0);
+  }
+
+  std::filesystem::remove_all(dir);
+}
+#endif
+
 }  // namespace spu::pir
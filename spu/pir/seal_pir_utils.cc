@@ -14,11 +14,49 @@
 
 #include "spu/pir/seal_pir_utils.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
 #include "spdlog/spdlog.h"
 #include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
 
 namespace spu::pir {
 
+namespace {
+
+// A shard is this header followed by plaintext records of the same size,
+// each of parms_id and then coeff_count coefficients.
+constexpr char kShardMagic[8] = {'S', 'P', 'U', 'P', 'I', 'R', 'D', 'B'};
+constexpr uint32_t kShardVersion = 1;
+
+struct ShardHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+constexpr size_t kParmsIdSize = sizeof(seal::parms_id_type);
+
+void WritePlaintext(std::ofstream* out, const seal::Plaintext& plaintext) {
+  uint64_t coeff_count = plaintext.coeff_count();
+  out->write(reinterpret_cast<const char*>(plaintext.parms_id().data()),
+             kParmsIdSize);
+  out->write(reinterpret_cast<const char*>(&coeff_count), sizeof(coeff_count));
+  out->write(reinterpret_cast<const char*>(plaintext.data()),
+             coeff_count * sizeof(uint64_t));
+}
+
+}  // namespace
+
 std::vector<uint8_t> MemoryDbElementProvider::ReadElement(size_t index) {
   YACL_ENFORCE(index < items_.size());
 
@@ -40,23 +78,171 @@ std::vector<uint8_t> MemoryDbElementProvider::ReadElement(size_t index,
 
 void MemoryDbPlaintextStore::SetSubDbNumber(size_t sub_db_num) {
   db_vec_.resize(sub_db_num);
+  for (auto& sub_db : db_vec_) {
+    sub_db = std::make_shared<std::vector<seal::Plaintext>>();
+  }
 }
 
 void MemoryDbPlaintextStore::SavePlaintext(const seal::Plaintext& plaintxt,
                                            size_t sub_db_index) {
-  db_vec_[sub_db_index].push_back(plaintxt);
+  db_vec_[sub_db_index]->push_back(plaintxt);
 }
 
 void MemoryDbPlaintextStore::SavePlaintexts(
     const std::vector<seal::Plaintext>& plaintexts, size_t sub_db_index) {
   for (size_t idx = 0; idx < plaintexts.size(); ++idx) {
-    db_vec_[sub_db_index].push_back(plaintexts[idx]);
+    db_vec_[sub_db_index]->push_back(plaintexts[idx]);
+  }
+}
+
+std::shared_ptr<const std::vector<seal::Plaintext>>
+MemoryDbPlaintextStore::ReadPlaintexts(size_t sub_db_index) {
+  YACL_ENFORCE(sub_db_index < db_vec_.size());
+  return db_vec_[sub_db_index];
+}
+
+FileDbPlaintextStore::FileDbPlaintextStore(const std::string& dir)
+    : dir_(dir) {
+  std::filesystem::create_directories(dir_);
+  // open the shards already in dir.
+  while (std::filesystem::exists(GetShardPath(sub_db_num_))) {
+    sub_db_num_++;
+  }
+  loaded_.resize(sub_db_num_);
+}
+
+std::string FileDbPlaintextStore::GetShardPath(size_t sub_db_index) const {
+  return (std::filesystem::path(dir_) /
+          fmt::format("sub_db_{}.bin", sub_db_index))
+      .string();
+}
+
+void FileDbPlaintextStore::SetSubDbNumber(size_t sub_db_num) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t idx = sub_db_num; idx < sub_db_num_; ++idx) {
+    std::filesystem::remove(GetShardPath(idx));
+  }
+  sub_db_num_ = sub_db_num;
+  loaded_.assign(sub_db_num_, nullptr);
+
+  ShardHeader header{};
+  std::memcpy(header.magic, kShardMagic, sizeof(kShardMagic));
+  header.version = kShardVersion;
+  for (size_t idx = 0; idx < sub_db_num_; ++idx) {
+    std::ofstream out(GetShardPath(idx), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    YACL_ENFORCE(!out.fail(), "cannot write {}", GetShardPath(idx));
   }
 }
 
-std::vector<seal::Plaintext> MemoryDbPlaintextStore::ReadPlaintexts(
-    size_t sub_db_index) {
-  return std::move(db_vec_[sub_db_index]);
+void FileDbPlaintextStore::SavePlaintext(const seal::Plaintext& plaintext,
+                                         size_t sub_db_index) {
+  SavePlaintexts({plaintext}, sub_db_index);
+}
+
+void FileDbPlaintextStore::SavePlaintexts(
+    const std::vector<seal::Plaintext>& plaintexts, size_t sub_db_index) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  YACL_ENFORCE(sub_db_index < sub_db_num_, "sub db {} out of range {}",
+               sub_db_index, sub_db_num_);
+
+  std::ofstream out(GetShardPath(sub_db_index),
+                    std::ios::binary | std::ios::app);
+  for (const auto& plaintext : plaintexts) {
+    WritePlaintext(&out, plaintext);
+  }
+  out.close();
+  YACL_ENFORCE(!out.fail(), "cannot write {}", GetShardPath(sub_db_index));
+  loaded_[sub_db_index] = nullptr;
+}
+
+std::shared_ptr<const std::vector<seal::Plaintext>>
+FileDbPlaintextStore::ReadPlaintexts(size_t sub_db_index) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    YACL_ENFORCE(sub_db_index < sub_db_num_, "sub db {} out of range {}",
+                 sub_db_index, sub_db_num_);
+    if (loaded_[sub_db_index] != nullptr) {
+      return loaded_[sub_db_index];
+    }
+  }
+
+  // concurrent readers of a cold shard may both load it, the first one wins.
+  auto plaintexts = LoadShard(sub_db_index);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (loaded_[sub_db_index] == nullptr) {
+    loaded_[sub_db_index] = std::move(plaintexts);
+  }
+  return loaded_[sub_db_index];
+}
+
+void FileDbPlaintextStore::LoadAll() {
+  yacl::parallel_for(0, GetSubDbNumber(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      ReadPlaintexts(idx);
+    }
+  });
+}
+
+std::shared_ptr<std::vector<seal::Plaintext>> FileDbPlaintextStore::LoadShard(
+    size_t sub_db_index) const {
+  std::string path = GetShardPath(sub_db_index);
+  int fd = open(path.c_str(), O_RDONLY);
+  YACL_ENFORCE(fd >= 0, "cannot open {}, errno={}", path, errno);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    YACL_THROW("cannot stat {}, errno={}", path, errno);
+  }
+  size_t size = st.st_size;
+  YACL_ENFORCE(size >= sizeof(ShardHeader), "truncated shard {}", path);
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  YACL_ENFORCE(addr != MAP_FAILED, "cannot mmap {}, size={}, errno={}", path,
+               size, errno);
+  std::unique_ptr<void, std::function<void(void*)>> mapping(
+      addr, [size](void* ptr) { munmap(ptr, size); });
+  const auto* data = static_cast<const uint8_t*>(addr);
+
+  ShardHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  YACL_ENFORCE(std::memcmp(header.magic, kShardMagic, sizeof(kShardMagic)) == 0,
+               "{} is not a pir db shard", path);
+  YACL_ENFORCE(header.version == kShardVersion,
+               "unsupported pir db shard version {} of {}", header.version,
+               path);
+
+  auto plaintexts = std::make_shared<std::vector<seal::Plaintext>>();
+  size_t body_size = size - sizeof(ShardHeader);
+  if (body_size == 0) {
+    return plaintexts;
+  }
+  data += sizeof(ShardHeader);
+
+  uint64_t coeff_count;
+  YACL_ENFORCE(body_size >= kParmsIdSize + sizeof(coeff_count),
+               "truncated shard {}", path);
+  std::memcpy(&coeff_count, data + kParmsIdSize, sizeof(coeff_count));
+  size_t record_size =
+      kParmsIdSize + sizeof(coeff_count) + coeff_count * sizeof(uint64_t);
+  YACL_ENFORCE(body_size % record_size == 0, "truncated shard {}", path);
+
+  plaintexts->resize(body_size / record_size);
+  yacl::parallel_for(
+      0, plaintexts->size(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t idx = begin; idx < end; ++idx) {
+          const uint8_t* record = data + idx * record_size;
+          seal::Plaintext& plaintext = (*plaintexts)[idx];
+          // resize before setting parms_id, a NTT form plaintext could not be
+          // resized.
+          plaintext.resize(coeff_count);
+          std::memcpy(plaintext.data(), record + kParmsIdSize + sizeof(uint64_t),
+                      coeff_count * sizeof(uint64_t));
+          std::memcpy(plaintext.parms_id().data(), record, kParmsIdSize);
+        }
+      });
+  return plaintexts;
 }
 
 }  // namespace spu::pir
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -47,7 +49,11 @@ class IDbPlaintextStore {
 
   virtual void SavePlaintexts(const std::vector<seal::Plaintext>& plaintext,
                               size_t sub_db_index) = 0;
-  virtual std::vector<seal::Plaintext> ReadPlaintexts(size_t sub_db_index) = 0;
+
+  // The store keeps the plaintexts, so every query reads the same ones
+  // without a copy.
+  virtual std::shared_ptr<const std::vector<seal::Plaintext>> ReadPlaintexts(
+      size_t sub_db_index) = 0;
 };
 
 class MemoryDbElementProvider : public IDbElementProvider {
@@ -80,10 +86,51 @@ class MemoryDbPlaintextStore : public IDbPlaintextStore {
 
   void SavePlaintexts(const std::vector<seal::Plaintext>& plaintexts,
                       size_t sub_db_index) override;
-  std::vector<seal::Plaintext> ReadPlaintexts(size_t sub_db_index) override;
+  std::shared_ptr<const std::vector<seal::Plaintext>> ReadPlaintexts(
+      size_t sub_db_index) override;
 
  private:
-  std::vector<std::vector<seal::Plaintext>> db_vec_;
+  std::vector<std::shared_ptr<std::vector<seal::Plaintext>>> db_vec_;
+};
+
+// Store the plaintexts of every sub db in its own shard file under `dir`,
+// as raw coefficients together with their parms_id, so that the NTT form
+// plaintexts written by SealPirServer::SetDatabase are loaded back as is.
+//
+// A store opened on a dir of existing shards serves queries without
+// SetDatabase. Shards are mapped and parsed in parallel when first read, and
+// `LoadAll` loads all of them in parallel ahead of the first query.
+class FileDbPlaintextStore : public IDbPlaintextStore {
+ public:
+  explicit FileDbPlaintextStore(const std::string& dir);
+
+  void SetSubDbNumber(size_t sub_db_num) override;
+
+  void SavePlaintext(const seal::Plaintext& plaintext,
+                     size_t sub_db_index) override;
+
+  void SavePlaintexts(const std::vector<seal::Plaintext>& plaintexts,
+                      size_t sub_db_index) override;
+
+  // Thread safe.
+  std::shared_ptr<const std::vector<seal::Plaintext>> ReadPlaintexts(
+      size_t sub_db_index) override;
+
+  void LoadAll();
+
+  size_t GetSubDbNumber() const { return sub_db_num_; }
+
+  std::string GetShardPath(size_t sub_db_index) const;
+
+ private:
+  std::shared_ptr<std::vector<seal::Plaintext>> LoadShard(
+      size_t sub_db_index) const;
+
+  const std::string dir_;
+  size_t sub_db_num_ = 0;
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<const std::vector<seal::Plaintext>>> loaded_;
 };
 
 }  // namespace spu::pir
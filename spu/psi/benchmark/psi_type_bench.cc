@@ -0,0 +1,169 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compare every PsiType of MemoryPsi on the same generated datasets.
+//
+// Arguments of a benchmark are (log2 of items, overlap percent, ratio), rank
+// 0 is the receiver of numel / ratio items, the others have numel items, and
+// all parties share overlap percent of the receiver items. Reported counters
+// are the bytes sent by all parties and the peak RSS of the run.
+//
+// Parties run in process over memory links, without a network profile. The
+// NetworkEmulator of spu/mpc/util delays the receives of the mpc
+// Communicator, while psi sends and receives on the yacl links directly, so
+// the LAN and WAN profiles do not apply here. To bench under a network
+// profile, run mparty_bench over brpc links shaped by the OS instead.
+//
+// e.g.
+// bazel run -c opt //spu/psi/benchmark:psi_type_bench --
+//     --benchmark_filter='KKRT_PSI_2PC/log2:20/.*'
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "benchmark/benchmark.h"
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+#include "yacl/link/test_util.h"
+
+#include "spu/psi/memory_psi.h"
+#include "spu/psi/utils/test_utils.h"
+
+namespace spu::psi::bench {
+namespace {
+
+struct PsiTypeSetup {
+  PsiType psi_type;
+  size_t world_size;
+};
+
+const std::vector<PsiTypeSetup> kPsiTypes = {
+    {PsiType::ECDH_PSI_2PC, 2}, {PsiType::KKRT_PSI_2PC, 2},
+    {PsiType::BC22_PSI_2PC, 2}, {PsiType::ECDH_PSI_3PC, 3},
+    {PsiType::ECDH_PSI_NPC, 3}, {PsiType::KKRT_PSI_NPC, 3},
+};
+
+std::vector<std::vector<std::string>> CreateDataset(size_t world_size,
+                                                    size_t numel,
+                                                    size_t overlap,
+                                                    size_t ratio) {
+  const size_t receiver_size = numel / ratio;
+  const size_t joined_size = receiver_size * overlap / 100;
+
+  std::vector<std::vector<std::string>> items(world_size);
+  for (size_t rank = 0; rank < world_size; rank++) {
+    const size_t size = rank == 0 ? receiver_size : numel;
+    items[rank] = psi::test::CreateRangeItems(0, joined_size);
+    auto own_items =
+        psi::test::CreateRangeItems((rank + 1) << 40, size - joined_size);
+    items[rank].insert(items[rank].end(), own_items.begin(), own_items.end());
+  }
+  return items;
+}
+
+// Reset the peak RSS of the process, linux only.
+void ResetPeakRss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+// The peak RSS of the process in bytes, or 0 if unknown.
+double PeakRssBytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (absl::StartsWith(line, "VmHWM:")) {
+      return std::stod(line.substr(6)) * 1024;
+    }
+  }
+  return 0;
+}
+
+void BM_MemoryPsi(benchmark::State& state, const PsiTypeSetup& setup) {
+  const size_t numel = size_t(1) << state.range(0);
+  const size_t overlap = state.range(1);
+  const size_t ratio = state.range(2);
+
+  double sent_bytes = 0;
+  double peak_rss = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto items = CreateDataset(setup.world_size, numel, overlap, ratio);
+    auto ctxs = yacl::link::test::SetupWorld(setup.world_size);
+    ResetPeakRss();
+    state.ResumeTiming();
+
+    std::vector<std::future<std::vector<std::string>>> futures;
+    for (size_t rank = 0; rank < setup.world_size; rank++) {
+      futures.push_back(std::async([&, rank] {
+        MemoryPsiConfig config;
+        config.set_psi_type(setup.psi_type);
+        config.set_receiver_rank(0);
+        config.set_broadcast_result(false);
+        return MemoryPsi(config, ctxs[rank]).Run(items[rank]);
+      }));
+    }
+    std::vector<std::string> joined = futures[0].get();
+    for (size_t rank = 1; rank < setup.world_size; rank++) {
+      futures[rank].get();
+    }
+
+    state.PauseTiming();
+    YACL_ENFORCE(joined.size() == numel / ratio * overlap / 100,
+                 "{} joined {} items", PsiType_Name(setup.psi_type),
+                 joined.size());
+    for (const auto& ctx : ctxs) {
+      sent_bytes += ctx->GetStats()->sent_bytes;
+    }
+    peak_rss = std::max(peak_rss, PeakRssBytes());
+    state.ResumeTiming();
+  }
+
+  state.counters["sent_bytes"] =
+      benchmark::Counter(sent_bytes, benchmark::Counter::kAvgIterations,
+                         benchmark::Counter::kIs1024);
+  state.counters["peak_rss"] = benchmark::Counter(
+      peak_rss, benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+void DefaultPsiTypeArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"log2", "overlap", "ratio"})
+      ->ArgsProduct({benchmark::CreateDenseRange(16, 28, 4), {10, 50, 90},
+                     {1, 16}})
+      ->Iterations(1)
+      ->Unit(benchmark::kSecond);
+}
+
+}  // namespace
+}  // namespace spu::psi::bench
+
+int main(int argc, char** argv) {
+  spdlog::set_level(spdlog::level::off);  // turn off spdlog
+
+  for (const auto& setup : spu::psi::bench::kPsiTypes) {
+    benchmark::RegisterBenchmark(
+        spu::psi::PsiType_Name(setup.psi_type).c_str(),
+        spu::psi::bench::BM_MemoryPsi, setup)
+        ->Apply(spu::psi::bench::DefaultPsiTypeArguments);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -14,8 +14,12 @@
 
 #include "spu/psi/bucket_psi.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <future>
+#include <iterator>
 #include <numeric>
+#include <thread>
 #include <type_traits>
 
 #include "absl/time/clock.h"
@@ -33,6 +37,7 @@
 #include "spu/psi/utils/cipher_store.h"
 #include "spu/psi/utils/csv_checker.h"
 #include "spu/psi/utils/csv_header_analyzer.h"
+#include "spu/psi/utils/psi_selector.h"
 #include "spu/psi/utils/serialize.h"
 #include "spu/psi/utils/utils.h"
 
@@ -42,6 +47,9 @@ namespace spu::psi {
 
 namespace {
 
+// the upper bound of the tuned ecdh psi batch size.
+constexpr size_t kMaxAutoBatchSize = 1 << 18;
+
 constexpr size_t kCsvHeaderLineCount = 1;
 
 constexpr size_t kBucketSize = 1 << 20;
@@ -104,40 +112,44 @@ PsiResultReport BucketPsi::Run() {
     digest_equal = HashListEqualTest(digest_buf_list);
   }
 
-  // run psi
-  std::vector<uint64_t> indices;
+  // run psi, the indices are sorted out of core.
+  auto out_dir =
+      std::filesystem::path(config_.output_params().path()).parent_path();
+  ExternalIndexSorter indices(out_dir.string());
   if (!digest_equal) {
-    indices = RunPsi(checker->data_count());
+    RunPsi(checker->data_count(), &indices);
   } else {
     SPDLOG_INFO("Skip doing psi, because dataset has been aligned!");
-    indices.resize(checker->data_count());
-    std::iota(indices.begin(), indices.end(), 0);
+  }
+  const size_t intersection_count =
+      digest_equal ? checker->data_count() : indices.size();
+  report.set_batch_size(psi_batch_size_);
+  report.set_psi_type(config_.psi_type());
+  if (config_.psi_type() == PsiType::ECDH_PSI_2PC) {
+    report.set_curve_type(config_.curve_type());
   }
 
   if (static_cast<size_t>(config_.receiver_rank()) != lctx_->Rank() &&
       config_.broadcast_result() == false) {
     report.set_intersection_count(-1);
+    if (checkpoint_ != nullptr) {
+      checkpoint_->Clear();
+    }
     // no generate output file;
     return report;
   } else {
-    report.set_intersection_count(indices.size());
+    report.set_intersection_count(intersection_count);
   }
 
   // filter dataset
   SPDLOG_INFO("Begin post filtering, indices.size={}, should_sort={}",
-              indices.size(), config_.output_params().need_sort());
-  // sort indices
-  std::sort(indices.begin(), indices.end());
+              intersection_count, config_.output_params().need_sort());
   // use tmp file to avoid `shell Injection`
   auto timestamp_str = std::to_string(absl::ToUnixNanos(absl::Now()));
   auto tmp_sort_in_file =
-      std::filesystem::path(config_.output_params().path())
-          .parent_path()
-          .append(fmt::format("tmp-sort-in-{}", timestamp_str));
+      out_dir / fmt::format("tmp-sort-in-{}", timestamp_str);
   auto tmp_sort_out_file =
-      std::filesystem::path(config_.output_params().path())
-          .parent_path()
-          .append(fmt::format("tmp-sort-out-{}", timestamp_str));
+      out_dir / fmt::format("tmp-sort-out-{}", timestamp_str);
   // register remove of temp file.
   ON_SCOPE_EXIT([&] {
     std::error_code ec;
@@ -152,19 +164,45 @@ PsiResultReport BucketPsi::Run() {
                   tmp_sort_in_file.c_str(), ec.message());
     }
   });
-  FilterFileByIndices(config_.input_params().path(), tmp_sort_in_file, indices,
-                      kCsvHeaderLineCount);
-  if (config_.output_params().need_sort() && !digest_equal) {
-    MultiKeySort(tmp_sort_in_file, tmp_sort_out_file, selected_fields_);
-
-    std::filesystem::rename(tmp_sort_out_file, config_.output_params().path());
+  // one sequential pass over the input with the merged indices.
+  std::function<bool(uint64_t*)> next_index;
+  std::unique_ptr<ExternalIndexSorter::Reader> reader;
+  if (digest_equal) {
+    uint64_t next = 0;
+    next_index = [&, next](uint64_t* index) mutable {
+      if (next == checker->data_count()) {
+        return false;
+      }
+      *index = next++;
+      return true;
+    };
   } else {
-    std::filesystem::rename(tmp_sort_in_file, config_.output_params().path());
+    reader = indices.Finalize();
+    next_index = [&](uint64_t* index) { return reader->Next(index); };
   }
+  // the lines are sorted while filtered, in one pass.
+  const bool need_sort = config_.output_params().need_sort() &&
+                         !digest_equal && !config_.input_params().presorted();
+  size_t target_count =
+      need_sort ? FilterAndSortFileByIndices(
+                      config_.input_params().path(), tmp_sort_out_file,
+                      next_index, selected_fields_, kCsvHeaderLineCount)
+                : FilterFileByIndices(config_.input_params().path(),
+                                      tmp_sort_in_file, next_index,
+                                      kCsvHeaderLineCount);
+  YACL_ENFORCE(target_count == intersection_count,
+               "logstic error, indices.size={}, target_count={}",
+               intersection_count, target_count);
+  std::filesystem::rename(need_sort ? tmp_sort_out_file : tmp_sort_in_file,
+                          config_.output_params().path());
 
   SPDLOG_INFO("End post filtering, in={}, out={}",
               config_.input_params().path(), config_.output_params().path());
 
+  if (checkpoint_ != nullptr) {
+    checkpoint_->Clear();
+  }
+
   return report;
 }
 
@@ -176,12 +214,19 @@ void BucketPsi::Init() {
   }
   SPDLOG_INFO("bucket size set to {}", config_.bucket_size());
 
-  MemoryPsiConfig config;
-  config.set_psi_type(config_.psi_type());
-  config.set_curve_type(config_.curve_type());
-  config.set_receiver_rank(config_.receiver_rank());
-  config.set_broadcast_result(config_.broadcast_result());
-  mem_psi_ = std::make_unique<MemoryPsi>(config, lctx_);
+  mem_psi_config_.set_psi_type(config_.psi_type());
+  mem_psi_config_.set_curve_type(config_.curve_type());
+  mem_psi_config_.set_receiver_rank(config_.receiver_rank());
+  mem_psi_config_.set_broadcast_result(config_.broadcast_result());
+  // the memory psi of AUTO_PSI_2PC is created once selected.
+  if (config_.psi_type() == PsiType::AUTO_PSI_2PC) {
+    YACL_ENFORCE(!ic_mode_, "IC mode only support ECDH_PSI_2PC");
+    YACL_ENFORCE(lctx_->WorldSize() == 2,
+                 "psi_type:{}, only two parties supported, got {}",
+                 config_.psi_type(), lctx_->WorldSize());
+  } else {
+    mem_psi_ = std::make_unique<MemoryPsi>(mem_psi_config_, lctx_);
+  }
 
   // create output folder.
   auto out_dir_path =
@@ -357,7 +402,57 @@ void BucketPsi::Handshake(uint64_t self_items_count) {
   }
 }
 
-std::vector<uint64_t> BucketPsi::RunPsi(uint64_t self_items_count) {
+void BucketPsi::SelectPsiType(uint64_t self_items_count) {
+  std::vector<size_t> items_size_list =
+      AllGatherItemsSize(lctx_, self_items_count);
+
+  // the slower party bounds the threads, and FourQ runs on both or none.
+  bool fourq_supported = true;
+  try {
+    CreateEccCryptor(CurveType::CURVE_FOURQ);
+  } catch (const yacl::Exception&) {
+    fourq_supported = false;
+  }
+  const size_t self_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  std::vector<size_t> capability_list =
+      AllGatherItemsSize(lctx_, self_threads * 2 + (fourq_supported ? 1 : 0));
+
+  PsiSelectOptions options;
+  options.receiver_size = items_size_list[config_.receiver_rank()];
+  options.sender_size = items_size_list[1 - config_.receiver_rank()];
+  options.link = ProbeLink(lctx_);
+  options.num_threads = self_threads;
+  options.fourq_supported = fourq_supported;
+  for (size_t capability : capability_list) {
+    options.num_threads = std::min(options.num_threads, capability / 2);
+    options.fourq_supported &= (capability % 2) == 1;
+  }
+  options.bucket_size = config_.bucket_size();
+
+  PsiSelection selection = SelectPsi(options);
+  SPDLOG_INFO(
+      "psi protocol={} selected {}, curve={}, expected_seconds={}, "
+      "rtt_seconds={}, bytes_per_second={}, threads={}",
+      config_.psi_type(), PsiType_Name(selection.psi_type),
+      CurveType_Name(selection.curve_type), selection.expected_seconds,
+      options.link.rtt_seconds, options.link.bytes_per_second,
+      options.num_threads);
+
+  config_.set_psi_type(selection.psi_type);
+  if (selection.psi_type == PsiType::ECDH_PSI_2PC) {
+    config_.set_curve_type(selection.curve_type);
+  }
+  mem_psi_config_.set_psi_type(config_.psi_type());
+  mem_psi_config_.set_curve_type(config_.curve_type());
+  mem_psi_ = std::make_unique<MemoryPsi>(mem_psi_config_, lctx_);
+}
+
+void BucketPsi::RunPsi(uint64_t self_items_count,
+                       ExternalIndexSorter* indices) {
+  if (config_.psi_type() == PsiType::AUTO_PSI_2PC) {
+    SelectPsiType(self_items_count);
+  }
+
   SPDLOG_INFO("Run psi protocol={}, self_items_count={}", config_.psi_type(),
               self_items_count);
 
@@ -377,25 +472,40 @@ std::vector<uint64_t> BucketPsi::RunPsi(uint64_t self_items_count) {
       psi_options.target_rank = yacl::link::kAllRank;
     }
     psi_options.ic_mode = ic_mode_;
+    if (config_.auto_batch_size()) {
+      psi_options.batch_size_tuner = std::make_shared<BatchSizeTuner>(
+          kEcdhPsiBatchSize, kMaxAutoBatchSize);
+    }
 
-    auto batch_provider = std::make_shared<CsvBatchProvider>(
-        config_.input_params().path(), selected_fields_);
-    auto cipher_store = std::make_shared<DiskCipherStore>(
-        std::filesystem::path(config_.output_params().path()).parent_path(),
-        64);
+    // parse the csv ahead of the masking.
+    auto batch_provider = std::make_shared<PrefetchBatchProvider>(
+        std::make_shared<CsvBatchProvider>(config_.input_params().path(),
+                                           selected_fields_),
+        psi_options.batch_size);
+    const auto cache_dir =
+        std::filesystem::path(config_.output_params().path()).parent_path();
 
     // Launch ECDH-PSI core.
-    RunEcdhPsi(psi_options, batch_provider, cipher_store);
-
-    return cipher_store->FinalizeAndComputeIndices();
+    if (config_.input_params().presorted()) {
+      auto cipher_store = std::make_shared<SortedCipherStore>(
+          cache_dir, psi_options.dual_mask_size);
+      RunEcdhPsi(psi_options, batch_provider, cipher_store);
+      cipher_store->FinalizeAndComputeIndices(indices);
+    } else {
+      auto cipher_store = std::make_shared<DiskCipherStore>(cache_dir, 64);
+      RunEcdhPsi(psi_options, batch_provider, cipher_store);
+      cipher_store->FinalizeAndComputeIndices(indices);
+    }
+    psi_batch_size_ = psi_options.batch_size_tuner != nullptr
+                          ? psi_options.batch_size_tuner->batch_size()
+                          : psi_options.batch_size;
   } else {
-    return RunBucketPsi(self_items_count);
+    RunBucketPsi(self_items_count, indices);
   }
 }
 
-std::vector<uint64_t> BucketPsi::RunBucketPsi(uint64_t self_items_count) {
-  std::vector<uint64_t> ret;
-
+void BucketPsi::RunBucketPsi(uint64_t self_items_count,
+                             ExternalIndexSorter* indices) {
   std::vector<size_t> items_size_list =
       AllGatherItemsSize(lctx_, self_items_count);
 
@@ -417,7 +527,7 @@ std::vector<uint64_t> BucketPsi::RunBucketPsi(uint64_t self_items_count) {
   // one party item_size is 0, no need to do intersection
   if (min_item_size == 0) {
     SPDLOG_INFO("psi protocol={}, min_item_size=0", config_.psi_type());
-    return ret;
+    return;
   }
 
   SPDLOG_INFO("psi protocol={}, bucket_count={}", config_.psi_type(),
@@ -428,29 +538,130 @@ std::vector<uint64_t> BucketPsi::RunBucketPsi(uint64_t self_items_count) {
       config_.input_params().path(), selected_fields_,
       std::filesystem::path(config_.output_params().path()).parent_path(),
       max_bucket_count);
-  for (size_t bucket_idx = 0; bucket_idx < bucket_store->BucketNum();
-       bucket_idx++) {
-    auto bucket_items_list = bucket_store->LoadBucketItems(bucket_idx);
 
-    SPDLOG_INFO("run psi bucket_idx={}, bucket_item_size={} ", bucket_idx,
-                bucket_items_list.size());
+  // all parties must spawn the same number of sub-links.
+  std::vector<size_t> parallelism_list = AllGatherItemsSize(
+      lctx_, std::max<size_t>(config_.bucket_parallelism(), 1));
+  size_t parallelism = *std::min_element(parallelism_list.begin(),
+                                         parallelism_list.end());
+  parallelism = std::min<size_t>(parallelism, bucket_store->BucketNum());
+
+  // buckets finished by all parties in the previous runs are skipped.
+  const auto finished = OpenCheckpoint(bucket_store->BucketNum());
+  for (size_t bucket_idx : finished) {
+    indices->Add(checkpoint_->LoadIndices(bucket_idx));
+  }
 
-    std::vector<std::string> item_data_list;
-    item_data_list.reserve(bucket_items_list.size());
-    for (const auto& item : bucket_items_list) {
-      item_data_list.push_back(item.base64_data);
+  if (parallelism <= 1) {
+    std::vector<uint64_t> bucket_indices;
+    for (size_t bucket_idx = 0; bucket_idx < bucket_store->BucketNum();
+         bucket_idx++) {
+      if (finished.count(bucket_idx) != 0) {
+        continue;
+      }
+      bucket_indices.clear();
+      RunOneBucket(mem_psi_.get(), bucket_store.get(), bucket_idx,
+                   &bucket_indices);
+      indices->Add(bucket_indices);
     }
+    return;
+  }
+
+  SPDLOG_INFO("psi protocol={}, bucket_parallelism={}", config_.psi_type(),
+              parallelism);
+
+  // worker w runs buckets w, w + parallelism, ... in order on its own
+  // sub-link, so at most `parallelism` buckets are loaded at the same time.
+  std::vector<std::unique_ptr<MemoryPsi>> workers;
+  for (size_t w = 0; w < parallelism; w++) {
+    workers.push_back(
+        std::make_unique<MemoryPsi>(mem_psi_config_, lctx_->Spawn()));
+  }
+
+  std::vector<std::future<void>> futures;
+  for (size_t w = 0; w < parallelism; w++) {
+    futures.push_back(std::async(std::launch::async, [&, w]() {
+      std::vector<uint64_t> bucket_indices;
+      for (size_t bucket_idx = w; bucket_idx < bucket_store->BucketNum();
+           bucket_idx += parallelism) {
+        if (finished.count(bucket_idx) != 0) {
+          continue;
+        }
+        bucket_indices.clear();
+        RunOneBucket(workers[w].get(), bucket_store.get(), bucket_idx,
+                     &bucket_indices);
+        indices->Add(bucket_indices);
+      }
+    }));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+}
 
-    auto result_list = mem_psi_->Run(item_data_list);
+void BucketPsi::RunOneBucket(MemoryPsi* mem_psi, HashBucketCache* bucket_store,
+                             size_t bucket_idx,
+                             std::vector<uint64_t>* indices) const {
+  auto bucket_items_list = bucket_store->LoadBucketItems(bucket_idx);
 
-    SPDLOG_INFO("psi protocol={}, result_size={}", config_.psi_type(),
-                result_list.size());
+  SPDLOG_INFO("run psi bucket_idx={}, bucket_item_size={} ", bucket_idx,
+              bucket_items_list.size());
+
+  std::vector<std::string> item_data_list;
+  item_data_list.reserve(bucket_items_list.size());
+  for (const auto& item : bucket_items_list) {
+    item_data_list.push_back(item.data);
+  }
+
+  auto result_list = mem_psi->Run(item_data_list);
+
+  SPDLOG_INFO("psi protocol={}, result_size={}", config_.psi_type(),
+              result_list.size());
+
+  // get result item indices
+  GetResultIndices(item_data_list, bucket_items_list, result_list, indices);
+
+  if (checkpoint_ != nullptr) {
+    checkpoint_->Save(bucket_idx, *indices);
+  }
+}
+
+std::set<size_t> BucketPsi::OpenCheckpoint(size_t bucket_count) {
+  std::set<size_t> finished;
+  if (!config_.checkpoint_dir().empty()) {
+    // a checkpoint is only valid for the same inputs and settings.
+    std::error_code ec;
+    auto input_size =
+        std::filesystem::file_size(config_.input_params().path(), ec);
+    auto fingerprint = fmt::format(
+        "rank={},input={},input_size={},fields={},psi_type={},curve={},"
+        "bucket_size={},bucket_count={},receiver_rank={},broadcast={}",
+        lctx_->Rank(), config_.input_params().path(), input_size,
+        fmt::join(selected_fields_, ","), config_.psi_type(),
+        config_.curve_type(), config_.bucket_size(), bucket_count,
+        config_.receiver_rank(), config_.broadcast_result());
+    checkpoint_ = std::make_unique<BucketCheckpoint>(config_.checkpoint_dir(),
+                                                     fingerprint);
+    finished = checkpoint_->finished();
+  }
 
-    // get result item indices
-    GetResultIndices(item_data_list, bucket_items_list, result_list, &ret);
+  // always sync, parties without a checkpoint finished nothing.
+  auto finished_list = yacl::link::AllGather(
+      lctx_, BucketCheckpoint::SerializeBuckets(finished),
+      "PSI:SYNC_CHECKPOINT");
+  for (const auto& buf : finished_list) {
+    auto peer_finished = BucketCheckpoint::DeserializeBuckets(
+        std::string_view(buf.data<char>(), buf.size()));
+    std::set<size_t> common;
+    std::set_intersection(finished.begin(), finished.end(),
+                          peer_finished.begin(), peer_finished.end(),
+                          std::inserter(common, common.end()));
+    finished = std::move(common);
   }
 
-  return ret;
+  SPDLOG_INFO("psi protocol={}, resume from finished_buckets={}",
+              config_.psi_type(), finished.size());
+  return finished;
 }
 
 void BucketPsi::GetResultIndices(
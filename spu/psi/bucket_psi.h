@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -22,7 +23,9 @@
 #include "yacl/link/link.h"
 
 #include "spu/psi/memory_psi.h"
+#include "spu/psi/utils/bucket_checkpoint.h"
 #include "spu/psi/utils/hash_bucket_cache.h"
+#include "spu/psi/utils/index_sorter.h"
 
 #include "spu/psi/psi.pb.h"
 
@@ -42,12 +45,24 @@ class BucketPsi {
  private:
   void Init();
 
-  std::vector<uint64_t> RunPsi(uint64_t self_items_count);
+  // Add the indices of the intersection.
+  void RunPsi(uint64_t self_items_count, ExternalIndexSorter* indices);
 
-  std::vector<uint64_t> RunBucketPsi(uint64_t self_items_count);
+  void RunBucketPsi(uint64_t self_items_count, ExternalIndexSorter* indices);
 
   void Handshake(uint64_t self_items_count);
 
+  // Select the protocol of AUTO_PSI_2PC by the set sizes and a probe of the
+  // link, and set it to the configs.
+  void SelectPsiType(uint64_t self_items_count);
+
+  // Run the psi of one bucket and append the indices of the intersection.
+  void RunOneBucket(MemoryPsi* mem_psi, HashBucketCache* bucket_store,
+                    size_t bucket_idx, std::vector<uint64_t>* indices) const;
+
+  // Open the checkpoint and return the buckets finished by all parties.
+  std::set<size_t> OpenCheckpoint(size_t bucket_count);
+
   // the item order of `item_data_list` and `item_list` needs to be the same
   void GetResultIndices(
       const std::vector<std::string>& item_data_list,
@@ -63,6 +78,12 @@ class BucketPsi {
 
   std::vector<std::string> selected_fields_;
 
+  std::unique_ptr<BucketCheckpoint> checkpoint_;
+
+  // the batch size of the ecdh psi run.
+  size_t psi_batch_size_ = 0;
+
+  MemoryPsiConfig mem_psi_config_;
   std::unique_ptr<MemoryPsi> mem_psi_;
 };
 
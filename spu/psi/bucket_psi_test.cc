@@ -186,6 +186,49 @@ TEST_P(StreamTaskPsiTest, BroadcastFalse) {
   }
 }
 
+TEST_P(StreamTaskPsiTest, ParallelBuckets) {
+  auto params = GetParam();
+
+  SetupTmpfilePaths(params.in_content_list.size());
+  auto lctxs = yacl::link::test::SetupWorld(params.in_content_list.size());
+
+  auto proc = [&](int idx) -> spu::psi::PsiResultReport {
+    spu::psi::BucketPsiConfig config;
+    config.mutable_input_params()->set_path(input_paths_[idx]);
+    config.mutable_input_params()->mutable_select_fields()->Add(
+        params.field_names_list[idx].begin(),
+        params.field_names_list[idx].end());
+    config.mutable_input_params()->set_precheck(true);
+    config.mutable_output_params()->set_path(output_paths_[idx]);
+    config.mutable_output_params()->set_need_sort(params.should_sort);
+    config.set_psi_type(params.psi_protocol);
+    config.set_broadcast_result(true);
+    config.set_bucket_size(2);
+    // parties use the smaller one.
+    config.set_bucket_parallelism(idx == 0 ? 4 : 3);
+    config.set_curve_type(CurveType::CURVE_25519);
+
+    BucketPsi ctx(config, lctxs[idx], params.run_in_ic_mode);
+    return ctx.Run();
+  };
+
+  size_t world_size = lctxs.size();
+  std::vector<std::future<spu::psi::PsiResultReport>> f_links(world_size);
+  for (size_t i = 0; i < world_size; i++) {
+    WritFile(input_paths_[i], params.in_content_list[i]);
+    f_links[i] = std::async(proc, i);
+  }
+
+  for (size_t i = 0; i < world_size; i++) {
+    auto report = f_links[i].get();
+
+    EXPECT_EQ(report.original_count(), params.item_size_list[i]);
+    EXPECT_EQ(params.expect_result_size,
+              GetFileLineCount(output_paths_[i]) - 1);
+    EXPECT_EQ(params.out_content_list[i], ReadFileToString(output_paths_[i]));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Works_Instances, StreamTaskPsiTest,
     testing::Values(
@@ -203,6 +246,20 @@ INSTANTIATE_TEST_SUITE_P(
             false,
             5,
         },
+        TestParams{
+            {10, 15},
+            {"id,value\ng,1\nb,2\ns,1\nh,1\ne,1\nc,1\na,1\nj,1\nk,1\nl,1\n",
+             "id,value\ne,1\nc,1\na,1\nj,1\nk,1\nq,1\nw,1\nn,1\nr,1\nt,1\ny,"
+             "1\nu,1\ni,1\no,1\np,1\n"},
+            {"id,value\na,1\nc,1\ne,1\nj,1\nk,1\n",
+             "id,value\na,1\nc,1\ne,1\nj,1\nk,1\n"},
+            {{"id"}, {"id"}},
+            spu::psi::PsiType::AUTO_PSI_2PC,
+            64,
+            true,
+            false,
+            5,
+        },
         TestParams{
             {10, 15},
             {"id,value\ng,1\nb,2\ns,1\nh,1\ne,1\nc,1\na,1\nj,1\nk,1\nl,1\n",
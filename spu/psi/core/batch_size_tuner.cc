@@ -0,0 +1,91 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/batch_size_tuner.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+BatchSizeTuner::BatchSizeTuner(size_t min_batch_size, size_t max_batch_size,
+                               size_t samples_per_size)
+    : min_batch_size_(min_batch_size),
+      max_batch_size_(max_batch_size),
+      samples_per_size_(samples_per_size),
+      current_(min_batch_size),
+      best_size_(min_batch_size) {
+  YACL_ENFORCE(min_batch_size_ > 0 && min_batch_size_ <= max_batch_size_,
+               "invalid batch size range [{}, {}]", min_batch_size_,
+               max_batch_size_);
+  YACL_ENFORCE(samples_per_size_ > 0);
+  converged_ = min_batch_size_ == max_batch_size_;
+}
+
+size_t BatchSizeTuner::batch_size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return current_;
+}
+
+bool BatchSizeTuner::converged() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return converged_;
+}
+
+void BatchSizeTuner::Observe(size_t items, double seconds) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (converged_ || items != current_ || seconds <= 0) {
+    return;
+  }
+  sample_items_ += items;
+  sample_seconds_ += seconds;
+  if (++sample_count_ < samples_per_size_) {
+    return;
+  }
+
+  double throughput = sample_items_ / sample_seconds_;
+  sample_items_ = 0;
+  sample_seconds_ = 0;
+  sample_count_ = 0;
+
+  if (throughput > best_throughput_ * (1 + kMinGain)) {
+    best_throughput_ = throughput;
+    best_size_ = current_;
+    if (current_ < max_batch_size_) {
+      current_ = std::min(current_ * 2, max_batch_size_);
+      return;
+    }
+  }
+  current_ = best_size_;
+  converged_ = true;
+  SPDLOG_INFO("batch size tuned to {}, throughput={:.0f} items/s", current_,
+              best_throughput_);
+}
+
+void BatchSizeTuner::ObserveBatchDone(size_t items) {
+  auto now = std::chrono::steady_clock::now();
+  std::optional<std::chrono::steady_clock::time_point> last;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    last = last_done_;
+    last_done_ = now;
+  }
+  if (last.has_value()) {
+    Observe(items, std::chrono::duration<double>(now - *last).count());
+  }
+}
+
+}  // namespace spu::psi
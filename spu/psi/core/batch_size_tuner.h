@@ -0,0 +1,69 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+
+namespace spu::psi {
+
+// Tune the size of the batches of a stream by the measured throughput.
+//
+// Async sends block once the throttle window of the link is full, so the
+// time between sends of a steady stream measures throughput, bounded by the
+// bandwidth-delay product of the link when the batches are small. The tuner
+// starts from `min_batch_size` and doubles the size while it gains at least
+// `kMinGain` items per second, then keeps the best size seen. A stream whose
+// receiver reads any batch size could follow `batch_size()` batch by batch.
+class BatchSizeTuner {
+ public:
+  // Gain of the throughput to keep doubling.
+  static constexpr double kMinGain = 0.1;
+
+  BatchSizeTuner(size_t min_batch_size, size_t max_batch_size,
+                 size_t samples_per_size = 2);
+
+  // Thread safe.
+  size_t batch_size() const;
+
+  bool converged() const;
+
+  // A batch of `items` items is done `seconds` after the previous one. Only
+  // full batches of the current size are counted.
+  void Observe(size_t items, double seconds);
+
+  // Observe the time since the previous call, the first call only starts the
+  // clock.
+  void ObserveBatchDone(size_t items);
+
+ private:
+  const size_t min_batch_size_;
+  const size_t max_batch_size_;
+  const size_t samples_per_size_;
+
+  mutable std::mutex mutex_;
+  size_t current_;
+  size_t best_size_;
+  double best_throughput_ = 0;
+  size_t sample_items_ = 0;
+  double sample_seconds_ = 0;
+  size_t sample_count_ = 0;
+  bool converged_ = false;
+  std::optional<std::chrono::steady_clock::time_point> last_done_;
+};
+
+}  // namespace spu::psi
@@ -0,0 +1,81 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/batch_size_tuner.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+namespace {
+
+// Feed the tuner batches taking `batch_seconds` until it converges.
+size_t Tune(BatchSizeTuner* tuner,
+            const std::function<double(size_t)>& batch_seconds) {
+  for (size_t round = 0; round < 100 && !tuner->converged(); ++round) {
+    size_t batch_size = tuner->batch_size();
+    tuner->Observe(batch_size, batch_seconds(batch_size));
+  }
+  EXPECT_TRUE(tuner->converged());
+  return tuner->batch_size();
+}
+
+}  // namespace
+
+TEST(BatchSizeTunerTest, LatencyBound) {
+  // a window of 8 batches in flight on a link of 10ms rtt and 1m items/s.
+  BatchSizeTuner tuner(1024, 1 << 20);
+  size_t tuned = Tune(&tuner, [](size_t batch_size) {
+    return std::max(0.01 / 8, batch_size / 1e6);
+  });
+  // the smallest size at the bandwidth limit.
+  EXPECT_GE(tuned, 0.01 / 8 * 1e6);
+  EXPECT_LE(tuned, 4 * 0.01 / 8 * 1e6);
+}
+
+TEST(BatchSizeTunerTest, ThroughputBound) {
+  // the throughput does not depend on the batch size.
+  BatchSizeTuner tuner(1024, 1 << 20);
+  EXPECT_EQ(Tune(&tuner, [](size_t batch_size) { return batch_size / 1e6; }),
+            1024);
+}
+
+TEST(BatchSizeTunerTest, MaxBound) {
+  // always per batch overhead.
+  BatchSizeTuner tuner(1024, 10000);
+  EXPECT_EQ(Tune(&tuner, [](size_t) { return 0.01; }), 10000);
+}
+
+TEST(BatchSizeTunerTest, IgnoreOtherSizes) {
+  BatchSizeTuner tuner(1024, 1 << 20, 1);
+  // a partial last batch.
+  tuner.Observe(100, 1);
+  EXPECT_EQ(tuner.batch_size(), 1024);
+  tuner.Observe(1024, 1);
+  EXPECT_EQ(tuner.batch_size(), 2048);
+  // a batch read before the size was changed.
+  tuner.Observe(1024, 0.1);
+  EXPECT_EQ(tuner.batch_size(), 2048);
+}
+
+TEST(BatchSizeTunerTest, BadRange) {
+  EXPECT_THROW(BatchSizeTuner(0, 10), yacl::EnforceNotMet);
+  EXPECT_THROW(BatchSizeTuner(100, 10), yacl::EnforceNotMet);
+}
+
+}  // namespace spu::psi
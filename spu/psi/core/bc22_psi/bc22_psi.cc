@@ -15,6 +15,7 @@
 #include "spu/psi/core/bc22_psi/bc22_psi.h"
 
 #include <algorithm>
+#include <array>
 #include <future>
 #include <random>
 #include <utility>
@@ -24,6 +25,7 @@
 #include "absl/strings/escaping.h"
 #include "openssl/rand.h"
 #include "spdlog/spdlog.h"
+#include "yacl/crypto/utils/hash_util.h"
 #include "yacl/crypto/utils/rand.h"
 #include "yacl/utils/parallel.h"
 
@@ -48,12 +50,13 @@ constexpr size_t kMaxCompareBytes = 13;
 // H(i, vi) = H(i, wi-delta*ui)
 std::vector<uint8_t> BaRKOPRFHash(size_t bin_idx,
                                   WolverineVoleFieldType value) {
-  std::string hash_input(sizeof(WolverineVoleFieldType) + sizeof(size_t), '\0');
+  std::array<uint8_t, sizeof(WolverineVoleFieldType) + sizeof(size_t)>
+      hash_input;
   std::memcpy(hash_input.data(), &bin_idx, sizeof(size_t));
   std::memcpy(hash_input.data() + sizeof(size_t), &value,
               sizeof(WolverineVoleFieldType));
-  std::vector<uint8_t> hash_res = yacl::crypto::Blake3(hash_input);
-  return hash_res;
+  return yacl::crypto::Blake3(
+      yacl::ByteContainerView(hash_input.data(), hash_input.size()));
 }
 
 }  // namespace
@@ -142,45 +145,8 @@ std::string Bc22PcgPsi::RunmBaRKOprfSender(absl::Span<const std::string> items,
   const size_t coeff_byte_size =
       kMaxItemsPerBin * sizeof(WolverineVoleFieldType);
 
-  // sender alice
-  // recv masked polynomial coeff
-  size_t recv_bin_idx = 0;
-  size_t bins_num = cuckoo_options_.NumBins();
-  SPDLOG_INFO("cuckoo_options_.NumBins: {}", bins_num);
-
-  SPDLOG_INFO("begin recv receiver's masked coeff");
-
-  std::vector<std::array<WolverineVoleFieldType, kMaxItemsPerBin>>
-      masked_coeffs(bins_num);
-
-  while (true) {
-    yacl::Buffer masked_coeff_buffer = link_ctx_->Recv(
-        link_ctx_->NextRank(), fmt::format("recv {} bin", recv_bin_idx));
-    YACL_ENFORCE((masked_coeff_buffer.size() % coeff_byte_size) == 0);
-
-    size_t num_bin = masked_coeff_buffer.size() / coeff_byte_size;
-
-    std::memcpy(&masked_coeffs[recv_bin_idx],
-                reinterpret_cast<uint8_t *>(masked_coeff_buffer.data()),
-                masked_coeff_buffer.size());
-
-    recv_bin_idx += num_bin;
-    // every kPcgPsiLogBatchSize bin print percentage
-    if (recv_bin_idx % kPcgPsiLogBatchSize == 0) {
-      SPDLOG_INFO(
-          "recv receiver's masked coeff, recv_bin_idx: {} Bins_Num:{} "
-          "percentage:{}",
-          recv_bin_idx, bins_num, (double)recv_bin_idx / bins_num);
-    }
-
-    if (recv_bin_idx == bins_num) {
-      break;
-    }
-  }
-
-  SPDLOG_INFO("after recv receiver's masked coeff, recv_bin_idx: {}",
-              recv_bin_idx);
-
+  // the table is needed to evaluate the oprfs of a batch of bins as soon as
+  // its masked coeffs arrive, and it is built along with the extension.
   table_thread.get();
 
   const std::vector<std::vector<CuckooIndex::Bin>> &bins = simple_table.bins();
@@ -215,49 +181,102 @@ std::string Bc22PcgPsi::RunmBaRKOprfSender(absl::Span<const std::string> items,
                    2 * compare_bytes_size) == 1);
   }
 
-  // compute sender's oprf
-  yacl::parallel_for(0, bins.size(), 1, [&](int64_t begin, int64_t end) {
-    for (int64_t bin_idx = begin; bin_idx < end; ++bin_idx) {
-      std::vector<WolverineVoleFieldType> oprf_key(kMaxItemsPerBin);
+  // compute sender's oprf of bins [bin_begin, bin_begin + num_bin)
+  auto compute_oprfs = [&](const WolverineVoleFieldType *masked_coeffs,
+                           size_t bin_begin, size_t num_bin) {
+    yacl::parallel_for(0, num_bin, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t j = begin; j < end; ++j) {
+        size_t bin_idx = bin_begin + j;
+        std::array<WolverineVoleFieldType, kMaxItemsPerBin> oprf_key;
 
-      size_t vole_start = bin_idx * kMaxItemsPerBin;
+        size_t vole_start = bin_idx * kMaxItemsPerBin;
 
-      std::array<WolverineVoleFieldType, kMaxItemsPerBin> masked_coeff =
-          masked_coeffs[bin_idx];
+        const WolverineVoleFieldType *masked_coeff =
+            masked_coeffs + j * kMaxItemsPerBin;
 
-      // delta * masked_coeff_i + w_i
-      // = delta * coeff_i - delta * u_i + w_i
-      // = delta * coeff_i + v_i
-      for (size_t j = 0; j < kMaxItemsPerBin; ++j) {
-        WolverineVoleFieldType tmp = mod(delta * masked_coeff[j], pr);
+        // delta * masked_coeff_i + w_i
+        // = delta * coeff_i - delta * u_i + w_i
+        // = delta * coeff_i + v_i
+        for (size_t k = 0; k < kMaxItemsPerBin; ++k) {
+          WolverineVoleFieldType tmp = mod(delta * masked_coeff[k], pr);
 
-        oprf_key[j] = mod(vole_blocks[vole_start + j] + tmp, pr);
-      }
+          oprf_key[k] = mod(vole_blocks[vole_start + k] + tmp, pr);
+        }
 
-      for (size_t j = 0; j < bins[bin_idx].size(); ++j) {
-        size_t item_idx = bins[bin_idx][j].InputIdx();
-        size_t hash_idx = bins[bin_idx][j].HashIdx();
+        for (size_t k = 0; k < bins[bin_idx].size(); ++k) {
+          size_t item_idx = bins[bin_idx][k].InputIdx();
+          size_t hash_idx = bins[bin_idx][k].HashIdx();
 
-        absl::string_view item_hash_str = absl::string_view(
-            reinterpret_cast<const char *>(&items_hash_low64[item_idx]),
-            sizeof(uint64_t));
+          absl::string_view item_hash_str = absl::string_view(
+              reinterpret_cast<const char *>(&items_hash_low64[item_idx]),
+              sizeof(uint64_t));
 
-        // delta * Poly(x) + vi_0 + vi_1*x+vi_1*x^2
-        WolverineVoleFieldType eval =
-            EvaluatePolynoimal(absl::MakeSpan(oprf_key), item_hash_str, delta);
+          // delta * Poly(x) + vi_0 + vi_1*x+vi_1*x^2
+          WolverineVoleFieldType eval = EvaluatePolynoimal(
+              absl::MakeConstSpan(oprf_key), item_hash_str, delta);
 
-        std::vector<uint8_t> hash_res = BaRKOPRFHash(bin_idx, eval);
+          std::vector<uint8_t> hash_res = BaRKOPRFHash(bin_idx, eval);
 
-        // copy to shuffled pos
-        size_t shuffled_idx = shuffled_idx_vec[item_idx];
+          // copy to shuffled pos
+          size_t shuffled_idx = shuffled_idx_vec[item_idx];
 
-        std::memcpy(
-            &oprfs[((shuffled_idx * cuckoo_options_.num_hash) + hash_idx) *
-                   compare_bytes_size],
-            hash_res.data(), compare_bytes_size);
+          std::memcpy(
+              &oprfs[((shuffled_idx * cuckoo_options_.num_hash) + hash_idx) *
+                     compare_bytes_size],
+              hash_res.data(), compare_bytes_size);
+        }
       }
+    });
+  };
+
+  // sender alice
+  // recv masked polynomial coeff
+  size_t recv_bin_idx = 0;
+  size_t bins_num = cuckoo_options_.NumBins();
+  SPDLOG_INFO("cuckoo_options_.NumBins: {}", bins_num);
+
+  SPDLOG_INFO("begin recv receiver's masked coeff");
+
+  // the oprfs of a batch are computed in the background when the next one is
+  // received.
+  std::future<void> compute_thread;
+  yacl::Buffer computing_buffer;
+
+  while (recv_bin_idx < bins_num) {
+    yacl::Buffer masked_coeff_buffer = link_ctx_->Recv(
+        link_ctx_->NextRank(), fmt::format("recv {} bin", recv_bin_idx));
+    YACL_ENFORCE((masked_coeff_buffer.size() % coeff_byte_size) == 0);
+
+    size_t num_bin = masked_coeff_buffer.size() / coeff_byte_size;
+    YACL_ENFORCE(recv_bin_idx + num_bin <= bins_num,
+                 "recv {} bins more than {}", recv_bin_idx + num_bin,
+                 bins_num);
+
+    if (compute_thread.valid()) {
+      compute_thread.get();
     }
-  });
+    computing_buffer = std::move(masked_coeff_buffer);
+    const auto *masked_coeffs =
+        reinterpret_cast<const WolverineVoleFieldType *>(
+            computing_buffer.data());
+    compute_thread = std::async(std::launch::async, compute_oprfs,
+                                masked_coeffs, recv_bin_idx, num_bin);
+
+    recv_bin_idx += num_bin;
+    // every kPcgPsiLogBatchSize bin print percentage
+    if (recv_bin_idx % kPcgPsiLogBatchSize == 0) {
+      SPDLOG_INFO(
+          "recv receiver's masked coeff, recv_bin_idx: {} Bins_Num:{} "
+          "percentage:{}",
+          recv_bin_idx, bins_num, (double)recv_bin_idx / bins_num);
+    }
+  }
+  if (compute_thread.valid()) {
+    compute_thread.get();
+  }
+
+  SPDLOG_INFO("after recv receiver's masked coeff, recv_bin_idx: {}",
+              recv_bin_idx);
 
   SPDLOG_INFO("after compute sender's oprf");
 
@@ -24,8 +24,13 @@ WolverineVole::WolverineVole(
     : party_((psi_role == PsiRoleType::Sender) ? emp::ALICE : emp::BOB),
       link_ctx_(link_ctx) {
   // set CheetahIo
-  for (size_t i = 0; i < kVoleSilentOTThreads; ++i) {
-    silent_ios_[i] = std::make_unique<CheetahIo>(link_ctx_);
+  // emp runs the mpfss of every thread on its own io, so the ios should not
+  // share a link. Both parties spawn the links in the same order.
+  silent_ios_[0] = std::make_unique<CheetahIo>(link_ctx_);
+  ios_[0] = silent_ios_[0].get();
+  for (size_t i = 1; i < kVoleSilentOTThreads; ++i) {
+    thread_links_.push_back(link_ctx_->Spawn());
+    silent_ios_[i] = std::make_unique<CheetahIo>(thread_links_.back());
     ios_[i] = silent_ios_[i].get();
   }
 
@@ -32,7 +32,8 @@
 
 namespace spu::psi {
 
-inline constexpr size_t kVoleSilentOTThreads = 1;
+// threads of the silent vole extension, each on its own spawned link.
+inline constexpr size_t kVoleSilentOTThreads = 4;
 
 // VOLE
 // Wolverine: Fast, Scalable, and Communication-Efficient
@@ -71,6 +72,8 @@ class WolverineVole {
 
   int party_;
   std::shared_ptr<yacl::link::Context> link_ctx_;
+  // links of the extension threads but the first one, which uses link_ctx_.
+  std::vector<std::shared_ptr<yacl::link::Context>> thread_links_;
 
   WolverineVoleFieldType delta_;
 
@@ -14,6 +14,7 @@
 
 #include "spu/psi/core/bc22_psi/generalized_cuckoo_hash.h"
 
+#include <algorithm>
 #include <set>
 #include <utility>
 
@@ -29,6 +30,11 @@ namespace {
 
 constexpr size_t kDefaultHashNum = 2;
 
+// Insert of fewer items runs serially.
+constexpr size_t kParallelPlaceThreshold = 1 << 16;
+// Bins of a partition placed by one task.
+constexpr size_t kBinsPerPartition = 1 << 14;
+
 // Permutation-Based Hashing
 // [PSSZ15] In USENIX Security 2015
 // Phasing: Private set intersection using permutation-based hashing
@@ -106,7 +112,8 @@ void GeneralizedCuckooHashTable::Insert(yacl::ByteContainerView item_data,
     for (uint32_t i = 0; i < gch_options_.num_hash; i++) {
       size_t hash_idx = (rand_hash_idx + i) % gch_options_.num_hash;
 
-      bin_idx = hashes_[candidate.InputIdx()][hash_idx];
+      bin_idx =
+          hashes_[candidate.InputIdx() * gch_options_.num_hash + hash_idx];
 
       if (bins_[bin_idx].size() < max_items_per_bin_) {
         uint64_t next_candid =
@@ -125,7 +132,8 @@ void GeneralizedCuckooHashTable::Insert(yacl::ByteContainerView item_data,
 
     rand_hash_idx = uniform_hashidx_(gen_);
 
-    bin_idx = hashes_[candidate.InputIdx()][rand_hash_idx];
+    bin_idx =
+        hashes_[candidate.InputIdx() * gch_options_.num_hash + rand_hash_idx];
 
     uint64_t next_candid =
         CuckooIndex::Bin::Encode(candidate.InputIdx(), rand_hash_idx);
@@ -143,14 +151,14 @@ void GeneralizedCuckooHashTable::Insert(yacl::ByteContainerView item_data,
 
 void GeneralizedCuckooHashTable::Insert(yacl::ByteContainerView item) {
   uint128_t item_hash = yacl::crypto::Blake3_128(item);
-  size_t input_offset = hashes_.size();
+  size_t input_offset = items_hash_low64_.size();
 
   // hash_bin_idx
   std::pair<uint64_t, uint64_t> items_hash_u64 =
       yacl::DecomposeUInt128(item_hash);
   std::vector<uint64_t> hash_bin_idx =
       GetBinIdx(gch_options_, item_hash, items_hash_u64.first);
-  hashes_.push_back(hash_bin_idx);
+  hashes_.insert(hashes_.end(), hash_bin_idx.begin(), hash_bin_idx.end());
 
   items_hash_low64_.push_back(items_hash_u64.second);
 
@@ -159,25 +167,97 @@ void GeneralizedCuckooHashTable::Insert(yacl::ByteContainerView item) {
 
 void GeneralizedCuckooHashTable::Insert(absl::Span<const std::string> items) {
   size_t input_offset = items_hash_low64_.size();
+  const size_t num_hash = gch_options_.num_hash;
   items_hash_low64_.resize(input_offset + items.size());
-  hashes_.resize(input_offset + items.size());
+  hashes_.resize((input_offset + items.size()) * num_hash);
 
   yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
-    for (int i = begin; i < end; ++i) {
+    for (int64_t i = begin; i < end; ++i) {
       uint128_t item_hash = yacl::crypto::Blake3_128(items[i]);
 
       std::pair<uint64_t, uint64_t> items_hash_u64 =
           yacl::DecomposeUInt128(item_hash);
 
       items_hash_low64_[input_offset + i] = items_hash_u64.second;
-      hashes_[input_offset + i] =
+      std::vector<uint64_t> hash_bin_idx =
           GetBinIdx(gch_options_, item_hash, items_hash_u64.first);
+      std::copy(hash_bin_idx.begin(), hash_bin_idx.end(),
+                hashes_.begin() + (input_offset + i) * num_hash);
     }
   });
 
-  for (size_t i = 0; i < items.size(); ++i) {
-    Insert(items[i], input_offset + i);
+  if (items.size() < kParallelPlaceThreshold) {
+    for (size_t i = 0; i < items.size(); ++i) {
+      Insert(items[i], input_offset + i);
+    }
+    return;
+  }
+
+  std::vector<size_t> pending = ParallelPlace(input_offset, items.size());
+  SPDLOG_INFO("gch parallel placed {} of {} items",
+              items.size() - pending.size(), items.size());
+  for (size_t item_idx : pending) {
+    Insert(items[item_idx - input_offset], item_idx);
+  }
+}
+
+std::vector<size_t> GeneralizedCuckooHashTable::ParallelPlace(
+    size_t input_offset, size_t item_num) {
+  const size_t num_hash = gch_options_.num_hash;
+  const size_t num_partitions =
+      (bins_.size() + kBinsPerPartition - 1) / kBinsPerPartition;
+
+  // a random candidate of every item, as the first try of Insert.
+  std::vector<uint8_t> hash_choice(item_num);
+  for (size_t i = 0; i < item_num; ++i) {
+    hash_choice[i] = uniform_hashidx_(gen_);
+  }
+  auto target_bin = [&](size_t i) {
+    return hashes_[(input_offset + i) * num_hash + hash_choice[i]];
+  };
+
+  // stable counting sort of the items by the partition of their target, so
+  // a partition is placed in the input order by one task.
+  std::vector<size_t> partition_begin(num_partitions + 1, 0);
+  for (size_t i = 0; i < item_num; ++i) {
+    partition_begin[target_bin(i) / kBinsPerPartition + 1]++;
+  }
+  for (size_t p = 0; p < num_partitions; ++p) {
+    partition_begin[p + 1] += partition_begin[p];
+  }
+  std::vector<size_t> sorted_items(item_num);
+  {
+    std::vector<size_t> fill_pos(partition_begin.begin(),
+                                 partition_begin.end() - 1);
+    for (size_t i = 0; i < item_num; ++i) {
+      sorted_items[fill_pos[target_bin(i) / kBinsPerPartition]++] = i;
+    }
+  }
+
+  std::vector<uint8_t> placed(item_num, 0);
+  yacl::parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      for (size_t k = partition_begin[p]; k < partition_begin[p + 1]; ++k) {
+        size_t i = sorted_items[k];
+        std::vector<CuckooIndex::Bin> &bin = bins_[target_bin(i)];
+        if (bin.size() < max_items_per_bin_) {
+          bin.emplace_back(CuckooIndex::Bin::Encode(input_offset + i,
+                                                    hash_choice[i]));
+          placed[i] = 1;
+        }
+      }
+    }
+  });
+
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < item_num; ++i) {
+    if (placed[i] != 0) {
+      inserted_items_++;
+    } else {
+      pending.push_back(input_offset + i);
+    }
   }
+  return pending;
 }
 
 SimpleHashTable::SimpleHashTable(CuckooIndex::Options options, uint128_t seed)
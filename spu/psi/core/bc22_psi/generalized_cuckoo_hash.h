@@ -53,6 +53,8 @@ class GeneralizedCuckooHashTable : public IPsiHashTable {
 
   void Insert(yacl::ByteContainerView item_data, size_t input_offset);
   void Insert(yacl::ByteContainerView item);
+  // Large inputs are first placed greedily in parallel over bin partitions,
+  // and only the items that find their bin full take the random walk.
   void Insert(absl::Span<const std::string> items) override;
 
   const std::vector<std::vector<CuckooIndex::Bin>> &bins() const {
@@ -79,10 +81,15 @@ class GeneralizedCuckooHashTable : public IPsiHashTable {
   size_t max_items_per_bin_;
   uint128_t seed_;
   std::vector<std::vector<CuckooIndex::Bin>> bins_;
-  std::vector<std::vector<uint64_t>> hashes_;
+  // candidate bins of the items, num_hash per item.
+  std::vector<uint64_t> hashes_;
   std::vector<uint64_t> items_hash_low64_;
   size_t inserted_items_ = 0;
 
+  // Place items [input_offset, input_offset + item_num) into a bin of a
+  // random candidate if it is not full, and return the ones left.
+  std::vector<size_t> ParallelPlace(size_t input_offset, size_t item_num);
+
   // Randomness source for location function sampling.
   std::mt19937_64 gen_;
 
@@ -124,4 +124,33 @@ TEST(GchTest, CuckooHashTest) {
   SPDLOG_INFO("conflict_idx: {}", conflict_idx.size());
 }
 
+TEST(GchTest, ParallelPlaceTest) {
+  // large enough to be placed in parallel first.
+  std::vector<std::string> items = CreateRangeItems(0, 200000);
+
+  size_t bin_size = 3;
+  size_t hash_num = 2;
+  CuckooIndex::Options cuckoo_options =
+      GetCuckooHashOption(bin_size, hash_num, items.size());
+
+  GeneralizedCuckooHashTable gch(cuckoo_options, bin_size, 0);
+  gch.Insert(absl::MakeSpan(items));
+
+  std::vector<size_t> item_count(items.size(), 0);
+  for (const auto &bin : gch.bins()) {
+    EXPECT_LE(bin.size(), bin_size);
+    for (const auto &data : bin) {
+      ASSERT_LT(data.InputIdx(), items.size());
+      EXPECT_LT(data.HashIdx(), hash_num);
+      item_count[data.InputIdx()]++;
+    }
+  }
+  for (size_t i = 0; i < items.size(); ++i) {
+    EXPECT_EQ(item_count[i], 1) << "item " << i;
+  }
+  EXPECT_DOUBLE_EQ(gch.FillRate(),
+                   static_cast<double>(items.size()) /
+                       (cuckoo_options.NumBins() * bin_size));
+}
+
 }  // namespace spu::psi
@@ -0,0 +1,428 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/circuit_psi.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "absl/types/span.h"
+#include "yacl/base/exception.h"
+#include "yacl/crypto/primitives/ot/kkrt_ot_extension.h"
+#include "yacl/crypto/utils/rand.h"
+#include "yacl/utils/parallel.h"
+
+#include "spu/core/type_util.h"
+#include "spu/core/xt_helper.h"
+#include "spu/kernel/hal/constants.h"
+#include "spu/kernel/hal/ring.h"
+#include "spu/kernel/hal/type_cast.h"
+#include "spu/psi/core/cuckoo_index.h"
+#include "spu/psi/core/kkrt_psi.h"
+#include "spu/psi/utils/serialize.h"
+
+namespace spu::psi {
+
+namespace {
+
+constexpr size_t kCuckooHashNum = 3;
+constexpr size_t kKkrtOtBatchSize = (65535 / 4 / 16 * 0.8);
+constexpr size_t kKkrtBaseOtNum = 512;
+
+// bins programmed and sent by a message.
+constexpr size_t kBinBatchSize = 4096;
+
+// the oprf programs are over the field of this mersenne prime.
+constexpr uint64_t kPrime = (uint64_t(1) << 61) - 1;
+
+uint64_t ModP(uint64_t x) {
+  x = (x & kPrime) + (x >> 61);
+  return x >= kPrime ? x - kPrime : x;
+}
+
+uint64_t AddMod(uint64_t a, uint64_t b) { return ModP(a + b); }
+
+uint64_t SubMod(uint64_t a, uint64_t b) {
+  return a >= b ? a - b : a + kPrime - b;
+}
+
+uint64_t MulMod(uint64_t a, uint64_t b) {
+  const uint128_t r = static_cast<uint128_t>(a) * b;
+  return AddMod(static_cast<uint64_t>(r) & kPrime,
+                static_cast<uint64_t>(r >> 61));
+}
+
+uint64_t InvMod(uint64_t a) {
+  YACL_ENFORCE(a != 0, "zero has no inverse");
+  uint64_t ret = 1;
+  for (uint64_t e = kPrime - 2; e != 0; e >>= 1) {
+    if (e & 1) {
+      ret = MulMod(ret, a);
+    }
+    a = MulMod(a, a);
+  }
+  return ret;
+}
+
+// Coefficients, low first, of the polynomial of degree below xs.size()
+// through the points (xs[i], ys[i]), by lagrange in O(n^2).
+std::vector<uint64_t> Interpolate(absl::Span<const uint64_t> xs,
+                                  absl::Span<const uint64_t> ys) {
+  const size_t n = xs.size();
+
+  // m(x) = prod(x - xs[i])
+  std::vector<uint64_t> m(n + 1, 0);
+  m[0] = 1;
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j > 0; --j) {
+      m[j] = SubMod(m[j - 1], MulMod(xs[i], m[j]));
+    }
+    m[0] = SubMod(0, MulMod(xs[i], m[0]));
+  }
+
+  std::vector<uint64_t> coeffs(n, 0);
+  std::vector<uint64_t> q(n);
+  for (size_t i = 0; i < n; ++i) {
+    // q(x) = m(x) / (x - xs[i]), and its value at xs[i].
+    q[n - 1] = m[n];
+    for (size_t j = n - 1; j > 0; --j) {
+      q[j - 1] = AddMod(m[j], MulMod(xs[i], q[j]));
+    }
+    uint64_t w = 0;
+    for (size_t j = n; j > 0; --j) {
+      w = AddMod(MulMod(w, xs[i]), q[j - 1]);
+    }
+
+    const uint64_t c = MulMod(ys[i], InvMod(w));
+    for (size_t j = 0; j < n; ++j) {
+      coeffs[j] = AddMod(coeffs[j], MulMod(c, q[j]));
+    }
+  }
+  return coeffs;
+}
+
+uint64_t Evaluate(absl::Span<const uint64_t> coeffs, uint64_t x) {
+  uint64_t ret = 0;
+  for (size_t j = coeffs.size(); j > 0; --j) {
+    ret = AddMod(MulMod(ret, x), coeffs[j - 1]);
+  }
+  return ret;
+}
+
+// The point of an item on the programs.
+uint64_t ItemPoint(uint128_t item) {
+  return ModP(static_cast<uint64_t>(item));
+}
+
+// The membership and the payload oprf outputs of a kkrt encoding.
+std::pair<uint64_t, uint64_t> SplitEncoding(uint128_t encoding) {
+  return {ModP(static_cast<uint64_t>(encoding)),
+          ModP(static_cast<uint64_t>(encoding >> 64))};
+}
+
+// A bound of the items in a bin when n items are hashed to kCuckooHashNum of
+// num_bins bins, which is exceeded by probability 2^-stat_sec_param over all
+// bins, by the chernoff bound
+//   P(load >= mu + t) <= exp(-t^2 / (2 * mu + 2 * t / 3))
+// All programs are of this degree, so their size does not leak the load.
+size_t MaxBinLoad(size_t n, size_t num_bins, size_t stat_sec_param) {
+  const double mu = static_cast<double>(kCuckooHashNum * n) / num_bins;
+  const double l = std::log(static_cast<double>(num_bins)) +
+                   static_cast<double>(stat_sec_param) * std::log(2.0);
+  const double t = (2 * l / 3 + std::sqrt(4 * l * l / 9 + 8 * mu * l)) / 2;
+  return std::clamp<size_t>(static_cast<size_t>(std::ceil(mu + t)), 1, n);
+}
+
+size_t ExchangeSetSize(const std::shared_ptr<yacl::link::Context>& link_ctx,
+                       size_t items_size) {
+  link_ctx->SendAsync(link_ctx->NextRank(), utils::SerializeSize(items_size),
+                      fmt::format("CIRCUIT:PSI:SELF_SIZE={}", items_size));
+
+  return utils::DeserializeSize(
+      link_ctx->Recv(link_ctx->NextRank(), "CIRCUIT:PSI:PEER_SIZE"));
+}
+
+// OPRF of every bin of the sender items, then programs of the targets.
+// Shares are the negated targets.
+void SendPrograms(const std::shared_ptr<yacl::link::Context>& link_ctx,
+                  const std::vector<uint128_t>& items_hash,
+                  const std::vector<uint64_t>& payloads, size_t num_bins,
+                  size_t max_load, std::vector<int64_t>* member_shares,
+                  std::vector<int64_t>* payload_shares) {
+  yacl::BaseRecvOptions base_options;
+  GetKkrtOtSenderOptions(link_ctx, kKkrtBaseOtNum, &base_options);
+
+  yacl::KkrtOtExtSender sender;
+  sender.Init(link_ctx, base_options, num_bins);
+  sender.SetBatchSize(kKkrtOtBatchSize);
+  const size_t ot_batch_size = sender.GetBatchSize();
+  for (size_t begin = 0, batch_idx = 0; begin < num_bins; ++batch_idx) {
+    const size_t num_this_batch = std::min(ot_batch_size, num_bins - begin);
+    auto correction = link_ctx->Recv(
+        link_ctx->NextRank(),
+        fmt::format("CIRCUIT:PSI:RECV_CORRECTION:{}", batch_idx));
+    sender.SetCorrection(correction, num_this_batch);
+    begin += num_this_batch;
+  }
+
+  // simple hashing, colliding hashes of an item go to one bin.
+  std::vector<std::vector<size_t>> bins(num_bins);
+  for (size_t i = 0; i < items_hash.size(); ++i) {
+    CuckooIndex::HashRoom item_hash(items_hash[i]);
+    std::array<uint64_t, kCuckooHashNum> bin_indices;
+    for (size_t h = 0; h < kCuckooHashNum; ++h) {
+      bin_indices[h] = item_hash.GetHash(h) % num_bins;
+      if (std::find(bin_indices.begin(), bin_indices.begin() + h,
+                    bin_indices[h]) == bin_indices.begin() + h) {
+        bins[bin_indices[h]].push_back(i);
+      }
+    }
+  }
+  for (const auto& bin : bins) {
+    YACL_ENFORCE(bin.size() <= max_load,
+                 "bin load {} exceeds the bound {}, items are not hashed",
+                 bin.size(), max_load);
+  }
+
+  const size_t program_size = 2 * max_load;
+  for (size_t begin = 0; begin < num_bins; begin += kBinBatchSize) {
+    const size_t end = std::min(begin + kBinBatchSize, num_bins);
+    std::vector<uint64_t> programs((end - begin) * program_size);
+
+    yacl::parallel_for(begin, end, 1, [&](int64_t bin_begin, int64_t bin_end) {
+      yacl::Prg<uint64_t> prg(yacl::RandSeed());
+      std::vector<uint64_t> xs(max_load);
+      std::vector<uint64_t> member_ys(max_load);
+      std::vector<uint64_t> payload_ys(max_load);
+      for (int64_t b = bin_begin; b < bin_end; ++b) {
+        const uint64_t r = ModP(prg());
+        const uint64_t s = ModP(prg());
+        const auto& bin = bins[b];
+        for (size_t k = 0; k < max_load; ++k) {
+          if (k < bin.size()) {
+            const size_t idx = bin[k];
+            uint128_t encoding = 0;
+            sender.Encode(b, items_hash[idx],
+                          reinterpret_cast<uint8_t*>(&encoding),
+                          sizeof(encoding));
+            auto [f_member, f_payload] = SplitEncoding(encoding);
+            const uint64_t payload = payloads.empty() ? 0 : payloads[idx];
+            xs[k] = ItemPoint(items_hash[idx]);
+            member_ys[k] = SubMod(f_member, r);
+            payload_ys[k] = SubMod(SubMod(f_payload, payload), s);
+            YACL_ENFORCE(
+                std::find(xs.begin(), xs.begin() + k, xs[k]) == xs.begin() + k,
+                "items of bin {} collide, items are not hashed", b);
+          } else {
+            // dummy points hide the load of the bin.
+            do {
+              xs[k] = ModP(prg());
+            } while (std::find(xs.begin(), xs.begin() + k, xs[k]) !=
+                     xs.begin() + k);
+            member_ys[k] = ModP(prg());
+            payload_ys[k] = ModP(prg());
+          }
+        }
+
+        auto member_program = Interpolate(xs, member_ys);
+        auto payload_program = Interpolate(xs, payload_ys);
+        uint64_t* program = &programs[(b - begin) * program_size];
+        std::copy(member_program.begin(), member_program.end(), program);
+        std::copy(payload_program.begin(), payload_program.end(),
+                  program + max_load);
+
+        (*member_shares)[b] = -static_cast<int64_t>(r);
+        (*payload_shares)[b] = -static_cast<int64_t>(s);
+      }
+    });
+
+    link_ctx->SendAsync(
+        link_ctx->NextRank(),
+        yacl::ByteContainerView(programs.data(),
+                                programs.size() * sizeof(uint64_t)),
+        fmt::format("CIRCUIT:PSI:SEND_PROGRAM:{}", begin));
+  }
+}
+
+// OPRF of the cuckoo bins, then evaluates the programs of the sender at the
+// items. Shares are the evaluations, returns the input index of every bin.
+std::vector<int64_t> RecvPrograms(
+    const std::shared_ptr<yacl::link::Context>& link_ctx,
+    const std::vector<uint128_t>& items_hash,
+    const CuckooIndex::Options& cuckoo_options, size_t max_load,
+    std::vector<int64_t>* member_shares,
+    std::vector<int64_t>* payload_shares) {
+  CuckooIndex cuckoo_index(cuckoo_options);
+  cuckoo_index.Insert(absl::MakeSpan(items_hash));
+  YACL_ENFORCE(cuckoo_index.stash().empty(), "stash size not 0");
+  const auto& ck_bins = cuckoo_index.bins();
+  const size_t num_bins = ck_bins.size();
+
+  yacl::BaseSendOptions base_options;
+  GetKkrtOtReceiverOptions(link_ctx, kKkrtBaseOtNum, &base_options);
+
+  yacl::KkrtOtExtReceiver receiver;
+  receiver.Init(link_ctx, base_options, num_bins);
+  receiver.SetBatchSize(kKkrtOtBatchSize);
+  const size_t ot_batch_size = receiver.GetBatchSize();
+
+  // empty bins evaluate a random item, which matches no sender item.
+  yacl::Prg<uint128_t> prg(yacl::RandSeed());
+  std::vector<int64_t> bin_items(num_bins, -1);
+  std::vector<uint128_t> inputs(num_bins);
+  std::vector<uint128_t> encodings(num_bins, 0);
+  for (size_t begin = 0, batch_idx = 0; begin < num_bins; ++batch_idx) {
+    const size_t num_this_batch = std::min(ot_batch_size, num_bins - begin);
+    for (size_t b = begin; b < begin + num_this_batch; ++b) {
+      if (ck_bins[b].IsEmpty()) {
+        inputs[b] = prg();
+      } else {
+        bin_items[b] = static_cast<int64_t>(ck_bins[b].InputIdx());
+        inputs[b] = items_hash[bin_items[b]];
+      }
+      receiver.Encode(
+          b, inputs[b],
+          absl::Span<uint8_t>(reinterpret_cast<uint8_t*>(&encodings[b]),
+                              sizeof(uint128_t)));
+    }
+    link_ctx->SendAsync(
+        link_ctx->NextRank(), receiver.ShiftCorrection(num_this_batch),
+        fmt::format("CIRCUIT:PSI:SEND_CORRECTION:{}", batch_idx));
+    begin += num_this_batch;
+  }
+
+  const size_t program_size = 2 * max_load;
+  for (size_t begin = 0; begin < num_bins; begin += kBinBatchSize) {
+    const size_t end = std::min(begin + kBinBatchSize, num_bins);
+    auto buf = link_ctx->Recv(
+        link_ctx->NextRank(),
+        fmt::format("CIRCUIT:PSI:RECV_PROGRAM:{}", begin));
+    YACL_ENFORCE_EQ(static_cast<size_t>(buf.size()),
+                    (end - begin) * program_size * sizeof(uint64_t));
+    const auto* programs = buf.data<uint64_t>();
+
+    yacl::parallel_for(begin, end, 1, [&](int64_t bin_begin, int64_t bin_end) {
+      for (int64_t b = bin_begin; b < bin_end; ++b) {
+        absl::Span<const uint64_t> program(
+            programs + (b - begin) * program_size, program_size);
+        const uint64_t x = ItemPoint(inputs[b]);
+        auto [f_member, f_payload] = SplitEncoding(encodings[b]);
+        (*member_shares)[b] = static_cast<int64_t>(
+            SubMod(f_member, Evaluate(program.first(max_load), x)));
+        (*payload_shares)[b] = static_cast<int64_t>(
+            SubMod(f_payload, Evaluate(program.subspan(max_load), x)));
+      }
+    });
+  }
+  return bin_items;
+}
+
+// The additive shares of all parties as a secret.
+Value MakeShares(HalContext* ctx, const std::vector<int64_t>& shares) {
+  const auto numel = static_cast<int64_t>(shares.size());
+  const auto ty =
+      kernel::hal::p2s(ctx, kernel::hal::constant(ctx, int64_t(0), {1}))
+          .storage_type();
+
+  NdArrayRef arr(ty, {numel});
+  DISPATCH_ALL_FIELDS(ctx->getField(), "_", [&]() {
+    auto arr_xt = xt_mutable_adapt<ring2k_t>(arr);
+    for (int64_t idx = 0; idx < numel; ++idx) {
+      arr_xt[idx] = static_cast<ring2k_t>(shares[idx]);
+    }
+  });
+  return Value(arr, DT_I64);
+}
+
+}  // namespace
+
+CircuitPsiResult CircuitPsi(HalContext* ctx, const CircuitPsiOptions& options,
+                            const std::vector<uint128_t>& items_hash,
+                            const std::vector<uint64_t>& payloads) {
+  YACL_ENFORCE(ctx->lctx() != nullptr && ctx->lctx()->WorldSize() == 2,
+               "circuit psi runs by 2 parties");
+  const auto protocol = ctx->rt_config().protocol();
+  YACL_ENFORCE(
+      protocol == ProtocolKind::SEMI2K || protocol == ProtocolKind::CHEETAH,
+      "circuit psi needs additive shares, got protocol={}",
+      ProtocolKind_Name(protocol));
+  // the field elements of the programs are 61 bits.
+  YACL_ENFORCE(ctx->getField() != FieldType::FM32,
+               "circuit psi needs a field of at least 64 bits");
+  YACL_ENFORCE(options.receiver_rank < 2, "invalid receiver_rank={}",
+               options.receiver_rank);
+
+  auto link_ctx = ctx->lctx()->Spawn();
+  const bool is_receiver = link_ctx->Rank() == options.receiver_rank;
+  const size_t self_size = items_hash.size();
+  const size_t peer_size = ExchangeSetSize(link_ctx, self_size);
+  YACL_ENFORCE((peer_size > 0) && (self_size > 0),
+               "item size need not zero, mine={}, peer={}", self_size,
+               peer_size);
+  if (!is_receiver) {
+    YACL_ENFORCE(payloads.empty() || payloads.size() == self_size,
+                 "payloads size={} mismatch items size={}", payloads.size(),
+                 self_size);
+    for (auto payload : payloads) {
+      YACL_ENFORCE(payload < kPrime, "payload {} is not below 2^61 - 1",
+                   payload);
+    }
+  }
+
+  const size_t receiver_size = is_receiver ? self_size : peer_size;
+  const size_t sender_size = is_receiver ? peer_size : self_size;
+  auto cuckoo_options = CuckooIndex::SelectParams(
+      receiver_size, 0, kCuckooHashNum, options.stat_sec_param);
+  const size_t num_bins = cuckoo_options.NumBins();
+  const size_t max_load =
+      MaxBinLoad(sender_size, num_bins, options.stat_sec_param);
+
+  CircuitPsiResult result;
+  std::vector<int64_t> member_shares(num_bins);
+  std::vector<int64_t> payload_shares(num_bins);
+  if (is_receiver) {
+    result.bin_items =
+        RecvPrograms(link_ctx, items_hash, cuckoo_options, max_load,
+                     &member_shares, &payload_shares);
+  } else {
+    SendPrograms(link_ctx, items_hash, payloads, num_bins, max_load,
+                 &member_shares, &payload_shares);
+  }
+
+  // the receiver has r_b iff matched, so the member shares are of zero.
+  auto member_diff = MakeShares(ctx, member_shares);
+  result.membership =
+      kernel::hal::_eqz(ctx, member_diff).setDtype(DT_I1);
+
+  // the receiver has (payload + s_b) mod p, the sum of the shares v is in
+  // (-p, p), and the payload is v + p * (v < 0).
+  const std::vector<int64_t> shape = {static_cast<int64_t>(num_bins)};
+  auto v = MakeShares(ctx, payload_shares);
+  auto wrapped =
+      kernel::hal::_less(ctx, v, kernel::hal::constant(ctx, int64_t(0), shape));
+  auto payload = kernel::hal::_add(
+      ctx, v,
+      kernel::hal::_mul(
+          ctx, wrapped,
+          kernel::hal::constant(ctx, static_cast<int64_t>(kPrime), shape)));
+  result.payload = kernel::hal::_mul(ctx, result.membership, payload)
+                       .setDtype(DT_I64);
+
+  return result;
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,81 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "yacl/base/int128.h"
+
+#include "spu/kernel/context.h"
+#include "spu/kernel/value.h"
+
+//
+// Circuit PSI, the intersection is not revealed to either party, but output
+// as secret shares aligned to the cuckoo bins of the receiver, so it is fed
+// to the following spu computation as is.
+//
+// The receiver cuckoo hashes its items, the sender simple hashes its items
+// to all the bins of them. A KKRT oprf runs per bin, then the sender
+// programs the oprf of every bin by a polynomial (OPPRF), which evaluates to
+// a random target r_b at the sender items of the bin, so the receiver gets
+// r_b iff its item of the bin is one of the sender, and the difference of
+// the two sides is an additive share of zero exactly for the matched bins.
+// Payloads are programmed the same way, masked by another target s_b.
+//
+// Reference:
+// PSTY19 Efficient Circuit-based PSI with Linear Communication
+// https://eprint.iacr.org/2019/241.pdf
+//
+namespace spu::psi {
+
+struct CircuitPsiOptions {
+  // the rank of the cuckoo hashing party, the other rank programs the oprf
+  // and owns the payloads.
+  size_t receiver_rank = 0;
+
+  // cuckoo hashing and the bin load bound of the sender fail by probability
+  // 2^-stat_sec_param.
+  size_t stat_sec_param = 40;
+};
+
+struct CircuitPsiResult {
+  // secret DT_I1 of the number of bins, 1 if the item of the receiver in the
+  // bin is also an item of the sender.
+  spu::Value membership;
+
+  // secret DT_I64 of the number of bins, the payload of the matched sender
+  // item, 0 for the other bins.
+  spu::Value payload;
+
+  // receiver only, the input index of the item in every bin, -1 for the
+  // empty bins.
+  std::vector<int64_t> bin_items;
+};
+
+//
+// Run by both parties of a 2pc context of additive arithmetic shares, e.g.
+// SEMI2K and CHEETAH, the shares are made locally from the oprf outputs and
+// only the equality tests run in spu.
+//
+// items should be prepocessed by a hash like kkrt psi. `payloads` are of the
+// sender, one per item below 2^61 - 1, or empty for no payload. They are
+// ignored for the receiver.
+//
+CircuitPsiResult CircuitPsi(HalContext* ctx, const CircuitPsiOptions& options,
+                            const std::vector<uint128_t>& items_hash,
+                            const std::vector<uint64_t>& payloads = {});
+
+}  // namespace spu::psi
@@ -0,0 +1,126 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/circuit_psi.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+#include "yacl/crypto/utils/hash_util.h"
+
+#include "spu/kernel/hal/test_util.h"
+#include "spu/kernel/hal/type_cast.h"
+#include "spu/mpc/util/simulate.h"
+
+namespace spu::psi {
+
+namespace {
+
+std::vector<uint128_t> CreateRangeItems(size_t begin, size_t size) {
+  std::vector<uint128_t> ret;
+  for (size_t i = 0; i < size; ++i) {
+    ret.push_back(yacl::crypto::Blake3_128(std::to_string(begin + i)));
+  }
+  return ret;
+}
+
+struct RevealedResult {
+  xt::xarray<int64_t> membership;
+  xt::xarray<int64_t> payload;
+  std::vector<int64_t> bin_items;
+};
+
+}  // namespace
+
+class CircuitPsiTest
+    : public ::testing::TestWithParam<std::tuple<ProtocolKind, size_t>> {};
+
+TEST_P(CircuitPsiTest, Works) {
+  const auto protocol = std::get<0>(GetParam());
+  const size_t receiver_rank = std::get<1>(GetParam());
+
+  // the receiver has [0, 1000), the sender has [600, 1600).
+  const auto receiver_items = CreateRangeItems(0, 1000);
+  const auto sender_items = CreateRangeItems(600, 1000);
+  std::vector<uint64_t> payloads(sender_items.size());
+  for (size_t i = 0; i < payloads.size(); ++i) {
+    payloads[i] = (i + 600) * 7 + 3;
+  }
+
+  auto results = mpc::util::simulate(
+      2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+        RuntimeConfig conf;
+        conf.set_protocol(protocol);
+        conf.set_field(FieldType::FM64);
+        HalContext ctx(conf, lctx);
+
+        CircuitPsiOptions options;
+        options.receiver_rank = receiver_rank;
+        const bool is_receiver = lctx->Rank() == receiver_rank;
+        auto result = CircuitPsi(&ctx, options,
+                                 is_receiver ? receiver_items : sender_items,
+                                 is_receiver ? std::vector<uint64_t>{}
+                                             : payloads);
+        EXPECT_TRUE(result.membership.isSecret());
+        EXPECT_TRUE(result.payload.isSecret());
+
+        RevealedResult revealed;
+        revealed.membership = kernel::hal::test::dump_public_as<int64_t>(
+            &ctx, kernel::hal::reveal(&ctx, result.membership));
+        revealed.payload = kernel::hal::test::dump_public_as<int64_t>(
+            &ctx, kernel::hal::reveal(&ctx, result.payload));
+        revealed.bin_items = result.bin_items;
+        return revealed;
+      });
+
+  const auto& revealed = results[receiver_rank];
+  EXPECT_TRUE(results[1 - receiver_rank].bin_items.empty());
+  ASSERT_EQ(revealed.membership.size(), revealed.bin_items.size());
+
+  size_t num_matched = 0;
+  for (size_t b = 0; b < revealed.bin_items.size(); ++b) {
+    const int64_t idx = revealed.bin_items[b];
+    if (idx >= 600) {
+      num_matched++;
+      EXPECT_EQ(revealed.membership(b), 1) << b;
+      EXPECT_EQ(revealed.payload(b), idx * 7 + 3) << b;
+    } else {
+      EXPECT_EQ(revealed.membership(b), 0) << b;
+      EXPECT_EQ(revealed.payload(b), 0) << b;
+    }
+  }
+  EXPECT_EQ(num_matched, 400);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Works_Instances, CircuitPsiTest,
+    testing::Combine(testing::Values(ProtocolKind::SEMI2K,
+                                     ProtocolKind::CHEETAH),
+                     testing::Values(size_t{0}, size_t{1})));
+
+TEST(CircuitPsiSetupTest, Only2PC) {
+  mpc::util::simulate(
+      3, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+        RuntimeConfig conf;
+        conf.set_protocol(ProtocolKind::ABY3);
+        conf.set_field(FieldType::FM64);
+        HalContext ctx(conf, lctx);
+
+        EXPECT_THROW(CircuitPsi(&ctx, {}, CreateRangeItems(0, 10)),
+                     ::yacl::EnforceNotMet);
+      });
+}
+
+}  // namespace spu::psi
@@ -14,11 +14,24 @@
 
 #include "spu/psi/core/cuckoo_index.h"
 
+#include <algorithm>
 #include <cmath>
 #include <set>
 
+#include "yacl/utils/parallel.h"
+
 namespace spu::psi {
 
+namespace {
+
+// 2MB of bins in a partition to stay in cache.
+constexpr size_t kBinsPerPartition = 1 << 18;
+constexpr size_t kMaxPartitions = 1 << 12;
+// Bins fetched ahead of the one being swapped.
+constexpr size_t kPrefetchDistance = 8;
+
+}  // namespace
+
 CuckooIndex::CuckooIndex(const Options& options) : options_(options) {
   bins_.resize(options_.NumBins());
   stash_.resize(options_.num_stash);
@@ -32,7 +45,6 @@ CuckooIndex::CuckooIndex(const Options& options) : options_(options) {
 void CuckooIndex::Insert(absl::Span<const HashType> codes) {
   const size_t input_offset = hashes_.size();
   const size_t size = codes.size();
-  const size_t num_bins = options_.NumBins();
 
   // Add to hash rooms.
   for (const HashType& code : codes) {
@@ -47,24 +59,14 @@ void CuckooIndex::Insert(absl::Span<const HashType> codes) {
   }
 
   size_t try_count = 0;
-  std::vector<Bin> evicted;
 
   while (!candidates.empty() && try_count++ < options_.max_try_count) {
-    size_t write_idx = 0;
-    for (size_t i = 0; i < candidates.size(); ++i) {
-      const Bin candid = candidates[i];
-      size_t bin_idx =
-          hashes_[candid.InputIdx()].GetHash(candid.HashIdx()) % num_bins;
-      Bin evicted_bin = Bin(bins_[bin_idx].Swap(candid.encoded()));
-      if (!evicted_bin.IsEmpty()) {
-        // Try next hash for evicted items.
-        uint64_t next_candid =
-            Bin::Encode(evicted_bin.InputIdx(),
-                        (evicted_bin.HashIdx() + 1) % options_.num_hash);
-        candidates[write_idx++].set_encoded(next_candid);
-      }
+    if (options_.parallel_insert &&
+        candidates.size() >= kParallelInsertThreshold) {
+      ParallelInsertRound(&candidates);
+    } else {
+      InsertRound(&candidates);
     }
-    candidates.resize(write_idx);
   }
 
   for (size_t i = 0; i < candidates.size(); ++i) {
@@ -72,6 +74,91 @@ void CuckooIndex::Insert(absl::Span<const HashType> codes) {
   }
 }
 
+void CuckooIndex::InsertRound(std::vector<Bin>* candidates) {
+  const size_t num_bins = options_.NumBins();
+  size_t write_idx = 0;
+  for (size_t i = 0; i < candidates->size(); ++i) {
+    const Bin candid = (*candidates)[i];
+    size_t bin_idx =
+        hashes_[candid.InputIdx()].GetHash(candid.HashIdx()) % num_bins;
+    Bin evicted_bin = Bin(bins_[bin_idx].Swap(candid.encoded()));
+    if (!evicted_bin.IsEmpty()) {
+      // Try next hash for evicted items.
+      uint64_t next_candid =
+          Bin::Encode(evicted_bin.InputIdx(),
+                      (evicted_bin.HashIdx() + 1) % options_.num_hash);
+      (*candidates)[write_idx++].set_encoded(next_candid);
+    }
+  }
+  candidates->resize(write_idx);
+}
+
+void CuckooIndex::ParallelInsertRound(std::vector<Bin>* candidates) {
+  const size_t num_bins = options_.NumBins();
+  const size_t size = candidates->size();
+  const size_t num_parts =
+      std::clamp<size_t>(num_bins / kBinsPerPartition, 1, kMaxPartitions);
+  auto part_of = [&](uint64_t bin_idx) {
+    return bin_idx * num_parts / num_bins;
+  };
+
+  std::vector<uint64_t> bin_indices(size);
+  yacl::parallel_for(0, size, 4096, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const Bin candid = (*candidates)[i];
+      bin_indices[i] =
+          hashes_[candid.InputIdx()].GetHash(candid.HashIdx()) % num_bins;
+    }
+  });
+
+  // Stable counting sort of the candidates by partition, so that a bin sees
+  // its candidates in the same order as a serial round.
+  std::vector<size_t> part_begin(num_parts + 1, 0);
+  for (size_t i = 0; i < size; ++i) {
+    part_begin[part_of(bin_indices[i]) + 1]++;
+  }
+  for (size_t p = 0; p < num_parts; ++p) {
+    part_begin[p + 1] += part_begin[p];
+  }
+  std::vector<size_t> order(size);
+  {
+    std::vector<size_t> part_end(part_begin.begin(), part_begin.end() - 1);
+    for (size_t i = 0; i < size; ++i) {
+      order[part_end[part_of(bin_indices[i])]++] = i;
+    }
+  }
+
+  // Evicted candidates are kept at the position of the one evicting them.
+  std::vector<Bin> evicted(size);
+  yacl::parallel_for(0, num_parts, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      const size_t part_end = part_begin[p + 1];
+      for (size_t k = part_begin[p]; k < part_end; ++k) {
+        if (k + kPrefetchDistance < part_end) {
+          __builtin_prefetch(
+              &bins_[bin_indices[order[k + kPrefetchDistance]]], 1);
+        }
+        const size_t i = order[k];
+        Bin evicted_bin =
+            Bin(bins_[bin_indices[i]].Swap((*candidates)[i].encoded()));
+        if (!evicted_bin.IsEmpty()) {
+          evicted[i].set_encoded(
+              Bin::Encode(evicted_bin.InputIdx(),
+                          (evicted_bin.HashIdx() + 1) % options_.num_hash));
+        }
+      }
+    }
+  });
+
+  size_t write_idx = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (!evicted[i].IsEmpty()) {
+      (*candidates)[write_idx++] = evicted[i];
+    }
+  }
+  candidates->resize(write_idx);
+}
+
 void CuckooIndex::PutToStash(uint64_t input_idx) {
   // `stash` is small enough to do a linear search.
   for (size_t i = 0; i < stash_.size(); ++i) {
@@ -110,6 +110,9 @@ class CuckooIndex {
     // evicted items will be put into `stash` finally. If the stash is full, an
     // exception will ocurred.
     uint64_t max_try_count = 128;
+    // Run eviction rounds of many candidates in parallel. The bins are the
+    // same as a serial insert.
+    bool parallel_insert = true;
 
     uint64_t NumBins() const {
       uint64_t num_bins = num_input * scale_factor;
@@ -134,8 +137,16 @@ class CuckooIndex {
   const std::vector<HashRoom>& hashes() const { return hashes_; }
 
   // This interface assumes `inputs` are already cryptographic random.
+  //
+  // Candidates are placed in rounds, and every evicted one retries with its
+  // next hash in the next round. A round of at least
+  // `kParallelInsertThreshold` candidates is partitioned by contiguous ranges
+  // of bins, each placed in order by one thread, so the result does not
+  // depend on the number of threads.
   void Insert(absl::Span<const HashType> codes);
 
+  static constexpr size_t kParallelInsertThreshold = 1 << 16;
+
   // For debug only.
   void SanityCheck() const;
 
@@ -147,6 +158,10 @@ class CuckooIndex {
  private:
   void PutToStash(uint64_t input_idx);
 
+  // Place the candidates and keep the evicted ones as the next candidates.
+  void InsertRound(std::vector<Bin>* candidates);
+  void ParallelInsertRound(std::vector<Bin>* candidates);
+
   const Options options_;
   std::vector<Bin> bins_;
   std::vector<Bin> stash_;
@@ -0,0 +1,44 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "yacl/crypto/base/symmetric_crypto.h"
+
+#include "spu/psi/core/cuckoo_index.h"
+
+// range(0): number of inputs, range(1): parallel insert or not.
+static void BM_CuckooIndexInsert(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    spu::psi::CuckooIndex::Options options{
+        static_cast<uint64_t>(state.range(0)), 0, 3, 1.3};
+    options.parallel_insert = state.range(1) != 0;
+    std::vector<uint128_t> inputs(options.num_input);
+    yacl::FillAesRandom(std::random_device()(), 0, 0, absl::MakeSpan(inputs));
+    spu::psi::CuckooIndex cuckoo_index(options);
+    state.ResumeTiming();
+
+    cuckoo_index.Insert(absl::MakeSpan(inputs));
+  }
+}
+
+// [1m, 4m, 16m, 64m] x [serial, parallel]
+BENCHMARK(BM_CuckooIndexInsert)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgsProduct({{1 << 20, 4 << 20, 16 << 20, 64 << 20}, {0, 1}});
+
+BENCHMARK_MAIN();
@@ -68,6 +68,30 @@ INSTANTIATE_TEST_SUITE_P(
         CuckooIndex::Options{(1 << 0), 0, 3, 1.2}         // dummy
         ));
 
+TEST(CuckooIndexTest, ParallelInsertSameBins) {
+  CuckooIndex::Options options{(1 << 20) + 17, 4, 3, 1.2};
+  std::vector<uint128_t> inputs(options.num_input);
+  yacl::FillAesRandom(std::random_device()(), 0, 0, absl::MakeSpan(inputs));
+
+  CuckooIndex parallel_index(options);
+  parallel_index.Insert(absl::MakeSpan(inputs));
+  ASSERT_NO_THROW(parallel_index.SanityCheck());
+
+  options.parallel_insert = false;
+  CuckooIndex serial_index(options);
+  serial_index.Insert(absl::MakeSpan(inputs));
+
+  ASSERT_EQ(parallel_index.bins().size(), serial_index.bins().size());
+  for (size_t i = 0; i < serial_index.bins().size(); ++i) {
+    ASSERT_EQ(parallel_index.bins()[i].encoded(),
+              serial_index.bins()[i].encoded());
+  }
+  for (size_t i = 0; i < serial_index.stash().size(); ++i) {
+    ASSERT_EQ(parallel_index.stash()[i].encoded(),
+              serial_index.stash()[i].encoded());
+  }
+}
+
 TEST(CuckooIndexTest, Bad_StashTooSmall) {
   CuckooIndex cuckoo_index(CuckooIndex::Options{1 << 16, 0, 3, 1.1});
   std::vector<uint128_t> inputs(1 << 16);
@@ -15,8 +15,11 @@
 #include "spu/psi/core/dp_psi/dp_psi.h"
 
 #include <algorithm>
+#include <cstring>
 #include <future>
+#include <numeric>
 #include <random>
+#include <string_view>
 
 #include "spdlog/spdlog.h"
 #include "yacl/base/buffer.h"
@@ -40,66 +43,207 @@ namespace {
 
 constexpr uint64_t kSendBatchSize = 8192;
 
-std::vector<size_t> BernoulliSamples(const std::vector<size_t>& items_idx,
-                                     double q) {
+// Bob reads, sub samples and masks the items by batches of it.
+constexpr size_t kReadBatchSize = 1 << 16;
+
+// Bernoulli samples are drawn in parallel by chunks of it, each chunk with
+// its own generator.
+constexpr size_t kSampleChunkSize = 1 << 14;
+
+// Ascending indices of [0, n), where index i is kept with probability
+// `keep_prob(i)`. The generators of the chunks are seeded from one random
+// seed, so the samples do not depend on the number of threads.
+template <typename KeepProb>
+std::vector<size_t> BernoulliSamples(size_t n, const KeepProb& keep_prob) {
   std::pair<uint64_t, uint64_t> seed_pair =
       yacl::DecomposeUInt128(yacl::RandSeed());
-  std::mt19937 rand(seed_pair.first);
 
-  SPDLOG_INFO("sample bernoulli_distribution: {}", q);
+  size_t num_chunks = (n + kSampleChunkSize - 1) / kSampleChunkSize;
+  std::vector<std::vector<size_t>> chunk_samples(num_chunks);
+  yacl::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; ++chunk) {
+      std::seed_seq seed_seq{static_cast<uint32_t>(seed_pair.first),
+                             static_cast<uint32_t>(seed_pair.first >> 32),
+                             static_cast<uint32_t>(seed_pair.second),
+                             static_cast<uint32_t>(seed_pair.second >> 32),
+                             static_cast<uint32_t>(chunk)};
+      std::mt19937_64 rand(seed_seq);
+
+      size_t chunk_begin = chunk * kSampleChunkSize;
+      size_t chunk_end = std::min(chunk_begin + kSampleChunkSize, n);
+      for (size_t idx = chunk_begin; idx < chunk_end; ++idx) {
+        if (std::bernoulli_distribution(keep_prob(idx))(rand)) {
+          chunk_samples[chunk].push_back(idx);
+        }
+      }
+    }
+  });
 
-  std::bernoulli_distribution dist(q);
+  size_t samples_size = 0;
+  for (const auto& samples : chunk_samples) {
+    samples_size += samples.size();
+  }
+  std::vector<size_t> samples_idx;
+  samples_idx.reserve(samples_size);
+  for (const auto& samples : chunk_samples) {
+    samples_idx.insert(samples_idx.end(), samples.begin(), samples.end());
+  }
+  return samples_idx;
+}
+
+// Fixed width items in one flat buffer.
+class PackedItems {
+ public:
+  explicit PackedItems(size_t item_size) : item_size_(item_size) {}
+
+  void Append(std::string_view item) {
+    YACL_ENFORCE(item.size() == item_size_, "item size {} != {}",
+                 item.size(), item_size_);
+    buffer_.append(item);
+  }
 
-  std::vector<size_t> bernoulli_items_idx;
-  for (size_t idx = 0; idx < items_idx.size(); idx++) {
-    if (dist(rand)) {
-      bernoulli_items_idx.push_back(items_idx[idx]);
+  size_t size() const { return buffer_.size() / item_size_; }
+
+  std::string_view operator[](size_t idx) const {
+    return std::string_view(buffer_).substr(idx * item_size_, item_size_);
+  }
+
+  // Sort the items unless they are sorted already, as the dual masks sent by
+  // MaskShufflePeer.
+  void Sort() {
+    bool sorted = true;
+    for (size_t idx = 1; idx < size() && sorted; ++idx) {
+      sorted = (*this)[idx - 1] <= (*this)[idx];
+    }
+    if (sorted) {
+      return;
     }
+
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+      return (*this)[lhs] < (*this)[rhs];
+    });
+    std::string sorted_buffer;
+    sorted_buffer.reserve(buffer_.size());
+    for (size_t idx : order) {
+      sorted_buffer.append((*this)[idx]);
+    }
+    buffer_.swap(sorted_buffer);
   }
 
-  SPDLOG_INFO(
-      "bernoulli_items_idx:{} ratio:{} ", bernoulli_items_idx.size(),
-      static_cast<double>(bernoulli_items_idx.size()) / items_idx.size());
+  // The items should be sorted.
+  bool Contains(std::string_view item) const {
+    size_t begin = 0;
+    size_t end = size();
+    while (begin < end) {
+      size_t mid = begin + (end - begin) / 2;
+      if ((*this)[mid] < item) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin < size() && (*this)[begin] == item;
+  }
 
-  return bernoulli_items_idx;
-}
+ private:
+  const size_t item_size_;
+  std::string buffer_;
+};
 
-std::pair<std::vector<std::string>, std::vector<size_t>> BernoulliSamples(
-    const std::vector<std::string>& items,
-    const std::vector<size_t>& shuffled_idx, double p) {
-  std::pair<uint64_t, uint64_t> seed_pair =
-      yacl::DecomposeUInt128(yacl::RandSeed());
-  std::mt19937 rand(seed_pair.first);
+class PackedCipherStore : public ICipherStore {
+ public:
+  explicit PackedCipherStore(size_t item_size)
+      : self_results_(item_size), peer_results_(item_size) {}
+
+  void SaveSelf(std::string ciphertext) override {
+    self_results_.Append(ciphertext);
+  }
+
+  void SavePeer(std::string ciphertext) override {
+    peer_results_.Append(ciphertext);
+  }
+
+  PackedItems& self_results() { return self_results_; }
 
-  SPDLOG_INFO("sample bernoulli_distribution: {}", p);
+  PackedItems& peer_results() { return peer_results_; }
 
-  std::bernoulli_distribution dist(p);
+ private:
+  PackedItems self_results_;
+  PackedItems peer_results_;
+};
 
-  std::vector<std::string> bernoulli_items;
-  std::vector<size_t> bernoulli_idx;
-  for (size_t idx = 0; idx < items.size(); idx++) {
-    if (dist(rand)) {
-      bernoulli_items.push_back(items[shuffled_idx[idx]]);
-      bernoulli_idx.push_back(shuffled_idx[idx]);
+// Sub sample the items as they are read, mask them and send them in the
+// order of the masks, which tells nothing of the read order. Return the read
+// positions of the sent items in the send order.
+std::vector<uint64_t> SubSampleMaskSendSelf(
+    const DpPsiOptions& dp_psi_options,
+    const std::shared_ptr<IEccCryptor>& cryptor,
+    const std::shared_ptr<IBatchProvider>& batch_provider,
+    EcdhP2PExtendCtx* psi_ctx, size_t* items_size) {
+  const size_t mask_length = cryptor->GetMaskLength();
+  // a mask followed by the read position of its item.
+  ExternalItemSorter sorter(dp_psi_options.cache_dir,
+                            mask_length + sizeof(uint64_t),
+                            dp_psi_options.max_in_memory_bytes);
+
+  *items_size = 0;
+  std::vector<std::string> batch_items =
+      batch_provider->ReadNextBatch(kReadBatchSize);
+  while (!batch_items.empty()) {
+    // read the next batch while this one is sampled and masked.
+    auto next_batch_items = std::async(std::launch::async, [&] {
+      return batch_provider->ReadNextBatch(kReadBatchSize);
+    });
+
+    std::vector<size_t> sample_idx = BernoulliSamples(
+        batch_items.size(), [&](size_t) { return dp_psi_options.p1; });
+    std::vector<std::string> sample_items(sample_idx.size());
+    for (size_t idx = 0; idx < sample_idx.size(); ++idx) {
+      sample_items[idx] = std::move(batch_items[sample_idx[idx]]);
     }
-  }
 
-  SPDLOG_INFO("bernoulli_items: {}, bernoulli_idx:{} ratio:{} ",
-              bernoulli_items.size(), bernoulli_idx.size(),
-              static_cast<double>(bernoulli_items.size()) / items.size());
-  return std::make_pair(bernoulli_items, bernoulli_idx);
-}
+    std::vector<std::string> records =
+        Mask(cryptor, HashInputs(cryptor, sample_items));
+    for (size_t idx = 0; idx < records.size(); ++idx) {
+      YACL_ENFORCE(records[idx].size() == mask_length);
+      uint64_t read_pos = *items_size + sample_idx[idx];
+      records[idx].append(reinterpret_cast<const char*>(&read_pos),
+                          sizeof(read_pos));
+    }
+    sorter.Add(records);
 
-std::vector<size_t> GetShuffledIdx(size_t items_size) {
-  std::pair<uint64_t, uint64_t> seed_pair =
-      yacl::DecomposeUInt128(yacl::RandSeed());
-  std::mt19937 rng(seed_pair.first);
+    *items_size += batch_items.size();
+    batch_items = next_batch_items.get();
+  }
+
+  SPDLOG_INFO("bob items_size: {}, sub sampled: {}, runs: {}", *items_size,
+              sorter.size(), sorter.num_runs());
 
-  std::vector<size_t> shuffled_idx_vec(items_size);
-  std::iota(shuffled_idx_vec.begin(), shuffled_idx_vec.end(), 0);
-  std::shuffle(shuffled_idx_vec.begin(), shuffled_idx_vec.end(), rng);
+  std::vector<uint64_t> send_pos;
+  send_pos.reserve(sorter.size());
+  auto reader = sorter.Finalize();
+  size_t batch_count = 0;
+  while (true) {
+    std::vector<std::string> records = reader->NextBatch(kEcdhPsiBatchSize);
+    std::vector<std::string> masked_items(records.size());
+    for (size_t idx = 0; idx < records.size(); ++idx) {
+      masked_items[idx] = records[idx].substr(0, mask_length);
+      uint64_t read_pos;
+      std::memcpy(&read_pos, records[idx].data() + mask_length,
+                  sizeof(read_pos));
+      send_pos.push_back(read_pos);
+    }
+    // an empty batch tells the end of items.
+    psi_ctx->ForwardBatch(masked_items, batch_count);
+    if (records.empty()) {
+      break;
+    }
+    batch_count++;
+  }
 
-  return shuffled_idx_vec;
+  return send_pos;
 }
 
 }  // namespace
@@ -109,12 +253,18 @@ size_t RunDpEcdhPsiAlice(const DpPsiOptions& dp_psi_options,
                          const std::vector<std::string>& items,
                          size_t* sub_sample_size, size_t* up_sample_size,
                          CurveType curve) {
-  auto memory_store = std::make_shared<MemoryCipherStore>();
-  auto batch_provider = std::make_shared<MemoryBatchProvider>(items);
+  return RunDpEcdhPsiAlice(dp_psi_options, link_ctx,
+                           std::make_shared<MemoryBatchProvider>(items),
+                           sub_sample_size, up_sample_size, curve);
+}
 
-  SPDLOG_INFO(
-      "alice items_size: {}, downsampling_rate: {}, upsampling_rate: {}",
-      items.size(), dp_psi_options.p2, dp_psi_options.q);
+size_t RunDpEcdhPsiAlice(const DpPsiOptions& dp_psi_options,
+                         const std::shared_ptr<yacl::link::Context>& link_ctx,
+                         const std::shared_ptr<IBatchProvider>& batch_provider,
+                         size_t* sub_sample_size, size_t* up_sample_size,
+                         CurveType curve) {
+  SPDLOG_INFO("alice downsampling_rate: {}, upsampling_rate: {}",
+              dp_psi_options.p2, dp_psi_options.q);
 
   EcdhPsiOptions options;
 
@@ -124,44 +274,40 @@ size_t RunDpEcdhPsiAlice(const DpPsiOptions& dp_psi_options,
 
   EcdhP2PExtendCtx psi_ctx(options);
 
+  auto cipher_store =
+      std::make_shared<PackedCipherStore>(options.dual_mask_size);
+
   std::future<void> f_mask_self_a =
       std::async([&] { return psi_ctx.MaskSelf(batch_provider); });
 
   std::future<void> f_recv_peer_a =
-      std::async([&] { return psi_ctx.MaskPeer(memory_store); });
+      std::async([&] { return psi_ctx.MaskPeer(cipher_store); });
 
   f_mask_self_a.get();
   f_recv_peer_a.get();
 
   SPDLOG_INFO("after maskSelf maskPeer");
 
-  std::vector<std::string>& alice_peer_result = memory_store->peer_results();
-
-  std::vector<std::string> self_dual_mask;
-
-  std::future<void> f_recv_dual_mask_a =
-      std::async([&] { return psi_ctx.RecvItems(&self_dual_mask); });
-  f_recv_dual_mask_a.get();
+  psi_ctx.RecvDualMaskedSelf(cipher_store);
 
-  // std::vector<std::string> intersection_ab;
-  std::vector<size_t> intersection_idx;
-  std::vector<size_t> non_intersection_idx;
+  PackedItems& self_dual_mask = cipher_store->self_results();
+  self_dual_mask.Sort();
 
-  std::sort(self_dual_mask.begin(), self_dual_mask.end());
+  const PackedItems& alice_peer_result = cipher_store->peer_results();
+  const size_t peer_size = alice_peer_result.size();
 
-  for (size_t index = 0; index < alice_peer_result.size(); index++) {
-    if (std::binary_search(self_dual_mask.begin(), self_dual_mask.end(),
-                           alice_peer_result[index])) {
-      YACL_ENFORCE(index < alice_peer_result.size());
-
-      intersection_idx.push_back(index);
-    } else {
-      non_intersection_idx.push_back(index);
+  std::vector<uint8_t> in_intersection(peer_size);
+  yacl::parallel_for(0, peer_size, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      in_intersection[idx] = self_dual_mask.Contains(alice_peer_result[idx]);
     }
-  }
-  // check non_intersection_idx size==0
+  });
+  size_t intersection_size =
+      std::count(in_intersection.begin(), in_intersection.end(), 1);
+
+  // check non intersection size==0
   // if size==0 report intersection 0
-  if (non_intersection_idx.size() == 0) {
+  if (intersection_size == peer_size) {
     yacl::Buffer intersection_idx_size_buffer = utils::SerializeSize(0);
     link_ctx->SendAsync(link_ctx->NextRank(), intersection_idx_size_buffer,
                         fmt::format("intersection_idx size: {}", 0));
@@ -171,19 +317,23 @@ size_t RunDpEcdhPsiAlice(const DpPsiOptions& dp_psi_options,
     return 0;
   }
 
-  std::vector<size_t> sub_sample_idx =
-      BernoulliSamples(intersection_idx, dp_psi_options.p2);
-
-  std::vector<size_t> up_sample_idx =
-      BernoulliSamples(non_intersection_idx, dp_psi_options.q);
+  SPDLOG_INFO("sample bernoulli_distribution: {} {}", dp_psi_options.p2,
+              dp_psi_options.q);
 
-  *sub_sample_size = intersection_idx.size() - sub_sample_idx.size();
-  *up_sample_size = up_sample_idx.size();
-
-  sub_sample_idx.insert(sub_sample_idx.end(), up_sample_idx.begin(),
-                        up_sample_idx.end());
-  // sort index, mix sub_sample_idx and up_sample_idx
-  std::sort(sub_sample_idx.begin(), sub_sample_idx.end());
+  // sub sample the intersection and up sample the others, the idx are
+  // ascending, which mixes them.
+  std::vector<size_t> sub_sample_idx =
+      BernoulliSamples(peer_size, [&](size_t idx) {
+        return in_intersection[idx] != 0 ? dp_psi_options.p2
+                                         : dp_psi_options.q;
+      });
+
+  size_t sub_sample_kept = 0;
+  for (size_t idx : sub_sample_idx) {
+    sub_sample_kept += in_intersection[idx];
+  }
+  *sub_sample_size = intersection_size - sub_sample_kept;
+  *up_sample_size = sub_sample_idx.size() - sub_sample_kept;
 
   SPDLOG_INFO("alice intersection size: {}", sub_sample_idx.size());
 
@@ -221,19 +371,17 @@ std::vector<size_t> RunDpEcdhPsiBob(
     const std::shared_ptr<yacl::link::Context>& link_ctx,
     const std::vector<std::string>& items, size_t* sub_sample_size,
     CurveType curve) {
-  std::vector<size_t> bob_shuffled_idx = GetShuffledIdx(items.size());
-
-  SPDLOG_INFO("bob items_size: {}, downsampling_rate: {}", items.size(),
-              dp_psi_options.p1);
-
-  std::pair<std::vector<std::string>, std::vector<size_t>> sub_sample_result =
-      BernoulliSamples(items, bob_shuffled_idx, dp_psi_options.p1);
-
-  *sub_sample_size = items.size() - sub_sample_result.first.size();
+  return RunDpEcdhPsiBob(dp_psi_options, link_ctx,
+                         std::make_shared<MemoryBatchProvider>(items),
+                         sub_sample_size, curve);
+}
 
-  auto batch_provider =
-      std::make_shared<MemoryBatchProvider>(sub_sample_result.first);
-  auto memory_store = std::make_shared<MemoryCipherStore>();
+std::vector<size_t> RunDpEcdhPsiBob(
+    const DpPsiOptions& dp_psi_options,
+    const std::shared_ptr<yacl::link::Context>& link_ctx,
+    const std::shared_ptr<IBatchProvider>& batch_provider,
+    size_t* sub_sample_size, CurveType curve) {
+  SPDLOG_INFO("bob downsampling_rate: {}", dp_psi_options.p1);
 
   EcdhPsiOptions options;
 
@@ -244,27 +392,25 @@ std::vector<size_t> RunDpEcdhPsiBob(
 
   EcdhP2PExtendCtx psi_ctx(options);
 
-  std::future<void> f_mask_peer_b =
-      std::async([&] { return psi_ctx.MaskPeer(memory_store); });
+  // send x^a^b to alice, shuffled by sorting.
+  std::future<void> f_mask_peer_b = std::async([&] {
+    return psi_ctx.MaskShufflePeer(dp_psi_options.cache_dir,
+                                   dp_psi_options.max_in_memory_bytes);
+  });
 
-  std::future<void> f_mask_self_b =
-      std::async([&] { return psi_ctx.MaskSelf(batch_provider); });
+  size_t items_size = 0;
+  std::vector<uint64_t> send_pos;
+  std::future<void> f_mask_self_b = std::async([&] {
+    send_pos = SubSampleMaskSendSelf(dp_psi_options, options.ecc_cryptor,
+                                     batch_provider, &psi_ctx, &items_size);
+  });
 
   f_mask_peer_b.get();
   f_mask_self_b.get();
 
-  SPDLOG_INFO("after mask self, mask peer");
-
-  std::vector<std::string>& bob_peer_result = memory_store->peer_results();
-  std::sort(bob_peer_result.begin(), bob_peer_result.end());
-
-  // send x^a^b to alice
-  std::future<void> f_bob_send_shuffle_dual_mask =
-      std::async([&] { return psi_ctx.SendItems(bob_peer_result); });
-
-  f_bob_send_shuffle_dual_mask.get();
+  SPDLOG_INFO("after mask self, mask shuffle peer");
 
-  SPDLOG_INFO("after send shuffled batch");
+  *sub_sample_size = items_size - send_pos.size();
 
   yacl::Buffer intersection_size_buffer = link_ctx->Recv(
       link_ctx->NextRank(), fmt::format("recv intersection_size"));
@@ -283,6 +429,7 @@ std::vector<size_t> RunDpEcdhPsiBob(
     YACL_ENFORCE(batch.flatten_bytes.size() % sizeof(size_t) == 0);
     size_t current_num;
     current_num = batch.flatten_bytes.size() / sizeof(size_t);
+    YACL_ENFORCE(recv_idx + current_num <= intersection_size);
     std::memcpy(intersection_idx.data() + recv_idx, batch.flatten_bytes.data(),
                 batch.flatten_bytes.size());
 
@@ -294,9 +441,10 @@ std::vector<size_t> RunDpEcdhPsiBob(
     }
   }
 
-  std::vector<size_t> dp_intersection_idx;
-  for (const auto& idx : intersection_idx) {
-    dp_intersection_idx.push_back(sub_sample_result.second[idx]);
+  std::vector<size_t> dp_intersection_idx(intersection_idx.size());
+  for (size_t idx = 0; idx < intersection_idx.size(); ++idx) {
+    YACL_ENFORCE(intersection_idx[idx] < send_pos.size());
+    dp_intersection_idx[idx] = send_pos[intersection_idx[idx]];
   }
   std::sort(dp_intersection_idx.begin(), dp_intersection_idx.end());
 
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <utility>
@@ -22,6 +23,8 @@
 #include "yacl/link/link.h"
 
 #include "spu/psi/core/ecdh_psi.h"
+#include "spu/psi/utils/batch_provider.h"
+#include "spu/psi/utils/item_sorter.h"
 
 namespace spu::psi {
 
@@ -46,6 +49,11 @@ struct DpPsiOptions {
   double p2;
   // alice UpSampling
   double q;
+
+  // bob shuffles its masked items by sorting them, out of core through
+  // `cache_dir` beyond `max_in_memory_bytes`.
+  std::string cache_dir = std::filesystem::temp_directory_path();
+  size_t max_in_memory_bytes = ExternalItemSorter::kDefaultMaxInMemoryBytes;
 };
 
 /**
@@ -65,6 +73,14 @@ size_t RunDpEcdhPsiAlice(const DpPsiOptions& dp_psi_options,
                          size_t* sub_sample_size, size_t* up_sample_size,
                          CurveType curve = CurveType::CURVE_25519);
 
+// Streaming version of RunDpEcdhPsiAlice. The items are read from
+// `batch_provider` and only their fixed width dual masks are kept.
+size_t RunDpEcdhPsiAlice(const DpPsiOptions& dp_psi_options,
+                         const std::shared_ptr<yacl::link::Context>& link_ctx,
+                         const std::shared_ptr<IBatchProvider>& batch_provider,
+                         size_t* sub_sample_size, size_t* up_sample_size,
+                         CurveType curve = CurveType::CURVE_25519);
+
 /**
  * @brief
  *
@@ -81,4 +97,13 @@ std::vector<size_t> RunDpEcdhPsiBob(
     const std::vector<std::string>& items, size_t* sub_sample_size,
     CurveType curve = CurveType::CURVE_25519);
 
+// Streaming version of RunDpEcdhPsiBob. The items are sub sampled and masked
+// batch by batch as read from `batch_provider`, and the returned idx are the
+// positions in the read order.
+std::vector<size_t> RunDpEcdhPsiBob(
+    const DpPsiOptions& dp_psi_options,
+    const std::shared_ptr<yacl::link::Context>& link_ctx,
+    const std::shared_ptr<IBatchProvider>& batch_provider,
+    size_t* sub_sample_size, CurveType curve = CurveType::CURVE_25519);
+
 }  // namespace spu::psi
@@ -164,6 +164,28 @@ std::vector<std::string> CreateRangeItems(size_t start_pos, size_t size) {
   return ret;
 }
 
+// Range items made as they are read, to stream inputs that do not fit in
+// memory.
+class RangeBatchProvider : public IBatchProvider {
+ public:
+  RangeBatchProvider(size_t start_pos, size_t size)
+      : next_pos_(start_pos), end_pos_(start_pos + size) {}
+
+  std::vector<std::string> ReadNextBatch(size_t batch_size) override {
+    size_t current_size = std::min(batch_size, end_pos_ - next_pos_);
+    std::vector<std::string> batch(current_size);
+    for (size_t i = 0; i < current_size; ++i) {
+      batch[i] = std::to_string(next_pos_ + i);
+    }
+    next_pos_ += current_size;
+    return batch;
+  }
+
+ private:
+  size_t next_pos_;
+  size_t end_pos_;
+};
+
 constexpr double kPayloadMu = 50;
 constexpr double kPayloadSigma = 8;
 constexpr double kPayloadMinValue = 0;
@@ -393,6 +415,66 @@ BENCHMARK(BM_DpPsi)
     ->Args({1 << 20, 4})
     ->Args({1 << 20, 5});
 
+static void BM_DpPsiStream(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    size_t items_size = state.range(0);
+
+    auto ctxs = CreateLinks(kLinkAddrAB);
+
+    ctxs[0]->SetThrottleWindowSize(kLinkWindowSize);
+    ctxs[1]->SetThrottleWindowSize(kLinkWindowSize);
+
+    ctxs[0]->SetRecvTimeout(kLinkRecvTimeout);
+    ctxs[1]->SetRecvTimeout(kLinkRecvTimeout);
+
+    auto provider_a = std::make_shared<RangeBatchProvider>(0, items_size);
+    auto provider_b = std::make_shared<RangeBatchProvider>(
+        items_size * (1 - kIntersectionRatio), items_size);
+
+    const DpPsiOptions& options = dp_psi_params_map[items_size];
+
+    state.ResumeTiming();
+
+    size_t alice_sub_sample_size;
+    size_t alice_up_sample_size;
+    size_t bob_sub_sample_size;
+
+    std::future<size_t> f_dp_psi_a = std::async([&] {
+      return RunDpEcdhPsiAlice(options, ctxs[0], provider_a,
+                               &alice_sub_sample_size, &alice_up_sample_size);
+    });
+
+    std::future<std::vector<size_t>> f_dp_psi_b = std::async([&] {
+      return RunDpEcdhPsiBob(options, ctxs[1], provider_b,
+                             &bob_sub_sample_size);
+    });
+
+    size_t alice_intersection_size = f_dp_psi_a.get();
+    std::vector<size_t> dp_psi_result = f_dp_psi_b.get();
+
+    SPDLOG_INFO(
+        "items_size:{} alice_intersection_size:{} "
+        "alice_sub_sample_size:{},alice_up_sample_size:{} "
+        "bob_sub_sample_size:{}",
+        items_size, alice_intersection_size, alice_sub_sample_size,
+        alice_up_sample_size, bob_sub_sample_size);
+
+    auto stats0 = ctxs[0]->GetStats();
+    double total_comm_bytes = stats0->sent_bytes + stats0->recv_bytes;
+    SPDLOG_INFO("total_comm_bytes:{} MB", total_comm_bytes / 1024 / 1024);
+  }
+}
+
+// [16m, 64m, 256m, 1b], streamed from batch providers.
+BENCHMARK(BM_DpPsiStream)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1)
+    ->Arg(16 << 20)
+    ->Arg(64 << 20)
+    ->Arg(256 << 20)
+    ->Arg(1 << 30);
+
 BENCHMARK_MAIN();
 
 }  // namespace spu::psi
@@ -134,6 +134,48 @@ TEST_P(DpPsiTest, Works) {
   SPDLOG_INFO("total_comm_bytes: {} MB", total_comm_bytes);
 }
 
+TEST(DpPsiStreamTest, KeepAllWorks) {
+  size_t items_size = 1000;
+
+  auto link_ctxs = yacl::link::test::SetupWorld(2);
+
+  std::vector<std::string> items_a = CreateRangeItems(0, items_size);
+  std::vector<std::string> items_b =
+      CreateRangeItems(items_size * (1 - kIntersectionRatio), items_size);
+
+  // keep every item of bob and the whole intersection, with no fake items.
+  DpPsiOptions options(1.0, 100);
+  EXPECT_EQ(options.p2, 1.0);
+  EXPECT_EQ(options.q, 0.0);
+  // bob spills the masked items to many runs.
+  options.max_in_memory_bytes = 1024;
+
+  size_t alice_sub_sample_size = 0;
+  size_t alice_up_sample_size = 0;
+  size_t bob_sub_sample_size = 0;
+
+  std::future<size_t> f_dp_psi_a = std::async([&] {
+    return RunDpEcdhPsiAlice(options, link_ctxs[0],
+                             std::make_shared<MemoryBatchProvider>(items_a),
+                             &alice_sub_sample_size, &alice_up_sample_size);
+  });
+
+  std::future<std::vector<size_t>> f_dp_psi_b = std::async([&] {
+    return RunDpEcdhPsiBob(options, link_ctxs[1],
+                           std::make_shared<MemoryBatchProvider>(items_b),
+                           &bob_sub_sample_size);
+  });
+
+  size_t alice_intersection_size = f_dp_psi_a.get();
+  std::vector<size_t> dp_psi_result = f_dp_psi_b.get();
+
+  EXPECT_EQ(alice_sub_sample_size, 0);
+  EXPECT_EQ(alice_up_sample_size, 0);
+  EXPECT_EQ(bob_sub_sample_size, 0);
+  EXPECT_EQ(alice_intersection_size, dp_psi_result.size());
+  EXPECT_EQ(dp_psi_result, GetIntersectionIdx(items_a, items_b));
+}
+
 INSTANTIATE_TEST_SUITE_P(Works_Instances, DpPsiTest,
                          testing::Values(                       //
                              TestParams{20, DpPsiOptions(0.8)}  // dummy
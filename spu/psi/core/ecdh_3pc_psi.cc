@@ -30,6 +30,60 @@
 
 namespace spu::psi {
 
+namespace {
+
+// Sorts the dual masked items of both sides out of core, to intersect them
+// by a merge.
+class SorterCipherStore : public ICipherStore {
+ public:
+  SorterCipherStore(const std::string& cache_dir, size_t item_size,
+                    size_t max_in_memory_bytes)
+      : self_sorter_(cache_dir, item_size, max_in_memory_bytes),
+        peer_sorter_(cache_dir, item_size, max_in_memory_bytes) {}
+
+  void SaveSelf(std::string ciphertext) override {
+    self_sorter_.Add(ciphertext);
+  }
+
+  void SavePeer(std::string ciphertext) override {
+    peer_sorter_.Add(ciphertext);
+  }
+
+  const ExternalItemSorter& self_sorter() const { return self_sorter_; }
+
+  const ExternalItemSorter& peer_sorter() const { return peer_sorter_; }
+
+  // The items of both sides, with duplicates as std::set_intersection.
+  std::vector<std::string> Intersect() {
+    auto self_reader = self_sorter_.Finalize();
+    auto peer_reader = peer_sorter_.Finalize();
+
+    std::vector<std::string> intersection;
+    std::string self_item;
+    std::string peer_item;
+    bool has_self = self_reader->Next(&self_item);
+    bool has_peer = peer_reader->Next(&peer_item);
+    while (has_self && has_peer) {
+      if (self_item < peer_item) {
+        has_self = self_reader->Next(&self_item);
+      } else if (peer_item < self_item) {
+        has_peer = peer_reader->Next(&peer_item);
+      } else {
+        intersection.push_back(self_item);
+        has_self = self_reader->Next(&self_item);
+        has_peer = peer_reader->Next(&peer_item);
+      }
+    }
+    return intersection;
+  }
+
+ private:
+  ExternalItemSorter self_sorter_;
+  ExternalItemSorter peer_sorter_;
+};
+
+}  // namespace
+
 EcdhP2PExtendCtx::EcdhP2PExtendCtx(EcdhPsiOptions options)
     : EcdhPsiContext(std::move(options)) {}
 
@@ -49,31 +103,67 @@ void EcdhP2PExtendCtx::MaskRecvPeer(
   *dup_masked_peer_items = memory_store->peer_results();
 }
 
-void EcdhP2PExtendCtx::MaskShufflePeer() {
-  std::vector<std::string> peer_items;
-  RecvItems(&peer_items);
+std::vector<std::string> EcdhP2PExtendCtx::RecvNextBatch(size_t batch_idx) {
+  std::vector<std::string> items;
+  RecvBatch(&items, batch_idx);
+  return items;
+}
+
+void EcdhP2PExtendCtx::MaskShufflePeer(const std::string& cache_dir,
+                                       size_t max_in_memory_bytes) {
+  ExternalItemSorter sorter(cache_dir, options_.dual_mask_size,
+                            max_in_memory_bytes);
 
-  std::vector<std::string> dup_masked_items;
-  if (peer_items.size() > 0) {
+  size_t batch_count = 0;
+  std::vector<std::string> peer_items = RecvNextBatch(batch_count);
+  while (!peer_items.empty()) {
+    auto next_items = std::async([this, batch_idx = batch_count + 1] {
+      return RecvNextBatch(batch_idx);
+    });
+
+    std::vector<std::string> dup_masked_items;
+    dup_masked_items.reserve(peer_items.size());
     for (const auto& masked : Mask(options_.ecc_cryptor, peer_items)) {
       dup_masked_items.emplace_back(masked.substr(
           masked.length() - options_.dual_mask_size, options_.dual_mask_size));
     }
-    // shuffle x^a^b
-    std::sort(dup_masked_items.begin(), dup_masked_items.end());
+    sorter.Add(dup_masked_items);
+
+    peer_items = next_items.get();
+    batch_count++;
   }
+  SPDLOG_INFO("MaskShufflePeer:{} masked items:{}, runs:{}",
+              options_.link_ctx->Id(), sorter.size(), sorter.num_runs());
 
-  SendDupMasked(dup_masked_items);
+  // shuffle x^a^b, the sorted order tells nothing of the peer order.
+  auto reader = sorter.Finalize();
+  size_t send_count = 0;
+  while (true) {
+    auto batch_items = reader->NextBatch(options_.batch_size);
+    SendDualMaskedBatch(batch_items, send_count);
+    if (batch_items.empty()) {
+      SPDLOG_INFO("MaskShufflePeer:{} finished, batch_count={}",
+                  options_.link_ctx->Id(), send_count);
+      break;
+    }
+    send_count++;
+  }
 }
 
 void EcdhP2PExtendCtx::MaskPeerForward(
     const std::shared_ptr<EcdhP2PExtendCtx>& forward_ctx,
     int32_t truncation_size) {
   size_t batch_count = 0;
+  std::vector<std::string> peer_items = RecvNextBatch(batch_count);
   while (true) {
-    std::vector<std::string> peer_items;
+    std::future<std::vector<std::string>> next_items;
+    if (!peer_items.empty()) {
+      next_items = std::async([this, batch_idx = batch_count + 1] {
+        return RecvNextBatch(batch_idx);
+      });
+    }
+
     std::vector<std::string> dup_masked_items;
-    RecvBatch(&peer_items, batch_count);
     if (!peer_items.empty()) {
       for (auto& masked : Mask(options_.ecc_cryptor, peer_items)) {
         if (truncation_size > 0) {
@@ -90,6 +180,7 @@ void EcdhP2PExtendCtx::MaskPeerForward(
                   options_.link_ctx->Id(), batch_count);
       break;
     }
+    peer_items = next_items.get();
     batch_count++;
   }
 }
@@ -241,8 +332,9 @@ void ShuffleEcdh3PcPsi::PartnersPsiImpl(
   SPDLOG_INFO("PartnersPsi:{} begin", options_.link_ctx->Rank());
   // a - b psi
   if (IsCalcuator()) {
-    std::vector<std::string> self_result;
-    std::vector<std::string> peer_result;
+    auto cipher_store = std::make_shared<SorterCipherStore>(
+        options_.cache_dir, ecc_cryptor_->GetMaskLength(),
+        options_.max_in_memory_bytes);
 
     auto context =
         CreateP2PCtx("PartnersPsi", options_.link_ctx->NextRank(),
@@ -252,26 +344,20 @@ void ShuffleEcdh3PcPsi::PartnersPsiImpl(
     std::future<void> f_mask_self =
         std::async([&] { return context->MaskSendSelf(self_items); });
     std::future<void> f_mask_peer =
-        std::async([&] { return context->MaskRecvPeer(&peer_result); });
+        std::async([&] { return context->MaskPeer(cipher_store); });
     std::future<void> f_recv_peer =
-        std::async([&] { return context->RecvDupMasked(&self_result); });
+        std::async([&] { return context->RecvDualMaskedSelf(cipher_store); });
 
     f_mask_self.get();
     f_mask_peer.get();
     f_recv_peer.get();
 
     SPDLOG_INFO("PartnersPsi:{}--self_result:{}, peer_result:{}",
-                options_.link_ctx->Rank(), self_result.size(),
-                peer_result.size());
-
-    // calc intersection_ab
-    std::sort(self_result.begin(), self_result.end());
-    std::sort(peer_result.begin(), peer_result.end());
+                options_.link_ctx->Rank(), cipher_store->self_sorter().size(),
+                cipher_store->peer_sorter().size());
 
-    std::vector<std::string> intersection;
-    std::set_intersection(self_result.begin(), self_result.end(),
-                          peer_result.begin(), peer_result.end(),
-                          std::back_inserter(intersection));
+    // calc intersection_ab by merging the sorted results
+    std::vector<std::string> intersection = cipher_store->Intersect();
     // send to master
     auto a_c_ctx = CreateP2PCtx("PartnersPsi", options_.master_rank,
                                 options_.dual_mask_size, options_.master_rank);
@@ -290,8 +376,10 @@ void ShuffleEcdh3PcPsi::PartnersPsiImpl(
     std::future<void> f_mask_self =
         std::async([&] { return context->MaskSendSelf(self_items); });
     // shuffle x^a^b
-    std::future<void> f_mask_peer =
-        std::async([&] { return context->MaskShufflePeer(); });
+    std::future<void> f_mask_peer = std::async([&] {
+      return context->MaskShufflePeer(options_.cache_dir,
+                                      options_.max_in_memory_bytes);
+    });
 
     f_mask_self.get();
     f_mask_peer.get();
@@ -14,12 +14,14 @@
 
 #pragma once
 
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "spu/psi/core/communication.h"
 #include "spu/psi/core/ecdh_psi.h"
+#include "spu/psi/utils/item_sorter.h"
 
 namespace spu::psi {
 
@@ -38,12 +40,19 @@ class EcdhP2PExtendCtx : public EcdhPsiContext {
   // wrapper of `EcdhPsiContext::RecvDualMaskedSelf`
   void RecvDupMasked(std::vector<std::string>* dup_masked_items);
 
-  // recv peer masked items, mask them again then use `forward_ctx` to forward
+  // recv peer masked items, mask them again then use `forward_ctx` to forward.
+  // A batch is masked while the next one is received.
   void MaskPeerForward(const std::shared_ptr<EcdhP2PExtendCtx>& forward_ctx,
                        int32_t truncation_size = -1);
 
-  // recv peer masked items, mask them again then shuffle and send them back
-  void MaskShufflePeer();
+  // recv peer masked items, mask them again then shuffle and send them back.
+  // A batch is masked while the next one is received, and the items are
+  // shuffled by sorting, out of core through `cache_dir` beyond
+  // `max_in_memory_bytes`.
+  void MaskShufflePeer(
+      const std::string& cache_dir = std::filesystem::temp_directory_path(),
+      size_t max_in_memory_bytes =
+          ExternalItemSorter::kDefaultMaxInMemoryBytes);
 
   // send the duplicate masked items to peer
   void SendDupMasked(const std::vector<std::string>& dual_masked_items);
@@ -59,6 +68,8 @@ class EcdhP2PExtendCtx : public EcdhPsiContext {
 
  private:
   void SendImpl(const std::vector<std::string>& items, bool dup_masked);
+
+  std::vector<std::string> RecvNextBatch(size_t batch_idx);
 };
 
 //
@@ -115,6 +126,12 @@ class ShuffleEcdh3PcPsi {
 
     // curve_type
     CurveType curve_type = CurveType::CURVE_25519;
+
+    // the partner shuffle and the calcuator intersection sort the masked
+    // items, out of core with run files under cache_dir beyond
+    // max_in_memory_bytes each.
+    std::string cache_dir = std::filesystem::temp_directory_path();
+    size_t max_in_memory_bytes = ExternalItemSorter::kDefaultMaxInMemoryBytes;
   };
 
  public:
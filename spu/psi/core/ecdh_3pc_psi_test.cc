@@ -30,6 +30,9 @@ struct TestParams {
   std::vector<std::string> items_a;
   std::vector<std::string> items_b;
   std::vector<std::string> items_c;
+  // spills the shuffle and intersection to disk if small.
+  size_t max_in_memory_bytes =
+      spu::psi::ExternalItemSorter::kDefaultMaxInMemoryBytes;
 };
 
 namespace spu::psi::test {
@@ -53,6 +56,7 @@ TEST_P(Ecdh3PcPsiTest, MaskMaster) {
   ShuffleEcdh3PcPsi::Options opts;
   opts.link_ctx = link_abc[alice_rank];
   opts.master_rank = master_rank;
+  opts.max_in_memory_bytes = params.max_in_memory_bytes;
   ecdh_3pc_psi_master = std::make_shared<ShuffleEcdh3PcPsi>(opts);
 
   opts.link_ctx = link_abc[bob_rank];
@@ -106,6 +110,7 @@ TEST_P(Ecdh3PcPsiTest, PartnersPsi) {
   ShuffleEcdh3PcPsi::Options opts;
   opts.link_ctx = link_abc[alice_rank];
   opts.master_rank = master_rank;
+  opts.max_in_memory_bytes = params.max_in_memory_bytes;
   ecdh_3pc_psi_master = std::make_shared<ShuffleEcdh3PcPsi>(opts);
 
   opts.link_ctx = link_abc[bob_rank];
@@ -162,6 +167,7 @@ TEST_P(Ecdh3PcPsiTest, Works) {
   ShuffleEcdh3PcPsi::Options opts;
   opts.link_ctx = link_abc[alice_rank];
   opts.master_rank = master_rank;
+  opts.max_in_memory_bytes = params.max_in_memory_bytes;
   ecdh_3pc_psi_master = std::make_shared<ShuffleEcdh3PcPsi>(opts);
 
   opts.link_ctx = link_abc[bob_rank];
@@ -237,6 +243,9 @@ INSTANTIATE_TEST_SUITE_P(
         // more than one batch
         TestParams{CreateRangeItems(0, 8193), CreateRangeItems(5, 8193),
                    CreateRangeItems(10, 8193)},  //
+        // out of core
+        TestParams{CreateRangeItems(0, 8193), CreateRangeItems(5, 8193),
+                   CreateRangeItems(10, 8193), 1000 * 32},  //
         //
         TestParams{{}, {}, {}}  //
         ));
@@ -17,6 +17,7 @@
 #include "absl/strings/escaping.h"
 #include "yacl/crypto/base/hash/blake3.h"
 #include "yacl/crypto/utils/hash_util.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/psi/cryptor/ecc_utils.h"
 
@@ -118,6 +119,177 @@ std::string ItemMul(absl::string_view sk_bytes, absl::string_view item_bytes,
   return point_bytes;
 }
 
+// Points are converted to affine coordinates by batches of it, with one
+// field inversion per batch instead of one per point.
+constexpr int64_t kAffineBatchSize = 256;
+
+// Multiply the points of `num` items by their scalars, with the curve set up
+// once for a range. `set_point(ec_group, idx, point, bn_ctx)` sets the point
+// of item idx, and `scalar(idx)` gives its scalar bytes, which are converted
+// again only when they change.
+template <typename SetPoint, typename Scalar>
+std::vector<std::string> BatchPointMul(int ec_group_nid, size_t num,
+                                       SetPoint &&set_point, Scalar &&scalar) {
+  std::vector<std::string> ret(num);
+
+  yacl::parallel_for(0, num, 1, [&](int64_t begin, int64_t end) {
+    BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
+    EcGroupSt ec_group(ec_group_nid);
+    BigNumSt bn_sk;
+    absl::string_view sk_bytes;
+
+    EcPointSt ec_point(ec_group);
+    std::vector<ECPointPtr> masked_points(
+        std::min(kAffineBatchSize, end - begin));
+    std::vector<EC_POINT *> masked_point_ptrs;
+    for (auto &masked_point : masked_points) {
+      masked_point.reset(yacl::CheckNotNull(EC_POINT_new(ec_group.get())));
+    }
+
+    for (int64_t batch_begin = begin; batch_begin < end;
+         batch_begin += kAffineBatchSize) {
+      const int64_t batch_size = std::min(kAffineBatchSize, end - batch_begin);
+
+      masked_point_ptrs.clear();
+      for (int64_t i = 0; i < batch_size; ++i) {
+        const int64_t idx = batch_begin + i;
+        set_point(ec_group, idx, ec_point.get(), bn_ctx.get());
+
+        const absl::string_view sk = scalar(idx);
+        YACL_ENFORCE(sk.size() == kEccKeySize);
+        if (sk.data() != sk_bytes.data()) {
+          bn_sk.FromBytes(sk, ec_group.bn_n, bn_ctx.get());
+          sk_bytes = sk;
+        }
+
+        EC_POINT *masked_point = masked_points[i].get();
+        YACL_ENFORCE(EC_POINT_mul(ec_group.get(), masked_point, nullptr,
+                                  ec_point.get(), bn_sk.get(),
+                                  bn_ctx.get()) == 1);
+        masked_point_ptrs.push_back(masked_point);
+      }
+
+      MakeAffine(ec_group, &masked_point_ptrs, bn_ctx.get());
+
+      for (int64_t i = 0; i < batch_size; ++i) {
+        auto &out = ret[batch_begin + i];
+        out.resize(kEcPointCompressLength);
+        EcPointSt::ToCompressedBytes(
+            ec_group, masked_point_ptrs[i],
+            absl::MakeSpan((uint8_t *)out.data(), out.size()), bn_ctx.get());
+      }
+    }
+  });
+
+  return ret;
+}
+
+// The points of BatchPointMul decoded from compressed `points`.
+auto DecodedPoints(absl::Span<const std::string> points) {
+  return [points](const EcGroupSt &ec_group, int64_t idx, EC_POINT *point,
+                  BN_CTX *bn_ctx) {
+    YACL_ENFORCE(EC_POINT_oct2point(ec_group.get(), point,
+                                    (const uint8_t *)points[idx].data(),
+                                    points[idx].size(), bn_ctx) == 1,
+                 "invalid ec point of item={}", idx);
+  };
+}
+
+// The points of BatchPointMul hashed from `items`.
+auto HashedPoints(absl::Span<const std::string> items) {
+  return [items](const EcGroupSt &ec_group, int64_t idx, EC_POINT *point,
+                 BN_CTX *bn_ctx) {
+    EcPointSt hashed =
+        EcPointSt::CreateEcPointByHashToCurve(items[idx], ec_group, bn_ctx);
+    YACL_ENFORCE(EC_POINT_copy(point, hashed.get()) == 1);
+  };
+}
+
+std::vector<std::string> HashItems(absl::Span<const std::string> items,
+                                   const std::vector<std::string> &masked_items,
+                                   size_t hash_len,
+                                   yacl::crypto::HashAlgorithm hash_type) {
+  std::vector<std::string> ret(items.size());
+
+  yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      ret[idx] = HashItem(items[idx], masked_items[idx], hash_len, hash_type);
+    }
+  });
+
+  return ret;
+}
+
+// Generate random keys of `num` items to `keys`, and their inverses of the
+// group order to `inv_keys`, kEccKeySize bytes each. The keys of a range are
+// inverted by one inversion with Montgomery's trick.
+void GenKeysAndInverses(int ec_group_nid, size_t num, uint8_t *keys,
+                        uint8_t *inv_keys) {
+  YACL_ENFORCE(RAND_bytes(keys, num * kEccKeySize) == 1,
+               "Cannot create random private key");
+
+  yacl::parallel_for(0, num, 1, [&](int64_t begin, int64_t end) {
+    BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
+    EcGroupSt ec_group(ec_group_nid);
+    const BIGNUM *order = ec_group.bn_n.get();
+
+    // prefixes[i] is the product of the keys of [begin, begin + i].
+    std::vector<BigNumSt> bn_keys(end - begin);
+    std::vector<BigNumSt> prefixes(end - begin);
+    for (int64_t i = 0; i < end - begin; ++i) {
+      bn_keys[i].FromBytes(
+          absl::string_view((const char *)keys + (begin + i) * kEccKeySize,
+                            kEccKeySize),
+          ec_group.bn_n, bn_ctx.get());
+      YACL_ENFORCE(!BN_is_zero(bn_keys[i].get()), "zero private key");
+      if (i == 0) {
+        YACL_ENFORCE(BN_copy(prefixes[i].get(), bn_keys[i].get()) != nullptr);
+      } else {
+        YACL_ENFORCE(BN_mod_mul(prefixes[i].get(), prefixes[i - 1].get(),
+                                bn_keys[i].get(), order, bn_ctx.get()) == 1);
+      }
+    }
+
+    BigNumSt bn_inv;
+    YACL_ENFORCE(BN_mod_inverse(bn_inv.get(), prefixes.back().get(), order,
+                                bn_ctx.get()) != nullptr);
+
+    // bn_inv is the inverse of prefixes[i] at the step of i.
+    BigNumSt bn_key_inv;
+    for (int64_t i = end - begin - 1; i >= 0; --i) {
+      if (i == 0) {
+        YACL_ENFORCE(BN_copy(bn_key_inv.get(), bn_inv.get()) != nullptr);
+      } else {
+        YACL_ENFORCE(BN_mod_mul(bn_key_inv.get(), bn_inv.get(),
+                                prefixes[i - 1].get(), order,
+                                bn_ctx.get()) == 1);
+        YACL_ENFORCE(BN_mod_mul(bn_inv.get(), bn_inv.get(), bn_keys[i].get(),
+                                order, bn_ctx.get()) == 1);
+      }
+      YACL_ENFORCE(BN_bn2binpad(bn_key_inv.get(),
+                                inv_keys + (begin + i) * kEccKeySize,
+                                kEccKeySize) == kEccKeySize);
+    }
+  });
+}
+
+// Compute the inverse of `key` of the group order.
+void InverseKey(const uint8_t *key, int ec_group_nid, uint8_t *inv_key) {
+  EcGroupSt ec_group(ec_group_nid);
+  BigNumSt bn_sk;
+
+  bn_sk.FromBytes(absl::string_view((const char *)key, kEccKeySize),
+                  ec_group.bn_n);
+
+  BigNumSt bn_sk_inv = bn_sk.Inverse(ec_group.bn_n);
+
+  std::string sk_inv = bn_sk_inv.ToBytes();
+  YACL_ENFORCE(kEccKeySize == sk_inv.length());
+
+  std::memcpy(inv_key, sk_inv.data(), sk_inv.length());
+  OPENSSL_cleanse(sk_inv.data(), sk_inv.size());
+}
+
 }  // namespace
 
 std::string BasicEcdhOprfServer::Evaluate(
@@ -127,6 +299,23 @@ std::string BasicEcdhOprfServer::Evaluate(
       blinded_element, ec_group_nid_);
 }
 
+std::vector<std::string> BasicEcdhOprfServer::Evaluate(
+    absl::Span<const std::string> blinded_elements) const {
+  const absl::string_view sk((const char *)&private_key_[0], kEccKeySize);
+  return BatchPointMul(ec_group_nid_, blinded_elements.size(),
+                       DecodedPoints(blinded_elements),
+                       [&](int64_t) { return sk; });
+}
+
+std::vector<std::string> BasicEcdhOprfServer::FullEvaluate(
+    absl::Span<const std::string> input) const {
+  const absl::string_view sk((const char *)&private_key_[0], kEccKeySize);
+  std::vector<std::string> masked_items =
+      BatchPointMul(ec_group_nid_, input.size(), HashedPoints(input),
+                    [&](int64_t) { return sk; });
+  return HashItems(input, masked_items, GetCompareLength(), hash_type_);
+}
+
 std::string BasicEcdhOprfServer::FullEvaluate(
     yacl::ByteContainerView input) const {
   absl::string_view input_sv =
@@ -152,31 +341,94 @@ size_t BasicEcdhOprfServer::GetEcPointLength() const {
 
 BasicEcdhOprfClient::BasicEcdhOprfClient(CurveType type) : curve_type_(type) {
   ec_group_nid_ = Sm2Cryptor::GetEcGroupId(type);
-  BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
-  EcGroupSt ec_group(ec_group_nid_);
-  BigNumSt bn_sk;
-
-  bn_sk.FromBytes(
-      absl::string_view((const char *)&private_key_[0], kEccKeySize),
-      ec_group.bn_n);
-
-  BigNumSt bn_sk_inv = bn_sk.Inverse(ec_group.bn_n);
-
-  std::string sk_inv = bn_sk_inv.ToBytes();
-  YACL_ENFORCE(sk_inv_.size() == sk_inv.length());
-
-  std::memcpy(sk_inv_.data(), sk_inv.data(), sk_inv.length());
+  InverseKey(&private_key_[0], ec_group_nid_, sk_inv_.data());
   (void)curve_type_;
 }
 
 std::string BasicEcdhOprfClient::Blind(absl::string_view input) const {
-  return ItemMul(absl::string_view((const char *)&private_key_[0], kEccKeySize),
-                 input, ec_group_nid_);
+  return BlindWithKey(
+      input, absl::string_view((const char *)&private_key_[0], kEccKeySize));
 }
 
 std::string BasicEcdhOprfClient::Finalize(
     absl::string_view item, absl::string_view evaluated_element) const {
-  std::string unblinded_element = Unblind(evaluated_element);
+  return FinalizeWithKey(
+      item, evaluated_element,
+      absl::string_view((const char *)&sk_inv_[0], kEccKeySize));
+}
+
+std::vector<std::string> BasicEcdhOprfClient::Blind(
+    absl::Span<const std::string> input) const {
+  const absl::string_view sk((const char *)&private_key_[0], kEccKeySize);
+  return BatchPointMul(ec_group_nid_, input.size(), HashedPoints(input),
+                       [&](int64_t) { return sk; });
+}
+
+std::vector<std::string> BasicEcdhOprfClient::Finalize(
+    absl::Span<const std::string> items,
+    absl::Span<const std::string> evaluated_elements) const {
+  YACL_ENFORCE(items.size() == evaluated_elements.size(),
+               "mismatched items={}, evaluated={}", items.size(),
+               evaluated_elements.size());
+  const absl::string_view sk_inv((const char *)&sk_inv_[0], kEccKeySize);
+  std::vector<std::string> unblinded_elements =
+      BatchPointMul(ec_group_nid_, items.size(),
+                    DecodedPoints(evaluated_elements),
+                    [&](int64_t) { return sk_inv; });
+  return HashItems(items, unblinded_elements, GetCompareLength(), hash_type_);
+}
+
+std::vector<std::string> BasicEcdhOprfClient::BlindWithFreshKeys(
+    absl::Span<const std::string> input, std::string *unblind_keys) const {
+  std::string keys(input.size() * kEccKeySize, '\0');
+  unblind_keys->resize(input.size() * kEccKeySize);
+  GenKeysAndInverses(ec_group_nid_, input.size(), (uint8_t *)keys.data(),
+                     (uint8_t *)unblind_keys->data());
+
+  std::vector<std::string> blinded_elements =
+      BatchPointMul(ec_group_nid_, input.size(), HashedPoints(input),
+                    [&](int64_t idx) {
+                      return absl::string_view(keys).substr(
+                          idx * kEccKeySize, kEccKeySize);
+                    });
+  OPENSSL_cleanse(keys.data(), keys.size());
+  return blinded_elements;
+}
+
+std::vector<std::string> BasicEcdhOprfClient::FinalizeWithKeys(
+    absl::Span<const std::string> items,
+    absl::Span<const std::string> evaluated_elements,
+    absl::string_view unblind_keys) const {
+  YACL_ENFORCE(items.size() == evaluated_elements.size() &&
+                   unblind_keys.size() == items.size() * kEccKeySize,
+               "mismatched items={}, evaluated={}, keys={}", items.size(),
+               evaluated_elements.size(), unblind_keys.size() / kEccKeySize);
+  std::vector<std::string> unblinded_elements =
+      BatchPointMul(ec_group_nid_, items.size(),
+                    DecodedPoints(evaluated_elements), [&](int64_t idx) {
+                      return unblind_keys.substr(idx * kEccKeySize,
+                                                 kEccKeySize);
+                    });
+  return HashItems(items, unblinded_elements, GetCompareLength(), hash_type_);
+}
+
+void BasicEcdhOprfClient::GenBlindingKey(uint8_t *key,
+                                         uint8_t *unblind_key) const {
+  YACL_ENFORCE(RAND_bytes(key, kEccKeySize) == 1,
+               "Cannot create random private key");
+  InverseKey(key, ec_group_nid_, unblind_key);
+}
+
+std::string BasicEcdhOprfClient::BlindWithKey(absl::string_view input,
+                                              absl::string_view key) const {
+  return ItemMul(key, input, ec_group_nid_);
+}
+
+std::string BasicEcdhOprfClient::FinalizeWithKey(
+    absl::string_view item, absl::string_view evaluated_element,
+    absl::string_view unblind_key) const {
+  std::string unblinded_element =
+      EcPointMul(unblind_key, evaluated_element, ec_group_nid_);
 
   return HashItem(item, unblinded_element, GetCompareLength(), hash_type_);
 }
@@ -249,6 +501,16 @@ void FourQHashToCurvePoint(absl::string_view input, point_t pt) {
   return;
 }
 
+// Compute the inverse of `key` of the curve order.
+void FourQInverseKey(const uint8_t *key, uint8_t *inv_key) {
+  to_Montgomery(const_cast<digit_t *>(reinterpret_cast<const digit_t *>(key)),
+                reinterpret_cast<digit_t *>(inv_key));
+  Montgomery_inversion_mod_order(reinterpret_cast<digit_t *>(inv_key),
+                                 reinterpret_cast<digit_t *>(inv_key));
+  from_Montgomery(reinterpret_cast<digit_t *>(inv_key),
+                  reinterpret_cast<digit_t *>(inv_key));
+}
+
 }  // namespace
 std::string FourQBasicEcdhOprfServer::Evaluate(
     absl::string_view blinded_element) const {
@@ -283,26 +545,42 @@ size_t FourQBasicEcdhOprfServer::GetEcPointLength() const {
 }
 
 FourQBasicEcdhOprfClient::FourQBasicEcdhOprfClient() {
-  to_Montgomery(const_cast<digit_t *>(
-                    reinterpret_cast<const digit_t *>(&private_key_[0])),
-                reinterpret_cast<digit_t *>(sk_inv_.data()));
-  Montgomery_inversion_mod_order(reinterpret_cast<digit_t *>(sk_inv_.data()),
-                                 reinterpret_cast<digit_t *>(sk_inv_.data()));
-  from_Montgomery(reinterpret_cast<digit_t *>(sk_inv_.data()),
-                  reinterpret_cast<digit_t *>(sk_inv_.data()));
+  FourQInverseKey(&private_key_[0], sk_inv_.data());
 }
 
 std::string FourQBasicEcdhOprfClient::Blind(absl::string_view input) const {
+  return BlindWithKey(
+      input, absl::string_view((const char *)&private_key_[0], kEccKeySize));
+}
+
+std::string FourQBasicEcdhOprfClient::Finalize(
+    absl::string_view item, absl::string_view evaluated_element) const {
+  return FinalizeWithKey(
+      item, evaluated_element,
+      absl::string_view((const char *)&sk_inv_[0], kEccKeySize));
+}
+
+void FourQBasicEcdhOprfClient::GenBlindingKey(uint8_t *key,
+                                              uint8_t *unblind_key) const {
+  YACL_ENFORCE(RAND_bytes(key, kEccKeySize) == 1,
+               "Cannot create random private key");
+  FourQInverseKey(key, unblind_key);
+}
+
+std::string FourQBasicEcdhOprfClient::BlindWithKey(
+    absl::string_view input, absl::string_view key) const {
   point_t pt;
   FourQHashToCurvePoint(input, pt);
 
-  return FourQPointMul(
-      absl::string_view((const char *)&private_key_[0], kEccKeySize), pt);
+  return FourQPointMul(key, pt);
 }
 
-std::string FourQBasicEcdhOprfClient::Finalize(
-    absl::string_view item, absl::string_view evaluated_element) const {
-  std::string unblinded_element = Unblind(evaluated_element);
+std::string FourQBasicEcdhOprfClient::FinalizeWithKey(
+    absl::string_view item, absl::string_view evaluated_element,
+    absl::string_view unblind_key) const {
+  std::string unblinded_element = FourQPointMul(
+      unblind_key, absl::MakeSpan((const uint8_t *)evaluated_element.data(),
+                                  evaluated_element.size()));
 
   return HashItem(item, unblinded_element, GetCompareLength(), hash_type_);
 }
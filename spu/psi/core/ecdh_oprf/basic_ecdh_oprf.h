@@ -67,8 +67,15 @@ class BasicEcdhOprfServer : public IEcdhOprfServer {
 
   std::string Evaluate(absl::string_view blinded_element) const override;
 
+  // The curve and the key are set up once for a range of the batch.
+  std::vector<std::string> Evaluate(
+      absl::Span<const std::string> blinded_element) const override;
+
   std::string FullEvaluate(yacl::ByteContainerView input) const override;
 
+  std::vector<std::string> FullEvaluate(
+      absl::Span<const std::string> input) const override;
+
   size_t GetCompareLength() const override;
   size_t GetEcPointLength() const override;
 
@@ -92,9 +99,27 @@ class BasicEcdhOprfClient : public IEcdhOprfClient {
 
   std::string Blind(absl::string_view input) const override;
 
+  // The batches set up the curve once for a range, and the fresh keys are
+  // inverted by one inversion of a range.
+  std::vector<std::string> Blind(
+      absl::Span<const std::string> input) const override;
+
   std::string Finalize(absl::string_view item,
                        absl::string_view evaluated_element) const override;
 
+  std::vector<std::string> Finalize(
+      absl::Span<const std::string> items,
+      absl::Span<const std::string> evaluated_element) const override;
+
+  std::vector<std::string> BlindWithFreshKeys(
+      absl::Span<const std::string> input,
+      std::string* unblind_keys) const override;
+
+  std::vector<std::string> FinalizeWithKeys(
+      absl::Span<const std::string> items,
+      absl::Span<const std::string> evaluated_element,
+      absl::string_view unblind_keys) const override;
+
   size_t GetCompareLength() const override;
   size_t GetEcPointLength() const override;
 
@@ -104,6 +129,16 @@ class BasicEcdhOprfClient : public IEcdhOprfClient {
     hash_type_ = hash_type;
   }
 
+ protected:
+  void GenBlindingKey(uint8_t* key, uint8_t* unblind_key) const override;
+
+  std::string BlindWithKey(absl::string_view input,
+                           absl::string_view key) const override;
+
+  std::string FinalizeWithKey(absl::string_view item,
+                              absl::string_view evaluated_element,
+                              absl::string_view unblind_key) const override;
+
  private:
   CurveType curve_type_;
   int ec_group_nid_;
@@ -161,6 +196,16 @@ class FourQBasicEcdhOprfClient : public IEcdhOprfClient {
     hash_type_ = hash_type;
   }
 
+ protected:
+  void GenBlindingKey(uint8_t* key, uint8_t* unblind_key) const override;
+
+  std::string BlindWithKey(absl::string_view input,
+                           absl::string_view key) const override;
+
+  std::string FinalizeWithKey(absl::string_view item,
+                              absl::string_view evaluated_element,
+                              absl::string_view unblind_key) const override;
+
  private:
   std::array<uint8_t, kEccKeySize> sk_inv_;
   yacl::crypto::HashAlgorithm hash_type_ = yacl::crypto::HashAlgorithm::BLAKE3;
@@ -76,6 +76,20 @@ TEST_P(BasicEcdhOprfTest, Works) {
       dh_oprf_client->Finalize(items_vec, mask_item_vec);
 
   EXPECT_EQ(server_evaluted_vec, client_evaluted_vec);
+
+  // each item is blinded by its own key.
+  std::string unblind_keys;
+  std::vector<std::string> fresh_blinded_vec =
+      dh_oprf_client->BlindWithFreshKeys(items_vec, &unblind_keys);
+  EXPECT_EQ(unblind_keys.size(), params.items_size * kEccKeySize);
+  EXPECT_NE(fresh_blinded_vec, blinded_item_vec);
+
+  std::vector<std::string> fresh_evaluted_vec =
+      dh_oprf_client->FinalizeWithKeys(
+          items_vec, dh_oprf_server->Evaluate(fresh_blinded_vec),
+          unblind_keys);
+
+  EXPECT_EQ(server_evaluted_vec, fresh_evaluted_vec);
 }
 
 INSTANTIATE_TEST_SUITE_P(
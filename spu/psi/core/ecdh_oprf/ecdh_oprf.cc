@@ -72,4 +72,50 @@ std::vector<std::string> IEcdhOprfClient::Finalize(
 
   return output;
 }
+
+std::vector<std::string> IEcdhOprfClient::BlindWithFreshKeys(
+    absl::Span<const std::string> input, std::string* unblind_keys) const {
+  std::vector<std::string> blinded_elements(input.size());
+  unblind_keys->resize(input.size() * kEccKeySize);
+
+  yacl::parallel_for(0, input.size(), 1, [&](int64_t begin, int64_t end) {
+    std::array<uint8_t, kEccKeySize> key;
+    for (int64_t idx = begin; idx < end; ++idx) {
+      GenBlindingKey(key.data(),
+                     reinterpret_cast<uint8_t*>(unblind_keys->data()) +
+                         idx * kEccKeySize);
+      blinded_elements[idx] = BlindWithKey(
+          input[idx],
+          absl::string_view(reinterpret_cast<const char*>(key.data()),
+                            key.size()));
+    }
+    OPENSSL_cleanse(key.data(), key.size());
+  });
+
+  return blinded_elements;
+}
+
+std::vector<std::string> IEcdhOprfClient::FinalizeWithKeys(
+    absl::Span<const std::string> items,
+    absl::Span<const std::string> evaluated_elements,
+    absl::string_view unblind_keys) const {
+  YACL_ENFORCE(items.size() == evaluated_elements.size() &&
+                   unblind_keys.size() == items.size() * kEccKeySize,
+               "mismatched items={}, evaluated={}, keys={}", items.size(),
+               evaluated_elements.size(), unblind_keys.size() / kEccKeySize);
+  std::vector<std::string> output(evaluated_elements.size());
+
+  yacl::parallel_for(
+      0, evaluated_elements.size(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t idx = begin; idx < end; ++idx) {
+          output[idx] =
+              FinalizeWithKey(items[idx], evaluated_elements[idx],
+                              unblind_keys.substr(idx * kEccKeySize,
+                                                  kEccKeySize));
+        }
+      });
+
+  return output;
+}
+
 }  // namespace spu::psi
\ No newline at end of file
@@ -168,6 +168,42 @@ class IEcdhOprfClient : public IEcdhOprf {
       absl::Span<const std::string> evaluated_element) const;
 
   virtual std::string Unblind(absl::string_view input) const = 0;
+
+  /**
+   * @brief Blind each input by a fresh temp private key, which saves a client
+   * per item when items should not share a key
+   *
+   * @param input   client input data
+   * @param unblind_keys  the keys to unblind, kEccKeySize bytes of each item
+   * @return std::vector<std::string>   blinded data
+   */
+  virtual std::vector<std::string> BlindWithFreshKeys(
+      absl::Span<const std::string> input, std::string* unblind_keys) const;
+
+  /**
+   * @brief Finalize each item with its key of BlindWithFreshKeys
+   *
+   * @param items   client input data
+   * @param evaluated_element
+   * @param unblind_keys  the keys of BlindWithFreshKeys
+   * @return std::vector<std::string> masked data with server's private key
+   */
+  virtual std::vector<std::string> FinalizeWithKeys(
+      absl::Span<const std::string> items,
+      absl::Span<const std::string> evaluated_element,
+      absl::string_view unblind_keys) const;
+
+ protected:
+  // Generate a temp private key and the key to unblind by it, kEccKeySize
+  // bytes each.
+  virtual void GenBlindingKey(uint8_t* key, uint8_t* unblind_key) const = 0;
+
+  virtual std::string BlindWithKey(absl::string_view input,
+                                   absl::string_view key) const = 0;
+
+  virtual std::string FinalizeWithKey(absl::string_view item,
+                                      absl::string_view evaluated_element,
+                                      absl::string_view unblind_key) const = 0;
 };
 
 }  // namespace spu::psi
\ No newline at end of file
@@ -14,9 +14,13 @@
 
 #include "spu/psi/core/ecdh_oprf_psi.h"
 
+#include <array>
+#include <cstring>
 #include <future>
 #include <utility>
 
+#include "absl/strings/escaping.h"
+#include "yacl/crypto/utils/hash_util.h"
 #include "yacl/utils/parallel.h"
 #include "yacl/utils/serialize.h"
 
@@ -80,6 +84,100 @@ void EcdhOprfPsiServer::SendFinalEvaluatedItems(
   SPDLOG_INFO("{} finished, batch_count={}", __func__, batch_count);
 }
 
+std::unique_ptr<OprfEvaluatedSet> EcdhOprfPsiServer::FullEvaluateSet(
+    const std::shared_ptr<IBatchProvider>& batch_provider) {
+  auto evaluated_set = std::make_unique<OprfEvaluatedSet>(
+      GetKeyEpoch(), oprf_server_->GetCompareLength());
+  size_t batch_count = 0;
+  while (true) {
+    auto items = batch_provider->ReadNextBatch(options_.batch_size);
+    if (items.empty()) {
+      break;
+    }
+    for (const auto& masked_item : oprf_server_->FullEvaluate(items)) {
+      evaluated_set->Append(masked_item);
+    }
+    batch_count++;
+  }
+  evaluated_set->Finish();
+  SPDLOG_INFO("{} finished, batch_count={}, set_size={}", __func__,
+              batch_count, evaluated_set->size());
+  return evaluated_set;
+}
+
+void EcdhOprfPsiServer::SendEvaluatedSet(
+    const OprfEvaluatedSet& evaluated_set) {
+  YACL_ENFORCE(evaluated_set.epoch() == GetKeyEpoch(),
+               "evaluated set is not of the current private key");
+  YACL_ENFORCE(evaluated_set.item_length() ==
+               oprf_server_->GetCompareLength());
+
+  options_.link0->SendAsync(options_.link0->NextRank(), evaluated_set.epoch(),
+                            "EcdhOprfPSI:EvaluatedSetEpoch");
+  auto cached = options_.link0->Recv(options_.link0->NextRank(),
+                                     "EcdhOprfPSI:EvaluatedSetCached");
+  YACL_ENFORCE(cached.size() == 1);
+  if (cached.data<char>()[0] != 0) {
+    SPDLOG_INFO("{} peer has the evaluated set cached", __func__);
+    return;
+  }
+
+  // count | fingerprint_bytes | bucket_num, zero fingerprint_bytes for items.
+  const CuckooFilter* filter = evaluated_set.filter();
+  std::array<uint64_t, 3> form = {evaluated_set.size(), 0, 0};
+  if (filter != nullptr) {
+    form[1] = filter->params().fingerprint_bytes;
+    form[2] = filter->params().bucket_num;
+  }
+  options_.link0->SendAsync(
+      options_.link0->NextRank(),
+      yacl::ByteContainerView(form.data(), sizeof(form)),
+      "EcdhOprfPSI:EvaluatedSetForm");
+
+  // the filter table is sent in chunks of the size of an item batch.
+  std::string_view payload =
+      filter != nullptr ? std::string_view(filter->table())
+                        : evaluated_set.GetItems(0, evaluated_set.size());
+  const size_t chunk_size = options_.batch_size * evaluated_set.item_length();
+  const char* tag_prefix = filter != nullptr
+                               ? "EcdhOprfPSI:EvaluatedFilter"
+                               : "EcdhOprfPSI:FinalEvaluatedItems";
+
+  size_t batch_count = 0;
+  for (size_t begin = 0;; begin += chunk_size) {
+    PsiDataBatch batch;
+    batch.is_last_batch = begin >= payload.size();
+    if (!batch.is_last_batch) {
+      batch.flatten_bytes = payload.substr(begin, chunk_size);
+    }
+
+    const auto tag = fmt::format("{}:{}", tag_prefix, batch_count);
+    options_.link0->SendAsync(options_.link0->NextRank(), batch.Serialize(),
+                              tag);
+    if (batch.is_last_batch) {
+      break;
+    }
+    batch_count++;
+  }
+  SPDLOG_INFO("{} finished, batch_count={}", __func__, batch_count);
+}
+
+std::string EcdhOprfPsiServer::GetKeyEpoch() const {
+  std::string buf =
+      fmt::format("ecdh-oprf-key-epoch:{}:{}:{}:",
+                  static_cast<int>(options_.oprf_type),
+                  static_cast<int>(options_.curve_type),
+                  oprf_server_->GetCompareLength());
+  auto private_key = oprf_server_->GetPrivateKey();
+  buf.append(reinterpret_cast<const char*>(private_key.data()),
+             private_key.size());
+  auto digest = yacl::crypto::Sha256(buf);
+  OPENSSL_cleanse(buf.data(), buf.size());
+  OPENSSL_cleanse(private_key.data(), private_key.size());
+  return absl::BytesToHexString(absl::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
 void EcdhOprfPsiServer::RecvBlindAndSendEvaluate() {
   size_t batch_count = 0;
 
@@ -159,6 +257,70 @@ void EcdhOprfPsiClient::RecvFinalEvaluatedItems(
   }
 }
 
+std::unique_ptr<OprfEvaluatedSet> EcdhOprfPsiClient::RecvEvaluatedSet(
+    const std::string& cache_path) {
+  auto epoch_buf = options_.link0->Recv(options_.link0->NextRank(),
+                                        "EcdhOprfPSI:EvaluatedSetEpoch");
+  std::string epoch(epoch_buf.data<char>(), epoch_buf.size());
+
+  std::unique_ptr<OprfEvaluatedSet> evaluated_set;
+  if (!cache_path.empty()) {
+    evaluated_set = OprfEvaluatedSet::Load(cache_path, epoch);
+  }
+  const char cached = evaluated_set != nullptr ? 1 : 0;
+  options_.link0->SendAsync(options_.link0->NextRank(),
+                            yacl::ByteContainerView(&cached, 1),
+                            "EcdhOprfPSI:EvaluatedSetCached");
+  if (cached != 0) {
+    YACL_ENFORCE(evaluated_set->item_length() == compare_length_);
+    SPDLOG_INFO("{} use cached evaluated set, size={}", __func__,
+                evaluated_set->size());
+    return evaluated_set;
+  }
+
+  std::array<uint64_t, 3> form;
+  auto form_buf = options_.link0->Recv(options_.link0->NextRank(),
+                                       "EcdhOprfPSI:EvaluatedSetForm");
+  YACL_ENFORCE(static_cast<size_t>(form_buf.size()) == sizeof(form));
+  std::memcpy(form.data(), form_buf.data(), sizeof(form));
+  const bool is_filter = form[1] != 0;
+  const char* tag_prefix = is_filter ? "EcdhOprfPSI:EvaluatedFilter"
+                                     : "EcdhOprfPSI:FinalEvaluatedItems";
+
+  evaluated_set = std::make_unique<OprfEvaluatedSet>(epoch, compare_length_);
+  std::string filter_table;
+  size_t batch_count = 0;
+  while (true) {
+    const auto tag = fmt::format("{}:{}", tag_prefix, batch_count);
+    PsiDataBatch masked_batch = PsiDataBatch::Deserialize(
+        options_.link0->Recv(options_.link0->NextRank(), tag));
+    if (masked_batch.is_last_batch) {
+      break;
+    }
+    if (is_filter) {
+      filter_table.append(masked_batch.flatten_bytes);
+    } else {
+      evaluated_set->Append(masked_batch.flatten_bytes);
+    }
+    batch_count++;
+  }
+  if (is_filter) {
+    CuckooFilter::Params filter_params;
+    filter_params.fingerprint_bytes = form[1];
+    filter_params.bucket_num = form[2];
+    evaluated_set->SetFilter(std::make_unique<CuckooFilter>(
+        filter_params, std::move(filter_table), form[0]));
+  } else {
+    evaluated_set->Finish();
+  }
+  if (!cache_path.empty()) {
+    evaluated_set->Save(cache_path);
+  }
+  SPDLOG_INFO("{} finished, batch_count={}, set_size={}", __func__,
+              batch_count, evaluated_set->size());
+  return evaluated_set;
+}
+
 void EcdhOprfPsiClient::SendBlindedItems(
     const std::shared_ptr<IBatchProvider>& batch_provider) {
   size_t batch_count = 0;
@@ -180,19 +342,9 @@ void EcdhOprfPsiClient::SendBlindedItems(
       break;
     }
 
-    std::vector<std::shared_ptr<IEcdhOprfClient>> oprf_clients(items.size());
-    std::vector<std::string> blinded_items(items.size());
-
-    yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
-      for (int64_t idx = begin; idx < end; ++idx) {
-        std::shared_ptr<IEcdhOprfClient> oprf_client =
-            CreateEcdhOprfClient(options_.oprf_type, options_.curve_type);
-
-        oprf_clients[idx] = oprf_client;
-
-        blinded_items[idx] = oprf_client->Blind(items[idx]);
-      }
-    });
+    std::string unblind_keys;
+    std::vector<std::string> blinded_items =
+        oprf_client_->BlindWithFreshKeys(items, &unblind_keys);
 
     blinded_batch.flatten_bytes.reserve(items.size() * ec_point_length_);
 
@@ -200,15 +352,14 @@ void EcdhOprfPsiClient::SendBlindedItems(
       blinded_batch.flatten_bytes.append(blinded_items[idx]);
     }
 
-    // push to oprf_client_queue_
+    // push to unblind_keys_queue_
     {
       std::unique_lock<std::mutex> lock(mutex_);
       queue_push_cv_.wait(lock, [&] {
-        return (oprf_client_queue_.size() < options_.window_size);
+        return (unblind_keys_queue_.size() < options_.window_size);
       });
-      oprf_client_queue_.push(std::move(oprf_clients));
+      unblind_keys_queue_.push(std::move(unblind_keys));
       queue_pop_cv_.notify_one();
-      // SPDLOG_INFO("push to queue size:{}", oprf_client_queue_.size());
     }
 
     options_.link1->SendAsync(options_.link1->NextRank(),
@@ -248,31 +399,21 @@ void EcdhOprfPsiClient::RecvEvaluatedItems(
           idx * ec_point_length_, ec_point_length_);
     }
 
-    std::vector<std::string> oprf_items(items.size());
-    std::vector<std::shared_ptr<IEcdhOprfClient>> oprf_clients;
+    std::string unblind_keys;
 
-    // get oprf_clients
+    // get unblind_keys
     {
       std::unique_lock<std::mutex> lock(mutex_);
-      queue_pop_cv_.wait(lock, [&] {
-        // SPDLOG_INFO("pop queue size:{}", oprf_client_queue_.size());
-        return (!oprf_client_queue_.empty());
-      });
+      queue_pop_cv_.wait(lock, [&] { return (!unblind_keys_queue_.empty()); });
 
-      oprf_clients = std::move(oprf_client_queue_.front());
-      oprf_client_queue_.pop();
+      unblind_keys = std::move(unblind_keys_queue_.front());
+      unblind_keys_queue_.pop();
       queue_push_cv_.notify_one();
     }
 
-    YACL_ENFORCE(oprf_clients.size() == items.size(),
-                 "EcdhOprfServer should not be nullptr");
-
-    yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
-      for (int64_t idx = begin; idx < end; ++idx) {
-        oprf_items[idx] =
-            oprf_clients[idx]->Finalize(items[idx], evaluate_items[idx]);
-      }
-    });
+    std::vector<std::string> oprf_items =
+        oprf_client_->FinalizeWithKeys(items, evaluate_items, unblind_keys);
+    OPENSSL_cleanse(unblind_keys.data(), unblind_keys.size());
 
     for (uint64_t idx = 0; idx < items.size(); ++idx) {
       cipher_store->SaveSelf(oprf_items[idx]);
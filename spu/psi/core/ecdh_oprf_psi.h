@@ -25,6 +25,7 @@
 
 #include "spu/psi/core/ecdh_oprf/ecdh_oprf.h"
 #include "spu/psi/core/ecdh_oprf/ecdh_oprf_selector.h"
+#include "spu/psi/core/oprf_evaluated_set.h"
 #include "spu/psi/utils/batch_provider.h"
 #include "spu/psi/utils/cipher_store.h"
 
@@ -58,6 +59,25 @@
 // =======================================================
 //                                           Intersection
 //
+// Unbalanced mode: the server FullEvaluates its set once per private key into
+// an OprfEvaluatedSet and saves it. At the start of a session the server
+// sends its key epoch, and a client holding the set of that epoch skips the
+// download, so a session only pays for the online phase of the client items.
+// A set turned into a cuckoo filter by OprfEvaluatedSet::ToFilter is sent as
+// the filter table, a few bytes per item instead of the compare length.
+//
+//               server                         client
+//  FullEvaluateSet (once per key)
+//                        key epoch
+//                 ----------------------->
+//                                        load cached set of the epoch
+//                     cached or not
+//                 <-----------------------
+//                 evaluated set (if not cached)
+//                 ----------------------->
+//                         Online
+//                                  ...
+//
 namespace spu::psi {
 
 // send queque capacity
@@ -119,6 +139,23 @@ class EcdhOprfPsiServer {
   void SendFinalEvaluatedItems(
       const std::shared_ptr<IBatchProvider>& batch_provider);
 
+  /**
+   * @brief FullEvaluate server side data into a sorted set bound to the key
+   * epoch, to save and serve every client session of unbalanced psi
+   *
+   * @param batch_provider input data batch provider
+   */
+  std::unique_ptr<OprfEvaluatedSet> FullEvaluateSet(
+      const std::shared_ptr<IBatchProvider>& batch_provider);
+
+  /**
+   * @brief send the evaluated set unless the client has it cached
+   *
+   * @param evaluated_set set of FullEvaluateSet with the current key, as
+   * items or as a filter
+   */
+  void SendEvaluatedSet(const OprfEvaluatedSet& evaluated_set);
+
   /**
    * @brief
    *
@@ -134,6 +171,12 @@ class EcdhOprfPsiServer {
     return oprf_server_->GetPrivateKey();
   }
 
+  /**
+   * @brief Get the epoch of the private key, a digest telling the keys apart
+   * without revealing them
+   */
+  std::string GetKeyEpoch() const;
+
  private:
   EcdhOprfPsiOptions options_;
 
@@ -143,10 +186,9 @@ class EcdhOprfPsiServer {
 class EcdhOprfPsiClient {
  public:
   explicit EcdhOprfPsiClient(EcdhOprfPsiOptions options) : options_(options) {
-    std::shared_ptr<IEcdhOprfClient> oprf_client =
-        CreateEcdhOprfClient(options.oprf_type, options.curve_type);
-    compare_length_ = oprf_client->GetCompareLength();
-    ec_point_length_ = oprf_client->GetEcPointLength();
+    oprf_client_ = CreateEcdhOprfClient(options.oprf_type, options.curve_type);
+    compare_length_ = oprf_client_->GetCompareLength();
+    ec_point_length_ = oprf_client_->GetEcPointLength();
   }
 
   /**
@@ -157,6 +199,16 @@ class EcdhOprfPsiClient {
   void RecvFinalEvaluatedItems(
       const std::shared_ptr<ICipherStore>& cipher_store);
 
+  /**
+   * @brief recv server's evaluated set, or load it from cache_path if the
+   * cached set is of the current server key. A downloaded set is saved to
+   * cache_path, and an empty cache_path disables the cache.
+   *
+   * @param cache_path file of the cached set
+   */
+  std::unique_ptr<OprfEvaluatedSet> RecvEvaluatedSet(
+      const std::string& cache_path);
+
   /**
    * @brief blind input data and send to server
    *
@@ -179,7 +231,12 @@ class EcdhOprfPsiClient {
   std::mutex mutex_;
   std::condition_variable queue_push_cv_;
   std::condition_variable queue_pop_cv_;
-  std::queue<std::vector<std::shared_ptr<IEcdhOprfClient>>> oprf_client_queue_;
+  // the keys to unblind the batches in flight, each item of a batch is
+  // blinded by a fresh key.
+  std::queue<std::string> unblind_keys_queue_;
+
+  // blinds and finalizes items of the keys of the queue.
+  std::unique_ptr<IEcdhOprfClient> oprf_client_;
 
   size_t compare_length_;
   size_t ec_point_length_;
@@ -15,6 +15,7 @@
 #include "spu/psi/core/ecdh_oprf_psi.h"
 
 #include <algorithm>
+#include <filesystem>
 #include <future>
 #include <iostream>
 #include <random>
@@ -232,4 +233,101 @@ INSTANTIATE_TEST_SUITE_P(
         // Curve256k1
         TestParams{1000, CurveType::CURVE_SECP256K1}  // more than one batch
         ));
+
+TEST(UnbalancedEcdhOprfTest, Works) {
+  constexpr size_t kServerItemsSize = 5000;
+  constexpr size_t kClientItemsSize = 100;
+  auto ctxs = yacl::link::test::SetupWorld(2);
+
+  std::vector<std::string> items_a_vec(kServerItemsSize);
+  std::vector<std::string> items_b_vec(kClientItemsSize);
+  for (size_t idx = 0; idx < kServerItemsSize; ++idx) {
+    items_a_vec[idx] = std::to_string(idx);
+  }
+  // half of the client items are in the server set.
+  for (size_t idx = 0; idx < kClientItemsSize; ++idx) {
+    items_b_vec[idx] =
+        std::to_string(idx * 2 + kServerItemsSize - kClientItemsSize);
+  }
+  std::vector<std::string> intersection_std =
+      GetIntersection(items_a_vec, items_b_vec);
+
+  EcdhOprfPsiOptions server_options;
+  server_options.link0 = ctxs[0];
+  server_options.link1 = ctxs[0]->Spawn();
+  EcdhOprfPsiOptions client_options;
+  client_options.link0 = ctxs[1];
+  client_options.link1 = ctxs[1]->Spawn();
+
+  auto cache_path =
+      std::filesystem::temp_directory_path() / "unbalanced-ecdh-oprf-test";
+  std::filesystem::remove(cache_path);
+
+  auto run_session = [&](EcdhOprfPsiServer &server,
+                         const OprfEvaluatedSet &server_set) {
+    EcdhOprfPsiClient client(client_options);
+
+    std::future<void> f_server = std::async([&] {
+      server.SendEvaluatedSet(server_set);
+      server.RecvBlindAndSendEvaluate();
+    });
+
+    auto client_set = client.RecvEvaluatedSet(cache_path);
+    auto memory_store_client = std::make_shared<MemoryCipherStore>();
+    std::future<void> f_client_send_blind = std::async([&] {
+      client.SendBlindedItems(
+          std::make_shared<MemoryBatchProvider>(items_b_vec));
+    });
+    client.RecvEvaluatedItems(
+        std::make_shared<MemoryBatchProvider>(items_b_vec),
+        memory_store_client);
+    f_client_send_blind.get();
+    f_server.get();
+
+    std::vector<std::string> intersection;
+    for (size_t index :
+         client_set->Intersect(memory_store_client->self_results())) {
+      intersection.push_back(items_b_vec[index]);
+    }
+    return intersection;
+  };
+
+  EcdhOprfPsiServer server(server_options);
+  auto server_set = server.FullEvaluateSet(
+      std::make_shared<MemoryBatchProvider>(items_a_vec));
+  EXPECT_EQ(server_set->size(), kServerItemsSize);
+  EXPECT_EQ(server_set->epoch(), server.GetKeyEpoch());
+
+  // the first session downloads the set, and the next one loads the cache.
+  EXPECT_EQ(run_session(server, *server_set), intersection_std);
+  EXPECT_TRUE(std::filesystem::exists(cache_path));
+  EXPECT_EQ(run_session(server, *server_set), intersection_std);
+
+  // the same key is of the same epoch.
+  EcdhOprfPsiServer server_reload(server_options, server.GetPrivateKey());
+  EXPECT_EQ(server_reload.GetKeyEpoch(), server.GetKeyEpoch());
+  EXPECT_EQ(run_session(server_reload, *server_set), intersection_std);
+
+  // a new key makes the cache stale.
+  EcdhOprfPsiServer server_rotated(server_options);
+  EXPECT_NE(server_rotated.GetKeyEpoch(), server.GetKeyEpoch());
+  EXPECT_THROW(server_rotated.SendEvaluatedSet(*server_set),
+               yacl::EnforceNotMet);
+  auto rotated_set = server_rotated.FullEvaluateSet(
+      std::make_shared<MemoryBatchProvider>(items_a_vec));
+  EXPECT_EQ(run_session(server_rotated, *rotated_set), intersection_std);
+
+  // send and cache a filter of the set.
+  std::filesystem::remove(cache_path);
+  rotated_set->ToFilter(1e-8);
+  EXPECT_EQ(run_session(server_rotated, *rotated_set), intersection_std);
+  auto cached_set = OprfEvaluatedSet::Load(cache_path, rotated_set->epoch());
+  ASSERT_NE(cached_set, nullptr);
+  ASSERT_NE(cached_set->filter(), nullptr);
+  EXPECT_EQ(cached_set->filter()->table(), rotated_set->filter()->table());
+  EXPECT_EQ(run_session(server_rotated, *rotated_set), intersection_std);
+
+  std::filesystem::remove(cache_path);
+}
+
 }  // namespace spu::psi
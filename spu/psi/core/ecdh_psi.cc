@@ -14,6 +14,7 @@
 
 #include "spu/psi/core/ecdh_psi.h"
 
+#include <deque>
 #include <future>
 #include <utility>
 
@@ -32,6 +33,10 @@ namespace spu::psi {
 EcdhPsiContext::EcdhPsiContext(const EcdhPsiOptions& options)
     : options_(options) {
   YACL_ENFORCE(options_.link_ctx->WorldSize() == 2);
+  YACL_ENFORCE(options_.mask_cache == nullptr ||
+                   options_.mask_cache->epoch() ==
+                       options_.ecc_cryptor->GetKeyEpoch(),
+               "the mask cache is not of the cryptor key");
 
   main_link_ctx_ = options_.link_ctx;
   dual_mask_link_ctx_ = options_.link_ctx->Spawn();
@@ -55,65 +60,119 @@ void EcdhPsiContext::CheckConfig() {
                peer_config);
 }
 
+std::vector<std::string> EcdhPsiContext::MaskPoints(
+    const std::vector<std::string>& points) const {
+  if (options_.mask_cache != nullptr) {
+    return options_.mask_cache->Mask(options_.ecc_cryptor, points);
+  }
+  return Mask(options_.ecc_cryptor, points);
+}
+
 void EcdhPsiContext::MaskSelf(
     const std::shared_ptr<IBatchProvider>& batch_provider) {
+  // batches being masked, sent in the reading order.
+  std::deque<std::future<std::vector<std::string>>> inflight;
+  size_t sent_count = 0;
+  auto send_front = [&]() {
+    auto masked_items = inflight.front().get();
+    inflight.pop_front();
+    // Send x^a.
+    const auto tag = fmt::format("ECDHPSI:X^A:{}", sent_count);
+    SendBatch(masked_items, sent_count, tag);
+    if (options_.batch_size_tuner != nullptr) {
+      options_.batch_size_tuner->ObserveBatchDone(masked_items.size());
+    }
+    ++sent_count;
+  };
+
   size_t batch_count = 0;
   while (true) {
-    // NOTE: we still need to send one batch even there is no data.
-    // This dummy batch is used to notify peer the end of data stream.
-    auto batch_items = batch_provider->ReadNextBatch(options_.batch_size);
-    std::vector<std::string> masked_items;
-    if (!batch_items.empty()) {
-      masked_items = Mask(options_.ecc_cryptor,
-                          HashInputs(options_.ecc_cryptor, batch_items));
-    }
-    // Send x^a.
-    const auto tag = fmt::format("ECDHPSI:X^A:{}", batch_count);
-    SendBatch(masked_items, batch_count, tag);
+    auto batch_items = batch_provider->ReadNextBatch(
+        options_.batch_size_tuner != nullptr
+            ? options_.batch_size_tuner->batch_size()
+            : options_.batch_size);
     if (batch_items.empty()) {
+      while (!inflight.empty()) {
+        send_front();
+      }
+      // NOTE: we still need to send one batch even there is no data.
+      // This dummy batch is used to notify peer the end of data stream.
+      const auto tag = fmt::format("ECDHPSI:X^A:{}", batch_count);
+      SendBatch(std::vector<std::string>(), batch_count, tag);
       SPDLOG_INFO("MaskSelf:{}--finished, batch_count={}",
                   options_.link_ctx->Id(), batch_count);
       break;
     }
+    inflight.push_back(std::async(
+        std::launch::async, [this, items = std::move(batch_items)]() {
+          return MaskPoints(HashInputs(options_.ecc_cryptor, items));
+        }));
+    if (inflight.size() >= PipelineDepth()) {
+      send_front();
+    }
     ++batch_count;
   }
 }
 
 void EcdhPsiContext::MaskPeer(
     const std::shared_ptr<ICipherStore>& cipher_store) {
+  // batches being masked, stored and sent back in the receiving order.
+  std::deque<std::future<std::vector<std::string>>> inflight;
+  size_t sent_count = 0;
+  auto store_and_send = [&](const std::vector<std::string>& dual_masked_peers) {
+    if (CanTouchResults()) {
+      // Store cipher of peer items for later intersection compute.
+      for (const auto& cipher : dual_masked_peers) {
+        cipher_store->SavePeer(cipher);
+      }
+    }
+    // Should send out the dual masked items to peer.
+    if (PeerCanTouchResults()) {
+      const auto tag = fmt::format("ECDHPSI:Y^B^A:{}", sent_count);
+      SendDualMaskedBatch(dual_masked_peers, sent_count, tag);
+    }
+    ++sent_count;
+  };
+  auto pop_front = [&]() {
+    auto dual_masked_peers = inflight.front().get();
+    inflight.pop_front();
+    store_and_send(dual_masked_peers);
+  };
+
   size_t batch_count = 0;
   while (true) {
     // Fetch y^b.
     std::vector<std::string> peer_items;
-    std::vector<std::string> dual_masked_peers;
     const auto tag = fmt::format("ECDHPSI:Y^B:{}", batch_count);
     RecvBatch(&peer_items, batch_count, tag);
 
-    // Compute (y^b)^a.
-    if (!peer_items.empty()) {
-      // TODO: avoid mem copy
-      for (const auto& masked : Mask(options_.ecc_cryptor, peer_items)) {
-        // In the final comparison, we only send & compare `kFinalCompareBytes`
-        // number of bytes.
-        std::string cipher = masked.substr(
-            masked.length() - options_.dual_mask_size, options_.dual_mask_size);
-        if (CanTouchResults()) {
-          // Store cipher of peer items for later intersection compute.
-          cipher_store->SavePeer(cipher);
-        }
-        dual_masked_peers.emplace_back(std::move(cipher));
-      }
-    }
-    // Should send out the dual masked items to peer.
-    if (PeerCanTouchResults()) {
-      const auto tag = fmt::format("ECDHPSI:Y^B^A:{}", batch_count);
-      SendDualMaskedBatch(dual_masked_peers, batch_count, tag);
-    }
     if (peer_items.empty()) {
+      while (!inflight.empty()) {
+        pop_front();
+      }
+      store_and_send({});
       SPDLOG_INFO("MaskPeer:{}--finished, batch_count={}",
                   options_.link_ctx->Id(), batch_count);
       break;
     }
+
+    // Compute (y^b)^a.
+    inflight.push_back(std::async(
+        std::launch::async, [this, items = std::move(peer_items)]() {
+          std::vector<std::string> dual_masked_peers;
+          dual_masked_peers.reserve(items.size());
+          for (const auto& masked : MaskPoints(items)) {
+            // In the final comparison, we only send & compare
+            // `kFinalCompareBytes` number of bytes.
+            dual_masked_peers.emplace_back(
+                masked.substr(masked.length() - options_.dual_mask_size,
+                              options_.dual_mask_size));
+          }
+          return dual_masked_peers;
+        }));
+    if (inflight.size() >= PipelineDepth()) {
+      pop_front();
+    }
     batch_count++;
   }
 }
@@ -282,26 +341,18 @@ std::vector<std::string> RunEcdhPsi(
   options.target_rank = target_rank;
   options.batch_size = batch_size;
 
-  auto memory_store = std::make_shared<MemoryCipherStore>();
+  auto cipher_store = std::make_shared<FlatCipherStore>(options.dual_mask_size);
   auto batch_provider = std::make_shared<MemoryBatchProvider>(items);
 
-  RunEcdhPsi(options, batch_provider, memory_store);
+  RunEcdhPsi(options, batch_provider, cipher_store);
 
-  // Originally we should setup a hashset for peer results.
-  // But tests show that when items_count > 10,000,000, the performance of
-  // |std::unordered_set| or |absl::flat_hash_set| drops significantly.
-  // Besides, these hashset containers require more memory.
-  // Here we choose the compact data structure and stable find costs.
+  // Hashsets of |std::string| drop significantly when items_count >
+  // 10,000,000 and require much more memory, the flat store packs the
+  // ciphertexts and probes an open addressing table over them instead.
   std::vector<std::string> ret;
-  std::vector<std::string> peer_results(memory_store->peer_results());
-  std::sort(peer_results.begin(), peer_results.end());
-  const auto& self_results = memory_store->self_results();
-  for (uint32_t index = 0; index < self_results.size(); index++) {
-    if (std::binary_search(peer_results.begin(), peer_results.end(),
-                           self_results[index])) {
-      YACL_ENFORCE(index < items.size());
-      ret.push_back(items[index]);
-    }
+  for (uint64_t index : cipher_store->ComputeIntersectionIndices()) {
+    YACL_ENFORCE(index < items.size());
+    ret.push_back(items[index]);
   }
   return ret;
 }
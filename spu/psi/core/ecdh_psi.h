@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -22,8 +23,10 @@
 
 #include "yacl/link/link.h"
 
+#include "spu/psi/core/batch_size_tuner.h"
 #include "spu/psi/core/communication.h"
 #include "spu/psi/cryptor/ecc_cryptor.h"
+#include "spu/psi/cryptor/ecc_mask_cache.h"
 #include "spu/psi/utils/batch_provider.h"
 #include "spu/psi/utils/cipher_store.h"
 
@@ -51,6 +54,23 @@ struct EcdhPsiOptions {
   //     batch send and read
   size_t batch_size = kEcdhPsiBatchSize;
 
+  // Optional, tune the size of the self batches by the measured throughput
+  // instead of `batch_size`. The peer reads batches of any size. The tuned
+  // size could be read from it after the run.
+  std::shared_ptr<BatchSizeTuner> batch_size_tuner;
+
+  // The number of batches masked concurrently in each of the stages, while
+  // the stage keeps reading, sending and storing batches in order. Each
+  // EccMask is already parallel over the items, the pipeline overlaps the
+  // curve operations with io. 1 means no pipelining.
+  size_t pipeline_depth = 4;
+
+  // Optional, reuse the masks of the unchanged items of the previous runs,
+  // both the self points and the peer masked points. The cache should be of
+  // the key epoch of `ecc_cryptor`, which keeps the same private key across
+  // runs, and the peer should keep its key too to hit the peer masks.
+  std::shared_ptr<EccMaskCache> mask_cache;
+
   // Points out which rank the psi results should be revealed.
   //
   // Allowed values:
@@ -110,6 +130,14 @@ class EcdhPsiContext {
                            std::string_view tag = "");
 
  private:
+  // Mask through the cache if any.
+  std::vector<std::string> MaskPoints(
+      const std::vector<std::string>& points) const;
+
+  size_t PipelineDepth() const {
+    return std::max<size_t>(options_.pipeline_depth, 1);
+  }
+
   bool CanTouchResults() const {
     return options_.target_rank == yacl::link::kAllRank ||
            options_.target_rank == options_.link_ctx->Rank();
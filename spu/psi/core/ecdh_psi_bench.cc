@@ -78,6 +78,45 @@ static void BM_EcdhPsi(benchmark::State& state) {
   }
 }
 
+// The throughput of the selected EccMask backend alone.
+static void BM_EccMask(benchmark::State& state) {
+  const auto curve = GetOverrideCurveType();
+  auto cryptor = spu::psi::CreateEccCryptor(
+      curve.has_value() ? *curve : spu::psi::CurveType::CURVE_25519);
+  const size_t n = state.range(0);
+  auto points = spu::psi::HashInputs(cryptor, CreateRangeItems(0, n));
+  std::string batch_points;
+  for (const auto& point : points) {
+    batch_points.append(point.substr(0, cryptor->GetMaskLength()));
+  }
+  std::string out_points(batch_points.size(), '\0');
+
+  for (auto _ : state) {
+    cryptor->EccMask(batch_points, absl::MakeSpan(out_points));
+    benchmark::DoNotOptimize(out_points.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_EccMask)->Arg(4096)->Arg(64 << 10)->Arg(1 << 20);
+
+// The throughput of the selected batch hash to curve alone.
+static void BM_HashInputs(benchmark::State& state) {
+  const auto curve = GetOverrideCurveType();
+  auto cryptor = spu::psi::CreateEccCryptor(
+      curve.has_value() ? *curve : spu::psi::CurveType::CURVE_25519);
+  const size_t n = state.range(0);
+  auto items = CreateRangeItems(0, n);
+
+  for (auto _ : state) {
+    auto points = spu::psi::HashInputs(cryptor, items);
+    benchmark::DoNotOptimize(points.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_HashInputs)->Arg(4096)->Arg(64 << 10)->Arg(1 << 20);
+
 // [256k, 512k, 1m, 2m, 4m, 8m]
 BENCHMARK(BM_EcdhPsi)
     ->Arg(256 << 10)
@@ -14,9 +14,11 @@
 
 #include "spu/psi/core/kkrt_psi.h"
 
+#include <cstring>
 #include <future>
 #include <numeric>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/escaping.h"
 #include "openssl/crypto.h"
 #include "openssl/rand.h"
@@ -28,6 +30,7 @@
 #include "yacl/crypto/primitives/ot/kkrt_ot_extension.h"
 #include "yacl/crypto/utils/hash_util.h"
 #include "yacl/crypto/utils/rand.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/psi/core/communication.h"
 #include "spu/psi/core/cuckoo_index.h"
@@ -44,6 +47,20 @@ constexpr size_t kStatSecParam = 40;
 
 constexpr size_t kKkrtOtBatchSize = (65535 / 4 / 16 * 0.8);
 
+// items hashed or encoded by a thread at a time.
+constexpr size_t kParallelGrain = 4096;
+
+// oprf encodings are random, so their low bits are a good hash.
+struct EncodingHash {
+  size_t operator()(uint128_t encoding) const {
+    return static_cast<size_t>(encoding);
+  }
+};
+
+using EncodingMap = absl::flat_hash_map<uint128_t, size_t, EncodingHash>;
+
+constexpr size_t kNotFound = size_t(-1);
+
 // send set size to peer
 // get peer's item size
 //
@@ -209,35 +226,43 @@ void KkrtPsiSend(const std::shared_ptr<yacl::link::Context>& link_ctx,
   std::mt19937 rng(mt_seed);
   std::shuffle(input_permute.begin(), input_permute.end(), rng);
 
+  // the position of every item in the permuted encodings.
+  std::vector<size_t> permuted_pos(self_size);
+  for (size_t t = 0; t < self_size; ++t) {
+    permuted_pos[input_permute[t]] = t;
+  }
+
   // hash bucketing
   yacl::Buffer encode_buf(self_size * kkrt_psi_options.cuckoo_hash_num *
                           encode_size);
   std::vector<std::array<uint64_t, kCuckooHashNum>> bin_indices;
   bin_indices.resize(self_size);
-  {
-    for (size_t i = 0; i < self_size; ++i) {
-      CuckooIndex::HashRoom itemHash(items_hash[i]);
-      uint64_t bin_idx0 = itemHash.GetHash(0) % num_bins;
-      uint64_t bin_idx1 = itemHash.GetHash(1) % num_bins;
-      uint64_t bin_idx2 = itemHash.GetHash(2) % num_bins;
-
-      bin_indices[i][0] = bin_idx0;
-      // check collision
-      uint8_t c01 = (bin_idx0 == bin_idx1) ? 1 : 0;
-      bin_indices[i][1] = bin_idx1 | (c01 * uint64_t(-1));
-      uint8_t c02 = (bin_idx0 == bin_idx2 || bin_idx1 == bin_idx2) ? 1 : 0;
-      bin_indices[i][2] = bin_idx2 | (c02 * uint64_t(-1));
-      if (c01 == 1) {
-        uint8_t* encode_pos =
-            encode_buf.data<uint8_t>() +
-            (input_permute[i] * kkrt_psi_options.cuckoo_hash_num + 1) *
-                encode_size;
-        prg.Fill(absl::MakeSpan(encode_pos, encode_size));
-      }
-      if (c02 == 1) {
+  std::vector<uint8_t> collisions(self_size, 0);
+  yacl::parallel_for(
+      0, self_size, kParallelGrain, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          CuckooIndex::HashRoom itemHash(items_hash[i]);
+          uint64_t bin_idx0 = itemHash.GetHash(0) % num_bins;
+          uint64_t bin_idx1 = itemHash.GetHash(1) % num_bins;
+          uint64_t bin_idx2 = itemHash.GetHash(2) % num_bins;
+
+          bin_indices[i][0] = bin_idx0;
+          // check collision
+          uint8_t c01 = (bin_idx0 == bin_idx1) ? 1 : 0;
+          bin_indices[i][1] = bin_idx1 | (c01 * uint64_t(-1));
+          uint8_t c02 =
+              (bin_idx0 == bin_idx2 || bin_idx1 == bin_idx2) ? 1 : 0;
+          bin_indices[i][2] = bin_idx2 | (c02 * uint64_t(-1));
+          collisions[i] = c01 | (c02 << 1);
+        }
+      });
+  // colliding hashes are sent as random encodings, they are rare.
+  for (size_t i = 0; i < self_size; ++i) {
+    for (size_t h = 1; h < kCuckooHashNum; ++h) {
+      if ((collisions[i] >> (h - 1)) & 1) {
         uint8_t* encode_pos =
             encode_buf.data<uint8_t>() +
-            (input_permute[i] * kkrt_psi_options.cuckoo_hash_num + 2) *
+            (permuted_pos[i] * kkrt_psi_options.cuckoo_hash_num + h) *
                 encode_size;
         prg.Fill(absl::MakeSpan(encode_pos, encode_size));
       }
@@ -287,37 +312,46 @@ void KkrtPsiSend(const std::shared_ptr<yacl::link::Context>& link_ctx,
   // Join receiving thread and throw exceptions if any thing is wrong.
   f_recv_corrections.get();
 
+  // All corrections are set, and encoding only reads them, so the remaining
+  // encodings are computed in parallel.
+  yacl::parallel_for(
+      0, self_size, kParallelGrain, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          auto input_idx = input_permute[i];
+          uint8_t* encoding =
+              encode_buf.data<uint8_t>() +
+              (i * kkrt_psi_options.cuckoo_hash_num) * encode_size;
+          for (size_t k = 0; k < kkrt_psi_options.cuckoo_hash_num; k++) {
+            uint64_t b_idx = bin_indices[input_idx][k];
+
+            if (b_idx != uint64_t(-1)) {
+              sender.Encode(b_idx, items_hash[input_idx], encoding,
+                            encode_size);
+            }
+            encoding += encode_size;
+          }
+        }
+      });
+
   // encoding buffer
   for (size_t i = 0; i < self_size;) {
+    const auto& tuner = kkrt_psi_options.psi_batch_size_tuner;
     size_t curr_step_item_num =
-        std::min(kkrt_psi_options.psi_batch_size, self_size - i);
+        std::min(tuner != nullptr ? tuner->batch_size()
+                                  : kkrt_psi_options.psi_batch_size,
+                 self_size - i);
     size_t curr_step_encode_num =
         curr_step_item_num * kkrt_psi_options.cuckoo_hash_num;
 
     PsiDataBatch batch;
-    batch.flatten_bytes.resize(encode_size * curr_step_encode_num);
-    uint8_t* encoding = encode_buf.data<uint8_t>() +
-                        (i * kkrt_psi_options.cuckoo_hash_num) * encode_size;
-    for (size_t j = 0; j < curr_step_item_num; ++j) {
-      auto input_idx = input_permute[i + j];
-
-      for (size_t k = 0; k < kkrt_psi_options.cuckoo_hash_num; k++) {
-        uint64_t b_idx = bin_indices[input_idx][k];
-
-        if (b_idx != uint64_t(-1)) {
-          sender.Encode(b_idx, items_hash[input_idx], encoding, encode_size);
-        }
-        encoding += encode_size;
-      }
-    }
-
     batch.item_num = curr_step_item_num;
     batch.is_last_batch = false;
 
-    encoding = encode_buf.data<uint8_t>() +
-               (i * kkrt_psi_options.cuckoo_hash_num) * encode_size;
-    memcpy(batch.flatten_bytes.data(), encoding,
-           encode_size * curr_step_encode_num);
+    const uint8_t* encoding =
+        encode_buf.data<uint8_t>() +
+        (i * kkrt_psi_options.cuckoo_hash_num) * encode_size;
+    batch.flatten_bytes.assign(reinterpret_cast<const char*>(encoding),
+                               encode_size * curr_step_encode_num);
 
     i += curr_step_item_num;
     if (i == self_size) {
@@ -327,6 +361,9 @@ void KkrtPsiSend(const std::shared_ptr<yacl::link::Context>& link_ctx,
     link_ctx->SendAsync(
         link_ctx->NextRank(), batch.Serialize(),
         fmt::format("KKRT:PSI:SENDER OPRF:{}", curr_step_item_num));
+    if (tuner != nullptr) {
+      tuner->ObserveBatchDone(curr_step_item_num);
+    }
   }
 
   const char* finish_str = "kkrt finish";
@@ -368,8 +405,8 @@ std::vector<std::size_t> KkrtPsiRecv(
   receiver.SetBatchSize(kkrt_psi_options.ot_batch_size);
   uint64_t kkrt_ot_batch_size = receiver.GetBatchSize();
 
-  std::array<std::unordered_map<std::string, size_t>, kCuckooHashNum>
-      oprf_encode_map;
+  // encodings of at most 16 bytes, zero padded, to the input index.
+  std::array<EncodingMap, kCuckooHashNum> oprf_encode_map;
   for (size_t i = 0; i < kCuckooHashNum; i++) {
     oprf_encode_map[i].reserve(kkrt_ot_num);
   }
@@ -378,8 +415,7 @@ std::vector<std::size_t> KkrtPsiRecv(
                      peer_size);  // by byte
 
   // encoding prf & send correction
-  auto ck_bins = cuckoo_index.bins();
-  std::string encode_str(encode_size, '\0');
+  const auto& ck_bins = cuckoo_index.bins();
   const size_t ot_num_batch =
       (kkrt_ot_num + kkrt_ot_batch_size - 1) / kkrt_ot_batch_size;
   for (size_t batch_idx = 0; batch_idx < ot_num_batch; ++batch_idx) {
@@ -393,13 +429,14 @@ std::vector<std::size_t> KkrtPsiRecv(
         receiver.ZeroEncode(current_idx);
       } else {
         uint128_t input_item = items_hash[ck_bins[current_idx].InputIdx()];
+        uint128_t encoding = 0;
         receiver.Encode(
             current_idx, input_item,
-            absl::Span<uint8_t>(reinterpret_cast<uint8_t*>(&encode_str[0]),
+            absl::Span<uint8_t>(reinterpret_cast<uint8_t*>(&encoding),
                                 encode_size));
 
         uint8_t min_hash_idx = cuckoo_index.MinCollidingHashIdx(current_idx);
-        oprf_encode_map[min_hash_idx].emplace(encode_str,
+        oprf_encode_map[min_hash_idx].emplace(encoding,
                                               ck_bins[current_idx].InputIdx());
       }
     }
@@ -425,16 +462,28 @@ std::vector<std::size_t> KkrtPsiRecv(
     YACL_ENFORCE_EQ(batch.flatten_bytes.size(),
                     (curr_step_encode_num * encode_size));
 
-    for (size_t i = 0; i < curr_step_item_num; ++i) {
-      for (size_t j = 0; j < kkrt_psi_options.cuckoo_hash_num; ++j) {
-        std::string encode_sub_str = batch.flatten_bytes.substr(
-            (i * kkrt_psi_options.cuckoo_hash_num + j) * encode_size,
-            encode_size);
+    // probe in parallel, and keep the hits in the order of the encodings.
+    std::vector<size_t> hits(curr_step_encode_num, kNotFound);
+    yacl::parallel_for(
+        0, curr_step_item_num, kParallelGrain / kCuckooHashNum,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            for (size_t j = 0; j < kkrt_psi_options.cuckoo_hash_num; ++j) {
+              size_t pos = i * kkrt_psi_options.cuckoo_hash_num + j;
+              uint128_t encoding = 0;
+              std::memcpy(&encoding, &batch.flatten_bytes[pos * encode_size],
+                          encode_size);
 
-        auto it = oprf_encode_map[j].find(encode_sub_str);
-        if (it != oprf_encode_map[j].end()) {
-          ret_intersection.emplace_back(it->second);
-        }
+              auto it = oprf_encode_map[j].find(encoding);
+              if (it != oprf_encode_map[j].end()) {
+                hits[pos] = it->second;
+              }
+            }
+          }
+        });
+    for (size_t hit : hits) {
+      if (hit != kNotFound) {
+        ret_intersection.emplace_back(hit);
       }
     }
 
@@ -24,6 +24,8 @@
 #include "yacl/crypto/primitives/ot/options.h"
 #include "yacl/link/link.h"
 
+#include "spu/psi/core/batch_size_tuner.h"
+
 //
 // implementation of KKRT16 PSI protocol
 // https://eprint.iacr.org/2016/799.pdf
@@ -42,6 +44,11 @@ struct KkrtPsiOptions {
   // batch size the sender used to send oprf encode
   size_t psi_batch_size = 128;
 
+  // Optional, tune the size of the oprf encode batches by the measured
+  // throughput instead of `psi_batch_size`. The receiver reads batches of any
+  // size. The ot batches are agreed by both sides and stay fixed.
+  std::shared_ptr<BatchSizeTuner> psi_batch_size_tuner;
+
   // cuckoo hash parameter
   // now use stashless setting
   // stash_size = 0  cuckoo_hash_num =3
@@ -19,6 +19,7 @@
 #include "yacl/base/exception.h"
 #include "yacl/crypto/utils/hash_util.h"
 #include "yacl/link/test_util.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/psi/core/kkrt_psi.h"
 
@@ -53,10 +54,12 @@ std::vector<std::size_t> KkrtPsiRecv(
 
 }  // namespace
 
+// range(0): items of each side, range(1): threads of each side.
 static void BM_KkrtPsi(benchmark::State& state) {
+  size_t n = state.range(0);
+  yacl::set_num_threads(state.range(1));
   for (auto _ : state) {
     state.PauseTiming();
-    size_t n = state.range(0);
     auto alice_items = CreateRangeItems(1, n);
     auto bob_items = CreateRangeItems(2, n);
 
@@ -72,16 +75,13 @@ static void BM_KkrtPsi(benchmark::State& state) {
     kkrt_psi_sender.get();
     auto results_b = kkrt_psi_receiver.get();
   }
+  state.SetItemsProcessed(state.iterations() * n);
 }
 
-// [256k, 512k, 1m, 2m, 4m, 8m]
+// [256k, 512k, 1m, 2m, 4m, 8m] x [1, 4, 16] threads
 BENCHMARK(BM_KkrtPsi)
     ->Unit(benchmark::kMillisecond)
-    ->Arg(256 << 10)
-    ->Arg(512 << 10)
-    ->Arg(1 << 20)
-    ->Arg(2 << 20)
-    ->Arg(4 << 20)
-    ->Arg(8 << 20);
+    ->ArgsProduct({{256 << 10, 512 << 10, 1 << 20, 2 << 20, 4 << 20, 8 << 20},
+                   {1, 4, 16}});
 
 BENCHMARK_MAIN();
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <future>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -30,6 +35,7 @@
 #include "spu/psi/core/labeled_psi/psi_params.h"
 #include "spu/psi/core/labeled_psi/receiver.h"
 #include "spu/psi/core/labeled_psi/sender.h"
+#include "spu/psi/core/labeled_psi/sender_db.h"
 
 namespace spu::psi {
 
@@ -247,6 +253,93 @@ TEST_P(LabelPsiTest, Works) {
   EXPECT_EQ(intersection_label, query_result.second);
 }
 
+TEST(SenderDBTest, InsertBatches) {
+  apsi::PSIParams psi_params = spu::psi::GetPsiParams(1, 10000);
+  const size_t label_byte_count = 16;
+  const size_t nonce_byte_count = 16;
+
+  std::array<uint8_t, 32> oprf_key;
+  yacl::Prg<uint128_t> prg(42);
+  prg.Fill(absl::MakeSpan(oprf_key));
+
+  std::vector<std::string> items = GenerateData(1, 10000);
+  std::vector<std::string> labels = GenerateData(2, items.size());
+  std::vector<std::pair<apsi::Item, apsi::Label>> data;
+  for (size_t i = 0; i < items.size(); ++i) {
+    apsi::Item item;
+    std::memcpy(item.value().data(), items[i].data(), items[i].size());
+    data.emplace_back(item, apsi::Label(labels[i].begin(), labels[i].end()));
+  }
+
+  SenderDB vector_db(psi_params, oprf_key, label_byte_count, nonce_byte_count,
+                     false);
+  vector_db.SetData(data);
+
+  SenderDB batch_db(psi_params, oprf_key, label_byte_count, nonce_byte_count,
+                    false);
+  EXPECT_THROW(batch_db.InsertOrAssign(
+                   std::make_shared<MemoryBatchProvider>(items), nullptr, 999),
+               yacl::EnforceNotMet);
+  batch_db.InsertOrAssign(std::make_shared<MemoryBatchProvider>(items),
+                          std::make_shared<MemoryBatchProvider>(labels), 999);
+
+  // the batches fill the bundles in the same order as a single insertion.
+  EXPECT_EQ(batch_db.GetItemCount(), items.size());
+  EXPECT_EQ(batch_db.GetBinBundleCount(), vector_db.GetBinBundleCount());
+  for (size_t i = 0; i < data.size(); i += 1000) {
+    EXPECT_EQ(batch_db.GetLabel(data[i].first), data[i].second);
+  }
+
+  // only the bundles of the removed items get new caches.
+  batch_db.remove(std::vector<apsi::Item>{data[0].first, data[1].first});
+  EXPECT_EQ(batch_db.GetItemCount(), items.size() - 2);
+  EXPECT_FALSE(batch_db.HasItem(data[0].first));
+  EXPECT_TRUE(batch_db.HasItem(data[2].first));
+}
+
+TEST(SenderDBTest, Snapshot) {
+  apsi::PSIParams psi_params = spu::psi::GetPsiParams(1, 10000);
+
+  std::array<uint8_t, 32> oprf_key;
+  yacl::Prg<uint128_t> prg(42);
+  prg.Fill(absl::MakeSpan(oprf_key));
+
+  std::vector<std::string> items = GenerateData(1, 1000);
+  std::vector<std::string> labels = GenerateData(2, items.size());
+  SenderDB sender_db(psi_params, oprf_key, 16, 16, false);
+  sender_db.InsertOrAssign(std::make_shared<MemoryBatchProvider>(items),
+                           std::make_shared<MemoryBatchProvider>(labels), 100);
+
+  auto path = std::filesystem::temp_directory_path() / "sender_db_snapshot";
+  sender_db.SaveSnapshot(path);
+  auto loaded = SenderDB::LoadSnapshot(path);
+
+  EXPECT_EQ(loaded->GetItemCount(), sender_db.GetItemCount());
+  EXPECT_EQ(loaded->GetBinBundleCount(), sender_db.GetBinBundleCount());
+  EXPECT_EQ(loaded->GetHashedItems(), sender_db.GetHashedItems());
+  EXPECT_EQ(loaded->GetOprfKey(), sender_db.GetOprfKey());
+  for (size_t i = 0; i < items.size(); i += 100) {
+    apsi::Item item;
+    std::memcpy(item.value().data(), items[i].data(), items[i].size());
+    EXPECT_EQ(loaded->GetLabel(item),
+              apsi::Label(labels[i].begin(), labels[i].end()));
+  }
+
+  // a stripped snapshot keeps the bundles only.
+  sender_db.strip();
+  sender_db.SaveSnapshot(path);
+  loaded = SenderDB::LoadSnapshot(path);
+  EXPECT_TRUE(loaded->IsStripped());
+  EXPECT_EQ(loaded->GetBinBundleCount(), sender_db.GetBinBundleCount());
+
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "not a snapshot, but long enough to hold the whole header....";
+  }
+  EXPECT_THROW(SenderDB::LoadSnapshot(path), yacl::EnforceNotMet);
+  std::filesystem::remove(path);
+}
+
 INSTANTIATE_TEST_SUITE_P(Works_Instances, LabelPsiTest,
                          testing::Values(  //
 #if 0
@@ -275,6 +368,7 @@ INSTANTIATE_TEST_SUITE_P(Works_Instances, LabelPsiTest,
                              TestParams{1, 10000, 0},       // 1-10K
                              TestParams{1, 100000, 0},      // 1-100K
                              TestParams{256, 100000, 0},    // 256-100K
+                             TestParams{10000, 100000, 0},  // 10000-100K
                              TestParams{2048, 100000, 32},  // 2048-100K-32
                              TestParams{4096, 100000, 32})  // 4096-100K-32
 #endif
@@ -18,6 +18,7 @@
 
 #include "spdlog/spdlog.h"
 #include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
 
 namespace spu::psi {
 
@@ -26,33 +27,32 @@ PlainResultPackage ResultPackage::extract(
   YACL_ENFORCE(crypto_context.decryptor(),
                "decryptor is not configured in CryptoContext");
 
-  // SPDLOG_INFO("extract ciphertext");
-
-  seal::Ciphertext psi_result_ct =
-      psi_result.extract(crypto_context.seal_context());
-  seal::Plaintext psi_result_pt;
-  crypto_context.decryptor()->decrypt(psi_result_ct, psi_result_pt);
-
-  SPDLOG_DEBUG(
-      "Matching result noise budget: {}",
-      crypto_context.decryptor()->invariant_noise_budget(psi_result_ct));
-
   PlainResultPackage plain_rp;
   plain_rp.bundle_idx = bundle_idx;
-  crypto_context.encoder()->decode(psi_result_pt, plain_rp.psi_result);
-
   plain_rp.label_byte_count = label_byte_count;
   plain_rp.nonce_byte_count = nonce_byte_count;
-  for (auto &ct : label_result) {
-    seal::Ciphertext label_result_ct =
-        ct.extract(crypto_context.seal_context());
-    seal::Plaintext label_result_pt;
-    crypto_context.decryptor()->decrypt(label_result_ct, label_result_pt);
-
-    std::vector<uint64_t> label_result_data;
-    crypto_context.encoder()->decode(label_result_pt, label_result_data);
-    plain_rp.label_result.push_back(move(label_result_data));
-  }
+  plain_rp.label_result.resize(label_result.size());
+
+  // the matching result and the label parts are decrypted concurrently, the
+  // decryptor and the encoder are of const methods only.
+  auto decrypt = [&](apsi::SEALObject<seal::Ciphertext> &ct,
+                     std::vector<uint64_t> *out) {
+    seal::Ciphertext result_ct = ct.extract(crypto_context.seal_context());
+    seal::Plaintext result_pt;
+    crypto_context.decryptor()->decrypt(result_ct, result_pt);
+    crypto_context.encoder()->decode(result_pt, *out);
+  };
+  yacl::parallel_for(0, label_result.size() + 1, 1,
+                     [&](int64_t begin, int64_t end) {
+                       for (int64_t idx = begin; idx < end; ++idx) {
+                         if (idx == 0) {
+                           decrypt(psi_result, &plain_rp.psi_result);
+                         } else {
+                           decrypt(label_result[idx - 1],
+                                   &plain_rp.label_result[idx - 1]);
+                         }
+                       }
+                     });
 
   // Clear the label data
   label_result.clear();
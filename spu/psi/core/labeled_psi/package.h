@@ -23,6 +23,13 @@
 
 namespace spu::psi {
 
+// The OPRF items are streamed in batches, the sender evaluates the received
+// batches while the receiver is still blinding and sending the following
+// ones, up to kOprfPipelineDepth batches in flight. An empty batch ends the
+// stream.
+inline constexpr size_t kOprfBatchSize = 4096;
+inline constexpr size_t kOprfPipelineDepth = 4;
+
 struct PlainResultPackage {
   std::uint32_t bundle_idx;
 
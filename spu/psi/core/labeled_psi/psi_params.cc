@@ -15,9 +15,16 @@
 #include "spu/psi/core/labeled_psi/psi_params.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <limits>
+#include <optional>
+#include <set>
 #include <string>
 
+#include "apsi/powers.h"
+#include "apsi/util/utils.h"
+#include "seal/seal.h"
 #include "spdlog/spdlog.h"
 
 namespace spu::psi {
@@ -45,6 +52,31 @@ std::vector<SEALParams> kSealParams = {
     {8192, 65537, 0, {56, 56, 30}},       // 14
 };
 
+// Query powers of GetPsiParams by the SEAL parameters they are validated
+// with, the candidates of TunePsiParams.
+struct QueryProfile {
+  size_t seal_params_idx;
+  uint32_t ps_low_degree;
+  uint32_t max_items_per_bin;
+  // empty for all the powers up to max_items_per_bin
+  std::set<uint32_t> query_powers;
+};
+
+const std::vector<QueryProfile> kQueryProfiles = {
+    {0, 0, 20, {}},
+    {0, 0, 35, {}},
+    {0, 0, 55, {}},
+    {3, 5, 60, {1, 2, 3, 4, 5, 6, 18, 30, 42, 54, 60}},
+    {11, 8, 96, {1, 3, 4, 9, 27}},
+    {11, 44, 528, {1, 3, 11, 18, 45, 225}},
+    {11, 310, 3720, {1, 4, 10, 11, 28, 33, 78, 118, 143, 311, 1555}},
+};
+
+// Table sizes tried, as multiples of the least bundle count. More bundles
+// spread the sender items over more bins, so fewer bin bundles per bundle
+// index and more parallelism, for a larger query.
+constexpr size_t kMaxBundleCountFactor = 8;
+
 }  // namespace
 
 yacl::Buffer PsiParamsToBuffer(const apsi::PSIParams &psi_params) {
@@ -155,6 +187,27 @@ inline size_t GetHashTruncateSize(size_t nr, size_t ns,
   return l1;
 }
 
+apsi::PSIParams::SEALParams CreateApsiSealParams(SEALParams seal_params) {
+  apsi::PSIParams::SEALParams apsi_seal_params;
+  apsi_seal_params.set_poly_modulus_degree(seal_params.poly_modulus_degree);
+
+  if (seal_params.plain_modulus_bits > 0) {
+    apsi_seal_params.set_plain_modulus(seal::PlainModulus::Batching(
+        seal_params.poly_modulus_degree, seal_params.plain_modulus_bits));
+
+  } else if (seal_params.plain_modulus > 0) {
+    apsi_seal_params.set_plain_modulus(seal_params.plain_modulus);
+  } else {
+    YACL_THROW(
+        "SEALParams error, must set plain_modulus or plain_modulus_bits");
+  }
+
+  apsi_seal_params.set_coeff_modulus(seal::CoeffModulus::Create(
+      seal_params.poly_modulus_degree, seal_params.coeff_modulus_bits));
+
+  return apsi_seal_params;
+}
+
 SEALParams GetSealParams(size_t nr, size_t ns) {
   if (nr == 1) {
     if (ns <= 3000000) {  // 3M
@@ -241,26 +294,278 @@ apsi::PSIParams GetPsiParams(size_t nr, size_t ns) {
   }
 
   // seal param
-  apsi_seal_params.set_poly_modulus_degree(seal_params.poly_modulus_degree);
+  apsi_seal_params = CreateApsiSealParams(seal_params);
 
-  if (seal_params.plain_modulus_bits > 0) {
-    apsi_seal_params.set_plain_modulus(seal::PlainModulus::Batching(
-        seal_params.poly_modulus_degree, seal_params.plain_modulus_bits));
+  apsi::PSIParams psi_params(item_params, table_params, query_params,
+                             apsi_seal_params);
 
-  } else if (seal_params.plain_modulus > 0) {
-    apsi_seal_params.set_plain_modulus(seal_params.plain_modulus);
-  } else {
-    YACL_THROW(
-        "SEALParams error, must set plain_modulus or plain_modulus_bits");
+  return psi_params;
+}
+
+namespace {
+
+apsi::PSIParams CreateTunedPsiParams(const QueryProfile &profile, size_t nr,
+                                     size_t ns, size_t bundle_count) {
+  SEALParams seal_params = kSealParams[profile.seal_params_idx];
+
+  apsi::PSIParams::ItemParams item_params;
+  apsi::PSIParams::TableParams table_params;
+  apsi::PSIParams::QueryParams query_params;
+
+  size_t hash_size = GetHashTruncateSize(nr, ns);
+  item_params.felts_per_item = std::ceil(
+      static_cast<double>(hash_size) / (seal_params.GetPlainModulusBits() - 1));
+
+  table_params.hash_func_count = nr == 1 ? 1 : 3;
+  table_params.table_size = bundle_count * (seal_params.poly_modulus_degree /
+                                            item_params.felts_per_item);
+  table_params.max_items_per_bin = profile.max_items_per_bin;
+
+  query_params.ps_low_degree = profile.ps_low_degree;
+  query_params.query_powers = profile.query_powers;
+  if (query_params.query_powers.empty()) {
+    for (size_t idx = 0; idx < table_params.max_items_per_bin; ++idx) {
+      query_params.query_powers.insert(idx + 1);
+    }
   }
 
-  apsi_seal_params.set_coeff_modulus(seal::CoeffModulus::Create(
-      seal_params.poly_modulus_degree, seal_params.coeff_modulus_bits));
+  return apsi::PSIParams(item_params, table_params, query_params,
+                         CreateApsiSealParams(seal_params));
+}
 
-  apsi::PSIParams psi_params(item_params, table_params, query_params,
-                             apsi_seal_params);
+// Whether the query powers compute all the powers of the Paterson-Stockmeyer
+// evaluation, as LabelPsiReceiver::ResetPowersDag does.
+bool IsPowersDagConfigurable(const apsi::PSIParams &psi_params) {
+  apsi::PowersDag pd;
+  pd.configure(psi_params.query_params().query_powers,
+               apsi::util::create_powers_set(
+                   psi_params.query_params().ps_low_degree,
+                   psi_params.table_params().max_items_per_bin));
+  return pd.is_configured();
+}
 
-  return psi_params;
+double GetCost(const PsiParamsCost &cost, PsiParamsTarget target) {
+  switch (target) {
+    case PsiParamsTarget::kReceiverLatency:
+      return cost.receiver_latency_ns;
+    case PsiParamsTarget::kSenderCpu:
+      return cost.sender_cpu_ns;
+    case PsiParamsTarget::kBandwidth:
+      return static_cast<double>(cost.query_bytes + cost.response_bytes);
+  }
+  YACL_THROW("unknown psi params target {}", static_cast<int>(target));
+}
+
+}  // namespace
+
+LabelPsiCostModel CalibrateLabelPsiCostModel(size_t sender_threads,
+                                             double bandwidth_bytes_per_sec) {
+  constexpr size_t kReps = 8;
+  // kSealParams[3], of two data primes and a special prime.
+  const SEALParams &calib_params = kSealParams[3];
+  const double degree = calib_params.poly_modulus_degree;
+  const double data_primes = calib_params.coeff_modulus_bits.size() - 1;
+
+  seal::EncryptionParameters parms(seal::scheme_type::bfv);
+  parms.set_poly_modulus_degree(calib_params.poly_modulus_degree);
+  parms.set_coeff_modulus(seal::CoeffModulus::Create(
+      calib_params.poly_modulus_degree, calib_params.coeff_modulus_bits));
+  parms.set_plain_modulus(calib_params.plain_modulus);
+  seal::SEALContext context(parms);
+
+  seal::KeyGenerator keygen(context);
+  seal::PublicKey public_key;
+  keygen.create_public_key(public_key);
+  seal::RelinKeys relin_keys;
+  keygen.create_relin_keys(relin_keys);
+  seal::Encryptor encryptor(context, public_key);
+  seal::Decryptor decryptor(context, keygen.secret_key());
+  seal::Evaluator evaluator(context);
+
+  auto time_ns = [&](const auto &fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t rep = 0; rep < kReps; ++rep) {
+      fn();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kReps;
+  };
+
+  seal::Plaintext plain(calib_params.poly_modulus_degree);
+  plain.set_zero();
+  plain[0] = 1;
+  seal::Ciphertext ct;
+  seal::Ciphertext ct_out;
+  seal::Plaintext plain_out;
+
+  LabelPsiCostModel model;
+  model.sender_threads = sender_threads;
+  model.bandwidth_bytes_per_sec = bandwidth_bytes_per_sec;
+  model.encrypt_ns =
+      time_ns([&] { encryptor.encrypt(plain, ct); }) / (degree * data_primes);
+  model.ct_ct_mult_ns = time_ns([&] {
+                          evaluator.multiply(ct, ct, ct_out);
+                          evaluator.relinearize_inplace(ct_out, relin_keys);
+                        }) /
+                        (degree * data_primes * data_primes);
+  model.decrypt_ns = time_ns([&] { decryptor.decrypt(ct, plain_out); }) /
+                     (degree * data_primes);
+
+  // the sender keeps its plaintexts and the powers in NTT form.
+  seal::Plaintext plain_ntt = plain;
+  evaluator.transform_to_ntt_inplace(plain_ntt, context.first_parms_id());
+  seal::Ciphertext ct_ntt = ct;
+  evaluator.transform_to_ntt_inplace(ct_ntt);
+  model.ct_pt_mult_ns =
+      time_ns([&] { evaluator.multiply_plain(ct_ntt, plain_ntt, ct_out); }) /
+      (degree * data_primes);
+
+  return model;
+}
+
+PsiParamsCost EstimatePsiParamsCost(const apsi::PSIParams &psi_params,
+                                    size_t ns,
+                                    const PsiParamsTuneOptions &options) {
+  const auto &model = options.cost_model;
+  const auto &table_params = psi_params.table_params();
+  const auto &query_params = psi_params.query_params();
+  const auto &coeff_modulus = psi_params.seal_params().coeff_modulus();
+
+  const double degree = psi_params.seal_params().poly_modulus_degree();
+  // the last prime is the special prime of key switching if more than one.
+  const size_t data_primes =
+      coeff_modulus.size() > 1 ? coeff_modulus.size() - 1 : 1;
+  size_t data_bits = 0;
+  size_t all_bits = 0;
+  for (size_t idx = 0; idx < coeff_modulus.size(); ++idx) {
+    all_bits += coeff_modulus[idx].bit_count();
+    if (idx < data_primes) {
+      data_bits += coeff_modulus[idx].bit_count();
+    }
+  }
+
+  const size_t bundle_count = psi_params.bundle_idx_count();
+  const size_t max_items_per_bin = table_params.max_items_per_bin;
+
+  // the bin bundles of a bundle index hold its most loaded bin.
+  const double load = static_cast<double>(ns) * table_params.hash_func_count /
+                      table_params.table_size;
+  const double max_load =
+      load + std::sqrt(2 * load * std::log(psi_params.items_per_bundle())) + 1;
+  const auto bin_bundles = std::max<size_t>(
+      1, static_cast<size_t>(std::ceil(max_load / max_items_per_bin)));
+
+  size_t label_size = 0;
+  if (options.label_byte_count > 0) {
+    label_size = (8 * (options.label_byte_count + options.nonce_byte_count) +
+                  psi_params.item_bit_count() - 1) /
+                 psi_params.item_bit_count();
+  }
+  const size_t polys = bin_bundles * (1 + label_size);
+
+  const size_t source_powers = query_params.query_powers.size();
+  const size_t target_powers =
+      apsi::util::create_powers_set(query_params.ps_low_degree,
+                                    max_items_per_bin)
+          .size();
+  const size_t powers_mults =
+      target_powers > source_powers ? target_powers - source_powers : 0;
+
+  const double ct_ct_ns =
+      model.ct_ct_mult_ns * degree * data_primes * data_primes;
+  const double ct_pt_ns = model.ct_pt_mult_ns * degree * data_primes;
+  double poly_ns = max_items_per_bin * ct_pt_ns;
+  if (query_params.ps_low_degree > 0) {
+    poly_ns += static_cast<double>(max_items_per_bin) /
+               (query_params.ps_low_degree + 1) * ct_ct_ns;
+  }
+  const double bundle_ns = powers_mults * ct_ct_ns + polys * poly_ns;
+
+  PsiParamsCost cost;
+  cost.sender_cpu_ns = bundle_count * bundle_ns;
+
+  // fresh ciphertexts and keys are seeded, so of a single polynomial.
+  const auto query_ct_bytes = static_cast<size_t>(degree * data_bits / 8);
+  const size_t relin_key_bytes =
+      powers_mults > 0 || query_params.ps_low_degree > 0
+          ? data_primes * static_cast<size_t>(degree * all_bits / 8)
+          : 0;
+  // the responses are switched to the last data prime.
+  const auto response_ct_bytes =
+      static_cast<size_t>(2 * degree * coeff_modulus[0].bit_count() / 8);
+  cost.query_bytes =
+      bundle_count * source_powers * query_ct_bytes + relin_key_bytes;
+  cost.response_bytes = bundle_count * polys * response_ct_bytes;
+
+  const size_t parallel = std::max<size_t>(
+      1, std::min<size_t>(model.sender_threads, bundle_count));
+  const double sender_latency_ns =
+      std::ceil(static_cast<double>(bundle_count) / parallel) * bundle_ns;
+  const double transfer_ns =
+      static_cast<double>(cost.query_bytes + cost.response_bytes) /
+      model.bandwidth_bytes_per_sec * 1e9;
+  cost.receiver_latency_ns =
+      bundle_count * source_powers * model.encrypt_ns * degree * data_primes +
+      sender_latency_ns + transfer_ns +
+      bundle_count * polys * model.decrypt_ns * degree;
+
+  return cost;
+}
+
+apsi::PSIParams TunePsiParams(size_t nr, size_t ns,
+                              const PsiParamsTuneOptions &options,
+                              PsiParamsCost *cost) {
+  YACL_ENFORCE(nr > 0 && ns > 0, "empty psi sets, nr={} ns={}", nr, ns);
+
+  std::optional<apsi::PSIParams> best_params;
+  PsiParamsCost best_cost;
+  double best = std::numeric_limits<double>::infinity();
+
+  for (const auto &profile : kQueryProfiles) {
+    // the least bundle count for the cuckoo table of the receiver.
+    auto params = CreateTunedPsiParams(profile, nr, ns, 1);
+    if (!IsPowersDagConfigurable(params)) {
+      SPDLOG_WARN("skip psi params of ps_low_degree {}, bad query powers",
+                  profile.ps_low_degree);
+      continue;
+    }
+    const size_t cuckoo_table_size = std::ceil(1.6 * nr);
+    const size_t min_bundle_count =
+        (cuckoo_table_size + params.items_per_bundle() - 1) /
+        params.items_per_bundle();
+
+    for (size_t factor = 1; factor <= kMaxBundleCountFactor; factor *= 2) {
+      params = CreateTunedPsiParams(profile, nr, ns,
+                                    std::max<size_t>(1, min_bundle_count) *
+                                        factor);
+      auto params_cost = EstimatePsiParamsCost(params, ns, options);
+      double value = GetCost(params_cost, options.target);
+      if (value < best) {
+        best = value;
+        best_cost = params_cost;
+        best_params.emplace(std::move(params));
+      }
+    }
+  }
+  YACL_ENFORCE(best_params.has_value(), "no psi params for nr={} ns={}", nr,
+               ns);
+
+  SPDLOG_INFO(
+      "tuned psi params, poly_modulus_degree={} table_size={} "
+      "max_items_per_bin={} ps_low_degree={}, estimated sender_cpu={}ms "
+      "latency={}ms query={}B response={}B",
+      best_params->seal_params().poly_modulus_degree(),
+      best_params->table_params().table_size,
+      best_params->table_params().max_items_per_bin,
+      best_params->query_params().ps_low_degree, best_cost.sender_cpu_ns / 1e6,
+      best_cost.receiver_latency_ns / 1e6, best_cost.query_bytes,
+      best_cost.response_bytes);
+
+  if (cost != nullptr) {
+    *cost = best_cost;
+  }
+  return *best_params;
 }
 
 }  // namespace spu::psi
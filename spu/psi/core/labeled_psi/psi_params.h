@@ -57,6 +57,95 @@ struct SEALParams {
  */
 apsi::PSIParams GetPsiParams(size_t nr, size_t ns);
 
+/**
+ * @brief What TunePsiParams minimizes
+ */
+enum class PsiParamsTarget {
+  // query and response transfer, plus the sender evaluation with the bundles
+  // run in parallel
+  kReceiverLatency,
+  // total homomorphic work of the sender
+  kSenderCpu,
+  // bytes of the query and the response
+  kBandwidth,
+};
+
+/**
+ * @brief Cost of the homomorphic ops, in nanoseconds per polynomial
+ * coefficient per rns prime, so they scale to other SEAL parameters
+ */
+struct LabelPsiCostModel {
+  // multiply + relinearize, per coefficient per prime squared
+  double ct_ct_mult_ns = 30.0;
+  // multiply by a NTT plaintext, as the sender caches them
+  double ct_pt_mult_ns = 1.5;
+  double encrypt_ns = 30.0;
+  double decrypt_ns = 9.0;
+
+  double bandwidth_bytes_per_sec = 100.0 * 1024 * 1024;
+  size_t sender_threads = 1;
+};
+
+/**
+ * @brief Measure the cost model of this machine by timing a few SEAL ops
+ *
+ * @param sender_threads threads of the sender to evaluate the bundles
+ * @param bandwidth_bytes_per_sec bandwidth between the parties
+ * @return LabelPsiCostModel
+ */
+LabelPsiCostModel CalibrateLabelPsiCostModel(
+    size_t sender_threads, double bandwidth_bytes_per_sec);
+
+struct PsiParamsTuneOptions {
+  // label byte count of the SenderDB, 0 for unlabeled
+  size_t label_byte_count = 0;
+  size_t nonce_byte_count = 16;
+
+  PsiParamsTarget target = PsiParamsTarget::kReceiverLatency;
+  LabelPsiCostModel cost_model;
+};
+
+/**
+ * @brief Estimated cost of one query
+ */
+struct PsiParamsCost {
+  double sender_cpu_ns = 0;
+  double receiver_latency_ns = 0;
+  size_t query_bytes = 0;
+  size_t response_bytes = 0;
+};
+
+/**
+ * @brief Estimate the cost of a query against ns sender items, the receiver
+ * items are already of the table size of psi_params
+ *
+ * @param psi_params apsi::PSIParams
+ * @param ns sender's items size
+ * @param options label size and cost model
+ * @return PsiParamsCost
+ */
+PsiParamsCost EstimatePsiParamsCost(const apsi::PSIParams &psi_params,
+                                    size_t ns,
+                                    const PsiParamsTuneOptions &options);
+
+/**
+ * @brief Search the SEAL parameters, query powers and table size of the
+ * least cost for options.target
+ *
+ * Only the validated pairs of SEAL parameters and query powers of
+ * GetPsiParams are tried, as the noise budget is not modeled. The returned
+ * params are those to create the SenderDB by, and are kept by its snapshot.
+ *
+ * @param nr receiver's items size
+ * @param ns sender's items size
+ * @param options label size, target and cost model
+ * @param cost optional, the estimated cost of the returned params
+ * @return apsi::PSIParams
+ */
+apsi::PSIParams TunePsiParams(size_t nr, size_t ns,
+                              const PsiParamsTuneOptions &options,
+                              PsiParamsCost *cost = nullptr);
+
 /**
  * @brief Serialize apsi::PSIParams to yacl::Buffer
  *
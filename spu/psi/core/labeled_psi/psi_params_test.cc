@@ -0,0 +1,106 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "spu/psi/core/labeled_psi/psi_params.h"
+
+#include <tuple>
+
+#include "apsi/powers.h"
+#include "apsi/util/utils.h"
+#include "gtest/gtest.h"
+
+namespace spu::psi {
+
+class TunePsiParamsTest
+    : public ::testing::TestWithParam<std::tuple<size_t, size_t, size_t>> {};
+
+TEST_P(TunePsiParamsTest, Works) {
+  const auto [nr, ns, label_bytes] = GetParam();
+
+  PsiParamsTuneOptions options;
+  options.label_byte_count = label_bytes;
+  options.cost_model.sender_threads = 8;
+
+  std::vector<PsiParamsCost> costs;
+  for (auto target :
+       {PsiParamsTarget::kReceiverLatency, PsiParamsTarget::kSenderCpu,
+        PsiParamsTarget::kBandwidth}) {
+    options.target = target;
+    PsiParamsCost cost;
+    apsi::PSIParams params = TunePsiParams(nr, ns, options, &cost);
+
+    EXPECT_GE(params.table_params().table_size, 1.6 * nr);
+    EXPECT_EQ(params.table_params().table_size % params.items_per_bundle(),
+              0U);
+
+    apsi::PowersDag pd;
+    pd.configure(params.query_params().query_powers,
+                 apsi::util::create_powers_set(
+                     params.query_params().ps_low_degree,
+                     params.table_params().max_items_per_bin));
+    EXPECT_TRUE(pd.is_configured());
+
+    // the tuned params are sent to the receiver and kept by the SenderDB.
+    auto parsed = ParsePsiParamsProto(PsiParamsToBuffer(params));
+    EXPECT_EQ(parsed.to_string(), params.to_string());
+
+    auto estimated = EstimatePsiParamsCost(params, ns, options);
+    EXPECT_EQ(estimated.query_bytes, cost.query_bytes);
+    EXPECT_EQ(estimated.response_bytes, cost.response_bytes);
+    costs.push_back(cost);
+  }
+
+  // every target is the least of its own metric.
+  for (const auto &cost : costs) {
+    EXPECT_LE(costs[0].receiver_latency_ns, cost.receiver_latency_ns);
+    EXPECT_LE(costs[1].sender_cpu_ns, cost.sender_cpu_ns);
+    EXPECT_LE(costs[2].query_bytes + costs[2].response_bytes,
+              cost.query_bytes + cost.response_bytes);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Works_Instances, TunePsiParamsTest,
+    testing::Values(std::make_tuple(1, 10000, 0),
+                    std::make_tuple(1, 1000000, 16),
+                    std::make_tuple(100, 100000, 0),
+                    std::make_tuple(4096, 1000000, 32),
+                    std::make_tuple(10000, 10000000, 0)));
+
+TEST(TunePsiParamsTest, LabelCost) {
+  auto params = GetPsiParams(100, 100000);
+
+  PsiParamsTuneOptions options;
+  auto unlabeled = EstimatePsiParamsCost(params, 100000, options);
+  options.label_byte_count = 64;
+  auto labeled = EstimatePsiParamsCost(params, 100000, options);
+
+  EXPECT_EQ(labeled.query_bytes, unlabeled.query_bytes);
+  EXPECT_GT(labeled.response_bytes, unlabeled.response_bytes);
+  EXPECT_GT(labeled.sender_cpu_ns, unlabeled.sender_cpu_ns);
+}
+
+TEST(TunePsiParamsTest, Calibrate) {
+  auto model = CalibrateLabelPsiCostModel(4, 1e9);
+
+  EXPECT_EQ(model.sender_threads, size_t{4});
+  EXPECT_EQ(model.bandwidth_bytes_per_sec, 1e9);
+  EXPECT_GT(model.ct_ct_mult_ns, 0);
+  EXPECT_GT(model.ct_pt_mult_ns, 0);
+  EXPECT_GT(model.encrypt_ns, 0);
+  EXPECT_GT(model.decrypt_ns, 0);
+}
+
+}  // namespace spu::psi
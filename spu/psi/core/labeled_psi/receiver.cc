@@ -15,11 +15,15 @@
 #include "spu/psi/core/labeled_psi/receiver.h"
 
 #include <algorithm>
+#include <cstring>
+#include <deque>
 #include <future>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -128,46 +132,77 @@ std::pair<std::vector<apsi::HashedItem>, std::vector<apsi::LabelKey>>
 LabelPsiReceiver::RequestOPRF(
     const std::vector<std::string> &items,
     const std::shared_ptr<yacl::link::Context> &link_ctx) {
-  std::vector<std::string> blind_items(items.size());
   std::vector<std::shared_ptr<IEcdhOprfClient>> oprf_clients(items.size());
+  const size_t batch_count =
+      (items.size() + kOprfBatchSize - 1) / kOprfBatchSize;
+
+  // blind and send the batches, while the evaluated ones are received and
+  // finalized below. The last batch is empty to end the stream.
+  auto f_blind = std::async(std::launch::async, [&]() {
+    for (size_t batch_idx = 0; batch_idx <= batch_count; ++batch_idx) {
+      const size_t batch_begin =
+          std::min(batch_idx * kOprfBatchSize, items.size());
+      const size_t batch_end =
+          std::min(batch_begin + kOprfBatchSize, items.size());
+
+      std::vector<std::string> blind_items(batch_end - batch_begin);
+      yacl::parallel_for(
+          batch_begin, batch_end, 1, [&](int64_t begin, int64_t end) {
+            for (int64_t idx = begin; idx < end; ++idx) {
+              oprf_clients[idx] =
+                  CreateEcdhOprfClient(OprfType::Basic, CurveType::CURVE_FOURQ);
+              oprf_clients[idx]->SetCompareLength(kEccKeySize);
+
+              blind_items[idx - batch_begin] =
+                  oprf_clients[idx]->Blind(items[idx]);
+            }
+          });
+
+      proto::OprfProto oprf_proto;
+      for (const auto &blind_item : blind_items) {
+        oprf_proto.add_data(blind_item.data(), blind_item.length());
+      }
 
-  yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
-    for (int idx = begin; idx < end; ++idx) {
-      oprf_clients[idx] =
-          CreateEcdhOprfClient(OprfType::Basic, CurveType::CURVE_FOURQ);
-      oprf_clients[idx]->SetCompareLength(kEccKeySize);
+      yacl::Buffer blind_buffer(oprf_proto.ByteSizeLong());
+      oprf_proto.SerializePartialToArray(blind_buffer.data(),
+                                         blind_buffer.size());
 
-      blind_items[idx] = oprf_clients[idx]->Blind(items[idx]);
+      link_ctx->SendAsync(
+          link_ctx->NextRank(), blind_buffer,
+          fmt::format("send oprf blind items batch:{} buffer size:{}",
+                      batch_idx, blind_buffer.size()));
     }
   });
 
-  proto::OprfProto oprf_proto;
-  for (size_t idx = 0; idx < blind_items.size(); ++idx) {
-    oprf_proto.add_data(blind_items[idx].data(), blind_items[idx].length());
+  std::vector<std::string> items_oprf(items.size());
+  size_t received = 0;
+  for (size_t batch_idx = 0;; ++batch_idx) {
+    yacl::Buffer evaluated_buffer = link_ctx->Recv(
+        link_ctx->NextRank(),
+        fmt::format("recv oprf evaluated items batch:{}", batch_idx));
+
+    proto::OprfProto evaluated_proto;
+    YACL_ENFORCE(evaluated_proto.ParseFromArray(evaluated_buffer.data(),
+                                                evaluated_buffer.size()));
+    if (evaluated_proto.data_size() == 0) {
+      break;
+    }
+    YACL_ENFORCE(received + evaluated_proto.data_size() <= items.size(),
+                 "too many oprf evaluated items, batch:{}", batch_idx);
+
+    yacl::parallel_for(0, evaluated_proto.data_size(), 1,
+                       [&](int64_t begin, int64_t end) {
+                         for (int64_t idx = begin; idx < end; ++idx) {
+                           items_oprf[received + idx] =
+                               oprf_clients[received + idx]->Finalize(
+                                   items[received + idx],
+                                   evaluated_proto.data(idx));
+                         }
+                       });
+    received += evaluated_proto.data_size();
   }
-
-  yacl::Buffer blind_buffer(oprf_proto.ByteSizeLong());
-  oprf_proto.SerializePartialToArray(blind_buffer.data(), blind_buffer.size());
-
-  link_ctx->SendAsync(
-      link_ctx->NextRank(), blind_buffer,
-      fmt::format("send oprf blind items buffer size:{}", blind_buffer.size()));
-
-  yacl::Buffer evaluated_buffer = link_ctx->Recv(
-      link_ctx->NextRank(), fmt::format("recv oprf evaluated message"));
-
-  proto::OprfProto evaluated_proto;
-  YACL_ENFORCE(evaluated_proto.ParseFromArray(evaluated_buffer.data(),
-                                              evaluated_buffer.size()));
-
-  std::vector<std::string> items_oprf(evaluated_proto.data_size());
-  yacl::parallel_for(0, evaluated_proto.data_size(), 1,
-                     [&](int64_t begin, int64_t end) {
-                       for (int idx = begin; idx < end; ++idx) {
-                         items_oprf[idx] = oprf_clients[idx]->Finalize(
-                             items[idx], evaluated_proto.data(idx));
-                       }
-                     });
+  f_blind.get();
+  YACL_ENFORCE_EQ(received, items.size(), "oprf evaluated items mismatch");
 
   std::vector<apsi::HashedItem> hashed_items(items_oprf.size());
   std::vector<apsi::LabelKey> label_keys(items_oprf.size());
@@ -329,44 +364,64 @@ LabelPsiReceiver::RequestQuery(
       link_ctx->NextRank(), query_buffer,
       fmt::format("send query buffer size:{}", query_buffer.size()));
 
-  yacl::Buffer response_buffer = link_ctx->Recv(
-      link_ctx->NextRank(), fmt::format("recv server query response message"));
-
-  proto::QueryResponseProto response_proto;
-  YACL_ENFORCE(response_proto.ParseFromArray(response_buffer.data(),
-                                             response_buffer.size()));
+  yacl::Buffer count_buffer = link_ctx->Recv(
+      link_ctx->NextRank(), fmt::format("recv query result count"));
+  size_t result_count;
+  YACL_ENFORCE(sizeof(result_count) == count_buffer.size());
+  std::memcpy(&result_count, count_buffer.data(), count_buffer.size());
 
+  // The sender streams the results as they are computed. Each one is
+  // decrypted and decoded on its own thread while the next ones are received,
+  // with at most max_pending results in flight.
   std::vector<std::pair<size_t, std::string>> query_result_vec;
-
-  std::vector<std::vector<std::pair<size_t, std::string>>> results(
-      response_proto.results_size());
-
-  yacl::parallel_for(0, response_proto.results_size(), 1,
-                     [&](int64_t begin, int64_t end) {
-                       for (int idx = begin; idx < end; ++idx) {
-                         const proto::QueryResultProto &query_result_proto =
-                             response_proto.results(idx);
-                         results[idx] = LabelPsiReceiver::ProcessQueryResult(
-                             query_result_proto, itt, label_keys);
-                       }
-                     });
-
-  for (int idx = 0; idx < response_proto.results_size(); ++idx) {
-    query_result_vec.insert(query_result_vec.end(), results[idx].begin(),
-                            results[idx].end());
+  std::deque<std::future<std::vector<std::pair<size_t, std::string>>>>
+      pending;
+  const size_t max_pending =
+      std::max<size_t>(1, std::thread::hardware_concurrency());
+  auto collect_front = [&]() {
+    auto result = pending.front().get();
+    pending.pop_front();
+    query_result_vec.insert(query_result_vec.end(),
+                            std::make_move_iterator(result.begin()),
+                            std::make_move_iterator(result.end()));
+  };
+
+  for (size_t idx = 0; idx < result_count; ++idx) {
+    yacl::Buffer result_buffer = link_ctx->Recv(
+        link_ctx->NextRank(), fmt::format("recv query result:{}", idx));
+    auto query_result_proto = std::make_shared<proto::QueryResultProto>();
+    YACL_ENFORCE(query_result_proto->ParseFromArray(result_buffer.data(),
+                                                    result_buffer.size()));
+
+    if (pending.size() >= max_pending) {
+      collect_front();
+    }
+    pending.push_back(
+        std::async(std::launch::async, [&, query_result_proto]() {
+          return ProcessQueryResult(*query_result_proto, itt, label_keys);
+        }));
+  }
+  while (!pending.empty()) {
+    collect_front();
   }
 
   std::sort(query_result_vec.begin(), query_result_vec.end(),
-            [](std::pair<size_t, std::string> a,
-               std::pair<size_t, std::string> b) { return a.first < b.first; });
+            [](const std::pair<size_t, std::string> &a,
+               const std::pair<size_t, std::string> &b) {
+              return a.first < b.first;
+            });
 
   std::vector<size_t> query_result;
   std::vector<std::string> query_labels;
+  query_result.reserve(query_result_vec.size());
+  if (has_label_) {
+    query_labels.reserve(query_result_vec.size());
+  }
 
-  for (const auto &[index, value] : query_result_vec) {
+  for (auto &[index, value] : query_result_vec) {
     query_result.emplace_back(index);
     if (has_label_) {
-      query_labels.emplace_back(value);
+      query_labels.emplace_back(std::move(value));
     }
   }
 
@@ -522,6 +577,7 @@ LabelPsiReceiver::ProcessQueryResult(
 
           // Collect the entire label into this vector
           apsi::util::AlgLabel alg_label;
+          alg_label.reserve(plain_rp.label_result.size() * felts_per_item);
 
           size_t label_offset =
               seal::util::mul_safe(std::get<1>(I), felts_per_item);
@@ -545,14 +601,16 @@ LabelPsiReceiver::ProcessQueryResult(
               encrypted_label, label_keys[item_idx], nonce_byte_count);
         }
 
-        std::string label_str(label.size(), '\0');
-        std::memcpy(&label_str[0], label.data(), label.size());
-        match_ids.push_back(std::make_pair(item_idx, label_str));
+        match_ids.emplace_back(
+            item_idx, std::string(reinterpret_cast<const char *>(label.data()),
+                                  label.size()));
       });
 
   std::sort(match_ids.begin(), match_ids.end(),
-            [](std::pair<size_t, std::string> a,
-               std::pair<size_t, std::string> b) { return a.first < b.first; });
+            [](const std::pair<size_t, std::string> &a,
+               const std::pair<size_t, std::string> &b) {
+              return a.first < b.first;
+            });
 
   return match_ids;
 }
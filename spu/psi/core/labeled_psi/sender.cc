@@ -15,9 +15,13 @@
 #include "spu/psi/core/labeled_psi/sender.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <deque>
+#include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -27,6 +31,7 @@
 #include "apsi/powers.h"
 #include "apsi/util/label_encryptor.h"
 #include "gsl/span"
+#include "spdlog/spdlog.h"
 #include "yacl/utils/parallel.h"
 
 #include "spu/psi/core/labeled_psi/package.h"
@@ -148,39 +153,107 @@ void LabelPsiSender::RunOPRF(
     const std::shared_ptr<yacl::link::Context> &link_ctx) {
   oprf_server->SetCompareLength(kEccKeySize);
 
-  yacl::Buffer blind_buffer = link_ctx->Recv(
-      link_ctx->NextRank(), fmt::format("recv oprf blind message"));
-
-  proto::OprfProto blind_proto;
-  YACL_ENFORCE(
-      blind_proto.ParseFromArray(blind_buffer.data(), blind_buffer.size()));
-
-  proto::OprfProto evaluated_proto;
-  std::vector<std::string> evaluated_vec(blind_proto.data_size());
-  yacl::parallel_for(
-      0, blind_proto.data_size(), 1, [&](int64_t begin, int64_t end) {
-        for (int idx = begin; idx < end; ++idx) {
-          evaluated_vec[idx] = oprf_server->Evaluate(blind_proto.data(idx));
-        }
-      });
+  // batches being evaluated, sent back in the receiving order.
+  std::deque<std::future<proto::OprfProto>> inflight;
+  size_t sent_count = 0;
+  auto send_evaluated = [&](const proto::OprfProto &evaluated_proto) {
+    yacl::Buffer evaluated_buffer(evaluated_proto.ByteSizeLong());
+    evaluated_proto.SerializePartialToArray(evaluated_buffer.data(),
+                                            evaluated_buffer.size());
+
+    link_ctx->SendAsync(
+        link_ctx->NextRank(), evaluated_buffer,
+        fmt::format("send evaluated items batch:{} buffer size:{}",
+                    sent_count++, evaluated_buffer.size()));
+  };
+  auto is_ready = [](const std::future<proto::OprfProto> &f) {
+    return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  };
+
+  size_t batch_count = 0;
+  while (true) {
+    yacl::Buffer blind_buffer = link_ctx->Recv(
+        link_ctx->NextRank(),
+        fmt::format("recv oprf blind items batch:{}", batch_count));
+
+    proto::OprfProto blind_proto;
+    YACL_ENFORCE(
+        blind_proto.ParseFromArray(blind_buffer.data(), blind_buffer.size()));
+
+    if (blind_proto.data_size() == 0) {
+      while (!inflight.empty()) {
+        send_evaluated(inflight.front().get());
+        inflight.pop_front();
+      }
+      send_evaluated({});
+      SPDLOG_INFO("RunOPRF finished, batch_count={}", batch_count);
+      break;
+    }
 
-  for (int idx = 0; idx < blind_proto.data_size(); ++idx) {
-    evaluated_proto.add_data(evaluated_vec[idx].data(),
-                             evaluated_vec[idx].length());
+    inflight.push_back(std::async(
+        std::launch::async,
+        [&oprf_server, blind_proto = std::move(blind_proto)]() {
+          std::vector<std::string> evaluated_vec(blind_proto.data_size());
+          yacl::parallel_for(
+              0, blind_proto.data_size(), 1, [&](int64_t begin, int64_t end) {
+                for (int idx = begin; idx < end; ++idx) {
+                  evaluated_vec[idx] =
+                      oprf_server->Evaluate(blind_proto.data(idx));
+                }
+              });
+
+          proto::OprfProto evaluated_proto;
+          for (const auto &evaluated : evaluated_vec) {
+            evaluated_proto.add_data(evaluated.data(), evaluated.length());
+          }
+          return evaluated_proto;
+        }));
+    ++batch_count;
+
+    while (!inflight.empty() && (inflight.size() >= kOprfPipelineDepth ||
+                                 is_ready(inflight.front()))) {
+      send_evaluated(inflight.front().get());
+      inflight.pop_front();
+    }
   }
+}
+
+// Invoked with the number of results once before any result, and then with
+// every result on the thread which computed it.
+using ResultCountCallback = std::function<void(size_t)>;
+using ResultCallback = std::function<void(const ResultPackage &)>;
+
+void SenderRunQuery(const QueryRequest &query,
+                    const std::shared_ptr<spu::psi::SenderDB> &sender_db,
+                    const ResultCountCallback &on_result_count,
+                    const ResultCallback &on_result);
 
-  yacl::Buffer evaluated_buffer(evaluated_proto.ByteSizeLong());
-  evaluated_proto.SerializePartialToArray(evaluated_buffer.data(),
-                                          evaluated_buffer.size());
+namespace {
+
+yacl::Buffer SerializeQueryResult(const ResultPackage &result,
+                                  seal::compr_mode_type compr_mode) {
+  proto::QueryResultProto result_proto;
+  result_proto.set_bundle_idx(result.bundle_idx);
+  std::vector<uint8_t> temp;
+  temp.resize(result.psi_result.save_size(compr_mode));
+  auto size = result.psi_result.save(temp, compr_mode);
+  result_proto.set_ciphertext(temp.data(), size);
+  result_proto.set_label_byte_count(result.label_byte_count);
+  result_proto.set_nonce_byte_count(result.nonce_byte_count);
+
+  for (const auto &r : result.label_result) {
+    temp.resize(r.save_size(compr_mode));
+    size = r.save(temp, compr_mode);
+    result_proto.add_label_results(temp.data(), size);
+  }
 
-  link_ctx->SendAsync(link_ctx->NextRank(), evaluated_buffer,
-                      fmt::format("send evaluated items buffer size:{}",
-                                  evaluated_buffer.size()));
+  yacl::Buffer result_buffer(result_proto.ByteSizeLong());
+  result_proto.SerializePartialToArray(result_buffer.data(),
+                                       result_buffer.size());
+  return result_buffer;
 }
 
-std::vector<std::shared_ptr<ResultPackage>> SenderRunQuery(
-    const QueryRequest &query,
-    const std::shared_ptr<spu::psi::SenderDB> &sender_db);
+}  // namespace
 
 void LabelPsiSender::RunQuery(
     const std::shared_ptr<yacl::link::Context> &link_ctx) {
@@ -227,44 +300,31 @@ void LabelPsiSender::RunQuery(
 
   QueryRequest request(&relin_keys, encrypted_powers, sender_db_);
 
-  std::vector<std::shared_ptr<ResultPackage>> query_result =
-      SenderRunQuery(request, sender_db_);
-
-  proto::QueryResponseProto response_proto;
-  for (size_t idx = 0; idx < query_result.size(); ++idx) {
-    proto::QueryResultProto *result_proto = response_proto.add_results();
-    result_proto->set_bundle_idx(query_result[idx]->bundle_idx);
-    std::vector<uint8_t> temp;
-    temp.resize(query_result[idx]->psi_result.save_size(compr_mode_));
-    auto size = query_result[idx]->psi_result.save(temp, compr_mode_);
-    result_proto->set_ciphertext(temp.data(), temp.size());
-    result_proto->set_label_byte_count(query_result[idx]->label_byte_count);
-    result_proto->set_nonce_byte_count(query_result[idx]->nonce_byte_count);
-
-    for (auto &r : query_result[idx]->label_result) {
-      temp.resize(r.save_size(compr_mode_));
-      size = r.save(temp, compr_mode_);
-      result_proto->add_label_results(temp.data(), size);
-    }
-  }
-
-  yacl::Buffer response_buffer(response_proto.ByteSizeLong());
-  response_proto.SerializePartialToArray(response_buffer.data(),
-                                         response_buffer.size());
-
-  SPDLOG_DEBUG("response_buffer size:{}, query_result size:{}",
-               response_buffer.size(), query_result.size());
-
-  link_ctx->SendAsync(
-      link_ctx->NextRank(), response_buffer,
-      fmt::format("send query response size:{}", response_buffer.size()));
+  // Every result is sent as soon as it is computed, so that the receiver
+  // decrypts the earlier results while the later ones are still evaluated.
+  std::mutex send_mutex;
+  SenderRunQuery(
+      request, sender_db_,
+      [&](size_t result_count) {
+        yacl::Buffer count_buffer(&result_count, sizeof(result_count));
+        link_ctx->SendAsync(
+            link_ctx->NextRank(), count_buffer,
+            fmt::format("send query result count:{}", result_count));
+      },
+      [&](const ResultPackage &result) {
+        yacl::Buffer result_buffer = SerializeQueryResult(result, compr_mode_);
+        std::lock_guard<std::mutex> lock(send_mutex);
+        link_ctx->SendAsync(link_ctx->NextRank(), result_buffer,
+                            fmt::format("send query result of bundle:{}",
+                                        result.bundle_idx));
+      });
 }
 
 void ComputePowers(const std::shared_ptr<spu::psi::SenderDB> &sender_db,
                    const apsi::CryptoContext &crypto_context,
                    std::vector<CiphertextPowers> *all_powers,
                    const apsi::PowersDag &pd, uint32_t bundle_idx,
-                   seal::MemoryPoolHandle *pool);
+                   bool parallel, seal::MemoryPoolHandle *pool);
 
 void ProcessBinBundleCache(
     const std::shared_ptr<spu::psi::SenderDB> &sender_db,
@@ -274,9 +334,10 @@ void ProcessBinBundleCache(
     seal::compr_mode_type compr_mode, seal::MemoryPoolHandle *pool,
     std::shared_ptr<ResultPackage> result);
 
-std::vector<std::shared_ptr<ResultPackage>> SenderRunQuery(
-    const QueryRequest &query,
-    const std::shared_ptr<spu::psi::SenderDB> &sender_db) {
+void SenderRunQuery(const QueryRequest &query,
+                    const std::shared_ptr<spu::psi::SenderDB> &sender_db,
+                    const ResultCountCallback &on_result_count,
+                    const ResultCallback &on_result) {
   // We use a custom SEAL memory that is freed after the query is done
   auto pool = seal::MemoryManager::GetPool(seal::mm_force_new);
 
@@ -342,31 +403,55 @@ std::vector<std::shared_ptr<ResultPackage>> SenderRunQuery(
     }
   }
 
-  // Compute query powers for the bundle indexes
-  for (size_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
-    ComputePowers(sender_db, crypto_context, &all_powers, pd,
-                  static_cast<uint32_t>(bundle_idx), &pool);
+  // Compute query powers for the bundle indexes. With enough bundle indices
+  // to keep the thread pool busy, each bundle index is a single task which
+  // computes its powers serially; otherwise the bundle indices are processed
+  // one after another, each spreading its own powers over the threads. The
+  // tasks never wait on the pool themselves, so they cannot starve it.
+  if (bundle_idx_count >= apsi::ThreadPoolMgr::GetThreadCount()) {
+    std::vector<std::future<void>> power_futures;
+    power_futures.reserve(bundle_idx_count);
+    for (size_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
+      power_futures.push_back(tpm.thread_pool().enqueue([&, bundle_idx]() {
+        ComputePowers(sender_db, crypto_context, &all_powers, pd,
+                      static_cast<uint32_t>(bundle_idx), false, &pool);
+      }));
+    }
+    for (auto &f : power_futures) {
+      f.get();
+    }
+  } else {
+    for (size_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
+      ComputePowers(sender_db, crypto_context, &all_powers, pd,
+                    static_cast<uint32_t>(bundle_idx), true, &pool);
+    }
   }
 
   SPDLOG_DEBUG("Finished computing powers for all bundle indices");
   SPDLOG_DEBUG("Start processing bin bundle caches");
 
-  std::vector<std::shared_ptr<ResultPackage>> query_results;
-  std::vector<std::future<void>> futures;
+  std::vector<std::vector<
+      std::reference_wrapper<const apsi::sender::BinBundleCache>>>
+      all_caches(bundle_idx_count);
+  size_t result_count = 0;
   for (size_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
-    auto bundle_caches =
+    all_caches[bundle_idx] =
         sender_db->GetCacheAt(static_cast<uint32_t>(bundle_idx));
+    result_count += all_caches[bundle_idx].size();
+  }
+  on_result_count(result_count);
 
-    for (auto &cache : bundle_caches) {
-      query_results.push_back(std::make_shared<ResultPackage>());
-      std::shared_ptr<ResultPackage> result = *(query_results.rbegin());
-
-      futures.push_back(
-          tpm.thread_pool().enqueue([&, bundle_idx, cache, result]() {
-            ProcessBinBundleCache(sender_db, crypto_context, cache, &all_powers,
-                                  static_cast<uint32_t>(bundle_idx),
-                                  query.compr_mode(), &pool, result);
-          }));
+  std::vector<std::future<void>> futures;
+  futures.reserve(result_count);
+  for (size_t bundle_idx = 0; bundle_idx < bundle_idx_count; bundle_idx++) {
+    for (auto &cache : all_caches[bundle_idx]) {
+      futures.push_back(tpm.thread_pool().enqueue([&, bundle_idx, cache]() {
+        auto result = std::make_shared<ResultPackage>();
+        ProcessBinBundleCache(sender_db, crypto_context, cache, &all_powers,
+                              static_cast<uint32_t>(bundle_idx),
+                              query.compr_mode(), &pool, result);
+        on_result(*result);
+      }));
     }
   }
 
@@ -375,16 +460,14 @@ std::vector<std::shared_ptr<ResultPackage>> SenderRunQuery(
     f.get();
   }
 
-  SPDLOG_INFO("Finished processing query request");
-
-  return query_results;
+  SPDLOG_INFO("Finished processing query request, {} results", result_count);
 }
 
 void ComputePowers(const std::shared_ptr<spu::psi::SenderDB> &sender_db,
                    const apsi::CryptoContext &crypto_context,
                    std::vector<CiphertextPowers> *all_powers,
                    const apsi::PowersDag &pd, uint32_t bundle_idx,
-                   seal::MemoryPoolHandle *pool) {
+                   bool parallel, seal::MemoryPoolHandle *pool) {
   SPDLOG_DEBUG("Sender::ComputePowers");
   auto bundle_caches = sender_db->GetCacheAt(bundle_idx);
   if (!bundle_caches.size()) {
@@ -400,7 +483,7 @@ void ComputePowers(const std::shared_ptr<spu::psi::SenderDB> &sender_db,
 
   CiphertextPowers &powers_at_this_bundle_idx = (*all_powers)[bundle_idx];
   bool relinearize = crypto_context.seal_context()->using_keyswitching();
-  pd.parallel_apply([&](const apsi::PowersDag::PowersNode &node) {
+  auto compute_node = [&](const apsi::PowersDag::PowersNode &node) {
     if (!node.is_source()) {
       auto parents = node.parents;
       seal::Ciphertext prod(*pool);
@@ -417,7 +500,12 @@ void ComputePowers(const std::shared_ptr<spu::psi::SenderDB> &sender_db,
       }
       powers_at_this_bundle_idx[node.power] = std::move(prod);
     }
-  });
+  };
+  if (parallel) {
+    pd.parallel_apply(compute_node);
+  } else {
+    pd.apply(compute_node);
+  }
 
   // Now that all powers of the ciphertext have been computed, we need to
   // transform them to NTT form. This will substantially improve the polynomial
@@ -442,31 +530,41 @@ void ComputePowers(const std::shared_ptr<spu::psi::SenderDB> &sender_db,
 
   uint32_t ps_low_degree = sender_db->GetParams().query_params().ps_low_degree;
 
-  std::vector<std::future<void>> futures;
-  for (uint32_t power : pd.target_powers()) {
-    futures.push_back(tpm.thread_pool().enqueue([&, power]() {
-      if (!ps_low_degree) {
-        // Only one ciphertext-plaintext multiplication is needed after this
+  auto transform_power = [&](uint32_t power) {
+    if (!ps_low_degree) {
+      // Only one ciphertext-plaintext multiplication is needed after this
+      evaluator->mod_switch_to_inplace(powers_at_this_bundle_idx[power],
+                                       high_powers_parms_id, *pool);
+
+      // All powers must be in NTT form
+      evaluator->transform_to_ntt_inplace(powers_at_this_bundle_idx[power]);
+    } else {
+      if (power <= ps_low_degree) {
+        // Low powers must be at a higher level than high powers
         evaluator->mod_switch_to_inplace(powers_at_this_bundle_idx[power],
-                                         high_powers_parms_id, *pool);
+                                         low_powers_parms_id, *pool);
 
-        // All powers must be in NTT form
+        // Low powers must be in NTT form
         evaluator->transform_to_ntt_inplace(powers_at_this_bundle_idx[power]);
       } else {
-        if (power <= ps_low_degree) {
-          // Low powers must be at a higher level than high powers
-          evaluator->mod_switch_to_inplace(powers_at_this_bundle_idx[power],
-                                           low_powers_parms_id, *pool);
-
-          // Low powers must be in NTT form
-          evaluator->transform_to_ntt_inplace(powers_at_this_bundle_idx[power]);
-        } else {
-          // High powers are only modulus switched
-          evaluator->mod_switch_to_inplace(powers_at_this_bundle_idx[power],
-                                           high_powers_parms_id, *pool);
-        }
+        // High powers are only modulus switched
+        evaluator->mod_switch_to_inplace(powers_at_this_bundle_idx[power],
+                                         high_powers_parms_id, *pool);
       }
-    }));
+    }
+  };
+
+  if (!parallel) {
+    for (uint32_t power : pd.target_powers()) {
+      transform_power(power);
+    }
+    return;
+  }
+
+  std::vector<std::future<void>> futures;
+  for (uint32_t power : pd.target_powers()) {
+    futures.push_back(
+        tpm.thread_pool().enqueue([&, power]() { transform_power(power); }));
   }
 
   for (auto &f : futures) {
@@ -54,6 +54,10 @@ class LabelPsiSender {
   /**
    * @brief Receive query_powers Request and Send polynoimal ciphertext Response
    *
+   * Only a reader lock of the SenderDB is held, and every query evaluates with
+   * its own memory pool, so queries of different receivers could be served
+   * concurrently by calling it from several threads with their own link_ctx.
+   *
    * @param link_ctx
    */
   void RunQuery(const std::shared_ptr<yacl::link::Context>& link_ctx);
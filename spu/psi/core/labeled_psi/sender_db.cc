@@ -20,9 +20,18 @@
 // switchable between secp256k1, sm2 or other types
 
 // STD
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <future>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -38,6 +47,7 @@
 #include "spdlog/spdlog.h"
 
 #include "spu/psi/core/ecdh_oprf/ecdh_oprf_selector.h"
+#include "spu/psi/core/labeled_psi/psi_params.h"
 #include "spu/psi/core/labeled_psi/sender_db.h"
 
 // Kuku
@@ -218,10 +228,29 @@ std::vector<std::pair<apsi::util::AlgItem, size_t>> PreprocessUnlabeledData(
                                  params);
 }
 
+/**
+Groups the positions of the given data by their bundle indices, so that each
+worker only walks over the data of its own bundle index. The positions of a
+bundle index keep the input order.
+*/
+template <typename T>
+std::map<size_t, std::vector<size_t>> GroupByBundleIdx(
+    const std::vector<std::pair<T, size_t>> &data_with_indices,
+    uint32_t bins_per_bundle) {
+  std::map<size_t, std::vector<size_t>> groups;
+  for (size_t pos = 0; pos < data_with_indices.size(); pos++) {
+    size_t bin_idx, bundle_idx;
+    std::tie(bin_idx, bundle_idx) =
+        UnpackCuckooIdx(data_with_indices[pos].second, bins_per_bundle);
+    groups[bundle_idx].push_back(pos);
+  }
+  return groups;
+}
+
 /**
 Inserts the given items and corresponding labels into bin_bundles at their
-respective cuckoo indices. It will only insert the data with bundle index in the
-half-open range range indicated by work_range. If inserting into a BinBundle
+respective cuckoo indices. It will only insert the data at the given positions,
+which all belong to the bundle index indicated by bundle_index. If inserting into a BinBundle
 would make the number of items in a bin larger than max_bin_size, this function
 will create and insert a new BinBundle. If overwrite is set, this will overwrite
 the labels if it finds an AlgItemLabel that matches the input perfectly.
@@ -229,6 +258,7 @@ the labels if it finds an AlgItemLabel that matches the input perfectly.
 template <typename T>
 void InsertOrAssignWorker(
     const std::vector<std::pair<T, size_t>> &data_with_indices,
+    const std::vector<size_t> &positions,
     std::vector<std::vector<apsi::sender::BinBundle>> *bin_bundles,
     const apsi::CryptoContext &crypto_context, uint32_t bundle_index,
     uint32_t bins_per_bundle, size_t label_size, size_t max_bin_size,
@@ -239,7 +269,8 @@ void InsertOrAssignWorker(
       bundle_index, overwrite ? "overwriting existing" : "inserting new");
 
   // Iteratively insert each item-label pair at the given cuckoo index
-  for (auto &data_with_idx : data_with_indices) {
+  for (size_t pos : positions) {
+    const auto &data_with_idx = data_with_indices[pos];
     const T &data = data_with_idx.first;
 
     // Get the bundle index
@@ -248,13 +279,6 @@ void InsertOrAssignWorker(
     std::tie(bin_idx, bundle_idx) =
         UnpackCuckooIdx(cuckoo_idx, bins_per_bundle);
 
-    // If the bundle_idx isn't in the prescribed range, don't try to insert this
-    // data
-    if (bundle_idx != bundle_index) {
-      // Dealing with this bundle index is not our job
-      continue;
-    }
-
     // Get the bundle set at the given bundle index
     std::vector<apsi::sender::BinBundle> &bundle_set =
         (*bin_bundles)[bundle_idx];
@@ -328,10 +352,11 @@ void InsertOrAssignWorker(
 }
 
 /**
-Takes algebraized data to be inserted, splits it up, and distributes it so that
-thread_count many threads can all insert in parallel. If overwrite is set, this
-will overwrite the labels if it finds an AlgItemLabel that matches the input
-perfectly.
+Takes algebraized data to be inserted, splits it up by bundle index, and
+distributes it so that one task owns each bundle index and all of them insert in
+parallel without locking. The touched bundle indices are added to
+dirty_bundles. If overwrite is set, this will overwrite the labels if it finds
+an AlgItemLabel that matches the input perfectly.
 */
 template <typename T>
 void DispatchInsertOrAssign(
@@ -339,42 +364,27 @@ void DispatchInsertOrAssign(
     std::vector<std::vector<apsi::sender::BinBundle>> *bin_bundles,
     const apsi::CryptoContext &crypto_context, uint32_t bins_per_bundle,
     size_t label_size, uint32_t max_bin_size, uint32_t ps_low_degree,
-    bool overwrite, bool compressed) {
+    bool overwrite, bool compressed, std::set<size_t> *dirty_bundles) {
   apsi::ThreadPoolMgr tpm;
 
-  // Collect the bundle indices and partition them into thread_count many
-  // partitions. By some uniformity assumption, the number of things to insert
-  // per partition should be roughly the same. Note that the contents of
-  // bundle_indices is always sorted (increasing order).
-  std::set<size_t> bundle_indices_set;
-  for (auto &data_with_idx : data_with_indices) {
-    size_t cuckoo_idx = data_with_idx.second;
-    size_t bin_idx, bundle_idx;
-    std::tie(bin_idx, bundle_idx) =
-        UnpackCuckooIdx(cuckoo_idx, bins_per_bundle);
-    bundle_indices_set.insert(bundle_idx);
-  }
+  // Group the data by bundle index once, instead of having every task scan all
+  // of the data for its own bundle index.
+  auto groups = GroupByBundleIdx(data_with_indices, bins_per_bundle);
 
-  // Copy the set of indices into a vector and sort so each thread processes a
-  // range of indices
-  std::vector<size_t> bundle_indices;
-  bundle_indices.reserve(bundle_indices_set.size());
-  copy(bundle_indices_set.begin(), bundle_indices_set.end(),
-       back_inserter(bundle_indices));
-  std::sort(bundle_indices.begin(), bundle_indices.end());
-
-  // Run the threads on the partitions
-  std::vector<std::future<void>> futures(bundle_indices.size());
-  SPDLOG_INFO("Launching {} insert-or-assign worker tasks",
-              bundle_indices.size());
-  size_t future_idx = 0;
-  for (auto &bundle_idx : bundle_indices) {
-    futures[future_idx++] = tpm.thread_pool().enqueue([&, bundle_idx]() {
-      InsertOrAssignWorker(data_with_indices, bin_bundles, crypto_context,
-                           static_cast<uint32_t>(bundle_idx), bins_per_bundle,
-                           label_size, max_bin_size, ps_low_degree, overwrite,
-                           compressed);
-    });
+  // Run the threads on the groups
+  std::vector<std::future<void>> futures;
+  futures.reserve(groups.size());
+  SPDLOG_INFO("Launching {} insert-or-assign worker tasks", groups.size());
+  for (const auto &[bundle_idx, positions] : groups) {
+    dirty_bundles->insert(bundle_idx);
+    futures.push_back(tpm.thread_pool().enqueue(
+        [&, bundle_idx = bundle_idx, &positions = positions]() {
+          InsertOrAssignWorker(data_with_indices, positions, bin_bundles,
+                               crypto_context,
+                               static_cast<uint32_t>(bundle_idx),
+                               bins_per_bundle, label_size, max_bin_size,
+                               ps_low_degree, overwrite, compressed);
+        }));
   }
 
   // Wait for the tasks to finish
@@ -387,31 +397,28 @@ void DispatchInsertOrAssign(
 
 /**
 Removes the given items and corresponding labels from bin_bundles at their
-respective cuckoo indices.
+respective cuckoo indices. It will only remove the data at the given positions,
+which all belong to the bundle index indicated by bundle_index.
 */
 void RemoveWorker(
     const std::vector<std::pair<apsi::util::AlgItem, size_t>>
         &data_with_indices,
+    const std::vector<size_t> &positions,
     std::vector<std::vector<apsi::sender::BinBundle>> *bin_bundles,
     uint32_t bundle_index, uint32_t bins_per_bundle) {
   STOPWATCH(sender_stopwatch, "remove_worker");
-  SPDLOG_INFO("Remove worker [{}]", bundle_index);
+  SPDLOG_DEBUG("Remove worker [{}]", bundle_index);
 
   // Iteratively remove each item-label pair at the given cuckoo index
-  for (auto &data_with_idx : data_with_indices) {
+  for (size_t pos : positions) {
+    const auto &data_with_idx = data_with_indices[pos];
+
     // Get the bundle index
     size_t cuckoo_idx = data_with_idx.second;
     size_t bin_idx, bundle_idx;
     std::tie(bin_idx, bundle_idx) =
         UnpackCuckooIdx(cuckoo_idx, bins_per_bundle);
 
-    // If the bundle_idx isn't in the prescribed range, don't try to remove this
-    // data
-    if (bundle_idx != bundle_index) {
-      // Dealing with this bundle index is not our job
-      continue;
-    }
-
     // Get the bundle set at the given bundle index
     std::vector<apsi::sender::BinBundle> &bundle_set =
         (*bin_bundles)[bundle_idx];
@@ -443,51 +450,35 @@ void RemoveWorker(
     }
   }
 
-  SPDLOG_INFO("Remove worker: finished processing bundle index {}",
-              bundle_index);
+  SPDLOG_DEBUG("Remove worker: finished processing bundle index {}",
+               bundle_index);
 }
 
 /**
-Takes algebraized data to be removed, splits it up, and distributes it so that
-thread_count many threads can all remove in parallel.
+Takes algebraized data to be removed, splits it up by bundle index, and
+distributes it so that one task owns each bundle index and all of them remove in
+parallel. The touched bundle indices are added to dirty_bundles.
 */
 void DispatchRemove(
     const std::vector<std::pair<apsi::util::AlgItem, size_t>>
         &data_with_indices,
     std::vector<std::vector<apsi::sender::BinBundle>> *bin_bundles,
-    uint32_t bins_per_bundle) {
+    uint32_t bins_per_bundle, std::set<size_t> *dirty_bundles) {
   apsi::ThreadPoolMgr tpm;
 
-  // Collect the bundle indices and partition them into thread_count many
-  // partitions. By some uniformity assumption, the number of things to remove
-  // per partition should be roughly the same. Note that the contents of
-  // bundle_indices is always sorted (increasing order).
-  std::set<size_t> bundle_indices_set;
-  for (auto &data_with_idx : data_with_indices) {
-    size_t cuckoo_idx = data_with_idx.second;
-    size_t bin_idx, bundle_idx;
-    std::tie(bin_idx, bundle_idx) =
-        UnpackCuckooIdx(cuckoo_idx, bins_per_bundle);
-    bundle_indices_set.insert(bundle_idx);
-  }
+  auto groups = GroupByBundleIdx(data_with_indices, bins_per_bundle);
 
-  // Copy the set of indices into a vector and sort so each thread processes a
-  // range of indices
-  std::vector<size_t> bundle_indices;
-  bundle_indices.reserve(bundle_indices_set.size());
-  copy(bundle_indices_set.begin(), bundle_indices_set.end(),
-       back_inserter(bundle_indices));
-  sort(bundle_indices.begin(), bundle_indices.end());
-
-  // Run the threads on the partitions
-  std::vector<std::future<void>> futures(bundle_indices.size());
-  SPDLOG_INFO("Launching {} remove worker tasks", bundle_indices.size());
-  size_t future_idx = 0;
-  for (auto &bundle_idx : bundle_indices) {
-    futures[future_idx++] = tpm.thread_pool().enqueue([&]() {
-      RemoveWorker(data_with_indices, bin_bundles,
-                   static_cast<uint32_t>(bundle_idx), bins_per_bundle);
-    });
+  // Run the threads on the groups
+  std::vector<std::future<void>> futures;
+  futures.reserve(groups.size());
+  SPDLOG_INFO("Launching {} remove worker tasks", groups.size());
+  for (const auto &[bundle_idx, positions] : groups) {
+    dirty_bundles->insert(bundle_idx);
+    futures.push_back(tpm.thread_pool().enqueue(
+        [&, bundle_idx = bundle_idx, &positions = positions]() {
+          RemoveWorker(data_with_indices, positions, bin_bundles,
+                       static_cast<uint32_t>(bundle_idx), bins_per_bundle);
+        }));
   }
 
   // Wait for the tasks to finish
@@ -496,6 +487,14 @@ void DispatchRemove(
   }
 }
 
+/**
+Returns the bytes of the given item, which are the input of the OPRF.
+*/
+std::string ItemToString(const apsi::Item &item) {
+  return std::string(reinterpret_cast<const char *>(item.value().data()),
+                     item.value().size());
+}
+
 /**
 Returns a set of DB cache references corresponding to the bundles in the given
 set
@@ -510,6 +509,77 @@ CollectCaches(std::vector<apsi::sender::BinBundle> *bin_bundles) {
 
   return result;
 }
+
+/**
+The layout of a SenderDB snapshot file: this header, the serialized PSI
+parameters, the OPRF key, the hashed items, a table of SnapshotBundleEntry, and
+then the serialized BinBundles with their caches. Any change of the layout
+should bump kSnapshotVersion.
+*/
+constexpr char kSnapshotMagic[8] = {'S', 'P', 'U', 'S', 'D', 'B', '\0', '\0'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+constexpr uint32_t kSnapshotCompressed = 1;
+constexpr uint32_t kSnapshotStripped = 1 << 1;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  uint64_t label_byte_count;
+  uint64_t nonce_byte_count;
+  uint64_t item_count;
+  uint64_t params_size;
+  uint64_t oprf_key_size;
+  uint64_t hashed_item_count;
+  uint64_t bin_bundle_count;
+};
+
+struct SnapshotBundleEntry {
+  uint64_t offset;
+  uint64_t size;
+};
+
+/**
+A read-only mapping of a whole file.
+*/
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    YACL_ENFORCE(fd >= 0, "cannot open {}, errno={}", path, errno);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      YACL_THROW("cannot stat {}, errno={}", path, errno);
+    }
+    size_ = st.st_size;
+    void *addr = nullptr;
+    if (size_ > 0) {
+      addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    YACL_ENFORCE(addr != MAP_FAILED, "cannot mmap {}, size={}, errno={}", path,
+                 size_, errno);
+    data_ = static_cast<const unsigned char *>(addr);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(const_cast<unsigned char *>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const unsigned char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const unsigned char *data_ = nullptr;
+  size_t size_ = 0;
+};
 }  // namespace
 
 SenderDB::SenderDB(const apsi::PSIParams &params, size_t label_byte_count,
@@ -578,6 +648,7 @@ SenderDB::SenderDB(SenderDB &&source)
 
   hashed_items_ = move(source.hashed_items_);
   bin_bundles_ = move(source.bin_bundles_);
+  dirty_bundles_ = move(source.dirty_bundles_);
 
   std::vector<uint8_t> oprf_key = source.GetOprfKey();
   oprf_key_.resize(oprf_key.size());
@@ -612,6 +683,7 @@ SenderDB &SenderDB::operator=(SenderDB &&source) {
 
   hashed_items_ = move(source.hashed_items_);
   bin_bundles_ = move(source.bin_bundles_);
+  dirty_bundles_ = move(source.dirty_bundles_);
 
   std::vector<uint8_t> oprf_key = source.GetOprfKey();
   oprf_key_.resize(oprf_key.size());
@@ -669,6 +741,7 @@ void SenderDB::ClearInternal() {
   // Clear the BinBundles
   bin_bundles_.clear();
   bin_bundles_.resize(params_.bundle_idx_count());
+  dirty_bundles_.clear();
 
   // Reset the stripped_ flag
   stripped_ = false;
@@ -686,15 +759,29 @@ void SenderDB::clear() {
 }
 
 void SenderDB::GenerateCaches() {
+  // Assume the SenderDB is already locked for writing
   STOPWATCH(sender_stopwatch, "SenderDB::GenerateCaches");
-  SPDLOG_INFO("Start generating bin bundle caches");
+  SPDLOG_INFO("Start generating bin bundle caches of {} bundle indices",
+              dirty_bundles_.size());
 
-  for (auto &bundle_idx : bin_bundles_) {
-    for (auto &bb : bundle_idx) {
-      bb.regen_cache();
+  apsi::ThreadPoolMgr tpm;
+
+  // Only the BinBundles at the touched bundle indices need new caches, and
+  // each of them is regenerated in its own task.
+  std::vector<std::future<void>> futures;
+  for (size_t bundle_idx : dirty_bundles_) {
+    for (auto &bb : bin_bundles_[bundle_idx]) {
+      futures.push_back(
+          tpm.thread_pool().enqueue([&bb]() { bb.regen_cache(); }));
     }
   }
 
+  // Wait for the tasks to finish
+  for (auto &f : futures) {
+    f.get();
+  }
+  dirty_bundles_.clear();
+
   SPDLOG_INFO("Finished generating bin bundle caches");
 }
 
@@ -754,18 +841,94 @@ void SenderDB::InsertOrAssign(
 
   SPDLOG_INFO("Start inserting {} items in SenderDB", data.size());
 
-  // First compute the hashes for the input data
-  // auto hashed_data = OPRFSender::ComputeHashes(
-  //    data, oprf_key_, label_byte_count_, nonce_byte_count_);
-  std::vector<std::string> data_str(data.size());
+  std::vector<std::string> items(data.size());
+  std::vector<apsi::Label> labels(data.size());
   for (size_t i = 0; i < data.size(); ++i) {
-    std::string temp_str(data[i].first.value().size(), '\0');
+    items[i] = ItemToString(data[i].first);
+    labels[i] = data[i].second;
+  }
+  InsertOrAssignLabeled(items, labels, true);
 
-    std::memcpy(&temp_str[0], data[i].first.value().data(),
-                data[i].first.value().size());
-    data_str[i] = temp_str;
+  SPDLOG_INFO("Finished inserting {} items in SenderDB", data.size());
+}
+
+void SenderDB::InsertOrAssign(const std::vector<apsi::Item> &data) {
+  if (stripped_) {
+    SPDLOG_ERROR("Cannot insert data to a stripped SenderDB");
+    YACL_THROW("failed to insert data");
   }
-  std::vector<std::string> oprf_out = oprf_server_->FullEvaluate(data_str);
+  if (IsLabeled()) {
+    SPDLOG_ERROR(
+        "Attempted to insert unlabeled data but this is a labeled SenderDB");
+    YACL_THROW("failed to insert data");
+  }
+
+  STOPWATCH(sender_stopwatch, "SenderDB::insert_or_assign (unlabeled)");
+  SPDLOG_INFO("Start inserting {} items in SenderDB", data.size());
+
+  std::vector<std::string> items(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    items[i] = ItemToString(data[i]);
+  }
+  InsertOrAssignUnlabeled(items, true);
+
+  SPDLOG_INFO("Finished inserting {} items in SenderDB", data.size());
+}
+
+void SenderDB::InsertOrAssign(
+    const std::shared_ptr<IBatchProvider> &item_provider,
+    const std::shared_ptr<IBatchProvider> &label_provider,
+    size_t batch_size) {
+  if (stripped_) {
+    SPDLOG_ERROR("Cannot insert data to a stripped SenderDB");
+    YACL_THROW("failed to insert data");
+  }
+  YACL_ENFORCE(item_provider != nullptr, "item provider should not be null");
+  YACL_ENFORCE(batch_size > 0, "batch size should be positive");
+  YACL_ENFORCE(IsLabeled() == (label_provider != nullptr),
+               "a labeled SenderDB needs a label provider, and an unlabeled "
+               "SenderDB takes none");
+
+  STOPWATCH(sender_stopwatch, "SenderDB::insert_or_assign (batches)");
+  SPDLOG_INFO("Start inserting batches of {} items in SenderDB", batch_size);
+
+  size_t item_count = 0;
+  while (true) {
+    std::vector<std::string> items = item_provider->ReadNextBatch(batch_size);
+    if (label_provider != nullptr) {
+      std::vector<std::string> label_strs =
+          label_provider->ReadNextBatch(batch_size);
+      YACL_ENFORCE_EQ(items.size(), label_strs.size(),
+                      "item and label batches mismatch after {} items",
+                      item_count);
+      if (items.empty()) {
+        break;
+      }
+      std::vector<apsi::Label> labels(label_strs.size());
+      for (size_t i = 0; i < label_strs.size(); ++i) {
+        labels[i].assign(label_strs[i].begin(), label_strs[i].end());
+      }
+      InsertOrAssignLabeled(items, labels, false);
+    } else {
+      if (items.empty()) {
+        break;
+      }
+      InsertOrAssignUnlabeled(items, false);
+    }
+    item_count += items.size();
+  }
+
+  // The caches of all the batches are generated once in the end.
+  auto lock = GetWriterLock();
+  GenerateCaches();
+
+  SPDLOG_INFO("Finished inserting {} items in SenderDB", item_count);
+}
+
+void SenderDB::InsertOrAssignLabeled(const std::vector<std::string> &items,
+                                     const std::vector<apsi::Label> &labels,
+                                     bool generate_caches) {
+  std::vector<std::string> oprf_out = oprf_server_->FullEvaluate(items);
   std::vector<std::pair<apsi::HashedItem, apsi::EncryptedLabel>> hashed_data;
   for (size_t i = 0; i < oprf_out.size(); ++i) {
     apsi::HashedItem hashed_item;
@@ -777,7 +940,7 @@ void SenderDB::InsertOrAssign(
                 key.size());
 
     apsi::EncryptedLabel encrypted_label = encrypt_label(
-        data[i].second, key, label_byte_count_, nonce_byte_count_);
+        labels[i], key, label_byte_count_, nonce_byte_count_);
 
     hashed_data.push_back(std::make_pair(hashed_item, encrypted_label));
   }
@@ -828,7 +991,7 @@ void SenderDB::InsertOrAssign(
     DispatchInsertOrAssign(data_with_indices, &bin_bundles_, crypto_context_,
                            bins_per_bundle, label_size, max_bin_size,
                            ps_low_degree, true, /* overwrite items */
-                           compressed_);
+                           compressed_, &dirty_bundles_);
 
     // Release memory that is no longer needed
     hashed_data.erase(new_data_end, hashed_data.end());
@@ -845,38 +1008,17 @@ void SenderDB::InsertOrAssign(
     DispatchInsertOrAssign(data_with_indices, &bin_bundles_, crypto_context_,
                            bins_per_bundle, label_size, max_bin_size,
                            ps_low_degree, false, /* don't overwrite items */
-                           compressed_);
+                           compressed_, &dirty_bundles_);
   }
 
-  // Generate the BinBundle caches
-  GenerateCaches();
-
-  SPDLOG_INFO("Finished inserting {} items in SenderDB", data.size());
-}
-
-void SenderDB::InsertOrAssign(const std::vector<apsi::Item> &data) {
-  if (stripped_) {
-    SPDLOG_ERROR("Cannot insert data to a stripped SenderDB");
-    YACL_THROW("failed to insert data");
-  }
-  if (IsLabeled()) {
-    SPDLOG_ERROR(
-        "Attempted to insert unlabeled data but this is a labeled SenderDB");
-    YACL_THROW("failed to insert data");
+  if (generate_caches) {
+    GenerateCaches();
   }
+}
 
-  STOPWATCH(sender_stopwatch, "SenderDB::insert_or_assign (unlabeled)");
-  SPDLOG_INFO("Start inserting {} items in SenderDB", data.size());
-
-  // First compute the hashes for the input data
-  // auto hashed_data = OPRFSender::ComputeHashes(data, oprf_key_);
-  std::vector<std::string> data_str(data.size());
-  for (size_t i = 0; i < data.size(); ++i) {
-    std::string item_str(data[i].value().size(), '\0');
-    std::memcpy(&item_str[0], data[i].value().data(), data[i].value().size());
-    data_str[i] = item_str;
-  }
-  std::vector<std::string> oprf_out = oprf_server_->FullEvaluate(data_str);
+void SenderDB::InsertOrAssignUnlabeled(const std::vector<std::string> &items,
+                                       bool generate_caches) {
+  std::vector<std::string> oprf_out = oprf_server_->FullEvaluate(items);
   std::vector<apsi::HashedItem> hashed_data;
   for (size_t i = 0; i < oprf_out.size(); ++i) {
     apsi::Item::value_type value{};
@@ -922,12 +1064,11 @@ void SenderDB::InsertOrAssign(const std::vector<apsi::Item> &data) {
                          bins_per_bundle, 0, /* label size */
                          max_bin_size, ps_low_degree,
                          false, /* don't overwrite items */
-                         compressed_);
+                         compressed_, &dirty_bundles_);
 
-  // Generate the BinBundle caches
-  GenerateCaches();
-
-  SPDLOG_INFO("Finished inserting {} items in SenderDB", data.size());
+  if (generate_caches) {
+    GenerateCaches();
+  }
 }
 
 void SenderDB::remove(const std::vector<apsi::Item> &data) {
@@ -943,9 +1084,7 @@ void SenderDB::remove(const std::vector<apsi::Item> &data) {
   // auto hashed_data = OPRFSender::ComputeHashes(data, oprf_key_);
   std::vector<std::string> data_str(data.size());
   for (size_t i = 0; i < data.size(); ++i) {
-    data_str[i].reserve(data[i].value().size());
-    std::memcpy(&data_str[i][0], data[i].value().data(),
-                data[i].value().size());
+    data_str[i] = ItemToString(data[i]);
   }
   std::vector<std::string> oprf_out = oprf_server_->FullEvaluate(data_str);
   std::vector<apsi::HashedItem> hashed_data;
@@ -988,7 +1127,8 @@ void SenderDB::remove(const std::vector<apsi::Item> &data) {
 
   // Dispatch the removal
   uint32_t bins_per_bundle = params_.bins_per_bundle();
-  DispatchRemove(data_with_indices, &bin_bundles_, bins_per_bundle);
+  DispatchRemove(data_with_indices, &bin_bundles_, bins_per_bundle,
+                 &dirty_bundles_);
 
   // Generate the BinBundle caches
   GenerateCaches();
@@ -996,6 +1136,167 @@ void SenderDB::remove(const std::vector<apsi::Item> &data) {
   SPDLOG_INFO("Finished removing {} items from SenderDB", data.size());
 }
 
+void SenderDB::SaveSnapshot(const std::string &path) const {
+  STOPWATCH(sender_stopwatch, "SenderDB::SaveSnapshot");
+
+  // Lock the database for reading
+  auto lock = GetReaderLock();
+
+  yacl::Buffer params_buf = PsiParamsToBuffer(params_);
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.version = kSnapshotVersion;
+  header.flags = (compressed_ ? kSnapshotCompressed : 0) |
+                 (stripped_ ? kSnapshotStripped : 0);
+  header.label_byte_count = label_byte_count_;
+  header.nonce_byte_count = nonce_byte_count_;
+  header.item_count = item_count_;
+  header.params_size = params_buf.size();
+  header.oprf_key_size = stripped_ ? 0 : oprf_key_.size();
+  header.hashed_item_count = hashed_items_.size();
+  for (const auto &bundle_set : bin_bundles_) {
+    header.bin_bundle_count += bundle_set.size();
+  }
+
+  // Write to a temp file first, so that a crash never leaves a partial
+  // snapshot at path.
+  std::string tmp_path = path + ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  YACL_ENFORCE(out.is_open(), "cannot open {}", tmp_path);
+
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(params_buf.data<char>(), params_buf.size());
+  out.write(reinterpret_cast<const char *>(oprf_key_.data()),
+            header.oprf_key_size);
+  for (const auto &item : hashed_items_) {
+    out.write(reinterpret_cast<const char *>(item.value().data()),
+              item.value().size());
+  }
+
+  // Reserve the table and fill it after the BinBundles are written.
+  std::streampos table_pos = out.tellp();
+  std::vector<SnapshotBundleEntry> table(header.bin_bundle_count);
+  out.write(reinterpret_cast<const char *>(table.data()),
+            table.size() * sizeof(SnapshotBundleEntry));
+
+  size_t entry_idx = 0;
+  for (size_t bundle_idx = 0; bundle_idx < bin_bundles_.size(); bundle_idx++) {
+    for (const auto &bb : bin_bundles_[bundle_idx]) {
+      auto &entry = table[entry_idx++];
+      entry.offset = static_cast<uint64_t>(out.tellp());
+      entry.size = bb.save(out, static_cast<uint32_t>(bundle_idx));
+    }
+  }
+
+  out.seekp(table_pos);
+  out.write(reinterpret_cast<const char *>(table.data()),
+            table.size() * sizeof(SnapshotBundleEntry));
+  out.close();
+  YACL_ENFORCE(!out.fail(), "failed to write {}", tmp_path);
+
+  std::filesystem::rename(tmp_path, path);
+
+  SPDLOG_INFO("Saved SenderDB snapshot of {} items and {} bin bundles to {}",
+              item_count_, header.bin_bundle_count, path);
+}
+
+std::shared_ptr<SenderDB> SenderDB::LoadSnapshot(const std::string &path) {
+  STOPWATCH(sender_stopwatch, "SenderDB::LoadSnapshot");
+
+  MappedFile file(path);
+
+  size_t pos = 0;
+  auto next = [&](size_t size) {
+    YACL_ENFORCE(pos + size <= file.size(),
+                 "truncated SenderDB snapshot {}, size={}", path, file.size());
+    const unsigned char *ptr = file.data() + pos;
+    pos += size;
+    return ptr;
+  };
+
+  SnapshotHeader header;
+  std::memcpy(&header, next(sizeof(header)), sizeof(header));
+  YACL_ENFORCE(
+      std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0,
+      "{} is not a SenderDB snapshot", path);
+  YACL_ENFORCE_EQ(header.version, kSnapshotVersion,
+                  "unsupported SenderDB snapshot version of {}", path);
+
+  const unsigned char *params_ptr = next(header.params_size);
+  apsi::PSIParams params = ParsePsiParamsProto(
+      yacl::Buffer(params_ptr, static_cast<int64_t>(header.params_size)));
+  bool compressed = (header.flags & kSnapshotCompressed) != 0;
+  bool stripped = (header.flags & kSnapshotStripped) != 0;
+
+  std::shared_ptr<SenderDB> sender_db;
+  if (stripped) {
+    sender_db = std::make_shared<SenderDB>(params, header.label_byte_count,
+                                           header.nonce_byte_count, compressed);
+  } else {
+    const unsigned char *key_ptr = next(header.oprf_key_size);
+    sender_db = std::make_shared<SenderDB>(
+        params, yacl::ByteContainerView(key_ptr, header.oprf_key_size),
+        header.label_byte_count, header.nonce_byte_count, compressed);
+  }
+  sender_db->stripped_ = stripped;
+  sender_db->item_count_ = header.item_count;
+
+  sender_db->hashed_items_.reserve(header.hashed_item_count);
+  for (uint64_t i = 0; i < header.hashed_item_count; i++) {
+    apsi::HashedItem item;
+    std::memcpy(item.value().data(), next(item.value().size()),
+                item.value().size());
+    sender_db->hashed_items_.insert(item);
+  }
+
+  std::vector<SnapshotBundleEntry> table(header.bin_bundle_count);
+  std::memcpy(table.data(),
+              next(table.size() * sizeof(SnapshotBundleEntry)),
+              table.size() * sizeof(SnapshotBundleEntry));
+
+  size_t label_size = ComputeLabelSize(
+      header.nonce_byte_count + header.label_byte_count, params);
+  uint32_t bins_per_bundle = params.bins_per_bundle();
+  uint32_t max_bin_size = params.table_params().max_items_per_bin;
+  uint32_t ps_low_degree = params.query_params().ps_low_degree;
+
+  // The BinBundles are independent, so they are parsed right out of the
+  // mapping in parallel. Their caches are stored in the snapshot, so nothing
+  // is regenerated.
+  apsi::ThreadPoolMgr tpm;
+  std::vector<std::future<std::pair<uint32_t, apsi::sender::BinBundle>>>
+      futures;
+  futures.reserve(table.size());
+  for (const auto &entry : table) {
+    YACL_ENFORCE(entry.offset + entry.size <= file.size(),
+                 "truncated SenderDB snapshot {}, size={}", path, file.size());
+    futures.push_back(tpm.thread_pool().enqueue([&, entry]() {
+      apsi::sender::BinBundle bb(sender_db->crypto_context_, label_size,
+                                 max_bin_size, ps_low_degree, bins_per_bundle,
+                                 compressed, stripped);
+      auto [bundle_idx, size] = bb.load(gsl::span<const unsigned char>(
+          file.data() + entry.offset, entry.size));
+      YACL_ENFORCE_EQ(size, entry.size, "corrupted bin bundle in {}", path);
+      // Only regenerates if the cache was not saved.
+      bb.regen_cache();
+      return std::make_pair(bundle_idx, std::move(bb));
+    }));
+  }
+
+  for (auto &f : futures) {
+    auto [bundle_idx, bb] = f.get();
+    YACL_ENFORCE(bundle_idx < sender_db->bin_bundles_.size(),
+                 "invalid bundle index {} in {}", bundle_idx, path);
+    sender_db->bin_bundles_[bundle_idx].push_back(std::move(bb));
+  }
+
+  SPDLOG_INFO("Loaded SenderDB snapshot of {} items and {} bin bundles from {}",
+              header.item_count, table.size(), path);
+
+  return sender_db;
+}
+
 bool SenderDB::HasItem(const apsi::Item &item) const {
   if (stripped_) {
     SPDLOG_ERROR(
@@ -1005,9 +1306,7 @@ bool SenderDB::HasItem(const apsi::Item &item) const {
 
   // First compute the hash for the input item
   // auto hashed_item = OPRFSender::ComputeHashes({&item, 1}, oprf_key_)[0];
-  std::string item_str;
-  item_str.reserve(item.value().size());
-  std::memcpy(&item_str[0], item.value().data(), item.value().size());
+  std::string item_str = ItemToString(item);
   std::string oprf_out = oprf_server_->FullEvaluate(item_str);
   apsi::HashedItem hashed_item;
   std::memcpy(hashed_item.value().data(), &oprf_out[0],
@@ -1035,9 +1334,7 @@ apsi::Label SenderDB::GetLabel(const apsi::Item &item) const {
   apsi::LabelKey key;
   // tie(hashed_item, key) = OPRFSender::GetItemHash(item, oprf_key_);
 
-  std::string item_str;
-  item_str.reserve(item.value().size());
-  std::memcpy(&item_str[0], item.value().data(), item.value().size());
+  std::string item_str = ItemToString(item);
   std::string oprf_out = oprf_server_->FullEvaluate(item_str);
   std::memcpy(hashed_item.value().data(), &oprf_out[0],
               hashed_item.value().size());
@@ -23,6 +23,8 @@
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <set>
+#include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -38,6 +40,7 @@
 #include "yacl/base/byte_container_view.h"
 
 #include "spu/psi/core/ecdh_oprf/basic_ecdh_oprf.h"
+#include "spu/psi/utils/batch_provider.h"
 
 // SEAL
 #include "seal/plaintext.h"
@@ -165,6 +168,17 @@ class SenderDB {
     InsertOrAssign(data_singleton);
   }
 
+  /**
+  Inserts the items read from item_provider into the database, batch_size items
+  at a time, so that the whole input never needs to be in memory. A labeled
+  SenderDB reads the label of each item from label_provider, which should yield
+  batches of the same sizes; an unlabeled SenderDB takes a null label_provider.
+  The BinBundle caches are generated once after the last batch.
+  */
+  void InsertOrAssign(const std::shared_ptr<IBatchProvider> &item_provider,
+                      const std::shared_ptr<IBatchProvider> &label_provider,
+                      size_t batch_size);
+
   /**
   Clears the database and inserts the given data. This function can be used only
   on a labeled SenderDB instance.
@@ -271,6 +285,19 @@ class SenderDB {
 
   std::vector<uint8_t> GetOprfKey() const;
 
+  /**
+  Saves the SenderDB, including the BinBundle caches, to a versioned snapshot
+  file at path. The file is written aside and renamed into place.
+  */
+  void SaveSnapshot(const std::string &path) const;
+
+  /**
+  Loads a SenderDB from a snapshot saved by SaveSnapshot. The file is mapped
+  and its BinBundles are parsed in parallel with their saved caches, so the
+  returned SenderDB is ready to serve queries without regenerating anything.
+  */
+  static std::shared_ptr<SenderDB> LoadSnapshot(const std::string &path);
+
  private:
   SenderDB(const SenderDB &copy) = delete;
 
@@ -278,8 +305,24 @@ class SenderDB {
 
   void ClearInternal();
 
+  /**
+  Regenerates the caches of the BinBundles at the dirty bundle indices in
+  parallel. Assumes the SenderDB is locked for writing.
+  */
   void GenerateCaches();
 
+  /**
+  Inserts the given items, as OPRF inputs, and their labels. The caches of the
+  touched bundle indices are regenerated only if generate_caches is set;
+  otherwise they are left dirty for a later GenerateCaches.
+  */
+  void InsertOrAssignLabeled(const std::vector<std::string> &items,
+                             const std::vector<apsi::Label> &labels,
+                             bool generate_caches);
+
+  void InsertOrAssignUnlabeled(const std::vector<std::string> &items,
+                               bool generate_caches);
+
   /**
   The set of all items that have been inserted into the database
   */
@@ -338,6 +381,11 @@ class SenderDB {
   */
   std::vector<std::vector<apsi::sender::BinBundle>> bin_bundles_;
 
+  /**
+  The bundle indices modified since their BinBundle caches were last generated.
+  */
+  std::set<size_t> dirty_bundles_;
+
   /**
   Holds the OPRF key for this SenderDB.
   */
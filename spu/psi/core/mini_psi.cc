@@ -111,16 +111,18 @@ struct MiniPsiSendCtx {
   }
 
   void EvalPolynomial(const std::vector<std::string>& items) {
-    polynomial_eval_values.resize(items.size());
     masked_values.resize(items.size());
 
     items_hash = HashInputs(items);
 
+    // evaluate at all items at once, by the fast multipoint evaluation.
+    std::vector<absl::string_view> poly_x(items_hash.begin(),
+                                          items_hash.end());
+    polynomial_eval_values =
+        spu::psi::EvalPolynomial(polynomial_coeff, poly_x, prime256_str);
+
     yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
       for (int64_t idx = begin; idx < end; ++idx) {
-        polynomial_eval_values[idx] = spu::psi::EvalPolynomial(
-            polynomial_coeff, absl::string_view(items_hash[idx]), prime256_str);
-
         std::array<uint8_t, kKeySize> ideal_permuation;
         // Ideal Permuation
         aes_ecb->Decrypt(
@@ -239,8 +241,7 @@ struct MiniPsiRecvCtx {
           (const char*)poly_y_permuation[idx].data(), kKeySize);
     }
 
-    // ToDo: now use newton Polynomial Interpolation, need optimize to fft
-    //
+    // subproduct tree interpolation over a native prime field.
     polynomial_coeff =
         spu::psi::InterpolatePolynomial(poly_x, poly_y, prime256_str);
   }
@@ -0,0 +1,295 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/oprf_evaluated_set.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+#include "spu/psi/io/io.h"
+
+namespace spu::psi {
+
+namespace {
+
+// file layout: magic | epoch | item_length | count | fingerprint_bytes |
+// bucket_num | items or filter table, where the epoch is prefixed by its u32
+// size and zero fingerprint_bytes is for items.
+constexpr char kMagic[] = "OPRFSET1";
+
+// items are bucketed by their first two bytes before sorting.
+constexpr size_t kBucketNum = 1 << 16;
+
+size_t BucketOf(std::string_view item) {
+  size_t bucket = static_cast<uint8_t>(item[0]) << 8;
+  if (item.size() > 1) {
+    bucket |= static_cast<uint8_t>(item[1]);
+  }
+  return bucket;
+}
+
+uint64_t ReadU64(std::string_view* data) {
+  uint64_t value;
+  YACL_ENFORCE(data->size() >= sizeof(value), "corrupted evaluated set");
+  std::memcpy(&value, data->data(), sizeof(value));
+  data->remove_prefix(sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+OprfEvaluatedSet::OprfEvaluatedSet(std::string epoch, size_t item_length)
+    : epoch_(std::move(epoch)), item_length_(item_length) {
+  YACL_ENFORCE(item_length_ > 0);
+}
+
+std::unique_ptr<OprfEvaluatedSet> OprfEvaluatedSet::Load(
+    const std::string& path, const std::string& epoch) {
+  if (!std::filesystem::exists(path)) {
+    return nullptr;
+  }
+
+  auto in = io::BuildInputStream(io::FileIoOptions(path));
+  std::string header(sizeof(kMagic) - 1 + sizeof(uint32_t), '\0');
+  in->Read(header.data(), header.size());
+  YACL_ENFORCE(header.compare(0, sizeof(kMagic) - 1, kMagic) == 0,
+               "bad evaluated set file={}", path);
+  uint32_t epoch_size;
+  std::memcpy(&epoch_size, header.data() + sizeof(kMagic) - 1,
+              sizeof(epoch_size));
+  std::string file_epoch(epoch_size, '\0');
+  in->Read(file_epoch.data(), file_epoch.size());
+  if (file_epoch != epoch) {
+    SPDLOG_WARN("discard evaluated set of another key epoch, file={}", path);
+    return nullptr;
+  }
+
+  std::string sizes(4 * sizeof(uint64_t), '\0');
+  in->Read(sizes.data(), sizes.size());
+  std::string_view sizes_view(sizes);
+  const uint64_t item_length = ReadU64(&sizes_view);
+  const uint64_t count = ReadU64(&sizes_view);
+  CuckooFilter::Params filter_params;
+  filter_params.fingerprint_bytes = ReadU64(&sizes_view);
+  filter_params.bucket_num = ReadU64(&sizes_view);
+
+  auto set = std::make_unique<OprfEvaluatedSet>(epoch, item_length);
+  if (filter_params.fingerprint_bytes == 0) {
+    set->data_.resize(item_length * count);
+    in->Read(set->data_.data(), set->data_.size());
+    set->finished_ = true;
+  } else {
+    std::string table(filter_params.TableSize(), '\0');
+    in->Read(table.data(), table.size());
+    set->SetFilter(std::make_unique<CuckooFilter>(filter_params,
+                                                  std::move(table), count));
+  }
+  in->Close();
+  SPDLOG_INFO("load evaluated set file={}, size={}", path, count);
+  return set;
+}
+
+void OprfEvaluatedSet::Save(const std::string& path) const {
+  YACL_ENFORCE(finished_, "evaluated set should be finished before save");
+
+  std::string header(kMagic, sizeof(kMagic) - 1);
+  uint32_t epoch_size = epoch_.size();
+  header.append(reinterpret_cast<const char*>(&epoch_size),
+                sizeof(epoch_size));
+  header.append(epoch_);
+  uint64_t item_length = item_length_;
+  uint64_t count = size();
+  header.append(reinterpret_cast<const char*>(&item_length),
+                sizeof(item_length));
+  header.append(reinterpret_cast<const char*>(&count), sizeof(count));
+  CuckooFilter::Params filter_params;
+  if (filter_) {
+    filter_params = filter_->params();
+  }
+  header.append(reinterpret_cast<const char*>(&filter_params.fingerprint_bytes),
+                sizeof(filter_params.fingerprint_bytes));
+  header.append(reinterpret_cast<const char*>(&filter_params.bucket_num),
+                sizeof(filter_params.bucket_num));
+
+  // write to a temp file then rename, an interrupted save keeps the old one.
+  const std::string tmp_path = path + ".tmp";
+  {
+    auto out = io::BuildOutputStream(io::FileIoOptions(tmp_path));
+    out->Write(header.data(), header.size());
+    const std::string& payload = filter_ ? filter_->table() : data_;
+    out->Write(payload.data(), payload.size());
+    out->Close();
+  }
+  std::filesystem::rename(tmp_path, path);
+}
+
+void OprfEvaluatedSet::Append(std::string_view flatten_items) {
+  YACL_ENFORCE(filter_ == nullptr, "cannot append to a filter");
+  YACL_ENFORCE(flatten_items.size() % item_length_ == 0,
+               "flatten items size={} is not a multiple of item_length={}",
+               flatten_items.size(), item_length_);
+  data_.append(flatten_items);
+  finished_ = false;
+}
+
+void OprfEvaluatedSet::Finish() {
+  const size_t count = size();
+
+  bool sorted = true;
+  for (size_t idx = 1; idx < count && sorted; ++idx) {
+    sorted = GetItem(idx - 1) < GetItem(idx);
+  }
+  if (sorted) {
+    finished_ = true;
+    return;
+  }
+
+  // oprf outputs are uniform, a counting sort by the first two bytes leaves
+  // small buckets to sort in parallel.
+  std::vector<size_t> bucket_begin(kBucketNum + 1, 0);
+  for (size_t idx = 0; idx < count; ++idx) {
+    ++bucket_begin[BucketOf(GetItem(idx)) + 1];
+  }
+  std::partial_sum(bucket_begin.begin(), bucket_begin.end(),
+                   bucket_begin.begin());
+
+  std::string bucketed(data_.size(), '\0');
+  std::vector<size_t> pos(bucket_begin.begin(), bucket_begin.end() - 1);
+  for (size_t idx = 0; idx < count; ++idx) {
+    auto item = GetItem(idx);
+    std::memcpy(&bucketed[pos[BucketOf(item)]++ * item_length_], item.data(),
+                item_length_);
+  }
+  data_ = std::move(bucketed);
+
+  yacl::parallel_for(0, kBucketNum, 1, [&](int64_t begin, int64_t end) {
+    std::vector<size_t> order;
+    std::string buf;
+    for (int64_t bucket = begin; bucket < end; ++bucket) {
+      if (bucket_begin[bucket + 1] - bucket_begin[bucket] < 2) {
+        continue;
+      }
+      order.resize(bucket_begin[bucket + 1] - bucket_begin[bucket]);
+      std::iota(order.begin(), order.end(), bucket_begin[bucket]);
+      std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return GetItem(a) < GetItem(b);
+      });
+      buf.clear();
+      for (size_t idx : order) {
+        buf.append(GetItem(idx));
+      }
+      std::memcpy(&data_[bucket_begin[bucket] * item_length_], buf.data(),
+                  buf.size());
+    }
+  });
+
+  size_t unique_count = 0;
+  for (size_t idx = 0; idx < count; ++idx) {
+    if (unique_count > 0 && GetItem(idx) == GetItem(unique_count - 1)) {
+      continue;
+    }
+    if (unique_count != idx) {
+      std::memmove(&data_[unique_count * item_length_],
+                   &data_[idx * item_length_], item_length_);
+    }
+    ++unique_count;
+  }
+  data_.resize(unique_count * item_length_);
+  finished_ = true;
+}
+
+void OprfEvaluatedSet::ToFilter(double false_positive_rate) {
+  YACL_ENFORCE(finished_ && filter_ == nullptr,
+               "only finished items could turn into a filter");
+
+  auto filter = std::make_unique<CuckooFilter>(size(), false_positive_rate);
+  for (size_t idx = 0; idx < size(); ++idx) {
+    filter->Insert(GetItem(idx));
+  }
+  SPDLOG_INFO("evaluated set of {} items to a filter of {} bytes", size(),
+              filter->table().size());
+  SetFilter(std::move(filter));
+}
+
+void OprfEvaluatedSet::SetFilter(std::unique_ptr<CuckooFilter> filter) {
+  YACL_ENFORCE(filter != nullptr);
+  filter_ = std::move(filter);
+  std::string().swap(data_);
+  finished_ = true;
+}
+
+bool OprfEvaluatedSet::Contains(std::string_view item) const {
+  YACL_ENFORCE(finished_, "evaluated set should be finished before lookup");
+  YACL_ENFORCE(item.size() == item_length_, "item size={} mismatch {}",
+               item.size(), item_length_);
+  if (filter_) {
+    return filter_->Contains(item);
+  }
+
+  size_t low = 0;
+  size_t high = size();
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (GetItem(mid) < item) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < size() && GetItem(low) == item;
+}
+
+std::vector<size_t> OprfEvaluatedSet::Intersect(
+    const std::vector<std::string>& items) const {
+  std::vector<uint8_t> hits;
+  if (filter_) {
+    for (const auto& item : items) {
+      YACL_ENFORCE(item.size() == item_length_, "item size={} mismatch {}",
+                   item.size(), item_length_);
+    }
+    hits = filter_->BatchContains(items);
+  } else {
+    hits.resize(items.size());
+    yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
+      for (int64_t idx = begin; idx < end; ++idx) {
+        hits[idx] = Contains(items[idx]);
+      }
+    });
+  }
+
+  std::vector<size_t> indices;
+  for (size_t idx = 0; idx < items.size(); ++idx) {
+    if (hits[idx] != 0) {
+      indices.push_back(idx);
+    }
+  }
+  return indices;
+}
+
+std::string_view OprfEvaluatedSet::GetItems(size_t begin, size_t count) const {
+  YACL_ENFORCE(filter_ == nullptr, "items of a filter are not available");
+  YACL_ENFORCE(begin <= size());
+  count = std::min(count, size() - begin);
+  return std::string_view(data_).substr(begin * item_length_,
+                                        count * item_length_);
+}
+
+}  // namespace spu::psi
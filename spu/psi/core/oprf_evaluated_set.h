@@ -0,0 +1,92 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "spu/psi/utils/cuckoo_filter.h"
+
+namespace spu::psi {
+
+// The truncated oprf outputs of the server set in unbalanced psi, sorted and
+// kept in one flat buffer of item_length bytes per item.
+//
+// The server evaluates its set once per private key and serves every client
+// session from the saved set. A client keeps the downloaded set as well, so a
+// session with a cached set only blinds and finalizes the client items. A set
+// is bound to the key epoch of the server, and a file of another epoch is
+// discarded on Load.
+//
+// The set could be turned into a cuckoo filter of the items, a few bytes per
+// item in place of item_length, which is sent and cached instead at the price
+// of false positives.
+class OprfEvaluatedSet {
+ public:
+  OprfEvaluatedSet(std::string epoch, size_t item_length);
+
+  // The set of `epoch` saved at `path`, or nullptr if the file does not exist
+  // or is of another epoch.
+  static std::unique_ptr<OprfEvaluatedSet> Load(const std::string& path,
+                                                const std::string& epoch);
+
+  void Save(const std::string& path) const;
+
+  // Append items concatenated in `flatten_items`, Finish after the last one.
+  void Append(std::string_view flatten_items);
+
+  // Sort and dedup the items, required before lookups.
+  void Finish();
+
+  // Replace the finished items by a cuckoo filter of them.
+  void ToFilter(double false_positive_rate);
+
+  // Replace the items by a received or loaded filter.
+  void SetFilter(std::unique_ptr<CuckooFilter> filter);
+
+  // The filter of ToFilter or SetFilter, or nullptr for the items.
+  const CuckooFilter* filter() const { return filter_.get(); }
+
+  bool Contains(std::string_view item) const;
+
+  // Indices of `items` in the set, in ascending order.
+  std::vector<size_t> Intersect(const std::vector<std::string>& items) const;
+
+  // `count` items from `begin` concatenated, not available for a filter.
+  std::string_view GetItems(size_t begin, size_t count) const;
+
+  const std::string& epoch() const { return epoch_; }
+
+  size_t item_length() const { return item_length_; }
+
+  size_t size() const {
+    return filter_ ? filter_->size() : data_.size() / item_length_;
+  }
+
+ private:
+  std::string_view GetItem(size_t idx) const {
+    return std::string_view(data_).substr(idx * item_length_, item_length_);
+  }
+
+  std::string epoch_;
+  size_t item_length_;
+  std::string data_;
+  bool finished_ = false;
+  std::unique_ptr<CuckooFilter> filter_;
+};
+
+}  // namespace spu::psi
@@ -0,0 +1,77 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/oprf_evaluated_set.h"
+
+#include <filesystem>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+#include "yacl/crypto/tools/prg.h"
+
+namespace spu::psi {
+
+TEST(OprfEvaluatedSetTest, Works) {
+  constexpr size_t kItemLength = 12;
+  constexpr size_t kItemNum = 100000;
+
+  yacl::Prg<uint8_t> prg(0);
+  std::vector<std::string> items(kItemNum, std::string(kItemLength, '\0'));
+  OprfEvaluatedSet set("epoch", kItemLength);
+  for (auto& item : items) {
+    prg.Fill(absl::MakeSpan(item));
+    set.Append(item);
+  }
+  // duplicated items are kept once.
+  set.Append(items[0] + items[1]);
+  set.Finish();
+
+  EXPECT_EQ(set.size(), kItemNum);
+  std::set<std::string> expected(items.begin(), items.end());
+  auto iter = expected.begin();
+  for (size_t idx = 0; idx < set.size(); ++idx, ++iter) {
+    EXPECT_EQ(set.GetItems(idx, 1), *iter);
+  }
+
+  std::vector<std::string> queries = {items[5], std::string(kItemLength, 'x'),
+                                      items[kItemNum - 1]};
+  EXPECT_EQ(set.Intersect(queries), (std::vector<size_t>{0, 2}));
+  EXPECT_THROW(set.Contains("short"), yacl::EnforceNotMet);
+
+  auto path = std::filesystem::temp_directory_path() / "oprf-evaluated-set";
+  set.Save(path);
+  EXPECT_EQ(OprfEvaluatedSet::Load(path, "another epoch"), nullptr);
+  auto loaded = OprfEvaluatedSet::Load(path, "epoch");
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->item_length(), kItemLength);
+  EXPECT_EQ(loaded->GetItems(0, kItemNum), set.GetItems(0, kItemNum));
+  EXPECT_EQ(loaded->Intersect(queries), (std::vector<size_t>{0, 2}));
+
+  loaded->ToFilter(1e-8);
+  EXPECT_EQ(loaded->size(), kItemNum);
+  EXPECT_EQ(loaded->Intersect(queries), (std::vector<size_t>{0, 2}));
+  EXPECT_THROW(loaded->GetItems(0, 1), yacl::EnforceNotMet);
+  loaded->Save(path);
+  auto loaded_filter = OprfEvaluatedSet::Load(path, "epoch");
+  ASSERT_NE(loaded_filter->filter(), nullptr);
+  EXPECT_EQ(loaded_filter->size(), kItemNum);
+  EXPECT_EQ(loaded_filter->filter()->table(), loaded->filter()->table());
+  EXPECT_EQ(loaded_filter->Intersect(items).size(), kItemNum);
+
+  std::filesystem::remove(path);
+  EXPECT_EQ(OprfEvaluatedSet::Load(path, "epoch"), nullptr);
+}
+
+}  // namespace spu::psi
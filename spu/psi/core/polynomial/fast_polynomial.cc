@@ -0,0 +1,360 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/polynomial/fast_polynomial.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+namespace spu::psi {
+
+namespace {
+
+using Element = PrimeField::Element;
+
+// Below the sizes the quadratic algorithms are faster.
+constexpr size_t kKaratsubaThreshold = 16;
+constexpr size_t kFastDivisionThreshold = 1024;
+// Polynomials of fewer coefficients are evaluated by horner's rule.
+constexpr size_t kFastEvalThreshold = 64;
+
+// products of an output coefficient are added up before one reduction.
+void SchoolbookMul(const PrimeField &field, const Element *a, size_t na,
+                   const Element *b, size_t nb, Element *out) {
+  for (size_t c = 0; c + 1 < na + nb; ++c) {
+    PrimeField::WideElement acc{};
+    size_t i_begin = c >= nb ? c - nb + 1 : 0;
+    size_t i_end = std::min(c, na - 1);
+    for (size_t i = i_begin; i <= i_end; ++i) {
+      PrimeField::MulAcc(&acc, a[i], b[c - i]);
+    }
+    out[c] = field.Reduce(acc);
+  }
+}
+
+// out[0, 2n - 1) = a[0, n) * b[0, n)
+void KaratsubaMul(const PrimeField &field, const Element *a, const Element *b,
+                  size_t n, Element *out) {
+  if (n <= kKaratsubaThreshold) {
+    SchoolbookMul(field, a, n, b, n, out);
+    return;
+  }
+
+  // a = a0 + a1 * x^h, where a1 has l <= h coefficients.
+  size_t h = (n + 1) / 2;
+  size_t l = n - h;
+
+  FieldPoly z0(2 * h - 1);
+  FieldPoly z2(2 * l - 1);
+  FieldPoly z1(2 * h - 1);
+  KaratsubaMul(field, a, b, h, z0.data());
+  KaratsubaMul(field, a + h, b + h, l, z2.data());
+
+  FieldPoly sa(a, a + h);
+  FieldPoly sb(b, b + h);
+  for (size_t i = 0; i < l; ++i) {
+    sa[i] = field.Add(sa[i], a[h + i]);
+    sb[i] = field.Add(sb[i], b[h + i]);
+  }
+  KaratsubaMul(field, sa.data(), sb.data(), h, z1.data());
+  for (size_t i = 0; i < z0.size(); ++i) {
+    z1[i] = field.Sub(z1[i], z0[i]);
+  }
+  for (size_t i = 0; i < z2.size(); ++i) {
+    z1[i] = field.Sub(z1[i], z2[i]);
+  }
+
+  std::fill(out, out + 2 * n - 1, field.Zero());
+  std::copy(z0.begin(), z0.end(), out);
+  std::copy(z2.begin(), z2.end(), out + 2 * h);
+  for (size_t i = 0; i < z1.size(); ++i) {
+    out[h + i] = field.Add(out[h + i], z1[i]);
+  }
+}
+
+FieldPoly AddPolynomial(const PrimeField &field,
+                        absl::Span<const Element> a,
+                        absl::Span<const Element> b) {
+  if (a.size() < b.size()) {
+    std::swap(a, b);
+  }
+  FieldPoly res(a.begin(), a.end());
+  for (size_t i = 0; i < b.size(); ++i) {
+    res[i] = field.Add(res[i], b[i]);
+  }
+  return res;
+}
+
+// g with f * g = 1 mod x^n, where f[0] should be invertible.
+FieldPoly InversePowerSeries(const PrimeField &field,
+                             absl::Span<const Element> f, size_t n) {
+  FieldPoly g = {field.Inv(f[0])};
+  Element two = field.FromUint64(2);
+  size_t len = 1;
+  while (len < n) {
+    // g = g * (2 - f * g) mod x^len
+    len = std::min(2 * len, n);
+    FieldPoly t = MulPolynomial(field, f.subspan(0, std::min(len, f.size())),
+                                g);
+    t.resize(len, field.Zero());
+    for (auto &e : t) {
+      e = field.Neg(e);
+    }
+    t[0] = field.Add(t[0], two);
+    g = MulPolynomial(field, g, t);
+    g.resize(len);
+  }
+  return g;
+}
+
+// a mod b, where b should be monic, as all nodes of a subproduct tree are.
+FieldPoly RemPolynomial(const PrimeField &field, absl::Span<const Element> a,
+                        absl::Span<const Element> b) {
+  YACL_ENFORCE(!b.empty());
+  const size_t m = b.size() - 1;
+  if (a.size() <= m) {
+    return FieldPoly(a.begin(), a.end());
+  }
+  const size_t k = a.size() - m;
+
+  if (k < kFastDivisionThreshold || m < kFastDivisionThreshold) {
+    // long division, where a coefficient of the quotient or the remainder is
+    // a minus an inner product of the quotient and b.
+    FieldPoly q(k);
+    for (size_t i = k; i-- > 0;) {
+      PrimeField::WideElement acc{};
+      for (size_t j = i + 1; j < std::min(k, i + m + 1); ++j) {
+        PrimeField::MulAcc(&acc, q[j], b[i + m - j]);
+      }
+      q[i] = field.Sub(a[i + m], field.Reduce(acc));
+    }
+    FieldPoly r(m);
+    for (size_t t = 0; t < m; ++t) {
+      PrimeField::WideElement acc{};
+      for (size_t j = (t + 1 > m ? t + 1 - m : 0); j <= std::min(t, k - 1);
+           ++j) {
+        PrimeField::MulAcc(&acc, q[j], b[t - j]);
+      }
+      r[t] = field.Sub(a[t], field.Reduce(acc));
+    }
+    return r;
+  }
+
+  // rev(q) = rev(a) / rev(b) mod x^k, then r = a - b * q.
+  FieldPoly rev_a(a.rbegin(), a.rbegin() + k);
+  FieldPoly rev_b(b.rbegin(), b.rend());
+  FieldPoly rev_q = MulPolynomial(field, rev_a,
+                                  InversePowerSeries(field, rev_b, k));
+  rev_q.resize(k);
+  FieldPoly q(rev_q.rbegin(), rev_q.rend());
+
+  FieldPoly bq = MulPolynomial(field, b, q);
+  FieldPoly r(m);
+  for (size_t i = 0; i < m; ++i) {
+    r[i] = field.Sub(a[i], bq[i]);
+  }
+  return r;
+}
+
+Element HornerEval(const PrimeField &field, absl::Span<const Element> coeffs,
+                   const Element &x) {
+  Element acc = field.Zero();
+  for (size_t i = coeffs.size(); i-- > 0;) {
+    acc = field.Add(field.Mul(acc, x), coeffs[i]);
+  }
+  return acc;
+}
+
+// levels[0] holds x - x_i, and node k of level l + 1 is the product of nodes
+// 2k and 2k + 1 of level l, or a copy of node 2k if it is the last one.
+class SubproductTree {
+ public:
+  SubproductTree(const PrimeField &field, absl::Span<const Element> poly_x)
+      : field_(field) {
+    YACL_ENFORCE(!poly_x.empty());
+    std::vector<FieldPoly> leaves(poly_x.size());
+    for (size_t i = 0; i < poly_x.size(); ++i) {
+      leaves[i] = {field_.Neg(poly_x[i]), field_.One()};
+    }
+    levels_.push_back(std::move(leaves));
+
+    while (levels_.back().size() > 1) {
+      const std::vector<FieldPoly> &prev = levels_.back();
+      std::vector<FieldPoly> next((prev.size() + 1) / 2);
+      yacl::parallel_for(0, next.size(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t k = begin; k < end; ++k) {
+          if (2 * k + 1 < static_cast<int64_t>(prev.size())) {
+            next[k] = MulPolynomial(field_, prev[2 * k], prev[2 * k + 1]);
+          } else {
+            next[k] = prev[2 * k];
+          }
+        }
+      });
+      levels_.push_back(std::move(next));
+    }
+  }
+
+  const FieldPoly &Root() const { return levels_.back()[0]; }
+
+  // Value of the polynomial at the leaves by the remainder tree.
+  std::vector<Element> Eval(absl::Span<const Element> coeffs) const {
+    std::vector<FieldPoly> rems = {RemPolynomial(field_, coeffs, Root())};
+    for (size_t l = levels_.size() - 1; l-- > 0;) {
+      const std::vector<FieldPoly> &nodes = levels_[l];
+      std::vector<FieldPoly> next(nodes.size());
+      yacl::parallel_for(0, nodes.size(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          next[i] = RemPolynomial(field_, rems[i / 2], nodes[i]);
+        }
+      });
+      rems = std::move(next);
+    }
+
+    std::vector<Element> values(rems.size());
+    for (size_t i = 0; i < rems.size(); ++i) {
+      values[i] = rems[i].empty() ? field_.Zero() : rems[i][0];
+    }
+    return values;
+  }
+
+  // sum of w_i * prod_{j != i} (x - x_j) up the tree.
+  FieldPoly LinearCombine(std::vector<Element> weights) const {
+    std::vector<FieldPoly> vals(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+      vals[i] = {weights[i]};
+    }
+    for (size_t l = 0; l + 1 < levels_.size(); ++l) {
+      const std::vector<FieldPoly> &nodes = levels_[l];
+      std::vector<FieldPoly> next((vals.size() + 1) / 2);
+      yacl::parallel_for(0, next.size(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t k = begin; k < end; ++k) {
+          if (2 * k + 1 < static_cast<int64_t>(vals.size())) {
+            next[k] = AddPolynomial(
+                field_, MulPolynomial(field_, vals[2 * k], nodes[2 * k + 1]),
+                MulPolynomial(field_, vals[2 * k + 1], nodes[2 * k]));
+          } else {
+            next[k] = std::move(vals[2 * k]);
+          }
+        }
+      });
+      vals = std::move(next);
+    }
+    return vals[0];
+  }
+
+ private:
+  const PrimeField &field_;
+  std::vector<std::vector<FieldPoly>> levels_;
+};
+
+}  // namespace
+
+FieldPoly MulPolynomial(const PrimeField &field, absl::Span<const Element> a,
+                        absl::Span<const Element> b) {
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+  if (a.size() < b.size()) {
+    std::swap(a, b);
+  }
+  FieldPoly res(a.size() + b.size() - 1, field.Zero());
+  if (b.size() <= kKaratsubaThreshold) {
+    SchoolbookMul(field, a.data(), a.size(), b.data(), b.size(), res.data());
+    return res;
+  }
+
+  // multiply b by the chunks of a of its size.
+  const size_t n = b.size();
+  FieldPoly chunk(n);
+  FieldPoly prod(2 * n - 1);
+  for (size_t offset = 0; offset < a.size(); offset += n) {
+    size_t len = std::min(n, a.size() - offset);
+    std::copy(a.begin() + offset, a.begin() + offset + len, chunk.begin());
+    std::fill(chunk.begin() + len, chunk.end(), field.Zero());
+    KaratsubaMul(field, chunk.data(), b.data(), n, prod.data());
+    for (size_t i = 0; i < len + n - 1; ++i) {
+      res[offset + i] = field.Add(res[offset + i], prod[i]);
+    }
+  }
+  return res;
+}
+
+std::vector<Element> MultiEvalPolynomial(const PrimeField &field,
+                                         absl::Span<const Element> coeffs,
+                                         absl::Span<const Element> poly_x) {
+  std::vector<Element> values(poly_x.size(), field.Zero());
+  if (poly_x.empty() || coeffs.empty()) {
+    return values;
+  }
+
+  if (coeffs.size() < kFastEvalThreshold) {
+    yacl::parallel_for(0, poly_x.size(), 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        values[i] = HornerEval(field, coeffs, poly_x[i]);
+      }
+    });
+    return values;
+  }
+
+  // points are evaluated in chunks of about the degree, which balances the
+  // tree with the top division.
+  const size_t chunk_size = coeffs.size();
+  const size_t num_chunks = (poly_x.size() + chunk_size - 1) / chunk_size;
+  yacl::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; ++c) {
+      size_t offset = c * chunk_size;
+      size_t len = std::min(chunk_size, poly_x.size() - offset);
+      SubproductTree tree(field, poly_x.subspan(offset, len));
+      std::vector<Element> chunk_values = tree.Eval(coeffs);
+      std::copy(chunk_values.begin(), chunk_values.end(),
+                values.begin() + offset);
+    }
+  });
+  return values;
+}
+
+FieldPoly InterpolatePolynomial(const PrimeField &field,
+                                absl::Span<const Element> poly_x,
+                                absl::Span<const Element> poly_y) {
+  YACL_ENFORCE(poly_x.size() == poly_y.size());
+  if (poly_x.empty()) {
+    return {};
+  }
+
+  // Lagrange interpolation, with w_i = y_i / M'(x_i) and M = prod (x - x_i).
+  SubproductTree tree(field, poly_x);
+  const FieldPoly &root = tree.Root();
+  FieldPoly derivative(root.size() - 1);
+  for (size_t i = 1; i < root.size(); ++i) {
+    derivative[i - 1] = field.Mul(root[i], field.FromUint64(i));
+  }
+
+  std::vector<Element> weights = tree.Eval(derivative);
+  for (const auto &w : weights) {
+    YACL_ENFORCE(!PrimeField::IsZero(w), "interpolate duplicated x");
+  }
+  field.BatchInv(&weights);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = field.Mul(weights[i], poly_y[i]);
+  }
+
+  FieldPoly coeffs = tree.LinearCombine(std::move(weights));
+  coeffs.resize(poly_x.size(), field.Zero());
+  return coeffs;
+}
+
+}  // namespace spu::psi
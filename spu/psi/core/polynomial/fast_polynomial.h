@@ -0,0 +1,51 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "absl/types/span.h"
+
+#include "spu/psi/core/polynomial/prime_field.h"
+
+namespace spu::psi {
+
+// Coefficients of a polynomial over PrimeField, the lowest degree first.
+using FieldPoly = std::vector<PrimeField::Element>;
+
+// Subquadratic polynomial arithmetic over PrimeField.
+//
+// Multiplication is karatsuba, and division is by a newton inverse of the
+// reversed divisor. Multipoint evaluation and interpolation go through the
+// subproduct tree of (x - x_i) as in
+// von zur Gathen and Gerhard, Modern Computer Algebra, Chapter 10,
+// and the nodes of a tree level are computed in parallel.
+
+FieldPoly MulPolynomial(const PrimeField &field,
+                        absl::Span<const PrimeField::Element> a,
+                        absl::Span<const PrimeField::Element> b);
+
+// Value of the polynomial at every x.
+std::vector<PrimeField::Element> MultiEvalPolynomial(
+    const PrimeField &field, absl::Span<const PrimeField::Element> coeffs,
+    absl::Span<const PrimeField::Element> poly_x);
+
+// The polynomial of degree < poly_x.size() going through (x_i, y_i), where
+// x_i should be distinct. High zero coefficients are kept.
+FieldPoly InterpolatePolynomial(const PrimeField &field,
+                                absl::Span<const PrimeField::Element> poly_x,
+                                absl::Span<const PrimeField::Element> poly_y);
+
+}  // namespace spu::psi
@@ -19,6 +19,10 @@
 
 #include "openssl/bn.h"
 #include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+#include "spu/psi/core/polynomial/fast_polynomial.h"
+#include "spu/psi/core/polynomial/prime_field.h"
 
 namespace spu::psi {
 
@@ -66,6 +70,17 @@ std::vector<BigNumPtr> GetBigNumPtrVector(
 
   return res;
 }
+
+std::vector<PrimeField::Element> ToFieldElements(
+    const PrimeField &field, const std::vector<absl::string_view> &data_vec) {
+  std::vector<PrimeField::Element> res(data_vec.size());
+  yacl::parallel_for(0, data_vec.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      res[idx] = field.FromBytes(data_vec[idx]);
+    }
+  });
+  return res;
+}
 }  // namespace
 
 std::string EvalPolynomial(const std::vector<absl::string_view> &coeff,
@@ -111,12 +126,32 @@ std::vector<std::string> EvalPolynomial(
     const std::vector<absl::string_view> &poly_x, std::string_view p_str) {
   std::vector<std::string> res(poly_x.size());
 
-  for (size_t idx = 0; idx < poly_x.size(); idx++) {
-    res[idx] = EvalPolynomial(coeff, poly_x[idx], p_str);
+  if (!PrimeField::IsSupported(p_str)) {
+    for (size_t idx = 0; idx < poly_x.size(); idx++) {
+      res[idx] = EvalPolynomial(coeff, poly_x[idx], p_str);
+    }
+    return res;
   }
+
+  PrimeField field(p_str);
+  std::vector<PrimeField::Element> values = MultiEvalPolynomial(
+      field, ToFieldElements(field, coeff), ToFieldElements(field, poly_x));
+  yacl::parallel_for(0, poly_x.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      res[idx] = field.ToBytes(values[idx], poly_x[idx].length());
+    }
+  });
   return res;
 }
 
+std::vector<std::string> EvalPolynomial(
+    const std::vector<std::string> &coeff,
+    const std::vector<absl::string_view> &poly_x, std::string_view p_str) {
+  std::vector<absl::string_view> coeff2(coeff.begin(), coeff.end());
+
+  return EvalPolynomial(coeff2, poly_x, p_str);
+}
+
 std::vector<std::string> InterpolatePolynomial(
     const std::vector<absl::string_view> &poly_x,
     const std::vector<absl::string_view> &poly_y, std::string_view p_str) {
@@ -124,6 +159,20 @@ std::vector<std::string> InterpolatePolynomial(
 
   YACL_ENFORCE(poly_y.size() == poly_x.size());
 
+  if (PrimeField::IsSupported(p_str)) {
+    PrimeField field(p_str);
+    FieldPoly coeffs =
+        InterpolatePolynomial(field, ToFieldElements(field, poly_x),
+                              ToFieldElements(field, poly_y));
+    while ((m > 0) && PrimeField::IsZero(coeffs[m - 1])) m--;
+
+    std::vector<std::string> res(m);
+    for (int64_t idx = 0; idx < m; idx++) {
+      res[idx] = field.ToBytes(coeffs[idx], poly_y[0].length());
+    }
+    return res;
+  }
+
   BigNumPtr bn_p = GetBigNumPtr(p_str);
 
   // std::vector<MersennePrime> prod(X);
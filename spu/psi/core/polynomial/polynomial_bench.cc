@@ -0,0 +1,87 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "benchmark/benchmark.h"
+#include "yacl/crypto/tools/prg.h"
+
+#include "spu/psi/core/polynomial/polynomial.h"
+
+namespace {
+
+// first prime over 2^256, the modulus of mini psi
+constexpr char kPrimeOver256bHexStr[] =
+    "010000000000000000000000000000000000000000000000000000000000000129";
+constexpr size_t kBnByteSize = 32;
+
+std::vector<std::string> RandomBytes(size_t n) {
+  yacl::Prg<uint64_t> prg(std::random_device{}());
+  std::vector<std::string> ret(n, std::string(kBnByteSize, '\0'));
+  for (auto& bytes : ret) {
+    prg.Fill(absl::MakeSpan(bytes.data(), kBnByteSize));
+  }
+  return ret;
+}
+
+std::vector<absl::string_view> ToViews(const std::vector<std::string>& data) {
+  return std::vector<absl::string_view>(data.begin(), data.end());
+}
+
+}  // namespace
+
+// range(0): number of points
+static void BM_InterpolatePolynomial(benchmark::State& state) {
+  std::string prime = absl::HexStringToBytes(kPrimeOver256bHexStr);
+  std::vector<std::string> poly_x = RandomBytes(state.range(0));
+  std::vector<std::string> poly_y = RandomBytes(state.range(0));
+  std::vector<absl::string_view> poly_x_sv = ToViews(poly_x);
+  std::vector<absl::string_view> poly_y_sv = ToViews(poly_y);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        spu::psi::InterpolatePolynomial(poly_x_sv, poly_y_sv, prime));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// range(0): number of coefficients, evaluated at 3 times as many points as
+// the items of mini psi sender.
+static void BM_EvalPolynomial(benchmark::State& state) {
+  std::string prime = absl::HexStringToBytes(kPrimeOver256bHexStr);
+  std::vector<std::string> coeff = RandomBytes(state.range(0));
+  std::vector<std::string> poly_x = RandomBytes(3 * state.range(0));
+  std::vector<absl::string_view> poly_x_sv = ToViews(poly_x);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        spu::psi::EvalPolynomial(coeff, poly_x_sv, prime));
+  }
+  state.SetItemsProcessed(state.iterations() * poly_x.size());
+}
+
+BENCHMARK(BM_InterpolatePolynomial)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(4)
+    ->Range(256, 16384);
+
+BENCHMARK(BM_EvalPolynomial)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(4)
+    ->Range(256, 16384);
+
+BENCHMARK_MAIN();
@@ -22,6 +22,8 @@
 #include "gtest/gtest.h"
 #include "yacl/crypto/tools/prg.h"
 
+#include "spu/psi/core/polynomial/prime_field.h"
+
 namespace {
 struct TestParams {
   uint64_t polynomial_order;
@@ -80,7 +82,75 @@ INSTANTIATE_TEST_SUITE_P(Works_Instances, PolynomialBnTest,
                                          TestParams{128},   //
                                          TestParams{256},   //
                                          TestParams{1024},  //
-                                         TestParams{1025}   //
+                                         TestParams{1025},  //
+                                         TestParams{2049}   //
                                          ));
 
+TEST(PolynomialBnTest, MultiEval) {
+  std::random_device rd;
+  yacl::Prg<uint64_t> prg(rd());
+  std::string prime_data = absl::HexStringToBytes(kPrimeOver256bHexStr);
+
+  // more points than coefficients, evaluated in chunks.
+  std::vector<std::string> coeff(300);
+  std::vector<std::string> poly_x(1000);
+  for (auto &c : coeff) {
+    c.resize(kBnByteSize);
+    prg.Fill(absl::MakeSpan(c.data(), kBnByteSize));
+  }
+  std::vector<absl::string_view> poly_x_sv;
+  for (auto &x : poly_x) {
+    x.resize(kBnByteSize);
+    prg.Fill(absl::MakeSpan(x.data(), kBnByteSize));
+    poly_x_sv.push_back(x);
+  }
+
+  std::vector<std::string> eval_y =
+      EvalPolynomial(coeff, poly_x_sv, prime_data);
+  ASSERT_EQ(eval_y.size(), poly_x.size());
+  for (size_t i = 0; i < poly_x.size(); ++i) {
+    EXPECT_EQ(eval_y[i], EvalPolynomial(coeff, poly_x[i], prime_data));
+  }
+}
+
+TEST(PrimeFieldTest, Works) {
+  std::string prime_data = absl::HexStringToBytes(kPrimeOver256bHexStr);
+  ASSERT_TRUE(PrimeField::IsSupported(prime_data));
+  EXPECT_FALSE(PrimeField::IsSupported(std::string(64, '\xff')));
+  PrimeField field(prime_data);
+
+  std::random_device rd;
+  yacl::Prg<uint64_t> prg(rd());
+  std::vector<PrimeField::Element> elements(100);
+  for (auto &e : elements) {
+    std::string bytes(kBnByteSize, '\0');
+    prg.Fill(absl::MakeSpan(bytes.data(), kBnByteSize));
+    e = field.FromBytes(bytes);
+    EXPECT_EQ(field.ToBytes(e, kBnByteSize), bytes);
+    EXPECT_EQ(field.Mul(e, field.Inv(e)), field.One());
+    EXPECT_EQ(field.Add(e, field.Neg(e)), field.Zero());
+  }
+  // p reduces to 0, and p + 1 to 1.
+  EXPECT_EQ(field.FromBytes(prime_data), field.Zero());
+  std::string prime_plus_one = prime_data;
+  prime_plus_one.back()++;
+  EXPECT_EQ(field.FromBytes(prime_plus_one), field.One());
+
+  std::vector<PrimeField::Element> inverses = elements;
+  inverses.push_back(field.Zero());
+  field.BatchInv(&inverses);
+  for (size_t i = 0; i < elements.size(); ++i) {
+    EXPECT_EQ(inverses[i], field.Inv(elements[i]));
+  }
+  EXPECT_EQ(inverses.back(), field.Zero());
+
+  PrimeField::WideElement acc{};
+  PrimeField::Element expected = field.Zero();
+  for (size_t i = 0; i + 1 < elements.size(); ++i) {
+    PrimeField::MulAcc(&acc, elements[i], elements[i + 1]);
+    expected = field.Add(expected, field.Mul(elements[i], elements[i + 1]));
+  }
+  EXPECT_EQ(field.Reduce(acc), expected);
+}
+
 }  // namespace spu::psi
@@ -0,0 +1,341 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/core/polynomial/prime_field.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "openssl/bn.h"
+#include "yacl/base/exception.h"
+#include "yacl/base/int128.h"
+
+namespace spu::psi {
+
+namespace {
+
+constexpr size_t kElementBytes = PrimeField::kLimbs * sizeof(uint64_t);
+
+class BNDeleter {
+ public:
+  void operator()(BIGNUM *bn) { BN_free(bn); }
+};
+typedef std::unique_ptr<BIGNUM, BNDeleter> BigNumPtr;
+
+class BNCtxDeleter {
+ public:
+  void operator()(BN_CTX *ctx) { BN_CTX_free(ctx); }
+};
+typedef std::unique_ptr<BN_CTX, BNCtxDeleter> BNCtxPtr;
+
+BigNumPtr GetBigNumPtr(std::string_view v) {
+  BIGNUM *bn = BN_bin2bn(reinterpret_cast<const uint8_t *>(v.data()),
+                         v.length(), nullptr);
+  YACL_ENFORCE(bn != nullptr);
+  return BigNumPtr(bn);
+}
+
+// big endian bytes of at most kElementBytes to limbs.
+PrimeField::Element BytesToLimbs(std::string_view bytes) {
+  YACL_ENFORCE(bytes.size() <= kElementBytes);
+  PrimeField::Element limbs{};
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    size_t shift = bytes.size() - 1 - i;
+    limbs[shift / 8] |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i]))
+                        << ((shift % 8) * 8);
+  }
+  return limbs;
+}
+
+PrimeField::Element BigNumToLimbs(const BIGNUM *bn) {
+  std::string bytes(kElementBytes, '\0');
+  YACL_ENFORCE(BN_bn2binpad(bn, reinterpret_cast<uint8_t *>(bytes.data()),
+                            bytes.size()) >= 0);
+  return BytesToLimbs(bytes);
+}
+
+// a >= b
+bool GreaterEqual(const PrimeField::Element &a,
+                  const PrimeField::Element &b) {
+  for (size_t i = PrimeField::kLimbs; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] > b[i];
+    }
+  }
+  return true;
+}
+
+// a -= b, and return the borrow.
+uint64_t SubInPlace(PrimeField::Element *a, const PrimeField::Element &b) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < PrimeField::kLimbs; ++i) {
+    uint128_t d = static_cast<uint128_t>((*a)[i]) - b[i] - borrow;
+    (*a)[i] = static_cast<uint64_t>(d);
+    borrow = static_cast<uint64_t>(d >> 64) & 1;
+  }
+  return borrow;
+}
+
+// a += b, and return the carry.
+uint64_t AddInPlace(PrimeField::Element *a, const PrimeField::Element &b) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < PrimeField::kLimbs; ++i) {
+    uint128_t s = static_cast<uint128_t>((*a)[i]) + b[i] + carry;
+    (*a)[i] = static_cast<uint64_t>(s);
+    carry = static_cast<uint64_t>(s >> 64);
+  }
+  return carry;
+}
+
+}  // namespace
+
+bool PrimeField::IsSupported(std::string_view p) {
+  BigNumPtr bn_p = GetBigNumPtr(p);
+  int bits = BN_num_bits(bn_p.get());
+  return BN_is_odd(bn_p.get()) && bits >= 2 &&
+         bits <= static_cast<int>(kMaxPrimeBits);
+}
+
+PrimeField::PrimeField(std::string_view p) {
+  YACL_ENFORCE(IsSupported(p), "unsupported prime of {} bytes", p.size());
+
+  BigNumPtr bn_p = GetBigNumPtr(p);
+  p_bytes_ = std::string(p);
+  byte_size_ = BN_num_bytes(bn_p.get());
+  p_ = BigNumToLimbs(bn_p.get());
+
+  // Newton iteration doubles the correct low bits of p[0]^-1 every round.
+  uint64_t inv = p_[0];
+  for (size_t i = 0; i < 6; ++i) {
+    inv *= 2 - p_[0] * inv;
+  }
+  p_inv_ = ~inv + 1;
+
+  BNCtxPtr bn_ctx(BN_CTX_new());
+  BigNumPtr r(BN_new());
+  BN_one(r.get());
+  BN_lshift(r.get(), r.get(), 64 * kLimbs);
+  BN_nnmod(r.get(), r.get(), bn_p.get(), bn_ctx.get());
+  one_ = BigNumToLimbs(r.get());
+
+  BN_mod_sqr(r.get(), r.get(), bn_p.get(), bn_ctx.get());
+  r2_ = BigNumToLimbs(r.get());
+
+  p_minus_2_ = p_;
+  Element two{};
+  two[0] = 2;
+  SubInPlace(&p_minus_2_, two);
+}
+
+PrimeField::Element PrimeField::MontMul(const Element &a,
+                                        const Element &b) const {
+  // CIOS montgomery multiplication, t = a * b * R^-1 mod p.
+  uint64_t t[kLimbs + 2] = {0};
+  for (size_t i = 0; i < kLimbs; ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < kLimbs; ++j) {
+      uint128_t s = static_cast<uint128_t>(a[j]) * b[i] + t[j] + carry;
+      t[j] = static_cast<uint64_t>(s);
+      carry = static_cast<uint64_t>(s >> 64);
+    }
+    uint128_t s = static_cast<uint128_t>(t[kLimbs]) + carry;
+    t[kLimbs] = static_cast<uint64_t>(s);
+    t[kLimbs + 1] = static_cast<uint64_t>(s >> 64);
+
+    uint64_t m = t[0] * p_inv_;
+    s = static_cast<uint128_t>(m) * p_[0] + t[0];
+    carry = static_cast<uint64_t>(s >> 64);
+    for (size_t j = 1; j < kLimbs; ++j) {
+      s = static_cast<uint128_t>(m) * p_[j] + t[j] + carry;
+      t[j - 1] = static_cast<uint64_t>(s);
+      carry = static_cast<uint64_t>(s >> 64);
+    }
+    s = static_cast<uint128_t>(t[kLimbs]) + carry;
+    t[kLimbs - 1] = static_cast<uint64_t>(s);
+    t[kLimbs] = t[kLimbs + 1] + static_cast<uint64_t>(s >> 64);
+  }
+
+  Element res;
+  std::copy(t, t + kLimbs, res.begin());
+  if (t[kLimbs] != 0 || GreaterEqual(res, p_)) {
+    SubInPlace(&res, p_);
+  }
+  return res;
+}
+
+PrimeField::Element PrimeField::FromBytes(std::string_view bytes) const {
+  Element x{};
+  bool reduced = false;
+  if (bytes.size() <= kElementBytes) {
+    x = BytesToLimbs(bytes);
+    reduced = !GreaterEqual(x, p_);
+  }
+  if (!reduced) {
+    // inputs not below the prime are rare, and reduced by BIGNUM.
+    BNCtxPtr bn_ctx(BN_CTX_new());
+    BigNumPtr bn_x = GetBigNumPtr(bytes);
+    BigNumPtr bn_p = GetBigNumPtr(p_bytes_);
+    BN_nnmod(bn_x.get(), bn_x.get(), bn_p.get(), bn_ctx.get());
+    x = BigNumToLimbs(bn_x.get());
+  }
+  return MontMul(x, r2_);
+}
+
+PrimeField::Element PrimeField::FromUint64(uint64_t v) const {
+  std::string bytes(sizeof(uint64_t), '\0');
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    bytes[sizeof(uint64_t) - 1 - i] = static_cast<char>(v >> (i * 8));
+  }
+  return FromBytes(bytes);
+}
+
+std::string PrimeField::ToBytes(const Element &a, size_t min_len) const {
+  Element unit{};
+  unit[0] = 1;
+  Element x = MontMul(a, unit);
+
+  std::string bytes(kElementBytes, '\0');
+  for (size_t i = 0; i < kElementBytes; ++i) {
+    size_t shift = kElementBytes - 1 - i;
+    bytes[i] = static_cast<char>(x[shift / 8] >> ((shift % 8) * 8));
+  }
+  size_t num_bytes = kElementBytes;
+  while (num_bytes > 0 && bytes[kElementBytes - num_bytes] == '\0') {
+    num_bytes--;
+  }
+
+  size_t len = std::max(num_bytes, min_len);
+  if (len <= kElementBytes) {
+    return bytes.substr(kElementBytes - len);
+  }
+  return std::string(len - kElementBytes, '\0') + bytes;
+}
+
+PrimeField::Element PrimeField::Add(const Element &a, const Element &b) const {
+  Element res = a;
+  AddInPlace(&res, b);
+  // a + b < 2p < R, so there is no carry out.
+  if (GreaterEqual(res, p_)) {
+    SubInPlace(&res, p_);
+  }
+  return res;
+}
+
+PrimeField::Element PrimeField::Sub(const Element &a, const Element &b) const {
+  Element res = a;
+  if (SubInPlace(&res, b) != 0) {
+    AddInPlace(&res, p_);
+  }
+  return res;
+}
+
+PrimeField::Element PrimeField::Mul(const Element &a, const Element &b) const {
+  return MontMul(a, b);
+}
+
+void PrimeField::MulAcc(WideElement *acc, const Element &a,
+                        const Element &b) {
+  uint64_t prod[2 * kLimbs] = {0};
+  for (size_t i = 0; i < kLimbs; ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < kLimbs; ++j) {
+      uint128_t s = static_cast<uint128_t>(a[j]) * b[i] + prod[i + j] + carry;
+      prod[i + j] = static_cast<uint64_t>(s);
+      carry = static_cast<uint64_t>(s >> 64);
+    }
+    prod[i + kLimbs] = carry;
+  }
+
+  uint64_t carry = 0;
+  for (size_t k = 0; k < 2 * kLimbs; ++k) {
+    uint128_t s = static_cast<uint128_t>((*acc)[k]) + prod[k] + carry;
+    (*acc)[k] = static_cast<uint64_t>(s);
+    carry = static_cast<uint64_t>(s >> 64);
+  }
+  (*acc)[2 * kLimbs] += carry;
+}
+
+PrimeField::Element PrimeField::Reduce(const WideElement &acc) const {
+  // montgomery reduction, t = acc * R^-1 mod p, as the products are of
+  // elements in montgomery form.
+  WideElement t = acc;
+  for (size_t i = 0; i < kLimbs; ++i) {
+    uint64_t m = t[i] * p_inv_;
+    uint64_t carry = 0;
+    for (size_t j = 0; j < kLimbs; ++j) {
+      uint128_t s = static_cast<uint128_t>(m) * p_[j] + t[i + j] + carry;
+      t[i + j] = static_cast<uint64_t>(s);
+      carry = static_cast<uint64_t>(s >> 64);
+    }
+    for (size_t k = i + kLimbs; carry != 0 && k < t.size(); ++k) {
+      uint128_t s = static_cast<uint128_t>(t[k]) + carry;
+      t[k] = static_cast<uint64_t>(s);
+      carry = static_cast<uint64_t>(s >> 64);
+    }
+  }
+
+  // acc < 2^32 * p^2 and p < R / 2^32, so the result is below 2p.
+  Element res;
+  std::copy(t.begin() + kLimbs, t.begin() + 2 * kLimbs, res.begin());
+  if (t[2 * kLimbs] != 0 || GreaterEqual(res, p_)) {
+    SubInPlace(&res, p_);
+  }
+  return res;
+}
+
+PrimeField::Element PrimeField::Inv(const Element &a) const {
+  if (IsZero(a)) {
+    return a;
+  }
+  // a^(p-2) by fermat's little theorem.
+  Element res = one_;
+  for (size_t i = kLimbs; i-- > 0;) {
+    for (size_t bit = 64; bit-- > 0;) {
+      res = MontMul(res, res);
+      if ((p_minus_2_[i] >> bit) & 1) {
+        res = MontMul(res, a);
+      }
+    }
+  }
+  return res;
+}
+
+void PrimeField::BatchInv(std::vector<Element> *elements) const {
+  // prefix[i] is the product of the non zero elements before i.
+  std::vector<Element> prefix(elements->size());
+  Element acc = one_;
+  for (size_t i = 0; i < elements->size(); ++i) {
+    prefix[i] = acc;
+    if (!IsZero((*elements)[i])) {
+      acc = MontMul(acc, (*elements)[i]);
+    }
+  }
+
+  Element acc_inv = Inv(acc);
+  for (size_t i = elements->size(); i-- > 0;) {
+    Element &e = (*elements)[i];
+    if (IsZero(e)) {
+      continue;
+    }
+    Element e_inv = MontMul(acc_inv, prefix[i]);
+    acc_inv = MontMul(acc_inv, e);
+    e = e_inv;
+  }
+}
+
+bool PrimeField::IsZero(const Element &a) {
+  return std::all_of(a.begin(), a.end(), [](uint64_t v) { return v == 0; });
+}
+
+}  // namespace spu::psi
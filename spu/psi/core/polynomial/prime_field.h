@@ -0,0 +1,96 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace spu::psi {
+
+// Arithmetic of a prime field with fixed width elements, used for the
+// polynomials of mini psi instead of openssl BIGNUM.
+//
+// Elements are kLimbs little endian 64 bit limbs in montgomery form, so a
+// multiplication is a CIOS montgomery product without any allocation. The
+// prime should be odd and of at most kMaxPrimeBits bits, which holds the 257
+// bit prime of mini psi.
+class PrimeField {
+ public:
+  static constexpr size_t kLimbs = 5;
+  // leave room for 2^32 products in a WideElement.
+  static constexpr size_t kMaxPrimeBits = 64 * kLimbs - 32;
+
+  using Element = std::array<uint64_t, kLimbs>;
+
+  // Unreduced sum of products, to reduce once for an inner product.
+  using WideElement = std::array<uint64_t, 2 * kLimbs + 1>;
+
+  // `p` is the big endian bytes of the prime.
+  explicit PrimeField(std::string_view p);
+
+  // Whether the prime of big endian bytes `p` is supported.
+  static bool IsSupported(std::string_view p);
+
+  // Number of bytes of the prime.
+  size_t ByteSize() const { return byte_size_; }
+
+  Element Zero() const { return Element{}; }
+  const Element &One() const { return one_; }
+
+  // From big endian bytes of any length, reduced mod p.
+  Element FromBytes(std::string_view bytes) const;
+  Element FromUint64(uint64_t v) const;
+
+  // To big endian bytes of max(min_len, bytes of the value).
+  std::string ToBytes(const Element &a, size_t min_len = 0) const;
+
+  Element Add(const Element &a, const Element &b) const;
+  Element Sub(const Element &a, const Element &b) const;
+  Element Neg(const Element &a) const { return Sub(Zero(), a); }
+  Element Mul(const Element &a, const Element &b) const;
+
+  // acc += a * b without reduction. At most 2^32 products could be added
+  // before Reduce.
+  static void MulAcc(WideElement *acc, const Element &a, const Element &b);
+  Element Reduce(const WideElement &acc) const;
+
+  // Zero has no inverse, and is returned as is.
+  Element Inv(const Element &a) const;
+
+  // Invert all elements with one inversion, zeros are left as is.
+  void BatchInv(std::vector<Element> *elements) const;
+
+  static bool IsZero(const Element &a);
+
+ private:
+  Element MontMul(const Element &a, const Element &b) const;
+
+  std::string p_bytes_;
+  Element p_;
+  // -p^-1 mod 2^64
+  uint64_t p_inv_;
+  // R^2 mod p, with R = 2^(64 * kLimbs)
+  Element r2_;
+  // R mod p
+  Element one_;
+  // p - 2, the exponent of inversion
+  Element p_minus_2_;
+  size_t byte_size_;
+};
+
+}  // namespace spu::psi
@@ -15,6 +15,8 @@
 #include "spu/psi/cryptor/cryptor_selector.h"
 
 #include <cstdlib>
+#include <mutex>
+#include <unordered_map>
 
 #include "spdlog/spdlog.h"
 
@@ -64,10 +66,54 @@ std::unique_ptr<IEccCryptor> GetFourQCryptor() {
 #endif
   return {};
 }
+
+struct FactoryRegistry {
+  std::mutex mutex;
+  std::unordered_map<int, EccCryptorFactory> factories;
+};
+
+FactoryRegistry& GetFactoryRegistry() {
+  static FactoryRegistry registry;
+  return registry;
+}
+
+std::unique_ptr<IEccCryptor> GetRegisteredCryptor(CurveType type) {
+  EccCryptorFactory factory;
+  {
+    auto& registry = GetFactoryRegistry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    auto iter = registry.factories.find(static_cast<int>(type));
+    if (iter == registry.factories.end()) {
+      return {};
+    }
+    factory = iter->second;
+  }
+  auto cryptor = factory();
+  if (cryptor != nullptr) {
+    SPDLOG_INFO("Using registered cryptor of curve={}", type);
+  }
+  return cryptor;
+}
 }  // namespace
 
+void RegisterEccCryptorFactory(CurveType type, EccCryptorFactory factory) {
+  YACL_ENFORCE(factory != nullptr, "factory should not be empty");
+  auto& registry = GetFactoryRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  registry.factories[static_cast<int>(type)] = std::move(factory);
+}
+
+void UnregisterEccCryptorFactory(CurveType type) {
+  auto& registry = GetFactoryRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  registry.factories.erase(static_cast<int>(type));
+}
+
 std::unique_ptr<IEccCryptor> CreateEccCryptor(CurveType type) {
-  std::unique_ptr<IEccCryptor> cryptor;
+  std::unique_ptr<IEccCryptor> cryptor = GetRegisteredCryptor(type);
+  if (cryptor != nullptr) {
+    return cryptor;
+  }
   switch (type) {
     case CurveType::CURVE_25519: {
       cryptor = GetIppCryptor();
@@ -14,12 +14,24 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "spu/psi/cryptor/ecc_cryptor.h"
 
 namespace spu::psi {
 
+using EccCryptorFactory = std::function<std::unique_ptr<IEccCryptor>()>;
+
+// Register an accelerated backend of a curve, e.g. a GPU or FPGA one which is
+// built with its own toolchain and linked in. The registered factory is tried
+// before the built-in backends, it could return nullptr when the device is not
+// available to fall back to them. Registering again replaces the previous one.
+void RegisterEccCryptorFactory(CurveType type, EccCryptorFactory factory);
+
+// Remove the registered backend of a curve.
+void UnregisterEccCryptorFactory(CurveType type);
+
 std::unique_ptr<IEccCryptor> CreateEccCryptor(CurveType type);
 
 }  // namespace spu::psi
@@ -0,0 +1,73 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/cryptor/cryptor_selector.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace spu::psi {
+
+namespace {
+
+// stands for an offloaded backend.
+class FakeEccCryptor : public IEccCryptor {
+ public:
+  void EccMask(absl::Span<const char> batch_points,
+               absl::Span<char> dest_points) const override {
+    std::memcpy(dest_points.data(), batch_points.data(), batch_points.size());
+  }
+
+  CurveType GetCurveType() const override { return CurveType::CURVE_25519; }
+};
+
+}  // namespace
+
+TEST(CryptorSelectorTest, RegisteredFactory) {
+  EXPECT_EQ(dynamic_cast<FakeEccCryptor*>(
+                CreateEccCryptor(CurveType::CURVE_25519).get()),
+            nullptr);
+
+  bool available = true;
+  RegisterEccCryptorFactory(
+      CurveType::CURVE_25519, [&]() -> std::unique_ptr<IEccCryptor> {
+        if (!available) {
+          return nullptr;
+        }
+        return std::make_unique<FakeEccCryptor>();
+      });
+
+  EXPECT_NE(dynamic_cast<FakeEccCryptor*>(
+                CreateEccCryptor(CurveType::CURVE_25519).get()),
+            nullptr);
+  // other curves are not affected.
+  EXPECT_EQ(dynamic_cast<FakeEccCryptor*>(
+                CreateEccCryptor(CurveType::CURVE_SM2).get()),
+            nullptr);
+
+  // fall back to the built-in backends.
+  available = false;
+  auto cryptor = CreateEccCryptor(CurveType::CURVE_25519);
+  EXPECT_NE(cryptor, nullptr);
+  EXPECT_EQ(dynamic_cast<FakeEccCryptor*>(cryptor.get()), nullptr);
+
+  available = true;
+  UnregisterEccCryptorFactory(CurveType::CURVE_25519);
+  EXPECT_EQ(dynamic_cast<FakeEccCryptor*>(
+                CreateEccCryptor(CurveType::CURVE_25519).get()),
+            nullptr);
+}
+
+}  // namespace spu::psi
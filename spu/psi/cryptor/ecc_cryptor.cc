@@ -14,6 +14,7 @@
 
 #include "spu/psi/cryptor/ecc_cryptor.h"
 
+#include "absl/strings/escaping.h"
 #include "yacl/crypto/utils/hash_util.h"
 #include "yacl/utils/parallel.h"
 
@@ -67,6 +68,28 @@ std::vector<uint8_t> IEccCryptor::HashToCurve(
   return yacl::crypto::Sha256(input);
 }
 
+std::vector<std::string> IEccCryptor::BatchHashToCurve(
+    const std::vector<std::string>& inputs) const {
+  std::vector<std::string> ret(inputs.size());
+  yacl::parallel_for(0, inputs.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      std::vector<uint8_t> point = HashToCurve(inputs[idx]);
+      ret[idx].assign(reinterpret_cast<const char*>(point.data()),
+                      point.size());
+    }
+  });
+  return ret;
+}
+
+std::string IEccCryptor::GetKeyEpoch() const {
+  std::string buf = fmt::format("ecc-key-epoch:{}:", GetCurveType());
+  buf.append(reinterpret_cast<const char*>(private_key_), kEccKeySize);
+  auto digest = yacl::crypto::Sha256(buf);
+  OPENSSL_cleanse(buf.data(), buf.size());
+  return absl::BytesToHexString(absl::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
 std::vector<std::string> Mask(const std::shared_ptr<IEccCryptor>& cryptor,
                               const std::vector<std::string>& items) {
   std::string batch_points = CreateFlattenEccBuffer(
@@ -95,13 +118,7 @@ std::string HashInput(const std::shared_ptr<IEccCryptor>& cryptor,
 
 std::vector<std::string> HashInputs(const std::shared_ptr<IEccCryptor>& cryptor,
                                     const std::vector<std::string>& items) {
-  std::vector<std::string> ret(items.size());
-  yacl::parallel_for(0, items.size(), 1, [&](int64_t begin, int64_t end) {
-    for (int64_t idx = begin; idx < end; ++idx) {
-      ret[idx] = HashInput(cryptor, items[idx]);
-    }
-  });
-  return ret;
+  return cryptor->BatchHashToCurve(items);
 }
 
 }  // namespace spu::psi
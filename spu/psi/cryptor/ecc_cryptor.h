@@ -62,6 +62,16 @@ class IEccCryptor {
   // Perform hash on input
   virtual std::vector<uint8_t> HashToCurve(absl::Span<const char> input) const;
 
+  // Perform hash on a batch of inputs. The default calls HashToCurve for the
+  // inputs in parallel, and a cryptor could override it to share the setup
+  // of the curve across the batch.
+  virtual std::vector<std::string> BatchHashToCurve(
+      const std::vector<std::string>& inputs) const;
+
+  // A digest of the curve and the private key, which identifies the key
+  // without revealing it, e.g. to check cached masks are still valid.
+  std::string GetKeyEpoch() const;
+
  protected:
   uint8_t private_key_[kEccKeySize];
 };
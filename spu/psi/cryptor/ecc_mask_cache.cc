@@ -0,0 +1,167 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/cryptor/ecc_mask_cache.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+
+#include "spu/psi/io/io.h"
+
+namespace spu::psi {
+
+namespace {
+
+// file layout: magic | epoch | count | (point, mask) * count, where strings
+// are prefixed by their u32 size.
+constexpr char kMagic[] = "ECCMASK1";
+
+void AppendU64(std::string* buf, uint64_t value) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string* buf, std::string_view str) {
+  uint32_t size = str.size();
+  buf->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  buf->append(str.data(), str.size());
+}
+
+class Parser {
+ public:
+  explicit Parser(std::string_view data) : data_(data) {}
+
+  uint64_t ReadU64() {
+    uint64_t value;
+    std::memcpy(&value, Take(sizeof(value)).data(), sizeof(value));
+    return value;
+  }
+
+  std::string_view ReadString() {
+    uint32_t size;
+    std::memcpy(&size, Take(sizeof(size)).data(), sizeof(size));
+    return Take(size);
+  }
+
+  std::string_view Take(size_t size) {
+    YACL_ENFORCE(data_.size() >= size, "corrupted mask cache");
+    auto ret = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return ret;
+  }
+
+ private:
+  std::string_view data_;
+};
+
+}  // namespace
+
+std::unique_ptr<EccMaskCache> EccMaskCache::Load(const std::string& path,
+                                                 const std::string& epoch) {
+  auto cache = std::make_unique<EccMaskCache>(epoch);
+  if (!std::filesystem::exists(path)) {
+    return cache;
+  }
+
+  auto in = io::BuildInputStream(io::FileIoOptions(path));
+  std::string content(in->GetLength(), '\0');
+  in->Read(content.data(), content.size());
+  in->Close();
+
+  Parser parser(content);
+  YACL_ENFORCE(parser.Take(sizeof(kMagic) - 1) == kMagic,
+               "bad mask cache file={}", path);
+  if (parser.ReadString() != epoch) {
+    SPDLOG_WARN("discard mask cache of another key epoch, file={}", path);
+    return cache;
+  }
+  const uint64_t count = parser.ReadU64();
+  cache->masks_.reserve(count);
+  for (uint64_t idx = 0; idx < count; ++idx) {
+    std::string point(parser.ReadString());
+    cache->masks_.emplace(std::move(point), parser.ReadString());
+  }
+  SPDLOG_INFO("load mask cache file={}, size={}", path, count);
+  return cache;
+}
+
+void EccMaskCache::Save(const std::string& path) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::string buf(kMagic, sizeof(kMagic) - 1);
+  AppendString(&buf, epoch_);
+  AppendU64(&buf, masks_.size());
+  for (const auto& [point, mask] : masks_) {
+    AppendString(&buf, point);
+    AppendString(&buf, mask);
+  }
+
+  // write to a temp file then rename, an interrupted save keeps the old one.
+  const std::string tmp_path = path + ".tmp";
+  {
+    auto out = io::BuildOutputStream(io::FileIoOptions(tmp_path));
+    out->Write(buf.data(), buf.size());
+    out->Close();
+  }
+  std::filesystem::rename(tmp_path, path);
+}
+
+std::vector<std::string> EccMaskCache::Mask(
+    const std::shared_ptr<IEccCryptor>& cryptor,
+    const std::vector<std::string>& points) {
+  YACL_ENFORCE(cryptor->GetKeyEpoch() == epoch_,
+               "the cryptor key does not match the mask cache");
+
+  std::vector<std::string> ret(points.size());
+  std::vector<size_t> miss_indices;
+  std::vector<std::string> miss_points;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (size_t idx = 0; idx < points.size(); ++idx) {
+      auto iter = masks_.find(points[idx]);
+      if (iter != masks_.end()) {
+        ret[idx] = iter->second;
+      } else {
+        miss_indices.push_back(idx);
+        miss_points.push_back(points[idx]);
+      }
+    }
+    stats_.hits += points.size() - miss_points.size();
+    stats_.misses += miss_points.size();
+  }
+  if (miss_points.empty()) {
+    return ret;
+  }
+
+  auto masked = ::spu::psi::Mask(cryptor, miss_points);
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (size_t i = 0; i < miss_indices.size(); ++i) {
+    ret[miss_indices[i]] = masked[i];
+    masks_.emplace(std::move(miss_points[i]), std::move(masked[i]));
+  }
+  return ret;
+}
+
+size_t EccMaskCache::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return masks_.size();
+}
+
+EccMaskCache::Stats EccMaskCache::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,68 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+#include "spu/psi/cryptor/ecc_cryptor.h"
+
+namespace spu::psi {
+
+/// Memoize `Mask` of one private key, so the points of unchanged items are not
+/// masked again by the next runs with the same key.
+//
+// The cache could be persisted and is bound to the key epoch of the cryptor,
+// see `IEccCryptor::GetKeyEpoch`.
+class EccMaskCache {
+ public:
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+  };
+
+  explicit EccMaskCache(std::string epoch) : epoch_(std::move(epoch)) {}
+
+  // Load a saved cache, it's empty if the file does not exist or is saved
+  // under another epoch.
+  static std::unique_ptr<EccMaskCache> Load(const std::string& path,
+                                            const std::string& epoch);
+
+  void Save(const std::string& path) const;
+
+  const std::string& epoch() const { return epoch_; }
+
+  // Same as `Mask(cryptor, points)`, only the missed points are masked.
+  // Thread safe.
+  std::vector<std::string> Mask(const std::shared_ptr<IEccCryptor>& cryptor,
+                                const std::vector<std::string>& points);
+
+  size_t size() const;
+
+  Stats stats() const;
+
+ private:
+  const std::string epoch_;
+
+  mutable std::mutex mutex_;
+  absl::flat_hash_map<std::string, std::string> masks_;
+  Stats stats_;
+};
+
+}  // namespace spu::psi
@@ -0,0 +1,70 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/cryptor/ecc_mask_cache.h"
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+#include "spu/psi/cryptor/sodium_curve25519_cryptor.h"
+
+namespace spu::psi {
+
+namespace {
+
+std::vector<std::string> MakePoints(const std::shared_ptr<IEccCryptor>& cryptor,
+                                    size_t begin, size_t end) {
+  std::vector<std::string> items;
+  for (size_t idx = begin; idx < end; ++idx) {
+    items.push_back(std::to_string(idx));
+  }
+  return HashInputs(cryptor, items);
+}
+
+}  // namespace
+
+TEST(EccMaskCacheTest, Works) {
+  std::shared_ptr<IEccCryptor> cryptor =
+      std::make_shared<SodiumCurve25519Cryptor>();
+  auto path = std::filesystem::temp_directory_path() / "ecc-mask-cache-test";
+  std::filesystem::remove(path);
+
+  auto cache = EccMaskCache::Load(path, cryptor->GetKeyEpoch());
+  EXPECT_EQ(cache->size(), 0);
+
+  auto points = MakePoints(cryptor, 0, 100);
+  EXPECT_EQ(cache->Mask(cryptor, points), Mask(cryptor, points));
+  EXPECT_EQ(cache->stats().misses, 100);
+  cache->Save(path);
+
+  // the next run with the same key, 50 of 100 items are unchanged.
+  auto loaded = EccMaskCache::Load(path, cryptor->GetKeyEpoch());
+  EXPECT_EQ(loaded->size(), 100);
+  points = MakePoints(cryptor, 50, 150);
+  EXPECT_EQ(loaded->Mask(cryptor, points), Mask(cryptor, points));
+  EXPECT_EQ(loaded->stats().hits, 50);
+  EXPECT_EQ(loaded->stats().misses, 50);
+
+  // another key.
+  std::shared_ptr<IEccCryptor> other =
+      std::make_shared<SodiumCurve25519Cryptor>();
+  EXPECT_NE(other->GetKeyEpoch(), cryptor->GetKeyEpoch());
+  EXPECT_EQ(EccMaskCache::Load(path, other->GetKeyEpoch())->size(), 0);
+  EXPECT_THROW(loaded->Mask(other, points), yacl::EnforceNotMet);
+
+  std::filesystem::remove(path);
+}
+
+}  // namespace spu::psi
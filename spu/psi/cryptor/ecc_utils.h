@@ -21,6 +21,7 @@
 #include "absl/types/span.h"
 #include "openssl/bn.h"
 #include "openssl/ec.h"
+#include "openssl/opensslv.h"
 #include "yacl/crypto/utils/hash_util.h"
 #include "yacl/utils/parallel.h"
 
@@ -101,11 +102,15 @@ struct BigNumSt {
   }
 
   void FromBytes(absl::string_view bytes, const BigNumSt& p) {
-    BigNumSt bn_m(bytes);
     BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
 
-    YACL_ENFORCE(BN_nnmod(bn_ptr.get(), bn_m.get(), p.get(), bn_ctx.get()) ==
-                 1);
+    FromBytes(bytes, p, bn_ctx.get());
+  }
+
+  void FromBytes(absl::string_view bytes, const BigNumSt& p, BN_CTX* bn_ctx) {
+    BigNumSt bn_m(bytes);
+
+    YACL_ENFORCE(BN_nnmod(bn_ptr.get(), bn_m.get(), p.get(), bn_ctx) == 1);
   }
 
   BigNumSt Inverse(const BigNumSt& p) {
@@ -160,16 +165,23 @@ struct EcPointSt {
                                               const EcGroupSt& ec_group) {
     BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
 
+    return CreateEcPointByHashToCurve(m, ec_group, bn_ctx.get());
+  }
+
+  // Reuse `bn_ctx` to hash a batch of items.
+  static EcPointSt CreateEcPointByHashToCurve(absl::string_view m,
+                                              const EcGroupSt& ec_group,
+                                              BN_CTX* bn_ctx) {
     EcPointSt ec_point(ec_group);
 
     BigNumSt bn_x;
-    bn_x.FromBytes(m, ec_group.bn_p);
+    bn_x.FromBytes(m, ec_group.bn_p, bn_ctx);
 
     size_t counter = 0;
 
     while (true) {
       int ret = EC_POINT_set_compressed_coordinates(
-          ec_group.get(), ec_point.get(), bn_x.get(), 0, bn_ctx.get());
+          ec_group.get(), ec_point.get(), bn_x.get(), 0, bn_ctx);
 
       if (ret == 1) {
         break;
@@ -180,7 +192,7 @@ struct EcPointSt {
         // std::vector<uint8_t> hash = yacl::crypto::Sm3(bn_x_bytes);
         std::vector<uint8_t> hash = yacl::crypto::Sha256(bn_x_bytes);
         bn_x.FromBytes(absl::string_view((const char*)hash.data(), hash.size()),
-                       ec_group.bn_p);
+                       ec_group.bn_p, bn_ctx);
       }
       counter++;
       YACL_ENFORCE(counter < kHashToCurveCounterGuard,
@@ -226,6 +238,23 @@ struct EcPointSt {
     return length;
   }
 
+  // Write the compressed form to `bytes` of kEcPointCompressLength, reusing
+  // `bn_ctx`.
+  void ToBytes(absl::Span<uint8_t> bytes, BN_CTX* bn_ctx) const {
+    ToCompressedBytes(group_ref, point_ptr.get(), bytes, bn_ctx);
+  }
+
+  static void ToCompressedBytes(const EcGroupSt& group, const EC_POINT* point,
+                                absl::Span<uint8_t> bytes, BN_CTX* bn_ctx) {
+    YACL_ENFORCE(bytes.size() == kEcPointCompressLength, "{}!={}",
+                 bytes.size(), kEcPointCompressLength);
+    size_t length =
+        EC_POINT_point2oct(group.get(), point, POINT_CONVERSION_COMPRESSED,
+                           bytes.data(), bytes.size(), bn_ctx);
+    YACL_ENFORCE(length == kEcPointCompressLength, "{}!={}", length,
+                 kEcPointCompressLength);
+  }
+
   EcPointSt PointMul(const EcGroupSt& ec_group, const BigNumSt& bn_sk) {
     BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
     EcPointSt ec_point(ec_group);
@@ -253,4 +282,19 @@ struct EcPointSt {
   ECPointPtr point_ptr;
 };
 
+// Convert `points` to affine coordinates, with one field inversion for all.
+inline void MakeAffine(const EcGroupSt& ec_group,
+                       std::vector<EC_POINT*>* points, BN_CTX* bn_ctx) {
+// EC_POINTs_make_affine is deprecated by openssl 3.0 with no replacement.
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+  YACL_ENFORCE(EC_POINTs_make_affine(ec_group.get(), points->size(),
+                                     points->data(), bn_ctx) == 1);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#pragma GCC diagnostic pop
+#endif
+}
+
 }  // namespace spu::psi
@@ -61,9 +61,14 @@ void IppEccCryptor::EccMask(absl::Span<const char> batch_points,
   absl::Span<Item> output(reinterpret_cast<Item *>(dest_points.data()),
                           dest_points.size() / sizeof(Item));
 
-  yacl::parallel_for(0, input.size(), 8, [&](int64_t begin, int64_t end) {
-    for (int64_t idx = begin; idx < end; idx += 8) {
-      int64_t current_batch_size = std::min(int64_t(8), end - begin);
+  // split by whole groups of 8 lanes, only the last group could be partial.
+  constexpr int64_t kLanes = 8;
+  const int64_t num_groups = (input.size() + kLanes - 1) / kLanes;
+  yacl::parallel_for(0, num_groups, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t group = begin; group < end; ++group) {
+      const int64_t idx = group * kLanes;
+      const int64_t current_batch_size =
+          std::min(kLanes, static_cast<int64_t>(input.size()) - idx);
       mask_functor(input.subspan(idx, current_batch_size),
                    output.subspan(idx, current_batch_size));
     }
@@ -14,6 +14,9 @@
 
 #include "spu/psi/cryptor/sm2_cryptor.h"
 
+#include <algorithm>
+#include <string>
+
 #include "absl/types/span.h"
 #include "openssl/bn.h"
 #include "openssl/ec.h"
@@ -24,47 +27,71 @@
 
 namespace spu::psi {
 
+namespace {
+
+// Masked points are converted to affine coordinates by batches of it, with
+// one field inversion per batch instead of one per point.
+constexpr int64_t kAffineBatchSize = 256;
+
+}  // namespace
+
 void Sm2Cryptor::EccMask(absl::Span<const char> batch_points,
                          absl::Span<char> dest_points) const {
   YACL_ENFORCE(batch_points.size() % kEcPointCompressLength == 0, "{} % {}!=0",
                batch_points.size(), kEcPointCompressLength);
+  YACL_ENFORCE(dest_points.size() == batch_points.size(), "{}!={}",
+               dest_points.size(), batch_points.size());
 
-  using Item = std::array<char, kEcPointCompressLength>;
-  static_assert(sizeof(Item) == kEcPointCompressLength);
+  const int64_t num_points = batch_points.size() / kEcPointCompressLength;
 
-  auto mask_functor = [this](const Item& in, Item& out) {
+  yacl::parallel_for(0, num_points, 1, [&](int64_t begin, int64_t end) {
+    // the curve, the key and the scratch points are set up once for a range.
     BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
 
     EcGroupSt ec_group(ec_group_nid_);
 
-    EcPointSt ec_point(ec_group);
-
-    EC_POINT_oct2point(ec_group.get(), ec_point.get(),
-                       (const unsigned char*)in.data(), in.size(),
-                       bn_ctx.get());
-
     BigNumSt bn_sk;
     bn_sk.FromBytes(
         absl::string_view((const char*)&this->private_key_[0], kEccKeySize),
-        ec_group.bn_p);
-
-    // pointmul
-
-    EcPointSt ec_point2 = ec_point.PointMul(ec_group, bn_sk);
+        ec_group.bn_p, bn_ctx.get());
 
-    ec_point2.ToBytes(
-        absl::MakeSpan(reinterpret_cast<uint8_t*>(out.data()), out.size()));
-  };
-
-  absl::Span<const Item> input(
-      reinterpret_cast<const Item*>(batch_points.data()),
-      batch_points.size() / sizeof(Item));
-  absl::Span<Item> output(reinterpret_cast<Item*>(dest_points.data()),
-                          dest_points.size() / sizeof(Item));
+    EcPointSt ec_point(ec_group);
+    std::vector<ECPointPtr> masked_points(
+        std::min(kAffineBatchSize, end - begin));
+    std::vector<EC_POINT*> masked_point_ptrs;
+    for (auto& masked_point : masked_points) {
+      masked_point.reset(yacl::CheckNotNull(EC_POINT_new(ec_group.get())));
+    }
 
-  yacl::parallel_for(0, input.size(), 1, [&](int64_t begin, int64_t end) {
-    for (int64_t idx = begin; idx < end; ++idx) {
-      mask_functor(input[idx], output[idx]);
+    for (int64_t batch_begin = begin; batch_begin < end;
+         batch_begin += kAffineBatchSize) {
+      const int64_t batch_size = std::min(kAffineBatchSize, end - batch_begin);
+
+      masked_point_ptrs.clear();
+      for (int64_t i = 0; i < batch_size; ++i) {
+        const auto* in = reinterpret_cast<const unsigned char*>(
+            &batch_points[(batch_begin + i) * kEcPointCompressLength]);
+        YACL_ENFORCE(EC_POINT_oct2point(ec_group.get(), ec_point.get(), in,
+                                        kEcPointCompressLength,
+                                        bn_ctx.get()) == 1);
+
+        // pointmul, in projective coordinates.
+        EC_POINT* masked_point = masked_points[i].get();
+        YACL_ENFORCE(EC_POINT_mul(ec_group.get(), masked_point, nullptr,
+                                  ec_point.get(), bn_sk.get(),
+                                  bn_ctx.get()) == 1);
+        masked_point_ptrs.push_back(masked_point);
+      }
+
+      MakeAffine(ec_group, &masked_point_ptrs, bn_ctx.get());
+
+      for (int64_t i = 0; i < batch_size; ++i) {
+        auto* out = reinterpret_cast<uint8_t*>(
+            &dest_points[(batch_begin + i) * kEcPointCompressLength]);
+        EcPointSt::ToCompressedBytes(
+            ec_group, masked_point_ptrs[i],
+            absl::MakeSpan(out, kEcPointCompressLength), bn_ctx.get());
+      }
     }
   });
 }
@@ -85,4 +112,30 @@ std::vector<uint8_t> Sm2Cryptor::HashToCurve(
   return out;
 }
 
+std::vector<std::string> Sm2Cryptor::BatchHashToCurve(
+    const std::vector<std::string>& inputs) const {
+  std::vector<std::string> ret(inputs.size());
+
+  yacl::parallel_for(0, inputs.size(), 1, [&](int64_t begin, int64_t end) {
+    // the curve is set up once for a range, the points found by their
+    // compressed coordinates are affine already.
+    BnCtxPtr bn_ctx(yacl::CheckNotNull(BN_CTX_new()));
+
+    EcGroupSt ec_group(ec_group_nid_);
+
+    for (int64_t idx = begin; idx < end; ++idx) {
+      EcPointSt ec_point = EcPointSt::CreateEcPointByHashToCurve(
+          inputs[idx], ec_group, bn_ctx.get());
+
+      ret[idx].resize(kEcPointCompressLength);
+      ec_point.ToBytes(
+          absl::MakeSpan(reinterpret_cast<uint8_t*>(ret[idx].data()),
+                         kEcPointCompressLength),
+          bn_ctx.get());
+    }
+  });
+
+  return ret;
+}
+
 }  // namespace spu::psi
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <random>
+#include <string>
 #include <vector>
 
 #include "openssl/evp.h"
@@ -46,6 +47,9 @@ class Sm2Cryptor : public IEccCryptor {
 
   std::vector<uint8_t> HashToCurve(absl::Span<const char> input) const override;
 
+  std::vector<std::string> BatchHashToCurve(
+      const std::vector<std::string>& inputs) const override;
+
   static int GetEcGroupId(CurveType type) {
     switch (type) {
       case CurveType::CURVE_SECP256K1:
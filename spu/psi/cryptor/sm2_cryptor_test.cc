@@ -92,6 +92,40 @@ TEST_P(Sm2CryptorTest, Works) {
   EXPECT_EQ(masked_ab, masked_ba);
 }
 
+TEST_P(Sm2CryptorTest, BatchMatchesSingle) {
+  auto params = GetParam();
+  // cross a few affine conversion batches.
+  size_t items_size = params.items_size * 7;
+  std::shared_ptr<Sm2Cryptor> sm2_cryptor =
+      std::make_shared<Sm2Cryptor>(params.type);
+
+  std::vector<std::string> items(items_size);
+  for (size_t idx = 0; idx < items_size; ++idx) {
+    items[idx] = std::to_string(idx);
+  }
+
+  std::vector<std::string> points = sm2_cryptor->BatchHashToCurve(items);
+  ASSERT_EQ(points.size(), items_size);
+
+  std::string batch_points;
+  for (size_t idx = 0; idx < items_size; ++idx) {
+    std::vector<uint8_t> point = sm2_cryptor->HashToCurve(items[idx]);
+    EXPECT_EQ(points[idx], std::string(point.begin(), point.end()));
+    batch_points.append(points[idx]);
+  }
+
+  std::string masked(batch_points.size(), '\0');
+  sm2_cryptor->EccMask(batch_points, absl::MakeSpan(masked));
+
+  const size_t mask_length = sm2_cryptor->GetMaskLength();
+  for (size_t idx = 0; idx < items_size; ++idx) {
+    std::string single_masked(mask_length, '\0');
+    sm2_cryptor->EccMask(absl::MakeSpan(points[idx]),
+                         absl::MakeSpan(single_masked));
+    EXPECT_EQ(masked.substr(idx * mask_length, mask_length), single_masked);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Works_Instances, Sm2CryptorTest,
     testing::Values(TestParams{1}, TestParams{10}, TestParams{50},
@@ -14,7 +14,15 @@
 
 #include "spu/psi/memory_psi.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+#include <tuple>
+
 #include "spdlog/spdlog.h"
+#include "yacl/crypto/utils/hash_util.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/psi/core/ecdh_psi.h"
 #include "spu/psi/operator/factory.h"
@@ -22,6 +30,56 @@
 
 namespace spu::psi {
 
+namespace {
+
+// inputs are hashed to digests of this size when digested.
+constexpr size_t kDigestSize = 16;
+
+using ItemDigest = std::array<uint8_t, kDigestSize>;
+
+// A digest and the index of its first item in inputs.
+struct DigestedItem {
+  ItemDigest digest;
+  size_t index;
+};
+
+// Shards are ranges of the 32-bit digest prefix, so the shards of sorted
+// digests are contiguous.
+size_t ShardOf(const ItemDigest& digest, size_t num_shards) {
+  uint32_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix = (prefix << 8) | digest[i];
+  }
+  return (static_cast<uint64_t>(prefix) * num_shards) >> 32;
+}
+
+// Digest and deduplicate `inputs`, sorted by digests.
+std::vector<DigestedItem> DigestItems(const std::vector<std::string>& inputs) {
+  std::vector<DigestedItem> items(inputs.size());
+  yacl::parallel_for(0, inputs.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; idx++) {
+      std::vector<uint8_t> hash = yacl::crypto::Blake3(inputs[idx]);
+      std::memcpy(items[idx].digest.data(), hash.data(), kDigestSize);
+      items[idx].index = idx;
+    }
+  });
+
+  std::sort(items.begin(), items.end(),
+            [](const DigestedItem& lhs, const DigestedItem& rhs) {
+              return std::tie(lhs.digest, lhs.index) <
+                     std::tie(rhs.digest, rhs.index);
+            });
+  auto last = std::unique(items.begin(), items.end(),
+                          [](const DigestedItem& lhs, const DigestedItem& rhs) {
+                            return lhs.digest == rhs.digest;
+                          });
+  items.erase(last, items.end());
+  items.shrink_to_fit();
+  return items;
+}
+
+}  // namespace
+
 MemoryPsi::MemoryPsi(MemoryPsiConfig config,
                      std::shared_ptr<yacl::link::Context> lctx)
     : config_(std::move(config)), lctx_(std::move(lctx)) {
@@ -32,6 +90,9 @@ void MemoryPsi::CheckOptions() const {
   // options sanity check.
   YACL_ENFORCE(config_.psi_type() != PsiType::INVALID_PSI_TYPE,
                "unsupported psi proto:{}", config_.psi_type());
+  YACL_ENFORCE(config_.psi_type() != PsiType::AUTO_PSI_2PC,
+               "psi proto:{} is only supported by bucket psi",
+               config_.psi_type());
 
   YACL_ENFORCE(
       static_cast<size_t>(config_.receiver_rank()) < lctx_->WorldSize(),
@@ -57,12 +118,104 @@ void MemoryPsi::CheckOptions() const {
   }
 }
 
+size_t MemoryPsi::NumShards() const {
+  if (config_.num_shards() > 1) {
+    return config_.num_shards();
+  }
+  return config_.digest_inputs() ? 1 : 0;
+}
+
 std::vector<std::string> MemoryPsi::Run(
     const std::vector<std::string>& inputs) {
+  const size_t num_shards = NumShards();
+  // parties must agree on the ingestion, or they join different items.
+  std::vector<size_t> num_shards_list = AllGatherItemsSize(lctx_, num_shards);
+  for (size_t idx = 0; idx < num_shards_list.size(); idx++) {
+    YACL_ENFORCE(num_shards_list[idx] == num_shards,
+                 "mismatched shards, rank={} has {}, rank={} has {}",
+                 lctx_->Rank(), num_shards, idx, num_shards_list[idx]);
+  }
+
+  if (num_shards == 0) {
+    return RunProtocol(lctx_, inputs);
+  }
+  return RunDigested(inputs, num_shards);
+}
+
+std::vector<std::string> MemoryPsi::RunDigested(
+    const std::vector<std::string>& inputs, size_t num_shards) {
+  std::vector<DigestedItem> items = DigestItems(inputs);
+  SPDLOG_INFO("psi protocol={}, digested {} inputs to {} items, shards={}",
+              config_.psi_type(), inputs.size(), items.size(), num_shards);
+
+  // shard s is items[shard_begins[s], shard_begins[s + 1]).
+  std::vector<size_t> shard_begins(num_shards + 1, items.size());
+  for (size_t shard = 0, idx = 0; shard < num_shards; shard++) {
+    while (idx < items.size() &&
+           ShardOf(items[idx].digest, num_shards) < shard) {
+      idx++;
+    }
+    shard_begins[shard] = idx;
+  }
+
+  auto run_shard = [&](const std::shared_ptr<yacl::link::Context>& lctx,
+                       size_t shard) {
+    const auto begin = items.begin() + shard_begins[shard];
+    const auto end = items.begin() + shard_begins[shard + 1];
+
+    std::vector<std::string> digests;
+    digests.reserve(end - begin);
+    for (auto it = begin; it != end; ++it) {
+      digests.emplace_back(reinterpret_cast<const char*>(it->digest.data()),
+                           kDigestSize);
+    }
+
+    std::vector<size_t> indices;
+    for (const auto& joined : RunProtocol(lctx, digests)) {
+      YACL_ENFORCE(joined.size() == kDigestSize);
+      DigestedItem key;
+      std::memcpy(key.digest.data(), joined.data(), kDigestSize);
+      auto it = std::lower_bound(
+          begin, end, key,
+          [](const DigestedItem& lhs, const DigestedItem& rhs) {
+            return lhs.digest < rhs.digest;
+          });
+      YACL_ENFORCE(it != end && it->digest == key.digest,
+                   "unknown joined digest of shard={}", shard);
+      indices.push_back(it->index);
+    }
+    return indices;
+  };
+
+  // links of shards are spawned in order, so the shards of parties match.
+  std::vector<std::future<std::vector<size_t>>> futures(num_shards);
+  for (size_t shard = 0; shard < num_shards; shard++) {
+    futures[shard] = std::async(std::launch::async, run_shard, lctx_->Spawn(),
+                                shard);
+  }
+
+  std::vector<size_t> indices;
+  for (auto& future : futures) {
+    auto shard_indices = future.get();
+    indices.insert(indices.end(), shard_indices.begin(), shard_indices.end());
+  }
+  std::sort(indices.begin(), indices.end());
+
+  std::vector<std::string> res;
+  res.reserve(indices.size());
+  for (size_t idx : indices) {
+    res.push_back(inputs[idx]);
+  }
+  return res;
+}
+
+std::vector<std::string> MemoryPsi::RunProtocol(
+    const std::shared_ptr<yacl::link::Context>& lctx,
+    const std::vector<std::string>& inputs) {
   std::vector<std::string> res;
   size_t min_inputs_size = inputs.size();
   std::vector<size_t> inputs_size_list =
-      AllGatherItemsSize(lctx_, inputs.size());
+      AllGatherItemsSize(lctx, inputs.size());
   for (size_t idx = 0; idx < inputs_size_list.size(); idx++) {
     SPDLOG_INFO("psi protocol={}, rank={}, inputs_size={}", config_.psi_type(),
                 idx, inputs_size_list[idx]);
@@ -77,10 +230,10 @@ std::vector<std::string> MemoryPsi::Run(
   }
 
   if (config_.psi_type() == PsiType::ECDH_PSI_2PC) {
-    res = EcdhPsi(inputs);
+    res = EcdhPsi(lctx, inputs);
   } else {
     res = OperatorFactory::GetInstance()
-              ->Create(config_, lctx_)
+              ->Create(config_, lctx)
               ->Run(inputs, config_.broadcast_result());
   }
 
@@ -88,6 +241,7 @@ std::vector<std::string> MemoryPsi::Run(
 }
 
 std::vector<std::string> MemoryPsi::EcdhPsi(
+    const std::shared_ptr<yacl::link::Context>& lctx,
     const std::vector<std::string>& inputs) {
   size_t target_rank = config_.receiver_rank();
   if (config_.broadcast_result()) {
@@ -95,9 +249,9 @@ std::vector<std::string> MemoryPsi::EcdhPsi(
   }
 
   if (config_.curve_type() != CurveType::CURVE_INVALID_TYPE) {
-    return RunEcdhPsi(lctx_, inputs, target_rank, config_.curve_type());
+    return RunEcdhPsi(lctx, inputs, target_rank, config_.curve_type());
   }
-  return RunEcdhPsi(lctx_, inputs, target_rank);
+  return RunEcdhPsi(lctx, inputs, target_rank);
 }
 
 }  // namespace spu::psi
@@ -36,7 +36,22 @@ class MemoryPsi {
  private:
   void CheckOptions() const;
 
-  std::vector<std::string> EcdhPsi(const std::vector<std::string>& inputs);
+  // The shards of the digested inputs, or 0 if inputs are not digested.
+  size_t NumShards() const;
+
+  // Run the protocol on `inputs` over `lctx`.
+  std::vector<std::string> RunProtocol(
+      const std::shared_ptr<yacl::link::Context>& lctx,
+      const std::vector<std::string>& inputs);
+
+  // Run the protocol on the deduplicated digests of `inputs` by
+  // `num_shards` shards in parallel, and map the joined digests back.
+  std::vector<std::string> RunDigested(const std::vector<std::string>& inputs,
+                                       size_t num_shards);
+
+  std::vector<std::string> EcdhPsi(
+      const std::shared_ptr<yacl::link::Context>& lctx,
+      const std::vector<std::string>& inputs);
 
  private:
   MemoryPsiConfig config_;
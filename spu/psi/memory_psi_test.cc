@@ -177,6 +177,56 @@ INSTANTIATE_TEST_SUITE_P(
         MemoryTaskTestParams{
             {20, 17, 14, 30, 35}, 11, spu::psi::PsiType::KKRT_PSI_NPC}));
 
+class MemoryDigestPsiTest
+    : public testing::TestWithParam<std::tuple<spu::psi::PsiType, size_t>> {};
+
+// Duplicated items are joined once, in the order of their first inputs.
+TEST_P(MemoryDigestPsiTest, Works) {
+  const auto psi_type = std::get<0>(GetParam());
+  const size_t num_shards = std::get<1>(GetParam());
+
+  std::vector<std::vector<std::string>> items(2);
+  for (size_t i = 0; i < 100; i++) {
+    items[0].push_back(std::to_string(i % 60));
+    items[1].push_back(std::to_string(99 - i));
+  }
+  std::vector<std::string> intersection;
+  for (size_t i = 0; i < 60; i++) {
+    intersection.push_back(std::to_string(i));
+  }
+
+  auto lctxs = yacl::link::test::SetupWorld(2);
+
+  auto proc = [&](int idx) -> std::vector<std::string> {
+    spu::psi::MemoryPsiConfig config;
+    config.set_psi_type(psi_type);
+    config.set_broadcast_result(true);
+    config.set_digest_inputs(true);
+    config.set_num_shards(num_shards);
+
+    MemoryPsi ctx(config, lctxs[idx]);
+
+    return ctx.Run(items[idx]);
+  };
+
+  std::vector<std::future<std::vector<std::string>>> f_links(2);
+  for (size_t i = 0; i < 2; i++) {
+    f_links[i] = std::async(proc, i);
+  }
+
+  EXPECT_EQ(f_links[0].get(), intersection);
+  auto results = f_links[1].get();
+  std::sort(results.begin(), results.end());
+  std::sort(intersection.begin(), intersection.end());
+  EXPECT_EQ(results, intersection);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Works_Instances, MemoryDigestPsiTest,
+    testing::Combine(testing::Values(spu::psi::PsiType::ECDH_PSI_2PC,
+                                     spu::psi::PsiType::KKRT_PSI_2PC),
+                     testing::Values(1, 4)));
+
 struct FailedTestParams {
   size_t party_num;
   size_t receiver_rank;
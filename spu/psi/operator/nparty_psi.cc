@@ -31,6 +31,9 @@
 
 namespace {
 constexpr size_t kSyncRecvWaitTimeoutMs = 60 * 60 * 1000;
+
+// the setup and round trips of a 2-party psi, in items.
+constexpr double kPsiFixedCost = 1 << 12;
 }  // namespace
 
 namespace spu::psi {
@@ -66,6 +69,100 @@ std::vector<std::string> NpartyPsiOperator::OnRun(
     return {};
   }
 
+  Topology topology = options_.topology;
+  if (topology == Topology::Auto) {
+    std::vector<size_t> party_sizes;
+    for (const auto& [item_size, rank] : party_size_rank_vec) {
+      party_sizes.push_back(item_size);
+    }
+    topology = SelectTopology(party_sizes);
+  }
+  SPDLOG_INFO("rank:{}, nparty psi topology:{}", options_.link_ctx->Rank(),
+              topology == Topology::Chain ? "chain" : "tree");
+
+  if (topology == Topology::Chain) {
+    return RunChain(inputs, party_size_rank_vec);
+  }
+  return RunTree(inputs, std::move(party_size_rank_vec));
+}
+
+double NpartyPsiOperator::EstimateCost(Topology topology,
+                                       const std::vector<size_t>& party_sizes) {
+  YACL_ENFORCE(topology != Topology::Auto);
+  if (topology == Topology::Chain) {
+    double cost = 0;
+    size_t intersection_size = party_sizes[0];
+    for (size_t idx = 1; idx < party_sizes.size(); ++idx) {
+      cost += kPsiFixedCost + intersection_size + party_sizes[idx];
+      intersection_size = std::min(intersection_size, party_sizes[idx]);
+    }
+    return cost;
+  }
+
+  // the pairs of GetPsiRank, the result is left at the lower index.
+  double cost = 0;
+  std::vector<size_t> sizes = party_sizes;
+  while (sizes.size() > 1) {
+    double round_cost = 0;
+    for (size_t idx = 0; idx < sizes.size() / 2; ++idx) {
+      size_t peer_idx = sizes.size() - 1 - idx;
+      round_cost = std::max<double>(round_cost, sizes[idx] + sizes[peer_idx]);
+      sizes[idx] = std::min(sizes[idx], sizes[peer_idx]);
+    }
+    cost += kPsiFixedCost + round_cost;
+    sizes.resize((sizes.size() + 1) / 2);
+  }
+  return cost;
+}
+
+NpartyPsiOperator::Topology NpartyPsiOperator::SelectTopology(
+    const std::vector<size_t>& party_sizes) {
+  return EstimateCost(Topology::Chain, party_sizes) <
+                 EstimateCost(Topology::Tree, party_sizes)
+             ? Topology::Chain
+             : Topology::Tree;
+}
+
+std::vector<std::string> NpartyPsiOperator::RunChain(
+    const std::vector<std::string>& inputs,
+    const std::vector<std::pair<size_t, size_t>>& party_size_rank_vec) {
+  const auto tag = "chain intersection size";
+  if (options_.link_ctx->Rank() == options_.master_rank) {
+    std::vector<std::string> intersection = inputs;
+    for (size_t idx = 1; idx < party_size_rank_vec.size(); ++idx) {
+      size_t peer_rank = party_size_rank_vec[idx].second;
+      // tell the peer to skip its psi once the intersection is empty.
+      options_.link_ctx->SendAsync(
+          peer_rank, utils::SerializeSize(intersection.size()), tag);
+      if (!intersection.empty()) {
+        intersection =
+            Run2PartyPsi(intersection, peer_rank, options_.master_rank);
+      }
+      SPDLOG_INFO("rank:{}, chain_idx:{}, peer_rank:{}, intersection:{}",
+                  options_.link_ctx->Rank(), idx, peer_rank,
+                  intersection.size());
+    }
+    yacl::link::Broadcast(options_.link_ctx, "finish", options_.master_rank,
+                          "send finish message");
+    std::sort(intersection.begin(), intersection.end());
+    return intersection;
+  }
+
+  yacl::link::RecvTimeoutGuard guard(options_.link_ctx,
+                                     kSyncRecvWaitTimeoutMs);
+  size_t master_size = utils::DeserializeSize(
+      options_.link_ctx->Recv(options_.master_rank, tag));
+  if (master_size != 0) {
+    Run2PartyPsi(inputs, options_.master_rank, options_.master_rank);
+  }
+  yacl::link::Broadcast(options_.link_ctx, {}, options_.master_rank,
+                        "recv finish message");
+  return {};
+}
+
+std::vector<std::string> NpartyPsiOperator::RunTree(
+    const std::vector<std::string>& inputs,
+    std::vector<std::pair<size_t, size_t>> party_size_rank_vec) {
   // std::log2(absl::bit_ceil( 00000000 )) = 0
   // std::log2(absl::bit_ceil( 00000001 )) = 0
   // std::log2(absl::bit_ceil( 00000010 )) = 1
@@ -38,12 +38,23 @@ namespace spu::psi {
 //              =======
 //           ||  0    1
 // 3rd round ||  <---->
+//
+// the disjoint pairs of a round run concurrently on their p2p links. Or in a
+// chain, the master runs 2-party psi with the others one by one in ascending
+// order of items size, each on the intersection so far. The topology is
+// chosen by a cost model of both on the item sizes gathered by all parties.
 class NpartyPsiOperator : public PsiBaseOperator {
  public:
   enum class PsiProtocol {
     Ecdh,
     Kkrt,
   };
+  enum class Topology {
+    // choose by EstimateCost.
+    Auto,
+    Chain,
+    Tree,
+  };
   struct Options {
     std::shared_ptr<yacl::link::Context> link_ctx;
 
@@ -53,8 +64,19 @@ class NpartyPsiOperator : public PsiBaseOperator {
 
     // for ecdh
     size_t batch_size = kEcdhPsiBatchSize;
+
+    Topology topology = Topology::Auto;
   };
 
+  // Estimated time of the topology in item units, with the 2-party psi cost
+  // linear in the items of both sides plus a fixed cost, the rounds of the
+  // tree in parallel and the intersection bound by the smaller set.
+  // `party_sizes` is of GetAllPartyItemSizeVec order, the master first.
+  static double EstimateCost(Topology topology,
+                             const std::vector<size_t>& party_sizes);
+
+  static Topology SelectTopology(const std::vector<size_t>& party_sizes);
+
   static Options ParseConfig(const MemoryPsiConfig& config,
                              const std::shared_ptr<yacl::link::Context>& lctx);
 
@@ -65,6 +87,14 @@ class NpartyPsiOperator : public PsiBaseOperator {
       const std::vector<std::string>& inputs) override final;
 
  private:
+  std::vector<std::string> RunTree(
+      const std::vector<std::string>& inputs,
+      std::vector<std::pair<size_t, size_t>> party_size_rank_vec);
+
+  std::vector<std::string> RunChain(
+      const std::vector<std::string>& inputs,
+      const std::vector<std::pair<size_t, size_t>>& party_size_rank_vec);
+
   std::vector<std::string> Run2PartyPsi(const std::vector<std::string>& items,
                                         size_t peer_rank, size_t target_rank);
 
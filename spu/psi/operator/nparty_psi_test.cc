@@ -36,6 +36,7 @@ struct NPartyTestParams {
   size_t intersection_size;
   NpartyPsiOperator::PsiProtocol psi_type =
       NpartyPsiOperator::PsiProtocol::Ecdh;
+  NpartyPsiOperator::Topology topology = NpartyPsiOperator::Topology::Auto;
 };
 
 std::vector<std::vector<std::string>> CreateNPartyItems(
@@ -84,6 +85,7 @@ TEST_P(NPartyPsiTest, Works) {
     opts.psi_proto = params.psi_type;
     opts.link_ctx = ctxs[idx];
     opts.master_rank = master_rank;
+    opts.topology = params.topology;
 
     NpartyPsiOperator op(opts);
 
@@ -128,6 +130,23 @@ INSTANTIATE_TEST_SUITE_P(
         NPartyTestParams{{20, 17, 14, 30, 35}, 0},   //
         //
         NPartyTestParams{{0, 0}, 0},
+        // chain and tree
+        NPartyTestParams{{20, 17, 14, 30, 35},
+                         11,
+                         NpartyPsiOperator::PsiProtocol::Ecdh,
+                         NpartyPsiOperator::Topology::Chain},  //
+        NPartyTestParams{{20, 17, 14, 30, 35},
+                         0,
+                         NpartyPsiOperator::PsiProtocol::Ecdh,
+                         NpartyPsiOperator::Topology::Chain},  //
+        NPartyTestParams{{20, 17, 14, 30},
+                         10,
+                         NpartyPsiOperator::PsiProtocol::Ecdh,
+                         NpartyPsiOperator::Topology::Tree},  //
+        NPartyTestParams{{20, 17, 14, 30},
+                         10,
+                         NpartyPsiOperator::PsiProtocol::Kkrt,
+                         NpartyPsiOperator::Topology::Chain},  //
         // kkrt
         NPartyTestParams{{0, 3}, 0, NpartyPsiOperator::PsiProtocol::Kkrt},  //
         NPartyTestParams{{3, 0}, 0, NpartyPsiOperator::PsiProtocol::Kkrt},  //
@@ -146,4 +165,26 @@ INSTANTIATE_TEST_SUITE_P(
         //
         NPartyTestParams{{0, 0}, 0, NpartyPsiOperator::PsiProtocol::Kkrt}));
 
-}  // namespace spu::psi
\ No newline at end of file
+TEST(NPartyPsiTopologyTest, SelectTopology) {
+  using Topology = NpartyPsiOperator::Topology;
+
+  // equal sizes, the 2 rounds of the tree against 3 psi of the chain.
+  EXPECT_EQ(NpartyPsiOperator::SelectTopology({1000, 1000, 1000, 1000}),
+            Topology::Tree);
+  // a tie goes to the tree.
+  EXPECT_EQ(NpartyPsiOperator::EstimateCost(Topology::Tree, {100, 100, 100}),
+            NpartyPsiOperator::EstimateCost(Topology::Chain, {100, 100, 100}));
+  EXPECT_EQ(NpartyPsiOperator::SelectTopology({100, 100, 100}),
+            Topology::Tree);
+
+  // a large master with a small peer, the chain shrinks the intersection
+  // before meeting the other large set, while the tree pairs the two large
+  // sets first.
+  EXPECT_EQ(NpartyPsiOperator::SelectTopology({1000000, 10, 1000000}),
+            Topology::Chain);
+  EXPECT_EQ(NpartyPsiOperator::SelectTopology(
+                {1000000, 10, 10, 1000, 10000, 100000, 1000000}),
+            Topology::Chain);
+}
+
+}  // namespace spu::psi
@@ -14,6 +14,7 @@
 
 #include "spu/psi/utils/batch_provider.h"
 
+#include "absl/strings/ascii.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -48,17 +49,10 @@ CsvBatchProvider::CsvBatchProvider(
 
 std::vector<std::string> CsvBatchProvider::ReadNextBatch(size_t batch_size) {
   std::vector<std::string> ret;
+  std::vector<std::string_view> fields;
   std::string line;
   while (in_->GetLine(&line)) {
-    std::vector<absl::string_view> tokens = absl::StrSplit(line, ',');
-    std::vector<absl::string_view> targets;
-    for (size_t fidx : analyzer_.target_indices()) {
-      YACL_ENFORCE(fidx < tokens.size(),
-                   "Illegal line due to no field at index={}, line={}", fidx,
-                   line);
-      targets.push_back(absl::StripAsciiWhitespace(tokens[fidx]));
-    }
-    ret.push_back(KeysJoin(targets));
+    ret.push_back(ExtractKeys(line, analyzer_.target_indices(), &fields));
     if (ret.size() == batch_size) {
       break;
     }
@@ -66,4 +60,116 @@ std::vector<std::string> CsvBatchProvider::ReadNextBatch(size_t batch_size) {
   return ret;
 }
 
+std::string CsvBatchProvider::ExtractKeys(
+    std::string_view line, const std::vector<size_t>& target_indices,
+    std::vector<std::string_view>* fields) {
+  size_t max_index = 0;
+  for (size_t fidx : target_indices) {
+    max_index = std::max(max_index, fidx);
+  }
+
+  fields->clear();
+  size_t begin = 0;
+  while (fields->size() <= max_index) {
+    size_t end = line.find(',', begin);
+    if (end == std::string_view::npos) {
+      fields->push_back(line.substr(begin));
+      break;
+    }
+    fields->push_back(line.substr(begin, end - begin));
+    begin = end + 1;
+  }
+
+  std::string ret;
+  for (size_t i = 0; i < target_indices.size(); ++i) {
+    const size_t fidx = target_indices[i];
+    YACL_ENFORCE(fidx < fields->size(),
+                 "Illegal line due to no field at index={}, line={}", fidx,
+                 line);
+    if (i > 0) {
+      ret.push_back('-');
+    }
+    auto field = absl::StripAsciiWhitespace((*fields)[fidx]);
+    ret.append(field.data(), field.size());
+  }
+  return ret;
+}
+
+PrefetchBatchProvider::PrefetchBatchProvider(
+    std::shared_ptr<IBatchProvider> provider, size_t prefetch_batch_size,
+    size_t queue_depth)
+    : provider_(std::move(provider)),
+      prefetch_batch_size_(prefetch_batch_size),
+      queue_depth_(queue_depth) {
+  YACL_ENFORCE(provider_ != nullptr);
+  YACL_ENFORCE(prefetch_batch_size_ > 0 && queue_depth_ > 0);
+  reader_ = std::thread([this]() { ReadLoop(); });
+}
+
+PrefetchBatchProvider::~PrefetchBatchProvider() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  reader_.join();
+}
+
+void PrefetchBatchProvider::ReadLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stopped_ || queue_.size() < queue_depth_; });
+      if (stopped_) {
+        return;
+      }
+    }
+
+    std::vector<std::string> batch;
+    std::exception_ptr error;
+    try {
+      batch = provider_->ReadNextBatch(prefetch_batch_size_);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (error != nullptr || batch.empty()) {
+      error_ = error;
+      end_of_stream_ = true;
+      cv_.notify_all();
+      return;
+    }
+    queue_.push_back(std::move(batch));
+    cv_.notify_all();
+  }
+}
+
+std::vector<std::string> PrefetchBatchProvider::ReadNextBatch(
+    size_t batch_size) {
+  std::vector<std::string> ret;
+  while (ret.size() < batch_size) {
+    if (current_pos_ == current_.size()) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return !queue_.empty() || end_of_stream_; });
+      if (queue_.empty()) {
+        if (error_ != nullptr) {
+          std::rethrow_exception(error_);
+        }
+        break;
+      }
+      current_ = std::move(queue_.front());
+      queue_.pop_front();
+      current_pos_ = 0;
+      cv_.notify_all();
+    }
+
+    size_t n = std::min(batch_size - ret.size(), current_.size() - current_pos_);
+    for (size_t i = 0; i < n; ++i) {
+      ret.push_back(std::move(current_[current_pos_++]));
+    }
+  }
+  return ret;
+}
+
 }  // namespace spu::psi
\ No newline at end of file
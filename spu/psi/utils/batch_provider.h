@@ -14,6 +14,16 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 #include "spu/psi/io/io.h"
 #include "spu/psi/utils/csv_header_analyzer.h"
 
@@ -50,10 +60,55 @@ class CsvBatchProvider : public IBatchProvider {
 
   std::vector<std::string> ReadNextBatch(size_t batch_size) override;
 
+  // Join the target fields of a csv line with "-", same as `KeysJoin` over
+  // the stripped tokens, in one scan which stops after the last target field.
+  static std::string ExtractKeys(std::string_view line,
+                                 const std::vector<size_t>& target_indices,
+                                 std::vector<std::string_view>* fields);
+
  private:
   const std::string path_;
   std::unique_ptr<io::InputStream> in_;
   CsvHeaderAnalyzer analyzer_;
 };
 
+/// Read batches of another provider ahead in a background thread.
+//
+// The reader keeps at most `queue_depth` batches of `prefetch_batch_size`
+// items, `ReadNextBatch` could ask for any size.
+class PrefetchBatchProvider : public IBatchProvider {
+ public:
+  explicit PrefetchBatchProvider(std::shared_ptr<IBatchProvider> provider,
+                                 size_t prefetch_batch_size,
+                                 size_t queue_depth = 2);
+
+  ~PrefetchBatchProvider() override;
+
+  PrefetchBatchProvider(const PrefetchBatchProvider&) = delete;
+  PrefetchBatchProvider& operator=(const PrefetchBatchProvider&) = delete;
+
+  // The exception of the underlying provider is rethrown here.
+  std::vector<std::string> ReadNextBatch(size_t batch_size) override;
+
+ private:
+  void ReadLoop();
+
+  const std::shared_ptr<IBatchProvider> provider_;
+  const size_t prefetch_batch_size_;
+  const size_t queue_depth_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::vector<std::string>> queue_;
+  bool end_of_stream_ = false;
+  bool stopped_ = false;
+  std::exception_ptr error_;
+
+  // the front batch being consumed.
+  std::vector<std::string> current_;
+  size_t current_pos_ = 0;
+
+  std::thread reader_;
+};
+
 }  // namespace spu::psi
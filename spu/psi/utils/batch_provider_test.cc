@@ -0,0 +1,85 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/batch_provider.h"
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+namespace {
+
+class FailingBatchProvider : public IBatchProvider {
+ public:
+  std::vector<std::string> ReadNextBatch(size_t batch_size) override {
+    if (count_++ == 2) {
+      YACL_THROW("read failed");
+    }
+    return std::vector<std::string>(batch_size, "x");
+  }
+
+ private:
+  size_t count_ = 0;
+};
+
+}  // namespace
+
+TEST(CsvBatchProviderTest, ExtractKeys) {
+  std::vector<std::string_view> fields;
+  EXPECT_EQ(CsvBatchProvider::ExtractKeys("a, b ,c,d", {2, 1}, &fields),
+            "c-b");
+  EXPECT_EQ(CsvBatchProvider::ExtractKeys("a,b,", {2}, &fields), "");
+  EXPECT_EQ(CsvBatchProvider::ExtractKeys("a,b,c", {0}, &fields), "a");
+  EXPECT_THROW(CsvBatchProvider::ExtractKeys("a,b", {2}, &fields),
+               yacl::EnforceNotMet);
+}
+
+TEST(PrefetchBatchProviderTest, Works) {
+  std::vector<std::string> items;
+  for (size_t idx = 0; idx < 1000; ++idx) {
+    items.push_back(std::to_string(idx));
+  }
+
+  // read sizes differ from the prefetch size.
+  PrefetchBatchProvider provider(std::make_shared<MemoryBatchProvider>(items),
+                                 64, 3);
+  std::vector<std::string> read;
+  while (true) {
+    auto batch = provider.ReadNextBatch(100);
+    if (batch.empty()) {
+      break;
+    }
+    EXPECT_LE(batch.size(), 100);
+    read.insert(read.end(), batch.begin(), batch.end());
+  }
+  EXPECT_EQ(read, items);
+  EXPECT_TRUE(provider.ReadNextBatch(100).empty());
+}
+
+TEST(PrefetchBatchProviderTest, Error) {
+  PrefetchBatchProvider provider(std::make_shared<FailingBatchProvider>(), 10);
+  EXPECT_EQ(provider.ReadNextBatch(15).size(), 15);
+  EXPECT_EQ(provider.ReadNextBatch(15).size(), 5);
+  EXPECT_THROW(provider.ReadNextBatch(15), yacl::EnforceNotMet);
+}
+
+TEST(PrefetchBatchProviderTest, StopEarly) {
+  std::vector<std::string> items(10000, "x");
+  PrefetchBatchProvider provider(std::make_shared<MemoryBatchProvider>(items),
+                                 10);
+  EXPECT_EQ(provider.ReadNextBatch(5).size(), 5);
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,140 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/bucket_checkpoint.h"
+
+#include <cstring>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+
+#include "spu/psi/io/io.h"
+
+namespace spu::psi {
+
+namespace {
+
+constexpr char kMetaFile[] = "meta";
+constexpr char kBucketPrefix[] = "bucket-";
+constexpr char kBucketSuffix[] = ".idx";
+
+std::string ReadFile(const std::filesystem::path& path) {
+  auto in = io::BuildInputStream(io::FileIoOptions(path.string()));
+  std::string ret(in->GetLength(), '\0');
+  in->Read(ret.data(), ret.size());
+  in->Close();
+  return ret;
+}
+
+// write to a temp file then rename, so the file is complete once it exists.
+void WriteFileAtomic(const std::filesystem::path& path,
+                     std::string_view content) {
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+  {
+    auto out = io::BuildOutputStream(io::FileIoOptions(tmp_path.string()));
+    out->Write(content.data(), content.size());
+    out->Close();
+  }
+  std::filesystem::rename(tmp_path, path);
+}
+
+}  // namespace
+
+BucketCheckpoint::BucketCheckpoint(const std::string& dir,
+                                   const std::string& fingerprint)
+    : dir_(dir) {
+  YACL_ENFORCE(!dir_.empty(), "checkpoint dir should not be empty");
+  auto meta_path = dir_ / kMetaFile;
+  if (std::filesystem::exists(meta_path) &&
+      ReadFile(meta_path) != fingerprint) {
+    SPDLOG_WARN("discard checkpoint of another job, dir={}", dir_.string());
+    std::filesystem::remove_all(dir_);
+  }
+  std::filesystem::create_directories(dir_);
+  if (!std::filesystem::exists(meta_path)) {
+    WriteFileAtomic(meta_path, fingerprint);
+  }
+
+  for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+    std::string_view name = entry.path().filename().native();
+    if (!absl::ConsumePrefix(&name, kBucketPrefix) ||
+        !absl::ConsumeSuffix(&name, kBucketSuffix)) {
+      continue;
+    }
+    size_t bucket_idx = 0;
+    if (absl::SimpleAtoi(name, &bucket_idx)) {
+      finished_.insert(bucket_idx);
+    }
+  }
+  SPDLOG_INFO("open checkpoint dir={}, finished_buckets={}", dir_.string(),
+              finished_.size());
+}
+
+std::filesystem::path BucketCheckpoint::BucketPath(size_t bucket_idx) const {
+  return dir_ / fmt::format("{}{}{}", kBucketPrefix, bucket_idx, kBucketSuffix);
+}
+
+std::vector<uint64_t> BucketCheckpoint::LoadIndices(size_t bucket_idx) const {
+  YACL_ENFORCE(finished_.count(bucket_idx) != 0,
+               "bucket={} is not in the checkpoint", bucket_idx);
+  auto content = ReadFile(BucketPath(bucket_idx));
+  YACL_ENFORCE(content.size() % sizeof(uint64_t) == 0,
+               "corrupted checkpoint of bucket={}, size={}", bucket_idx,
+               content.size());
+  std::vector<uint64_t> indices(content.size() / sizeof(uint64_t));
+  std::memcpy(indices.data(), content.data(), content.size());
+  return indices;
+}
+
+void BucketCheckpoint::Save(size_t bucket_idx,
+                            const std::vector<uint64_t>& indices) {
+  WriteFileAtomic(
+      BucketPath(bucket_idx),
+      std::string_view(reinterpret_cast<const char*>(indices.data()),
+                       indices.size() * sizeof(uint64_t)));
+  std::lock_guard<std::mutex> guard(mutex_);
+  finished_.insert(bucket_idx);
+}
+
+void BucketCheckpoint::Clear() {
+  std::error_code ec;
+  std::filesystem::remove_all(dir_, ec);
+  if (ec.value() != 0) {
+    SPDLOG_WARN("can not remove checkpoint dir: {}, msg: {}", dir_.string(),
+                ec.message());
+  }
+}
+
+std::string BucketCheckpoint::SerializeBuckets(
+    const std::set<size_t>& buckets) {
+  return absl::StrJoin(buckets, ",");
+}
+
+std::set<size_t> BucketCheckpoint::DeserializeBuckets(std::string_view data) {
+  std::set<size_t> ret;
+  for (auto token : absl::StrSplit(data, ',', absl::SkipEmpty())) {
+    size_t bucket_idx = 0;
+    YACL_ENFORCE(absl::SimpleAtoi(token, &bucket_idx), "bad bucket id={}",
+                 std::string(token));
+    ret.insert(bucket_idx);
+  }
+  return ret;
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,70 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace spu::psi {
+
+/// Persist the results of finished buckets, so a failed bucket psi job could
+/// resume from them.
+//
+// Layout of the checkpoint dir:
+//   meta                       the fingerprint of the job
+//   bucket-{idx}.idx           the result indices of a finished bucket
+//
+// A bucket file is written to a temp file and renamed, so it exists iff the
+// bucket is finished.
+class BucketCheckpoint {
+ public:
+  // Open the checkpoint under `dir`, an existing one of a different
+  // `fingerprint` is discarded.
+  BucketCheckpoint(const std::string& dir, const std::string& fingerprint);
+
+  BucketCheckpoint(const BucketCheckpoint&) = delete;
+  BucketCheckpoint& operator=(const BucketCheckpoint&) = delete;
+
+  // The buckets finished by the previous runs.
+  const std::set<size_t>& finished() const { return finished_; }
+
+  std::vector<uint64_t> LoadIndices(size_t bucket_idx) const;
+
+  // Persist the result of a bucket. Thread safe.
+  void Save(size_t bucket_idx, const std::vector<uint64_t>& indices);
+
+  // Remove the checkpoint after the job is done.
+  void Clear();
+
+  // Serialize bucket ids to sync with peers.
+  static std::string SerializeBuckets(const std::set<size_t>& buckets);
+  static std::set<size_t> DeserializeBuckets(std::string_view data);
+
+ private:
+  std::filesystem::path BucketPath(size_t bucket_idx) const;
+
+  const std::filesystem::path dir_;
+
+  std::set<size_t> finished_;
+
+  std::mutex mutex_;
+};
+
+}  // namespace spu::psi
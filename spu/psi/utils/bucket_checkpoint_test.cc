@@ -0,0 +1,60 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/bucket_checkpoint.h"
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+TEST(BucketCheckpointTest, Resume) {
+  auto dir = std::filesystem::temp_directory_path() / "bucket-checkpoint-test";
+  std::filesystem::remove_all(dir);
+
+  {
+    BucketCheckpoint checkpoint(dir, "job-a");
+    EXPECT_TRUE(checkpoint.finished().empty());
+    checkpoint.Save(3, {1, 5, 9});
+    checkpoint.Save(0, {});
+    EXPECT_EQ(checkpoint.finished(), std::set<size_t>({0, 3}));
+  }
+
+  {
+    // resumed by the same job.
+    BucketCheckpoint checkpoint(dir, "job-a");
+    EXPECT_EQ(checkpoint.finished(), std::set<size_t>({0, 3}));
+    EXPECT_EQ(checkpoint.LoadIndices(3), std::vector<uint64_t>({1, 5, 9}));
+    EXPECT_TRUE(checkpoint.LoadIndices(0).empty());
+    EXPECT_THROW(checkpoint.LoadIndices(1), yacl::EnforceNotMet);
+  }
+
+  {
+    // discarded by another job.
+    BucketCheckpoint checkpoint(dir, "job-b");
+    EXPECT_TRUE(checkpoint.finished().empty());
+    checkpoint.Clear();
+  }
+  EXPECT_FALSE(std::filesystem::exists(dir));
+}
+
+TEST(BucketCheckpointTest, SerializeBuckets) {
+  std::set<size_t> buckets = {0, 7, 1024};
+  EXPECT_EQ(BucketCheckpoint::DeserializeBuckets(
+                BucketCheckpoint::SerializeBuckets(buckets)),
+            buckets);
+  EXPECT_TRUE(BucketCheckpoint::DeserializeBuckets("").empty());
+}
+
+}  // namespace spu::psi
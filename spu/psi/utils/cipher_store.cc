@@ -14,12 +14,107 @@
 
 #include "spu/psi/utils/cipher_store.h"
 
+#include <cstring>
+#include <limits>
+#include <string_view>
 #include <unordered_set>
 
 #include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
 
 namespace spu::psi {
 
+namespace {
+
+// the leading (at most) 8 bytes of a ciphertext.
+uint64_t CipherKey(const char* cipher, size_t cipher_size) {
+  uint64_t key = 0;
+  std::memcpy(&key, cipher, std::min(cipher_size, sizeof(key)));
+  return key;
+}
+
+}  // namespace
+
+FlatCipherStore::FlatCipherStore(size_t cipher_size)
+    : cipher_size_(cipher_size) {
+  YACL_ENFORCE(cipher_size_ > 0);
+}
+
+void FlatCipherStore::SaveSelf(std::string ciphertext) {
+  YACL_ENFORCE(ciphertext.size() == cipher_size_,
+               "expect cipher size={}, got={}", cipher_size_,
+               ciphertext.size());
+  self_data_.append(ciphertext);
+}
+
+void FlatCipherStore::SavePeer(std::string ciphertext) {
+  YACL_ENFORCE(ciphertext.size() == cipher_size_,
+               "expect cipher size={}, got={}", cipher_size_,
+               ciphertext.size());
+  peer_data_.append(ciphertext);
+}
+
+std::vector<uint64_t> FlatCipherStore::ComputeIntersectionIndices() const {
+  const size_t num_peer = peer_count();
+  const size_t num_self = self_count();
+  if (num_peer == 0 || num_self == 0) {
+    return {};
+  }
+  YACL_ENFORCE(num_peer < std::numeric_limits<uint32_t>::max(),
+               "too many peer items={}", num_peer);
+
+  // slots hold peer index + 1, 0 is empty, the load factor is at most 1/2.
+  size_t num_slots = 1;
+  while (num_slots < 2 * num_peer) {
+    num_slots <<= 1;
+  }
+  const size_t mask = num_slots - 1;
+  std::vector<uint32_t> slots(num_slots, 0);
+  for (size_t idx = 0; idx < num_peer; ++idx) {
+    const char* cipher = peer_data_.data() + idx * cipher_size_;
+    size_t pos = CipherKey(cipher, cipher_size_) & mask;
+    while (slots[pos] != 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos] = static_cast<uint32_t>(idx + 1);
+  }
+
+  auto contains = [&](const char* cipher) {
+    size_t pos = CipherKey(cipher, cipher_size_) & mask;
+    while (slots[pos] != 0) {
+      const char* peer = peer_data_.data() + (slots[pos] - 1) * cipher_size_;
+      if (std::memcmp(peer, cipher, cipher_size_) == 0) {
+        return true;
+      }
+      pos = (pos + 1) & mask;
+    }
+    return false;
+  };
+
+  // chunks keep the ascending order.
+  constexpr int64_t kChunkSize = 1 << 16;
+  const int64_t num_chunks = (num_self + kChunkSize - 1) / kChunkSize;
+  std::vector<std::vector<uint64_t>> chunk_indices(num_chunks);
+  yacl::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; ++chunk) {
+      const size_t chunk_end =
+          std::min<size_t>(num_self, (chunk + 1) * kChunkSize);
+      for (size_t idx = chunk * kChunkSize; idx < chunk_end; ++idx) {
+        if (contains(self_data_.data() + idx * cipher_size_)) {
+          chunk_indices[chunk].push_back(idx);
+        }
+      }
+    }
+  });
+
+  std::vector<uint64_t> indices;
+  for (const auto& chunk : chunk_indices) {
+    indices.insert(indices.end(), chunk.begin(), chunk.end());
+  }
+  return indices;
+}
+
 DiskCipherStore::DiskCipherStore(const std::string& cache_dir, size_t num_bins)
     : num_bins_(std::max(1UL, num_bins)) {
   SPDLOG_INFO("Disk cache choose num_bins={}", num_bins_);
@@ -36,37 +131,94 @@ void DiskCipherStore::SavePeer(std::string ciphertext) {
   peer_cache_->WriteItem(ciphertext);
 }
 
-std::vector<uint64_t> DiskCipherStore::FinalizeAndComputeIndices() {
+void DiskCipherStore::FinalizeAndComputeIndices(ExternalIndexSorter* indices) {
   self_cache_->Flush();
   peer_cache_->Flush();
 
   // Compute indices
-  std::vector<uint64_t> indices;
+  std::vector<uint64_t> bin_indices;
   for (size_t bin_idx = 0; bin_idx < num_bins_; ++bin_idx) {
-    FindIntersectionIndices(bin_idx, &indices);
+    bin_indices.clear();
+    FindIntersectionIndices(bin_idx, &bin_indices);
+    indices->Add(bin_indices);
   }
-  // Sort to make `FilterByLine` happy.
-  std::sort(indices.begin(), indices.end());
-  return indices;
 }
 
 void DiskCipherStore::FindIntersectionIndices(size_t bucket_idx,
                                               std::vector<uint64_t>* indices) {
-  std::vector<HashBucketCache::BucketItem> self_results =
-      self_cache_->LoadBucketItems(bucket_idx);
-  std::vector<HashBucketCache::BucketItem> peer_results =
-      peer_cache_->LoadBucketItems(bucket_idx);
-  std::unordered_set<std::string> peer_set;
-  peer_set.reserve(peer_results.size());
-  std::for_each(peer_results.begin(), peer_results.end(),
-                [&](HashBucketCache::BucketItem& item) {
-                  peer_set.insert(std::move(item.base64_data));
-                });
-  for (const auto& item : self_results) {
-    if (peer_set.find(item.base64_data) != peer_set.end()) {
+  auto self_results = self_cache_->MapBucketItems(bucket_idx);
+  auto peer_results = peer_cache_->MapBucketItems(bucket_idx);
+  std::unordered_set<std::string_view> peer_set;
+  peer_set.reserve(peer_results->items().size());
+  for (const auto& item : peer_results->items()) {
+    peer_set.insert(item.data);
+  }
+  for (const auto& item : self_results->items()) {
+    if (peer_set.find(item.data) != peer_set.end()) {
       indices->push_back(item.index);
     }
   }
 }
 
+SortedCipherStore::SortedCipherStore(const std::string& cache_dir,
+                                     size_t cipher_size,
+                                     size_t max_in_memory_bytes)
+    : cipher_size_(cipher_size),
+      self_sorter_(cache_dir, cipher_size + sizeof(uint64_t),
+                   max_in_memory_bytes),
+      peer_sorter_(cache_dir, cipher_size, max_in_memory_bytes) {}
+
+void SortedCipherStore::SaveSelf(std::string ciphertext) {
+  YACL_ENFORCE(ciphertext.size() == cipher_size_,
+               "cipher size={} mismatch {}", ciphertext.size(), cipher_size_);
+  const uint64_t index = self_count_++;
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    ciphertext.push_back(
+        static_cast<char>(index >> (8 * (sizeof(uint64_t) - 1 - i))));
+  }
+  self_sorter_.Add(ciphertext);
+}
+
+void SortedCipherStore::SavePeer(std::string ciphertext) {
+  peer_sorter_.Add(ciphertext);
+}
+
+void SortedCipherStore::FinalizeAndComputeIndices(
+    ExternalIndexSorter* indices) {
+  SPDLOG_INFO("Sorted cipher store, self={}, runs={}, peer={}, runs={}",
+              self_sorter_.size(), self_sorter_.num_runs(),
+              peer_sorter_.size(), peer_sorter_.num_runs());
+  auto self_reader = self_sorter_.Finalize();
+  auto peer_reader = peer_sorter_.Finalize();
+
+  // flush the indices to `indices` by batches.
+  constexpr size_t kIndicesBatch = 1 << 16;
+  std::vector<uint64_t> batch;
+  std::string self_item;
+  std::string peer_item;
+  bool has_self = self_reader->Next(&self_item);
+  bool has_peer = peer_reader->Next(&peer_item);
+  while (has_self && has_peer) {
+    const auto cipher = std::string_view(self_item).substr(0, cipher_size_);
+    if (peer_item < cipher) {
+      has_peer = peer_reader->Next(&peer_item);
+      continue;
+    }
+    // the peer item is kept for the duplicates of self.
+    if (peer_item == cipher) {
+      uint64_t index = 0;
+      for (size_t i = cipher_size_; i < self_item.size(); ++i) {
+        index = (index << 8) | static_cast<uint8_t>(self_item[i]);
+      }
+      batch.push_back(index);
+      if (batch.size() == kIndicesBatch) {
+        indices->Add(batch);
+        batch.clear();
+      }
+    }
+    has_self = self_reader->Next(&self_item);
+  }
+  indices->Add(batch);
+}
+
 }  // namespace spu::psi
\ No newline at end of file
@@ -16,9 +16,12 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "spu/psi/utils/hash_bucket_cache.h"
+#include "spu/psi/utils/index_sorter.h"
+#include "spu/psi/utils/item_sorter.h"
 
 namespace spu::psi {
 
@@ -65,6 +68,42 @@ class MemoryCipherStore : public ICipherStore {
   std::vector<std::string> peer_results_;
 };
 
+/// FlatCipherStore packs fixed-width ciphertexts into contiguous bytes, without
+/// a heap allocation per item.
+class FlatCipherStore : public ICipherStore {
+ public:
+  explicit FlatCipherStore(size_t cipher_size);
+
+  void SaveSelf(std::string ciphertext) override;
+
+  void SavePeer(std::string ciphertext) override;
+
+  size_t self_count() const { return self_data_.size() / cipher_size_; }
+  size_t peer_count() const { return peer_data_.size() / cipher_size_; }
+
+  std::string_view self_cipher(size_t idx) const {
+    return std::string_view(self_data_).substr(idx * cipher_size_,
+                                               cipher_size_);
+  }
+  std::string_view peer_cipher(size_t idx) const {
+    return std::string_view(peer_data_).substr(idx * cipher_size_,
+                                               cipher_size_);
+  }
+
+  // The sorted indices of self ciphertexts which are also saved by peer.
+  //
+  // Peer ciphertexts are indexed by an open addressing table of u32 slots,
+  // keyed by their leading bytes which are already uniformly random, then
+  // self ones are looked up in parallel.
+  std::vector<uint64_t> ComputeIntersectionIndices() const;
+
+ private:
+  const size_t cipher_size_;
+
+  std::string self_data_;
+  std::string peer_data_;
+};
+
 class DiskCipherStore : public ICipherStore {
  public:
   explicit DiskCipherStore(const std::string& cache_dir, size_t num_bins);
@@ -73,7 +112,8 @@ class DiskCipherStore : public ICipherStore {
 
   void SavePeer(std::string ciphertext) override;
 
-  std::vector<uint64_t> FinalizeAndComputeIndices();
+  // Add the indices of the self items in the intersection.
+  void FinalizeAndComputeIndices(ExternalIndexSorter* indices);
 
  private:
   void FindIntersectionIndices(size_t bucket_idx,
@@ -86,4 +126,32 @@ class DiskCipherStore : public ICipherStore {
   std::unique_ptr<HashBucketCache> peer_cache_;
 };
 
+/// SortedCipherStore sorts fixed-width ciphertexts of both sides out of core
+/// and intersects them by a streaming merge, so the memory is bounded by the
+/// sorters whatever the input size. Self ciphertexts are packed with their
+/// index, since the masking loses the input order.
+class SortedCipherStore : public ICipherStore {
+ public:
+  SortedCipherStore(const std::string& cache_dir, size_t cipher_size,
+                    size_t max_in_memory_bytes =
+                        ExternalItemSorter::kDefaultMaxInMemoryBytes);
+
+  void SaveSelf(std::string ciphertext) override;
+
+  void SavePeer(std::string ciphertext) override;
+
+  // Add the indices of the self items in the intersection.
+  void FinalizeAndComputeIndices(ExternalIndexSorter* indices);
+
+ private:
+  const size_t cipher_size_;
+
+  size_t self_count_ = 0;
+
+  // ciphertext | index (u64, big endian), so items are ordered by the
+  // ciphertext first.
+  ExternalItemSorter self_sorter_;
+  ExternalItemSorter peer_sorter_;
+};
+
 }  // namespace spu::psi
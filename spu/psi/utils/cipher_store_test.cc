@@ -0,0 +1,124 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/cipher_store.h"
+
+#include <filesystem>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace spu::psi {
+
+namespace {
+
+std::string RandomCipher(std::mt19937_64* rng, size_t size) {
+  std::string ret(size, '\0');
+  for (auto& c : ret) {
+    c = static_cast<char>((*rng)());
+  }
+  return ret;
+}
+
+}  // namespace
+
+class FlatCipherStoreTest : public testing::TestWithParam<size_t> {};
+
+TEST_P(FlatCipherStoreTest, Works) {
+  const size_t cipher_size = GetParam();
+  std::mt19937_64 rng(cipher_size);
+
+  FlatCipherStore store(cipher_size);
+  std::vector<std::string> self;
+  std::vector<uint64_t> expected;
+  for (size_t idx = 0; idx < 200000; ++idx) {
+    self.push_back(RandomCipher(&rng, cipher_size));
+    store.SaveSelf(self.back());
+  }
+  for (size_t idx = 0; idx < 150000; ++idx) {
+    if (idx % 3 == 0) {
+      store.SavePeer(self[idx]);
+      expected.push_back(idx);
+    } else {
+      store.SavePeer(RandomCipher(&rng, cipher_size));
+    }
+  }
+  // duplicates of peer.
+  store.SavePeer(self[0]);
+
+  EXPECT_EQ(store.self_count(), self.size());
+  EXPECT_EQ(store.peer_count(), 150001);
+  EXPECT_EQ(store.self_cipher(7), self[7]);
+  EXPECT_EQ(store.ComputeIntersectionIndices(), expected);
+
+  EXPECT_THROW(store.SaveSelf(std::string(cipher_size + 1, 'a')),
+               yacl::EnforceNotMet);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, FlatCipherStoreTest,
+                         testing::Values(4, 12, 32));
+
+TEST(FlatCipherStoreTest, Empty) {
+  FlatCipherStore store(12);
+  store.SaveSelf(std::string(12, 'a'));
+  EXPECT_TRUE(store.ComputeIntersectionIndices().empty());
+}
+
+class SortedCipherStoreTest : public testing::TestWithParam<size_t> {};
+
+TEST_P(SortedCipherStoreTest, Works) {
+  constexpr size_t kCipherSize = 12;
+  std::mt19937_64 rng(GetParam());
+
+  // spill runs of both sides.
+  SortedCipherStore store(std::filesystem::temp_directory_path(), kCipherSize,
+                          GetParam());
+  std::vector<std::string> self;
+  std::vector<uint64_t> expected;
+  for (size_t idx = 0; idx < 20000; ++idx) {
+    self.push_back(RandomCipher(&rng, kCipherSize));
+    store.SaveSelf(self.back());
+  }
+  for (size_t idx = 0; idx < 15000; ++idx) {
+    if (idx % 3 == 0) {
+      store.SavePeer(self[idx]);
+      expected.push_back(idx);
+    } else {
+      store.SavePeer(RandomCipher(&rng, kCipherSize));
+    }
+  }
+  // duplicates of peer.
+  store.SavePeer(self[0]);
+
+  ExternalIndexSorter indices(std::filesystem::temp_directory_path());
+  store.FinalizeAndComputeIndices(&indices);
+  EXPECT_EQ(indices.size(), expected.size());
+  auto reader = indices.Finalize();
+  std::vector<uint64_t> sorted;
+  uint64_t index;
+  while (reader->Next(&index)) {
+    sorted.push_back(index);
+  }
+  EXPECT_EQ(sorted, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, SortedCipherStoreTest,
+                         testing::Values(1 << 12, 1 << 28));
+
+TEST(SortedCipherStoreTest, BadCipherSize) {
+  SortedCipherStore store(std::filesystem::temp_directory_path(), 12);
+  EXPECT_THROW(store.SaveSelf(std::string(13, 'a')), yacl::EnforceNotMet);
+}
+
+}  // namespace spu::psi
@@ -14,22 +14,42 @@
 
 #include "spu/psi/utils/csv_checker.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <string_view>
+#include <unordered_map>
 
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_join.h"
-#include "absl/time/clock.h"
-#include "absl/time/time.h"
 #include "spdlog/spdlog.h"
 #include "yacl/base/exception.h"
 #include "yacl/crypto/utils/hash_util.h"
-#include "yacl/utils/scope_guard.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/psi/io/io.h"
+#include "spu/psi/utils/hash_bucket_cache.h"
 
 namespace spu::psi {
 
 namespace {
+
+// Rows hashed in a chunk of the digest, the chunks are fixed by rows so the
+// digest of a file does not depend on the threads.
+constexpr size_t kDigestChunkRows = 1 << 14;
+
+// Chunks hashed in a round in parallel.
+constexpr size_t kDigestRoundChunks = 64;
+
+// The keys are partitioned to buckets of about this size, each is checked
+// in memory.
+constexpr size_t kDuplicateBucketBytes = 16 << 20;
+
+// Each bucket keeps an open file while keys are written.
+constexpr size_t kMaxDuplicateBuckets = 512;
+
+// Duplicated keys reported at most.
+constexpr size_t kMaxReportedKeys = 10;
+
 // Check if the first line starts with BOM(Byte Order Mark).
 bool CheckIfBOMExists(const std::string& file_path) {
   std::string first_line;
@@ -48,6 +68,59 @@ bool CheckIfBOMExists(const std::string& file_path) {
     return false;
   }
 }
+
+// Hash the chunks of rows in parallel, appending their digests to `digests`.
+void DigestChunks(const std::vector<std::vector<std::string>>& chunks,
+                  std::string* digests) {
+  std::vector<std::vector<uint8_t>> results(chunks.size());
+  yacl::parallel_for(0, chunks.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; ++idx) {
+      yacl::crypto::SslHash hash_obj(yacl::crypto::HashAlgorithm::SHA256);
+      for (const auto& row : chunks[idx]) {
+        hash_obj.Update(row);
+      }
+      results[idx] = hash_obj.CumulativeHash();
+    }
+  });
+  for (const auto& digest : results) {
+    digests->append(reinterpret_cast<const char*>(digest.data()),
+                    digest.size());
+  }
+}
+
+// Find the keys of the buckets seen more than once, buckets are checked in
+// parallel by a hash set of each.
+void FindDuplicatedKeys(HashBucketCache* cache, size_t* duplicated_size,
+                        std::vector<std::string>* duplicated_keys) {
+  std::vector<size_t> sizes(cache->BucketNum(), 0);
+  std::vector<std::vector<std::string>> keys(cache->BucketNum());
+  yacl::parallel_for(
+      0, cache->BucketNum(), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t idx = begin; idx < end; ++idx) {
+          auto bucket = cache->MapBucketItems(idx);
+          std::unordered_map<std::string_view, size_t> counts;
+          counts.reserve(bucket->items().size());
+          for (const auto& item : bucket->items()) {
+            if (++counts[item.data] != 2) {
+              continue;
+            }
+            if (sizes[idx]++ < kMaxReportedKeys) {
+              keys[idx].emplace_back(item.data);
+            }
+          }
+        }
+      });
+
+  for (size_t idx = 0; idx < cache->BucketNum(); ++idx) {
+    *duplicated_size += sizes[idx];
+    for (auto& key : keys[idx]) {
+      if (duplicated_keys->size() < kMaxReportedKeys) {
+        duplicated_keys->push_back(std::move(key));
+      }
+    }
+  }
+}
+
 }  // namespace
 
 CsvChecker::CsvChecker(const std::string& csv_path,
@@ -57,10 +130,6 @@ CsvChecker::CsvChecker(const std::string& csv_path,
   YACL_ENFORCE(!CheckIfBOMExists(csv_path),
                "the file {} starts with BOM(Byte Order Mark).", csv_path);
 
-  size_t duplicated_size = 0;
-  std::vector<std::string> duplicated_keys;
-  yacl::crypto::SslHash hash_obj(yacl::crypto::HashAlgorithm::SHA256);
-
   io::FileIoOptions file_opts(csv_path);
   io::CsvOptions csv_opts;
   csv_opts.read_options.file_schema.feature_names = schema_names;
@@ -68,19 +137,17 @@ CsvChecker::CsvChecker(const std::string& csv_path,
                                                          io::Schema::STRING);
   auto csv_reader = io::BuildReader(file_opts, csv_opts);
 
-  auto timestamp_str = std::to_string(absl::ToUnixNanos(absl::Now()));
-  std::string keys_file = fmt::format("selected-keys.{}", timestamp_str);
-
-  io::FileIoOptions tmp_file_ops(keys_file);
-  auto keys_os = io::BuildOutputStream(tmp_file_ops);
-  ON_SCOPE_EXIT([&] {
-    std::error_code ec;
-    std::filesystem::remove(tmp_file_ops.file_name, ec);
-    if (ec.value() != 0) {
-      SPDLOG_WARN("can not remove tmp file: {}, msg: {}",
-                  tmp_file_ops.file_name, ec.message());
-    }
-  });
+  // keys are partitioned by their hash, so duplicates land in one bucket.
+  std::unique_ptr<HashBucketCache> keys_cache;
+  if (!skip_check) {
+    const size_t bucket_num = std::clamp<size_t>(
+        std::filesystem::file_size(csv_path) / kDuplicateBucketBytes, 1,
+        kMaxDuplicateBuckets);
+    keys_cache = std::make_unique<HashBucketCache>(tmp_cache_dir, bucket_num);
+  }
+
+  std::string chunk_digests;
+  std::vector<std::vector<std::string>> chunks(1);
 
   // read csv file by row
   io::ColumnVectorBatch batch;
@@ -93,51 +160,36 @@ CsvChecker::CsvChecker(const std::string& csv_path,
                      data_count_ + row, schema_names[col]);
         chosen.push_back(token);
       }
-      // if combined_id is about 128bytes
-      // .keys file tasks almost 12GB for 10^8 samples.
       std::string combined_id = absl::StrJoin(chosen, "-");
-      hash_obj.Update(combined_id);
-      if (!skip_check) {
-        keys_os->Write(combined_id.data(), combined_id.size());
-        keys_os->Write("\n", 1);
+      if (keys_cache) {
+        keys_cache->WriteItem(combined_id);
       }
-    }
-    data_count_ += batch.Shape().rows;
-  }
-  keys_os->Close();
 
-  if (!skip_check) {
-    std::string duplicated_keys_file =
-        fmt::format("duplicate-keys.{}", timestamp_str);
-    ON_SCOPE_EXIT([&] {
-      std::error_code ec;
-      std::filesystem::remove(duplicated_keys_file, ec);
-      if (ec.value() != 0) {
-        SPDLOG_WARN("can not remove tmp file: {}, msg: {}",
-                    duplicated_keys_file, ec.message());
-      }
-    });
-
-    std::string cmd = fmt::format(
-        "LC_ALL=C sort --buffer-size=1G --temporary-directory={} "
-        "--stable {} | LC_ALL=C uniq -d > {}",
-        tmp_cache_dir, keys_file, duplicated_keys_file);
-    SPDLOG_INFO("Executing duplicated scripts: {}", cmd);
-    int ret = system(cmd.c_str());
-    YACL_ENFORCE(ret == 0, "failed to execute cmd={}, ret={}", cmd, ret);
-    io::FileIoOptions dup_keys_file_opts(duplicated_keys_file);
-    auto duplicated_is = io::BuildInputStream(dup_keys_file_opts);
-    std::string duplicated_key;
-    while (duplicated_is->GetLine(&duplicated_key)) {
-      if (duplicated_size++ < 10) {
-        duplicated_keys.push_back(duplicated_key);
+      if (chunks.back().size() == kDigestChunkRows) {
+        if (chunks.size() == kDigestRoundChunks) {
+          DigestChunks(chunks, &chunk_digests);
+          chunks.clear();
+        }
+        chunks.emplace_back().reserve(kDigestChunkRows);
       }
+      chunks.back().push_back(std::move(combined_id));
     }
-    // not precise size if some key repeat more than 2 times.
-    YACL_ENFORCE(duplicated_size == 0, "found duplicated keys: {}",
-                 fmt::join(duplicated_keys, ","));
+    data_count_ += batch.Shape().rows;
+  }
+  DigestChunks(chunks, &chunk_digests);
+
+  if (keys_cache) {
+    keys_cache->Flush();
+    size_t duplicated_size = 0;
+    std::vector<std::string> duplicated_keys;
+    FindDuplicatedKeys(keys_cache.get(), &duplicated_size, &duplicated_keys);
+    YACL_ENFORCE(duplicated_size == 0, "found {} duplicated keys: {}",
+                 duplicated_size, fmt::join(duplicated_keys, ","));
   }
 
+  // the digest of the digests of chunks.
+  yacl::crypto::SslHash hash_obj(yacl::crypto::HashAlgorithm::SHA256);
+  hash_obj.Update(chunk_digests);
   std::vector<uint8_t> digest = hash_obj.CumulativeHash();
   hash_digest_ = absl::BytesToHexString(absl::string_view(
       reinterpret_cast<const char*>(digest.data()), digest.size()));
@@ -16,6 +16,7 @@
 
 #include <filesystem>
 
+#include "fmt/format.h"
 #include "gtest/gtest.h"
 
 #include "spu/psi/io/io.h"
@@ -192,4 +193,45 @@ INSTANTIATE_TEST_SUITE_P(
         FailedTestParams{"id\nc\nb\na\nc\n", {"id"}},
         FailedTestParams{"x1,id\n1,a\n2,b\n3,c\n1,a\n", {"x1, id"}}));
 
+// Rows span several chunks of the digest.
+TEST(CsvCheckerLargeTest, ChunkedDigest) {
+  const std::vector<std::string> paths = {"csv_checker_large_a",
+                                          "csv_checker_large_b",
+                                          "csv_checker_large_c"};
+  for (size_t idx = 0; idx < paths.size(); idx++) {
+    auto os = io::BuildOutputStream(io::FileIoOptions(paths[idx]));
+    os->Write("id,x1\n");
+    for (size_t row = 0; row < 40000; row++) {
+      // the last file differs at a row of the second chunk.
+      const size_t value = (idx == 2 && row == 20000) ? 40000 : row;
+      os->Write(fmt::format("{},{}\n", value, row % 7));
+    }
+    os->Close();
+  }
+
+  std::vector<std::string> digests;
+  for (const auto& path : paths) {
+    CsvChecker checker(path, {"id"}, "./");
+    EXPECT_EQ(checker.data_count(), 40000U);
+    digests.push_back(checker.hash_digest());
+    std::filesystem::remove(path);
+  }
+  EXPECT_EQ(digests[0], digests[1]);
+  EXPECT_NE(digests[0], digests[2]);
+}
+
+TEST(CsvCheckerLargeTest, DuplicatedKeys) {
+  const std::string path = "csv_checker_large_dup";
+  auto os = io::BuildOutputStream(io::FileIoOptions(path));
+  os->Write("id\n");
+  for (size_t row = 0; row < 40000; row++) {
+    os->Write(fmt::format("{}\n", row == 30000 ? 5 : row));
+  }
+  os->Close();
+
+  EXPECT_ANY_THROW(CsvChecker(path, {"id"}, "./"));
+  EXPECT_NO_THROW(CsvChecker(path, {"id"}, "./", true));
+  std::filesystem::remove(path);
+}
+
 }  // namespace spu::psi
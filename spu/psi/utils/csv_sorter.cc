@@ -0,0 +1,253 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/csv_sorter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+namespace spu::psi {
+
+namespace {
+
+// lines sorted by a task before the sorted parts are merged.
+constexpr size_t kSortPartLines = 1 << 16;
+
+// bytes of lines written at a time.
+constexpr size_t kWriteBufferSize = 1 << 20;
+
+// Find the (offset, size) of the key fields of `line`, a missing field is
+// empty as `sort` does.
+void FindKeys(std::string_view line, const std::vector<size_t>& key_indices,
+              std::pair<uint32_t, uint32_t>* spans) {
+  const size_t num_fields =
+      *std::max_element(key_indices.begin(), key_indices.end()) + 1;
+  std::vector<std::pair<uint32_t, uint32_t>> fields(num_fields, {0, 0});
+  size_t begin = 0;
+  for (size_t field = 0; field < num_fields && begin <= line.size();
+       ++field) {
+    size_t end = line.find(',', begin);
+    if (end == std::string_view::npos) {
+      end = line.size();
+    }
+    fields[field] = {static_cast<uint32_t>(begin),
+                     static_cast<uint32_t>(end - begin)};
+    begin = end + 1;
+  }
+  for (size_t idx = 0; idx < key_indices.size(); ++idx) {
+    spans[idx] = fields[key_indices[idx]];
+  }
+}
+
+void FlushLines(std::string* buf, io::OutputStream* out) {
+  out->Write(buf->data(), buf->size());
+  buf->clear();
+}
+
+// A run file being merged, with the keys of its current line.
+class RunCursor {
+ public:
+  RunCursor(std::unique_ptr<io::InputStream> in,
+            const std::vector<size_t>* key_indices)
+      : in_(std::move(in)),
+        key_indices_(key_indices),
+        spans_(key_indices->size()) {}
+
+  bool Next() {
+    if (!in_->GetLine(&line_)) {
+      return false;
+    }
+    FindKeys(line_, *key_indices_, spans_.data());
+    return true;
+  }
+
+  const std::string& line() const { return line_; }
+
+  std::string_view key(size_t idx) const {
+    return std::string_view(line_).substr(spans_[idx].first,
+                                          spans_[idx].second);
+  }
+
+ private:
+  std::unique_ptr<io::InputStream> in_;
+  const std::vector<size_t>* key_indices_;
+  std::string line_;
+  std::vector<std::pair<uint32_t, uint32_t>> spans_;
+};
+
+}  // namespace
+
+ExternalCsvSorter::ExternalCsvSorter(const std::string& cache_dir,
+                                     std::vector<size_t> key_indices,
+                                     size_t max_in_memory_bytes)
+    : key_indices_(std::move(key_indices)),
+      max_in_memory_bytes_(max_in_memory_bytes) {
+  YACL_ENFORCE(!key_indices_.empty(), "no key to sort by");
+  YACL_ENFORCE(max_in_memory_bytes_ > 0);
+  disk_cache_ = ScopeDiskCache::Create(std::filesystem::path(cache_dir));
+  YACL_ENFORCE(disk_cache_, "cannot create disk cache from dir={}",
+               cache_dir);
+}
+
+void ExternalCsvSorter::Add(std::string_view line) {
+  YACL_ENFORCE(!finalized_, "cannot add lines after finalized");
+  YACL_ENFORCE(line.size() <= std::numeric_limits<uint32_t>::max(),
+               "line too large, size={}", line.size());
+  entries_.push_back(Entry{buffer_.size(), line.size()});
+  buffer_.append(line);
+  key_spans_.resize(key_spans_.size() + key_indices_.size());
+  FindKeys(line, key_indices_,
+           key_spans_.data() + key_spans_.size() - key_indices_.size());
+  ++total_;
+
+  if (buffer_.size() >= max_in_memory_bytes_) {
+    Spill();
+  }
+}
+
+std::vector<size_t> ExternalCsvSorter::SortBuffer() const {
+  const size_t num_keys = key_indices_.size();
+  auto key = [&](size_t entry, size_t idx) {
+    const auto& span = key_spans_[entry * num_keys + idx];
+    return std::string_view(buffer_).substr(entries_[entry].offset + span.first,
+                                            span.second);
+  };
+  // ties keep the order of adding.
+  auto less = [&](size_t a, size_t b) {
+    for (size_t idx = 0; idx < num_keys; ++idx) {
+      const int cmp = key(a, idx).compare(key(b, idx));
+      if (cmp != 0) {
+        return cmp < 0;
+      }
+    }
+    return a < b;
+  };
+
+  const size_t num = entries_.size();
+  std::vector<size_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+
+  // sort the parts in parallel, then merge pairs of them by rounds.
+  const size_t num_parts = (num + kSortPartLines - 1) / kSortPartLines;
+  auto bound = [&](size_t part) {
+    return order.begin() + std::min(num, part * kSortPartLines);
+  };
+  yacl::parallel_for(0, num_parts, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t part = begin; part < end; ++part) {
+      std::sort(bound(part), bound(part + 1), less);
+    }
+  });
+  for (size_t width = 1; width < num_parts; width *= 2) {
+    const size_t num_pairs = (num_parts + 2 * width - 1) / (2 * width);
+    yacl::parallel_for(0, num_pairs, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t pair = begin; pair < end; ++pair) {
+        const size_t first = pair * 2 * width;
+        std::inplace_merge(bound(first), bound(first + width),
+                           bound(first + 2 * width), less);
+      }
+    });
+  }
+  return order;
+}
+
+void ExternalCsvSorter::Spill() {
+  const auto order = SortBuffer();
+
+  auto out = io::BuildOutputStream(
+      io::FileIoOptions(disk_cache_->GetBinPath(run_sizes_.size())));
+  std::string lines;
+  for (size_t entry : order) {
+    lines.append(buffer_, entries_[entry].offset, entries_[entry].size);
+    lines.push_back('\n');
+    if (lines.size() >= kWriteBufferSize) {
+      FlushLines(&lines, out.get());
+    }
+  }
+  FlushLines(&lines, out.get());
+  out->Close();
+
+  SPDLOG_INFO("spill csv run={}, size={}", run_sizes_.size(),
+              entries_.size());
+  run_sizes_.push_back(entries_.size());
+  buffer_.clear();
+  entries_.clear();
+  key_spans_.clear();
+}
+
+void ExternalCsvSorter::Finalize(io::OutputStream* out) {
+  YACL_ENFORCE(!finalized_, "already finalized");
+  finalized_ = true;
+
+  std::string lines;
+  if (run_sizes_.empty()) {
+    for (size_t entry : SortBuffer()) {
+      lines.append(buffer_, entries_[entry].offset, entries_[entry].size);
+      lines.push_back('\n');
+      if (lines.size() >= kWriteBufferSize) {
+        FlushLines(&lines, out);
+      }
+    }
+    FlushLines(&lines, out);
+    return;
+  }
+  if (!entries_.empty()) {
+    Spill();
+  }
+
+  std::vector<RunCursor> cursors;
+  for (size_t idx = 0; idx < run_sizes_.size(); ++idx) {
+    cursors.emplace_back(disk_cache_->CreateHashBinInputStream(idx),
+                         &key_indices_);
+  }
+  // the top is the least line, ties go to the earlier run.
+  auto greater = [&](size_t a, size_t b) {
+    for (size_t idx = 0; idx < key_indices_.size(); ++idx) {
+      const int cmp = cursors[a].key(idx).compare(cursors[b].key(idx));
+      if (cmp != 0) {
+        return cmp > 0;
+      }
+    }
+    return a > b;
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(
+      greater);
+  for (size_t idx = 0; idx < cursors.size(); ++idx) {
+    if (cursors[idx].Next()) {
+      heap.push(idx);
+    }
+  }
+
+  while (!heap.empty()) {
+    const size_t idx = heap.top();
+    heap.pop();
+    lines.append(cursors[idx].line());
+    lines.push_back('\n');
+    if (lines.size() >= kWriteBufferSize) {
+      FlushLines(&lines, out);
+    }
+    if (cursors[idx].Next()) {
+      heap.push(idx);
+    }
+  }
+  FlushLines(&lines, out);
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,88 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "spu/psi/io/io.h"
+#include "spu/psi/utils/scope_disk_cache.h"
+
+namespace spu::psi {
+
+/// An out-of-core sorter of csv lines by key columns.
+//
+// Lines are ordered as `LC_ALL=C sort --stable --field-separator=,` with a
+// `--key=F,F` of each key column: by the bytes of the key fields in order,
+// ties keep the order of adding. It works as ExternalItemSorter: lines are
+// buffered, sorted by threads and spilled to run files under a scoped temp
+// dir when the buffer is full, and `Finalize` k-way merges the runs.
+class ExternalCsvSorter {
+ public:
+  // 256MB of lines.
+  static constexpr size_t kDefaultMaxInMemoryBytes = 1 << 28;
+
+  // `key_indices` are the columns of the keys by priority.
+  ExternalCsvSorter(const std::string& cache_dir,
+                    std::vector<size_t> key_indices,
+                    size_t max_in_memory_bytes = kDefaultMaxInMemoryBytes);
+
+  ExternalCsvSorter(const ExternalCsvSorter&) = delete;
+  ExternalCsvSorter& operator=(const ExternalCsvSorter&) = delete;
+
+  // Add a line without the line break. Not thread safe.
+  void Add(std::string_view line);
+
+  // The number of lines added.
+  size_t size() const { return total_; }
+
+  // The number of spilled run files.
+  size_t num_runs() const { return run_sizes_.size(); }
+
+  // Write the sorted lines to `out`, each followed by a line break. No more
+  // lines could be added after it, and it should be called once.
+  void Finalize(io::OutputStream* out);
+
+ private:
+  // A line of the buffer.
+  struct Entry {
+    size_t offset;
+    size_t size;
+  };
+
+  // Sort the buffer by threads, return the order of entries.
+  std::vector<size_t> SortBuffer() const;
+
+  // Sort the buffer and write it as a new run.
+  void Spill();
+
+  const std::vector<size_t> key_indices_;
+  const size_t max_in_memory_bytes_;
+
+  std::unique_ptr<ScopeDiskCache> disk_cache_;
+
+  std::string buffer_;
+  std::vector<Entry> entries_;
+  // the (offset in line, size) of the keys of entries, in a row of each.
+  std::vector<std::pair<uint32_t, uint32_t>> key_spans_;
+  std::vector<size_t> run_sizes_;
+  size_t total_ = 0;
+  bool finalized_ = false;
+};
+
+}  // namespace spu::psi
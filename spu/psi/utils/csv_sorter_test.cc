@@ -0,0 +1,85 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/csv_sorter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "absl/strings/str_split.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+class ExternalCsvSorterTest : public testing::TestWithParam<size_t> {};
+
+TEST_P(ExternalCsvSorterTest, Works) {
+  const size_t max_in_memory_bytes = GetParam();
+
+  std::mt19937 rng(42);
+  std::vector<std::string> lines;
+  for (size_t idx = 0; idx < 100000; ++idx) {
+    lines.push_back(fmt::format("{},{},{}", rng() % 50, idx, rng() % 7));
+  }
+  // a missing key field is empty.
+  lines.push_back("3");
+
+  const std::string out_path = "csv_sorter_test_out";
+  ExternalCsvSorter sorter(std::filesystem::temp_directory_path(), {2, 0},
+                           max_in_memory_bytes);
+  for (const auto& line : lines) {
+    sorter.Add(line);
+  }
+  EXPECT_EQ(sorter.size(), lines.size());
+  {
+    auto out = io::BuildOutputStream(io::FileIoOptions(out_path));
+    sorter.Finalize(out.get());
+    out->Close();
+  }
+
+  // by the 3rd then the 1st field as bytes, ties keep the order.
+  auto key = [](const std::string& line) {
+    std::vector<std::string> fields = absl::StrSplit(line, ',');
+    fields.resize(3);
+    return std::make_pair(fields[2], fields[0]);
+  };
+  std::stable_sort(
+      lines.begin(), lines.end(),
+      [&](const auto& a, const auto& b) { return key(a) < key(b); });
+
+  std::vector<std::string> sorted;
+  auto in = io::BuildInputStream(io::FileIoOptions(out_path));
+  std::string line;
+  while (in->GetLine(&line)) {
+    sorted.push_back(line);
+  }
+  in->Close();
+  std::filesystem::remove(out_path);
+  EXPECT_EQ(sorted, lines);
+
+  EXPECT_THROW(sorter.Add(lines[0]), yacl::EnforceNotMet);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, ExternalCsvSorterTest,
+                         testing::Values(1 << 12, 1 << 18, 1 << 28));
+
+TEST(ExternalCsvSorterTest, NoKeys) {
+  EXPECT_THROW(ExternalCsvSorter(std::filesystem::temp_directory_path(), {}),
+               yacl::EnforceNotMet);
+}
+
+}  // namespace spu::psi
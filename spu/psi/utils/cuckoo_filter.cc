@@ -0,0 +1,238 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/cuckoo_filter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+#include "yacl/utils/parallel.h"
+
+namespace spu::psi {
+
+namespace {
+
+// items of a BatchContains chunk, their buckets are prefetched together.
+constexpr size_t kPrefetchNum = 16;
+
+// splitmix64 finalizer.
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// 32 bit value to [0, n) without division.
+uint64_t FastRange(uint64_t value32, uint64_t n) {
+  return (value32 * n) >> 32;
+}
+
+uint64_t NextRandom(uint64_t* state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+}  // namespace
+
+CuckooFilter::Params CuckooFilter::SelectParams(size_t item_num,
+                                                double false_positive_rate) {
+  YACL_ENFORCE(false_positive_rate > 0 && false_positive_rate < 1,
+               "bad false positive rate={}", false_positive_rate);
+
+  Params params;
+  params.fingerprint_bytes = 4;
+  for (uint64_t bytes : {1, 2}) {
+    if (2.0 * kSlotsPerBucket / std::exp2(8 * bytes) <= false_positive_rate) {
+      params.fingerprint_bytes = bytes;
+      break;
+    }
+  }
+  if (2.0 * kSlotsPerBucket / std::exp2(32) > false_positive_rate) {
+    SPDLOG_WARN("false positive rate={} is lower than 4 byte fingerprints",
+                false_positive_rate);
+  }
+
+  params.bucket_num = std::max<uint64_t>(
+      1, std::ceil(item_num / (kSlotsPerBucket * kMaxLoadFactor)));
+  return params;
+}
+
+CuckooFilter::CuckooFilter(const Params& params)
+    : CuckooFilter(params, std::string(params.TableSize(), '\0'), 0) {}
+
+CuckooFilter::CuckooFilter(const Params& params, std::string table,
+                           size_t size)
+    : params_(params), table_(std::move(table)), size_(size) {
+  YACL_ENFORCE(params_.fingerprint_bytes == 1 ||
+                   params_.fingerprint_bytes == 2 ||
+                   params_.fingerprint_bytes == 4,
+               "bad fingerprint_bytes={}", params_.fingerprint_bytes);
+  YACL_ENFORCE(params_.bucket_num > 0 && params_.bucket_num < (1ULL << 32),
+               "bad bucket_num={}", params_.bucket_num);
+  YACL_ENFORCE(table_.size() == params_.TableSize(),
+               "table size={} mismatch params {}", table_.size(),
+               params_.TableSize());
+}
+
+CuckooFilter::Position CuckooFilter::Locate(std::string_view item) const {
+  uint64_t hash = Mix(item.size());
+  for (size_t offset = 0; offset < item.size(); offset += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    std::memcpy(&word, item.data() + offset,
+                std::min(sizeof(uint64_t), item.size() - offset));
+    hash = Mix(hash ^ word);
+  }
+
+  // the bucket from the high half and the fingerprint from the low half.
+  Position pos;
+  pos.bucket = FastRange(hash >> 32, params_.bucket_num);
+  const uint64_t fingerprint_mask =
+      (1ULL << (8 * params_.fingerprint_bytes)) - 1;
+  pos.fingerprint = hash & fingerprint_mask;
+  if (pos.fingerprint == 0) {
+    // zero is an empty slot.
+    pos.fingerprint = 1;
+  }
+  pos.alt_bucket = AltBucket(pos.bucket, pos.fingerprint);
+  return pos;
+}
+
+uint64_t CuckooFilter::AltBucket(uint64_t bucket, uint32_t fingerprint) const {
+  // (h(f) - bucket) mod n is an involution between the two buckets, and
+  // works for any n unlike the xor of the paper.
+  const uint64_t n = params_.bucket_num;
+  return (FastRange(Mix(fingerprint) >> 32, n) + n - bucket) % n;
+}
+
+bool CuckooFilter::BucketContains(uint64_t bucket,
+                                  uint32_t fingerprint) const {
+  const size_t bucket_bytes = kSlotsPerBucket * params_.fingerprint_bytes;
+  const char* ptr = table_.data() + bucket * bucket_bytes;
+
+  // compare all slots of a word at once: xor with the fingerprint in every
+  // lane and test for a zero lane.
+  const uint64_t lanes_low =
+      ~0ULL / ((1ULL << (8 * params_.fingerprint_bytes)) - 1);
+  const uint64_t lanes_high = lanes_low << (8 * params_.fingerprint_bytes - 1);
+  const uint64_t pattern = fingerprint * lanes_low;
+  for (size_t offset = 0; offset < bucket_bytes; offset += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    std::memcpy(&word, ptr + offset,
+                std::min(sizeof(uint64_t), bucket_bytes - offset));
+    // lanes past the bucket are zero and never match a nonzero fingerprint.
+    const uint64_t diff = word ^ pattern;
+    if (((diff - lanes_low) & ~diff & lanes_high) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t CuckooFilter::GetSlot(uint64_t bucket, size_t slot) const {
+  uint32_t fingerprint = 0;
+  std::memcpy(&fingerprint,
+              table_.data() + (bucket * kSlotsPerBucket + slot) *
+                                  params_.fingerprint_bytes,
+              params_.fingerprint_bytes);
+  return fingerprint;
+}
+
+void CuckooFilter::SetSlot(uint64_t bucket, size_t slot,
+                           uint32_t fingerprint) {
+  std::memcpy(
+      table_.data() +
+          (bucket * kSlotsPerBucket + slot) * params_.fingerprint_bytes,
+      &fingerprint, params_.fingerprint_bytes);
+}
+
+bool CuckooFilter::TryPut(uint64_t bucket, uint32_t fingerprint) {
+  for (size_t slot = 0; slot < kSlotsPerBucket; ++slot) {
+    if (GetSlot(bucket, slot) == 0) {
+      SetSlot(bucket, slot, fingerprint);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CuckooFilter::Insert(std::string_view item) {
+  auto pos = Locate(item);
+  if (TryPut(pos.bucket, pos.fingerprint) ||
+      TryPut(pos.alt_bucket, pos.fingerprint)) {
+    ++size_;
+    return;
+  }
+
+  uint64_t bucket =
+      (NextRandom(&rng_state_) & 1) != 0 ? pos.alt_bucket : pos.bucket;
+  uint32_t fingerprint = pos.fingerprint;
+  for (size_t kick = 0; kick < kMaxKicks; ++kick) {
+    const size_t slot = NextRandom(&rng_state_) % kSlotsPerBucket;
+    const uint32_t victim = GetSlot(bucket, slot);
+    SetSlot(bucket, slot, fingerprint);
+    fingerprint = victim;
+    bucket = AltBucket(bucket, fingerprint);
+    if (TryPut(bucket, fingerprint)) {
+      ++size_;
+      return;
+    }
+  }
+  YACL_THROW("cuckoo filter is full, size={}, bucket_num={}", size_,
+             params_.bucket_num);
+}
+
+bool CuckooFilter::Contains(std::string_view item) const {
+  auto pos = Locate(item);
+  return BucketContains(pos.bucket, pos.fingerprint) ||
+         BucketContains(pos.alt_bucket, pos.fingerprint);
+}
+
+std::vector<uint8_t> CuckooFilter::BatchContains(
+    absl::Span<const std::string> items) const {
+  const size_t bucket_bytes = kSlotsPerBucket * params_.fingerprint_bytes;
+  std::vector<uint8_t> ret(items.size());
+  yacl::parallel_for(
+      0, items.size(), kPrefetchNum, [&](int64_t begin, int64_t end) {
+        std::array<Position, kPrefetchNum> positions;
+        for (int64_t chunk = begin; chunk < end; chunk += kPrefetchNum) {
+          const size_t num = std::min<int64_t>(kPrefetchNum, end - chunk);
+          for (size_t idx = 0; idx < num; ++idx) {
+            positions[idx] = Locate(items[chunk + idx]);
+            __builtin_prefetch(table_.data() +
+                               positions[idx].bucket * bucket_bytes);
+            __builtin_prefetch(table_.data() +
+                               positions[idx].alt_bucket * bucket_bytes);
+          }
+          for (size_t idx = 0; idx < num; ++idx) {
+            ret[chunk + idx] = BucketContains(positions[idx].bucket,
+                                              positions[idx].fingerprint) ||
+                               BucketContains(positions[idx].alt_bucket,
+                                              positions[idx].fingerprint);
+          }
+        }
+      });
+  return ret;
+}
+
+}  // namespace spu::psi
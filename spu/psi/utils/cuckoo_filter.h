@@ -0,0 +1,102 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace spu::psi {
+
+// Cuckoo filter of Fan et al., Cuckoo Filter: Practically Better Than Bloom,
+// CoNEXT 2014, with buckets of kSlotsPerBucket fingerprints.
+//
+// Items should be uniformly random, like hash or oprf outputs, and their
+// bytes are mixed into the bucket and fingerprint without a cryptographic
+// hash. A fingerprint is 1, 2 or 4 bytes, the smallest one for the false
+// positive rate, about 2 * kSlotsPerBucket / 2^(8 * fingerprint_bytes). A
+// bucket is probed with a few word operations over all of its slots.
+class CuckooFilter {
+ public:
+  static constexpr size_t kSlotsPerBucket = 4;
+  static constexpr double kMaxLoadFactor = 0.9;
+  static constexpr size_t kMaxKicks = 500;
+
+  struct Params {
+    uint64_t fingerprint_bytes = 0;
+    uint64_t bucket_num = 0;
+
+    size_t TableSize() const {
+      return bucket_num * kSlotsPerBucket * fingerprint_bytes;
+    }
+  };
+
+  // Params to hold `item_num` items with `false_positive_rate`.
+  static Params SelectParams(size_t item_num, double false_positive_rate);
+
+  CuckooFilter(size_t item_num, double false_positive_rate)
+      : CuckooFilter(SelectParams(item_num, false_positive_rate)) {}
+
+  explicit CuckooFilter(const Params& params);
+
+  // A filter of `size` items restored from its params and table.
+  CuckooFilter(const Params& params, std::string table, size_t size);
+
+  // Throws if the filter is full, and the filter is unusable then.
+  void Insert(std::string_view item);
+
+  bool Contains(std::string_view item) const;
+
+  // Contains of every item, the buckets of a chunk of items are prefetched
+  // before probing, and chunks are probed in parallel.
+  std::vector<uint8_t> BatchContains(absl::Span<const std::string> items) const;
+
+  const Params& params() const { return params_; }
+
+  const std::string& table() const { return table_; }
+
+  size_t size() const { return size_; }
+
+ private:
+  struct Position {
+    uint64_t bucket;
+    uint64_t alt_bucket;
+    uint32_t fingerprint;
+  };
+
+  Position Locate(std::string_view item) const;
+
+  uint64_t AltBucket(uint64_t bucket, uint32_t fingerprint) const;
+
+  bool BucketContains(uint64_t bucket, uint32_t fingerprint) const;
+
+  uint32_t GetSlot(uint64_t bucket, size_t slot) const;
+
+  void SetSlot(uint64_t bucket, size_t slot, uint32_t fingerprint);
+
+  // Put the fingerprint into an empty slot of the bucket if any.
+  bool TryPut(uint64_t bucket, uint32_t fingerprint);
+
+  Params params_;
+  std::string table_;
+  size_t size_ = 0;
+  // for victims to kick out.
+  uint64_t rng_state_ = 0x9e3779b97f4a7c15ULL;
+};
+
+}  // namespace spu::psi
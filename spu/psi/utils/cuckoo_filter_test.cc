@@ -0,0 +1,94 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/cuckoo_filter.h"
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+#include "yacl/crypto/tools/prg.h"
+
+namespace spu::psi {
+
+namespace {
+
+std::vector<std::string> MakeItems(yacl::Prg<uint8_t>* prg, size_t num) {
+  std::vector<std::string> items(num, std::string(12, '\0'));
+  for (auto& item : items) {
+    prg->Fill(absl::MakeSpan(item));
+  }
+  return items;
+}
+
+}  // namespace
+
+struct TestParams {
+  double false_positive_rate;
+  size_t fingerprint_bytes;
+};
+
+class CuckooFilterTest : public ::testing::TestWithParam<TestParams> {};
+
+TEST_P(CuckooFilterTest, Works) {
+  constexpr size_t kItemNum = 100000;
+  auto params = GetParam();
+
+  yacl::Prg<uint8_t> prg(0);
+  auto items = MakeItems(&prg, kItemNum);
+  auto others = MakeItems(&prg, kItemNum);
+
+  CuckooFilter filter(kItemNum, params.false_positive_rate);
+  EXPECT_EQ(filter.params().fingerprint_bytes, params.fingerprint_bytes);
+  for (const auto& item : items) {
+    filter.Insert(item);
+  }
+  EXPECT_EQ(filter.size(), kItemNum);
+
+  auto hits = filter.BatchContains(items);
+  for (size_t idx = 0; idx < kItemNum; ++idx) {
+    ASSERT_TRUE(hits[idx]);
+    ASSERT_TRUE(filter.Contains(items[idx]));
+  }
+
+  CuckooFilter restored(filter.params(), filter.table(), filter.size());
+  auto other_hits = restored.BatchContains(others);
+  size_t false_positives = 0;
+  for (size_t idx = 0; idx < kItemNum; ++idx) {
+    EXPECT_EQ(other_hits[idx], restored.Contains(others[idx]));
+    false_positives += other_hits[idx];
+  }
+  EXPECT_LE(false_positives, kItemNum * params.false_positive_rate);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, CuckooFilterTest,
+                         testing::Values(TestParams{0.05, 1},
+                                         TestParams{0.001, 2},
+                                         TestParams{1e-8, 4}));
+
+TEST(CuckooFilterFullTest, Throws) {
+  CuckooFilter::Params params;
+  params.fingerprint_bytes = 2;
+  params.bucket_num = 1;
+  CuckooFilter filter(params);
+
+  yacl::Prg<uint8_t> prg(0);
+  auto items = MakeItems(&prg, CuckooFilter::kSlotsPerBucket + 1);
+  for (size_t idx = 0; idx < CuckooFilter::kSlotsPerBucket; ++idx) {
+    filter.Insert(items[idx]);
+  }
+  EXPECT_THROW(filter.Insert(items.back()), yacl::EnforceNotMet);
+
+  EXPECT_THROW(CuckooFilter(params, "", 0), yacl::EnforceNotMet);
+}
+
+}  // namespace spu::psi
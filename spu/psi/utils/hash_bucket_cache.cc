@@ -14,25 +14,108 @@
 
 #include "spu/psi/utils/hash_bucket_cache.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <filesystem>
+#include <limits>
 #include <memory>
 
-#include "absl/strings/escaping.h"
 #include "absl/strings/str_split.h"
 #include "spdlog/spdlog.h"
+#include "yacl/utils/parallel.h"
 
 #include "spu/psi/utils/batch_provider.h"
 
 namespace spu::psi {
 
+namespace {
+
+// items hashed per task of WriteItems.
+constexpr int64_t kHashGrainSize = 1024;
+
+// index (u64) | size (u32)
+constexpr size_t kRecordHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+void AppendLittleEndian(std::string* buf, uint64_t value, size_t nbytes) {
+  for (size_t i = 0; i < nbytes; ++i) {
+    buf->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t ReadLittleEndian(const char* ptr, size_t nbytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < nbytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(ptr[i])) << (8 * i);
+  }
+  return value;
+}
+
+// Parse the binary records of a bucket, calling fn(index, data) on each.
+template <typename Fn>
+void ForEachRecord(std::string_view content, Fn&& fn) {
+  size_t pos = 0;
+  while (pos < content.size()) {
+    YACL_ENFORCE(content.size() - pos >= kRecordHeaderSize,
+                 "truncated record header at offset={}", pos);
+    const char* ptr = content.data() + pos;
+    uint64_t index = ReadLittleEndian(ptr, sizeof(uint64_t));
+    size_t size = ReadLittleEndian(ptr + sizeof(uint64_t), sizeof(uint32_t));
+    pos += kRecordHeaderSize;
+    YACL_ENFORCE(content.size() - pos >= size,
+                 "truncated record data at offset={}, size={}", pos, size);
+    fn(index, content.substr(pos, size));
+    pos += size;
+  }
+}
+
+}  // namespace
+
+HashBucketCache::MappedBucket::MappedBucket(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  YACL_ENFORCE(fd >= 0, "cannot open {}, errno={}", path, errno);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    YACL_THROW("cannot stat {}, errno={}", path, errno);
+  }
+  size_ = st.st_size;
+  if (size_ > 0) {
+    addr_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (addr_ == MAP_FAILED) {
+    addr_ = nullptr;
+    YACL_THROW("cannot mmap {}, size={}, errno={}", path, size_, errno);
+  }
+
+  ForEachRecord(std::string_view(static_cast<const char*>(addr_), size_),
+                [&](uint64_t index, std::string_view data) {
+                  items_.push_back(BucketItemView{index, data});
+                });
+}
+
+HashBucketCache::MappedBucket::~MappedBucket() {
+  if (addr_ != nullptr) {
+    munmap(addr_, size_);
+  }
+}
+
 HashBucketCache::HashBucketCache(const std::string& target_dir,
-                                 uint32_t bucket_num)
-    : target_dir_(target_dir), bucket_num_(bucket_num), item_index_(0) {
+                                 uint32_t bucket_num, Format format)
+    : target_dir_(target_dir),
+      bucket_num_(bucket_num),
+      format_(format),
+      item_index_(0) {
   YACL_ENFORCE(bucket_num_ > 0);
   disk_cache_ = ScopeDiskCache::Create(std::filesystem::path(target_dir_));
   YACL_ENFORCE(disk_cache_, "cannot create disk cache from dir={}",
                target_dir_);
   disk_cache_->CreateHashBinStreams(bucket_num_, &bucket_os_vec_);
+  bucket_buffers_.resize(bucket_num_);
 }
 
 HashBucketCache::~HashBucketCache() {
@@ -40,28 +123,106 @@ HashBucketCache::~HashBucketCache() {
   disk_cache_ = nullptr;
 }
 
+size_t HashBucketCache::BucketIndex(const std::string& data) const {
+  // the bucket only depends on the data, so peers agree on it whatever format
+  // they use.
+  return std::hash<std::string>()(data) % bucket_os_vec_.size();
+}
+
+void HashBucketCache::AppendItem(size_t bucket_idx, uint64_t index,
+                                 const std::string& data) {
+  auto& buf = bucket_buffers_[bucket_idx];
+
+  if (format_ == Format::kBinary) {
+    YACL_ENFORCE(data.size() <= std::numeric_limits<uint32_t>::max(),
+                 "item too large, size={}", data.size());
+    AppendLittleEndian(&buf, index, sizeof(uint64_t));
+    AppendLittleEndian(&buf, data.size(), sizeof(uint32_t));
+    buf.append(data);
+  } else {
+    BucketItem bucket_item;
+    bucket_item.index = index;
+    bucket_item.data = data;
+    buf.append(bucket_item.Serialize());
+    buf.push_back('\n');
+  }
+
+  if (buf.size() >= kWriteBufferSize) {
+    FlushBucket(bucket_idx);
+  }
+}
+
 void HashBucketCache::WriteItem(const std::string& data) {
-  BucketItem bucket_item;
-  bucket_item.index = item_index_;
-  bucket_item.base64_data = absl::Base64Escape(data);
-
-  auto& out = bucket_os_vec_[std::hash<std::string>()(bucket_item.base64_data) %
-                             bucket_os_vec_.size()];
-  out->Write(bucket_item.Serialize());
-  out->Write("\n");
+  AppendItem(BucketIndex(data), item_index_, data);
   item_index_++;
 }
 
+void HashBucketCache::WriteItems(const std::vector<std::string>& items) {
+  std::vector<uint32_t> bucket_idxs(items.size());
+  yacl::parallel_for(0, items.size(), kHashGrainSize,
+                     [&](int64_t begin, int64_t end) {
+                       for (int64_t idx = begin; idx < end; ++idx) {
+                         bucket_idxs[idx] = BucketIndex(items[idx]);
+                       }
+                     });
+
+  // stable counting sort of the items by their buckets.
+  std::vector<size_t> offsets(bucket_num_ + 1, 0);
+  for (auto bucket_idx : bucket_idxs) {
+    offsets[bucket_idx + 1]++;
+  }
+  for (size_t idx = 0; idx < bucket_num_; ++idx) {
+    offsets[idx + 1] += offsets[idx];
+  }
+  std::vector<size_t> order(items.size());
+  {
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t idx = 0; idx < items.size(); ++idx) {
+      order[next[bucket_idxs[idx]]++] = idx;
+    }
+  }
+
+  // every bucket has its own buffer and stream, so they are appended and
+  // flushed independently.
+  yacl::parallel_for(0, bucket_num_, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bucket_idx = begin; bucket_idx < end; ++bucket_idx) {
+      for (size_t pos = offsets[bucket_idx]; pos < offsets[bucket_idx + 1];
+           ++pos) {
+        AppendItem(bucket_idx, item_index_ + order[pos], items[order[pos]]);
+      }
+    }
+  });
+  item_index_ += items.size();
+}
+
+void HashBucketCache::FlushBucket(size_t bucket_idx) {
+  auto& buf = bucket_buffers_[bucket_idx];
+  if (!buf.empty()) {
+    bucket_os_vec_[bucket_idx]->Write(buf.data(), buf.size());
+    buf.clear();
+  }
+}
+
 void HashBucketCache::Flush() {
-  // Flush files.
-  for (const auto& out : bucket_os_vec_) {
-    out->Flush();
+  // Flush buffers and files.
+  for (size_t idx = 0; idx < bucket_os_vec_.size(); ++idx) {
+    FlushBucket(idx);
+    bucket_os_vec_[idx]->Flush();
   }
 }
 
 std::vector<HashBucketCache::BucketItem> HashBucketCache::LoadBucketItems(
     uint32_t index) {
   std::vector<BucketItem> ret;
+  if (format_ == Format::kBinary) {
+    auto mapped = MapBucketItems(index);
+    ret.reserve(mapped->items().size());
+    for (const auto& item : mapped->items()) {
+      ret.push_back(BucketItem{item.index, std::string(item.data)});
+    }
+    return ret;
+  }
+
   auto in = disk_cache_->CreateHashBinInputStream(index);
 
   std::string line;
@@ -72,22 +233,31 @@ std::vector<HashBucketCache::BucketItem> HashBucketCache::LoadBucketItems(
   return ret;
 }
 
+std::unique_ptr<HashBucketCache::MappedBucket> HashBucketCache::MapBucketItems(
+    uint32_t index) {
+  YACL_ENFORCE(format_ == Format::kBinary,
+               "only buckets of the binary format could be mapped");
+  YACL_ENFORCE(index < bucket_num_, "bucket index={} out of range={}", index,
+               bucket_num_);
+  return std::make_unique<MappedBucket>(disk_cache_->GetBinPath(index));
+}
+
 std::unique_ptr<HashBucketCache> CreateCacheFromCsv(
     const std::string& csv_path, const std::vector<std::string>& schema_names,
     const std::string& cache_dir, uint32_t bucket_num,
-    uint32_t read_batch_size) {
-  auto bucket_cache = std::make_unique<HashBucketCache>(cache_dir, bucket_num);
+    uint32_t read_batch_size, HashBucketCache::Format format) {
+  auto bucket_cache =
+      std::make_unique<HashBucketCache>(cache_dir, bucket_num, format);
 
-  auto batch_provider =
-      std::make_unique<CsvBatchProvider>(csv_path, schema_names);
+  auto batch_provider = std::make_unique<PrefetchBatchProvider>(
+      std::make_shared<CsvBatchProvider>(csv_path, schema_names),
+      read_batch_size);
   while (true) {
     auto items = batch_provider->ReadNextBatch(read_batch_size);
     if (items.empty()) {
       break;
     }
-    for (const auto& it : items) {
-      bucket_cache->WriteItem(it);
-    }
+    bucket_cache->WriteItems(items);
   }
   bucket_cache->Flush();
 
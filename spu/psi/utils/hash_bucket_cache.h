@@ -19,6 +19,7 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_split.h"
 #include "fmt/format.h"
 #include "yacl/base/exception.h"
@@ -32,9 +33,12 @@ class HashBucketCache {
  public:
   struct BucketItem {
     uint64_t index;
-    std::string base64_data;
+    std::string data;
 
-    std::string Serialize() { return fmt::format("{},{}", index, base64_data); }
+    // the csv line, data is base64 encoded.
+    std::string Serialize() const {
+      return fmt::format("{},{}", index, absl::Base64Escape(data));
+    }
 
     static BucketItem Deserialize(std::string_view data_str) {
       BucketItem item;
@@ -44,31 +48,89 @@ class HashBucketCache {
       YACL_ENFORCE(absl::SimpleAtoi(tokens[0], &item.index),
                    "cannot convert {} to idx",
                    std::string(tokens[0].data(), tokens[0].size()));
-      item.base64_data = std::string(tokens[1].data(), tokens[1].size());
+      YACL_ENFORCE(absl::Base64Unescape(tokens[1], &item.data),
+                   "cannot decode base64 data of idx={}", item.index);
 
       return item;
     }
   };
 
  public:
-  explicit HashBucketCache(const std::string& target_dir, uint32_t bucket_num);
+  // The on-disk format of the buckets.
+  enum class Format {
+    // length-prefixed records of the raw item bytes:
+    //   index (u64, little endian) | size (u32, little endian) | data
+    kBinary,
+    // "{index},{base64 of data}" lines, readable for debugging.
+    kCsv,
+  };
+
+  // An item of a bucket which references the mapped file.
+  struct BucketItemView {
+    uint64_t index;
+    std::string_view data;
+  };
+
+  // The items of a binary bucket mapped from the disk, the views are valid
+  // during its lifetime.
+  class MappedBucket {
+   public:
+    MappedBucket(const std::string& path);
+
+    ~MappedBucket();
+
+    MappedBucket(const MappedBucket&) = delete;
+    MappedBucket& operator=(const MappedBucket&) = delete;
+
+    const std::vector<BucketItemView>& items() const { return items_; }
+
+   private:
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+    std::vector<BucketItemView> items_;
+  };
+
+  explicit HashBucketCache(const std::string& target_dir, uint32_t bucket_num,
+                           Format format = Format::kBinary);
 
   ~HashBucketCache();
 
   void WriteItem(const std::string& data);
 
+  // Same as WriteItem on each of items in order. The items are hashed and
+  // encoded by several threads, and the buckets are appended and flushed in
+  // parallel, so a bucket still keeps the input order.
+  void WriteItems(const std::vector<std::string>& items);
+
   void Flush();
 
   std::vector<BucketItem> LoadBucketItems(uint32_t index);
 
+  // Map a bucket of the binary format, the items are not copied.
+  std::unique_ptr<MappedBucket> MapBucketItems(uint32_t index);
+
   uint32_t BucketNum() { return bucket_num_; }
 
+  Format format() const { return format_; }
+
  private:
+  // flush the pending bytes of a bucket when they exceed this.
+  static constexpr size_t kWriteBufferSize = 64 * 1024;
+
+  size_t BucketIndex(const std::string& data) const;
+
+  // append the record of item index to the pending bytes of the bucket.
+  void AppendItem(size_t bucket_idx, uint64_t index, const std::string& data);
+
+  void FlushBucket(size_t bucket_idx);
+
   std::unique_ptr<ScopeDiskCache> disk_cache_;
   std::vector<std::unique_ptr<io::OutputStream>> bucket_os_vec_;
+  std::vector<std::string> bucket_buffers_;
 
   std::string target_dir_;
   uint32_t bucket_num_;
+  Format format_;
 
   uint64_t item_index_;
 };
@@ -76,6 +138,7 @@ class HashBucketCache {
 std::unique_ptr<HashBucketCache> CreateCacheFromCsv(
     const std::string& csv_path, const std::vector<std::string>& schema_names,
     const std::string& cache_dir, uint32_t bucket_num,
-    uint32_t read_batch_size = 4096);
+    uint32_t read_batch_size = 4096,
+    HashBucketCache::Format format = HashBucketCache::Format::kBinary);
 
 }  // namespace spu::psi
@@ -0,0 +1,144 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/hash_bucket_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+
+#include "gtest/gtest.h"
+
+namespace spu::psi {
+
+namespace {
+
+// items with commas, newlines and zeros, which only survive an exact format.
+std::vector<std::string> MakeItems(size_t num) {
+  std::vector<std::string> items;
+  for (size_t idx = 0; idx < num; ++idx) {
+    std::string item = fmt::format("item,{}\n", idx);
+    item.push_back('\0');
+    item.append(idx % 7, static_cast<char>(0xFF));
+    items.push_back(std::move(item));
+  }
+  // an empty item.
+  items.emplace_back();
+  return items;
+}
+
+std::map<uint64_t, std::string> LoadAll(HashBucketCache* cache) {
+  std::map<uint64_t, std::string> ret;
+  for (uint32_t idx = 0; idx < cache->BucketNum(); ++idx) {
+    for (auto& item : cache->LoadBucketItems(idx)) {
+      EXPECT_TRUE(ret.emplace(item.index, std::move(item.data)).second);
+    }
+  }
+  return ret;
+}
+
+}  // namespace
+
+class HashBucketCacheTest
+    : public ::testing::TestWithParam<HashBucketCache::Format> {};
+
+TEST_P(HashBucketCacheTest, Works) {
+  const auto items = MakeItems(20000);
+  const uint32_t bucket_num = 5;
+
+  HashBucketCache cache(std::filesystem::temp_directory_path(), bucket_num,
+                        GetParam());
+  for (const auto& item : items) {
+    cache.WriteItem(item);
+  }
+  cache.Flush();
+
+  auto loaded = LoadAll(&cache);
+  ASSERT_EQ(loaded.size(), items.size());
+  for (size_t idx = 0; idx < items.size(); ++idx) {
+    EXPECT_EQ(loaded[idx], items[idx]);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, HashBucketCacheTest,
+                         testing::Values(HashBucketCache::Format::kBinary,
+                                         HashBucketCache::Format::kCsv));
+
+TEST_P(HashBucketCacheTest, WriteItems) {
+  const auto items = MakeItems(20000);
+  const uint32_t bucket_num = 7;
+
+  HashBucketCache expected(std::filesystem::temp_directory_path(), bucket_num,
+                           GetParam());
+  HashBucketCache cache(std::filesystem::temp_directory_path(), bucket_num,
+                        GetParam());
+  for (const auto& item : items) {
+    expected.WriteItem(item);
+  }
+  // batches of different sizes, and an empty one.
+  cache.WriteItems({});
+  for (size_t begin = 0, size = 1; begin < items.size(); size *= 3) {
+    size_t end = std::min(begin + size, items.size());
+    cache.WriteItems(std::vector<std::string>(items.begin() + begin,
+                                              items.begin() + end));
+    begin = end;
+  }
+  expected.Flush();
+  cache.Flush();
+
+  // the same buckets of the same order as written one by one.
+  for (uint32_t idx = 0; idx < bucket_num; ++idx) {
+    auto expected_items = expected.LoadBucketItems(idx);
+    auto bucket_items = cache.LoadBucketItems(idx);
+    ASSERT_EQ(bucket_items.size(), expected_items.size());
+    for (size_t i = 0; i < bucket_items.size(); ++i) {
+      EXPECT_EQ(bucket_items[i].index, expected_items[i].index);
+      EXPECT_EQ(bucket_items[i].data, expected_items[i].data);
+    }
+  }
+}
+
+TEST(HashBucketCacheMapTest, Works) {
+  const auto items = MakeItems(1000);
+  const uint32_t bucket_num = 3;
+
+  HashBucketCache binary(std::filesystem::temp_directory_path(), bucket_num);
+  HashBucketCache csv(std::filesystem::temp_directory_path(), bucket_num,
+                      HashBucketCache::Format::kCsv);
+  for (const auto& item : items) {
+    binary.WriteItem(item);
+    csv.WriteItem(item);
+  }
+  binary.Flush();
+  csv.Flush();
+
+  EXPECT_THROW(csv.MapBucketItems(0), yacl::EnforceNotMet);
+  EXPECT_THROW(binary.MapBucketItems(bucket_num), yacl::EnforceNotMet);
+
+  size_t total = 0;
+  for (uint32_t idx = 0; idx < bucket_num; ++idx) {
+    auto mapped = binary.MapBucketItems(idx);
+    // the bucket of an item does not depend on the format.
+    auto expected = csv.LoadBucketItems(idx);
+    ASSERT_EQ(mapped->items().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(mapped->items()[i].index, expected[i].index);
+      EXPECT_EQ(mapped->items()[i].data, expected[i].data);
+    }
+    total += expected.size();
+  }
+  EXPECT_EQ(total, items.size());
+}
+
+}  // namespace spu::psi
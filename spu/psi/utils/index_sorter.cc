@@ -0,0 +1,186 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/index_sorter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+namespace {
+
+// indices read from a run file at a time.
+constexpr size_t kRunBlockSize = 1 << 16;
+
+class MemoryReader : public ExternalIndexSorter::Reader {
+ public:
+  explicit MemoryReader(std::vector<uint64_t> indices)
+      : indices_(std::move(indices)) {}
+
+  bool Next(uint64_t* index) override {
+    if (pos_ == indices_.size()) {
+      return false;
+    }
+    *index = indices_[pos_++];
+    return true;
+  }
+
+ private:
+  std::vector<uint64_t> indices_;
+  size_t pos_ = 0;
+};
+
+// A sorted source of the merge, a run file or the last in-memory buffer.
+class RunCursor {
+ public:
+  RunCursor(std::unique_ptr<io::InputStream> in, size_t size)
+      : in_(std::move(in)), remaining_(size) {}
+
+  explicit RunCursor(std::vector<uint64_t> block) : block_(std::move(block)) {}
+
+  bool Next(uint64_t* index) {
+    if (pos_ == block_.size()) {
+      if (remaining_ == 0) {
+        return false;
+      }
+      block_.resize(std::min(remaining_, kRunBlockSize));
+      in_->Read(block_.data(), block_.size() * sizeof(uint64_t));
+      remaining_ -= block_.size();
+      pos_ = 0;
+    }
+    *index = block_[pos_++];
+    return true;
+  }
+
+ private:
+  std::unique_ptr<io::InputStream> in_;
+  size_t remaining_ = 0;
+  std::vector<uint64_t> block_;
+  size_t pos_ = 0;
+};
+
+class MergeReader : public ExternalIndexSorter::Reader {
+ public:
+  MergeReader(std::unique_ptr<ScopeDiskCache> disk_cache,
+              std::vector<RunCursor> cursors)
+      : disk_cache_(std::move(disk_cache)), cursors_(std::move(cursors)) {
+    for (size_t idx = 0; idx < cursors_.size(); ++idx) {
+      Advance(idx);
+    }
+  }
+
+  bool Next(uint64_t* index) override {
+    if (heap_.empty()) {
+      return false;
+    }
+    auto [value, idx] = heap_.top();
+    heap_.pop();
+    *index = value;
+    Advance(idx);
+    return true;
+  }
+
+ private:
+  void Advance(size_t idx) {
+    uint64_t value;
+    if (cursors_[idx].Next(&value)) {
+      heap_.emplace(value, idx);
+    }
+  }
+
+  // keep the run files until the merge is done.
+  std::unique_ptr<ScopeDiskCache> disk_cache_;
+  std::vector<RunCursor> cursors_;
+  std::priority_queue<std::pair<uint64_t, size_t>,
+                      std::vector<std::pair<uint64_t, size_t>>,
+                      std::greater<>>
+      heap_;
+};
+
+}  // namespace
+
+ExternalIndexSorter::ExternalIndexSorter(const std::string& cache_dir,
+                                         size_t max_in_memory)
+    : max_in_memory_(max_in_memory) {
+  YACL_ENFORCE(max_in_memory_ > 0);
+  disk_cache_ = ScopeDiskCache::Create(std::filesystem::path(cache_dir));
+  YACL_ENFORCE(disk_cache_, "cannot create disk cache from dir={}",
+               cache_dir);
+}
+
+void ExternalIndexSorter::Add(uint64_t index) {
+  Add(absl::MakeConstSpan(&index, 1));
+}
+
+void ExternalIndexSorter::Add(absl::Span<const uint64_t> indices) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  YACL_ENFORCE(!finalized_, "cannot add indices after finalized");
+  total_ += indices.size();
+  while (!indices.empty()) {
+    size_t n = std::min(indices.size(), max_in_memory_ - buffer_.size());
+    buffer_.insert(buffer_.end(), indices.begin(), indices.begin() + n);
+    indices.remove_prefix(n);
+    if (buffer_.size() == max_in_memory_) {
+      SpillLocked();
+    }
+  }
+}
+
+size_t ExternalIndexSorter::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return total_;
+}
+
+void ExternalIndexSorter::SpillLocked() {
+  std::sort(buffer_.begin(), buffer_.end());
+
+  auto out = io::BuildOutputStream(
+      io::FileIoOptions(disk_cache_->GetBinPath(run_sizes_.size())));
+  out->Write(buffer_.data(), buffer_.size() * sizeof(uint64_t));
+  out->Close();
+
+  SPDLOG_INFO("spill index run={}, size={}", run_sizes_.size(),
+              buffer_.size());
+  run_sizes_.push_back(buffer_.size());
+  buffer_.clear();
+}
+
+std::unique_ptr<ExternalIndexSorter::Reader> ExternalIndexSorter::Finalize() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  YACL_ENFORCE(!finalized_, "already finalized");
+  finalized_ = true;
+
+  std::sort(buffer_.begin(), buffer_.end());
+  if (run_sizes_.empty()) {
+    return std::make_unique<MemoryReader>(std::move(buffer_));
+  }
+
+  std::vector<RunCursor> cursors;
+  for (size_t idx = 0; idx < run_sizes_.size(); ++idx) {
+    cursors.emplace_back(disk_cache_->CreateHashBinInputStream(idx),
+                         run_sizes_[idx]);
+  }
+  cursors.emplace_back(std::move(buffer_));
+  return std::make_unique<MergeReader>(std::move(disk_cache_),
+                                       std::move(cursors));
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,82 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+
+#include "spu/psi/io/io.h"
+#include "spu/psi/utils/scope_disk_cache.h"
+
+namespace spu::psi {
+
+/// An out-of-core sorter of item indices.
+//
+// Indices are buffered in memory, sorted and spilled to run files under a
+// scoped temp dir when the buffer is full. `Finalize` k-way merges the runs,
+// so the memory is bounded by the buffer plus a block per run.
+class ExternalIndexSorter {
+ public:
+  // 128MB of indices.
+  static constexpr size_t kDefaultMaxInMemory = 1 << 24;
+
+  // Read the sorted indices one by one.
+  class Reader {
+   public:
+    virtual ~Reader() = default;
+
+    // Return false when all indices are read.
+    virtual bool Next(uint64_t* index) = 0;
+  };
+
+  explicit ExternalIndexSorter(const std::string& cache_dir,
+                               size_t max_in_memory = kDefaultMaxInMemory);
+
+  ExternalIndexSorter(const ExternalIndexSorter&) = delete;
+  ExternalIndexSorter& operator=(const ExternalIndexSorter&) = delete;
+
+  // Thread safe.
+  void Add(uint64_t index);
+  void Add(absl::Span<const uint64_t> indices);
+
+  // The number of indices added.
+  size_t size() const;
+
+  // The number of spilled run files.
+  size_t num_runs() const { return run_sizes_.size(); }
+
+  // No more indices could be added after it, and it should be called once.
+  std::unique_ptr<Reader> Finalize();
+
+ private:
+  // Sort the buffer and write it as a new run, with the lock held.
+  void SpillLocked();
+
+  const size_t max_in_memory_;
+
+  std::unique_ptr<ScopeDiskCache> disk_cache_;
+
+  mutable std::mutex mutex_;
+  std::vector<uint64_t> buffer_;
+  std::vector<size_t> run_sizes_;
+  size_t total_ = 0;
+  bool finalized_ = false;
+};
+
+}  // namespace spu::psi
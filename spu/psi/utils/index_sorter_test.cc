@@ -0,0 +1,100 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/index_sorter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <future>
+#include <numeric>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace spu::psi {
+
+namespace {
+
+std::vector<uint64_t> ReadAll(ExternalIndexSorter::Reader* reader) {
+  std::vector<uint64_t> ret;
+  uint64_t index;
+  while (reader->Next(&index)) {
+    ret.push_back(index);
+  }
+  return ret;
+}
+
+}  // namespace
+
+class ExternalIndexSorterTest : public testing::TestWithParam<size_t> {};
+
+TEST_P(ExternalIndexSorterTest, Works) {
+  const size_t max_in_memory = GetParam();
+  std::vector<uint64_t> indices(10000);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::shuffle(indices.begin(), indices.end(), std::mt19937(42));
+
+  ExternalIndexSorter sorter(std::filesystem::temp_directory_path(),
+                             max_in_memory);
+  // by spans of different sizes and by one.
+  size_t pos = 0;
+  for (size_t n = 1; pos + n <= indices.size(); n += 17) {
+    sorter.Add(absl::MakeConstSpan(indices.data() + pos, n));
+    pos += n;
+  }
+  for (; pos < indices.size(); pos++) {
+    sorter.Add(indices[pos]);
+  }
+  EXPECT_EQ(sorter.size(), indices.size());
+  EXPECT_EQ(sorter.num_runs(), indices.size() / max_in_memory);
+
+  auto sorted = ReadAll(sorter.Finalize().get());
+  std::sort(indices.begin(), indices.end());
+  EXPECT_EQ(sorted, indices);
+
+  EXPECT_THROW(sorter.Add(1), yacl::EnforceNotMet);
+  EXPECT_THROW(sorter.Finalize(), yacl::EnforceNotMet);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, ExternalIndexSorterTest,
+                         testing::Values(1000, 3333, 10000, 100000));
+
+TEST(ExternalIndexSorterTest, MultiThreads) {
+  ExternalIndexSorter sorter(std::filesystem::temp_directory_path(), 100);
+
+  std::vector<std::future<void>> futures;
+  for (uint64_t tid = 0; tid < 4; tid++) {
+    futures.push_back(std::async(std::launch::async, [&, tid]() {
+      for (uint64_t idx = tid; idx < 4000; idx += 4) {
+        sorter.Add(idx);
+      }
+    }));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+
+  auto sorted = ReadAll(sorter.Finalize().get());
+  ASSERT_EQ(sorted.size(), 4000);
+  for (size_t idx = 0; idx < sorted.size(); idx++) {
+    EXPECT_EQ(sorted[idx], idx);
+  }
+}
+
+TEST(ExternalIndexSorterTest, Empty) {
+  ExternalIndexSorter sorter(std::filesystem::temp_directory_path());
+  EXPECT_TRUE(ReadAll(sorter.Finalize().get()).empty());
+}
+
+}  // namespace spu::psi
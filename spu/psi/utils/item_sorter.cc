@@ -0,0 +1,230 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/item_sorter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+namespace {
+
+// items read from a run file at a time.
+constexpr size_t kRunBlockItems = 1 << 14;
+
+// Sort the items of a flat buffer in place.
+void SortFlatItems(std::string* buffer, size_t item_size) {
+  const size_t num = buffer->size() / item_size;
+  auto item = [&](size_t idx) {
+    return std::string_view(*buffer).substr(idx * item_size, item_size);
+  };
+
+  std::vector<size_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return item(a) < item(b); });
+
+  std::string sorted;
+  sorted.reserve(buffer->size());
+  for (size_t idx : order) {
+    sorted.append(item(idx));
+  }
+  buffer->swap(sorted);
+}
+
+// A sorted source of the merge, a run file or the last in-memory buffer.
+class RunCursor {
+ public:
+  RunCursor(std::unique_ptr<io::InputStream> in, size_t item_size, size_t size)
+      : in_(std::move(in)), item_size_(item_size), remaining_(size) {}
+
+  RunCursor(std::string block, size_t item_size)
+      : item_size_(item_size), block_(std::move(block)) {}
+
+  // The view is valid until the next call.
+  bool Next(std::string_view* item) {
+    if (pos_ == block_.size()) {
+      if (remaining_ == 0) {
+        return false;
+      }
+      const size_t num = std::min(remaining_, kRunBlockItems);
+      block_.resize(num * item_size_);
+      in_->Read(block_.data(), block_.size());
+      remaining_ -= num;
+      pos_ = 0;
+    }
+    *item = std::string_view(block_).substr(pos_, item_size_);
+    pos_ += item_size_;
+    return true;
+  }
+
+ private:
+  std::unique_ptr<io::InputStream> in_;
+  size_t item_size_;
+  size_t remaining_ = 0;
+  std::string block_;
+  size_t pos_ = 0;
+};
+
+class MemoryReader : public ExternalItemSorter::Reader {
+ public:
+  MemoryReader(std::string items, size_t item_size)
+      : cursor_(std::move(items), item_size) {}
+
+  bool Next(std::string* item) override {
+    std::string_view view;
+    if (!cursor_.Next(&view)) {
+      return false;
+    }
+    item->assign(view);
+    return true;
+  }
+
+ private:
+  RunCursor cursor_;
+};
+
+class MergeReader : public ExternalItemSorter::Reader {
+ public:
+  MergeReader(std::unique_ptr<ScopeDiskCache> disk_cache,
+              std::vector<RunCursor> cursors)
+      : disk_cache_(std::move(disk_cache)), cursors_(std::move(cursors)) {
+    for (size_t idx = 0; idx < cursors_.size(); ++idx) {
+      Advance(idx);
+    }
+  }
+
+  bool Next(std::string* item) override {
+    if (heap_.empty()) {
+      return false;
+    }
+    auto [value, idx] = heap_.top();
+    heap_.pop();
+    // copy before the cursor moves on.
+    item->assign(value);
+    Advance(idx);
+    return true;
+  }
+
+ private:
+  void Advance(size_t idx) {
+    std::string_view value;
+    if (cursors_[idx].Next(&value)) {
+      heap_.emplace(value, idx);
+    }
+  }
+
+  // keep the run files until the merge is done.
+  std::unique_ptr<ScopeDiskCache> disk_cache_;
+  std::vector<RunCursor> cursors_;
+  std::priority_queue<std::pair<std::string_view, size_t>,
+                      std::vector<std::pair<std::string_view, size_t>>,
+                      std::greater<>>
+      heap_;
+};
+
+}  // namespace
+
+std::vector<std::string> ExternalItemSorter::Reader::NextBatch(size_t num) {
+  std::vector<std::string> items;
+  std::string item;
+  while (items.size() < num && Next(&item)) {
+    items.push_back(std::move(item));
+  }
+  return items;
+}
+
+ExternalItemSorter::ExternalItemSorter(const std::string& cache_dir,
+                                       size_t item_size,
+                                       size_t max_in_memory_bytes)
+    : item_size_(item_size),
+      max_in_memory_items_(std::max<size_t>(
+          1, max_in_memory_bytes / std::max<size_t>(item_size, 1))) {
+  YACL_ENFORCE(item_size_ > 0);
+  disk_cache_ = ScopeDiskCache::Create(std::filesystem::path(cache_dir));
+  YACL_ENFORCE(disk_cache_, "cannot create disk cache from dir={}",
+               cache_dir);
+}
+
+void ExternalItemSorter::Add(std::string_view item) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  AddLocked(item);
+}
+
+void ExternalItemSorter::Add(const std::vector<std::string>& items) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const auto& item : items) {
+    AddLocked(item);
+  }
+}
+
+void ExternalItemSorter::AddLocked(std::string_view item) {
+  YACL_ENFORCE(!finalized_, "cannot add items after finalized");
+  YACL_ENFORCE(item.size() == item_size_, "item size={} mismatch {}",
+               item.size(), item_size_);
+  buffer_.append(item);
+  ++total_;
+  if (buffer_.size() == max_in_memory_items_ * item_size_) {
+    SpillLocked();
+  }
+}
+
+size_t ExternalItemSorter::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return total_;
+}
+
+void ExternalItemSorter::SpillLocked() {
+  SortFlatItems(&buffer_, item_size_);
+
+  auto out = io::BuildOutputStream(
+      io::FileIoOptions(disk_cache_->GetBinPath(run_sizes_.size())));
+  out->Write(buffer_.data(), buffer_.size());
+  out->Close();
+
+  SPDLOG_INFO("spill item run={}, size={}", run_sizes_.size(),
+              buffer_.size() / item_size_);
+  run_sizes_.push_back(buffer_.size() / item_size_);
+  buffer_.clear();
+}
+
+std::unique_ptr<ExternalItemSorter::Reader> ExternalItemSorter::Finalize() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  YACL_ENFORCE(!finalized_, "already finalized");
+  finalized_ = true;
+
+  SortFlatItems(&buffer_, item_size_);
+  if (run_sizes_.empty()) {
+    return std::make_unique<MemoryReader>(std::move(buffer_), item_size_);
+  }
+
+  std::vector<RunCursor> cursors;
+  for (size_t idx = 0; idx < run_sizes_.size(); ++idx) {
+    cursors.emplace_back(disk_cache_->CreateHashBinInputStream(idx),
+                         item_size_, run_sizes_[idx]);
+  }
+  cursors.emplace_back(std::move(buffer_), item_size_);
+  return std::make_unique<MergeReader>(std::move(disk_cache_),
+                                       std::move(cursors));
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,89 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "spu/psi/io/io.h"
+#include "spu/psi/utils/scope_disk_cache.h"
+
+namespace spu::psi {
+
+/// An out-of-core sorter of fixed size items, compared as bytes.
+//
+// It works as ExternalIndexSorter: items are buffered in one flat buffer,
+// sorted and spilled to run files under a scoped temp dir when the buffer is
+// full, and `Finalize` k-way merges the runs.
+class ExternalItemSorter {
+ public:
+  // 256MB of items.
+  static constexpr size_t kDefaultMaxInMemoryBytes = 1 << 28;
+
+  // Read the sorted items in order.
+  class Reader {
+   public:
+    virtual ~Reader() = default;
+
+    // Return false when all items are read.
+    virtual bool Next(std::string* item) = 0;
+
+    // Up to `num` items, empty when all items are read.
+    std::vector<std::string> NextBatch(size_t num);
+  };
+
+  ExternalItemSorter(const std::string& cache_dir, size_t item_size,
+                     size_t max_in_memory_bytes = kDefaultMaxInMemoryBytes);
+
+  ExternalItemSorter(const ExternalItemSorter&) = delete;
+  ExternalItemSorter& operator=(const ExternalItemSorter&) = delete;
+
+  // Thread safe.
+  void Add(std::string_view item);
+  void Add(const std::vector<std::string>& items);
+
+  size_t item_size() const { return item_size_; }
+
+  // The number of items added.
+  size_t size() const;
+
+  // The number of spilled run files.
+  size_t num_runs() const { return run_sizes_.size(); }
+
+  // No more items could be added after it, and it should be called once.
+  std::unique_ptr<Reader> Finalize();
+
+ private:
+  void AddLocked(std::string_view item);
+
+  // Sort the buffer and write it as a new run, with the lock held.
+  void SpillLocked();
+
+  const size_t item_size_;
+  const size_t max_in_memory_items_;
+
+  std::unique_ptr<ScopeDiskCache> disk_cache_;
+
+  mutable std::mutex mutex_;
+  std::string buffer_;
+  std::vector<size_t> run_sizes_;
+  size_t total_ = 0;
+  bool finalized_ = false;
+};
+
+}  // namespace spu::psi
@@ -0,0 +1,73 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/item_sorter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+class ExternalItemSorterTest : public testing::TestWithParam<size_t> {};
+
+TEST_P(ExternalItemSorterTest, Works) {
+  constexpr size_t kItemSize = 12;
+  const size_t max_in_memory_items = GetParam();
+
+  std::mt19937 rng(42);
+  std::vector<std::string> items(10000, std::string(kItemSize, '\0'));
+  for (auto& item : items) {
+    std::generate(item.begin(), item.end(), [&] { return rng(); });
+  }
+  // duplicates are kept.
+  items[1] = items[0];
+
+  ExternalItemSorter sorter(std::filesystem::temp_directory_path(), kItemSize,
+                            max_in_memory_items * kItemSize);
+  sorter.Add(std::vector<std::string>(items.begin(), items.begin() + 5000));
+  for (size_t idx = 5000; idx < items.size(); ++idx) {
+    sorter.Add(items[idx]);
+  }
+  EXPECT_EQ(sorter.size(), items.size());
+  EXPECT_EQ(sorter.num_runs(), items.size() / max_in_memory_items);
+
+  auto reader = sorter.Finalize();
+  std::vector<std::string> sorted;
+  while (true) {
+    auto batch = reader->NextBatch(999);
+    if (batch.empty()) {
+      break;
+    }
+    sorted.insert(sorted.end(), batch.begin(), batch.end());
+  }
+  std::sort(items.begin(), items.end());
+  EXPECT_EQ(sorted, items);
+
+  EXPECT_THROW(sorter.Add(items[0]), yacl::EnforceNotMet);
+  EXPECT_THROW(sorter.Finalize(), yacl::EnforceNotMet);
+}
+
+INSTANTIATE_TEST_SUITE_P(Works_Instances, ExternalItemSorterTest,
+                         testing::Values(1000, 3333, 10000, 100000));
+
+TEST(ExternalItemSorterTest, BadItemSize) {
+  ExternalItemSorter sorter(std::filesystem::temp_directory_path(), 4);
+  EXPECT_THROW(sorter.Add("too long"), yacl::EnforceNotMet);
+}
+
+}  // namespace spu::psi
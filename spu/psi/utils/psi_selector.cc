@@ -0,0 +1,184 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/psi_selector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "yacl/base/exception.h"
+
+namespace spu::psi {
+
+namespace {
+
+// Rough costs per party of the protocols on one x86 core from a 2^20 run of
+// psi_type_bench, they only need to rank the protocols.
+struct ProtocolCost {
+  double seconds_per_receiver_item;
+  double seconds_per_sender_item;
+  double bytes_per_receiver_item;
+  double bytes_per_sender_item;
+  double setup_seconds;
+  size_t rounds;
+  // whether the compute scales with threads.
+  bool parallel;
+};
+
+// Every item is masked twice, by its owner and then the peer, and the peer
+// sends back the dual masks.
+ProtocolCost EcdhCost(CurveType curve_type) {
+  const double mul_seconds = curve_type == CurveType::CURVE_FOURQ ? 15e-6
+                                                                  : 30e-6;
+  return {2 * mul_seconds, 2 * mul_seconds, 44, 44, 0, 4, true};
+}
+
+// The receiver sends 1.27 cuckoo bins of 512-bit OT columns per item, and
+// the sender 3 hashes per item. Base OTs are the setup.
+constexpr ProtocolCost kKkrtCost = {3e-6, 3e-6, 82, 30, 0.1, 6, false};
+
+// The receiver sends compressed VOLE of its bins, and the sender 3 hashes of
+// 13 bytes per item. The VOLE bootstrap is the setup.
+constexpr ProtocolCost kBc22Cost = {1.5e-6, 1.5e-6, 24, 40, 0.5, 10, false};
+
+double EstimateSeconds(const ProtocolCost& cost, size_t num_runs,
+                       const PsiSelectOptions& options) {
+  const auto receiver_size = static_cast<double>(options.receiver_size);
+  const auto sender_size = static_cast<double>(options.sender_size);
+
+  double compute = receiver_size * cost.seconds_per_receiver_item +
+                   sender_size * cost.seconds_per_sender_item;
+  if (cost.parallel) {
+    compute /= std::max<size_t>(options.num_threads, 1);
+  }
+  const double bytes = receiver_size * cost.bytes_per_receiver_item +
+                       sender_size * cost.bytes_per_sender_item;
+  const double bytes_per_second =
+      std::max(options.link.bytes_per_second, 1.0);
+
+  return compute + bytes / bytes_per_second +
+         num_runs * (cost.setup_seconds +
+                     cost.rounds * std::max(options.link.rtt_seconds, 0.0));
+}
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point begin) {
+  return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+constexpr size_t kProbePings = 3;
+
+// the payload of the ping messages.
+const std::string kProbeMessage = "probe";
+
+}  // namespace
+
+double EstimatePsiSeconds(PsiType psi_type, CurveType curve_type,
+                          const PsiSelectOptions& options) {
+  size_t num_runs = 1;
+  if (options.bucket_size != 0) {
+    const size_t max_size =
+        std::max(options.receiver_size, options.sender_size);
+    num_runs = std::max<size_t>(
+        (max_size + options.bucket_size - 1) / options.bucket_size, 1);
+  }
+
+  switch (psi_type) {
+    case PsiType::ECDH_PSI_2PC:
+      return EstimateSeconds(EcdhCost(curve_type), 1, options);
+    case PsiType::KKRT_PSI_2PC:
+      return EstimateSeconds(kKkrtCost, num_runs, options);
+    case PsiType::BC22_PSI_2PC:
+      return EstimateSeconds(kBc22Cost, num_runs, options);
+    default:
+      YACL_THROW("no cost model of psi_type={}", PsiType_Name(psi_type));
+  }
+}
+
+PsiSelection SelectPsi(const PsiSelectOptions& options) {
+  std::vector<PsiSelection> candidates = {
+      {PsiType::ECDH_PSI_2PC, CurveType::CURVE_25519, 0},
+      {PsiType::KKRT_PSI_2PC, CurveType::CURVE_INVALID_TYPE, 0},
+      {PsiType::BC22_PSI_2PC, CurveType::CURVE_INVALID_TYPE, 0},
+  };
+  if (options.fourq_supported) {
+    candidates.push_back(
+        {PsiType::ECDH_PSI_2PC, CurveType::CURVE_FOURQ, 0});
+  }
+
+  for (auto& candidate : candidates) {
+    candidate.expected_seconds = EstimatePsiSeconds(
+        candidate.psi_type, candidate.curve_type, options);
+  }
+  // ties go to the earlier candidate.
+  return *std::min_element(candidates.begin(), candidates.end(),
+                           [](const PsiSelection& lhs,
+                              const PsiSelection& rhs) {
+                             return lhs.expected_seconds <
+                                    rhs.expected_seconds;
+                           });
+}
+
+LinkProfile ProbeLink(const std::shared_ptr<yacl::link::Context>& lctx,
+                      size_t probe_bytes) {
+  YACL_ENFORCE(lctx->WorldSize() == 2, "only 2 parties are probed, got {}",
+               lctx->WorldSize());
+
+  LinkProfile profile;
+  if (lctx->Rank() == 0) {
+    profile.rtt_seconds = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < kProbePings; i++) {
+      const auto begin = Clock::now();
+      lctx->Send(1, kProbeMessage, "PSI:PROBE_PING");
+      lctx->Recv(1, "PSI:PROBE_PONG");
+      profile.rtt_seconds = std::min(profile.rtt_seconds, SecondsSince(begin));
+    }
+
+    const std::string probe(probe_bytes, '\0');
+    const auto begin = Clock::now();
+    lctx->Send(1, probe, "PSI:PROBE_DATA");
+    lctx->Recv(1, "PSI:PROBE_ACK");
+    const double seconds =
+        std::max(SecondsSince(begin) - profile.rtt_seconds, 1e-6);
+    profile.bytes_per_second = probe_bytes / seconds;
+
+    lctx->Send(1,
+               fmt::format("{:.17g},{:.17g}", profile.rtt_seconds,
+                           profile.bytes_per_second),
+               "PSI:PROBE_PROFILE");
+  } else {
+    for (size_t i = 0; i < kProbePings; i++) {
+      lctx->Recv(0, "PSI:PROBE_PING");
+      lctx->Send(0, kProbeMessage, "PSI:PROBE_PONG");
+    }
+
+    lctx->Recv(0, "PSI:PROBE_DATA");
+    lctx->Send(0, kProbeMessage, "PSI:PROBE_ACK");
+
+    auto buf = lctx->Recv(0, "PSI:PROBE_PROFILE");
+    std::vector<std::string> fields =
+        absl::StrSplit(std::string(buf.data<char>(), buf.size()), ',');
+    YACL_ENFORCE(fields.size() == 2, "invalid link profile");
+    profile.rtt_seconds = std::stod(fields[0]);
+    profile.bytes_per_second = std::stod(fields[1]);
+  }
+  return profile;
+}
+
+}  // namespace spu::psi
@@ -0,0 +1,70 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "yacl/link/link.h"
+
+#include "spu/psi/psi.pb.h"
+
+namespace spu::psi {
+
+// The link between the two parties.
+struct LinkProfile {
+  double rtt_seconds = 0;
+  double bytes_per_second = 0;
+};
+
+struct PsiSelectOptions {
+  size_t receiver_size = 0;
+  size_t sender_size = 0;
+
+  LinkProfile link;
+
+  // the threads of the slower party.
+  size_t num_threads = 1;
+
+  // whether both parties support FourQ.
+  bool fourq_supported = false;
+
+  // the protocols but ECDH run by buckets of this size and pay their setup
+  // per bucket, 0 for one run of all items.
+  size_t bucket_size = 0;
+};
+
+struct PsiSelection {
+  PsiType psi_type = PsiType::INVALID_PSI_TYPE;
+  CurveType curve_type = CurveType::CURVE_INVALID_TYPE;
+  double expected_seconds = 0;
+};
+
+// The expected wall time of a 2-party protocol, by a coarse model of its
+// compute, bytes and rounds. `curve_type` is used by ECDH_PSI_2PC only.
+double EstimatePsiSeconds(PsiType psi_type, CurveType curve_type,
+                          const PsiSelectOptions& options);
+
+// Select among ECDH_PSI_2PC, KKRT_PSI_2PC and BC22_PSI_2PC, and the curve of
+// ECDH, of the least expected wall time. It is deterministic, so parties of
+// the same options select the same.
+PsiSelection SelectPsi(const PsiSelectOptions& options);
+
+// Measure the link to the peer of a 2-party `lctx` by a few pings and a
+// transfer of `probe_bytes`. Both parties should call it, and get the
+// profile measured by rank 0.
+LinkProfile ProbeLink(const std::shared_ptr<yacl::link::Context>& lctx,
+                      size_t probe_bytes = 1 << 20);
+
+}  // namespace spu::psi
@@ -0,0 +1,104 @@
+// Copyright 2022 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "spu/psi/utils/psi_selector.h"
+
+#include <future>
+
+#include "gtest/gtest.h"
+#include "yacl/link/test_util.h"
+
+namespace spu::psi {
+
+namespace {
+
+PsiSelectOptions MakeOptions(size_t size, double rtt_seconds,
+                             double bytes_per_second) {
+  PsiSelectOptions options;
+  options.receiver_size = size;
+  options.sender_size = size;
+  options.link.rtt_seconds = rtt_seconds;
+  options.link.bytes_per_second = bytes_per_second;
+  options.num_threads = 8;
+  return options;
+}
+
+}  // namespace
+
+TEST(PsiSelectorTest, SmallSetsSkipSetup) {
+  auto selection = SelectPsi(MakeOptions(100, 1e-3, 1e8));
+  EXPECT_EQ(selection.psi_type, PsiType::ECDH_PSI_2PC);
+  EXPECT_EQ(selection.curve_type, CurveType::CURVE_25519);
+}
+
+TEST(PsiSelectorTest, SelectsTheLeast) {
+  for (size_t size : {1 << 10, 1 << 16, 1 << 20, 1 << 24}) {
+    for (double rtt_seconds : {1e-4, 1e-2, 1e-1}) {
+      for (double bytes_per_second : {1e6, 1e8, 1e10}) {
+        auto options = MakeOptions(size, rtt_seconds, bytes_per_second);
+        options.fourq_supported = true;
+        auto selection = SelectPsi(options);
+        EXPECT_DOUBLE_EQ(selection.expected_seconds,
+                         EstimatePsiSeconds(selection.psi_type,
+                                            selection.curve_type, options));
+        for (auto psi_type : {PsiType::ECDH_PSI_2PC, PsiType::KKRT_PSI_2PC,
+                              PsiType::BC22_PSI_2PC}) {
+          for (auto curve_type :
+               {CurveType::CURVE_25519, CurveType::CURVE_FOURQ}) {
+            EXPECT_LE(selection.expected_seconds,
+                      EstimatePsiSeconds(psi_type, curve_type, options));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(PsiSelectorTest, FourQOnlyWhenSupported) {
+  auto options = MakeOptions(1 << 20, 1e-3, 1e10);
+  options.num_threads = 64;
+  options.fourq_supported = false;
+  EXPECT_NE(SelectPsi(options).curve_type, CurveType::CURVE_FOURQ);
+
+  options.fourq_supported = true;
+  auto selection = SelectPsi(options);
+  if (selection.psi_type == PsiType::ECDH_PSI_2PC) {
+    EXPECT_EQ(selection.curve_type, CurveType::CURVE_FOURQ);
+  }
+}
+
+TEST(PsiSelectorTest, SetupPerBucket) {
+  auto options = MakeOptions(1 << 20, 1e-2, 1e8);
+  const double one_run =
+      EstimatePsiSeconds(PsiType::KKRT_PSI_2PC, {}, options);
+  options.bucket_size = 1 << 10;
+  EXPECT_GT(EstimatePsiSeconds(PsiType::KKRT_PSI_2PC, {}, options), one_run);
+  EXPECT_ANY_THROW(EstimatePsiSeconds(PsiType::ECDH_PSI_3PC, {}, options));
+}
+
+TEST(PsiSelectorTest, ProbeLink) {
+  auto lctxs = yacl::link::test::SetupWorld(2);
+
+  auto f0 = std::async([&] { return ProbeLink(lctxs[0], 1 << 16); });
+  auto f1 = std::async([&] { return ProbeLink(lctxs[1], 1 << 16); });
+  auto profile0 = f0.get();
+  auto profile1 = f1.get();
+
+  EXPECT_GE(profile0.rtt_seconds, 0);
+  EXPECT_GT(profile0.bytes_per_second, 0);
+  EXPECT_DOUBLE_EQ(profile0.rtt_seconds, profile1.rtt_seconds);
+  EXPECT_DOUBLE_EQ(profile0.bytes_per_second, profile1.bytes_per_second);
+}
+
+}  // namespace spu::psi
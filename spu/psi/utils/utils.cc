@@ -14,115 +14,149 @@
 
 #include "spu/psi/utils/utils.h"
 
+#include <algorithm>
+#include <filesystem>
+
 #include "spdlog/spdlog.h"
 #include "yacl/base/exception.h"
 
 #include "spu/psi/io/io.h"
 #include "spu/psi/utils/csv_header_analyzer.h"
+#include "spu/psi/utils/csv_sorter.h"
 #include "spu/psi/utils/serialize.h"
 
 namespace spu::psi {
 
-// Multiple-Key out-of-core sort.
-// Out-of-core support reference:
-//   http://vkundeti.blogspot.com/2008/03/tech-algorithmic-details-of-unix-sort.html
-// Multiple-Key support reference:
-//   https://stackoverflow.com/questions/9471101/sort-csv-file-by-column-priority-using-the-sort-command
-// use POSIX locale for sort
-//   https://unix.stackexchange.com/questions/43465/whats-the-default-order-of-linux-sort/43466
-//
-// NOTE:
-// This implementation requires `sort` command, which is guaranteed by our
-// docker-way ship.
-void MultiKeySort(const std::string& in_csv, const std::string& out_csv,
-                  const std::vector<std::string>& keys) {
-  CsvHeaderAnalyzer analyzer(in_csv, keys);
-
-  std::string line;
-  {
-    // Copy head line to out_csv
-    // Add scope to flush write here.
-    io::FileIoOptions in_opts(in_csv);
-    auto in = io::BuildInputStream(in_opts);
-    in->GetLine(&line);
-    in->Close();
-
-    io::FileIoOptions out_opts(out_csv);
-    auto out = io::BuildOutputStream(out_opts);
-    out->Write(line);
-    out->Write("\n");
-    out->Close();
-  }
-
-  // Construct sort key indices.
-  // NOTE: `sort` cmd starts from index 1.
-  std::vector<std::string> sort_keys;
-  for (size_t index : analyzer.target_indices()) {
-    // About `sort --key=KEYDEF`
-    //
-    // KEYDEF is F[.C][OPTS][,F[.C][OPTS]] for start and stop position, where
-    // F is a field number and C a character position in the field; both are
-    // origin 1, and the stop position defaults to the line's end.  If neither
-    // -t nor -b is in effect, characters in a field are counted from the
-    // beginning of the preceding whitespace.  OPTS is one or more
-    // single-letter ordering options [bdfgiMhnRrV], which override global
-    // ordering options for that key.  If no key is given, use the entire line
-    // as the key.
-    //
-    // I have already verified `sort --key=3,3 --key=1,1` will firstly sort by
-    // 3rd field and then 1st field.
-    constexpr size_t kOffset = 1;
-    size_t key_index = kOffset + index;
-    sort_keys.push_back(fmt::format("--key={},{}", key_index, key_index));
-  }
-  YACL_ENFORCE(sort_keys.size() == keys.size(),
-               "mismatched header, field_names={}, line={}",
-               fmt::join(keys, ","), line);
-
-  // Sort the csv body and append to out csv.
-  std::string cmd = fmt::format(
-      "tail -n +2 {} | LC_ALL=C sort --buffer-size=1G "
-      "--temporary-directory=./ --stable --field-separator=, {} >>{}",
-      in_csv, fmt::join(sort_keys, " "), out_csv);
-  SPDLOG_INFO("Executing sort scripts: {}", cmd);
-  int ret = system(cmd.c_str());
-  SPDLOG_INFO("Finished sort scripts: {}, ret={}", cmd, ret);
-  YACL_ENFORCE(ret == 0, "failed to execute cmd={}, ret={}", cmd, ret);
-}
+namespace {
 
-void FilterFileByIndices(const std::string& input, const std::string& output,
-                         const std::vector<uint64_t>& indices,
-                         size_t header_line_count) {
+// Pass the header lines and the lines of `next_index` to `on_header` and
+// `on_line`, return the number of the latter.
+template <typename OnHeader, typename OnLine>
+size_t ForEachLineOfIndices(const std::string& input,
+                            const std::function<bool(uint64_t*)>& next_index,
+                            size_t header_line_count, OnHeader&& on_header,
+                            OnLine&& on_line) {
   auto in = io::BuildInputStream(io::FileIoOptions(input));
-  auto out = io::BuildOutputStream(io::FileIoOptions(output));
 
   std::string line;
   size_t idx = 0;
   size_t target_count = 0;
-  auto indices_iter = indices.begin();
+  uint64_t target = 0;
+  bool has_target = next_index(&target);
   while (in->GetLine(&line)) {
     if (idx < header_line_count) {
-      out->Write(line);
-      out->Write("\n");
+      on_header(line);
     } else {
-      if (indices_iter == indices.end()) {
+      if (!has_target) {
         break;
       }
-      if (*indices_iter == idx - header_line_count) {
-        indices_iter++;
-        out->Write(line);
-        out->Write("\n");
+      if (target == idx - header_line_count) {
+        on_line(line);
         ++target_count;
+        uint64_t prev = target;
+        has_target = next_index(&target);
+        YACL_ENFORCE(!has_target || target > prev,
+                     "indices should be sorted and unique, {} after {}",
+                     target, prev);
       }
     }
     idx++;
   }
+  YACL_ENFORCE(!has_target, "index={} out of range, line_count={}", target,
+               idx - std::min(idx, header_line_count));
+  in->Close();
+
+  return target_count;
+}
+
+// The cache dir of the sort runs of `output`, next to it.
+std::string SortCacheDir(const std::string& output) {
+  return std::filesystem::path(output).parent_path().string();
+}
+
+}  // namespace
+
+void MultiKeySort(const std::string& in_csv, const std::string& out_csv,
+                  const std::vector<std::string>& keys) {
+  CsvHeaderAnalyzer analyzer(in_csv, keys);
+  YACL_ENFORCE(analyzer.target_indices().size() == keys.size(),
+               "mismatched header, field_names={}", fmt::join(keys, ","));
+
+  auto in = io::BuildInputStream(io::FileIoOptions(in_csv));
+  auto out = io::BuildOutputStream(io::FileIoOptions(out_csv));
+  ExternalCsvSorter sorter(SortCacheDir(out_csv), analyzer.target_indices());
+
+  std::string line;
+  // Copy head line to out_csv
+  if (in->GetLine(&line)) {
+    out->Write(line);
+    out->Write("\n");
+  }
+  while (in->GetLine(&line)) {
+    sorter.Add(line);
+  }
+  sorter.Finalize(out.get());
+
+  out->Close();
+  in->Close();
+}
+
+void FilterFileByIndices(const std::string& input, const std::string& output,
+                         const std::vector<uint64_t>& indices,
+                         size_t header_line_count) {
+  auto indices_iter = indices.begin();
+  size_t target_count = FilterFileByIndices(
+      input, output,
+      [&](uint64_t* index) {
+        if (indices_iter == indices.end()) {
+          return false;
+        }
+        *index = *indices_iter++;
+        return true;
+      },
+      header_line_count);
   YACL_ENFORCE(target_count == indices.size(),
                "logstic error, indices.size={}, target_count={}, please be "
-               "sure the `indices` is sorted");
+               "sure the `indices` is sorted",
+               indices.size(), target_count);
+}
 
+size_t FilterFileByIndices(const std::string& input, const std::string& output,
+                           const std::function<bool(uint64_t*)>& next_index,
+                           size_t header_line_count) {
+  auto out = io::BuildOutputStream(io::FileIoOptions(output));
+  auto write = [&](const std::string& line) {
+    out->Write(line);
+    out->Write("\n");
+  };
+  size_t target_count = ForEachLineOfIndices(input, next_index,
+                                             header_line_count, write, write);
   out->Close();
-  in->Close();
+
+  return target_count;
+}
+
+size_t FilterAndSortFileByIndices(
+    const std::string& input, const std::string& output,
+    const std::function<bool(uint64_t*)>& next_index,
+    const std::vector<std::string>& keys, size_t header_line_count) {
+  CsvHeaderAnalyzer analyzer(input, keys);
+  YACL_ENFORCE(analyzer.target_indices().size() == keys.size(),
+               "mismatched header, field_names={}", fmt::join(keys, ","));
+
+  auto out = io::BuildOutputStream(io::FileIoOptions(output));
+  ExternalCsvSorter sorter(SortCacheDir(output), analyzer.target_indices());
+  size_t target_count = ForEachLineOfIndices(
+      input, next_index, header_line_count,
+      [&](const std::string& line) {
+        out->Write(line);
+        out->Write("\n");
+      },
+      [&](const std::string& line) { sorter.Add(line); });
+  sorter.Finalize(out.get());
+  out->Close();
+
+  return target_count;
 }
 
 std::string KeysJoin(const std::vector<absl::string_view>& keys) {
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <future>
 #include <memory>
 #include <string>
@@ -30,17 +31,9 @@ static const std::string kFinishedFlag = "p_finished";
 static const std::string kUnFinishedFlag = "p_unfinished";
 }  // namespace
 
-// Multiple-Key out-of-core sort.
-// Out-of-core support reference:
-//   http://vkundeti.blogspot.com/2008/03/tech-algorithmic-details-of-unix-sort.html
-// Multiple-Key support reference:
-//   https://stackoverflow.com/questions/9471101/sort-csv-file-by-column-priority-using-the-sort-command
-// use POSIX locale for sort
-//   https://unix.stackexchange.com/questions/43465/whats-the-default-order-of-linux-sort/43466
-//
-// NOTE:
-// This implementation requires `sort` command, which is guaranteed by our
-// docker-way ship.
+// Multiple-Key out-of-core sort, ordered as
+// `LC_ALL=C sort --stable --field-separator=, --key=F,F ...` of the keys.
+// The header line is kept, the runs are spilled next to `out_csv`.
 void MultiKeySort(const std::string& in_csv, const std::string& out_csv,
                   const std::vector<std::string>& keys);
 
@@ -49,6 +42,21 @@ void FilterFileByIndices(const std::string& input, const std::string& output,
                          const std::vector<uint64_t>& indices,
                          size_t header_line_count = 1);
 
+// Stream version, `next_index` yields the sorted indices one by one and
+// returns false at the end. Return the number of lines written, header lines
+// excluded.
+size_t FilterFileByIndices(const std::string& input, const std::string& output,
+                           const std::function<bool(uint64_t*)>& next_index,
+                           size_t header_line_count = 1);
+
+// Filter by `next_index` as FilterFileByIndices, and sort the lines by
+// `keys` as MultiKeySort in the same pass. Return the number of lines
+// written, header lines excluded.
+size_t FilterAndSortFileByIndices(
+    const std::string& input, const std::string& output,
+    const std::function<bool(uint64_t*)>& next_index,
+    const std::vector<std::string>& keys, size_t header_line_count = 1);
+
 // join keys with "-"
 std::string KeysJoin(const std::vector<absl::string_view>& keys);
 